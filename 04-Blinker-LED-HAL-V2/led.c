@@ -90,7 +90,7 @@ void LED_Init(void) {
     // Set pullup/pushdown resistors configuration
     LEDGPIO->PUPDR    = (LEDGPIO->PUPDR&~GPIO_PUPDR_M)|GPIO_PUPDR_V;
     // Turn off LED
-    LEDGPIO->ODR     &=  ~LEDMASK;
+    LEDGPIO->BSRR     =  LEDMASK<<16;
 }
 
 /**************************************************************************************************/
@@ -38,8 +38,9 @@ static inline void LED_Clear(void) {
 }
 
 static inline void LED_Toggle(void) {
-        /* This is a read/modify/write sequence */
-       LEDGPIO->ODR ^= LEDMASK;             // Use XOR to toggle output
+uint32_t odr = LEDGPIO->ODR;
+        /* Set or clear with one write. Other pins are not changed */
+        LEDGPIO->BSRR = (odr&LEDMASK) ? (LEDMASK<<16) : LEDMASK;
 }
 #endif
 
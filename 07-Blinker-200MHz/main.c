@@ -46,7 +46,11 @@ int main(void) {
 
     //SystemSetCoreClock(CLOCKSRC_HSE,100);
 
-    #if 1
+    #if defined(USE_216MHZ)
+    /* configure clock to 216 MHz (over-drive is enabled by SystemConfigMainPLL) */
+    SystemConfigMainPLL(&MainPLLConfiguration_216MHz);
+    SystemSetCoreClock(CLOCKSRC_PLL,1);
+    #else
     /* configure clock to 200 MHz */
     SystemConfigMainPLL(&MainPLLConfiguration_200MHz);
     SystemSetCoreClock(CLOCKSRC_PLL,1);
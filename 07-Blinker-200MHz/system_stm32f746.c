@@ -164,6 +164,16 @@ FlashWaitStates_Type const flashwaitstates_tab[] = {
 #define MAXWAITSTATES 9
 ///@}
 
+/**
+ * @brief   Maximal HCLK frequency without over-drive (VOS scale 1)
+ *
+ * @note    The over-drive needs a supply voltage above 2.1 V
+ */
+///@{
+#define OVERDRIVEMINFREQ    180000000
+#define OVERDRIVEMINVOLTAGE 2100
+///@}
+
 /**
  * @brief iabs: find absolute value of an integer
  */
@@ -193,7 +203,7 @@ static inline void LockFlashRegisters(void) {
 
 static void inline SetFlashWaitStates(int n) {
 
-    FLASH->ACR = (FLASH->CR&~FLASH_ACR_LATENCY)|((n)<<FLASH_ACR_LATENCY_Pos);
+    FLASH->ACR = (FLASH->ACR&~FLASH_ACR_LATENCY)|((n)<<FLASH_ACR_LATENCY_Pos);
 
 }
 
@@ -226,9 +236,9 @@ int i,j;
  *
  **/
 static void inline ConfigureFlashWaitStates(uint32_t freq, uint32_t voltage) {
-uint32_t ws;
+int ws;
 
-    ws = FindFlashWaitStates(freq,voltage);
+    ws = FindFlashWaitStates(freq/1000000,voltage);
 
     if( ws < 0 )
         return;
@@ -238,6 +248,27 @@ uint32_t ws;
 }
 
 
+/**
+ * @brief   Enable or disable the over-drive mode according the clock frequency
+ *
+ * @note    It does nothing while SYSCLK is PLL, because the over-drive mode can
+ *          only be changed when SYSCLK is HSI or HSE (RM Section 4.1.4)
+ *
+ * @note    It must be enabled only after the Main PLL is on
+ **/
+static void ConfigureOverDrive(uint32_t freq) {
+
+    if( (RCC->CFGR&RCC_CFGR_SWS) == RCC_CFGR_SWS_PLL )
+        return;
+
+    if( freq > OVERDRIVEMINFREQ && VSUPPLY >= OVERDRIVEMINVOLTAGE ) {
+        if( (PWR->CSR1&PWR_CSR1_ODSWRDY) == 0 )
+            SystemEnableOverDrive();
+    } else {
+        SystemDisableOverDrive();
+    }
+}
+
 /**
  * @brief   Get HPRE Prescaler
  *
@@ -373,7 +404,7 @@ void SystemSetAPB2Prescaler(uint32_t div) {
 uint32_t ppre2;
 uint32_t p2;
 
-    if( SystemCoreClock/div > 54000000 )
+    if( SystemCoreClock/div > 108000000 )
         return;
         
     p2 = SystemFindLargestPower2Exp(div);
@@ -581,7 +612,7 @@ PLLConfiguration_t pllconfig;
         pllconfig.source = pllsrc;
         pllconfig.M = (rcc_pllcfgr & RCC_PLLCFGR_PLLM)>>RCC_PLLCFGR_PLLM_Pos;
         pllconfig.N = (rcc_pllcfgr & RCC_PLLCFGR_PLLN)>>RCC_PLLCFGR_PLLN_Pos;
-        pllconfig.P = (rcc_pllcfgr & RCC_PLLCFGR_PLLP)>>RCC_PLLCFGR_PLLP_Pos;
+        pllconfig.P = ((rcc_pllcfgr & RCC_PLLCFGR_PLLP)>>RCC_PLLCFGR_PLLP_Pos)*2+2;
         sysclk_freq = CalculateMainPLLOutFrequency(&pllconfig);
       break;
     }
@@ -722,7 +753,8 @@ int      pllwascoreclock = 0;
     // If core clock source is PLL change it to HSI
     if( (RCC->CFGR&RCC_CFGR_SWS) == RCC_CFGR_SWS_PLL ) {
         SystemEnableHSI();
-        RCC->CFGR = (RCC->CFGR&RCC_CFGR_SW)|RCC_CFGR_SW_HSI;
+        RCC->CFGR = (RCC->CFGR&~RCC_CFGR_SW)|RCC_CFGR_SW_HSI;
+        while( (RCC->CFGR&RCC_CFGR_SWS) != RCC_CFGR_SWS_HSI ) {}
         pllwascoreclock = 1;
     }
     // Disable Main PLL
@@ -757,20 +789,28 @@ int      pllwascoreclock = 0;
                  (
                    ((pllconfig->M<<RCC_PLLCFGR_PLLM_Pos)&RCC_PLLCFGR_PLLM)
                   |((pllconfig->N<<RCC_PLLCFGR_PLLN_Pos)&RCC_PLLCFGR_PLLN)
-                  |((pllconfig->P<<RCC_PLLCFGR_PLLP_Pos)&RCC_PLLCFGR_PLLP)
+                  |(((pllconfig->P/2-1)<<RCC_PLLCFGR_PLLP_Pos)&RCC_PLLCFGR_PLLP)
                   |((pllconfig->Q<<RCC_PLLCFGR_PLLQ_Pos)&RCC_PLLCFGR_PLLQ)
                   |((src<<RCC_PLLCFGR_PLLSRC_Pos)&RCC_PLLCFGR_PLLSRC)
                  );
 
     RCC->PLLCFGR = rcc_pllcfgr;
 
+    // Voltage scale 1 (reset value). VOS can only be changed with the PLL off
+    RCC->APB1ENR |= RCC_APB1ENR_PWREN;
+    PWR->CR1 |= PWR_CR1_VOS;
+
     SystemEnableMainPLL();
 
+    // Wait for the regulator and set over-drive for the new frequency
+    while( (PWR->CSR1&PWR_CSR1_VOSRDY) == 0 ) {}
+    ConfigureOverDrive(CalculateMainPLLOutFrequency(pllconfig));
+
     MainPLLConfigured = 1;
 
     /* If it was the core clock, change back */
     if( pllwascoreclock ) {
-        RCC->CFGR = (RCC->CFGR&RCC_CFGR_SW)|RCC_CFGR_SW_PLL;
+        RCC->CFGR = (RCC->CFGR&~RCC_CFGR_SW)|RCC_CFGR_SW_PLL;
     }
 }
 
@@ -908,6 +948,7 @@ uint32_t src,div;
 uint32_t hpre,newhpre;
 uint32_t ppre1;
 uint32_t ppre2;
+PLLOutputFrequencies_t pllfreq;
 
     src = RCC->CFGR & RCC_CFGR_SW;
 
@@ -937,10 +978,14 @@ uint32_t ppre2;
         case CLOCKSRC_HSI:
             SystemEnableHSI();
             RCC->CFGR = (RCC->CFGR&~RCC_CFGR_SW)|RCC_CFGR_SW_HSI;
+            while( (RCC->CFGR&RCC_CFGR_SWS) != RCC_CFGR_SWS_HSI ) {}
+            ConfigureOverDrive(0);
             break;
         case CLOCKSRC_HSE:
             SystemEnableHSE();
             RCC->CFGR = (RCC->CFGR&~RCC_CFGR_SW)|RCC_CFGR_SW_HSE;
+            while( (RCC->CFGR&RCC_CFGR_SWS) != RCC_CFGR_SWS_HSE ) {}
+            ConfigureOverDrive(0);
             break;
         case CLOCKSRC_PLL:
             if( !MainPLLConfigured ) {
@@ -948,6 +993,9 @@ uint32_t ppre2;
                 SystemSetAPB2Prescaler(2);                  // Safe
                 SystemConfigMainPLL(&ClockConfiguration200MHz);
             }
+            // Over-drive must be on before switching to a PLL above 180 MHz
+            SystemGetPLLFrequencies(PLL_MAIN,&pllfreq);
+            ConfigureOverDrive(pllfreq.poutfreq);
             RCC->CFGR = (RCC->CFGR&~RCC_CFGR_SW)|RCC_CFGR_SW_PLL;
             __DSB();
             __ISB();
@@ -979,7 +1027,7 @@ PLLConfiguration_t clockconf;
     }
     clockconf.source = CLOCKSRC_HSE;     /* Clock source   */
     clockconf.M = HSE_FREQ/1000000;      /* f_IN = 1 MHz   */
-    clockconf.N = 2*freq;                /* f_PLL = 400 MHz*/
+    clockconf.N = 2*(freq/1000000);      /* f_PLL = 400 MHz*/
     clockconf.P = 2;                     /* f_OUT = 200 MHz*/
     clockconf.Q = 2;                     /* Not used */
     clockconf.R = 2;                     /* Not used */
@@ -256,6 +256,30 @@ static inline void SystemDisableMainPLL(void) {
 }
 ///@}
 
+/**
+ * @brief   Over-drive mode Enable/Disable
+ *
+ * @note    Needed for HCLK above 180 MHz. It can only be changed when SYSCLK is
+ *          HSI or HSE and it can only be enabled when the Main PLL is on
+ *
+ * @note    It is set by SystemConfigMainPLL and SystemSetCoreClock as needed
+ **/
+///@{
+static inline void SystemEnableOverDrive(void) {
+
+    RCC->APB1ENR |= RCC_APB1ENR_PWREN;
+    PWR->CR1 |= PWR_CR1_ODEN;
+    while( (PWR->CSR1&PWR_CSR1_ODRDY) == 0 ) {}
+    PWR->CR1 |= PWR_CR1_ODSWEN;
+    while( (PWR->CSR1&PWR_CSR1_ODSWRDY) == 0 ) {}
+}
+static inline void SystemDisableOverDrive(void) {
+
+    RCC->APB1ENR |= RCC_APB1ENR_PWREN;
+    PWR->CR1 &= ~(PWR_CR1_ODSWEN|PWR_CR1_ODEN);
+}
+///@}
+
 /**
  * @brief   PLL SAI Enable/Disable
  */
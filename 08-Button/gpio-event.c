@@ -0,0 +1,295 @@
+/**
+ * @file    gpio-event.c
+ *
+ * @note    Debounced GPIO events thru EXTI (see gpio-event.h)
+ *
+ * @note    For each line, the state is
+ *          idle        EXTI line unmasked, waiting for an edge
+ *          debouncing  EXTI line masked, counter > 0. At zero, the pin is read
+ *                      and the line is unmasked again
+ *
+ * @note    SYSCFG->EXTICR selects the port of each line (RM 11.2.2) and
+ *          EXTI->RTSR/FTSR enable both edges
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "gpio.h"
+#include "gpio-event.h"
+
+#define BIT(N)                  (1UL<<(N))
+
+/**
+ * @brief   Line information
+ */
+typedef struct {
+    GPIO_TypeDef    *gpio;      // 0 when not used
+    uint8_t         flags;
+    uint8_t         pressed;    // debounced state
+    uint8_t         longsent;
+    uint8_t         debounce;   // ms to read the pin
+    uint32_t        presstime;
+} Line;
+
+static Line lines[16];
+
+/**
+ * @brief   Event queue
+ */
+///@{
+static GPIOEvent            queue[GPIOEVENT_QUEUESIZE];
+static volatile uint32_t    qhead = 0;      // written by GPIOEvent_Tick
+static volatile uint32_t    qtail = 0;      // written by GPIOEvent_Get
+static uint32_t             overruns = 0;
+///@}
+
+static volatile uint32_t    now = 0;        // ms
+static uint16_t             activelines = 0;// lines being debounced or pressed
+static void                 (*notifyfunc)(void) = 0;
+
+static void
+Put(unsigned pin, unsigned type, uint32_t duration) {
+GPIOEvent *e;
+
+    if( qhead-qtail >= GPIOEVENT_QUEUESIZE ) {
+        overruns++;
+        return;
+    }
+    e = &queue[qhead&(GPIOEVENT_QUEUESIZE-1)];
+    e->pin      = pin;
+    e->type     = type;
+    e->duration = duration > 0xFFFF ? 0xFFFF : duration;
+    e->time     = now;
+    __DMB();
+    qhead++;
+    if( notifyfunc )
+        notifyfunc();
+}
+
+static int
+ReadPin(const Line *l, unsigned pin) {
+int level;
+
+    level = (l->gpio->IDR&BIT(pin)) != 0;
+    if( l->flags&GPIOEVENT_ACTIVELOW )
+        level = !level;
+    return level;
+}
+
+static IRQn_Type
+LineIRQ(unsigned pin) {
+
+    if( pin <= 4 )
+        return (IRQn_Type) (EXTI0_IRQn+pin);
+    if( pin <= 9 )
+        return EXTI9_5_IRQn;
+    return EXTI15_10_IRQn;
+}
+
+/**
+ * @brief   EXTI interrupt
+ *
+ * @note    Masks the lines and starts the debounce time
+ */
+static void
+EXTIHandler(uint32_t mask) {
+uint32_t pending;
+unsigned pin;
+
+    pending = EXTI->PR&EXTI->IMR&mask;
+    EXTI->PR   = pending;
+    EXTI->IMR &= ~pending;
+    for(pin=0;pending;pin++,pending>>=1) {
+        if( pending&1 ) {
+            lines[pin].debounce = GPIOEVENT_DEBOUNCE_MS;
+            activelines |= BIT(pin);
+        }
+    }
+}
+
+void EXTI0_IRQHandler(void)     { EXTIHandler(BIT(0)); }
+void EXTI1_IRQHandler(void)     { EXTIHandler(BIT(1)); }
+void EXTI2_IRQHandler(void)     { EXTIHandler(BIT(2)); }
+void EXTI3_IRQHandler(void)     { EXTIHandler(BIT(3)); }
+void EXTI4_IRQHandler(void)     { EXTIHandler(BIT(4)); }
+void EXTI9_5_IRQHandler(void)   { EXTIHandler(0x03E0); }
+void EXTI15_10_IRQHandler(void) { EXTIHandler(0xFC00); }
+
+/**
+ * @brief   GPIOEvent_Init
+ *
+ * @note    notify can be null
+ */
+void
+GPIOEvent_Init(void (*notify)(void)) {
+
+    RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;
+    __DSB();
+    notifyfunc = notify;
+    qhead = qtail = 0;
+    now = 0;
+}
+
+/**
+ * @brief   GPIOEvent_Add
+ *
+ * @note    Configures the pin as input and its EXTI line for both edges
+ *
+ * @note    Returns 0 or -1 when the pin is not valid or its line is used by
+ *          another port
+ */
+int
+GPIOEvent_Add(GPIO_TypeDef *gpio, unsigned pin, unsigned flags) {
+Line *l;
+uint32_t port;
+
+    if( pin > 15 )
+        return -1;
+    l = &lines[pin];
+    if( l->gpio && l->gpio != gpio )
+        return -1;
+
+    GPIO_Init(gpio,BIT(pin),0);
+    gpio->PUPDR = (gpio->PUPDR&~(3UL<<(2*pin)))
+                 |((flags&GPIOEVENT_PULLUP)?(1UL<<(2*pin)):0)
+                 |((flags&GPIOEVENT_PULLDOWN)?(2UL<<(2*pin)):0);
+
+    port = ((uint32_t) gpio-GPIOA_BASE)/(GPIOB_BASE-GPIOA_BASE);
+    SYSCFG->EXTICR[pin/4] = (SYSCFG->EXTICR[pin/4]&~(0xFUL<<(4*(pin%4))))
+                           |(port<<(4*(pin%4)));
+
+    NVIC_DisableIRQ(LineIRQ(pin));
+    l->gpio     = gpio;
+    l->flags    = flags;
+    l->longsent = 0;
+    l->debounce = 0;
+    l->pressed  = ReadPin(l,pin);
+    l->presstime = now;
+    if( l->pressed )
+        activelines |= BIT(pin);
+
+    EXTI->RTSR |= BIT(pin);
+    EXTI->FTSR |= BIT(pin);
+    EXTI->PR    = BIT(pin);
+    EXTI->IMR  |= BIT(pin);
+
+    NVIC_SetPriority(LineIRQ(pin),GPIOEVENT_IRQLEVEL);
+    NVIC_ClearPendingIRQ(LineIRQ(pin));
+    NVIC_EnableIRQ(LineIRQ(pin));
+    return 0;
+}
+
+/**
+ * @brief   GPIOEvent_Remove
+ *
+ * @note    Disables the EXTI line. The shared interrupts stay enabled
+ */
+int
+GPIOEvent_Remove(unsigned pin) {
+
+    if( pin > 15 || lines[pin].gpio == 0 )
+        return -1;
+    EXTI->IMR  &= ~BIT(pin);
+    EXTI->RTSR &= ~BIT(pin);
+    EXTI->FTSR &= ~BIT(pin);
+    EXTI->PR    = BIT(pin);
+    if( pin <= 4 )
+        NVIC_DisableIRQ(LineIRQ(pin));
+    lines[pin].gpio = 0;
+    activelines &= ~BIT(pin);
+    return 0;
+}
+
+/**
+ * @brief   GPIOEvent_Tick
+ *
+ * @note    Must be called every ms, at the EXTI priority (GPIOEVENT_IRQLEVEL).
+ *          It does nothing while no line is debouncing or pressed
+ */
+void
+GPIOEvent_Tick(void) {
+uint32_t active;
+unsigned pin;
+Line *l;
+int level;
+
+    now++;
+    active = activelines;
+    for(pin=0;active;pin++,active>>=1) {
+        if( (active&1) == 0 )
+            continue;
+        l = &lines[pin];
+        if( l->debounce ) {
+            if( --l->debounce )
+                continue;
+            level = ReadPin(l,pin);
+            if( level != l->pressed ) {
+                l->pressed = level;
+                if( level ) {
+                    l->presstime = now;
+                    l->longsent = 0;
+                    Put(pin,GPIOEVENT_PRESS,0);
+                } else {
+                    Put(pin,GPIOEVENT_RELEASE,now-l->presstime);
+                }
+            }
+            // An edge during the debounce time was lost. Unmask it again
+            EXTI->PR   = BIT(pin);
+            EXTI->IMR |= BIT(pin);
+            if( ReadPin(l,pin) != l->pressed ) {
+                l->debounce = GPIOEVENT_DEBOUNCE_MS;
+                continue;
+            }
+        }
+        if( l->pressed ) {
+            if( !l->longsent && now-l->presstime >= GPIOEVENT_LONGPRESS_MS ) {
+                l->longsent = 1;
+                Put(pin,GPIOEVENT_LONGPRESS,now-l->presstime);
+            }
+        } else if( l->debounce == 0 ) {
+            activelines &= ~BIT(pin);
+        }
+    }
+}
+
+/**
+ * @brief   GPIOEvent_Get
+ *
+ * @note    Returns 0 and the oldest event or -1 when there is none. It does not
+ *          block
+ */
+int
+GPIOEvent_Get(GPIOEvent *ev) {
+
+    if( qtail == qhead )
+        return -1;
+    *ev = queue[qtail&(GPIOEVENT_QUEUESIZE-1)];
+    __DMB();
+    qtail++;
+    return 0;
+}
+
+/**
+ * @brief   GPIOEvent_IsPressed
+ *
+ * @note    Debounced state
+ */
+int
+GPIOEvent_IsPressed(unsigned pin) {
+
+    return pin <= 15 && lines[pin].gpio && lines[pin].pressed;
+}
+
+/**
+ * @brief   GPIOEvent_GetOverruns
+ *
+ * @note    Number of events lost because the queue was full
+ */
+uint32_t
+GPIOEvent_GetOverruns(void) {
+
+    return overruns;
+}
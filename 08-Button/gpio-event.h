@@ -0,0 +1,93 @@
+#ifndef GPIO_EVENT_H
+#define GPIO_EVENT_H
+/**
+ * @file    gpio-event.h
+ *
+ * @note    Debounced GPIO events thru EXTI
+ *
+ * @note    An edge on a pin generates an EXTI interrupt. The line is masked and
+ *          GPIOEvent_Tick, called every ms (SysTick), reads the pin when the
+ *          debounce time ends. When the level changed, a press or a release
+ *          event is queued. A pin that stays pressed for GPIOEVENT_LONGPRESS_MS
+ *          queues a long press event too. So nothing runs while the pins do not
+ *          change, besides a test in GPIOEvent_Tick
+ *
+ * @note    The events are read by GPIOEvent_Get, from the main loop, a task of
+ *          the Time Triggered Executive or a RTOS task. The notify callback is
+ *          called (in interrupt) when an event is queued, to post a semaphore or
+ *          flag. The queue has one producer and one consumer and needs no lock
+ *
+ * @note    EXTI lines are shared by the pins with the same number, so there is
+ *          only one pin with a given number (PA0 or PB0 ...) at a time
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "stm32f746xx.h"
+
+/**
+ * @brief   Timing (ms)
+ */
+///@{
+#ifndef GPIOEVENT_DEBOUNCE_MS
+#define GPIOEVENT_DEBOUNCE_MS           20
+#endif
+#ifndef GPIOEVENT_LONGPRESS_MS
+#define GPIOEVENT_LONGPRESS_MS          1000
+#endif
+///@}
+
+/**
+ * @brief   Queue size (power of 2)
+ */
+#ifndef GPIOEVENT_QUEUESIZE
+#define GPIOEVENT_QUEUESIZE             16
+#endif
+
+/**
+ * @brief   EXTI interrupt priority
+ *
+ * @note    It must be the same of SysTick (15 after SysTick_Config), so the
+ *          EXTI routines and GPIOEvent_Tick do not preempt each other
+ */
+#ifndef GPIOEVENT_IRQLEVEL
+#define GPIOEVENT_IRQLEVEL              15
+#endif
+
+/**
+ * @brief   Flags for GPIOEvent_Add
+ */
+///@{
+#define GPIOEVENT_ACTIVEHIGH            0x00    // pressed when high
+#define GPIOEVENT_ACTIVELOW             0x01    // pressed when low
+#define GPIOEVENT_PULLUP                0x02
+#define GPIOEVENT_PULLDOWN              0x04
+///@}
+
+/**
+ * @brief   Event types
+ */
+///@{
+#define GPIOEVENT_PRESS                 1
+#define GPIOEVENT_RELEASE               2
+#define GPIOEVENT_LONGPRESS             3
+///@}
+
+typedef struct {
+    uint8_t     pin;            // = EXTI line
+    uint8_t     type;           // GPIOEVENT_PRESS, ...
+    uint16_t    duration;       // ms pressed (release and long press)
+    uint32_t    time;           // ms since GPIOEvent_Init
+} GPIOEvent;
+
+void     GPIOEvent_Init(void (*notify)(void));
+int      GPIOEvent_Add(GPIO_TypeDef *gpio, unsigned pin, unsigned flags);
+int      GPIOEvent_Remove(unsigned pin);
+void     GPIOEvent_Tick(void);
+int      GPIOEvent_Get(GPIOEvent *ev);
+int      GPIOEvent_IsPressed(unsigned pin);
+uint32_t GPIOEvent_GetOverruns(void);
+
+#endif // GPIO_EVENT_H
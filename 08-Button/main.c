@@ -8,6 +8,10 @@
  * @note     Direct access to registers
  * @note     No library used
  *
+ * @note     The button generates debounced events (gpio-event.c). A press
+ *           stops or restarts the blinking and a long press changes the
+ *           blinking period. The main loop sleeps between events
+ *
  *
  ******************************************************************************/
 
@@ -15,6 +19,7 @@
 #include "system_stm32f746.h"
 #include "led.h"
 #include "button.h"
+#include "gpio-event.h"
 
 
 /**
@@ -24,11 +29,13 @@
  *
  */
 static volatile int blinkon = 1;
+static volatile uint32_t period_ms = 500;
 
 static volatile uint32_t tick_ms = 0;
 void SysTick_Handler(void) {
 
-    if( tick_ms >= 500 ) {
+    GPIOEvent_Tick();
+    if( tick_ms >= period_ms ) {
        if( blinkon )
            LED_Toggle();
        tick_ms = 0;
@@ -45,6 +52,7 @@ void SysTick_Handler(void) {
  */
 
 int main(void) {
+GPIOEvent ev;
 
     //SystemSetCoreClock(CLOCKSRC_HSE,100);
 
@@ -55,11 +63,19 @@ int main(void) {
     SysTick_Config(SystemCoreClock/1000);
 
     LED_Init();
-    Button_Init();
+    GPIOEvent_Init(0);
+    GPIOEvent_Add(BUTTONGPIO,BUTTONPIN,GPIOEVENT_ACTIVEHIGH);
 
     /* Main */
     for (;;) {
-        if( Button_Read() )          // No debounce (yet) !!!!!
-            blinkon = !blinkon;
+        while( GPIOEvent_Get(&ev) == 0 ) {
+            if( ev.pin != BUTTONPIN )
+                continue;
+            if( ev.type == GPIOEVENT_PRESS )
+                blinkon = !blinkon;
+            else if( ev.type == GPIOEVENT_LONGPRESS )
+                period_ms = (period_ms == 500) ? 100 : 500;
+        }
+        __WFI();                    // Wakes up at the next SysTick or EXTI
     }
 }
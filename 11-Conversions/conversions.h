@@ -11,8 +11,39 @@
  *
  **/
 
+#include <stdint.h>
+
+/**
+ * @brief Return values of the parsing routines
+ *
+ * @note  On success, they return the number of characters used (leading
+ *        blanks included), so the parsing can go on after the number
+ */
+///@{
+#define CONV_ERROR_SYNTAX           (-1)    ///< no digit
+#define CONV_ERROR_OVERFLOW         (-2)    ///< out of range
+///@}
+
 void IntToString(int v, char *s);
 void UnsignedToString(unsigned x, char *s);
 void IntToHexString(unsigned, char *s);
 
+int StringToInt(const char *s, int *v);
+int StringToUnsigned(const char *s, unsigned *v);
+int HexStringToUnsigned(const char *s, unsigned *v);
+int StringToFixed(const char *s, int frac, int32_t *v);
+
+/**
+ * @brief Buffer size for the floating point routines
+ */
+///@{
+#define CONV_FLOAT_BUFSIZE          40      ///< sign, 20+17 digits, point, 0
+#define CONV_FLOAT_MAXDECIMALS      17
+///@}
+
+int FloatToString(float v, char *s);
+int DoubleToString(double v, char *s);
+int DoubleToFixedString(double v, int decimals, char *s);
+int FixedToString(int32_t v, int frac, char *s);
+
 #endif // CONV_H
@@ -11,6 +11,8 @@
  *
  ******************************************************************************/
 
+#include <stdlib.h>
+
 #include "stm32f746xx.h"
 #include "system_stm32f746.h"
 #include "led.h"
@@ -112,6 +114,95 @@ char s[30];
     UART_WriteString(uart,"\n\r");
 }
 
+/**
+ * @brief   Parsing benchmark
+ *
+ * @note    Cycles (DWT counter) to parse each number of the set, average of
+ *          BENCH_REPEAT runs, with the routines of conversions.c and with
+ *          strtol/strtoul of newlib
+ */
+///@{
+#define BENCH_REPEAT 100
+
+static const char *const benchnumbers[] = {
+    "7", "42", "-1234", "65535", "1000000", "-87654321", "2147483647", " 3000000000"
+};
+#define BENCH_COUNT (sizeof(benchnumbers)/sizeof(benchnumbers[0]))
+
+static volatile int benchsink;
+
+static uint32_t BenchStringToInt(void) {
+uint32_t start;
+unsigned i,k;
+int v = 0;
+
+    start = DWT->CYCCNT;
+    for(k=0;k<BENCH_REPEAT;k++) {
+        for(i=0;i<BENCH_COUNT;i++) {
+            StringToInt(benchnumbers[i],&v);
+            benchsink = v;
+        }
+    }
+    return (DWT->CYCCNT-start)/(BENCH_REPEAT*BENCH_COUNT);
+}
+
+static uint32_t BenchStrtol(void) {
+uint32_t start;
+unsigned i,k;
+
+    start = DWT->CYCCNT;
+    for(k=0;k<BENCH_REPEAT;k++) {
+        for(i=0;i<BENCH_COUNT;i++)
+            benchsink = strtol(benchnumbers[i],0,10);
+    }
+    return (DWT->CYCCNT-start)/(BENCH_REPEAT*BENCH_COUNT);
+}
+
+static uint32_t BenchStringToUnsigned(void) {
+uint32_t start;
+unsigned i,k;
+unsigned v = 0;
+
+    start = DWT->CYCCNT;
+    for(k=0;k<BENCH_REPEAT;k++) {
+        for(i=0;i<BENCH_COUNT;i++) {
+            StringToUnsigned(benchnumbers[i],&v);
+            benchsink = v;
+        }
+    }
+    return (DWT->CYCCNT-start)/(BENCH_REPEAT*BENCH_COUNT);
+}
+
+static uint32_t BenchStrtoul(void) {
+uint32_t start;
+unsigned i,k;
+
+    start = DWT->CYCCNT;
+    for(k=0;k<BENCH_REPEAT;k++) {
+        for(i=0;i<BENCH_COUNT;i++)
+            benchsink = strtoul(benchnumbers[i],0,10);
+    }
+    return (DWT->CYCCNT-start)/(BENCH_REPEAT*BENCH_COUNT);
+}
+
+static void ParsingBenchmark(void) {
+int32_t f = 0;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    UART_WriteString(UART_1,"Parsing (cycles per number)\n\r");
+    WriteValue(UART_1,"StringToInt:                 ",BenchStringToInt());
+    WriteValue(UART_1,"strtol:                      ",BenchStrtol());
+    WriteValue(UART_1,"StringToUnsigned:            ",BenchStringToUnsigned());
+    WriteValue(UART_1,"strtoul:                     ",BenchStrtoul());
+
+    StringToFixed("-12.3456",3,&f);
+    WriteValue(UART_1,"StringToFixed(-12.3456,3):   ",f);
+}
+///@}
+
 /**
  * @brief   Linker information
  */
@@ -205,7 +296,7 @@ uint32_t ramused,flashused;
     v = (uint32_t) ((char *) &_bss_end);
     WriteHexValue(UART_1,"BSS end:      ",v);
 
-
+    ParsingBenchmark();
 
     for(;;) {}
 }
@@ -16,6 +16,9 @@
 #include "led.h"
 #include "uart.h"
 #include "ministdio.h"
+#ifdef STDIO_USE_SWO
+#include "swo.h"
+#endif
 
 
 /**
@@ -112,11 +115,20 @@ uint32_t v;
 /**
  * @brief   Interface to ministdio
  *
- * @note    All input/output go thru getchar/putchar functions
+ * @note    Input goes thru getchar. Output is buffered by ministdio and sent
+ *          in blocks by miniwrite (putchar is only used for the echo of fgets)
+ *
+ * @note    When STDIO_USE_SWO is defined, output goes to ITM stimulus port 0
  */
 
 int getchar(void) { return UART_ReadChar(UART_1); }
+#ifdef STDIO_USE_SWO
+void putchar(char c) { SWO_WriteChar(SWO_PORT_STDIO,c); }
+int miniwrite(const char *s, int n) { return SWO_Write(SWO_PORT_STDIO,s,n); }
+#else
 void putchar(char c) { UART_WriteChar(UART_1,c); }
+int miniwrite(const char *s, int n) { return UART_Write(UART_1,s,n); }
+#endif
 
 /**
  * @brief   main
@@ -136,6 +148,11 @@ uint32_t ramused,flashused;
 
     SysTick_Config(SystemCoreClock/1000);
 
+#ifdef STDIO_USE_SWO
+    /* Enable stimulus ports for stdio, logs, counters and events */
+    SWO_Init(0,0xF);
+#endif
+
     LED_Init();
 
     UART_Init(UART_1,uartconfig);
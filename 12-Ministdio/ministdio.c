@@ -6,22 +6,50 @@
  *
  * @note  Uses getchar and putchar routines for input/output
  *
- * @note  Does not accept width and precision specification
- * @note  Does not return character count
+ * @note  Accepts flags '-' and '0', width and the l and ll size modifiers
+ * @note  Precision is only used by %f
  *
- * @note  Output routines: printf, puts, fputs
+ * @note  %f writes a fixed number of decimals (default 6), exactly as newlib.
+ *        %g writes the shortest representation that reads back to the same
+ *        double (0.1 and not 0.100000) and %hg the one of a float (the argument
+ *        is converted back to float). This is not the standard %g. Both use
+ *        only integer arithmetic (Grisu2 for %g), so no soft float routines are
+ *        linked. Define MINIPRINTF_NOFLOAT to leave them out
+ *
+ * @note  Output routines: printf, snprintf, vsnprintf, puts, fputs, fflush
  *
  * @note  Input routines: fgets
  *
+ * @note  printf, puts and fputs write into the stdout buffer, which is sent by
+ *        miniwrite. There is a weak version of it that calls putchar for each
+ *        char. The application can provide a faster one that writes the whole
+ *        block (e.g. using DMA).
+ *
+ * @note  The buffer is sent when full, by fflush, before fgets reads and, in
+ *        line buffering mode (default), at the end of a call that wrote a '\n'.
+ *        setvbuf selects full buffering (_IOFBF, only when full or by fflush),
+ *        line buffering (_IOLBF) or no buffering (_IONBF, each printf formats
+ *        into a buffer in the stack and sends it at the end)
+ *
  */
 
 #include <stdarg.h>
+#include <stdint.h>
 #include "ministdio.h"
 
 /*
- * Use division in conversion
+ * Size of the buffer used by printf when stdout is not buffered
+ */
+#ifndef MINIPRINTF_BUFSIZE
+#define MINIPRINTF_BUFSIZE 128
+#endif
+
+/*
+ * Size of the stdout buffer
  */
-#define USE_DIV
+#ifndef MINISTDIO_OUTBUFSIZE
+#define MINISTDIO_OUTBUFSIZE 256
+#endif
 
 /*
  * Low level input/output
@@ -34,161 +62,883 @@ extern int      minigetchar(void);
 #define CR  '\x0D'
 #define LF  '\x0A'
 
+/**
+ * @brief   Write a block of chars
+ *
+ * @note    Weak version. Sends char by char using putchar
+ */
+__attribute__((weak)) int
+miniwrite(const char *s, int n) {
+int i;
+
+    for(i=0;i<n;i++) putchar(s[i]);
+    return n;
+}
+
+/**
+ * @brief   Output buffer
+ *
+ * @note    When the buffer is full, it is flushed using miniwrite (printf) or the
+ *          rest of output is discarded (snprintf)
+ */
+typedef struct {
+    char        *buf;
+    int         size;
+    int         pos;
+    int         count;                      /// total chars generated
+    int         flush;                      /// flush when full (otherwise truncate)
+    int         crlf;                       /// send CR after LF
+    int         newline;                    /// LF written since last flush
+} OUTBUF;
+
+static void
+outflush(OUTBUF *o) {
+
+    if( o->flush && o->pos ) {
+        miniwrite(o->buf,o->pos);
+        o->pos = 0;
+    }
+    o->newline = 0;
+}
+
+static inline void
+outchar(OUTBUF *o, char c) {
+
+    o->count++;
+    if( c == '\n' )
+        o->newline = 1;
+    if( o->pos >= o->size ) {
+        if( !o->flush )
+            return;
+        outflush(o);
+    }
+    o->buf[o->pos++] = c;
+}
+
 static void
-printbit(unsigned n,int size) {
-unsigned int m = 1<<(size-1);
-int flag = 0;
-
-    while(m) {
-        if( n&m ) {
-            putchar('1');
-            flag = 1;
+outblock(OUTBUF *o, const char *s, int n) {
+
+    while( n-- > 0 ) outchar(o,*s++);
+}
+
+/**
+ * @brief   Pairs of decimal digits
+ *
+ * @note    Used to convert two digits in each step
+ */
+static const char digits2[200] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const char hexlower[] = "0123456789abcdef";
+static const char hexupper[] = "0123456789ABCDEF";
+
+/**
+ * @brief   Divide by 100 using multiplication by reciprocal
+ *
+ * @note    Exact for all 32 bit values
+ */
+static inline uint32_t div100(uint32_t n) {
+    return (uint32_t) (((uint64_t) n*0x51EB851FU)>>37);
+}
+
+/**
+ * @brief   Convert unsigned to decimal
+ *
+ * @note    Digits are written backwards ending at end. Returns pointer to first one
+ */
+static char *
+fmtu32(char *end, uint32_t n) {
+char *p = end;
+uint32_t q;
+unsigned r;
+
+    while( n >= 100 ) {
+        q = div100(n);
+        r = (n-q*100)*2;
+        n = q;
+        *--p = digits2[r+1];
+        *--p = digits2[r];
+    }
+    if( n >= 10 ) {
+        *--p = digits2[n*2+1];
+        *--p = digits2[n*2];
+    } else {
+        *--p = n+'0';
+    }
+    return p;
+}
+
+/**
+ * @brief   Convert unsigned long long to decimal
+ *
+ * @note    Splits the value in pieces of 8 digits, so only a few 64 bit
+ *          divisions are needed
+ */
+static char *
+fmtu64(char *end, uint64_t n) {
+char *p = end;
+char *q;
+uint64_t d;
+
+    while( n > 0xFFFFFFFFU ) {
+        d = n/100000000U;
+        q = fmtu32(p,(uint32_t) (n-d*100000000U));
+        while( q > p-8 ) *--q = '0';
+        p = q;
+        n = d;
+    }
+    return fmtu32(p,(uint32_t) n);
+}
+
+/**
+ * @brief   Convert to hexadecimal
+ */
+static char *
+fmthex(char *end, uint64_t n, const char *digits) {
+char *p = end;
+
+    do {
+        *--p = digits[n&0xF];
+        n >>= 4;
+    } while( n );
+    return p;
+}
+
+/**
+ * @brief   Convert to binary
+ */
+static char *
+fmtbin(char *end, uint64_t n) {
+char *p = end;
+
+    do {
+        *--p = (n&1)+'0';
+        n >>= 1;
+    } while( n );
+    return p;
+}
+
+#ifndef MINIPRINTF_NOFLOAT
+/**
+ * @brief   Number of decimal digits
+ */
+static int
+countdigits(uint32_t x) {
+int n = 1;
+
+    while( x >= 10 ) {
+        x /= 10;
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief   Powers of 10 (64 bits)
+ */
+static const uint64_t pow10l[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL,
+    1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+    1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+    1000000000000000000ULL, 10000000000000000000ULL
+};
+
+/**
+ * @brief   Cached powers of 10 for Grisu
+ *
+ * @note    10^k = cachedf[i]*2^cachede[i] for k = -348+8*i, with cachedf
+ *          normalized (bit 63 set) and rounded
+ */
+///@{
+static const uint64_t cachedf[87] = {
+    0xFA8FD5A0081C0288ULL, 0xBAAEE17FA23EBF76ULL, 0x8B16FB203055AC76ULL,
+    0xCF42894A5DCE35EAULL, 0x9A6BB0AA55653B2DULL, 0xE61ACF033D1A45DFULL,
+    0xAB70FE17C79AC6CAULL, 0xFF77B1FCBEBCDC4FULL, 0xBE5691EF416BD60CULL,
+    0x8DD01FAD907FFC3CULL, 0xD3515C2831559A83ULL, 0x9D71AC8FADA6C9B5ULL,
+    0xEA9C227723EE8BCBULL, 0xAECC49914078536DULL, 0x823C12795DB6CE57ULL,
+    0xC21094364DFB5637ULL, 0x9096EA6F3848984FULL, 0xD77485CB25823AC7ULL,
+    0xA086CFCD97BF97F4ULL, 0xEF340A98172AACE5ULL, 0xB23867FB2A35B28EULL,
+    0x84C8D4DFD2C63F3BULL, 0xC5DD44271AD3CDBAULL, 0x936B9FCEBB25C996ULL,
+    0xDBAC6C247D62A584ULL, 0xA3AB66580D5FDAF6ULL, 0xF3E2F893DEC3F126ULL,
+    0xB5B5ADA8AAFF80B8ULL, 0x87625F056C7C4A8BULL, 0xC9BCFF6034C13053ULL,
+    0x964E858C91BA2655ULL, 0xDFF9772470297EBDULL, 0xA6DFBD9FB8E5B88FULL,
+    0xF8A95FCF88747D94ULL, 0xB94470938FA89BCFULL, 0x8A08F0F8BF0F156BULL,
+    0xCDB02555653131B6ULL, 0x993FE2C6D07B7FACULL, 0xE45C10C42A2B3B06ULL,
+    0xAA242499697392D3ULL, 0xFD87B5F28300CA0EULL, 0xBCE5086492111AEBULL,
+    0x8CBCCC096F5088CCULL, 0xD1B71758E219652CULL, 0x9C40000000000000ULL,
+    0xE8D4A51000000000ULL, 0xAD78EBC5AC620000ULL, 0x813F3978F8940984ULL,
+    0xC097CE7BC90715B3ULL, 0x8F7E32CE7BEA5C70ULL, 0xD5D238A4ABE98068ULL,
+    0x9F4F2726179A2245ULL, 0xED63A231D4C4FB27ULL, 0xB0DE65388CC8ADA8ULL,
+    0x83C7088E1AAB65DBULL, 0xC45D1DF942711D9AULL, 0x924D692CA61BE758ULL,
+    0xDA01EE641A708DEAULL, 0xA26DA3999AEF774AULL, 0xF209787BB47D6B85ULL,
+    0xB454E4A179DD1877ULL, 0x865B86925B9BC5C2ULL, 0xC83553C5C8965D3DULL,
+    0x952AB45CFA97A0B3ULL, 0xDE469FBD99A05FE3ULL, 0xA59BC234DB398C25ULL,
+    0xF6C69A72A3989F5CULL, 0xB7DCBF5354E9BECEULL, 0x88FCF317F22241E2ULL,
+    0xCC20CE9BD35C78A5ULL, 0x98165AF37B2153DFULL, 0xE2A0B5DC971F303AULL,
+    0xA8D9D1535CE3B396ULL, 0xFB9B7CD9A4A7443CULL, 0xBB764C4CA7A44410ULL,
+    0x8BAB8EEFB6409C1AULL, 0xD01FEF10A657842CULL, 0x9B10A4E5E9913129ULL,
+    0xE7109BFBA19C0C9DULL, 0xAC2820D9623BF429ULL, 0x80444B5E7AA7CF85ULL,
+    0xBF21E44003ACDD2DULL, 0x8E679C2F5E44FF8FULL, 0xD433179D9C8CB841ULL,
+    0x9E19DB92B4E31BA9ULL, 0xEB96BF6EBADF77D9ULL, 0xAF87023B9BF0EE6BULL,
+};
+
+static const int16_t cachede[87] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007,  -980,
+     -954,  -927,  -901,  -874,  -847,  -821,  -794,  -768,  -741,  -715,
+     -688,  -661,  -635,  -608,  -582,  -555,  -529,  -502,  -475,  -449,
+     -422,  -396,  -369,  -343,  -316,  -289,  -263,  -236,  -210,  -183,
+     -157,  -130,  -103,   -77,   -50,   -24,     3,    30,    56,    83,
+      109,   136,   162,   189,   216,   242,   269,   295,   322,   348,
+      375,   402,   428,   455,   481,   508,   534,   561,   588,   614,
+      641,   667,   694,   720,   747,   774,   800,   827,   853,   880,
+      907,   933,   960,   986,  1013,  1039,  1066,
+};
+///@}
+
+/**
+ * @brief   Floating point number with a 64 bit significand (f*2^e)
+ */
+typedef struct {
+    uint64_t    f;
+    int         e;
+} DiyFp;
+
+/**
+ * @brief   Product rounded to 64 bits
+ *
+ * @note    Four 32x32 multiplications, what the Cortex-M7 does in hardware
+ */
+static DiyFp
+diymul(DiyFp x, DiyFp y) {
+DiyFp r;
+uint64_t a = x.f>>32, b = x.f&0xFFFFFFFFU;
+uint64_t c = y.f>>32, d = y.f&0xFFFFFFFFU;
+uint64_t ac = a*c, bc = b*c, ad = a*d, bd = b*d;
+uint64_t t;
+
+    t = (bd>>32)+(ad&0xFFFFFFFFU)+(bc&0xFFFFFFFFU)+(1U<<31);
+    r.f = ac+(ad>>32)+(bc>>32)+(t>>32);
+    r.e = x.e+y.e+64;
+    return r;
+}
+
+static DiyFp
+diynormalize(DiyFp x) {
+int s = __builtin_clzll(x.f);
+
+    x.f <<= s;
+    x.e -= s;
+    return x;
+}
+
+/**
+ * @brief   Grisu2 digit generation
+ *
+ * @note    Generates the digits of W (scaled by 10^k) until the number is
+ *          between the boundaries Wm and Wp, so it reads back to the same
+ *          value. The last digit is then moved towards W. The result is the
+ *          shortest in almost all cases (about 0.1% of doubles get one digit
+ *          more) and always exact when read back
+ *
+ * @note    Returns the number of digits. The value is digits*10^*k
+ */
+static int
+digitgen(DiyFp w, DiyFp wp, uint64_t delta, char *digits, int *k) {
+DiyFp one;
+uint64_t wpw,p2,rest,tenkappa;
+uint32_t p1,d;
+int kappa,n = 0;
+
+    one.e = wp.e;
+    one.f = 1ULL<<-one.e;
+    wpw = wp.f-w.f;
+    p1 = (uint32_t) (wp.f>>-one.e);
+    p2 = wp.f&(one.f-1);
+    kappa = countdigits(p1);
+    for(;;) {
+        if( kappa > 0 ) {
+            d = p1/(uint32_t) pow10l[kappa-1];
+            p1 -= d*(uint32_t) pow10l[kappa-1];
+            kappa--;
+            rest = ((uint64_t) p1<<-one.e)+p2;
+            tenkappa = pow10l[kappa]<<-one.e;
         } else {
-            if( flag ) putchar('0');
+            p2 *= 10;
+            delta *= 10;
+            d = (uint32_t) (p2>>-one.e);
+            p2 &= one.f-1;
+            kappa--;
+            rest = p2;
+            tenkappa = one.f;
+            if( -kappa < 20 )
+                wpw = (wp.f-w.f)*pow10l[-kappa];
+        }
+        if( d || n )
+            digits[n++] = '0'+d;
+        if( rest < delta || (kappa >= 0 && rest == delta) ) {
+            while( rest < wpw && delta-rest >= tenkappa
+                && (rest+tenkappa < wpw || wpw-rest > rest+tenkappa-wpw) ) {
+                digits[n-1]--;
+                rest += tenkappa;
+            }
+            *k += kappa;
+            return n;
         }
-        m >>= 1;
     }
 }
 
-static void
-printuint(unsigned n) {
-int d;
-int k;
-unsigned n10;
-
-    d = 1;
-    n10 = n/10;
-    while( d < n10 ) d *= 10;
-
-    while( d > 1 ) {
-#ifdef USE_DIV
-        k = n/d;
-        n = n % d;
-#else
-        k = 0;
-        while( n > d ) {
-            n = n-d;
-            k++;
+/**
+ * @brief   Grisu2
+ *
+ * @note    The value is f*2^e. The boundaries are the midpoints to the
+ *          neighbour values. When f is a power of 2, the lower neighbour is
+ *          closer (lowercloser)
+ */
+static int
+grisu2(uint64_t f, int e, int lowercloser, char *digits, int *k) {
+DiyFp v,wp,wm,c;
+int i;
+
+    wp.f = (f<<1)+1;
+    wp.e = e-1;
+    wp = diynormalize(wp);
+    if( lowercloser ) {
+        wm.f = (f<<2)-1;
+        wm.e = e-2;
+    } else {
+        wm.f = (f<<1)-1;
+        wm.e = e-1;
+    }
+    wm.f <<= wm.e-wp.e;
+    wm.e = wp.e;
+
+    // Power of 10 that brings the exponent of wp*c to -61..-32
+    i = ((347-(((wp.e+61)*78913)>>18))>>3)+1;
+    c.f = cachedf[i];
+    c.e = cachede[i];
+    *k = 348-i*8;
+
+    v.f = f;
+    v.e = e;
+    v = diymul(diynormalize(v),c);
+    wp = diymul(wp,c);
+    wm = diymul(wm,c);
+    wm.f++;
+    wp.f--;
+    return digitgen(v,wp,wp.f-wm.f,digits,k);
+}
+
+/**
+ * @brief   Floating point formats
+ */
+#define MINIPRINTF_MAXDECIMALS 17
+
+/**
+ * @brief   Write NaN and infinities
+ */
+static int
+fmtspecial(char *s, int neg, int nan) {
+char *p = s;
+
+    if( nan ) {
+        *p++ = 'n'; *p++ = 'a'; *p++ = 'n';
+    } else {
+        if( neg ) *p++ = '-';
+        *p++ = 'i'; *p++ = 'n'; *p++ = 'f';
+    }
+    return p-s;
+}
+
+/**
+ * @brief   Write digits*10^k
+ *
+ * @note    Positional when the decimal exponent is -4 to 16, otherwise with an
+ *          exponent (1.5e+20). Integers have no decimal point
+ */
+static int
+fmtdigits(char *s, int neg, const char *digits, int n, int k) {
+char *p = s;
+int dp = n+k;                               // position of the decimal point
+int i,x;
+
+    if( neg )
+        *p++ = '-';
+    if( dp-1 >= -4 && dp-1 < 17 ) {
+        if( dp <= 0 ) {
+            *p++ = '0';
+            *p++ = '.';
+            for(i=dp;i<0;i++) *p++ = '0';
+            for(i=0;i<n;i++) *p++ = digits[i];
+        } else {
+            for(i=0;i<n||i<dp;i++) {
+                if( i == dp )
+                    *p++ = '.';
+                *p++ = (i < n) ? digits[i] : '0';
+            }
         }
-#endif
-        putchar(k+'0');
-        d /= 10;
-    };
+    } else {
+        *p++ = digits[0];
+        if( n > 1 ) {
+            *p++ = '.';
+            for(i=1;i<n;i++) *p++ = digits[i];
+        }
+        *p++ = 'e';
+        x = dp-1;
+        if( x < 0 ) {
+            *p++ = '-';
+            x = -x;
+        } else {
+            *p++ = '+';
+        }
+        if( x >= 100 ) {
+            *p++ = '0'+x/100;
+            x %= 100;
+        }
+        *p++ = digits2[x*2];
+        *p++ = digits2[x*2+1];
+    }
+    return p-s;
+}
+
+/**
+ * @brief   Shortest representation of a double (%g)
+ */
+static int
+fmtdouble(char *s, double v) {
+union { double d; uint64_t u; } x;
+uint64_t f;
+int be,e,n,k;
+char digits[20];
 
-    putchar(n+'0');
+    x.d = v;
+    be = (int) (x.u>>52)&0x7FF;
+    f  = x.u&0x000FFFFFFFFFFFFFULL;
+    if( be == 0x7FF )
+        return fmtspecial(s,x.u>>63,f != 0);
+    if( be == 0 && f == 0 ) {
+        digits[0] = '0';
+        return fmtdigits(s,x.u>>63,digits,1,0);
+    }
+    if( be == 0 ) {
+        e = -1074;
+    } else {
+        e = be-1075;
+        f |= 1ULL<<52;
+    }
+    n = grisu2(f,e,f == (1ULL<<52) && be > 1,digits,&k);
+    return fmtdigits(s,x.u>>63,digits,n,k);
 }
 
-static void
-printhex(int n, int d) {
-int pos = sizeof(int)*8-4;
-int ch;
+/**
+ * @brief   Shortest representation of a float (%hg)
+ */
+static int
+fmtfloat(char *s, float v) {
+union { float fl; uint32_t u; } x;
+uint32_t f;
+int be,e,n,k;
+char digits[20];
 
-    while( pos >= 0 ) {
-        ch = (n>>pos)&0x0F;
-        if( ch < 10 )
-            putchar(ch+'0');
-        else
-            putchar(ch-10+d);
-        pos -= 4;
+    x.fl = v;
+    be = (int) (x.u>>23)&0xFF;
+    f  = x.u&0x007FFFFFU;
+    if( be == 0xFF )
+        return fmtspecial(s,x.u>>31,f != 0);
+    if( be == 0 && f == 0 ) {
+        digits[0] = '0';
+        return fmtdigits(s,x.u>>31,digits,1,0);
     }
+    if( be == 0 ) {
+        e = -149;
+    } else {
+        e = be-150;
+        f |= 1U<<23;
+    }
+    n = grisu2(f,e,f == (1U<<23) && be > 1,digits,&k);
+    return fmtdigits(s,x.u>>31,digits,n,k);
 }
 
-static void
-printint( int n) {
-int d,n10,k;
-
-    if( n < 0 ) {
-        n = -n;
-        putchar('-');
-    }
-    d = 1;
-    n10 = n/10;
-    while( d <= n10 ) d *= 10;
-    while( d > 1 ) {
-#ifdef USE_DIV
-        k = n/d;
-        n = n%d;
-#else
-        k = 0;
-        while( (n = n-d) >= 0 ) k++;
-        n += d;
+/**
+ * @brief   Fixed number of decimals (%f)
+ *
+ * @note    Exact: the fraction is kept as a 128 bit fixed point number (four
+ *          words), multiplied by 10 for each decimal. Rounds to nearest, ties
+ *          to even. At most MINIPRINTF_MAXDECIMALS decimals. Values from 2^64
+ *          up are written as %g
+ */
+static int
+fmtfixed(char *s, double v, int decimals) {
+union { double d; uint64_t u; } x;
+uint32_t w[4] = { 0, 0, 0, 0 };             // fraction, binary point at bit 124
+uint64_t f,ip,t;
+int be,e,sh,i,j,neg,up;
+unsigned sticky = 0;
+char tmp[20];
+char *p = s;
+char *q,*r;
+
+    x.d = v;
+    neg = x.u>>63;
+    be  = (int) (x.u>>52)&0x7FF;
+    f   = x.u&0x000FFFFFFFFFFFFFULL;
+    if( be == 0x7FF )
+        return fmtspecial(s,neg,f != 0);
+    if( be == 0 ) {
+        e = -1074;
+    } else {
+        e = be-1075;
+        f |= 1ULL<<52;
+    }
+    if( e > 11 )                            // 2^64 or more
+        return fmtdouble(s,v);
+    if( decimals > MINIPRINTF_MAXDECIMALS )
+        decimals = MINIPRINTF_MAXDECIMALS;
+
+    if( e >= 0 ) {
+        ip = f<<e;
+    } else if( e > -64 ) {
+        ip = f>>-e;
+        f &= (1ULL<<-e)-1;
+    } else {
+        ip = 0;
+    }
+    if( e < 0 ) {
+        // Fraction is f*2^e, aligned to bit 124 of w
+        sh = 124+e;
+        if( sh < 0 ) {
+            if( sh <= -64 ) {
+                sticky = f != 0;
+                f = 0;
+            } else {
+                sticky = (f&((1ULL<<-sh)-1)) != 0;
+                f >>= -sh;
+            }
+            sh = 0;
+        }
+        for(j=sh/32;j<4 && f;j++) {
+            i = sh%32;
+            w[j] |= (uint32_t) (f<<i);
+            f = (i == 0) ? f>>32 : f>>(32-i);
+            sh = (j+1)*32;
+        }
+    }
+
+    if( neg )
+        *p++ = '-';
+    q = p;
+    r = fmtu64(tmp+sizeof(tmp),ip);
+    while( r < tmp+sizeof(tmp) ) *p++ = *r++;
+    if( decimals > 0 )
+        *p++ = '.';
+    for(i=0;i<decimals;i++) {
+        t = 0;
+        for(j=0;j<4;j++) {
+            t += (uint64_t) w[j]*10;
+            w[j] = (uint32_t) t;
+            t >>= 32;
+        }
+        *p++ = '0'+(w[3]>>28);
+        w[3] &= 0x0FFFFFFF;
+    }
+
+    // Rest against one half: 0x08000000 in w[3]
+    if( w[3] != 0x08000000 )
+        up = w[3] > 0x08000000;
+    else if( w[2] || w[1] || w[0] || sticky )
+        up = 1;
+    else
+        up = ((decimals > 0) ? p[-1]-'0' : (int) (ip&1))&1;
+    if( up ) {
+        for(i=p-q-1;i>=0;i--) {
+            if( q[i] == '.' )
+                continue;
+            if( q[i] != '9' ) {
+                q[i]++;
+                break;
+            }
+            q[i] = '0';
+        }
+        if( i < 0 ) {                       // 99.9 to 100.0
+            for(j=p-q;j>0;j--) q[j] = q[j-1];
+            q[0] = '1';
+            p++;
+        }
+    }
+    return p-s;
+}
 #endif
-        putchar(k+'0');
-        d /= 10;
-    };
 
-    putchar(n+'0');
+/**
+ * @brief   Output field with padding
+ *
+ * @note    Zero padding is inserted after the sign
+ */
+static void
+outfield(OUTBUF *o, const char *s, int n, int width, int left, char pad) {
+int fill = width-n;
+
+    if( (pad == '0') && (n > 0) && (*s == '-') ) {
+        outchar(o,*s++);
+        n--;
+    }
+    if( !left ) while( fill-- > 0 ) outchar(o,pad);
+    outblock(o,s,n);
+    if( left ) while( fill-- > 0 ) outchar(o,' ');
 }
 
-int
-miniprintf(const char *fmt, ... ) {
-va_list ap;
-int n;
-char ch;
+/**
+ * @brief   Formatting engine
+ *
+ * @note    Format is %[-][0][width][.precision][h|l|ll]conv with conv one of
+ *          d i u x X c s b f g %
+ */
+static void
+format(OUTBUF *o, const char *fmt, va_list ap) {
+char tmp[66];                               // 64 bits in binary + sign
+char *end = tmp+sizeof(tmp);
 char *p;
+char ch;
+int width,left,size,prec;
+char pad;
+uint64_t u;
+int64_t  v;
 
-    va_start(ap,fmt);
     while( (ch = *fmt++) != 0 ) {
         if( ch != '%' ) {
-            putchar(ch);
-            if ( ch == '\n' ) putchar('\r');
-        } else {
+            outchar(o,ch);
+            if( (ch == '\n') && o->crlf ) outchar(o,'\r');
+            continue;
+        }
+        left  = 0;
+        pad   = ' ';
+        width = 0;
+        size  = 0;
+        for(;;) {
             ch = *fmt++;
-            switch(ch) {
-            case '%':
-                putchar('%');
-                break;
-            case 'i':
-            case 'd':
-                n = va_arg(ap,int);
-                printint(n);
-                break;
-            case 'u':
-                n = va_arg(ap,int);
-                printuint(n);
-                break;
-            case 'x':
-                n = va_arg(ap,unsigned int);
-                printhex(n,'a');
-                break;
-            case 'X':
-                n = va_arg(ap,unsigned int);
-                printhex(n,'A');
-                break;
-            case 'c':
-                n = va_arg(ap,int);
-                putchar(n);
-                break;
-            case 's':
-                p = va_arg(ap,char *);
-                while (*p) putchar(*p++);
-                break;
-            case 'b':
-                n = va_arg(ap,unsigned int);
-                printbit(n,sizeof(int)*8);
-                break;
-            default:
-                putchar(ch);
-                break;
+            if( ch == '-' )      left = 1;
+            else if( ch == '0' ) pad = '0';
+            else break;
+        }
+        if( left ) pad = ' ';
+        while( (ch >= '0') && (ch <= '9') ) {
+            width = width*10+ch-'0';
+            ch = *fmt++;
+        }
+        prec = -1;
+        if( ch == '.' ) {
+            prec = 0;
+            ch = *fmt++;
+            while( (ch >= '0') && (ch <= '9') ) {
+                prec = prec*10+ch-'0';
+                ch = *fmt++;
             }
         }
+        while( ch == 'l' ) {
+            size++;
+            ch = *fmt++;
+        }
+        if( ch == 'h' ) {                   // short is promoted to int
+            size = -1;
+            ch = *fmt++;
+        }
+
+        switch(ch) {
+        case 'i':
+        case 'd':
+            if( size >= 2 )
+                v = va_arg(ap,long long);
+            else if( size == 1 )
+                v = va_arg(ap,long);
+            else
+                v = va_arg(ap,int);
+            if( v < 0 ) {
+                p = (v >= -0x7FFFFFFFLL-1) ? fmtu32(end,-(uint32_t) v)
+                                           : fmtu64(end,-(uint64_t) v);
+                *--p = '-';
+            } else {
+                p = (v <= 0xFFFFFFFFLL) ? fmtu32(end,(uint32_t) v) : fmtu64(end,v);
+            }
+            outfield(o,p,end-p,width,left,pad);
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'b':
+            if( size >= 2 )
+                u = va_arg(ap,unsigned long long);
+            else if( size == 1 )
+                u = va_arg(ap,unsigned long);
+            else
+                u = va_arg(ap,unsigned);
+            if( ch == 'u' )
+                p = (u <= 0xFFFFFFFFU) ? fmtu32(end,(uint32_t) u) : fmtu64(end,u);
+            else if( ch == 'x' )
+                p = fmthex(end,u,hexlower);
+            else if( ch == 'X' )
+                p = fmthex(end,u,hexupper);
+            else
+                p = fmtbin(end,u);
+            outfield(o,p,end-p,width,left,pad);
+            break;
+#ifndef MINIPRINTF_NOFLOAT
+        case 'f':
+            size = fmtfixed(tmp,va_arg(ap,double),(prec < 0) ? 6 : prec);
+            outfield(o,tmp,size,width,left,pad);
+            break;
+        case 'g':
+            if( size < 0 )
+                size = fmtfloat(tmp,(float) va_arg(ap,double));
+            else
+                size = fmtdouble(tmp,va_arg(ap,double));
+            outfield(o,tmp,size,width,left,pad);
+            break;
+#endif
+        case 'c':
+            tmp[0] = va_arg(ap,int);
+            outfield(o,tmp,1,width,left,' ');
+            break;
+        case 's':
+            p = va_arg(ap,char *);
+            for(size=0;p[size];size++) {}
+            outfield(o,p,size,width,left,' ');
+            break;
+        case 0:
+            return;
+        default:
+            outchar(o,ch);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief   stdout buffer
+ */
+///@{
+static char outbuf[MINISTDIO_OUTBUFSIZE];
+static OUTBUF out = { outbuf, sizeof(outbuf), 0, 0, 1, 1, 0 };
+static int outmode = _IOLBF;
+///@}
+
+/**
+ * @brief   Flush stdout at the end of a call according to the mode
+ */
+static void
+outsync(void) {
+
+    if( (outmode == _IONBF) || ((outmode == _IOLBF) && out.newline) )
+        outflush(&out);
+}
+
+int
+miniprintf(const char *fmt, ... ) {
+va_list ap;
+char buf[MINIPRINTF_BUFSIZE];
+OUTBUF o = { buf, sizeof(buf), 0, 0, 1, 1, 0 };
 
+    va_start(ap,fmt);
+    if( outmode == _IONBF ) {
+        format(&o,fmt,ap);
+        outflush(&o);
+    } else {
+        out.count = 0;
+        format(&out,fmt,ap);
+        outsync();
+        o.count = out.count;
     }
     va_end(ap);
-    return 1;
+    return o.count;
+}
+
+/**
+ * @brief   fflush
+ *
+ * @note    Sends the contents of the stdout buffer
+ */
+int
+minifflush(void *ignored) {
+
+    outflush(&out);
+    return 0;
+}
+
+/**
+ * @brief   setvbuf
+ *
+ * @note    Selects the buffering mode of stdout (_IOFBF, _IOLBF or _IONBF). When
+ *          buf is not null, it replaces the internal buffer (size chars).
+ *          Pending output is sent first
+ */
+int
+minisetvbuf(void *ignored, char *buf, int mode, int size) {
+
+    if( (mode != _IOFBF) && (mode != _IOLBF) && (mode != _IONBF) )
+        return -1;
+    outflush(&out);
+    if( buf && (size > 0) ) {
+        out.buf  = buf;
+        out.size = size;
+    } else {
+        out.buf  = outbuf;
+        out.size = sizeof(outbuf);
+    }
+    outmode = mode;
+    return 0;
+}
+
+/**
+ * @brief   vsnprintf
+ *
+ * @note    Writes at most n chars into s including the ending 0
+ *
+ * @note    Returns the number of chars of the full output (as standard vsnprintf)
+ */
+int
+minivsnprintf(char *s, int n, const char *fmt, va_list ap) {
+OUTBUF o = { s, n-1, 0, 0, 0, 0, 0 };
+
+    if( n <= 0 )
+        o.size = o.pos = 0;
+    format(&o,fmt,ap);
+    if( n > 0 )
+        s[o.pos] = 0;
+    return o.count;
+}
+
+int
+minisnprintf(char *s, int n, const char *fmt, ...) {
+va_list ap;
+int cnt;
+
+    va_start(ap,fmt);
+    cnt = minivsnprintf(s,n,fmt,ap);
+    va_end(ap);
+    return cnt;
 }
 
 int
 miniputs(const char *s) {
 
-    while( *s ) putchar(*s++);
+    while( *s ) outchar(&out,*s++);
+    outsync();
     return 1;
 }
 
 int
 minifputs(const char *s, void *ignored ) {
 
-    while( *s ) putchar(*s++);
+    while( *s ) outchar(&out,*s++);
+    outsync();
     return 1;
 }
 
@@ -197,6 +947,7 @@ minifgets(char *s, int n, void *ignored) {
 char *p = s;
 int c;
 
+    outflush(&out); // prompt must be visible
     n--; // make space for ending 0
     while( ((c=getchar()) != CR) && (c!=LF) ) {
         if( (c==BS) || (c==DEL) ) {
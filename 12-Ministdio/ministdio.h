@@ -15,21 +15,39 @@
  */
 
 #define printf          miniprintf
+#define snprintf        minisnprintf
+#define vsnprintf       minivsnprintf
 #define puts            miniputs
 #define fputs           minifputs
 #define fgets           minifgets
 #define getchar         minigetchar
 #define putchar         miniputchar
+#define fflush          minifflush
+#define setvbuf         minisetvbuf
+
+#include <stdarg.h>
 
 int printf(const char *fmt, ...);
+int snprintf(char *s, int n, const char *fmt, ...);
+int vsnprintf(char *s, int n, const char *fmt, va_list ap);
+int miniwrite(const char *s, int n);
 int puts(const char *s);
 int fputs(const char *s, void *ignored);
 char *fgets(char *s, int n, void *ignored);
+int fflush(void *ignored);
+int setvbuf(void *ignored, char *buf, int mode, int size);
 
 #define stdin  0
 #define stdout 0
 #define stderr 0
 
+/*
+ * Buffering modes of stdout (setvbuf)
+ */
+#define _IOFBF 0                            /* full buffering */
+#define _IOLBF 1                            /* line buffering (default) */
+#define _IONBF 2                            /* no buffering */
+
 
 
 #endif
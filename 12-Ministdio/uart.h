@@ -149,6 +149,7 @@ int UART_Init(int uartn, unsigned config);
 int UART_InitExt(int uartn, unsigned config, FIFO in, FIFO out);
 int UART_WriteChar(int uartn, unsigned c);
 int UART_WriteString(int uartn, char s[]);
+int UART_Write(int uartn, const char *s, int n);
 
 int UART_ReadChar(int uartn);
 int UART_ReadCharNoWait(int uartn);
@@ -402,6 +402,37 @@ USART_TypeDef *uart;
     return 0;
 }
 
+/**
+ ** @brief UART Send a block of chars
+ **
+ ** @note  With the output fifo, the chars are inserted with the TX interrupts
+ **        disabled and they are enabled once for the block. It waits while
+ **        the fifo is full. Without it, it uses UART_WriteChar
+ **
+ **/
+int
+UART_Write(int uartn, const char *s, int n) {
+USART_TypeDef *uart;
+FIFO f;
+int i = 0;
+
+    if( uartn >= uarttabsize ) return -1;
+
+    if( !uarttab[uartn].conf.useoutputfifo ) {
+        while( i < n ) UART_WriteChar(uartn,s[i++]);
+        return n;
+    }
+    uart = uarttab[uartn].device;
+    f = uarttab[uartn].outputfifo;
+    while( i < n ) {
+        while( fifo_full(f) ) {}
+        uart->CR1 &= ~(USART_CR1_TCIE|USART_CR1_TXEIE);
+        while( i < n && fifo_insert(f,s[i]) == 0 ) i++;
+        uart->CR1 |= (USART_CR1_TCIE|USART_CR1_TXEIE);
+    }
+    return n;
+}
+
 /**
  ** @brief UART Send a string
  **
@@ -0,0 +1,894 @@
+/**
+ * @file     conv.c
+ * @brief    itoa, utoa and itoh conversion routines and their inverses,
+ *           floating point and fixed point formatting
+ * @version  V1.0
+ * @date     23/01/2016
+ *
+ **/
+
+
+#include <stdint.h>
+#include "conversions.h"
+
+
+/***************************************************************************
+ *                                                                         *
+ *              Conversion routines                                        *
+ *                                                                         *
+ ***************************************************************************/
+
+ /**
+ * @brief Pairs of decimal digits
+ *
+ * @note  Used to convert two digits in each step
+ */
+static const char digits2[200] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/**
+ * @brief Divide by 100 using multiplication by reciprocal
+ *
+ * @note  Exact for all 32 bit values
+ */
+static inline uint32_t div100(uint32_t n) {
+    return (uint32_t) (((uint64_t) n*0x51EB851FU)>>37);
+}
+
+/**
+ * @brief Number of decimal digits
+ */
+static int
+countdigits(uint32_t x) {
+int n = 1;
+
+    while( x >= 100 ) {
+        x = div100(x);
+        n += 2;
+    }
+    if( x >= 10 )
+        n++;
+    return n;
+}
+
+/**
+ * @brief Write decimal digits backwards ending at p
+ */
+static void
+writedigits(char *p, uint32_t x) {
+uint32_t q;
+unsigned r;
+
+    while( x >= 100 ) {
+        q = div100(x);
+        r = (x-q*100)*2;
+        x = q;
+        *--p = digits2[r+1];
+        *--p = digits2[r];
+    }
+    if( x >= 10 ) {
+        *--p = digits2[x*2+1];
+        *--p = digits2[x*2];
+    } else {
+        *--p = x+'0';
+    }
+}
+
+ /**
+ * @brief itoa
+ *
+ * @note  Converts an signed integer to an decimal ASCII string with signal
+ * @note  Assumes 32 bit integer
+ *
+ */
+
+void
+IntToString(int v, char *s) {
+uint32_t x;
+
+    x = v;
+    if( v < 0 ) {
+        x = -x;
+        *s++ = '-';
+    }
+    UnsignedToString(x,s);
+    return;
+}
+
+/**
+ * @brief utoa
+ *
+ * @note  Converts an unsigned integer to an decimal ASCII string
+ * @note  Assumes 32 bit integer
+ *
+ * @note  Converts two digits in each step using a table and division by 100 is
+ *        done by multiplication
+ *
+ */
+
+void
+UnsignedToString(unsigned x, char *s) {
+int n;
+
+    n = countdigits(x);
+    s[n] = '\0';
+    writedigits(s+n,x);
+    return;
+}
+
+/**
+ * @brief itohex
+ *
+ * @note  Converts an integer to an hexadecimal ASCII string
+ * @note  Assumes 32 bit integer
+ *
+ */
+//@{
+static const char tohex[] = "0123456789ABCDEF";
+
+void
+IntToHexString(unsigned x, char *s) {
+int n = sizeof(unsigned)*8;
+
+    do {
+        n -= 4;
+        *s++ = tohex[(x>>n)&0xF];
+    } while ( n > 0 );
+    *s = '\0';
+
+    return;
+}
+
+//@}
+
+/***************************************************************************
+ *                                                                         *
+ *              Parsing routines                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+/**
+ * @brief Powers of 10
+ */
+static const uint32_t pow10[10] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+/**
+ * @brief SWAR (SIMD within a register) on four ASCII characters
+ *
+ * @note  The first character is in the low byte (little endian load).
+ *        ALLDIGITS is true when the four are '0' to '9': a byte below '0' sets
+ *        its bit 7 in W-'0' and a byte above '9' sets it in W+(0x80-':'). A
+ *        borrow or carry between bytes only happens when a byte is already
+ *        rejected
+ *
+ * @note  digits4 converts four digits with two multiplications: the first
+ *        gives the pairs (d0*10+d1 and d2*10+d3) in bytes 0 and 2, the second
+ *        combines the pairs
+ */
+///@{
+#define ALLDIGITS(W)    (((((W)-0x30303030U)|((W)+0x46464646U))&0x80808080U) == 0)
+
+static inline uint32_t digits4(uint32_t w) {
+
+    w -= 0x30303030U;
+    w  = (w*10+(w>>8))&0x00FF00FFU;
+    return (w*100+(w>>16))&0xFFFFU;
+}
+///@}
+
+/**
+ * @brief Skip blanks
+ */
+static const char *
+skipblanks(const char *p) {
+
+    while( *p == ' ' || *p == '\t' )
+        p++;
+    return p;
+}
+
+/**
+ * @brief Parse decimal digits
+ *
+ * @note  Sets *n to the number of digits and returns the end. *value is the
+ *        value, greater than 0xFFFFFFFF on overflow
+ *
+ * @note  After the bytes up to a word boundary, the digits are taken 8 at a
+ *        time (two words) and then 4 at a time. The loads are word aligned, so
+ *        they do not cross into the next word: when a word holds the end of
+ *        the string, it is not read beyond it
+ */
+static const char *
+parsedigits(const char *p, uint64_t *value, int *n) {
+const char *start = p;
+uint64_t acc = 0;
+uint32_t w0,w1;
+
+    while( ((uint32_t) p&3) != 0 && (unsigned) (*p-'0') <= 9 )
+        acc = acc*10+(*p++-'0');
+    if( ((uint32_t) p&3) == 0 ) {
+        while( acc <= 0xFFFFFFFFU ) {
+            w0 = *(const uint32_t *) p;
+            if( !ALLDIGITS(w0) )
+                break;
+            w1 = *(const uint32_t *) (p+4);
+            if( ALLDIGITS(w1) ) {
+                acc = acc*100000000+digits4(w0)*10000+digits4(w1);
+                p += 8;
+            } else {
+                acc = acc*10000+digits4(w0);
+                p += 4;
+                break;
+            }
+        }
+        while( acc <= 0xFFFFFFFFU && (unsigned) (*p-'0') <= 9 )
+            acc = acc*10+(*p++-'0');
+    }
+    // Digits left after an overflow are used
+    while( (unsigned) (*p-'0') <= 9 )
+        p++;
+    *value = acc;
+    *n = p-start;
+    return p;
+}
+
+/**
+ * @brief atou
+ *
+ * @note  Parses an unsigned decimal number after optional blanks. The
+ *        conversion uses SWAR, 8 digits in two words (see parsedigits)
+ */
+int
+StringToUnsigned(const char *s, unsigned *v) {
+const char *p;
+uint64_t x;
+int n;
+
+    p = parsedigits(skipblanks(s),&x,&n);
+    if( n == 0 )
+        return CONV_ERROR_SYNTAX;
+    if( x > 0xFFFFFFFFU )
+        return CONV_ERROR_OVERFLOW;
+    *v = (unsigned) x;
+    return p-s;
+}
+
+/**
+ * @brief atoi
+ *
+ * @note  Parses a signed decimal number (-2147483648 to 2147483647) after
+ *        optional blanks
+ */
+int
+StringToInt(const char *s, int *v) {
+const char *p;
+uint64_t x;
+int n,neg = 0;
+
+    p = skipblanks(s);
+    if( *p == '-' || *p == '+' )
+        neg = *p++ == '-';
+    p = parsedigits(p,&x,&n);
+    if( n == 0 )
+        return CONV_ERROR_SYNTAX;
+    if( x > 0x7FFFFFFFU+(unsigned) neg )
+        return CONV_ERROR_OVERFLOW;
+    *v = neg ? (int) (0U-(uint32_t) x) : (int) x;
+    return p-s;
+}
+
+/**
+ * @brief htou
+ *
+ * @note  Parses an hexadecimal number, with an optional 0x prefix, after
+ *        optional blanks. Upper or lower case
+ */
+int
+HexStringToUnsigned(const char *s, unsigned *v) {
+const char *p, *start;
+uint32_t x = 0;
+unsigned d;
+
+    p = skipblanks(s);
+    if( p[0] == '0' && (p[1]|0x20) == 'x' )
+        p += 2;
+    // Leading zeros do not count for the overflow
+    while( *p == '0' && ((unsigned) (p[1]-'0') <= 9 || (unsigned) ((p[1]|0x20)-'a') <= 5) )
+        p++;
+    start = p;
+    for(;;) {
+        d = *p-'0';
+        if( d > 9 ) {
+            d = (*p|0x20)-'a';
+            if( d > 5 )
+                break;
+            d += 10;
+        }
+        if( p-start == 8 )
+            return CONV_ERROR_OVERFLOW;
+        x = (x<<4)|d;
+        p++;
+    }
+    if( p == start )
+        return CONV_ERROR_SYNTAX;
+    *v = x;
+    return p-s;
+}
+
+/**
+ * @brief atof for fixed point
+ *
+ * @note  Parses a signed decimal number with optional fraction ("-12.345",
+ *        "7", ".5") into a value scaled by 10^frac (frac from 0 to 9): with
+ *        frac=3, "-12.345" gives -12345. Digits beyond frac are rounded (half
+ *        away from zero)
+ */
+int
+StringToFixed(const char *s, int frac, int32_t *v) {
+const char *p;
+uint64_t ipart,x;
+uint32_t fpart = 0;
+int n,nf = 0,neg = 0;
+
+    if( frac < 0 || frac > 9 )
+        return CONV_ERROR_SYNTAX;
+    p = skipblanks(s);
+    if( *p == '-' || *p == '+' )
+        neg = *p++ == '-';
+    p = parsedigits(p,&ipart,&n);
+    if( *p == '.' ) {
+        p++;
+        while( nf < frac && (unsigned) (*p-'0') <= 9 ) {
+            fpart = fpart*10+(*p++-'0');
+            nf++;
+        }
+        fpart *= pow10[frac-nf];
+        if( (unsigned) (*p-'0') <= 9 ) {
+            fpart += *p >= '5';
+            nf++;
+        }
+        while( (unsigned) (*p-'0') <= 9 )
+            p++;
+    }
+    if( n == 0 && nf == 0 )
+        return CONV_ERROR_SYNTAX;
+    if( ipart > 0xFFFFFFFFU )
+        return CONV_ERROR_OVERFLOW;
+    x = ipart*pow10[frac]+fpart;
+    if( x > 0x7FFFFFFFU+(unsigned) neg )
+        return CONV_ERROR_OVERFLOW;
+    *v = neg ? (int32_t) (0U-(uint32_t) x) : (int32_t) x;
+    return p-s;
+}
+
+/***************************************************************************
+ *                                                                         *
+ *              Floating point formatting                                  *
+ *                                                                         *
+ ***************************************************************************/
+
+/**
+ * @brief Powers of 10 (64 bits)
+ */
+static const uint64_t pow10l[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL,
+    1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+    1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+    1000000000000000000ULL, 10000000000000000000ULL
+};
+
+/**
+ * @brief Cached powers of 10 for Grisu
+ *
+ * @note  10^k = cachedf[i]*2^cachede[i] for k = -348+8*i, with cachedf
+ *        normalized (bit 63 set) and rounded
+ */
+///@{
+static const uint64_t cachedf[87] = {
+    0xFA8FD5A0081C0288ULL, 0xBAAEE17FA23EBF76ULL, 0x8B16FB203055AC76ULL,
+    0xCF42894A5DCE35EAULL, 0x9A6BB0AA55653B2DULL, 0xE61ACF033D1A45DFULL,
+    0xAB70FE17C79AC6CAULL, 0xFF77B1FCBEBCDC4FULL, 0xBE5691EF416BD60CULL,
+    0x8DD01FAD907FFC3CULL, 0xD3515C2831559A83ULL, 0x9D71AC8FADA6C9B5ULL,
+    0xEA9C227723EE8BCBULL, 0xAECC49914078536DULL, 0x823C12795DB6CE57ULL,
+    0xC21094364DFB5637ULL, 0x9096EA6F3848984FULL, 0xD77485CB25823AC7ULL,
+    0xA086CFCD97BF97F4ULL, 0xEF340A98172AACE5ULL, 0xB23867FB2A35B28EULL,
+    0x84C8D4DFD2C63F3BULL, 0xC5DD44271AD3CDBAULL, 0x936B9FCEBB25C996ULL,
+    0xDBAC6C247D62A584ULL, 0xA3AB66580D5FDAF6ULL, 0xF3E2F893DEC3F126ULL,
+    0xB5B5ADA8AAFF80B8ULL, 0x87625F056C7C4A8BULL, 0xC9BCFF6034C13053ULL,
+    0x964E858C91BA2655ULL, 0xDFF9772470297EBDULL, 0xA6DFBD9FB8E5B88FULL,
+    0xF8A95FCF88747D94ULL, 0xB94470938FA89BCFULL, 0x8A08F0F8BF0F156BULL,
+    0xCDB02555653131B6ULL, 0x993FE2C6D07B7FACULL, 0xE45C10C42A2B3B06ULL,
+    0xAA242499697392D3ULL, 0xFD87B5F28300CA0EULL, 0xBCE5086492111AEBULL,
+    0x8CBCCC096F5088CCULL, 0xD1B71758E219652CULL, 0x9C40000000000000ULL,
+    0xE8D4A51000000000ULL, 0xAD78EBC5AC620000ULL, 0x813F3978F8940984ULL,
+    0xC097CE7BC90715B3ULL, 0x8F7E32CE7BEA5C70ULL, 0xD5D238A4ABE98068ULL,
+    0x9F4F2726179A2245ULL, 0xED63A231D4C4FB27ULL, 0xB0DE65388CC8ADA8ULL,
+    0x83C7088E1AAB65DBULL, 0xC45D1DF942711D9AULL, 0x924D692CA61BE758ULL,
+    0xDA01EE641A708DEAULL, 0xA26DA3999AEF774AULL, 0xF209787BB47D6B85ULL,
+    0xB454E4A179DD1877ULL, 0x865B86925B9BC5C2ULL, 0xC83553C5C8965D3DULL,
+    0x952AB45CFA97A0B3ULL, 0xDE469FBD99A05FE3ULL, 0xA59BC234DB398C25ULL,
+    0xF6C69A72A3989F5CULL, 0xB7DCBF5354E9BECEULL, 0x88FCF317F22241E2ULL,
+    0xCC20CE9BD35C78A5ULL, 0x98165AF37B2153DFULL, 0xE2A0B5DC971F303AULL,
+    0xA8D9D1535CE3B396ULL, 0xFB9B7CD9A4A7443CULL, 0xBB764C4CA7A44410ULL,
+    0x8BAB8EEFB6409C1AULL, 0xD01FEF10A657842CULL, 0x9B10A4E5E9913129ULL,
+    0xE7109BFBA19C0C9DULL, 0xAC2820D9623BF429ULL, 0x80444B5E7AA7CF85ULL,
+    0xBF21E44003ACDD2DULL, 0x8E679C2F5E44FF8FULL, 0xD433179D9C8CB841ULL,
+    0x9E19DB92B4E31BA9ULL, 0xEB96BF6EBADF77D9ULL, 0xAF87023B9BF0EE6BULL,
+};
+
+static const int16_t cachede[87] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007,  -980,
+     -954,  -927,  -901,  -874,  -847,  -821,  -794,  -768,  -741,  -715,
+     -688,  -661,  -635,  -608,  -582,  -555,  -529,  -502,  -475,  -449,
+     -422,  -396,  -369,  -343,  -316,  -289,  -263,  -236,  -210,  -183,
+     -157,  -130,  -103,   -77,   -50,   -24,     3,    30,    56,    83,
+      109,   136,   162,   189,   216,   242,   269,   295,   322,   348,
+      375,   402,   428,   455,   481,   508,   534,   561,   588,   614,
+      641,   667,   694,   720,   747,   774,   800,   827,   853,   880,
+      907,   933,   960,   986,  1013,  1039,  1066,
+};
+///@}
+
+/**
+ * @brief Floating point number with a 64 bit significand (f*2^e)
+ */
+typedef struct {
+    uint64_t    f;
+    int         e;
+} DiyFp;
+
+/**
+ * @brief Product rounded to 64 bits
+ *
+ * @note  Four 32x32 multiplications, what the Cortex-M7 does in hardware
+ */
+static DiyFp
+diymul(DiyFp x, DiyFp y) {
+DiyFp r;
+uint64_t a = x.f>>32, b = x.f&0xFFFFFFFFU;
+uint64_t c = y.f>>32, d = y.f&0xFFFFFFFFU;
+uint64_t ac = a*c, bc = b*c, ad = a*d, bd = b*d;
+uint64_t t;
+
+    t = (bd>>32)+(ad&0xFFFFFFFFU)+(bc&0xFFFFFFFFU)+(1U<<31);
+    r.f = ac+(ad>>32)+(bc>>32)+(t>>32);
+    r.e = x.e+y.e+64;
+    return r;
+}
+
+static DiyFp
+diynormalize(DiyFp x) {
+int s = __builtin_clzll(x.f);
+
+    x.f <<= s;
+    x.e -= s;
+    return x;
+}
+
+/**
+ * @brief Grisu2 digit generation
+ *
+ * @note  Generates the digits of W (scaled by 10^k) until the number is
+ *        between the boundaries Wm and Wp, so it reads back to the same
+ *        value. The last digit is then moved towards W. The result is the
+ *        shortest in almost all cases (about 0.1% of doubles get one digit
+ *        more) and always exact when read back
+ *
+ * @note  Returns the number of digits. The value is digits*10^*k
+ */
+static int
+digitgen(DiyFp w, DiyFp wp, uint64_t delta, char *digits, int *k) {
+DiyFp one;
+uint64_t wpw,p2,rest,tenkappa;
+uint32_t p1,d;
+int kappa,n = 0;
+
+    one.e = wp.e;
+    one.f = 1ULL<<-one.e;
+    wpw = wp.f-w.f;
+    p1 = (uint32_t) (wp.f>>-one.e);
+    p2 = wp.f&(one.f-1);
+    kappa = countdigits(p1);
+    for(;;) {
+        if( kappa > 0 ) {
+            d = p1/(uint32_t) pow10l[kappa-1];
+            p1 -= d*(uint32_t) pow10l[kappa-1];
+            kappa--;
+            rest = ((uint64_t) p1<<-one.e)+p2;
+            tenkappa = pow10l[kappa]<<-one.e;
+        } else {
+            p2 *= 10;
+            delta *= 10;
+            d = (uint32_t) (p2>>-one.e);
+            p2 &= one.f-1;
+            kappa--;
+            rest = p2;
+            tenkappa = one.f;
+            if( -kappa < 20 )
+                wpw = (wp.f-w.f)*pow10l[-kappa];
+        }
+        if( d || n )
+            digits[n++] = '0'+d;
+        if( rest < delta || (kappa >= 0 && rest == delta) ) {
+            while( rest < wpw && delta-rest >= tenkappa
+                && (rest+tenkappa < wpw || wpw-rest > rest+tenkappa-wpw) ) {
+                digits[n-1]--;
+                rest += tenkappa;
+            }
+            *k += kappa;
+            return n;
+        }
+    }
+}
+
+/**
+ * @brief Grisu2
+ *
+ * @note  The value is f*2^e. The boundaries are the midpoints to the
+ *        neighbour values. When f is a power of 2, the lower neighbour is
+ *        closer (lowercloser)
+ */
+static int
+grisu2(uint64_t f, int e, int lowercloser, char *digits, int *k) {
+DiyFp v,wp,wm,c;
+int i;
+
+    wp.f = (f<<1)+1;
+    wp.e = e-1;
+    wp = diynormalize(wp);
+    if( lowercloser ) {
+        wm.f = (f<<2)-1;
+        wm.e = e-2;
+    } else {
+        wm.f = (f<<1)-1;
+        wm.e = e-1;
+    }
+    wm.f <<= wm.e-wp.e;
+    wm.e = wp.e;
+
+    // Power of 10 that brings the exponent of wp*c to -61..-32
+    i = ((347-(((wp.e+61)*78913)>>18))>>3)+1;
+    c.f = cachedf[i];
+    c.e = cachede[i];
+    *k = 348-i*8;
+
+    v.f = f;
+    v.e = e;
+    v = diymul(diynormalize(v),c);
+    wp = diymul(wp,c);
+    wm = diymul(wm,c);
+    wm.f++;
+    wp.f--;
+    return digitgen(v,wp,wp.f-wm.f,digits,k);
+}
+
+/**
+ * @brief Write NaN and infinities
+ */
+static int
+writespecial(char *s, int neg, int nan) {
+char *p = s;
+
+    if( nan ) {
+        *p++ = 'n'; *p++ = 'a'; *p++ = 'n';
+    } else {
+        if( neg ) *p++ = '-';
+        *p++ = 'i'; *p++ = 'n'; *p++ = 'f';
+    }
+    *p = '\0';
+    return p-s;
+}
+
+/**
+ * @brief Write digits*10^k
+ *
+ * @note  Positional when the decimal exponent is -4 to 16 (as %.17g),
+ *        otherwise with an exponent (1.5e+20). Integers have no decimal point
+ */
+static int
+writeshortest(char *s, int neg, const char *digits, int n, int k) {
+char *p = s;
+int dp = n+k;                               // position of the decimal point
+int i,x;
+
+    if( neg )
+        *p++ = '-';
+    if( dp-1 >= -4 && dp-1 < 17 ) {
+        if( dp <= 0 ) {
+            *p++ = '0';
+            *p++ = '.';
+            for(i=dp;i<0;i++) *p++ = '0';
+            for(i=0;i<n;i++) *p++ = digits[i];
+        } else {
+            for(i=0;i<n||i<dp;i++) {
+                if( i == dp )
+                    *p++ = '.';
+                *p++ = (i < n) ? digits[i] : '0';
+            }
+        }
+    } else {
+        *p++ = digits[0];
+        if( n > 1 ) {
+            *p++ = '.';
+            for(i=1;i<n;i++) *p++ = digits[i];
+        }
+        *p++ = 'e';
+        x = dp-1;
+        if( x < 0 ) {
+            *p++ = '-';
+            x = -x;
+        } else {
+            *p++ = '+';
+        }
+        if( x >= 100 ) {
+            *p++ = '0'+x/100;
+            x %= 100;
+        }
+        *p++ = digits2[x*2];
+        *p++ = digits2[x*2+1];
+    }
+    *p = '\0';
+    return p-s;
+}
+
+/**
+ * @brief Shortest representation of a double
+ *
+ * @note  Writes the fewest digits that read back (strtod) to the same value,
+ *        e.g. 0.1 and not 0.10000000000000001 as %.17g. Uses Grisu2 (integer
+ *        only, no soft float calls)
+ *
+ * @note  s must have CONV_FLOAT_BUFSIZE chars. Returns the length
+ */
+int
+DoubleToString(double v, char *s) {
+union { double d; uint64_t u; } x;
+uint64_t f;
+int be,e,n,k;
+char digits[20];
+
+    x.d = v;
+    be = (int) (x.u>>52)&0x7FF;
+    f  = x.u&0x000FFFFFFFFFFFFFULL;
+    if( be == 0x7FF )
+        return writespecial(s,x.u>>63,f != 0);
+    if( be == 0 && f == 0 ) {
+        digits[0] = '0';
+        return writeshortest(s,x.u>>63,digits,1,0);
+    }
+    if( be == 0 ) {
+        e = -1074;
+    } else {
+        e = be-1075;
+        f |= 1ULL<<52;
+    }
+    n = grisu2(f,e,f == (1ULL<<52) && be > 1,digits,&k);
+    return writeshortest(s,x.u>>63,digits,n,k);
+}
+
+/**
+ * @brief Shortest representation of a float
+ *
+ * @note  As DoubleToString, but the boundaries are the ones of single
+ *        precision, so 0.1f is written as 0.1 and not as 0.10000000149011612
+ */
+int
+FloatToString(float v, char *s) {
+union { float fl; uint32_t u; } x;
+uint32_t f;
+int be,e,n,k;
+char digits[20];
+
+    x.fl = v;
+    be = (int) (x.u>>23)&0xFF;
+    f  = x.u&0x007FFFFFU;
+    if( be == 0xFF )
+        return writespecial(s,x.u>>31,f != 0);
+    if( be == 0 && f == 0 ) {
+        digits[0] = '0';
+        return writeshortest(s,x.u>>31,digits,1,0);
+    }
+    if( be == 0 ) {
+        e = -149;
+    } else {
+        e = be-150;
+        f |= 1U<<23;
+    }
+    n = grisu2(f,e,f == (1U<<23) && be > 1,digits,&k);
+    return writeshortest(s,x.u>>31,digits,n,k);
+}
+
+/**
+ * @brief Write a 64 bit unsigned in decimal
+ *
+ * @note  Pieces of 9 digits, so there are at most two 64 bit divisions
+ */
+static char *
+writeu64(char *p, uint64_t x) {
+char tmp[20];
+char *q = tmp+sizeof(tmp);
+uint64_t d;
+uint32_t r;
+int i;
+
+    while( x > 0xFFFFFFFFU ) {
+        d = x/1000000000U;
+        r = (uint32_t) (x-d*1000000000U);
+        writedigits(q,r);
+        for(i=countdigits(r);i<9;i++) q[-1-i] = '0';
+        q -= 9;
+        x = d;
+    }
+    i = countdigits((uint32_t) x);
+    writedigits(q,(uint32_t) x);
+    q -= i;
+    while( q < tmp+sizeof(tmp) ) *p++ = *q++;
+    return p;
+}
+
+/**
+ * @brief Fixed number of decimals
+ *
+ * @note  Exact: the integer part is taken from the significand with a shift
+ *        and the fraction is kept as a 128 bit fixed point number (four
+ *        words), multiplied by 10 for each decimal. Rounds to nearest, ties to
+ *        even, as printf
+ *
+ * @note  At most CONV_FLOAT_MAXDECIMALS decimals. Values from 2^64 up are
+ *        written as DoubleToString does
+ *
+ * @note  s must have CONV_FLOAT_BUFSIZE chars. Returns the length
+ */
+int
+DoubleToFixedString(double v, int decimals, char *s) {
+union { double d; uint64_t u; } x;
+uint32_t w[4] = { 0, 0, 0, 0 };             // fraction, binary point at bit 124
+uint64_t f,ip,t;
+int be,e,sh,i,j,neg,up;
+unsigned sticky = 0;
+char *p = s;
+char *q;
+
+    x.d = v;
+    neg = x.u>>63;
+    be  = (int) (x.u>>52)&0x7FF;
+    f   = x.u&0x000FFFFFFFFFFFFFULL;
+    if( be == 0x7FF )
+        return writespecial(s,neg,f != 0);
+    if( be == 0 ) {
+        e = -1074;
+    } else {
+        e = be-1075;
+        f |= 1ULL<<52;
+    }
+    if( e > 11 )                            // 2^64 or more
+        return DoubleToString(v,s);
+    if( decimals < 0 )
+        decimals = 0;
+    if( decimals > CONV_FLOAT_MAXDECIMALS )
+        decimals = CONV_FLOAT_MAXDECIMALS;
+
+    if( e >= 0 ) {
+        ip = f<<e;
+    } else if( e > -64 ) {
+        ip = f>>-e;
+        f &= (1ULL<<-e)-1;
+    } else {
+        ip = 0;
+    }
+    if( e < 0 ) {
+        // Fraction is f*2^e, aligned to bit 124 of w
+        sh = 124+e;
+        if( sh < 0 ) {
+            if( sh <= -64 ) {
+                sticky = f != 0;
+                f = 0;
+            } else {
+                sticky = (f&((1ULL<<-sh)-1)) != 0;
+                f >>= -sh;
+            }
+            sh = 0;
+        }
+        for(j=sh/32;j<4 && f;j++) {
+            i = sh%32;
+            w[j] |= (uint32_t) (f<<i);
+            f = (i == 0) ? f>>32 : f>>(32-i);
+            sh = (j+1)*32;
+        }
+    }
+
+    if( neg )
+        *p++ = '-';
+    q = p;
+    p = writeu64(p,ip);
+    if( decimals > 0 )
+        *p++ = '.';
+    for(i=0;i<decimals;i++) {
+        t = 0;
+        for(j=0;j<4;j++) {
+            t += (uint64_t) w[j]*10;
+            w[j] = (uint32_t) t;
+            t >>= 32;
+        }
+        *p++ = '0'+(w[3]>>28);
+        w[3] &= 0x0FFFFFFF;
+    }
+
+    // Rest against one half: 0x08000000 in w[3]
+    if( w[3] != 0x08000000 )
+        up = w[3] > 0x08000000;
+    else if( w[2] || w[1] || w[0] || sticky )
+        up = 1;
+    else
+        up = ((decimals > 0) ? p[-1]-'0' : (int) (ip&1))&1;
+    if( up ) {
+        for(i=p-q-1;i>=0;i--) {
+            if( q[i] == '.' )
+                continue;
+            if( q[i] != '9' ) {
+                q[i]++;
+                break;
+            }
+            q[i] = '0';
+        }
+        if( i < 0 ) {                       // 99.9 to 100.0
+            for(j=p-q;j>0;j--) q[j] = q[j-1];
+            q[0] = '1';
+            p++;
+        }
+    }
+    *p = '\0';
+    return p-s;
+}
+
+/**
+ * @brief Fixed point to string
+ *
+ * @note  v is the value times 10^frac (frac 0 to 9), the format of
+ *        StringToFixed. E.g. -12345 with frac=3 is written as -12.345
+ *
+ * @note  Returns the length
+ */
+int
+FixedToString(int32_t v, int frac, char *s) {
+uint32_t x,ip,fp;
+char *p = s;
+int n;
+
+    if( frac < 0 || frac > 9 )
+        frac = 0;
+    x = v;
+    if( v < 0 ) {
+        x = -x;
+        *p++ = '-';
+    }
+    ip = x/pow10[frac];
+    fp = x-ip*pow10[frac];
+    n = countdigits(ip);
+    writedigits(p+n,ip);
+    p += n;
+    if( frac > 0 ) {
+        *p++ = '.';
+        n = countdigits(fp);
+        while( n < frac ) {
+            *p++ = '0';
+            frac--;
+        }
+        writedigits(p+n,fp);
+        p += n;
+    }
+    *p = '\0';
+    return p-s;
+}
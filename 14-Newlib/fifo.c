@@ -6,22 +6,44 @@
  * @note    It does not use malloc
  * @note    Size must be defined in DECLARE_fifo_AREA and in fifo_init (Ugly)
  * @note    Uses as many dependencies as possible
+ * @note    Lock free when there is only one producer and one consumer, e.g.
+ *          an interrupt routine and the main program
+ * @note    Block operations (fifo_write, fifo_read) copy contiguous spans using memcpy.
+ *          fifo_readspan/fifo_skip and fifo_writespan/fifo_commit give direct access
+ *          to the contiguous spans, e.g., for DMA
  */
 
+#include <string.h>
 #include "fifo.h"
 
+/**
+ * @brief   Compiler barrier
+ *
+ * @note    Data must be written before the counter is updated. The core sees its own
+ *          accesses in order, so, for interrupt routines, it is enough to avoid the
+ *          reordering done by the compiler.
+ */
+#define FIFO_BARRIER()  __asm volatile ("" ::: "memory")
+
 
 /**
  * @brief   initializes a fifo area
+ *
+ * @note    The capacity is the largest power of 2 not larger than n
  */
 
 FIFO
 fifo_init(void *b, int n) {
 FIFO f = (FIFO) b;
+int c;
+
+    c = 1;
+    while( 2*c <= n )
+        c *= 2;
 
-    f->front = f->rear = f->data;
-    f->size = 0;
-    f->capacity = n;
+    f->head = f->tail = 0;
+    f->capacity = c;
+    f->mask = c-1;
     return f;
 }
 
@@ -35,8 +57,7 @@ FIFO f = (FIFO) b;
 void
 fifo_deinit(FIFO f) {
 
-    f->size = 0;
-    f->front = f->rear = f->data;
+    f->tail = f->head;
 
 }
 
@@ -44,12 +65,12 @@ fifo_deinit(FIFO f) {
  * @brief   Clears fifo
  *
  * @note    Does not free area. For now identical to deinit
+ * @note    Must be called by the consumer
  */
  void
  fifo_clear(FIFO f) {
 
-    f->size = 0;
-    f->front = f->rear = f->data;
+    f->tail = f->head;
 
 }
 
@@ -61,14 +82,14 @@ fifo_deinit(FIFO f) {
 
 int
 fifo_insert(FIFO f, char x) {
+unsigned h = f->head;
 
-    if( fifo_full(f) )
+    if( (int) (h-f->tail) >= f->capacity )
         return -1;
 
-    *(f->rear++) = x;
-    f->size++;
-    if( (f->rear - f->data) > f->capacity )
-        f->rear = f->data;
+    f->data[h&f->mask] = x;
+    FIFO_BARRIER();
+    f->head = h+1;
     return 0;
 }
 
@@ -80,14 +101,126 @@ fifo_insert(FIFO f, char x) {
 
 int
 fifo_remove(FIFO f) {
-char ch;
+unsigned t = f->tail;
+unsigned char ch;
 
-    if( fifo_empty(f) )
+    if( t == f->head )
         return -1;
 
-    ch = *(f->front++);
-    f->size--;
-    if( (f->front - f->data) > f->capacity )
-        f->front = f->data;
+    ch = f->data[t&f->mask];
+    FIFO_BARRIER();
+    f->tail = t+1;
     return ch;
 }
+
+/**
+ * @brief   Returns the contiguous span with chars to be read
+ *
+ * @note    Returns the number of chars in span. *p points to first char
+ */
+
+int
+fifo_readspan(FIFO f, char **p) {
+unsigned t = f->tail;
+int n;
+int end;
+
+    n   = f->head-t;
+    end = f->capacity-(t&f->mask);
+    *p = &f->data[t&f->mask];
+    return n<end?n:end;
+}
+
+/**
+ * @brief   Removes n chars from fifo without copying them
+ *
+ * @note    Used after fifo_readspan
+ */
+
+void
+fifo_skip(FIFO f, int n) {
+
+    FIFO_BARRIER();
+    f->tail += n;
+}
+
+/**
+ * @brief   Returns the contiguous free span where chars can be written
+ *
+ * @note    Returns the number of free chars in span. *p points to first position
+ */
+
+int
+fifo_writespan(FIFO f, char **p) {
+unsigned h = f->head;
+int n;
+int end;
+
+    n   = f->capacity-(int) (h-f->tail);
+    end = f->capacity-(h&f->mask);
+    *p = &f->data[h&f->mask];
+    return n<end?n:end;
+}
+
+/**
+ * @brief   Inserts n chars already written in fifo
+ *
+ * @note    Used after fifo_writespan
+ */
+
+void
+fifo_commit(FIFO f, int n) {
+
+    FIFO_BARRIER();
+    f->head += n;
+}
+
+/**
+ * @brief   Insert up to n chars in fifo
+ *
+ * @note    return number of chars inserted
+ */
+
+int
+fifo_write(FIFO f, const char *buf, int n) {
+char *p;
+int cnt = 0;
+int k;
+
+    while( cnt < n ) {
+        k = fifo_writespan(f,&p);
+        if( k == 0 )
+            break;
+        if( k > n-cnt )
+            k = n-cnt;
+        memcpy(p,buf+cnt,k);
+        fifo_commit(f,k);
+        cnt += k;
+    }
+    return cnt;
+}
+
+/**
+ * @brief   Removes up to n chars from fifo
+ *
+ * @note    return number of chars removed
+ */
+
+int
+fifo_read(FIFO f, char *buf, int n) {
+char *p;
+int cnt = 0;
+int k;
+
+    while( cnt < n ) {
+        k = fifo_readspan(f,&p);
+        if( k == 0 )
+            break;
+        if( k > n-cnt )
+            k = n-cnt;
+        memcpy(buf+cnt,p,k);
+        fifo_skip(f,k);
+        cnt += k;
+    }
+    return cnt;
+}
@@ -9,15 +9,19 @@
  *  @brief  Data structure to store info about a fifo, including its data
  *
  * @note    Uses x[0] hack. This structure is a header
- * @note    First element is a pointer to force data alignement
+ * @note    Single producer/single consumer ring. Only the producer changes head and
+ *          only the consumer changes tail. So one side can run in an interrupt routine
+ *          without disabling interrupts
+ * @note    head and tail are free running counters. The position in data is
+ *          obtained masking them with capacity-1, so capacity must be a power of 2
  */
 
 typedef struct fifo_s {
-    char    *front;             // pointer to first char in fifo
-    char    *rear;              // pointer to last char in fifo
-    int     size;               // number of char stored in fifo
-    int     capacity;           // number of chars in data
-    char    data[];             // flexible array
+    volatile unsigned   head;   // counter of chars inserted (changed by producer)
+    volatile unsigned   tail;   // counter of chars removed (changed by consumer)
+    unsigned            mask;   // capacity-1
+    int                 capacity;   // number of chars in data (power of 2)
+    char                data[];     // flexible array
 } FIFO_t;
 
 typedef FIFO_t *FIFO;
@@ -32,9 +36,17 @@ int     fifo_insert(FIFO f, char x);
 int     fifo_remove(FIFO f);
 void    fifo_clear(FIFO f);
 
+int     fifo_write(FIFO f, const char *buf, int n);
+int     fifo_read(FIFO f, char *buf, int n);
+
+int     fifo_readspan(FIFO f, char **p);
+void    fifo_skip(FIFO f, int n);
+int     fifo_writespan(FIFO f, char **p);
+void    fifo_commit(FIFO f, int n);
+
 #define fifo_capacity(F) ((F)->capacity)
-#define fifo_size(F) ((F)->size)
-#define fifo_empty(F) ((F)->size==0)
-#define fifo_full(F) ((F)->size==fifo_capacity(F))
+#define fifo_size(F) ((int) ((F)->head-(F)->tail))
+#define fifo_empty(F) ((F)->head==(F)->tail)
+#define fifo_full(F) (fifo_size(F)==fifo_capacity(F))
 
 #endif
@@ -16,6 +16,12 @@
 #include "system_stm32f746.h"
 #include "led.h"
 #include "uart.h"
+#ifdef FLOAT_FORMAT_TEST
+#include "conversions.h"
+#endif
+#ifdef STDIO_USE_SWO
+#include "swo.h"
+#endif
 
 
 
@@ -104,6 +110,181 @@ uint32_t v;
 }
 ///@}
 
+#ifdef UART_THROUGHPUT_TEST
+/**
+ * @brief   Aggregate throughput of UART_2 to UART_8
+ *
+ * @note    All UARTs are interrupt driven at TESTBAUD. Each one gets as many chars
+ *          as fit in its output fifo and its input fifo is drained, in turn, for
+ *          one second. Without wiring only the transmitted chars are counted. With
+ *          TX connected to RX on each UART (see README.md) the received and lost
+ *          chars are counted too. UART_1 is the console
+ */
+///@{
+#define TESTBAUD    (921600)
+#define TESTSECONDS (10)
+
+static void UARTThroughputTest( void ) {
+static char pattern[UART_FIFOSIZE];
+char buf[UART_FIFOSIZE];
+UART_Counters c;
+unsigned config;
+unsigned rx,tx,lost;
+int i,n,s;
+
+    for(i=0;i<UART_FIFOSIZE;i++)
+        pattern[i] = 'A'+i%26;
+
+    config = UART_NOPARITY|UART_8BITS|UART_STOP_1|UART_BITFIELD(TESTBAUD,12);
+    for(n=UART_2;n<=UART_8;n++) {
+        if( UART_Init(n,config) != 0 )
+            printf("UART_Init(%d) failed\n",n+1);
+    }
+
+    printf("Throughput test with UART_2 to UART_8 at %d bps\n",TESTBAUD);
+    for(s=0;s<TESTSECONDS;s++) {
+        // delay_ms is decremented by SysTick
+        delay_ms = 1000;
+        while( delay_ms ) {
+            for(n=UART_2;n<=UART_8;n++) {
+                UART_WriteNoWait(n,pattern,UART_FIFOSIZE);
+                UART_ReadTimeout(n,buf,UART_FIFOSIZE,0);
+            }
+        }
+        rx = tx = lost = 0;
+        for(n=UART_2;n<=UART_8;n++) {
+            UART_GetCounters(n,&c);
+            rx   += c.rxchars;
+            tx   += c.txchars;
+            lost += c.rxlost;
+        }
+        printf("%2d s: TX %u chars/s RX %u chars/s lost %u\n",s+1,tx/(s+1),rx/(s+1),lost);
+    }
+}
+///@}
+#endif
+
+#ifdef UART_HIGHSPEED_TEST
+/**
+ * @brief   Loopback of USART6 in high speed mode
+ *
+ * @note    USART6 runs at HSBAUD from SYSCLK with DMA and RTS/CTS. TX (PC6) must
+ *          be connected to RX (PC7) and RTS (PG12) to CTS (PG15). A byte counter
+ *          is sent and each received byte is checked against the next expected
+ *          value. Zero loss means no overruns, no lost chars and no wrong bytes
+ */
+///@{
+#define HSBAUD      (6000000)
+#define HSSECONDS   (10)
+#define HSCHUNK     (512)
+
+static void UARTHighSpeedTest( void ) {
+static char pattern[HSCHUNK];
+char buf[HSCHUNK];
+UART_Counters c;
+unsigned char expected = 0;
+unsigned wrong = 0;
+int i,n,s;
+int res;
+
+    for(i=0;i<HSCHUNK;i++)
+        pattern[i] = i;
+
+    UART_SetFIFOSizes(UART_6,2048,1024);
+    res = UART_Init(UART_6,UART_NOPARITY|UART_8BITS|UART_STOP_1|UART_CLOCK_SYSCLK
+                          |UART_BAUD_HS(HSBAUD));
+    if( res != 0 ) {
+        printf("UART_Init(6) failed (%d)\n",res);
+        return;
+    }
+
+    printf("High speed test with USART6 at %d bps\n",HSBAUD);
+    for(s=0;s<HSSECONDS;s++) {
+        // delay_ms is decremented by SysTick
+        delay_ms = 1000;
+        while( delay_ms ) {
+            UART_WriteNoWait(UART_6,pattern,HSCHUNK);
+            n = UART_ReadTimeout(UART_6,buf,HSCHUNK,0);
+            for(i=0;i<n;i++) {
+                if( (unsigned char) buf[i] != expected )
+                    wrong++;
+                expected = (unsigned char) buf[i]+1;
+            }
+        }
+        UART_GetCounters(UART_6,&c);
+        printf("%2d s: RX %u chars/s lost %u overruns %u wrong %u\n",s+1,c.rxchars/(s+1),
+                c.rxlost,c.rxoverruns,wrong);
+    }
+}
+///@}
+#endif
+
+#ifdef FLOAT_FORMAT_TEST
+/**
+ * @brief   Float formatting of conversions.c against newlib
+ *
+ * @note    Average cycles (DWT counter) to format each value of the set with
+ *          three decimals (DoubleToFixedString and %.3f) and with the shortest
+ *          exact representation (DoubleToString and %.17g, the newlib format
+ *          that always reads back to the same value). Each value is printed in
+ *          the four ways to compare them
+ */
+///@{
+#define FLOATREPEAT 20
+
+static const double floatvalues[] = {
+    0.1, -3.14159265358979, 2.5e-5, 123456.789, 1e10, -0.001, 9.81, 1013.25
+};
+#define FLOATCOUNT  (sizeof(floatvalues)/sizeof(floatvalues[0]))
+
+static void FloatFormatTest( void ) {
+char buf[CONV_FLOAT_BUFSIZE];
+char fixed[CONV_FLOAT_BUFSIZE];
+char shortest[CONV_FLOAT_BUFSIZE];
+uint32_t start,convfixed,newlibfixed,convshortest,newlibshortest;
+unsigned i,k;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    start = DWT->CYCCNT;
+    for(k=0;k<FLOATREPEAT;k++)
+        for(i=0;i<FLOATCOUNT;i++)
+            DoubleToFixedString(floatvalues[i],3,buf);
+    convfixed = (DWT->CYCCNT-start)/(FLOATREPEAT*FLOATCOUNT);
+
+    start = DWT->CYCCNT;
+    for(k=0;k<FLOATREPEAT;k++)
+        for(i=0;i<FLOATCOUNT;i++)
+            snprintf(buf,sizeof(buf),"%.3f",floatvalues[i]);
+    newlibfixed = (DWT->CYCCNT-start)/(FLOATREPEAT*FLOATCOUNT);
+
+    start = DWT->CYCCNT;
+    for(k=0;k<FLOATREPEAT;k++)
+        for(i=0;i<FLOATCOUNT;i++)
+            DoubleToString(floatvalues[i],buf);
+    convshortest = (DWT->CYCCNT-start)/(FLOATREPEAT*FLOATCOUNT);
+
+    start = DWT->CYCCNT;
+    for(k=0;k<FLOATREPEAT;k++)
+        for(i=0;i<FLOATCOUNT;i++)
+            snprintf(buf,sizeof(buf),"%.17g",floatvalues[i]);
+    newlibshortest = (DWT->CYCCNT-start)/(FLOATREPEAT*FLOATCOUNT);
+
+    printf("Float formatting (cycles per value)\n");
+    printf("DoubleToFixedString: %6u  %%.3f:   %6u\n",convfixed,newlibfixed);
+    printf("DoubleToString:      %6u  %%.17g:  %6u\n",convshortest,newlibshortest);
+    for(i=0;i<FLOATCOUNT;i++) {
+        DoubleToFixedString(floatvalues[i],3,fixed);
+        DoubleToString(floatvalues[i],shortest);
+        snprintf(buf,sizeof(buf),"%.17g",floatvalues[i]);
+        printf("%-12s %-12.3f %-20s %s\n",fixed,floatvalues[i],shortest,buf);
+    }
+}
+///@}
+#endif
+
 
 /**
  * @brief   main
@@ -123,6 +304,11 @@ uint32_t ramused,flashused;
 
     SysTick_Config(SystemCoreClock/1000);
 
+#ifdef STDIO_USE_SWO
+    /* Enable stimulus ports for stdio, logs, counters and events */
+    SWO_Init(0,0xF);
+#endif
+
     LED_Init();
 
     printf("\n\r\n\r******************************************\n\r");
@@ -179,7 +365,17 @@ uint32_t ramused,flashused;
     v = (uint32_t) ((char *) &_bss_end);
     printf("BSS end:      %x\n",v);
 
+#ifdef UART_THROUGHPUT_TEST
+    UARTThroughputTest();
+#endif
+
+#ifdef UART_HIGHSPEED_TEST
+    UARTHighSpeedTest();
+#endif
 
+#ifdef FLOAT_FORMAT_TEST
+    FloatFormatTest();
+#endif
 
     for(;;) {}
 }
@@ -50,6 +50,9 @@
 
 #include "syscalls.h"
 #include "ttyemul.h"
+#ifdef STDIO_USE_SWO
+#include "swo.h"
+#endif
 
 /// CMSIS functions for microcontroller
 #include "stm32f746xx.h"
@@ -320,9 +323,17 @@ int _wait(int *status) {
  *          example; it relies on a outbyte subroutine (not shown; typically, you must write this
  *          in assembler from examples provided by your hardware manufacturer) to
  *          actually perform the output.
+ *
+ * @note    When STDIO_USE_SWO is defined, output goes to the ITM stimulus port
+ *          SWO_PORT_STDIO instead of the UART.
  */
 
 int _write(int file, char *ptr, int len) {
 
+#ifdef STDIO_USE_SWO
+    /* stdout and stderr thru ITM stimulus port */
+    return SWO_Write(SWO_PORT_STDIO,ptr,len);
+#else
     return tty_write(0,ptr,len);
+#endif
 }
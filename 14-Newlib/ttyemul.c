@@ -37,23 +37,13 @@ int tty_init(int chn) {
 }
 /**
  *  @brief  tty_write
+ *
+ *  @note   Uses the block write of the UART. The LF to CR-LF mapping is done
+ *          while the chars are copied into the output fifo
  */
 int tty_write(int chn, char *ptr, int len) {
-int cnt;
-char ch;
-int i;
 
-    cnt = 0;
-    for (i = 0; i < len; i++) {
-        ch = *ptr++;
-        if( (ch == '\n') && ttyconfig&TTY_OCRLF ) {
-            UART_WriteChar(UART_N,'\r');
-            cnt++;
-        }
-        UART_WriteChar(UART_N,ch);
-        cnt++;
-    }
-    return cnt;
+    return UART_Write(UART_N,ptr,len,(ttyconfig&TTY_OCRLF)?UART_WRITE_CRLF:0);
 }
 
 /**
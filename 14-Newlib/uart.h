@@ -84,10 +84,43 @@
 #define UART_CLOCK_LSE      (0x300)
 ///@}
 
+/**
+ *  @brief  DMA mode (bit 10)
+ *
+ *  @note   RX uses a circular DMA into the input fifo and TX drains the output fifo
+ *          using DMA. Both FIFOs are needed (UART_InitExt)
+ *
+ *  @note   FIFO areas must be in a memory accessible by DMA and not cached (e.g. DTCM)
+ */
+///@{
+#define UART_DMA_M          (0x400)
+#define UART_DMA_P          (10)
+#define UART_DMA            (0x400)
+///@}
+
+/**
+ *  @brief  High speed mode (bit 11)
+ *
+ *  @note   For links of several Mbaud. The baud rate field is in units of 100 baud
+ *          (use UART_BAUD_HS) and the mode implies UART_OVER8, UART_DMA and RTS/CTS
+ *          flow control (see UART_SetFlowControl). The maximum is fCK/8, e.g.,
+ *          27 Mbaud with UART_CLOCK_SYSCLK at 216 MHz
+ *
+ *  @note   The input fifo must hold the chars received between two reads (e.g.,
+ *          4096 chars are 6.8 ms at 6 Mbaud). RTS stops the sender only when RDR
+ *          is not read in time, not when the input fifo is full
+ */
+///@{
+#define UART_HS_M           (0x800)
+#define UART_HS_P           (11)
+#define UART_HIGHSPEED      (0x800)
+#define UART_BAUD_HS(B)     (UART_HIGHSPEED|UART_BITFIELD((B)/100,12))
+///@}
+
 /**
  *  @brief  Baud rate (bit 31-12)
  *
- *  @note   Values up to 2^19-1 = 1048575
+ *  @note   Values up to 2^20-1 = 1048575. In high speed mode, in units of 100
  */
 ///@{
 #define UART_BAUD_M         (0xFFFFF000)
@@ -103,6 +136,9 @@
 #define UART_BAUD_38400     (UART_BITFIELD(38400,12))
 #define UART_BAUD_57600     (UART_BITFIELD(57600,12))
 #define UART_BAUD_115200    (UART_BITFIELD(115200,12))
+#define UART_BAUD_2M        (UART_BAUD_HS(2000000))
+#define UART_BAUD_4M        (UART_BAUD_HS(4000000))
+#define UART_BAUD_6M        (UART_BAUD_HS(6000000))
 //@}
 
 /**
@@ -135,6 +171,19 @@
 
 //@}
 
+/// Flags for UART_Write
+//@{
+#define UART_WRITE_CRLF UART_BIT(0)     ///< Map LF to CR-LF
+///@}
+
+/// Flags for UART_SetFlowControl
+//@{
+#define UART_FLOW_NONE  (0)
+#define UART_FLOW_RTS   UART_BIT(0)     ///< RTS asserted while RDR can receive
+#define UART_FLOW_CTS   UART_BIT(1)     ///< Transmit only while CTS is asserted
+#define UART_FLOW_RTSCTS (UART_FLOW_RTS|UART_FLOW_CTS)
+///@}
+
 /// Symbols returned by GetStatus
 //@{
 #define UART_TXCOMPLETE UART_BIT(6)
@@ -145,15 +194,59 @@
 #define UART_RXPERROR   UART_BIT(0)
 ///@}
 
+/**
+ ** @brief  FIFOs used by UART_Init
+ **
+ ** @note   Each UART has its own input and output FIFOs, allocated from a pool of
+ **         UART_FIFOPOOLSIZE bytes. The default size is UART_FIFOSIZE chars and
+ **         can be changed by UART_SetFIFOSizes before UART_Init
+ **/
+///@{
+#ifndef UART_FIFOPOOLSIZE
+#define UART_FIFOPOOLSIZE   (4096)
+#endif
+#ifndef UART_FIFOSIZE
+#define UART_FIFOSIZE       (64)
+#endif
+///@}
+
+/**
+ ** @brief  UARTs with a specialized driver (see uartfast.h)
+ **
+ ** @note   Bit uartn set means that the interrupt routine of the UART is generated
+ **         by UART_DEFINE and not compiled in uart2.c. Set it in the Makefile,
+ **         e.g. -DUART_FASTMASK=0x02 for UART_2
+ **/
+#ifndef UART_FASTMASK
+#define UART_FASTMASK       (0)
+#endif
+
+/// Counters returned by UART_GetCounters
+typedef struct {
+    unsigned    rxchars;
+    unsigned    txchars;
+    unsigned    rxlost;     ///< overrun or input fifo full
+    unsigned    rxoverruns; ///< overrun (ORE) only
+} UART_Counters;
+
 int UART_Init(int uartn, unsigned config);
 int UART_InitExt(int uartn, unsigned config, FIFO in, FIFO out);
+int UART_SetFIFOSizes(int uartn, int insize, int outsize);
+int UART_SetFlowControl(int uartn, unsigned flags);
 int UART_WriteChar(int uartn, unsigned c);
 int UART_WriteString(int uartn, char s[]);
+int UART_Write(int uartn, const char *buf, int len, unsigned flags);
+int UART_WriteNoWait(int uartn, const char *buf, int len);
 
 int UART_ReadChar(int uartn);
 int UART_ReadCharNoWait(int uartn);
 int UART_ReadString(int uartn, char *s, int n);
+int UART_ReadTimeout(int uartn, char *buf, int n, unsigned timeout);
+int UART_Available(int uartn);
+int UART_SetLineEvent(int uartn, int terminator, void (*callback)(int uartn));
+int UART_GetLineEvent(int uartn);
 int UART_GetStatus(int uartn);
+int UART_GetCounters(int uartn, UART_Counters *c);
 
 int UART_Flush(int uartn);
 
@@ -16,6 +16,7 @@
 #include "gpio.h"
 #include "uart.h"
 #include "fifo.h"
+#include "profile.h"
 
 /**
  ** @brief Bit manipulation macros
@@ -34,6 +35,8 @@ typedef struct {
     USART_TypeDef           *device;
     GPIO_PinConfiguration   txpinconf;
     GPIO_PinConfiguration   rxpinconf;
+    GPIO_PinConfiguration   ctspinconf;
+    GPIO_PinConfiguration   rtspinconf;
     struct {
     unsigned            irqlevel :5;
     unsigned            irqn     :10;
@@ -45,16 +48,39 @@ typedef struct {
     FIFO                    outputfifo;
     char                    inputbuffer;
     char                    outputbuffer;
+    // DMA mode
+    unsigned                usedma;
+    volatile int            txdmacount;     // chars being transmitted by DMA
+    // Line event
+    void                    (*rxcallback)(int uartn);
+    int                     terminator;     // char that signals the event (-1=none)
+    volatile int            lineevent;      // set when terminator is received
+    // FIFO areas used by UART_Init (allocated from fifopool)
+    int                     inputsize;      // requested by UART_SetFIFOSizes (0=default)
+    int                     outputsize;
+    void                    *inputarea;
+    void                    *outputarea;
+    int                     inputareasize;  // size of the allocated areas
+    int                     outputareasize;
+    // Flow control (UART_FLOW_*) set by UART_SetFlowControl
+    unsigned                flowcontrol;
+    // Counters
+    volatile unsigned       rxchars;
+    volatile unsigned       txchars;
+    volatile unsigned       rxlost;
+    volatile unsigned       rxoverruns;
 } UART_Info;
 
-/*
- * Default FIFO area
+/**
+ * @brief   Pool for the FIFO areas of UART_Init
+ *
+ * @note    Each UART gets its own areas. They are never freed. An area is reused
+ *          when the UART is initialized again with a size that fits in it
  */
-#define INPUTAREASIZE    (16)
-#define OUTPUTAREASIZE   (16)
-
-DECLARE_FIFO_AREA(inputarea,INPUTAREASIZE);
-DECLARE_FIFO_AREA(outputarea,OUTPUTAREASIZE);
+///@{
+static unsigned fifopool[UART_FIFOPOOLSIZE/sizeof(unsigned)];
+static unsigned fifopoolused = 0;       // words
+///@}
 
 /**
  * @brief   Interrupt level for UARTs
@@ -65,23 +91,122 @@ DECLARE_FIFO_AREA(outputarea,OUTPUTAREASIZE);
  ** @brief  List of known UARTs
  **
  ** @note   There are pin alternatives for most of UARTs
+ **
+ ** @note   CTS and RTS pins are configured only when flow control is used
  **/
 //@{
 static UART_Info uarttab[] = {
 /* Device          txconfig                            rxconfig                                   */
 /*            Port  Pin AF  M  O  S  P  I   Port  Pin AF  M   O  S  P  I                          */
-{ USART1,   { GPIOA, 9, 7, 2, 1, 1, 0, 0 }, { GPIOB, 7, 7, 2, 1, 1, 0, 0 }, INTLEVEL, USART1_IRQn },
-{ USART2,   { GPIOA, 2, 7, 2, 1, 1, 0, 0 }, { GPIOA, 3, 7, 2, 1, 1, 0, 0 }, INTLEVEL, USART2_IRQn },
-{ USART3,   { GPIOD, 8, 7, 2, 1, 1, 0, 0 }, { GPIOD, 9, 7, 2, 1, 1, 0, 0 }, INTLEVEL, USART3_IRQn },
-{ UART4,    { GPIOC,10, 8, 2, 1, 1, 0, 0 }, { GPIOC,11, 8, 2, 1, 1, 0, 0 }, INTLEVEL, UART4_IRQn  },
-{ UART5,    { GPIOC,12, 7, 2, 1, 1, 0, 0 }, { GPIOD, 2, 8, 2, 1, 1, 0, 0 }, INTLEVEL, UART5_IRQn  },
-{ USART6,   { GPIOC, 6, 8, 2, 1, 1, 0, 0 }, { GPIOC, 7, 8, 2, 1, 1, 0, 0 }, INTLEVEL, USART6_IRQn },
-{ UART7,    { GPIOE, 8, 8, 2, 1, 1, 0, 0 }, { GPIOE, 7, 8, 2, 1, 1, 0, 0 }, INTLEVEL, UART7_IRQn  },
-{ UART8,    { GPIOE, 1, 8, 2, 1, 1, 0, 0 }, { GPIOE, 0, 8, 2, 1, 1, 0, 0 }, INTLEVEL, UART8_IRQn  }
+/*                 ctsconfig                           rtsconfig                                  */
+{ USART1,   { GPIOA, 9, 7, 2, 1, 1, 0, 0 }, { GPIOB, 7, 7, 2, 1, 1, 0, 0 },
+            { GPIOA,11, 7, 2, 1, 1, 0, 0 }, { GPIOA,12, 7, 2, 1, 1, 0, 0 }, INTLEVEL, USART1_IRQn },
+{ USART2,   { GPIOA, 2, 7, 2, 1, 1, 0, 0 }, { GPIOA, 3, 7, 2, 1, 1, 0, 0 },
+            { GPIOA, 0, 7, 2, 1, 1, 0, 0 }, { GPIOA, 1, 7, 2, 1, 1, 0, 0 }, INTLEVEL, USART2_IRQn },
+{ USART3,   { GPIOD, 8, 7, 2, 1, 1, 0, 0 }, { GPIOD, 9, 7, 2, 1, 1, 0, 0 },
+            { GPIOD,11, 7, 2, 1, 1, 0, 0 }, { GPIOD,12, 7, 2, 1, 1, 0, 0 }, INTLEVEL, USART3_IRQn },
+{ UART4,    { GPIOC,10, 8, 2, 1, 1, 0, 0 }, { GPIOC,11, 8, 2, 1, 1, 0, 0 },
+            { GPIOB, 0, 8, 2, 1, 1, 0, 0 }, { GPIOA,15, 8, 2, 1, 1, 0, 0 }, INTLEVEL, UART4_IRQn  },
+{ UART5,    { GPIOC,12, 7, 2, 1, 1, 0, 0 }, { GPIOD, 2, 8, 2, 1, 1, 0, 0 },
+            { GPIOC, 9, 7, 2, 1, 1, 0, 0 }, { GPIOC, 8, 7, 2, 1, 1, 0, 0 }, INTLEVEL, UART5_IRQn  },
+{ USART6,   { GPIOC, 6, 8, 2, 1, 1, 0, 0 }, { GPIOC, 7, 8, 2, 1, 1, 0, 0 },
+            { GPIOG,15, 8, 2, 1, 1, 0, 0 }, { GPIOG,12, 8, 2, 1, 1, 0, 0 }, INTLEVEL, USART6_IRQn },
+{ UART7,    { GPIOE, 8, 8, 2, 1, 1, 0, 0 }, { GPIOE, 7, 8, 2, 1, 1, 0, 0 },
+            { GPIOE,10, 8, 2, 1, 1, 0, 0 }, { GPIOE, 9, 8, 2, 1, 1, 0, 0 }, INTLEVEL, UART7_IRQn  },
+{ UART8,    { GPIOE, 1, 8, 2, 1, 1, 0, 0 }, { GPIOE, 0, 8, 2, 1, 1, 0, 0 },
+            { GPIOD,14, 8, 2, 1, 1, 0, 0 }, { GPIOD,15, 8, 2, 1, 1, 0, 0 }, INTLEVEL, UART8_IRQn  }
+};
+static const int uarttabsize = sizeof(uarttab)/sizeof(UART_Info);
+//@}
+
+/**
+ ** @brief  DMA streams for UARTs
+ **
+ ** @note   From RM0385 DMA1 and DMA2 request mapping tables. Some streams are shared,
+ **         i.e., USART3 TX and UART7 RX, USART3 RX and UART7 TX, USART2 TX and UART8 RX,
+ **         UART5 RX and UART8 TX.
+ **         They can not be used in DMA mode at same time.
+ **/
+typedef struct {
+    DMA_TypeDef             *dma;
+    DMA_Stream_TypeDef      *rxstream;
+    DMA_Stream_TypeDef      *txstream;
+    unsigned                rxchannel;
+    unsigned                txchannel;
+    unsigned                rxsn;           // RX stream number (used for flags)
+    IRQn_Type               rxirqn;
+} UART_DMAInfo;
+
+//@{
+static const UART_DMAInfo uartdmatab[] = {
+/* DMA    RX stream     TX stream     RX ch TX ch RX sn RX IRQ                         */
+{ DMA2, DMA2_Stream2, DMA2_Stream7,   4,    4,    2,    DMA2_Stream2_IRQn },    // USART1
+{ DMA1, DMA1_Stream5, DMA1_Stream6,   4,    4,    5,    DMA1_Stream5_IRQn },    // USART2
+{ DMA1, DMA1_Stream1, DMA1_Stream3,   4,    4,    1,    DMA1_Stream1_IRQn },    // USART3
+{ DMA1, DMA1_Stream2, DMA1_Stream4,   4,    4,    2,    DMA1_Stream2_IRQn },    // UART4
+{ DMA1, DMA1_Stream0, DMA1_Stream7,   4,    4,    0,    DMA1_Stream0_IRQn },    // UART5
+{ DMA2, DMA2_Stream1, DMA2_Stream6,   5,    5,    1,    DMA2_Stream1_IRQn },    // USART6
+{ DMA1, DMA1_Stream3, DMA1_Stream1,   5,    5,    3,    DMA1_Stream3_IRQn },    // UART7
+{ DMA1, DMA1_Stream6, DMA1_Stream0,   5,    5,    6,    DMA1_Stream6_IRQn }     // UART8
 };
-static const int uarttabsize = sizeof(uarttab)/sizeof(UART_Info)-1;
 //@}
 
+/**
+ ** @brief  DMA flags position in LISR/HISR and LIFCR/HIFCR for each stream
+ **/
+static const unsigned dmaflagpos[] = { 0, 6, 16, 22, 0, 6, 16, 22 };
+
+/**
+ ** @brief  DMA stream flags (Shifted to position 0)
+ **/
+//@{
+#define DMA_FLAG_FE                 BIT(0)
+#define DMA_FLAG_DME                BIT(2)
+#define DMA_FLAG_TE                 BIT(3)
+#define DMA_FLAG_HT                 BIT(4)
+#define DMA_FLAG_TC                 BIT(5)
+#define DMA_FLAG_ALL                (DMA_FLAG_FE|DMA_FLAG_DME|DMA_FLAG_TE|DMA_FLAG_HT|DMA_FLAG_TC)
+//@}
+
+/**
+ ** @brief  Interrupt flags cleared at end of interrupt processing
+ **/
+#define UART_ICR_ALL    (USART_ICR_PECF|USART_ICR_FECF|USART_ICR_NCF|USART_ICR_ORECF   \
+                        |USART_ICR_IDLECF|USART_ICR_TCCF|USART_ICR_LBDCF|USART_ICR_CTSCF\
+                        |USART_ICR_RTOCF|USART_ICR_EOBCF|USART_ICR_CMCF)
+
+/**
+ ** @brief  Clear DMA flags of stream sn
+ **/
+static inline void
+DMA_ClearFlags(DMA_TypeDef *dma, unsigned sn, uint32_t flags) {
+
+    if( sn < 4 )
+        dma->LIFCR = flags<<dmaflagpos[sn];
+    else
+        dma->HIFCR = flags<<dmaflagpos[sn];
+}
+
+/**
+ ** @brief  Get DMA flags of stream sn
+ **/
+static inline uint32_t
+DMA_GetFlags(DMA_TypeDef *dma, unsigned sn) {
+uint32_t isr;
+
+    isr = (sn<4)?dma->LISR:dma->HISR;
+    return (isr>>dmaflagpos[sn])&DMA_FLAG_ALL;
+}
+
+/**
+ ** @brief  Stream number of a stream
+ **/
+static inline unsigned
+DMA_StreamNumber(DMA_TypeDef *dma, DMA_Stream_TypeDef *stream) {
+
+    return ((uint32_t) stream-(uint32_t) dma-0x10)/0x18;
+}
+
 /**
  * @brief   Enable clock for UART
  */
@@ -98,6 +223,165 @@ void UART_EnableClock(USART_TypeDef *uart) {
 }
 
 
+/**
+ * @brief   Signal line event when terminator char is received
+ *
+ * @note    Called from interrupt routines
+ */
+static inline void UART_CheckTerminator(int un, int ch) {
+
+    if( ch != uarttab[un].terminator )
+        return;
+    uarttab[un].lineevent = 1;
+    if( uarttab[un].rxcallback )
+        uarttab[un].rxcallback(un);
+}
+
+/**
+ * @brief   Publish chars received by DMA
+ *
+ * @note    The DMA writes in the data area of the input fifo. The number of chars
+ *          written since last call is calculated from NDTR and added to head.
+ *
+ * @note    Called from the IDLE interrupt of the UART and from the half and full
+ *          transfer interrupts of the DMA, so there are never more than capacity/2
+ *          new chars
+ *
+ * @note    The DMA does not stop when the fifo is full. The chars that overwrote
+ *          chars not yet read are counted as lost and dropped by moving tail, so
+ *          the fifo never has more than capacity chars and the reader gets the
+ *          newest ones in order. This is the only place where the producer
+ *          changes tail, so the readers change it with UART_LockInput
+ */
+static void UART_PublishDMAInput(int un) {
+FIFO f = uarttab[un].inputfifo;
+unsigned pos;
+unsigned n;
+int over;
+
+    pos = f->capacity-uartdmatab[un].rxstream->NDTR;
+    n   = (pos-(f->head&f->mask))&f->mask;
+    if( n == 0 )
+        return;
+    uarttab[un].rxchars += n;
+    over = fifo_size(f)+(int) n-f->capacity;
+    if( over > 0 ) {
+        uarttab[un].rxlost += over;
+        f->tail += over;
+    }
+    if( uarttab[un].terminator >= 0 ) {
+        unsigned i;
+        for(i=0;i<n;i++)
+            UART_CheckTerminator(un,(unsigned char) f->data[(f->head+i)&f->mask]);
+    }
+    fifo_commit(f,n);
+}
+
+/**
+ * @brief   Keep UART_PublishDMAInput out while the reader changes tail
+ *
+ * @note    In DMA mode, the interrupt routines of the UART and of the RX stream
+ *          move tail when the ring overflows. A reader interrupted in the middle
+ *          of its tail update would undo that, so both interrupts are disabled
+ *          around it. Other modes only change head in interrupts
+ */
+static inline void UART_LockInput(int un) {
+
+    if( uarttab[un].usedma ) {
+        NVIC_DisableIRQ(uarttab[un].conf.irqn);
+        NVIC_DisableIRQ(uartdmatab[un].rxirqn);
+    }
+}
+
+static inline void UART_UnlockInput(int un) {
+
+    if( uarttab[un].usedma ) {
+        NVIC_EnableIRQ(uartdmatab[un].rxirqn);
+        NVIC_EnableIRQ(uarttab[un].conf.irqn);
+    }
+}
+
+/**
+ * @brief   Start transmission by DMA of the next contiguous span of output fifo
+ *
+ * @note    Called from ProcessInterrupt or with the UART interrupt disabled
+ */
+static void UART_StartDMAOutput(int un) {
+DMA_Stream_TypeDef *stream = uartdmatab[un].txstream;
+USART_TypeDef *uart = uarttab[un].device;
+char *p;
+int n;
+
+    if( uarttab[un].txdmacount )
+        return;
+
+    n = fifo_readspan(uarttab[un].outputfifo,&p);
+    if( n == 0 ) {
+        uart->CR1 &= ~USART_CR1_TCIE;
+        return;
+    }
+
+    /* Data must be in memory before DMA reads it */
+    SCB_CleanDCache_by_Addr((uint32_t *) ((uint32_t) p&~31U),n+((uint32_t) p&31U));
+
+    stream->CR &= ~DMA_SxCR_EN;
+    while( stream->CR&DMA_SxCR_EN ) {}
+    DMA_ClearFlags(uartdmatab[un].dma,DMA_StreamNumber(uartdmatab[un].dma,stream),DMA_FLAG_ALL);
+    stream->M0AR = (uint32_t) p;
+    stream->NDTR = n;
+    uarttab[un].txdmacount = n;
+    uart->ICR = USART_ICR_TCCF;
+    uart->CR1 |= USART_CR1_TCIE;
+    stream->CR |= DMA_SxCR_EN;
+}
+
+/**
+ * @brief   Interrupt processing in DMA mode
+ *
+ * @note    IDLE publishes received chars. TC signals the end of a DMA transmission.
+ *          ORE (enabled by EIE) means that the DMA did not read RDR in time
+ */
+static void ProcessDMAInterrupt(int un) {
+USART_TypeDef  *uart;
+uint32_t isr;
+
+    uart = uarttab[un].device;
+    isr  = uart->ISR;
+
+    if( isr & USART_ISR_ORE ) {
+        uarttab[un].rxoverruns++;
+        uarttab[un].rxlost++;
+    }
+
+    if( isr & USART_ISR_IDLE ) {
+        uart->ICR = USART_ICR_IDLECF;
+        UART_PublishDMAInput(un);
+    }
+    if( (isr & USART_ISR_TC) && (uart->CR1 & USART_CR1_TCIE) ) {
+        uart->ICR = USART_ICR_TCCF;
+        if( uarttab[un].txdmacount ) {
+            uarttab[un].txchars += uarttab[un].txdmacount;
+            fifo_skip(uarttab[un].outputfifo,uarttab[un].txdmacount);
+            uarttab[un].txdmacount = 0;
+        }
+        UART_StartDMAOutput(un);
+    }
+    uart->ICR = UART_ICR_ALL&~USART_ICR_TCCF;
+}
+
+/**
+ * @brief   DMA RX stream interrupt processing
+ *
+ * @note    Half and full transfer
+ */
+static void ProcessDMARXInterrupt(int un) {
+const UART_DMAInfo *d = &uartdmatab[un];
+
+    DMA_ClearFlags(d->dma,d->rxsn,DMA_GetFlags(d->dma,d->rxsn));
+    if( uarttab[un].usedma )
+        UART_PublishDMAInput(un);
+}
+
 /**
  * @brief   Interrupt processing
  *
@@ -106,17 +390,34 @@ void UART_EnableClock(USART_TypeDef *uart) {
 static void ProcessInterrupt(int un) {
 USART_TypeDef  *uart;
 
+    PROFILE_BEGIN(UART_ISR);
+
+    if( uarttab[un].usedma ) {
+        ProcessDMAInterrupt(un);
+        PROFILE_END(UART_ISR);
+        return;
+    }
+
     uart = uarttab[un].device;
 
     /* Receiving  */
+    if( uart->ISR & USART_ISR_ORE ) {   // char lost: RDR not read in time
+        uarttab[un].rxoverruns++;
+        uarttab[un].rxlost++;
+    }
     if( uart->ISR & USART_ISR_RXNE  ) { // RX not empty
+        char ch = uart->RDR;
+        uarttab[un].rxchars++;
         if( uarttab[un].conf.useinputfifo ) {
             /* Multibyte buffer */
-            fifo_insert(uarttab[un].inputfifo,uart->RDR);
+            if( fifo_insert(uarttab[un].inputfifo,ch) < 0 )
+                uarttab[un].rxlost++;
         } else {
             /* Single byte buffer */
-            uarttab[un].inputbuffer = uart->RDR;
+            uarttab[un].inputbuffer = ch;
         }
+        if( uarttab[un].terminator >= 0 )
+            UART_CheckTerminator(un,(unsigned char) ch);
     }
     /* Transmitting */
     if( uart->ISR & (USART_ISR_TC|USART_ISR_TXE)  ) { // TX completed or TX buffer empty
@@ -127,6 +428,7 @@ USART_TypeDef  *uart;
             } else {
                 uart->CR1 |= (USART_CR1_TXEIE|USART_CR1_TCIE);
                 uart->TDR = fifo_remove(uarttab[un].outputfifo);
+                uarttab[un].txchars++;
             }
         } else {
             /* Single byte buffer */
@@ -136,80 +438,277 @@ USART_TypeDef  *uart;
             } else {
                 uart->TDR = uarttab[un].outputbuffer;
                 uarttab[un].outputbuffer = 0;
+                uarttab[un].txchars++;
             }
         }
     }
-    uart->ICR = 0x00021B5F;     // Clear all pending interrupts
+    uart->ICR = UART_ICR_ALL;       // Clear all pending interrupts
 
+    PROFILE_END(UART_ISR);
 }
 /**
  ** @brief  Interrupt routines for USART and UART
+ **
+ ** @note   The UARTs in UART_FASTMASK have their routines generated by UART_DEFINE
+ **         (uartfast.h)
  **/
 ///@{
 
+#if !(UART_FASTMASK&UART_BIT(0))
 /// IRQ Handler for USART1
 void USART1_IRQHandler(void) {
 
     ProcessInterrupt(UART_1);
 }
+#endif
 
+#if !(UART_FASTMASK&UART_BIT(1))
 /// IRQ Handler for USART2
 void USART2_IRQHandler(void) {
 
     ProcessInterrupt(UART_2);
 }
+#endif
 
+#if !(UART_FASTMASK&UART_BIT(2))
 /// IRQ Handler for USART3
 void USART3_IRQHandler(void) {
 
     ProcessInterrupt(UART_3);
 }
+#endif
 
+#if !(UART_FASTMASK&UART_BIT(3))
 /// IRQ Handler for UART4
 void UART4_IRQHandler(void) {
 
     ProcessInterrupt(UART_4);
 }
+#endif
 
+#if !(UART_FASTMASK&UART_BIT(4))
 /// IRQ Handler for UART5
 void UART5_IRQHandler(void) {
 
     ProcessInterrupt(UART_5);
 }
+#endif
 
 
+#if !(UART_FASTMASK&UART_BIT(5))
 /// IRQ Handler for USART6
 void USART6_IRQHandler(void) {
 
     ProcessInterrupt(UART_6);
 }
+#endif
 
 
+#if !(UART_FASTMASK&UART_BIT(6))
 /// IRQ Handler for UART7
 void UART7_IRQHandler(void) {
 
     ProcessInterrupt(UART_7);
 }
+#endif
 
+#if !(UART_FASTMASK&UART_BIT(7))
 /// IRQ Handler for UART8
 void UART8_IRQHandler(void) {
 
     ProcessInterrupt(UART_8);
 }
+#endif
 ///@}
 
+/**
+ ** @brief  Interrupt routines for DMA RX streams
+ **/
+///@{
+
+/// USART1 RX
+void DMA2_Stream2_IRQHandler(void) {
+
+    ProcessDMARXInterrupt(UART_1);
+}
+
+/// USART2 RX
+void DMA1_Stream5_IRQHandler(void) {
+
+    ProcessDMARXInterrupt(UART_2);
+}
+
+/// USART3 RX
+void DMA1_Stream1_IRQHandler(void) {
+
+    ProcessDMARXInterrupt(UART_3);
+}
+
+/// UART4 RX
+void DMA1_Stream2_IRQHandler(void) {
+
+    ProcessDMARXInterrupt(UART_4);
+}
+
+/// UART5 RX
+void DMA1_Stream0_IRQHandler(void) {
+
+    ProcessDMARXInterrupt(UART_5);
+}
+
+/// USART6 RX
+void DMA2_Stream1_IRQHandler(void) {
+
+    ProcessDMARXInterrupt(UART_6);
+}
+
+/// UART7 RX
+void DMA1_Stream3_IRQHandler(void) {
+
+    ProcessDMARXInterrupt(UART_7);
+}
+
+/// UART8 RX
+void DMA1_Stream6_IRQHandler(void) {
+
+    ProcessDMARXInterrupt(UART_8);
+}
+///@}
+
+/**
+ ** @brief Configure DMA streams for UART
+ **
+ ** @note  RX uses a circular transfer into the data area of input fifo.
+ **        TX transfers contiguous spans of output fifo
+ **
+ ** @note  In high speed mode, the RX stream has very high priority, so other
+ **        streams of the same DMA do not delay the read of RDR
+ **/
+static int
+UART_ConfigureDMA(int uartn, int highspeed) {
+const UART_DMAInfo *d = &uartdmatab[uartn];
+USART_TypeDef *uart = uarttab[uartn].device;
+FIFO in  = uarttab[uartn].inputfifo;
+
+    if( (in == 0) || (uarttab[uartn].outputfifo == 0) )
+        return -1;
+
+    if( d->dma == DMA1 )
+        RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN;
+    else
+        RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+
+    // RX
+    d->rxstream->CR &= ~DMA_SxCR_EN;
+    while( d->rxstream->CR&DMA_SxCR_EN ) {}
+    DMA_ClearFlags(d->dma,d->rxsn,DMA_FLAG_ALL);
+    in->head = in->tail = 0;                    // DMA starts at data[0]
+    d->rxstream->PAR  = (uint32_t) &uart->RDR;
+    d->rxstream->M0AR = (uint32_t) in->data;
+    d->rxstream->NDTR = in->capacity;
+    d->rxstream->FCR  = 0;                      // Direct mode
+    d->rxstream->CR   = BITVALUE(d->rxchannel,25)   // Channel
+                      | (highspeed?DMA_SxCR_PL:DMA_SxCR_PL_1) // Very high or high priority
+                      | DMA_SxCR_MINC               // Memory increment
+                      | DMA_SxCR_CIRC               // Circular
+                      | DMA_SxCR_HTIE               // Half transfer interrupt
+                      | DMA_SxCR_TCIE;              // Transfer complete interrupt
+    NVIC_SetPriority(d->rxirqn,uarttab[uartn].conf.irqlevel);
+    NVIC_ClearPendingIRQ(d->rxirqn);
+    NVIC_EnableIRQ(d->rxirqn);
+    d->rxstream->CR  |= DMA_SxCR_EN;
+
+    // TX
+    d->txstream->CR &= ~DMA_SxCR_EN;
+    while( d->txstream->CR&DMA_SxCR_EN ) {}
+    d->txstream->PAR  = (uint32_t) &uart->TDR;
+    d->txstream->FCR  = 0;                      // Direct mode
+    d->txstream->CR   = BITVALUE(d->txchannel,25)   // Channel
+                      | DMA_SxCR_PL_0               // Medium priority
+                      | DMA_SxCR_MINC               // Memory increment
+                      | DMA_SxCR_DIR_0;             // Memory to peripheral
+    uarttab[uartn].txdmacount = 0;
+
+    return 0;
+}
+
+/**
+ ** @brief Get a FIFO area of at least size chars
+ **
+ ** @note  *area is reused when *areasize is large enough. Otherwise a new area is
+ **        taken from the pool. Returns 0 when the pool is exhausted
+ **/
+static FIFO
+UART_GetFIFO(void **area, int *areasize, int size) {
+unsigned words;
+
+    if( *area == 0 || *areasize < size ) {
+        words = (sizeof(struct fifo_s)+size+sizeof(unsigned)-1)/sizeof(unsigned);
+        if( fifopoolused+words > sizeof(fifopool)/sizeof(unsigned) )
+            return 0;
+        *area     = &fifopool[fifopoolused];
+        *areasize = size;
+        fifopoolused += words;
+    }
+    return fifo_init(*area,size);
+}
+
+/**
+ ** @brief Set the sizes of the FIFOs used by UART_Init
+ **
+ ** @note  Must be called before UART_Init. The sizes should be powers of 2 (the
+ **        capacity is the largest power of 2 not larger than size). A size of 0
+ **        means UART_FIFOSIZE
+ **/
+int
+UART_SetFIFOSizes(int uartn, int insize, int outsize) {
+
+    if( uartn >= uarttabsize ) return -1;
+
+    uarttab[uartn].inputsize  = insize;
+    uarttab[uartn].outputsize = outsize;
+    return 0;
+}
+
+/**
+ ** @brief Set the hardware flow control
+ **
+ ** @note  Must be called before UART_Init. flags are UART_FLOW_RTS and/or
+ **        UART_FLOW_CTS. The CTS and RTS pins of uarttab are configured by UART_Init.
+ **        UART_HIGHSPEED always uses both
+ **/
+int
+UART_SetFlowControl(int uartn, unsigned flags) {
+
+    if( uartn >= uarttabsize ) return -1;
+
+    uarttab[uartn].flowcontrol = flags&UART_FLOW_RTSCTS;
+    return 0;
+}
+
 /**
  ** @brief UART Initialization Simplified
  **
  ** @note  Use defines in uart.h to configure the uart, or'ing the parameters
+ **
+ ** @note  Each UART gets its own input and output FIFOs (see UART_SetFIFOSizes),
+ **        so all of them can be used at the same time
  **/
 int
 UART_Init(int uartn, unsigned config) {
+UART_Info *u;
 FIFO in;
 FIFO out;
 
-    in  = fifo_init(inputarea,INPUTAREASIZE);
-    out = fifo_init(outputarea,OUTPUTAREASIZE);
+    if( uartn >= uarttabsize ) return -1;
+
+    u   = &uarttab[uartn];
+    in  = UART_GetFIFO(&u->inputarea,&u->inputareasize,
+                       u->inputsize?u->inputsize:UART_FIFOSIZE);
+    out = UART_GetFIFO(&u->outputarea,&u->outputareasize,
+                       u->outputsize?u->outputsize:UART_FIFOSIZE);
+    if( (in == 0) || (out == 0) )
+        return 5;
 
     return UART_InitExt(uartn,config,in,out);
 }
@@ -226,6 +725,7 @@ uint32_t baudrate,div,t,over;
 USART_TypeDef * uart;
 uint32_t uartfreq;
 uint32_t cr1,cr2,cr3,ckcfgr;
+unsigned flow;
 
     if( uartn >= uarttabsize ) return -1;
 
@@ -234,28 +734,50 @@ uint32_t cr1,cr2,cr3,ckcfgr;
     uarttab[uartn].outputfifo   = out;
     uarttab[uartn].inputbuffer  = 0;
     uarttab[uartn].outputbuffer = 0;
-    if( in )
-        uarttab[uartn].conf.useinputfifo = 1;
-    if( out )
-        uarttab[uartn].conf.useoutputfifo = 1;
+    uarttab[uartn].conf.useinputfifo  = (in != 0);
+    uarttab[uartn].conf.useoutputfifo = (out != 0);
+    uarttab[uartn].usedma       = 0;
+    uarttab[uartn].txdmacount   = 0;
+    uarttab[uartn].rxcallback   = 0;
+    uarttab[uartn].terminator   = -1;
+    uarttab[uartn].lineevent    = 0;
+    uarttab[uartn].rxchars      = 0;
+    uarttab[uartn].txchars      = 0;
+    uarttab[uartn].rxlost       = 0;
+    uarttab[uartn].rxoverruns   = 0;
+
+    // High speed mode
+    flow = uarttab[uartn].flowcontrol;
+    if( config&UART_HIGHSPEED ) {
+        config |= UART_OVER8|UART_DMA;
+        flow   |= UART_FLOW_RTSCTS;
+    }
 
     // Configure pins
     GPIO_ConfigureSinglePin(&uarttab[uartn].txpinconf);
     GPIO_ConfigureSinglePin(&uarttab[uartn].rxpinconf);
-
-    // Configure clock for UxARTy at RCC DCKCFGR2
-    ckcfgr = RCC->DCKCFGR2;
+    if( flow&UART_FLOW_CTS )
+        GPIO_ConfigureSinglePin(&uarttab[uartn].ctspinconf);
+    if( flow&UART_FLOW_RTS )
+        GPIO_ConfigureSinglePin(&uarttab[uartn].rtspinconf);
 
     // Get pointer to UART registers
     uart = uarttab[uartn].device;
 
+    // Configure clock for UxARTy at RCC DCKCFGR2
+    ckcfgr = RCC->DCKCFGR2;
+
     // Select clock source
     uartfreq = 0;
     ckcfgr &= ~BITVALUE(3,uartn*2);
     switch(config&UART_CLOCK_M) {
     case UART_CLOCK_APB:
+        // USART1 and USART6 are on APB2
         ckcfgr |= BITVALUE(0,uartn*2);
-        uartfreq = SystemGetAPB1Frequency();
+        if( (uart == USART1) || (uart == USART6) )
+            uartfreq = SystemGetAPB2Frequency();
+        else
+            uartfreq = SystemGetAPB1Frequency();
         break;
     case UART_CLOCK_SYSCLK:
         ckcfgr |= BITVALUE(1,uartn*2);
@@ -331,15 +853,30 @@ uint32_t cr1,cr2,cr3,ckcfgr;
     // Configure UART CR3 register
     cr3 = uart->CR3;
     cr3 = 0;
+    if( config&UART_DMA )
+        cr3 |= USART_CR3_DMAR|USART_CR3_DMAT|USART_CR3_EIE;
+    if( flow&UART_FLOW_RTS )
+        cr3 |= USART_CR3_RTSE;
+    if( flow&UART_FLOW_CTS )
+        cr3 |= USART_CR3_CTSE;
 
     // Configure UART BRR register (baudrate)
     baudrate = ((config&UART_BAUD_M)>>UART_BAUD_P);
+    if( config&UART_HIGHSPEED )
+        baudrate *= 100;
+    if( baudrate == 0 )
+        return 6;
 
+    // USARTDIV must be at least 16, so the maximum is fCK/16 or fCK/8 (OVER8)
     if( over == 16 ) {
-        div = uartfreq/baudrate;
+        div = (uartfreq+baudrate/2)/baudrate;
+        if( div < 16 )
+            return 6;
         uart->BRR = div;
     } else {
-        div = 2*uartfreq/baudrate;
+        div = (2*uartfreq+baudrate/2)/baudrate;
+        if( div < 16 )
+            return 6;
         uart->BRR = (div&~0xF)|((div&0xF)>>1);
     }
 
@@ -353,9 +890,25 @@ uint32_t cr1,cr2,cr3,ckcfgr;
     NVIC_ClearPendingIRQ(uarttab[uartn].conf.irqn);
     NVIC_EnableIRQ(uarttab[uartn].conf.irqn);
 
+    // Configure DMA
+    if( config&UART_DMA ) {
+        if( UART_ConfigureDMA(uartn,(config&UART_HIGHSPEED) != 0) < 0 )
+            return 4;
+        uarttab[uartn].usedma = 1;
+    }
+
     // Enable interrupts
-    uart->CR1 |= USART_CR1_RXNEIE;          // Enable interrupt when RX not empty
-    uart->CR1 |= USART_CR1_TXEIE;           // Enable interrupt when TX is empty
+    if( uarttab[uartn].usedma ) {
+        uart->CR1 |= USART_CR1_IDLEIE;      // Enable interrupt when RX line is idle
+    } else {
+        uart->CR1 |= USART_CR1_RXNEIE;      // Enable interrupt when RX not empty
+        uart->CR1 |= USART_CR1_TXEIE;       // Enable interrupt when TX is empty
+    }
+
+    // Enable cycle counter used for timeouts
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;                  // Unlock access on Cortex-M7
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 
     // Enable UART
     uart->CR1 |= USART_CR1_TE|USART_CR1_RE;
@@ -374,12 +927,22 @@ USART_TypeDef *uart;
     if( uartn >= uarttabsize ) return -1;
 
     uart = uarttab[uartn].device;
+
+    if( uarttab[uartn].usedma ) {
+        /* DMA */
+        while( fifo_insert(uarttab[uartn].outputfifo,c) < 0 ) {}
+        NVIC_DisableIRQ(uarttab[uartn].conf.irqn);
+        UART_StartDMAOutput(uartn);
+        NVIC_EnableIRQ(uarttab[uartn].conf.irqn);
+        return 0;
+    }
 #if 1
     if( uarttab[uartn].conf.useoutputfifo ) {
         /* Multibyte buffer */
         if ( fifo_empty(uarttab[uartn].outputfifo) ) {
             while( (uart->ISR&USART_ISR_TXE)==0 ) {}
             uart->TDR = c;
+            uarttab[uartn].txchars++;
         } else {
             fifo_insert(uarttab[uartn].outputfifo,c);
         }
@@ -402,6 +965,128 @@ USART_TypeDef *uart;
     return 0;
 }
 
+/**
+ ** @brief Start transmission of the chars in output fifo
+ **
+ ** @note  In interrupt mode, enables the TXE interrupt. In DMA mode, starts DMA
+ **/
+static void
+UART_KickOutput(int uartn) {
+USART_TypeDef *uart = uarttab[uartn].device;
+
+    if( uarttab[uartn].usedma ) {
+        NVIC_DisableIRQ(uarttab[uartn].conf.irqn);
+        UART_StartDMAOutput(uartn);
+        NVIC_EnableIRQ(uarttab[uartn].conf.irqn);
+    } else {
+        uart->CR1 |= (USART_CR1_TCIE|USART_CR1_TXEIE);
+    }
+}
+
+/**
+ ** @brief UART Send a block of chars
+ **
+ ** @note  The chars are copied into the output fifo in contiguous spans. The
+ **        transmission is started once for each span, not for each char
+ **
+ ** @note  When flags has UART_WRITE_CRLF, LF is mapped to CR-LF
+ **
+ ** @note  Blocks while the output fifo is full. Returns the number of chars of buf
+ **        written
+ **/
+int
+UART_Write(int uartn, const char *buf, int len, unsigned flags) {
+FIFO out;
+char *p;
+int i;
+int k;
+int n;
+int crsent = 0;
+
+    if( uartn >= uarttabsize ) return -1;
+
+    if( !uarttab[uartn].conf.useoutputfifo ) {
+        /* Singlebyte buffer */
+        for(i=0;i<len;i++) {
+            if( (buf[i] == '\n') && (flags&UART_WRITE_CRLF) )
+                UART_WriteChar(uartn,'\r');
+            UART_WriteChar(uartn,buf[i]);
+        }
+        return len;
+    }
+
+    out = uarttab[uartn].outputfifo;
+    i = 0;
+    while( i < len ) {
+        n = fifo_writespan(out,&p);
+        if( n == 0 ) {
+            /* fifo full: wait until there is space */
+            UART_KickOutput(uartn);
+            continue;
+        }
+        for(k=0;(k<n)&&(i<len);) {
+            if( (buf[i] == '\n') && (flags&UART_WRITE_CRLF) && !crsent ) {
+                p[k++] = '\r';
+                crsent = 1;
+            } else {
+                p[k++] = buf[i++];
+                crsent = 0;
+            }
+        }
+        fifo_commit(out,k);
+        if( k == n )
+            UART_KickOutput(uartn);
+    }
+    UART_KickOutput(uartn);
+    return len;
+}
+
+/**
+ ** @brief UART Send the chars of a block that fit in the output fifo
+ **
+ ** @note  It does not block, so a program can feed several UARTs in turn. Returns
+ **        the number of chars of buf written (0 when the fifo is full)
+ **/
+int
+UART_WriteNoWait(int uartn, const char *buf, int len) {
+int n;
+
+    if( uartn >= uarttabsize ) return -1;
+
+    if( !uarttab[uartn].conf.useoutputfifo ) {
+        /* Singlebyte buffer */
+        if( (len == 0) || (uarttab[uartn].outputbuffer != 0) )
+            return 0;
+        UART_WriteChar(uartn,buf[0]);
+        return 1;
+    }
+
+    n = fifo_write(uarttab[uartn].outputfifo,buf,len);
+    if( n > 0 )
+        UART_KickOutput(uartn);
+    return n;
+}
+
+/**
+ ** @brief Get the counters of chars received, transmitted and lost
+ **
+ ** @note  Free running counters, cleared by UART_Init. Lost chars are the ones
+ **        overwritten in RDR (overrun) or not inserted in a full input fifo.
+ **        rxoverruns counts only the first ones, so, with flow control, it must
+ **        stay at 0
+ **/
+int
+UART_GetCounters(int uartn, UART_Counters *c) {
+
+    if( uartn >= uarttabsize ) return -1;
+
+    c->rxchars = uarttab[uartn].rxchars;
+    c->txchars = uarttab[uartn].txchars;
+    c->rxlost  = uarttab[uartn].rxlost;
+    c->rxoverruns = uarttab[uartn].rxoverruns;
+    return 0;
+}
+
 /**
  ** @brief UART Send a string
  **
@@ -436,7 +1121,9 @@ uint32_t c;
 
     if( uarttab[uartn].conf.useinputfifo ) {
         while( fifo_empty(uarttab[uartn].inputfifo) ) {}
+        UART_LockInput(uartn);
         c = fifo_remove(uarttab[uartn].inputfifo);
+        UART_UnlockInput(uartn);
     } else {
         while( uarttab[uartn].inputbuffer == 0 ) {}
         c = uarttab[uartn].inputbuffer;
@@ -466,11 +1153,13 @@ uint32_t c;
     uart = uarttab[uartn].device;
 
     if( uarttab[uartn].conf.useinputfifo ) {
+        UART_LockInput(uartn);
         if( fifo_empty(uarttab[uartn].inputfifo)) {
             c = 0;
         } else {
             c = fifo_remove(uarttab[uartn].inputfifo);
         }
+        UART_UnlockInput(uartn);
     } else {
         if( uarttab[uartn].inputbuffer ) {
             c = uarttab[uartn].inputbuffer;
@@ -487,6 +1176,102 @@ uint32_t c;
     return c;
 }
 
+/**
+ ** @brief Number of chars available to be read
+ **/
+int
+UART_Available(int uartn) {
+
+    if( uartn >= uarttabsize ) return -1;
+
+    if( uarttab[uartn].conf.useinputfifo )
+        return fifo_size(uarttab[uartn].inputfifo);
+    else
+        return uarttab[uartn].inputbuffer != 0;
+}
+
+/**
+ ** @brief Read up to n chars from UART waiting at most timeout ms
+ **
+ ** @note  Returns the number of chars read. It returns before the timeout when n
+ **        chars were read.
+ **
+ ** @note  While waiting, the core sleeps (WFI) until an interrupt occurs, e.g., the
+ **        UART receives a char or the SysTick
+ **
+ ** @note  Timeout is measured using the DWT cycle counter
+ **/
+int
+UART_ReadTimeout(int uartn, char *buf, int n, unsigned timeout) {
+uint64_t limit;
+uint64_t elapsed;
+uint32_t last,now;
+int cnt;
+int c;
+
+    if( uartn >= uarttabsize ) return -1;
+
+    limit   = (uint64_t) timeout*(SystemCoreClock/1000);
+    elapsed = 0;
+    last    = DWT->CYCCNT;
+    cnt     = 0;
+    while( cnt < n ) {
+        if( uarttab[uartn].conf.useinputfifo ) {
+            UART_LockInput(uartn);
+            cnt += fifo_read(uarttab[uartn].inputfifo,buf+cnt,n-cnt);
+            UART_UnlockInput(uartn);
+        } else if( (c=uarttab[uartn].inputbuffer) != 0 ) {
+            uarttab[uartn].inputbuffer = 0;
+            buf[cnt++] = c;
+        }
+        if( cnt >= n )
+            break;
+        now = DWT->CYCCNT;
+        elapsed += now-last;
+        last = now;
+        if( elapsed >= limit )
+            break;
+        __WFI();
+    }
+    return cnt;
+}
+
+/**
+ ** @brief Set a line event
+ **
+ ** @note  When terminator is received, the line event flag is set and callback
+ **        (if not null) is called. The callback runs in the interrupt routine.
+ **
+ ** @note  A negative terminator disables the event
+ **/
+int
+UART_SetLineEvent(int uartn, int terminator, void (*callback)(int uartn)) {
+
+    if( uartn >= uarttabsize ) return -1;
+
+    uarttab[uartn].rxcallback = callback;
+    uarttab[uartn].lineevent  = 0;
+    uarttab[uartn].terminator = terminator;
+    return 0;
+}
+
+/**
+ ** @brief Test and clear line event flag
+ **
+ ** @note  Returns a non zero value if the terminator was received since last call
+ **/
+int
+UART_GetLineEvent(int uartn) {
+int e;
+
+    if( uartn >= uarttabsize ) return -1;
+
+    e = uarttab[uartn].lineevent;
+    if( e )
+        uarttab[uartn].lineevent = 0;
+    return e;
+}
+
 /**
  ** @brief UART Send a string
  **
@@ -563,7 +1348,9 @@ uint32_t status;
 
     // Flush input buffer
     if( uarttab[uartn].conf.useinputfifo ) {
+        UART_LockInput(uartn);
         fifo_clear(uarttab[uartn].inputfifo);
+        UART_UnlockInput(uartn);
     } else {
         uarttab[uartn].inputbuffer = 0;
     }
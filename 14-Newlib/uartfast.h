@@ -0,0 +1,147 @@
+#ifndef UARTFAST_H
+#define UARTFAST_H
+/**
+ * @file    uartfast.h
+ *
+ * @note    Specialized interrupt driven driver for one UART, generated by macros.
+ *          The device, the buffers and their sizes are compile time constants, so
+ *          there is no lookup in uarttab, no test of configuration flags and no
+ *          call to fifo.c in the write path and in the interrupt routine
+ *
+ * @note    UART_DECLARE(N,DEVICE,INSIZE,OUTSIZE) declares the data and defines the
+ *          inline functions UARTN_WriteChar, UARTN_ReadChar, UARTN_ReadCharNoWait
+ *          and UARTN_Available. Put it in a header. INSIZE and OUTSIZE must be
+ *          powers of 2
+ *
+ * @note    UART_DEFINE(N,DEVICE) defines the data, UARTN_Init and the interrupt
+ *          routine DEVICE_IRQHandler. Put it in one source file, after
+ *          UART_DECLARE. Bit N-1 of UART_FASTMASK must be set (in the Makefile), so
+ *          uart2.c does not define its own routine for the UART
+ *
+ * @note    N is the UART number (1 to 8) and DEVICE the CMSIS name of the device,
+ *          e.g., UART_DECLARE(2,USART2,64,256). UARTN_Init uses UART_InitExt to
+ *          configure pins, clock and frame. UART_DMA is not supported and the
+ *          other functions of uart.h must not be used with the UART
+ *
+ * @note    Single producer/single consumer rings, like fifo.c, with free running
+ *          head and tail counters
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include "stm32f746xx.h"
+#include "uart.h"
+
+/**
+ * @brief   Compiler barrier
+ *
+ * @note    The char must be stored before head is incremented
+ */
+#define UARTFAST_BARRIER()  __asm volatile ("" ::: "memory")
+
+/**
+ * @brief   Data and inline functions of a specialized UART
+ */
+#define UART_DECLARE(N,DEVICE,INSIZE,OUTSIZE)                                   \
+struct UART##N##_Data {                                                         \
+    volatile unsigned   rxhead;                                                 \
+    volatile unsigned   rxtail;                                                 \
+    volatile unsigned   txhead;                                                 \
+    volatile unsigned   txtail;                                                 \
+    char                rx[INSIZE];                                             \
+    char                tx[OUTSIZE];                                            \
+};                                                                              \
+typedef char UART##N##_SizesMustBePowersOf2[                                    \
+                (((INSIZE)&((INSIZE)-1))==0 && ((OUTSIZE)&((OUTSIZE)-1))==0)    \
+                ? 1 : -1];                                                      \
+extern struct UART##N##_Data UART##N##_data;                                    \
+int UART##N##_Init(unsigned config);                                            \
+                                                                                \
+static inline void UART##N##_WriteChar( unsigned c ) {                          \
+unsigned h = UART##N##_data.txhead;                                             \
+                                                                                \
+    while( h-UART##N##_data.txtail >= (OUTSIZE) ) {}                            \
+    UART##N##_data.tx[h&((OUTSIZE)-1)] = c;                                     \
+    UARTFAST_BARRIER();                                                         \
+    UART##N##_data.txhead = h+1;                                                \
+    DEVICE->CR1 |= USART_CR1_TXEIE;                                             \
+}                                                                               \
+                                                                                \
+static inline int UART##N##_Available( void ) {                                 \
+                                                                                \
+    return UART##N##_data.rxhead-UART##N##_data.rxtail;                         \
+}                                                                               \
+                                                                                \
+static inline int UART##N##_ReadCharNoWait( void ) {                            \
+unsigned t = UART##N##_data.rxtail;                                             \
+int c;                                                                          \
+                                                                                \
+    if( t == UART##N##_data.rxhead )                                            \
+        return -1;                                                              \
+    c = (unsigned char) UART##N##_data.rx[t&((INSIZE)-1)];                      \
+    UARTFAST_BARRIER();                                                         \
+    UART##N##_data.rxtail = t+1;                                                \
+    return c;                                                                   \
+}                                                                               \
+                                                                                \
+static inline int UART##N##_ReadChar( void ) {                                  \
+                                                                                \
+    while( UART##N##_data.rxtail == UART##N##_data.rxhead ) {}                  \
+    return UART##N##_ReadCharNoWait();                                          \
+}
+
+/**
+ * @brief   Data, initialization and interrupt routine of a specialized UART
+ *
+ * @note    A received char is discarded when the input ring is full. An overrun
+ *          is cleared
+ */
+#define UART_DEFINE(N,DEVICE)                                                   \
+typedef char UART##N##_MustBeInUART_FASTMASK[                                   \
+                (UART_FASTMASK&UART_BIT((N)-1)) ? 1 : -1];                      \
+struct UART##N##_Data UART##N##_data;                                           \
+                                                                                \
+int                                                                             \
+UART##N##_Init(unsigned config) {                                               \
+int rc;                                                                         \
+                                                                                \
+    if( config&UART_DMA )                                                       \
+        return 4;                                                               \
+    UART##N##_data.rxhead = UART##N##_data.rxtail = 0;                          \
+    UART##N##_data.txhead = UART##N##_data.txtail = 0;                          \
+    rc = UART_InitExt((N)-1,config,0,0);                                        \
+    if( rc )                                                                    \
+        return rc;                                                              \
+    DEVICE->CR1 &= ~(USART_CR1_TXEIE|USART_CR1_TCIE);                           \
+    return 0;                                                                   \
+}                                                                               \
+                                                                                \
+void DEVICE##_IRQHandler(void) {                                                \
+unsigned isr = DEVICE->ISR;                                                     \
+unsigned h,t;                                                                   \
+                                                                                \
+    if( isr&USART_ISR_RXNE ) {                                                  \
+        h = UART##N##_data.rxhead;                                              \
+        if( h-UART##N##_data.rxtail < sizeof(UART##N##_data.rx) ) {             \
+            UART##N##_data.rx[h&(sizeof(UART##N##_data.rx)-1)] = DEVICE->RDR;   \
+            UARTFAST_BARRIER();                                                 \
+            UART##N##_data.rxhead = h+1;                                        \
+        } else {                                                                \
+            (void) DEVICE->RDR;                                                 \
+        }                                                                       \
+    }                                                                           \
+    if( isr&USART_ISR_ORE )                                                     \
+        DEVICE->ICR = USART_ICR_ORECF;                                          \
+    if( (isr&USART_ISR_TXE) && (DEVICE->CR1&USART_CR1_TXEIE) ) {                \
+        t = UART##N##_data.txtail;                                              \
+        if( t == UART##N##_data.txhead ) {                                      \
+            DEVICE->CR1 &= ~USART_CR1_TXEIE;                                    \
+        } else {                                                                \
+            DEVICE->TDR = UART##N##_data.tx[t&(sizeof(UART##N##_data.tx)-1)];   \
+            UART##N##_data.txtail = t+1;                                        \
+        }                                                                       \
+    }                                                                           \
+}
+
+#endif // UARTFAST_H
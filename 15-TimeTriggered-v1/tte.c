@@ -12,6 +12,7 @@
 
 #include <stdint.h>
 #include "tte.h"
+#include "profile.h"
 
 /// Task Info
 typedef struct {
@@ -92,6 +93,8 @@ Task_Dispatch(void) {
 int i;
 TaskInfo *p;
 
+    PROFILE_BEGIN(Task_Dispatch);
+
     for(i=0;i<TASK_MAXCNT;i++) {
         p = &taskinfo[i];
         if( p->task ) {
@@ -106,6 +109,7 @@ TaskInfo *p;
 
     }
 
+    PROFILE_END(Task_Dispatch);
     return 0;
 }
 
@@ -94,7 +94,7 @@ int i,i2;
             // Set pullup/pushdown resistors configuration
             gpio->PUPDR    = (gpio->PUPDR&~f)|(OUTPUTPUPDR<<i2);
             // Set pin to 0
-            gpio->ODR     &=  ~m;
+            gpio->BSRR     =  m<<16;
         }
     }
 
@@ -16,6 +16,18 @@
 #include "led.h"
 #include "button.h"
 #include "tte.h"
+#include "tickless.h"
+#include "msgqueue.h"
+#ifdef USE_SCHEDULE
+#include "schedule.h"
+#endif
+
+/**
+ * @brief   Idle mode between activations (see tickless.h)
+ */
+#ifndef TICKLESS_MODE
+#define TICKLESS_MODE TICKLESS_NONE
+#endif
 
 /**
  * @brief   Systick routine
@@ -39,6 +51,54 @@ void Blink(void) {
         LED_Clear();
 }
 
+#ifdef USE_MSGQUEUE
+/**
+ * @brief   Button events passed from a preemptive task to a cooperative one
+ *
+ * @note    ButtonSample runs in PendSV every 10 ms and puts an event in the
+ *          queue at each press. ButtonEvents drains the queue and switches the
+ *          blinking. No variable is shared between them
+ */
+///@{
+typedef struct {
+    uint32_t    time;           // ms
+    uint32_t    pressed;
+} ButtonEvent;
+
+MSGQUEUE_STORAGE(buttonslots,8);
+MSGPOOL_STORAGE(buttonblocks,sizeof(ButtonEvent),8);
+static MsgQueue buttonqueue;
+static MsgPool  buttonpool;
+
+void ButtonSample(void) {
+static uint32_t last = 0;
+uint32_t pressed = Button_Read() != 0;
+ButtonEvent *ev;
+
+    if( pressed && !last ) {
+        ev = MsgPool_Alloc(&buttonpool);
+        if( ev ) {
+            ev->time    = tick_ms;
+            ev->pressed = pressed;
+            if( MsgQueue_Put(&buttonqueue,ev) < 0 )
+                MsgPool_Free(&buttonpool,ev);
+        }
+    }
+    last = pressed;
+}
+
+void ButtonEvents(void) {
+ButtonEvent *ev;
+
+    while( (ev = MsgQueue_Get(&buttonqueue)) != 0 ) {
+        if( ev->pressed )
+            blinking = !blinking;
+        MsgPool_Free(&buttonpool,ev);
+    }
+}
+///@}
+#endif
+
 /**
  * @brief   main
  *
@@ -47,7 +107,9 @@ void Blink(void) {
  */
 
 int main(void) {
+#ifndef USE_SCHEDULE
 int taskno_blink;
+#endif
 
     //SystemSetCoreClock(CLOCKSRC_HSE,100);
 
@@ -60,11 +122,26 @@ int taskno_blink;
     LED_Init();
     Button_Init();
     Task_Init();
+#if TICKLESS_MODE != TICKLESS_NONE
+    Tickless_Init();
+#endif
 
+#ifdef USE_SCHEDULE
+    Task_SetSchedule(&schedule);
+#else
     taskno_blink  = Task_Add(Blink,500,0);
+#endif
+
+#ifdef USE_MSGQUEUE
+    MsgQueue_Init(&buttonqueue,buttonslots,8);
+    MsgPool_Init(&buttonpool,buttonblocks,sizeof(ButtonEvent),buttonblocks_slots,8);
+    Task_AddPreemptive(ButtonSample,10,0,0);
+    Task_Add(ButtonEvents,50,1);
+#endif
 
     /* Main */
     for (;;) {
         Task_Dispatch();
+        Tickless_Idle(TICKLESS_MODE);
     }
 }
@@ -0,0 +1,226 @@
+/**
+ * @file    msgqueue.c
+ *
+ * @note    Single producer, single consumer queues of message pointers and
+ *          pools of message blocks for the Time Triggered Executive
+ *
+ * @note    The producer writes the slot and then advances tail, the consumer
+ *          reads the slot and then advances head. The barrier between them
+ *          keeps this order, so the other side never sees an index before the
+ *          slot it covers
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "msgqueue.h"
+
+/**
+ * @brief   Memory barrier
+ *
+ * @note    From CMSIS cmsis_gcc.h (__DMB), to avoid CPU specific files as
+ *          tte-v2.c
+ */
+__attribute__((always_inline))
+static inline void msgqueue_barrier(void)
+{
+  __asm volatile ("dmb 0xF" : : : "memory");
+}
+
+/**
+ * @brief   Power of 2 test
+ */
+static inline int
+ispowerof2(uint32_t n) {
+
+    return n != 0 && (n&(n-1)) == 0;
+}
+
+/**
+ * @brief   MsgQueue Init
+ *
+ * @note    slots has size entries (a power of 2). Must be called before the
+ *          producer and the consumer use the queue
+ */
+int
+MsgQueue_Init(MsgQueue *q, void **slots, uint32_t size) {
+
+    if( !q || !slots || !ispowerof2(size) )
+        return MSGQUEUE_ERROR_PARAM;
+    q->slots    = slots;
+    q->mask     = size-1;
+    q->head     = 0;
+    q->tail     = 0;
+    q->maxdepth = 0;
+    q->full     = 0;
+    return MSGQUEUE_OK;
+}
+
+/**
+ * @brief   MsgQueue Put
+ *
+ * @note    Producer side. Returns MSGQUEUE_ERROR_FULL when there is no free
+ *          slot. The message is then still owned by the caller
+ */
+int
+MsgQueue_Put(MsgQueue *q, void *msg) {
+uint32_t tail = q->tail;
+uint32_t depth = tail-q->head;
+
+    if( depth > q->mask ) {
+        q->full++;
+        return MSGQUEUE_ERROR_FULL;
+    }
+    q->slots[tail&q->mask] = msg;
+    msgqueue_barrier();
+    q->tail = tail+1;
+    if( depth+1 > q->maxdepth )
+        q->maxdepth = depth+1;
+    return MSGQUEUE_OK;
+}
+
+/**
+ * @brief   MsgQueue Get
+ *
+ * @note    Consumer side. Returns the oldest message or null when the queue
+ *          is empty
+ */
+void *
+MsgQueue_Get(MsgQueue *q) {
+uint32_t head = q->head;
+void *msg;
+
+    if( head == q->tail )
+        return 0;
+    msgqueue_barrier();
+    msg = q->slots[head&q->mask];
+    msgqueue_barrier();
+    q->head = head+1;
+    return msg;
+}
+
+/**
+ * @brief   MsgQueue Peek
+ *
+ * @note    Consumer side. Returns the oldest message without removing it
+ */
+void *
+MsgQueue_Peek(const MsgQueue *q) {
+uint32_t head = q->head;
+
+    if( head == q->tail )
+        return 0;
+    msgqueue_barrier();
+    return q->slots[head&q->mask];
+}
+
+/**
+ * @brief   MsgQueue Get Depth
+ *
+ * @note    Messages in the queue. From the other side, it can already be
+ *          outdated when returned
+ */
+uint32_t
+MsgQueue_GetDepth(const MsgQueue *q) {
+
+    return q->tail-q->head;
+}
+
+/**
+ * @brief   MsgQueue Get Stats
+ *
+ * @note    puts and gets are the indices, so they wrap around after 2^32
+ *          messages
+ */
+void
+MsgQueue_GetStats(const MsgQueue *q, MsgQueueStats *st) {
+
+    st->size     = q->mask+1;
+    st->gets     = q->head;
+    st->puts     = q->tail;
+    st->depth    = st->puts-st->gets;
+    st->maxdepth = q->maxdepth;
+    st->full     = q->full;
+}
+
+/**
+ * @brief   MsgQueue Reset Stats
+ *
+ * @note    Clears the high water mark and the refused puts. Must be called by
+ *          the producer, that writes them
+ */
+void
+MsgQueue_ResetStats(MsgQueue *q) {
+
+    q->maxdepth = q->tail-q->head;
+    q->full     = 0;
+}
+
+/**
+ * @brief   MsgPool Init
+ *
+ * @note    blocks has count blocks (a power of 2) of blocksize bytes, each one
+ *          rounded up to a word. slots has count entries. All blocks start
+ *          free
+ */
+int
+MsgPool_Init(MsgPool *p, void *blocks, uint32_t blocksize, void **slots,
+             uint32_t count) {
+uint32_t i;
+
+    if( !p || !blocks || blocksize == 0 || (((uint32_t) blocks)&3) != 0 )
+        return MSGQUEUE_ERROR_PARAM;
+    if( MsgQueue_Init(&p->free,slots,count) < 0 )
+        return MSGQUEUE_ERROR_PARAM;
+    p->blocks    = blocks;
+    p->blocksize = (blocksize+3)&~3U;
+    p->count     = count;
+    p->failures  = 0;
+    for(i=0;i<count;i++)
+        MsgQueue_Put(&p->free,p->blocks+i*p->blocksize);
+    p->free.maxdepth = 0;
+    return MSGQUEUE_OK;
+}
+
+/**
+ * @brief   MsgPool Alloc
+ *
+ * @note    Returns a free block or null when there is none. Only one context
+ *          can allocate from a pool
+ */
+void *
+MsgPool_Alloc(MsgPool *p) {
+void *block;
+
+    block = MsgQueue_Get(&p->free);
+    if( !block )
+        p->failures++;
+    return block;
+}
+
+/**
+ * @brief   MsgPool Free
+ *
+ * @note    Gives a block back to the pool. Only one context can free blocks of
+ *          a pool. Pointers not in the pool are ignored
+ */
+void
+MsgPool_Free(MsgPool *p, void *block) {
+uint8_t *b = block;
+
+    if( b < p->blocks || b >= p->blocks+p->count*p->blocksize )
+        return;
+    MsgQueue_Put(&p->free,block);
+}
+
+/**
+ * @brief   MsgPool Get Free
+ *
+ * @note    Free blocks
+ */
+uint32_t
+MsgPool_GetFree(const MsgPool *p) {
+
+    return MsgQueue_GetDepth(&p->free);
+}
@@ -0,0 +1,118 @@
+#ifndef MSGQUEUE_H
+#define MSGQUEUE_H
+/**
+ * @file    msgqueue.h
+ *
+ * @note    Message queues between the tasks of the Time Triggered Executive
+ *
+ * @note    A queue is a ring of pointers with a single producer and a single
+ *          consumer. The producer only writes tail and the consumer only
+ *          writes head, so no lock is needed, also when one of them is an
+ *          interrupt routine or a preemptive task (PendSV). The cooperative
+ *          tasks run to completion, so two of them never access a queue at
+ *          the same time
+ *
+ * @note    The messages are not copied. The producer takes a block of a pool
+ *          (MsgPool_Alloc), fills it and puts its pointer in the queue. The
+ *          consumer gets it, uses it and gives it back (MsgPool_Free). The
+ *          free blocks of a pool are kept in a queue too, where the consumer
+ *          is the producer of the free blocks, so a pool is lock free for one
+ *          allocating and one freeing context
+ *
+ * @note    The number of slots and of blocks must be a power of 2
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define MSGQUEUE_OK                 (0)
+#define MSGQUEUE_ERROR_PARAM        (-1)
+#define MSGQUEUE_ERROR_FULL         (-2)
+///@}
+
+/**
+ * @brief   Queue
+ *
+ * @note    head and tail are free running counters. The depth is tail-head
+ *
+ * @note    The statistics are written by the producer, except gets (head)
+ */
+typedef struct {
+    void              **slots;
+    uint32_t            mask;           // slots-1
+    volatile uint32_t   head;           // next to get (consumer)
+    volatile uint32_t   tail;           // next to put (producer)
+    uint32_t            maxdepth;
+    uint32_t            full;           // puts refused
+} MsgQueue;
+
+/**
+ * @brief   Queue statistics (MsgQueue_GetStats)
+ */
+typedef struct {
+    uint32_t            size;
+    uint32_t            depth;          // messages in the queue
+    uint32_t            maxdepth;       // high water mark
+    uint32_t            puts;
+    uint32_t            gets;
+    uint32_t            full;           // puts refused because it was full
+} MsgQueueStats;
+
+/**
+ * @brief   Pool of message blocks
+ *
+ * @note    blocks points to count blocks of blocksize bytes, aligned to a word
+ */
+typedef struct {
+    MsgQueue            free;
+    uint8_t            *blocks;
+    uint32_t            blocksize;
+    uint32_t            count;
+    uint32_t            failures;       // MsgPool_Alloc without a free block
+} MsgPool;
+
+/**
+ * @brief   Storage of a queue and of a pool
+ *
+ * @note    For example
+ *
+ *          MSGQUEUE_STORAGE(events,16);
+ *          MSGPOOL_STORAGE(eventblocks,sizeof(Event),16);
+ *          ...
+ *          MsgQueue_Init(&q,events,16);
+ *          MsgPool_Init(&p,eventblocks,sizeof(Event),eventblocks_slots,16);
+ */
+///@{
+#define MSGQUEUE_STORAGE(NAME,SIZE) \
+        static void *NAME[SIZE]
+#define MSGPOOL_STORAGE(NAME,BLOCKSIZE,COUNT) \
+        static uint32_t NAME[(COUNT)*(((BLOCKSIZE)+3)/4)]; \
+        static void *NAME##_slots[COUNT]
+///@}
+
+/**
+ * @brief   API
+ */
+///@{
+int      MsgQueue_Init(MsgQueue *q, void **slots, uint32_t size);
+int      MsgQueue_Put(MsgQueue *q, void *msg);
+void    *MsgQueue_Get(MsgQueue *q);
+void    *MsgQueue_Peek(const MsgQueue *q);
+uint32_t MsgQueue_GetDepth(const MsgQueue *q);
+void     MsgQueue_GetStats(const MsgQueue *q, MsgQueueStats *st);
+void     MsgQueue_ResetStats(MsgQueue *q);
+
+int      MsgPool_Init(MsgPool *p, void *blocks, uint32_t blocksize, void **slots,
+                      uint32_t count);
+void    *MsgPool_Alloc(MsgPool *p);
+void     MsgPool_Free(MsgPool *p, void *block);
+uint32_t MsgPool_GetFree(const MsgPool *p);
+///@}
+
+#endif // MSGQUEUE_H
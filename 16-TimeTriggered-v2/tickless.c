@@ -0,0 +1,181 @@
+/**
+ * @file    tickless.c
+ *
+ * @note    Tickless idle for the Time Triggered Executive
+ *
+ * @note    LPTIM1 counts continuously at LSE/8 (4096 Hz) from 0 to 0xFFFF. A
+ *          sleep programs the compare register for the next activation, so it
+ *          is at most 16 s long. The counter is read before and after it, so
+ *          an earlier wakeup by another interrupt is compensated too
+ *
+ * @note    LPTIM1 wakes the core from Stop mode through EXTI line 23
+ *
+ * @note    The debugger loses the connection in Stop mode unless DBGMCU_CR
+ *          DBG_STOP is set
+ */
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "tte.h"
+#include "tickless.h"
+
+/**
+ * @brief   LPTIM1 parameters
+ */
+///@{
+#define LPTIM_FREQ                  (LSE_FREQ/8)
+#define LPTIM_MAXCOUNT              0xFFFF
+/// Longest sleep in ticks, with a margin for the compare write (CMPOK)
+#define TICKLESS_MAXTICKS   ((uint32_t) (((uint64_t) (LPTIM_MAXCOUNT-16)*TICKLESS_TICKFREQ)/LPTIM_FREQ))
+///@}
+
+/// Fraction of tick carried between sleeps (in 1/LPTIM_FREQ of a tick)
+static uint32_t tickless_remainder = 0;
+
+/// Ticks slept
+static uint32_t tickless_sleepticks = 0;
+
+/**
+ * @brief   lptim_read
+ *
+ * @note    CNT is in the LSE domain. It is valid when two reads are equal
+ */
+static uint32_t
+lptim_read(void) {
+uint32_t c1,c2;
+
+    c2 = LPTIM1->CNT;
+    do {
+        c1 = c2;
+        c2 = LPTIM1->CNT;
+    } while( c1 != c2 );
+    return c1;
+}
+
+/**
+ * @brief   LP_TIMER1_IRQHandler
+ *
+ * @note    Only wakes the core up
+ */
+void
+LP_TIMER1_IRQHandler(void) {
+
+    LPTIM1->ICR = LPTIM_ICR_CMPMCF;
+    EXTI->PR = EXTI_PR_PR23;
+}
+
+/**
+ * @brief   Tickless_Init
+ *
+ * @note    Starts the LSE, when not running, and LPTIM1
+ */
+void
+Tickless_Init(void) {
+
+    // Access to the backup domain for the LSE
+    RCC->APB1ENR |= RCC_APB1ENR_PWREN;
+    __DSB();
+    PWR->CR1 |= PWR_CR1_DBP;
+    if( (RCC->BDCR&RCC_BDCR_LSERDY) == 0 ) {
+        RCC->BDCR |= RCC_BDCR_LSEON;
+        while( (RCC->BDCR&RCC_BDCR_LSERDY) == 0 ) {}
+    }
+
+    // LPTIM1 clocked by LSE
+    RCC->DCKCFGR2 = (RCC->DCKCFGR2&~RCC_DCKCFGR2_LPTIM1SEL)
+                   |RCC_DCKCFGR2_LPTIM1SEL_0|RCC_DCKCFGR2_LPTIM1SEL_1;
+    RCC->APB1ENR |= RCC_APB1ENR_LPTIM1EN;
+    __DSB();
+
+    // CFGR and IER can only be written with the timer disabled
+    LPTIM1->CR   = 0;
+    LPTIM1->CFGR = LPTIM_CFGR_PRESC_0|LPTIM_CFGR_PRESC_1;      // /8
+    LPTIM1->IER  = LPTIM_IER_CMPMIE;
+    LPTIM1->CR   = LPTIM_CR_ENABLE;
+    LPTIM1->ARR  = LPTIM_MAXCOUNT;
+    while( (LPTIM1->ISR&LPTIM_ISR_ARROK) == 0 ) {}
+    LPTIM1->ICR  = LPTIM_ICR_ARROKCF;
+    LPTIM1->CR  |= LPTIM_CR_CNTSTRT;
+
+    // Wakeup from Stop mode
+    EXTI->IMR  |= EXTI_IMR_MR23;
+    EXTI->RTSR |= EXTI_RTSR_TR23;
+
+    NVIC_SetPriority(LPTIM1_IRQn,0);
+    NVIC_ClearPendingIRQ(LPTIM1_IRQn);
+    NVIC_EnableIRQ(LPTIM1_IRQn);
+}
+
+/**
+ * @brief   Tickless_Idle
+ *
+ * @note    Must be called in main loop after Task_Dispatch
+ *
+ * @note    It sleeps until the tick before the next activation, so that tick
+ *          is given by SysTick as usual. When the next activation is nearer
+ *          than TICKLESS_MINTICKS, it only waits for the next interrupt
+ */
+void
+Tickless_Idle(int mode) {
+uint32_t ticks,start,counts,elapsed;
+
+    __disable_irq();
+    ticks = Task_GetIdleTicks();
+    if( mode == TICKLESS_NONE || ticks < TICKLESS_MINTICKS ) {
+        if( ticks > 0 )
+            __WFI();        // taken after __enable_irq
+        __enable_irq();
+        return;
+    }
+    ticks--;
+    if( ticks > TICKLESS_MAXTICKS )
+        ticks = TICKLESS_MAXTICKS;
+
+    // Stop SysTick. A tick pending stays in the counter of tte-v2.c
+    SysTick->CTRL &= ~(SysTick_CTRL_ENABLE_Msk|SysTick_CTRL_TICKINT_Msk);
+
+    counts = (ticks*LPTIM_FREQ)/TICKLESS_TICKFREQ;
+    start  = lptim_read();
+    LPTIM1->ICR = LPTIM_ICR_CMPMCF|LPTIM_ICR_CMPOKCF;
+    LPTIM1->CMP = (start+counts)&LPTIM_MAXCOUNT;
+    while( (LPTIM1->ISR&LPTIM_ISR_CMPOK) == 0 ) {}
+    NVIC_ClearPendingIRQ(LPTIM1_IRQn);
+
+    if( mode == TICKLESS_STOP ) {
+        PWR->CR1 = (PWR->CR1&~PWR_CR1_PDDS)|PWR_CR1_LPDS;
+        SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+    }
+    __DSB();
+    __WFI();
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+
+    if( mode == TICKLESS_STOP ) {
+        // The core runs from HSI after Stop mode
+        SystemConfigMainPLL(&MainPLLConfiguration_200MHz);
+        SystemSetCoreClock(CLOCKSRC_PLL,1);
+    }
+
+    // Compensate the ticks elapsed (carrying the fraction)
+    elapsed = (lptim_read()-start)&LPTIM_MAXCOUNT;
+    tickless_remainder += elapsed*TICKLESS_TICKFREQ;
+    ticks = tickless_remainder/LPTIM_FREQ;
+    tickless_remainder %= LPTIM_FREQ;
+    tickless_sleepticks += ticks;
+
+    __enable_irq();
+    Task_Advance(ticks);
+
+    SysTick->VAL   = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk|SysTick_CTRL_TICKINT_Msk;
+}
+
+/**
+ * @brief   Tickless_GetSleepTicks
+ *
+ * @note    Ticks spent in Sleep or Stop mode since reset
+ */
+uint32_t
+Tickless_GetSleepTicks(void) {
+
+    return tickless_sleepticks;
+}
@@ -0,0 +1,45 @@
+#ifndef TICKLESS_H
+#define TICKLESS_H
+/**
+ * @file    tickless.h
+ *
+ * @note    Tickless idle for the Time Triggered Executive
+ *
+ * @note    Between activations, SysTick is stopped and LPTIM1, clocked by the
+ *          LSE (32768 Hz), wakes the core up when the next task is due. The
+ *          ticks elapsed are then given to the kernel by Task_Advance
+ *
+ * @note    In Stop mode the PLL and HSE are turned off and the clock is
+ *          configured again at wakeup, taking some tens of microseconds
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Modes
+ */
+///@{
+#define TICKLESS_NONE               0       // SysTick runs, WFI between ticks
+#define TICKLESS_SLEEP              1       // Sleep mode (clocks running)
+#define TICKLESS_STOP               2       // Stop mode (main regulator in low power)
+///@}
+
+/**
+ * @brief   Parameters
+ */
+///@{
+/// Tick frequency of the kernel (SysTick)
+#ifndef TICKLESS_TICKFREQ
+#define TICKLESS_TICKFREQ           1000
+#endif
+/// Idle ticks below which SysTick is kept running
+#ifndef TICKLESS_MINTICKS
+#define TICKLESS_MINTICKS           3
+#endif
+///@}
+
+void     Tickless_Init(void);
+void     Tickless_Idle(int mode);
+uint32_t Tickless_GetSleepTicks(void);
+
+#endif // TICKLESS_H
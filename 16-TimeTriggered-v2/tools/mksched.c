@@ -0,0 +1,254 @@
+/**
+ * @file    mksched.c
+ *
+ * @note    Builds the static schedule of the Time Triggered Executive
+ *          (TaskSchedule, see tte.h) from a list of tasks
+ *
+ * @note    Host program. Built with make mksched. Usage
+ *
+ *          mksched [-t tick] [-m maxticks] schedule.txt > schedule.h
+ *
+ *          Each line of schedule.txt has the name of the task function, its
+ *          period in ticks and its WCET in us. tick is the tick length in us
+ *          (1000 by default). # starts a comment
+ *
+ * @note    The offsets are assigned in rate monotonic order (shortest period
+ *          first). Each task gets the offset that gives the smallest maximal
+ *          load of the ticks where it runs, so the tasks do not cluster. The
+ *          order in a tick is the same, so a shorter period runs first
+ *
+ * @note    It fails when the hyperperiod (least common multiple of the
+ *          periods) is longer than maxticks (10000 by default) or when the
+ *          load of a tick is larger than the tick
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define MAXTASKS 64
+#define MAXNAME  64
+
+/**
+ * @brief   Tasks read
+ */
+static struct {
+    char        name[MAXNAME];
+    unsigned    period;             // ticks
+    unsigned    wcet;               // us
+    unsigned    offset;             // ticks
+    int         line;
+} tasks[MAXTASKS];
+static int ntasks = 0;
+
+static int order[MAXTASKS];
+
+static unsigned long
+gcd(unsigned long a, unsigned long b) {
+unsigned long t;
+
+    while( b ) {
+        t = a%b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static int
+cmptasks(const void *a, const void *b) {
+int ia = *(const int *) a, ib = *(const int *) b;
+
+    if( tasks[ia].period != tasks[ib].period )
+        return tasks[ia].period < tasks[ib].period ? -1 : 1;
+    if( tasks[ia].wcet != tasks[ib].wcet )
+        return tasks[ia].wcet > tasks[ib].wcet ? -1 : 1;
+    return ia-ib;
+}
+
+static void
+usage(void) {
+
+    fprintf(stderr,"Usage: mksched [-t tick] [-m maxticks] schedule.txt > schedule.h\n");
+    exit(1);
+}
+
+int
+main(int argc, char *argv[]) {
+const char *fn = 0;
+unsigned long tick = 1000, maxticks = 10000, hp = 1;
+unsigned long *load;
+unsigned long best,bestsum,m,sum,peak,total;
+unsigned o,bo,t;
+int i,k,n,lineno = 0;
+char line[256], name[MAXNAME];
+unsigned period,wcet;
+FILE *f;
+
+    for(i=1;i<argc;i++) {
+        if( strcmp(argv[i],"-t") == 0 && i+1 < argc )
+            tick = strtoul(argv[++i],0,0);
+        else if( strcmp(argv[i],"-m") == 0 && i+1 < argc )
+            maxticks = strtoul(argv[++i],0,0);
+        else if( argv[i][0] != '-' && fn == 0 )
+            fn = argv[i];
+        else
+            usage();
+    }
+    if( !fn || tick == 0 )
+        usage();
+
+    f = fopen(fn,"r");
+    if( !f ) {
+        fprintf(stderr,"mksched: cannot open %s\n",fn);
+        return 1;
+    }
+    while( fgets(line,sizeof(line),f) ) {
+        char *p = strchr(line,'#');
+        lineno++;
+        if( p ) *p = 0;
+        n = sscanf(line,"%63s %u %u",name,&period,&wcet);
+        if( n <= 0 )
+            continue;
+        if( n != 3 || period == 0 ) {
+            fprintf(stderr,"mksched: %s:%d: expected name period wcet\n",fn,lineno);
+            return 1;
+        }
+        if( ntasks == MAXTASKS ) {
+            fprintf(stderr,"mksched: more than %d tasks\n",MAXTASKS);
+            return 1;
+        }
+        strcpy(tasks[ntasks].name,name);
+        tasks[ntasks].period = period;
+        tasks[ntasks].wcet   = wcet;
+        tasks[ntasks].line   = lineno;
+        ntasks++;
+    }
+    fclose(f);
+    if( ntasks == 0 ) {
+        fprintf(stderr,"mksched: no tasks in %s\n",fn);
+        return 1;
+    }
+
+    // Hyperperiod
+    for(i=0;i<ntasks;i++) {
+        hp = hp/gcd(hp,tasks[i].period)*tasks[i].period;
+        if( hp > maxticks ) {
+            fprintf(stderr,"mksched: hyperperiod longer than %lu ticks (%s)\n",
+                    maxticks,tasks[i].name);
+            return 1;
+        }
+    }
+
+    // Offsets, shortest period first
+    for(i=0;i<ntasks;i++)
+        order[i] = i;
+    qsort(order,ntasks,sizeof(order[0]),cmptasks);
+    load = calloc(hp,sizeof(load[0]));
+    if( !load )
+        return 1;
+    for(k=0;k<ntasks;k++) {
+        i = order[k];
+        best = (unsigned long) -1;
+        bestsum = 0;
+        bo = 0;
+        for(o=0;o<tasks[i].period;o++) {
+            m = 0;
+            sum = 0;
+            for(t=o;t<hp;t+=tasks[i].period) {
+                if( load[t] > m ) m = load[t];
+                sum += load[t];
+            }
+            if( m < best || (m == best && sum < bestsum) ) {
+                best = m;
+                bestsum = sum;
+                bo = o;
+            }
+        }
+        tasks[i].offset = bo;
+        for(t=bo;t<hp;t+=tasks[i].period)
+            load[t] += tasks[i].wcet;
+    }
+
+    // Verification
+    peak  = 0;
+    total = 0;
+    for(t=0;t<hp;t++) {
+        if( load[t] > peak ) peak = load[t];
+        total += load[t];
+    }
+    fprintf(stderr,"mksched: %d tasks, hyperperiod %lu ticks, peak load %lu us of %lu (%lu%%), "
+            "utilization %lu%%\n",ntasks,hp,peak,tick,peak*100/tick,total*100/(hp*tick));
+    if( peak > tick ) {
+        for(t=0;t<hp;t++) {
+            if( load[t] > tick ) {
+                fprintf(stderr,"mksched: tick %u has a load of %lu us\n",t,load[t]);
+                break;
+            }
+        }
+        return 1;
+    }
+
+    n = 0;
+    for(i=0;i<ntasks;i++)
+        n += hp/tasks[i].period;
+    if( n > 0xFFFF ) {
+        fprintf(stderr,"mksched: more than 65535 activations in the hyperperiod\n");
+        return 1;
+    }
+
+    // Output
+    printf("/**\n * @file    schedule.h\n *\n * @note    Generated by mksched from %s\n",fn);
+    printf(" *\n * @note    Hyperperiod %lu ticks of %lu us, peak load %lu us\n",hp,tick,peak);
+    printf(" *\n *          task                     period    wcet  offset\n");
+    for(k=0;k<ntasks;k++) {
+        i = order[k];
+        printf(" *          %-24s %6u  %6u  %6u\n",tasks[i].name,tasks[i].period,
+                tasks[i].wcet,tasks[i].offset);
+    }
+    printf(" */\n\n#include \"tte.h\"\n\n");
+    for(k=0;k<ntasks;k++)
+        printf("void %s(void);\n",tasks[order[k]].name);
+
+    printf("\nstatic void (* const schedule_tasks[%d])(void) = {\n",ntasks);
+    for(k=0;k<ntasks;k++)
+        printf("    %s,\n",tasks[order[k]].name);
+    printf("};\n\n");
+
+    printf("static const uint16_t schedule_index[%lu] = {",hp+1);
+    n = 0;
+    for(t=0;t<=hp;t++) {
+        printf("%s%d,",(t%16)?" ":"\n    ",n);
+        if( t == hp )
+            break;
+        for(k=0;k<ntasks;k++) {
+            i = order[k];
+            if( t%tasks[i].period == tasks[i].offset )
+                n++;
+        }
+    }
+    printf("\n};\n\n");
+
+    printf("static const uint8_t schedule_list[%d] = {",n ? n : 1);
+    n = 0;
+    for(t=0;t<hp;t++) {
+        for(k=0;k<ntasks;k++) {
+            i = order[k];
+            if( t%tasks[i].period == tasks[i].offset )
+                printf("%s%d,",(n++%16)?" ":"\n    ",k);
+        }
+    }
+    if( n == 0 )
+        printf("0");
+    printf("\n};\n\n");
+
+    printf("static const TaskSchedule schedule = {\n");
+    printf("    %lu,\n    %d,\n    schedule_tasks,\n    schedule_index,\n    schedule_list\n};\n",
+            hp,ntasks);
+    free(load);
+    return 0;
+}
@@ -6,6 +6,31 @@
  *
  * @note Based on the one found in Engineering Reliable Embedded System.
  *
+ * @note The tasks waiting for activation are kept in a delta queue, ordered
+ *       by activation time. Each entry stores the number of ticks after the
+ *       previous one, so a tick only decrements the first entry and runs the
+ *       ones that reach zero. Tasks due in the same tick are ordered by
+ *       priority (0 is the highest) and then by insertion order
+ *
+ * @note Each activation is measured with the cycle counter (DWT->CYCCNT): the
+ *       execution time and the release delay, from the tick interrupt to the
+ *       start of the task. A task with a budget (WCET) reports the activations
+ *       longer than it to the budget handler
+ *
+ * @note Preemptive tasks (Task_AddPreemptive) have their own queue, processed
+ *       at each tick in the PendSV interrupt. It has the lowest priority, just
+ *       below SysTick, so they preempt the cooperative tasks of the main loop
+ *       but not the other interrupts. They must be short and must not call
+ *       Task_Add or Task_Delete
+ *
+ * @note A static schedule built offline (Task_SetSchedule) can be used
+ *       instead of or together with the queues. Its tasks run first in each
+ *       tick, from a table indexed by the tick in the hyperperiod
+ *
+ * @note The overload policy (Task_SetOverloadPolicy) decides what is done
+ *       with the ticks that a long task left waiting: run them all, skip the
+ *       missed releases or drop the low priority tasks until it is on time
+ *
  */
 
 #include <stdint.h>
@@ -30,8 +55,43 @@ static inline void __disable_irq(void)
 }
 ///@}
 
+/**
+ * @brief Cycle counter registers
+ *
+ * From CMSIS core_cm7.h
+ */
+///@{
+#define TASK_DEMCR          (*(volatile uint32_t *) 0xE000EDFC)
+#define TASK_DWT_CTRL       (*(volatile uint32_t *) 0xE0001000)
+#define TASK_DWT_CYCCNT     (*(volatile uint32_t *) 0xE0001004)
+#define TASK_DWT_LAR        (*(volatile uint32_t *) 0xE0001FB0)
+#define TASK_DEMCR_TRCENA   (1UL<<24)
+#define TASK_DWT_CYCCNTENA  (1UL<<0)
+///@}
+
+/**
+ * @brief PendSV and SysTick registers
+ *
+ * From CMSIS core_cm7.h. Priorities with 4 bits (STM32F7)
+ */
+///@{
+#define TASK_SCB_ICSR           (*(volatile uint32_t *) 0xE000ED04)
+#define TASK_SCB_SHPR_PENDSV    (*(volatile uint8_t *) 0xE000ED22)
+#define TASK_SCB_SHPR_SYSTICK   (*(volatile uint8_t *) 0xE000ED23)
+#define TASK_ICSR_PENDSVSET     (1UL<<28)
+#define TASK_PENDSV_PRIO        0xF0
+#define TASK_SYSTICK_PRIO       0xE0
+///@}
+
 /// task tick counter
-static uint32_t task_tickcounter = 0;
+static volatile uint32_t task_tickcounter = 0;
+
+/// tick counter of the preemptive tasks (decremented in PendSV)
+static volatile uint32_t task_preempttickcounter = 0;
+
+/// cycle counter at the last tick and cycles between the last two ticks
+static volatile uint32_t task_ticktime = 0;
+static volatile uint32_t task_tickcycles = 0;
 
 /**
  * @brief Task Info
@@ -41,7 +101,13 @@ static uint32_t task_tickcounter = 0;
 typedef struct {
     void    (*task)(void);  // pointer to function
     uint32_t    period;     // period, i.e. time between activations
-    uint32_t    delay;      // time to next activation
+    uint32_t    delay;      // ticks after the previous entry of the queue
+    uint32_t    priority;   // order in the same tick, 0 is the highest
+    int         next;       // next entry of the queue or -1
+    int         queued;     // in the queue (not when running)
+    int         preemptive; // run in PendSV
+    uint32_t    budget;     // WCET in cycles, 0 when not checked
+    TaskStats   stats;      // measurements (cycles)
 } TaskInfo;
 
 
@@ -50,43 +116,420 @@ typedef struct {
 #define TASK_MAXCNT 10
 #endif
 
-// Forward definition of Task_Delete
-uint32_t Task_Delete(uint32_t );
-
 /// Task info table
 static TaskInfo taskinfo[TASK_MAXCNT];
 
+/// First entry of the delta queues or -1
+///@{
+static int task_head = -1;
+static int task_preempthead = -1;
+///@}
+
+/**
+ * @brief Overrun information
+ */
+///@{
+static uint32_t task_overruns = 0;
+static uint32_t task_maxbacklog = 0;
+static uint32_t task_preemptoverruns = 0;
+static void (*task_overrunhandler)(uint32_t backlog) = 0;
+static void (*task_budgethandler)(uint32_t taskno, uint32_t cycles) = 0;
+///@}
+
+/**
+ * @brief Overload policy and ticks and releases skipped by it
+ */
+///@{
+static uint32_t task_overloadpolicy = TASK_OVERLOAD_POLICY;
+static uint32_t task_shedpriority = TASK_OVERLOAD_SHEDPRIORITY;
+static uint32_t task_skippedticks = 0;
+static uint32_t task_skippedreleases = 0;
+///@}
+
+/// Priority limit of task_runtick that runs all tasks
+#define TASK_ALLPRIORITIES UINT32_MAX
+
+/**
+ * @brief Static schedule and tick in its hyperperiod
+ */
+///@{
+static const TaskSchedule *task_schedule = 0;
+static uint32_t task_scheduletick = 0;
+///@}
+
+/**
+ * @brief Task Clear Stats
+ */
+static void
+task_clearstats(TaskStats *st) {
+
+    st->runs         = 0;
+    st->execmin      = UINT32_MAX;
+    st->execmax      = 0;
+    st->exectotal    = 0;
+    st->releasemin   = UINT32_MAX;
+    st->releasemax   = 0;
+    st->budgetovers  = 0;
+}
+
+/**
+ * @brief Task Update Stats
+ *
+ * @note Called after each activation with its release delay and execution
+ *       time
+ */
+static void
+task_updatestats(int taskno, uint32_t release, uint32_t exec) {
+TaskInfo *p = &taskinfo[taskno];
+TaskStats *st = &p->stats;
+
+    st->runs++;
+    st->exectotal += exec;
+    if( exec < st->execmin ) st->execmin = exec;
+    if( exec > st->execmax ) st->execmax = exec;
+    if( release < st->releasemin ) st->releasemin = release;
+    if( release > st->releasemax ) st->releasemax = release;
+    if( p->budget && exec > p->budget ) {
+        st->budgetovers++;
+        if( task_budgethandler )
+            task_budgethandler(taskno,exec);
+    }
+}
+
+/**
+ * @brief Task Insert
+ *
+ * @note Puts task taskno in the queue head, to be run after delay ticks (>0)
+ * @note Among the tasks due in the same tick, it goes after the ones with the
+ *       same or a higher priority
+ */
+static void
+task_insert(int *head, int taskno, uint32_t delay) {
+TaskInfo *p = &taskinfo[taskno];
+TaskInfo *q;
+int *link = head;
+
+    while( *link >= 0 ) {
+        q = &taskinfo[*link];
+        if( delay < q->delay )
+            break;
+        if( delay == q->delay && p->priority < q->priority )
+            break;
+        delay -= q->delay;
+        link = &q->next;
+    }
+    if( *link >= 0 )
+        taskinfo[*link].delay -= delay;
+    p->delay  = delay;
+    p->next   = *link;
+    p->queued = 1;
+    *link = taskno;
+}
+
+/**
+ * @brief Task Remove
+ *
+ * @note Takes task taskno out of the queue head. Its delay goes to the next one
+ */
+static void
+task_remove(int *head, int taskno) {
+TaskInfo *p = &taskinfo[taskno];
+int *link = head;
+
+    if( !p->queued )
+        return;
+    while( *link >= 0 && *link != taskno )
+        link = &taskinfo[*link].next;
+    if( *link < 0 )
+        return;
+    *link = p->next;
+    if( p->next >= 0 )
+        taskinfo[p->next].delay += p->delay;
+    p->next   = -1;
+    p->queued = 0;
+}
+
+/**
+ * @brief Task Queue
+ *
+ * @note Queue of the class of task taskno
+ */
+static inline int *
+task_queue(int taskno) {
+
+    return taskinfo[taskno].preemptive ? &task_preempthead : &task_head;
+}
+
+/**
+ * @brief Task Run Tick
+ *
+ * @note Processes a tick of queue head: decrements its first entry and runs
+ *       the tasks that reach zero. release is the cycle counter at the tick
+ * @note The tasks with a priority above maxpriority are not run. Their
+ *       release is counted as skipped and they are rescheduled
+ */
+static void
+task_runtick(int *head, uint32_t release, uint32_t maxpriority) {
+int i;
+TaskInfo *p;
+uint32_t start;
+
+    if( *head < 0 )
+        return;
+    taskinfo[*head].delay--;
+    while( *head >= 0 && taskinfo[*head].delay == 0 ) {
+        i = *head;
+        p = &taskinfo[i];
+        *head     = p->next;
+        p->next   = -1;
+        p->queued = 0;
+        if( p->priority > maxpriority ) {
+            task_skippedreleases++;
+            task_insert(head,i,p->period?p->period:1);
+            continue;
+        }
+        start = TASK_DWT_CYCCNT;
+        p->task();      // call task function
+        if( p->task == 0 )  // deleted itself
+            continue;
+        task_updatestats(i,start-release,TASK_DWT_CYCCNT-start);
+        if( p->period == 0 ) { // one time tasks are dangerous
+            Task_Delete(i);
+        } else {
+            task_insert(head,i,p->period);
+        }
+    }
+}
+
+/**
+ * @brief Task Run Schedule
+ *
+ * @note Runs the tasks of the static schedule for the current tick
+ */
+static void
+task_runschedule(void) {
+const TaskSchedule *s = task_schedule;
+uint32_t k;
+
+    for(k=s->index[task_scheduletick];k<s->index[task_scheduletick+1];k++)
+        s->tasks[s->list[k]]();
+    if( ++task_scheduletick >= s->hyperperiod )
+        task_scheduletick = 0;
+}
+
+/**
+ * @brief Task Skip Ticks
+ *
+ * @note Processes n ticks of the cooperative queue and of the static schedule
+ *       without running their tasks (TASK_OVERLOAD_SKIP). They are the ticks
+ *       before the current one, whose release is given
+ * @note A task released in them runs once, now, in priority order. It keeps
+ *       its phase: the next release is the first one after the current tick.
+ *       The releases in between are counted as skipped
+ */
+static void
+task_skipticks(uint32_t n, uint32_t release) {
+int late[TASK_MAXCNT];
+int nlate = 0;
+int i,k;
+TaskInfo *p;
+uint32_t left = n;
+uint32_t next,start;
+
+    task_skippedticks += n;
+    if( task_schedule )
+        task_scheduletick = (task_scheduletick+n)%task_schedule->hyperperiod;
+
+    while( task_head >= 0 && taskinfo[task_head].delay <= left ) {
+        // left+1 ticks from the release of the first entry to the current one
+        left -= taskinfo[task_head].delay;
+        taskinfo[task_head].delay = 0;
+        while( task_head >= 0 && taskinfo[task_head].delay == 0 ) {
+            i = task_head;
+            p = &taskinfo[i];
+            task_head = p->next;
+            p->next   = -1;
+            p->queued = 0;
+            if( p->period ) {
+                next = p->period;
+                while( next <= left+1 ) {
+                    next += p->period;
+                    task_skippedreleases++;
+                }
+                task_insert(&task_head,i,next);
+            }
+            // ordered by priority, then by release
+            for(k=nlate;k>0&&taskinfo[late[k-1]].priority>p->priority;k--)
+                late[k] = late[k-1];
+            late[k] = i;
+            nlate++;
+        }
+    }
+    if( task_head >= 0 )
+        taskinfo[task_head].delay -= left;
+
+    for(k=0;k<nlate;k++) {
+        i = late[k];
+        p = &taskinfo[i];
+        if( p->task == 0 )  // deleted by a previous one
+            continue;
+        start = TASK_DWT_CYCCNT;
+        p->task();
+        if( p->task == 0 )  // deleted itself
+            continue;
+        task_updatestats(i,start-release,TASK_DWT_CYCCNT-start);
+        if( p->period == 0 )
+            Task_Delete(i);
+    }
+}
+
+/**
+ * @brief Task Take Tick
+ *
+ * @note Takes the next tick waiting for Task_Dispatch. Returns 0 when there
+ *       is none. Must be called with the interrupts disabled
+ * @note skip gets the ticks to skip before it (TASK_OVERLOAD_SKIP) and
+ *       maxpriority the priority limit of its tasks (TASK_OVERLOAD_SHED)
+ */
+static uint32_t
+task_taketick(uint32_t *release, uint32_t *skip, uint32_t *maxpriority) {
+
+    *skip = 0;
+    *maxpriority = TASK_ALLPRIORITIES;
+    if( task_tickcounter == 0 )
+        return 0;
+    if( task_overloadpolicy == TASK_OVERLOAD_SKIP ) {
+        *skip = task_tickcounter-1;
+        task_tickcounter = 1;
+    }
+    task_tickcounter--;
+    if( task_overloadpolicy == TASK_OVERLOAD_SHED && task_tickcounter > 0 )
+        *maxpriority = task_shedpriority;
+    *release = task_ticktime-task_tickcounter*task_tickcycles;
+    return 1;
+}
+
+/**
+ * @brief Task Check Backlog
+ *
+ * @note backlog is the number of ticks found waiting after a tick. The first
+ *       one after a tick on time is an overrun. Returns 1 when late
+ */
+static int
+task_checkbacklog(uint32_t backlog, int late) {
+
+    if( backlog > task_maxbacklog )
+        task_maxbacklog = backlog;
+    if( backlog && !late ) {
+        task_overruns++;
+        if( task_overrunhandler )
+            task_overrunhandler(backlog);
+    }
+    return backlog != 0;
+}
+
 /**
  * @brief Task Init
  * @note  Initialization of TTE Kernel
+ * @note  Must be called after SysTick_Config, which sets the SysTick priority
  */
 uint32_t
 Task_Init(void) {
 int i;
+
+    TASK_DEMCR |= TASK_DEMCR_TRCENA;
+    TASK_DWT_LAR = 0xC5ACCE55;              // Unlock access on Cortex-M7
+    TASK_DWT_CTRL |= TASK_DWT_CYCCNTENA;
+
+    // SysTick preempts PendSV, so a preemptive tick overrun is seen
+    TASK_SCB_SHPR_PENDSV  = TASK_PENDSV_PRIO;
+    TASK_SCB_SHPR_SYSTICK = TASK_SYSTICK_PRIO;
+
+    __disable_irq();
+    task_head = -1;
+    task_preempthead = -1;
+    task_preempttickcounter = 0;
+    __enable_irq();
     for(i=0;i<TASK_MAXCNT;i++) {
+        taskinfo[i].queued = 0;
         Task_Delete(i);
     }
+    task_overruns   = 0;
+    task_maxbacklog = 0;
+    task_preemptoverruns = 0;
+    task_skippedticks    = 0;
+    task_skippedreleases = 0;
+    task_schedule = 0;
     return 0;
 }
 
 /**
- * @brief Task Add
+ * @brief Task Add Class
+ *
+ * @note Common part of Task_AddWithPriority and Task_AddPreemptive
+ */
+static int32_t
+task_add( void (*task)(void), uint32_t period, uint32_t delay,
+          uint32_t priority, int preemptive ) {
+int taskno = 0;
+
+    while( (taskno<TASK_MAXCNT) && taskinfo[taskno].task ) taskno++;
+    if( taskno == TASK_MAXCNT ) return -1;
+
+    taskinfo[taskno].period     = period;
+    taskinfo[taskno].priority   = priority;
+    taskinfo[taskno].preemptive = preemptive;
+    taskinfo[taskno].budget     = 0;
+    task_clearstats(&taskinfo[taskno].stats);
+    __disable_irq();
+    taskinfo[taskno].task       = task;
+    task_insert(task_queue(taskno),taskno,delay+1);
+    __enable_irq();
+
+    return taskno;
+}
+
+/**
+ * @brief Task Add With Priority
  *
  * @note Add task to Kernel
+ * @note It runs first in the tick after delay ticks, and then every period
+ *       ticks. A period of 0 runs it once
  * @note delay can be used to serialize task activation and avoid clustering
  *       in a certain time
+ * @note Returns the task number or -1 when the table is full
  */
-uint32_t
+int32_t
+Task_AddWithPriority( void (*task)(void), uint32_t period, uint32_t delay,
+                      uint32_t priority ) {
+
+    return task_add(task,period,delay,priority,0);
+}
+
+/**
+ * @brief Task Add
+ *
+ * @note Add task with TASK_PRIORITY_DEFAULT
+ */
+int32_t
 Task_Add( void (*task)(void), uint32_t period, uint32_t delay ) {
-int taskno = 0;
 
-    while( (taskno<TASK_MAXCNT) && taskinfo[taskno].task ) taskno++;
-    if( taskno == TASK_MAXCNT ) return 1;
+    return Task_AddWithPriority(task,period,delay,TASK_PRIORITY_DEFAULT);
+}
 
-    taskinfo[taskno].task   = task;
-    taskinfo[taskno].period = period;
+/**
+ * @brief Task Add Preemptive
+ *
+ * @note Add a task run in the PendSV interrupt, preempting the cooperative
+ *       ones. The timing is the one of Task_Add. Tasks due in the same tick
+ *       run in priority order
+ * @note For short work with hard deadlines, like a control loop
+ */
+int32_t
+Task_AddPreemptive( void (*task)(void), uint32_t period, uint32_t delay,
+                    uint32_t priority ) {
 
-    return taskno;
+    return task_add(task,period,delay,priority,1);
 }
 
 /**
@@ -94,12 +537,20 @@ int taskno = 0;
  *
  * @note Remove task from Kernel
  * @note Use with caution because it modifies the scheduling calculation
+ * @note A task can delete itself
  */
 uint32_t
 Task_Delete(uint32_t taskno) {
 
+    if( taskno >= TASK_MAXCNT )
+        return 1;
+    __disable_irq();
+    task_remove(task_queue(taskno),taskno);
     taskinfo[taskno].task   = 0;
     taskinfo[taskno].period = 0;
+    taskinfo[taskno].delay  = 0;
+    taskinfo[taskno].next   = -1;
+    __enable_irq();
     return 0;
 }
 
@@ -108,47 +559,37 @@ Task_Delete(uint32_t taskno) {
  *
  * @note Run tasks if they are ready
  * @note Must be called in main loop
+ * @note Each pending tick decrements only the first entry of the queue
+ * @note When a tick arrives before the tasks of the previous one are done, it
+ *       is an overrun. It is counted and reported to the overrun handler with
+ *       the number of ticks waiting, once until they are all processed
+ * @note The ticks waiting are processed as set by Task_SetOverloadPolicy
  */
 uint32_t
 Task_Dispatch(void) {
-int i;
-TaskInfo *p;
-uint32_t dispatch;
+uint32_t dispatch,backlog;
+uint32_t release = 0;
+uint32_t skip,maxpriority;
+int late = 0;
 
     __disable_irq();
-    if( task_tickcounter > 0 ) {
-        task_tickcounter--;
-        dispatch = 1;
-    }
+    dispatch = task_taketick(&release,&skip,&maxpriority);
     __enable_irq();
-
+    // The ticks skipped here are not seen waiting after the first one
+    late = task_checkbacklog(skip,late);
 
     while( dispatch ) {
-        for(i=0;i<TASK_MAXCNT;i++) {
-            p = &taskinfo[i];
-            if( p->task ) {
-                if( p->delay == 0 ) {
-                    p->task();      // call task function
-                    if( p->period == 0 ) { // one time tasks are dangerous
-                        Task_Delete(i);
-                    } else {
-                        p->delay = p->period;
-                    }
-                } else {
-                    p->delay--;
-                }
-            }
-
-        }
+        if( skip )
+            task_skipticks(skip,release);
+        if( task_schedule )
+            task_runschedule();
+        task_runtick(&task_head,release,maxpriority);
         __disable_irq();
-        if( task_tickcounter > 0 ) {
-            task_tickcounter--;
-            dispatch = 1;
-        } else {
-            dispatch = 0;
-        }
+        backlog = task_tickcounter;
+        dispatch = task_taketick(&release,&skip,&maxpriority);
         __enable_irq();
 
+        late = task_checkbacklog(backlog,late);
     }
     return 0;
 }
@@ -157,23 +598,53 @@ uint32_t dispatch;
  * @brief Task Update
  *
  * @note Must be called only in Timer Interrupt Routine
- * @note Almost nothing happens here
+ * @note Almost nothing happens here. The preemptive tasks run in PendSV, set
+ *       pending here and taken after the return of the timer interrupt
  *
  */
 
 void
 Task_Update(void) {
+uint32_t now = TASK_DWT_CYCCNT;
 
+    task_tickcycles = now-task_ticktime;
+    task_ticktime   = now;
     task_tickcounter++;
+    if( task_preempthead >= 0 ) {
+        task_preempttickcounter++;
+        TASK_SCB_ICSR = TASK_ICSR_PENDSVSET;
+    }
 
     return;
 }
 
+/**
+ * @brief PendSV Handler
+ *
+ * @note Runs the preemptive tasks. A tick that arrives before they are done
+ *       is an overrun. The ticks are processed one by one
+ */
+void
+PendSV_Handler(void) {
+uint32_t release;
+
+    while( task_preempttickcounter > 0 ) {
+        __disable_irq();
+        task_preempttickcounter--;
+        release = task_ticktime-task_preempttickcounter*task_tickcycles;
+        __enable_irq();
+        task_runtick(&task_preempthead,release,TASK_ALLPRIORITIES);
+        if( task_preempttickcounter > 0 )
+            task_preemptoverruns++;
+    }
+}
+
 
 /**
  * @brief Task Modify Period
  *
  * @note CAUTION!!! It can modify all timing calculation
+ * @note The new period is used after the next activation
  *
  */
 uint32_t
@@ -182,3 +653,238 @@ uint32_t t = taskinfo[taskno].period;
     taskinfo[taskno].period = newperiod;
     return t;
 }
+
+/**
+ * @brief Task Get Overruns
+ *
+ * @note Returns the number of overruns, of the cooperative and the preemptive
+ *       tasks. When maxbacklog is not null, it gets the largest number of
+ *       ticks found waiting by Task_Dispatch
+ */
+uint32_t
+Task_GetOverruns(uint32_t *maxbacklog) {
+
+    if( maxbacklog )
+        *maxbacklog = task_maxbacklog;
+    return task_overruns+task_preemptoverruns;
+}
+
+/**
+ * @brief Task Set Overload Policy
+ *
+ * @note Sets the processing of the ticks found waiting by Task_Dispatch, one
+ *       of TASK_OVERLOAD_CATCHUP, TASK_OVERLOAD_SKIP or TASK_OVERLOAD_SHED.
+ *       With the last one, the tasks with a priority above shedpriority are
+ *       dropped while late. Returns the previous policy, which is kept when
+ *       policy is not valid
+ * @note The preemptive tasks always process all ticks
+ */
+uint32_t
+Task_SetOverloadPolicy(uint32_t policy, uint32_t shedpriority) {
+uint32_t t = task_overloadpolicy;
+
+    if( policy > TASK_OVERLOAD_SHED )
+        return t;
+    __disable_irq();
+    task_overloadpolicy = policy;
+    task_shedpriority   = shedpriority;
+    __enable_irq();
+    return t;
+}
+
+/**
+ * @brief Task Get Skipped
+ *
+ * @note Returns the number of ticks skipped by TASK_OVERLOAD_SKIP. When
+ *       releases is not null, it gets the number of task releases not run,
+ *       by TASK_OVERLOAD_SKIP or TASK_OVERLOAD_SHED
+ */
+uint32_t
+Task_GetSkipped(uint32_t *releases) {
+
+    if( releases )
+        *releases = task_skippedreleases;
+    return task_skippedticks;
+}
+
+/**
+ * @brief Task Set Overrun Handler
+ *
+ * @note handler is called by Task_Dispatch (main loop) at each overrun
+ */
+void
+Task_SetOverrunHandler(void (*handler)(uint32_t backlog)) {
+
+    task_overrunhandler = handler;
+}
+
+/**
+ * @brief Task Get Idle Ticks
+ *
+ * @note Returns the number of ticks until the next activation, 0 when ticks
+ *       are waiting for Task_Dispatch or TASK_IDLE_FOREVER without tasks
+ * @note Used by the tickless mode (tickless.c)
+ */
+uint32_t
+Task_GetIdleTicks(void) {
+uint32_t ticks = TASK_IDLE_FOREVER;
+
+    if( task_tickcounter > 0 || task_preempttickcounter > 0 )
+        return 0;
+    if( task_head >= 0 )
+        ticks = taskinfo[task_head].delay;
+    if( task_preempthead >= 0 && taskinfo[task_preempthead].delay < ticks )
+        ticks = taskinfo[task_preempthead].delay;
+    return ticks;
+}
+
+/**
+ * @brief Task Advance
+ *
+ * @note Adds ticks that were not counted by Task_Update (timer stopped)
+ * @note The ones before the next activation are skipped at once. The others
+ *       are left to Task_Dispatch, so a late wakeup is seen as an overrun
+ * @note Must be called in main loop
+ */
+void
+Task_Advance(uint32_t ticks) {
+uint32_t skip;
+
+    __disable_irq();
+    skip = Task_GetIdleTicks();
+    skip = (skip == 0) ? 0 : skip-1;
+    if( skip > ticks )
+        skip = ticks;
+    if( task_head >= 0 )
+        taskinfo[task_head].delay -= skip;
+    if( task_preempthead >= 0 )
+        taskinfo[task_preempthead].delay -= skip;
+    ticks -= skip;
+
+    task_tickcounter += ticks;
+    if( task_preempthead >= 0 && ticks > 0 ) {
+        task_preempttickcounter += ticks;
+        TASK_SCB_ICSR = TASK_ICSR_PENDSVSET;
+    }
+    __enable_irq();
+}
+
+/**
+ * @brief Task Set Budget
+ *
+ * @note Sets the WCET budget of a task in cycles (0 disables the check).
+ *       Returns the previous one
+ */
+uint32_t
+Task_SetBudget(uint32_t taskno, uint32_t cycles) {
+uint32_t t;
+
+    if( taskno >= TASK_MAXCNT )
+        return 0;
+    t = taskinfo[taskno].budget;
+    taskinfo[taskno].budget = cycles;
+    return t;
+}
+
+/**
+ * @brief Task Set Budget Handler
+ *
+ * @note handler is called by Task_Dispatch after each activation longer than
+ *       the budget, with the task number and the cycles used
+ */
+void
+Task_SetBudgetHandler(void (*handler)(uint32_t taskno, uint32_t cycles)) {
+
+    task_budgethandler = handler;
+}
+
+/**
+ * @brief Task Get Stats
+ *
+ * @note Returns 1 when taskno is not used
+ */
+uint32_t
+Task_GetStats(uint32_t taskno, TaskStats *st) {
+
+    if( taskno >= TASK_MAXCNT || taskinfo[taskno].task == 0 )
+        return 1;
+    *st = taskinfo[taskno].stats;
+    return 0;
+}
+
+/**
+ * @brief Task Reset Stats
+ *
+ * @note Clears the measurements of all tasks and the overrun and skip counters
+ */
+void
+Task_ResetStats(void) {
+int i;
+
+    for(i=0;i<TASK_MAXCNT;i++)
+        task_clearstats(&taskinfo[i].stats);
+    task_overruns   = 0;
+    task_maxbacklog = 0;
+    task_skippedticks    = 0;
+    task_skippedreleases = 0;
+}
+
+/**
+ * @brief Task Print Stats
+ *
+ * @note Prints a line for each task with print (e.g. printf). Times are in
+ *       cycles. jitter is the difference between the largest and the
+ *       smallest release delay
+ */
+void
+Task_PrintStats(int (*print)(const char *fmt, ...)) {
+int i;
+TaskInfo *p;
+TaskStats *st;
+
+    print("task class period prio runs execmin execavg execmax budget overs "
+          "releasemin releasemax jitter\n");
+    for(i=0;i<TASK_MAXCNT;i++) {
+        p = &taskinfo[i];
+        st = &p->stats;
+        if( p->task == 0 )
+            continue;
+        if( st->runs == 0 ) {
+            print("%d %c %lu %lu 0\n",i,p->preemptive?'P':'C',
+                    (unsigned long) p->period,(unsigned long) p->priority);
+            continue;
+        }
+        print("%d %c %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu %lu\n",
+                i,
+                p->preemptive?'P':'C',
+                (unsigned long) p->period,
+                (unsigned long) p->priority,
+                (unsigned long) st->runs,
+                (unsigned long) st->execmin,
+                (unsigned long) (st->exectotal/st->runs),
+                (unsigned long) st->execmax,
+                (unsigned long) p->budget,
+                (unsigned long) st->budgetovers,
+                (unsigned long) st->releasemin,
+                (unsigned long) st->releasemax,
+                (unsigned long) (st->releasemax-st->releasemin));
+    }
+    print("overruns %lu maxbacklog %lu skippedticks %lu skippedreleases %lu\n",
+            (unsigned long) task_overruns,(unsigned long) task_maxbacklog,
+            (unsigned long) task_skippedticks,
+            (unsigned long) task_skippedreleases);
+}
+
+/**
+ * @brief Task Set Schedule
+ *
+ * @note Uses the static schedule generated by tools/mksched (schedule.h).
+ *       The next tick is the first one of the hyperperiod. A null pointer
+ *       stops it
+ */
+void
+Task_SetSchedule(const TaskSchedule *schedule) {
+
+    task_scheduletick = 0;
+    task_schedule     = schedule;
+}
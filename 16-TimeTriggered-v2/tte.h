@@ -12,15 +12,92 @@
  *
  ******************************************************************************/
 
+/**
+ * @brief Priority of the tasks added by Task_Add (0 is the highest)
+ */
+#ifndef TASK_PRIORITY_DEFAULT
+#define TASK_PRIORITY_DEFAULT 8
+#endif
+
+/// Returned by Task_GetIdleTicks when there is no task
+#define TASK_IDLE_FOREVER 0xFFFFFFFFUL
+
+/**
+ * @brief Overload policies of Task_Dispatch, for the ticks found waiting
+ *
+ * @note CATCHUP runs all of them back to back. SKIP runs only the last one:
+ *       a task released in the others runs once and keeps its phase. SHED
+ *       runs all of them, but only the tasks with a priority up to
+ *       TASK_OVERLOAD_SHEDPRIORITY while other ticks are waiting
+ */
+///@{
+#define TASK_OVERLOAD_CATCHUP   0
+#define TASK_OVERLOAD_SKIP      1
+#define TASK_OVERLOAD_SHED      2
+#ifndef TASK_OVERLOAD_POLICY
+#define TASK_OVERLOAD_POLICY TASK_OVERLOAD_CATCHUP
+#endif
+#ifndef TASK_OVERLOAD_SHEDPRIORITY
+#define TASK_OVERLOAD_SHEDPRIORITY (TASK_PRIORITY_DEFAULT-1)
+#endif
+///@}
+
+/**
+ * @brief Measurements of a task (cycles of DWT->CYCCNT)
+ *
+ * @note The release delay is the time from the tick interrupt to the start
+ *       of the task. Its variation is the jitter
+ */
+typedef struct {
+    uint32_t    runs;           // activations measured
+    uint32_t    execmin;        // execution time
+    uint32_t    execmax;
+    uint64_t    exectotal;
+    uint32_t    releasemin;     // release delay
+    uint32_t    releasemax;
+    uint32_t    budgetovers;    // activations longer than the budget
+} TaskStats;
+
+/**
+ * @brief Static schedule (generated by tools/mksched)
+ *
+ * @note The tasks of tick t of the hyperperiod are
+ *       tasks[list[index[t]]] to tasks[list[index[t+1]-1]]
+ */
+typedef struct {
+    uint32_t            hyperperiod;    // ticks
+    uint32_t            ntasks;
+    void        (* const *tasks)(void);
+    const uint16_t      *index;         // hyperperiod+1 entries
+    const uint8_t       *list;
+} TaskSchedule;
+
 /**
  * @brief TTE API
  *
  */
 //@{
 uint32_t Task_Init(void);
-uint32_t Task_Add(void (*task)(void), uint32_t period, uint32_t delay);
+ int32_t Task_Add(void (*task)(void), uint32_t period, uint32_t delay);
+ int32_t Task_AddWithPriority(void (*task)(void), uint32_t period, uint32_t delay,
+                              uint32_t priority);
+ int32_t Task_AddPreemptive(void (*task)(void), uint32_t period, uint32_t delay,
+                            uint32_t priority);
 uint32_t Task_Delete(uint32_t i); // Do not use
 uint32_t Task_Dispatch(void);
 void     Task_Update(void);
+uint32_t Task_ModifyPeriod(uint32_t taskno, uint32_t newperiod);
+uint32_t Task_GetOverruns(uint32_t *maxbacklog);
+uint32_t Task_SetOverloadPolicy(uint32_t policy, uint32_t shedpriority);
+uint32_t Task_GetSkipped(uint32_t *releases);
+void     Task_SetOverrunHandler(void (*handler)(uint32_t backlog));
+uint32_t Task_GetIdleTicks(void);
+void     Task_Advance(uint32_t ticks);
+uint32_t Task_SetBudget(uint32_t taskno, uint32_t cycles);
+void     Task_SetBudgetHandler(void (*handler)(uint32_t taskno, uint32_t cycles));
+uint32_t Task_GetStats(uint32_t taskno, TaskStats *st);
+void     Task_ResetStats(void);
+void     Task_PrintStats(int (*print)(const char *fmt, ...));
+void     Task_SetSchedule(const TaskSchedule *schedule);
 //@}
 #endif
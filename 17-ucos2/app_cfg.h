@@ -57,6 +57,11 @@
 
 #define  TASKLED_PRIO                      (10)
 #define  TASKUART_PRIO                     (11)
+#define  TASKPROF_PRIO                     (20)
+#define  SWITCHTEST_PRIO                   (30)    /* Uses 30 to 33 */
+#define  TASKLOG_PRIO                      (25)
+#define  NEWLIBTEST_PRIO                   (12)    /* Uses 12 and 13 */
+#define  MSGBLOCKTEST_PRIO                 (14)    /* Uses 14 and 15 */
 
 /*
 *********************************************************************************************************
@@ -69,6 +74,10 @@
 
 #define TASKLED_STK_SIZE                  100
 #define TASKUART_STK_SIZE                 100
+#define TASKPROF_STK_SIZE                 256
+#define TASKLOG_STK_SIZE                  256
+#define NEWLIBTEST_STK_SIZE               512     /* newlib printf */
+#define MSGBLOCKTEST_STK_SIZE             256
 
 /*
 *********************************************************************************************************
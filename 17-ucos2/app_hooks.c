@@ -30,6 +30,10 @@
 */
 
 #include  <os.h>
+#include  "taskprof.h"
+#include  "tickless.h"
+#include  "syscalls.h"
+#include  "tasklog.h"
 
 
 /*
@@ -106,7 +110,8 @@
 
 void  App_TaskCreateHook (OS_TCB *ptcb)
 {
-    (void)ptcb;
+    Syscalls_TaskCreateHook(ptcb);
+    TaskLog_TaskCreateHook(ptcb);
 }
 
 
@@ -124,7 +129,8 @@ void  App_TaskCreateHook (OS_TCB *ptcb)
 
 void  App_TaskDelHook (OS_TCB *ptcb)
 {
-    (void)ptcb;
+    Syscalls_TaskDelHook(ptcb);
+    TaskLog_TaskDelHook(ptcb);
 }
 
 
@@ -144,6 +150,8 @@ void  App_TaskDelHook (OS_TCB *ptcb)
 #if OS_VERSION >= 251
 void  App_TaskIdleHook (void)
 {
+    Syscalls_IdleHook();
+    Tickless_Idle(TICKLESS_MODE);
 }
 #endif
 
@@ -206,7 +214,8 @@ void  App_TaskReturnHook (OS_TCB  *ptcb)
 #if OS_TASK_SW_HOOK_EN > 0
 void  App_TaskSwHook (void)
 {
-
+    TaskProf_SwHook();
+    Syscalls_SwHook();
 }
 #endif
 
@@ -12,14 +12,25 @@
  ******************************************************************************/
 
 #include <stdio.h>
+#include <string.h>
 #include "stm32f746xx.h"
 #include "system_stm32f746.h"
 #include "led.h"
 #include "uart.h"
 #include "ucos_ii.h"
+#include "taskprof.h"
+#include "tickless.h"
+#include "syscalls.h"
+#include "tasklog.h"
+#ifdef USE_SWITCHTEST
+#include "switchtest.h"
+#endif
+#ifdef USE_MSGBLOCKTEST
+#include "sdram.h"
+#include "msgblock.h"
+#endif
 
 #define DELAYLED                500
-#define DELAYUART               1000
 
 
 /**
@@ -29,6 +40,40 @@
 static OS_STK TaskStartStack[APP_CFG_STARTUP_TASK_STK_SIZE];
 static OS_STK TaskLEDStack[TASKLED_STK_SIZE];
 static OS_STK TaskUARTStack[TASKUART_STK_SIZE];
+static OS_STK TaskProfStack[TASKPROF_STK_SIZE];
+#ifdef USE_NEWLIBTEST
+static OS_STK TaskLogStack[TASKLOG_STK_SIZE];
+static OS_STK TaskNewlibStack[2][NEWLIBTEST_STK_SIZE];
+#endif
+#ifdef USE_MSGBLOCKTEST
+static OS_STK TaskSamplerStack[MSGBLOCKTEST_STK_SIZE];
+static OS_STK TaskProcessStack[MSGBLOCKTEST_STK_SIZE];
+#endif
+
+/**
+ * @brief  Create a task with stack checking
+ *
+ * @note   The stack is cleared, so OSTaskStkChk finds the high water mark
+ *
+ * @note   A task that uses floats must be created with OS_TASK_OPT_SAVE_FP
+ *         in opt and needs 34 more words of stack for the FPU context
+ */
+static void
+CreateTask(void (*task)(void *), OS_STK *stack, INT32U size, INT8U prio, char *name,
+           INT16U opt) {
+INT8U err;
+
+    OSTaskCreateExt(task,                                       // Pointer to task
+                    (void *) 0,                                 // Parameter
+                    &stack[size-1],                             // Initial value of SP
+                    prio,                                       // Task Priority
+                    prio,                                       // Task ID
+                    &stack[0],                                  // Bottom of stack
+                    size,                                       // Stack size
+                    (void *) 0,                                 // No TCB extension
+                    OS_TASK_OPT_STK_CHK|OS_TASK_OPT_STK_CLR|opt);
+    OSTaskNameSet(prio,(INT8U *) name,&err);
+}
 
 
 /**
@@ -46,19 +91,127 @@ void TaskLED(void *param) {
 }
 
 /**
- * @brief  Task for sending a char
+ * @brief  Task for echoing the chars received
  *
- * @note   LED_Init must be called before
+ * @note   UART_Init must be called before
+ *
+ * @note   It waits on the UART semaphores, so it uses no CPU time while
+ *         there is nothing to do
  */
 
 void TaskUART(void *param) {
+int c;
+
+    UART_WriteString(UART_1,"uC/OS-II UART echo\r\n");
+    while(1) {
+        c = UART_ReadChar(UART_1);
+        if( c < 0 )
+            continue;
+        UART_WriteChar(UART_1,c);
+        if( c == '\r' )
+            UART_WriteChar(UART_1,'\n');
+    }
+}
+
+#ifdef USE_NEWLIBTEST
+/**
+ * @brief  Tasks using newlib at the same time
+ *
+ * @note   Each one prints lines with printf and logs with TaskLog_Printf. The
+ *         lines must not be mixed. errno and strtok are per task, so the
+ *         tokens of one task are not affected by the other
+ */
+void TaskNewlib(void *param) {
+char line[32];
+char *tok;
+unsigned n = 0;
+int id = (int) param;
+
+    while(1) {
+        snprintf(line,sizeof(line),"task%d a b c",id);
+        tok = strtok(line," ");
+        OSTimeDly(1+id);                    // the other task uses strtok too
+        while( tok ) {
+            printf("%s ",tok);
+            tok = strtok(0," ");
+        }
+        printf("%u\n",n++);
+        TaskLog_Printf("log task%d %u drops %lu\n",id,n,(unsigned long) TaskLog_GetDrops());
+        OSTimeDly(100*(id+1));
+    }
+}
+#endif
+
+#ifdef USE_MSGBLOCKTEST
+/**
+ * @brief  Sample blocks passed between two tasks
+ *
+ * @note   TaskSampler fills a large block (in SDRAM) with SAMPLECOUNT samples
+ *         and posts its pointer. TaskProcess gets it, sums the samples and
+ *         frees it. The samples are never copied
+ */
+#define SAMPLECOUNT             256
+#define SAMPLEQUEUESIZE         8
+#define SAMPLEPERIOD            10          // ticks
+#define SAMPLEREPORT            500         // blocks
+
+typedef struct {
+    uint32_t    seq;
+    uint32_t    count;
+    uint16_t    data[SAMPLECOUNT];
+} SampleBlock;
+
+static void     *SampleQueueStorage[SAMPLEQUEUESIZE];
+static OS_EVENT *SampleQueue;
+
+void TaskSampler(void *param) {
+SampleBlock *b;
+uint32_t seq = 0;
+int i;
 
     while(1) {
-        UART_WriteChar(UART_1,'*');
-        OSTimeDly(DELAYUART);
+        OSTimeDly(SAMPLEPERIOD);
+        b = MsgBlock_Alloc(sizeof(SampleBlock));
+        if( !b )
+            continue;                       // counted as a failure
+        b->seq   = seq++;
+        b->count = SAMPLECOUNT;
+        for(i=0;i<SAMPLECOUNT;i++)
+            b->data[i] = DWT->CYCCNT&0xFFF; // stands for an ADC reading
+        if( MsgBlock_Post(SampleQueue,b) != MSGBLOCK_OK )
+            MsgBlock_Free(b);               // still ours when the post fails
     }
 }
 
+static void
+msgblock_out(const char *s) {
+
+    UART_WriteString(UART_1,(char *) s);
+}
+
+void TaskProcess(void *param) {
+SampleBlock *b;
+uint32_t sum,n = 0;
+INT8U err;
+int i;
+
+    while(1) {
+        b = MsgBlock_Pend(SampleQueue,0,&err);
+        if( err != OS_ERR_NONE || !b )
+            continue;
+        sum = 0;
+        for(i=0;i<b->count;i++)
+            sum += b->data[i];
+        MsgBlock_Free(b);
+        if( ++n%SAMPLEREPORT == 0 ) {
+            UART_WriteString(UART_1,"sample blocks\r\n");
+            MsgBlock_Report(msgblock_out);
+        }
+        (void) sum;
+    }
+}
+#endif
+
 /**
  * @brief   Board Support Package (BSP)
  */
@@ -75,6 +228,26 @@ void  OS_CPU_TickInit (CPU_INT32U  tick_rate)
     OS_CPU_SysTickInit(cnts);                                   /* Call the Generic OS Systick initialization           */
 }
 
+/**
+ * @brief   FPU context saving
+ *
+ * @note    ASPEN: CONTROL.FPCA is set by the first FPU instruction of a task
+ *          and only then the exception entry reserves the extended frame.
+ *          LSPEN: S0-S15 and FPSCR are written there only when the handler
+ *          uses the FPU. The PendSV of the port saves S16-S31 only for a
+ *          context with FPCA (bit 4 of EXC_RETURN cleared), so the tasks that
+ *          do not use floats do not pay for the FPU context
+ *
+ * @note    These are the reset values. They are set to be sure
+ */
+static void
+FPU_ConfigLazyStacking(void) {
+
+    FPU->FPCCR |= FPU_FPCCR_ASPEN_Msk|FPU_FPCCR_LSPEN_Msk;
+    __DSB();
+    __ISB();
+}
+
 /**
  * @brief  Task for starting other tasks
  *
@@ -91,23 +264,49 @@ void TaskStart(void *param) {
     // Initialize the Tick interrupt (uCOS way)
     OS_CPU_TickInit(OS_TICKS_PER_SEC);
 
+#if TICKLESS_MODE != TICKLESS_NONE
+    // Stop SysTick when idle and wake up with LPTIM1
+    Tickless_Init();
+#endif
+
 
 #if (OS_TASK_STAT_EN > 0)
     OSStatInit();                                               // Determine CPU capacity
 #endif
 
     // Create a task to blink LED 0
-    OSTaskCreate(   TaskLED,                                    // Pointer to task
-                    (void *) 0,                                 // Parameter
-                    (void *) &TaskLEDStack[TASKLED_STK_SIZE-1], // Initial value of SP
-                    TASKLED_PRIO);                              // Task Priority/ID
+    CreateTask(TaskLED,TaskLEDStack,TASKLED_STK_SIZE,TASKLED_PRIO,"LED",0);
 
-    // Create a task to blink LED 1
-/*    OSTaskCreate(   TaskUART,                                   // Pointer to task*/
-/*                    (void *) 0,                                 // Parameter*/
-/*                    (void *) &TaskUARTStack[TASKUART_STK_SIZE-1],// Initial value of SP*/
-/*                    TASKUART_PRIO);                             // Task Priority/ID*/
+    // Create a task to echo the UART
+    CreateTask(TaskUART,TaskUARTStack,TASKUART_STK_SIZE,TASKUART_PRIO,"UART",0);
 
+    // Create a task to report CPU and stack usage
+    CreateTask(TaskProf_Task,TaskProfStack,TASKPROF_STK_SIZE,TASKPROF_PRIO,"Profile",0);
+
+#ifdef USE_SWITCHTEST
+    // Create the tasks that measure the context switch time
+    SwitchTest_Start(SWITCHTEST_PRIO);
+#endif
+
+#ifdef USE_NEWLIBTEST
+    // Create the task that sends the logs and two tasks that use newlib
+    CreateTask(TaskLog_Task,TaskLogStack,TASKLOG_STK_SIZE,TASKLOG_PRIO,"Log",0);
+    OSTaskCreateExt(TaskNewlib,(void *) 0,&TaskNewlibStack[0][NEWLIBTEST_STK_SIZE-1],
+                    NEWLIBTEST_PRIO,NEWLIBTEST_PRIO,&TaskNewlibStack[0][0],
+                    NEWLIBTEST_STK_SIZE,(void *) 0,OS_TASK_OPT_STK_CHK|OS_TASK_OPT_STK_CLR);
+    OSTaskCreateExt(TaskNewlib,(void *) 1,&TaskNewlibStack[1][NEWLIBTEST_STK_SIZE-1],
+                    NEWLIBTEST_PRIO+1,NEWLIBTEST_PRIO+1,&TaskNewlibStack[1][0],
+                    NEWLIBTEST_STK_SIZE,(void *) 0,OS_TASK_OPT_STK_CHK|OS_TASK_OPT_STK_CLR);
+#endif
+
+#ifdef USE_MSGBLOCKTEST
+    // Create the queue and the tasks that pass sample blocks
+    SampleQueue = OSQCreate(SampleQueueStorage,SAMPLEQUEUESIZE);
+    CreateTask(TaskSampler,TaskSamplerStack,MSGBLOCKTEST_STK_SIZE,MSGBLOCKTEST_PRIO,
+               "Sampler",0);
+    CreateTask(TaskProcess,TaskProcessStack,MSGBLOCKTEST_STK_SIZE,MSGBLOCKTEST_PRIO+1,
+               "Process",0);
+#endif
 
 
     OSTaskDel(OS_PRIO_SELF);                                    // Kill itself. Task should never return
@@ -135,12 +334,32 @@ static const uint32_t uartconfig =  UART_NOPARITY | UART_8BITS | UART_STOP_2 |
     LED_Init();
     LED_Set();
 
-    // Configure UART
-    UART_Init(UART_1,uartconfig);
+#ifdef USE_MSGBLOCKTEST
+    // The large message blocks are in SDRAM
+    SDRAM_Init();
+#endif
 
     // Initialize uc/os II
     OSInit();
 
+    // Enable the cycle counter for task profiling
+    TaskProf_Init();
+
+    // Save the FPU context only for tasks using it
+    FPU_ConfigLazyStacking();
+
+    // Configure UART (after OSInit, because it creates semaphores)
+    UART_Init(UART_1,uartconfig);
+
+    // Reentrant newlib and task log (before the tasks are created)
+    Syscalls_Init();
+    TaskLog_Init();
+
+#ifdef USE_MSGBLOCKTEST
+    // Memory partitions of the message blocks (after OSInit and SDRAM_Init)
+    MsgBlock_Init();
+#endif
+
     // Create a task to start the other tasks
     OSTaskCreate(   TaskStart,                                          // Pointer to function
             (void *) 0,                                                 // Parameter for task
@@ -0,0 +1,21 @@
+#ifndef MEMSECTIONS_H
+#define MEMSECTIONS_H
+/**
+ * @file    memsections.h
+ *
+ * @note    Attributes to place data in DTCM RAM and in the external SDRAM
+ *
+ * @note    The sections are defined in stm32f746.ld
+ *
+ *  Attribute   | Section    | Memory  | Initialization
+ *  ------------|------------|---------|--------------------------------
+ *  DTCM_BSS    | .dtcm_bss  | DTCMRAM | none
+ *  SDRAM_BSS   | .sdram_bss | SDRAM   | zeroed by SDRAM_Init
+ *
+ * @note    Data in SDRAM can only be used after SDRAM_Init
+ */
+
+#define DTCM_BSS        __attribute__((section(".dtcm_bss"),aligned(8)))
+#define SDRAM_BSS       __attribute__((section(".sdram_bss"),aligned(8)))
+
+#endif // MEMSECTIONS_H
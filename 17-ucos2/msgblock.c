@@ -0,0 +1,361 @@
+/**
+ * @file     msgblock.c
+ * @brief    Message blocks passed by pointer between uC/OS-II tasks
+ *
+ * @note     See msgblock.h
+ *
+ * @note     The header is before the data returned to the user. Its first word
+ *           is left for the free list of the partition (OSMemPut writes the
+ *           link there), so the owner of a free block is still readable and a
+ *           double free is detected
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "ucos_ii.h"
+#include "memsections.h"
+#include "msgblock.h"
+
+#if (MSGBLOCK_SMALLSIZE%8) != 0 || (MSGBLOCK_LARGESIZE%8) != 0
+#error MSGBLOCK_SMALLSIZE and MSGBLOCK_LARGESIZE must be multiples of 8
+#endif
+#if MSGBLOCK_SMALLSIZE >= MSGBLOCK_LARGESIZE
+#error MSGBLOCK_SMALLSIZE must be smaller than MSGBLOCK_LARGESIZE
+#endif
+#if OS_LOWEST_PRIO >= 0xFD
+#error The owner codes need OS_LOWEST_PRIO smaller than 0xFD
+#endif
+
+/**
+ * @brief   Header of a block
+ */
+typedef struct {
+    void       *link;               ///< used by OSMemPut/OSMemGet
+    uint8_t     cls;
+    uint8_t     owner;              ///< task priority or one of below
+    uint16_t    magic;
+} Header;
+
+#define HEADERSIZE                  sizeof(Header)
+#define MAGIC                       0xB10C
+
+/**
+ * @brief   Owners besides tasks
+ */
+///@{
+#define OWNER_QUEUE                 0xFF
+#define OWNER_ISR                   0xFE
+#define OWNER_FREE                  0xFD
+///@}
+
+/**
+ * @brief   Storage of the partitions
+ */
+///@{
+static uint8_t smallblocks[MSGBLOCK_SMALLCOUNT][MSGBLOCK_SMALLSIZE+HEADERSIZE] DTCM_BSS;
+static uint8_t largeblocks[MSGBLOCK_LARGECOUNT][MSGBLOCK_LARGESIZE+HEADERSIZE] SDRAM_BSS;
+///@}
+
+/**
+ * @brief   Classes
+ *
+ * @note    Ordered by size. The counters are changed with interrupts disabled
+ */
+typedef struct {
+    OS_MEM     *mem;
+    uint8_t    *start;
+    uint8_t    *end;
+    uint32_t    size;
+    uint32_t    count;
+    uint32_t    minfree;
+    uint32_t    allocs;
+    uint32_t    fallbacks;
+    uint32_t    failures;
+} Class;
+
+static Class classes[MSGBLOCK_CLASSES] = {
+    { 0, &smallblocks[0][0], &smallblocks[MSGBLOCK_SMALLCOUNT][0],
+         MSGBLOCK_SMALLSIZE, MSGBLOCK_SMALLCOUNT, 0, 0, 0, 0 },
+    { 0, &largeblocks[0][0], &largeblocks[MSGBLOCK_LARGECOUNT][0],
+         MSGBLOCK_LARGESIZE, MSGBLOCK_LARGECOUNT, 0, 0, 0, 0 }
+};
+
+static uint32_t ownererrors = 0;
+
+/**
+ * @brief   Owner code of the caller
+ */
+static inline uint8_t
+caller(void) {
+
+    return OSIntNesting > 0 ? OWNER_ISR : OSPrioCur;
+}
+
+/**
+ * @brief   Header of a block given to the user
+ *
+ * @note    Returns null when msg is not the data of a block
+ */
+static Header *
+getheader(const void *msg) {
+const uint8_t *p = (const uint8_t *) msg-HEADERSIZE;
+Header *h;
+Class *c;
+
+    if( !msg )
+        return 0;
+    for(c=classes;c<classes+MSGBLOCK_CLASSES;c++) {
+        if( p >= c->start && p < c->end ) {
+            if( (p-c->start)%(c->size+HEADERSIZE) != 0 )
+                return 0;
+            h = (Header *) p;
+            if( h->magic != MAGIC || h->cls != c-classes )
+                return 0;
+            return h;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief   MsgBlock_Init
+ *
+ * @note    Creates a partition for each class. Returns MSGBLOCK_ERROR_PARAM
+ *          when OSMemCreate fails (OS_MAX_MEM_PART in os_cfg.h)
+ */
+int
+MsgBlock_Init(void) {
+static const char *const names[MSGBLOCK_CLASSES] = { "MsgSmall", "MsgLarge" };
+Class *c;
+Header *h;
+INT8U err;
+uint32_t i;
+
+    for(c=classes;c<classes+MSGBLOCK_CLASSES;c++) {
+        for(i=0;i<c->count;i++) {
+            h = (Header *) (c->start+i*(c->size+HEADERSIZE));
+            h->cls   = c-classes;
+            h->owner = OWNER_FREE;
+            h->magic = MAGIC;
+        }
+        c->mem = OSMemCreate(c->start,c->count,c->size+HEADERSIZE,&err);
+        if( err != OS_ERR_NONE )
+            return MSGBLOCK_ERROR_PARAM;
+        OSMemNameSet(c->mem,(INT8U *) names[c-classes],&err);
+        c->minfree = c->count;
+    }
+    return MSGBLOCK_OK;
+}
+
+/**
+ * @brief   MsgBlock_Alloc
+ *
+ * @note    Returns a block of at least size bytes, owned by the caller, or null.
+ *          When its class is exhausted, a block of a larger class is taken and
+ *          counted as a fallback. Never waits
+ */
+void *
+MsgBlock_Alloc(uint32_t size) {
+#if OS_CRITICAL_METHOD == 3u
+OS_CPU_SR cpu_sr = 0u;
+#endif
+Class *c,*first;
+Header *h = 0;
+INT8U err;
+
+    for(first=classes;first<classes+MSGBLOCK_CLASSES;first++) {
+        if( size <= first->size )
+            break;
+    }
+    if( first == classes+MSGBLOCK_CLASSES )
+        return 0;
+
+    OS_ENTER_CRITICAL();
+    for(c=first;c<classes+MSGBLOCK_CLASSES;c++) {
+        h = OSMemGet(c->mem,&err);
+        if( h ) {
+            c->allocs++;
+            if( c->mem->OSMemNFree < c->minfree )
+                c->minfree = c->mem->OSMemNFree;
+            if( c != first )
+                first->fallbacks++;
+            h->owner = caller();
+            break;
+        }
+    }
+    if( !h )
+        first->failures++;
+    OS_EXIT_CRITICAL();
+
+    return h ? (uint8_t *) h+HEADERSIZE : 0;
+}
+
+/**
+ * @brief   MsgBlock_Free
+ *
+ * @note    Gives the block back to its partition. Only the owner can do it
+ */
+int
+MsgBlock_Free(void *msg) {
+#if OS_CRITICAL_METHOD == 3u
+OS_CPU_SR cpu_sr = 0u;
+#endif
+Header *h;
+int rc = MSGBLOCK_OK;
+
+    h = getheader(msg);
+    OS_ENTER_CRITICAL();
+    if( !h || h->owner == OWNER_FREE ) {
+        rc = MSGBLOCK_ERROR_PARAM;
+        ownererrors++;
+    } else if( h->owner != caller() ) {
+        rc = MSGBLOCK_ERROR_OWNER;
+        ownererrors++;
+    } else {
+        h->owner = OWNER_FREE;
+        OSMemPut(classes[h->cls].mem,h);
+    }
+    OS_EXIT_CRITICAL();
+    return rc;
+}
+
+/**
+ * @brief   MsgBlock_Post
+ *
+ * @note    Posts the pointer to q (created with OSQCreate). On success the
+ *          queue owns the block. Otherwise the caller still owns it and must
+ *          free it or post it again
+ */
+int
+MsgBlock_Post(OS_EVENT *q, void *msg) {
+#if OS_CRITICAL_METHOD == 3u
+OS_CPU_SR cpu_sr = 0u;
+#endif
+Header *h;
+uint8_t owner;
+INT8U err;
+
+    h = getheader(msg);
+    if( !h || h->owner == OWNER_FREE ) {
+        OS_ENTER_CRITICAL();
+        ownererrors++;
+        OS_EXIT_CRITICAL();
+        return MSGBLOCK_ERROR_PARAM;
+    }
+    owner = caller();
+    if( h->owner != owner ) {
+        OS_ENTER_CRITICAL();
+        ownererrors++;
+        OS_EXIT_CRITICAL();
+        return MSGBLOCK_ERROR_OWNER;
+    }
+
+    // Before the post, because the receiver can run before it returns
+    h->owner = OWNER_QUEUE;
+    err = OSQPost(q,msg);
+    if( err == OS_ERR_NONE )
+        return MSGBLOCK_OK;
+    h->owner = owner;
+    return err == OS_ERR_Q_FULL ? MSGBLOCK_ERROR_FULL : MSGBLOCK_ERROR_POST;
+}
+
+/**
+ * @brief   MsgBlock_Pend
+ *
+ * @note    Waits for a block in q (timeout in ticks, 0 is forever). The caller
+ *          becomes its owner. err is the one of OSQPend. Pointers that are not
+ *          blocks are passed as they are
+ */
+void *
+MsgBlock_Pend(OS_EVENT *q, INT32U timeout, INT8U *err) {
+void *msg;
+Header *h;
+
+    msg = OSQPend(q,timeout,err);
+    h = getheader(msg);
+    if( h )
+        h->owner = OSPrioCur;
+    return msg;
+}
+
+/**
+ * @brief   MsgBlock_GetSize
+ *
+ * @note    Usable size of the block (it can be larger than requested)
+ */
+uint32_t
+MsgBlock_GetSize(const void *msg) {
+Header *h;
+
+    h = getheader(msg);
+    return h ? classes[h->cls].size : 0;
+}
+
+/**
+ * @brief   MsgBlock_GetStats
+ */
+int
+MsgBlock_GetStats(int cls, MsgBlock_Stats *stats) {
+#if OS_CRITICAL_METHOD == 3u
+OS_CPU_SR cpu_sr = 0u;
+#endif
+Class *c;
+
+    if( cls < 0 || cls >= MSGBLOCK_CLASSES )
+        return MSGBLOCK_ERROR_PARAM;
+    c = &classes[cls];
+    OS_ENTER_CRITICAL();
+    stats->size      = c->size;
+    stats->count     = c->count;
+    stats->free      = c->mem ? c->mem->OSMemNFree : 0;
+    stats->minfree   = c->minfree;
+    stats->allocs    = c->allocs;
+    stats->fallbacks = c->fallbacks;
+    stats->failures  = c->failures;
+    OS_EXIT_CRITICAL();
+    return MSGBLOCK_OK;
+}
+
+/**
+ * @brief   MsgBlock_GetOwnerErrors
+ *
+ * @note    Posts and frees refused
+ */
+uint32_t
+MsgBlock_GetOwnerErrors(void) {
+
+    return ownererrors;
+}
+
+/**
+ * @brief   MsgBlock_Report
+ *
+ * @note    Prints a line for each class
+ *
+ *          class size free/count minfree allocs fallbacks failures
+ */
+void
+MsgBlock_Report(void (*out)(const char *s)) {
+static const char *const names[MSGBLOCK_CLASSES] = { "small", "large" };
+MsgBlock_Stats st;
+char line[96];
+int i;
+
+    out("class  size  free/count  minfree    allocs  fallback  fail\r\n");
+    for(i=0;i<MSGBLOCK_CLASSES;i++) {
+        MsgBlock_GetStats(i,&st);
+        snprintf(line,sizeof(line),"%-5s %5lu %5lu/%-5lu %8lu %9lu %9lu %5lu\r\n",
+                names[i],
+                (unsigned long) st.size,
+                (unsigned long) st.free,(unsigned long) st.count,
+                (unsigned long) st.minfree,
+                (unsigned long) st.allocs,
+                (unsigned long) st.fallbacks,
+                (unsigned long) st.failures);
+        out(line);
+    }
+    snprintf(line,sizeof(line),"owner errors %lu\r\n",(unsigned long) ownererrors);
+    out(line);
+}
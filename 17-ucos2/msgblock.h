@@ -0,0 +1,99 @@
+#ifndef MSGBLOCK_H
+#define MSGBLOCK_H
+/**
+ * @file     msgblock.h
+ * @brief    Message blocks passed by pointer between uC/OS-II tasks
+ *
+ * @note     The blocks come from uC/OS-II memory partitions (OSMemCreate), one
+ *           for each size class. The small blocks are in DTCM RAM (zero wait
+ *           state), the large ones (sample buffers) in the external SDRAM. Only
+ *           the pointer goes thru the queue (OSQPost/OSQPend), so the data is
+ *           written once by the producer and never copied
+ *
+ * @note     A block has always one owner: the task (or the interrupts) that
+ *           allocated it or got it from a queue, or the queue while it is
+ *           there. Only the owner can post or free it.
+ *
+ *           - MsgBlock_Alloc gives a block owned by the caller
+ *           - MsgBlock_Post gives it to the queue. After a successful post the
+ *             caller must not touch it. When the post fails, it still owns it
+ *           - MsgBlock_Pend makes the caller the owner
+ *           - MsgBlock_Free gives it back to its partition
+ *
+ *           A post or free by another task, a double free and a pointer that is
+ *           not a block are refused and counted
+ *
+ * @note     MsgBlock_Init must be called after OSInit and SDRAM_Init. The
+ *           interrupts can allocate, post and free, but not pend
+ *
+ ******************************************************************************/
+
+#include <stdint.h>
+
+#include "ucos_ii.h"
+
+/**
+ * @brief   Size classes
+ *
+ * @note    Size is the usable size in bytes (a multiple of 8). Each block has
+ *          a header of 8 bytes more
+ */
+///@{
+#ifndef MSGBLOCK_SMALLSIZE
+#define MSGBLOCK_SMALLSIZE          64      ///< DTCM RAM
+#endif
+#ifndef MSGBLOCK_SMALLCOUNT
+#define MSGBLOCK_SMALLCOUNT         32
+#endif
+#ifndef MSGBLOCK_LARGESIZE
+#define MSGBLOCK_LARGESIZE          1024    ///< SDRAM
+#endif
+#ifndef MSGBLOCK_LARGECOUNT
+#define MSGBLOCK_LARGECOUNT         32
+#endif
+///@}
+
+/**
+ * @brief   Classes (index for MsgBlock_GetStats)
+ */
+///@{
+#define MSGBLOCK_SMALL              (0)
+#define MSGBLOCK_LARGE              (1)
+#define MSGBLOCK_CLASSES            (2)
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define MSGBLOCK_OK                 (0)
+#define MSGBLOCK_ERROR_PARAM        (-1)    ///< not a block or already free
+#define MSGBLOCK_ERROR_OWNER        (-2)    ///< caller is not the owner
+#define MSGBLOCK_ERROR_FULL         (-3)    ///< queue full
+#define MSGBLOCK_ERROR_POST         (-4)    ///< other OSQPost error
+///@}
+
+/**
+ * @brief   Usage of a class
+ */
+typedef struct {
+    uint32_t    size;               // usable bytes of a block
+    uint32_t    count;              // blocks
+    uint32_t    free;               // blocks free now
+    uint32_t    minfree;            // low water mark
+    uint32_t    allocs;
+    uint32_t    fallbacks;          // served by a larger class
+    uint32_t    failures;           // no block in this or larger classes
+} MsgBlock_Stats;
+
+int      MsgBlock_Init(void);
+void    *MsgBlock_Alloc(uint32_t size);
+int      MsgBlock_Free(void *msg);
+int      MsgBlock_Post(OS_EVENT *q, void *msg);
+void    *MsgBlock_Pend(OS_EVENT *q, INT32U timeout, INT8U *err);
+uint32_t MsgBlock_GetSize(const void *msg);
+int      MsgBlock_GetStats(int cls, MsgBlock_Stats *stats);
+uint32_t MsgBlock_GetOwnerErrors(void);
+void     MsgBlock_Report(void (*out)(const char *s));
+
+#endif // MSGBLOCK_H
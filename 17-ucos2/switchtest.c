@@ -0,0 +1,134 @@
+/**
+ * @file     switchtest.c
+ * @brief    Measurement of the context switch time with and without FPU context
+ *
+ * @note     A pair of tasks is used for each case. The poster, with lower
+ *           priority, reads the cycle counter and posts a semaphore. The
+ *           waiter, with higher priority, is pended on it and reads the counter
+ *           when it runs. So the time includes OSSemPost, the switch (PendSV)
+ *           and the return of OSSemPend
+ *
+ * @note     In the FPU pair both tasks use floats, so their contexts have FPU
+ *           state (CONTROL.FPCA). The switch saves S16-S31 and, because that
+ *           uses the FPU, the S0-S15 and FPSCR reserved by the lazy stacking
+ *           too. The difference of the two pairs is the cost of the FPU context
+ *
+ * @note     The pairs run one after the other. Interrupts (SysTick) and higher
+ *           priority tasks increase the maximum, so the minimum is the value
+ *           to compare
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "stm32f746xx.h"
+#include "ucos_ii.h"
+#include "uart.h"
+#include "switchtest.h"
+
+/**
+ * @brief   Data of a pair of tasks
+ */
+typedef struct {
+    const char         *name;
+    int                 fp;
+    OS_EVENT           *sem;
+    volatile uint32_t   start;
+    uint32_t            min;
+    uint32_t            max;
+    uint64_t            total;
+    uint32_t            n;
+} SwitchTest_Pair;
+
+static SwitchTest_Pair switchtest_pairs[2] = {
+    { "integer", 0 },
+    { "fpu",     1 }
+};
+
+static OS_STK switchtest_stacks[4][SWITCHTEST_STK_SIZE];
+
+/// Keeps the float operations
+static volatile float switchtest_fpwork = 1.0f;
+
+/**
+ * @brief   switchtest_waiter
+ *
+ * @note    Higher priority task of a pair
+ */
+static void
+switchtest_waiter(void *param) {
+SwitchTest_Pair *p = (SwitchTest_Pair *) param;
+uint32_t t;
+INT8U err;
+
+    while(1) {
+        OSSemPend(p->sem,0,&err);
+        t = DWT->CYCCNT-p->start;
+        if( t < p->min ) p->min = t;
+        if( t > p->max ) p->max = t;
+        p->total += t;
+        p->n++;
+        if( p->fp )
+            switchtest_fpwork = switchtest_fpwork*1.0001f;
+    }
+}
+
+/**
+ * @brief   switchtest_poster
+ *
+ * @note    Lower priority task of a pair. It prints the result and ends
+ */
+static void
+switchtest_poster(void *param) {
+SwitchTest_Pair *p = (SwitchTest_Pair *) param;
+char line[80];
+int i;
+
+    OSTimeDly(OS_TICKS_PER_SEC);
+    for(i=0;i<SWITCHTEST_ROUNDS;i++) {
+        if( p->fp )
+            switchtest_fpwork = switchtest_fpwork+0.5f;
+        p->start = DWT->CYCCNT;
+        OSSemPost(p->sem);
+    }
+    snprintf(line,sizeof(line),"switch %-8s min %lu avg %lu max %lu cycles\r\n",
+            p->name,
+            (unsigned long) p->min,
+            (unsigned long) (p->n ? p->total/p->n : 0),
+            (unsigned long) p->max);
+    UART_WriteString(UART_1,line);
+    OSTaskDel(OS_PRIO_SELF);
+}
+
+/**
+ * @brief   SwitchTest_Start
+ *
+ * @note    Creates the tasks. The FPU tasks are created with
+ *          OS_TASK_OPT_SAVE_FP. The cycle counter must be enabled
+ *          (TaskProf_Init)
+ */
+void
+SwitchTest_Start(unsigned prio) {
+SwitchTest_Pair *p;
+OS_STK *stk;
+INT16U opt;
+int i;
+
+    for(i=0;i<2;i++) {
+        p = &switchtest_pairs[i];
+        p->sem   = OSSemCreate(0);
+        p->min   = 0xFFFFFFFF;
+        p->max   = 0;
+        p->total = 0;
+        p->n     = 0;
+        opt = OS_TASK_OPT_STK_CHK|OS_TASK_OPT_STK_CLR;
+        if( p->fp )
+            opt |= OS_TASK_OPT_SAVE_FP;
+
+        stk = switchtest_stacks[2*i];
+        OSTaskCreateExt(switchtest_waiter,p,&stk[SWITCHTEST_STK_SIZE-1],
+                        prio+2*i,prio+2*i,stk,SWITCHTEST_STK_SIZE,(void *) 0,opt);
+        stk = switchtest_stacks[2*i+1];
+        OSTaskCreateExt(switchtest_poster,p,&stk[SWITCHTEST_STK_SIZE-1],
+                        prio+2*i+1,prio+2*i+1,stk,SWITCHTEST_STK_SIZE,(void *) 0,opt);
+    }
+}
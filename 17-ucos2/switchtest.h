@@ -0,0 +1,24 @@
+#ifndef SWITCHTEST_H
+#define SWITCHTEST_H
+/**
+ * @file     switchtest.h
+ * @brief    Measurement of the context switch time with and without FPU context
+ *
+ * @note     It uses four tasks, from prio to prio+3, and prints the result on
+ *           UART_1
+ *
+ ******************************************************************************/
+
+/**
+ * @brief   Parameters
+ */
+///@{
+#ifndef SWITCHTEST_ROUNDS
+#define SWITCHTEST_ROUNDS           1000
+#endif
+#define SWITCHTEST_STK_SIZE         256
+///@}
+
+void SwitchTest_Start(unsigned prio);
+
+#endif // SWITCHTEST_H
@@ -0,0 +1,474 @@
+/**
+ * @file    syscalls.c
+ *
+ * @note    Following 11. System Calls in Newlib LibC documentation
+ *
+ * @note    Minimal implementation (mostly stubs) for POSIX like routines and
+ *          data, as in 14-Newlib, made safe for uC/OS-II tasks
+ *
+ * @note    Reentrancy: newlib keeps its state (errno, strtok, rand, the
+ *          buffers of dtoa, stdio) in a struct _reent pointed by _impure_ptr.
+ *          Each task created after Syscalls_Init gets one from a pool
+ *          (SYSCALLS_REENTCOUNT) and the context switch hook points
+ *          _impure_ptr to the one of the task switched in. So the tasks do
+ *          not share state and no lock is taken for it
+ *
+ * @note    malloc: newlib calls __malloc_lock/__malloc_unlock around the heap
+ *          operations. They take a semaphore, recursively, because malloc
+ *          can call itself (e.g. realloc and _reclaim_reent). Before OSStart
+ *          they do nothing
+ *
+ * @note    _write takes a semaphore for the whole call, so the output of a
+ *          call (a line, stdout being line buffered because _isatty is true)
+ *          is never mixed with the one of another task. It is only held while
+ *          the chars are put in the UART FIFO
+ *
+ * @note    When a task is deleted, its structure is reclaimed (its stdio
+ *          buffers freed) by the idle task, which can not wait: it only does it
+ *          when the malloc semaphore is free
+ *
+ * @note    Function list
+ *
+ *    void _exit(void);
+ *    int _close(int file);
+ *    int _execve(char *name, char **argv, char **env);
+ *    int _fork(void);
+ *    int _fstat(int file, struct stat *st);
+ *    int _getpid(void);
+ *    int _isatty(int file);
+ *    int _kill(int pid, int sig);
+ *    int _link(char *old, char *new);
+ *    int _lseek(int file, int ptr, int dir);
+ *    int _open(const char *name, int flags, int mode);
+ *    int _read(int file, char *ptr, int len);
+ *    caddr_t _sbrk(int incr);
+ *    int _stat(char *file, struct stat *st);
+ *    int _times(struct tms *buf);
+ *    int _unlink(char *name);
+ *    int _wait(int *status);
+ *    int _write(int file, char *ptr, int len);
+ *
+ * @note    Data list
+ *    extern char *__env[1];
+ *    extern char **environ;
+ *
+ */
+
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/times.h>
+#include <reent.h>
+
+#include "syscalls.h"
+#include "uart.h"
+#include "ucos_ii.h"
+
+/**
+ * @brief errno
+ *
+ * @note  Stubs set the errno of the reentrancy structure of the task (the
+ *        errno macro of errno.h), so it is not disabled here
+ */
+#include <errno.h>
+
+/**
+ * @brief   Reentrancy structures
+ *
+ * @note    reenttab maps the priority of a task to its structure. state is
+ *          REENT_FREE, REENT_USED or REENT_ZOMBIE (task deleted, to be
+ *          reclaimed)
+ */
+///@{
+#define REENT_FREE      0
+#define REENT_USED      1
+#define REENT_ZOMBIE    2
+
+static struct _reent    reentpool[SYSCALLS_REENTCOUNT];
+static uint8_t          reentstate[SYSCALLS_REENTCOUNT];
+static struct _reent   *reenttab[OS_LOWEST_PRIO+1];
+static struct _reent   *reentglobal;
+static int              initialized = 0;
+///@}
+
+/**
+ * @brief   Locks
+ */
+///@{
+static OS_EVENT        *malloclock;
+static volatile INT8U   mallocowner;
+static volatile int     mallocdepth = 0;
+static OS_EVENT        *writelock;
+///@}
+
+/**
+ * @brief   Initialization
+ *
+ * @note    Creates the semaphores. Must be called after OSInit
+ */
+void
+Syscalls_Init(void) {
+
+    reentglobal = _impure_ptr;
+    malloclock  = OSSemCreate(1);
+    writelock   = OSSemCreate(1);
+    initialized = 1;
+}
+
+/**
+ * @brief   Task creation hook
+ *
+ * @note    Called with interrupts disabled. Gives the task a reentrancy
+ *          structure, when there is one free
+ */
+void
+Syscalls_TaskCreateHook(OS_TCB *ptcb) {
+int i;
+
+    if( !initialized )
+        return;
+    for(i=0;i<SYSCALLS_REENTCOUNT;i++) {
+        if( reentstate[i] == REENT_FREE ) {
+            _REENT_INIT_PTR(&reentpool[i]);
+            reentstate[i] = REENT_USED;
+            reenttab[ptcb->OSTCBPrio] = &reentpool[i];
+            return;
+        }
+    }
+}
+
+/**
+ * @brief   Task deletion hook
+ *
+ * @note    Called with interrupts disabled. The structure is reclaimed later
+ *          by Syscalls_IdleHook
+ */
+void
+Syscalls_TaskDelHook(OS_TCB *ptcb) {
+struct _reent *r = reenttab[ptcb->OSTCBPrio];
+
+    if( r == 0 )
+        return;
+    reenttab[ptcb->OSTCBPrio] = 0;
+    reentstate[r-reentpool] = REENT_ZOMBIE;
+}
+
+/**
+ * @brief   Context switch hook
+ *
+ * @note    Called by OSTaskSwHook (and by OSStartHighRdy for the first task)
+ *          with interrupts disabled. OSTCBHighRdy is the task switched in
+ */
+void
+Syscalls_SwHook(void) {
+struct _reent *r = reenttab[OSTCBHighRdy->OSTCBPrio];
+
+    _impure_ptr = r ? r : reentglobal;
+}
+
+/**
+ * @brief   Idle hook
+ *
+ * @note    Reclaims the structures of the deleted tasks when nobody holds the
+ *          malloc lock. The free calls inside _reclaim_reent take it again
+ *          (recursively)
+ */
+void
+Syscalls_IdleHook(void) {
+int i;
+
+    if( !initialized )
+        return;
+    for(i=0;i<SYSCALLS_REENTCOUNT;i++) {
+        if( reentstate[i] != REENT_ZOMBIE )
+            continue;
+        if( OSSemAccept(malloclock) == 0 )
+            return;
+        mallocowner = OSTCBCur->OSTCBPrio;
+        mallocdepth = 1;
+        _reclaim_reent(&reentpool[i]);
+        reentstate[i] = REENT_FREE;
+        mallocdepth = 0;
+        OSSemPost(malloclock);
+    }
+}
+
+/**
+ * @brief   malloc lock
+ *
+ * @note    Recursive: the task that holds it only counts the nested calls.
+ *          owner and depth are only changed by the holder
+ */
+void
+__malloc_lock(struct _reent *r) {
+INT8U err;
+
+    if( !initialized || OSRunning == OS_FALSE )
+        return;
+    if( mallocdepth > 0 && mallocowner == OSTCBCur->OSTCBPrio ) {
+        mallocdepth++;
+        return;
+    }
+    OSSemPend(malloclock,0,&err);
+    mallocowner = OSTCBCur->OSTCBPrio;
+    mallocdepth = 1;
+}
+
+void
+__malloc_unlock(struct _reent *r) {
+
+    if( !initialized || OSRunning == OS_FALSE )
+        return;
+    if( --mallocdepth == 0 )
+        OSSemPost(malloclock);
+}
+
+/**
+ * @brief   _exit
+ *
+ * @note    Exit a program without cleaning up files. If your system doesn’t provide this,
+ *          it is best to avoid linking with subroutines that require it (exit, system).
+ */
+
+void _exit(void) {
+    while (1) {}        // eternal loop
+}
+
+/**
+ * @brief   close
+ *
+ * @note    Close a file. Minimal implementation.
+ */
+int _close(int file) {
+    return -1;
+}
+
+/**
+ * @brief   environ
+ *
+ * @note    A pointer to a list of environment variables and their values.
+ *          For a minimal environment, this empty list is adequate.
+ */
+
+char *__env[1] = { 0 };
+char **environ = __env;
+
+/**
+ * @brief   execve
+ *
+ * @note    Transfer control to a new process. Minimal implementation
+ *          (for a system without processes)
+ */
+
+int _execve(char *name, char **argv, char **env) {
+      errno = ENOMEM;
+      return -1;
+}
+
+/**
+ * @brief   fork
+ *
+ * @note    Create a new process. Minimal implementation
+ *          (for a system without processes)
+ */
+
+int _fork(void) {
+      errno = EAGAIN;
+      return -1;
+}
+
+/**
+ * @brief   fstat
+ *
+ * @note    Status of an open file. All files are regarded as character
+ *          special devices.
+ */
+
+int _fstat(int file, struct stat *st) {
+    st->st_mode = S_IFCHR;
+    return 0;
+}
+
+/**
+ * @brief   getpid
+ *
+ * @note    Process-ID. The priority of the task
+ */
+
+int _getpid(void) {
+    return OSTCBCur ? OSTCBCur->OSTCBPrio : 1;
+}
+
+/**
+ * @brief   isatty
+ *
+ * @note    Query whether output stream is a terminal. It makes stdout line
+ *          buffered
+ */
+
+int _isatty(int file) {
+    return 1;
+}
+
+/**
+ * @brief   kill
+ *
+ * @note    Send a signal. Minimal implementation.
+ */
+int _kill(int pid, int sig) {
+    errno = EINVAL;
+    return -1;
+}
+
+/**
+ * @brief   link
+ *
+ * @note    Establish a new name for an existing file. Minimal implementation.
+ */
+
+int _link(char *old, char *new) {
+    errno = EMLINK;
+    return -1;
+}
+
+/**
+ * @brief   lseek
+ *
+ * @note    Set position in a file. Minimal implementation.
+ */
+
+int _lseek(int file, int ptr, int dir) {
+    return 0;
+}
+
+/**
+ * @brief   open
+ *
+ * @note    Open a file. Minimal implementation.
+ */
+
+int _open(const char *name, int flags, int mode) {
+    return -1;
+}
+
+/**
+ * @brief   read
+ *
+ * @note    Reads a line (or len chars) from the UART with echo. CR is
+ *          returned as LF
+ */
+
+int _read(int file, char *ptr, int len) {
+int i,c;
+
+    for(i=0;i<len;) {
+        c = UART_ReadChar(SYSCALLS_UART);
+        if( c < 0 )
+            break;
+        if( c == '\r' )
+            c = '\n';
+        ptr[i++] = c;
+        if( c == '\n' ) {
+            UART_WriteString(SYSCALLS_UART,"\r\n");
+            break;
+        }
+        UART_WriteChar(SYSCALLS_UART,c);
+    }
+    return i;
+}
+
+/**
+ * @brief   sbrk
+ *
+ * @note    Increase program data space. The heap goes from the end of bss to
+ *          the stack of main and of the interrupts (_stack_start). The task
+ *          stacks are static arrays in bss, so the SP can not be used as limit
+ *
+ * @note    Called by malloc with the malloc lock taken
+ */
+
+caddr_t _sbrk(int incr) {
+extern char _bss_end;       /* Defined in the linker script */
+extern char _stack_start;
+static char *heap_end = 0;
+char *prev_heap_end;
+
+    if (heap_end == 0) {
+        heap_end = &_bss_end;
+    }
+    prev_heap_end = heap_end;
+    if( (heap_end + incr) > &_stack_start ) {
+        errno = ENOMEM;
+        return (caddr_t) -1;
+    }
+
+    heap_end += incr;
+    return (caddr_t) prev_heap_end;
+}
+
+/**
+ * @brief   stat
+ *
+ * @note    Status of a file (by name). Minimal implementation.
+ */
+
+int _stat(char *file, struct stat *st) {
+    st->st_mode = S_IFCHR;
+    return 0;
+}
+
+/**
+ * @brief   times
+ *
+ * @note    Timing information for current process. Minimal implementation.
+ */
+
+int _times(struct tms *buf) {
+    return -1;
+}
+
+/**
+ * @brief   unlink
+ *
+ * @note    Remove a file’s directory entry. Minimal implementation.
+ */
+
+int _unlink(char *name) {
+  errno = ENOENT;
+  return -1;
+}
+
+/**
+ * @brief   wait
+ *
+ * @note    Wait for a child process. Minimal implementation.
+ */
+
+int _wait(int *status) {
+    errno = ECHILD;
+    return -1;
+}
+
+/**
+ * @brief   write
+ *
+ * @note    Sends the chars to the UART, with CR after LF. The whole call is
+ *          done with the write lock taken, so the outputs of tasks are not
+ *          mixed. Before OSStart there is no lock
+ */
+
+int _write(int file, char *ptr, int len) {
+INT8U err;
+int i,locked;
+
+    locked = initialized && OSRunning == OS_TRUE;
+    if( locked )
+        OSSemPend(writelock,0,&err);
+    for(i=0;i<len;i++) {
+        UART_WriteChar(SYSCALLS_UART,ptr[i]);
+        if( ptr[i] == '\n' )
+            UART_WriteChar(SYSCALLS_UART,'\r');
+    }
+    if( locked )
+        OSSemPost(writelock);
+    return len;
+}
@@ -0,0 +1,67 @@
+#ifndef SYSCALLS_H
+#define SYSCALLS_H
+/**
+ * @file syscalls.h
+ *
+ * @note    Following 11. System Calls in Newlib LibC documentation
+ *
+ * @note    Reentrant version for uC/OS-II: each task has its own newlib
+ *          reentrancy structure (errno, strtok, rand, stdio state), malloc is
+ *          protected by a semaphore and _write sends a whole call at once
+ *
+ * @note    Syscalls_Init must be called after OSInit and UART_Init and before
+ *          the tasks that use newlib are created. The hooks must be called from
+ *          the application hooks (app_hooks.c)
+ */
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/times.h>
+#include <reent.h>
+
+#include "ucos_ii.h"
+
+/**
+ * @brief   Number of tasks with their own reentrancy structure
+ *
+ * @note    The others (and the tasks created before Syscalls_Init, as the idle
+ *          and statistic tasks) share the global one
+ */
+#ifndef SYSCALLS_REENTCOUNT
+#define SYSCALLS_REENTCOUNT         8
+#endif
+
+/**
+ * @brief   UART used for stdin, stdout and stderr
+ */
+#ifndef SYSCALLS_UART
+#define SYSCALLS_UART               UART_1
+#endif
+
+void Syscalls_Init(void);
+void Syscalls_TaskCreateHook(OS_TCB *ptcb);
+void Syscalls_TaskDelHook(OS_TCB *ptcb);
+void Syscalls_SwHook(void);
+void Syscalls_IdleHook(void);
+
+void _exit(void);
+int _close(int file);
+extern char *__env[1];
+extern char **environ;
+int _execve(char *name, char **argv, char **env);
+int _fork(void);
+int _fstat(int file, struct stat *st);
+int _getpid(void);
+int _isatty(int file);
+int _kill(int pid, int sig);
+int _link(char *old, char *new);
+int _lseek(int file, int ptr, int dir);
+int _open(const char *name, int flags, int mode);
+int _read(int file, char *ptr, int len);
+caddr_t _sbrk(int incr);
+int _stat(char *file, struct stat *st);
+int _times(struct tms *buf);
+int _unlink(char *name);
+int _wait(int *status);
+int _write(int file, char *ptr, int len);
+
+#endif
@@ -0,0 +1,180 @@
+/**
+ * @file     tasklog.c
+ * @brief    Lock free log for uC/OS-II tasks
+ *
+ * @note     See tasklog.h
+ *
+ * @note     head and tail are free running counters (the index is taken with
+ *           the mask). The producer writes the chars and then head; the
+ *           consumer reads head and then the chars. A DMB between them keeps
+ *           this order for the other side
+ *
+ ******************************************************************************/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "stm32f746xx.h"
+#include "ucos_ii.h"
+#include "syscalls.h"
+#include "tasklog.h"
+
+#if (TASKLOG_RINGSIZE&(TASKLOG_RINGSIZE-1)) != 0
+#error TASKLOG_RINGSIZE must be a power of 2
+#endif
+
+/**
+ * @brief   Ring of a task
+ *
+ * @note    A ring of a deleted task is released by the consumer when empty
+ */
+typedef struct {
+    volatile uint32_t   head;               ///< written by the task
+    volatile uint32_t   tail;               ///< written by TaskLog_Task
+    volatile uint32_t   drops;
+    volatile uint8_t    used;
+    volatile uint8_t    deleted;
+    char                data[TASKLOG_RINGSIZE];
+} Ring;
+
+static Ring  rings[TASKLOG_RINGCOUNT];
+static Ring *ringtab[OS_LOWEST_PRIO+1];
+static int   initialized = 0;
+static uint32_t olddrops = 0;               ///< of released rings
+
+void
+TaskLog_Init(void) {
+
+    initialized = 1;
+}
+
+/**
+ * @brief   Task creation hook
+ *
+ * @note    Called with interrupts disabled
+ */
+void
+TaskLog_TaskCreateHook(OS_TCB *ptcb) {
+int i;
+
+    if( !initialized )
+        return;
+    for(i=0;i<TASKLOG_RINGCOUNT;i++) {
+        if( !rings[i].used ) {
+            rings[i].head    = 0;
+            rings[i].tail    = 0;
+            rings[i].drops   = 0;
+            rings[i].deleted = 0;
+            rings[i].used    = 1;
+            ringtab[ptcb->OSTCBPrio] = &rings[i];
+            return;
+        }
+    }
+}
+
+/**
+ * @brief   Task deletion hook
+ *
+ * @note    Called with interrupts disabled. The pending messages are still sent
+ */
+void
+TaskLog_TaskDelHook(OS_TCB *ptcb) {
+Ring *r = ringtab[ptcb->OSTCBPrio];
+
+    if( r == 0 )
+        return;
+    ringtab[ptcb->OSTCBPrio] = 0;
+    r->deleted = 1;
+}
+
+/**
+ * @brief   Log a message
+ *
+ * @note    Formatted by vsnprintf, with the newlib state of the task. Returns
+ *          the number of chars or a negative error code
+ */
+int
+TaskLog_Printf(const char *fmt, ...) {
+Ring *r;
+va_list ap;
+char msg[TASKLOG_MSGSIZE];
+uint32_t head;
+int n,i;
+
+    r = ringtab[OSTCBCur->OSTCBPrio];
+    if( r == 0 )
+        return TASKLOG_ERROR_NORING;
+
+    va_start(ap,fmt);
+    n = vsnprintf(msg,sizeof(msg),fmt,ap);
+    va_end(ap);
+    if( n < 0 )
+        return n;
+    if( n > (int) sizeof(msg)-1 )
+        n = sizeof(msg)-1;
+
+    head = r->head;
+    if( (uint32_t) n > TASKLOG_RINGSIZE-(head-r->tail) ) {
+        r->drops++;
+        return TASKLOG_ERROR_FULL;
+    }
+    for(i=0;i<n;i++)
+        r->data[(head+i)&(TASKLOG_RINGSIZE-1)] = msg[i];
+    __DMB();                                // chars before head
+    r->head = head+n;
+    return n;
+}
+
+/**
+ * @brief   Messages dropped by all tasks
+ */
+uint32_t
+TaskLog_GetDrops(void) {
+uint32_t drops = olddrops;
+int i;
+
+    for(i=0;i<TASKLOG_RINGCOUNT;i++) {
+        if( rings[i].used )
+            drops += rings[i].drops;
+    }
+    return drops;
+}
+
+/**
+ * @brief   Consumer task
+ *
+ * @note    Every TASKLOG_PERIOD ticks sends what is in the rings, in at most
+ *          two calls to _write for each one (the data may wrap around)
+ */
+void
+TaskLog_Task(void *param) {
+Ring *r;
+uint32_t head,tail,n;
+int i;
+
+    while(1) {
+        for(i=0;i<TASKLOG_RINGCOUNT;i++) {
+            r = &rings[i];
+            if( !r->used )
+                continue;
+            head = r->head;
+            __DMB();                        // head before chars
+            tail = r->tail;
+            if( head != tail ) {
+                n = TASKLOG_RINGSIZE-(tail&(TASKLOG_RINGSIZE-1));
+                if( n > head-tail )
+                    n = head-tail;
+                _write(1,&r->data[tail&(TASKLOG_RINGSIZE-1)],n);
+                if( head-tail > n )
+                    _write(1,r->data,head-tail-n);
+                __DMB();                    // chars read before tail
+                r->tail = head;
+            } else if( r->deleted ) {
+                olddrops += r->drops;
+                r->used = 0;
+            }
+        }
+        OSTimeDly(TASKLOG_PERIOD);
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef TASKLOG_H
+#define TASKLOG_H
+/**
+ * @file     tasklog.h
+ * @brief    Lock free log for uC/OS-II tasks
+ *
+ * @note     Each task writes its messages into its own ring buffer. A ring has
+ *           one producer (the task) and one consumer (TaskLog_Task), so no lock
+ *           is needed: the task only moves head and the consumer only moves
+ *           tail. A message is formatted in the stack of the task and copied
+ *           whole, or dropped and counted when there is no space. A task never
+ *           waits to log
+ *
+ * @note     TaskLog_Task sends the messages with _write (syscalls.c), so they
+ *           are not mixed with the printf output of other tasks
+ *
+ * @note     TaskLog_TaskCreateHook and TaskLog_TaskDelHook must be called from
+ *           App_TaskCreateHook and App_TaskDelHook (app_hooks.c). Only tasks
+ *           created after TaskLog_Init get a ring. Not usable in interrupts
+ *
+ ******************************************************************************/
+
+#include <stdint.h>
+
+#include "ucos_ii.h"
+
+/**
+ * @brief   Rings
+ *
+ * @note    TASKLOG_RINGSIZE must be a power of 2
+ */
+///@{
+#ifndef TASKLOG_RINGCOUNT
+#define TASKLOG_RINGCOUNT           8
+#endif
+#ifndef TASKLOG_RINGSIZE
+#define TASKLOG_RINGSIZE            256
+#endif
+#ifndef TASKLOG_MSGSIZE
+#define TASKLOG_MSGSIZE             96      ///< longer messages are truncated
+#endif
+///@}
+
+/**
+ * @brief   Period of TaskLog_Task in ticks
+ */
+#ifndef TASKLOG_PERIOD
+#define TASKLOG_PERIOD              10
+#endif
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define TASKLOG_ERROR_NORING        (-1)    ///< task without a ring
+#define TASKLOG_ERROR_FULL          (-2)    ///< message dropped
+///@}
+
+void     TaskLog_Init(void);
+void     TaskLog_TaskCreateHook(OS_TCB *ptcb);
+void     TaskLog_TaskDelHook(OS_TCB *ptcb);
+int      TaskLog_Printf(const char *fmt, ...);
+uint32_t TaskLog_GetDrops(void);
+void     TaskLog_Task(void *param);
+
+#endif // TASKLOG_H
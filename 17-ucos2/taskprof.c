@@ -0,0 +1,163 @@
+/**
+ * @file     taskprof.c
+ * @brief    Per task CPU usage, context switches and stack usage for uC/OS-II
+ *
+ * @note     The cycle counter (DWT->CYCCNT) is read at each context switch and
+ *           the cycles since the last one are added to the task switched out.
+ *           It uses the profiling fields of the OS_TCB (OS_TASK_PROFILE_EN):
+ *           OSTCBCyclesStart, OSTCBCyclesTot and OSTCBCtxSwCtr
+ *
+ * @note     OSTCBCyclesTot is 32 bits (21 s at 200 MHz), so it is cleared at
+ *           each sample. TASKPROF_PERIOD must be shorter than that
+ *
+ * @note     The time spent in interrupts is charged to the task interrupted
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "stm32f746xx.h"
+#include "ucos_ii.h"
+#include "uart.h"
+#include "taskprof.h"
+
+/**
+ * @brief   Cycle counter at the last sample
+ */
+static uint32_t taskprof_last = 0;
+
+/**
+ * @brief   TaskProf_Init
+ *
+ * @note    Enables the cycle counter. Must be called before OSStart
+ */
+void
+TaskProf_Init(void) {
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;                  // Unlock access on Cortex-M7
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    taskprof_last = 0;
+}
+
+/**
+ * @brief   TaskProf_SwHook
+ *
+ * @note    Called by OSTaskSwHook with interrupts disabled. OSTCBCur is the
+ *          task switched out and OSTCBHighRdy the one switched in
+ */
+void
+TaskProf_SwHook(void) {
+uint32_t now = DWT->CYCCNT;
+
+    if( OSTCBCur != (OS_TCB *) 0 )
+        OSTCBCur->OSTCBCyclesTot += now-OSTCBCur->OSTCBCyclesStart;
+    OSTCBHighRdy->OSTCBCyclesStart = now;
+}
+
+/**
+ * @brief   TaskProf_Sample
+ *
+ * @note    Fills info with up to n tasks, in priority order, and clears the
+ *          counters. interval is the number of cycles since the last sample.
+ *          Returns the number of tasks
+ *
+ * @note    It scans the stacks (OSTaskStkChk), so it must be called from a
+ *          low priority task
+ */
+int
+TaskProf_Sample(TaskProf_Info *info, int n, uint32_t *interval) {
+OS_TCB *ptcb;
+OS_STK_DATA stk;
+uint32_t now;
+int prio,k = 0;
+#if OS_CRITICAL_METHOD == 3u
+OS_CPU_SR cpu_sr = 0u;
+#endif
+
+    OS_ENTER_CRITICAL();
+    now = DWT->CYCCNT;
+    // Running task has not been charged yet
+    OSTCBCur->OSTCBCyclesTot += now-OSTCBCur->OSTCBCyclesStart;
+    OSTCBCur->OSTCBCyclesStart = now;
+    *interval = now-taskprof_last;
+    taskprof_last = now;
+    for(prio=0;prio<=OS_LOWEST_PRIO && k<n;prio++) {
+        ptcb = OSTCBPrioTbl[prio];
+        if( ptcb == (OS_TCB *) 0 || ptcb == OS_TCB_RESERVED )
+            continue;
+        info[k].prio     = prio;
+        info[k].name     = (const char *) ptcb->OSTCBTaskName;
+        info[k].cycles   = ptcb->OSTCBCyclesTot;
+        info[k].switches = ptcb->OSTCBCtxSwCtr;
+        info[k].stkused  = 0;
+        info[k].stksize  = 0;
+        ptcb->OSTCBCyclesTot = 0;
+        ptcb->OSTCBCtxSwCtr  = 0;
+        k++;
+    }
+    OS_EXIT_CRITICAL();
+
+    // Stack scanning is long. Done with interrupts enabled
+    for(prio=0;prio<k;prio++) {
+        if( OSTaskStkChk(info[prio].prio,&stk) == OS_ERR_NONE ) {
+            info[prio].stkused = stk.OSUsed;
+            info[prio].stksize = stk.OSUsed+stk.OSFree;
+        }
+    }
+    return k;
+}
+
+/**
+ * @brief   TaskProf_Report
+ *
+ * @note    Samples and prints a line for each task
+ *
+ *          prio name cpu% switches stack-used/stack-size
+ *
+ *          CPU usage is in tenths of percent
+ */
+void
+TaskProf_Report(void (*out)(const char *s)) {
+static TaskProf_Info info[OS_MAX_TASKS+OS_N_SYS_TASKS];
+char line[80];
+uint32_t interval,pm;
+int i,n;
+
+    n = TaskProf_Sample(info,sizeof(info)/sizeof(info[0]),&interval);
+    if( interval == 0 )
+        interval = 1;
+    out("prio name             cpu%  switches  stack\r\n");
+    for(i=0;i<n;i++) {
+        pm = (uint32_t) (((uint64_t) info[i].cycles*1000)/interval);
+        snprintf(line,sizeof(line),"%4u %-16.16s %3lu.%lu %9lu  %lu/%lu\r\n",
+                (unsigned) info[i].prio,
+                info[i].name ? info[i].name : "?",
+                (unsigned long) pm/10,(unsigned long) pm%10,
+                (unsigned long) info[i].switches,
+                (unsigned long) info[i].stkused,
+                (unsigned long) info[i].stksize);
+        out(line);
+    }
+}
+
+static void
+taskprof_out(const char *s) {
+
+    UART_WriteString(UART_1,(char *) s);
+}
+
+/**
+ * @brief   TaskProf_Task
+ *
+ * @note    Prints the report on UART_1 every TASKPROF_PERIOD ticks
+ */
+void
+TaskProf_Task(void *param) {
+
+    (void) param;
+    while(1) {
+        OSTimeDly(TASKPROF_PERIOD);
+        TaskProf_Report(taskprof_out);
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef TASKPROF_H
+#define TASKPROF_H
+/**
+ * @file     taskprof.h
+ * @brief    Per task CPU usage, context switches and stack usage for uC/OS-II
+ *
+ * @note     TaskProf_SwHook must be called from App_TaskSwHook (app_hooks.c)
+ *
+ * @note     Stack usage is only known for tasks created with OSTaskCreateExt
+ *           and the options OS_TASK_OPT_STK_CHK|OS_TASK_OPT_STK_CLR
+ *
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/**
+ * @brief   Report period in ticks
+ */
+#ifndef TASKPROF_PERIOD
+#define TASKPROF_PERIOD             5000
+#endif
+
+/**
+ * @brief   Usage of a task in the last interval
+ */
+typedef struct {
+    uint8_t     prio;
+    const char *name;
+    uint32_t    cycles;             // cycles running
+    uint32_t    switches;           // times switched in
+    uint32_t    stkused;            // bytes, high water mark
+    uint32_t    stksize;            // bytes (0 when unknown)
+} TaskProf_Info;
+
+void TaskProf_Init(void);
+void TaskProf_SwHook(void);
+int  TaskProf_Sample(TaskProf_Info *info, int n, uint32_t *interval);
+void TaskProf_Report(void (*out)(const char *s));
+void TaskProf_Task(void *param);
+
+#endif // TASKPROF_H
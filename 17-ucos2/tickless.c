@@ -0,0 +1,248 @@
+/**
+ * @file    tickless.c
+ *
+ * @note    Tickless idle for uC/OS-II
+ *
+ * @note    LPTIM1 counts continuously at LSE/8 (4096 Hz) from 0 to 0xFFFF. A
+ *          sleep programs the compare register for the tick before the nearest
+ *          delay expiry, so it is at most 16 s long and that last tick is given
+ *          by SysTick as usual. The counter is read before and after it, so an
+ *          earlier wakeup by another interrupt (e.g. UART) is compensated too
+ *
+ * @note    It is called by the idle task (App_TaskIdleHook), so no other task
+ *          is ready. The kernel lists are used with interrupts disabled
+ *          (PRIMASK), because WFI does not wake up on interrupts masked by
+ *          BASEPRI (OS_ENTER_CRITICAL)
+ *
+ * @note    The uC/OS-II timers (OS_TMR_EN) are signalled by the tick hook and
+ *          get only one step after a sleep. They are not used here
+ *
+ * @note    LPTIM1 wakes the core from Stop mode through EXTI line 23
+ *
+ * @note    The debugger loses the connection in Stop mode unless DBGMCU_CR
+ *          DBG_STOP is set
+ */
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "ucos_ii.h"
+#include "tickless.h"
+
+/**
+ * @brief   LPTIM1 parameters
+ */
+///@{
+#define LPTIM_FREQ                  (LSE_FREQ/8)
+#define LPTIM_MAXCOUNT              0xFFFF
+/// Longest sleep in ticks, with a margin for the compare write (CMPOK)
+#define TICKLESS_MAXTICKS   ((uint32_t) (((uint64_t) (LPTIM_MAXCOUNT-16)*OS_TICKS_PER_SEC)/LPTIM_FREQ))
+///@}
+
+/// Fraction of tick carried between sleeps (in 1/LPTIM_FREQ of a tick)
+static uint32_t tickless_remainder = 0;
+
+/// Ticks slept
+static uint32_t tickless_sleepticks = 0;
+
+/**
+ * @brief   lptim_read
+ *
+ * @note    CNT is in the LSE domain. It is valid when two reads are equal
+ */
+static uint32_t
+lptim_read(void) {
+uint32_t c1,c2;
+
+    c2 = LPTIM1->CNT;
+    do {
+        c1 = c2;
+        c2 = LPTIM1->CNT;
+    } while( c1 != c2 );
+    return c1;
+}
+
+/**
+ * @brief   LP_TIMER1_IRQHandler
+ *
+ * @note    Only wakes the core up. It does not call the kernel
+ */
+void
+LP_TIMER1_IRQHandler(void) {
+
+    LPTIM1->ICR = LPTIM_ICR_CMPMCF;
+    EXTI->PR = EXTI_PR_PR23;
+}
+
+/**
+ * @brief   tickless_idleticks
+ *
+ * @note    Returns the ticks until the nearest delay expires, 0 when a task
+ *          other than idle is ready or the scheduler is locked, and
+ *          TICKLESS_MAXTICKS when no task is delayed
+ */
+static uint32_t
+tickless_idleticks(void) {
+OS_TCB *ptcb;
+uint32_t ticks = TICKLESS_MAXTICKS;
+
+    if( OSLockNesting > 0u )
+        return 0;
+    for(ptcb=OSTCBList;ptcb->OSTCBPrio!=OS_TASK_IDLE_PRIO;ptcb=ptcb->OSTCBNext) {
+        if( OSRdyTbl[ptcb->OSTCBY] & ptcb->OSTCBBitX )
+            return 0;
+        if( ptcb->OSTCBDly != 0u && ptcb->OSTCBDly < ticks )
+            ticks = ptcb->OSTCBDly;
+    }
+    return ticks;
+}
+
+/**
+ * @brief   tickless_announce
+ *
+ * @note    Gives n ticks to the kernel. Same as n calls to OSTimeTick, without
+ *          the hooks. Returns 1 when a task was made ready
+ */
+static int
+tickless_announce(uint32_t n) {
+OS_TCB *ptcb;
+int ready = 0;
+
+    OSTime += n;
+    for(ptcb=OSTCBList;ptcb->OSTCBPrio!=OS_TASK_IDLE_PRIO;ptcb=ptcb->OSTCBNext) {
+        if( ptcb->OSTCBDly == 0u )
+            continue;
+        if( ptcb->OSTCBDly > n ) {
+            ptcb->OSTCBDly -= n;
+            continue;
+        }
+        ptcb->OSTCBDly = 0u;
+        if( (ptcb->OSTCBStat & OS_STAT_PEND_ANY) != OS_STAT_RDY ) {
+            ptcb->OSTCBStat    &= (INT8U) ~(INT8U) OS_STAT_PEND_ANY;
+            ptcb->OSTCBStatPend = OS_STAT_PEND_TO;
+        } else {
+            ptcb->OSTCBStatPend = OS_STAT_PEND_OK;
+        }
+        if( (ptcb->OSTCBStat & OS_STAT_SUSPEND) == OS_STAT_RDY ) {
+            OSRdyGrp               |= ptcb->OSTCBBitY;
+            OSRdyTbl[ptcb->OSTCBY] |= ptcb->OSTCBBitX;
+            ready = 1;
+        }
+    }
+    return ready;
+}
+
+/**
+ * @brief   Tickless_Init
+ *
+ * @note    Starts the LSE, when not running, and LPTIM1
+ */
+void
+Tickless_Init(void) {
+
+    // Access to the backup domain for the LSE
+    RCC->APB1ENR |= RCC_APB1ENR_PWREN;
+    __DSB();
+    PWR->CR1 |= PWR_CR1_DBP;
+    if( (RCC->BDCR&RCC_BDCR_LSERDY) == 0 ) {
+        RCC->BDCR |= RCC_BDCR_LSEON;
+        while( (RCC->BDCR&RCC_BDCR_LSERDY) == 0 ) {}
+    }
+
+    // LPTIM1 clocked by LSE
+    RCC->DCKCFGR2 = (RCC->DCKCFGR2&~RCC_DCKCFGR2_LPTIM1SEL)
+                   |RCC_DCKCFGR2_LPTIM1SEL_0|RCC_DCKCFGR2_LPTIM1SEL_1;
+    RCC->APB1ENR |= RCC_APB1ENR_LPTIM1EN;
+    __DSB();
+
+    // CFGR and IER can only be written with the timer disabled
+    LPTIM1->CR   = 0;
+    LPTIM1->CFGR = LPTIM_CFGR_PRESC_0|LPTIM_CFGR_PRESC_1;      // /8
+    LPTIM1->IER  = LPTIM_IER_CMPMIE;
+    LPTIM1->CR   = LPTIM_CR_ENABLE;
+    LPTIM1->ARR  = LPTIM_MAXCOUNT;
+    while( (LPTIM1->ISR&LPTIM_ISR_ARROK) == 0 ) {}
+    LPTIM1->ICR  = LPTIM_ICR_ARROKCF;
+    LPTIM1->CR  |= LPTIM_CR_CNTSTRT;
+
+    // Wakeup from Stop mode
+    EXTI->IMR  |= EXTI_IMR_MR23;
+    EXTI->RTSR |= EXTI_RTSR_TR23;
+
+    NVIC_SetPriority(LPTIM1_IRQn,0);
+    NVIC_ClearPendingIRQ(LPTIM1_IRQn);
+    NVIC_EnableIRQ(LPTIM1_IRQn);
+}
+
+/**
+ * @brief   Tickless_Idle
+ *
+ * @note    Called by App_TaskIdleHook
+ *
+ * @note    When the nearest delay expiry is nearer than TICKLESS_MINTICKS, it
+ *          only waits for the next interrupt
+ */
+void
+Tickless_Idle(int mode) {
+uint32_t ticks,start,counts,elapsed;
+int ready;
+
+    __disable_irq();
+    ticks = tickless_idleticks();
+    if( mode == TICKLESS_NONE || ticks < TICKLESS_MINTICKS ) {
+        if( ticks > 0 )
+            __WFI();        // taken after __enable_irq
+        __enable_irq();
+        return;
+    }
+    ticks--;
+
+    // Stop SysTick. A tick pending is taken after __enable_irq
+    SysTick->CTRL &= ~(SysTick_CTRL_ENABLE_Msk|SysTick_CTRL_TICKINT_Msk);
+
+    counts = (ticks*LPTIM_FREQ)/OS_TICKS_PER_SEC;
+    start  = lptim_read();
+    LPTIM1->ICR = LPTIM_ICR_CMPMCF|LPTIM_ICR_CMPOKCF;
+    LPTIM1->CMP = (start+counts)&LPTIM_MAXCOUNT;
+    while( (LPTIM1->ISR&LPTIM_ISR_CMPOK) == 0 ) {}
+    NVIC_ClearPendingIRQ(LPTIM1_IRQn);
+
+    if( mode == TICKLESS_STOP ) {
+        PWR->CR1 = (PWR->CR1&~PWR_CR1_PDDS)|PWR_CR1_LPDS;
+        SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+    }
+    __DSB();
+    __WFI();
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+
+    if( mode == TICKLESS_STOP ) {
+        // The core runs from HSI after Stop mode
+        SystemConfigMainPLL(&MainPLLConfiguration_200MHz);
+        SystemSetCoreClock(CLOCKSRC_PLL,1);
+    }
+
+    // Compensate the ticks elapsed (carrying the fraction)
+    elapsed = (lptim_read()-start)&LPTIM_MAXCOUNT;
+    tickless_remainder += elapsed*OS_TICKS_PER_SEC;
+    ticks = tickless_remainder/LPTIM_FREQ;
+    tickless_remainder %= LPTIM_FREQ;
+    tickless_sleepticks += ticks;
+    ready = ticks ? tickless_announce(ticks) : 0;
+
+    SysTick->VAL   = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk|SysTick_CTRL_TICKINT_Msk;
+    __enable_irq();
+
+    if( ready )
+        OS_Sched();
+}
+
+/**
+ * @brief   Tickless_GetSleepTicks
+ *
+ * @note    Ticks spent in Sleep or Stop mode since the start
+ */
+uint32_t
+Tickless_GetSleepTicks(void) {
+
+    return tickless_sleepticks;
+}
@@ -0,0 +1,47 @@
+#ifndef TICKLESS_H
+#define TICKLESS_H
+/**
+ * @file    tickless.h
+ *
+ * @note    Tickless idle for uC/OS-II
+ *
+ * @note    When all tasks are delayed or waiting, the idle task stops SysTick
+ *          and LPTIM1, clocked by the LSE (32768 Hz), wakes the core up when
+ *          the nearest delay (OSTCBDly) expires. The ticks elapsed are then
+ *          given to the kernel at once (OSTime and the task delays)
+ *
+ * @note    In Stop mode the PLL and HSE are turned off and the clock is
+ *          configured again at wakeup, taking some tens of microseconds. The
+ *          UARTs do not receive in Stop mode
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Modes
+ */
+///@{
+#define TICKLESS_NONE               0       // SysTick runs, WFI between ticks
+#define TICKLESS_SLEEP              1       // Sleep mode (clocks running)
+#define TICKLESS_STOP               2       // Stop mode (main regulator in low power)
+///@}
+
+/**
+ * @brief   Parameters
+ */
+///@{
+/// Mode used by the idle task
+#ifndef TICKLESS_MODE
+#define TICKLESS_MODE               TICKLESS_NONE
+#endif
+/// Idle ticks below which SysTick is kept running
+#ifndef TICKLESS_MINTICKS
+#define TICKLESS_MINTICKS           3
+#endif
+///@}
+
+void     Tickless_Init(void);
+void     Tickless_Idle(int mode);
+uint32_t Tickless_GetSleepTicks(void);
+
+#endif // TICKLESS_H
@@ -8,6 +8,7 @@
  ** @note     Direct access to registers
  ** @note     No library except CMSIS is used
  ** @note     Only asynchronous communication
+ ** @note     Interrupt driven. The tasks wait on uC/OS-II semaphores
  **
  **/
 
@@ -15,6 +16,8 @@
 #include "system_stm32f746.h"
 #include "gpio.h"
 #include "uart.h"
+#include "fifo.h"
+#include "ucos_ii.h"
 
 /**
  ** @brief Bit manipulation macros
@@ -33,8 +36,38 @@ typedef struct {
     USART_TypeDef      *device;
     GPIO_PinConfiguration    txpinconf;
     GPIO_PinConfiguration    rxpinconf;
+    IRQn_Type           irqn;
+    FIFO                inputfifo;
+    FIFO                outputfifo;
+    OS_EVENT           *rxsem;          // counts chars in inputfifo
+    OS_EVENT           *txsem;          // counts free space in outputfifo
+    uint32_t            rxdrops;        // chars lost (fifo full or overrun)
 } UART_Info;
 
+/**
+ ** @brief  Default FIFO areas (used by UART_Init)
+ **/
+//@{
+#define INPUTAREASIZE    (16)
+#define OUTPUTAREASIZE   (16)
+
+static DECLARE_FIFO_AREA(inputarea,INPUTAREASIZE);
+static DECLARE_FIFO_AREA(outputarea,OUTPUTAREASIZE);
+//@}
+
+/**
+ ** @brief  Interrupt level for UARTs
+ **
+ ** @note   It must not be higher (smaller) than CPU_CFG_KA_IPL_BOUNDARY
+ **         (app_cfg.h), because the interrupt routine calls the kernel and
+ **         OS_ENTER_CRITICAL must mask it
+ **/
+#define INTLEVEL 10
+
+#if INTLEVEL < CPU_CFG_KA_IPL_BOUNDARY
+#error "UART interrupt level must be kernel aware (>= CPU_CFG_KA_IPL_BOUNDARY)"
+#endif
+
 /**
  ** @brief  List of known UARTs
  **
@@ -42,17 +75,17 @@ typedef struct {
  **/
 //@{
 static UART_Info uarttab[] = {
-    /* Device        txconfig        rxconfig    */
-    /*              Port  Pin AF    Port  Pin AF */
-    { USART1,    { GPIOA, 9, 7 }, { GPIOB, 7, 7 } },
-    { USART2,    { GPIOA, 2, 7 }, { GPIOA, 3, 7 } },
-    { USART3,    { GPIOD, 8, 7 }, { GPIOD, 9, 7 } },
-    { UART4,     { GPIOC,10, 8 }, { GPIOC,11, 8 } },
-    { UART5,     { GPIOC,12, 7 }, { GPIOD, 2, 8 } },
-    { USART6,    { GPIOC, 6, 8 }, { GPIOC, 7, 8 } },
-    { UART7,     { GPIOE, 8, 8 }, { GPIOE, 7, 8 } },
-    { UART8,     { GPIOE, 1, 8 }, { GPIOE, 0, 8 } },
-    { 0,         { 0,     0, 0 }, { 0,     0, 0 } }
+    /* Device        txconfig        rxconfig        IRQ         */
+    /*              Port  Pin AF    Port  Pin AF                 */
+    { USART1,    { GPIOA, 9, 7 }, { GPIOB, 7, 7 }, USART1_IRQn },
+    { USART2,    { GPIOA, 2, 7 }, { GPIOA, 3, 7 }, USART2_IRQn },
+    { USART3,    { GPIOD, 8, 7 }, { GPIOD, 9, 7 }, USART3_IRQn },
+    { UART4,     { GPIOC,10, 8 }, { GPIOC,11, 8 }, UART4_IRQn  },
+    { UART5,     { GPIOC,12, 7 }, { GPIOD, 2, 8 }, UART5_IRQn  },
+    { USART6,    { GPIOC, 6, 8 }, { GPIOC, 7, 8 }, USART6_IRQn },
+    { UART7,     { GPIOE, 8, 8 }, { GPIOE, 7, 8 }, UART7_IRQn  },
+    { UART8,     { GPIOE, 1, 8 }, { GPIOE, 0, 8 }, UART8_IRQn  },
+    { 0,         { 0,     0, 0 }, { 0,     0, 0 }, 0           }
 };
 static const int uarttabsize = sizeof(uarttab)/sizeof(UART_Info)-1;
 //@}
@@ -72,23 +105,121 @@ void UART_EnableClock(USART_TypeDef *uart) {
     else if ( uart == UART8 )   RCC->APB1ENR |= RCC_APB1ENR_UART8EN;
 }
 
+/**
+ * @brief   Interrupt processing
+ *
+ * @note    Identical to all uarts/usarts
+ *
+ * @note    A received char is stored in the input FIFO and posted to rxsem.
+ *          A char sent from the output FIFO is posted to txsem, so a task
+ *          waiting for space runs. TXEIE is disabled when the FIFO is empty
+ */
+static void ProcessInterrupt(int un) {
+USART_TypeDef  *uart;
+UART_Info      *u;
+uint32_t        isr;
+int             c;
+
+    u    = &uarttab[un];
+    uart = u->device;
+    isr  = uart->ISR;
+
+    /* Receiving */
+    if( isr & USART_ISR_RXNE ) {
+        c = uart->RDR;
+        if( fifo_insert(u->inputfifo,c) == 0 )
+            OSSemPost(u->rxsem);
+        else
+            u->rxdrops++;
+    }
+    if( isr & USART_ISR_ORE ) {
+        u->rxdrops++;
+    }
+    /* Transmitting */
+    if( (uart->CR1 & USART_CR1_TXEIE) && (isr & USART_ISR_TXE) ) {
+        c = fifo_remove(u->outputfifo);
+        if( c >= 0 ) {
+            uart->TDR = c;
+            OSSemPost(u->txsem);
+        }
+        if( fifo_empty(u->outputfifo) )
+            uart->CR1 &= ~USART_CR1_TXEIE;
+    }
+    uart->ICR = USART_ICR_ORECF|USART_ICR_FECF|USART_ICR_NCF|USART_ICR_PECF;
+}
+
+/**
+ ** @brief  Interrupt routines for USART and UART
+ **
+ ** @note   OSIntEnter/OSIntExit, so a task made ready runs at the exit
+ **/
+///@{
+#define UART_IRQHANDLER(NAME,UN)    \
+void NAME(void) {                   \
+                                    \
+    OSIntEnter();                   \
+    ProcessInterrupt(UN);           \
+    OSIntExit();                    \
+}
+
+UART_IRQHANDLER(USART1_IRQHandler,UART_1)
+UART_IRQHANDLER(USART2_IRQHandler,UART_2)
+UART_IRQHANDLER(USART3_IRQHandler,UART_3)
+UART_IRQHANDLER(UART4_IRQHandler,UART_4)
+UART_IRQHANDLER(UART5_IRQHandler,UART_5)
+UART_IRQHANDLER(USART6_IRQHandler,UART_6)
+UART_IRQHANDLER(UART7_IRQHandler,UART_7)
+UART_IRQHANDLER(UART8_IRQHandler,UART_8)
+///@}
+
 
 /**
- ** @brief UART Initialization
+ ** @brief UART Initialization Simplified
  **
  ** @note  Use defines in uart.h to configure the uart, or'ing the parameters
+ **
+ ** @note  The default FIFOs can be used by only one UART. The others must
+ **        be initialized by UART_InitExt
  **/
 int
 UART_Init(int uartn, uint32_t config) {
+FIFO in;
+FIFO out;
+
+    in  = fifo_init(inputarea,INPUTAREASIZE);
+    out = fifo_init(outputarea,OUTPUTAREASIZE);
+
+    return UART_InitExt(uartn,config,in,out);
+}
+
+/**
+ ** @brief UART Initialization Extended
+ **
+ ** @note  Use defines in uart.h to configure the uart, or'ing the parameters
+ **
+ ** @note  It creates the semaphores, so it must be called after OSInit.
+ **        It must be called only once for each UART
+ **/
+int
+UART_InitExt(int uartn, uint32_t config, FIFO in, FIFO out) {
 uint32_t baudrate,div,t,over;
 USART_TypeDef * uart;
 uint32_t uartfreq;
 uint32_t cr1,cr2,cr3,ckcfgr;
 
     if( uartn >= uarttabsize ) return -1;
+    if( in == 0 || out == 0 ) return -1;
 
     uart = uarttab[uartn].device;
 
+    // Configure FIFOs and semaphores
+    uarttab[uartn].inputfifo  = in;
+    uarttab[uartn].outputfifo = out;
+    uarttab[uartn].rxdrops    = 0;
+    uarttab[uartn].rxsem      = OSSemCreate(0);
+    uarttab[uartn].txsem      = OSSemCreate(fifo_capacity(out));
+    if( uarttab[uartn].rxsem == 0 || uarttab[uartn].txsem == 0 ) return 4;
+
     // Configure pins
     GPIO_ConfigureSinglePin(&uarttab[uartn].txpinconf);
     GPIO_ConfigureSinglePin(&uarttab[uartn].rxpinconf);
@@ -200,6 +331,14 @@ uint32_t cr1,cr2,cr3,ckcfgr;
     uart->CR2 = cr2;
     uart->CR3 = cr3;
 
+    // Enable interrupts on NVIC
+    NVIC_SetPriority(uarttab[uartn].irqn,INTLEVEL);
+    NVIC_ClearPendingIRQ(uarttab[uartn].irqn);
+    NVIC_EnableIRQ(uarttab[uartn].irqn);
+
+    // Enable interrupt when RX not empty. TXEIE is enabled when writing
+    uart->CR1 |= USART_CR1_RXNEIE;
+
     // Enable UART
     uart->CR1 |= USART_CR1_TE|USART_CR1_RE;
     uart->CR1 |= USART_CR1_UE;
@@ -209,17 +348,28 @@ uint32_t cr1,cr2,cr3,ckcfgr;
 /**
  ** @brief UART Send a character
  **
+ ** @note  It puts the char in the output FIFO. When it is full, the task
+ **        waits until the interrupt routine sends a char
  **/
 int
 UART_WriteChar(int uartn, uint32_t c) {
 USART_TypeDef *uart;
+INT8U err;
+#if OS_CRITICAL_METHOD == 3u
+OS_CPU_SR cpu_sr = 0u;
+#endif
 
     if( uartn >= uarttabsize ) return -1;
 
     uart = uarttab[uartn].device;
 
-    while( (uart->ISR&USART_ISR_TXE)==0 ) {}
-    uart->TDR = c;
+    OSSemPend(uarttab[uartn].txsem,0,&err);
+    if( err != OS_ERR_NONE ) return -1;
+
+    OS_ENTER_CRITICAL();
+    fifo_insert(uarttab[uartn].outputfifo,c);
+    uart->CR1 |= USART_CR1_TXEIE;
+    OS_EXIT_CRITICAL();
 
     return 0;
 }
@@ -241,29 +391,40 @@ UART_WriteString(int uartn, char s[]) {
     return 0;
 }
 
+/**
+ ** @brief Get a character from the input FIFO
+ **
+ ** @note  The caller has taken a count of rxsem, so there is one
+ **/
+static int
+uart_getchar(int uartn) {
+int c;
+#if OS_CRITICAL_METHOD == 3u
+OS_CPU_SR cpu_sr = 0u;
+#endif
+
+    OS_ENTER_CRITICAL();
+    c = fifo_remove(uarttab[uartn].inputfifo);
+    OS_EXIT_CRITICAL();
+    return c;
+}
+
 /**
  ** @brief Read a character from UART
  **
- ** @note  It blocks until a character is entered
+ ** @note  The task waits until a character is entered
  **
  **/
 int
 UART_ReadChar(int uartn) {
-USART_TypeDef *uart;
-uint32_t status;
+INT8U err;
 
     if( uartn >= uarttabsize ) return -1;
 
-    uart = uarttab[uartn].device;
-
-    status = uart->ISR;
-    if( status & USART_ISR_ORE )  {  // overun error
-        uart->ICR |= USART_ICR_ORECF;
-    }
-
-    while( (uart->ISR & USART_ISR_RXNE) == 0 ) {}
+    OSSemPend(uarttab[uartn].rxsem,0,&err);
+    if( err != OS_ERR_NONE ) return -1;
 
-    return uart->RDR;
+    return uart_getchar(uartn);
 }
 
 /**
@@ -274,23 +435,13 @@ uint32_t status;
  **/
 int
 UART_ReadCharNoWait(int uartn) {
-USART_TypeDef *uart;
-uint32_t status;
 
     if( uartn >= uarttabsize ) return -1;
 
-    uart = uarttab[uartn].device;
-
-    status = uart->ISR;
-    if( status & USART_ISR_ORE )  {  // overun error
-        uart->ICR |= USART_ICR_ORECF;
-    }
-
-    if ( uart->ISR & USART_ISR_RXNE ) {
-        return uart->RDR;
-    } else {
+    if( OSSemAccept(uarttab[uartn].rxsem) == 0 )
         return 0;
-    }
+
+    return uart_getchar(uartn);
 }
 
 
@@ -339,3 +490,16 @@ uint32_t status;
 
 }
 
+/**
+ ** @brief UART Get number of received chars lost
+ **
+ ** @note  Input FIFO full or overrun
+ **/
+uint32_t
+UART_GetDrops(int uartn) {
+
+    if( uartn >= uarttabsize ) return 0;
+
+    return uarttab[uartn].rxdrops;
+}
+
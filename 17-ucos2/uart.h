@@ -9,10 +9,12 @@
  * @note     Direct access to registers
  * @note     No library except CMSIS is used
  * @note     No support for synchronous communication
- * @note     No interrupts (for now)
+ * @note     Interrupt driven with FIFOs. The tasks wait on uC/OS-II semaphores
  *
  ******************************************************************************/
 
+#include "fifo.h"
+
 #ifndef UART_BIT
 #define UART_BIT(N) (1U<<(N))
 #define UART_BITFIELD(V,P)   ((V)<<(P))
@@ -144,6 +146,7 @@
 ///@}
 
 int UART_Init(int uartn, uint32_t config);
+int UART_InitExt(int uartn, uint32_t config, FIFO in, FIFO out);
 int UART_WriteChar(int uartn, uint32_t c);
 int UART_WriteString(int uartn, char s[]);
 
@@ -151,5 +154,6 @@ int UART_ReadChar(int uartn);
 int UART_ReadCharNoWait(int uartn);
 int UART_ReadString(int uartn, char *s, int n);
 int UART_GetStatus(int uartn);
+uint32_t UART_GetDrops(int uartn);
 
 #endif // UART_H
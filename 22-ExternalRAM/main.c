@@ -19,6 +19,7 @@
 #include "stm32f746xx.h"
 #include "system_stm32f746.h"
 #include "sdram.h"
+#include "sdramtest.h"
 #include "led.h"
 
 
@@ -218,6 +219,8 @@ char line[LINEMAX+1];
         puts("5 - Write random pattern using 32-bit access");
         puts("6 - Write random pattern using 32-bit access");
         puts("7 - Reset apontadores");
+        puts("8 - Bandwidth test with current configuration");
+        puts("9 - Bandwidth test with all configurations");
         fputs(">",stdout);
         fgets(line,100,stdin);
         int test = atoi(line);
@@ -310,6 +313,14 @@ char line[LINEMAX+1];
             p = (uint16_t *) 0xC0000000;
             lw = 0x12345678;
             lp = (uint32_t *) 0xC0000000;
+            break;
+        case 8:
+            SDRAMTest_Run();
+            break;
+        case 9:
+            k = SDRAMTest_RunAll();
+            printf("Total errors = %d\n",k);
+            break;
         }
     }
 }
@@ -75,19 +75,14 @@
  *  |SDRAM_RBURST    | Burst read  (0: no, 1: always) |    1    |     1   |
  *  |SDRAM_SDCLK     | SDRAM Clock (0:no, 2: /2, 3: /3|    2    |     2   |
  *  |SDRAM_WP        | Write protection (0:no, 1:yes) |    0    |     0   |
- *  |SDRAM_CAS       | CAS Latency (1,2,3 cycles)     |    2    |     3   |
+ *  |SDRAM_CAS       | CAS Latency (1,2,3 cycles)     |    3    |     3   |
  *  |SDRAM_NB        | Number of banks (0:2, 1:4)     |    1    |     1   |
  *  |SDRAM_MWID      | Data bus (0:8, 1:16, 2:32)     |    1    |     1   |
  *  |SDRAM_NR        | Row address (0:11, 1:12, 2, 13)|    1    |     1   |
  *  |SDRAM_NC        | Column address (x+8)           |    0    |     0   |
- *  |SDRAM_TRCD      | Row to column delay (x+1)      |    2    |     2   |
- *  |SDRAM_TRP       | Row precharge delay (x+1)      |    2    |     2   |
- *  |SDRAM_TWR       | Write Recovery delay  (x+1)    |    2    |     3   |
- *  |SDRAM_TRC       | Row cycle delay (x+1)          |    7    |     7   |
- *  |SDRAM_TRAS      | Self refresh time (x+1)        |    4    |     4   |
- *  |SDRAM_TXSR      | Exit self refresh delay (x+1)  |    7    |     7   |
- *  |SDRAM_TMRD      | Load mode to active (x+1)      |    2    |     2   |
  *
+ * @note  RPIPE, RBURST, SDCLK and CAS are the defaults. They can be changed at run
+ *        time with SDRAM_Configure
  *
  * @note  There are some differences between STM32F746G Discovery Demo
  *        and the code in BSP/stm32g_discovery_sdram.c
@@ -108,17 +103,44 @@
 #define SDRAM_NR                1
 #define SDRAM_NC                0
 
-// Configuration of SDTRx
-#define SDRAM_TRCD              2
-#define SDRAM_TRP               2
-#define SDRAM_TWR               3
-#define SDRAM_TRC               7
-#define SDRAM_TRAS              4
-#define SDRAM_TXSR              7
-#define SDRAM_TMRD              2
+/**
+ * @brief Timing of the MT48LC4M32B2B5-6A (in ns or cycles)
+ *
+ *  | Parameter      | Description                    | Value   |
+ *  |----------------|--------------------------------|---------|
+ *  |SDRAM_TRCD_NS   | Row to column delay            |  18 ns  |
+ *  |SDRAM_TRP_NS    | Row precharge delay            |  18 ns  |
+ *  |SDRAM_TWR_NS    | Write Recovery delay           |  12 ns  |
+ *  |SDRAM_TRC_NS    | Row cycle delay                |  60 ns  |
+ *  |SDRAM_TRAS_NS   | Self refresh time              |  42 ns  |
+ *  |SDRAM_TXSR_NS   | Exit self refresh delay        |  67 ns  |
+ *  |SDRAM_TMRD_CLK  | Load mode to active            |  2 clk  |
+ *
+ * @note  The fields of SDTRx are computed by CalcTiming from SDRAM_CLOCKFREQUENCY
+ *        and the SDCLK divisor. For 100 MHz (HCLK/2) they are
+ *        TRCD=1, TRP=1, TWR=2, TRC=5, TRAS=4, TXSR=6, TMRD=1 (register values)
+ */
+///@{
+#define SDRAM_TRCD_NS           18
+#define SDRAM_TRP_NS            18
+#define SDRAM_TWR_NS            12
+#define SDRAM_TRC_NS            60
+#define SDRAM_TRAS_NS           42
+#define SDRAM_TXSR_NS           67
+#define SDRAM_TMRD_CLK          2
+///@}
 
+/**
+ *  @brief  Minimal write recovery delay in cycles
+ *
+ *  @note   MT48LC4M32B2 needs 1 clock + 6 ns. Two cycles cover it up to 166 MHz
+ */
+#define SDRAM_TWR_MINCLK        2
 
-#define SDRAM_REFRESHCOUNT      1539
+/**
+ *  @brief  Maximal SDRAM clock frequency supported by FMC
+ */
+#define SDRAM_MAXFREQUENCY      100000000
 
 /**
  *  @brief  FMC Command Mode
@@ -146,22 +168,23 @@
  *  @note   All rows must be refreshed every 64 ms. This can be done distributed
  *          along this time or as a burst with an interval of 60 ns.
  *
- *  @note   Refresh count depends on the SD_CLK signal
+ *  @note   Refresh count depends on the SD_CLK signal. It is computed by CalcTiming
  *
  *          64 ms/4096 rows = 15.625 us
  *          15.625 us *100 MHz = 1562
  *          Subtract a safety margin (20)
  *          Counter = 1542
- *          Refresh rate = (1582+1)*100 MHz
  *
- *          OBS: 20 or 20% ??
-
  *  @note   It must be different from TWR+TRP+TRC+TRCD+4 memory cycles
  *
  *  @note   It must be greater than 40
  *
  */
-#define SDRAM_REFRESH                       1542
+///@{
+#define SDRAM_REFRESHPERIOD_MS              64
+#define SDRAM_ROWS                          4096
+#define SDRAM_REFRESHMARGIN                 20
+///@}
 
 /**
  *  @brief  Default timeout
@@ -178,17 +201,39 @@
  * | Reserved         | 13-10|  000  | Must be 000                |
  * | Write Burst Mode |  9-9 |    1  | Single Location Access     |
  * | Operation mode   |  8-7 |   00  | Standard Operation)        |
- * | CAS Latency      |  6-4 |  010  |  2                         |
+ * | CAS Latency      |  6-4 |  0xx  |  2 or 3                    |
  * | Burst type       |  3-3 |    0  | Sequential                 |
  * | Burst length     |  2-0 |  000  |  1                         |
  *
  *      11 1100 0000 0000
  *      32 1098 7654 3210
  *      --------------
- *      00 0010 0010 0000 = 0x220
+ *      00 0010 0011 0000 = 0x230 (CAS=3)
+ *
+ * @note  The CAS latency must be the same programmed in the FMC
+ *
+ * @note  The burst length of the device is 1. The FMC read burst (RBURST) does
+ *        not use it. It queues the reads inside a row and uses the pipe.
+ */
+
+#define SDRAM_MODE(CAS)     (0x200|((CAS)<<4))
+
+/**
+ *  @brief  Default configuration
+ *
+ *  @note   The same used before the configuration could be changed
  */
+const SDRAM_Config_t SDRAM_DefaultConfig = {
+    .sdclk      = SDRAM_SDCLK,
+    .rburst     = SDRAM_RBURST,
+    .rpipe      = SDRAM_RPIPE,
+    .cas        = SDRAM_CAS
+};
 
-#define SDRAM_MODE   0x230
+/**
+ *  @brief  Configuration in use
+ */
+static SDRAM_Config_t currentconfig;
 
 
 /*******************^^^^^^ To be rewamped ^^^^^^ *************************************************/
@@ -872,30 +917,107 @@ EnableFMCClock(void) {
 
 
 /**
- * @brief   SmallDelay
+ * @brief   DelayMicroseconds
  *
- * @note    Quick and dirty small delay routine
+ * @note    Busy wait using the DWT cycle counter. It does not depends on the
+ *          code generated by the compiler as a counting loop does
  */
 static void
-SmallDelay(volatile uint32_t v) {
+DelayMicroseconds(uint32_t us) {
+uint32_t start;
+uint32_t cycles;
+
+    if( (DWT->CTRL&DWT_CTRL_CYCCNTENA_Msk) == 0 ) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->LAR = 0xC5ACCE55;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+    cycles = (SystemCoreClock/1000000)*us;
+    start = DWT->CYCCNT;
+    while( (DWT->CYCCNT-start) < cycles ) {}
+}
+
+/**
+ *  @brief  Convert a time in ns to a register field
+ *
+ *  @note   Fields of SDTRx are number of cycles minus 1 (x+1) and have 4 bits
+ *
+ *  @note   Rounded up. Always at least 1 cycle
+ */
+static uint32_t
+NsToField(uint32_t ns, uint32_t freq) {
+uint32_t cycles;
+
+    // freq in MHz (rounded up) times ns/1000 without overflow
+    cycles = (((freq+999999)/1000000)*ns+999)/1000;
+    if( cycles < 1 )
+        cycles = 1;
+    if( cycles > 16 )
+        cycles = 16;
+    return cycles-1;
+}
+
+/**
+ *  @brief  CalcTiming
+ *
+ *  @note   Computes the fields of SDTRx and the refresh count for a SDCLK divisor
+ *
+ *  @note   SDRAM clock is SDRAM_CLOCKFREQUENCY divided by sdclk (2 or 3)
+ *
+ *  @note   FMC requires TWR >= TRAS-TRCD and TWR >= TRC-TRCD-TRP (in cycles)
+ *
+ *  @note   Returns -1 when the resulting frequency is above SDRAM_MAXFREQUENCY
+ */
+int
+SDRAM_CalcTiming(const SDRAM_Config_t *config, SDRAM_Timing_t *timing) {
+uint32_t freq;
+uint32_t twr;
+
+    if( (config->sdclk != 2) && (config->sdclk != 3) )
+        return -1;
+    freq = SDRAM_CLOCKFREQUENCY/config->sdclk;
+    if( freq > SDRAM_MAXFREQUENCY )
+        return -1;
 
-    while(v--) {}
+    timing->frequency = freq;
+    timing->trcd = NsToField(SDRAM_TRCD_NS,freq);
+    timing->trp  = NsToField(SDRAM_TRP_NS,freq);
+    timing->trc  = NsToField(SDRAM_TRC_NS,freq);
+    timing->tras = NsToField(SDRAM_TRAS_NS,freq);
+    timing->txsr = NsToField(SDRAM_TXSR_NS,freq);
+    timing->tmrd = SDRAM_TMRD_CLK-1;
+
+    // Fields are cycles-1, so every +1 in the expressions below cancels out
+    twr = NsToField(SDRAM_TWR_NS,freq);
+    if( twr < SDRAM_TWR_MINCLK-1 )
+        twr = SDRAM_TWR_MINCLK-1;
+    if( timing->tras > timing->trcd && twr < timing->tras-timing->trcd-1 )
+        twr = timing->tras-timing->trcd-1;
+    if( timing->trc > timing->trcd+timing->trp+1
+        && twr < timing->trc-timing->trcd-timing->trp-2 )
+        twr = timing->trc-timing->trcd-timing->trp-2;
+    timing->twr = twr;
+
+    timing->refresh = freq/1000*SDRAM_REFRESHPERIOD_MS/SDRAM_ROWS-SDRAM_REFRESHMARGIN;
+
+    return 0;
 }
 
 /**
  *  @brief  ConfigureFMC for SDRAM
  *
- *  @note   All parameters for f_SDCLOCK = 100 MHz
+ *  @note   Timing is computed from SDRAM_CLOCKFREQUENCY and the SDCLK divisor
  *
  *  @note   The SDRAM is in SDRAM Bank 1 (FMC Bank 5)
  *
- *  @note   FMC is configured to run at half the speed of the core.
+ *  @note   RPIPE, RBURST and SDCLK only exist in SDCR1 and TWR in SDTR1. They are
+ *          shared by both banks.
  *
  *  @note   Autorefresh = 1 always?
  */
 
 static void
-ConfigureFMCSDRAM(int bank) {
+ConfigureFMCSDRAM(int bank, const SDRAM_Config_t *config, const SDRAM_Timing_t *timing) {
 uint32_t sdcr1,sdcr2;
 uint32_t sdtr1,sdtr2;
 
@@ -909,35 +1031,36 @@ uint32_t sdtr1,sdtr2;
                     |FMC_SDCR1_SDCLK_Msk
                     |FMC_SDCR1_WP_Msk
                     |FMC_SDCR1_CAS_Msk
+                    |FMC_SDCR1_NB_Msk
                     |FMC_SDCR1_MWID_Msk
                     |FMC_SDCR1_NR_Msk
                     |FMC_SDCR1_NC_Msk);
         /* Set fields in SDCR1 */
-        sdcr1 |=     (SDRAM_RPIPE<<FMC_SDCR1_RPIPE_Pos)
-                    |(SDRAM_RBURST<<FMC_SDCR1_RBURST_Pos)
-                    |(SDRAM_SDCLK<<FMC_SDCR1_SDCLK_Pos)
+        sdcr1 |=     (config->rpipe<<FMC_SDCR1_RPIPE_Pos)
+                    |(config->rburst<<FMC_SDCR1_RBURST_Pos)
+                    |(config->sdclk<<FMC_SDCR1_SDCLK_Pos)
                     |(SDRAM_WP<<FMC_SDCR1_WP_Pos)
-                    |(SDRAM_CAS<<FMC_SDCR1_CAS_Pos)
+                    |(config->cas<<FMC_SDCR1_CAS_Pos)
                     |(SDRAM_NB<<FMC_SDCR1_NB_Pos)
                     |(SDRAM_MWID<<FMC_SDCR1_MWID_Pos)
                     |(SDRAM_NR<<FMC_SDCR1_NR_Pos)
                     |(SDRAM_NC<<FMC_SDCR1_NC_Pos);
         /* Clear fields in SDTR1 */
-        sdtr1  &=   ~(FMC_SDTR1_TRCD_Msk)
-                    |(FMC_SDTR1_TRP_Msk)
-                    |(FMC_SDTR1_TWR_Msk)
-                    |(FMC_SDTR1_TRC_Msk)
-                    |(FMC_SDTR1_TRAS_Msk)
-                    |(FMC_SDTR1_TXSR_Msk)
-                    |(FMC_SDTR1_TMRD_Msk);
+        sdtr1  &=   ~(FMC_SDTR1_TRCD_Msk
+                    |FMC_SDTR1_TRP_Msk
+                    |FMC_SDTR1_TWR_Msk
+                    |FMC_SDTR1_TRC_Msk
+                    |FMC_SDTR1_TRAS_Msk
+                    |FMC_SDTR1_TXSR_Msk
+                    |FMC_SDTR1_TMRD_Msk);
         /* Set fields in SDTR1 */
-        sdtr1  |=    (SDRAM_TRCD<<FMC_SDTR1_TRCD_Pos)
-                    |(SDRAM_TRP<<FMC_SDTR1_TRP_Pos)
-                    |(SDRAM_TWR<<FMC_SDTR1_TWR_Pos)
-                    |(SDRAM_TRC<<FMC_SDTR1_TRC_Pos)
-                    |(SDRAM_TRAS<<FMC_SDTR1_TRAS_Pos)
-                    |(SDRAM_TXSR<<FMC_SDTR1_TXSR_Pos)
-                    |(SDRAM_TMRD<<FMC_SDTR1_TMRD_Pos);
+        sdtr1  |=    (timing->trcd<<FMC_SDTR1_TRCD_Pos)
+                    |(timing->trp<<FMC_SDTR1_TRP_Pos)
+                    |(timing->twr<<FMC_SDTR1_TWR_Pos)
+                    |(timing->trc<<FMC_SDTR1_TRC_Pos)
+                    |(timing->tras<<FMC_SDTR1_TRAS_Pos)
+                    |(timing->txsr<<FMC_SDTR1_TXSR_Pos)
+                    |(timing->tmrd<<FMC_SDTR1_TMRD_Pos);
 
         FMC_Bank5_6->SDCR[0] = sdcr1;
         FMC_Bank5_6->SDTR[0] = sdtr1;
@@ -951,18 +1074,19 @@ uint32_t sdtr1,sdtr2;
                     |FMC_SDCR1_RBURST_Msk
                     |FMC_SDCR1_SDCLK_Msk);
         /* Set fields in SDCR1 */
-        sdcr1 |=    (SDRAM_RPIPE<<FMC_SDCR1_RPIPE_Pos)
-                    |(SDRAM_RBURST<<FMC_SDCR1_RBURST_Pos)
-                    |(SDRAM_SDCLK<<FMC_SDCR1_SDCLK_Pos);
+        sdcr1 |=    (config->rpipe<<FMC_SDCR1_RPIPE_Pos)
+                    |(config->rburst<<FMC_SDCR1_RBURST_Pos)
+                    |(config->sdclk<<FMC_SDCR1_SDCLK_Pos);
         /* Clear fields in SDCR2 */
         sdcr2 &=   ~(FMC_SDCR1_WP_Msk
                     |FMC_SDCR1_CAS_Msk
+                    |FMC_SDCR1_NB_Msk
                     |FMC_SDCR1_MWID_Msk
                     |FMC_SDCR1_NR_Msk
                     |FMC_SDCR1_NC_Msk);
         /* Set fields in SDCR2 */
         sdcr2 |=     (SDRAM_WP<<FMC_SDCR1_WP_Pos)
-                    |(SDRAM_CAS<<FMC_SDCR1_CAS_Pos)
+                    |(config->cas<<FMC_SDCR1_CAS_Pos)
                     |(SDRAM_NB<<FMC_SDCR1_NB_Pos)
                     |(SDRAM_MWID<<FMC_SDCR1_MWID_Pos)
                     |(SDRAM_NR<<FMC_SDCR1_NR_Pos)
@@ -970,21 +1094,14 @@ uint32_t sdtr1,sdtr2;
         /* Clear fields that only can be written in SDTR1 */
         sdtr1 &=   ~(FMC_SDTR1_TWR_Msk);
         /* Set fields that only can be writter in SDTR1 */
-        sdtr1 |=    (SDRAM_TWR<<FMC_SDTR1_TWR_Pos);
-        /* Clear fields in SDTR2 */
-        sdtr2  &    ~(FMC_SDTR1_TRCD_Msk)
-                    |(FMC_SDTR1_TRP_Msk)
-                    |(FMC_SDTR1_TRC_Msk)
-                    |(FMC_SDTR1_TRAS_Msk)
-                    |(FMC_SDTR1_TXSR_Msk)
-                    |(FMC_SDTR1_TMRD_Msk);
+        sdtr1 |=    (timing->twr<<FMC_SDTR1_TWR_Pos);
         /* Set fields in SDTR2 */
-        sdtr2  =     (SDRAM_TRCD<<FMC_SDTR1_TRCD_Pos)
-                    |(SDRAM_TRP<<FMC_SDTR1_TRP_Pos)
-                    |(SDRAM_TRC<<FMC_SDTR1_TRC_Pos)
-                    |(SDRAM_TRAS<<FMC_SDTR1_TRAS_Pos)
-                    |(SDRAM_TXSR<<FMC_SDTR1_TXSR_Pos)
-                    |(SDRAM_TMRD<<FMC_SDTR1_TMRD_Pos);
+        sdtr2  =     (timing->trcd<<FMC_SDTR1_TRCD_Pos)
+                    |(timing->trp<<FMC_SDTR1_TRP_Pos)
+                    |(timing->trc<<FMC_SDTR1_TRC_Pos)
+                    |(timing->tras<<FMC_SDTR1_TRAS_Pos)
+                    |(timing->txsr<<FMC_SDTR1_TXSR_Pos)
+                    |(timing->tmrd<<FMC_SDTR1_TMRD_Pos);
 
         FMC_Bank5_6->SDCR[0] = sdcr1;
         FMC_Bank5_6->SDCR[1] = sdcr2;
@@ -999,11 +1116,11 @@ uint32_t sdtr1,sdtr2;
  *
  */
 static void
-ConfigureSDRAMRefresh(int bank) {
+ConfigureSDRAMRefresh(int bank, const SDRAM_Timing_t *timing) {
 
     /* Set refresh count */
     FMC_Bank5_6->SDRTR = (FMC_Bank5_6->SDRTR&~(FMC_SDRTR_COUNT_Msk))
-                |(SDRAM_REFRESH<<FMC_SDRTR_COUNT_Pos);
+                |(timing->refresh<<FMC_SDRTR_COUNT_Pos);
 
     /* Disable write protection */
     FMC_Bank5_6->SDCR[bank] &= ~(FMC_SDCR1_WP);
@@ -1077,45 +1194,107 @@ int timeout = 0x7FFF;
     while( (FMC_Bank5_6->SDSR&FMC_SDSR_BUSY) &&(timeout-->0) ) {}
 
     if( FMC_Bank5_6->SDSR&FMC_SDSR_BUSY )
-        return 0;
-    else
         return -1;
+    else
+        return 0;
 }
 
 
 /**
- *  @brief  ConfigureFMC for SDRAM
- *
- *  @note   All parameters for f_SDCLOCK = 100 MHz
- *
- *  @note   The FCM SDRAM interface must be configured to run at half the speed
- *          of the core.
+ *  @brief  ConfigureSDRAMDevice
  *
  *  @note   Send SDRAM initialization sequence
  *
+ *  @note   The CAS latency in the mode register must match the one in the FMC
+ *
  */
 
 static void
-ConfigureSDRAMDevice(int bank) {
+ConfigureSDRAMDevice(int bank, const SDRAM_Config_t *config) {
 
     /* Clock enable command */
     SendCommand(bank,SDRAM_MODE_CLOCKCONFIGENABLE,0x0000);
 
-    SmallDelay(1000);       // 100 us, maybe systick is better */
+    /* At least 100 us with clock stable before any other command */
+    DelayMicroseconds(100);
 
     /* PALL command */
     SendCommand(bank,SDRAM_MODE_PALL,0x0000);
 
     /* Auto refresh command */
-    SendCommand(bank,SDRAM_MODE_AUTOREFRESH,8);
+    SendCommand(bank,SDRAM_MODE_AUTOREFRESH,SDRAM_AUTOREFRESH);
 
     /* MRD register program */
-    SendCommand(bank,SDRAM_MODE_LOADMODE,SDRAM_MODE);
+    SendCommand(bank,SDRAM_MODE_LOADMODE,SDRAM_MODE(config->cas));
 
 }
 
 
+/**
+ * @brief   SDRAM Configure
+ *
+ * @note    Configures FMC and SDRAM device of bank using config
+ *
+ * @note    It can be called again to change the configuration. The SDRAM clock
+ *          is stopped and the device initialization sequence is sent.
+ *          Contents of SDRAM are lost.
+ *
+ * @note    HCLK must be SDRAM_CLOCKFREQUENCY
+ *
+ * @note    Returns 0 when OK, -1 when config is invalid
+ */
+int
+SDRAM_ConfigureEx(int bank, const SDRAM_Config_t *config) {
+SDRAM_Timing_t timing;
 
+    if( SystemCoreClock != SDRAM_CLOCKFREQUENCY )
+        return -1;
+
+    if( (config->rpipe < 0) || (config->rpipe > 2) )
+        return -1;
+    if( (config->cas < 2) || (config->cas > 3) )
+        return -1;
+    if( SDRAM_CalcTiming(config,&timing) < 0 )
+        return -1;
+
+    /* Stop SDRAM clock. SDCLK can only be changed when it is disabled */
+    FMC_Bank5_6->SDCR[0] &= ~FMC_SDCR1_SDCLK_Msk;
+
+    /* Configure FMC interface for SDRAM */
+    ConfigureFMCSDRAM(bank,config,&timing);
+
+    /* Configure SDRAM chip */
+    ConfigureSDRAMDevice(bank,config);
+
+    /* Configure Refresh */
+    ConfigureSDRAMRefresh(bank,&timing);
+
+    currentconfig = *config;
+
+    return 0;
+}
+
+/**
+ * @brief   SDRAM Configure
+ *
+ * @note    Changes configuration of SDRAM Bank 1
+ */
+int
+SDRAM_Configure(const SDRAM_Config_t *config) {
+
+    return SDRAM_ConfigureEx(SDRAM_BANK1,config);
+}
+
+/**
+ * @brief   SDRAM GetConfig
+ *
+ * @note    Returns the configuration in use
+ */
+const SDRAM_Config_t *
+SDRAM_GetConfig(void) {
+
+    return &currentconfig;
+}
 
 
 /**
@@ -1140,16 +1319,8 @@ SDRAM_InitEx(int bank) {
     /* Configure FMC pins for SDRAM interface*/
     ConfigureFMCSDRAMPins(bank);
 
-    /* Configure FMC interface for SDRAM */
-    ConfigureFMCSDRAM(bank);
-
-    /* Configure SDRAM chip */
-    ConfigureSDRAMDevice(bank);
-
-    /* Configure Refresh */
-    ConfigureSDRAMRefresh(bank);
-
-    return 0;
+    /* Configure FMC, SDRAM chip and refresh */
+    return SDRAM_ConfigureEx(bank,&SDRAM_DefaultConfig);
 }
 
 
@@ -1168,4 +1339,3 @@ SDRAM_Init(void) {
     return SDRAM_InitEx(SDRAM_BANK1);
 
 }
-
@@ -7,12 +7,51 @@
  * @author  Hans
  */
 
+#include <stdint.h>
+
 int SDRAM_Init();
 
+/**
+ *  @brief  Configuration of FMC SDRAM interface
+ *
+ *  @note   Timing (TRCD, TRP, TWR, ...) is computed from SDRAM_CLOCKFREQUENCY/sdclk
+ */
+typedef struct {
+    int     sdclk;                      ///< SDRAM clock = HCLK/sdclk (2 or 3)
+    int     rburst;                     ///< 1: FMC read burst enabled
+    int     rpipe;                      ///< read pipe delay in HCLK cycles (0, 1 or 2)
+    int     cas;                        ///< CAS latency in SDRAM cycles (2 or 3)
+} SDRAM_Config_t;
+
+/**
+ *  @brief  Timing computed for a configuration
+ *
+ *  @note   Fields are register values (cycles-1), as in SDTRx
+ */
+typedef struct {
+    uint32_t    frequency;              ///< SDRAM clock frequency in Hz
+    uint32_t    trcd;                   ///< row to column delay
+    uint32_t    trp;                    ///< row precharge delay
+    uint32_t    twr;                    ///< write recovery delay
+    uint32_t    trc;                    ///< row cycle delay
+    uint32_t    tras;                   ///< self refresh time
+    uint32_t    txsr;                   ///< exit self refresh delay
+    uint32_t    tmrd;                   ///< load mode register to active
+    uint32_t    refresh;                ///< refresh timer count (SDRTR)
+} SDRAM_Timing_t;
+
+extern const SDRAM_Config_t SDRAM_DefaultConfig;
+
+int SDRAM_InitEx(int bank);
+int SDRAM_Configure(const SDRAM_Config_t *config);
+int SDRAM_ConfigureEx(int bank, const SDRAM_Config_t *config);
+int SDRAM_CalcTiming(const SDRAM_Config_t *config, SDRAM_Timing_t *timing);
+const SDRAM_Config_t *SDRAM_GetConfig(void);
+
 /**
  *  @brief  SystemCoreClock for correct working of the SDRAM
  *
- *  @note   It is divided by 2. So the SDRAM runs at 100 MHz
+ *  @note   It is divided by 2 (default) or 3. So the SDRAM runs at 100 or 66 MHz
  *
  *  @note   Other frequencies are possible but the FMC and SDRAM must be reconfigured
  */
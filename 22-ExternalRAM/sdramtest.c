@@ -0,0 +1,294 @@
+/**
+ * @file    sdramtest.c
+ *
+ * @note    Measures SDRAM bandwidth for sequential and random accesses using
+ *          byte, word and burst (8 words, LDM/STM) transfers
+ *
+ * @note    Time is measured with the DWT cycle counter. The SDRAM region is not
+ *          cacheable in the default memory map (0xC000_0000 is external device),
+ *          so the numbers are the ones of the FMC, not the ones of the D-cache.
+ *
+ * @note    Output format (one line per test)
+ *
+ *          SDRAM,<config>,<test>,<bytes>,<cycles>,<MB/s>
+ *
+ * @author  Hans
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "sdram.h"
+#include "sdramtest.h"
+
+/**
+ *  @brief  Configurations tested by SDRAMTest_RunAll
+ */
+static const SDRAM_Config_t configtab[] = {
+    /* sdclk  rburst rpipe  cas */
+    {   2,      0,    0,     3  },
+    {   2,      1,    0,     3  },
+    {   2,      1,    1,     3  },
+    {   2,      1,    0,     2  },
+    {   3,      0,    0,     2  },
+    {   3,      1,    0,     2  },
+    {   3,      1,    1,     2  },
+};
+
+#define NCONFIGS (sizeof(configtab)/sizeof(configtab[0]))
+
+/**
+ *  @brief  Sink for values read, so the reads are not optimized away
+ */
+static volatile uint32_t sink;
+
+/**
+ *  @brief  Enable DWT cycle counter
+ */
+static void
+EnableCycleCounter(void) {
+
+    if( (DWT->CTRL&DWT_CTRL_CYCCNTENA_Msk) == 0 ) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->LAR = 0xC5ACCE55;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+}
+
+/**
+ *  @brief  Print a result line
+ *
+ *  @note   MB/s with one decimal digit
+ */
+static void
+Report(const char *test, uint32_t bytes, uint32_t cycles) {
+const SDRAM_Config_t *c = SDRAM_GetConfig();
+uint32_t mbps10;
+
+    if( cycles == 0 ) cycles = 1;
+    mbps10 = (uint32_t) (((uint64_t) bytes*SystemCoreClock*10)/cycles/1000000);
+    printf("SDRAM,HCLK/%d-RB%d-RP%d-CL%d,%s,%u,%u,%u.%u\n",
+            c->sdclk,c->rburst,c->rpipe,c->cas,
+            test,(unsigned) bytes,(unsigned) cycles,
+            (unsigned) (mbps10/10),(unsigned) (mbps10%10));
+}
+
+/**
+ *  @brief  Sequential byte access
+ */
+static void
+TestByte(void) {
+volatile uint8_t *p = (volatile uint8_t *) SDRAMTEST_ADDRESS;
+uint32_t start,cycles;
+uint32_t i;
+uint32_t sum = 0;
+
+    start = DWT->CYCCNT;
+    for(i=0;i<SDRAMTEST_SIZE;i++) {
+        p[i] = (uint8_t) i;
+    }
+    __DSB();
+    cycles = DWT->CYCCNT-start;
+    Report("seq-byte-write",SDRAMTEST_SIZE,cycles);
+
+    start = DWT->CYCCNT;
+    for(i=0;i<SDRAMTEST_SIZE;i++) {
+        sum += p[i];
+    }
+    cycles = DWT->CYCCNT-start;
+    sink = sum;
+    Report("seq-byte-read",SDRAMTEST_SIZE,cycles);
+}
+
+/**
+ *  @brief  Sequential word (32 bit) access
+ */
+static void
+TestWord(void) {
+volatile uint32_t *p = (volatile uint32_t *) SDRAMTEST_ADDRESS;
+uint32_t start,cycles;
+uint32_t i;
+uint32_t sum = 0;
+
+    start = DWT->CYCCNT;
+    for(i=0;i<SDRAMTEST_SIZE/4;i++) {
+        p[i] = i;
+    }
+    __DSB();
+    cycles = DWT->CYCCNT-start;
+    Report("seq-word-write",SDRAMTEST_SIZE,cycles);
+
+    start = DWT->CYCCNT;
+    for(i=0;i<SDRAMTEST_SIZE/4;i++) {
+        sum += p[i];
+    }
+    cycles = DWT->CYCCNT-start;
+    sink = sum;
+    Report("seq-word-read",SDRAMTEST_SIZE,cycles);
+}
+
+/**
+ *  @brief  Sequential burst access (8 words per iteration)
+ *
+ *  @note   Eight loads (stores) in sequence are compiled as a LDM (STM), so the
+ *          AXI bus issues bursts to the FMC
+ */
+static void
+TestBurst(void) {
+uint32_t *p;
+uint32_t *end = (uint32_t *) (SDRAMTEST_ADDRESS+SDRAMTEST_SIZE);
+uint32_t start,cycles;
+uint32_t w0,w1,w2,w3,w4,w5,w6,w7;
+uint32_t sum = 0;
+
+    start = DWT->CYCCNT;
+    for(p=(uint32_t *) SDRAMTEST_ADDRESS;p<end;p+=8) {
+        p[0] = 0; p[1] = 1; p[2] = 2; p[3] = 3;
+        p[4] = 4; p[5] = 5; p[6] = 6; p[7] = 7;
+    }
+    __DSB();
+    cycles = DWT->CYCCNT-start;
+    Report("seq-burst-write",SDRAMTEST_SIZE,cycles);
+
+    start = DWT->CYCCNT;
+    for(p=(uint32_t *) SDRAMTEST_ADDRESS;p<end;p+=8) {
+        w0 = p[0]; w1 = p[1]; w2 = p[2]; w3 = p[3];
+        w4 = p[4]; w5 = p[5]; w6 = p[6]; w7 = p[7];
+        sum += w0+w1+w2+w3+w4+w5+w6+w7;
+    }
+    cycles = DWT->CYCCNT-start;
+    sink = sum;
+    Report("seq-burst-read",SDRAMTEST_SIZE,cycles);
+}
+
+/**
+ *  @brief  Random word access
+ *
+ *  @note   Addresses from a LCG (Numerical Recipes constants). The cost of the
+ *          generator is part of the result, but it is a few cycles
+ */
+static void
+TestRandom(void) {
+volatile uint32_t *p = (volatile uint32_t *) SDRAMTEST_ADDRESS;
+uint32_t start,cycles;
+uint32_t i;
+uint32_t r;
+uint32_t sum = 0;
+const uint32_t mask = SDRAMTEST_SIZE/4-1;
+
+    r = 1;
+    start = DWT->CYCCNT;
+    for(i=0;i<SDRAMTEST_SIZE/4;i++) {
+        r = r*1664525+1013904223;
+        p[(r>>8)&mask] = i;
+    }
+    __DSB();
+    cycles = DWT->CYCCNT-start;
+    Report("rand-word-write",SDRAMTEST_SIZE,cycles);
+
+    r = 1;
+    start = DWT->CYCCNT;
+    for(i=0;i<SDRAMTEST_SIZE/4;i++) {
+        r = r*1664525+1013904223;
+        sum += p[(r>>8)&mask];
+    }
+    cycles = DWT->CYCCNT-start;
+    sink = sum;
+    Report("rand-word-read",SDRAMTEST_SIZE,cycles);
+}
+
+/**
+ *  @brief  Verify the contents
+ *
+ *  @note   A configuration too fast for the device shows up as errors here
+ *
+ *  @note   Returns the number of words with a wrong value
+ */
+static int
+TestVerify(void) {
+volatile uint32_t *p = (volatile uint32_t *) SDRAMTEST_ADDRESS;
+volatile uint16_t *h = (volatile uint16_t *) SDRAMTEST_ADDRESS;
+uint32_t i;
+int errors = 0;
+
+    for(i=0;i<SDRAMTEST_SIZE/4;i++) {
+        p[i] = i^0xA5A55A5A;
+    }
+    __DSB();
+    for(i=0;i<SDRAMTEST_SIZE/4;i++) {
+        if( p[i] != (i^0xA5A55A5A) )
+            errors++;
+    }
+    // Half words, since the data bus has 16 bits
+    for(i=0;i<SDRAMTEST_SIZE/2;i++) {
+        h[i] = (uint16_t) ~i;
+    }
+    __DSB();
+    for(i=0;i<SDRAMTEST_SIZE/2;i++) {
+        if( h[i] != (uint16_t) ~i )
+            errors++;
+    }
+    return errors;
+}
+
+/**
+ * @brief   SDRAMTest_Run
+ *
+ * @note    Runs all tests with the configuration in use
+ *
+ * @note    Returns the number of verification errors
+ */
+int
+SDRAMTest_Run(void) {
+int errors;
+
+    EnableCycleCounter();
+
+    TestByte();
+    TestWord();
+    TestBurst();
+    TestRandom();
+    errors = TestVerify();
+    printf("SDRAM,HCLK/%d-RB%d-RP%d-CL%d,verify,%d errors\n",
+            SDRAM_GetConfig()->sdclk,SDRAM_GetConfig()->rburst,
+            SDRAM_GetConfig()->rpipe,SDRAM_GetConfig()->cas,errors);
+    return errors;
+}
+
+/**
+ * @brief   SDRAMTest_RunAll
+ *
+ * @note    Reconfigures SDRAM with each entry of configtab and runs the tests
+ *
+ * @note    SDRAM contents are lost. The default configuration is restored at the end
+ *
+ * @note    Returns the total number of verification errors
+ */
+int
+SDRAMTest_RunAll(void) {
+SDRAM_Timing_t timing;
+unsigned i;
+int errors = 0;
+
+    for(i=0;i<NCONFIGS;i++) {
+        if( SDRAM_Configure(&configtab[i]) < 0 ) {
+            printf("SDRAM,HCLK/%d-RB%d-RP%d-CL%d,invalid\n",
+                configtab[i].sdclk,configtab[i].rburst,
+                configtab[i].rpipe,configtab[i].cas);
+            continue;
+        }
+        SDRAM_CalcTiming(&configtab[i],&timing);
+        printf("SDRAM,HCLK/%d-RB%d-RP%d-CL%d,timing,%u Hz,TRCD=%u TRP=%u TWR=%u TRC=%u TRAS=%u TXSR=%u REFRESH=%u\n",
+                configtab[i].sdclk,configtab[i].rburst,
+                configtab[i].rpipe,configtab[i].cas,
+                (unsigned) timing.frequency,
+                (unsigned) timing.trcd,(unsigned) timing.trp,(unsigned) timing.twr,
+                (unsigned) timing.trc,(unsigned) timing.tras,(unsigned) timing.txsr,
+                (unsigned) timing.refresh);
+        errors += SDRAMTest_Run();
+    }
+    SDRAM_Configure(&SDRAM_DefaultConfig);
+    return errors;
+}
@@ -0,0 +1,28 @@
+#ifndef SDRAMTEST_H
+#define SDRAMTEST_H
+/**
+ * @file    sdramtest.h
+ *
+ * @note    Bandwidth test for SDRAM. Used to validate FMC configurations
+ *
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ *  @brief  Area used by the test
+ *
+ *  @note   Its contents are destroyed
+ *
+ *  @note   Size must be a power of 2 (random access uses a mask)
+ */
+///@{
+#define SDRAMTEST_ADDRESS       SDRAM_ADDRESS
+#define SDRAMTEST_SIZE          (1024*1024)
+///@}
+
+int SDRAMTest_Run(void);
+int SDRAMTest_RunAll(void);
+
+#endif
@@ -0,0 +1,215 @@
+
+/**
+ *  @file   heap.c
+ *
+ *  @note   Replacement of malloc, free, calloc and realloc of newlib using buddy pools
+ *
+ *  @note   Small allocations (up to HEAP_THRESHOLD bytes) are done in a pool in
+ *          internal SRAM. Larger ones are done in a pool in SDRAM. When one pool is
+ *          full, the other is tried.
+ *
+ *  @note   Before Heap_Init is called (i.e., before the SDRAM is initialized), all
+ *          allocations are done in the internal SRAM pool. So printf can be used before.
+ *
+ *  @note   The reentrant versions (_malloc_r, etc.) are defined too, because they are
+ *          used inside newlib (e.g. for stdio buffers). So the newlib allocator and
+ *          _sbrk are not linked.
+ *
+ *  @note   It is not thread safe, as the rest of this project.
+ *
+ *  @note   Only compiled when HEAP_USE_BUDDY is defined (See Makefile)
+ */
+
+#ifdef HEAP_USE_BUDDY
+
+#include <stddef.h>
+#include <string.h>
+#include <reent.h>
+
+#include "buddy.h"
+#include "heap.h"
+
+/**
+ *  @brief  Area in internal SRAM for small allocations
+ */
+static char sramarea[HEAP_SRAMSIZE] __attribute__((aligned(HEAP_SRAMMINSIZE)));
+
+/**
+ *  @brief  Pools
+ */
+///@{
+static POOL sram  = 0;
+static POOL sdram = 0;
+///@}
+
+/**
+ *  @brief  initsram
+ *
+ *  @note   The SRAM pool is created on first use
+ */
+static inline void
+initsram(void) {
+
+    if( sram == 0 )
+        sram = Buddy_CreatePool(sramarea,HEAP_SRAMSIZE,HEAP_SRAMMINSIZE);
+}
+
+/**
+ *  @brief  insram
+ *
+ *  @note   Returns a non zero value if p is in the internal SRAM pool
+ */
+static inline int
+insram(void *p) {
+
+    return ((char *) p >= sramarea) && ((char *) p < sramarea+HEAP_SRAMSIZE);
+}
+
+/**
+ *  @brief  poolof
+ *
+ *  @note   Returns the pool where p was allocated
+ */
+static inline POOL
+poolof(void *p) {
+
+    return insram(p) ? sram : sdram;
+}
+
+/**
+ *  @brief  Heap_Init
+ *
+ *  @note   Creates the pool in SDRAM. It must be called after SDRAM_Init.
+ *
+ *  @note   The bit vectors are stored at the head of the SDRAM area
+ */
+int
+Heap_Init(char *sdramaddr, long sdramsize) {
+
+    initsram();
+    if( sdram == 0 )
+        sdram = Buddy_CreatePool(sdramaddr,sdramsize,HEAP_SDRAMMINSIZE);
+    return (sram && sdram) ? 0 : -1;
+}
+
+/**
+ *  @brief  Heap_GetSRAMPool
+ */
+POOL
+Heap_GetSRAMPool(void) {
+
+    return sram;
+}
+
+/**
+ *  @brief  Heap_GetSDRAMPool
+ */
+POOL
+Heap_GetSDRAMPool(void) {
+
+    return sdram;
+}
+
+/**
+ *  @brief  malloc
+ */
+void *
+malloc(size_t size) {
+void *p;
+
+    initsram();
+    if( (size > HEAP_THRESHOLD) && sdram ) {
+        p = Buddy_AllocFrom(sdram,size);
+        if( p == 0 )
+            p = Buddy_AllocFrom(sram,size);
+    } else {
+        p = Buddy_AllocFrom(sram,size);
+        if( (p == 0) && sdram )
+            p = Buddy_AllocFrom(sdram,size);
+    }
+    return p;
+}
+
+/**
+ *  @brief  free
+ */
+void
+free(void *p) {
+
+    if( p == 0 )
+        return;
+    Buddy_FreeTo(poolof(p),p);
+}
+
+/**
+ *  @brief  calloc
+ */
+void *
+calloc(size_t n, size_t size) {
+void *p;
+
+    if( (size != 0) && (n > ((size_t) -1)/size) )
+        return 0;
+    p = malloc(n*size);
+    if( p )
+        memset(p,0,n*size);
+    return p;
+}
+
+/**
+ *  @brief  realloc
+ *
+ *  @note   When the new size fits in the block, nothing is done
+ */
+void *
+realloc(void *p, size_t size) {
+void *q;
+long blocksize;
+
+    if( p == 0 )
+        return malloc(size);
+    if( size == 0 ) {
+        free(p);
+        return 0;
+    }
+    blocksize = Buddy_BlockSize(poolof(p),p);
+    if( (long) size <= blocksize )
+        return p;
+    q = malloc(size);
+    if( q == 0 )
+        return 0;
+    memcpy(q,p,blocksize);
+    free(p);
+    return q;
+}
+
+/**
+ *  @brief  Reentrant versions used by newlib
+ */
+///@{
+void *
+_malloc_r(struct _reent *r, size_t size) {
+    (void) r;
+    return malloc(size);
+}
+
+void
+_free_r(struct _reent *r, void *p) {
+    (void) r;
+    free(p);
+}
+
+void *
+_calloc_r(struct _reent *r, size_t n, size_t size) {
+    (void) r;
+    return calloc(n,size);
+}
+
+void *
+_realloc_r(struct _reent *r, void *p, size_t size) {
+    (void) r;
+    return realloc(p,size);
+}
+///@}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef HEAP_H
+#define HEAP_H
+/**
+ *  @file   heap.h
+ *
+ *  @note   Replacement of malloc/free of newlib using buddy pools
+ *
+ *  @note   Only compiled when HEAP_USE_BUDDY is defined (See Makefile)
+ *
+ *  @author Hans
+ *  @date   14/10/2026
+ */
+
+#include "buddy.h"
+
+/**
+ *  @brief  Size of the pool in internal SRAM (power of 2)
+ */
+#ifndef HEAP_SRAMSIZE
+#define HEAP_SRAMSIZE           (16*1024)
+#endif
+
+/**
+ *  @brief  Minimal block in internal SRAM pool
+ */
+#ifndef HEAP_SRAMMINSIZE
+#define HEAP_SRAMMINSIZE        (16)
+#endif
+
+/**
+ *  @brief  Minimal block in SDRAM pool
+ */
+#ifndef HEAP_SDRAMMINSIZE
+#define HEAP_SDRAMMINSIZE       (64)
+#endif
+
+/**
+ *  @brief  Allocations larger than this go to SDRAM
+ */
+#ifndef HEAP_THRESHOLD
+#define HEAP_THRESHOLD          (512)
+#endif
+
+int  Heap_Init(char *sdramaddr, long sdramsize);
+POOL Heap_GetSRAMPool(void);
+POOL Heap_GetSDRAMPool(void);
+
+#endif
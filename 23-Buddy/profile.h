@@ -0,0 +1,83 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+/**
+ * @file    profile.h
+ *
+ * @note    Measurement of execution time using the DWT cycle counter
+ *
+ * @note    Probes are enabled only when PROFILE_ENABLE is defined. Otherwise the
+ *          macros expand to nothing.
+ *
+ * @note    Usage
+ *
+ *          PROFILE_BEGIN(name);
+ *          ... code to be measured ...
+ *          PROFILE_END(name);
+ *
+ *          name must be a valid identifier. Each pair creates a probe, which
+ *          accumulates count, minimum, maximum and total cycles. Profile_Dump
+ *          prints them.
+ *
+ * @note    PROFILE_BEGIN declares a variable, so it must be in the same block as
+ *          PROFILE_END.
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Maximal number of probes
+ */
+#ifndef PROFILE_MAXPROBES
+#define PROFILE_MAXPROBES   16
+#endif
+
+/**
+ * @brief   Probe data
+ */
+typedef struct {
+    const char          *name;              ///< name of probe
+    uint32_t            count;              ///< number of measurements
+    uint32_t            min;                ///< minimal cycle count
+    uint32_t            max;                ///< maximal cycle count
+    uint64_t            total;              ///< sum of cycle counts
+} PROFILE_Probe;
+
+void            Profile_Init(void);
+PROFILE_Probe  *Profile_Register(const char *name);
+void            Profile_Reset(void);
+void            Profile_Dump(void);
+extern uint32_t profileoverhead;
+
+#ifdef PROFILE_ENABLE
+#include "stm32f746xx.h"
+
+/**
+ * @brief   Accumulate a measurement
+ */
+static inline void
+Profile_Update(PROFILE_Probe *p, uint32_t start) {
+uint32_t d;
+
+    d = DWT->CYCCNT-start;
+    if( p == 0 )
+        return;
+    d = (d > profileoverhead) ? d-profileoverhead : 0;
+    if( d < p->min ) p->min = d;
+    if( d > p->max ) p->max = d;
+    p->total += d;
+    p->count++;
+}
+
+#define PROFILE_BEGIN(NAME) \
+        static PROFILE_Probe *profile_probe_##NAME = 0; \
+        if( profile_probe_##NAME == 0 ) \
+            profile_probe_##NAME = Profile_Register(#NAME); \
+        uint32_t profile_start_##NAME = DWT->CYCCNT
+#define PROFILE_END(NAME) \
+        Profile_Update(profile_probe_##NAME,profile_start_##NAME)
+#else
+#define PROFILE_BEGIN(NAME)
+#define PROFILE_END(NAME)
+#endif
+
+#endif // PROFILE_H
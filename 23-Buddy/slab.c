@@ -0,0 +1,363 @@
+
+/**
+ *  @file   slab.c
+ *
+ *  @note   Allocator for fixed size objects layered on top of the buddy allocator
+ *
+ *  @note
+ *    A slab is a block got from a buddy pool. It starts with a header followed by
+ *    equal size objects. The free objects of a slab are linked in a list, whose nodes
+ *    are stored in the objects themselves. So allocation and free run in O(1) time.
+ *
+ *  @note
+ *    The slabs of a cache are in one of two lists: partial (with at least one free
+ *    object) and full. Empty slabs stay at the end of the partial list, so they are
+ *    the last to be used and the first to be released by Slab_Shrink.
+ *
+ *  @note
+ *    The slab of an object is found by clearing the lower bits of its address. So
+ *    the area of the buddy pool must be aligned to the slab size (SDRAM_ADDRESS is).
+ *
+ */
+
+#include <stdint.h>
+#ifdef DEBUG
+#include <stdio.h>
+#endif
+
+#include "buddy.h"
+#include "slab.h"
+
+/**
+ *  @brief  Maximal number of caches
+ */
+#define  MAXCACHES  8
+
+/**
+ *  @brief  Alignment of objects
+ */
+#define  OBJALIGN   (sizeof(void *))
+
+/**
+ *  @brief  Free object. Stored inside the object itself
+ */
+typedef struct freeobj_s {
+    struct freeobj_s    *next;
+} FREEOBJ_t;
+
+/**
+ *  @brief  Header of a slab
+ */
+typedef struct slab_s {
+    struct slab_s       *next;                  /// next slab in list
+    struct slab_s       *prev;                  /// previous slab in list
+    FREEOBJ_t           *freelist;              /// free objects in this slab
+    unsigned            inuse;                  /// number of objects allocated
+} SLAB_t;
+
+/**
+ *  @brief  Cache of objects of the same size
+ */
+typedef struct slabcache_s {
+    POOL                pool;                   /// buddy pool where slabs come from
+    unsigned            objsize;                /// object size (rounded to OBJALIGN)
+    unsigned            slabsize;               /// slab size (power of 2)
+    unsigned            objsperslab;            /// number of objects in a slab
+    unsigned            offset;                 /// offset of first object in slab
+    int                 flags;                  /// SLAB_RELEASEEMPTY
+    SLAB_t              *partial;               /// slabs with free objects
+    SLAB_t              *full;                  /// slabs without free objects
+    unsigned            slabs;                  /// number of slabs
+    unsigned            inuse;                  /// number of allocated objects
+    unsigned            allocs;                 /// counter of allocations
+    unsigned            frees;                  /// counter of frees
+} SLABCACHE_t;
+
+/**
+ *  @brief  Cache area
+ */
+///@{
+static SLABCACHE_t  cachearea[MAXCACHES];
+static int          cachecount = 0;
+///@}
+
+static inline unsigned roundup(unsigned n, unsigned a) { return (n+a-1)&~(a-1); }
+
+/**
+ *  @brief  Insert slab at the begin of a list
+ */
+static void
+list_insert(SLAB_t **list, SLAB_t *s) {
+
+    s->prev = 0;
+    s->next = *list;
+    if( s->next )
+        s->next->prev = s;
+    *list = s;
+}
+
+/**
+ *  @brief  Append slab at the end of a list
+ *
+ *  @note   Lists are short. It is only used for empty slabs
+ */
+static void
+list_append(SLAB_t **list, SLAB_t *s) {
+SLAB_t *p;
+
+    s->next = 0;
+    if( *list == 0 ) {
+        s->prev = 0;
+        *list = s;
+        return;
+    }
+    for(p=*list;p->next;p=p->next) {}
+    p->next = s;
+    s->prev = p;
+}
+
+/**
+ *  @brief  Remove slab from a list
+ */
+static void
+list_remove(SLAB_t **list, SLAB_t *s) {
+
+    if( s->prev )
+        s->prev->next = s->next;
+    else
+        *list = s->next;
+    if( s->next )
+        s->next->prev = s->prev;
+}
+
+/**
+ *  @brief  Get a new slab from buddy pool and build its free list
+ */
+static SLAB_t *
+slab_new(SLABCACHE cache) {
+SLAB_t      *s;
+FREEOBJ_t   *o;
+char        *p;
+unsigned    i;
+
+    s = Buddy_AllocFrom(cache->pool,cache->slabsize);
+    if( s == 0 )
+        return 0;
+
+    // The slab must be aligned to find it from object address
+    if( ((uintptr_t) s)&(cache->slabsize-1) ) {
+        Buddy_FreeTo(cache->pool,s);
+        return 0;
+    }
+
+    s->inuse    = 0;
+    s->freelist = 0;
+    p = (char *) s+cache->offset+(cache->objsperslab-1)*cache->objsize;
+    for(i=0;i<cache->objsperslab;i++) {
+        o = (FREEOBJ_t *) p;
+        o->next = s->freelist;
+        s->freelist = o;
+        p -= cache->objsize;
+    }
+    cache->slabs++;
+    return s;
+}
+
+/**
+ *  @brief  Return a slab to the buddy pool
+ */
+static void
+slab_release(SLABCACHE cache, SLAB_t *s) {
+
+    list_remove(&cache->partial,s);
+    Buddy_FreeTo(cache->pool,s);
+    cache->slabs--;
+}
+
+/**
+ *  @brief  Slab_CreateCache
+ *
+ *  @note   Creates a cache for objects with objsize bytes, using slabs with slabsize
+ *          bytes got from a buddy pool.
+ *
+ *  @note   slabsize must be a power of 2. When zero, the smallest power of 2
+ *          larger than 8 objects is used.
+ *
+ *  @note   Returns 0 when there are no more caches or slabsize is too small
+ */
+SLABCACHE
+Slab_CreateCache(POOL pool, unsigned objsize, unsigned slabsize, int flags) {
+SLABCACHE cache;
+unsigned  offset;
+
+    if( (cachecount >= MAXCACHES) || (pool == 0) )
+        return 0;
+
+    if( objsize < sizeof(FREEOBJ_t) )
+        objsize = sizeof(FREEOBJ_t);
+    objsize = roundup(objsize,OBJALIGN);
+    offset  = roundup(sizeof(SLAB_t),OBJALIGN);
+
+    if( slabsize == 0 ) {
+        slabsize = 1;
+        while( slabsize < offset+8*objsize )
+            slabsize <<= 1;
+    }
+
+    if( (slabsize&(slabsize-1)) != 0 )
+        return 0;
+
+    if( slabsize < offset+objsize )
+        return 0;
+
+    cache = &cachearea[cachecount++];
+    cache->pool         = pool;
+    cache->objsize      = objsize;
+    cache->slabsize     = slabsize;
+    cache->offset       = offset;
+    cache->objsperslab  = (slabsize-offset)/objsize;
+    cache->flags        = flags;
+    cache->partial      = 0;
+    cache->full         = 0;
+    cache->slabs        = 0;
+    cache->inuse        = 0;
+    cache->allocs       = 0;
+    cache->frees        = 0;
+
+    return cache;
+}
+
+/**
+ *  @brief  Slab_Alloc
+ *
+ *  @note   Returns 0 when the buddy pool can not give a new slab
+ */
+void *
+Slab_Alloc(SLABCACHE cache) {
+SLAB_t      *s;
+FREEOBJ_t   *o;
+
+    s = cache->partial;
+    if( s == 0 ) {
+        s = slab_new(cache);
+        if( s == 0 )
+            return 0;
+        list_insert(&cache->partial,s);
+    }
+
+    o = s->freelist;
+    s->freelist = o->next;
+    s->inuse++;
+    if( s->freelist == 0 ) {
+        list_remove(&cache->partial,s);
+        list_insert(&cache->full,s);
+    }
+    cache->inuse++;
+    cache->allocs++;
+    return (void *) o;
+}
+
+/**
+ *  @brief  Slab_Free
+ *
+ *  @note   Empty slabs are released when the cache was created with SLAB_RELEASEEMPTY.
+ *          Otherwise, they are moved to the end of partial list
+ */
+void
+Slab_Free(SLABCACHE cache, void *obj) {
+SLAB_t      *s;
+FREEOBJ_t   *o = (FREEOBJ_t *) obj;
+
+    if( obj == 0 )
+        return;
+
+    s = (SLAB_t *) (((uintptr_t) obj)&~((uintptr_t) cache->slabsize-1));
+
+    if( s->freelist == 0 ) {
+        list_remove(&cache->full,s);
+        list_insert(&cache->partial,s);
+    }
+    o->next = s->freelist;
+    s->freelist = o;
+    s->inuse--;
+    cache->inuse--;
+    cache->frees++;
+
+    if( s->inuse == 0 ) {
+        if( cache->flags&SLAB_RELEASEEMPTY ) {
+            slab_release(cache,s);
+        } else if( s->next ) {
+            list_remove(&cache->partial,s);
+            list_append(&cache->partial,s);
+        }
+    }
+}
+
+/**
+ *  @brief  Slab_Shrink
+ *
+ *  @note   Returns all empty slabs to the buddy pool
+ *
+ *  @note   Returns the number of slabs released
+ */
+int
+Slab_Shrink(SLABCACHE cache) {
+SLAB_t  *s;
+SLAB_t  *next;
+int     n = 0;
+
+    for(s=cache->partial;s;s=next) {
+        next = s->next;
+        if( s->inuse == 0 ) {
+            slab_release(cache,s);
+            n++;
+        }
+    }
+    return n;
+}
+
+/**
+ *  @brief  Slab_GetStats
+ */
+void
+Slab_GetStats(SLABCACHE cache, SLAB_Stats *stats) {
+SLAB_t  *s;
+
+    stats->objsize      = cache->objsize;
+    stats->objsperslab  = cache->objsperslab;
+    stats->slabs        = cache->slabs;
+    stats->inuse        = cache->inuse;
+    stats->free         = cache->slabs*cache->objsperslab-cache->inuse;
+    stats->allocs       = cache->allocs;
+    stats->frees        = cache->frees;
+    stats->emptyslabs   = 0;
+    stats->fullslabs    = 0;
+    for(s=cache->partial;s;s=s->next) {
+        if( s->inuse == 0 )
+            stats->emptyslabs++;
+    }
+    for(s=cache->full;s;s=s->next) {
+        stats->fullslabs++;
+    }
+}
+
+#ifdef DEBUG
+/**
+ *  @brief  Slab_Print
+ *
+ *  @note   Prints the occupancy of every slab
+ */
+void
+Slab_Print(SLABCACHE cache) {
+SLAB_t  *s;
+
+    printf("Cache objsize=%u slabsize=%u objs/slab=%u slabs=%u inuse=%u\n",
+            cache->objsize,cache->slabsize,cache->objsperslab,cache->slabs,cache->inuse);
+    for(s=cache->full;s;s=s->next) {
+        printf("  slab %p %u/%u (full)\n",(void *) s,s->inuse,cache->objsperslab);
+    }
+    for(s=cache->partial;s;s=s->next) {
+        printf("  slab %p %u/%u\n",(void *) s,s->inuse,cache->objsperslab);
+    }
+}
+#endif
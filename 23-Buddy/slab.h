@@ -0,0 +1,50 @@
+#ifndef SLAB_H
+#define SLAB_H
+/**
+ *  @file   slab.h
+ *
+ *  @note   Fixed size object allocator using slabs got from a buddy pool
+ *
+ *  @author Hans
+ *  @date   14/10/2026
+ */
+
+#include "buddy.h"
+
+/**
+ *  @brief  Handle for a slab cache
+ */
+typedef struct slabcache_s *SLABCACHE;
+
+/**
+ *  @brief  Flags for Slab_CreateCache
+ */
+///@{
+#define SLAB_RELEASEEMPTY           (1)     ///< Return empty slabs to buddy pool at once
+///@}
+
+/**
+ *  @brief  Statistics of a cache
+ */
+typedef struct {
+    unsigned    objsize;                    ///< size of objects (rounded)
+    unsigned    objsperslab;                ///< number of objects in each slab
+    unsigned    slabs;                      ///< number of slabs got from buddy pool
+    unsigned    emptyslabs;                 ///< number of slabs without allocated objects
+    unsigned    fullslabs;                  ///< number of slabs without free objects
+    unsigned    inuse;                      ///< number of objects allocated
+    unsigned    free;                       ///< number of objects free in the slabs
+    unsigned    allocs;                     ///< number of calls to Slab_Alloc that succeeded
+    unsigned    frees;                      ///< number of calls to Slab_Free
+} SLAB_Stats;
+
+SLABCACHE Slab_CreateCache(POOL pool, unsigned objsize, unsigned slabsize, int flags);
+void     *Slab_Alloc(SLABCACHE cache);
+void      Slab_Free(SLABCACHE cache, void *obj);
+int       Slab_Shrink(SLABCACHE cache);
+void      Slab_GetStats(SLABCACHE cache, SLAB_Stats *stats);
+
+#ifdef DEBUG
+void      Slab_Print(SLABCACHE cache);
+#endif
+#endif
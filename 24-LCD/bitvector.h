@@ -164,6 +164,159 @@ int i;
 }
 
 
+/**
+ *  @brief  bv_ctz
+ *
+ *  @note   returns the number of trailing zeros of x. x must not be zero
+ *
+ *  @note   On Cortex-M7 it is compiled as a RBIT followed by a CLZ
+ */
+static inline int
+bv_ctz(BV_TYPE x) {
+    return __builtin_ctz(x);
+}
+
+
+/**
+ *  @brief  bv_rangemask
+ *
+ *  @note   returns a mask with bits from position first to last (inclusive) set
+ *          0 <= first <= last < BV_BITS
+ */
+static inline BV_TYPE
+bv_rangemask(int first, int last) {
+    return ((~(BV_TYPE) 0)<<first)&((~(BV_TYPE) 0)>>(BV_BITS-1-last));
+}
+
+
+/**
+ *  @brief  bv_find_next
+ *
+ *  @note   returns the position of the first set bit at position start or after it.
+ *          Returns -1 if there is none. The search is done 32 bits at a time
+ */
+static inline int
+bv_find_next(bv_type v, int size, int start) {
+int i;
+BV_TYPE w;
+
+    if( start >= size )
+        return -1;
+    i = bv_index(start);
+    w = v[i]&(~(BV_TYPE) 0<<bv_bit(start));
+    for(;;) {
+        if( w ) {
+            start = (i<<BV_SHIFT)+bv_ctz(w);
+            return start<size?start:-1;
+        }
+        if( ++i >= BV_SIZE(size) )
+            return -1;
+        w = v[i];
+    }
+}
+
+
+/**
+ *  @brief  bv_find_next_clear
+ *
+ *  @note   returns the position of the first clear bit at position start or after it.
+ *          Returns -1 if there is none. The search is done 32 bits at a time
+ */
+static inline int
+bv_find_next_clear(bv_type v, int size, int start) {
+int i;
+BV_TYPE w;
+
+    if( start >= size )
+        return -1;
+    i = bv_index(start);
+    w = ~v[i]&(~(BV_TYPE) 0<<bv_bit(start));
+    for(;;) {
+        if( w ) {
+            start = (i<<BV_SHIFT)+bv_ctz(w);
+            return start<size?start:-1;
+        }
+        if( ++i >= BV_SIZE(size) )
+            return -1;
+        w = ~v[i];
+    }
+}
+
+
+/**
+ *  @brief  bv_find_first_set
+ *
+ *  @note   returns the position of the first set bit or -1 if all are cleared
+ */
+static inline int
+bv_find_first_set(bv_type v, int size) {
+    return bv_find_next(v,size,0);
+}
+
+
+/**
+ *  @brief  bv_find_first_clear
+ *
+ *  @note   returns the position of the first clear bit or -1 if all are set
+ */
+static inline int
+bv_find_first_clear(bv_type v, int size) {
+    return bv_find_next_clear(v,size,0);
+}
+
+
+/**
+ *  @brief  bv_setrange
+ *
+ *  @note   set n bits starting at position start
+ */
+static inline void
+bv_setrange(bv_type v, int start, int n) {
+int last = start+n-1;
+int i;
+int j;
+
+    if( n <= 0 )
+        return;
+    i = bv_index(start);
+    j = bv_index(last);
+    if( i == j ) {
+        v[i] |= bv_rangemask(bv_bit(start),bv_bit(last));
+        return;
+    }
+    v[i++] |= bv_rangemask(bv_bit(start),BV_BITS-1);
+    while( i < j )
+        v[i++] = ~(BV_TYPE) 0;
+    v[j] |= bv_rangemask(0,bv_bit(last));
+}
+
+
+/**
+ *  @brief  bv_clearrange
+ *
+ *  @note   clear n bits starting at position start
+ */
+static inline void
+bv_clearrange(bv_type v, int start, int n) {
+int last = start+n-1;
+int i;
+int j;
+
+    if( n <= 0 )
+        return;
+    i = bv_index(start);
+    j = bv_index(last);
+    if( i == j ) {
+        v[i] &= ~bv_rangemask(bv_bit(start),bv_bit(last));
+        return;
+    }
+    v[i++] &= ~bv_rangemask(bv_bit(start),BV_BITS-1);
+    while( i < j )
+        v[i++] = 0;
+    v[j] &= ~bv_rangemask(0,bv_bit(last));
+}
+
+
 #ifdef DEBUG
 #ifdef BV_ENABLEMACROS
 /// Call bv_dump. Complex instructions are generally not inlined
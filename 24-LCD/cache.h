@@ -0,0 +1,64 @@
+#ifndef CACHE_H
+#define CACHE_H
+/**
+ * @file    cache.h
+ *
+ * @note    MPU configuration and cache maintenance for DMA buffers
+ *
+ * @note    The L1 data cache is enabled by SystemInit. A DMA master (ETH, DMA2D,
+ *          DMA1/2) does not see the cache, so a buffer shared with it must be
+ *          either in a non cacheable region (NOCACHE) or cleaned before the DMA
+ *          reads it and invalidated before the CPU reads what the DMA wrote.
+ *
+ * @note    Cache maintenance works on 32 byte lines. Buffers that are invalidated
+ *          must be aligned and padded to 32 bytes (CACHE_ALIGNED), otherwise
+ *          data of neighbour variables in the same line can be lost.
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Size of a L1 cache line in bytes
+ */
+#define CACHE_LINESIZE              (32)
+
+/**
+ * @brief   Attributes for variables
+ */
+///@{
+#define NOCACHE                     __attribute__((section(".nocache")))
+#define CACHE_ALIGNED               __attribute__((aligned(CACHE_LINESIZE)))
+///@}
+
+/**
+ * @brief   Memory types for Cache_SetRegion
+ */
+///@{
+#define CACHE_WRITEBACK             (0)     ///< Normal, write back, write allocate
+#define CACHE_WRITETHROUGH          (1)     ///< Normal, write through, no write allocate
+#define CACHE_NONCACHEABLE          (2)     ///< Normal, not cacheable, shareable
+#define CACHE_DEVICE                (3)     ///< Device, shareable
+#define CACHE_TYPE_MASK             (3)
+#define CACHE_XN                    (4)     ///< Execution not allowed
+///@}
+
+/**
+ * @brief   MPU regions used by Cache_Init and LCD_SetSRAMFrameBuffer
+ *
+ * @note    Higher numbers have priority when regions overlap
+ */
+///@{
+#define CACHE_REGION_SDRAM          (0)
+#define CACHE_REGION_NOCACHE        (1)
+#define CACHE_REGION_LCD            (2)     ///< SRAM frame buffers (lcd.c)
+#define CACHE_REGION_FREE           (3)     ///< first region free for application
+///@}
+
+int  Cache_Init(void);
+int  Cache_SetRegion(int region, uint32_t base, uint32_t size, unsigned type);
+int  Cache_DisableRegion(int region);
+void Cache_CleanRange(const void *p, uint32_t n);
+void Cache_InvalidateRange(void *p, uint32_t n);
+void Cache_CleanInvalidateRange(void *p, uint32_t n);
+
+#endif // CACHE_H
@@ -0,0 +1,334 @@
+/**
+ * @file    console.c
+ *
+ * @note    Text console in a LCD layer with scrolling by moving the frame
+ *          buffer address
+ *
+ * @note    The buffer has nrows = CONSOLE_SCREENS*rows text rows and the layer
+ *          shows rows of them, starting at buffer row top. Screen row r is
+ *          buffer row top+r. A new line at the last screen row increments top
+ *          and clears the new last row. When top+rows would pass the end of the
+ *          buffer, the rows still visible are copied to the start and top
+ *          becomes 0
+ *
+ * @note    All drawing is queued in the DMA2D. The new address of the layer
+ *          is set by the callback of the job that clears the new row, so the
+ *          window only moves when the copy and the clear are done, and the
+ *          CPU does not wait for them
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "lcd.h"
+#include "dma2d.h"
+#include "buddy.h"
+#include "text.h"
+#include "console.h"
+
+/**
+ * @brief   Tab stops
+ */
+#define TABSIZE             8
+
+/**
+ * @brief   Console state
+ */
+static struct {
+    int             initialized;
+    int             layer;
+    TEXTFONT        font;
+    char           *buffer;
+    int             pitch;
+    int             width;              ///< in pixels
+    int             cw;                 ///< glyph size
+    int             ch;
+    int             rows;               ///< visible text rows
+    int             cols;
+    int             nrows;              ///< text rows in buffer
+    int             top;                ///< buffer row at top of window
+    int             row;                ///< cursor (screen row)
+    int             col;
+    int             used;               ///< columns drawn in the cursor row
+    unsigned        fg;                 ///< RGB888
+    unsigned        bg;                 ///< in CONSOLE_FORMAT
+    Console_Stats   stats;
+} con;
+
+/**
+ * @brief   Converts a RGB888 color to CONSOLE_FORMAT
+ */
+static unsigned
+convertcolor(unsigned c) {
+
+    switch( CONSOLE_FORMAT ) {
+    case LCD_FORMAT_ARGB8888:
+        return 0xFF000000|(c&0xFFFFFF);
+    case LCD_FORMAT_RGB565:
+        return ((c>>8)&0xF800)|((c>>5)&0x07E0)|((c>>3)&0x001F);
+    default:
+        return c&0xFFFFFF;
+    }
+}
+
+/**
+ * @brief   Bytes per pixel of CONSOLE_FORMAT
+ */
+static int
+pixelsize(void) {
+
+    switch( CONSOLE_FORMAT ) {
+    case LCD_FORMAT_ARGB8888:
+        return 4;
+    case LCD_FORMAT_RGB888:
+        return 3;
+    default:
+        return 2;
+    }
+}
+
+/**
+ * @brief   Moves the window. Called from the DMA2D interrupt
+ */
+static void
+movewindow(void *arg, int status) {
+
+    (void) status;
+    LCD_SetFrameBufferAddress(con.layer,arg);
+}
+
+/**
+ * @brief   Queues the clear of n text rows starting at buffer row first
+ *
+ * @note    cb is called when done. Returns -1 when the DMA2D does not accept
+ *          the job
+ */
+static int
+clearrows(int first, int n, DMA2D_Callback cb, void *arg) {
+DECLARE_REGION(r,con.buffer,0,first*con.ch,con.width,n*con.ch,CONSOLE_FORMAT,con.pitch);
+
+    // Wait for a free entry when the queue is full
+    while( DMA2D_SubmitFill(&r,con.bg,cb,arg) == 0 ) {
+        if( DMA2D_IsIdle() )
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief   Queues the clear of columns col0 to col1-1 of the cursor row
+ */
+static int
+clearcolumns(int col0, int col1) {
+DECLARE_REGION(r,con.buffer,col0*con.cw,(con.top+con.row)*con.ch,
+                (col1-col0)*con.cw,con.ch,CONSOLE_FORMAT,con.pitch);
+
+    while( DMA2D_SubmitFill(&r,con.bg,0,0) == 0 ) {
+        if( DMA2D_IsIdle() )
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief   Queues the copy of n text rows from buffer row from to buffer row to
+ */
+static int
+copyrows(int from, int to, int n) {
+DECLARE_REGION(src,con.buffer,0,from*con.ch,con.width,n*con.ch,CONSOLE_FORMAT,con.pitch);
+DECLARE_REGION(dst,con.buffer,0,to*con.ch,con.width,n*con.ch,CONSOLE_FORMAT,con.pitch);
+
+    while( DMA2D_SubmitCopy(&src,&dst,0,0) == 0 ) {
+        if( DMA2D_IsIdle() )
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief   Advances the cursor to the start of the next line, scrolling when
+ *          it is in the last row
+ */
+static void
+newline(void) {
+
+    con.col  = 0;
+    con.used = 0;
+    if( con.row < con.rows-1 ) {
+        con.row++;
+        return;
+    }
+
+    if( con.top+con.rows >= con.nrows ) {
+        // The rows that stay visible go to the start of the buffer
+        copyrows(con.top+1,0,con.rows-1);
+        con.top = 0;
+        con.stats.copies++;
+    } else {
+        con.top++;
+    }
+    con.stats.lines++;
+    clearrows(con.top+con.rows-1,1,movewindow,con.buffer+con.top*con.ch*con.pitch);
+}
+
+/**
+ * @brief   Draws n characters at the cursor, all in the cursor row
+ */
+static void
+drawsegment(const char *s, int n) {
+char seg[CONSOLE_MAXCOLUMNS+1];
+int i;
+
+    if( n == 0 )
+        return;
+    for(i=0;i<n;i++)
+        seg[i] = s[i];
+    seg[n] = 0;
+    // Overwriting after a carriage return or a backspace
+    if( con.col < con.used )
+        clearcolumns(con.col,con.used < con.col+n ? con.used : con.col+n);
+    Text_DrawInBuffer(con.buffer,CONSOLE_FORMAT,con.pitch,con.width,con.nrows*con.ch,
+                      con.font,con.col*con.cw,(con.top+con.row)*con.ch,seg,con.fg);
+    con.col += n;
+    if( con.col > con.used )
+        con.used = con.col;
+}
+
+/**
+ * @brief   Console_Init
+ *
+ * @note    The console uses layer in a window of the full display width and
+ *          rows text rows (0 = as many as fit) starting at line y. The layer is
+ *          configured and enabled. fg and bg are RGB888 colors
+ *
+ * @note    The buffer is allocated from the buddy pool (SDRAM)
+ */
+int
+Console_Init(int layer, TEXTFONT font, int y, int rows, unsigned fg, unsigned bg) {
+TEXT_Stats ts;
+int size;
+
+    if( font == 0 || y < 0 || y >= LCD_DH || rows < 0 || CONSOLE_SCREENS < 2 )
+        return CONSOLE_ERROR_PARAMETER;
+
+    Text_GetStats(font,&ts);
+    if( rows == 0 )
+        rows = (LCD_DH-y)/ts.cellheight;
+    if( rows == 0 || y+rows*(int) ts.cellheight > LCD_DH )
+        return CONSOLE_ERROR_PARAMETER;
+
+    con.initialized = 0;
+    con.layer  = layer;
+    con.font   = font;
+    con.cw     = ts.cellwidth;
+    con.ch     = ts.cellheight;
+    con.width  = LCD_DW;
+    con.rows   = rows;
+    con.cols   = LCD_DW/con.cw;
+    if( con.cols > CONSOLE_MAXCOLUMNS )
+        con.cols = CONSOLE_MAXCOLUMNS;
+    con.nrows  = CONSOLE_SCREENS*rows;
+    con.pitch  = ((con.width*pixelsize()+63)/64)*64;
+    size       = con.nrows*con.ch*con.pitch;
+
+    if( con.buffer )
+        Buddy_Free(con.buffer);
+    con.buffer = Buddy_Alloc(size);
+    if( con.buffer == 0 )
+        return CONSOLE_ERROR_NOMEMORY;
+
+    con.fg     = fg;
+    con.bg     = convertcolor(bg);
+    con.top    = 0;
+    con.row    = 0;
+    con.col    = 0;
+    con.used   = 0;
+    con.stats.lines  = 0;
+    con.stats.copies = 0;
+
+    if( clearrows(0,con.nrows,0,0) < 0 )
+        return CONSOLE_ERROR_DMA2D;
+    LCD_WaitDrawing();
+    LCD_SetFrameBuffer(layer,con.buffer,CONSOLE_FORMAT,0,y,con.width,rows*con.ch,con.pitch);
+    con.initialized = 1;
+    return CONSOLE_OK;
+}
+
+/**
+ * @brief   Console_Write
+ *
+ * @note    Handles '\n', '\r', '\b' and '\t'. Other control characters are
+ *          ignored and long lines are wrapped. Returns n
+ */
+int
+Console_Write(const char *s, int n) {
+const char *seg;
+int i,len;
+
+    if( !con.initialized )
+        return n;
+
+    seg = s;
+    len = 0;
+    for(i=0;i<n;i++) {
+        if( (unsigned char) s[i] >= ' ' ) {
+            if( con.col+len == con.cols ) {
+                drawsegment(seg,len);
+                newline();
+                seg = s+i;
+                len = 0;
+            }
+            len++;
+            continue;
+        }
+        drawsegment(seg,len);
+        seg = s+i+1;
+        len = 0;
+        switch( s[i] ) {
+        case '\n':
+            newline();
+            break;
+        case '\r':
+            con.col = 0;
+            break;
+        case '\b':
+            if( con.col > 0 )
+                con.col--;
+            break;
+        case '\t':
+            con.col = (con.col/TABSIZE+1)*TABSIZE;
+            if( con.col >= con.cols )
+                newline();
+            break;
+        }
+    }
+    drawsegment(seg,len);
+    return n;
+}
+
+/**
+ * @brief   Console_Clear
+ *
+ * @note    Clears the window and moves the cursor to the top left corner
+ */
+void
+Console_Clear(void) {
+
+    if( !con.initialized )
+        return;
+    clearrows(con.top,con.rows,0,0);
+    con.row  = 0;
+    con.col  = 0;
+    con.used = 0;
+}
+
+/**
+ * @brief   Console_GetStats
+ */
+void
+Console_GetStats(Console_Stats *s) {
+
+    *s = con.stats;
+}
@@ -0,0 +1,67 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+/**
+ * @file    console.h
+ *
+ * @note    Text console in a LCD layer, used as a stdout backend by _write
+ *          (syscalls.c) when USE_LCDCONSOLE is defined
+ *
+ * @note    The layer scans a window of rows text rows over a buffer with
+ *          CONSOLE_SCREENS times as many rows. Scrolling moves the start
+ *          address of the layer (CFBAR) by one text row, so no pixel is copied.
+ *          Only when the window reaches the end of the buffer, the visible
+ *          rows are copied to its start by the DMA2D, once every
+ *          (CONSOLE_SCREENS-1)*rows lines
+ *
+ * @note    Text is drawn with the glyph cache of text.c. Console_Write is not
+ *          reentrant, so it must not be called from interrupts
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include "text.h"
+
+/**
+ * @brief   Size of the scroll buffer in screens (at least 2)
+ */
+#ifndef CONSOLE_SCREENS
+#define CONSOLE_SCREENS         4
+#endif
+
+/**
+ * @brief   Pixel format of the console layer
+ */
+#ifndef CONSOLE_FORMAT
+#define CONSOLE_FORMAT          LCD_FORMAT_RGB565
+#endif
+
+/**
+ * @brief   Maximal number of columns
+ */
+#define CONSOLE_MAXCOLUMNS      128
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define CONSOLE_OK              (0)
+#define CONSOLE_ERROR_PARAMETER (-1)
+#define CONSOLE_ERROR_NOMEMORY  (-2)
+#define CONSOLE_ERROR_DMA2D     (-3)
+///@}
+
+/**
+ * @brief   Statistics
+ */
+typedef struct {
+    uint32_t    lines;                      ///< lines scrolled
+    uint32_t    copies;                     ///< wraps of the scroll buffer
+} Console_Stats;
+
+int   Console_Init(int layer, TEXTFONT font, int y, int rows, unsigned fg, unsigned bg);
+int   Console_Write(const char *s, int n);
+void  Console_Clear(void);
+void  Console_GetStats(Console_Stats *s);
+
+#endif // CONSOLE_H
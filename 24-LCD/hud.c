@@ -0,0 +1,360 @@
+/**
+ * @file    hud.c
+ *
+ * @note    Performance overlay in a LCD layer (see hud.h)
+ *
+ * @note    The window has HUD_LINES text lines of HUD_COLUMNS glyphs. The text
+ *          shown is kept, padded with spaces, so a new line is compared with
+ *          it and only the columns from the first to the last difference are
+ *          cleared and drawn. The jobs are queued in the DMA2D in order, so the
+ *          text is blended after the clear, and the CPU does not wait for them
+ *
+ * @note    The rates are the differences of the counters over the DWT cycles
+ *          since the last update, so a late HUD_Poll gives a longer interval,
+ *          not a wrong rate. The cycle counter wraps after 21 s at 200 MHz,
+ *          so HUD_Poll must be called more often than that
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "lcd.h"
+#include "dma2d.h"
+#include "buddy.h"
+#include "uart.h"
+#include "text.h"
+#include "hud.h"
+
+/**
+ * @brief   Lines of the window
+ */
+///@{
+#define LINE_CPU            0
+#define LINE_FPS            1
+#define LINE_DMA2D          2
+#define LINE_HEAP           3
+#define LINE_NET            4
+#define LINE_UART           5
+#define LINE_HUD            6
+///@}
+
+/**
+ * @brief   HUD state
+ */
+static struct {
+    int             initialized;
+    int             layer;
+    TEXTFONT        font;
+    char           *buffer;
+    int             pitch;
+    int             width;              ///< in pixels
+    int             height;
+    int             cw;                 ///< glyph size
+    int             ch;
+    unsigned        fg;                 ///< RGB888
+    unsigned        bg;                 ///< in HUD_FORMAT
+    HUD_Counter     counter;
+    char            text[HUD_LINES][HUD_COLUMNS+1];     ///< shown
+    uint32_t        last;               ///< DWT->CYCCNT of the last update
+    uint32_t        lastidle;           ///< counters at the last update
+    uint32_t        lastbusy;
+    uint32_t        lastframes;
+    uint32_t        lastpackets;
+    HUD_Stats       stats;
+} hud;
+
+/**
+ * @brief   Cycles spent in HUD_Idle
+ */
+static volatile uint32_t idlecycles = 0;
+
+/**
+ * @brief   Converts a RGB888 color to HUD_FORMAT
+ */
+static unsigned
+convertcolor(unsigned c) {
+
+    switch( HUD_FORMAT ) {
+    case LCD_FORMAT_ARGB8888:
+        return 0xFF000000|(c&0xFFFFFF);
+    case LCD_FORMAT_RGB565:
+        return ((c>>8)&0xF800)|((c>>5)&0x07E0)|((c>>3)&0x001F);
+    default:
+        return c&0xFFFFFF;
+    }
+}
+
+/**
+ * @brief   Bytes per pixel of HUD_FORMAT
+ */
+static int
+pixelsize(void) {
+
+    switch( HUD_FORMAT ) {
+    case LCD_FORMAT_ARGB8888:
+        return 4;
+    case LCD_FORMAT_RGB888:
+        return 3;
+    default:
+        return 2;
+    }
+}
+
+/**
+ * @brief   Queues the clear of a rectangle of the window
+ *
+ * @note    Returns -1 when the DMA2D does not accept the job
+ */
+static int
+clearrect(int x, int y, int w, int h) {
+DECLARE_REGION(r,hud.buffer,x,y,w,h,HUD_FORMAT,hud.pitch);
+
+    // Wait for a free entry when the queue is full
+    while( DMA2D_SubmitFill(&r,hud.bg,0,0) == 0 ) {
+        if( DMA2D_IsIdle() )
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief   Redraws the columns of line that changed
+ *
+ * @note    s has HUD_COLUMNS chars (padded with spaces)
+ */
+static void
+updateline(int line, const char *s) {
+char seg[HUD_COLUMNS+1];
+char *old = hud.text[line];
+int c0,c1,d0,d1;
+
+    for(c0=0;c0<HUD_COLUMNS && s[c0]==old[c0];c0++) {}
+    if( c0 == HUD_COLUMNS )
+        return;
+    for(c1=HUD_COLUMNS;s[c1-1]==old[c1-1];c1--) {}
+
+    clearrect(c0*hud.cw,line*hud.ch,(c1-c0)*hud.cw,hud.ch);
+    hud.stats.rects++;
+    hud.stats.pixels += (c1-c0)*hud.cw*hud.ch;
+
+    // Spaces are only cleared
+    for(d0=c0;d0<c1 && s[d0]==' ';d0++) {}
+    for(d1=c1;d1>d0 && s[d1-1]==' ';d1--) {}
+    if( d1 > d0 ) {
+        memcpy(seg,s+d0,d1-d0);
+        seg[d1-d0] = 0;
+        Text_DrawInBuffer(hud.buffer,HUD_FORMAT,hud.pitch,hud.width,hud.height,
+                          hud.font,d0*hud.cw,line*hud.ch,seg,hud.fg);
+    }
+    memcpy(old,s,HUD_COLUMNS);
+}
+
+/**
+ * @brief   Formats a line, padded with spaces, and redraws it
+ */
+static void
+printline(int line, const char *fmt, ...) {
+char s[HUD_COLUMNS+1];
+va_list ap;
+int n;
+
+    va_start(ap,fmt);
+    n = vsnprintf(s,sizeof(s),fmt,ap);
+    va_end(ap);
+    if( n < 0 )
+        n = 0;
+    if( n > HUD_COLUMNS )
+        n = HUD_COLUMNS;
+    memset(s+n,' ',HUD_COLUMNS-n);
+    s[HUD_COLUMNS] = 0;
+    updateline(line,s);
+}
+
+/**
+ * @brief   Ratio x 1000 of two cycle counts, limited to 1000
+ */
+static unsigned
+permille(uint32_t part, uint32_t total) {
+
+    if( part >= total )
+        return 1000;
+    return (unsigned) (((uint64_t) part*1000)/total);
+}
+
+/**
+ * @brief   HUD_Init
+ *
+ * @note    The HUD uses layer in a window of HUD_COLUMNS x HUD_LINES glyphs of
+ *          font with the top left corner at (x,y). The layer is configured,
+ *          enabled and made translucent (HUD_OPACITY). fg and bg are RGB888
+ *          colors
+ *
+ * @note    The buffer is allocated from the buddy pool (SDRAM). The first
+ *          update is HUD_PERIOD ms later
+ */
+int
+HUD_Init(int layer, TEXTFONT font, int x, int y, unsigned fg, unsigned bg) {
+TEXT_Stats ts;
+int line;
+
+    if( font == 0 || x < 0 || y < 0 )
+        return HUD_ERROR_PARAMETER;
+
+    Text_GetStats(font,&ts);
+    if( x+HUD_COLUMNS*(int) ts.cellwidth >= LCD_DW || y+HUD_LINES*(int) ts.cellheight >= LCD_DH )
+        return HUD_ERROR_PARAMETER;
+
+    hud.initialized = 0;
+    hud.layer  = layer;
+    hud.font   = font;
+    hud.cw     = ts.cellwidth;
+    hud.ch     = ts.cellheight;
+    hud.width  = HUD_COLUMNS*hud.cw;
+    hud.height = HUD_LINES*hud.ch;
+    hud.pitch  = ((hud.width*pixelsize()+63)/64)*64;
+
+    if( hud.buffer )
+        Buddy_Free(hud.buffer);
+    hud.buffer = Buddy_Alloc(hud.height*hud.pitch);
+    if( hud.buffer == 0 )
+        return HUD_ERROR_NOMEMORY;
+
+    hud.fg = fg;
+    hud.bg = convertcolor(bg);
+    for(line=0;line<HUD_LINES;line++) {
+        memset(hud.text[line],' ',HUD_COLUMNS);
+        hud.text[line][HUD_COLUMNS] = 0;
+    }
+    memset(&hud.stats,0,sizeof(hud.stats));
+
+    if( clearrect(0,0,hud.width,hud.height) < 0 )
+        return HUD_ERROR_DMA2D;
+    LCD_WaitDrawing();
+    LCD_SetFrameBuffer(layer,hud.buffer,HUD_FORMAT,x,y,hud.width,hud.height,hud.pitch);
+    LCD_SetLayerOpacity(layer,HUD_OPACITY);
+
+    hud.last        = DWT->CYCCNT;
+    hud.lastidle    = idlecycles;
+    hud.lastbusy    = DMA2D_GetBusyCycles();
+    hud.lastframes  = LCD_GetFrameCount(HUD_FRAMELAYER);
+    hud.lastpackets = hud.counter ? hud.counter() : 0;
+    hud.initialized = 1;
+    return HUD_OK;
+}
+
+/**
+ * @brief   HUD_SetPacketCounter
+ *
+ * @note    counter returns the packets since start (0 removes it)
+ */
+void
+HUD_SetPacketCounter(HUD_Counter counter) {
+
+    hud.counter     = counter;
+    hud.lastpackets = counter ? counter() : 0;
+}
+
+/**
+ * @brief   HUD_Poll
+ *
+ * @note    Updates the window when HUD_PERIOD ms have passed since the last
+ *          update. Returns 1 when it did
+ */
+int
+HUD_Poll(void) {
+BUDDY_Stats bs;
+UART_FIFOLevels ul;
+uint32_t now,elapsed,cycles,idle,busy,frames,packets;
+unsigned load,util,fps;
+
+    if( !hud.initialized )
+        return 0;
+    now     = DWT->CYCCNT;
+    elapsed = now-hud.last;
+    if( elapsed < HUD_PERIOD*(SystemCoreClock/1000) )
+        return 0;
+
+    idle   = idlecycles;
+    busy   = DMA2D_GetBusyCycles();
+    frames = LCD_GetFrameCount(HUD_FRAMELAYER);
+
+    load = 1000-permille(idle-hud.lastidle,elapsed);
+    printline(LINE_CPU,"cpu   %3u.%u %%",load/10,load%10);
+
+    fps = (unsigned) (((uint64_t) (frames-hud.lastframes)*10*SystemCoreClock)/elapsed);
+    printline(LINE_FPS,"fps   %3u.%u",fps/10,fps%10);
+
+    util = permille(busy-hud.lastbusy,elapsed);
+    printline(LINE_DMA2D,"dma2d %3u.%u %%",util/10,util%10);
+
+    if( Buddy_GetStats(&bs) == 0 )
+        printline(LINE_HEAP,"heap  %ldK/%ldK max %ldK",
+                  bs.inuse/1024,bs.size/1024,bs.largestfree/1024);
+
+    if( hud.counter ) {
+        packets = hud.counter();
+        printline(LINE_NET,"net   %lu pps",(unsigned long)
+                  (((uint64_t) (packets-hud.lastpackets)*SystemCoreClock)/elapsed));
+        hud.lastpackets = packets;
+    } else {
+        printline(LINE_NET,"net   --");
+    }
+
+    if( UART_GetFIFOLevels(HUD_UART,&ul) == 0 )
+        printline(LINE_UART,"uart  tx %d/%d rx %d/%d",
+                  ul.outlevel,ul.outcapacity,ul.inlevel,ul.incapacity);
+
+    // Cost of the previous update
+    printline(LINE_HUD,"hud   %lu us %u.%u %%",
+              (unsigned long) (hud.stats.lastcycles/(SystemCoreClock/1000000)),
+              (unsigned) hud.stats.permille/10,(unsigned) hud.stats.permille%10);
+
+    hud.last       = now;
+    hud.lastidle   = idle;
+    hud.lastbusy   = busy;
+    hud.lastframes = frames;
+
+    cycles = DWT->CYCCNT-now;
+    hud.stats.updates++;
+    hud.stats.lastcycles = cycles;
+    if( cycles > hud.stats.maxcycles )
+        hud.stats.maxcycles = cycles;
+    hud.stats.permille = permille(cycles,elapsed);
+    return 1;
+}
+
+/**
+ * @brief   HUD_Idle
+ *
+ * @note    Sleeps until the next interrupt, counting the time as idle
+ *
+ * @note    Interrupts are disabled around the WFI, so the CPU wakes up but the
+ *          interrupt routine runs after the idle time is added, not inside it
+ */
+void
+HUD_Idle(void) {
+uint32_t t0;
+
+    __disable_irq();
+    t0 = DWT->CYCCNT;
+    __DSB();
+    __WFI();
+    idlecycles += DWT->CYCCNT-t0;
+    __enable_irq();
+}
+
+/**
+ * @brief   HUD_GetStats
+ */
+void
+HUD_GetStats(HUD_Stats *s) {
+
+    *s = hud.stats;
+}
@@ -0,0 +1,94 @@
+#ifndef HUD_H
+#define HUD_H
+/**
+ * @file    hud.h
+ *
+ * @note    Performance overlay in a small window of a LCD layer (usually 2)
+ *          over the application in layer 1
+ *
+ * @note    HUD_Poll is called from the main loop. Every HUD_PERIOD ms it
+ *          samples the counters over the last interval and updates the text
+ *          lines: CPU load, flips per second of HUD_FRAMELAYER, DMA2D
+ *          utilization, buddy pool, packets per second, UART FIFO levels and
+ *          the cost of the HUD itself
+ *
+ * @note    Only the columns that changed since the last update are cleared and
+ *          redrawn (queued DMA2D jobs and the glyph cache of text.c), so most
+ *          updates redraw a few digits
+ *
+ * @note    The CPU load is the time not spent in HUD_Idle, that the application
+ *          calls instead of __WFI when it waits. The interrupt that wakes the
+ *          CPU there runs after the idle time is counted, so it is load
+ *
+ * @note    The packets come from a counter function given by HUD_SetPacketCounter
+ *          (e.g. the Ethernet counters of the network stack). Without it the
+ *          line shows "--"
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "text.h"
+
+/**
+ * @brief   Parameters
+ */
+///@{
+#ifndef HUD_PERIOD
+#define HUD_PERIOD              500     ///< ms between updates
+#endif
+#ifndef HUD_FORMAT
+#define HUD_FORMAT              LCD_FORMAT_RGB565
+#endif
+#ifndef HUD_OPACITY
+#define HUD_OPACITY             208     ///< constant alpha of the layer
+#endif
+#ifndef HUD_FRAMELAYER
+#define HUD_FRAMELAYER          1       ///< layer whose flips are counted
+#endif
+#ifndef HUD_UART
+#define HUD_UART                0       ///< UART_1, used by stdout
+#endif
+#define HUD_COLUMNS             28
+#define HUD_LINES               7
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define HUD_OK                  (0)
+#define HUD_ERROR_PARAMETER     (-1)
+#define HUD_ERROR_NOMEMORY      (-2)
+#define HUD_ERROR_DMA2D         (-3)
+///@}
+
+/**
+ * @brief   Counter of packets (received+sent) since start, wrapping around
+ */
+typedef uint32_t (*HUD_Counter)(void);
+
+/**
+ * @brief   Statistics
+ *
+ * @note    cycles are CPU cycles spent in HUD_Poll while updating. The DMA2D
+ *          time of the redraws is in the DMA2D utilization
+ */
+typedef struct {
+    uint32_t    updates;                    ///< samples taken
+    uint32_t    rects;                      ///< line segments redrawn
+    uint32_t    pixels;                     ///< pixels redrawn
+    uint32_t    lastcycles;                 ///< last update
+    uint32_t    maxcycles;                  ///< longest update
+    uint32_t    permille;                   ///< last update over its interval x 1000
+} HUD_Stats;
+
+int   HUD_Init(int layer, TEXTFONT font, int x, int y, unsigned fg, unsigned bg);
+void  HUD_SetPacketCounter(HUD_Counter counter);
+int   HUD_Poll(void);
+void  HUD_Idle(void);
+void  HUD_GetStats(HUD_Stats *s);
+
+#endif // HUD_H
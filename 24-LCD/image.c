@@ -0,0 +1,250 @@
+/**
+ * @file    image.c
+ *
+ * @note    Compressed images drawn with DMA2D
+ *
+ * @note    RLE images are decoded by the CPU into one of two buffers, a block of
+ *          lines at a time. A DMA2D job then copies the block into the layer
+ *          (converting the pixel format) or blends it when the image has alpha.
+ *          Meanwhile the next block is decoded into the other buffer.
+ *
+ * @note    Raw images are transferred by DMA2D directly from the asset.
+ *
+ * @note    Layers in L8, AL44 and AL88 are not supported, since the DMA2D can
+ *          not write them.
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "lcd.h"
+#include "dma2d.h"
+#include "cache.h"
+#include "memsections.h"
+#include "image.h"
+
+/**
+ * @brief   Pixel size of the image formats (LCD_FORMAT_ARGB8888..ARGB4444)
+ */
+static const uint8_t pixelsize[] = { 4, 3, 2, 2, 2 };
+
+/**
+ * @brief   Decoding buffers and the last DMA2D job reading each one
+ *
+ * @note    Aligned to cache lines, because DMA2D_Submit* cleans them from the
+ *          data cache
+ */
+///@{
+static uint8_t      imagebuf[2][IMAGE_BUFSIZE] CACHE_ALIGNED;
+static DMA2D_Fence  imagefence[2] = { 0, 0 };
+///@}
+
+/**
+ * @brief   decodeline
+ *
+ * @note    Decodes a line of w pixels of ps bytes from p into dst. When dst is
+ *          null, the line is only skipped
+ *
+ * @note    Returns the start of the next line or null if the data is corrupted
+ */
+ITCM_CODE static const uint8_t *
+decodeline(const uint8_t *p, const uint8_t *end, uint8_t *dst, int w, int ps) {
+int c,n,i;
+
+    while( w > 0 ) {
+        if( p >= end )
+            return 0;
+        c = *p++;
+        n = (c&0x7F)+1;
+        if( n > w )
+            return 0;
+        w -= n;
+        if( c < 0x80 ) {
+            n *= ps;
+            if( end-p < n )
+                return 0;
+            if( dst ) {
+                for(i=0;i<n;i++)
+                    *dst++ = p[i];
+            }
+            p += n;
+        } else {
+            if( end-p < ps )
+                return 0;
+            if( dst ) {
+                switch(ps) {
+                case 2: {
+                    uint16_t v = p[0]|(p[1]<<8);
+                    uint16_t *q = (uint16_t *) dst;
+                    for(i=0;i<n;i++)
+                        *q++ = v;
+                    dst = (uint8_t *) q;
+                    }
+                    break;
+                case 4: {
+                    uint32_t v = p[0]|(p[1]<<8)|(p[2]<<16)|((uint32_t) p[3]<<24);
+                    uint32_t *q = (uint32_t *) dst;
+                    for(i=0;i<n;i++)
+                        *q++ = v;
+                    dst = (uint8_t *) q;
+                    }
+                    break;
+                default:
+                    for(i=0;i<n;i++) {
+                        dst[0] = p[0]; dst[1] = p[1]; dst[2] = p[2];
+                        dst += 3;
+                    }
+                    break;
+                }
+            }
+            p += ps;
+        }
+    }
+    return p;
+}
+
+/**
+ * @brief   submit
+ *
+ * @note    Queues the transfer of fg into the layer region dst. Images with
+ *          alpha are blended, the others copied
+ */
+static DMA2D_Fence
+submit(const DMA2DRegion *fg, const DMA2DRegion *dst, int blend) {
+DMA2D_Fence f;
+
+    // Wait for a free entry when the queue is full
+    for(;;) {
+        if( blend )
+            f = DMA2D_SubmitBlend(fg,dst,dst,255,0,0);
+        else
+            f = DMA2D_SubmitCopy(fg,dst,0,0);
+        if( f || DMA2D_IsIdle() )
+            return f;
+    }
+}
+
+/**
+ * @brief   Image_Decode
+ *
+ * @note    Decodes the whole image into dst (pitch bytes per line) in the image
+ *          format. Returns 0 or -1 when the data is corrupted
+ */
+int
+Image_Decode(const IMAGE_Asset *img, void *dst, int pitch) {
+const uint8_t *p = img->data;
+const uint8_t *end = img->data+img->size;
+uint8_t *q = dst;
+int ps,linebytes,i,k;
+
+    if( img->format > LCD_FORMAT_ARGB4444 )
+        return -1;
+    ps = pixelsize[img->format];
+    linebytes = img->width*ps;
+
+    for(i=0;i<img->height;i++) {
+        if( img->encoding == IMAGE_RAW ) {
+            if( end-p < linebytes )
+                return -1;
+            for(k=0;k<linebytes;k++)
+                q[k] = p[k];
+            p += linebytes;
+        } else {
+            p = decodeline(p,end,q,img->width,ps);
+            if( p == 0 )
+                return -1;
+        }
+        q += pitch;
+    }
+    return 0;
+}
+
+/**
+ * @brief   Image_Draw
+ *
+ * @note    Draws the image with the top left corner at (x,y). It is clipped to
+ *          the layer
+ *
+ * @note    Returns the number of lines queued or -1 when the layer format or the
+ *          image is not supported or the data is corrupted. Use LCD_WaitDrawing
+ *          before the CPU accesses the area
+ */
+int
+Image_Draw(int layer, const IMAGE_Asset *img, int x, int y) {
+const uint8_t *p = img->data;
+const uint8_t *end = img->data+img->size;
+int format,pitch,lw,lh;
+int ps,linebytes,blend;
+int cx,cy,w,h,row,n,nlines;
+static int cur = 0;
+char *base;
+
+    format = LCD_GetFormat(layer);
+    if( format > LCD_FORMAT_ARGB4444 || img->format > LCD_FORMAT_ARGB4444 )
+        return -1;
+
+    ps        = pixelsize[img->format];
+    linebytes = img->width*ps;
+    blend     = img->format == LCD_FORMAT_ARGB8888
+             || img->format == LCD_FORMAT_ARGB1555
+             || img->format == LCD_FORMAT_ARGB4444;
+
+    pitch = LCD_GetPitch(layer);
+    lw    = LCD_GetWidth(layer);
+    lh    = LCD_GetHeight(layer);
+    base  = (char *) LCD_GetLineAddress(layer,0);
+
+    cx = x < 0 ? -x : 0;
+    w  = (x+img->width > lw ? lw-x : img->width)-cx;
+    cy = y < 0 ? -y : 0;
+    h  = (y+img->height > lh ? lh-y : img->height)-cy;
+    if( w <= 0 || h <= 0 )
+        return 0;
+
+    if( img->encoding == IMAGE_RAW ) {
+        if( img->size < (uint32_t) (linebytes*img->height) )
+            return -1;
+        DECLARE_REGION(fg,img->data,cx,cy,w,h,img->format,linebytes);
+        DECLARE_REGION(bg,base,x+cx,y+cy,w,h,format,pitch);
+        if( submit(&fg,&bg,blend) == 0 )
+            return -1;
+        LCD_AddDamage(layer,x+cx,y+cy,w,h);
+        return h;
+    }
+
+    if( linebytes > IMAGE_BUFSIZE )
+        return -1;
+    nlines = IMAGE_BUFSIZE/linebytes;
+
+    // Lines above the layer must be decoded to find the next ones
+    for(row=0;row<cy;row++) {
+        p = decodeline(p,end,0,img->width,ps);
+        if( p == 0 )
+            return -1;
+    }
+
+    while( row < cy+h ) {
+        if( imagefence[cur] ) {
+            DMA2D_WaitFence(imagefence[cur]);
+            imagefence[cur] = 0;
+        }
+        for(n=0;n<nlines && row<cy+h;n++,row++) {
+            p = decodeline(p,end,imagebuf[cur]+n*linebytes,img->width,ps);
+            if( p == 0 )
+                return -1;
+        }
+        {
+        DECLARE_REGION(fg,imagebuf[cur],cx,0,w,n,img->format,linebytes);
+        DECLARE_REGION(bg,base,x+cx,y+row-n,w,n,format,pitch);
+        imagefence[cur] = submit(&fg,&bg,blend);
+        if( imagefence[cur] == 0 )
+            return -1;
+        }
+        cur ^= 1;
+    }
+
+    LCD_AddDamage(layer,x+cx,y+cy,w,h);
+    return h;
+}
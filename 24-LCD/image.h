@@ -0,0 +1,60 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+/**
+ * @file    image.h
+ *
+ * @note    Compressed images drawn with DMA2D
+ *
+ * @note    Images are generated by tools/imgconv (make imgconv) as C files with
+ *          a const IMAGE_Asset. The data can be in the internal flash or in any
+ *          memory mapped area (QSPI flash in memory mapped mode, SDRAM)
+ *
+ * @note    RLE encoding (IMAGE_RLE). Each line is coded separately. A control
+ *          byte c is followed by
+ *          - c < 0x80: c+1 pixels (literal)
+ *          - c >= 0x80: one pixel repeated (c&0x7F)+1 times (run)
+ *          Pixels are stored little endian with the size of the pixel format
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Encodings
+ */
+///@{
+#define IMAGE_RAW                   0
+#define IMAGE_RLE                   1
+///@}
+
+/**
+ * @brief   Size of each of the two decoding buffers
+ *
+ * @note    As many full lines as fit are decoded before a DMA2D transfer. It
+ *          must hold at least one line of the widest image
+ */
+#ifndef IMAGE_BUFSIZE
+#define IMAGE_BUFSIZE               4096
+#endif
+
+/**
+ * @brief   Image
+ *
+ * @note    format is one of LCD_FORMAT_ARGB8888, RGB888, RGB565, ARGB1555 or
+ *          ARGB4444. Formats with alpha are blended into the layer
+ */
+typedef struct {
+    uint16_t        width;                  ///< in pixels
+    uint16_t        height;                 ///< in lines
+    uint8_t         format;                 ///< LCD_FORMAT_*
+    uint8_t         encoding;               ///< IMAGE_RAW or IMAGE_RLE
+    uint32_t        size;                   ///< bytes in data
+    const uint8_t   *data;                  ///< encoded pixels
+} IMAGE_Asset;
+
+int Image_Decode(const IMAGE_Asset *img, void *dst, int pitch);
+int Image_Draw(int layer, const IMAGE_Asset *img, int x, int y);
+
+#endif // IMAGE_H
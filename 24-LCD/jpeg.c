@@ -0,0 +1,901 @@
+/**
+ * @file    jpeg.c
+ *
+ * @note    Baseline JPEG images drawn with DMA2D
+ *
+ * @note    The headers are parsed from the asset in memory. Then the entropy
+ *          coded data is decoded MCU by MCU: Huffman decoding and dequantization
+ *          of each 8x8 block, IDCT into the sample planes of the MCU and color
+ *          conversion into the current row buffer (RGB565). The output function
+ *          receives each complete row of MCUs
+ *
+ * @note    The IDCT is the integer version of the Loeffler, Ligtenberg and
+ *          Moschytz algorithm (as in the jidctint.c of the IJG library), with
+ *          12 bit constants. Columns with only the DC coefficient are handled
+ *          without multiplications, which is the common case
+ *
+ * @note    Huffman codes of up to FASTBITS bits are decoded with a table. The
+ *          longer ones are found comparing with the largest code of each size
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "stm32f746xx.h"
+#include "lcd.h"
+#include "dma2d.h"
+#include "cache.h"
+#include "memsections.h"
+#include "jpeg.h"
+
+/**
+ * @brief   Width of the row buffers (multiple of the largest MCU width)
+ */
+#define STRIPWIDTH                  ((JPEG_MAXWIDTH+15)&~15)
+
+/**
+ * @brief   Bits decoded by table lookup
+ */
+#define FASTBITS                    9
+
+/**
+ * @brief   Markers
+ */
+///@{
+#define M_SOF0                      0xC0
+#define M_SOF1                      0xC1
+#define M_DHT                       0xC4
+#define M_RST0                      0xD0
+#define M_RST7                      0xD7
+#define M_SOI                       0xD8
+#define M_EOI                       0xD9
+#define M_SOS                       0xDA
+#define M_DQT                       0xDB
+#define M_DRI                       0xDD
+///@}
+
+/**
+ * @brief   Huffman table
+ *
+ * @note    maxcode[n] is the first code of size n not used, aligned to 16 bits.
+ *          delta[n] converts a code of size n into the index of its value
+ */
+typedef struct {
+    uint8_t     fast[1<<FASTBITS];          ///< index of the value or 255
+    uint8_t     values[256];
+    uint8_t     sizes[256];
+    uint32_t    maxcode[18];
+    int32_t     delta[17];
+    uint8_t     defined;
+} huffman;
+
+/**
+ * @brief   Component
+ */
+typedef struct {
+    uint8_t     id;
+    uint8_t     h;                          ///< sampling factors
+    uint8_t     v;
+    uint8_t     tq;                         ///< quantization table
+    uint8_t     td;                         ///< DC Huffman table
+    uint8_t     ta;                         ///< AC Huffman table
+    int         dcpred;
+} component;
+
+/**
+ * @brief   Decoder state
+ */
+typedef struct {
+    const uint8_t   *p;                     ///< next byte
+    const uint8_t   *end;
+    uint32_t        bits;                   ///< bit buffer, left aligned
+    int             nbits;
+    int             marker;                 ///< found in the entropy coded data
+    int             width;
+    int             height;
+    int             ncomp;
+    int             hmax;
+    int             vmax;
+    int             restart;                ///< MCUs between restart markers
+    unsigned        qdefined;
+    component       comp[3];
+    uint16_t        quant[4][64];           ///< in zigzag order
+    huffman         dc[2];
+    huffman         ac[2];
+} decoder;
+
+static decoder dec DTCM_BSS;
+
+/**
+ * @brief   Natural order of the coefficients in zigzag order
+ */
+static uint8_t zigzag[64] DTCM_DATA = {
+     0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+};
+
+/**
+ * @brief   Samples of the current MCU (Y up to 16x16, Cb and Cr 8x8)
+ */
+///@{
+static uint8_t ysamples[256] DTCM_BSS;
+static uint8_t cbsamples[64] DTCM_BSS;
+static uint8_t crsamples[64] DTCM_BSS;
+///@}
+
+/**
+ * @brief   Row buffers and the last DMA2D job reading each one
+ *
+ * @note    Aligned to cache lines, because DMA2D_Submit* cleans them from the
+ *          data cache
+ */
+///@{
+static uint16_t     stripbuf[2][STRIPWIDTH*16] CACHE_ALIGNED;
+static DMA2D_Fence  stripfence[2] = { 0, 0 };
+///@}
+
+static JPEG_Stats   stats;
+
+/**
+ * @brief   Output of a row of MCUs
+ *
+ * @note    Lines y to y+h-1 of the image are in row (pitch in pixels). Returns
+ *          the DMA2D job reading it or 0 when it was not queued
+ */
+typedef DMA2D_Fence (*rowoutput)(void *arg, const uint16_t *row, int pitch, int y, int h);
+
+/**
+ * @brief   Bit reader
+ *
+ * @note    Inline, since they are called by the ITCM code. Stuffed zeros after
+ *          0xFF are removed. When a marker is found, zeros are returned and the
+ *          marker is kept in dec.marker with p pointing to it
+ */
+///@{
+static inline __attribute__((always_inline)) void
+fill(decoder *d) {
+uint32_t c;
+
+    while( d->nbits <= 24 ) {
+        c = 0;
+        if( d->marker == 0 && d->p < d->end ) {
+            c = *d->p++;
+            if( c == 0xFF ) {
+                if( d->p < d->end && *d->p == 0x00 ) {
+                    d->p++;
+                } else {
+                    d->marker = d->p < d->end ? *d->p : M_EOI;
+                    d->p--;
+                    c = 0;
+                }
+            }
+        }
+        d->bits |= c<<(24-d->nbits);
+        d->nbits += 8;
+    }
+}
+
+static inline __attribute__((always_inline)) int
+getbits(decoder *d, int n) {
+uint32_t v;
+
+    if( d->nbits < n )
+        fill(d);
+    v = d->bits>>(32-n);
+    d->bits <<= n;
+    d->nbits -= n;
+    return (int) v;
+}
+
+/**
+ * @brief   Value of n bits with the sign coding of JPEG (EXTEND in the standard)
+ */
+static inline __attribute__((always_inline)) int
+extend(int v, int n) {
+
+    return v < (1<<(n-1)) ? v-(1<<n)+1 : v;
+}
+
+/**
+ * @brief   Decodes a Huffman coded value. Returns -1 for an invalid code
+ */
+static inline __attribute__((always_inline)) int
+decodehuffman(decoder *d, const huffman *h) {
+uint32_t top;
+int k,n;
+
+    if( d->nbits < 16 )
+        fill(d);
+    k = h->fast[d->bits>>(32-FASTBITS)];
+    if( k != 255 ) {
+        n = h->sizes[k];
+        d->bits <<= n;
+        d->nbits -= n;
+        return h->values[k];
+    }
+    top = d->bits>>16;
+    for(n=FASTBITS+1;top>=h->maxcode[n];n++) {}
+    if( n > 16 )
+        return -1;
+    k = (int) (d->bits>>(32-n))+h->delta[n];
+    d->bits <<= n;
+    d->nbits -= n;
+    return h->values[k];
+}
+///@}
+
+/**
+ * @brief   IDCT of a row or column
+ *
+ * @note    Fixed point with 12 fractional bits. Sets x0..x3 (even part) and
+ *          t0..t3 (odd part). The outputs are x0+t3, x1+t2, x2+t1, x3+t0,
+ *          x3-t0, x2-t1, x1-t2 and x0-t3
+ */
+#define FIX(X)                      ((int) ((X)*4096+0.5))
+#define IDCT_1D(S0,S1,S2,S3,S4,S5,S6,S7)                    \
+    p1 = ((S2)+(S6))*FIX(0.5411961);                        \
+    t2 = p1+(S6)*FIX(-1.847759065);                         \
+    t3 = p1+(S2)*FIX(0.765366865);                          \
+    t0 = ((S0)+(S4))*4096;                                  \
+    t1 = ((S0)-(S4))*4096;                                  \
+    x0 = t0+t3;                                             \
+    x3 = t0-t3;                                             \
+    x1 = t1+t2;                                             \
+    x2 = t1-t2;                                             \
+    t0 = (S7);                                              \
+    t1 = (S5);                                              \
+    t2 = (S3);                                              \
+    t3 = (S1);                                              \
+    p3 = t0+t2;                                             \
+    p4 = t1+t3;                                             \
+    p1 = t0+t3;                                             \
+    p2 = t1+t2;                                             \
+    p5 = (p3+p4)*FIX(1.175875602);                          \
+    t0 = t0*FIX(0.298631336);                               \
+    t1 = t1*FIX(2.053119869);                               \
+    t2 = t2*FIX(3.072711026);                               \
+    t3 = t3*FIX(1.501321110);                               \
+    p1 = p5+p1*FIX(-0.899976223);                           \
+    p2 = p5+p2*FIX(-2.562915447);                           \
+    p3 = p3*FIX(-1.961570560);                              \
+    p4 = p4*FIX(-0.390180644);                              \
+    t3 += p1+p4;                                            \
+    t2 += p2+p3;                                            \
+    t1 += p2+p4;                                            \
+    t0 += p1+p3
+
+static inline __attribute__((always_inline)) uint8_t
+clamp(int v) {
+
+    if( (unsigned) v > 255 )
+        return v < 0 ? 0 : 255;
+    return (uint8_t) v;
+}
+
+/**
+ * @brief   idct
+ *
+ * @note    Converts the dequantized coefficients (natural order) into 8x8
+ *          samples with stride bytes per line. The coefficients are changed
+ */
+ITCM_CODE static void
+idct(int *coef, uint8_t *out, int stride) {
+int t0,t1,t2,t3,p1,p2,p3,p4,p5,x0,x1,x2,x3;
+int *c;
+int i,dc;
+
+    // Columns, results scaled by 2^2 (10 bits of the 12 removed)
+    for(i=0,c=coef;i<8;i++,c++) {
+        if( (c[8]|c[16]|c[24]|c[32]|c[40]|c[48]|c[56]) == 0 ) {
+            dc = c[0]*4;
+            c[0] = c[8] = c[16] = c[24] = c[32] = c[40] = c[48] = c[56] = dc;
+            continue;
+        }
+        IDCT_1D(c[0],c[8],c[16],c[24],c[32],c[40],c[48],c[56]);
+        x0 += 512; x1 += 512; x2 += 512; x3 += 512;
+        c[0]  = (x0+t3)>>10;
+        c[56] = (x0-t3)>>10;
+        c[8]  = (x1+t2)>>10;
+        c[48] = (x1-t2)>>10;
+        c[16] = (x2+t1)>>10;
+        c[40] = (x2-t1)>>10;
+        c[24] = (x3+t0)>>10;
+        c[32] = (x3-t0)>>10;
+    }
+
+    // Rows, scaled back by 2^(12+2+3) with rounding and the level shift (+128)
+    for(i=0,c=coef;i<8;i++,c+=8,out+=stride) {
+        IDCT_1D(c[0],c[1],c[2],c[3],c[4],c[5],c[6],c[7]);
+        x0 += 65536+(128<<17);
+        x1 += 65536+(128<<17);
+        x2 += 65536+(128<<17);
+        x3 += 65536+(128<<17);
+        out[0] = clamp((x0+t3)>>17);
+        out[7] = clamp((x0-t3)>>17);
+        out[1] = clamp((x1+t2)>>17);
+        out[6] = clamp((x1-t2)>>17);
+        out[2] = clamp((x2+t1)>>17);
+        out[5] = clamp((x2-t1)>>17);
+        out[3] = clamp((x3+t0)>>17);
+        out[4] = clamp((x3-t0)>>17);
+    }
+}
+
+/**
+ * @brief   Limits a coefficient to 12 bits
+ *
+ * @note    Coefficients of 8 bit samples are in this range. It only matters for
+ *          corrupted data, which would overflow the IDCT
+ */
+static inline __attribute__((always_inline)) int
+limit(int v) {
+
+    return v < -2048 ? -2048 : v > 2047 ? 2047 : v;
+}
+
+/**
+ * @brief   decodeblock
+ *
+ * @note    Decodes the coefficients of a block of the component, dequantizes
+ *          them and transforms them into out. Returns -1 when the data is
+ *          corrupted
+ */
+ITCM_CODE static int
+decodeblock(decoder *d, component *cp, uint8_t *out, int stride) {
+const huffman *ac = &d->ac[cp->ta];
+const uint16_t *q = d->quant[cp->tq];
+int coef[64];
+int k,s,r;
+
+    for(k=0;k<64;k++)
+        coef[k] = 0;
+
+    s = decodehuffman(d,&d->dc[cp->td]);
+    if( s < 0 || s > 11 )
+        return -1;
+    if( s )
+        cp->dcpred = limit(cp->dcpred+extend(getbits(d,s),s));
+    coef[0] = limit(cp->dcpred*q[0]);
+
+    for(k=1;k<64;k++) {
+        s = decodehuffman(d,ac);
+        if( s < 0 )
+            return -1;
+        r = s>>4;
+        s &= 15;
+        if( s == 0 ) {
+            if( r != 15 )
+                break;                      // end of block
+            k += 15;                        // 16 zeros
+            continue;
+        }
+        k += r;
+        if( k > 63 || s > 10 )
+            return -1;
+        coef[zigzag[k]] = limit(extend(getbits(d,s),s)*q[k]);
+    }
+    idct(coef,out,stride);
+    return 0;
+}
+
+/**
+ * @brief   colorconvert
+ *
+ * @note    Converts the samples of the MCU (w x h pixels) into RGB565 at row
+ *          (pitch in pixels). Chroma samples are replicated hs x vs times
+ *
+ * @note    R = Y+1.402(Cr-128), G = Y-0.344(Cb-128)-0.714(Cr-128),
+ *          B = Y+1.772(Cb-128), with 16 fractional bits
+ */
+ITCM_CODE static void
+colorconvert(const decoder *d, uint16_t *row, int pitch, int w, int h) {
+const uint8_t *yp;
+uint16_t *o;
+int x,y,i,j,hs,vs,yy;
+int cb,cr,rc,gc,bc;
+int r,g,b;
+
+    if( d->ncomp == 1 ) {
+        for(y=0;y<8;y++) {
+            for(x=0;x<8;x++) {
+                g = ysamples[y*8+x];
+                row[y*pitch+x] = ((g>>3)<<11)|((g>>2)<<5)|(g>>3);
+            }
+        }
+        return;
+    }
+
+    hs = d->hmax;
+    vs = d->vmax;
+    for(y=0;y<h;y+=vs) {
+        for(x=0;x<w;x+=hs) {
+            cb = cbsamples[(y/vs)*8+x/hs]-128;
+            cr = crsamples[(y/vs)*8+x/hs]-128;
+            rc = (cr*91881+32768)>>16;
+            gc = (-cb*22554-cr*46802+32768)>>16;
+            bc = (cb*116130+32768)>>16;
+            for(j=0;j<vs;j++) {
+                yp = &ysamples[(y+j)*w+x];
+                o  = &row[(y+j)*pitch+x];
+                for(i=0;i<hs;i++) {
+                    yy = yp[i];
+                    r = clamp(yy+rc);
+                    g = clamp(yy+gc);
+                    b = clamp(yy+bc);
+                    o[i] = ((r>>3)<<11)|((g>>2)<<5)|(b>>3);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief   decodemcu
+ *
+ * @note    Decodes a MCU into the samples. The Y blocks are placed in a plane
+ *          of 8*hmax samples per line
+ */
+ITCM_CODE static int
+decodemcu(decoder *d) {
+component *cp;
+int bx,by,w;
+
+    if( d->ncomp == 1 )
+        return decodeblock(d,&d->comp[0],ysamples,8);
+
+    cp = &d->comp[0];
+    w  = 8*cp->h;
+    for(by=0;by<cp->v;by++) {
+        for(bx=0;bx<cp->h;bx++) {
+            if( decodeblock(d,cp,ysamples+by*8*w+bx*8,w) < 0 )
+                return -1;
+        }
+    }
+    if( decodeblock(d,&d->comp[1],cbsamples,8) < 0 )
+        return -1;
+    return decodeblock(d,&d->comp[2],crsamples,8);
+}
+
+/**
+ * @brief   Big endian 16 bit value
+ */
+static inline int
+get16(const uint8_t *p) {
+
+    return (p[0]<<8)|p[1];
+}
+
+/**
+ * @brief   buildhuffman
+ *
+ * @note    Builds the table from the number of codes of each size (counts) and
+ *          the values in order of code. Returns -1 when the codes do not fit
+ */
+static int
+buildhuffman(huffman *h, const uint8_t *counts, const uint8_t *values) {
+uint16_t codes[256];
+uint32_t code = 0;
+int n,i,k = 0,m;
+
+    for(n=1;n<=16;n++) {
+        h->delta[n] = k-(int) code;
+        for(i=0;i<counts[n-1];i++) {
+            if( k >= 256 )
+                return -1;
+            h->values[k] = values[k];
+            h->sizes[k]  = n;
+            codes[k++]   = code++;
+        }
+        if( code > (1U<<n) )
+            return -1;
+        h->maxcode[n] = code<<(16-n);
+        code <<= 1;
+    }
+    h->maxcode[17] = 0xFFFFFFFF;
+
+    for(i=0;i<(1<<FASTBITS);i++)
+        h->fast[i] = 255;
+    for(i=0;i<k;i++) {
+        n = h->sizes[i];
+        if( n > FASTBITS )
+            continue;
+        m = 1<<(FASTBITS-n);
+        code = codes[i]<<(FASTBITS-n);
+        while( m-- > 0 )
+            h->fast[code++] = i;
+    }
+    h->defined = 1;
+    return 0;
+}
+
+/**
+ * @brief   parseheaders
+ *
+ * @note    Parses the markers up to the start of scan and leaves p at the
+ *          entropy coded data
+ */
+static int
+parseheaders(decoder *d, const JPEG_Asset *img) {
+const uint8_t *p = img->data;
+const uint8_t *end = img->data+img->size;
+const uint8_t *seg,*segend;
+component *cp;
+int m,len,i,j,n;
+
+    d->ncomp    = 0;
+    d->restart  = 0;
+    d->qdefined = 0;
+    d->dc[0].defined = d->dc[1].defined = 0;
+    d->ac[0].defined = d->ac[1].defined = 0;
+
+    if( img->size < 4 || p[0] != 0xFF || p[1] != M_SOI )
+        return JPEG_ERROR_FORMAT;
+    p += 2;
+
+    for(;;) {
+        // Markers may be preceded by fill bytes (0xFF)
+        if( p >= end || *p != 0xFF )
+            return JPEG_ERROR_DATA;
+        while( p < end && *p == 0xFF )
+            p++;
+        if( p >= end )
+            return JPEG_ERROR_DATA;
+        m = *p++;
+        if( m == M_EOI || (m >= M_RST0 && m <= M_RST7) )
+            return JPEG_ERROR_DATA;
+        if( end-p < 2 )
+            return JPEG_ERROR_DATA;
+        len = get16(p);
+        if( len < 2 || end-p < len )
+            return JPEG_ERROR_DATA;
+        seg    = p+2;
+        segend = p+len;
+        p      = segend;
+
+        switch(m) {
+        case M_SOF0:
+        case M_SOF1:
+            if( segend-seg < 6 || seg[0] != 8 )
+                return JPEG_ERROR_FORMAT;
+            d->height = get16(seg+1);
+            d->width  = get16(seg+3);
+            d->ncomp  = seg[5];
+            seg += 6;
+            if( d->width == 0 || d->height == 0 )
+                return JPEG_ERROR_FORMAT;       // no DNL
+            if( (d->ncomp != 1 && d->ncomp != 3) || segend-seg < 3*d->ncomp )
+                return JPEG_ERROR_FORMAT;
+            for(i=0;i<d->ncomp;i++,seg+=3) {
+                cp = &d->comp[i];
+                cp->id = seg[0];
+                cp->h  = seg[1]>>4;
+                cp->v  = seg[1]&15;
+                cp->tq = seg[2];
+                if( cp->tq > 3 || cp->h < 1 || cp->h > 2 || cp->v < 1 || cp->v > 2 )
+                    return JPEG_ERROR_FORMAT;
+                if( i > 0 && (cp->h != 1 || cp->v != 1) )
+                    return JPEG_ERROR_FORMAT;
+            }
+            if( d->ncomp == 1 )
+                d->comp[0].h = d->comp[0].v = 1;    // a block per MCU
+            d->hmax = d->comp[0].h;
+            d->vmax = d->comp[0].v;
+            break;
+
+        case M_DHT:
+            while( seg < segend ) {
+                if( segend-seg < 17 || (seg[0]>>4) > 1 || (seg[0]&15) > 1 )
+                    return JPEG_ERROR_FORMAT;
+                for(i=0,n=0;i<16;i++)
+                    n += seg[1+i];
+                if( n > 256 || segend-seg < 17+n )
+                    return JPEG_ERROR_DATA;
+                if( buildhuffman((seg[0]>>4) ? &d->ac[seg[0]&15] : &d->dc[seg[0]&15],
+                                  seg+1,seg+17) < 0 )
+                    return JPEG_ERROR_DATA;
+                seg += 17+n;
+            }
+            break;
+
+        case M_DQT:
+            while( seg < segend ) {
+                if( (seg[0]>>4) != 0 || (seg[0]&15) > 3 )
+                    return JPEG_ERROR_FORMAT;  // 16 bit tables are not baseline
+                if( segend-seg < 65 )
+                    return JPEG_ERROR_DATA;
+                for(j=0;j<64;j++)
+                    d->quant[seg[0]&15][j] = seg[1+j];
+                d->qdefined |= 1U<<(seg[0]&15);
+                seg += 65;
+            }
+            break;
+
+        case M_DRI:
+            if( segend-seg < 2 )
+                return JPEG_ERROR_DATA;
+            d->restart = get16(seg);
+            break;
+
+        case M_SOS:
+            if( d->ncomp == 0 || segend-seg < 1 || seg[0] != d->ncomp )
+                return JPEG_ERROR_FORMAT;   // only one interleaved scan
+            n = seg[0];
+            seg++;
+            if( segend-seg < 2*n+3 )
+                return JPEG_ERROR_DATA;
+            for(i=0;i<n;i++,seg+=2) {
+                for(j=0;j<d->ncomp && d->comp[j].id != seg[0];j++) {}
+                if( j != i )
+                    return JPEG_ERROR_FORMAT;
+                cp = &d->comp[j];
+                cp->td = seg[1]>>4;
+                cp->ta = seg[1]&15;
+                if( cp->td > 1 || cp->ta > 1 || !d->dc[cp->td].defined
+                        || !d->ac[cp->ta].defined || !(d->qdefined&(1U<<cp->tq)) )
+                    return JPEG_ERROR_FORMAT;
+                cp->dcpred = 0;
+            }
+            if( seg[0] != 0 || seg[1] != 63 || seg[2] != 0 )
+                return JPEG_ERROR_FORMAT;   // progressive
+            d->p      = segend;
+            d->end    = end;
+            d->bits   = 0;
+            d->nbits  = 0;
+            d->marker = 0;
+            return JPEG_OK;
+
+        default:
+            if( (m >= 0xC2 && m <= 0xCF) && m != M_DHT && m != 0xC8 && m != 0xCC )
+                return JPEG_ERROR_FORMAT;   // progressive, lossless or arithmetic
+            break;                          // APPn, COM, ...
+        }
+    }
+}
+
+/**
+ * @brief   restartinterval
+ *
+ * @note    Skips to the data after the next restart marker and resets the
+ *          predictors
+ */
+static int
+restartinterval(decoder *d) {
+const uint8_t *p = d->p;
+int i;
+
+    while( p+1 < d->end && !(p[0] == 0xFF && p[1] >= M_RST0 && p[1] <= M_RST7) )
+        p++;
+    if( p+1 >= d->end )
+        return -1;
+    d->p      = p+2;
+    d->bits   = 0;
+    d->nbits  = 0;
+    d->marker = 0;
+    for(i=0;i<d->ncomp;i++)
+        d->comp[i].dcpred = 0;
+    return 0;
+}
+
+/**
+ * @brief   decode
+ *
+ * @note    Decodes the rows of MCUs with lines up to maxlines-1 and passes them
+ *          to out. The two row buffers are used alternately. A buffer is reused
+ *          only after its DMA2D job ended
+ */
+static int
+decode(const JPEG_Asset *img, int maxlines, rowoutput out, void *arg) {
+decoder *d = &dec;
+uint32_t start,t;
+int mcuw,mcuh,mcusx,mcusy;
+int mx,my,rc,h;
+int count = 0;
+static int cur = 0;
+
+    start = DWT->CYCCNT;
+    stats.waitcycles = 0;
+    stats.mcus       = 0;
+    stats.blocks     = 0;
+
+    rc = parseheaders(d,img);
+    if( rc < 0 )
+        return rc;
+    if( d->width != img->width || d->height != img->height )
+        return JPEG_ERROR_DATA;
+    mcuw  = 8*d->hmax;
+    mcuh  = 8*d->vmax;
+    mcusx = (d->width+mcuw-1)/mcuw;
+    mcusy = (d->height+mcuh-1)/mcuh;
+    if( mcusx*mcuw > STRIPWIDTH )
+        return JPEG_ERROR_SIZE;
+    if( maxlines > d->height )
+        maxlines = d->height;
+
+    for(my=0;my<mcusy && my*mcuh<maxlines;my++) {
+        if( stripfence[cur] ) {
+            t = DWT->CYCCNT;
+            DMA2D_WaitFence(stripfence[cur]);
+            stats.waitcycles += DWT->CYCCNT-t;
+            stripfence[cur] = 0;
+        }
+        for(mx=0;mx<mcusx;mx++) {
+            if( d->restart && count == d->restart ) {
+                if( restartinterval(d) < 0 )
+                    return JPEG_ERROR_DATA;
+                count = 0;
+            }
+            if( decodemcu(d) < 0 )
+                return JPEG_ERROR_DATA;
+            colorconvert(d,stripbuf[cur]+mx*mcuw,STRIPWIDTH,mcuw,mcuh);
+            count++;
+        }
+        stats.mcus += mcusx;
+        h = d->height-my*mcuh;
+        if( h > mcuh )
+            h = mcuh;
+        stripfence[cur] = out(arg,stripbuf[cur],STRIPWIDTH,my*mcuh,h);
+        cur ^= 1;
+    }
+    stats.blocks = stats.mcus*(d->ncomp == 1 ? 1 : d->hmax*d->vmax+2);
+    stats.cycles = DWT->CYCCNT-start;
+    return JPEG_OK;
+}
+
+/**
+ * @brief   JPEG_GetInfo
+ *
+ * @note    Returns JPEG_OK and the size and number of components of the image
+ *          or an error when it can not be decoded. Pointers may be null
+ */
+int
+JPEG_GetInfo(const JPEG_Asset *img, int *width, int *height, int *components) {
+int rc;
+
+    rc = parseheaders(&dec,img);
+    if( rc < 0 )
+        return rc;
+    if( width )
+        *width = dec.width;
+    if( height )
+        *height = dec.height;
+    if( components )
+        *components = dec.ncomp;
+    return JPEG_OK;
+}
+
+/**
+ * @brief   Output to a buffer in memory (JPEG_Decode)
+ */
+///@{
+typedef struct {
+    uint16_t    *dst;
+    int         pitch;                      // in bytes
+    int         width;
+} bufferoutput;
+
+static DMA2D_Fence
+tobuffer(void *arg, const uint16_t *row, int pitch, int y, int h) {
+bufferoutput *b = arg;
+uint16_t *q;
+int i,j;
+
+    for(j=0;j<h;j++) {
+        q = (uint16_t *) ((char *) b->dst+(y+j)*b->pitch);
+        for(i=0;i<b->width;i++)
+            q[i] = row[j*pitch+i];
+    }
+    return 0;
+}
+///@}
+
+/**
+ * @brief   JPEG_Decode
+ *
+ * @note    Decodes the whole image into dst (pitch bytes per line) in RGB565.
+ *          Returns JPEG_OK or an error
+ */
+int
+JPEG_Decode(const JPEG_Asset *img, uint16_t *dst, int pitch) {
+bufferoutput b;
+
+    b.dst   = dst;
+    b.pitch = pitch;
+    b.width = img->width;
+    return decode(img,img->height,tobuffer,&b);
+}
+
+/**
+ * @brief   Output to a layer (JPEG_Draw)
+ */
+///@{
+typedef struct {
+    char        *base;                      // line 0 of the layer
+    int         format;
+    int         pitch;
+    int         x;                          // position of the image
+    int         y;
+    int         cx;                         // visible area of the image
+    int         cy;
+    int         w;
+    int         h;
+    int         error;
+} layeroutput;
+
+static DMA2D_Fence
+tolayer(void *arg, const uint16_t *row, int pitch, int y, int h) {
+layeroutput *l = arg;
+DMA2D_Fence f;
+int y0,y1;
+
+    y0 = y < l->cy ? l->cy : y;
+    y1 = y+h > l->cy+l->h ? l->cy+l->h : y+h;
+    if( y1 <= y0 )
+        return 0;
+
+    DECLARE_REGION(fg,row,l->cx,y0-y,l->w,y1-y0,LCD_FORMAT_RGB565,pitch*2);
+    DECLARE_REGION(bg,l->base,l->x+l->cx,l->y+y0,l->w,y1-y0,l->format,l->pitch);
+    // Wait for a free entry when the queue is full
+    for(;;) {
+        f = DMA2D_SubmitCopy(&fg,&bg,0,0);
+        if( f || DMA2D_IsIdle() )
+            break;
+    }
+    if( f == 0 )
+        l->error = 1;
+    return f;
+}
+///@}
+
+/**
+ * @brief   JPEG_Draw
+ *
+ * @note    Draws the image with the top left corner at (x,y). It is clipped to
+ *          the layer. Lines below the layer are not decoded
+ *
+ * @note    Returns the number of lines queued or an error. Use LCD_WaitDrawing
+ *          before the CPU accesses the area
+ */
+int
+JPEG_Draw(int layer, const JPEG_Asset *img, int x, int y) {
+layeroutput l;
+int lw,lh,rc;
+
+    l.format = LCD_GetFormat(layer);
+    if( l.format > LCD_FORMAT_ARGB4444 )
+        return JPEG_ERROR_LAYER;
+    l.base  = (char *) LCD_GetLineAddress(layer,0);
+    l.pitch = LCD_GetPitch(layer);
+    lw      = LCD_GetWidth(layer);
+    lh      = LCD_GetHeight(layer);
+
+    l.x  = x;
+    l.y  = y;
+    l.cx = x < 0 ? -x : 0;
+    l.w  = (x+img->width > lw ? lw-x : img->width)-l.cx;
+    l.cy = y < 0 ? -y : 0;
+    l.h  = (y+img->height > lh ? lh-y : img->height)-l.cy;
+    l.error = 0;
+    if( l.w <= 0 || l.h <= 0 )
+        return 0;
+
+    rc = decode(img,l.cy+l.h,tolayer,&l);
+    if( rc < 0 )
+        return rc;
+    if( l.error )
+        return JPEG_ERROR_DMA2D;
+    LCD_AddDamage(layer,x+l.cx,y+l.cy,l.w,l.h);
+    return l.h;
+}
+
+/**
+ * @brief   JPEG_GetStats
+ */
+void
+JPEG_GetStats(JPEG_Stats *st) {
+
+    *st = stats;
+}
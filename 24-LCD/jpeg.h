@@ -0,0 +1,84 @@
+#ifndef JPEG_H
+#define JPEG_H
+/**
+ * @file    jpeg.h
+ *
+ * @note    Baseline JPEG images drawn with DMA2D
+ *
+ * @note    The STM32F746 has no JPEG codec and its DMA2D has no YCbCr input
+ *          format (both came with the STM32F76x). The decoding, including the
+ *          color conversion, is done by the CPU, one MCU (minimum coded unit,
+ *          8x8 to 16x16 pixels) at a time, into a row of MCUs in RGB565. When
+ *          the row is complete, a DMA2D job copies it into the layer, converting
+ *          it to the layer format, while the next row is decoded into a second
+ *          buffer (as Image_Draw does with RLE images)
+ *
+ * @note    The Huffman decoder, the IDCT and the color conversion are in ITCM
+ *          and their tables in DTCM
+ *
+ * @note    Supported: baseline and extended sequential Huffman coding (SOF0 and
+ *          SOF1) with 8 bit samples, grayscale or YCbCr with the chroma
+ *          sampled 1x1, 2x1 or 2x2 (4:4:4, 4:2:2, 4:2:0) and restart markers.
+ *          Not supported: progressive and arithmetic coding, 12 bit samples.
+ *          Chroma is upsampled by replication
+ *
+ * @note    Images are generated by tools/jpgconv (make jpgconv) as C files with
+ *          a const JPEG_Asset. The data can be in the internal flash or in any
+ *          memory mapped area (QSPI flash in memory mapped mode, SDRAM)
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Maximal width of the images
+ *
+ * @note    The two buffers have a row of MCUs each: 2 x (480+15) x 16 x 2 bytes
+ */
+#ifndef JPEG_MAXWIDTH
+#define JPEG_MAXWIDTH               480
+#endif
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define JPEG_OK                     (0)
+#define JPEG_ERROR_FORMAT           (-1)    ///< not a JPEG or not supported
+#define JPEG_ERROR_DATA             (-2)    ///< corrupted
+#define JPEG_ERROR_SIZE             (-3)    ///< wider than JPEG_MAXWIDTH
+#define JPEG_ERROR_LAYER            (-4)    ///< layer format not writable by DMA2D
+#define JPEG_ERROR_DMA2D            (-5)
+///@}
+
+/**
+ * @brief   Image
+ */
+typedef struct {
+    uint16_t        width;                  ///< in pixels
+    uint16_t        height;                 ///< in lines
+    uint32_t        size;                   ///< bytes in data
+    const uint8_t   *data;                  ///< JPEG file
+} JPEG_Asset;
+
+/**
+ * @brief   Measurements of the last call to JPEG_Decode or JPEG_Draw
+ *
+ * @note    Cycles of the DWT counter. waitcycles is the time spent waiting
+ *          for a buffer still being copied by DMA2D
+ */
+typedef struct {
+    uint32_t        cycles;                 ///< total, parsing included
+    uint32_t        waitcycles;
+    uint32_t        mcus;
+    uint32_t        blocks;                 ///< 8x8 blocks decoded
+} JPEG_Stats;
+
+int  JPEG_GetInfo(const JPEG_Asset *img, int *width, int *height, int *components);
+int  JPEG_Decode(const JPEG_Asset *img, uint16_t *dst, int pitch);
+int  JPEG_Draw(int layer, const JPEG_Asset *img, int x, int y);
+void JPEG_GetStats(JPEG_Stats *stats);
+
+#endif // JPEG_H
@@ -5,9 +5,21 @@
  * @author  Hans
  */
 
+#include <string.h>
+
 #include "stm32f746xx.h"
 #include "system_stm32f746.h"
 #include "lcd.h"
+#include "profile.h"
+#include "memsections.h"
+#include "dma2d.h"
+#include "buddy.h"
+#include "pixops.h"
+#include "sdram.h"
+#include "cache.h"
+#ifdef USE_PLLCONFIG
+#include "pllconfig.h"
+#endif
 
 
 #define BIT(N)          (1U<<(N))
@@ -28,6 +40,57 @@
 
 ///@}
 
+/**
+ * @brief   Hardware acceleration of fills (DMA2D)
+ *
+ * @note    LCD_ACCEL_DEFAULT is the setting of all layers after LCD_Init. It can
+ *          be changed for each layer by LCD_SetAcceleration
+ *
+ * @note    Rectangles with less than LCD_ACCEL_MINPIXELS pixels are filled by the
+ *          CPU. The setup of the DMA2D costs more than a short span. Lists of
+ *          spans (LCD_FillSpans) use the DMA2D when the average span has at
+ *          least LCD_ACCEL_MINSPAN pixels
+ *
+ * @note    DMA2D can only write ARGB8888, RGB888, RGB565, ARGB1555 and ARGB4444.
+ *          Layers in other formats always use the CPU
+ */
+///@{
+#ifndef LCD_ACCEL_DEFAULT
+#define LCD_ACCEL_DEFAULT       1
+#endif
+#ifndef LCD_ACCEL_MINPIXELS
+#define LCD_ACCEL_MINPIXELS     64
+#endif
+#ifndef LCD_ACCEL_MINSPAN
+#define LCD_ACCEL_MINSPAN       32
+#endif
+static int accelerated[3] = { 0, 0, 0 };
+///@}
+
+/**
+ * @brief   Frame buffers in internal SRAM (LCD_SetSRAMFrameBuffer)
+ *
+ * @note    LCD_SRAMFBSIZE bytes are reserved in section .sram_lcd, at the start
+ *          of SRAM1. It must be a power of 2 (at most 64 KB), because the area
+ *          is a MPU region. 0 (default) reserves nothing
+ *
+ * @note    Layer 1 takes its buffer from the start of the area and layer 2 from
+ *          the end, so each one can be set again without fragmentation
+ */
+///@{
+#ifndef LCD_SRAMFBSIZE
+#define LCD_SRAMFBSIZE          0
+#endif
+#if LCD_SRAMFBSIZE > 0
+#if (LCD_SRAMFBSIZE&(LCD_SRAMFBSIZE-1)) != 0 || LCD_SRAMFBSIZE > 65536 || LCD_SRAMFBSIZE < 32
+#error LCD_SRAMFBSIZE must be a power of 2 between 32 and 65536
+#endif
+static uint8_t sramfb[LCD_SRAMFBSIZE] SRAM_LCD __attribute__((aligned(LCD_SRAMFBSIZE)));
+static uint32_t sramfbused[3] = { 0, 0, 0 };
+static int sramfbmpu = 0;
+#endif
+///@}
+
 /*
  * @brief   LCD Connection
  *
@@ -133,6 +196,8 @@ typedef struct {
     uint16_t    hbp;                /// Horizontal back porch  (unit is LCD_CLK Period)
     uint16_t    vfp;                /// Vertical front porch (unit is HSYNC Period)
     uint16_t    vbp;                /// Vertical back porch (unit is HSYNC Period)
+    uint16_t    maxhtotal;          /// Maximal HSYNC period (unit is LCD_CLK Period)
+    uint16_t    maxvtotal;          /// Maximal VSYNC period (unit is HSYNC Period)
     uint16_t    pitch[5];           /// Pitch used to store lines in memory (in bytes)
                                     /// For 1,2,3,4 bytes (Position 0 not used)
 
@@ -154,6 +219,8 @@ const DisplayProperties_t dispRK043 = {
     .hbp        =   13,             // or 40
     .vfp        =   2,              // or 4
     .vbp        =   2,              // or 12
+    .maxhtotal  =   605,            //
+    .maxvtotal  =   335,            //
     .pitch      = { 0,              // Position not used!!!!
                     512,            // L8 and other 1 byte representation
                     1024,           // RGB565 and other 2 bytes representation
@@ -175,15 +242,35 @@ const DisplayProperties_t *display = &dispRK043;
 #define LCD_FREQ    (display->frequency)
 #define HSW         (display->hsync)
 #define HAW         (display->width)
-#define HFP         (display->hfp)
+#define HFP         (timing.hfp)
 #define HBP         (display->hbp)
 #define VSH         (display->vsync)
 #define VAH         (display->height)
 #define VBP         (display->vbp)
-#define VFP         (display->vfp)
+#define VFP         (timing.vfp)
 #define POL         (display->polarity)
+#define HTOTAL      (HSW+HBP+HAW+HFP)
+#define VTOTAL      (VSH+VBP+VAH+VFP)
 ///@}
 
+/**
+ * @brief   Timing that can change at run time
+ *
+ * @note    LCD_SetRefreshRate lengthens the front porches of the display. The
+ *          pixel clock is the one set by LCD_SetClock
+ */
+static struct {
+    uint16_t    hfp;
+    uint16_t    vfp;
+    uint32_t    pixelclock;
+} timing = { 0, 0, 0 };
+
+/**
+ * @brief   LTDC errors counted by LCD_TFT_ER_IRQHandler
+ */
+static volatile uint32_t fifounderruns = 0;
+static volatile uint32_t transfererrors = 0;
+
 static const int pixelsize[] = {
         4,  // 000: ARGB8888
         3,  // 001: RGB888
@@ -693,6 +780,13 @@ void  LCD_Off(void) {
  */
 static int  LCDCLOCK_Initialized = 0;
 
+#ifdef USE_PLLCONFIG
+/**
+ * @brief   PLLSAI configuration and PLLSAIDIVR found by tools/mkpll (pllconfig.h)
+ */
+static const PLLConfiguration_t PLLSAIConfiguration = PLLCONFIG_SAI;
+#endif
+
 /**
  * @brief   Set Clock for LCD
  *
@@ -700,10 +794,19 @@ static int  LCDCLOCK_Initialized = 0;
  */
 int LCD_SetClock(void) {
 uint32_t pllsaidivr;
+#ifndef USE_PLLCONFIG
 int div;
 PLLOutputFrequencies_t pllfreq;
+#endif
 
-
+#ifdef USE_PLLCONFIG
+    if( ! (RCC->CR&RCC_CR_PLLSAION) ) {
+        SystemConfigPLLSAI(&PLLSAIConfiguration);
+        SystemEnablePLLSAI();
+    }
+    pllsaidivr = PLLCONFIG_PLLSAIDIVR;
+    timing.pixelclock = PLLCONFIG_LCDCLK;
+#else
     if( ! (RCC->CR&RCC_CR_PLLSAION) ) {
         SystemConfigPLLSAI(&PLLSAIConfiguration_48MHz);
         SystemEnablePLLSAI();
@@ -721,6 +824,8 @@ PLLOutputFrequencies_t pllfreq;
     default:
         return -2; // ignore wrong divisor
     }
+    timing.pixelclock = pllfreq.routfreq/div;
+#endif
 
     // Configure divisor for LCD controller
     RCC->DCKCFGR1 = (RCC->DCKCFGR1&~RCC_DCKCFGR1_PLLSAIDIVR)
@@ -766,6 +871,9 @@ void LCD_Init(void) {
 
     // Reset LCD
 
+    timing.hfp = display->hfp;
+    timing.vfp = display->vfp;
+
     // configure polarity of control signals
     LTDC->GCR =   (LTDC->GCR&~(LTDC_GCR_DEPOL|LTDC_GCR_HSPOL|LTDC_GCR_VSPOL|LTDC_GCR_PCPOL))
                  |(POL);
@@ -785,6 +893,23 @@ void LCD_Init(void) {
     /* Enable interrupts */
     //LTDC->IER  |= (LTDC_IER_RRIE|LTDC_IER_TERRIE|LTDC_IER_FUIE|LTDC_IER_LIE);
 
+    /* Count FIFO underruns and transfer errors */
+    fifounderruns  = 0;
+    transfererrors = 0;
+    LTDC->ICR  = LTDC_ICR_CFUIF|LTDC_ICR_CTERRIF;
+    LTDC->IER |= LTDC_IER_FUIE|LTDC_IER_TERRIE;
+    NVIC_SetPriority(LTDC_ER_IRQn,LCD_IRQLEVEL);
+    NVIC_EnableIRQ(LTDC_ER_IRQn);
+
+#if LCD_REFRESH > 0
+    LCD_SetRefreshRate(LCD_REFRESH);
+#endif
+
+    /* DMA2D for fills */
+    DMA2D_Init();
+    for(int i=0;i<3;i++)
+        accelerated[i] = LCD_ACCEL_DEFAULT;
+
 
     LCD_PutDisplayOperation();
     LCD_TurnBacklightOn();
@@ -792,6 +917,156 @@ void LCD_Init(void) {
 }
 
 
+/**
+ * @brief   LCD_SetRefreshRate
+ *
+ * @note    Sets the refresh rate to hz (or the nearest possible) by adding
+ *          lines to the vertical front porch and, when the panel does not accept
+ *          more lines, clocks to the horizontal front porch. A rate higher than
+ *          the one given by the datasheet timing needs a faster pixel clock
+ *          (PLLTARGETS in the Makefile)
+ *
+ * @note    A lower rate reduces the SDRAM bandwidth used by the LTDC in the same
+ *          proportion. The frame being scanned can be irregular
+ *
+ * @note    hz = 0 restores the datasheet timing
+ *
+ * @note    Returns 0 or -1 when hz is above the rate of the datasheet timing or
+ *          the clock is not set
+ */
+int
+LCD_SetRefreshRate(unsigned hz) {
+uint32_t frame,h0,v0,htotal,vtotal;
+
+    if( timing.pixelclock == 0 )
+        return -1;
+
+    h0 = HSW+HBP+HAW+display->hfp;
+    v0 = VSH+VBP+VAH+display->vfp;
+    htotal = h0;
+    vtotal = v0;
+    if( hz > 0 ) {
+        frame = timing.pixelclock/hz;
+        if( frame < h0*v0 )
+            return -1;
+        vtotal = frame/h0;
+        if( vtotal > display->maxvtotal ) {
+            vtotal = display->maxvtotal;
+            htotal = frame/vtotal;
+            if( htotal > display->maxhtotal )
+                htotal = display->maxhtotal;
+        }
+    }
+    timing.hfp = display->hfp+htotal-h0;
+    timing.vfp = display->vfp+vtotal-v0;
+
+    LTDC->TWCR  = ((HTOTAL-1)<<LTDC_TWCR_TOTALW_Pos)
+                 |((VTOTAL-1)<<LTDC_TWCR_TOTALH_Pos);
+    return 0;
+}
+
+/**
+ * @brief   LCD_GetRefreshRate
+ *
+ * @note    Refresh rate computed from the pixel clock and the timing, in 1/100 Hz
+ */
+unsigned
+LCD_GetRefreshRate(void) {
+
+    if( timing.pixelclock == 0 || HFP == 0 )
+        return 0;
+    return (unsigned) (((uint64_t) timing.pixelclock*100)/(HTOTAL*VTOTAL));
+}
+
+/**
+ * @brief   LCD_MeasureRefreshRate
+ *
+ * @note    Counts the vertical synchronization pulses during ms milliseconds
+ *          (busy wait with the cycle counter). Returns 1/100 Hz
+ */
+unsigned
+LCD_MeasureRefreshRate(unsigned ms) {
+uint32_t start,cycles,n;
+int vs,last;
+
+    cycles = (SystemCoreClock/1000)*ms;
+    n      = 0;
+    last   = LTDC->CDSR&LTDC_CDSR_VSYNCS;
+    start  = DWT->CYCCNT;
+    while( DWT->CYCCNT-start < cycles ) {
+        vs = LTDC->CDSR&LTDC_CDSR_VSYNCS;
+        if( vs && !last )
+            n++;
+        last = vs;
+    }
+    return ms == 0 ? 0 : (n*100000)/ms;
+}
+
+/**
+ * @brief   LCD_GetBandwidth
+ *
+ * @note    Bytes read by the LTDC for the enabled layers, per frame and per
+ *          second, and the rate while the active part of a line is scanned,
+ *          when all layers are read at once. The share of the SDRAM is for
+ *          the layers in SDRAM, against the peak of its 16 bit bus
+ *
+ * @note    The LTDC reads every enabled layer at every refresh, whether it
+ *          changed or not. A lower refresh rate or a smaller pixel format
+ *          (RGB565 instead of ARGB8888) leave more SDRAM cycles for the DMA2D
+ *          and the CPU
+ */
+void
+LCD_GetBandwidth(LCD_Bandwidth_t *bw) {
+uint32_t a,line,sdramline;
+uint64_t refresh;
+int layer;
+
+    refresh = LCD_GetRefreshRate();
+    bw->pixelclock = timing.pixelclock;
+    bw->refresh    = refresh;
+    bw->htotal     = HTOTAL;
+    bw->vtotal     = VTOTAL;
+
+    bw->bytesperframe = 0;
+    line      = 0;
+    sdramline = 0;
+    for(layer=1;layer<=2;layer++) {
+        if( (LTDC_Layer[layer]->CR&LTDC_LxCR_LEN) == 0 )
+            continue;
+        a = LTDC_Layer[layer]->CFBAR;
+        bw->bytesperframe += LCD_GetWidth(layer)*LCD_GetPixelSize(layer)*LCD_GetHeight(layer);
+        line += LCD_GetWidth(layer)*LCD_GetPixelSize(layer);
+        if( a >= SDRAM_ADDRESS && a < SDRAM_ADDRESS+SDRAM_SIZE )
+            sdramline += LCD_GetWidth(layer)*LCD_GetPixelSize(layer)*LCD_GetHeight(layer);
+    }
+    bw->bandwidth = (uint32_t) ((bw->bytesperframe*refresh)/100);
+    bw->peak      = (uint32_t) (((uint64_t) line*timing.pixelclock)/HAW);
+    // 16 bit bus at SDCLK = HCLK/2
+    bw->sdrampermille = (uint32_t) (((uint64_t) sdramline*refresh*10)
+                                    /((SDRAM_CLOCKFREQUENCY/2)*2));
+    bw->underruns      = fifounderruns;
+    bw->transfererrors = transfererrors;
+}
+
+/**
+ * @brief   LCD_TFT_ER_IRQHandler
+ *
+ * @note    Counts FIFO underruns (the LTDC could not read the frame buffer in
+ *          time, so pixels of the background color were shown) and transfer
+ *          errors
+ */
+void LCD_TFT_ER_IRQHandler(void) {
+
+    if( LTDC->ISR&LTDC_ISR_FUIF ) {
+        LTDC->ICR = LTDC_ICR_CFUIF;
+        fifounderruns++;
+    }
+    if( LTDC->ISR&LTDC_ISR_TERRIF ) {
+        LTDC->ICR = LTDC_ICR_CTERRIF;
+        transfererrors++;
+    }
+}
+
 /*
  * @brief   LCD Set Background Color
  */
@@ -911,6 +1186,157 @@ LCD_SetColorKey(int layer,  uint32_t c ) {
     LTDC_Layer[layer]->CKCR = c;
 }
 
+/**
+ * @brief   LCD_EnableColorKey
+ *
+ * @note    Pixels of layer with color c (RGB888) become transparent. Effective
+ *          at the next reload
+ */
+void
+LCD_EnableColorKey(int layer, uint32_t c) {
+
+    LTDC_Layer[layer]->CKCR = c&0xFFFFFF;
+    LTDC_Layer[layer]->CR  |= LTDC_LxCR_COLKEN;
+}
+
+/**
+ * @brief   LCD_DisableColorKey
+ */
+void
+LCD_DisableColorKey(int layer) {
+
+    LTDC_Layer[layer]->CR  &= ~LTDC_LxCR_COLKEN;
+}
+
+/**
+ * @brief   LCD_SetLayerPosition
+ *
+ * @note    Moves the window of layer to (hp,vp) keeping its size. The window is
+ *          kept inside the display. Effective at the next reload
+ *
+ * @note    Only the window registers change, so no pixel is copied
+ */
+void
+LCD_SetLayerPosition(int layer, int hp, int vp) {
+LTDC_Layer_TypeDef *const p = LTDC_Layer[layer];
+int w,h,dw,dh;
+
+    w  = ((p->WHPCR&LTDC_LxWHPCR_WHSPPOS_Msk)>>LTDC_LxWHPCR_WHSPPOS_Pos)
+        -((p->WHPCR&LTDC_LxWHPCR_WHSTPOS_Msk)>>LTDC_LxWHPCR_WHSTPOS_Pos)+1;
+    h  = ((p->WVPCR&LTDC_LxWVPCR_WVSPPOS_Msk)>>LTDC_LxWVPCR_WVSPPOS_Pos)
+        -((p->WVPCR&LTDC_LxWVPCR_WVSTPOS_Msk)>>LTDC_LxWVPCR_WVSTPOS_Pos)+1;
+
+    if( hp+w > (int) display->width )  hp = display->width-w;
+    if( vp+h > (int) display->height ) vp = display->height-h;
+    if( hp < 0 ) hp = 0;
+    if( vp < 0 ) vp = 0;
+
+    dw = (LTDC->BPCR&LTDC_BPCR_AHBP_Msk)>>LTDC_BPCR_AHBP_Pos;
+    dh = (LTDC->BPCR&LTDC_BPCR_AVBP_Msk)>>LTDC_BPCR_AVBP_Pos;
+
+    p->WHPCR  = ((hp+w+dw)<<LTDC_LxWHPCR_WHSPPOS_Pos)
+               |((hp+dw+1)<<LTDC_LxWHPCR_WHSTPOS_Pos);
+    p->WVPCR  = ((vp+h+dh)<<LTDC_LxWVPCR_WVSPPOS_Pos)
+               |((vp+dh+1)<<LTDC_LxWVPCR_WVSTPOS_Pos);
+}
+
+
+//////////////////////////// CLUT routines /////////////////////////////////////////////////////
+
+/**
+ * @brief   Palettes of the layers
+ *
+ * @note    Copy of what was loaded in the LTDC CLUT. The CLUT registers can not
+ *          be read back, and LCD_GetColorIndex needs them
+ */
+///@{
+static uint32_t palette[3][LCD_CLUTSIZE];
+static int      palettesize[3] = { 0, 0, 0 };
+///@}
+
+/**
+ * @brief   LCD_LoadCLUT
+ *
+ * @note    Loads n colors (RGB888, alpha ignored) at the start of the CLUT of a
+ *          layer. They are used by the L8, AL44 and AL88 formats when the CLUT
+ *          is enabled (LCD_EnableCLUT)
+ *
+ * @note    The CLUT can only be written when the layer is disabled or during
+ *          the vertical blanking. When the layer is enabled, it waits for it.
+ *
+ * @note    Returns 0 when OK, -1 on error
+ */
+int
+LCD_LoadCLUT(int layer, const uint32_t *colors, int n) {
+LTDC_Layer_TypeDef *p = LTDC_Layer[layer];
+int i;
+
+    if( n <= 0 || n > LCD_CLUTSIZE )
+        return -1;
+
+    if( p->CR&LTDC_LxCR_LEN ) {
+        while( LTDC->CDSR&LTDC_CDSR_VDES ) {}
+    }
+    for(i=0;i<n;i++) {
+        palette[layer][i] = colors[i]&0xFFFFFF;
+        p->CLUTWR = (((uint32_t) i)<<LTDC_LxCLUTWR_CLUTADD_Pos)|palette[layer][i];
+    }
+    palettesize[layer] = n;
+    return 0;
+}
+
+/**
+ * @brief   Enable/Disable CLUT of a layer
+ *
+ * @note    Takes effect at the next vertical blanking
+ */
+///@{
+void
+LCD_EnableCLUT(int layer) {
+
+    LTDC_Layer[layer]->CR |= LTDC_LxCR_CLUTEN;
+    LTDC->SRCR |= LTDC_SRCR_VBR;
+}
+
+void
+LCD_DisableCLUT(int layer) {
+
+    LTDC_Layer[layer]->CR &= ~LTDC_LxCR_CLUTEN;
+    LTDC->SRCR |= LTDC_SRCR_VBR;
+}
+///@}
+
+/**
+ * @brief   LCD_GetColorIndex
+ *
+ * @note    Returns the index of the palette entry nearest to color (RGB888).
+ *          The result can be used as color in the fill and draw routines of
+ *          L8 layers (or with LCD_AL44/LCD_AL88 for the others)
+ *
+ * @note    Returns 0 when no palette was loaded
+ */
+int
+LCD_GetColorIndex(int layer, uint32_t color) {
+int i,best,dr,dg,db;
+uint32_t d,bestd,c;
+
+    best  = 0;
+    bestd = 0xFFFFFFFF;
+    for(i=0;i<palettesize[layer];i++) {
+        c  = palette[layer][i];
+        dr = (int) ((c>>16)&0xFF)-(int) ((color>>16)&0xFF);
+        dg = (int) ((c>>8)&0xFF)-(int) ((color>>8)&0xFF);
+        db = (int) (c&0xFF)-(int) (color&0xFF);
+        d  = dr*dr+dg*dg+db*db;
+        if( d < bestd ) {
+            bestd = d;
+            best  = i;
+            if( d == 0 )
+                break;
+        }
+    }
+    return best;
+}
 
 /*
  * @brief   LCD Get Frame Buffer Address of a specified layer
@@ -921,6 +1347,21 @@ LCD_GetFrameBufferAddress(int layer) {
    return (void *) LTDC_Layer[layer]->CFBAR;
 }
 
+/**
+ * @brief   LCD_SetFrameBufferAddress
+ *
+ * @note    Moves the start of the frame buffer of layer, keeping format, pitch
+ *          and size. Effective at the next vertical blanking, so it can be used
+ *          to scroll a layer over a larger buffer without copying pixels. It
+ *          can be called from an interrupt
+ */
+void
+LCD_SetFrameBufferAddress(int layer, void *a) {
+
+    LTDC_Layer[layer]->CFBAR = (uint32_t) a;
+    LTDC->SRCR |= LTDC_SRCR_VBR;
+}
+
 
 /*
  * @brief   LCD Get Format used in layer
@@ -1025,6 +1466,68 @@ uint32_t ps,uf,uw,uh,pitch,dw,dh,hmax,wmax;
     LTDC->SRCR |= LTDC_SRCR_IMR;
 }
 
+/**
+ * @brief   LCD_SetSRAMFrameBuffer
+ *
+ * @note    Sets a window of layer (position x,y and size w x h, as in
+ *          LCD_SetFrameBuffer) with a frame buffer in internal SRAM, taken from
+ *          the area reserved by LCD_SRAMFBSIZE. Returns its address or null,
+ *          when it does not fit or the window is outside the display
+ *
+ * @note    The LTDC reads every enabled layer at every refresh. A band (status
+ *          bar, overlay) in SRAM is read thru the AHB matrix without using
+ *          the SDRAM, which is left to layer 1, the DMA2D and the CPU. A 480x32
+ *          band in ARGB4444 uses 30720 bytes
+ *
+ * @note    The D-cache is enabled by SystemInit and SRAM1 is write back. At the
+ *          first call, the area becomes a write through region of the MPU
+ *          (CACHE_REGION_LCD), so what the CPU draws is in the memory when the
+ *          LTDC reads it, as for the SDRAM with Cache_Init
+ *
+ * @note    The pitch is the line length rounded to 4 bytes. Drawing functions
+ *          and the DMA2D work as with any other frame buffer
+ */
+void *
+LCD_SetSRAMFrameBuffer(int layer, int format, int x, int y, int w, int h) {
+#if LCD_SRAMFBSIZE > 0
+uint32_t pitch,size,other;
+uint8_t *a;
+
+    if( layer < 1 || layer > 2 )
+        return 0;
+    if( x < 0 || y < 0 || w <= 0 || h <= 0
+        || x+w > display->width || y+h > display->height )
+        return 0;
+
+    pitch = (w*pixelsize[format]+3)&~3U;
+    size  = (pitch*h+CACHE_LINESIZE-1)&~(CACHE_LINESIZE-1);
+    other = sramfbused[3-layer];
+    if( size+other > LCD_SRAMFBSIZE )
+        return 0;
+
+    if( !sramfbmpu ) {
+        // Attributes change: no dirty line of the area can stay in the cache
+        Cache_CleanInvalidateRange(sramfb,LCD_SRAMFBSIZE);
+        __DMB();
+        MPU->CTRL = 0;
+        Cache_SetRegion(CACHE_REGION_LCD,(uint32_t) sramfb,LCD_SRAMFBSIZE,
+                        CACHE_WRITETHROUGH|CACHE_XN);
+        MPU->CTRL = MPU_CTRL_PRIVDEFENA_Msk|MPU_CTRL_ENABLE_Msk;
+        __DSB();
+        __ISB();
+        sramfbmpu = 1;
+    }
+
+    sramfbused[layer] = size;
+    a = (layer == 1) ? sramfb : sramfb+LCD_SRAMFBSIZE-size;
+    LCD_SetFrameBuffer(layer,a,format,x,y,w,h,pitch);
+    return a;
+#else
+    (void) layer; (void) format; (void) x; (void) y; (void) w; (void) h;
+    return 0;
+#endif
+}
+
 /**
  * @brief Get Framebuffer height
  *
@@ -1078,102 +1581,675 @@ LCD_GetPitch(int layer) {
 void *LCD_GetLineAddress(int layer, int line) {
 LTDC_Layer_TypeDef *p = LTDC_Layer[layer];
 
-    uint32_t base = p->CFBAR;
+    uint32_t base = (uint32_t) LCD_GetDrawBuffer(layer);
     uint32_t pitch = p->CFBLR>>LTDC_LxCFBLR_CFBP_Pos;
 
     return (void *) (base + line*pitch);
 }
 
+//////////////////////////// Frame buffer flipping /////////////////////////////////////////////////
+
 /**
- * @brief   fill1
+ * @brief   Buffers of a layer for double or triple buffering
  *
- * @note    fill a memory area with a 1 byte value
+ * @note    front is scanned out, back is where drawing routines write and pending
+ *          was given to LCD_PresentFrame and becomes front at the next reload
+ *          (vertical blanking). back is -1 while no buffer is free
  *
- * @note    n = size in bytes!!!
+ * @note    n = 0 means that the layer is not flipped. Drawing is done in CFBAR
+ */
+typedef struct {
+    void           *buffer[LCD_MAXFRAMEBUFFERS];
+    int             n;
+    int             front;
+    volatile int    back;
+    volatile int    pending;
+    volatile uint32_t frames;       /// number of buffer flips done
+    int             latest;         /// last buffer given to LCD_PresentFrame
+    int             needsync;       /// back buffer must get the damage from latest
+} FrameBuffers_t;
+
+static FrameBuffers_t framebuffers[3];
+
+/**
+ * @brief   Damaged (dirty) rectangles
  *
+ * @note    Coordinates are x0 <= x < x1 and y0 <= y < y1
+ *
+ * @note    history[0] has the rectangles drawn in the frame being built and
+ *          history[1] and history[2] the ones of the two frames presented before.
+ *          A back buffer is brought up to date by copying the rectangles of the
+ *          frames it missed from the latest presented buffer
  */
-static void fill1( void *area, int n, unsigned c) {
-uint8_t uc;
-uint8_t *p;
-uint32_t uv;
-uint32_t *q;
+typedef struct {
+    int16_t         x0,y0,x1,y1;
+} DamageRect_t;
 
-    p = (uint8_t *) area;
-    uc = c&0xFF;
-    // align to a word address (last two bits are zero)
-    while( (n>0) && ((((uintptr_t)p)&0x3)!=0) ) {
-        *p++ = uc;
-        n--;
-    }
-    // after that, can fill 4 bytes at one
-    uv = (uc<<24)|(uc<<16)|(uc<<8)|uc;
-    q = (uint32_t *) p;
-    while( n > 3 ) {
-        *q++ = uv;
-        n -= 4;
-    }
-    p = (uint8_t *) q;
-    while( n>0 ) {
-        *p++ = uc;
-        n--;
-    }
+typedef struct {
+    DamageRect_t    rect[LCD_MAXDAMAGE];
+    int             count;
+} DamageList_t;
 
-}
+static DamageList_t damage[3][LCD_MAXFRAMEBUFFERS];
+
+static LCD_DamageStats_t damagestats[3];
 
 /**
- * @brief   fill2
- *
- * @note    Fill a memory area with a 16-bit value
- *
- * @note    n = size in bytes!!!
- *
+ * @brief   area of a rectangle
  */
-static void fill2( void *area, int n, unsigned c) {
-uint8_t *p;
-uint16_t uc;
-uint32_t uv;
-uint32_t *q;
+static inline int rectarea(const DamageRect_t *r) { return (r->x1-r->x0)*(r->y1-r->y0); }
 
-    p = (uint8_t *) area;
-    uc = c&0xFFFF;
-    // align to a even address
-    while( ((uintptr_t) p)&3 ) {
-        *p++ = uc;
-        n--;
-        uc = (uc>>8)|(uc<<8);
+/**
+ * @brief   addrect
+ *
+ * @note    Adds rectangle to damage list. Rectangles that overlap or touch it are
+ *          merged into it. When the list is full, it is merged with the one whose
+ *          bounding box grows less
+ */
+static void
+addrect(DamageList_t *d, DamageRect_t r) {
+DamageRect_t *q;
+DamageRect_t u;
+int i,best,growth,bestgrowth;
+
+restart:
+    for(i=0;i<d->count;i++) {
+        q = &d->rect[i];
+        if( r.x0 <= q->x1 && q->x0 <= r.x1 && r.y0 <= q->y1 && q->y0 <= r.y1 ) {
+            if( q->x0 < r.x0 ) r.x0 = q->x0;
+            if( q->y0 < r.y0 ) r.y0 = q->y0;
+            if( q->x1 > r.x1 ) r.x1 = q->x1;
+            if( q->y1 > r.y1 ) r.y1 = q->y1;
+            d->rect[i] = d->rect[--d->count];
+            // The union can overlap rectangles already visited
+            goto restart;
+        }
     }
-    // after that, can fill 4 bytes at one
-    uv = (uc<<16)|uc;
-    q = (uint32_t *) p;
-    while( n > 3 ) {
-        *q++ = uv;
-        n -= 4;
+
+    if( d->count < LCD_MAXDAMAGE ) {
+        d->rect[d->count++] = r;
+        return;
     }
-    // fill the remaining bytes
-    p = (uint8_t *) q;
-    while( n > 0 ) {
-        *p++ = uc;
-        n--;
-        uc = (uc>>8)|(uc<<8);
+
+    best = 0;
+    bestgrowth = 0x7FFFFFFF;
+    for(i=0;i<d->count;i++) {
+        q = &d->rect[i];
+        u.x0 = q->x0 < r.x0 ? q->x0 : r.x0;
+        u.y0 = q->y0 < r.y0 ? q->y0 : r.y0;
+        u.x1 = q->x1 > r.x1 ? q->x1 : r.x1;
+        u.y1 = q->y1 > r.y1 ? q->y1 : r.y1;
+        growth = rectarea(&u)-rectarea(q);
+        if( growth < bestgrowth ) {
+            bestgrowth = growth;
+            best = i;
+        }
     }
+    q = &d->rect[best];
+    r.x0 = q->x0 < r.x0 ? q->x0 : r.x0;
+    r.y0 = q->y0 < r.y0 ? q->y0 : r.y0;
+    r.x1 = q->x1 > r.x1 ? q->x1 : r.x1;
+    r.y1 = q->y1 > r.y1 ? q->y1 : r.y1;
+    d->rect[best] = d->rect[--d->count];
+    // The bigger one can now touch others
+    goto restart;
 }
 
+/**
+ * @brief   Called by LCD_AddDamage for all layers (e.g. a remote viewer)
+ */
+static LCD_DamageCallback   damagecallback = 0;
 
 /**
- * @brief   fill3
- *
- * @note    Fill the frame buffer with a 3-byte value
+ * @brief   LCD_SetDamageCallback
  *
- * @note    n = size in bytes!!!
- *
- * @note    Memory organization
- *            word  | Pixel
+ * @note    cb gets every rectangle added by LCD_AddDamage, clipped to the
+ *          layer, also for layers without flipping. With cb = 0 it is not called
+ */
+void
+LCD_SetDamageCallback(LCD_DamageCallback cb) {
+
+    damagecallback = cb;
+}
+
+/**
+ * @brief   LCD_AddDamage
+ *
+ * @note    Records that the rectangle (x,y,w,h) of the back buffer of layer was
+ *          changed. Drawing routines call it. It must be called by code that
+ *          writes directly in the buffer returned by LCD_GetDrawBuffer
+ *
+ * @note    For layers without flipping, it is only passed to the callback of
+ *          LCD_SetDamageCallback
+ */
+void
+LCD_AddDamage(int layer, int x, int y, int w, int h) {
+DamageRect_t r;
+int lw,lh;
+
+    if( framebuffers[layer].n == 0 && damagecallback == 0 )
+        return;
+
+    lw = LCD_GetWidth(layer);
+    lh = LCD_GetHeight(layer);
+    if( x < 0 ) { w += x; x = 0; }
+    if( y < 0 ) { h += y; y = 0; }
+    if( x+w > lw ) w = lw-x;
+    if( y+h > lh ) h = lh-y;
+    if( w <= 0 || h <= 0 )
+        return;
+
+    if( damagecallback )
+        damagecallback(layer,x,y,w,h);
+    if( framebuffers[layer].n == 0 )
+        return;
+
+    r.x0 = x;
+    r.y0 = y;
+    r.x1 = x+w;
+    r.y1 = y+h;
+    addrect(&damage[layer][0],r);
+}
+
+/**
+ * @brief   copyrect
+ *
+ * @note    Copy a rectangle between two buffers of a layer with DMA2D or,
+ *          for formats DMA2D can not write, with the CPU
+ */
+static void
+copyrect(int layer, void *from, void *to, const DamageRect_t *r) {
+int format,pitch,ps,w,h,i;
+char *p,*q;
+
+    format = LCD_GetFormat(layer);
+    pitch  = LCD_GetPitch(layer);
+    w = r->x1-r->x0;
+    h = r->y1-r->y0;
+
+    if( format <= LCD_FORMAT_ARGB4444 ) {
+        DECLARE_REGION(src,from,r->x0,r->y0,w,h,format,pitch);
+        DECLARE_REGION(dst,to,r->x0,r->y0,w,h,format,pitch);
+        if( DMA2D_CopyRegion(&src,&dst) == 0 )
+            return;
+    }
+
+    LCD_WaitDrawing();
+    ps = pixelsize[format];
+    p = (char *) from + r->y0*pitch + r->x0*ps;
+    q = (char *) to   + r->y0*pitch + r->x0*ps;
+    for(i=0;i<h;i++) {
+        PixOps_Copy(q,p,w*ps);
+        p += pitch;
+        q += pitch;
+    }
+}
+
+/**
+ * @brief   syncbackbuffer
+ *
+ * @note    Copy the rectangles damaged in the frames the back buffer missed
+ *          from the latest presented buffer. It waits until the copy is done
+ *
+ * @note    With double buffering the back buffer missed one frame and with
+ *          triple buffering, two
+ */
+static void
+syncbackbuffer(int layer) {
+FrameBuffers_t *fb = &framebuffers[layer];
+LCD_DamageStats_t *st = &damagestats[layer];
+void *from,*to;
+int missed,k,i;
+uint32_t pixels = 0;
+unsigned rects = 0;
+
+    fb->needsync = 0;
+    from = fb->buffer[fb->latest];
+    to   = fb->buffer[fb->back];
+    missed = fb->n-1;
+    for(k=1;k<=missed;k++) {
+        for(i=0;i<damage[layer][k].count;i++) {
+            copyrect(layer,from,to,&damage[layer][k].rect[i]);
+            pixels += rectarea(&damage[layer][k].rect[i]);
+            rects++;
+        }
+    }
+    LCD_WaitDrawing();
+
+    st->lastpixels  = pixels;
+    st->lastrects   = rects;
+    st->totalpixels += pixels;
+    st->syncs++;
+}
+
+/**
+ * @brief   LCD_GetDamageStats
+ *
+ * @note    Returns the number of rectangles and pixels copied to bring the back
+ *          buffer up to date in the last frame and in total
+ */
+void
+LCD_GetDamageStats(int layer, LCD_DamageStats_t *stats) {
+
+    *stats = damagestats[layer];
+}
+
+
+/**
+ * @brief   Band rendering (racing the beam)
+ *
+ * @note    The active area is split in nbands bands. The line interrupt (LIPCR)
+ *          is set to the first line of a band. When the scan out reaches band k,
+ *          band k+1 is rendered, so it must be ready before the beam gets there.
+ *          The last band renders band 0 of the next frame
+ *
+ * @note    Lines are counted like CPSR.CYPOS: 0 at the start of VSYNC and the
+ *          first active line at VSH+VBP
+ */
+///@{
+static LCD_BandCallback     bandcallback = 0;
+static void                 *bandarg     = 0;
+static int                  bandcount    = 0;
+static volatile int         bandcurrent  = 0;
+static uint16_t             bandstart[LCD_MAXBANDS+1];
+static LCD_BandStats_t      bandstats[LCD_MAXBANDS];
+///@}
+
+/**
+ * @brief   bandline
+ *
+ * @note    Returns the scan line (CYPOS) of the first line of band b
+ */
+static inline int
+bandline(int b) {
+
+    return VSH+VBP+bandstart[b];
+}
+
+/**
+ * @brief   bandinterrupt
+ *
+ * @note    Called from the LTDC interrupt when the beam reaches the current band.
+ *          Arms the interrupt for the next band, renders it and measures how many
+ *          lines were left before the beam reached it
+ */
+static void
+bandinterrupt(void) {
+LCD_BandStats_t *st;
+int next,total,entry,done,budget,slack;
+
+    next  = bandcurrent+1;
+    if( next >= bandcount )
+        next = 0;
+    bandcurrent = next;
+    LTDC->LIPCR = bandline(next);
+
+    total = VSH+VBP+VAH+VFP;
+    entry = (LTDC->CPSR&LTDC_CPSR_CYPOS_Msk)>>LTDC_CPSR_CYPOS_Pos;
+    bandcallback(next,bandstart[next],bandstart[next+1],bandarg);
+    done  = (LTDC->CPSR&LTDC_CPSR_CYPOS_Msk)>>LTDC_CPSR_CYPOS_Pos;
+
+    // Distances are modulo the frame, since band 0 is in the next one
+    budget = (bandline(next)-entry+total)%total;
+    slack  = budget-(done-entry+total)%total;
+
+    st = &bandstats[next];
+    st->calls++;
+    st->lastslack = slack;
+    if( slack < st->minslack )
+        st->minslack = slack;
+    if( slack < 0 )
+        st->late++;
+}
+
+/**
+ * @brief   LCD_StartBands
+ *
+ * @note    Splits the active area in nbands bands of (almost) the same height and
+ *          calls cb(band,y0,y1,arg) to render lines y0 to y1-1 of the band just
+ *          ahead of the beam. It can be used with a single frame buffer
+ *
+ * @note    The callback runs in the LTDC interrupt (priority LCD_IRQLEVEL). It
+ *          must not wait for DMA2D jobs queued by the main program, since they are
+ *          started by the DMA2D interrupt, which has a lower priority
+ *
+ * @note    Returns -1 when nbands is invalid
+ */
+int
+LCD_StartBands(int nbands, LCD_BandCallback cb, void *arg) {
+int i;
+
+    if( nbands < 1 || nbands > LCD_MAXBANDS || cb == 0 )
+        return -1;
+
+    LCD_StopBands();
+
+    for(i=0;i<=nbands;i++)
+        bandstart[i] = (i*VAH)/nbands;
+    for(i=0;i<nbands;i++) {
+        bandstats[i].calls     = 0;
+        bandstats[i].late      = 0;
+        bandstats[i].lastslack = 0;
+        bandstats[i].minslack  = INT32_MAX;
+    }
+    bandcallback = cb;
+    bandarg      = arg;
+    bandcount    = nbands;
+    bandcurrent  = 0;
+
+    /* First interrupt when the beam reaches band 0 */
+    LTDC->LIPCR = bandline(0);
+    LTDC->ICR   = LTDC_ICR_CLIF;
+    LTDC->IER  |= LTDC_IER_LIE;
+    NVIC_SetPriority(LTDC_IRQn,LCD_IRQLEVEL);
+    NVIC_EnableIRQ(LTDC_IRQn);
+
+    return 0;
+}
+
+/**
+ * @brief   LCD_StopBands
+ *
+ * @note    Disables the line interrupt. The callback is not called anymore
+ */
+void
+LCD_StopBands(void) {
+
+    LTDC->IER &= ~LTDC_IER_LIE;
+    LTDC->ICR  = LTDC_ICR_CLIF;
+    bandcount  = 0;
+}
+
+/**
+ * @brief   LCD_GetBandStats
+ *
+ * @note    Returns the slack (in lines) measured for band since LCD_StartBands.
+ *          A negative slack means the band was rendered while it was being
+ *          scanned out (tearing)
+ */
+void
+LCD_GetBandStats(int band, LCD_BandStats_t *stats) {
+
+    *stats = bandstats[band];
+}
+
+
+/**
+ * @brief   LCD_TFT_EV_IRQHandler
+ *
+ * @note    The LTDC reloaded the shadow registers (vertical blanking). The pending
+ *          buffer is now the front one and the old front one is free
+ *
+ * @note    The line interrupt is used for band rendering
+ */
+void LCD_TFT_EV_IRQHandler(void) {
+FrameBuffers_t *fb;
+int oldfront;
+int i;
+
+    if( LTDC->ISR&LTDC_ISR_LIF ) {
+        LTDC->ICR = LTDC_ICR_CLIF;
+        if( bandcount > 0 )
+            bandinterrupt();
+    }
+
+    if( (LTDC->ISR&LTDC_ISR_RRIF) == 0 )
+        return;
+    LTDC->ICR = LTDC_ICR_CRRIF;
+
+    for(i=0;i<3;i++) {
+        fb = &framebuffers[i];
+        if( fb->n == 0 || fb->pending < 0 )
+            continue;
+        oldfront  = fb->front;
+        fb->front = fb->pending;
+        fb->pending = -1;
+        fb->frames++;
+        if( fb->back < 0 )
+            fb->back = oldfront;
+    }
+}
+
+/**
+ * @brief   LCD_SetupFrameBuffers
+ *
+ * @note    Allocates n (2 or 3) full size frame buffers for layer from the buddy
+ *          allocator (SDRAM) and shows the first one
+ *
+ * @note    After it, drawing routines write in the back buffer and
+ *          LCD_PresentFrame shows it
+ *
+ * @note    Returns 0 when OK or -1 when there is no memory
+ */
+int
+LCD_SetupFrameBuffers(int layer, int n, int format) {
+FrameBuffers_t *fb = &framebuffers[layer];
+int size;
+int i;
+
+    if( n < 2 || n > LCD_MAXFRAMEBUFFERS )
+        return -1;
+
+    size = LCD_GetMinimalFullFrameBufferSize(format);
+    for(i=0;i<n;i++) {
+        fb->buffer[i] = Buddy_Alloc(size);
+        if( fb->buffer[i] == 0 ) {
+            while( --i >= 0 )
+                Buddy_Free(fb->buffer[i]);
+            return -1;
+        }
+    }
+
+    fb->front   = 0;
+    fb->back    = 1;
+    fb->pending = -1;
+    fb->frames  = 0;
+    fb->latest  = 0;
+    fb->needsync= 0;
+    for(i=0;i<LCD_MAXFRAMEBUFFERS;i++)
+        damage[layer][i].count = 0;
+    LCD_SetFullSizeFrameBuffer(layer,fb->buffer[0],format);
+    fb->n       = n;
+
+    /* Interrupt at each reload of shadow registers */
+    LTDC->ICR  = LTDC_ICR_CRRIF;
+    LTDC->IER |= LTDC_IER_RRIE;
+    NVIC_SetPriority(LTDC_IRQn,LCD_IRQLEVEL);
+    NVIC_EnableIRQ(LTDC_IRQn);
+
+    return 0;
+}
+
+/**
+ * @brief   LCD_GetDrawBuffer
+ *
+ * @note    Returns the address of the buffer where drawing is done. For a layer
+ *          without flipping, it is the one scanned out (CFBAR)
+ *
+ * @note    With double buffering, it waits until the flip requested by
+ *          LCD_PresentFrame is done, since the only free buffer is still shown
+ */
+void *
+LCD_GetDrawBuffer(int layer) {
+FrameBuffers_t *fb = &framebuffers[layer];
+
+    if( fb->n == 0 )
+        return (void *) LTDC_Layer[layer]->CFBAR;
+
+    while( fb->back < 0 ) {
+        __WFI();
+    }
+    if( fb->needsync )
+        syncbackbuffer(layer);
+    return fb->buffer[fb->back];
+}
+
+/**
+ * @brief   LCD_IsNextBufferAvailable
+ *
+ * @note    Returns 1 when a buffer is free for drawing. It does not wait
+ */
+int
+LCD_IsNextBufferAvailable(int layer) {
+FrameBuffers_t *fb = &framebuffers[layer];
+
+    return (fb->n == 0) || (fb->back >= 0);
+}
+
+/**
+ * @brief   LCD_PresentFrame
+ *
+ * @note    Shows the back buffer at the next vertical blanking and chooses another
+ *          buffer for drawing. It returns at once, unless a previous flip is
+ *          still pending
+ *
+ * @note    With three buffers, drawing can continue at once in the third one.
+ *          With two, the next drawing waits for the vertical blanking
+ *
+ * @note    Returns -1 if the layer has no buffers set by LCD_SetupFrameBuffers
+ */
+int
+LCD_PresentFrame(int layer) {
+FrameBuffers_t *fb = &framebuffers[layer];
+int next;
+int i;
+
+    if( fb->n == 0 )
+        return -1;
+
+    /* Only one flip can be waiting for a reload */
+    while( fb->pending >= 0 ) {
+        __WFI();
+    }
+    /* Back buffer must be complete */
+    LCD_WaitDrawing();
+    if( fb->back < 0 )
+        return 0;
+
+    next = -1;
+    for(i=0;i<fb->n;i++) {
+        if( i != fb->front && i != fb->back ) {
+            next = i;
+            break;
+        }
+    }
+
+    /* Damage history: the frame just built becomes history[1] */
+    for(i=fb->n-1;i>0;i--)
+        damage[layer][i] = damage[layer][i-1];
+    damage[layer][0].count = 0;
+    fb->latest   = fb->back;
+    fb->needsync = 1;
+
+    __disable_irq();
+    fb->pending = fb->back;
+    fb->back    = (fb->n > 2) ? next : -1;
+    LTDC_Layer[layer]->CFBAR = (uint32_t) fb->buffer[fb->pending];
+    LTDC->SRCR = LTDC_SRCR_VBR;
+    __enable_irq();
+
+    return 0;
+}
+
+/**
+ * @brief   LCD_GetFrameCount
+ *
+ * @note    Returns the number of flips done in layer
+ */
+uint32_t
+LCD_GetFrameCount(int layer) {
+
+    return framebuffers[layer].frames;
+}
+
+/**
+ * @brief   fill1
+ *
+ * @note    fill a memory area with a 1 byte value
+ *
+ * @note    n = size in bytes!!!
+ *
+ */
+ITCM_CODE static void fill1( void *area, int n, unsigned c) {
+uint8_t uc;
+uint8_t *p;
+uint32_t uv;
+uint32_t *q;
+
+    p = (uint8_t *) area;
+    uc = c&0xFF;
+    // align to a word address (last two bits are zero)
+    while( (n>0) && ((((uintptr_t)p)&0x3)!=0) ) {
+        *p++ = uc;
+        n--;
+    }
+    // after that, can fill 4 bytes at one
+    uv = (uc<<24)|(uc<<16)|(uc<<8)|uc;
+    q = (uint32_t *) p;
+    PixOps_FillWords(q,uv,n>>2);
+    q += n>>2;
+    n &= 3;
+    p = (uint8_t *) q;
+    while( n>0 ) {
+        *p++ = uc;
+        n--;
+    }
+
+}
+
+/**
+ * @brief   fill2
+ *
+ * @note    Fill a memory area with a 16-bit value
+ *
+ * @note    n = size in bytes!!!
+ *
+ */
+ITCM_CODE static void fill2( void *area, int n, unsigned c) {
+uint8_t *p;
+uint16_t uc;
+uint32_t uv;
+uint32_t *q;
+
+    p = (uint8_t *) area;
+    uc = c&0xFFFF;
+    // align to a even address
+    while( ((uintptr_t) p)&3 ) {
+        *p++ = uc;
+        n--;
+        uc = (uc>>8)|(uc<<8);
+    }
+    // after that, can fill 4 bytes at one
+    uv = (uc<<16)|uc;
+    q = (uint32_t *) p;
+    PixOps_FillWords(q,uv,n>>2);
+    q += n>>2;
+    n &= 3;
+    // fill the remaining bytes
+    p = (uint8_t *) q;
+    while( n > 0 ) {
+        *p++ = uc;
+        n--;
+        uc = (uc>>8)|(uc<<8);
+    }
+}
+
+
+/**
+ * @brief   fill3
+ *
+ * @note    Fill the frame buffer with a 3-byte value
+ *
+ * @note    n = size in bytes!!!
+ *
+ * @note    Memory organization
+ *            word  | Pixel
  *         ---------|-----------------
  *            +0    | B1 R0 G0 B0
  *            +1    | G2 B2 R1 G1
  *            +2    | R3 G3 B3 R2
  */
-static void fill3( void *area, int n, unsigned c) {
+ITCM_CODE static void fill3( void *area, int n, unsigned c) {
 uint32_t w1,w2,w3;
 uint8_t *p;
 uint32_t uc;
@@ -1193,12 +2269,9 @@ uint32_t *q;
     w1 = (uc<<8)|(uc>>16);      // ABCA
     w2 = (uc<<16)|(uc>>8);      // BCAB
     w3 = (uc<<24)|uc;           // CABC
-    while( n > 11 ) {
-        *q++ = w3;
-        *q++ = w2;
-        *q++ = w1;
-        n -= 12;
-    }
+    PixOps_Fill3Words(q,w3,w2,w1,n/12);
+    q += 3*(n/12);
+    n %= 12;
     // fill the remaining bytes
     p = (uint8_t *) q;
     while( n > 0 ) {
@@ -1217,7 +2290,7 @@ uint32_t *q;
  *
  */
 
-static void fill4( void *area, int n, unsigned c) {
+ITCM_CODE static void fill4( void *area, int n, unsigned c) {
 uint8_t *p;
 uint32_t uc;
 uint32_t *q;
@@ -1232,10 +2305,9 @@ uint32_t *q;
     }
     // after that, can fill 4 bytes at one
     q = (uint32_t *) p;
-    while( n > 3 ) {
-        *q++ = uc;
-        n -= 4;
-    }
+    PixOps_FillWords(q,uc,n>>2);
+    q += n>>2;
+    n &= 3;
     // fill the remaining bytes
     p = (uint8_t *) q;
     while( n > 0 ) {
@@ -1247,6 +2319,61 @@ uint32_t *q;
 }
 
 
+/**
+ * @brief   LCD_SetAcceleration
+ *
+ * @note    Enables (on=1) or disables (on=0) the use of DMA2D for fills in layer
+ */
+void
+LCD_SetAcceleration(int layer, int on) {
+
+    LCD_WaitDrawing();
+    accelerated[layer] = on;
+}
+
+/**
+ * @brief   LCD_WaitDrawing
+ *
+ * @note    Waits until the DMA2D finishes the fills started and the jobs queued
+ *          (text). CPU drawing routines call it before writing into the frame buffer
+ */
+void
+LCD_WaitDrawing(void) {
+
+    while( !DMA2D_IsIdle() ) {}
+}
+
+/**
+ * @brief   accelfill
+ *
+ * @note    Fills a rectangle of layer using DMA2D
+ *
+ * @note    It does not wait for the end of the operation
+ *
+ * @note    Returns -1 when the rectangle must be filled by the CPU (acceleration
+ *          disabled, small rectangle or format not supported by DMA2D)
+ */
+static int
+accelfill(int layer, int x, int y, int w, int h, unsigned color) {
+int format;
+
+    if( !accelerated[layer] )
+        return -1;
+    if( w <= 0 || h <= 0 || w*h < LCD_ACCEL_MINPIXELS )
+        return -1;
+    format = LCD_GetFormat(layer);
+    if( format > LCD_FORMAT_ARGB4444 )
+        return -1;
+
+    DECLARE_REGION(r,LCD_GetDrawBuffer(layer),x,y,w,h,format,LCD_GetPitch(layer));
+
+    if( DMA2D_FillRegion(&r,color) < 0 )
+        return -1;
+
+    return 0;
+}
+
+
 /*
  * @brief   LCD_FillFrameBuffer
  *
@@ -1260,12 +2387,23 @@ char *area,*lineaddr;
 int  w,h,pitch;
 int i;
 
+    PROFILE_BEGIN(LCD_FillFrameBuffer);
+
     ps     = LCD_GetPixelSize(layer);
-    area   = (char *) LCD_GetFrameBufferAddress(layer);
+    area   = (char *) LCD_GetDrawBuffer(layer);
     w      = LCD_GetWidth(layer);
     h      = LCD_GetHeight(layer);
     pitch  = LCD_GetPitch(layer);
 
+    LCD_AddDamage(layer,0,0,w,h);
+
+    if( accelfill(layer,0,0,w,h,color) == 0 ) {
+        PROFILE_END(LCD_FillFrameBuffer);
+        return;
+    }
+
+    LCD_WaitDrawing();
+
     switch(ps) {
     case 1:
         w = LCD_GetPitch(layer);
@@ -1292,6 +2430,109 @@ int i;
     default:
         break;
     }
+
+    PROFILE_END(LCD_FillFrameBuffer);
+}
+
+/**
+ * @brief   Fill kernels indexed by pixel size
+ */
+static void (* const fillfunctions[5])(void *, int, unsigned) = {
+    0, fill1, fill2, fill3, fill4
+};
+
+/**
+ * @brief   clipspan
+ *
+ * @note    Clips span s to the layer. Returns 0 when nothing is left
+ */
+static inline int
+clipspan(const LCD_Span_t *s, int lw, int lh, int *x, int *y, int *w, int *h) {
+
+    *x = s->x;
+    *y = s->y;
+    *w = s->w;
+    *h = s->h;
+    if( *x < 0 ) { *w += *x; *x = 0; }
+    if( *y < 0 ) { *h += *y; *y = 0; }
+    if( *x+*w > lw ) *w = lw-*x;
+    if( *y+*h > lh ) *h = lh-*y;
+    return *w > 0 && *h > 0;
+}
+
+/**
+ * @brief   LCD_FillSpans
+ *
+ * @note    Fills n spans of layer with color (in the layer format). The spans
+ *          are clipped to the layer and their bounding box is added to the damage
+ *
+ * @note    When acceleration is on and the average span has at least
+ *          LCD_ACCEL_MINSPAN pixels, the spans go to the DMA2D as batches, one
+ *          queue entry for up to DMA2D_BATCHSIZE spans, and it does not wait.
+ *          Otherwise they are filled by the CPU with the fill kernels
+ */
+void
+LCD_FillSpans(int layer, const LCD_Span_t *spans, int n, unsigned color) {
+void (*fill)(void *, int, unsigned);
+DMA2D_Batch b;
+char *base,*q;
+int format,pitch,ps,lw,lh;
+int x,y,w,h,i,k,count;
+int bx0,by0,bx1,by1;
+uint32_t pixels;
+
+    lw     = LCD_GetWidth(layer);
+    lh     = LCD_GetHeight(layer);
+    format = LCD_GetFormat(layer);
+    pitch  = LCD_GetPitch(layer);
+    ps     = LCD_GetPixelSize(layer);
+    base   = (char *) LCD_GetDrawBuffer(layer);
+
+    bx0 = lw; by0 = lh; bx1 = 0; by1 = 0;
+    count  = 0;
+    pixels = 0;
+    for(i=0;i<n;i++) {
+        if( !clipspan(&spans[i],lw,lh,&x,&y,&w,&h) )
+            continue;
+        if( x < bx0 ) bx0 = x;
+        if( y < by0 ) by0 = y;
+        if( x+w > bx1 ) bx1 = x+w;
+        if( y+h > by1 ) by1 = y+h;
+        pixels += w*h;
+        count++;
+    }
+    if( count == 0 )
+        return;
+    LCD_AddDamage(layer,bx0,by0,bx1-bx0,by1-by0);
+
+    if( accelerated[layer] && format <= LCD_FORMAT_ARGB4444
+     && pixels >= (uint32_t) count*LCD_ACCEL_MINSPAN ) {
+        while( (b=DMA2D_BeginBatch()) < 0 ) {}
+        for(i=0;i<n;i++) {
+            if( !clipspan(&spans[i],lw,lh,&x,&y,&w,&h) )
+                continue;
+            DECLARE_REGION(r,base,x,y,w,h,format,pitch);
+            if( DMA2D_BatchFill(b,&r,color) < 0 ) {
+                while( DMA2D_SubmitBatch(b,0,0) == 0 ) {}
+                while( (b=DMA2D_BeginBatch()) < 0 ) {}
+                DMA2D_BatchFill(b,&r,color);
+            }
+        }
+        while( DMA2D_SubmitBatch(b,0,0) == 0 ) {}
+        return;
+    }
+
+    LCD_WaitDrawing();
+    fill = fillfunctions[ps];
+    for(i=0;i<n;i++) {
+        if( !clipspan(&spans[i],lw,lh,&x,&y,&w,&h) )
+            continue;
+        q = base+y*pitch+x*ps;
+        for(k=0;k<h;k++) {
+            fill(q,w*ps,color);
+            q += pitch;
+        }
+    }
 }
 
 
@@ -1318,6 +2559,13 @@ uint8_t c1,c2,c3,c4;
     if( (x+size) > w )
         size = w-x;
 
+    LCD_AddDamage(layer,x,y,size,1);
+
+    if( accelfill(layer,x,y,size,1,color) == 0 )
+        return;
+
+    LCD_WaitDrawing();
+
     lineaddr = (char *) LCD_GetLineAddress(layer,y);
     switch(ps) {
     case 1:
@@ -1383,6 +2631,13 @@ uint8_t c1,c2,c3,c4;
     if( (y+size) > h )
         size = h-y;
 
+    LCD_AddDamage(layer,x,y,1,size);
+
+    if( accelfill(layer,x,y,1,size,color) == 0 )
+        return;
+
+    LCD_WaitDrawing();
+
     switch(ps) {
     case 1:
         c1 = color&0xFF;
@@ -1469,6 +2724,14 @@ uint8_t c1,c2,c3,c4;
     sizeh -= 1;
     x++;
     y++;
+
+    LCD_AddDamage(layer,x,y,sizew,sizeh);
+
+    if( accelfill(layer,x,y,sizew,sizeh,color) == 0 )
+        return;
+
+    LCD_WaitDrawing();
+
     for(i=0;i<sizeh;i++) {
         q = LCD_GetLineAddress(layer,y+i);
         q += ps*x;
@@ -1489,151 +2752,278 @@ uint8_t c1,c2,c3,c4;
     }
 }
 
-/*
- * @brief Mark point
+/**
+ * @brief   LCD_BlitIndexed
+ *
+ * @note    Draws a w x h image with 8 bit indexes (L8) at (x,y). srcpitch is the
+ *          distance in bytes between lines of the image
+ *
+ * @note    For L8 layers the indexes are copied and the palette of the layer
+ *          is used (clut can be 0). For other layers, DMA2D expands the indexes
+ *          using clut (ARGB8888, n entries), that is loaded in the DMA2D
+ *          foreground CLUT when not 0. Use opaque colors (alpha=0xFF) for
+ *          ARGB layers.
+ *
+ * @note    The image is not clipped. Returns 0 when OK, -1 on error
  */
-static void plot(char *p, int ps, unsigned color ) {
+int
+LCD_BlitIndexed(int layer, int x, int y, int w, int h, const uint8_t *src, int srcpitch,
+                const uint32_t *clut, int n) {
+int format,pitch,i;
+char *base,*q;
 
-    switch(ps) {
-    case 4: *p++ = (color>>24)&0xFF;
-    case 3: *p++ = (color>>16)&0xFF;
-    case 2: *p++ = (color>>8)&0xFF;
-    case 1: *p++ = color&0xFF;
+    if( x < 0 || y < 0 || w <= 0 || h <= 0
+     || x+w > LCD_GetWidth(layer) || y+h > LCD_GetHeight(layer) )
+        return -1;
+
+    format = LCD_GetFormat(layer);
+    pitch  = LCD_GetPitch(layer);
+    base   = (char *) LCD_GetLineAddress(layer,0);
+    LCD_AddDamage(layer,x,y,w,h);
+
+    if( format == LCD_FORMAT_L8 ) {
+        LCD_WaitDrawing();
+        q = base+y*pitch+x;
+        for(i=0;i<h;i++) {
+            PixOps_Copy(q,src,w);
+            q   += pitch;
+            src += srcpitch;
+        }
+        return 0;
     }
+    if( format > LCD_FORMAT_ARGB4444 )
+        return -1;
+
+    if( clut && DMA2D_LoadCLUT(DMA2D_FOREGROUND,clut,n) < 0 )
+        return -1;
+
+    DECLARE_REGION(s,src,0,0,w,h,DMA2D_L8,srcpitch);
+    DECLARE_REGION(d,base,x,y,w,h,format,pitch);
+    return DMA2D_CopyRegion(&s,&d);
 }
-/*
- * @brief   LCD_DrawLine
+
+/**
+ * @brief   Pixel stores used by the line rasterizers
  *
- * @note    Draw an vertical line from point (x,y) with size 'size'
+ * @note    Pixels are stored in the same (little endian) order as the fills
  */
+///@{
+#define STORE8(P,C)     (*(uint8_t *)  (P) = (C))
+#define STORE16(P,C)    (*(uint16_t *) (P) = (C))
+#define STORE24(P,C)    ((P)[0] = (C), (P)[1] = (C)>>8, (P)[2] = (C)>>16)
+#define STORE32(P,C)    (*(uint32_t *) (P) = (C))
+///@}
 
 #define ABS(X)  ((X)>0?(X):-(X))
 
-void
-LCD_DrawLine(int layer, int x, int y, int dx, int dy, unsigned color) {
-enum   { Q0=0, Q1=1, Q2=5, Q3=4, Q4=6, Q5= 7, Q6=3, Q7=2 } octantcode;
-int xi,yi;
-int x1,x2,y1,y2;
-int key;
-int eps;
-int ps,w,h,pitch;
-char *lineaddr;
+/**
+ * @brief   Line rasterizer specialized for a pixel size
+ *
+ * @note    Bresenham algorithm valid for all octants. The end points must be
+ *          inside the layer. The address is advanced by pixel size and pitch,
+ *          so there are no multiplications inside the loop
+ */
+#define DEFINE_LINE(NAME,PS,STORE)                                          \
+ITCM_CODE static void                                                       \
+NAME(char *base, int pitch, int x0, int y0, int x1, int y1, unsigned c) {   \
+int dx,dy,sx,sy,err,e2,n;                                                   \
+char *p;                                                                    \
+                                                                            \
+    dx  = ABS(x1-x0);                                                       \
+    dy  = -ABS(y1-y0);                                                      \
+    sx  = (x0<x1)?(PS):-(PS);                                               \
+    sy  = (y0<y1)?pitch:-pitch;                                             \
+    err = dx+dy;                                                            \
+    n   = (dx>-dy)?dx:-dy;                                                  \
+    p   = base+y0*pitch+x0*(PS);                                            \
+    for(;;) {                                                               \
+        STORE(p,c);                                                         \
+        if( n-- == 0 )                                                      \
+            break;                                                          \
+        e2 = 2*err;                                                         \
+        if( e2 >= dy ) {                                                    \
+            err += dy;                                                      \
+            p   += sx;                                                      \
+        }                                                                   \
+        if( e2 <= dx ) {                                                    \
+            err += dx;                                                      \
+            p   += sy;                                                      \
+        }                                                                   \
+    }                                                                       \
+}
 
-    ps       = LCD_GetPixelSize(layer);
-    w        = LCD_GetWidth(layer);
-    h        = LCD_GetHeight(layer);
-    pitch    = LCD_GetPitch(layer);
-    lineaddr = (char *) LCD_GetLineAddress(layer,y);
+DEFINE_LINE(line8, 1,STORE8)
+DEFINE_LINE(line16,2,STORE16)
+DEFINE_LINE(line24,3,STORE24)
+DEFINE_LINE(line32,4,STORE32)
 
-    if( (x+dx) > w )
-        dx = w-x;
-    if( (y+dy) > h )
-        dy = h-y;
-
-    // Build oct value setting bits according octant
-    key = 0;
-    // find quadrant first
-    if( dx < 0 ) key |= 4;
-    if( dy < 0 ) key |= 2;
-    // find octant using rules according each quadrant
-    if( ABS(dy) > ABS(dx) ) key |= 1;
-    eps = 0;
-    x1 = x;
-    y1 = y;
-    x2 = x+dx;
-    y2 = y+dy;
-    xi = x1;
-    yi = y1;
-    lineaddr = (char *) LCD_GetLineAddress(layer,yi);
-    switch(key){
-    case Q0: // 1st octant
-        for(xi=x; xi<=x2;xi++) {
-            plot(lineaddr+xi*ps,ps,color);
-            eps += dy;
-            if( (eps<<1) >= dx ) {
-                yi++;
-                eps -= dx;
-                lineaddr += pitch;
-            }
-        }
-        break;
-    case Q1: // 2nd octant
-        for(yi=y1; yi<=y2;yi++) {
-            plot(lineaddr+xi*ps,ps,color);
-            eps += dx;
-            if( (eps<<1) >= dy ) {
-                xi++;
-                eps -= dy;
-            }
-            lineaddr += pitch;
-        }
-        break;
-    case Q2: // 3rd octant
-        for(yi=y1; yi<=y2;yi++) {
-            plot(lineaddr+xi*ps,ps,color);
-            eps -= dx;
-            if( (eps<<1) >= dy ) {
-                xi--;
-                eps -= dy;
-            }
-            lineaddr += pitch;
-        }
-        break;
-    case Q3: // 4th octant
-        for(xi=x; xi>=x2;xi--) {
-            plot(lineaddr+xi*ps,ps,color);
-            eps += dy;
-            if( (eps<<1) >= -dx ) {
-                yi++;
-                eps += dx;
-                lineaddr += pitch;
-            }
-        }
-        break;
-    case Q4: // 5th octant
-        for(xi=x; xi>=x2;xi--) {
-            plot(lineaddr+xi*ps,ps,color);
-            eps -= dy;
-            if( (eps<<1) >= -dx ) {
-                yi--;
-                eps += dx;
-                lineaddr -= pitch;
-            }
-        }
-        break;
-    case Q5: // 6th octant
-        for(yi=y1; yi>=y2;yi--) {
-            plot(lineaddr+xi*ps,ps,color);
-            eps -= dx;
-            if( (eps<<1) >= -dy ) {
-                xi--;
-                eps += dy;
-            }
-            lineaddr -= pitch;
-        }
-        break;
-    case Q6: // 7th octant
-        for(yi=y1; yi>=y2;yi--) {
-            plot(lineaddr+xi*ps,ps,color);
-            eps += dx;
-            if( (eps<<1) >= -dy ) {
-                xi++;
-                eps += dy;
-            }
-            lineaddr -= pitch;
+/**
+ * @brief   Rasterizers indexed by pixel size
+ */
+static void (* const linefunctions[5])(char *, int, int, int, int, int, unsigned) = {
+    0, line8, line16, line24, line32
+};
+
+/**
+ * @brief   Cohen-Sutherland outcodes
+ */
+///@{
+#define CLIP_LEFT       1
+#define CLIP_RIGHT      2
+#define CLIP_TOP        4
+#define CLIP_BOTTOM     8
+///@}
+
+static inline int outcode(int x, int y, int w, int h) {
+int code = 0;
+
+    if( x < 0 )         code |= CLIP_LEFT;
+    else if( x >= w )   code |= CLIP_RIGHT;
+    if( y < 0 )         code |= CLIP_TOP;
+    else if( y >= h )   code |= CLIP_BOTTOM;
+    return code;
+}
+
+/**
+ * @brief   clipline
+ *
+ * @note    Clips the segment (x0,y0)-(x1,y1) to the rectangle (0,0)-(w-1,h-1) with
+ *          the Cohen-Sutherland algorithm
+ *
+ * @note    Returns 0 when the segment is completely outside. Segments inside
+ *          or completely on one side cost only the outcode calculations
+ */
+static int
+clipline(int *x0, int *y0, int *x1, int *y1, int w, int h) {
+int c0,c1,c;
+int x,y;
+
+    c0 = outcode(*x0,*y0,w,h);
+    c1 = outcode(*x1,*y1,w,h);
+    for(;;) {
+        if( (c0|c1) == 0 )
+            return 1;
+        if( c0&c1 )
+            return 0;
+        c = c0?c0:c1;
+        // Intersection with the border. 64 bit products avoid overflows
+        if( c&CLIP_BOTTOM ) {
+            y = h-1;
+            x = *x0+(int)((int64_t)(*x1-*x0)*(y-*y0)/(*y1-*y0));
+        } else if( c&CLIP_TOP ) {
+            y = 0;
+            x = *x0+(int)((int64_t)(*x1-*x0)*(y-*y0)/(*y1-*y0));
+        } else if( c&CLIP_RIGHT ) {
+            x = w-1;
+            y = *y0+(int)((int64_t)(*y1-*y0)*(x-*x0)/(*x1-*x0));
+        } else {
+            x = 0;
+            y = *y0+(int)((int64_t)(*y1-*y0)*(x-*x0)/(*x1-*x0));
         }
-        break;
-    case Q7: // 8th octant
-        for(xi=x; xi<=x2;xi++) {
-            plot(lineaddr+xi*ps,ps,color);
-            eps -= dy;
-            if( (eps<<1) >= dx ) {
-                yi--;
-                eps -= dx;
-                lineaddr -= pitch;
-            }
+        if( c == c0 ) {
+            *x0 = x;
+            *y0 = y;
+            c0 = outcode(x,y,w,h);
+        } else {
+            *x1 = x;
+            *y1 = y;
+            c1 = outcode(x,y,w,h);
         }
-        break;
     }
 }
 
+/**
+ * @brief   Layer parameters used by all segments of a call
+ */
+typedef struct {
+    int         layer;
+    char        *base;
+    int         pitch;
+    int         w;
+    int         h;
+    void        (*line)(char *, int, int, int, int, int, unsigned);
+} LineContext_t;
+
+/**
+ * @brief   linesetup
+ *
+ * @note    Queries the layer once and waits for DMA2D drawings in progress
+ */
+static void
+linesetup(int layer, LineContext_t *lc) {
+
+    lc->layer = layer;
+    lc->w     = LCD_GetWidth(layer);
+    lc->h     = LCD_GetHeight(layer);
+    lc->pitch = LCD_GetPitch(layer);
+    lc->base  = (char *) LCD_GetLineAddress(layer,0);
+    lc->line  = linefunctions[LCD_GetPixelSize(layer)];
+
+    LCD_WaitDrawing();
+}
+
+/**
+ * @brief   drawsegment
+ *
+ * @note    Clips, marks the damaged area and draws a segment
+ */
+static void
+drawsegment(const LineContext_t *lc, int x0, int y0, int x1, int y1, unsigned color) {
+
+    if( !clipline(&x0,&y0,&x1,&y1,lc->w,lc->h) )
+        return;
+
+    LCD_AddDamage(lc->layer,x0<x1?x0:x1,y0<y1?y0:y1,ABS(x1-x0)+1,ABS(y1-y0)+1);
+    lc->line(lc->base,lc->pitch,x0,y0,x1,y1,color);
+}
+
+/**
+ * @brief   LCD_DrawLine
+ *
+ * @note    Draw a line from point (x,y) to point (x+dx,y+dy)
+ *
+ * @note    The line is clipped to the layer, so any part of it can be outside
+ */
+void
+LCD_DrawLine(int layer, int x, int y, int dx, int dy, unsigned color) {
+LineContext_t lc;
+
+    linesetup(layer,&lc);
+    drawsegment(&lc,x,y,x+dx,y+dy,color);
+}
+
+/**
+ * @brief   LCD_DrawPolyline
+ *
+ * @note    Draw lines connecting n points (n-1 segments)
+ *
+ * @note    The layer is queried once for all segments
+ */
+void
+LCD_DrawPolyline(int layer, const LCD_Point_t *points, int n, unsigned color) {
+LineContext_t lc;
+int i;
+
+    if( n < 2 )
+        return;
+    linesetup(layer,&lc);
+    for(i=1;i<n;i++) {
+        drawsegment(&lc,points[i-1].x,points[i-1].y,points[i].x,points[i].y,color);
+    }
+}
+
+/**
+ * @brief   LCD_DrawLines
+ *
+ * @note    Draw n independent lines. Line i goes from points[2*i] to points[2*i+1]
+ */
+void
+LCD_DrawLines(int layer, const LCD_Point_t *points, int n, unsigned color) {
+LineContext_t lc;
+int i;
+
+    linesetup(layer,&lc);
+    for(i=0;i<n;i++) {
+        drawsegment(&lc,points[2*i].x,points[2*i].y,points[2*i+1].x,points[2*i+1].y,color);
+    }
+}
@@ -69,6 +69,27 @@ void  LCD_DisableController(void);
 
 void  LCD_SetBackgroundColor( uint32_t bg );
 void  LCD_SetColorKey(int layer,  uint32_t c );
+void  LCD_EnableColorKey(int layer, uint32_t c);
+void  LCD_DisableColorKey(int layer);
+
+/**
+ * @brief   Indexed color formats (L8, AL44 and AL88)
+ *
+ * @note    The color of L8 is the index. AL44 and AL88 colors have an alpha
+ *          value too
+ */
+///@{
+#define LCD_CLUTSIZE        256
+#define LCD_AL44(A,I)       ( ((((uint32_t) (A))&0xF)<<4)|(((uint32_t) (I))&0xF) )
+#define LCD_AL88(A,I)       ( ((((uint32_t) (A))&0xFF)<<8)|(((uint32_t) (I))&0xFF) )
+///@}
+
+int   LCD_LoadCLUT(int layer, const uint32_t *colors, int n);
+void  LCD_EnableCLUT(int layer);
+void  LCD_DisableCLUT(int layer);
+int   LCD_GetColorIndex(int layer, uint32_t color);
+int   LCD_BlitIndexed(int layer, int x, int y, int w, int h, const uint8_t *src,
+                      int srcpitch, const uint32_t *clut, int n);
 
 /**
  * @brief Layer management
@@ -78,9 +99,13 @@ void  LCD_SetColorKey(int layer,  uint32_t c );
  *
  *        * Full size:    Only the format must be specified
  *        * Partial size: Format, position and size must be specified
+ *
+ * @note  LCD_SetSRAMFrameBuffer sets a partial size frame buffer in internal
+ *        SRAM (LCD_SRAMFBSIZE), so the LTDC does not read it from the SDRAM
  */
 void  LCD_SetFullSizeFrameBuffer(int layer, void *area, int format);
 void  LCD_SetFrameBuffer(int layer, void *a, int f, int w, int h, int p, int hp, int vp );
+void *LCD_SetSRAMFrameBuffer(int layer, int format, int x, int y, int w, int h);
 void  LCD_SetDefaultColor(int layer, uint32_t c );
 void  LCD_SetDefaultColor(int layer, uint32_t c );
 void  LCD_FillFrameBuffer(int layer, unsigned c );
@@ -97,6 +122,7 @@ int   LCD_GetHeight(int layer);
 int   LCD_GetWidth(int layer);
 int   LCD_GetPitch(int layer);
 void *LCD_GetFrameBufferAddress(int layer);
+void  LCD_SetFrameBufferAddress(int layer, void *a);
 void  LCD_SetFormat(int layer, int format);
 int   LCD_GetFormat(int layer);
 int   LCD_GetPixelSize(int layer);
@@ -106,6 +132,125 @@ int   LCD_GetMinimalFullFrameBufferSize(int format);
 void LCD_DrawHorizontalLine(int layer, int x, int y, int size, unsigned color);
 void LCD_DrawVerticalLine(int layer, int x, int y, int size, unsigned color);
 void LCD_DrawBox(int layer, int x, int y, int sw, int sh, unsigned color, unsigned bordercolor);
-void LCD_DrawLine(int layer, int x, int y, int sw, int sh, unsigned color);
+void LCD_DrawLine(int layer, int x, int y, int dx, int dy, unsigned color);
+
+/**
+ * @brief   Point for polylines and batches of lines
+ */
+typedef struct {
+    int16_t     x;
+    int16_t     y;
+} LCD_Point_t;
+
+void LCD_DrawPolyline(int layer, const LCD_Point_t *points, int n, unsigned color);
+void LCD_DrawLines(int layer, const LCD_Point_t *points, int n, unsigned color);
+
+/**
+ * @brief   Span (rectangle) produced by the rasterizers in raster.c
+ *
+ * @note    Usually one line high. Consecutive lines with the same extent are
+ *          given as one span with h lines
+ */
+typedef struct {
+    int16_t     x;
+    int16_t     y;
+    int16_t     w;
+    int16_t     h;
+} LCD_Span_t;
+
+void LCD_FillSpans(int layer, const LCD_Span_t *spans, int n, unsigned color);
+
+/**
+ * @brief   Double and triple buffering
+ *
+ * @note    LCD_IRQLEVEL is the priority of the LTDC interrupt used to detect the
+ *          reload of the frame buffer address at vertical blanking
+ */
+///@{
+#define LCD_MAXFRAMEBUFFERS     3
+#ifndef LCD_MAXDAMAGE
+#define LCD_MAXDAMAGE           16
+#endif
+#ifndef LCD_IRQLEVEL
+#define LCD_IRQLEVEL            5
+#endif
+///@}
+
+/**
+ * @brief   Statistics of partial updates (dirty rectangles)
+ */
+typedef struct {
+    uint32_t    lastpixels;                 ///< pixels copied for the last frame
+    uint32_t    lastrects;                  ///< rectangles copied for the last frame
+    uint32_t    totalpixels;                ///< pixels copied since setup
+    uint32_t    syncs;                      ///< number of back buffer updates
+} LCD_DamageStats_t;
+
+int   LCD_SetupFrameBuffers(int layer, int n, int format);
+void *LCD_GetDrawBuffer(int layer);
+int   LCD_IsNextBufferAvailable(int layer);
+int   LCD_PresentFrame(int layer);
+uint32_t LCD_GetFrameCount(int layer);
+void  LCD_AddDamage(int layer, int x, int y, int w, int h);
+void  LCD_GetDamageStats(int layer, LCD_DamageStats_t *stats);
+
+typedef void (*LCD_DamageCallback)(int layer, int x, int y, int w, int h);
+void  LCD_SetDamageCallback(LCD_DamageCallback cb);
+
+/**
+ * @brief   Band rendering (racing the beam)
+ *
+ * @note    The callback renders lines y0 to y1-1 and is called in the LTDC
+ *          interrupt when the beam reaches the band before it
+ */
+///@{
+#ifndef LCD_MAXBANDS
+#define LCD_MAXBANDS            16
+#endif
+typedef void (*LCD_BandCallback)(int band, int y0, int y1, void *arg);
+
+typedef struct {
+    uint32_t    calls;                      ///< times the band was rendered
+    uint32_t    late;                       ///< renders ended after the beam got there
+    int32_t     lastslack;                  ///< lines left at the end of the last render
+    int32_t     minslack;                   ///< smallest slack since start
+} LCD_BandStats_t;
+
+int   LCD_StartBands(int nbands, LCD_BandCallback cb, void *arg);
+void  LCD_StopBands(void);
+void  LCD_GetBandStats(int band, LCD_BandStats_t *stats);
+///@}
+
+/**
+ * @brief   Refresh rate and LTDC bandwidth
+ *
+ * @note    LCD_REFRESH (Hz) is set by LCD_Init. 0 keeps the datasheet timing
+ */
+///@{
+#ifndef LCD_REFRESH
+#define LCD_REFRESH             0
+#endif
+
+typedef struct {
+    uint32_t    pixelclock;                 ///< Hz
+    uint32_t    refresh;                    ///< 1/100 Hz
+    uint32_t    htotal;                     ///< pixel clocks per line
+    uint32_t    vtotal;                     ///< lines per frame
+    uint32_t    bytesperframe;              ///< read from the enabled layers
+    uint32_t    bandwidth;                  ///< bytes/s
+    uint32_t    peak;                       ///< bytes/s in the active part of a line
+    uint32_t    sdrampermille;              ///< share of the SDRAM peak bandwidth
+    uint32_t    underruns;                  ///< FIFO underruns since LCD_Init
+    uint32_t    transfererrors;             ///< since LCD_Init
+} LCD_Bandwidth_t;
+
+int      LCD_SetRefreshRate(unsigned hz);
+unsigned LCD_GetRefreshRate(void);
+unsigned LCD_MeasureRefreshRate(unsigned ms);
+void     LCD_GetBandwidth(LCD_Bandwidth_t *bw);
+///@}
+
+void LCD_SetAcceleration(int layer, int on);
+void LCD_WaitDrawing(void);
 #endif
 
@@ -0,0 +1,82 @@
+/**
+ * @file    logo.c
+ *
+ * @note    Generated by imgconv from logo.pam
+ *
+ * @note    120x80 rgb565, RLE: 996 bytes (raw 19200 bytes)
+ */
+
+#include <stdint.h>
+
+#include "lcd.h"
+#include "image.h"
+
+static const uint8_t logo_data[996] = {
+    0xF7, 0x7B, 0x04, 0xF7, 0x7B, 0x04, 0xF7, 0x7B, 0x04, 0xF7, 0x7B, 0x04, 0xF7, 0x7B, 0x04, 0xF7,
+    0x7B, 0x04, 0xF7, 0x7B, 0x04, 0xB3, 0x7B, 0x04, 0x90, 0x00, 0x00, 0xB2, 0x7B, 0x04, 0xB0, 0x7B,
+    0x04, 0x96, 0x00, 0x00, 0xAF, 0x7B, 0x04, 0xAE, 0x7B, 0x04, 0x9A, 0x00, 0x00, 0xAD, 0x7B, 0x04,
+    0xAC, 0xD6, 0x02, 0x9E, 0x00, 0x00, 0xAB, 0xD6, 0x02, 0xAA, 0xD6, 0x02, 0x89, 0x00, 0x00, 0x8E,
+    0x40, 0xFE, 0x89, 0x00, 0x00, 0xA9, 0xD6, 0x02, 0xA8, 0xD6, 0x02, 0x88, 0x00, 0x00, 0x94, 0x40,
+    0xFE, 0x88, 0x00, 0x00, 0xA7, 0xD6, 0x02, 0xA7, 0xD6, 0x02, 0x86, 0x00, 0x00, 0x9A, 0x40, 0xFE,
+    0x86, 0x00, 0x00, 0xA6, 0xD6, 0x02, 0xA6, 0xD6, 0x02, 0x86, 0x00, 0x00, 0x9C, 0x40, 0xFE, 0x86,
+    0x00, 0x00, 0xA5, 0xD6, 0x02, 0xA4, 0xD6, 0x02, 0x86, 0x00, 0x00, 0xA0, 0x40, 0xFE, 0x86, 0x00,
+    0x00, 0xA3, 0xD6, 0x02, 0xA3, 0xD6, 0x02, 0x86, 0x00, 0x00, 0xA2, 0x40, 0xFE, 0x86, 0x00, 0x00,
+    0xA2, 0xD6, 0x02, 0xA2, 0xD6, 0x02, 0x85, 0x00, 0x00, 0xA6, 0x40, 0xFE, 0x85, 0x00, 0x00, 0xA1,
+    0xD6, 0x02, 0xA2, 0xD6, 0x02, 0x84, 0x00, 0x00, 0xA8, 0x40, 0xFE, 0x84, 0x00, 0x00, 0xA1, 0xD6,
+    0x02, 0xA1, 0xD6, 0x02, 0x84, 0x00, 0x00, 0xAA, 0x40, 0xFE, 0x84, 0x00, 0x00, 0xA0, 0xD6, 0x02,
+    0xA0, 0x7B, 0x04, 0x84, 0x00, 0x00, 0xAC, 0x40, 0xFE, 0x84, 0x00, 0x00, 0x9F, 0x7B, 0x04, 0x9F,
+    0x7B, 0x04, 0x84, 0x00, 0x00, 0xAE, 0x40, 0xFE, 0x84, 0x00, 0x00, 0x9E, 0x7B, 0x04, 0x9F, 0x7B,
+    0x04, 0x84, 0x00, 0x00, 0xAE, 0x40, 0xFE, 0x84, 0x00, 0x00, 0x9E, 0x7B, 0x04, 0x9E, 0x7B, 0x04,
+    0x84, 0x00, 0x00, 0xB0, 0x40, 0xFE, 0x84, 0x00, 0x00, 0x9D, 0x7B, 0x04, 0x9E, 0x7B, 0x04, 0x83,
+    0x00, 0x00, 0xB2, 0x40, 0xFE, 0x83, 0x00, 0x00, 0x9D, 0x7B, 0x04, 0x9D, 0x7B, 0x04, 0x84, 0x00,
+    0x00, 0xB2, 0x40, 0xFE, 0x84, 0x00, 0x00, 0x9C, 0x7B, 0x04, 0x9D, 0x7B, 0x04, 0x83, 0x00, 0x00,
+    0xB4, 0x40, 0xFE, 0x83, 0x00, 0x00, 0x9C, 0x7B, 0x04, 0x9C, 0x7B, 0x04, 0x83, 0x00, 0x00, 0xB6,
+    0x40, 0xFE, 0x83, 0x00, 0x00, 0x9B, 0x7B, 0x04, 0x9C, 0x7B, 0x04, 0x83, 0x00, 0x00, 0xB6, 0x40,
+    0xFE, 0x83, 0x00, 0x00, 0x9B, 0x7B, 0x04, 0x9B, 0x7B, 0x04, 0x84, 0x00, 0x00, 0xB6, 0x40, 0xFE,
+    0x84, 0x00, 0x00, 0x9A, 0x7B, 0x04, 0x9B, 0xD6, 0x02, 0x83, 0x00, 0x00, 0xB8, 0x40, 0xFE, 0x83,
+    0x00, 0x00, 0x9A, 0xD6, 0x02, 0x9B, 0xD6, 0x02, 0x83, 0x00, 0x00, 0xB8, 0x40, 0xFE, 0x83, 0x00,
+    0x00, 0x9A, 0xD6, 0x02, 0x9A, 0xD6, 0x02, 0x84, 0x00, 0x00, 0xB8, 0x40, 0xFE, 0x84, 0x00, 0x00,
+    0x99, 0xD6, 0x02, 0x9A, 0xD6, 0x02, 0x83, 0x00, 0x00, 0xBA, 0x40, 0xFE, 0x83, 0x00, 0x00, 0x99,
+    0xD6, 0x02, 0x9A, 0xD6, 0x02, 0x83, 0x00, 0x00, 0xBA, 0x40, 0xFE, 0x83, 0x00, 0x00, 0x99, 0xD6,
+    0x02, 0x9A, 0xD6, 0x02, 0x83, 0x00, 0x00, 0xBA, 0x40, 0xFE, 0x83, 0x00, 0x00, 0x99, 0xD6, 0x02,
+    0x9A, 0xD6, 0x02, 0x83, 0x00, 0x00, 0xBA, 0x40, 0xFE, 0x83, 0x00, 0x00, 0x99, 0xD6, 0x02, 0x9A,
+    0xD6, 0x02, 0x83, 0x00, 0x00, 0xBA, 0x40, 0xFE, 0x83, 0x00, 0x00, 0x99, 0xD6, 0x02, 0x9A, 0xD6,
+    0x02, 0x83, 0x00, 0x00, 0xBA, 0x40, 0xFE, 0x83, 0x00, 0x00, 0x99, 0xD6, 0x02, 0x9A, 0xD6, 0x02,
+    0x83, 0x00, 0x00, 0xBA, 0x40, 0xFE, 0x83, 0x00, 0x00, 0x99, 0xD6, 0x02, 0x9A, 0x7B, 0x04, 0x83,
+    0x00, 0x00, 0xBA, 0x40, 0xFE, 0x83, 0x00, 0x00, 0x99, 0x7B, 0x04, 0x9A, 0x7B, 0x04, 0x83, 0x00,
+    0x00, 0xBA, 0x40, 0xFE, 0x83, 0x00, 0x00, 0x99, 0x7B, 0x04, 0x9A, 0x7B, 0x04, 0x83, 0x00, 0x00,
+    0xBA, 0x40, 0xFE, 0x83, 0x00, 0x00, 0x99, 0x7B, 0x04, 0x9A, 0x7B, 0x04, 0x83, 0x00, 0x00, 0xBA,
+    0x40, 0xFE, 0x83, 0x00, 0x00, 0x99, 0x7B, 0x04, 0x9A, 0x7B, 0x04, 0x83, 0x00, 0x00, 0xBA, 0x40,
+    0xFE, 0x83, 0x00, 0x00, 0x99, 0x7B, 0x04, 0x9A, 0x7B, 0x04, 0x83, 0x00, 0x00, 0xBA, 0x40, 0xFE,
+    0x83, 0x00, 0x00, 0x99, 0x7B, 0x04, 0x9A, 0x7B, 0x04, 0x83, 0x00, 0x00, 0xBA, 0x40, 0xFE, 0x83,
+    0x00, 0x00, 0x99, 0x7B, 0x04, 0x9A, 0x7B, 0x04, 0x83, 0x00, 0x00, 0xBA, 0x40, 0xFE, 0x83, 0x00,
+    0x00, 0x99, 0x7B, 0x04, 0x9A, 0x7B, 0x04, 0x84, 0x00, 0x00, 0xB8, 0x40, 0xFE, 0x84, 0x00, 0x00,
+    0x99, 0x7B, 0x04, 0x9B, 0x7B, 0x04, 0x83, 0x00, 0x00, 0xB8, 0x40, 0xFE, 0x83, 0x00, 0x00, 0x9A,
+    0x7B, 0x04, 0x9B, 0xD6, 0x02, 0x83, 0x00, 0x00, 0xB8, 0x40, 0xFE, 0x83, 0x00, 0x00, 0x9A, 0xD6,
+    0x02, 0x9B, 0xD6, 0x02, 0x84, 0x00, 0x00, 0xB6, 0x40, 0xFE, 0x84, 0x00, 0x00, 0x9A, 0xD6, 0x02,
+    0x9C, 0xD6, 0x02, 0x83, 0x00, 0x00, 0xB6, 0x40, 0xFE, 0x83, 0x00, 0x00, 0x9B, 0xD6, 0x02, 0x9C,
+    0xD6, 0x02, 0x83, 0x00, 0x00, 0xB6, 0x40, 0xFE, 0x83, 0x00, 0x00, 0x9B, 0xD6, 0x02, 0x9D, 0xD6,
+    0x02, 0x83, 0x00, 0x00, 0xB4, 0x40, 0xFE, 0x83, 0x00, 0x00, 0x9C, 0xD6, 0x02, 0x9D, 0xD6, 0x02,
+    0x84, 0x00, 0x00, 0xB2, 0x40, 0xFE, 0x84, 0x00, 0x00, 0x9C, 0xD6, 0x02, 0x9E, 0xD6, 0x02, 0x83,
+    0x00, 0x00, 0xB2, 0x40, 0xFE, 0x83, 0x00, 0x00, 0x9D, 0xD6, 0x02, 0x9E, 0xD6, 0x02, 0x84, 0x00,
+    0x00, 0xB0, 0x40, 0xFE, 0x84, 0x00, 0x00, 0x9D, 0xD6, 0x02, 0x9F, 0xD6, 0x02, 0x84, 0x00, 0x00,
+    0xAE, 0x40, 0xFE, 0x84, 0x00, 0x00, 0x9E, 0xD6, 0x02, 0x9F, 0xD6, 0x02, 0x84, 0x00, 0x00, 0xAE,
+    0x40, 0xFE, 0x84, 0x00, 0x00, 0x9E, 0xD6, 0x02, 0xA0, 0x7B, 0x04, 0x84, 0x00, 0x00, 0xAC, 0x40,
+    0xFE, 0x84, 0x00, 0x00, 0x9F, 0x7B, 0x04, 0xA1, 0x7B, 0x04, 0x84, 0x00, 0x00, 0xAA, 0x40, 0xFE,
+    0x84, 0x00, 0x00, 0xA0, 0x7B, 0x04, 0xA2, 0x7B, 0x04, 0x84, 0x00, 0x00, 0xA8, 0x40, 0xFE, 0x84,
+    0x00, 0x00, 0xA1, 0x7B, 0x04, 0xA2, 0x7B, 0x04, 0x85, 0x00, 0x00, 0xA6, 0x40, 0xFE, 0x85, 0x00,
+    0x00, 0xA1, 0x7B, 0x04, 0xA3, 0x7B, 0x04, 0x86, 0x00, 0x00, 0xA2, 0x40, 0xFE, 0x86, 0x00, 0x00,
+    0xA2, 0x7B, 0x04, 0xA4, 0x7B, 0x04, 0x86, 0x00, 0x00, 0xA0, 0x40, 0xFE, 0x86, 0x00, 0x00, 0xA3,
+    0x7B, 0x04, 0xA6, 0x7B, 0x04, 0x86, 0x00, 0x00, 0x9C, 0x40, 0xFE, 0x86, 0x00, 0x00, 0xA5, 0x7B,
+    0x04, 0xA7, 0x7B, 0x04, 0x86, 0x00, 0x00, 0x9A, 0x40, 0xFE, 0x86, 0x00, 0x00, 0xA6, 0x7B, 0x04,
+    0xA8, 0x7B, 0x04, 0x88, 0x00, 0x00, 0x94, 0x40, 0xFE, 0x88, 0x00, 0x00, 0xA7, 0x7B, 0x04, 0xAA,
+    0x7B, 0x04, 0x89, 0x00, 0x00, 0x8E, 0x40, 0xFE, 0x89, 0x00, 0x00, 0xA9, 0x7B, 0x04, 0xAC, 0xD6,
+    0x02, 0x9E, 0x00, 0x00, 0xAB, 0xD6, 0x02, 0xAE, 0xD6, 0x02, 0x9A, 0x00, 0x00, 0xAD, 0xD6, 0x02,
+    0xB0, 0xD6, 0x02, 0x96, 0x00, 0x00, 0xAF, 0xD6, 0x02, 0xB3, 0xD6, 0x02, 0x90, 0x00, 0x00, 0xB2,
+    0xD6, 0x02, 0xF7, 0xD6, 0x02, 0xF7, 0xD6, 0x02, 0xF7, 0xD6, 0x02, 0xF7, 0xD6, 0x02, 0xF7, 0xD6,
+    0x02, 0xF7, 0xD6, 0x02,
+};
+
+const IMAGE_Asset logo = {
+    120, 80, LCD_FORMAT_RGB565, IMAGE_RLE, 996, logo_data
+};
@@ -19,6 +19,47 @@
 #include "sdram.h"
 #include "buddy.h"
 #include "lcd.h"
+#include "text.h"
+#include "image.h"
+#include "jpeg.h"
+#include "scene.h"
+#include "dma2d.h"
+#include "sprite.h"
+#include "rotate.h"
+#include "raster.h"
+#ifdef USE_LCDCONSOLE
+#include "console.h"
+#endif
+#ifdef USE_RELHEAP
+#include "relheap.h"
+#endif
+#ifdef USE_HUD
+#include "hud.h"
+#endif
+#if defined(USE_SRAMOVERLAY) && defined(USE_LCDCONSOLE)
+#error USE_SRAMOVERLAY and USE_LCDCONSOLE both use layer 2
+#endif
+#if defined(USE_HUD) && (defined(USE_SRAMOVERLAY) || defined(USE_LCDCONSOLE))
+#error USE_HUD uses layer 2 too
+#endif
+#ifdef USE_PLLCONFIG
+#include "pllconfig.h"
+
+/**
+ * @brief   Main PLL configuration found by tools/mkpll (pllconfig.h)
+ */
+static const PLLConfiguration_t MainPLLConfiguration = PLLCONFIG_MAIN;
+#endif
+
+/**
+ * @brief   Pixel format of layer 1 (Makefile)
+ */
+#ifndef LCD_MAINFORMAT
+#define LCD_MAINFORMAT  LCD_FORMAT_RGB888
+#endif
+
+extern const IMAGE_Asset logo;
+extern const JPEG_Asset photo;
 
 
 
@@ -58,6 +99,9 @@ int verbose = 1;
 
 void messagewithconfirm(char *s) {
 int c;
+#ifdef USE_HUD
+    HUD_Poll();
+#endif
     if( ! verbose )
         return;
 
@@ -141,6 +185,74 @@ char *q;
 }
 
 
+#ifdef USE_RELHEAP
+/**
+ * @brief   relheapdemo
+ *
+ * @note    Fragments a relocatable heap of 1 MB with objects of mixed sizes,
+ *          compacts it with RelHeap_Step (as it would be done at idle time)
+ *          and allocates an object larger than any gap before. One object
+ *          stays locked, so it is not moved
+ */
+static void relheapdemo(void) {
+static const unsigned sizes[] = { 24*1024, 96*1024, 8*1024, 60*1024 };
+RELHEAP_HANDLE h[16],big;
+RELHEAP_Stats st;
+void *area;
+unsigned steps;
+int i;
+
+    area = Buddy_Alloc(1024*1024);
+    if( area == 0 || RelHeap_Init(area,1024*1024) < 0 ) {
+        printf("RelHeap: no memory\n");
+        return;
+    }
+    for(i=0;i<16;i++)
+        h[i] = RelHeap_Alloc(sizes[i%4]);
+    for(i=1;i<16;i+=2)
+        RelHeap_Free(h[i]);
+    RelHeap_Lock(h[8]);
+
+    RelHeap_GetStats(&st);
+    printf("RelHeap: %u objects, %u bytes used, largest gap %u\n",
+            st.handles,(unsigned) st.inuse,(unsigned) st.largest);
+
+    steps = 0;
+    while( RelHeap_Step() )
+        steps++;
+    RelHeap_GetStats(&st);
+    printf("RelHeap: %u steps, %u moves, %u bytes moved, largest gap %u\n",
+            steps,st.moves,(unsigned) st.bytesmoved,(unsigned) st.largest);
+
+    big = RelHeap_Alloc(st.largest);
+    printf("RelHeap: %u bytes %s\n",(unsigned) st.largest,big?"allocated":"not allocated");
+
+    RelHeap_Unlock(h[8]);
+    Buddy_Free(area);
+}
+#endif
+
+/**
+ * @brief   bandrender
+ *
+ * @note    Renders a band of a bar gauge for LCD_StartBands. The bar grows each
+ *          frame (a frame starts with band 0)
+ */
+static void bandrender(int band, int y0, int y1, void *arg) {
+volatile unsigned *frame = arg;
+int w = LCD_GetWidth(1);
+int len,y;
+
+    if( band == 0 )
+        (*frame)++;
+    len = 1+(*frame*4)%(w-1);
+    for(y=y0;y<y1;y++) {
+        LCD_DrawHorizontalLine(1,0,y,len,RGB(0,160,0));
+        LCD_DrawHorizontalLine(1,len,y,w-len,RGB(32,32,32));
+    }
+}
+
+
 /**
  * @brief   main
  *
@@ -154,15 +266,24 @@ int main(void) {
 int fbsize;
 void *fbarea1;
 void *fbarea2;
-int format = LCD_FORMAT_RGB888;
+int format = LCD_MAINFORMAT;
 
     message("Initializing LED");
     LED_Init();
 
     message("Setting clock to operating frequency");
-    SystemConfigMainPLL(&MainPLLConfiguration_200MHz);
+#ifdef USE_PLLCONFIG
+    // No search at run time. M, N, P and Q come from pllconfig.h
+    SystemConfigMainPLL(&MainPLLConfiguration);
+    RCC->DCKCFGR2 = (RCC->DCKCFGR2&~RCC_DCKCFGR2_CK48MSEL)
+                    |(PLLCONFIG_CK48MSEL<<RCC_DCKCFGR2_CK48MSEL_Pos);
+#endif
+    // Main PLL was started by SystemInit and locked meanwhile
     SystemSetCoreClock(CLOCKSRC_PLL,1);
     printf("Frequency is now %d Hz\n",SystemCoreClock);
+    printf("Boot took %u cycles (%u us at %u Hz)\n",
+            (unsigned) SystemBootCycles,
+            (unsigned) (SystemBootCycles/(HSI_FREQ/1000000)),(unsigned) HSI_FREQ);
 
     messagewithconfirm("turn OFF backlight without LCD initialization");
     LCD_TurnBacklightOff();
@@ -220,6 +341,31 @@ int format = LCD_FORMAT_RGB888;
     LCD_EnableLayer(1);
     printlayerinfo(1);
 
+    messagewithconfirm("measure the LTDC bandwidth at 50, 45 and 40 Hz");
+    {
+    static const unsigned rates[] = { 50, 45, 40 };
+    LCD_Bandwidth_t bw;
+    unsigned i,measured;
+
+    for(i=0;i<sizeof(rates)/sizeof(rates[0]);i++) {
+        if( LCD_SetRefreshRate(rates[i]) < 0 ) {
+            printf("%u Hz: not possible with this pixel clock\n",rates[i]);
+            continue;
+        }
+        LCD_GetBandwidth(&bw);
+        measured = LCD_MeasureRefreshRate(1000);
+        printf("%u Hz: %ux%u clocks, %u.%02u Hz computed, %u.%02u Hz measured\n",
+                rates[i],(unsigned) bw.htotal,(unsigned) bw.vtotal,
+                (unsigned) bw.refresh/100,(unsigned) bw.refresh%100,
+                measured/100,measured%100);
+        printf("  %u bytes/frame, %u bytes/s, peak %u bytes/s, %u.%u%% of SDRAM, %u underruns\n",
+                (unsigned) bw.bytesperframe,(unsigned) bw.bandwidth,(unsigned) bw.peak,
+                (unsigned) bw.sdrampermille/10,(unsigned) bw.sdrampermille%10,
+                (unsigned) bw.underruns);
+    }
+    LCD_SetRefreshRate(LCD_REFRESH);
+    }
+
 #define H2    48
 #define W2    32
 #define PS2   3
@@ -244,6 +390,53 @@ int format = LCD_FORMAT_RGB888;
     LCD_DisableLayer(2);
     LCD_EnableLayer(1);
 
+#ifdef USE_RELHEAP
+    messagewithconfirm("fragment and compact a relocatable heap");
+    relheapdemo();
+#endif
+
+#ifdef USE_SRAMOVERLAY
+    messagewithconfirm("put a 480x32 ARGB4444 band of layer 2 in internal SRAM");
+    {
+    LCD_Bandwidth_t bw;
+    void *band;
+
+    band = LCD_SetSRAMFrameBuffer(2,LCD_FORMAT_ARGB4444,0,LCD_DH-32,LCD_DW,32);
+    if( band == 0 ) {
+        printf("SRAM overlay: does not fit (LCD_SRAMFBSIZE in Makefile)\n");
+    } else {
+        // ARGB4444 color: alpha 14/15, dark blue
+        LCD_FillFrameBuffer(2,0xE008);
+        LCD_GetBandwidth(&bw);
+        printf("SRAM overlay at %p, %u bytes/frame, %u.%u%% of SDRAM\n",
+                band,(unsigned) bw.bytesperframe,
+                (unsigned) bw.sdrampermille/10,(unsigned) bw.sdrampermille%10);
+        messagewithconfirm("remove the band");
+    }
+    LCD_DisableLayer(2);
+    }
+#endif
+
+#ifdef USE_LCDCONSOLE
+    messagewithconfirm("use the bottom half of layer 2 as console");
+    {
+    TEXTFONT cfont = Text_CreateFont(&Text_Font5x7,16);
+
+    if( cfont == 0 || Console_Init(2,cfont,LCD_DH/2,0,RGB(255,255,255),RGB(0,0,96)) < 0 )
+        printf("Console: error\n");
+    }
+#endif
+
+#ifdef USE_HUD
+    messagewithconfirm("show the performance HUD in the top left corner of layer 2");
+    {
+    TEXTFONT hfont = Text_CreateFont(&Text_Font5x7,8);
+
+    if( hfont == 0 || HUD_Init(2,hfont,8,8,RGB(255,255,255),RGB(0,0,0)) < 0 )
+        printf("HUD: error\n");
+    }
+#endif
+
     /*
      * Show some screens
      */
@@ -325,5 +518,283 @@ int format = LCD_FORMAT_RGB888;
         LCD_DrawLine(1,120,80,-40,-60,RGB(0,0,0));
         LCD_ReloadLayerByVerticalBlanking(1);
 
+        messagewithconfirm("draw a star partially outside the layer");
+        {
+        static const LCD_Point_t star[] = {
+            { 400, 20 }, { 440, 250 }, { 340, 100 }, { 520, 100 }, { 360, 250 }, { 400, 20 }
+        };
+        LCD_DrawPolyline(1,star,sizeof(star)/sizeof(star[0]),RGB(0,0,0));
+        }
+        LCD_ReloadLayerByVerticalBlanking(1);
+
+        messagewithconfirm("fill layer 1 with text");
+        {
+        static TEXTFONT font = 0;
+        TEXT_Stats st;
+        uint32_t t0,t1;
+        int line;
+
+        if( font == 0 )
+            font = Text_CreateFont(&Text_Font5x7,16);
+        if( font ) {
+            Text_Preload(font,"0123456789.:-");
+            t0 = DWT->CYCCNT;
+            for(line=0;line<LCD_GetHeight(1);line+=16) {
+                Text_Draw(1,font,0,line,"12:34:56.789 -0123.4567 89:01:23.456 -7890.1234",RGB(0,0,0));
+            }
+            LCD_WaitDrawing();
+            t1 = DWT->CYCCNT;
+            Text_GetStats(font,&st);
+            printf("text: %u us hits=%u misses=%u\n",
+                    (unsigned) ((t1-t0)/(SystemCoreClock/1000000)),st.hits,st.misses);
+        }
+        }
+        LCD_ReloadLayerByVerticalBlanking(1);
+
+        messagewithconfirm("render a gauge in bands just ahead of the beam");
+        {
+        static volatile unsigned frame;
+        LCD_BandStats_t st;
+        int b;
+
+        frame = 0;
+        LCD_StartBands(4,bandrender,(void *) &frame);
+        while( frame < 120 ) {
+#ifdef USE_HUD
+            HUD_Idle();
+            HUD_Poll();
+#else
+            __WFI();
+#endif
+        }
+        LCD_StopBands();
+        for(b=0;b<4;b++) {
+            LCD_GetBandStats(b,&st);
+            printf("band %d: calls=%u late=%u slack min=%d last=%d lines\n",
+                    b,(unsigned) st.calls,(unsigned) st.late,(int) st.minslack,(int) st.lastslack);
+        }
+        }
+
+        messagewithconfirm("draw a compressed image");
+        {
+        uint32_t t0,t1;
+
+        t0 = DWT->CYCCNT;
+        Image_Draw(1,&logo,180,96);
+        LCD_WaitDrawing();
+        t1 = DWT->CYCCNT;
+        printf("image: %u us for %u bytes\n",
+                (unsigned) ((t1-t0)/(SystemCoreClock/1000000)),(unsigned) logo.size);
+        }
+        LCD_ReloadLayerByVerticalBlanking(1);
+
+        messagewithconfirm("draw a JPEG photo");
+        {
+        JPEG_Stats st;
+        uint32_t t0,t1;
+        int rc;
+
+        t0 = DWT->CYCCNT;
+        rc = JPEG_Draw(1,&photo,0,0);
+        LCD_WaitDrawing();
+        t1 = DWT->CYCCNT;
+        JPEG_GetStats(&st);
+        printf("jpeg: rc=%d %ux%u %u bytes, %u us (decode %u us, DMA2D wait %u us) %u MCUs %u blocks\n",
+                rc,(unsigned) photo.width,(unsigned) photo.height,(unsigned) photo.size,
+                (unsigned) ((t1-t0)/(SystemCoreClock/1000000)),
+                (unsigned) (st.cycles/(SystemCoreClock/1000000)),
+                (unsigned) (st.waitcycles/(SystemCoreClock/1000000)),
+                (unsigned) st.mcus,(unsigned) st.blocks);
+        }
+        LCD_ReloadLayerByVerticalBlanking(1);
+
+        messagewithconfirm("move an overlay over a static background");
+        {
+        static int sceneok = 0;
+        SCENE_Stats st;
+        int i,x,y;
+
+        if( !sceneok )
+            sceneok = Scene_Init(LCD_FORMAT_RGB888,LCD_FORMAT_RGB565,64,64) == 0;
+        if( sceneok ) {
+            // Background drawn once
+            LCD_FillFrameBuffer(SCENE_BACKGROUND,RGB(0,0,96));
+            for(i=0;i<8;i++)
+                LCD_DrawBox(SCENE_BACKGROUND,20+i*56,100,40,72,RGB(200,200,200),RGB(0,0,0));
+            // Overlay: a box with a black (transparent) border
+            LCD_FillFrameBuffer(SCENE_OVERLAY,0x0000);
+            LCD_DrawBox(SCENE_OVERLAY,8,8,47,47,0xF800,0xFFFF);     // RGB565 red and white
+            Scene_SetOverlayKey(1,RGB(0,0,0));
+            Scene_SetOverlayOpacity(255);
+            Scene_Present(SCENE_REDRAW_BACKGROUND|SCENE_REDRAW_OVERLAY);
+            for(i=0;i<200;i++) {
+                x = (i*3)%(LCD_GetWidth(SCENE_BACKGROUND)-64);
+                y = 104+((i&32)?(i&31):(31-(i&31)));
+                Scene_MoveOverlay(x,y);
+                Scene_Present(0);
+            }
+            Scene_GetStats(&st);
+            printf("scene: %u frames, scan out %u bytes/frame, written %u bytes (single layer %u bytes)\n",
+                    (unsigned) st.frames,(unsigned) st.scanoutbytes,
+                    (unsigned) st.totalbytes,(unsigned) st.totalsinglebytes);
+        }
+        }
+
+        messagewithconfirm("bounce sprites over layer 1");
+        {
+        static uint16_t ball[32*32] __attribute__((aligned(32)));
+        static SPRITE_Image ballimage = { ball, 32, 32, 32*2, DMA2D_ARGB4444 };
+        static void *spritebg = 0;
+        static int id[32];
+        static int dx[32], dy[32], px[32], py[32];
+        SPRITE_Stats st;
+        uint32_t t0,t1;
+        int i,j,d,f,lw,lh;
+
+        lw = LCD_GetWidth(1);
+        lh = LCD_GetHeight(1);
+        if( spritebg == 0 ) {
+            // Anti-aliased red ball in ARGB4444
+            for(i=0;i<32;i++) {
+                for(j=0;j<32;j++) {
+                    d = (2*i-31)*(2*i-31)+(2*j-31)*(2*j-31);
+                    d = d < 30*30 ? 15 : d < 32*32 ? 8 : 0;
+                    ball[i*32+j] = (d<<12)|(0xF<<8)|((d>>1)<<4)|(d>>2);
+                }
+            }
+            spritebg = Buddy_Alloc(LCD_GetPitch(1)*lh);
+        }
+        if( spritebg ) {
+            LCD_DisableLayer(SCENE_OVERLAY);
+            // What is in layer 1 now is the background
+            {
+            DECLARE_REGION(src,LCD_GetFrameBufferAddress(1),0,0,lw,lh,LCD_GetFormat(1),LCD_GetPitch(1));
+            DECLARE_REGION(dst,spritebg,0,0,lw,lh,LCD_GetFormat(1),LCD_GetPitch(1));
+            DMA2D_CopyRegion(&src,&dst);
+            LCD_WaitDrawing();
+            }
+            Sprite_Init(1,spritebg);
+            for(i=0;i<32;i++) {
+                px[i] = (i*53)%(lw-32);
+                py[i] = (i*37)%(lh-32);
+                dx[i] = 1+i%3;
+                dy[i] = 1+(i/3)%3;
+                id[i] = Sprite_Create(&ballimage,px[i],py[i],i);
+            }
+            t0 = DWT->CYCCNT;
+            for(f=0;f<200;f++) {
+                for(i=0;i<32;i++) {
+                    px[i] += dx[i];
+                    py[i] += dy[i];
+                    if( px[i] < 0 || px[i] > lw-32 ) dx[i] = -dx[i];
+                    if( py[i] < 0 || py[i] > lh-32 ) dy[i] = -dy[i];
+                    Sprite_Move(id[i],px[i],py[i]);
+                }
+                Sprite_Render();
+                LCD_WaitDrawing();
+#ifdef USE_HUD
+                HUD_Poll();
+#endif
+            }
+            t1 = DWT->CYCCNT;
+            Sprite_GetStats(&st);
+            printf("sprites: %u us/frame, %u rects %u jobs %u pixels in the last frame, %u batches\n",
+                    (unsigned) ((t1-t0)/(SystemCoreClock/1000000)/200),(unsigned) st.lastrects,
+                    (unsigned) st.lastjobs,(unsigned) st.lastpixels,(unsigned) st.batches);
+            for(i=0;i<32;i++)
+                Sprite_Destroy(id[i]);
+            Sprite_Render();
+            LCD_WaitDrawing();
+        }
+        }
+
+        messagewithconfirm("draw in portrait mode and rotate into layer 1");
+        {
+        static TEXTFONT font = 0;
+        ROTATE_Stats st;
+        char *pb;
+        uint32_t t0,t1,t2;
+        int pw,ph,pp,pf,line;
+
+        if( font == 0 )
+            font = Text_CreateFont(&Text_Font5x7,16);
+        if( font && Rotate_Init(1,ROTATE_90) == ROTATE_OK ) {
+            pb = Rotate_GetBuffer();
+            pw = Rotate_GetWidth();
+            ph = Rotate_GetHeight();
+            pp = Rotate_GetPitch();
+            pf = Rotate_GetFormat();
+            {
+            DECLARE_REGION(r,pb,0,0,pw,ph,pf,pp);
+            DMA2D_FillRegion(&r,0xFFFFFFFF);
+            }
+            for(line=0;line<ph;line+=32)
+                Text_DrawInBuffer(pb,pf,pp,pw,ph,font,0,line,"Portrait 272x480",RGB(0,0,128));
+            Rotate_AddDamage(0,0,pw,ph);
+            t0 = DWT->CYCCNT;
+            Rotate_Update();
+            t1 = DWT->CYCCNT;
+            // Only a line of text changes
+            Text_DrawInBuffer(pb,pf,pp,pw,ph,font,0,ph-16,"updated",RGB(128,0,0));
+            Rotate_AddDamage(0,ph-16,Text_GetWidth(font,"updated"),16);
+            Rotate_Update();
+            t2 = DWT->CYCCNT;
+            Rotate_GetStats(&st);
+            printf("rotate: full %u us, partial %u us (%u pixels %u tiles)\n",
+                    (unsigned) ((t1-t0)/(SystemCoreClock/1000000)),
+                    (unsigned) ((t2-t1)/(SystemCoreClock/1000000)),
+                    (unsigned) st.lastpixels,(unsigned) st.lasttiles);
+        }
+        }
+
+        messagewithconfirm("draw a dial with the scanline rasterizer");
+        {
+        static const LCD_Point_t needle[] = {
+            { 236, 132 }, { 320, 86 }, { 244, 140 }
+        };
+        // Inner and outer ends of the ticks, every 27 degrees from 135
+        static const LCD_Point_t ticks[] = {
+            { 191, 185 }, { 180, 196 }, { 173, 158 }, { 159, 162 },
+            { 171, 125 }, { 156, 123 }, { 183,  95 }, { 171,  86 },
+            { 208,  74 }, { 201,  60 }, { 240,  66 }, { 240,  51 },
+            { 272,  74 }, { 279,  60 }, { 297,  95 }, { 309,  86 },
+            { 309, 125 }, { 324, 123 }, { 307, 158 }, { 321, 162 },
+            { 289, 185 }, { 300, 196 },
+        };
+        RASTER_Stats st;
+        uint32_t t0,t1;
+        unsigned i;
+
+        LCD_FillFrameBuffer(1,0);
+        t0 = DWT->CYCCNT;
+        Raster_FillCircleAA(1,240,136,120,RGB(40,40,40));
+        Raster_FillArc(1,240,136,90,110,135,405,RGB(0,160,0));
+        Raster_FillArc(1,240,136,90,110,330,405,RGB(200,0,0));
+        for(i=0;i<sizeof(ticks)/sizeof(ticks[0]);i+=2) {
+            Raster_DrawLineAA(1,ticks[i].x,ticks[i].y,ticks[i+1].x,ticks[i+1].y,RGB(255,255,255));
+        }
+        Raster_FillPolygon(1,needle,3,RGB(255,200,0));
+        Raster_FillCircleAA(1,240,136,12,RGB(255,255,255));
+        LCD_WaitDrawing();
+        t1 = DWT->CYCCNT;
+        Raster_GetStats(&st);
+        printf("raster: %u us, %u spans (%u lines merged), %u masks\n",
+                (unsigned) ((t1-t0)/(SystemCoreClock/1000000)),(unsigned) st.spans,
+                (unsigned) st.merged,(unsigned) st.masks);
+        }
+        LCD_ReloadLayerByVerticalBlanking(1);
+
+#ifdef USE_HUD
+        {
+        HUD_Stats st;
+
+        HUD_GetStats(&st);
+        printf("hud: %u updates, %u rects %u pixels, last %u us (max %u us), %u.%u%%\n",
+                (unsigned) st.updates,(unsigned) st.rects,(unsigned) st.pixels,
+                (unsigned) (st.lastcycles/(SystemCoreClock/1000000)),
+                (unsigned) (st.maxcycles/(SystemCoreClock/1000000)),
+                (unsigned) st.permille/10,(unsigned) st.permille%10);
+        }
+#endif
     }
 }
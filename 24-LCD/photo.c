@@ -0,0 +1,664 @@
+/**
+ * @file    photo.c
+ *
+ * @note    Generated by jpgconv from photo.jpg
+ *
+ * @note    480x272 color JPEG: 10336 bytes (RGB565 261120 bytes)
+ */
+
+#include <stdint.h>
+
+#include "jpeg.h"
+
+static const uint8_t photo_data[10336] = {
+    0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x10, 0x4A, 0x46, 0x49, 0x46, 0x00, 0x01, 0x01, 0x00, 0x00, 0x01,
+    0x00, 0x01, 0x00, 0x00, 0xFF, 0xDB, 0x00, 0x43, 0x00, 0x08, 0x06, 0x06, 0x07, 0x06, 0x05, 0x08,
+    0x07, 0x07, 0x07, 0x09, 0x09, 0x08, 0x0A, 0x0C, 0x14, 0x0D, 0x0C, 0x0B, 0x0B, 0x0C, 0x19, 0x12,
+    0x13, 0x0F, 0x14, 0x1D, 0x1A, 0x1F, 0x1E, 0x1D, 0x1A, 0x1C, 0x1C, 0x20, 0x24, 0x2E, 0x27, 0x20,
+    0x22, 0x2C, 0x23, 0x1C, 0x1C, 0x28, 0x37, 0x29, 0x2C, 0x30, 0x31, 0x34, 0x34, 0x34, 0x1F, 0x27,
+    0x39, 0x3D, 0x38, 0x32, 0x3C, 0x2E, 0x33, 0x34, 0x32, 0xFF, 0xDB, 0x00, 0x43, 0x01, 0x09, 0x09,
+    0x09, 0x0C, 0x0B, 0x0C, 0x18, 0x0D, 0x0D, 0x18, 0x32, 0x21, 0x1C, 0x21, 0x32, 0x32, 0x32, 0x32,
+    0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32,
+    0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32,
+    0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0x32, 0xFF, 0xC0,
+    0x00, 0x11, 0x08, 0x01, 0x10, 0x01, 0xE0, 0x03, 0x01, 0x22, 0x00, 0x02, 0x11, 0x01, 0x03, 0x11,
+    0x01, 0xFF, 0xC4, 0x00, 0x1B, 0x00, 0x00, 0x03, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x00, 0x04, 0x05, 0x06, 0x07, 0xFF, 0xC4,
+    0x00, 0x40, 0x10, 0x00, 0x01, 0x03, 0x03, 0x03, 0x01, 0x06, 0x04, 0x04, 0x04, 0x03, 0x06, 0x07,
+    0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x11, 0x03, 0x12, 0x21, 0x04, 0x31, 0x41, 0x51, 0x05, 0x13,
+    0x22, 0x61, 0x71, 0xF0, 0x06, 0x32, 0x81, 0x91, 0x42, 0xA1, 0xB1, 0xC1, 0x14, 0xD1, 0xE1, 0xF1,
+    0x07, 0x23, 0x52, 0x15, 0x24, 0x53, 0x62, 0x92, 0xD2, 0x16, 0x33, 0x72, 0x82, 0x83, 0xA2, 0xA3,
+    0xFF, 0xC4, 0x00, 0x1A, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0xFF, 0xC4, 0x00, 0x2C,
+    0x11, 0x01, 0x00, 0x03, 0x00, 0x02, 0x02, 0x02, 0x01, 0x02, 0x05, 0x04, 0x03, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x01, 0x02, 0x11, 0x03, 0x31, 0x12, 0x21, 0x04, 0x41, 0x32, 0x05, 0x22, 0x33, 0x42,
+    0x51, 0x52, 0x61, 0x13, 0x23, 0x43, 0x71, 0x53, 0x72, 0x91, 0xFF, 0xDA, 0x00, 0x0C, 0x03, 0x01,
+    0x00, 0x02, 0x11, 0x03, 0x11, 0x00, 0x3F, 0x00, 0x9C, 0x2D, 0x0A, 0x90, 0xB4, 0x2F, 0xD9, 0xEB,
+    0xF3, 0xC9, 0xC2, 0xD0, 0xA9, 0x0B, 0x42, 0x68, 0x9C, 0x2D, 0x0A, 0x90, 0xB4, 0x26, 0x98, 0x9C,
+    0x2D, 0x0A, 0x90, 0xB4, 0x26, 0x89, 0xC2, 0xD0, 0xA9, 0x0B, 0x42, 0x68, 0x9C, 0x2D, 0x0A, 0x90,
+    0x84, 0x26, 0x84, 0x85, 0xA1, 0x3C, 0x23, 0x09, 0xA2, 0x70, 0xB4, 0x2A, 0x42, 0xD0, 0x9A, 0x62,
+    0x70, 0x8C, 0x27, 0x85, 0xA1, 0x34, 0xC2, 0x42, 0xD0, 0xA9, 0x0B, 0x42, 0x69, 0x89, 0xC2, 0xD0,
+    0xA9, 0x0B, 0x42, 0x69, 0x89, 0xC2, 0xD0, 0xA9, 0x0B, 0x42, 0x69, 0x89, 0xC2, 0xD6, 0xAA, 0x42,
+    0xD6, 0xA6, 0x98, 0x9D, 0xAB, 0x5A, 0xA9, 0x6A, 0xD6, 0xA7, 0x91, 0x89, 0xDA, 0xB5, 0xAA, 0xB6,
+    0xAD, 0x6A, 0x79, 0x18, 0x95, 0xAB, 0x5A, 0xA9, 0x6A, 0xD6, 0xA7, 0x91, 0x89, 0xDA, 0xB5, 0xAA,
+    0x96, 0xAD, 0x6A, 0x69, 0x89, 0xC2, 0xD0, 0xA9, 0x0B, 0x42, 0x69, 0x89, 0xC2, 0xD0, 0xA9, 0x0B,
+    0x42, 0x69, 0x89, 0xC2, 0xD0, 0xA9, 0x0B, 0x42, 0x69, 0x89, 0xC2, 0x10, 0xAB, 0x08, 0x42, 0x69,
+    0x89, 0xC2, 0xD0, 0xA9, 0x0B, 0x5A, 0x9A, 0x27, 0x0B, 0x42, 0xAD, 0x85, 0x1E, 0xE8, 0xA9, 0xE7,
+    0x06, 0x23, 0x0B, 0x42, 0xBF, 0x74, 0x50, 0xEE, 0xCA, 0x79, 0xC2, 0xE2, 0x30, 0xB4, 0x2A, 0x16,
+    0x90, 0xB4, 0x2B, 0xA9, 0x89, 0xC2, 0xD0, 0xA9, 0x0B, 0x42, 0x68, 0x9C, 0x2D, 0x0A, 0x90, 0xB4,
+    0x26, 0x89, 0xC2, 0xD0, 0xA9, 0x0B, 0x42, 0x68, 0x9C, 0x2D, 0x0A, 0x90, 0xB4, 0x26, 0x89, 0xC2,
+    0xD0, 0xA9, 0x0B, 0x42, 0x69, 0x8A, 0x42, 0xD0, 0x9E, 0x16, 0x85, 0xCF, 0x5A, 0xC2, 0x42, 0xD0,
+    0x9E, 0xD5, 0xA1, 0x34, 0xC2, 0x42, 0xD0, 0x9E, 0x11, 0x84, 0xD1, 0x38, 0x5A, 0x15, 0x21, 0x08,
+    0x4D, 0x31, 0x38, 0x5A, 0x15, 0x21, 0x68, 0x4D, 0x31, 0x38, 0x5A, 0x13, 0xC2, 0xD0, 0xAE, 0xA1,
+    0x21, 0x68, 0x4F, 0x0B, 0x42, 0x68, 0x48, 0x46, 0x13, 0xC2, 0xD0, 0xA6, 0xAE, 0x12, 0xD5, 0xA1,
+    0x52, 0xD5, 0xA1, 0x34, 0xC2, 0x42, 0xD0, 0xA9, 0x0B, 0x42, 0x9A, 0x62, 0x70, 0xB4, 0x2A, 0x42,
+    0xD0, 0x9A, 0x62, 0x70, 0xB4, 0x2A, 0x42, 0xD0, 0x9A, 0x62, 0x76, 0xAD, 0x6A, 0xA5, 0xA8, 0xDA,
+    0x9E, 0x46, 0x27, 0x6A, 0xD6, 0xAA, 0x5A, 0x8D, 0xAA, 0x79, 0x18, 0x9D, 0xAB, 0x5A, 0xA9, 0x6A,
+    0x36, 0xA7, 0x92, 0xE2, 0x36, 0xAD, 0x6A, 0xAD, 0xAB, 0x5A, 0x9E, 0x49, 0x88, 0xDA, 0xB5, 0xAA,
+    0xB6, 0xA1, 0x6A, 0xBE, 0x46, 0x27, 0x6A, 0xD0, 0xA9, 0x6A, 0xD6, 0xA6, 0x98, 0x9C, 0x2D, 0x6A,
+    0xA5, 0xAB, 0x5A, 0x9A, 0x62, 0x76, 0xAD, 0x6A, 0xA5, 0xAB, 0x5A, 0x9E, 0x46, 0x27, 0x08, 0x5A,
+    0xAB, 0x6A, 0x76, 0xD3, 0x95, 0x26, 0xF8, 0x44, 0x6A, 0x22, 0x99, 0x2A, 0xAD, 0xA3, 0xE4, 0xBA,
+    0x1B, 0x49, 0x55, 0xB4, 0x97, 0x9A, 0xFC, 0xEE, 0xB5, 0xE3, 0x73, 0x0A, 0x3E, 0x49, 0x85, 0x15,
+    0xD8, 0x29, 0x79, 0x27, 0x14, 0x97, 0x9A, 0xDF, 0x21, 0xD6, 0x38, 0xDC, 0x1D, 0xCF, 0x92, 0x06,
+    0x8F, 0x92, 0xF4, 0x3B, 0xAF, 0x24, 0x0D, 0x25, 0x23, 0xE4, 0x1F, 0xE9, 0xBC, 0xD7, 0x51, 0xF2,
+    0x52, 0x75, 0x25, 0xE9, 0xBA, 0x97, 0x92, 0x93, 0xA9, 0x2E, 0xF4, 0xF9, 0x0C, 0x5B, 0x8D, 0xE6,
+    0x96, 0x10, 0xB4, 0x2E, 0xC7, 0xD2, 0x50, 0x73, 0x21, 0x7A, 0xEB, 0xC9, 0x16, 0x71, 0x9A, 0xE2,
+    0x50, 0xB4, 0x27, 0x85, 0xA1, 0x6F, 0x53, 0x13, 0x85, 0xA1, 0x52, 0xD5, 0xAD, 0x4D, 0x13, 0x84,
+    0x61, 0x3D, 0xAB, 0x42, 0x69, 0x84, 0x85, 0xAD, 0x54, 0x85, 0xAD, 0x4D, 0x30, 0xF0, 0xB4, 0x2A,
+    0x42, 0x10, 0xB9, 0xEA, 0x92, 0x16, 0x84, 0xF0, 0xB4, 0x26, 0x84, 0xB5, 0x68, 0x54, 0x85, 0xA1,
+    0x34, 0x4E, 0x16, 0xB5, 0x52, 0x16, 0x84, 0xD1, 0x38, 0x42, 0x15, 0x21, 0x68, 0x4D, 0x13, 0x85,
+    0xA1, 0x3C, 0x2D, 0x09, 0xA1, 0x21, 0x68, 0x4F, 0x0B, 0x42, 0x68, 0x48, 0x46, 0x13, 0xC2, 0x30,
+    0x9A, 0x12, 0xD5, 0xA1, 0x3C, 0x23, 0x0A, 0x6A, 0xE1, 0x21, 0x68, 0x54, 0x85, 0xA1, 0x4F, 0x21,
+    0x38, 0x5A, 0x15, 0x21, 0x08, 0x4F, 0x20, 0x90, 0xB4, 0x27, 0x84, 0x61, 0x34, 0xC4, 0xED, 0x46,
+    0xD4, 0xF0, 0x8D, 0xA9, 0xE4, 0x12, 0xD4, 0x6D, 0x4F, 0x6A, 0x36, 0xA9, 0xE4, 0x62, 0x76, 0xAD,
+    0x6A, 0xAD, 0xAB, 0x5A, 0xA7, 0x92, 0xE2, 0x56, 0xA1, 0x6A, 0xAD, 0xA8, 0x5A, 0x9E, 0x46, 0x25,
+    0x6A, 0xD6, 0xAA, 0x5A, 0x84, 0x2D, 0x79, 0x26, 0x27, 0x6A, 0xD0, 0xA9, 0x0B, 0x42, 0x79, 0x18,
+    0x9C, 0x2D, 0x6A, 0xA4, 0x2D, 0x09, 0xA6, 0x27, 0x6A, 0xD6, 0xAA, 0x42, 0x21, 0xB2, 0x53, 0xC8,
+    0xC2, 0xB1, 0x92, 0xAE, 0xCA, 0x69, 0x98, 0xC5, 0xD0, 0xCA, 0x6B, 0xC9, 0xCB, 0xCA, 0xED, 0x4A,
+    0x15, 0x94, 0xD5, 0x9B, 0x49, 0x51, 0x94, 0xD7, 0x45, 0x3A, 0x45, 0xC4, 0x00, 0x09, 0x27, 0x00,
+    0x05, 0xF3, 0x79, 0x79, 0xF1, 0xE9, 0xAD, 0x10, 0x6D, 0x25, 0x41, 0x4B, 0xC9, 0x7B, 0x5A, 0x4E,
+    0xC7, 0x2E, 0x6D, 0xD5, 0xC9, 0x68, 0x23, 0x0D, 0x1B, 0xFD, 0x57, 0xA2, 0xCD, 0x16, 0x9A, 0x98,
+    0x86, 0xD0, 0x67, 0xFE, 0xE1, 0x3F, 0xAA, 0xF8, 0xBC, 0xFF, 0x00, 0xAB, 0x71, 0xD2, 0x72, 0x3D,
+    0xBD, 0xB4, 0xF8, 0x96, 0x98, 0xD9, 0xF4, 0xF9, 0x4E, 0xE9, 0x03, 0x49, 0x7D, 0x7F, 0xF0, 0xBA,
+    0x7F, 0xF8, 0x14, 0xBF, 0xE8, 0x0A, 0x15, 0xBB, 0x33, 0x4B, 0x57, 0x36, 0x58, 0x7A, 0xB3, 0x1F,
+    0x96, 0xCB, 0x95, 0x3F, 0x59, 0xA6, 0xFE, 0xE8, 0x98, 0x6E, 0x7E, 0x14, 0xE7, 0xA9, 0x7C, 0x9B,
+    0xA9, 0x28, 0xBE, 0x9A, 0xF6, 0xB5, 0x7D, 0x9D, 0x57, 0x4C, 0x64, 0x8B, 0x99, 0xFE, 0xA0, 0x31,
+    0xF5, 0xE8, 0xB8, 0x1F, 0x4D, 0x7D, 0x8E, 0x0F, 0x95, 0x5B, 0xC7, 0x95, 0x67, 0x61, 0xE3, 0xE4,
+    0xE2, 0x9A, 0xCE, 0x4B, 0xCC, 0x7D, 0x35, 0xCE, 0xFA, 0x6B, 0xD3, 0x7D, 0x35, 0xCC, 0xF6, 0x2F,
+    0xA9, 0xC3, 0xCC, 0xF2, 0xDE, 0x8F, 0x39, 0xCC, 0x82, 0x85, 0xAB, 0xA6, 0xA3, 0x14, 0xAD, 0x5F,
+    0x42, 0xB7, 0xD8, 0x79, 0xA6, 0x31, 0x38, 0x5A, 0x13, 0xC2, 0xD0, 0xB5, 0xA8, 0x48, 0x5A, 0x13,
+    0xC2, 0xD0, 0x9A, 0x12, 0x11, 0xB5, 0x3C, 0x23, 0x0A, 0x6A, 0x9A, 0x16, 0x85, 0x48, 0x42, 0x17,
+    0x3D, 0x5C, 0x24, 0x2D, 0x09, 0xE1, 0x68, 0x4D, 0x30, 0x90, 0xB4, 0x2A, 0x42, 0xD0, 0x9A, 0x62,
+    0x70, 0xB4, 0x2A, 0x42, 0x10, 0x9A, 0x62, 0x70, 0xB4, 0x2A, 0x42, 0x10, 0xAE, 0x89, 0xC2, 0xD0,
+    0x9E, 0xD5, 0xA1, 0x34, 0xC2, 0x42, 0xD0, 0x9E, 0x11, 0xB5, 0x34, 0xC2, 0x42, 0x30, 0x9A, 0x13,
+    0x42, 0x9A, 0x61, 0x2D, 0x46, 0xD4, 0xF0, 0x8D, 0xAA, 0x6A, 0xE2, 0x76, 0xA3, 0x6A, 0x7B, 0x56,
+    0xB5, 0x34, 0xC4, 0xED, 0x5A, 0xD5, 0x4B, 0x56, 0xB5, 0x34, 0xC4, 0xED, 0x5A, 0xD5, 0x4B, 0x56,
+    0xB5, 0x3C, 0x8C, 0x24, 0x23, 0x09, 0xED, 0x44, 0x35, 0x4F, 0x23, 0x08, 0x1A, 0x8D, 0xAA, 0x81,
+    0xA8, 0x86, 0xAC, 0xEA, 0xE2, 0x76, 0xAD, 0x6A, 0xAD, 0xAB, 0x5A, 0xA7, 0x91, 0x89, 0x5A, 0x85,
+    0xAA, 0xD6, 0xA5, 0x2D, 0x57, 0xC8, 0xC4, 0xAD, 0x4B, 0x0A, 0xC5, 0xA8, 0x5A, 0xAF, 0x92, 0x62,
+    0x50, 0xB5, 0xAA, 0x96, 0xA1, 0x6A, 0xBE, 0x46, 0x12, 0xD5, 0xA1, 0x3D, 0xA8, 0xC2, 0x79, 0x18,
+    0x9C, 0x27, 0x63, 0x51, 0xB5, 0x56, 0x9B, 0x56, 0x6F, 0x6C, 0x85, 0x88, 0xF6, 0x76, 0x31, 0x74,
+    0xB1, 0x89, 0x18, 0xD5, 0xD2, 0xC6, 0xAF, 0x99, 0xCD, 0x77, 0xAA, 0x95, 0x33, 0x18, 0xBD, 0xFE,
+    0xCC, 0xD1, 0x8A, 0x54, 0xC5, 0x67, 0xB4, 0x5E, 0xEC, 0xB7, 0xC8, 0x2F, 0x37, 0x41, 0x43, 0xBD,
+    0xD5, 0x53, 0x69, 0x12, 0x01, 0x93, 0x89, 0xC0, 0x5F, 0x44, 0xBF, 0x31, 0xFA, 0xAF, 0xC9, 0x98,
+    0xFF, 0x00, 0x6A, 0xBF, 0x7D, 0xBE, 0xA7, 0xC4, 0xE2, 0x8F, 0xCA, 0x59, 0x65, 0x96, 0x5F, 0x0D,
+    0xEF, 0x65, 0x96, 0x59, 0x00, 0x20, 0x38, 0x10, 0x40, 0x20, 0xE0, 0x82, 0xBE, 0x7F, 0xB4, 0x74,
+    0x7F, 0xC3, 0xD6, 0xF0, 0x8F, 0xF2, 0xDD, 0x96, 0xE7, 0xEE, 0x17, 0xD0, 0xA8, 0x6B, 0x69, 0x77,
+    0xDA, 0x4A, 0x8D, 0x89, 0x20, 0x48, 0xC4, 0xE4, 0x2F, 0x5F, 0xC2, 0xF9, 0x13, 0xC3, 0xCB, 0x1F,
+    0xD2, 0x7B, 0x71, 0xE7, 0xE3, 0x8B, 0xD7, 0xFC, 0xBE, 0x4D, 0xEC, 0x5C, 0xCF, 0x62, 0xEF, 0xA8,
+    0xD5, 0xCD, 0x51, 0xAB, 0xF6, 0x5C, 0x37, 0x7C, 0x5B, 0xD5, 0xE7, 0xD4, 0x62, 0xE7, 0x73, 0x60,
+    0xAE, 0xEA, 0x8D, 0x5C, 0xCF, 0x6E, 0x57, 0xD6, 0xE1, 0xBB, 0xC9, 0x78, 0x46, 0x10, 0x85, 0x48,
+    0x5A, 0x17, 0x7D, 0x73, 0x4E, 0x11, 0x84, 0xF0, 0xB4, 0x26, 0x85, 0x84, 0x6D, 0x4D, 0x08, 0x86,
+    0xA9, 0xA6, 0x1A, 0x16, 0x85, 0x48, 0x42, 0x16, 0x35, 0xA2, 0x42, 0xD0, 0x9E, 0xD5, 0xA1, 0x34,
+    0x24, 0x2D, 0x0A, 0x90, 0xB5, 0xA9, 0xA6, 0x27, 0x0B, 0x42, 0xA5, 0xA8, 0x42, 0x68, 0x9C, 0x21,
+    0x0A, 0xB0, 0x84, 0x2B, 0xA2, 0x50, 0xB4, 0x2A, 0x42, 0xD0, 0x9A, 0x98, 0x9C, 0x23, 0x09, 0xE1,
+    0x68, 0x4D, 0x30, 0xB0, 0x88, 0x09, 0xA1, 0x30, 0x0A, 0x6A, 0x92, 0x11, 0xB5, 0x38, 0x09, 0xAD,
+    0x53, 0x55, 0x3B, 0x56, 0xB5, 0x52, 0xD4, 0x61, 0x4D, 0x12, 0xB5, 0x6B, 0x55, 0x2D, 0x5A, 0xD4,
+    0xD1, 0x3B, 0x56, 0xB5, 0x52, 0xD5, 0xAD, 0x4D, 0x09, 0x6A, 0x21, 0xA9, 0xC3, 0x53, 0x06, 0xA9,
+    0x36, 0x30, 0x81, 0xA9, 0x83, 0x53, 0x86, 0xA6, 0x0D, 0x59, 0x9B, 0x2E, 0x27, 0x6A, 0xD6, 0xAA,
+    0xDA, 0xB5, 0xAB, 0x3E, 0x4B, 0x89, 0x5A, 0x94, 0xB5, 0x5A, 0xD4, 0x0B, 0x55, 0x8B, 0x26, 0x20,
+    0x5A, 0x85, 0xAA, 0xC5, 0xA9, 0x4B, 0x56, 0xA2, 0x53, 0x12, 0xB5, 0x0B, 0x55, 0x6D, 0x5A, 0x15,
+    0xD3, 0x12, 0xB5, 0x1B, 0x55, 0x21, 0x6B, 0x55, 0xD1, 0x3B, 0x55, 0x98, 0xD4, 0xB6, 0xAA, 0xB0,
+    0x2E, 0x5C, 0x93, 0xE9, 0xAA, 0xF6, 0xB3, 0x02, 0xE8, 0x60, 0x51, 0x60, 0x5D, 0x0C, 0x0B, 0xE6,
+    0x73, 0x4B, 0xD5, 0x47, 0xA7, 0xD9, 0x23, 0xFD, 0xE1, 0xDF, 0xFA, 0x0F, 0xEA, 0x17, 0xB0, 0xBC,
+    0x7E, 0xCB, 0x70, 0x1A, 0x92, 0x09, 0xCB, 0x9A, 0x40, 0x5E, 0xC2, 0xFC, 0x8F, 0xEA, 0x3F, 0xC7,
+    0x7D, 0x8F, 0x8D, 0xFC, 0x36, 0x59, 0x65, 0x97, 0x85, 0xE8, 0x65, 0x96, 0x59, 0x06, 0x59, 0x64,
+    0x1C, 0xE0, 0xC6, 0x97, 0x38, 0xC0, 0x02, 0x4A, 0x76, 0x3E, 0x5E, 0xA0, 0x5C, 0xCF, 0x0B, 0xAD,
+    0xEB, 0x99, 0xE1, 0x7E, 0xDB, 0x86, 0x5F, 0x0E, 0xEE, 0x4A, 0x81, 0x72, 0xD4, 0x0B, 0xB2, 0xA0,
+    0x5C, 0xCF, 0x19, 0x5F, 0x5F, 0x86, 0x5E, 0x3B, 0xA1, 0x0B, 0x5A, 0xA9, 0x0B, 0x42, 0xF4, 0xEB,
+    0x92, 0x76, 0xA3, 0x09, 0xE1, 0x68, 0x4D, 0x0B, 0x08, 0x86, 0xA6, 0x01, 0x30, 0x6A, 0x9A, 0x1A,
+    0x10, 0x85, 0x58, 0x42, 0x17, 0x3D, 0x6B, 0x13, 0x85, 0xA1, 0x52, 0x16, 0x85, 0x74, 0x4E, 0x11,
+    0x84, 0xF0, 0xB4, 0x29, 0xA6, 0x12, 0x10, 0x85, 0x48, 0x5A, 0x13, 0x4C, 0x4A, 0x10, 0x85, 0x58,
+    0x42, 0x15, 0xD4, 0x4A, 0x16, 0x85, 0x48, 0x42, 0x15, 0xD0, 0x90, 0x8C, 0x26, 0x84, 0x61, 0x34,
+    0x28, 0x08, 0x80, 0x98, 0x04, 0xC0, 0x29, 0x32, 0x14, 0x04, 0x6D, 0x4E, 0x02, 0x20, 0x2C, 0xCC,
+    0xAE, 0x12, 0x11, 0x84, 0xF6, 0xAD, 0x6A, 0x9A, 0xB8, 0x9C, 0x2D, 0x0A, 0x96, 0xAD, 0x6A, 0x69,
+    0x89, 0xC2, 0xD0, 0xA9, 0x6A, 0xD6, 0xA6, 0x98, 0x48, 0x4C, 0x1A, 0x98, 0x35, 0x30, 0x0A, 0x4D,
+    0x8C, 0x28, 0x6A, 0x60, 0x13, 0x06, 0xA6, 0x0D, 0x58, 0x99, 0x5C, 0x25, 0xAB, 0x5A, 0xAB, 0x6A,
+    0xD6, 0xAC, 0xF9, 0x2E, 0x24, 0x5A, 0x94, 0xB5, 0x58, 0xB5, 0x29, 0x6A, 0xD4, 0x59, 0x31, 0x12,
+    0xD4, 0xA5, 0xAA, 0xC5, 0xA9, 0x48, 0x5A, 0x89, 0x12, 0xB5, 0x08, 0x55, 0xB5, 0x0B, 0x56, 0xB5,
+    0x30, 0x90, 0xB5, 0xA9, 0xED, 0x46, 0xD4, 0xD3, 0x13, 0xB5, 0x51, 0x81, 0x6B, 0x53, 0x34, 0x65,
+    0x62, 0xD3, 0xB0, 0xB0, 0xAB, 0x15, 0xD8, 0xA0, 0xD5, 0x66, 0xAF, 0x07, 0x2C, 0x3D, 0x14, 0x97,
+    0x55, 0x0A, 0x86, 0x95, 0x56, 0xBC, 0x7E, 0x13, 0x3B, 0xAF, 0x7E, 0x9B, 0xDB, 0x52, 0x9B, 0x5E,
+    0xDD, 0x88, 0x95, 0xF3, 0x6D, 0x2B, 0xBF, 0x45, 0xAB, 0xEE, 0x0D, 0x8F, 0xFF, 0x00, 0xCB, 0x27,
+    0xEC, 0x57, 0xC1, 0xFD, 0x43, 0xE2, 0xCF, 0x24, 0x79, 0x57, 0xB8, 0x7D, 0x0F, 0x8D, 0xCB, 0x15,
+    0x9C, 0x9E, 0x9E, 0xBA, 0xC8, 0x31, 0xED, 0x7B, 0x43, 0x9A, 0x65, 0xA7, 0x62, 0x8A, 0xF8, 0x13,
+    0x19, 0xEA, 0x5F, 0x41, 0x96, 0x59, 0x64, 0x56, 0x5C, 0x7D, 0xA3, 0x5C, 0x53, 0xA3, 0xDD, 0x8F,
+    0x99, 0xFD, 0x0E, 0xC1, 0x5A, 0xBE, 0xA6, 0x9E, 0x9D, 0xBE, 0x23, 0x2E, 0x89, 0x0D, 0x1C, 0xAF,
+    0x12, 0xBD, 0x57, 0x55, 0xA8, 0xE7, 0xBB, 0x73, 0xD1, 0x7D, 0x0F, 0x83, 0xF1, 0x67, 0x92, 0xF1,
+    0x7B, 0x47, 0xA8, 0x79, 0xBE, 0x47, 0x2C, 0x56, 0x3C, 0x63, 0xB4, 0x1E, 0xA0, 0xF5, 0x67, 0x15,
+    0x07, 0xAF, 0xD4, 0x71, 0x55, 0xF2, 0xAF, 0x2E, 0x77, 0xA8, 0x38, 0x65, 0x74, 0x3D, 0x44, 0x85,
+    0xF5, 0x38, 0xBD, 0x43, 0xCB, 0x74, 0xE1, 0x08, 0x54, 0x85, 0xA1, 0x76, 0xD7, 0x34, 0xE1, 0x18,
+    0x4F, 0x08, 0xC2, 0x6A, 0x90, 0x04, 0xC0, 0x26, 0x01, 0x30, 0x0B, 0x33, 0x26, 0x09, 0x6A, 0x10,
+    0xA8, 0x42, 0xD0, 0xB1, 0xAD, 0x27, 0x0B, 0x42, 0x78, 0x46, 0x13, 0x50, 0x90, 0xB4, 0x27, 0x85,
+    0xA1, 0x35, 0x49, 0x08, 0x42, 0xA4, 0x2D, 0x09, 0xA2, 0x50, 0x84, 0x2A, 0xC2, 0x58, 0x57, 0x53,
+    0x13, 0x85, 0xA1, 0x3C, 0x2D, 0x0A, 0xE9, 0x84, 0x85, 0xA1, 0x3C, 0x23, 0x09, 0xA6, 0x14, 0x04,
+    0xC0, 0x22, 0x02, 0x60, 0x16, 0x66, 0x42, 0x80, 0x9A, 0x13, 0x06, 0xA6, 0x01, 0x67, 0x54, 0x96,
+    0xAD, 0x6A, 0xA5, 0xAB, 0x5A, 0xA6, 0xAE, 0x27, 0x6A, 0x10, 0xAB, 0x6A, 0x10, 0x9A, 0x98, 0x9C,
+    0x23, 0x6A, 0x78, 0x46, 0xD4, 0xD3, 0x08, 0x1A, 0x98, 0x35, 0x30, 0x6A, 0x60, 0xD5, 0x26, 0x57,
+    0x00, 0x35, 0x30, 0x6A, 0x60, 0xD4, 0xE1, 0xAB, 0x9C, 0xD9, 0x70, 0x96, 0xAD, 0x6A, 0xAD, 0xAB,
+    0x5A, 0xA7, 0x92, 0xE2, 0x25, 0xA9, 0x4B, 0x55, 0xCB, 0x52, 0x16, 0xAB, 0x16, 0x31, 0x02, 0xD4,
+    0xA4, 0x2B, 0x96, 0xA4, 0x2D, 0x5B, 0x8B, 0x33, 0x89, 0x5A, 0x85, 0xAA, 0xB6, 0xA1, 0x6A, 0xD6,
+    0x98, 0x9D, 0xA8, 0xDA, 0x9E, 0xD5, 0xA1, 0x34, 0xC2, 0x5A, 0xB4, 0x42, 0xA5, 0xAB, 0x5A, 0xA6,
+    0x98, 0xCD, 0x54, 0x6A, 0x98, 0x10, 0x9C, 0x2E, 0x3C, 0x95, 0xD6, 0xEB, 0x2A, 0xB4, 0xAA, 0x02,
+    0xA0, 0x0A, 0x70, 0xE5, 0xE3, 0xBF, 0x1B, 0xBD, 0x6C, 0xEA, 0xA5, 0xA8, 0xA9, 0x44, 0x93, 0x4D,
+    0xD1, 0x3B, 0xAE, 0xC6, 0xF6, 0xA3, 0xA3, 0xC7, 0x4C, 0x13, 0xE4, 0x61, 0x79, 0x61, 0xC8, 0xDC,
+    0xBC, 0x3C, 0xBF, 0x0F, 0x8F, 0x92, 0x76, 0xD0, 0xF4, 0x53, 0x9A, 0xD5, 0xEA, 0x5E, 0xAF, 0xFB,
+    0x50, 0x7F, 0xC2, 0xFF, 0x00, 0xED, 0xFD, 0x14, 0xAA, 0x76, 0x95, 0x57, 0x7C, 0x80, 0x30, 0x7D,
+    0xCA, 0xF3, 0xEE, 0x58, 0xB9, 0x73, 0xAF, 0xE9, 0xFC, 0x31, 0x3B, 0xE2, 0xD4, 0xFC, 0x8B, 0xCC,
+    0x76, 0x77, 0x3C, 0x92, 0x49, 0x32, 0x4F, 0x25, 0x49, 0xC5, 0x62, 0xE4, 0x85, 0xCB, 0xDF, 0x4E,
+    0x3C, 0x79, 0xED, 0x62, 0xB8, 0xA9, 0x39, 0x39, 0x2A, 0x6E, 0x2B, 0xDB, 0xC7, 0x47, 0x0B, 0x59,
+    0x27, 0x24, 0x85, 0x48, 0x5A, 0x17, 0xAE, 0x3D, 0x38, 0xCA, 0x70, 0x84, 0x2A, 0x42, 0xD0, 0xB5,
+    0xA8, 0x9C, 0x23, 0x09, 0xE1, 0x68, 0x53, 0x40, 0x0D, 0x4C, 0x02, 0x20, 0x26, 0x01, 0x49, 0x95,
+    0x12, 0x10, 0x85, 0x52, 0x12, 0xC2, 0xE7, 0xAB, 0x84, 0x85, 0xA1, 0x3C, 0x2D, 0x0A, 0xE9, 0x85,
+    0x85, 0xA1, 0x3C, 0x23, 0x0A, 0x69, 0x89, 0xC2, 0x10, 0xA9, 0x0B, 0x42, 0x69, 0x89, 0x10, 0x81,
+    0x0A, 0x84, 0x20, 0x42, 0xD4, 0x49, 0x89, 0xC2, 0x10, 0xA9, 0x08, 0x42, 0xBA, 0x84, 0x84, 0x61,
+    0x34, 0x22, 0x02, 0x68, 0x50, 0x13, 0x00, 0x98, 0x04, 0xC0, 0x2C, 0xCC, 0xAE, 0x00, 0x09, 0x83,
+    0x53, 0x00, 0x98, 0x35, 0x62, 0x65, 0x70, 0x96, 0xAD, 0x6A, 0xA5, 0xAB, 0x5A, 0xA6, 0xAE, 0x27,
+    0x6A, 0x16, 0xAA, 0xDA, 0x85, 0xA9, 0xA6, 0x27, 0x6A, 0x36, 0xA7, 0xB5, 0x1B, 0x53, 0x4C, 0x20,
+    0x6A, 0x70, 0xD4, 0x43, 0x53, 0x86, 0xAC, 0xCD, 0x8C, 0x00, 0xD4, 0xE1, 0xA8, 0x86, 0xA7, 0x0D,
+    0x58, 0x9B, 0x35, 0x84, 0xB5, 0x18, 0x54, 0xB5, 0x6B, 0x56, 0x7C, 0x97, 0x11, 0x2D, 0x4A, 0x5A,
+    0xAE, 0x5A, 0x90, 0xB5, 0x58, 0xB2, 0x62, 0x05, 0xA9, 0x4B, 0x55, 0x8B, 0x52, 0x96, 0xAE, 0x91,
+    0x64, 0xC4, 0x6D, 0x42, 0xD5, 0x5B, 0x50, 0xB5, 0x6B, 0x53, 0x13, 0xB5, 0x1B, 0x53, 0xDA, 0x8D,
+    0xA9, 0xA6, 0x27, 0x6A, 0xD6, 0xAA, 0x5A, 0xB5, 0xAA, 0x68, 0x91, 0x6A, 0x1B, 0x2A, 0x96, 0xA5,
+    0x2D, 0x57, 0x42, 0x82, 0x8C, 0xA0, 0x42, 0x12, 0xB3, 0x34, 0xD5, 0x8B, 0x1E, 0x51, 0xB9, 0x4E,
+    0x56, 0xB9, 0x73, 0x9E, 0x26, 0xE2, 0xEA, 0x5C, 0x85, 0xC9, 0x2E, 0x42, 0x52, 0x38, 0x8F, 0x33,
+    0x92, 0x94, 0x94, 0x25, 0x0D, 0xD7, 0x4A, 0xF1, 0xB3, 0x36, 0x62, 0x52, 0xC2, 0x68, 0x46, 0x17,
+    0x48, 0xF4, 0xC4, 0xFB, 0x24, 0x21, 0x0A, 0x90, 0xB4, 0x2D, 0x6A, 0x62, 0x50, 0xB4, 0x2A, 0x42,
+    0x10, 0x9A, 0x61, 0x21, 0x10, 0x13, 0x42, 0x30, 0x9A, 0x60, 0x00, 0x98, 0x35, 0x10, 0x13, 0x80,
+    0xB3, 0x32, 0xB8, 0xC4, 0x21, 0x0A, 0xA4, 0x21, 0x0B, 0x1A, 0xA9, 0xC2, 0xD0, 0xA9, 0x0B, 0x42,
+    0xBA, 0x12, 0x16, 0x85, 0x48, 0x5A, 0x14, 0xD1, 0x38, 0x42, 0x15, 0x61, 0x08, 0x4D, 0x12, 0x21,
+    0x29, 0x0A, 0xC4, 0x25, 0x21, 0x6A, 0x25, 0x31, 0x28, 0x42, 0x15, 0x21, 0x08, 0x57, 0x4C, 0x24,
+    0x22, 0x02, 0x78, 0x44, 0x04, 0xD3, 0x0A, 0x02, 0x70, 0x11, 0x01, 0x30, 0x0B, 0x33, 0x2A, 0x00,
+    0x27, 0x01, 0x10, 0x13, 0x00, 0xB1, 0x32, 0xB8, 0x5B, 0x56, 0xB5, 0x52, 0x16, 0x85, 0x9D, 0x31,
+    0x3B, 0x50, 0x85, 0x58, 0x42, 0x13, 0x4C, 0x4E, 0xD4, 0x61, 0x3C, 0x23, 0x09, 0xA6, 0x14, 0x35,
+    0x30, 0x08, 0x86, 0xA7, 0x0D, 0x59, 0x9B, 0x2E, 0x00, 0x6A, 0x70, 0xD4, 0xC1, 0xA9, 0xC3, 0x57,
+    0x39, 0xB3, 0x58, 0x5B, 0x56, 0xB5, 0x50, 0x35, 0x1B, 0x56, 0x7C, 0x97, 0x10, 0x2D, 0x4A, 0x5A,
+    0xAE, 0x5A, 0x90, 0xB5, 0x6A, 0x2C, 0x98, 0x81, 0x6A, 0x42, 0x15, 0xCB, 0x52, 0x16, 0xAD, 0xC4,
+    0xA6, 0x22, 0x5A, 0x85, 0xAA, 0xA5, 0xA8, 0x42, 0xDE, 0xA6, 0x27, 0x6A, 0x36, 0xA7, 0x84, 0x6D,
+    0x4D, 0x31, 0x3B, 0x56, 0xB5, 0x52, 0xD5, 0xAD, 0x53, 0x4C, 0x48, 0xB5, 0x29, 0x6A, 0xB1, 0x09,
+    0x48, 0x5A, 0x89, 0x4C, 0x40, 0xB5, 0x21, 0x0A, 0xE4, 0x24, 0x21, 0x6E, 0x25, 0x11, 0x21, 0x08,
+    0x55, 0x21, 0x2C, 0x2D, 0xEA, 0x12, 0x16, 0x84, 0xF0, 0xB4, 0x26, 0x85, 0x01, 0x10, 0x13, 0x00,
+    0x98, 0x05, 0x34, 0x2C, 0x23, 0x09, 0xA1, 0x18, 0x59, 0xD5, 0x24, 0x21, 0x0A, 0xB0, 0x84, 0x26,
+    0x89, 0xC2, 0x10, 0xA9, 0x0B, 0x42, 0xBA, 0x27, 0x08, 0x80, 0x9E, 0x11, 0x01, 0x34, 0x28, 0x09,
+    0xC3, 0x51, 0x01, 0x38, 0x0B, 0x13, 0x2A, 0xC4, 0x25, 0x85, 0x52, 0x10, 0x85, 0x98, 0x95, 0xC4,
+    0xE1, 0x68, 0x54, 0x85, 0xA1, 0x35, 0x30, 0x90, 0x8C, 0x27, 0x85, 0xAD, 0x53, 0x57, 0x09, 0x08,
+    0x10, 0xA9, 0x6A, 0x04, 0x2B, 0xA6, 0x24, 0x42, 0x52, 0x15, 0x88, 0x4A, 0x42, 0xB1, 0x28, 0x91,
+    0x08, 0x42, 0xA1, 0x08, 0x42, 0xD6, 0xA1, 0x21, 0x10, 0x13, 0x42, 0x60, 0x13, 0x42, 0x80, 0x9C,
+    0x04, 0x40, 0x4C, 0x02, 0xC4, 0xCA, 0xE3, 0x00, 0x98, 0x35, 0x10, 0x13, 0x80, 0xB1, 0x32, 0xD6,
+    0x16, 0x16, 0x84, 0xF0, 0x8C, 0x2C, 0xEA, 0xA7, 0x08, 0x42, 0xA5, 0xAB, 0x42, 0xBA, 0x89, 0xDA,
+    0x8C, 0x27, 0x85, 0x83, 0x53, 0x42, 0x80, 0x9C, 0x35, 0x10, 0xD5, 0x40, 0xD5, 0x89, 0xB2, 0x83,
+    0x5A, 0xBC, 0xBE, 0xDB, 0xF8, 0x87, 0x43, 0xD8, 0x54, 0x4F, 0x7E, 0xFB, 0xF5, 0x2E, 0x61, 0x75,
+    0x3A, 0x0D, 0xF9, 0x9F, 0xC6, 0x4F, 0x03, 0xCC, 0xF4, 0x31, 0x31, 0x0B, 0xCE, 0xF8, 0xB3, 0xE2,
+    0xA6, 0xF6, 0x35, 0x27, 0x68, 0xF4, 0x45, 0xAF, 0xED, 0x07, 0x8D, 0xF7, 0x14, 0x41, 0xE4, 0xF9,
+    0xF4, 0x1F, 0x53, 0x88, 0x07, 0xF3, 0x07, 0xD5, 0xAF, 0x5E, 0xBB, 0xAB, 0x6A, 0x6A, 0xD4, 0xAD,
+    0x55, 0xD1, 0x73, 0xEA, 0x38, 0xB9, 0xC7, 0x8C, 0x92, 0xBC, 0xBC, 0xBC, 0xD9, 0xEA, 0x3B, 0x5E,
+    0x9F, 0x49, 0xAD, 0xF8, 0xFB, 0xB6, 0xF5, 0x15, 0x67, 0x4E, 0x69, 0x69, 0x29, 0x82, 0x61, 0xAC,
+    0x60, 0x71, 0x23, 0x80, 0x4B, 0xA6, 0x63, 0xC8, 0x05, 0x2A, 0x5F, 0x1C, 0x76, 0xF3, 0x6A, 0x35,
+    0xCE, 0xD6, 0x35, 0xE0, 0x10, 0x4B, 0x5D, 0x45, 0x90, 0xEF, 0x23, 0x00, 0x1F, 0xB2, 0xF0, 0xC3,
+    0x43, 0xC4, 0x2A, 0xB3, 0x48, 0x41, 0x95, 0xE3, 0x9E, 0x6B, 0x7D, 0xCB, 0x9D, 0xF9, 0x7C, 0x7F,
+    0x0F, 0x6F, 0xD0, 0x3B, 0x17, 0xE3, 0x8A, 0x7A, 0xC7, 0xB2, 0x87, 0x69, 0x50, 0x14, 0x2A, 0x38,
+    0xC0, 0xAC, 0xC3, 0xFE, 0x5F, 0x3B, 0x83, 0x96, 0xF0, 0x39, 0xFA, 0x05, 0xF5, 0xC5, 0xAB, 0xF1,
+    0xA6, 0x39, 0xB4, 0x84, 0x15, 0xEE, 0xF6, 0x1F, 0xC5, 0x95, 0x3B, 0x27, 0xFC, 0x8A, 0xAC, 0x35,
+    0xF4, 0x84, 0xC8, 0x68, 0x30, 0xEA, 0x79, 0xC9, 0x6F, 0xE7, 0x8E, 0xBC, 0x8C, 0xCF, 0x4E, 0x1F,
+    0x97, 0x3B, 0x97, 0xFF, 0x00, 0xEA, 0x57, 0x96, 0x27, 0xD4, 0xBF, 0x44, 0x2D, 0x48, 0x5A, 0x9B,
+    0x4F, 0xA8, 0xA3, 0xAC, 0xD3, 0x53, 0xD4, 0x69, 0xEA, 0x36, 0xA5, 0x1A, 0x82, 0x5A, 0xE6, 0xF2,
+    0x98, 0xB5, 0x7D, 0x1A, 0xD9, 0xD7, 0x11, 0x21, 0x08, 0x55, 0x2D, 0x42, 0x16, 0xF5, 0x13, 0x84,
+    0x61, 0x3C, 0x2D, 0x6A, 0x68, 0x4B, 0x56, 0xB5, 0x52, 0xD5, 0xAD, 0x53, 0x44, 0x88, 0x4A, 0x5A,
+    0xAC, 0x5A, 0x90, 0x85, 0xA8, 0x94, 0x44, 0x84, 0x84, 0x2B, 0x10, 0x90, 0x85, 0xD2, 0x25, 0x31,
+    0x12, 0x10, 0x85, 0x52, 0x12, 0xC2, 0xDC, 0x4A, 0x27, 0x08, 0xC2, 0x68, 0x46, 0x13, 0x50, 0xA0,
+    0x26, 0x01, 0x10, 0x13, 0x00, 0xA4, 0xCA, 0x94, 0x04, 0x61, 0x3C, 0x2D, 0x0B, 0x3A, 0xB8, 0x48,
+    0x5A, 0x15, 0x21, 0x08, 0x4D, 0x31, 0x38, 0x42, 0x15, 0x21, 0x68, 0x57, 0x53, 0x13, 0x84, 0x40,
+    0x4F, 0x08, 0x80, 0x9A, 0x60, 0x00, 0x9C, 0x35, 0x60, 0x13, 0x80, 0xB1, 0x32, 0xD4, 0x43, 0x10,
+    0x96, 0x15, 0x48, 0x42, 0x16, 0x22, 0x55, 0x38, 0x5A, 0x13, 0xC2, 0x30, 0xAE, 0xA1, 0x21, 0x18,
+    0x4F, 0x0B, 0x42, 0x9A, 0xA4, 0x84, 0x21, 0x52, 0x10, 0x21, 0x34, 0x48, 0x84, 0xA4, 0x2A, 0x90,
+    0x94, 0x85, 0xA8, 0x94, 0xC4, 0x88, 0x5A, 0x13, 0x90, 0x84, 0x2D, 0x6A, 0x61, 0x61, 0x10, 0x13,
+    0x42, 0x20, 0x26, 0x98, 0x00, 0x27, 0x01, 0x60, 0x13, 0x80, 0xB1, 0x32, 0xAC, 0x02, 0x70, 0xD4,
+    0x40, 0x4E, 0x1A, 0xB9, 0xCC, 0xB5, 0x84, 0xB5, 0x1B, 0x50, 0xAF, 0x5E, 0x86, 0x95, 0x81, 0xFA,
+    0x8A, 0xD4, 0xE9, 0x30, 0x98, 0x0E, 0xA8, 0xE0, 0xD0, 0x4F, 0x4C, 0xAE, 0x73, 0xDA, 0xDD, 0x98,
+    0x37, 0xED, 0x1D, 0x20, 0xFF, 0x00, 0xE7, 0x6F, 0xF3, 0x58, 0x9B, 0xC4, 0x77, 0x23, 0xA2, 0xD5,
+    0xA1, 0x3B, 0x1C, 0xCA, 0xB4, 0xDB, 0x52, 0x9B, 0x9A, 0xF6, 0x38, 0x07, 0x35, 0xCD, 0x32, 0x08,
+    0x3C, 0x82, 0x8D, 0xAB, 0x5A, 0x27, 0x0B, 0x06, 0xAA, 0x42, 0x4A, 0xD5, 0x68, 0xE9, 0xA9, 0x3A,
+    0xAD, 0x7A, 0xAC, 0xA5, 0x4D, 0xBB, 0xBD, 0xEE, 0x0D, 0x03, 0x8D, 0xCA, 0x79, 0x18, 0x60, 0xD5,
+    0xF2, 0x3F, 0x13, 0x7C, 0x64, 0x3B, 0x39, 0xF5, 0x74, 0x1D, 0x9A, 0xD6, 0xD5, 0xD5, 0x00, 0x5A,
+    0xFA, 0xC4, 0xCB, 0x68, 0xBB, 0xA0, 0x1F, 0x88, 0x8C, 0xF9, 0x03, 0x1B, 0xE4, 0x2F, 0x3F, 0xB7,
+    0xBE, 0x37, 0xAB, 0x5D, 0xAF, 0xD3, 0x76, 0x40, 0x75, 0x3A, 0x44, 0x16, 0xBF, 0x50, 0xE1, 0x0F,
+    0x39, 0xDD, 0x99, 0xC6, 0x39, 0x39, 0xCF, 0x04, 0x2F, 0x90, 0xA6, 0x00, 0x10, 0xBC, 0x5C, 0xDF,
+    0x27, 0x3D, 0x51, 0x26, 0xF5, 0xAF, 0xE5, 0x28, 0x87, 0x3D, 0xF5, 0x1D, 0x52, 0xAB, 0x9C, 0xFA,
+    0x8F, 0x25, 0xCE, 0x73, 0x8C, 0x97, 0x13, 0xB9, 0x25, 0x58, 0x51, 0xEF, 0x36, 0x54, 0xEE, 0x2E,
+    0xC8, 0x4C, 0x08, 0xA3, 0xBA, 0xF0, 0xCD, 0xF7, 0xA7, 0x9A, 0xDC, 0xB7, 0xB7, 0xED, 0xFA, 0x2B,
+    0x28, 0x77, 0x79, 0x2A, 0x8E, 0xD4, 0xB5, 0xA2, 0x14, 0x6A, 0xEA, 0x83, 0x84, 0x05, 0xC4, 0xFB,
+    0x89, 0x94, 0x8A, 0x4D, 0xBF, 0x22, 0xB4, 0xB4, 0x7E, 0x1D, 0x3A, 0x2A, 0xB8, 0xBF, 0x21, 0x43,
+    0xBD, 0x2C, 0xDD, 0x28, 0xAB, 0x6E, 0x0A, 0x3D, 0xD9, 0xAD, 0xB2, 0xEB, 0x15, 0x88, 0xED, 0xDA,
+    0x29, 0x4A, 0x7E, 0xE8, 0xED, 0xED, 0x7C, 0x3F, 0xF1, 0x4E, 0xAB, 0xB1, 0x2B, 0xB8, 0x31, 0x9D,
+    0xFE, 0x9A, 0xA6, 0x5F, 0x40, 0xBA, 0x04, 0xF0, 0x41, 0xCC, 0x1F, 0xD4, 0x7D, 0x23, 0xF5, 0x4E,
+    0xCE, 0xED, 0x0D, 0x37, 0x6A, 0xE8, 0x99, 0xAB, 0xD2, 0xBE, 0xEA, 0x6E, 0xDC, 0x1C, 0x39, 0xA7,
+    0x90, 0x47, 0x05, 0x7E, 0x2F, 0x4B, 0x4A, 0x59, 0x92, 0xBD, 0x5E, 0xCD, 0xED, 0x2A, 0xDD, 0x97,
+    0xAA, 0x66, 0xA3, 0x4C, 0xFB, 0x6A, 0x37, 0x04, 0x1D, 0x9C, 0x39, 0x04, 0x72, 0x17, 0x4A, 0x7C,
+    0x8F, 0x09, 0xCE, 0xE0, 0xFF, 0x00, 0x5A, 0x3F, 0x9D, 0xFA, 0xE1, 0x6A, 0x16, 0xAF, 0x9B, 0xEC,
+    0xEF, 0x8D, 0x74, 0x55, 0xE9, 0xDB, 0xAF, 0x61, 0xD3, 0x54, 0x03, 0x2E, 0x68, 0x2E, 0x63, 0xB6,
+    0xDA, 0x32, 0x39, 0xC7, 0x96, 0xEB, 0xD9, 0x3D, 0xB5, 0xD9, 0x2D, 0xDF, 0xB5, 0x34, 0x43, 0xD7,
+    0x50, 0xCF, 0xE6, 0xBD, 0xD4, 0xE6, 0xA5, 0xA3, 0x62, 0x5B, 0x89, 0x89, 0x8D, 0x75, 0xDA, 0x8D,
+    0xAB, 0x81, 0xFD, 0xBF, 0xD8, 0xD4, 0xE9, 0xB9, 0xE7, 0xB5, 0x74, 0x44, 0x34, 0x12, 0x43, 0x6B,
+    0xB5, 0xC7, 0x1D, 0x00, 0x32, 0x7D, 0x02, 0xF2, 0xF5, 0x3F, 0x1D, 0xF6, 0x1E, 0x9E, 0xCE, 0xED,
+    0xF5, 0xF5, 0x37, 0x4C, 0xF7, 0x54, 0x88, 0xB7, 0xD6, 0xE8, 0xFC, 0x95, 0x9E, 0x4A, 0xC7, 0x72,
+    0xD4, 0x43, 0xE8, 0xED, 0x5A, 0xD5, 0xF0, 0xEE, 0xFF, 0x00, 0x12, 0x69, 0xF7, 0x8E, 0x14, 0xFB,
+    0x29, 0xC5, 0x92, 0x6D, 0x2E, 0xAF, 0x04, 0x8E, 0x24, 0x5A, 0x63, 0xEE, 0x57, 0x4E, 0x97, 0xFC,
+    0x40, 0xA3, 0x56, 0xA1, 0x1A, 0x8E, 0xCE, 0xAB, 0x4D, 0x91, 0x83, 0x4E, 0xA0, 0x79, 0x9F, 0x42,
+    0x07, 0xEA, 0xB1, 0x3F, 0x22, 0x91, 0xF6, 0xCF, 0x95, 0x7F, 0xAB, 0xEB, 0x8B, 0x52, 0x10, 0xA3,
+    0xA2, 0xED, 0x5D, 0x07, 0x69, 0x5C, 0x34, 0x9A, 0x96, 0x54, 0x73, 0x77, 0x6E, 0x5A, 0xE8, 0xC6,
+    0x60, 0xE6, 0x32, 0x32, 0xBA, 0x8B, 0x57, 0x5A, 0xDE, 0x27, 0xDC, 0x2A, 0x04, 0x24, 0x21, 0x58,
+    0x84, 0x84, 0x2E, 0xB1, 0x28, 0x89, 0x09, 0x61, 0x54, 0x84, 0xB0, 0xB7, 0x12, 0xCE, 0x12, 0x16,
+    0x84, 0xF0, 0xB4, 0x2B, 0xA6, 0x14, 0x04, 0xC0, 0x26, 0x01, 0x30, 0x0A, 0x4C, 0xAE, 0x14, 0x04,
+    0x61, 0x30, 0x08, 0xC2, 0xCE, 0x84, 0x85, 0xA1, 0x52, 0x10, 0x85, 0x35, 0x53, 0x84, 0x21, 0x52,
+    0x10, 0x85, 0x75, 0x30, 0x90, 0x88, 0x09, 0xA1, 0x30, 0x09, 0xA0, 0x00, 0x9D, 0xA1, 0x60, 0x15,
+    0x1A, 0xD5, 0x89, 0x95, 0x02, 0x12, 0xC2, 0x8F, 0x67, 0xF6, 0x96, 0x93, 0xB5, 0x74, 0xCD, 0xAF,
+    0xA5, 0xAA, 0x1C, 0x08, 0x05, 0xCC, 0x27, 0xC4, 0xCF, 0x27, 0x0E, 0x36, 0x3F, 0xB2, 0xEA, 0x85,
+    0x8A, 0xDA, 0x26, 0x36, 0x15, 0x38, 0x5A, 0x15, 0x21, 0x68, 0x57, 0x4C, 0x24, 0x23, 0x6A, 0x78,
+    0x46, 0x13, 0x4C, 0x4E, 0x10, 0x21, 0x56, 0x12, 0x90, 0x9A, 0x62, 0x44, 0x24, 0x21, 0x58, 0x84,
+    0xA4, 0x2D, 0x44, 0xA2, 0x44, 0x21, 0x0A, 0x84, 0x21, 0x0B, 0x5A, 0x12, 0x11, 0x01, 0x34, 0x22,
+    0x02, 0x68, 0xC0, 0x27, 0x01, 0x60, 0x10, 0xAF, 0x5E, 0x8E, 0x93, 0x4E, 0xFD, 0x46, 0xA2, 0xA0,
+    0xA7, 0x49, 0x82, 0x5C, 0xE3, 0xC2, 0xC5, 0xAD, 0x8A, 0x35, 0x2A, 0xD2, 0xD3, 0xD2, 0x35, 0x6B,
+    0xD4, 0x65, 0x2A, 0x6D, 0xDD, 0xEF, 0x70, 0x68, 0x1F, 0x52, 0xBE, 0x23, 0xB6, 0xFE, 0x2F, 0xD4,
+    0x6A, 0x6E, 0xD3, 0xF6, 0x59, 0x34, 0x68, 0x82, 0x41, 0xAF, 0xF8, 0x9E, 0x22, 0x31, 0x8F, 0x0F,
+    0x3E, 0x7B, 0x6C, 0xBC, 0xBF, 0x88, 0x7B, 0x72, 0xBF, 0x6C, 0xEA, 0x06, 0xF4, 0xF4, 0x94, 0xCC,
+    0xD3, 0xA5, 0xD7, 0xFE, 0x67, 0x79, 0xFE, 0x9F, 0x72, 0x7C, 0x47, 0x6A, 0xC3, 0x04, 0x2F, 0x99,
+    0xCD, 0xF2, 0x6D, 0x6F, 0x5C, 0x6E, 0x16, 0xBE, 0xCE, 0x75, 0x0B, 0x55, 0xD5, 0x54, 0x75, 0x47,
+    0x55, 0xD4, 0x55, 0x7D, 0x5A, 0x8E, 0xDD, 0xEF, 0x71, 0x71, 0x3F, 0x52, 0xB9, 0xEA, 0xEA, 0x43,
+    0xC4, 0x05, 0xCD, 0x56, 0xA9, 0xAB, 0xB2, 0x84, 0x16, 0x1C, 0xAE, 0x11, 0xC7, 0xF7, 0x3D, 0xA5,
+    0x69, 0x6E, 0xA7, 0xA7, 0x45, 0x3A, 0xF5, 0xF4, 0xB5, 0x85, 0x6A, 0x15, 0x6A, 0x52, 0xA8, 0xDF,
+    0x95, 0xEC, 0x71, 0x69, 0x1C, 0x6E, 0x17, 0xA5, 0xA7, 0xF8, 0xC3, 0xB6, 0xF4, 0xB4, 0xCD, 0x3A,
+    0x7D, 0xA3, 0x55, 0xC0, 0x99, 0x9A, 0xA0, 0x54, 0x3F, 0x77, 0x02, 0x7E, 0x8B, 0xC8, 0x0F, 0xBF,
+    0x0A, 0x8C, 0xD1, 0x97, 0x19, 0x5D, 0x62, 0xDE, 0x3F, 0x6E, 0x93, 0xE3, 0xC7, 0x1F, 0xED, 0xFB,
+    0x7B, 0x6D, 0xF8, 0xC7, 0xE2, 0x4A, 0x9F, 0x2F, 0x68, 0x7F, 0xF8, 0x53, 0xFF, 0x00, 0xB5, 0x79,
+    0xB5, 0x1F, 0xAA, 0xD4, 0xD5, 0x15, 0x75, 0x7A, 0x8A, 0xD5, 0xEA, 0x01, 0x68, 0x75, 0x57, 0x97,
+    0x10, 0x3A, 0x49, 0xF5, 0x29, 0xA9, 0xB4, 0x52, 0x19, 0x4E, 0xE7, 0x07, 0x8C, 0x2E, 0x57, 0xE5,
+    0xB5, 0xBD, 0x7D, 0x39, 0xDB, 0x92, 0x27, 0xAE, 0xC0, 0x16, 0x91, 0x08, 0x1A, 0x51, 0x94, 0x8E,
+    0xF0, 0x65, 0x45, 0xFA, 0xC0, 0x04, 0x2C, 0x45, 0x66, 0x7A, 0x62, 0x2B, 0x3C, 0x9F, 0xC5, 0x5C,
+    0xEA, 0x45, 0x21, 0x0B, 0x96, 0xAD, 0x7E, 0xF7, 0x65, 0x17, 0x87, 0x55, 0x32, 0x16, 0x63, 0x0B,
+    0x0E, 0x57, 0x58, 0xA4, 0x47, 0xBF, 0xB7, 0x6A, 0xD2, 0x63, 0xD5, 0xBA, 0x0B, 0x5C, 0xD3, 0x25,
+    0x51, 0xAF, 0x9C, 0x2A, 0xB5, 0xB7, 0xE1, 0x59, 0x9A, 0x38, 0xCA, 0x4D, 0xE3, 0xEC, 0xB7, 0x27,
+    0x87, 0xAE, 0x24, 0x1B, 0xA4, 0x2F, 0x32, 0xBA, 0xA9, 0x52, 0x14, 0x77, 0x54, 0x6D, 0x46, 0xD2,
+    0x10, 0x54, 0xEA, 0x54, 0x0F, 0xD9, 0x72, 0x9B, 0x5A, 0xDF, 0xF4, 0xE3, 0x33, 0xBE, 0xEB, 0xDA,
+    0x8E, 0xA8, 0xD7, 0x08, 0x0A, 0x0E, 0x16, 0xE5, 0x45, 0xCF, 0x34, 0xF2, 0xA4, 0xED, 0x55, 0xD8,
+    0x5A, 0xAD, 0x27, 0xE9, 0xAA, 0xF1, 0x79, 0x7B, 0xE5, 0xED, 0x67, 0x6A, 0xC3, 0x44, 0x2E, 0x6A,
+    0x8E, 0x35, 0xB6, 0x4B, 0xDC, 0x3A, 0xA1, 0x95, 0xD1, 0x4A, 0x97, 0x77, 0xBA, 0xE9, 0x95, 0xAF,
+    0x4E, 0xDD, 0x7A, 0xBF, 0x48, 0x32, 0x8B, 0x9A, 0x64, 0xAE, 0xA6, 0x00, 0xE1, 0x0A, 0xCD, 0x60,
+    0x7E, 0x13, 0x8A, 0x16, 0x65, 0x62, 0xD7, 0xDE, 0xDC, 0xAD, 0xCB, 0x31, 0xEB, 0x8F, 0xA4, 0xDB,
+    0xA4, 0x9C, 0xAB, 0x35, 0xCD, 0xA2, 0x20, 0xA0, 0x75, 0x4D, 0x60, 0x85, 0xCD, 0x56, 0xA7, 0x79,
+    0xB2, 0xC6, 0x5A, 0xDD, 0xB9, 0xC5, 0x77, 0xDD, 0x3B, 0x75, 0x8D, 0x6D, 0x4A, 0x55, 0x45, 0x5D,
+    0x3D, 0x57, 0xD2, 0xA8, 0xDD, 0x9E, 0xC7, 0x16, 0x91, 0xF5, 0x0B, 0xEF, 0x3E, 0x1D, 0xF8, 0xC6,
+    0x8F, 0x68, 0x1A, 0x3A, 0x2D, 0x79, 0xEE, 0xF5, 0xAE, 0xF0, 0xB6, 0xA4, 0x00, 0xCA, 0xA7, 0x8F,
+    0x47, 0x1E, 0x9B, 0x74, 0xDC, 0x05, 0xF9, 0x81, 0x71, 0x61, 0x43, 0xBC, 0xEF, 0x30, 0xBD, 0x1C,
+    0x53, 0x6E, 0x3E, 0xBA, 0x7A, 0x78, 0xEB, 0xE3, 0xEE, 0xF3, 0xED, 0xFB, 0xC3, 0x9A, 0xA6, 0x42,
+    0xF9, 0x8F, 0x82, 0xFE, 0x21, 0xAB, 0xDA, 0x14, 0x0E, 0x83, 0x5F, 0x50, 0x3B, 0x53, 0x4C, 0x0E,
+    0xEA, 0xA3, 0x8F, 0x8A, 0xAB, 0x79, 0x9E, 0xA4, 0x75, 0xDC, 0x8F, 0x42, 0x57, 0xD5, 0x90, 0xBE,
+    0x97, 0x1F, 0x24, 0x5A, 0x36, 0x1B, 0x40, 0x84, 0x21, 0x54, 0x84, 0xA4, 0x2E, 0xB1, 0x28, 0x9C,
+    0x2D, 0x09, 0xE1, 0x18, 0x57, 0x42, 0x80, 0x98, 0x04, 0x40, 0x4C, 0x02, 0xCC, 0xC8, 0x00, 0x23,
+    0x09, 0x80, 0x4D, 0x0B, 0x3A, 0xB8, 0x9C, 0x2D, 0x0A, 0x96, 0xA1, 0x09, 0xA6, 0x27, 0x08, 0x42,
+    0xA4, 0x21, 0x0A, 0xE8, 0x48, 0x44, 0x04, 0xD0, 0x98, 0x04, 0xD3, 0x00, 0x05, 0xF3, 0x1F, 0x16,
+    0xF6, 0xF5, 0x5D, 0x15, 0x21, 0xA0, 0xD0, 0xD4, 0x0D, 0xD4, 0x54, 0x1F, 0xE6, 0xBD, 0xA7, 0xC5,
+    0x49, 0xBC, 0x47, 0x42, 0x7E, 0xE0, 0x7A, 0x82, 0xBA, 0x7E, 0x24, 0xF8, 0x89, 0xBD, 0x95, 0x48,
+    0xE9, 0xB4, 0xA4, 0x3B, 0x5A, 0xE1, 0xBE, 0xE2, 0x90, 0xEA, 0x7C, 0xFA, 0x0F, 0xA9, 0xF3, 0xFC,
+    0xED, 0xFA, 0xB2, 0x5C, 0xE7, 0x54, 0x71, 0x73, 0xDC, 0x49, 0x73, 0x9C, 0x64, 0x93, 0xD4, 0xAF,
+    0x07, 0xC9, 0xF9, 0x19, 0xFB, 0x29, 0xDB, 0x9D, 0xEF, 0x11, 0xFB, 0x54, 0xD3, 0x76, 0x8D, 0x6E,
+    0xCE, 0xAA, 0x2A, 0xE9, 0xEB, 0x3A, 0x95, 0x41, 0xCB, 0x4E, 0xFC, 0xC1, 0xEA, 0x31, 0xB2, 0xFA,
+    0x6E, 0xCF, 0xFF, 0x00, 0x10, 0x1C, 0xD0, 0xD6, 0x6B, 0xF4, 0xBD, 0xE0, 0x1B, 0xD5, 0xA2, 0x60,
+    0xC4, 0x7F, 0xA4, 0xE0, 0x99, 0xF3, 0x1B, 0xEC, 0xBE, 0x12, 0xA1, 0x2F, 0xC8, 0x52, 0xEF, 0x4B,
+    0x17, 0x9F, 0x8E, 0x6D, 0x4F, 0xC6, 0x59, 0xE3, 0x8B, 0xC4, 0xFE, 0xEE, 0x9F, 0xA7, 0x3B, 0xFC,
+    0x44, 0xEC, 0x86, 0x6F, 0xA7, 0xD7, 0x7F, 0xD0, 0xCF, 0xFB, 0x97, 0x8F, 0xA8, 0xFF, 0x00, 0x13,
+    0x2B, 0xBD, 0x80, 0x69, 0x3B, 0x3A, 0x95, 0x3A, 0x93, 0x93, 0x56, 0xA1, 0x78, 0x8F, 0x40, 0x1B,
+    0xFA, 0xAF, 0x89, 0xCD, 0x65, 0x5A, 0x7A, 0x32, 0xD3, 0x25, 0x76, 0x9E, 0x7B, 0x67, 0xB9, 0x74,
+    0xBD, 0xB2, 0x7F, 0x6F, 0x4F, 0x4F, 0x51, 0xF1, 0x17, 0xC4, 0x1A, 0xEB, 0x0D, 0x4E, 0xD3, 0xD4,
+    0x34, 0x36, 0x63, 0xB9, 0x22, 0x96, 0xFD, 0x6D, 0x89, 0xDB, 0x95, 0xE7, 0xD2, 0xA7, 0xDD, 0xE0,
+    0xAE, 0x86, 0x10, 0xC1, 0x09, 0x8B, 0x03, 0xF2, 0xBC, 0xD6, 0xE5, 0x9B, 0x76, 0xE3, 0x6E, 0x5F,
+    0xFC, 0x7D, 0x9A, 0x85, 0x4A, 0x94, 0xAA, 0xB6, 0xAD, 0x0A, 0xAF, 0xA5, 0x51, 0xBB, 0x3D, 0x8E,
+    0x2D, 0x23, 0xEA, 0x17, 0xD1, 0xF6, 0x67, 0xC5, 0xFD, 0xA1, 0xA2, 0xA8, 0xC6, 0xEB, 0x9F, 0xFC,
+    0x56, 0x9C, 0x43, 0x4D, 0xC0, 0x5E, 0xD0, 0x39, 0x07, 0x93, 0xEB, 0x33, 0x1B, 0x8D, 0xD7, 0xCB,
+    0x97, 0x8A, 0x2A, 0x15, 0x35, 0x97, 0xE0, 0x25, 0x2D, 0x78, 0x9D, 0xAC, 0xA5, 0x3C, 0xA6, 0x76,
+    0xD3, 0xED, 0xFB, 0x37, 0x67, 0x76, 0xA6, 0x8F, 0xB5, 0xB4, 0xC2, 0xB6, 0x92, 0xB3, 0x5F, 0x80,
+    0x5C, 0xC9, 0x17, 0x32, 0x78, 0x70, 0xE3, 0x63, 0xF6, 0xC2, 0xEA, 0x21, 0x7E, 0x1D, 0xA4, 0xD6,
+    0x6B, 0x34, 0x1A, 0x91, 0xA9, 0xD1, 0xEA, 0x2A, 0x51, 0xAA, 0x3F, 0x13, 0x0C, 0x48, 0x99, 0x83,
+    0xD4, 0x60, 0x60, 0xE1, 0x7E, 0x9B, 0xF0, 0xEF, 0xC6, 0x5A, 0x5E, 0xD8, 0xFF, 0x00, 0x77, 0xD5,
+    0x8A, 0x7A, 0x4D, 0x60, 0x80, 0x1A, 0x5F, 0xE1, 0xAA, 0x4C, 0x0F, 0x0C, 0xF3, 0x3F, 0x87, 0x27,
+    0x6D, 0xF3, 0x1F, 0x47, 0x8F, 0x9A, 0x2D, 0xEA, 0x7B, 0x7A, 0x23, 0x73, 0xF7, 0x3E, 0x88, 0x84,
+    0x21, 0x54, 0x84, 0xB0, 0xBD, 0x1A, 0xA4, 0x84, 0xC0, 0x26, 0x84, 0xB5, 0x6A, 0xD2, 0xD3, 0xD2,
+    0x75, 0x5A, 0xF5, 0x59, 0x4A, 0x9B, 0x77, 0x7B, 0xDC, 0x1A, 0x07, 0xD4, 0xA4, 0xC9, 0x82, 0xE7,
+    0x36, 0x9B, 0x1C, 0xF7, 0xB8, 0x35, 0x8D, 0x12, 0xE7, 0x38, 0xC0, 0x03, 0xA9, 0x5F, 0x99, 0xFC,
+    0x51, 0xF1, 0x03, 0xFB, 0x4F, 0x5C, 0x59, 0x4A, 0xA1, 0xFE, 0x06, 0x91, 0xFF, 0x00, 0x29, 0xB1,
+    0x17, 0x18, 0xCB, 0x8F, 0xE7, 0x1E, 0x5C, 0x0C, 0xA3, 0xF1, 0x57, 0xC5, 0xAE, 0xED, 0x1A, 0x87,
+    0x4B, 0xA4, 0x25, 0x9A, 0x16, 0x1D, 0xF6, 0x35, 0x48, 0xE4, 0xF9, 0x74, 0x1F, 0x53, 0xD0, 0x7C,
+    0xA3, 0xF5, 0x1D, 0xEE, 0x02, 0xF0, 0x73, 0xF2, 0x4D, 0xFF, 0x00, 0x6D, 0x7A, 0x62, 0xD9, 0x6F,
+    0x4B, 0x54, 0xD6, 0x83, 0x85, 0xCC, 0xF6, 0xBA, 0xA1, 0x94, 0xBD, 0xC1, 0x9B, 0x89, 0x57, 0xA6,
+    0x40, 0x1B, 0x8C, 0x6E, 0xB8, 0x7E, 0xDA, 0xF4, 0x44, 0x47, 0xFC, 0x89, 0x32, 0x59, 0xBA, 0xBB,
+    0x59, 0xDE, 0xAC, 0x5D, 0x4C, 0x90, 0x32, 0x49, 0xE8, 0x9A, 0x95, 0x70, 0xCC, 0xD9, 0x1E, 0xA6,
+    0x16, 0x66, 0xDB, 0xD3, 0x9D, 0xB9, 0x2F, 0xF8, 0xC7, 0x4A, 0x33, 0x49, 0x66, 0x57, 0x40, 0xAA,
+    0xD6, 0x08, 0x5C, 0xC7, 0x5B, 0x54, 0xB7, 0x21, 0x99, 0xDA, 0x06, 0xFD, 0x39, 0x52, 0x97, 0x38,
+    0xB8, 0xB9, 0xC0, 0xC7, 0x97, 0xE8, 0xB9, 0x7B, 0x9F, 0xC9, 0xCE, 0x6B, 0x35, 0xFC, 0x1D, 0x55,
+    0x1C, 0x1F, 0xB2, 0xE7, 0x75, 0x5E, 0xED, 0x4C, 0x9A, 0x92, 0x00, 0xC4, 0x89, 0x89, 0xD9, 0x02,
+    0x1A, 0xE7, 0x41, 0x04, 0xCE, 0x07, 0x2B, 0x51, 0x90, 0xDD, 0x69, 0x58, 0xFD, 0xDF, 0x60, 0xFD,
+    0x4F, 0x79, 0x85, 0x2F, 0xE1, 0xDC, 0xF3, 0x2A, 0x8E, 0x6B, 0x70, 0x59, 0x69, 0x83, 0xC3, 0x79,
+    0x54, 0x25, 0xC0, 0x9B, 0x0F, 0x31, 0x8C, 0xFE, 0x4B, 0xA7, 0x9E, 0x74, 0xE9, 0xE5, 0xBF, 0x94,
+    0x35, 0x36, 0xD9, 0x82, 0xBA, 0x1B, 0x48, 0x54, 0x5C, 0xC5, 0xEE, 0x2E, 0x9C, 0xCE, 0xF6, 0xF9,
+    0x2D, 0x7D, 0x46, 0x66, 0x5E, 0x07, 0x06, 0xE8, 0xFC, 0x96, 0x26, 0x66, 0x5C, 0xED, 0x6B, 0x5B,
+    0xD4, 0xCF, 0xA7, 0x6B, 0x68, 0xF7, 0x59, 0x4C, 0xED, 0x53, 0x5A, 0x21, 0x71, 0x1A, 0xB5, 0x23,
+    0xC4, 0xE7, 0x63, 0xCC, 0xA4, 0x75, 0xBB, 0x12, 0x49, 0xDE, 0x08, 0xCA, 0xCC, 0x46, 0xCF, 0xB6,
+    0x22, 0x93, 0x5F, 0xC5, 0x5A, 0x8E, 0x2F, 0xC8, 0x50, 0x35, 0x4D, 0x34, 0x66, 0x0B, 0x80, 0x27,
+    0x07, 0x7E, 0x0A, 0x15, 0x1A, 0x1C, 0xDB, 0x8E, 0x33, 0x95, 0xD2, 0x26, 0x23, 0xD4, 0xBB, 0x56,
+    0xB4, 0xAF, 0xBA, 0xF6, 0x05, 0xE6, 0xAE, 0x02, 0x2C, 0xD1, 0x99, 0x94, 0xD4, 0x83, 0x29, 0xD4,
+    0x23, 0x91, 0x95, 0xD4, 0x35, 0x54, 0xDB, 0x4E, 0x48, 0xC7, 0x92, 0x5A, 0xF9, 0xF8, 0x93, 0x6F,
+    0x2F, 0xCB, 0xB6, 0xA6, 0x03, 0x04, 0x15, 0x5E, 0xEC, 0x3F, 0x65, 0x1E, 0xFA, 0x93, 0xC4, 0xC9,
+    0x07, 0x90, 0x46, 0x42, 0xC7, 0x50, 0x29, 0xCC, 0x19, 0x5C, 0xFD, 0xCF, 0x4E, 0x1B, 0x7B, 0xCE,
+    0x5F, 0xA5, 0x71, 0x47, 0x2A, 0x55, 0x35, 0x80, 0x88, 0x0B, 0x9E, 0xA6, 0xA7, 0xBD, 0xC0, 0x50,
+    0xEE, 0x9D, 0x32, 0xBA, 0x57, 0x8E, 0x3F, 0x99, 0xD6, 0xBC, 0x73, 0x1F, 0x87, 0x4A, 0x3C, 0x17,
+    0x99, 0x4A, 0x1E, 0x59, 0xBA, 0x76, 0x3A, 0x30, 0xAC, 0xDD, 0x37, 0x7B, 0x98, 0x5A, 0x99, 0x88,
+    0xED, 0xB9, 0x9A, 0x53, 0xDF, 0x1F, 0x68, 0x86, 0x77, 0xCA, 0xF4, 0xF4, 0x65, 0x99, 0x2A, 0xEC,
+    0xA2, 0x28, 0xE4, 0xAA, 0x1A, 0xED, 0x22, 0x17, 0x29, 0xBC, 0xF5, 0x57, 0x1B, 0x5E, 0x2D, 0xF9,
+    0x76, 0xD4, 0xAB, 0x1A, 0x0E, 0x6B, 0x98, 0xE2, 0xD7, 0xB4, 0x82, 0xD7, 0x34, 0xC1, 0x07, 0xA8,
+    0x5F, 0xA2, 0xFC, 0x37, 0xF1, 0x23, 0x3B, 0x5A, 0x98, 0xD2, 0xEA, 0x4B, 0x5B, 0xAD, 0x68, 0xC7,
+    0x02, 0xA8, 0xEA, 0x3C, 0xFA, 0x8F, 0xA8, 0xF2, 0xFC, 0xC9, 0xFD, 0x50, 0xA1, 0xDA, 0x55, 0xB4,
+    0x1A, 0x86, 0x57, 0xD3, 0xD4, 0x34, 0xEA, 0xD3, 0x32, 0xD7, 0x0E, 0x17, 0x5E, 0x1B, 0x5A, 0x96,
+    0xD8, 0x6B, 0x8E, 0x79, 0x37, 0x6F, 0xD3, 0xF6, 0xD2, 0x12, 0x90, 0xBE, 0x73, 0xE1, 0x6F, 0x8B,
+    0xE9, 0x76, 0xF4, 0xE9, 0xB5, 0x2D, 0x65, 0x1D, 0x70, 0x92, 0x1A, 0xDC, 0x36, 0xA0, 0xFF, 0x00,
+    0x96, 0x79, 0x1C, 0x8F, 0xAF, 0x58, 0xFA, 0x72, 0x17, 0xD4, 0xAD, 0xE2, 0x63, 0x61, 0xE8, 0x4A,
+    0x11, 0x84, 0xF0, 0xB4, 0x2D, 0x68, 0x00, 0x2C, 0xE7, 0x32, 0x9D, 0x37, 0x3D, 0xEE, 0x6B, 0x58,
+    0xD0, 0x4B, 0x9C, 0xE3, 0x00, 0x01, 0xC9, 0x5C, 0x3D, 0xAB, 0xDB, 0x7A, 0x1E, 0xC6, 0xA3, 0x7E,
+    0xAA, 0xAF, 0x8C, 0xC5, 0xB4, 0x99, 0x05, 0xEE, 0x9E, 0x62, 0x76, 0xC1, 0xCF, 0x92, 0xFC, 0xDB,
+    0xB6, 0xBE, 0x25, 0xD5, 0x76, 0xCD, 0x42, 0x2A, 0x3A, 0xCA, 0x01, 0xD7, 0x32, 0x8B, 0x76, 0x6F,
+    0x19, 0xEA, 0x7C, 0xCF, 0x53, 0x10, 0xBC, 0xFC, 0xBC, 0xF1, 0x4F, 0x5D, 0xCB, 0x16, 0xBC, 0x57,
+    0xD7, 0xDB, 0xEB, 0xBB, 0x53, 0xE3, 0x9D, 0x26, 0x92, 0xAB, 0xE8, 0x68, 0xA9, 0x7F, 0x10, 0xF6,
+    0xCB, 0x7B, 0xD2, 0xE8, 0x64, 0xF0, 0x47, 0xFA, 0x84, 0xFA, 0x6D, 0x83, 0xCA, 0xF9, 0x4D, 0x77,
+    0xC5, 0x3D, 0xB3, 0xAC, 0x04, 0x7F, 0x1C, 0xFA, 0x4C, 0xBA, 0xE0, 0xDA, 0x3E, 0x08, 0xF2, 0x91,
+    0x98, 0xCF, 0x25, 0x78, 0x0F, 0x99, 0x95, 0x23, 0xA8, 0x8C, 0x2F, 0x25, 0xB9, 0x39, 0x2F, 0xF6,
+    0xCD, 0x62, 0xD6, 0xFE, 0x27, 0xA8, 0x7A, 0xD4, 0xFE, 0x26, 0xED, 0x7D, 0x2D, 0x51, 0x51, 0xBD,
+    0xA5, 0xA9, 0x2E, 0x6E, 0xC1, 0xF5, 0x0B, 0xC7, 0xD8, 0xC8, 0x2B, 0xD7, 0xD0, 0xFF, 0x00, 0x88,
+    0xBD, 0xA7, 0x48, 0xB1, 0xBA, 0x9A, 0x14, 0x35, 0x4C, 0x13, 0x71, 0x8B, 0x1E, 0xEE, 0x99, 0x18,
+    0x1C, 0x7E, 0x1E, 0x3E, 0xAB, 0xE4, 0x7B, 0xB3, 0x58, 0xE1, 0x5E, 0x9E, 0x94, 0xD3, 0xC9, 0x48,
+    0xE4, 0x9A, 0x7D, 0xB5, 0xB3, 0x5E, 0xBA, 0x7E, 0xA3, 0xD9, 0xDF, 0x1B, 0x76, 0x56, 0xB4, 0x35,
+    0xB5, 0x8D, 0x4D, 0x25, 0x43, 0x68, 0x8A, 0xA2, 0x5B, 0x27, 0x78, 0x70, 0xE0, 0x75, 0x30, 0xBD,
+    0xDD, 0x3E, 0xB3, 0x49, 0xAC, 0xBB, 0xF8, 0x5D, 0x55, 0x1A, 0xF6, 0x45, 0xDD, 0xD5, 0x40, 0xE8,
+    0x9D, 0xA6, 0x3D, 0x17, 0xE3, 0x6D, 0x22, 0x21, 0x37, 0x72, 0x0E, 0x55, 0x8F, 0x99, 0x68, 0xFC,
+    0xA1, 0x8B, 0x73, 0xFF, 0x00, 0x64, 0x6B, 0xF6, 0x0D, 0x4E, 0xBF, 0x45, 0xA2, 0x91, 0xA9, 0xD5,
+    0x51, 0xA4, 0xE0, 0xDB, 0xAD, 0x73, 0xC5, 0xC4, 0x79, 0x0D, 0xCE, 0xDC, 0x2F, 0x95, 0xED, 0xBF,
+    0x8D, 0x43, 0x26, 0x8F, 0x65, 0xF9, 0x1F, 0xE2, 0x1C, 0x3E, 0xE0, 0x34, 0x8F, 0x4C, 0x9F, 0x3C,
+    0x6C, 0x57, 0xC3, 0x9A, 0xE2, 0x8E, 0x17, 0x3D, 0x5D, 0x4F, 0x7B, 0x80, 0xA5, 0xBE, 0x47, 0x25,
+    0xFD, 0x47, 0xA8, 0x3C, 0xE6, 0xD1, 0x91, 0xEA, 0x5D, 0x35, 0xB5, 0xC6, 0xAB, 0x9C, 0xE7, 0xB8,
+    0xB9, 0xEE, 0x24, 0x97, 0x38, 0xC9, 0x27, 0xA9, 0x5C, 0x55, 0x25, 0xC6, 0x54, 0x8B, 0x5C, 0x0C,
+    0xA2, 0xDA, 0x9C, 0x2E, 0x71, 0x48, 0x8E, 0x96, 0xBC, 0x71, 0xFF, 0x00, 0x2B, 0x36, 0xA1, 0x18,
+    0x54, 0x6E, 0x9C, 0xD5, 0xCA, 0xBB, 0x34, 0x77, 0x66, 0x15, 0xDB, 0x14, 0x56, 0x6D, 0xC9, 0x1F,
+    0xCA, 0xCD, 0xB9, 0x67, 0xAB, 0x74, 0x95, 0x3D, 0x37, 0x75, 0x92, 0xAD, 0xDE, 0xB6, 0x21, 0x07,
+    0x56, 0x0F, 0x10, 0xB9, 0xDF, 0xE1, 0xCC, 0xAC, 0x64, 0xDB, 0xB7, 0x2F, 0xDF, 0x3F, 0x87, 0x4B,
+    0x39, 0xBC, 0xA8, 0x3F, 0x55, 0xDD, 0xE1, 0x45, 0xDA, 0xB8, 0xC2, 0x91, 0x61, 0xAC, 0x65, 0x74,
+    0x8A, 0x7F, 0x73, 0xAD, 0x78, 0xEB, 0x5F, 0x74, 0xEC, 0xEF, 0xAC, 0x6B, 0x60, 0x24, 0x14, 0x5C,
+    0x0C, 0xAA, 0x53, 0xA2, 0x59, 0x05, 0x58, 0x54, 0x6C, 0x44, 0x19, 0x1C, 0x11, 0x0B, 0x53, 0x68,
+    0xAF, 0x4E, 0x9B, 0x5E, 0xED, 0xDA, 0x6C, 0x3C, 0x2B, 0xB7, 0x4B, 0x7E, 0x54, 0x3B, 0xD0, 0x09,
+    0xB5, 0xA3, 0x69, 0x9D, 0xD3, 0x9D, 0x45, 0x41, 0x73, 0x43, 0xCC, 0x79, 0x10, 0x21, 0x73, 0xB4,
+    0xCF, 0xD3, 0x94, 0xDA, 0xF7, 0xF5, 0x7E, 0x9F, 0x59, 0xD9, 0x9F, 0x17, 0x76, 0x8F, 0x66, 0x81,
+    0x4F, 0x52, 0xEF, 0xE3, 0x28, 0x8E, 0x2A, 0xBB, 0xC6, 0x37, 0xD9, 0xDB, 0xEE, 0x79, 0x9D, 0xB8,
+    0x5F, 0x4D, 0x43, 0xE3, 0x6E, 0xC3, 0xAB, 0x48, 0xBE, 0xA5, 0x7A, 0x94, 0x20, 0xC5, 0xB5, 0x29,
+    0x12, 0x4F, 0x9F, 0x86, 0x47, 0xF6, 0x5F, 0x95, 0x97, 0x5E, 0xFB, 0x8B, 0xCB, 0x88, 0xDB, 0xAC,
+    0x7F, 0x74, 0x84, 0x12, 0xE2, 0x2E, 0x88, 0xE7, 0x6E, 0x8B, 0xA7, 0x1F, 0xC8, 0xE4, 0xAC, 0x66,
+    0xAD, 0x66, 0xD1, 0xF6, 0xFD, 0x3B, 0x5B, 0xF1, 0xF7, 0x65, 0x50, 0x6C, 0x69, 0x1B, 0x57, 0x56,
+    0xF2, 0x01, 0x10, 0x3B, 0xB6, 0xEF, 0xB1, 0x2E, 0xC8, 0xC6, 0x76, 0x3C, 0x2F, 0x88, 0xED, 0x6F,
+    0x89, 0xB5, 0xDD, 0xB4, 0x40, 0xD5, 0x55, 0x6B, 0x69, 0xB4, 0xCB, 0x28, 0xD3, 0x16, 0xB4, 0x1D,
+    0xA7, 0xAF, 0xDC, 0x98, 0x93, 0x0B, 0xC8, 0xB8, 0xD9, 0x26, 0x63, 0x8C, 0x6F, 0xFC, 0xD1, 0x32,
+    0xD7, 0x58, 0xD1, 0xBF, 0x4D, 0xBD, 0x52, 0xFC, 0xD7, 0xBF, 0xA9, 0x6F, 0xCE, 0x74, 0x08, 0x65,
+    0x4C, 0x9F, 0x10, 0xE4, 0xCE, 0xCB, 0x10, 0x00, 0x90, 0xD6, 0x4F, 0x30, 0x30, 0x8D, 0xD1, 0x82,
+    0x37, 0x33, 0x85, 0x80, 0x20, 0x5B, 0x1E, 0x22, 0x76, 0x8D, 0xFD, 0xFE, 0xEB, 0x96, 0xCB, 0x1F,
+    0xF6, 0xC4, 0x40, 0xB8, 0x8C, 0x0C, 0x44, 0xF9, 0x21, 0x70, 0x8B, 0x4F, 0xA8, 0x3B, 0x7D, 0x51,
+    0x18, 0x75, 0xC3, 0x8C, 0x63, 0x90, 0xB3, 0x9C, 0x0B, 0x64, 0x93, 0xC6, 0x0E, 0x7D, 0xF0, 0x83,
+    0x78, 0x5C, 0xC0, 0x25, 0xB8, 0xE0, 0xF4, 0x40, 0x92, 0x00, 0x69, 0x24, 0x9C, 0xCC, 0x71, 0xF5,
+    0xF5, 0x5A, 0x08, 0xF9, 0xB2, 0x1B, 0xE5, 0xB0, 0x5B, 0x37, 0x12, 0x23, 0xD9, 0x43, 0x18, 0x93,
+    0x24, 0x01, 0x3D, 0x41, 0xEB, 0xBF, 0xEC, 0x89, 0xF9, 0x5D, 0x32, 0x60, 0x81, 0x91, 0x9D, 0xD6,
+    0x6F, 0xCD, 0x70, 0xFC, 0x5B, 0xFE, 0xFE, 0xFC, 0x90, 0x98, 0x7B, 0x9D, 0xBF, 0x39, 0xDD, 0x01,
+    0x82, 0x1C, 0x70, 0x24, 0xC6, 0x76, 0xC2, 0x57, 0x41, 0x2E, 0x31, 0x8D, 0xF0, 0x7D, 0xF0, 0x98,
+    0x5C, 0xFC, 0xB8, 0xFA, 0x0E, 0x53, 0x62, 0xE3, 0x69, 0x32, 0x24, 0x13, 0x26, 0x0A, 0x80, 0x37,
+    0x06, 0x1C, 0x32, 0x4E, 0x00, 0xDF, 0xA2, 0xC1, 0xD8, 0x80, 0x2D, 0xE2, 0x27, 0x31, 0xFB, 0x2C,
+    0x01, 0xDC, 0xCC, 0xF5, 0x3D, 0x3D, 0xCA, 0x51, 0x31, 0x0D, 0x11, 0x98, 0x0A, 0xA7, 0xF8, 0x18,
+    0x36, 0x38, 0x38, 0x41, 0xEB, 0xD5, 0x19, 0x99, 0xDE, 0xD8, 0x80, 0x67, 0x74, 0x0E, 0x32, 0x3C,
+    0x32, 0x24, 0xC1, 0x9F, 0xCD, 0x17, 0x92, 0x08, 0x02, 0x0B, 0x47, 0x5F, 0x7E, 0xF0, 0x8B, 0x8C,
+    0xE3, 0x7B, 0x60, 0x8D, 0xE2, 0x08, 0x41, 0xC0, 0x8C, 0x64, 0xB8, 0x18, 0x3E, 0x68, 0xC0, 0x68,
+    0xB9, 0xB0, 0x0C, 0x62, 0x38, 0xF2, 0x2B, 0x02, 0x4C, 0xC1, 0x0D, 0xBB, 0x27, 0xF2, 0xF7, 0xF4,
+    0x50, 0x82, 0xDE, 0x0B, 0x64, 0x91, 0xE6, 0x02, 0x20, 0xB7, 0xA8, 0x93, 0x31, 0xCC, 0x0F, 0x65,
+    0x66, 0xC9, 0x69, 0x6C, 0x36, 0x06, 0xF2, 0x10, 0x6D, 0x3D, 0x84, 0x86, 0x99, 0x99, 0xFD, 0xD5,
+    0xF4, 0x0B, 0x81, 0xB8, 0x90, 0x06, 0x71, 0x11, 0x8F, 0xA7, 0x54, 0x04, 0x11, 0x82, 0x78, 0xC7,
+    0xF7, 0xDB, 0xFA, 0x23, 0x00, 0x16, 0x89, 0x31, 0x13, 0x3E, 0x8B, 0x34, 0x36, 0x61, 0xA6, 0x47,
+    0x02, 0x37, 0xFE, 0x88, 0x7D, 0x30, 0x05, 0xD2, 0x30, 0x38, 0x11, 0x9F, 0xE8, 0x99, 0xA6, 0x59,
+    0x02, 0x24, 0x71, 0x1F, 0x7F, 0xA2, 0x51, 0xBC, 0xCF, 0x1B, 0x6D, 0x0B, 0x34, 0x0B, 0x81, 0x68,
+    0xD8, 0x4C, 0x38, 0xED, 0xD1, 0x03, 0x61, 0xC3, 0xAE, 0x66, 0x16, 0xBB, 0xCF, 0x07, 0x9E, 0x12,
+    0x33, 0x6C, 0x38, 0x47, 0xA6, 0xC5, 0x39, 0x2E, 0x00, 0x00, 0x76, 0xC9, 0x1F, 0x65, 0x3A, 0x36,
+    0x63, 0xA9, 0x62, 0x58, 0xC1, 0x74, 0x5D, 0xD2, 0x04, 0x4A, 0xE9, 0x66, 0xA9, 0xB4, 0xDB, 0xF2,
+    0x99, 0xE8, 0x08, 0x2B, 0x92, 0x67, 0x6F, 0x18, 0x3D, 0x06, 0xFE, 0xFF, 0x00, 0x92, 0x60, 0x60,
+    0xDD, 0x18, 0xD9, 0x27, 0xDC, 0x7B, 0x66, 0x2B, 0x11, 0x3B, 0x1D, 0xBA, 0x6A, 0x6A, 0x5A, 0xF9,
+    0x13, 0x0B, 0x99, 0xE4, 0xB7, 0x32, 0x95, 0xED, 0x31, 0x69, 0x00, 0x1F, 0x5C, 0x9F, 0x24, 0x1A,
+    0x24, 0x89, 0x3B, 0x6E, 0x79, 0xE8, 0xAD, 0x7D, 0x42, 0xC5, 0x6B, 0x3E, 0xE6, 0x0A, 0x75, 0x27,
+    0x64, 0x05, 0x13, 0x58, 0xCA, 0x62, 0xC6, 0x16, 0x49, 0xB6, 0xE6, 0x8E, 0x15, 0x68, 0xD5, 0xB0,
+    0x08, 0x03, 0xCF, 0x0B, 0xA7, 0x9C, 0x44, 0x7A, 0x74, 0xF3, 0x99, 0xF5, 0x6E, 0x9A, 0x9D, 0x03,
+    0x4B, 0x75, 0xF6, 0x1D, 0x97, 0xF1, 0xBE, 0xBB, 0x4B, 0x4C, 0x52, 0xD5, 0x30, 0x6A, 0xD8, 0x04,
+    0x34, 0xB9, 0xD6, 0xBC, 0x6D, 0xB9, 0x83, 0x3B, 0x1D, 0xC4, 0xE7, 0x75, 0xF2, 0xBF, 0xC4, 0x35,
+    0xC3, 0xC7, 0x4D, 0xCD, 0xE4, 0xA0, 0x2B, 0xD2, 0x00, 0x38, 0x13, 0x9E, 0xA1, 0x66, 0x39, 0x2F,
+    0x13, 0xB0, 0xE3, 0x6B, 0x72, 0x44, 0xE5, 0x7A, 0x7E, 0x91, 0xFF, 0x00, 0x8E, 0x74, 0x23, 0x4F,
+    0x77, 0xF0, 0xBA, 0x8E, 0xF6, 0xD9, 0xB7, 0xC3, 0x6D, 0xD1, 0xB4, 0xCE, 0xD3, 0xCC, 0x7D, 0x17,
+    0x89, 0xDA, 0x1F, 0x1F, 0xEB, 0x1E, 0x0B, 0x74, 0xB4, 0x29, 0xE9, 0x81, 0x03, 0xC4, 0x4D, 0xEE,
+    0x06, 0x78, 0x27, 0x1F, 0x92, 0xF9, 0x1A, 0x9A, 0xC8, 0x10, 0xB9, 0x9F, 0x35, 0x4C, 0xAE, 0xB1,
+    0xCB, 0xCB, 0x6F, 0xCA, 0x5D, 0x76, 0xF6, 0xFC, 0x65, 0xD1, 0x5F, 0x52, 0xED, 0x4B, 0xDC, 0xF7,
+    0x38, 0xB9, 0xEE, 0x24, 0xB9, 0xC4, 0xC9, 0x27, 0xA9, 0x5C, 0xA4, 0x16, 0x99, 0x58, 0x02, 0xC5,
+    0x56, 0x8E, 0xF7, 0x0B, 0x39, 0xE2, 0xB9, 0x4A, 0xFB, 0xB7, 0xE4, 0x98, 0xAA, 0x5D, 0x85, 0x46,
+    0x69, 0x0D, 0x4C, 0xAB, 0xB3, 0x45, 0x19, 0x5D, 0x0D, 0x78, 0xA4, 0x21, 0x62, 0xDC, 0x9F, 0xDA,
+    0xC5, 0xB9, 0x77, 0xD7, 0x22, 0x54, 0xE9, 0x0A, 0x3B, 0xAA, 0xDC, 0x1E, 0x21, 0x2B, 0xDC, 0x1E,
+    0xA0, 0xF7, 0xF7, 0x59, 0x58, 0xCF, 0x27, 0x2F, 0xDF, 0x6E, 0xBF, 0x15, 0x9C, 0xDB, 0x32, 0xA2,
+    0xFD, 0x60, 0x6E, 0x14, 0x1F, 0xAB, 0xBF, 0x0A, 0x5D, 0xC9, 0xA8, 0x65, 0x74, 0x8A, 0x7F, 0x73,
+    0xB5, 0x78, 0xE2, 0xBF, 0xC3, 0x3B, 0xDC, 0x6B, 0x6C, 0x91, 0xB4, 0xCB, 0x0A, 0xA3, 0x18, 0x69,
+    0xAE, 0x96, 0x53, 0xEF, 0x16, 0xA6, 0xD8, 0xD4, 0xDA, 0x95, 0xFF, 0x00, 0xD9, 0x06, 0x78, 0xF0,
+    0xAE, 0xCD, 0x1C, 0xE5, 0x59, 0xBA, 0x61, 0x4F, 0x29, 0x8E, 0xA4, 0x30, 0x42, 0xE5, 0x37, 0x99,
+    0xFC, 0x5C, 0x6D, 0x79, 0xB7, 0xF1, 0x13, 0xFE, 0x31, 0xAD, 0x6E, 0x1A, 0xEC, 0x18, 0x22, 0x14,
+    0x6A, 0x6A, 0x2F, 0x39, 0x81, 0x98, 0x39, 0x52, 0x69, 0x14, 0xDD, 0x19, 0x39, 0xE0, 0x44, 0xEE,
+    0x94, 0x93, 0x23, 0xC4, 0x1B, 0xBE, 0xDB, 0x29, 0x11, 0x10, 0xBE, 0x3B, 0x19, 0x26, 0xBC, 0x83,
+    0xB1, 0x07, 0x72, 0x25, 0x6B, 0x8B, 0xC4, 0x38, 0x8C, 0x9C, 0x67, 0xCD, 0x2B, 0x88, 0xBE, 0x67,
+    0x8F, 0x08, 0x27, 0x94, 0x64, 0x08, 0x1B, 0x88, 0xE7, 0x8D, 0x95, 0xD9, 0x6A, 0xB3, 0x91, 0x90,
+    0x5B, 0x5A, 0x09, 0x36, 0x00, 0xE0, 0x41, 0x18, 0x38, 0x4C, 0xEC, 0x90, 0xEB, 0x80, 0x8D, 0xC0,
+    0xFD, 0xD0, 0x69, 0x10, 0xDE, 0x33, 0x99, 0x3B, 0x7B, 0x28, 0x80, 0x5C, 0x6D, 0x38, 0x81, 0xFA,
+    0xEE, 0x92, 0x7A, 0x80, 0x83, 0x82, 0xE2, 0xEC, 0x75, 0xF6, 0x13, 0x41, 0x18, 0x90, 0x66, 0x63,
+    0x84, 0x09, 0x07, 0x37, 0x34, 0x93, 0x9C, 0x1E, 0x67, 0xFA, 0x2C, 0x04, 0x37, 0x7C, 0x44, 0x5B,
+    0xFD, 0x94, 0x46, 0x04, 0xBC, 0x08, 0x90, 0xE9, 0xFE, 0x48, 0x08, 0x2E, 0xB4, 0x3B, 0xD0, 0x03,
+    0x3D, 0x13, 0x7C, 0xC0, 0x81, 0xB0, 0x10, 0x20, 0xC1, 0x84, 0x1C, 0x05, 0x80, 0xB9, 0xB2, 0x0C,
+    0x64, 0x1C, 0x9F, 0x55, 0x54, 0xB0, 0xE2, 0x2D, 0x10, 0x60, 0x41, 0xCE, 0xDF, 0xD1, 0x17, 0xDC,
+    0xF3, 0xEA, 0x20, 0x08, 0xD9, 0x31, 0xC0, 0xC4, 0x41, 0xC0, 0xF3, 0xF2, 0x4A, 0x63, 0x61, 0x00,
+    0xED, 0x03, 0xCF, 0xA7, 0xDD, 0x0D, 0x07, 0x08, 0x39, 0x2E, 0xC9, 0xF5, 0xCF, 0x23, 0xDF, 0x45,
+    0x42, 0x78, 0x27, 0x23, 0xF1, 0x1E, 0x10, 0x13, 0x3D, 0x5C, 0x01, 0xD8, 0xE5, 0x16, 0xDC, 0x43,
+    0x62, 0x41, 0x8E, 0x23, 0x1E, 0x7F, 0xAA, 0x9A, 0x85, 0x80, 0x1A, 0x48, 0x91, 0x19, 0x82, 0x21,
+    0x1B, 0x64, 0x49, 0x00, 0x08, 0x27, 0x62, 0x81, 0x80, 0x38, 0x74, 0x8F, 0xD1, 0x09, 0x2E, 0xC7,
+    0xE1, 0x8C, 0x12, 0x7F, 0x35, 0x57, 0x58, 0x92, 0xE8, 0x86, 0x98, 0x1B, 0x01, 0x88, 0x58, 0x82,
+    0x00, 0xC1, 0x18, 0xDF, 0xF3, 0x42, 0x0B, 0x4C, 0x4F, 0x84, 0x1C, 0x18, 0xFA, 0xE5, 0x39, 0xFC,
+    0x22, 0xD1, 0x93, 0x22, 0x38, 0xF7, 0xFB, 0x21, 0xB0, 0xC5, 0xA4, 0x81, 0x73, 0xB0, 0x10, 0x9F,
+    0xC3, 0x19, 0x93, 0x24, 0x04, 0x6D, 0x04, 0xE7, 0x2E, 0x03, 0x20, 0x1C, 0xA5, 0x01, 0xC5, 0xD1,
+    0x38, 0x8D, 0xCF, 0xBD, 0xD4, 0x4C, 0xFB, 0x68, 0x61, 0x04, 0xDE, 0x24, 0xF2, 0x46, 0xC9, 0x9A,
+    0x33, 0x38, 0x77, 0x4F, 0x3F, 0x79, 0x59, 0x84, 0x99, 0x8D, 0x9A, 0x09, 0x00, 0x1E, 0x9E, 0x6B,
+    0x09, 0x2C, 0x91, 0x03, 0x3C, 0xEF, 0xF4, 0x28, 0xB2, 0x1B, 0x03, 0xF7, 0x80, 0x88, 0x1C, 0x4B,
+    0x9A, 0x66, 0x70, 0xE9, 0x0B, 0x07, 0x34, 0xBE, 0x09, 0xB8, 0xFE, 0x59, 0xE2, 0x56, 0x6B, 0x2E,
+    0xF1, 0x44, 0x12, 0x60, 0x81, 0xEF, 0xAA, 0x27, 0x45, 0x74, 0x6C, 0x60, 0x3B, 0xAE, 0x63, 0xAA,
+    0x36, 0x98, 0x26, 0x1D, 0xF7, 0xE3, 0x29, 0x72, 0x41, 0x9B, 0xB7, 0xC1, 0xE9, 0xCE, 0xF2, 0x8C,
+    0x00, 0x64, 0x81, 0x11, 0x33, 0x39, 0xE9, 0xEA, 0xAA, 0xFD, 0x1F, 0x27, 0xFD, 0x47, 0x8C, 0x8C,
+    0xEE, 0x97, 0xC2, 0xFF, 0x00, 0x03, 0xA2, 0x07, 0x4D, 0xFE, 0x88, 0x12, 0x48, 0xCE, 0x01, 0xDC,
+    0xCA, 0x63, 0x02, 0x46, 0x44, 0x46, 0xC7, 0x1F, 0x55, 0x00, 0x20, 0xB5, 0xA1, 0x92, 0x48, 0x26,
+    0x1A, 0x01, 0x44, 0x36, 0x4C, 0x62, 0x09, 0xC6, 0x36, 0xF7, 0x84, 0x82, 0x63, 0x38, 0x9F, 0xA8,
+    0x9F, 0xA2, 0x39, 0x24, 0x17, 0x67, 0x7D, 0xBF, 0x78, 0x54, 0x91, 0x23, 0xFE, 0xA1, 0x98, 0xDF,
+    0x1B, 0x23, 0x8B, 0x60, 0xBA, 0x22, 0x70, 0x73, 0x1E, 0xF2, 0xB1, 0x6B, 0x88, 0x17, 0x10, 0x04,
+    0x7D, 0x00, 0x41, 0xB9, 0x21, 0xA4, 0x89, 0x1E, 0x70, 0x54, 0x48, 0xF5, 0x0C, 0x76, 0xB7, 0xC2,
+    0x41, 0xDB, 0x83, 0xEF, 0x64, 0xCE, 0xF1, 0x90, 0xE2, 0xD0, 0x71, 0xF4, 0xDB, 0xDF, 0x2B, 0x3A,
+    0x1A, 0xDB, 0x85, 0xD2, 0x4C, 0xEF, 0x01, 0x23, 0x4C, 0x01, 0x26, 0x3C, 0x8E, 0xDF, 0x64, 0x51,
+    0x7B, 0x89, 0x20, 0x07, 0x18, 0x81, 0xB6, 0x41, 0x3D, 0x11, 0x92, 0xE7, 0x10, 0x37, 0x04, 0x4E,
+    0x77, 0xFD, 0x92, 0xE0, 0x12, 0x3E, 0xC3, 0xCB, 0x65, 0x83, 0x80, 0x71, 0x05, 0xD9, 0x02, 0x3D,
+    0x42, 0x62, 0x05, 0xC1, 0xDB, 0x66, 0x04, 0x67, 0x62, 0x9B, 0x67, 0xF8, 0x62, 0xE2, 0x06, 0x79,
+    0xDD, 0x63, 0x89, 0x68, 0x22, 0xDE, 0x93, 0xFA, 0x21, 0x21, 0xA6, 0x43, 0x41, 0x3C, 0x0F, 0x7F,
+    0x45, 0x57, 0xFE, 0x99, 0x84, 0x5C, 0x64, 0x71, 0xF6, 0xF7, 0x84, 0x5B, 0x6B, 0x41, 0x06, 0xDF,
+    0xD7, 0xF5, 0x58, 0xEE, 0x09, 0x37, 0x72, 0xD0, 0x7F, 0x45, 0xB0, 0x5B, 0xB8, 0x99, 0x8F, 0x63,
+    0xA6, 0xC8, 0x48, 0x10, 0x40, 0x77, 0x8A, 0x4C, 0x40, 0xE6, 0x79, 0xC2, 0x01, 0xB0, 0xEF, 0x01,
+    0x19, 0x90, 0x39, 0xE1, 0x1F, 0x90, 0xE2, 0x2E, 0xE0, 0x1C, 0x0F, 0x44, 0x01, 0xB8, 0x88, 0x86,
+    0xF3, 0x10, 0x81, 0xB0, 0x5D, 0x30, 0x67, 0x79, 0x22, 0x3F, 0x64, 0x2D, 0x87, 0x19, 0x68, 0x38,
+    0xDB, 0xD7, 0x69, 0x5B, 0x2E, 0x3E, 0x13, 0x70, 0x3C, 0x1E, 0x7D, 0xE5, 0x31, 0xF0, 0x90, 0x48,
+    0x71, 0x93, 0x92, 0x38, 0xFB, 0xFD, 0x14, 0x35, 0x85, 0xC6, 0xD8, 0xCC, 0x6E, 0x46, 0x71, 0xE8,
+    0xB3, 0x4F, 0xE1, 0x10, 0xD0, 0xD2, 0x20, 0xFF, 0x00, 0x65, 0x8C, 0xC1, 0x24, 0xCF, 0x99, 0xC0,
+    0x5A, 0x4F, 0x79, 0x74, 0x87, 0x41, 0x1C, 0xFB, 0xF4, 0x4E, 0xD1, 0xBC, 0x21, 0xDE, 0x17, 0x40,
+    0xDF, 0x19, 0xF3, 0x48, 0x6E, 0x04, 0x86, 0xC4, 0x0C, 0x63, 0x84, 0xD7, 0xDA, 0x41, 0x32, 0x24,
+    0x48, 0x93, 0xBA, 0x20, 0x92, 0x5A, 0x20, 0xCE, 0xD9, 0x1B, 0x7B, 0xC2, 0xBD, 0x2E, 0xC8, 0x00,
+    0x2E, 0x87, 0x4C, 0x4C, 0x6D, 0x29, 0xC3, 0xDD, 0x4C, 0x92, 0xC6, 0x88, 0x93, 0xB8, 0x21, 0x2E,
+    0x6D, 0xDF, 0x82, 0x1A, 0x39, 0x4A, 0x6C, 0x20, 0x43, 0x64, 0x1E, 0xBB, 0x22, 0x4C, 0x44, 0xCE,
+    0xCB, 0xAF, 0xF8, 0xE3, 0x6C, 0x59, 0xF9, 0xA9, 0x3A, 0xAD, 0xE7, 0x22, 0x1D, 0xD2, 0x54, 0x84,
+    0xC0, 0x0D, 0x00, 0x81, 0x3B, 0x8F, 0xCD, 0x0C, 0x64, 0x8B, 0x4C, 0x93, 0x39, 0xEA, 0xA4, 0x44,
+    0x47, 0x44, 0xD6, 0x2D, 0xD9, 0xC5, 0x53, 0xF8, 0x54, 0xEA, 0x17, 0xB8, 0x0B, 0x84, 0x02, 0x89,
+    0x01, 0x86, 0x67, 0xC3, 0xB6, 0x76, 0xF7, 0xFC, 0x93, 0x07, 0x3A, 0xD3, 0xE0, 0x2D, 0x03, 0x27,
+    0x19, 0x95, 0xBF, 0x29, 0x86, 0xE2, 0xD3, 0x11, 0x91, 0xD2, 0x2D, 0xA2, 0xD0, 0x66, 0x4F, 0x5D,
+    0x97, 0x53, 0x5E, 0xCA, 0x63, 0x24, 0x24, 0xB8, 0xB6, 0x43, 0x8C, 0x90, 0x36, 0x90, 0x91, 0xB0,
+    0xD3, 0x01, 0xAF, 0x0D, 0x9C, 0xE5, 0x49, 0xB4, 0xCF, 0x69, 0x13, 0x3F, 0xCB, 0xE9, 0xD4, 0x5D,
+    0x47, 0xF1, 0x3A, 0x3D, 0x42, 0xA3, 0x6A, 0x53, 0x67, 0xCA, 0xE9, 0xFA, 0x2E, 0x37, 0x45, 0xE3,
+    0xC2, 0x49, 0x8D, 0xA5, 0x0B, 0x80, 0x78, 0x20, 0xE6, 0x27, 0xD8, 0xF7, 0xBA, 0xCF, 0x6E, 0x7E,
+    0x11, 0x33, 0xBF, 0x6E, 0xB7, 0xEA, 0xEE, 0x96, 0x8E, 0x17, 0x2D, 0x40, 0x5D, 0xE2, 0xE3, 0xAA,
+    0x48, 0xCC, 0x13, 0x30, 0x37, 0x9D, 0xF7, 0x08, 0x96, 0xB9, 0xA0, 0x80, 0xDC, 0xEF, 0x07, 0x8F,
+    0xEA, 0xAC, 0x7A, 0xE9, 0xAC, 0x89, 0xEF, 0xD9, 0xB2, 0x0B, 0x5D, 0xE1, 0x00, 0x99, 0x8D, 0xF1,
+    0xC2, 0x1C, 0xC0, 0x20, 0x11, 0xB8, 0x25, 0x6B, 0x7E, 0x59, 0x8C, 0x0E, 0x02, 0xCD, 0xDE, 0xC3,
+    0x12, 0x7A, 0x22, 0xB4, 0x82, 0x41, 0x03, 0xD4, 0xED, 0x2B, 0x08, 0x6B, 0xC9, 0x81, 0xF5, 0x3C,
+    0x25, 0x77, 0x8C, 0x98, 0x18, 0x04, 0x80, 0x47, 0x1D, 0x53, 0xC4, 0xB8, 0xDB, 0xBE, 0x7E, 0xE5,
+    0x43, 0xA2, 0x81, 0x19, 0x97, 0x11, 0xB8, 0x82, 0xB3, 0x9A, 0x64, 0x88, 0x20, 0x09, 0x90, 0x36,
+    0x0B, 0x30, 0xE0, 0x80, 0xE1, 0xBE, 0x01, 0x18, 0x4D, 0xB9, 0xF1, 0x12, 0x3D, 0x7D, 0xF4, 0x0A,
+    0xF4, 0x6F, 0xB0, 0x9C, 0xC4, 0x49, 0x70, 0xC4, 0x14, 0x73, 0x97, 0x17, 0x18, 0x07, 0x0E, 0x58,
+    0xB8, 0x99, 0x89, 0x20, 0x08, 0x9E, 0xA5, 0x60, 0xD7, 0x38, 0x9B, 0xC4, 0xC0, 0xC3, 0x7A, 0x9F,
+    0x7F, 0xA2, 0x80, 0x12, 0x46, 0xD9, 0x13, 0x30, 0x3F, 0xA2, 0x57, 0x4B, 0x00, 0x00, 0x09, 0x88,
+    0x39, 0xDD, 0x39, 0x20, 0x12, 0x0B, 0x40, 0x24, 0x81, 0x08, 0x03, 0x97, 0x62, 0x7F, 0x75, 0x4E,
+    0x99, 0xAE, 0x37, 0x0C, 0x09, 0x10, 0x47, 0x8B, 0x75, 0xA4, 0x43, 0xAD, 0x68, 0x03, 0x00, 0xC7,
+    0x0B, 0x5A, 0xD6, 0x8B, 0x64, 0x89, 0x8C, 0x2C, 0xE6, 0x82, 0xF0, 0x0B, 0x8C, 0xDD, 0x9E, 0x62,
+    0x07, 0xF6, 0x44, 0xFB, 0x6B, 0x7C, 0x58, 0x17, 0x35, 0xB8, 0xC8, 0x18, 0x44, 0x5A, 0x5A, 0x4E,
+    0x40, 0x18, 0xC1, 0xDF, 0x0B, 0x16, 0x80, 0x65, 0xC6, 0x5B, 0xB6, 0x71, 0x94, 0xA5, 0xCD, 0xB4,
+    0x78, 0xA6, 0x32, 0x49, 0x1C, 0xFB, 0x9F, 0xB2, 0x8A, 0x2E, 0x79, 0x16, 0xE6, 0x4F, 0x23, 0x62,
+    0x56, 0xB4, 0x49, 0x87, 0x19, 0xFC, 0x42, 0x7C, 0xB0, 0x11, 0x32, 0xD6, 0xCC, 0x64, 0x63, 0x3F,
+    0xBA, 0xCF, 0x25, 0xC6, 0x4E, 0x62, 0x73, 0xD3, 0x2A, 0x84, 0x3E, 0x2C, 0xB4, 0x48, 0x99, 0x83,
+    0xD1, 0x36, 0x1C, 0x06, 0x44, 0x98, 0x19, 0x8F, 0x7C, 0xA2, 0x59, 0x20, 0x8B, 0x81, 0x24, 0xE6,
+    0x4E, 0xFE, 0xF6, 0x40, 0x83, 0x69, 0x22, 0x67, 0x88, 0xE4, 0x21, 0xE8, 0xAF, 0x70, 0x9C, 0x7A,
+    0x6F, 0xBF, 0xAF, 0xBF, 0xD1, 0x13, 0x6B, 0x9D, 0x22, 0x5B, 0xBC, 0xC9, 0xDB, 0xDF, 0xEC, 0x99,
+    0xC4, 0x13, 0xD7, 0xD7, 0xDF, 0xBF, 0xD5, 0x6E, 0x26, 0x03, 0xB2, 0x36, 0x82, 0x36, 0x28, 0x09,
+    0x16, 0x8F, 0x9B, 0x13, 0x03, 0xCF, 0xEA, 0x84, 0xDF, 0x52, 0x0B, 0x61, 0xC8, 0x96, 0xCB, 0x81,
+    0x20, 0x07, 0x01, 0x92, 0x02, 0x31, 0x8F, 0xC3, 0x04, 0xC1, 0xC4, 0x26, 0xA0, 0x00, 0x6D, 0xCD,
+    0xA0, 0xCC, 0x44, 0x4F, 0x4C, 0x2C, 0x4E, 0x27, 0x32, 0x46, 0x48, 0xC4, 0xFB, 0xFE, 0x4B, 0x3A,
+    0x5C, 0x6E, 0x6E, 0x1C, 0x76, 0x07, 0x94, 0x04, 0x49, 0x98, 0xDE, 0x64, 0x4E, 0x7D, 0xFE, 0xC8,
+    0xB1, 0xFD, 0x58, 0x41, 0x18, 0x06, 0xE1, 0x88, 0x88, 0xFB, 0xAC, 0x01, 0x00, 0x4D, 0xD2, 0x7A,
+    0xF3, 0xEE, 0x13, 0x0E, 0xF0, 0x82, 0x04, 0x4F, 0xCD, 0x83, 0xC2, 0x2F, 0x00, 0x32, 0x59, 0xE1,
+    0x9E, 0x3C, 0xFC, 0xBD, 0xF2, 0x86, 0x96, 0xEC, 0x5D, 0x3F, 0x70, 0x83, 0x84, 0x11, 0x83, 0x1F,
+    0xA7, 0xBC, 0x26, 0x10, 0xE1, 0x10, 0x0C, 0x67, 0xD1, 0x01, 0x0E, 0x74, 0x18, 0x27, 0x24, 0x0F,
+    0xD9, 0x40, 0xA6, 0x99, 0x73, 0xF3, 0x00, 0x9E, 0x7A, 0xA6, 0x04, 0x8D, 0xA1, 0xD1, 0xD7, 0x62,
+    0x98, 0x02, 0xD6, 0x06, 0xDB, 0xF8, 0x60, 0xC0, 0x94, 0xAD, 0xDC, 0x0C, 0x9F, 0xC4, 0x32, 0xAE,
+    0xE9, 0xBA, 0x62, 0xD2, 0x43, 0x44, 0x96, 0xC9, 0xC8, 0x24, 0xE4, 0xFB, 0x09, 0x03, 0xC4, 0x12,
+    0x44, 0x7F, 0xA8, 0x5B, 0x9F, 0x24, 0x6C, 0x22, 0x04, 0xB8, 0xC9, 0x92, 0x67, 0x7E, 0x13, 0x34,
+    0x98, 0xBC, 0x3A, 0x1B, 0x3E, 0xB2, 0xA1, 0xF4, 0x4F, 0x0D, 0x97, 0x01, 0x27, 0xD0, 0x61, 0x30,
+    0x20, 0xC8, 0x81, 0x23, 0x79, 0xE3, 0xAA, 0xD0, 0xE1, 0xBB, 0x9A, 0x0F, 0x51, 0x38, 0xF2, 0xC2,
+    0x0D, 0x26, 0xDF, 0x23, 0xBF, 0x9E, 0xE8, 0x15, 0xCD, 0x20, 0x00, 0x08, 0x9F, 0x52, 0x9D, 0xCC,
+    0x63, 0x4B, 0x48, 0xDC, 0x6F, 0x2B, 0x00, 0xE0, 0x2E, 0x86, 0x81, 0xCD, 0xDC, 0x21, 0x0D, 0xB7,
+    0xC2, 0x26, 0x49, 0x26, 0x78, 0x57, 0x4D, 0x99, 0x00, 0x1A, 0x49, 0x02, 0x01, 0x12, 0x37, 0xE6,
+    0x53, 0x93, 0x00, 0x4D, 0x4F, 0x17, 0xCC, 0x09, 0x4A, 0x19, 0xE1, 0x91, 0x9B, 0xB1, 0xBF, 0x29,
+    0x58, 0xD0, 0x19, 0xD7, 0x10, 0x0A, 0x12, 0x72, 0x4D, 0xA4, 0x8B, 0xB1, 0x99, 0xCE, 0x56, 0x7B,
+    0x83, 0x8C, 0x18, 0xC9, 0x39, 0xF2, 0xFE, 0x5F, 0xC9, 0x03, 0x97, 0x46, 0x1C, 0x40, 0xD8, 0x82,
+    0x79, 0xF7, 0xF9, 0xA3, 0x26, 0xF9, 0x19, 0x03, 0x78, 0xFC, 0xA5, 0x48, 0x0A, 0x5C, 0x43, 0x83,
+    0x5D, 0x01, 0xFC, 0x92, 0x42, 0x20, 0x1B, 0x80, 0x93, 0x22, 0x33, 0x32, 0x81, 0x0E, 0x2D, 0x83,
+    0x04, 0x6F, 0x9E, 0x51, 0xC4, 0x00, 0x5D, 0x11, 0xE4, 0xA9, 0x01, 0x2E, 0xB8, 0x5A, 0x06, 0x39,
+    0x20, 0x7A, 0xA3, 0x0C, 0x18, 0x83, 0x82, 0x6E, 0x91, 0xF9, 0x21, 0x1F, 0xE5, 0x92, 0xE8, 0x93,
+    0xC9, 0x03, 0x74, 0x62, 0x22, 0x22, 0x7A, 0x81, 0xBE, 0x7F, 0xA0, 0x40, 0x5C, 0x6E, 0x0E, 0x18,
+    0x69, 0xE1, 0x62, 0x40, 0x69, 0x27, 0xE5, 0x19, 0x8F, 0x55, 0xB3, 0xF8, 0x58, 0x06, 0x32, 0x00,
+    0xDC, 0xAC, 0x41, 0x80, 0x0E, 0x04, 0x62, 0x77, 0x44, 0x09, 0xF0, 0xD8, 0x0F, 0x88, 0x71, 0xC8,
+    0xF7, 0x84, 0x33, 0x74, 0xD8, 0x09, 0x73, 0x76, 0x27, 0xF2, 0xFC, 0x96, 0x33, 0x75, 0xC7, 0x38,
+    0x93, 0xE5, 0xB2, 0xD2, 0x60, 0x08, 0x3E, 0x42, 0x01, 0x13, 0xFB, 0x24, 0x2E, 0x7F, 0x41, 0xC4,
+    0xDB, 0xE2, 0x24, 0x1E, 0xB8, 0xFA, 0x20, 0x1A, 0x1A, 0x44, 0x36, 0x27, 0x03, 0xDF, 0xD5, 0x12,
+    0xE6, 0xBD, 0xBF, 0x2E, 0xDC, 0xF4, 0x44, 0x9F, 0x0B, 0x5D, 0x24, 0x0F, 0x52, 0x32, 0x87, 0xB6,
+    0x05, 0xD6, 0xEC, 0x40, 0xCE, 0x23, 0x7D, 0xD0, 0xC8, 0x30, 0xF2, 0x23, 0x63, 0xF7, 0xDD, 0x00,
+    0xD9, 0x79, 0x04, 0xE4, 0xF2, 0x07, 0xE9, 0xEF, 0x74, 0x44, 0x38, 0x6E, 0x72, 0x49, 0x20, 0x1D,
+    0xBE, 0x88, 0x30, 0x02, 0x45, 0xBD, 0x46, 0x11, 0x90, 0xE8, 0x82, 0x4F, 0xA7, 0x3B, 0xFF, 0x00,
+    0x24, 0xA4, 0x34, 0x9B, 0x81, 0xC9, 0xC4, 0xCE, 0xC9, 0x80, 0x71, 0x7C, 0x18, 0x83, 0xC1, 0xDB,
+    0xEE, 0x92, 0x35, 0x42, 0x00, 0x27, 0xCB, 0x39, 0xFA, 0xFF, 0x00, 0x34, 0x0B, 0xF0, 0xD3, 0x80,
+    0x44, 0x46, 0x31, 0x94, 0x5B, 0x36, 0x82, 0xE0, 0x23, 0x98, 0xE1, 0x0B, 0xB3, 0x3B, 0x19, 0x85,
+    0x06, 0x11, 0x36, 0x83, 0x06, 0x22, 0x3D, 0x16, 0x2F, 0x20, 0x78, 0x65, 0xC6, 0xDC, 0x90, 0x80,
+    0x71, 0x0E, 0x3D, 0x06, 0x43, 0x81, 0xD9, 0x19, 0x71, 0x19, 0x2D, 0x9E, 0x06, 0xE4, 0x7A, 0xAB,
+    0xF6, 0x64, 0x08, 0x32, 0xE0, 0xE1, 0xE7, 0x20, 0x6F, 0xEF, 0x75, 0x80, 0x25, 0xAE, 0x04, 0x90,
+    0xD6, 0xE0, 0xF5, 0xF7, 0x08, 0x43, 0x87, 0x27, 0x23, 0x04, 0x0C, 0x6D, 0xD5, 0x06, 0xFE, 0x12,
+    0xE7, 0x6E, 0x7A, 0xFB, 0xE8, 0x80, 0xDC, 0x78, 0x93, 0x39, 0x30, 0x3D, 0x16, 0x15, 0x04, 0x08,
+    0x24, 0x37, 0xCF, 0x74, 0x1C, 0x01, 0x83, 0xF2, 0x86, 0x90, 0x24, 0x8F, 0xD7, 0xA2, 0x24, 0x81,
+    0xE6, 0x3A, 0xF4, 0x40, 0x7E, 0x51, 0x07, 0xC2, 0x07, 0x97, 0xE6, 0x90, 0xB4, 0xB5, 0xE4, 0x01,
+    0x88, 0xC0, 0x8E, 0x3D, 0xCA, 0x62, 0x24, 0xF3, 0xE4, 0x7C, 0xFD, 0x94, 0x03, 0x70, 0xE1, 0x8C,
+    0x70, 0x07, 0x9A, 0x40, 0xC1, 0xA3, 0x24, 0x9C, 0x80, 0x72, 0x04, 0x21, 0xE2, 0x6D, 0x13, 0x00,
+    0x46, 0xD1, 0x27, 0x08, 0x06, 0x88, 0x93, 0xB1, 0xEA, 0x13, 0x08, 0xF9, 0x6E, 0x6E, 0xFB, 0xC4,
+    0x65, 0x24, 0x31, 0x10, 0xFC, 0x38, 0x12, 0x4C, 0x84, 0xBE, 0x11, 0x24, 0x4C, 0x6C, 0x24, 0xAC,
+    0x1E, 0xE2, 0x24, 0x10, 0x40, 0x18, 0x11, 0x32, 0x47, 0xF6, 0x58, 0xB6, 0x1B, 0x93, 0x38, 0x88,
+    0x3F, 0x5C, 0xA1, 0xD1, 0x8C, 0x67, 0x1E, 0x11, 0x26, 0x23, 0x61, 0xEC, 0x2C, 0xE0, 0x49, 0x99,
+    0xDB, 0x00, 0xC6, 0xC9, 0x58, 0xD6, 0x9C, 0xEC, 0x1C, 0x27, 0x38, 0x1E, 0x8B, 0x16, 0x8B, 0x89,
+    0x04, 0x36, 0x46, 0x21, 0x06, 0x01, 0xA5, 0xC4, 0x67, 0xC8, 0x8E, 0x88, 0xB9, 0xC6, 0xE3, 0x2D,
+    0x80, 0x77, 0x8E, 0xA8, 0x86, 0x82, 0xEB, 0x5A, 0x72, 0x32, 0x47, 0x1B, 0xFA, 0x25, 0x02, 0x59,
+    0x31, 0x1C, 0x83, 0x10, 0x3E, 0xC8, 0x09, 0xF1, 0x46, 0x62, 0x0E, 0xE7, 0x38, 0x94, 0x5B, 0xF2,
+    0xD8, 0x73, 0x22, 0x00, 0x27, 0x31, 0xC7, 0xBF, 0x24, 0x09, 0x24, 0x16, 0xCE, 0x04, 0x0F, 0x38,
+    0x47, 0x06, 0x66, 0x26, 0x72, 0x00, 0xDA, 0x54, 0x40, 0x0E, 0x61, 0xD8, 0x13, 0x00, 0xC9, 0xF5,
+    0x58, 0xC0, 0x7C, 0x8D, 0x87, 0x23, 0x69, 0xFD, 0xD1, 0x2E, 0xB5, 0xB6, 0x9D, 0x8E, 0x04, 0x13,
+    0xF6, 0x4A, 0xC1, 0xE1, 0xC8, 0x27, 0xA8, 0xE0, 0xA2, 0x98, 0x00, 0x41, 0xDE, 0x0E, 0xE2, 0x7F,
+    0x44, 0x1C, 0x41, 0x67, 0xE2, 0x2D, 0x27, 0x82, 0x81, 0x39, 0x03, 0x6C, 0xF2, 0x26, 0x11, 0x77,
+    0x8C, 0x90, 0xE0, 0x67, 0xAC, 0x6E, 0x64, 0x7F, 0x35, 0x41, 0x98, 0x13, 0x19, 0x3B, 0x71, 0x84,
+    0xAE, 0xB4, 0x34, 0xDA, 0x40, 0x23, 0x8C, 0x26, 0x19, 0x69, 0x22, 0xE0, 0x01, 0x9C, 0xA5, 0x6B,
+    0x6D, 0x74, 0x38, 0x99, 0x19, 0x80, 0x21, 0x08, 0x66, 0x09, 0x68, 0x32, 0x25, 0xBE, 0xF8, 0x54,
+    0x90, 0x1F, 0x36, 0x9D, 0xE2, 0xE0, 0x0A, 0x98, 0xF1, 0x01, 0x8C, 0xE0, 0xE7, 0x84, 0x5A, 0x0B,
+    0x88, 0x74, 0x86, 0xBB, 0x69, 0xDE, 0x4F, 0xAF, 0xBD, 0xD4, 0x90, 0x18, 0x6E, 0x00, 0xDB, 0x20,
+    0x64, 0x09, 0xE7, 0xD9, 0x44, 0x5A, 0x48, 0x17, 0x10, 0xE2, 0x7A, 0x7E, 0xC8, 0x60, 0xBB, 0x82,
+    0x71, 0xC4, 0x26, 0x90, 0xE1, 0xC1, 0xC7, 0xAF, 0xE7, 0xEF, 0x65, 0x4F, 0xF2, 0xC6, 0xE8, 0x9C,
+    0xE0, 0xE3, 0xED, 0xCA, 0x3B, 0x1B, 0x66, 0x01, 0x30, 0x24, 0x19, 0x29, 0x09, 0x06, 0x04, 0x81,
+    0xC9, 0x9F, 0xA8, 0x4C, 0xF1, 0x71, 0x18, 0x81, 0x91, 0xFC, 0x82, 0x87, 0x6C, 0x44, 0x36, 0x40,
+    0x86, 0xCE, 0xD1, 0x03, 0xDE, 0xC8, 0x07, 0x1F, 0x13, 0x43, 0x7E, 0x6F, 0x16, 0x32, 0x89, 0x92,
+    0xE6, 0x99, 0xE3, 0x32, 0x62, 0x10, 0x0E, 0x0D, 0xA7, 0x37, 0x5C, 0x06, 0xC0, 0x94, 0x18, 0x9B,
+    0x83, 0x84, 0x8B, 0x4F, 0xFA, 0xA1, 0x62, 0x5D, 0x7D, 0xC6, 0x48, 0x32, 0x01, 0x1B, 0x21, 0x20,
+    0x89, 0xC4, 0x40, 0xCF, 0x44, 0xC6, 0x08, 0x24, 0x89, 0xCE, 0x49, 0xC6, 0x53, 0xA1, 0x89, 0x2D,
+    0x20, 0x97, 0xB8, 0xC1, 0xE0, 0x61, 0x6D, 0x86, 0x5A, 0x40, 0x8D, 0xE7, 0x7F, 0x5F, 0x25, 0xBE,
+    0x57, 0x82, 0x4C, 0x40, 0xF9, 0xB0, 0x12, 0xB6, 0x0D, 0xC0, 0xC6, 0xFF, 0x00, 0x4F, 0x78, 0x44,
+    0xC6, 0x12, 0x1A, 0x24, 0xF8, 0x7A, 0x1D, 0xBD, 0x53, 0x93, 0xB0, 0x74, 0x0C, 0x64, 0x81, 0x2B,
+    0x1C, 0x88, 0x76, 0xDB, 0x4F, 0x97, 0x92, 0x56, 0xE5, 0xF9, 0xCB, 0x89, 0xDB, 0xDF, 0xA6, 0xC8,
+    0xB3, 0xFD, 0x44, 0x5D, 0xE1, 0x0E, 0x20, 0x47, 0x43, 0xFB, 0x20, 0x4E, 0x76, 0xE7, 0x03, 0x60,
+    0x8C, 0x64, 0x16, 0xB8, 0x06, 0x9C, 0xF4, 0x5A, 0xA0, 0x88, 0x24, 0xED, 0xB0, 0xE1, 0x08, 0x09,
+    0x6C, 0xB4, 0xC9, 0x3C, 0x09, 0x80, 0x47, 0xBF, 0xD9, 0x62, 0xD1, 0x6C, 0xB4, 0xC0, 0x1D, 0x7D,
+    0xFA, 0xA2, 0x48, 0xE4, 0x62, 0x23, 0xEB, 0xE5, 0xD1, 0x01, 0x91, 0x20, 0xE5, 0xBD, 0x07, 0x2A,
+    0x8C, 0xE9, 0x02, 0xD3, 0xC8, 0x81, 0xE7, 0xD7, 0x64, 0x1C, 0x4D, 0xC6, 0xD9, 0x1B, 0x0D, 0xE7,
+    0x94, 0xC3, 0x36, 0x97, 0x4C, 0xE7, 0x7E, 0x0F, 0xAA, 0x57, 0x60, 0x12, 0x25, 0xC6, 0x26, 0x02,
+    0x0D, 0x77, 0x30, 0x09, 0xDF, 0x23, 0x04, 0x26, 0x66, 0xCD, 0x39, 0xB8, 0x04, 0x5A, 0xD2, 0x26,
+    0x48, 0x19, 0x13, 0x94, 0x01, 0x80, 0x08, 0x12, 0xEF, 0x2D, 0xF3, 0xE5, 0xEA, 0xA2, 0x7F, 0x86,
+    0x6B, 0x4B, 0xA5, 0xC7, 0xCE, 0x09, 0x89, 0x0B, 0x78, 0xAD, 0xDA, 0x0F, 0x30, 0x7F, 0x24, 0x04,
+    0x46, 0x5A, 0x41, 0x27, 0xFD, 0x3B, 0xAD, 0x70, 0x2D, 0x91, 0x1B, 0x74, 0xDD, 0x0F, 0x63, 0x1F,
+    0xE6, 0x49, 0x11, 0x8E, 0x4F, 0xBF, 0x7E, 0x89, 0x5A, 0xC1, 0x27, 0x1F, 0x2E, 0xD1, 0x91, 0x09,
+    0x81, 0x01, 0xC4, 0x5F, 0x04, 0x64, 0x8F, 0x3E, 0x12, 0x93, 0xE2, 0xC9, 0x98, 0x38, 0xCE, 0x55,
+    0xF6, 0xA3, 0xBE, 0xE5, 0xC0, 0x73, 0x9D, 0xCA, 0x0E, 0x26, 0x30, 0x60, 0x8E, 0x27, 0x03, 0x08,
+    0xBD, 0xA5, 0xF1, 0x04, 0x01, 0xC7, 0x10, 0x97, 0xE5, 0xA8, 0x49, 0x36, 0xC0, 0xC0, 0x09, 0x04,
+    0x7B, 0x3C, 0x60, 0x98, 0x81, 0x00, 0x9C, 0xAC, 0xDF, 0x98, 0xB4, 0x64, 0xEE, 0x63, 0x78, 0xF2,
+    0xFB, 0xAC, 0x22, 0x40, 0x00, 0x6E, 0x78, 0x38, 0x0B, 0x48, 0x0D, 0x1B, 0x8D, 0x84, 0x0F, 0xEE,
+    0xA2, 0x03, 0x8D, 0xDC, 0x0F, 0x38, 0x0B, 0x07, 0x39, 0xAD, 0xB4, 0x75, 0x00, 0xF3, 0x27, 0x3D,
+    0x56, 0xC8, 0x74, 0x80, 0xE2, 0x4F, 0x94, 0x20, 0xEF, 0x29, 0x87, 0x44, 0x91, 0x03, 0x84, 0x5F,
+    0xA6, 0x6B, 0x6E, 0x8E, 0xBB, 0x79, 0xC4, 0x6C, 0x9B, 0xAB, 0xA4, 0x4C, 0xE0, 0x1F, 0x30, 0x90,
+    0x98, 0x1B, 0x0C, 0x71, 0xD7, 0xDC, 0xFE, 0x49, 0xC9, 0x69, 0xF9, 0x84, 0x10, 0x70, 0x09, 0xC7,
+    0xA2, 0xA6, 0x14, 0x40, 0x9D, 0xA4, 0xC6, 0x79, 0x8E, 0x21, 0x63, 0x2E, 0xDF, 0x7D, 0xA6, 0x16,
+    0x68, 0x20, 0x91, 0xE1, 0x24, 0x6D, 0x9D, 0x96, 0xBB, 0x23, 0xAE, 0xE0, 0x04, 0x24, 0x66, 0x5E,
+    0x1A, 0xD8, 0x16, 0x8C, 0x98, 0x39, 0x1B, 0xFE, 0xC8, 0xB4, 0x36, 0x5B, 0x6E, 0x63, 0x06, 0x0A,
+    0x15, 0x08, 0x93, 0x70, 0xF1, 0x1E, 0x7D, 0x56, 0x26, 0x72, 0x2E, 0xFA, 0x6D, 0x0A, 0x7D, 0x1A,
+    0xC1, 0xA3, 0xA4, 0x11, 0x9C, 0x93, 0xF5, 0x29, 0x43, 0x80, 0x24, 0xFE, 0x18, 0x8F, 0x24, 0x77,
+    0xC9, 0x02, 0x24, 0xEE, 0x26, 0x3D, 0x53, 0x89, 0xC0, 0x00, 0x8E, 0x84, 0x95, 0x47, 0xFF, 0xD9,
+};
+
+const JPEG_Asset photo = {
+    480, 272, 10336, photo_data
+};
@@ -0,0 +1,26 @@
+/**
+ * @file    pllconfig.h
+ *
+ * @note    Generated by mkpll -i 25000000 -s 200000000 -u 48000000 -l 9000000 -a 0
+ *
+ *          clock        output          target        actual     error
+ *          SYSCLK       PLL P       200000000     200000000         0
+ *          CK48         PLLSAI P     48000000      48000000         0
+ *          LCD_CLK      PLLSAI R      9000000       9000000         0
+ *
+ * @note    Initializers for PLLConfiguration_t (see system_stm32f746.h)
+ */
+
+#ifndef PLLCONFIG_H
+#define PLLCONFIG_H
+
+#define PLLCONFIG_MAIN          { CLOCKSRC_HSE, 25, 400, 2, 8, 2 }
+#define PLLCONFIG_SAI           { CLOCKSRC_HSE, 25, 288, 6, 2, 2 }
+#define PLLCONFIG_I2S           { CLOCKSRC_HSE, 25, 100, 2, 2, 2 }
+
+#define PLLCONFIG_SYSCLK        200000000U
+#define PLLCONFIG_CK48MSEL      1       // 0: PLL Q, 1: PLLSAI P
+#define PLLCONFIG_LCDCLK        9000000U
+#define PLLCONFIG_PLLSAIDIVR    3       // encoding of /16
+
+#endif // PLLCONFIG_H
@@ -0,0 +1,610 @@
+/**
+ * @file    raster.c
+ *
+ * @note    Scanline rasterizer and anti-aliased primitives
+ *
+ * @note    Pixel (x,y) has its center at (x+0.5,y+0.5) for polygons, so a
+ *          polygon with integer vertices covers exactly the pixels whose
+ *          centers are inside it and adjacent polygons do not overlap. Circles
+ *          are centered at the center of pixel (cx,cy)
+ *
+ * @note    Polygon edges are kept in 16.16 fixed point. For each line, the
+ *          crossings of the active edges are sorted and paired (even-odd rule)
+ *
+ * @note    Coverage masks are taken round robin from a pool of RASTER_MASKS
+ *          masks in SDRAM. A mask is only written again when the DMA2D job that
+ *          blended it is done (its fence)
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "lcd.h"
+#include "dma2d.h"
+#include "buddy.h"
+#include "raster.h"
+
+/**
+ * @brief   Polygon edge
+ */
+typedef struct {
+    int16_t         ya,yb;                  ///< lines ya to yb-1
+    int32_t         x;                      ///< 16.16 crossing at line ya
+    int32_t         dxdy;                   ///< 16.16 increment per line
+} Edge;
+
+/**
+ * @brief   Rasterizer state
+ */
+///@{
+static Edge         edges[RASTER_MAXEDGES];
+static uint16_t     active[RASTER_MAXEDGES];
+static int32_t      crossings[RASTER_MAXEDGES];
+static int16_t      runs[RASTER_MAXEDGES];
+static LCD_Point_t  arcpoints[RASTER_MAXEDGES];
+static RASTER_Stats stats;
+///@}
+
+/**
+ * @brief   Spans waiting for LCD_FillSpans
+ *
+ * @note    rowfirst and rowcount are the spans of the last line added, to
+ *          merge the next line into them when it has the same runs
+ */
+static struct {
+    int             layer;
+    unsigned        color;                  ///< in the layer format
+    LCD_Span_t      span[RASTER_MAXSPANS];
+    int             n;
+    int             rowfirst;
+    int             rowcount;               ///< -1 = can not merge
+    int             lasty;
+} out;
+
+/**
+ * @brief   Coverage masks
+ */
+///@{
+static uint8_t     *maskpool = 0;
+static DMA2D_Fence  maskfence[RASTER_MASKS];
+static int          masknext = 0;
+///@}
+
+/**
+ * @brief   sin(a) for a = 0 to 90 degrees (Q14)
+ */
+static const int16_t sintable[91] = {
+        0,   286,   572,   857,  1143,  1428,  1713,  1997,  2280,  2563,
+     2845,  3126,  3406,  3686,  3964,  4240,  4516,  4790,  5063,  5334,
+     5604,  5872,  6138,  6402,  6664,  6924,  7182,  7438,  7692,  7943,
+     8192,  8438,  8682,  8923,  9162,  9397,  9630,  9860, 10087, 10311,
+    10531, 10749, 10963, 11174, 11381, 11585, 11786, 11982, 12176, 12365,
+    12551, 12733, 12911, 13085, 13255, 13421, 13583, 13741, 13894, 14044,
+    14189, 14330, 14466, 14598, 14726, 14849, 14968, 15082, 15191, 15296,
+    15396, 15491, 15582, 15668, 15749, 15826, 15897, 15964, 16026, 16083,
+    16135, 16182, 16225, 16262, 16294, 16322, 16344, 16362, 16374, 16382,
+    16384,
+};
+
+/**
+ * @brief   sin and cos of an angle in degrees (Q14)
+ */
+static int
+isin(int a) {
+
+    a %= 360;
+    if( a < 0 )
+        a += 360;
+    if( a <= 90 )
+        return sintable[a];
+    if( a <= 180 )
+        return sintable[180-a];
+    if( a <= 270 )
+        return -sintable[a-180];
+    return -sintable[360-a];
+}
+
+static inline int icos(int a) { return isin(a+90); }
+
+/**
+ * @brief   Integer square root (floor)
+ */
+static uint32_t
+isqrt(uint32_t v) {
+uint32_t r = 0;
+uint32_t b = 1UL<<30;
+
+    while( b > v )
+        b >>= 2;
+    while( b ) {
+        if( v >= r+b ) {
+            v -= r+b;
+            r  = (r>>1)+b;
+        } else {
+            r >>= 1;
+        }
+        b >>= 2;
+    }
+    return r;
+}
+
+/**
+ * @brief   Converts a RGB888 color to the format of the layer
+ */
+static unsigned
+convertcolor(int format, unsigned c) {
+unsigned r = (c>>16)&0xFF;
+unsigned g = (c>>8)&0xFF;
+unsigned b = c&0xFF;
+
+    switch( format ) {
+    case LCD_FORMAT_ARGB8888:
+        return 0xFF000000|(c&0xFFFFFF);
+    case LCD_FORMAT_RGB565:
+        return ((r>>3)<<11)|((g>>2)<<5)|(b>>3);
+    case LCD_FORMAT_ARGB1555:
+        return 0x8000|((r>>3)<<10)|((g>>3)<<5)|(b>>3);
+    case LCD_FORMAT_ARGB4444:
+        return 0xF000|((r>>4)<<8)|((g>>4)<<4)|(b>>4);
+    default:
+        return c&0xFFFFFF;
+    }
+}
+
+/**
+ * @brief   Span output
+ */
+///@{
+static void
+beginspans(int layer, unsigned color) {
+
+    out.layer    = layer;
+    out.color    = convertcolor(LCD_GetFormat(layer),color);
+    out.n        = 0;
+    out.rowcount = -1;
+}
+
+static void
+flushspans(void) {
+
+    if( out.n > 0 )
+        LCD_FillSpans(out.layer,out.span,out.n,out.color);
+    stats.spans += out.n;
+    out.n        = 0;
+    out.rowcount = -1;
+}
+
+/**
+ * @brief   addrow
+ *
+ * @note    Adds the k runs x[2*i] to x[2*i+1]-1 of line y. Empty runs are
+ *          dropped. When the line below the last one has the same runs, the
+ *          spans of the last one grow instead
+ */
+static void
+addrow(int y, const int16_t *x, int k) {
+LCD_Span_t *s;
+int i,m;
+
+    // Drop empty runs
+    m = 0;
+    for(i=0;i<k;i++) {
+        if( x[2*i] < x[2*i+1] ) {
+            runs[2*m]   = x[2*i];
+            runs[2*m+1] = x[2*i+1];
+            m++;
+        }
+    }
+    if( m == 0 ) {
+        out.rowcount = -1;
+        return;
+    }
+
+    if( out.rowcount == m && y == out.lasty+1 ) {
+        s = &out.span[out.rowfirst];
+        for(i=0;i<m;i++) {
+            if( s[i].x != runs[2*i] || s[i].w != runs[2*i+1]-runs[2*i] )
+                break;
+        }
+        if( i == m ) {
+            for(i=0;i<m;i++)
+                s[i].h++;
+            out.lasty = y;
+            stats.merged++;
+            return;
+        }
+    }
+
+    if( out.n+m > RASTER_MAXSPANS )
+        flushspans();
+    out.rowfirst = out.n;
+    out.rowcount = m;
+    out.lasty    = y;
+    for(i=0;i<m;i++) {
+        s = &out.span[out.n++];
+        s->x = runs[2*i];
+        s->y = y;
+        s->w = runs[2*i+1]-runs[2*i];
+        s->h = 1;
+    }
+}
+///@}
+
+/**
+ * @brief   checklayer
+ *
+ * @note    Returns 0 when the DMA2D can write the layer format
+ */
+static int
+checklayer(int layer) {
+
+    if( layer < 1 || layer > 2 )
+        return RASTER_ERROR_PARAMETER;
+    if( LCD_GetFormat(layer) > LCD_FORMAT_ARGB4444 )
+        return RASTER_ERROR_FORMAT;
+    return RASTER_OK;
+}
+
+/**
+ * @brief   Raster_FillPolygon
+ *
+ * @note    Fills the polygon with n vertices (closed, any shape, even-odd rule)
+ */
+int
+Raster_FillPolygon(int layer, const LCD_Point_t *points, int n, unsigned color) {
+const LCD_Point_t *p,*q,*s;
+Edge *e,t;
+int ne,na,next,i,j,y,ymin,ymax,lh;
+int32_t c;
+
+    if( points == 0 || n < 3 || n > RASTER_MAXEDGES )
+        return RASTER_ERROR_PARAMETER;
+    if( (i=checklayer(layer)) < 0 )
+        return i;
+
+    // Edges that are not horizontal, sorted by first line (insertion sort)
+    ne = 0;
+    for(i=0;i<n;i++) {
+        p = &points[i];
+        q = &points[i+1 == n ? 0 : i+1];
+        if( p->y == q->y )
+            continue;
+        if( p->y > q->y ) {
+            s = p;
+            p = q;
+            q = s;
+        }
+        t.ya   = p->y;
+        t.yb   = q->y;
+        t.dxdy = (int32_t) (((int64_t) (q->x-p->x)*65536)/(q->y-p->y));
+        // Crossing at the center of line ya
+        t.x    = (int32_t) p->x*65536+t.dxdy/2;
+        for(j=ne;j>0 && edges[j-1].ya > t.ya;j--)
+            edges[j] = edges[j-1];
+        edges[j] = t;
+        ne++;
+    }
+    if( ne == 0 )
+        return RASTER_OK;
+
+    lh   = LCD_GetHeight(layer);
+    ymin = edges[0].ya < 0 ? 0 : edges[0].ya;
+    ymax = 0;
+    for(i=0;i<ne;i++) {
+        if( edges[i].yb > ymax )
+            ymax = edges[i].yb;
+    }
+    if( ymax > lh )
+        ymax = lh;
+
+    beginspans(layer,color);
+    na   = 0;
+    next = 0;
+    for(y=ymin;y<ymax;y++) {
+        // New edges and edges that end
+        while( next < ne && edges[next].ya <= y )
+            active[na++] = next++;
+        for(i=0,j=0;i<na;i++) {
+            if( edges[active[i]].yb > y )
+                active[j++] = active[i];
+        }
+        na = j;
+
+        // Sorted crossings
+        for(i=0;i<na;i++) {
+            e = &edges[active[i]];
+            c = e->x+e->dxdy*(y-e->ya);
+            for(j=i;j>0 && crossings[j-1] > c;j--)
+                crossings[j] = crossings[j-1];
+            crossings[j] = c;
+        }
+        // Pixels with the center between a pair of crossings
+        for(i=0;i+1<na;i+=2) {
+            runs[i]   = (crossings[i]+0x7FFF)>>16;
+            runs[i+1] = (crossings[i+1]+0x7FFF)>>16;
+        }
+        addrow(y,runs,na/2);
+    }
+    flushspans();
+    return RASTER_OK;
+}
+
+/**
+ * @brief   Raster_FillCircle
+ *
+ * @note    Fills the pixels (cx+dx,cy+dy) with dx*dx+dy*dy <= r*r+r
+ */
+int
+Raster_FillCircle(int layer, int cx, int cy, int r, unsigned color) {
+int16_t x[2];
+int y,y0,y1,hw,lh;
+
+    if( r < 0 )
+        return RASTER_ERROR_PARAMETER;
+    if( (y=checklayer(layer)) < 0 )
+        return y;
+
+    lh = LCD_GetHeight(layer);
+    y0 = cy-r < 0 ? 0 : cy-r;
+    y1 = cy+r+1 > lh ? lh : cy+r+1;
+    beginspans(layer,color);
+    for(y=y0;y<y1;y++) {
+        hw   = isqrt(r*r+r-(y-cy)*(y-cy));
+        x[0] = cx-hw;
+        x[1] = cx+hw+1;
+        addrow(y,x,1);
+    }
+    flushspans();
+    return RASTER_OK;
+}
+
+/**
+ * @brief   Raster_FillArc
+ *
+ * @note    Fills the part of the ring between radius r0 and r1 from angle a0 to
+ *          angle a1 (degrees, clockwise from 3 o'clock, since y grows down).
+ *          r0 = 0 gives a pie slice
+ *
+ * @note    The ring is a polygon with a vertex every RASTER_ARCSTEP degrees
+ */
+int
+Raster_FillArc(int layer, int cx, int cy, int r0, int r1, int a0, int a1,
+               unsigned color) {
+int n,steps,i,a;
+
+    if( r0 < 0 || r1 <= r0 || a1 <= a0 )
+        return RASTER_ERROR_PARAMETER;
+    if( a1-a0 > 360 )
+        a1 = a0+360;
+    steps = (a1-a0+RASTER_ARCSTEP-1)/RASTER_ARCSTEP;
+    if( 2*(steps+1) > RASTER_MAXEDGES )
+        return RASTER_ERROR_PARAMETER;
+
+    n = 0;
+    for(i=0;i<=steps;i++) {
+        a = i == steps ? a1 : a0+i*RASTER_ARCSTEP;
+        arcpoints[n].x = cx+((r1*icos(a)+(1<<13))>>14);
+        arcpoints[n].y = cy+((r1*isin(a)+(1<<13))>>14);
+        n++;
+    }
+    if( r0 == 0 ) {
+        arcpoints[n].x = cx;
+        arcpoints[n].y = cy;
+        n++;
+    } else {
+        for(i=steps;i>=0;i--) {
+            a = i == steps ? a1 : a0+i*RASTER_ARCSTEP;
+            arcpoints[n].x = cx+((r0*icos(a)+(1<<13))>>14);
+            arcpoints[n].y = cy+((r0*isin(a)+(1<<13))>>14);
+            n++;
+        }
+    }
+    return Raster_FillPolygon(layer,arcpoints,n,color);
+}
+
+/**
+ * @brief   getmask
+ *
+ * @note    Returns the next mask of the pool, waiting for the DMA2D to finish
+ *          the blend that used it
+ */
+static uint8_t *
+getmask(void) {
+
+    if( maskpool == 0 ) {
+        maskpool = Buddy_Alloc(RASTER_MASKS*RASTER_MASKSIZE);
+        if( maskpool == 0 )
+            return 0;
+    }
+    if( !DMA2D_FenceDone(maskfence[masknext]) ) {
+        stats.maskwaits++;
+        DMA2D_WaitFence(maskfence[masknext]);
+    }
+    return maskpool+masknext*RASTER_MASKSIZE;
+}
+
+/**
+ * @brief   blendmask
+ *
+ * @note    Queues the blend of the w x h mask m (pitch w) at (x,y) of layer with
+ *          the foreground color and gives the mask back to the pool
+ */
+static int
+blendmask(int layer, uint8_t *m, int x, int y, int w, int h) {
+DECLARE_REGION(fg,m,0,0,w,h,DMA2D_A8,w);
+DECLARE_REGION(bg,LCD_GetDrawBuffer(layer),x,y,w,h,LCD_GetFormat(layer),LCD_GetPitch(layer));
+DMA2D_Fence f;
+
+    while( (f=DMA2D_SubmitBlend(&fg,&bg,&bg,255,0,0)) == 0 ) {
+        if( DMA2D_IsIdle() )
+            return RASTER_ERROR_PARAMETER;
+    }
+    maskfence[masknext] = f;
+    masknext = (masknext+1)%RASTER_MASKS;
+    LCD_AddDamage(layer,x,y,w,h);
+    stats.masks++;
+    return RASTER_OK;
+}
+
+/**
+ * @brief   Raster_DrawLineAA
+ *
+ * @note    Draws an anti-aliased line from (x0,y0) to (x1,y1) (Wu algorithm).
+ *          Each step along the major axis sets two pixels with the coverage of
+ *          the distance to the ideal line
+ *
+ * @note    The line is cut in pieces of up to 32 steps. Each piece is a mask of
+ *          at most 32 x 34 pixels, clipped to the layer
+ */
+int
+Raster_DrawLineAA(int layer, int x0, int y0, int x1, int y1, unsigned color) {
+uint8_t *m;
+int dx,dy,steep,t,i,k,a,b,lo,hi,mw,mh,mx,my,lw,lh;
+int u,v,bx0,by0,bx1,by1;
+int32_t g,f;
+
+    if( (i=checklayer(layer)) < 0 )
+        return i;
+    lw = LCD_GetWidth(layer);
+    lh = LCD_GetHeight(layer);
+
+    // Work along the major axis (u) with the minor (v) as 16.16
+    steep = (y1-y0 > 0 ? y1-y0 : y0-y1) > (x1-x0 > 0 ? x1-x0 : x0-x1);
+    if( steep ) {
+        t = x0; x0 = y0; y0 = t;
+        t = x1; x1 = y1; y1 = t;
+    }
+    if( x0 > x1 ) {
+        t = x0; x0 = x1; x1 = t;
+        t = y0; y0 = y1; y1 = t;
+    }
+    dx = x1-x0;
+    dy = y1-y0;
+    g  = dx == 0 ? 0 : (int32_t) (((int64_t) dy*65536)/dx);
+
+    DMA2D_SetForegroundColor(color);
+    for(a=x0;a<=x1;a+=32) {
+        b  = a+32 > x1+1 ? x1+1 : a+32;
+        f  = (int32_t) y0*65536+g*(a-x0);
+        lo = f>>16;
+        hi = (f+g*(b-1-a))>>16;
+        if( lo > hi ) { t = lo; lo = hi; hi = t; }
+        hi += 2;
+        // Piece in layer coordinates (u,v) = (x,y) or (y,x)
+        if( steep ) {
+            bx0 = lo; bx1 = hi; by0 = a; by1 = b;
+        } else {
+            bx0 = a;  bx1 = b;  by0 = lo; by1 = hi;
+        }
+        if( bx0 < 0 ) bx0 = 0;
+        if( by0 < 0 ) by0 = 0;
+        if( bx1 > lw ) bx1 = lw;
+        if( by1 > lh ) by1 = lh;
+        if( bx0 >= bx1 || by0 >= by1 )
+            continue;
+        mw = bx1-bx0;
+        mh = by1-by0;
+        if( (m=getmask()) == 0 )
+            return RASTER_ERROR_NOMEMORY;
+        memset(m,0,mw*mh);
+        for(u=a;u<b;u++) {
+            f = (int32_t) y0*65536+g*(u-x0);
+            v = f>>16;
+            k = (f>>8)&0xFF;
+            for(i=0;i<2;i++,v++) {
+                mx = steep ? v : u;
+                my = steep ? u : v;
+                if( mx < bx0 || mx >= bx1 || my < by0 || my >= by1 )
+                    continue;
+                m[(my-by0)*mw+mx-bx0] = i == 0 ? 255-k : k;
+            }
+        }
+        if( (i=blendmask(layer,m,bx0,by0,mw,mh)) < 0 )
+            return i;
+    }
+    return RASTER_OK;
+}
+
+/**
+ * @brief   Raster_FillCircleAA
+ *
+ * @note    Fills an anti-aliased circle. The coverage of a pixel is
+ *          r+0.5-d clamped to 0..1, where d is the distance of its center to
+ *          the center of the circle. Only pixels with 0 < coverage < 1 need a
+ *          square root. The mask is blended in bands of lines
+ */
+int
+Raster_FillCircleAA(int layer, int cx, int cy, int r, unsigned color) {
+uint8_t *m,*row;
+int lw,lh,bx0,by0,bx1,by1,mw,band,y,yb,dy,full,outer,dx,x,cov,i,q;
+
+    if( r < 0 )
+        return RASTER_ERROR_PARAMETER;
+    if( (i=checklayer(layer)) < 0 )
+        return i;
+    lw = LCD_GetWidth(layer);
+    lh = LCD_GetHeight(layer);
+
+    bx0 = cx-r-1 < 0 ? 0 : cx-r-1;
+    by0 = cy-r-1 < 0 ? 0 : cy-r-1;
+    bx1 = cx+r+2 > lw ? lw : cx+r+2;
+    by1 = cy+r+2 > lh ? lh : cy+r+2;
+    if( bx0 >= bx1 || by0 >= by1 )
+        return RASTER_OK;
+    mw   = bx1-bx0;
+    band = RASTER_MASKSIZE/mw;
+    if( band == 0 )
+        return RASTER_ERROR_PARAMETER;
+
+    DMA2D_SetForegroundColor(color);
+    for(yb=by0;yb<by1;yb+=band) {
+        if( (m=getmask()) == 0 )
+            return RASTER_ERROR_NOMEMORY;
+        for(y=yb;y<yb+band && y<by1;y++) {
+            row = m+(y-yb)*mw;
+            memset(row,0,mw);
+            dy = y-cy;
+            // |dx| <= full: d <= r-0.5. |dx| <= outer: d < r+0.5
+            q = (2*r-1)*(2*r-1)-4*dy*dy;
+            full = q < 0 ? -1 : (int) isqrt(q/4);
+            q = (2*r+1)*(2*r+1)-4*dy*dy;
+            if( q <= 0 )
+                continue;
+            outer = isqrt((q-1)/4);
+            if( full >= 0 ) {
+                x = cx-full < bx0 ? bx0 : cx-full;
+                i = cx+full+1 > bx1 ? bx1 : cx+full+1;
+                if( x < i )
+                    memset(row+x-bx0,255,i-x);
+            }
+            for(dx=full+1;dx<=outer;dx++) {
+                cov = (r*16+8-(int) isqrt((dx*dx+dy*dy)<<8))*16;
+                if( cov <= 0 )
+                    continue;
+                if( cov > 255 )
+                    cov = 255;
+                x = cx-dx;
+                if( x >= bx0 && x < bx1 )
+                    row[x-bx0] = cov;
+                x = cx+dx;
+                if( x >= bx0 && x < bx1 )
+                    row[x-bx0] = cov;
+            }
+        }
+        if( (i=blendmask(layer,m,bx0,yb,mw,y-yb)) < 0 )
+            return i;
+    }
+    return RASTER_OK;
+}
+
+/**
+ * @brief   Raster_GetStats
+ */
+void
+Raster_GetStats(RASTER_Stats *st) {
+
+    *st = stats;
+}
@@ -0,0 +1,78 @@
+#ifndef RASTER_H
+#define RASTER_H
+/**
+ * @file    raster.h
+ *
+ * @note    Scanline rasterizer for filled polygons, circles and arcs, and
+ *          anti-aliased lines and circles
+ *
+ * @note    Filled shapes are converted to horizontal spans, one per line and
+ *          crossing, and filled by LCD_FillSpans with the DMA2D or the fill
+ *          kernels of lcd.c. Lines with the same spans as the one above are
+ *          merged into it, so a bar is a single DMA2D job
+ *
+ * @note    Anti-aliased shapes are rendered as coverage (A8) masks and blended
+ *          by the DMA2D with the color in the foreground color register, like
+ *          the glyphs of text.c. The CPU computes coverage only near the edges
+ *
+ * @note    Colors are RGB888 (RGB macro) and converted to the layer format.
+ *          Only formats the DMA2D can write are supported
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "lcd.h"
+
+/**
+ * @brief   Sizes
+ */
+///@{
+#ifndef RASTER_MAXEDGES
+#define RASTER_MAXEDGES             256     ///< polygon vertices
+#endif
+#ifndef RASTER_MAXSPANS
+#define RASTER_MAXSPANS             128     ///< spans given to LCD_FillSpans at once
+#endif
+#ifndef RASTER_MASKSIZE
+#define RASTER_MASKSIZE             4096    ///< bytes of a coverage mask
+#endif
+#ifndef RASTER_MASKS
+#define RASTER_MASKS                8       ///< masks in use by the DMA2D at once
+#endif
+#ifndef RASTER_ARCSTEP
+#define RASTER_ARCSTEP              5       ///< degrees between arc vertices
+#endif
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define RASTER_OK                   (0)
+#define RASTER_ERROR_PARAMETER      (-1)
+#define RASTER_ERROR_FORMAT         (-2)
+#define RASTER_ERROR_NOMEMORY       (-3)
+///@}
+
+/**
+ * @brief   Statistics
+ */
+typedef struct {
+    uint32_t    spans;                      ///< spans given to LCD_FillSpans
+    uint32_t    merged;                     ///< lines merged into the span above
+    uint32_t    masks;                      ///< coverage masks blended
+    uint32_t    maskwaits;                  ///< waits for a mask still in use
+} RASTER_Stats;
+
+int  Raster_FillPolygon(int layer, const LCD_Point_t *points, int n, unsigned color);
+int  Raster_FillCircle(int layer, int cx, int cy, int r, unsigned color);
+int  Raster_FillArc(int layer, int cx, int cy, int r0, int r1, int a0, int a1,
+                    unsigned color);
+int  Raster_DrawLineAA(int layer, int x0, int y0, int x1, int y1, unsigned color);
+int  Raster_FillCircleAA(int layer, int cx, int cy, int r, unsigned color);
+void Raster_GetStats(RASTER_Stats *stats);
+
+#endif // RASTER_H
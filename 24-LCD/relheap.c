@@ -0,0 +1,460 @@
+/**
+ *  @file   relheap.c
+ *
+ *  @note   Relocatable heap (see relheap.h)
+ *
+ *  @note
+ *    Each handle is an entry of a table, with the offset and the size of its
+ *    object. The handle is the index of the entry plus 1 and a generation in
+ *    the upper bits, so a handle of a freed object is refused even when the
+ *    entry is used again. order has the indexes of the entries sorted by
+ *    offset, so the gaps are found by walking it.
+ *
+ *  @note
+ *    A move copies the object from src down to dst, which is the end of the
+ *    previous object. When the gap is smaller than the object, source and
+ *    destination overlap. The copy is then split in chunks of the size of the
+ *    gap, done in ascending order, so no chunk overwrites data not yet copied.
+ *    The chunks are queued to the DMA2D as ARGB8888 regions whose width is a
+ *    power of 2 that divides the chunk (the DMA2D copies lines of at most 16383
+ *    pixels). While a move runs, the object takes the space from dst to the
+ *    end of src, and its offset changes when the last chunk is done.
+ *
+ */
+
+#include <stdint.h>
+
+#include "dma2d.h"
+#include "relheap.h"
+
+#if RELHEAP_MAXHANDLES > 255
+#error RELHEAP_MAXHANDLES must be at most 255
+#endif
+#if (RELHEAP_CHUNKSIZE%RELHEAP_ALIGN) != 0 || RELHEAP_CHUNKSIZE > 256*1024
+#error RELHEAP_CHUNKSIZE must be a multiple of RELHEAP_ALIGN up to 256 KB
+#endif
+
+/**
+ *  @brief  Width of the DMA2D regions in pixels (a power of 2)
+ */
+#define MAXWIDTH    8192
+
+/**
+ *  @brief  Object
+ */
+typedef struct {
+    uint32_t            offset;                 /// start in the area
+    uint32_t            size;                   /// multiple of RELHEAP_ALIGN
+    uint16_t            locks;                  /// RelHeap_Lock calls not undone
+    uint8_t             used;                   /// entry in use
+    uint8_t             gen;                    /// generation of the handle
+} ENTRY_t;
+
+/**
+ *  @brief  Heap
+ */
+static struct {
+    char               *base;                   /// aligned start of area
+    uint32_t            size;
+    int                 n;                      /// objects
+    uint8_t             order[RELHEAP_MAXHANDLES];
+    ENTRY_t             entries[RELHEAP_MAXHANDLES];
+    unsigned            allocs;
+    unsigned            failures;
+    unsigned            compactions;
+    unsigned            moves;
+    uint32_t            bytesmoved;
+} heap;
+
+/**
+ *  @brief  Move in progress
+ */
+static struct {
+    int                 index;                  /// -1 when none
+    uint32_t            src;
+    uint32_t            dst;
+    uint32_t            done;                   /// bytes queued
+    DMA2D_Fence         fence;                  /// last chunk queued
+} move = { -1, 0, 0, 0, 0 };
+
+static inline uint32_t roundup(uint32_t n, uint32_t a) { return (n+a-1)&~(a-1); }
+
+/**
+ *  @brief  Handle to entry index. Returns -1 when not valid
+ */
+static int
+getindex(RELHEAP_HANDLE h) {
+uint32_t i = (h&0xFF)-1;
+
+    if( i >= RELHEAP_MAXHANDLES )
+        return -1;
+    if( !heap.entries[i].used || heap.entries[i].gen != (h>>8) )
+        return -1;
+    return (int) i;
+}
+
+/**
+ *  @brief  Limits of the object in position k of order
+ *
+ *  @note   The object being moved takes from its destination to the end of
+ *          its source
+ */
+///@{
+static inline uint32_t
+blockstart(int k) {
+int i = heap.order[k];
+
+    return (i == move.index) ? move.dst : heap.entries[i].offset;
+}
+
+static inline uint32_t
+blockend(int k) {
+int i = heap.order[k];
+
+    return heap.entries[i].offset+heap.entries[i].size;
+}
+///@}
+
+/**
+ *  @brief  First gap with at least size bytes
+ *
+ *  @note   Returns the offset of the gap and in *pos the position in order
+ *          where the object goes, or -1 when none fits
+ */
+static long
+findgap(uint32_t size, int *pos) {
+uint32_t prev = 0;
+int k;
+
+    for(k=0;k<heap.n;k++) {
+        if( blockstart(k)-prev >= size ) {
+            *pos = k;
+            return prev;
+        }
+        prev = blockend(k);
+    }
+    if( heap.size-prev >= size ) {
+        *pos = heap.n;
+        return prev;
+    }
+    return -1;
+}
+
+/**
+ *  @brief  Queues the next chunks of the move
+ *
+ *  @note   A full DMA2D queue is not an error. The rest is queued in the next
+ *          step
+ */
+static void
+submitchunks(void) {
+ENTRY_t *e = &heap.entries[move.index];
+uint32_t gap,c,p,w;
+DMA2D_Fence f;
+int i;
+
+    gap = move.src-move.dst;
+    for(i=0;i<RELHEAP_STEPCHUNKS&&move.done<e->size;i++) {
+        c = e->size-move.done;
+        if( c > gap )
+            c = gap;
+        if( c > RELHEAP_CHUNKSIZE )
+            c = RELHEAP_CHUNKSIZE;
+        // c is a multiple of 32 bytes, so p is a multiple of 8 pixels
+        p = c/4;
+        for(w=MAXWIDTH;p%w!=0;w>>=1) {}
+        {
+        DECLARE_REGION(from,heap.base+move.src+move.done,0,0,w,p/w,DMA2D_ARGB8888,w*4);
+        DECLARE_REGION(to,heap.base+move.dst+move.done,0,0,w,p/w,DMA2D_ARGB8888,w*4);
+        f = DMA2D_SubmitCopy(&from,&to,0,0);
+        }
+        if( f == 0 )
+            break;
+        move.fence = f;
+        move.done += c;
+    }
+}
+
+/**
+ *  @brief  Ends the move when all chunks are done. Returns 1 when ended
+ */
+static int
+endmove(void) {
+ENTRY_t *e;
+
+    if( move.index < 0 )
+        return 1;
+    e = &heap.entries[move.index];
+    if( move.done < e->size || (move.fence && !DMA2D_FenceDone(move.fence)) )
+        return 0;
+    e->offset = move.dst;
+    heap.moves++;
+    heap.bytesmoved += e->size;
+    move.index = -1;
+    return 1;
+}
+
+/**
+ *  @brief  Completes the move (waiting for the DMA2D)
+ */
+static void
+finishmove(void) {
+
+    while( !endmove() ) {
+        submitchunks();
+        if( move.fence )
+            DMA2D_WaitFence(move.fence);
+    }
+}
+
+/**
+ *  @brief  RelHeap_Init
+ *
+ *  @note   The area is aligned to RELHEAP_ALIGN. Returns RELHEAP_ERROR_PARAM
+ *          when it is too small
+ */
+int
+RelHeap_Init(void *addr, long size) {
+uintptr_t a,end;
+int i;
+
+    if( addr == 0 || size <= 0 )
+        return RELHEAP_ERROR_PARAM;
+    a   = ((uintptr_t) addr+RELHEAP_ALIGN-1)&~(uintptr_t) (RELHEAP_ALIGN-1);
+    end = ((uintptr_t) addr+size)&~(uintptr_t) (RELHEAP_ALIGN-1);
+    if( end <= a )
+        return RELHEAP_ERROR_PARAM;
+
+    if( move.index >= 0 && move.fence )
+        DMA2D_WaitFence(move.fence);
+    move.index = -1;
+
+    heap.base = (char *) a;
+    heap.size = end-a;
+    heap.n    = 0;
+    for(i=0;i<RELHEAP_MAXHANDLES;i++) {
+        heap.entries[i].used  = 0;
+        heap.entries[i].locks = 0;
+    }
+    heap.allocs      = 0;
+    heap.failures    = 0;
+    heap.compactions = 0;
+    heap.moves       = 0;
+    heap.bytesmoved  = 0;
+    return RELHEAP_OK;
+}
+
+/**
+ *  @brief  RelHeap_Alloc
+ *
+ *  @note   Returns a handle or 0. When no gap fits, the heap is compacted and
+ *          the search is done again. The content is not initialized
+ */
+RELHEAP_HANDLE
+RelHeap_Alloc(unsigned size) {
+ENTRY_t *e;
+long offset;
+int i,k,pos;
+
+    if( heap.base == 0 || size == 0 || size > heap.size )
+        goto fail;
+    size = roundup(size,RELHEAP_ALIGN);
+
+    for(i=0;i<RELHEAP_MAXHANDLES&&heap.entries[i].used;i++) {}
+    if( i == RELHEAP_MAXHANDLES )
+        goto fail;
+
+    offset = findgap(size,&pos);
+    if( offset < 0 ) {
+        RelHeap_Compact();
+        heap.compactions++;
+        offset = findgap(size,&pos);
+        if( offset < 0 )
+            goto fail;
+    }
+
+    e = &heap.entries[i];
+    e->offset = offset;
+    e->size   = size;
+    e->locks  = 0;
+    e->used   = 1;
+    e->gen++;
+    for(k=heap.n;k>pos;k--)
+        heap.order[k] = heap.order[k-1];
+    heap.order[pos] = i;
+    heap.n++;
+    heap.allocs++;
+    return ((RELHEAP_HANDLE) e->gen<<8)|(i+1);
+
+fail:
+    heap.failures++;
+    return 0;
+}
+
+/**
+ *  @brief  RelHeap_Free
+ *
+ *  @note   A locked object can not be freed. A move of the object is stopped
+ */
+int
+RelHeap_Free(RELHEAP_HANDLE h) {
+int i,k;
+
+    i = getindex(h);
+    if( i < 0 )
+        return RELHEAP_ERROR_HANDLE;
+    if( heap.entries[i].locks )
+        return RELHEAP_ERROR_LOCKED;
+
+    if( i == move.index ) {
+        // The DMA2D must not write in the area after it is reused
+        if( move.fence )
+            DMA2D_WaitFence(move.fence);
+        move.index = -1;
+    }
+
+    for(k=0;heap.order[k]!=i;k++) {}
+    for(;k<heap.n-1;k++)
+        heap.order[k] = heap.order[k+1];
+    heap.n--;
+    heap.entries[i].used = 0;
+    return RELHEAP_OK;
+}
+
+/**
+ *  @brief  RelHeap_Lock
+ *
+ *  @note   Returns the address of the object, valid until the matching
+ *          RelHeap_Unlock, or null for an invalid handle. Locks can be nested.
+ *          When the object is being moved, waits for the end of the move
+ */
+void *
+RelHeap_Lock(RELHEAP_HANDLE h) {
+ENTRY_t *e;
+int i;
+
+    i = getindex(h);
+    if( i < 0 )
+        return 0;
+    if( i == move.index )
+        finishmove();
+    e = &heap.entries[i];
+    e->locks++;
+    return heap.base+e->offset;
+}
+
+/**
+ *  @brief  RelHeap_Unlock
+ */
+int
+RelHeap_Unlock(RELHEAP_HANDLE h) {
+int i;
+
+    i = getindex(h);
+    if( i < 0 || heap.entries[i].locks == 0 )
+        return RELHEAP_ERROR_HANDLE;
+    heap.entries[i].locks--;
+    return RELHEAP_OK;
+}
+
+/**
+ *  @brief  RelHeap_GetSize
+ *
+ *  @note   Size of the object, rounded to RELHEAP_ALIGN. 0 for an invalid handle
+ */
+uint32_t
+RelHeap_GetSize(RELHEAP_HANDLE h) {
+int i;
+
+    i = getindex(h);
+    return i < 0 ? 0 : heap.entries[i].size;
+}
+
+/**
+ *  @brief  RelHeap_Step
+ *
+ *  @note   One step of the compaction, to be called at idle time. It does not
+ *          wait for the DMA2D: it queues the next chunks of the move in
+ *          progress, ends it when they are done or starts the move of the
+ *          lowest unlocked object after a gap
+ *
+ *  @note   Returns 1 while there is work to do and 0 when no unlocked object
+ *          can be moved down
+ */
+int
+RelHeap_Step(void) {
+ENTRY_t *e;
+uint32_t prev;
+int k;
+
+    if( move.index >= 0 ) {
+        if( move.fence && !DMA2D_FenceDone(move.fence) )
+            return 1;
+        if( !endmove() )
+            submitchunks();
+        return 1;
+    }
+
+    prev = 0;
+    for(k=0;k<heap.n;k++) {
+        e = &heap.entries[heap.order[k]];
+        if( e->offset > prev && e->locks == 0 ) {
+            move.index = heap.order[k];
+            move.src   = e->offset;
+            move.dst   = prev;
+            move.done  = 0;
+            move.fence = 0;
+            submitchunks();
+            return 1;
+        }
+        prev = e->offset+e->size;
+    }
+    return 0;
+}
+
+/**
+ *  @brief  RelHeap_Compact
+ *
+ *  @note   Moves all unlocked objects down, waiting for the DMA2D. The gaps
+ *          left are only the ones before locked objects
+ */
+void
+RelHeap_Compact(void) {
+
+    while( RelHeap_Step() ) {
+        if( move.index >= 0 && move.fence )
+            DMA2D_WaitFence(move.fence);
+    }
+}
+
+/**
+ *  @brief  RelHeap_GetStats
+ */
+void
+RelHeap_GetStats(RELHEAP_Stats *stats) {
+uint32_t prev,start;
+int k;
+
+    stats->size        = heap.size;
+    stats->inuse       = 0;
+    stats->largest     = 0;
+    stats->handles     = heap.n;
+    stats->locked      = 0;
+    prev = 0;
+    for(k=0;k<heap.n;k++) {
+        start = blockstart(k);
+        if( start-prev > stats->largest )
+            stats->largest = start-prev;
+        stats->inuse += heap.entries[heap.order[k]].size;
+        if( heap.entries[heap.order[k]].locks )
+            stats->locked++;
+        prev = blockend(k);
+    }
+    if( heap.size-prev > stats->largest )
+        stats->largest = heap.size-prev;
+    stats->allocs      = heap.allocs;
+    stats->failures    = heap.failures;
+    stats->compactions = heap.compactions;
+    stats->moves       = heap.moves;
+    stats->bytesmoved  = heap.bytesmoved;
+}
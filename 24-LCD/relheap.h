@@ -0,0 +1,91 @@
+#ifndef RELHEAP_H
+#define RELHEAP_H
+/**
+ *  @file   relheap.h
+ *
+ *  @note   Relocatable heap for large and movable objects (images, caches)
+ *
+ *  @note   The buddy pool in SDRAM fragments after hours of allocations of
+ *          mixed sizes, and a large Buddy_Alloc fails with plenty of free
+ *          memory. The objects of this heap are reached by a handle, not by a
+ *          pointer, so they can be moved to close the gaps between them
+ *
+ *  @note   A pointer is only valid between RelHeap_Lock and RelHeap_Unlock.
+ *          A locked object is never moved. RelHeap_Step, called at idle time,
+ *          moves one unlocked object down to the end of the previous one with
+ *          the DMA2D. RelHeap_Alloc compacts the whole heap when no gap fits
+ *
+ *  @note   The area is given by the caller (e.g. a block of Buddy_Alloc).
+ *          DMA2D_Init must have been called (LCD_Init does it)
+ *
+ *  @note   Not reentrant. It must be used by only one thread and not in
+ *          interrupts
+ *
+ *  @author Hans
+ *  @date   15/10/2026
+ */
+
+#include <stdint.h>
+
+/**
+ *  @brief  Handle of an object. 0 is not a valid handle
+ */
+typedef uint32_t RELHEAP_HANDLE;
+
+/**
+ *  @brief  Parameters
+ *
+ *  @note   Sizes are rounded to RELHEAP_ALIGN (a cache line). An object is
+ *          copied in chunks of up to RELHEAP_CHUNKSIZE bytes, and each call of
+ *          RelHeap_Step queues up to RELHEAP_STEPCHUNKS of them
+ */
+///@{
+#ifndef RELHEAP_MAXHANDLES
+#define RELHEAP_MAXHANDLES          64
+#endif
+#ifndef RELHEAP_CHUNKSIZE
+#define RELHEAP_CHUNKSIZE           (64*1024)
+#endif
+#ifndef RELHEAP_STEPCHUNKS
+#define RELHEAP_STEPCHUNKS          4
+#endif
+#define RELHEAP_ALIGN               (32)
+///@}
+
+/**
+ *  @brief  Return values
+ */
+///@{
+#define RELHEAP_OK                  (0)
+#define RELHEAP_ERROR_HANDLE        (-1)
+#define RELHEAP_ERROR_LOCKED        (-2)
+#define RELHEAP_ERROR_PARAM         (-3)
+///@}
+
+/**
+ *  @brief  Statistics
+ */
+typedef struct {
+    uint32_t    size;                       ///< size of the area
+    uint32_t    inuse;                      ///< bytes in objects
+    uint32_t    largest;                    ///< largest gap
+    unsigned    handles;                    ///< objects allocated
+    unsigned    locked;                     ///< objects locked
+    unsigned    allocs;                     ///< allocations that succeeded
+    unsigned    failures;                   ///< allocations that did not fit
+    unsigned    compactions;                ///< full compactions by RelHeap_Alloc
+    unsigned    moves;                      ///< objects moved
+    uint32_t    bytesmoved;                 ///< bytes copied by the DMA2D
+} RELHEAP_Stats;
+
+int             RelHeap_Init(void *addr, long size);
+RELHEAP_HANDLE  RelHeap_Alloc(unsigned size);
+int             RelHeap_Free(RELHEAP_HANDLE h);
+void           *RelHeap_Lock(RELHEAP_HANDLE h);
+int             RelHeap_Unlock(RELHEAP_HANDLE h);
+uint32_t        RelHeap_GetSize(RELHEAP_HANDLE h);
+int             RelHeap_Step(void);
+void            RelHeap_Compact(void);
+void            RelHeap_GetStats(RELHEAP_Stats *stats);
+
+#endif
@@ -0,0 +1,256 @@
+/**
+ * @file    rotate.c
+ *
+ * @note    Portrait buffer rotated into a landscape layer by tiles
+ *
+ * @note    A portrait pixel (px,py) goes to the layer pixel
+ *
+ *          Direction  | lx         | ly
+ *          -----------|------------|-----------
+ *          ROTATE_90  | ph-1-py    | px
+ *          ROTATE_270 | py         | pw-1-px
+ *
+ *          where pw x ph is the size of the portrait buffer (the height and
+ *          the width of the layer)
+ *
+ * @note    Renderers that use the DMA2D must be finished before Rotate_Update
+ *          reads the buffer, so it calls LCD_WaitDrawing. The rotation itself is
+ *          done by the CPU, since the DMA2D can not transpose
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "lcd.h"
+#include "buddy.h"
+#include "memsections.h"
+#include "rotate.h"
+
+/**
+ * @brief   Rectangle (x1,y1 not included)
+ */
+typedef struct {
+    int16_t         x0,y0,x1,y1;
+} Rect;
+
+/**
+ * @brief   Rotation state
+ */
+static struct {
+    int             layer;
+    int             direction;
+    int             format;
+    int             ps;                     ///< bytes per pixel
+    char           *buffer;                 ///< portrait buffer
+    int             pitch;
+    int             pw;                     ///< portrait size
+    int             ph;
+    Rect            damage[ROTATE_MAXDAMAGE];
+    int             ndamage;
+    ROTATE_Stats    stats;
+} rot = { .layer = -1 };
+
+/**
+ * @brief   Tile kernels
+ *
+ * @note    Rotates the tile (x0,y0,w,h) of the portrait buffer src, with w and h
+ *          at most ROTATE_TILE. The tile is read line by line into t, transposed,
+ *          and each line of t is written as one run of a layer line
+ */
+#define DEFINE_TILE(NAME,TYPE)                                                  \
+ITCM_CODE static void                                                           \
+NAME(const char *src, int spitch, char *dst, int dpitch, int x0, int y0,        \
+     int w, int h) {                                                            \
+TYPE t[ROTATE_TILE][ROTATE_TILE];                                               \
+const TYPE *s;                                                                  \
+TYPE *d;                                                                        \
+int i,j;                                                                        \
+                                                                                \
+    for(i=0;i<h;i++) {                                                          \
+        s = (const TYPE *) (src+(y0+i)*spitch)+x0;                              \
+        for(j=0;j<w;j++)                                                        \
+            t[j][i] = s[j];                                                     \
+    }                                                                           \
+    for(j=0;j<w;j++) {                                                          \
+        if( rot.direction == ROTATE_90 ) {                                      \
+            d = (TYPE *) (dst+(x0+j)*dpitch)+(rot.ph-1-y0);                     \
+            for(i=0;i<h;i++)                                                    \
+                d[-i] = t[j][i];                                                \
+        } else {                                                                \
+            d = (TYPE *) (dst+(rot.pw-1-x0-j)*dpitch)+y0;                       \
+            for(i=0;i<h;i++)                                                    \
+                d[i] = t[j][i];                                                 \
+        }                                                                       \
+    }                                                                           \
+}
+
+DEFINE_TILE(tile8, uint8_t)
+DEFINE_TILE(tile16,uint16_t)
+DEFINE_TILE(tile24,RGB_t)
+DEFINE_TILE(tile32,uint32_t)
+
+/**
+ * @brief   Kernels by pixel size
+ */
+static void (* const tilefunctions[5])(const char *, int, char *, int, int, int, int, int) = {
+    0, tile8, tile16, tile24, tile32
+};
+
+/**
+ * @brief   Rotate_Init
+ *
+ * @note    Allocates a portrait buffer for layer from the buddy pool (SDRAM)
+ *          with the format of the layer. The layer must already have a frame
+ *          buffer. The buffer is not cleared
+ */
+int
+Rotate_Init(int layer, int direction) {
+
+    if( direction != ROTATE_90 && direction != ROTATE_270 )
+        return ROTATE_ERROR_PARAMETER;
+    if( LCD_GetWidth(layer) <= 0 || LCD_GetHeight(layer) <= 0 )
+        return ROTATE_ERROR_PARAMETER;
+
+    if( rot.buffer )
+        Buddy_Free(rot.buffer);
+    rot.layer     = -1;
+    rot.direction = direction;
+    rot.format    = LCD_GetFormat(layer);
+    rot.ps        = LCD_GetPixelSize(layer);
+    rot.pw        = LCD_GetHeight(layer);
+    rot.ph        = LCD_GetWidth(layer);
+    rot.pitch     = ((rot.pw*rot.ps+63)/64)*64;
+    rot.buffer    = Buddy_Alloc(rot.pitch*rot.ph);
+    if( rot.buffer == 0 )
+        return ROTATE_ERROR_NOMEMORY;
+
+    rot.layer     = layer;
+    rot.ndamage   = 0;
+    rot.stats.updates = 0;
+    return ROTATE_OK;
+}
+
+/**
+ * @brief   Portrait buffer and its geometry
+ *
+ * @note    Renderers use them like a frame buffer (e.g. Text_DrawInBuffer or
+ *          a DMA2D region) and call Rotate_AddDamage for what they changed
+ */
+///@{
+void *Rotate_GetBuffer(void) { return rot.buffer; }
+int   Rotate_GetWidth(void)  { return rot.pw; }
+int   Rotate_GetHeight(void) { return rot.ph; }
+int   Rotate_GetPitch(void)  { return rot.pitch; }
+int   Rotate_GetFormat(void) { return rot.format; }
+///@}
+
+/**
+ * @brief   Rotate_AddDamage
+ *
+ * @note    Records that the rectangle (x,y,w,h) of the portrait buffer was
+ *          changed. Overlapping rectangles are merged. When the list is full,
+ *          the new one is merged with the last
+ */
+void
+Rotate_AddDamage(int x, int y, int w, int h) {
+Rect r,*q;
+int i;
+
+    if( rot.layer < 0 )
+        return;
+    if( x < 0 ) { w += x; x = 0; }
+    if( y < 0 ) { h += y; y = 0; }
+    if( x+w > rot.pw ) w = rot.pw-x;
+    if( y+h > rot.ph ) h = rot.ph-y;
+    if( w <= 0 || h <= 0 )
+        return;
+
+    r.x0 = x;
+    r.y0 = y;
+    r.x1 = x+w;
+    r.y1 = y+h;
+restart:
+    for(i=0;i<rot.ndamage;i++) {
+        q = &rot.damage[i];
+        if( r.x0 < q->x1 && q->x0 < r.x1 && r.y0 < q->y1 && q->y0 < r.y1 ) {
+            if( q->x0 < r.x0 ) r.x0 = q->x0;
+            if( q->y0 < r.y0 ) r.y0 = q->y0;
+            if( q->x1 > r.x1 ) r.x1 = q->x1;
+            if( q->y1 > r.y1 ) r.y1 = q->y1;
+            rot.damage[i] = rot.damage[--rot.ndamage];
+            goto restart;
+        }
+    }
+    if( rot.ndamage == ROTATE_MAXDAMAGE ) {
+        q = &rot.damage[--rot.ndamage];
+        if( q->x0 < r.x0 ) r.x0 = q->x0;
+        if( q->y0 < r.y0 ) r.y0 = q->y0;
+        if( q->x1 > r.x1 ) r.x1 = q->x1;
+        if( q->y1 > r.y1 ) r.y1 = q->y1;
+        goto restart;
+    }
+    rot.damage[rot.ndamage++] = r;
+}
+
+/**
+ * @brief   Rotate_Update
+ *
+ * @note    Rotates the damaged rectangles into the draw buffer of the layer
+ *          (LCD_GetDrawBuffer) and adds the rotated rectangles to its damage.
+ *          With flipping, LCD_PresentFrame must be called after it
+ *
+ * @note    Returns the number of pixels rotated or -1 before Rotate_Init
+ */
+int
+Rotate_Update(void) {
+void (*tile)(const char *, int, char *, int, int, int, int, int);
+const Rect *r;
+char *dst;
+int dpitch,x,y,w,h,k;
+uint32_t pixels = 0;
+uint32_t tiles = 0;
+
+    if( rot.layer < 0 )
+        return -1;
+    if( rot.ndamage == 0 )
+        return 0;
+
+    LCD_WaitDrawing();
+    tile   = tilefunctions[rot.ps];
+    dst    = LCD_GetDrawBuffer(rot.layer);
+    dpitch = LCD_GetPitch(rot.layer);
+    for(k=0;k<rot.ndamage;k++) {
+        r = &rot.damage[k];
+        for(y=r->y0;y<r->y1;y+=ROTATE_TILE) {
+            h = r->y1-y < ROTATE_TILE ? r->y1-y : ROTATE_TILE;
+            for(x=r->x0;x<r->x1;x+=ROTATE_TILE) {
+                w = r->x1-x < ROTATE_TILE ? r->x1-x : ROTATE_TILE;
+                tile(rot.buffer,rot.pitch,dst,dpitch,x,y,w,h);
+                tiles++;
+            }
+        }
+        if( rot.direction == ROTATE_90 )
+            LCD_AddDamage(rot.layer,rot.ph-r->y1,r->x0,r->y1-r->y0,r->x1-r->x0);
+        else
+            LCD_AddDamage(rot.layer,r->y0,rot.pw-r->x1,r->y1-r->y0,r->x1-r->x0);
+        pixels += (r->x1-r->x0)*(r->y1-r->y0);
+    }
+
+    rot.stats.updates++;
+    rot.stats.lastrects  = rot.ndamage;
+    rot.stats.lastpixels = pixels;
+    rot.stats.lasttiles  = tiles;
+    rot.ndamage = 0;
+    return pixels;
+}
+
+/**
+ * @brief   Rotate_GetStats
+ */
+void
+Rotate_GetStats(ROTATE_Stats *stats) {
+
+    *stats = rot.stats;
+}
@@ -0,0 +1,77 @@
+#ifndef ROTATE_H
+#define ROTATE_H
+/**
+ * @file    rotate.h
+ *
+ * @note    Portrait mode for a layer. The LTDC can not rotate, so renderers
+ *          draw into a portrait buffer (LCD_DH x LCD_DW for a full size layer)
+ *          and Rotate_Update copies its damaged rectangles, rotated, into the
+ *          draw buffer of the layer
+ *
+ * @note    The copy is done in tiles of ROTATE_TILE x ROTATE_TILE pixels. A
+ *          tile is read line by line into a local array and written, transposed,
+ *          line by line, so both buffers are accessed in short sequential runs
+ *          in at most ROTATE_TILE SDRAM rows, instead of a row change for every
+ *          pixel of a naive transpose
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Directions
+ *
+ * @note    ROTATE_90: the top of the portrait image is at the right side of
+ *          the panel. ROTATE_270: at the left side
+ */
+///@{
+#define ROTATE_90                   (1)
+#define ROTATE_270                  (3)
+///@}
+
+/**
+ * @brief   Tile size (pixels)
+ */
+#ifndef ROTATE_TILE
+#define ROTATE_TILE                 16
+#endif
+
+/**
+ * @brief   Maximal number of damaged rectangles per update
+ */
+#ifndef ROTATE_MAXDAMAGE
+#define ROTATE_MAXDAMAGE            16
+#endif
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define ROTATE_OK                   (0)
+#define ROTATE_ERROR_PARAMETER      (-1)
+#define ROTATE_ERROR_NOMEMORY       (-2)
+///@}
+
+/**
+ * @brief   Statistics
+ */
+typedef struct {
+    uint32_t    updates;                    ///< calls to Rotate_Update with damage
+    uint32_t    lastrects;                  ///< rectangles rotated in the last update
+    uint32_t    lastpixels;                 ///< pixels rotated in the last update
+    uint32_t    lasttiles;                  ///< tiles rotated in the last update
+} ROTATE_Stats;
+
+int   Rotate_Init(int layer, int direction);
+void *Rotate_GetBuffer(void);
+int   Rotate_GetWidth(void);
+int   Rotate_GetHeight(void);
+int   Rotate_GetPitch(void);
+int   Rotate_GetFormat(void);
+void  Rotate_AddDamage(int x, int y, int w, int h);
+int   Rotate_Update(void);
+void  Rotate_GetStats(ROTATE_Stats *stats);
+
+#endif // ROTATE_H
@@ -0,0 +1,175 @@
+/**
+ * @file    scene.c
+ *
+ * @note    Composition of a static background and a moving overlay by the LTDC
+ *
+ * @note    Both buffers are allocated from the buddy allocator (SDRAM). The LTDC
+ *          blends the overlay window over the background during scan out, with
+ *          constant alpha and color keying, so nothing is copied when the
+ *          overlay moves
+ *
+ * @note    The position is changed in the shadow registers and used after the
+ *          next vertical blanking, when Scene_Present returns
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "stm32f746xx.h"
+#include "lcd.h"
+#include "buddy.h"
+#include "scene.h"
+
+/**
+ * @brief   Scene state
+ */
+///@{
+static void         *background = 0;
+static void         *overlay    = 0;
+static int          bgps, ovps;
+static int          ovw, ovh;
+static int          ovx, ovy;
+static int          lastx, lasty;
+static SCENE_Stats  stats;
+///@}
+
+/**
+ * @brief   Scene_Init
+ *
+ * @note    Allocates the background (full screen, bgformat) and the overlay
+ *          (ovwidth x ovheight, ovformat) and shows both, with the overlay at the
+ *          top left corner. Buffers of a previous call are freed
+ *
+ * @note    Returns 0 or -1 when there is no memory
+ */
+int
+Scene_Init(int bgformat, int ovformat, int ovwidth, int ovheight) {
+int pitch;
+
+    if( background ) Buddy_Free(background);
+    if( overlay )    Buddy_Free(overlay);
+    overlay = 0;
+
+    background = Buddy_Alloc(LCD_GetMinimalFullFrameBufferSize(bgformat));
+    if( background == 0 )
+        return -1;
+    LCD_SetFullSizeFrameBuffer(SCENE_BACKGROUND,background,bgformat);
+    bgps = LCD_GetPixelSize(SCENE_BACKGROUND);
+
+    // Lines aligned to 64 bytes like the other frame buffers
+    LCD_SetFormat(SCENE_OVERLAY,ovformat);
+    ovps  = LCD_GetPixelSize(SCENE_OVERLAY);
+    pitch = ((ovwidth*ovps+63)/64)*64;
+    overlay = Buddy_Alloc(pitch*ovheight);
+    if( overlay == 0 ) {
+        Buddy_Free(background);
+        background = 0;
+        return -1;
+    }
+    LCD_SetFrameBuffer(SCENE_OVERLAY,overlay,ovformat,0,0,ovwidth,ovheight,pitch);
+
+    ovw   = ovwidth;
+    ovh   = ovheight;
+    ovx   = lastx = 0;
+    ovy   = lasty = 0;
+
+    stats.frames           = 0;
+    stats.scanoutbytes     = LCD_GetWidth(SCENE_BACKGROUND)*LCD_GetHeight(SCENE_BACKGROUND)*bgps
+                           + ovw*ovh*ovps;
+    stats.lastbytes        = 0;
+    stats.totalbytes       = 0;
+    stats.singlebytes      = 0;
+    stats.totalsinglebytes = 0;
+
+    return 0;
+}
+
+/**
+ * @brief   Scene_SetOverlayKey
+ *
+ * @note    When on, overlay pixels with color (RGB888) show the background
+ */
+void
+Scene_SetOverlayKey(int on, uint32_t color) {
+
+    if( on )
+        LCD_EnableColorKey(SCENE_OVERLAY,color);
+    else
+        LCD_DisableColorKey(SCENE_OVERLAY);
+}
+
+/**
+ * @brief   Scene_SetOverlayOpacity
+ *
+ * @note    Constant alpha of the overlay (0=transparent, 255=opaque)
+ */
+void
+Scene_SetOverlayOpacity(int opacity) {
+
+    LCD_SetLayerOpacity(SCENE_OVERLAY,opacity);
+}
+
+/**
+ * @brief   Scene_MoveOverlay
+ *
+ * @note    The overlay is shown at (x,y) after the next Scene_Present. It is
+ *          kept inside the display
+ */
+void
+Scene_MoveOverlay(int x, int y) {
+
+    ovx = x;
+    ovy = y;
+    LCD_SetLayerPosition(SCENE_OVERLAY,x,y);
+}
+
+/**
+ * @brief   Scene_Present
+ *
+ * @note    Waits until drawing is done and the next vertical blanking reloads
+ *          the layers. redrawn tells which buffers were drawn for this frame
+ *          and is used for the SDRAM traffic statistics
+ */
+void
+Scene_Present(unsigned redrawn) {
+uint32_t written = 0, single = 0;
+uint32_t bgbytes, ovinbg;
+int moved;
+
+    LCD_WaitDrawing();
+    LCD_ReloadLayerByVerticalBlanking(SCENE_OVERLAY);
+    while( LTDC->SRCR&LTDC_SRCR_VBR ) {}
+
+    bgbytes = LCD_GetWidth(SCENE_BACKGROUND)*LCD_GetHeight(SCENE_BACKGROUND)*bgps;
+    ovinbg  = ovw*ovh*bgps;
+    moved   = ovx != lastx || ovy != lasty;
+
+    if( redrawn&SCENE_REDRAW_BACKGROUND ) {
+        written += bgbytes;
+        single  += bgbytes;
+    }
+    if( redrawn&SCENE_REDRAW_OVERLAY )
+        written += ovw*ovh*ovps;
+    if( !(redrawn&SCENE_REDRAW_BACKGROUND) && (moved || (redrawn&SCENE_REDRAW_OVERLAY)) )
+        single  += 3*ovinbg;
+
+    lastx = ovx;
+    lasty = ovy;
+
+    stats.frames++;
+    stats.lastbytes         = written;
+    stats.totalbytes       += written;
+    stats.singlebytes       = single;
+    stats.totalsinglebytes += single;
+}
+
+/**
+ * @brief   Scene_GetStats
+ */
+void
+Scene_GetStats(SCENE_Stats *st) {
+
+    *st = stats;
+}
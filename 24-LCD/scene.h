@@ -0,0 +1,59 @@
+#ifndef SCENE_H
+#define SCENE_H
+/**
+ * @file    scene.h
+ *
+ * @note    Composition of a static background and a moving overlay by the LTDC
+ *
+ * @note    The background is a full screen buffer in layer 1 (SCENE_BACKGROUND)
+ *          and the overlay a small window in layer 2 (SCENE_OVERLAY). Both are
+ *          drawn with the LCD_* routines using these layer numbers. Moving the
+ *          overlay only changes the window position, so an animation writes
+ *          just the overlay buffer, or nothing when the overlay does not change
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Layers used by the scene
+ */
+///@{
+#define SCENE_BACKGROUND            1
+#define SCENE_OVERLAY               2
+///@}
+
+/**
+ * @brief   Flags for Scene_Present: what was redrawn since the last frame
+ */
+///@{
+#define SCENE_REDRAW_BACKGROUND     1
+#define SCENE_REDRAW_OVERLAY        2
+///@}
+
+/**
+ * @brief   SDRAM traffic of the scene
+ *
+ * @note    singlebytes is what the same frame would write and read in a single
+ *          layer: restore the background under the old overlay position (read
+ *          and write) and draw the overlay at the new one
+ */
+typedef struct {
+    uint32_t    frames;                     ///< calls to Scene_Present
+    uint32_t    scanoutbytes;               ///< read by the LTDC in each frame
+    uint32_t    lastbytes;                  ///< written in the last frame
+    uint32_t    totalbytes;                 ///< written since Scene_Init
+    uint32_t    singlebytes;                ///< last frame done in a single layer
+    uint32_t    totalsinglebytes;           ///< the same since Scene_Init
+} SCENE_Stats;
+
+int  Scene_Init(int bgformat, int ovformat, int ovwidth, int ovheight);
+void Scene_SetOverlayKey(int on, uint32_t color);
+void Scene_SetOverlayOpacity(int opacity);
+void Scene_MoveOverlay(int x, int y);
+void Scene_Present(unsigned redrawn);
+void Scene_GetStats(SCENE_Stats *stats);
+
+#endif // SCENE_H
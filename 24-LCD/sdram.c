@@ -1149,6 +1149,16 @@ SDRAM_InitEx(int bank) {
     /* Configure Refresh */
     ConfigureSDRAMRefresh(bank);
 
+    /* Zero variables in section SDRAM BSS (see memsections.h) */
+    if( bank == SDRAM_BANK1 ) {
+        extern unsigned long _sdram_bss_start;
+        extern unsigned long _sdram_bss_end;
+        unsigned long *p = &_sdram_bss_start;
+        while( p < &_sdram_bss_end ) {
+            *p++ = 0;
+        }
+    }
+
     return 0;
 }
 
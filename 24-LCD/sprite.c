@@ -0,0 +1,411 @@
+/**
+ * @file    sprite.c
+ *
+ * @note    Sprites blended over a static background by the DMA2D
+ *
+ * @note    A sprite that moved, changed or was hidden makes its old and new
+ *          rectangles dirty (one rectangle when they overlap). For each dirty
+ *          rectangle, the background is copied from the background buffer and
+ *          the part of each sprite inside it is blended, from the lowest depth
+ *          to the highest. Overlapping dirty rectangles are correct, since each
+ *          one is rebuilt completely
+ *
+ * @note    The jobs are prepared into a DMA2D batch. When it is full, it is
+ *          submitted and a new one begun
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "lcd.h"
+#include "dma2d.h"
+#include "sprite.h"
+
+/**
+ * @brief   Rectangle (x1,y1 not included)
+ */
+typedef struct {
+    int16_t         x0,y0,x1,y1;
+} Rect;
+
+/**
+ * @brief   Sprite
+ */
+typedef struct {
+    const SPRITE_Image *image;
+    int16_t         x,y;
+    int16_t         depth;
+    uint8_t         alpha;
+    uint8_t         inuse;
+    uint8_t         visible;
+    uint8_t         changed;
+    Rect            drawn;                  ///< in the last frame (empty = none)
+} Sprite;
+
+/**
+ * @brief   Sprite state
+ */
+///@{
+static Sprite       sprites[SPRITE_MAX];
+static uint8_t      order[SPRITE_MAX];          ///< in use, by depth
+static int          nordered = 0;
+static int          resort   = 0;
+static int          layer    = -1;
+static const void  *background = 0;
+static DMA2D_Batch  batch    = -1;
+static SPRITE_Stats stats;
+///@}
+
+/**
+ * @brief   Flags in Sprite.changed
+ */
+///@{
+#define CHANGED             1
+#define DESTROYED           2
+///@}
+
+/**
+ * @brief   Dirty rectangles of a frame
+ */
+static Rect         dirty[2*SPRITE_MAX];
+
+static inline int valid(int id) {
+    return id >= 0 && id < SPRITE_MAX && sprites[id].inuse && !(sprites[id].changed&DESTROYED);
+}
+
+static inline int isempty(const Rect *r) { return r->x0 >= r->x1 || r->y0 >= r->y1; }
+
+static inline int overlaps(const Rect *a, const Rect *b) {
+    return a->x0 < b->x1 && b->x0 < a->x1 && a->y0 < b->y1 && b->y0 < a->y1;
+}
+
+/**
+ * @brief   Rectangle of sprite s clipped to the layer
+ */
+static void
+screenrect(const Sprite *s, int lw, int lh, Rect *r) {
+int x1 = s->x+s->image->width;
+int y1 = s->y+s->image->height;
+
+    r->x0 = s->x < 0 ? 0 : s->x;
+    r->y0 = s->y < 0 ? 0 : s->y;
+    r->x1 = x1 > lw ? lw : x1;
+    r->y1 = y1 > lh ? lh : y1;
+    if( !s->visible || isempty(r) )
+        r->x0 = r->x1 = r->y0 = r->y1 = 0;
+}
+
+/**
+ * @brief   Sorts order by depth (insertion sort, stable)
+ */
+static void
+sortsprites(void) {
+int i,j,k;
+uint8_t t;
+
+    nordered = 0;
+    for(i=0;i<SPRITE_MAX;i++) {
+        if( sprites[i].inuse )
+            order[nordered++] = i;
+    }
+    for(i=1;i<nordered;i++) {
+        t = order[i];
+        k = sprites[t].depth;
+        for(j=i;j>0 && sprites[order[j-1]].depth > k;j--)
+            order[j] = order[j-1];
+        order[j] = t;
+    }
+    resort = 0;
+}
+
+/**
+ * @brief   Submits the current batch and begins a new one
+ */
+static void
+flushbatch(void) {
+
+    if( batch >= 0 ) {
+        while( DMA2D_SubmitBatch(batch,0,0) == 0 ) {}
+        stats.batches++;
+    }
+    while( (batch=DMA2D_BeginBatch()) < 0 ) {}
+}
+
+/**
+ * @brief   Rebuilds rectangle r of the frame buffer fb
+ */
+static void
+rebuild(void *fb, int format, int pitch, const Rect *r) {
+const SPRITE_Image *im;
+const Sprite *s;
+int x0,y0,x1,y1;
+int i;
+
+    {
+    DECLARE_REGION(src,background,r->x0,r->y0,r->x1-r->x0,r->y1-r->y0,format,pitch);
+    DECLARE_REGION(dst,fb,r->x0,r->y0,r->x1-r->x0,r->y1-r->y0,format,pitch);
+    if( DMA2D_BatchCopy(batch,&src,&dst) < 0 ) {
+        flushbatch();
+        DMA2D_BatchCopy(batch,&src,&dst);
+    }
+    stats.lastjobs++;
+    }
+
+    for(i=0;i<nordered;i++) {
+        s = &sprites[order[i]];
+        if( !s->visible )
+            continue;
+        im = s->image;
+        x0 = s->x > r->x0 ? s->x : r->x0;
+        y0 = s->y > r->y0 ? s->y : r->y0;
+        x1 = s->x+im->width  < r->x1 ? s->x+im->width  : r->x1;
+        y1 = s->y+im->height < r->y1 ? s->y+im->height : r->y1;
+        if( x0 >= x1 || y0 >= y1 )
+            continue;
+        {
+        DECLARE_REGION(fg,im->pixels,x0-s->x,y0-s->y,x1-x0,y1-y0,im->format,im->pitch);
+        DECLARE_REGION(bg,fb,x0,y0,x1-x0,y1-y0,format,pitch);
+        if( DMA2D_BatchBlend(batch,&fg,&bg,&bg,s->alpha) < 0 ) {
+            flushbatch();
+            DMA2D_BatchBlend(batch,&fg,&bg,&bg,s->alpha);
+        }
+        stats.lastjobs++;
+        }
+    }
+}
+
+/**
+ * @brief   Sprite_Init
+ *
+ * @note    Sprites are drawn in layer. background has the same size, format
+ *          and pitch as the frame buffer of the layer and is what is shown where
+ *          there is no sprite. It is not written. All sprites are destroyed
+ *
+ * @note    Returns 0 or -1 when the layer format can not be written by the DMA2D
+ */
+int
+Sprite_Init(int l, const void *bg) {
+int i;
+
+    if( LCD_GetFormat(l) > LCD_FORMAT_ARGB4444 || bg == 0 )
+        return -1;
+    layer      = l;
+    background = bg;
+    for(i=0;i<SPRITE_MAX;i++)
+        sprites[i].inuse = 0;
+    nordered = 0;
+    resort   = 0;
+    stats.frames  = 0;
+    stats.batches = 0;
+    return 0;
+}
+
+/**
+ * @brief   Sprite_Create
+ *
+ * @note    Creates a visible and opaque sprite with the top left corner at
+ *          (x,y). Sprites with larger depth are drawn over the others
+ *
+ * @note    Returns the id of the sprite or -1 when there is no free one or the
+ *          image format has no alpha
+ */
+int
+Sprite_Create(const SPRITE_Image *image, int x, int y, int depth) {
+Sprite *s;
+int i;
+
+    if( image == 0 || (image->format != DMA2D_ARGB8888 && image->format != DMA2D_ARGB4444
+                    && image->format != DMA2D_ARGB1555) )
+        return -1;
+    for(i=0;i<SPRITE_MAX;i++) {
+        s = &sprites[i];
+        if( s->inuse )
+            continue;
+        s->image   = image;
+        s->x       = x;
+        s->y       = y;
+        s->depth   = depth;
+        s->alpha   = 255;
+        s->visible = 1;
+        s->changed = CHANGED;
+        s->drawn.x0 = s->drawn.x1 = s->drawn.y0 = s->drawn.y1 = 0;
+        s->inuse   = 1;
+        resort     = 1;
+        return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief   Sprite_Destroy
+ *
+ * @note    The sprite is hidden and its id is freed at the next Sprite_Render
+ */
+void
+Sprite_Destroy(int id) {
+
+    if( !valid(id) )
+        return;
+    sprites[id].visible  = 0;
+    sprites[id].changed |= CHANGED|DESTROYED;
+}
+
+/**
+ * @brief   Sprite_Move
+ */
+void
+Sprite_Move(int id, int x, int y) {
+
+    if( !valid(id) )
+        return;
+    if( x == sprites[id].x && y == sprites[id].y )
+        return;
+    sprites[id].x = x;
+    sprites[id].y = y;
+    sprites[id].changed |= CHANGED;
+}
+
+/**
+ * @brief   Sprite_SetImage
+ *
+ * @note    For animations: the new image is used at the next Sprite_Render
+ */
+void
+Sprite_SetImage(int id, const SPRITE_Image *image) {
+
+    if( !valid(id) || image == 0 )
+        return;
+    sprites[id].image    = image;
+    sprites[id].changed |= CHANGED;
+}
+
+/**
+ * @brief   Sprite_SetDepth
+ */
+void
+Sprite_SetDepth(int id, int depth) {
+
+    if( !valid(id) || sprites[id].depth == depth )
+        return;
+    sprites[id].depth    = depth;
+    sprites[id].changed |= CHANGED;
+    resort = 1;
+}
+
+/**
+ * @brief   Sprite_SetAlpha
+ *
+ * @note    Constant alpha multiplied with the alpha of the image
+ */
+void
+Sprite_SetAlpha(int id, unsigned alpha) {
+
+    if( !valid(id) )
+        return;
+    sprites[id].alpha    = alpha > 255 ? 255 : alpha;
+    sprites[id].changed |= CHANGED;
+}
+
+/**
+ * @brief   Sprite_Show
+ */
+void
+Sprite_Show(int id, int visible) {
+
+    if( !valid(id) )
+        return;
+    sprites[id].visible  = visible != 0;
+    sprites[id].changed |= CHANGED;
+}
+
+/**
+ * @brief   Sprite_Render
+ *
+ * @note    Submits the jobs that bring the draw buffer of the layer up to date
+ *          and adds the rectangles to its damage. It does not wait for them.
+ *          LCD_PresentFrame (or LCD_WaitDrawing) waits before the flip
+ *
+ * @note    Returns the number of dirty rectangles or -1 before Sprite_Init
+ */
+int
+Sprite_Render(void) {
+Sprite *s;
+Rect r;
+void *fb;
+int format,pitch,lw,lh;
+int i,n;
+
+    if( layer < 0 )
+        return -1;
+    if( resort )
+        sortsprites();
+
+    fb     = LCD_GetDrawBuffer(layer);
+    format = LCD_GetFormat(layer);
+    pitch  = LCD_GetPitch(layer);
+    lw     = LCD_GetWidth(layer);
+    lh     = LCD_GetHeight(layer);
+
+    // Old and new rectangles of the sprites that changed
+    n = 0;
+    for(i=0;i<nordered;i++) {
+        s = &sprites[order[i]];
+        if( !s->changed )
+            continue;
+        screenrect(s,lw,lh,&r);
+        if( !isempty(&s->drawn) ) {
+            if( !isempty(&r) && overlaps(&r,&s->drawn) ) {
+                if( s->drawn.x0 < r.x0 ) r.x0 = s->drawn.x0;
+                if( s->drawn.y0 < r.y0 ) r.y0 = s->drawn.y0;
+                if( s->drawn.x1 > r.x1 ) r.x1 = s->drawn.x1;
+                if( s->drawn.y1 > r.y1 ) r.y1 = s->drawn.y1;
+            } else {
+                dirty[n++] = s->drawn;
+            }
+        }
+        if( !isempty(&r) )
+            dirty[n++] = r;
+    }
+
+    stats.lastjobs   = 0;
+    stats.lastpixels = 0;
+    if( n > 0 ) {
+        flushbatch();
+        for(i=0;i<n;i++) {
+            rebuild(fb,format,pitch,&dirty[i]);
+            LCD_AddDamage(layer,dirty[i].x0,dirty[i].y0,
+                          dirty[i].x1-dirty[i].x0,dirty[i].y1-dirty[i].y0);
+            stats.lastpixels += (dirty[i].x1-dirty[i].x0)*(dirty[i].y1-dirty[i].y0);
+        }
+        while( DMA2D_SubmitBatch(batch,0,0) == 0 ) {}
+        stats.batches++;
+        batch = -1;
+    }
+
+    // What is in the frame now
+    for(i=0;i<nordered;i++) {
+        s = &sprites[order[i]];
+        if( s->changed&DESTROYED ) {
+            s->inuse = 0;
+            resort   = 1;
+        } else if( s->changed ) {
+            screenrect(s,lw,lh,&s->drawn);
+        }
+        s->changed = 0;
+    }
+
+    stats.lastrects = n;
+    stats.frames++;
+    return n;
+}
+
+/**
+ * @brief   Sprite_GetStats
+ */
+void
+Sprite_GetStats(SPRITE_Stats *st) {
+
+    *st = stats;
+}
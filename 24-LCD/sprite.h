@@ -0,0 +1,65 @@
+#ifndef SPRITE_H
+#define SPRITE_H
+/**
+ * @file    sprite.h
+ *
+ * @note    Sprites blended over a static background by the DMA2D
+ *
+ * @note    Each frame, Sprite_Render restores the background under the sprites
+ *          that changed (old and new position) and blends again, in depth
+ *          order, all sprites that touch those rectangles. All jobs of a frame
+ *          go to the DMA2D as one batch (DMA2D_SubmitBatch), so the CPU does
+ *          not wait and the queue is not filled. The rectangles are added to
+ *          the damage of the layer, so it works with LCD_SetupFrameBuffers
+ *
+ * @note    Images are in ARGB8888, ARGB4444 or ARGB1555 and can be anywhere
+ *          the DMA2D can read: SDRAM, flash or the QSPI flash in memory mapped
+ *          mode
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Maximal number of sprites
+ */
+#ifndef SPRITE_MAX
+#define SPRITE_MAX                  64
+#endif
+
+/**
+ * @brief   Image of a sprite
+ */
+typedef struct {
+    const void     *pixels;                 ///< first pixel
+    uint16_t        width;
+    uint16_t        height;
+    uint16_t        pitch;                  ///< bytes between lines
+    uint8_t         format;                 ///< DMA2D_ARGB8888, ARGB4444 or ARGB1555
+} SPRITE_Image;
+
+/**
+ * @brief   Statistics
+ */
+typedef struct {
+    uint32_t    frames;                     ///< calls to Sprite_Render
+    uint32_t    lastrects;                  ///< rectangles restored in the last frame
+    uint32_t    lastjobs;                   ///< DMA2D jobs of the last frame
+    uint32_t    lastpixels;                 ///< pixels restored in the last frame
+    uint32_t    batches;                    ///< batches submitted since Sprite_Init
+} SPRITE_Stats;
+
+int  Sprite_Init(int layer, const void *background);
+int  Sprite_Create(const SPRITE_Image *image, int x, int y, int depth);
+void Sprite_Destroy(int id);
+void Sprite_Move(int id, int x, int y);
+void Sprite_SetImage(int id, const SPRITE_Image *image);
+void Sprite_SetDepth(int id, int depth);
+void Sprite_SetAlpha(int id, unsigned alpha);
+void Sprite_Show(int id, int visible);
+int  Sprite_Render(void);
+void Sprite_GetStats(SPRITE_Stats *stats);
+
+#endif // SPRITE_H
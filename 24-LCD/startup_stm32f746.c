@@ -35,6 +35,9 @@ void _main(void)                          WEAK_ATTRIBUTE;
 /* inicializacao CMSIS  */
 void SystemInit(void)                     WEAK_ATTRIBUTE;
 
+/* inicializacao antes da copia de .data e .bss */
+void SystemEarlyInit(void)                WEAK_ATTRIBUTE;
+
 /* rotina de interrupcao default */
 void Default_Handler(void)                WEAK_ATTRIBUTE;
 
@@ -165,6 +168,15 @@ extern unsigned long _data_end;
 extern unsigned long _bss_start;
 extern unsigned long _bss_end;
 extern unsigned long _stack_start;
+extern unsigned long _data_load;
+extern unsigned long _itcm_start;
+extern unsigned long _itcm_end;
+extern unsigned long _itcm_load;
+extern unsigned long _dtcm_data_start;
+extern unsigned long _dtcm_data_end;
+extern unsigned long _dtcm_data_load;
+extern unsigned long _dtcm_bss_start;
+extern unsigned long _dtcm_bss_end;
 //extern unsigned long _stack_end;
 extern void(_stack_end)(void);
 
@@ -330,6 +342,69 @@ void SystemInit(void) {
 
 }
 
+/**
+ * @brief Core clock cycles from reset until main
+ *
+ * @note  It is measured with the DWT cycle counter
+ */
+uint32_t SystemBootCycles = 0;
+
+/**
+ * @brief Default SystemEarlyInit routine
+ *
+ * @note It can be redefined in other module (system_stm32f746.c)
+ *
+ * @note It runs before .data and .bss are initialized. It must not use variables
+ */
+
+void SystemEarlyInit(void) {
+
+}
+
+/**
+ * @brief Copy words from flash to RAM
+ *
+ * @note  Eight words per iteration, so the compiler can use LDM/STM
+ *
+ * @note  Sections are word aligned but their size can be not a multiple of 32 bytes
+ */
+
+static void __attribute__((noinline))
+copywords(unsigned long *pDest, unsigned long *pEnd, const unsigned long *pSource) {
+unsigned long w0,w1,w2,w3,w4,w5,w6,w7;
+
+    while( pDest+8 <= pEnd ) {
+        w0 = pSource[0]; w1 = pSource[1]; w2 = pSource[2]; w3 = pSource[3];
+        w4 = pSource[4]; w5 = pSource[5]; w6 = pSource[6]; w7 = pSource[7];
+        pDest[0] = w0; pDest[1] = w1; pDest[2] = w2; pDest[3] = w3;
+        pDest[4] = w4; pDest[5] = w5; pDest[6] = w6; pDest[7] = w7;
+        pDest   += 8;
+        pSource += 8;
+    }
+    while( pDest < pEnd ) {
+        *pDest++ = *pSource++;
+    }
+}
+
+/**
+ * @brief Zero words in RAM
+ *
+ * @note  Eight words per iteration, so the compiler can use STM
+ */
+
+static void __attribute__((noinline))
+zerowords(unsigned long *pDest, unsigned long *pEnd) {
+
+    while( pDest+8 <= pEnd ) {
+        pDest[0] = 0; pDest[1] = 0; pDest[2] = 0; pDest[3] = 0;
+        pDest[4] = 0; pDest[5] = 0; pDest[6] = 0; pDest[7] = 0;
+        pDest += 8;
+    }
+    while( pDest < pEnd ) {
+        *pDest++ = 0;
+    }
+}
+
 /**
  * @brief Default _main routine
  *
@@ -358,30 +433,46 @@ void _stop(void) {
 /**
  * @brief Reset Handler
  *
+ * @note Starts the cycle counter and calls SystemEarlyInit (caches, ART, HSE)
  * @note Copies initial values of variables from FLASH to RAM
- * @note Zeroes uninitialized variables
+ * @note Copies code and initialized data of ITCM and DTCM sections from FLASH
+ * @note Zeroes uninitialized variables (in RAM and DTCM)
  * @note Calls SystemInit
  * @note Calls _main
  * @note Call main
  * @note Call _stop if main returns
+ * @note Stores in SystemBootCycles the cycles used until main
  */
 
 void __attribute__((weak,naked)) Reset_Handler(void) {
-unsigned long *pSource;
-unsigned long *pDest;
+
+    /* Step 0 : Start cycle counter to measure boot time */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    /* Step 0a : Enable caches and ART and start HSE before the copies */
+    SystemEarlyInit();
 
     /* Step 1 : Copy  data to initialize variable in RAM from Flash */
-    pSource = &_text_end;
-    pDest   = &_data_start;
-    while( pDest < &_data_end ) {
-        *pDest++ = *pSource++;
-    }
+    copywords(&_data_start,&_data_end,&_data_load);
+
+    /* Step 1a : Copy code to ITCM RAM from Flash */
+    copywords(&_itcm_start,&_itcm_end,&_itcm_load);
+
+    /* Step 1b : Copy data to initialize variable in DTCM RAM from Flash */
+    copywords(&_dtcm_data_start,&_dtcm_data_end,&_dtcm_data_load);
 
     /* Step 2 : Zero variables in section BSS (non initialized data) */
-    pDest = &_bss_start;
-    while( pDest < &_bss_end ) {
-        *pDest++ = 0;
-    }
+    zerowords(&_bss_start,&_bss_end);
+
+    /* Step 2a : Zero variables in section DTCM BSS */
+    zerowords(&_dtcm_bss_start,&_dtcm_bss_end);
+
+    /* Code was written as data, so the instruction side must see it */
+    __DSB();
+    __ISB();
 
     /* Step 3 : Call SystemInit conforme CMSIS */
     SystemInit();
@@ -389,6 +480,8 @@ unsigned long *pDest;
     /* Step 4 : Call _main to initialize library */
     _main();
 
+    SystemBootCycles = DWT->CYCCNT;
+
     /* Step 5 : Call main */
     main();
 
@@ -50,6 +50,9 @@
 
 #include "syscalls.h"
 #include "ttyemul.h"
+#ifdef USE_LCDCONSOLE
+#include "console.h"
+#endif
 
 /// CMSIS functions for microcontroller
 #include "stm32f746xx.h"
@@ -324,5 +327,9 @@ int _wait(int *status) {
 
 int _write(int file, char *ptr, int len) {
 
+#ifdef USE_LCDCONSOLE
+    // Copy to the LCD console (ignored until Console_Init)
+    Console_Write(ptr,len);
+#endif
     return tty_write(0,ptr,len);
 }
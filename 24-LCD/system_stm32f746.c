@@ -193,7 +193,7 @@ static inline void LockFlashRegisters(void) {
 
 static void inline SetFlashWaitStates(int n) {
 
-    FLASH->ACR = (FLASH->CR&~FLASH_ACR_LATENCY)|((n)<<FLASH_ACR_LATENCY_Pos);
+    FLASH->ACR = (FLASH->ACR&~FLASH_ACR_LATENCY)|((n)<<FLASH_ACR_LATENCY_Pos);
 
 }
 
@@ -226,9 +226,9 @@ int i,j;
  *
  **/
 static void inline ConfigureFlashWaitStates(uint32_t freq, uint32_t voltage) {
-uint32_t ws;
+int ws;
 
-    ws = FindFlashWaitStates(freq,voltage);
+    ws = FindFlashWaitStates(freq/1000000,voltage);
 
     if( ws < 0 )
         return;
@@ -373,7 +373,7 @@ void SystemSetAPB2Prescaler(uint32_t div) {
 uint32_t ppre2;
 uint32_t p2;
 
-    if( SystemCoreClock/div > 54000000 )
+    if( SystemCoreClock/div > 108000000 )
         return;
         
     p2 = SystemFindLargestPower2Exp(div);
@@ -477,19 +477,19 @@ int  SystemGetPLLConfiguration(uint32_t whichone, PLLConfiguration_t *pllconfig)
     case PLL_MAIN:
         pllconfig->N = (RCC->PLLCFGR&RCC_PLLCFGR_PLLN_Msk)>>RCC_PLLCFGR_PLLN_Pos;
         pllconfig->P = (RCC->PLLCFGR&RCC_PLLCFGR_PLLP_Msk)>>RCC_PLLCFGR_PLLP_Pos;
-        pllconfig->Q = (RCC->PLLCFGR&RCC_PLLCFGR_PLLP_Msk)>>RCC_PLLCFGR_PLLQ_Pos;
+        pllconfig->Q = (RCC->PLLCFGR&RCC_PLLCFGR_PLLQ_Msk)>>RCC_PLLCFGR_PLLQ_Pos;
         pllconfig->R = 0;
         break;
     case PLL_SAI:
         pllconfig->N = (RCC->PLLSAICFGR&RCC_PLLSAICFGR_PLLSAIN_Msk)>>RCC_PLLSAICFGR_PLLSAIN_Pos;
         pllconfig->P = (RCC->PLLSAICFGR&RCC_PLLSAICFGR_PLLSAIP_Msk)>>RCC_PLLSAICFGR_PLLSAIP_Pos;
-        pllconfig->Q = (RCC->PLLSAICFGR&RCC_PLLSAICFGR_PLLSAIR_Msk)>>RCC_PLLSAICFGR_PLLSAIQ_Pos;
+        pllconfig->Q = (RCC->PLLSAICFGR&RCC_PLLSAICFGR_PLLSAIQ_Msk)>>RCC_PLLSAICFGR_PLLSAIQ_Pos;
         pllconfig->R = (RCC->PLLSAICFGR&RCC_PLLSAICFGR_PLLSAIR_Msk)>>RCC_PLLSAICFGR_PLLSAIR_Pos;
         break;
     case PLL_I2S:
         pllconfig->N = (RCC->PLLI2SCFGR&RCC_PLLI2SCFGR_PLLI2SN_Msk)>>RCC_PLLI2SCFGR_PLLI2SN_Pos;
         pllconfig->P = (RCC->PLLI2SCFGR&RCC_PLLI2SCFGR_PLLI2SP_Msk)>>RCC_PLLI2SCFGR_PLLI2SP_Pos;
-        pllconfig->Q = (RCC->PLLI2SCFGR&RCC_PLLI2SCFGR_PLLI2SR_Msk)>>RCC_PLLI2SCFGR_PLLI2SQ_Pos;
+        pllconfig->Q = (RCC->PLLI2SCFGR&RCC_PLLI2SCFGR_PLLI2SQ_Msk)>>RCC_PLLI2SCFGR_PLLI2SQ_Pos;
         pllconfig->R = (RCC->PLLI2SCFGR&RCC_PLLI2SCFGR_PLLI2SR_Msk)>>RCC_PLLI2SCFGR_PLLI2SR_Pos;
         break;
     }
@@ -581,7 +581,7 @@ PLLConfiguration_t pllconfig;
         pllconfig.source = pllsrc;
         pllconfig.M = (rcc_pllcfgr & RCC_PLLCFGR_PLLM)>>RCC_PLLCFGR_PLLM_Pos;
         pllconfig.N = (rcc_pllcfgr & RCC_PLLCFGR_PLLN)>>RCC_PLLCFGR_PLLN_Pos;
-        pllconfig.P = (rcc_pllcfgr & RCC_PLLCFGR_PLLP)>>RCC_PLLCFGR_PLLP_Pos;
+        pllconfig.P = ((rcc_pllcfgr & RCC_PLLCFGR_PLLP)>>RCC_PLLCFGR_PLLP_Pos)*2+2;
         sysclk_freq = CalculateMainPLLOutFrequency(&pllconfig);
       break;
     }
@@ -701,17 +701,18 @@ uint32_t k;
 }
 
 /**
- * @brief   SystemConfigMainPLL
+ * @brief   ConfigMainPLL
  *
- * @note    Configure Main PLL unit
+ * @note    Configure Main PLL unit and enable it
  *
- * @note    If core clock source (HCLK) is PLL, it is changed to HSI
+ * @note    If core clock source (HCLK) is PLL, it is changed to HSI and back.
+ *          In this case, it always waits for the lock
  *
- * @note    It does not switch the core clock source (HCLK) to PLL
+ * @note    When wait is zero, it returns without waiting for the PLL lock
  */
 
-void
-SystemConfigMainPLL(const PLLConfiguration_t *pllconfig) {
+static void
+ConfigMainPLL(const PLLConfiguration_t *pllconfig, int wait) {
 uint32_t freq,src;
 uint32_t rcc_pllcfgr;
 uint32_t clocksource;
@@ -722,7 +723,7 @@ int      pllwascoreclock = 0;
     // If core clock source is PLL change it to HSI
     if( (RCC->CFGR&RCC_CFGR_SWS) == RCC_CFGR_SWS_PLL ) {
         SystemEnableHSI();
-        RCC->CFGR = (RCC->CFGR&RCC_CFGR_SW)|RCC_CFGR_SW_HSI;
+        RCC->CFGR = (RCC->CFGR&~RCC_CFGR_SW)|RCC_CFGR_SW_HSI;
         pllwascoreclock = 1;
     }
     // Disable Main PLL
@@ -757,24 +758,60 @@ int      pllwascoreclock = 0;
                  (
                    ((pllconfig->M<<RCC_PLLCFGR_PLLM_Pos)&RCC_PLLCFGR_PLLM)
                   |((pllconfig->N<<RCC_PLLCFGR_PLLN_Pos)&RCC_PLLCFGR_PLLN)
-                  |((pllconfig->P<<RCC_PLLCFGR_PLLP_Pos)&RCC_PLLCFGR_PLLP)
+                  |(((pllconfig->P/2-1)<<RCC_PLLCFGR_PLLP_Pos)&RCC_PLLCFGR_PLLP)
                   |((pllconfig->Q<<RCC_PLLCFGR_PLLQ_Pos)&RCC_PLLCFGR_PLLQ)
                   |((src<<RCC_PLLCFGR_PLLSRC_Pos)&RCC_PLLCFGR_PLLSRC)
                  );
 
     RCC->PLLCFGR = rcc_pllcfgr;
 
-    SystemEnableMainPLL();
+    if( wait || pllwascoreclock ) {
+        SystemEnableMainPLL();
+    } else {
+        RCC->CR |= RCC_CR_PLLON;
+    }
 
     MainPLLConfigured = 1;
 
     /* If it was the core clock, change back */
     if( pllwascoreclock ) {
-        RCC->CFGR = (RCC->CFGR&RCC_CFGR_SW)|RCC_CFGR_SW_PLL;
+        RCC->CFGR = (RCC->CFGR&~RCC_CFGR_SW)|RCC_CFGR_SW_PLL;
     }
    SystemCoreClockUpdate();
 }
 
+/**
+ * @brief   SystemConfigMainPLL
+ *
+ * @note    Configure Main PLL unit
+ *
+ * @note    If core clock source (HCLK) is PLL, it is changed to HSI
+ *
+ * @note    It does not switch the core clock source (HCLK) to PLL
+ */
+
+void
+SystemConfigMainPLL(const PLLConfiguration_t *pllconfig) {
+
+    ConfigMainPLL(pllconfig,1);
+}
+
+/**
+ * @brief   SystemStartMainPLL
+ *
+ * @note    Configure Main PLL unit like SystemConfigMainPLL but does not wait
+ *          for the lock. It can be used to overlap the lock time with other
+ *          initialization
+ *
+ * @note    SystemSetCoreClock waits for the lock before switching to PLL
+ */
+
+void
+SystemStartMainPLL(const PLLConfiguration_t *pllconfig) {
+
+    ConfigMainPLL(pllconfig,0);
+}
+
 /**
  * @brief   SystemConfigPLLSAI
  *
@@ -807,7 +844,7 @@ uint32_t clocksource;
 
     rcc_pllsaicfgr |= (
                         ((pllconfig->N<<RCC_PLLSAICFGR_PLLSAIN_Pos)&RCC_PLLSAICFGR_PLLSAIN)
-                       |((pllconfig->P<<RCC_PLLSAICFGR_PLLSAIP_Pos)&RCC_PLLSAICFGR_PLLSAIP)
+                       |(((pllconfig->P/2-1)<<RCC_PLLSAICFGR_PLLSAIP_Pos)&RCC_PLLSAICFGR_PLLSAIP)
                        |((pllconfig->Q<<RCC_PLLSAICFGR_PLLSAIQ_Pos)&RCC_PLLSAICFGR_PLLSAIQ)
                        |((pllconfig->R<<RCC_PLLSAICFGR_PLLSAIR_Pos)&RCC_PLLSAICFGR_PLLSAIR)
                       );
@@ -853,7 +890,7 @@ uint32_t clocksource;
 
     rcc_plli2scfgr |= (
                         ((pllconfig->N<<RCC_PLLI2SCFGR_PLLI2SN_Pos)&RCC_PLLI2SCFGR_PLLI2SN)
-                       |((pllconfig->P<<RCC_PLLI2SCFGR_PLLI2SP_Pos)&RCC_PLLI2SCFGR_PLLI2SP)
+                       |(((pllconfig->P/2-1)<<RCC_PLLI2SCFGR_PLLI2SP_Pos)&RCC_PLLI2SCFGR_PLLI2SP)
                        |((pllconfig->Q<<RCC_PLLI2SCFGR_PLLI2SQ_Pos)&RCC_PLLI2SCFGR_PLLI2SQ)
                        |((pllconfig->R<<RCC_PLLI2SCFGR_PLLI2SR_Pos)&RCC_PLLI2SCFGR_PLLI2SR)
                       );
@@ -949,6 +986,8 @@ uint32_t ppre2;
                 SystemSetAPB2Prescaler(2);                  // Safe
                 SystemConfigMainPLL(&ClockConfiguration200MHz);
             }
+            // It can be still locking when started by SystemStartMainPLL
+            while( (RCC->CR&RCC_CR_PLLRDY)!=RCC_CR_PLLRDY ) {}
             RCC->CFGR = (RCC->CFGR&~RCC_CFGR_SW)|RCC_CFGR_SW_PLL;
             __DSB();
             __ISB();
@@ -980,7 +1019,7 @@ PLLConfiguration_t clockconf;
     }
     clockconf.source = CLOCKSRC_HSE;     /* Clock source   */
     clockconf.M = HSE_FREQ/1000000;      /* f_IN = 1 MHz   */
-    clockconf.N = 2*freq;                /* f_PLL = 400 MHz*/
+    clockconf.N = 2*(freq/1000000);      /* f_PLL = 400 MHz*/
     clockconf.P = 2;                     /* f_OUT = 200 MHz*/
     clockconf.Q = 2;                     /* Not used */
     clockconf.R = 2;                     /* Not used */
@@ -1095,17 +1134,24 @@ SystemCoreClockUpdate(void) {
 
 
 /**
- * @brief SystemInit
+ * @brief SystemEarlyInit
  *
- * @note  Resets to default configuration for clock and disables all interrupts
+ * @note  Enables FPU, ART accelerator and caches and starts the HSE oscillator
+ *        without waiting for it
  *
- * @note  It is part of CMSIS
+ * @note  It is called by Reset_Handler before .data and .bss are initialized,
+ *        so it must not use any variable
  *
- * @note  Replaces the one (dummy) contained in start_DEVICE.c
+ * @note  It can be called again. Caches and ART are not invalidated when already
+ *        enabled, since the D-cache can hold dirty lines of .data and .bss
+ *
+ * @note  Flash wait states are not changed. The core runs on HSI (16 MHz) here
+ *        and it needs none. SystemSetCoreClock changes them before raising
+ *        the frequency
  */
 
 void
-SystemInit(void) {
+SystemEarlyInit(void) {
 
     /* Configure FPU when FPU_USED=1 as defined in core_cm7.h */
 #if __FPU_USED == 1U
@@ -1116,8 +1162,51 @@ SystemInit(void) {
         __ISB();
     #endif
 #endif
-    /* Reset HSEON, CSSON and PLLON bits */
-    RCC->CR = 0x00000083;
+
+    /* Start HSE. Its start up time overlaps the initialization of memory */
+#ifdef HSE_EXTERNAL_OSCILLATOR
+    RCC->CR |= RCC_CR_HSEON|RCC_CR_HSEBYP;
+#else
+    RCC->CR |= RCC_CR_HSEON;
+#endif
+
+    /* Enable ART (ST technology). Only for TCM interface  */
+    if( (FLASH->ACR&FLASH_ACR_ARTEN) == 0 ) {
+        FLASH->ACR |= FLASH_ACR_ARTRST;         /* Reset ART */
+        FLASH->ACR &= ~FLASH_ACR_ARTRST;
+        FLASH->ACR |= FLASH_ACR_ARTEN;          /* Enable ART */
+        FLASH->ACR |= FLASH_ACR_PRFTEN;         /* Enable ART Prefetch*/
+    }
+
+    /* Enable cache for Instruction and Data . Only for AXIM interface */
+    if( (SCB->CCR&SCB_CCR_IC_Msk) == 0 )
+        SCB_EnableICache();
+    if( (SCB->CCR&SCB_CCR_DC_Msk) == 0 )
+        SCB_EnableDCache();
+
+}
+
+/**
+ * @brief SystemInit
+ *
+ * @note  Resets to default configuration for clock and disables all interrupts
+ *
+ * @note  It starts the Main PLL with the 200 MHz configuration but does not wait
+ *        for its lock. SystemSetCoreClock waits for it when switching to PLL
+ *
+ * @note  It is part of CMSIS
+ *
+ * @note  Replaces the one (dummy) contained in start_DEVICE.c
+ */
+
+void
+SystemInit(void) {
+
+    /* FPU, ART and caches. Nothing is done when already called by Reset_Handler */
+    SystemEarlyInit();
+
+    /* Reset CSSON and PLLON bits. HSE is kept when started by SystemEarlyInit */
+    RCC->CR = 0x00000083|(RCC->CR&(RCC_CR_HSEON|RCC_CR_HSEBYP));
 
     /* Reset CFGR register */
     RCC->CFGR = 0x00000000;
@@ -1136,22 +1225,12 @@ SystemInit(void) {
     SystemSetAHBPrescaler(1);
     SystemSetAPB1Prescaler(4);          // Safe
     SystemSetAPB2Prescaler(2);          // Safe
-            
-    /* Update SystemCoreClock */
-    SystemCoreClockUpdate();
 
+    /* Start Main PLL. It locks while library and application initialize */
+    SystemStartMainPLL(&ClockConfiguration200MHz);
 
-    /* Enable cache for Instruction and Data . Only for AXIM interface */
-    SCB_EnableICache();
-    SCB_EnableDCache();
-
-    /* Enable ART (ST technology). Only for TCM interface  */
-    FLASH->ACR &= ~FLASH_ACR_ARTEN;         /* Disable ART */
-    FLASH->ACR |= FLASH_ACR_ARTRST;         /* Reset ART */
-    //FLASH->ACR &= ~FLASH_ACR_ARTRST;      /* Reset ART */
-
-    FLASH->ACR |= FLASH_ACR_ARTEN;          /* Enable ART */
-    FLASH->ACR |= FLASH_ACR_PRFTEN;         /* Enable ART Prefetch*/
+    /* Update SystemCoreClock */
+    SystemCoreClockUpdate();
 
     /* It is possible to relocate Vector Table Must be a 512 byte boundary. Bits 8:0 = 0 */
     //SCB->VTOR = FLASH_BASE;                 /* Vector Table Relocation in Internal FLASH */
@@ -50,6 +50,21 @@ uint32_t SystemCoreClockGet(void);
  */
 void SystemInit(void);
 
+/**
+ * @brief   SystemEarlyInit
+ * @note    Enables FPU, ART and caches and starts HSE
+ * @note    Called by Reset_Handler before initialization of .data and .bss
+ * @note    It is not a CMSIS function
+ */
+void SystemEarlyInit(void);
+
+/**
+ * @brief   SystemBootCycles
+ * @note    Core clock cycles from reset until main is called
+ * @note    Set by Reset_Handler. Boot runs on HSI (16 MHz)
+ */
+extern uint32_t SystemBootCycles;
+
 
 //------8<-------8<-------8<-------8<-------8<-------8<-------8<-------8<-------8<-------8<-------
 /**
@@ -229,6 +244,7 @@ uint32_t SystemFindLargestPower2Exp(uint32_t divisor);
 
 
 void SystemConfigMainPLL(const PLLConfiguration_t *pllconfig);
+void SystemStartMainPLL(const PLLConfiguration_t *pllconfig);
 void SystemConfigPLLSAI(const PLLConfiguration_t *pllconfig);
 void SystemConfigPLLI2S(const PLLConfiguration_t *pllconfig);
 int  SystemGetPLLConfiguration(uint32_t whichone, PLLConfiguration_t *pllconfig);
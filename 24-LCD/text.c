@@ -0,0 +1,422 @@
+/**
+ * @file    text.c
+ *
+ * @note    Text rendering with a glyph cache and DMA2D
+ *
+ * @note    Each font has an atlas in SDRAM (buddy allocator) with TEXT_CACHESLOTS
+ *          cells of cellwidth x cellheight bytes (A8). A glyph is rendered into a
+ *          free cell, or into the least recently used one, when it is not found.
+ *
+ * @note    Glyphs are scaled from the bitmap font with 4x4 supersampling, so the
+ *          edges are anti-aliased when the height is not a multiple of the
+ *          bitmap height.
+ *
+ * @note    A string is drawn as one DMA2D job per glyph, memory to memory with
+ *          blending: foreground is the A8 cell with the color in FGCOLR and
+ *          background and output are the layer. The jobs are queued, so the CPU
+ *          can continue. Layers in L8, AL44 and AL88 are not supported, since the
+ *          DMA2D can not write them.
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "lcd.h"
+#include "dma2d.h"
+#include "buddy.h"
+#include "text.h"
+
+/**
+ * @brief   Maximal number of fonts
+ */
+#define MAXFONTS            4
+
+/**
+ * @brief   Supersampling factor in each direction
+ */
+#define SS                  4
+
+/**
+ * @brief   Font
+ */
+typedef struct textfont_s {
+    const TEXT_Bitmap   *bitmap;                    /// source
+    int                 cellwidth;                  /// glyph size in pixels
+    int                 cellheight;
+    uint8_t             *atlas;                     /// TEXT_CACHESLOTS cells
+    int16_t             code[TEXT_CACHESLOTS];      /// glyph in cell (-1=free)
+    uint32_t            lastuse[TEXT_CACHESLOTS];   /// for LRU replacement
+    int8_t              slot[256];                  /// cell of a code (-1=none)
+    uint32_t            clock;                      /// use counter
+    unsigned            hits;
+    unsigned            misses;
+    unsigned            evictions;
+} TEXTFONT_t;
+
+/**
+ * @brief   Font area
+ */
+///@{
+static TEXTFONT_t   fontarea[MAXFONTS];
+static int          fontcount = 0;
+///@}
+
+/**
+ * @brief   renderglyph
+ *
+ * @note    Scales glyph c of the bitmap into cell. The source cell has one
+ *          empty column and row for the spacing
+ */
+static void
+renderglyph(TEXTFONT font, int c, uint8_t *cell) {
+const TEXT_Bitmap *bm = font->bitmap;
+const uint8_t *cols;
+int srcw,srch,w,h;
+int ox,oy,i,j,sx,sy,n;
+
+    srcw = bm->width+1;
+    srch = bm->height+1;
+    w    = font->cellwidth;
+    h    = font->cellheight;
+    cols = bm->columns+(c-bm->first)*bm->width;
+
+    for(oy=0;oy<h;oy++) {
+        for(ox=0;ox<w;ox++) {
+            n = 0;
+            for(j=0;j<SS;j++) {
+                sy = ((oy*SS+j)*2+1)*srch/(h*SS*2);
+                if( sy >= bm->height )
+                    continue;
+                for(i=0;i<SS;i++) {
+                    sx = ((ox*SS+i)*2+1)*srcw/(w*SS*2);
+                    if( sx < bm->width && (cols[sx]&(1<<sy)) )
+                        n++;
+                }
+            }
+            *cell++ = (n*255)/(SS*SS);
+        }
+    }
+}
+
+/**
+ * @brief   getglyph
+ *
+ * @note    Returns the cell with glyph c, rendering it when needed. Returns
+ *          0 when the font has no glyph for c
+ */
+static uint8_t *
+getglyph(TEXTFONT font, int c) {
+const TEXT_Bitmap *bm = font->bitmap;
+int k,i;
+uint32_t oldest;
+
+    if( c < bm->first || c >= bm->first+bm->count )
+        return 0;
+
+    font->clock++;
+    k = font->slot[c];
+    if( k >= 0 ) {
+        font->hits++;
+        font->lastuse[k] = font->clock;
+        return font->atlas+k*font->cellwidth*font->cellheight;
+    }
+
+    // Free cell or the least recently used one
+    k = 0;
+    oldest = 0xFFFFFFFF;
+    for(i=0;i<TEXT_CACHESLOTS;i++) {
+        if( font->code[i] < 0 ) {
+            k = i;
+            break;
+        }
+        if( font->lastuse[i] < oldest ) {
+            oldest = font->lastuse[i];
+            k = i;
+        }
+    }
+    if( font->code[k] >= 0 ) {
+        font->slot[font->code[k]] = -1;
+        font->evictions++;
+    }
+
+    // The cell can be in use by a queued job
+    while( !DMA2D_IsIdle() ) {}
+
+    renderglyph(font,c,font->atlas+k*font->cellwidth*font->cellheight);
+    font->code[k]    = c;
+    font->lastuse[k] = font->clock;
+    font->slot[c]    = k;
+    font->misses++;
+    return font->atlas+k*font->cellwidth*font->cellheight;
+}
+
+/**
+ * @brief   Text_CreateFont
+ *
+ * @note    Creates a font with glyphs of the given height in pixels from a bitmap
+ *          font. The width keeps the proportion of the bitmap
+ *
+ * @note    Returns 0 when there are no more fonts or no memory for the atlas
+ */
+TEXTFONT
+Text_CreateFont(const TEXT_Bitmap *bitmap, int height) {
+TEXTFONT font;
+int i;
+
+    if( fontcount >= MAXFONTS || bitmap->height > 8 || height <= 0 )
+        return 0;
+
+    font = &fontarea[fontcount];
+    font->bitmap     = bitmap;
+    font->cellheight = height;
+    font->cellwidth  = (height*(bitmap->width+1)+(bitmap->height+1)/2)/(bitmap->height+1);
+    font->atlas      = Buddy_Alloc(TEXT_CACHESLOTS*font->cellwidth*font->cellheight);
+    if( font->atlas == 0 )
+        return 0;
+    for(i=0;i<TEXT_CACHESLOTS;i++) {
+        font->code[i]    = -1;
+        font->lastuse[i] = 0;
+    }
+    for(i=0;i<256;i++)
+        font->slot[i] = -1;
+    font->clock      = 0;
+    font->hits       = 0;
+    font->misses     = 0;
+    font->evictions  = 0;
+    fontcount++;
+    return font;
+}
+
+/**
+ * @brief   Text_Preload
+ *
+ * @note    Renders the glyphs of s, so the first Text_Draw does not need to.
+ *          Returns the number of glyphs in the atlas
+ */
+int
+Text_Preload(TEXTFONT font, const char *s) {
+int i,n = 0;
+
+    while( *s )
+        getglyph(font,(unsigned char) *s++);
+    for(i=0;i<TEXT_CACHESLOTS;i++) {
+        if( font->code[i] >= 0 )
+            n++;
+    }
+    return n;
+}
+
+/**
+ * @brief   Text_GetWidth
+ *
+ * @note    Returns the width of s in pixels
+ */
+int
+Text_GetWidth(TEXTFONT font, const char *s) {
+int n = 0;
+
+    while( s[n] )
+        n++;
+    return n*font->cellwidth;
+}
+
+/**
+ * @brief   Text_DrawInBuffer
+ *
+ * @note    Draws s with the top left corner at (x,y) in color (RGB888) into a
+ *          buffer of lw x lh pixels that is not (or not all) scanned by a layer,
+ *          like the scroll buffer of console.c. The string is clipped to the
+ *          buffer. No damage is added
+ *
+ * @note    Returns the width drawn or -1 when the format is not supported
+ */
+int
+Text_DrawInBuffer(void *base, int format, int pitch, int lw, int lh,
+                  TEXTFONT font, int x, int y, const char *s, unsigned color) {
+int cw,ch;
+int x0,cx,cy,w,h;
+uint8_t *cell;
+DMA2D_Fence f;
+
+    if( format > LCD_FORMAT_ARGB4444 )
+        return -1;
+
+    cw    = font->cellwidth;
+    ch    = font->cellheight;
+
+    // Vertical clipping is the same for all glyphs
+    cy = y < 0 ? -y : 0;
+    h  = (y+ch > lh ? lh-y : ch)-cy;
+    if( h <= 0 )
+        return 0;
+
+    DMA2D_SetForegroundColor(color);
+
+    x0 = x;
+    for(;*s;s++,x+=cw) {
+        if( x >= lw )
+            break;
+        if( x+cw <= 0 )
+            continue;
+        cell = getglyph(font,(unsigned char) *s);
+        if( cell == 0 )
+            continue;
+        cx = x < 0 ? -x : 0;
+        w  = (x+cw > lw ? lw-x : cw)-cx;
+        {
+        DECLARE_REGION(fg,cell,cx,cy,w,h,DMA2D_A8,cw);
+        DECLARE_REGION(bg,base,x+cx,y+cy,w,h,format,pitch);
+        // Wait for a free entry when the queue is full
+        while( (f=DMA2D_SubmitBlend(&fg,&bg,&bg,255,0,0)) == 0 ) {
+            if( DMA2D_IsIdle() )
+                return -1;
+        }
+        }
+    }
+    return x-x0;
+}
+
+/**
+ * @brief   Text_Draw
+ *
+ * @note    Draws s with the top left corner at (x,y) in color (RGB888). The
+ *          string is clipped to the layer
+ *
+ * @note    Returns the width drawn or -1 when the layer format is not supported
+ */
+int
+Text_Draw(int layer, TEXTFONT font, int x, int y, const char *s, unsigned color) {
+int lw,lh,w,cx,cy,h;
+
+    lw = LCD_GetWidth(layer);
+    lh = LCD_GetHeight(layer);
+    w  = Text_DrawInBuffer(LCD_GetLineAddress(layer,0),LCD_GetFormat(layer),
+                           LCD_GetPitch(layer),lw,lh,font,x,y,s,color);
+    if( w > 0 ) {
+        cx = x < 0 ? 0 : x;
+        cy = y < 0 ? 0 : y;
+        h  = (y+font->cellheight > lh ? lh : y+font->cellheight)-cy;
+        LCD_AddDamage(layer,cx,cy,(x+w > lw ? lw : x+w)-cx,h);
+    }
+    return w;
+}
+
+/**
+ * @brief   Text_GetStats
+ */
+void
+Text_GetStats(TEXTFONT font, TEXT_Stats *stats) {
+
+    stats->cellwidth  = font->cellwidth;
+    stats->cellheight = font->cellheight;
+    stats->hits       = font->hits;
+    stats->misses     = font->misses;
+    stats->evictions  = font->evictions;
+}
+
+/**
+ * @brief   5x7 font for codes 0x20 to 0x7E
+ *
+ * @note    One byte per column, top pixel in bit 0
+ */
+static const uint8_t font5x7columns[] = {
+    0x00,0x00,0x00,0x00,0x00,   // ' '
+    0x00,0x00,0x5F,0x00,0x00,   // '!'
+    0x00,0x07,0x00,0x07,0x00,   // '"'
+    0x14,0x7F,0x14,0x7F,0x14,   // '#'
+    0x24,0x2A,0x7F,0x2A,0x12,   // '$'
+    0x23,0x13,0x08,0x64,0x62,   // '%'
+    0x36,0x49,0x55,0x22,0x50,   // '&'
+    0x00,0x05,0x03,0x00,0x00,   // '''
+    0x00,0x1C,0x22,0x41,0x00,   // '('
+    0x00,0x41,0x22,0x1C,0x00,   // ')'
+    0x08,0x2A,0x1C,0x2A,0x08,   // '*'
+    0x08,0x08,0x3E,0x08,0x08,   // '+'
+    0x00,0x50,0x30,0x00,0x00,   // ','
+    0x08,0x08,0x08,0x08,0x08,   // '-'
+    0x00,0x60,0x60,0x00,0x00,   // '.'
+    0x20,0x10,0x08,0x04,0x02,   // '/'
+    0x3E,0x51,0x49,0x45,0x3E,   // '0'
+    0x00,0x42,0x7F,0x40,0x00,   // '1'
+    0x42,0x61,0x51,0x49,0x46,   // '2'
+    0x21,0x41,0x45,0x4B,0x31,   // '3'
+    0x18,0x14,0x12,0x7F,0x10,   // '4'
+    0x27,0x45,0x45,0x45,0x39,   // '5'
+    0x3C,0x4A,0x49,0x49,0x30,   // '6'
+    0x01,0x71,0x09,0x05,0x03,   // '7'
+    0x36,0x49,0x49,0x49,0x36,   // '8'
+    0x06,0x49,0x49,0x29,0x1E,   // '9'
+    0x00,0x36,0x36,0x00,0x00,   // ':'
+    0x00,0x56,0x36,0x00,0x00,   // ';'
+    0x08,0x14,0x22,0x41,0x00,   // '<'
+    0x14,0x14,0x14,0x14,0x14,   // '='
+    0x00,0x41,0x22,0x14,0x08,   // '>'
+    0x02,0x01,0x51,0x09,0x06,   // '?'
+    0x32,0x49,0x79,0x41,0x3E,   // '@'
+    0x7E,0x11,0x11,0x11,0x7E,   // 'A'
+    0x7F,0x49,0x49,0x49,0x36,   // 'B'
+    0x3E,0x41,0x41,0x41,0x22,   // 'C'
+    0x7F,0x41,0x41,0x22,0x1C,   // 'D'
+    0x7F,0x49,0x49,0x49,0x41,   // 'E'
+    0x7F,0x09,0x09,0x09,0x01,   // 'F'
+    0x3E,0x41,0x49,0x49,0x7A,   // 'G'
+    0x7F,0x08,0x08,0x08,0x7F,   // 'H'
+    0x00,0x41,0x7F,0x41,0x00,   // 'I'
+    0x20,0x40,0x41,0x3F,0x01,   // 'J'
+    0x7F,0x08,0x14,0x22,0x41,   // 'K'
+    0x7F,0x40,0x40,0x40,0x40,   // 'L'
+    0x7F,0x02,0x0C,0x02,0x7F,   // 'M'
+    0x7F,0x04,0x08,0x10,0x7F,   // 'N'
+    0x3E,0x41,0x41,0x41,0x3E,   // 'O'
+    0x7F,0x09,0x09,0x09,0x06,   // 'P'
+    0x3E,0x41,0x51,0x21,0x5E,   // 'Q'
+    0x7F,0x09,0x19,0x29,0x46,   // 'R'
+    0x46,0x49,0x49,0x49,0x31,   // 'S'
+    0x01,0x01,0x7F,0x01,0x01,   // 'T'
+    0x3F,0x40,0x40,0x40,0x3F,   // 'U'
+    0x1F,0x20,0x40,0x20,0x1F,   // 'V'
+    0x3F,0x40,0x38,0x40,0x3F,   // 'W'
+    0x63,0x14,0x08,0x14,0x63,   // 'X'
+    0x07,0x08,0x70,0x08,0x07,   // 'Y'
+    0x61,0x51,0x49,0x45,0x43,   // 'Z'
+    0x00,0x7F,0x41,0x41,0x00,   // '['
+    0x02,0x04,0x08,0x10,0x20,   // '\'
+    0x00,0x41,0x41,0x7F,0x00,   // ']'
+    0x04,0x02,0x01,0x02,0x04,   // '^'
+    0x40,0x40,0x40,0x40,0x40,   // '_'
+    0x00,0x01,0x02,0x04,0x00,   // '`'
+    0x20,0x54,0x54,0x54,0x78,   // 'a'
+    0x7F,0x48,0x44,0x44,0x38,   // 'b'
+    0x38,0x44,0x44,0x44,0x20,   // 'c'
+    0x38,0x44,0x44,0x48,0x7F,   // 'd'
+    0x38,0x54,0x54,0x54,0x18,   // 'e'
+    0x08,0x7E,0x09,0x01,0x02,   // 'f'
+    0x0C,0x52,0x52,0x52,0x3E,   // 'g'
+    0x7F,0x08,0x04,0x04,0x78,   // 'h'
+    0x00,0x44,0x7D,0x40,0x00,   // 'i'
+    0x20,0x40,0x44,0x3D,0x00,   // 'j'
+    0x7F,0x10,0x28,0x44,0x00,   // 'k'
+    0x00,0x41,0x7F,0x40,0x00,   // 'l'
+    0x7C,0x04,0x18,0x04,0x78,   // 'm'
+    0x7C,0x08,0x04,0x04,0x78,   // 'n'
+    0x38,0x44,0x44,0x44,0x38,   // 'o'
+    0x7C,0x14,0x14,0x14,0x08,   // 'p'
+    0x08,0x14,0x14,0x18,0x7C,   // 'q'
+    0x7C,0x08,0x04,0x04,0x08,   // 'r'
+    0x48,0x54,0x54,0x54,0x20,   // 's'
+    0x04,0x3F,0x44,0x40,0x20,   // 't'
+    0x3C,0x40,0x40,0x20,0x7C,   // 'u'
+    0x1C,0x20,0x40,0x20,0x1C,   // 'v'
+    0x3C,0x40,0x30,0x40,0x3C,   // 'w'
+    0x44,0x28,0x10,0x28,0x44,   // 'x'
+    0x0C,0x50,0x50,0x50,0x3C,   // 'y'
+    0x44,0x64,0x54,0x4C,0x44,   // 'z'
+    0x00,0x08,0x36,0x41,0x00,   // '{'
+    0x00,0x00,0x7F,0x00,0x00,   // '|'
+    0x00,0x41,0x36,0x08,0x00,   // '}'
+    0x08,0x04,0x08,0x10,0x08,   // '~'
+};
+
+const TEXT_Bitmap Text_Font5x7 = { 5, 7, 0x20, 95, font5x7columns };
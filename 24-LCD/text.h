@@ -0,0 +1,66 @@
+#ifndef TEXT_H
+#define TEXT_H
+/**
+ * @file    text.h
+ *
+ * @note    Text rendering with a glyph cache and DMA2D
+ *
+ * @note    A font is created from a bitmap font for a given height. Glyphs are
+ *          rendered (anti-aliased, A8) on first use into an atlas in SDRAM and
+ *          blended into the layer by DMA2D with the color in the foreground
+ *          color register
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Bitmap font used as source
+ *
+ * @note    Each glyph has width columns. Each column is a byte with the top
+ *          pixel in bit 0 (height <= 8), like the HD44780 5x7 fonts
+ */
+typedef struct {
+    uint8_t         width;                  ///< columns of a glyph
+    uint8_t         height;                 ///< rows of a glyph (<= 8)
+    uint8_t         first;                  ///< code of first glyph
+    uint8_t         count;                  ///< number of glyphs
+    const uint8_t   *columns;               ///< width bytes for each glyph
+} TEXT_Bitmap;
+
+extern const TEXT_Bitmap Text_Font5x7;
+
+/**
+ * @brief   Handle for a font
+ */
+typedef struct textfont_s *TEXTFONT;
+
+/**
+ * @brief   Number of glyphs kept in the atlas of each font
+ */
+#ifndef TEXT_CACHESLOTS
+#define TEXT_CACHESLOTS     64
+#endif
+
+/**
+ * @brief   Statistics of the glyph cache
+ */
+typedef struct {
+    unsigned    cellwidth;                  ///< width of a glyph in pixels
+    unsigned    cellheight;                 ///< height of a glyph in pixels
+    unsigned    hits;                       ///< glyphs found in the atlas
+    unsigned    misses;                     ///< glyphs rendered
+    unsigned    evictions;                  ///< glyphs replaced in the atlas
+} TEXT_Stats;
+
+TEXTFONT Text_CreateFont(const TEXT_Bitmap *bitmap, int height);
+int      Text_Preload(TEXTFONT font, const char *s);
+int      Text_GetWidth(TEXTFONT font, const char *s);
+int      Text_Draw(int layer, TEXTFONT font, int x, int y, const char *s, unsigned color);
+int      Text_DrawInBuffer(void *base, int format, int pitch, int lw, int lh,
+                           TEXTFONT font, int x, int y, const char *s, unsigned color);
+void     Text_GetStats(TEXTFONT font, TEXT_Stats *stats);
+
+#endif // TEXT_H
@@ -0,0 +1,283 @@
+/**
+ * @file    imgconv.c
+ *
+ * @note    Converts a PPM (P6) or PAM (P7, RGB_ALPHA) image into a C file with
+ *          an IMAGE_Asset (see image.h)
+ *
+ * @note    Host program. Built with make imgconv. Usage
+ *
+ *          imgconv [-f format] [-r] [-n name] image.ppm > name.c
+ *
+ *          format is argb8888, rgb888, rgb565 (default), argb1555 or argb4444.
+ *          -r generates a raw (not compressed) image
+ *
+ * @note    Other formats can be converted to PPM/PAM with netpbm or ImageMagick
+ *          (convert logo.png logo.pam)
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/**
+ * @brief   Output formats. Codes are the LCD_FORMAT_* codes
+ */
+static const struct {
+    const char  *name;
+    const char  *macro;
+    int         ps;
+} formats[] = {
+    { "argb8888",   "LCD_FORMAT_ARGB8888",  4 },
+    { "rgb888",     "LCD_FORMAT_RGB888",    3 },
+    { "rgb565",     "LCD_FORMAT_RGB565",    2 },
+    { "argb1555",   "LCD_FORMAT_ARGB1555",  2 },
+    { "argb4444",   "LCD_FORMAT_ARGB4444",  2 },
+};
+#define NFORMATS ((int)(sizeof(formats)/sizeof(formats[0])))
+
+/**
+ * @brief   Input image (RGBA, 4 bytes per pixel)
+ */
+static int      width, height;
+static uint8_t  *rgba;
+
+/**
+ * @brief   readtoken
+ *
+ * @note    Reads a header token, skipping blanks and comments
+ */
+static int
+readtoken(FILE *f, char *tok, int size) {
+int c,n = 0;
+
+    for(;;) {
+        c = fgetc(f);
+        if( c == '#' ) {
+            while( c != '\n' && c != EOF )
+                c = fgetc(f);
+        }
+        if( c == EOF )
+            return -1;
+        if( c != ' ' && c != '\t' && c != '\n' && c != '\r' )
+            break;
+    }
+    while( c != EOF && c != ' ' && c != '\t' && c != '\n' && c != '\r' ) {
+        if( n < size-1 )
+            tok[n++] = c;
+        c = fgetc(f);
+    }
+    tok[n] = 0;
+    return n;
+}
+
+/**
+ * @brief   readimage
+ *
+ * @note    Reads a binary PPM (P6) or PAM (P7) with maxval 255
+ */
+static int
+readimage(const char *fn) {
+FILE *f;
+char tok[32];
+int maxval = 255, depth = 3;
+int i,n,c;
+
+    f = fopen(fn,"rb");
+    if( !f )
+        return -1;
+    if( readtoken(f,tok,sizeof(tok)) < 0 )
+        goto error;
+    if( strcmp(tok,"P6") == 0 ) {
+        if( readtoken(f,tok,sizeof(tok)) < 0 ) goto error;
+        width = atoi(tok);
+        if( readtoken(f,tok,sizeof(tok)) < 0 ) goto error;
+        height = atoi(tok);
+        if( readtoken(f,tok,sizeof(tok)) < 0 ) goto error;
+        maxval = atoi(tok);
+    } else if( strcmp(tok,"P7") == 0 ) {
+        for(;;) {
+            if( readtoken(f,tok,sizeof(tok)) < 0 ) goto error;
+            if( strcmp(tok,"ENDHDR") == 0 )
+                break;
+            if( strcmp(tok,"WIDTH") == 0 ) {
+                readtoken(f,tok,sizeof(tok)); width = atoi(tok);
+            } else if( strcmp(tok,"HEIGHT") == 0 ) {
+                readtoken(f,tok,sizeof(tok)); height = atoi(tok);
+            } else if( strcmp(tok,"DEPTH") == 0 ) {
+                readtoken(f,tok,sizeof(tok)); depth = atoi(tok);
+            } else if( strcmp(tok,"MAXVAL") == 0 ) {
+                readtoken(f,tok,sizeof(tok)); maxval = atoi(tok);
+            }
+        }
+    } else {
+        goto error;
+    }
+    if( width <= 0 || height <= 0 || width > 65535 || height > 65535
+     || maxval != 255 || (depth != 3 && depth != 4) )
+        goto error;
+
+    n = width*height;
+    rgba = malloc(n*4);
+    if( !rgba )
+        goto error;
+    for(i=0;i<n;i++) {
+        for(c=0;c<depth;c++) {
+            int v = fgetc(f);
+            if( v == EOF )
+                goto error;
+            rgba[i*4+c] = v;
+        }
+        if( depth == 3 )
+            rgba[i*4+3] = 255;
+    }
+    fclose(f);
+    return 0;
+error:
+    fclose(f);
+    return -1;
+}
+
+/**
+ * @brief   topixel
+ *
+ * @note    Converts pixel i to the output format
+ */
+static uint32_t
+topixel(int i, int format) {
+uint32_t r = rgba[i*4], g = rgba[i*4+1], b = rgba[i*4+2], a = rgba[i*4+3];
+
+    switch(format) {
+    case 0: return (a<<24)|(r<<16)|(g<<8)|b;
+    case 1: return (r<<16)|(g<<8)|b;
+    case 2: return ((r>>3)<<11)|((g>>2)<<5)|(b>>3);
+    case 3: return ((a>>7)<<15)|((r>>3)<<10)|((g>>3)<<5)|(b>>3);
+    default:return ((a>>4)<<12)|((r>>4)<<8)|((g>>4)<<4)|(b>>4);
+    }
+}
+
+/**
+ * @brief   Output buffer
+ */
+static uint8_t  *out;
+static long     outsize = 0;
+
+static void
+putpixel(uint32_t v, int ps) {
+int k;
+
+    for(k=0;k<ps;k++)
+        out[outsize++] = (v>>(8*k))&0xFF;
+}
+
+/**
+ * @brief   encodeline
+ *
+ * @note    RLE encoding of a line. A run of two or more equal pixels ends the
+ *          current literal
+ */
+static void
+encodeline(const uint32_t *line, int w, int ps) {
+int i = 0, r, n, k;
+
+    while( i < w ) {
+        r = 1;
+        while( i+r < w && r < 128 && line[i+r] == line[i] )
+            r++;
+        if( r >= 2 ) {
+            out[outsize++] = 0x80|(r-1);
+            putpixel(line[i],ps);
+            i += r;
+            continue;
+        }
+        n = 1;
+        while( i+n < w && n < 128
+             && !(i+n+1 < w && line[i+n] == line[i+n+1]) )
+            n++;
+        out[outsize++] = n-1;
+        for(k=0;k<n;k++)
+            putpixel(line[i+k],ps);
+        i += n;
+    }
+}
+
+static void
+usage(void) {
+
+    fprintf(stderr,"Usage: imgconv [-f format] [-r] [-n name] image.ppm > name.c\n");
+    exit(1);
+}
+
+int
+main(int argc, char *argv[]) {
+const char *name = "image";
+const char *fn = 0;
+int format = 2;
+int raw = 0;
+int ps,i,j;
+uint32_t *line;
+long rawsize;
+
+    for(i=1;i<argc;i++) {
+        if( strcmp(argv[i],"-f") == 0 && i+1 < argc ) {
+            i++;
+            for(format=0;format<NFORMATS;format++)
+                if( strcmp(argv[i],formats[format].name) == 0 )
+                    break;
+            if( format == NFORMATS )
+                usage();
+        } else if( strcmp(argv[i],"-n") == 0 && i+1 < argc ) {
+            name = argv[++i];
+        } else if( strcmp(argv[i],"-r") == 0 ) {
+            raw = 1;
+        } else if( argv[i][0] != '-' && fn == 0 ) {
+            fn = argv[i];
+        } else {
+            usage();
+        }
+    }
+    if( !fn )
+        usage();
+    if( readimage(fn) < 0 ) {
+        fprintf(stderr,"imgconv: cannot read %s (binary PPM or PAM, maxval 255)\n",fn);
+        return 1;
+    }
+
+    ps = formats[format].ps;
+    rawsize = (long) width*height*ps;
+    // RLE adds at most a control byte for each 128 pixels and one at line end
+    out  = malloc(rawsize+(long) height*(width/64+2));
+    line = malloc(width*sizeof(uint32_t));
+    if( !out || !line )
+        return 1;
+
+    for(j=0;j<height;j++) {
+        for(i=0;i<width;i++)
+            line[i] = topixel(j*width+i,format);
+        if( raw ) {
+            for(i=0;i<width;i++)
+                putpixel(line[i],ps);
+        } else {
+            encodeline(line,width,ps);
+        }
+    }
+
+    printf("/**\n * @file    %s.c\n *\n * @note    Generated by imgconv from %s\n",name,fn);
+    printf(" *\n * @note    %dx%d %s, %s: %ld bytes (raw %ld bytes)\n */\n\n",
+            width,height,formats[format].name,raw?"raw":"RLE",outsize,rawsize);
+    printf("#include <stdint.h>\n\n#include \"lcd.h\"\n#include \"image.h\"\n\n");
+    printf("static const uint8_t %s_data[%ld] = {",name,outsize);
+    for(i=0;i<outsize;i++)
+        printf("%s0x%02X,",(i%16)?" ":"\n    ",out[i]);
+    printf("\n};\n\n");
+    printf("const IMAGE_Asset %s = {\n",name);
+    printf("    %d, %d, %s, %s, %ld, %s_data\n};\n",
+            width,height,formats[format].macro,raw?"IMAGE_RAW":"IMAGE_RLE",outsize,name);
+
+    fprintf(stderr,"imgconv: %s %dx%d %s %ld bytes (%ld%% of raw)\n",
+            name,width,height,formats[format].name,outsize,outsize*100/rawsize);
+    return 0;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file    jpgconv.c
+ *
+ * @note    Converts a JPEG file into a C file with a JPEG_Asset (see jpeg.h)
+ *
+ * @note    Host program. Built with make jpgconv. Usage
+ *
+ *          jpgconv [-n name] image.jpg > name.c
+ *
+ *          The file is copied as is. Only the frame header is checked, so that
+ *          progressive or arithmetic coded files, which jpeg.c can not decode,
+ *          are rejected here
+ *
+ * @note    Baseline files can be generated with cjpeg or ImageMagick
+ *          (convert photo.png -interlace none photo.jpg)
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/**
+ * @brief   Input file
+ */
+static uint8_t  *data;
+static long     size;
+
+/**
+ * @brief   readfile
+ */
+static int
+readfile(const char *fn) {
+FILE *f;
+
+    f = fopen(fn,"rb");
+    if( !f )
+        return -1;
+    fseek(f,0,SEEK_END);
+    size = ftell(f);
+    fseek(f,0,SEEK_SET);
+    data = malloc(size > 0 ? size : 1);
+    if( !data || fread(data,1,size,f) != (size_t) size ) {
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+    return 0;
+}
+
+/**
+ * @brief   checkframe
+ *
+ * @note    Finds the frame header. Returns 0 and the size for baseline and
+ *          extended sequential files with 8 bit samples and 1 or 3 components
+ */
+static int
+checkframe(int *width, int *height, int *ncomp) {
+long p = 2;
+int m,len;
+
+    if( size < 4 || data[0] != 0xFF || data[1] != 0xD8 )
+        return -1;
+    while( p+4 <= size ) {
+        if( data[p] != 0xFF )
+            return -1;
+        while( p < size && data[p] == 0xFF )
+            p++;
+        if( p+3 > size )
+            return -1;
+        m   = data[p];
+        len = (data[p+1]<<8)|data[p+2];
+        if( m == 0xC0 || m == 0xC1 ) {
+            if( p+9 > size || data[p+3] != 8 )
+                return -1;
+            *height = (data[p+4]<<8)|data[p+5];
+            *width  = (data[p+6]<<8)|data[p+7];
+            *ncomp  = data[p+8];
+            return (*ncomp == 1 || *ncomp == 3) && *width > 0 && *height > 0 ? 0 : -1;
+        }
+        if( (m >= 0xC2 && m <= 0xCF && m != 0xC4 && m != 0xC8 && m != 0xCC) || m == 0xDA )
+            return -1;
+        p += 1+len;
+    }
+    return -1;
+}
+
+static void
+usage(void) {
+
+    fprintf(stderr,"Usage: jpgconv [-n name] image.jpg > name.c\n");
+    exit(1);
+}
+
+int
+main(int argc, char *argv[]) {
+const char *name = "image";
+const char *fn = 0;
+const char *base;
+int width,height,ncomp;
+long i;
+
+    for(i=1;i<argc;i++) {
+        if( strcmp(argv[i],"-n") == 0 && i+1 < argc ) {
+            name = argv[++i];
+        } else if( argv[i][0] != '-' && fn == 0 ) {
+            fn = argv[i];
+        } else {
+            usage();
+        }
+    }
+    if( !fn )
+        usage();
+    if( readfile(fn) < 0 ) {
+        fprintf(stderr,"jpgconv: cannot read %s\n",fn);
+        return 1;
+    }
+    if( checkframe(&width,&height,&ncomp) < 0 ) {
+        fprintf(stderr,"jpgconv: %s is not a baseline JPEG with 8 bit samples\n",fn);
+        return 1;
+    }
+    base = strrchr(fn,'/');
+    base = base ? base+1 : fn;
+
+    printf("/**\n");
+    printf(" * @file    %s.c\n",name);
+    printf(" *\n");
+    printf(" * @note    Generated by jpgconv from %s\n",base);
+    printf(" *\n");
+    printf(" * @note    %dx%d %s JPEG: %ld bytes (RGB565 %ld bytes)\n",width,height,
+            ncomp == 1 ? "grayscale" : "color",size,(long) width*height*2);
+    printf(" */\n\n");
+    printf("#include <stdint.h>\n\n");
+    printf("#include \"jpeg.h\"\n\n");
+    printf("static const uint8_t %s_data[%ld] = {\n",name,size);
+    for(i=0;i<size;i++) {
+        if( i%16 == 0 )
+            printf("    ");
+        printf("0x%02X,",data[i]);
+        if( i%16 == 15 || i == size-1 )
+            printf("\n");
+        else
+            printf(" ");
+    }
+    printf("};\n\n");
+    printf("const JPEG_Asset %s = {\n",name);
+    printf("    %d, %d, %ld, %s_data\n",width,height,size,name);
+    printf("};\n");
+    return 0;
+}
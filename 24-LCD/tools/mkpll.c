@@ -0,0 +1,266 @@
+/**
+ * @file    mkpll.c
+ *
+ * @note    Finds the configuration of the Main PLL, PLLSAI and PLLI2S for the
+ *          given target frequencies and prints it as a header (pllconfig.h)
+ *
+ * @note    Host program. Built with make mkpll. Usage
+ *
+ *          mkpll [-i hse] [-s sysclk] [-u ck48] [-l lcdclk] [-a i2sclk] > pllconfig.h
+ *
+ *          All frequencies in Hz. Defaults: HSE 25000000, SYSCLK 200000000,
+ *          48 MHz clock 48000000, LCD_CLK 9000000 and no I2S clock. A zero
+ *          target means that the clock is not used
+ *
+ * @note    The three PLLs share the source and M. For each M, the Main PLL
+ *          gives SYSCLK (P) and the 48 MHz clock (Q). When Q cannot give it
+ *          within 0.25% (USB limit), it comes from the P output of PLLSAI
+ *          (CK48MSEL). The R output of PLLSAI divided by PLLSAIDIVR gives LCD_CLK
+ *          and the R output of PLLI2S gives the I2S clock. The smallest error
+ *          wins in this order: SYSCLK, 48 MHz, LCD_CLK, I2S
+ *
+ * @note    Limits (RM0385 5.3): VCO input 0.95-2.1 MHz, VCO output 100-432 MHz,
+ *          N 50-432, P 2, 4, 6 or 8, Q 2-15, R 2-7, PLLSAIDIVR 2, 4, 8 or 16 and
+ *          SYSCLK up to 216 MHz
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define VCOINMIN        950000.0
+#define VCOINMAX        2100000.0
+#define VCOMIN          100000000.0
+#define VCOMAX          432000000.0
+#define SYSCLKMAX       216000000.0
+#define CK48TOLERANCE   0.0025
+
+/**
+ * @brief   Divisors of one PLL and the errors of its outputs
+ */
+typedef struct {
+    unsigned    n,p,q,r,divr;
+    double      err[2];
+} PLL;
+
+static const unsigned pvalues[]    = { 2, 4, 6, 8 };
+static const unsigned divrvalues[] = { 2, 4, 8, 16 };
+
+/**
+ * @brief   Targets
+ */
+///@{
+static double fin    = 25000000.0;
+static double sysclk = 200000000.0;
+static double ck48   = 48000000.0;
+static double lcdclk = 9000000.0;
+static double i2sclk = 0.0;
+///@}
+
+static int
+better(const double *a, const double *b, int n) {
+int i;
+
+    for(i=0;i<n;i++) {
+        if( a[i] < b[i]-0.5 )
+            return 1;
+        if( a[i] > b[i]+0.5 )
+            return 0;
+    }
+    return 0;
+}
+
+/**
+ * @brief   searchmain
+ *
+ * @note    err[0] is the SYSCLK error and err[1] the 48 MHz error of Q
+ */
+static void
+searchmain(double vcoin, PLL *best) {
+unsigned n,i,q;
+double vco,f,e[2];
+
+    best->err[0] = best->err[1] = HUGE_VAL;
+    for(n=50;n<=432;n++) {
+        vco = vcoin*n;
+        if( vco < VCOMIN || vco > VCOMAX )
+            continue;
+        for(i=0;i<sizeof(pvalues)/sizeof(pvalues[0]);i++) {
+            f = vco/pvalues[i];
+            if( f > SYSCLKMAX )
+                continue;
+            for(q=2;q<=15;q++) {
+                e[0] = fabs(f-sysclk);
+                e[1] = ck48 ? fabs(vco/q-ck48) : 0.0;
+                if( better(e,best->err,2) ) {
+                    best->n = n; best->p = pvalues[i]; best->q = q; best->r = 2;
+                    best->err[0] = e[0];
+                    best->err[1] = e[1];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief   searchsai
+ *
+ * @note    err[0] is the 48 MHz error of P (0 when not used) and err[1] the
+ *          LCD_CLK error of R/PLLSAIDIVR
+ */
+static void
+searchsai(double vcoin, int useck48, PLL *best) {
+unsigned n,i,r,k;
+double vco,e[2];
+
+    best->err[0] = best->err[1] = HUGE_VAL;
+    for(n=50;n<=432;n++) {
+        vco = vcoin*n;
+        if( vco < VCOMIN || vco > VCOMAX )
+            continue;
+        for(i=0;i<sizeof(pvalues)/sizeof(pvalues[0]);i++) {
+            e[0] = useck48 ? fabs(vco/pvalues[i]-ck48) : 0.0;
+            for(r=2;r<=7;r++) {
+                for(k=0;k<sizeof(divrvalues)/sizeof(divrvalues[0]);k++) {
+                    e[1] = lcdclk ? fabs(vco/r/divrvalues[k]-lcdclk) : 0.0;
+                    if( better(e,best->err,2) ) {
+                        best->n = n; best->p = pvalues[i]; best->q = 2; best->r = r;
+                        best->divr = divrvalues[k];
+                        best->err[0] = e[0];
+                        best->err[1] = e[1];
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief   searchi2s
+ *
+ * @note    err[0] is the I2S clock error of R
+ */
+static void
+searchi2s(double vcoin, PLL *best) {
+unsigned n,r;
+double vco,e[2];
+
+    best->err[0] = best->err[1] = HUGE_VAL;
+    for(n=50;n<=432;n++) {
+        vco = vcoin*n;
+        if( vco < VCOMIN || vco > VCOMAX )
+            continue;
+        for(r=2;r<=7;r++) {
+            e[0] = i2sclk ? fabs(vco/r-i2sclk) : 0.0;
+            e[1] = 0.0;
+            if( better(e,best->err,1) ) {
+                best->n = n; best->p = 2; best->q = 2; best->r = r;
+                best->err[0] = e[0];
+            }
+        }
+    }
+}
+
+static void
+usage(void) {
+
+    fprintf(stderr,"Usage: mkpll [-i hse] [-s sysclk] [-u ck48] [-l lcdclk] [-a i2sclk] > pllconfig.h\n");
+    exit(1);
+}
+
+int
+main(int argc, char *argv[]) {
+PLL main_ = { 0 }, sai = { 0 }, i2s = { 0 };
+PLL bmain = { 0 }, bsai = { 0 }, bi2s = { 0 };
+double err[4], berr[4];
+double vcoin, vco;
+unsigned m, bm = 0;
+int i, ck48sai, bck48sai = 0;
+
+    for(i=1;i<argc;i++) {
+        if( i+1 >= argc || argv[i][0] != '-' || argv[i][2] != 0 )
+            usage();
+        switch(argv[i][1]) {
+        case 'i': fin    = strtod(argv[++i],0); break;
+        case 's': sysclk = strtod(argv[++i],0); break;
+        case 'u': ck48   = strtod(argv[++i],0); break;
+        case 'l': lcdclk = strtod(argv[++i],0); break;
+        case 'a': i2sclk = strtod(argv[++i],0); break;
+        default:  usage();
+        }
+    }
+    if( fin <= 0.0 || sysclk <= 0.0 || sysclk > SYSCLKMAX )
+        usage();
+
+    berr[0] = berr[1] = berr[2] = berr[3] = HUGE_VAL;
+    for(m=2;m<=63;m++) {
+        vcoin = fin/m;
+        if( vcoin < VCOINMIN || vcoin > VCOINMAX )
+            continue;
+        searchmain(vcoin,&main_);
+        ck48sai = ck48 && main_.err[1] > ck48*CK48TOLERANCE;
+        searchsai(vcoin,ck48sai,&sai);
+        searchi2s(vcoin,&i2s);
+        err[0] = main_.err[0];
+        err[1] = ck48sai ? sai.err[0] : main_.err[1];
+        err[2] = sai.err[1];
+        err[3] = i2s.err[0];
+        if( better(err,berr,4) ) {
+            memcpy(berr,err,sizeof(berr));
+            bm = m;
+            bmain = main_;
+            bsai = sai;
+            bi2s = i2s;
+            bck48sai = ck48sai;
+        }
+    }
+    if( bm == 0 ) {
+        fprintf(stderr,"mkpll: no M gives a VCO input in the 0.95-2.1 MHz range\n");
+        return 1;
+    }
+    if( ck48 && berr[1] > ck48*CK48TOLERANCE )
+        fprintf(stderr,"mkpll: warning: 48 MHz clock error %.0f Hz is larger than 0.25%%\n",berr[1]);
+
+    vcoin = fin/bm;
+    fprintf(stderr,"mkpll: M=%u SYSCLK %.0f Hz, 48 MHz clock %.0f Hz (%s), LCD_CLK %.0f Hz, I2S %.0f Hz\n",
+            bm,vcoin*bmain.n/bmain.p,
+            bck48sai ? vcoin*bsai.n/bsai.p : vcoin*bmain.n/bmain.q,bck48sai?"PLLSAI P":"PLL Q",
+            vcoin*bsai.n/bsai.r/bsai.divr,vcoin*bi2s.n/bi2s.r);
+
+    printf("/**\n * @file    pllconfig.h\n *\n");
+    printf(" * @note    Generated by mkpll -i %.0f -s %.0f -u %.0f -l %.0f -a %.0f\n",
+            fin,sysclk,ck48,lcdclk,i2sclk);
+    printf(" *\n *          clock        output          target        actual     error\n");
+    vco = vcoin*bmain.n;
+    printf(" *          SYSCLK       PLL P    %12.0f  %12.0f  %8.0f\n",sysclk,vco/bmain.p,berr[0]);
+    if( ck48 && bck48sai )
+        printf(" *          CK48         PLLSAI P %12.0f  %12.0f  %8.0f\n",ck48,vcoin*bsai.n/bsai.p,berr[1]);
+    else if( ck48 )
+        printf(" *          CK48         PLL Q    %12.0f  %12.0f  %8.0f\n",ck48,vco/bmain.q,berr[1]);
+    if( lcdclk )
+        printf(" *          LCD_CLK      PLLSAI R %12.0f  %12.0f  %8.0f\n",lcdclk,
+                vcoin*bsai.n/bsai.r/bsai.divr,berr[2]);
+    if( i2sclk )
+        printf(" *          I2S          PLLI2S R %12.0f  %12.0f  %8.0f\n",i2sclk,
+                vcoin*bi2s.n/bi2s.r,berr[3]);
+    printf(" *\n * @note    Initializers for PLLConfiguration_t (see system_stm32f746.h)\n */\n\n");
+
+    printf("#ifndef PLLCONFIG_H\n#define PLLCONFIG_H\n\n");
+    printf("#define PLLCONFIG_MAIN          { CLOCKSRC_HSE, %u, %u, %u, %u, %u }\n",
+            bm,bmain.n,bmain.p,bmain.q,bmain.r);
+    printf("#define PLLCONFIG_SAI           { CLOCKSRC_HSE, %u, %u, %u, %u, %u }\n",
+            bm,bsai.n,bsai.p,bsai.q,bsai.r);
+    printf("#define PLLCONFIG_I2S           { CLOCKSRC_HSE, %u, %u, %u, %u, %u }\n\n",
+            bm,bi2s.n,bi2s.p,bi2s.q,bi2s.r);
+    printf("#define PLLCONFIG_SYSCLK        %.0fU\n",vco/bmain.p);
+    printf("#define PLLCONFIG_CK48MSEL      %d       // 0: PLL Q, 1: PLLSAI P\n",bck48sai);
+    printf("#define PLLCONFIG_LCDCLK        %.0fU\n",vcoin*bsai.n/bsai.r/bsai.divr);
+    printf("#define PLLCONFIG_PLLSAIDIVR    %u       // encoding of /%u\n",
+            bsai.divr==2?0:bsai.divr==4?1:bsai.divr==8?2:3,bsai.divr);
+    printf("\n#endif // PLLCONFIG_H\n");
+    return 0;
+}
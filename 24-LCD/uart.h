@@ -155,6 +155,16 @@ int UART_ReadCharNoWait(int uartn);
 int UART_ReadString(int uartn, char *s, int n);
 int UART_GetStatus(int uartn);
 
+/// Levels returned by UART_GetFIFOLevels (0 when there is no FIFO)
+typedef struct {
+    int     inlevel;                        ///< chars waiting to be read
+    int     incapacity;
+    int     outlevel;                       ///< chars waiting to be sent
+    int     outcapacity;
+} UART_FIFOLevels;
+
+int UART_GetFIFOLevels(int uartn, UART_FIFOLevels *l);
+
 int UART_Flush(int uartn);
 
 #endif // UART_H
@@ -16,6 +16,7 @@
 #include "gpio.h"
 #include "uart.h"
 #include "fifo.h"
+#include "memsections.h"
 
 /**
  ** @brief Bit manipulation macros
@@ -103,7 +104,7 @@ void UART_EnableClock(USART_TypeDef *uart) {
  *
  * @note    Identical to all uarts/usarts
  */
-static void ProcessInterrupt(int un) {
+ITCM_CODE static void ProcessInterrupt(int un) {
 USART_TypeDef  *uart;
 
     uart = uarttab[un].device;
@@ -549,6 +550,34 @@ uint32_t status;
 
 }
 
+/**
+ ** @brief UART Get FIFO Levels
+ **
+ ** @note  Chars in the input and output FIFOs. Read without disabling the
+ **        interrupts, so a level can be off by one
+ **
+ **/
+
+int
+UART_GetFIFOLevels(int uartn, UART_FIFOLevels *l) {
+
+    if( uartn >= uarttabsize ) return -1;
+
+    l->inlevel     = 0;
+    l->incapacity  = 0;
+    l->outlevel    = 0;
+    l->outcapacity = 0;
+    if( uarttab[uartn].conf.useinputfifo ) {
+        l->inlevel    = fifo_size(uarttab[uartn].inputfifo);
+        l->incapacity = fifo_capacity(uarttab[uartn].inputfifo);
+    }
+    if( uarttab[uartn].conf.useoutputfifo ) {
+        l->outlevel    = fifo_size(uarttab[uartn].outputfifo);
+        l->outcapacity = fifo_capacity(uarttab[uartn].outputfifo);
+    }
+    return 0;
+}
+
 /**
  ** @brief UART Get Status
  **
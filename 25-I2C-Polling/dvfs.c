@@ -0,0 +1,355 @@
+/**
+ * @file    dvfs.c
+ *
+ * @note    Dynamic frequency and voltage scaling
+ *
+ * @note    The sequence follows RM Sections 3.3.2 (flash latency) and 4.1.4
+ *          (voltage regulator and over-drive)
+ *          1. Call the callbacks with DVFS_PRECHANGE
+ *          2. Switch SYSCLK to HSI. It sets the flash wait states for 16 MHz
+ *          3. Leave over-drive mode (only possible with SYSCLK from HSI or HSE)
+ *          4. With the PLL off, set VOS. It is used only when the PLL is on
+ *          5. Configure and enable the PLL and wait for VOSRDY
+ *          6. If needed, set ODEN, wait for ODRDY, set ODSWEN, wait for ODSWRDY
+ *          7. Switch SYSCLK to PLL. It sets the flash wait states for HCLK
+ *          8. Set the APB prescalers and rescale SysTick
+ *          9. Call the callbacks with DVFS_POSTCHANGE
+ *
+ * @note    Interrupts are disabled from 2 to 8, so the ticks during the
+ *          change (some hundreds of us) are lost
+ *
+ * @note    DVFS_Stop does 2 to 4 before entering Stop mode (RM Section 4.3.6),
+ *          so the core runs from HSI, as after the wakeup, and the regulator
+ *          is not in over-drive mode, that must be left before Stop. After the
+ *          wakeup, it does 4 to 8 for the same operating point and enables
+ *          PLLSAI and PLLI2S again, when they were on. Their configuration is
+ *          kept
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "dvfs.h"
+
+/**
+ * @brief   Operating point parameters
+ */
+typedef struct {
+    uint32_t            freq;
+    PLLConfiguration_t  pll;
+    uint32_t            vos;
+    uint32_t            overdrive;
+    uint32_t            apb1div;
+    uint32_t            apb2div;
+} DVFS_OperatingPoint;
+
+/**
+ * @brief   Operating point table
+ *
+ * @note    f_VCO = 1 MHz*N must be in range 100-432 MHz and f_OUT = f_VCO/P
+ *
+ * @note    APB1 must not exceed 54 MHz and APB2 108 MHz
+ *
+ * @note    Scale 3 (VOS=01) is for HCLK up to 144 MHz. Scale 1 (VOS=11) is for
+ *          up to 180 MHz and 216 MHz with over-drive
+ */
+static const DVFS_OperatingPoint optab[] = {
+/*      freq          source        M              N    P  Q  R   VOS                          OD  APB1 APB2 */
+    { 216000000, { CLOCKSRC_HSE, HSE_FREQ/1000000, 432, 2, 2, 2 }, PWR_CR1_VOS_1|PWR_CR1_VOS_0, 1,   4,   2 },
+    { 200000000, { CLOCKSRC_HSE, HSE_FREQ/1000000, 400, 2, 2, 2 }, PWR_CR1_VOS_1|PWR_CR1_VOS_0, 1,   4,   2 },
+    { 100000000, { CLOCKSRC_HSE, HSE_FREQ/1000000, 400, 4, 2, 2 }, PWR_CR1_VOS_0,               0,   2,   1 },
+    {  50000000, { CLOCKSRC_HSE, HSE_FREQ/1000000, 400, 8, 2, 2 }, PWR_CR1_VOS_0,               0,   1,   1 },
+};
+static const int optabsize = sizeof(optab)/sizeof(optab[0]);
+
+/**
+ * @brief   Actual operating point (-1 when not set by DVFS_SetOperatingPoint)
+ */
+static int opcurrent = -1;
+
+/**
+ * @brief   Stop mode statistics
+ */
+static DVFS_StopStats stopstats = { 0 };
+
+/**
+ * @brief   Registered callbacks
+ */
+///@{
+static DVFS_Callback    callbacks[DVFS_MAXCALLBACKS];
+static int              ncallbacks = 0;
+///@}
+
+/**
+ * @brief   CallCallbacks
+ *
+ * @note    POSTCHANGE and POSTSTOP callbacks are called in the reverse order
+ */
+static void
+CallCallbacks(int phase) {
+int i;
+
+    if( DVFS_BEFORE(phase) ) {
+        for(i=0;i<ncallbacks;i++)
+            callbacks[i](phase);
+    } else {
+        for(i=ncallbacks-1;i>=0;i--)
+            callbacks[i](phase);
+    }
+}
+
+/**
+ * @brief   SetVoltageScaling
+ *
+ * @note    Leaves the over-drive mode and sets VOS. The PLL must be off
+ */
+static void
+SetVoltageScaling(uint32_t vos) {
+
+    RCC->APB1ENR |= RCC_APB1ENR_PWREN;
+    __DSB();
+
+    PWR->CR1 &= ~(PWR_CR1_ODSWEN|PWR_CR1_ODEN);
+    PWR->CR1 = (PWR->CR1&~PWR_CR1_VOS)|vos;
+}
+
+/**
+ * @brief   EnableOverDrive
+ *
+ * @note    The PLL must be on and SYSCLK must come from HSI or HSE
+ */
+static void
+EnableOverDrive(void) {
+
+    PWR->CR1 |= PWR_CR1_ODEN;
+    while( (PWR->CSR1&PWR_CSR1_ODRDY) == 0 ) {}
+    PWR->CR1 |= PWR_CR1_ODSWEN;
+    while( (PWR->CSR1&PWR_CSR1_ODSWRDY) == 0 ) {}
+}
+
+/**
+ * @brief   RescaleSysTick
+ *
+ * @note    Keeps the SysTick period, when it is running
+ */
+static void
+RescaleSysTick(uint32_t oldfreq, uint32_t newfreq) {
+uint64_t load;
+
+    if( (SysTick->CTRL&SysTick_CTRL_ENABLE_Msk) == 0 || oldfreq == 0 )
+        return;
+
+    load = ((uint64_t) SysTick->LOAD+1)*newfreq/oldfreq;
+    if( load == 0 || load > SysTick_LOAD_RELOAD_Msk+1 )
+        return;
+    SysTick->LOAD = load-1;
+    SysTick->VAL  = 0;
+}
+
+/**
+ * @brief   SwitchOperatingPoint
+ *
+ * @note    Steps 2 to 8 without SysTick. Interrupts must be disabled. When
+ *          tswitch is not null, it receives the cycle counter just before
+ *          SYSCLK is switched to the PLL
+ */
+static void
+SwitchOperatingPoint(const DVFS_OperatingPoint *p, uint32_t *tswitch) {
+
+    SystemSetCoreClock(CLOCKSRC_HSI,1);
+
+    SystemDisableMainPLL();
+    SetVoltageScaling(p->vos);
+
+    SystemConfigMainPLL(&p->pll);
+    while( (PWR->CSR1&PWR_CSR1_VOSRDY) == 0 ) {}
+
+    if( p->overdrive )
+        EnableOverDrive();
+
+    if( tswitch )
+        *tswitch = DWT->CYCCNT;
+    SystemSetCoreClock(CLOCKSRC_PLL,1);
+    SystemSetAPB1Prescaler(p->apb1div);
+    SystemSetAPB2Prescaler(p->apb2div);
+}
+
+/**
+ * @brief   CyclesToMicroseconds
+ *
+ * @note    From t0 to tswitch the core runs from HSI, then at SystemCoreClock
+ */
+static uint32_t
+CyclesToMicroseconds(uint32_t t0, uint32_t tswitch, uint32_t t1) {
+
+    return (tswitch-t0)/(HSI_FREQ/1000000)+(t1-tswitch)/(SystemCoreClock/1000000);
+}
+
+/**
+ * @brief   DVFS_RegisterCallback
+ *
+ * @note    Returns 0 or -1 when the table is full
+ */
+int
+DVFS_RegisterCallback(DVFS_Callback f) {
+int i;
+
+    for(i=0;i<ncallbacks;i++) {
+        if( callbacks[i] == f )
+            return 0;
+    }
+    if( ncallbacks >= DVFS_MAXCALLBACKS )
+        return -1;
+    callbacks[ncallbacks++] = f;
+    return 0;
+}
+
+/**
+ * @brief   DVFS_SetOperatingPoint
+ *
+ * @note    Returns 0 or -1 when op is not valid
+ *
+ * @note    It busy waits for the PLL and the regulator. Do not call it from an
+ *          interrupt routine
+ */
+int
+DVFS_SetOperatingPoint(int op) {
+const DVFS_OperatingPoint *p;
+uint32_t oldfreq,primask;
+
+    if( op < 0 || op >= optabsize )
+        return -1;
+    if( op == opcurrent )
+        return 0;
+    p = &optab[op];
+
+    CallCallbacks(DVFS_PRECHANGE);
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    oldfreq = SystemCoreClock;
+
+    SwitchOperatingPoint(p,0);
+
+    RescaleSysTick(oldfreq,SystemCoreClock);
+    opcurrent = op;
+
+    if( !primask )
+        __enable_irq();
+
+    CallCallbacks(DVFS_POSTCHANGE);
+
+    return 0;
+}
+
+/**
+ * @brief   DVFS_GetOperatingPoint
+ *
+ * @note    Returns -1 before the first DVFS_SetOperatingPoint
+ */
+int
+DVFS_GetOperatingPoint(void) {
+
+    return opcurrent;
+}
+
+/**
+ * @brief   DVFS_GetFrequency
+ *
+ * @note    HCLK of the operating point or 0 when op is not valid
+ */
+uint32_t
+DVFS_GetFrequency(int op) {
+
+    if( op < 0 || op >= optabsize )
+        return 0;
+    return optab[op].freq;
+}
+
+/**
+ * @brief   DVFS_Stop
+ *
+ * @note    Enters Stop mode and returns after the wakeup, with the operating
+ *          point restored. The wakeup source is an EXTI line (a pin, RTC
+ *          alarm, ...) with its interrupt enabled. Its routine runs only after
+ *          the POSTSTOP callbacks. SysTick does not run in Stop mode
+ *
+ * @note    Returns 0 or -1 when no operating point was set
+ *
+ * @note    Do not call it from an interrupt routine
+ */
+int
+DVFS_Stop(unsigned flags) {
+const DVFS_OperatingPoint *p;
+uint32_t primask,saion,i2son,cr1;
+uint32_t t0,tswitch,t1,t2,us;
+
+    if( opcurrent < 0 )
+        return -1;
+    p = &optab[opcurrent];
+
+    // Cycle counter for the resume time
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    CallCallbacks(DVFS_PRESTOP);
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    saion = RCC->CR&RCC_CR_PLLSAION;
+    i2son = RCC->CR&RCC_CR_PLLI2SON;
+
+    SystemSetCoreClock(CLOCKSRC_HSI,1);
+    SystemDisableMainPLL();
+    SetVoltageScaling(p->vos);
+
+    cr1 = PWR->CR1&~(PWR_CR1_PDDS|PWR_CR1_LPDS|PWR_CR1_FPDS);
+    if( flags&DVFS_STOP_LPREGULATOR )
+        cr1 |= PWR_CR1_LPDS;
+    if( flags&DVFS_STOP_FLASHPOWERDOWN )
+        cr1 |= PWR_CR1_FPDS;
+    PWR->CR1 = cr1;
+
+    SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+    __DSB();
+    __WFI();
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+
+    t0 = DWT->CYCCNT;
+
+    SwitchOperatingPoint(p,&tswitch);
+    if( saion )
+        SystemEnablePLLSAI();
+    if( i2son )
+        SystemEnablePLLI2S();
+
+    t1 = DWT->CYCCNT;
+    CallCallbacks(DVFS_POSTSTOP);
+    t2 = DWT->CYCCNT;
+
+    us = CyclesToMicroseconds(t0,tswitch,t2);
+    stopstats.stops++;
+    stopstats.resumelast = us;
+    if( us > stopstats.resumemax )
+        stopstats.resumemax = us;
+    stopstats.clocklast = CyclesToMicroseconds(t0,tswitch,t1);
+
+    if( !primask )
+        __enable_irq();
+
+    return 0;
+}
+
+/**
+ * @brief   DVFS_GetStopStats
+ */
+void
+DVFS_GetStopStats(DVFS_StopStats *stats) {
+
+    *stats = stopstats;
+}
@@ -0,0 +1,103 @@
+#ifndef DVFS_H
+#define DVFS_H
+/**
+ * @file    dvfs.h
+ *
+ * @note    Dynamic frequency and voltage scaling
+ *
+ * @note    The core runs at one of the operating points below. A change sets the
+ *          PLL, the flash wait states, the regulator scale (VOS), the over-drive
+ *          mode and the APB prescalers, and rescales SysTick
+ *
+ * @note    The drivers whose timing depends on HCLK, APB1 or SYSCLK register a
+ *          callback. It is called with DVFS_PRECHANGE before the change, to let
+ *          the transfers in progress complete, and with DVFS_POSTCHANGE after it,
+ *          when SystemCoreClock has the new value, to program the new timing
+ *
+ * @note    DVFS_Stop enters Stop mode. The callbacks are called with
+ *          DVFS_PRESTOP before and with DVFS_POSTSTOP after it, when the
+ *          operating point was restored. The POSTSTOP callbacks run with the
+ *          interrupts still disabled, so, e.g., the SDRAM leaves self-refresh
+ *          before any interrupt routine can access it
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Operating points
+ *
+ * | Point       | HCLK    | VOS   | Over-drive | APB1   | APB2    |
+ * |-------------|---------|-------|------------|--------|---------|
+ * | DVFS_216MHZ | 216 MHz | 1     | yes        | 54 MHz | 108 MHz |
+ * | DVFS_200MHZ | 200 MHz | 1     | yes        | 50 MHz | 100 MHz |
+ * | DVFS_100MHZ | 100 MHz | 3     | no         | 50 MHz | 100 MHz |
+ * | DVFS_50MHZ  |  50 MHz | 3     | no         | 50 MHz |  50 MHz |
+ */
+///@{
+#define DVFS_216MHZ                 0
+#define DVFS_200MHZ                 1
+#define DVFS_100MHZ                 2
+#define DVFS_50MHZ                  3
+#define DVFS_OPERATINGPOINTS        4
+///@}
+
+/**
+ * @brief   Phases passed to the callbacks
+ */
+///@{
+#define DVFS_PRECHANGE              0
+#define DVFS_POSTCHANGE             1
+#define DVFS_PRESTOP                2
+#define DVFS_POSTSTOP               3
+///@}
+
+/**
+ * @brief   True for the phases before a change or a stop
+ */
+#define DVFS_BEFORE(PHASE)          (((PHASE)&1)==0)
+
+/**
+ * @brief   Flags for DVFS_Stop
+ *
+ * @note    Both reduce the consumption in Stop mode and increase the wakeup
+ *          time (see the datasheet, tWUSTOP)
+ */
+///@{
+#define DVFS_STOP_LPREGULATOR       0x1     ///< regulator in low power mode (LPDS)
+#define DVFS_STOP_FLASHPOWERDOWN    0x2     ///< flash in power down (FPDS)
+///@}
+
+/**
+ * @brief   Stop mode statistics
+ *
+ * @note    The resume time is measured from the first instruction after the
+ *          wakeup until the end of the POSTSTOP callbacks. It does not include
+ *          the wakeup of the regulator and the flash (tWUSTOP)
+ */
+typedef struct {
+    uint32_t    stops;
+    uint32_t    resumelast;                 ///< us
+    uint32_t    resumemax;                  ///< us
+    uint32_t    clocklast;                  ///< us, part to restore the clocks
+} DVFS_StopStats;
+
+/**
+ * @brief   Maximal number of callbacks
+ */
+#ifndef DVFS_MAXCALLBACKS
+#define DVFS_MAXCALLBACKS           8
+#endif
+
+typedef void (*DVFS_Callback)(int phase);
+
+int      DVFS_RegisterCallback(DVFS_Callback f);
+int      DVFS_SetOperatingPoint(int op);
+int      DVFS_GetOperatingPoint(void);
+uint32_t DVFS_GetFrequency(int op);
+int      DVFS_Stop(unsigned flags);
+void     DVFS_GetStopStats(DVFS_StopStats *stats);
+
+#endif // DVFS_H
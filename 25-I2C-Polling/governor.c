@@ -0,0 +1,311 @@
+/**
+ * @file    governor.c
+ *
+ * @note    Load driven choice of the operating point (see governor.h)
+ *
+ * @note    The time is measured with the DWT cycle counter, so no timer is
+ *          needed. A window ends when its cycles reach GOVERNOR_WINDOW ms at
+ *          the actual SystemCoreClock. A change of operating point ends the
+ *          window at once, so a window never mixes two frequencies
+ *
+ * @note    Governor_Sleep counts the cycles from WFI until the wakeup, with
+ *          the interrupts masked by PRIMASK, so the interrupt routine that
+ *          wakes the core runs after the count and is load
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "dvfs.h"
+#include "governor.h"
+
+#if (GOVERNOR_LOGSIZE&(GOVERNOR_LOGSIZE-1)) != 0
+#error "GOVERNOR_LOGSIZE must be a power of 2"
+#endif
+
+/**
+ * @brief   State
+ */
+///@{
+static int                  current = -1;       // operating point
+static uint32_t             windowstart = 0;    // DWT->CYCCNT
+static volatile uint32_t    idlecycles = 0;     // in the window
+static uint32_t             lowwindows = 0;     // consecutive, below GOVERNOR_DOWN
+static uint32_t             mstime = 0;         // since Governor_Init
+static uint32_t             floors[GOVERNOR_MAXFLOORS];
+static Governor_Stats       stats;
+///@}
+
+/**
+ * @brief   Transition log (ring)
+ */
+///@{
+static Governor_LogEntry    logtab[GOVERNOR_LOGSIZE];
+static uint32_t             logcount = 0;       // entries written
+///@}
+
+/**
+ * @brief   Ends the window and returns its load in %
+ *
+ * @note    The time of the window is added to the time of the operating point
+ */
+static uint32_t
+CloseWindow(void) {
+uint32_t now = DWT->CYCCNT;
+uint32_t elapsed,idle,ms,load;
+
+    elapsed = now-windowstart;
+    idle    = idlecycles;
+    windowstart = now;
+    idlecycles  = 0;
+
+    ms = elapsed/(SystemCoreClock/1000);
+    mstime += ms;
+    if( current >= 0 && current < DVFS_OPERATINGPOINTS )
+        stats.mstotal[current] += ms;
+
+    if( elapsed == 0 || idle >= elapsed )
+        load = 0;
+    else
+        load = 100-(uint32_t) (((uint64_t) idle*100)/elapsed);
+    return load;
+}
+
+/**
+ * @brief   Slowest operating point whose frequency is not below the floors
+ */
+static int
+FloorPoint(void) {
+int op;
+
+    for(op=GOVERNOR_SLOWEST;op>0;op--) {
+        if( DVFS_GetFrequency(op) >= stats.floor )
+            break;
+    }
+    return op;
+}
+
+/**
+ * @brief   Changes the operating point and logs the transition
+ */
+static int
+Change(int to, uint32_t load, int reason) {
+Governor_LogEntry *e;
+int from = current;
+
+    CloseWindow();
+    if( DVFS_SetOperatingPoint(to) < 0 )
+        return GOVERNOR_ERROR_DVFS;
+    current = to;
+
+    e = &logtab[logcount&(GOVERNOR_LOGSIZE-1)];
+    e->time   = mstime;
+    e->from   = (uint8_t) from;
+    e->to     = (uint8_t) to;
+    e->load   = (uint8_t) load;
+    e->reason = (uint8_t) reason;
+    logcount++;
+
+    if( from >= 0 && to < from )
+        stats.ups++;
+    else if( from >= 0 && to > from )
+        stats.downs++;
+    lowwindows = 0;
+
+    // The change took time with the interrupts disabled: start a new window
+    windowstart = DWT->CYCCNT;
+    idlecycles  = 0;
+    return GOVERNOR_OK;
+}
+
+/**
+ * @brief   Governor_Init
+ *
+ * @note    Enables the cycle counter. Starts at GOVERNOR_FASTEST, unless an
+ *          operating point was already set
+ */
+int
+Governor_Init(void) {
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;                  // Unlock access on Cortex-M7
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    memset(floors,0,sizeof(floors));
+    memset(&stats,0,sizeof(stats));
+    logcount   = 0;
+    lowwindows = 0;
+    mstime     = 0;
+
+    current = DVFS_GetOperatingPoint();
+    windowstart = DWT->CYCCNT;
+    idlecycles  = 0;
+    if( current < 0 )
+        return Change(GOVERNOR_FASTEST,0,GOVERNOR_REASON_INIT);
+    return GOVERNOR_OK;
+}
+
+/**
+ * @brief   Governor_Sleep
+ *
+ * @note    WFI, counting the cycles until the next interrupt as idle
+ */
+void
+Governor_Sleep(void) {
+uint32_t start;
+
+    __disable_irq();
+    start = DWT->CYCCNT;
+    __DSB();
+    __WFI();
+    idlecycles += DWT->CYCCNT-start;
+    __enable_irq();
+}
+
+/**
+ * @brief   Governor_AddIdle
+ *
+ * @note    Idle cycles measured by the caller (not with Governor_Sleep)
+ */
+void
+Governor_AddIdle(uint32_t cycles) {
+
+    idlecycles += cycles;
+}
+
+/**
+ * @brief   Governor_Poll
+ *
+ * @note    Decides at the end of each window. Returns the operating point or
+ *          GOVERNOR_ERROR_DVFS
+ */
+int
+Governor_Poll(void) {
+uint32_t load,expected;
+int target,fl;
+int reason = GOVERNOR_REASON_LOAD;
+
+    if( current < 0 )
+        return GOVERNOR_ERROR_DVFS;
+    if( DWT->CYCCNT-windowstart < (SystemCoreClock/1000)*GOVERNOR_WINDOW )
+        return current;
+
+    load = CloseWindow();
+    stats.windows++;
+    stats.load = load;
+
+    fl = FloorPoint();
+    target = current;
+    if( current > fl ) {
+        target = fl;
+        reason = GOVERNOR_REASON_FLOOR;
+    } else if( load > GOVERNOR_UP ) {
+        lowwindows = 0;
+        if( current > GOVERNOR_FASTEST )
+            target = current-1;
+    } else if( load < GOVERNOR_DOWN ) {
+        if( ++lowwindows >= GOVERNOR_DOWNWINDOWS && current < fl ) {
+            // Same work at the lower frequency
+            expected = (uint32_t) (((uint64_t) load*DVFS_GetFrequency(current))
+                                   /DVFS_GetFrequency(current+1));
+            if( expected < GOVERNOR_UP )
+                target = current+1;
+        }
+    } else {
+        lowwindows = 0;
+    }
+
+    if( target != current && Change(target,load,reason) < 0 )
+        return GOVERNOR_ERROR_DVFS;
+    return current;
+}
+
+/**
+ * @brief   Governor_SetFloor
+ *
+ * @note    Sets the minimal HCLK asked by the client id (0 removes it). When
+ *          the actual frequency is lower, the change is done at once. A lower
+ *          floor lets the governor go down at the next windows
+ */
+int
+Governor_SetFloor(unsigned id, uint32_t hz) {
+uint32_t max = 0;
+unsigned i;
+int fl;
+
+    if( id >= GOVERNOR_MAXFLOORS )
+        return GOVERNOR_ERROR_PARAM;
+    floors[id] = hz;
+    for(i=0;i<GOVERNOR_MAXFLOORS;i++) {
+        if( floors[i] > max )
+            max = floors[i];
+    }
+    stats.floor = max;
+
+    fl = FloorPoint();
+    if( current > fl )
+        return Change(fl,stats.load,GOVERNOR_REASON_FLOOR);
+    return GOVERNOR_OK;
+}
+
+/**
+ * @brief   Governor_GetStats
+ */
+void
+Governor_GetStats(Governor_Stats *s) {
+
+    *s = stats;
+}
+
+/**
+ * @brief   Governor_GetLog
+ *
+ * @note    Copies up to max of the last transitions, the oldest first. Returns
+ *          the number copied
+ */
+int
+Governor_GetLog(Governor_LogEntry *entries, int max) {
+uint32_t n,first,i;
+
+    n = logcount < GOVERNOR_LOGSIZE ? logcount : GOVERNOR_LOGSIZE;
+    if( max < 0 )
+        max = 0;
+    if( n > (uint32_t) max )
+        n = (uint32_t) max;
+    first = logcount-n;
+    for(i=0;i<n;i++)
+        entries[i] = logtab[(first+i)&(GOVERNOR_LOGSIZE-1)];
+    return (int) n;
+}
+
+/**
+ * @brief   Governor_DumpLog
+ *
+ * @note    Prints the transitions in the ring as lines
+ *
+ *          GOVERNOR,time_ms,from_MHz,to_MHz,load,reason
+ */
+void
+Governor_DumpLog(void) {
+static const char *reasons[] = { "load", "floor", "init" };
+Governor_LogEntry e[GOVERNOR_LOGSIZE];
+int i,n;
+
+    n = Governor_GetLog(e,GOVERNOR_LOGSIZE);
+    printf("#governor windows=%lu ups=%lu downs=%lu load=%lu%% floor=%lu Hz\n",
+            (unsigned long) stats.windows,(unsigned long) stats.ups,
+            (unsigned long) stats.downs,(unsigned long) stats.load,
+            (unsigned long) stats.floor);
+    for(i=0;i<n;i++) {
+        printf("GOVERNOR,%lu,%lu,%lu,%u,%s\n",(unsigned long) e[i].time,
+                (unsigned long) DVFS_GetFrequency(e[i].from)/1000000,
+                (unsigned long) DVFS_GetFrequency(e[i].to)/1000000,
+                e[i].load,reasons[e[i].reason]);
+    }
+}
@@ -0,0 +1,117 @@
+#ifndef GOVERNOR_H
+#define GOVERNOR_H
+/**
+ * @file    governor.h
+ *
+ * @note    Load driven choice of the operating point of dvfs.h
+ *
+ * @note    The main loop sleeps with Governor_Sleep (WFI), which counts the
+ *          cycles spent in it, or gives the idle cycles measured elsewhere (the
+ *          sleepcycles of an event loop, the idle task of uC/OS-II) with
+ *          Governor_AddIdle. Governor_Poll, also called in the main loop,
+ *          computes the load (% of the cycles not idle) over each window of
+ *          GOVERNOR_WINDOW ms and
+ *
+ *          - goes one point up (faster) when the load is above GOVERNOR_UP
+ *          - goes one point down when the load was below GOVERNOR_DOWN for
+ *            GOVERNOR_DOWNWINDOWS windows and the load expected at the lower
+ *            frequency is still below GOVERNOR_UP (no ping-pong)
+ *
+ * @note    Drivers that need a minimal HCLK (LTDC pixel clock, USB, a baud
+ *          rate) set a floor with Governor_SetFloor. The governor never goes
+ *          below the highest floor and goes up at once when it is raised
+ *
+ * @note    Each transition is logged (time, from, to, load, reason) in a ring
+ *          of GOVERNOR_LOGSIZE entries, printed by Governor_DumpLog
+ *
+ * @note    Governor_Poll and Governor_SetFloor call DVFS_SetOperatingPoint, so
+ *          they must not be called from interrupts
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "dvfs.h"
+
+/**
+ * @brief   Parameters
+ */
+///@{
+#ifndef GOVERNOR_WINDOW
+#define GOVERNOR_WINDOW             100     ///< ms
+#endif
+#ifndef GOVERNOR_UP
+#define GOVERNOR_UP                 80      ///< % of load to go up
+#endif
+#ifndef GOVERNOR_DOWN
+#define GOVERNOR_DOWN               30      ///< % of load to go down
+#endif
+#ifndef GOVERNOR_DOWNWINDOWS
+#define GOVERNOR_DOWNWINDOWS        5       ///< windows below GOVERNOR_DOWN
+#endif
+#ifndef GOVERNOR_FASTEST
+#define GOVERNOR_FASTEST            DVFS_200MHZ
+#endif
+#ifndef GOVERNOR_SLOWEST
+#define GOVERNOR_SLOWEST            DVFS_50MHZ
+#endif
+#ifndef GOVERNOR_MAXFLOORS
+#define GOVERNOR_MAXFLOORS          4       ///< floor ids 0 to GOVERNOR_MAXFLOORS-1
+#endif
+#ifndef GOVERNOR_LOGSIZE
+#define GOVERNOR_LOGSIZE            32      ///< power of 2
+#endif
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define GOVERNOR_OK                 (0)
+#define GOVERNOR_ERROR_PARAM        (-1)
+#define GOVERNOR_ERROR_DVFS         (-2)    ///< DVFS_SetOperatingPoint failed
+///@}
+
+/**
+ * @brief   Reasons of a transition
+ */
+///@{
+#define GOVERNOR_REASON_LOAD        0       ///< load above GOVERNOR_UP or below GOVERNOR_DOWN
+#define GOVERNOR_REASON_FLOOR       1       ///< floor raised
+#define GOVERNOR_REASON_INIT        2
+///@}
+
+/**
+ * @brief   Log entry
+ */
+typedef struct {
+    uint32_t    time;                       ///< ms since Governor_Init
+    uint8_t     from;                       ///< operating point
+    uint8_t     to;
+    uint8_t     load;                       ///< % of the last window
+    uint8_t     reason;
+} Governor_LogEntry;
+
+/**
+ * @brief   Statistics
+ */
+typedef struct {
+    uint32_t    windows;
+    uint32_t    ups;
+    uint32_t    downs;
+    uint32_t    load;                       ///< % of the last window
+    uint32_t    floor;                      ///< Hz, highest floor
+    uint32_t    mstotal[DVFS_OPERATINGPOINTS]; ///< ms at each operating point
+} Governor_Stats;
+
+int  Governor_Init(void);
+void Governor_Sleep(void);
+void Governor_AddIdle(uint32_t cycles);
+int  Governor_Poll(void);
+int  Governor_SetFloor(unsigned id, uint32_t hz);
+void Governor_GetStats(Governor_Stats *s);
+int  Governor_GetLog(Governor_LogEntry *entries, int max);
+void Governor_DumpLog(void);
+
+#endif // GOVERNOR_H
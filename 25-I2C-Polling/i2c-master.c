@@ -20,6 +20,7 @@
 #include "system_stm32f746.h"
 #include "i2c-master.h"
 #include "gpio.h"
+#include "dvfs.h"
 
 
 
@@ -154,9 +155,11 @@
  *
  * This can be overided by specifying a non zero timing parameter
  *
- * It is not a good idea to calculate this (constant) parameter during execution.
- * This will demand unnecessarily RAM, Flash and floating point (or at least, a boring
- * fixed point) calculation.
+ * When the I2CCLK frequency is fixed, a constant parameter is the best choice.
+ * But the kernel clock can change with SystemSetCoreClockFrequency (APB1 or SYSCLK
+ * as source) and the table does not cover all combinations. So, when timing is 0,
+ * I2CMaster_Init calculates it (integer arithmetic) for the actual clock using
+ * I2CMaster_CalculateTiming below and uses the table only when it fails.
  */
 
 /**
@@ -248,18 +251,23 @@ static const I2C_Configuration_t i2c_configuration[] = {
 };
 
 /**
- * @brief Data structure to store run time info. For now, only status
+ * @brief Data structure to store run time info
+ *
+ * @note  conf and kernelfreq are used to recalculate the timing when the clock
+ *        changes. kernelfreq is 0 when the timing was given to I2CMaster_Init
  */
 ///@{
 typedef struct {
     I2C_TypeDef                *i2c;
     I2C_Status_t                status;
+    uint32_t                    conf;
+    uint32_t                    kernelfreq;
 } RunTimeInfo_t;
 
 static RunTimeInfo_t  RunTimeInfo[] = {
-    { I2C1,  I2C_UNINITIALIZED },
-    { I2C3,  I2C_UNINITIALIZED },
-    {    0,  I2C_UNINITIALIZED }
+    { I2C1,  I2C_UNINITIALIZED, 0, 0 },
+    { I2C3,  I2C_UNINITIALIZED, 0, 0 },
+    {    0,  I2C_UNINITIALIZED, 0, 0 }
 };
 ///@}
 
@@ -558,6 +566,187 @@ struct Default_Timing_t *pTiming;
 }
 
 
+/**
+ * @brief  I2C bus characteristics (RM Tables 178 and 180), in ns
+ */
+struct I2C_BusTiming_t {
+    uint32_t    speed;          // SCL frequency (Hz)
+    uint32_t    tlowmin;
+    uint32_t    thighmin;
+    uint32_t    thddatmax;      // tVD;DAT max
+    uint32_t    tsudatmin;
+    uint32_t    minclock;       // Minimal I2CCLK (Hz) with an analog filter
+};
+
+static const struct I2C_BusTiming_t bus_timing[] = {
+/*      Speed    tLOW  tHIGH tHDDAT tSUDAT  I2CCLK  */
+    {  100000,   4700,  4000,  3450,  250,   2000000 },  // Standard
+    {  400000,   1300,   600,   900,  100,  10000000 },  // Fast
+    { 1000000,    500,   260,   450,   50,  22500000 },  // Fast plus
+};
+
+/**
+ * @brief  Analog filter delays (ns). See tAF table above
+ */
+#define TAFMIN              (50)
+#define TAFMAX              (150)
+
+/**
+ * @brief  Integer division rounding up
+ */
+#define DIVCEIL(A,B)        (((A)+(B)-1)/(B))
+
+/**
+ * @brief  I2CMaster_CalculateTiming
+ *
+ * @note   Computes TIMINGR for a I2CCLK frequency freq (Hz), the speed mode and the
+ *         filter in conf (I2C_CONF_MODE_*, I2C_CONF_FILTER_*) and the rise and fall
+ *         times of the bus, tr and tf (ns). It follows RM Section 30.4.9:
+ *
+ *       SDADEL >= (tf+tHDDATmin-tAFmin-(DNF+3)*tI2CCLK)/((PRESC+1)*tI2CCLK)
+ *       SDADEL <= (tVDDATmax-tr-tAFmax-(DNF+4)*tI2CCLK)/((PRESC+1)*tI2CCLK)
+ *       SCLDEL >= (tr+tSUDATmin)/((PRESC+1)*tI2CCLK)-1
+ *       tSCL    = tSYNC1+tSYNC2+(SCLL+1+SCLH+1)*(PRESC+1)*tI2CCLK
+ *
+ *         where tSYNCx = tf or tr + tAF + (DNF+2)*tI2CCLK. The smallest PRESC
+ *         that satisfies all constraints is used, giving the best resolution.
+ *         SCL frequency is at most the nominal one.
+ *
+ * @note   Times are calculated in ps, so the 32 bit arithmetic does not overflow
+ *         for clocks up to 216 MHz at 100 KHz.
+ *
+ * @return TIMINGR or 0 when there is no solution
+ */
+uint32_t
+I2CMaster_CalculateTiming( uint32_t freq, uint32_t conf, uint32_t tr, uint32_t tf ) {
+const struct I2C_BusTiming_t *bt;
+uint32_t tclk,tpresc,period,tsync,total;
+int32_t sdadelmin,sdadelmax;
+uint32_t presc,scldel,sdadel,scll,sclh,lowmin,highmin;
+uint32_t mode,filter,dnf,tafmin,tafmax;
+
+    mode = conf&I2C_CONF_MODE_MASK;
+    if( mode > I2C_CONF_MODE_FASTPLUS || freq == 0 )
+        return 0;
+    bt = &bus_timing[mode>>I2C_CONF_MODE_Pos];
+
+    filter = conf&I2C_CONF_FILTER_MASK;
+    tafmin = tafmax = 0;
+    if( filter == I2C_CONF_FILTER_ANALOG || filter == I2C_CONF_FILTER_BOTH ) {
+        tafmin = TAFMIN;
+        tafmax = TAFMAX;
+        if( freq < bt->minclock )
+            return 0;
+    }
+    dnf = 0;
+    if( filter == I2C_CONF_FILTER_DIGITAL || filter == I2C_CONF_FILTER_BOTH )
+        dnf = (conf&I2C_CONF_FILTER_DNF_MASK)>>I2C_CONF_FILTER_DNF_Pos;
+
+    if( bt->thddatmax <= tr+tafmax )
+        return 0;
+
+    tclk   = DIVCEIL(1000000000UL,freq/1000);           // ps
+    period = 1000000000UL/(bt->speed/1000);             // ps
+    tsync  = (tr+tf+2*tafmin)*1000+2*(dnf+2)*tclk;      // tSYNC1+tSYNC2
+    if( tsync >= period )
+        return 0;
+
+    for(presc=0;presc<16;presc++) {
+        tpresc = (presc+1)*tclk;
+
+        // Data setup and hold
+        sdadelmin = (int32_t) ((tf+tafmin)*1000)-(int32_t) ((dnf+3)*tclk);
+        sdadelmin = sdadelmin <= 0 ? 0 : (int32_t) DIVCEIL((uint32_t) sdadelmin,tpresc);
+        sdadelmax = (int32_t) ((bt->thddatmax-tr-tafmax)*1000)-(int32_t) ((dnf+4)*tclk);
+        if( sdadelmax < 0 )
+            continue;
+        sdadelmax = sdadelmax/tpresc;
+        if( sdadelmin > 15 || sdadelmin > sdadelmax )
+            continue;
+        sdadel = sdadelmin;
+
+        scldel = DIVCEIL((tr+bt->tsudatmin)*1000,tpresc);
+        scldel = scldel > 0 ? scldel-1 : 0;
+        if( scldel > 15 )
+            continue;
+
+        // SCL low and high periods
+        lowmin  = DIVCEIL(bt->tlowmin*1000,tpresc);
+        highmin = DIVCEIL(bt->thighmin*1000,tpresc);
+        total   = DIVCEIL(period-tsync,tpresc);
+        if( total < lowmin+highmin )
+            total = lowmin+highmin;
+        // Extra cycles go to the low period, that has the longest minimum
+        sclh = highmin;
+        scll = total-sclh;
+        if( scll > 256 || sclh > 256 )
+            continue;
+
+        return (presc<<I2C_TIMINGR_PRESC_Pos)
+              |(scldel<<I2C_TIMINGR_SCLDEL_Pos)
+              |(sdadel<<I2C_TIMINGR_SDADEL_Pos)
+              |((sclh-1)<<I2C_TIMINGR_SCLH_Pos)
+              |((scll-1)<<I2C_TIMINGR_SCLL_Pos);
+    }
+    return 0;
+}
+
+/**
+ * @brief  Get I2CCLK frequency
+ *
+ * @note   Reads the actual source from RCC->DCKCFGR2, so it follows changes done
+ *         by SystemSetCoreClockFrequency
+ */
+static uint32_t I2CMaster_GetKernelClockFrequency( I2C_TypeDef *i2c ) {
+uint32_t sel;
+
+    if ( i2c == I2C1 ) {
+        sel = (RCC->DCKCFGR2&RCC_DCKCFGR2_I2C1SEL_Msk)>>RCC_DCKCFGR2_I2C1SEL_Pos;
+    } else if ( i2c == I2C2 ) {
+        sel = (RCC->DCKCFGR2&RCC_DCKCFGR2_I2C2SEL_Msk)>>RCC_DCKCFGR2_I2C2SEL_Pos;
+    } else if ( i2c == I2C3 ) {
+        sel = (RCC->DCKCFGR2&RCC_DCKCFGR2_I2C3SEL_Msk)>>RCC_DCKCFGR2_I2C3SEL_Pos;
+    } else if ( i2c == I2C4 ) {
+        sel = (RCC->DCKCFGR2&RCC_DCKCFGR2_I2C4SEL_Msk)>>RCC_DCKCFGR2_I2C4SEL_Pos;
+    } else {
+        return 0;
+    }
+    switch(sel) {
+    case 0:  return SystemGetAPB1Frequency();
+    case 1:  return SystemGetSYSCLKFrequency();
+    case 2:  return HSI_FREQ;
+    }
+    return 0;
+}
+
+/**
+ * @brief  Fast mode plus drive capability
+ *
+ * @note   Fm+ needs the 20 mA drive of the I/O. It is enabled for the whole
+ *         I2C in SYSCFG->PMC (I2Cx_FMP bits)
+ */
+static void I2CMaster_SetFastModePlus( I2C_TypeDef *i2c, int on ) {
+uint32_t mask;
+
+    if ( i2c == I2C1 ) {
+        mask = SYSCFG_PMC_I2C1_FMP;
+    } else if ( i2c == I2C2 ) {
+        mask = SYSCFG_PMC_I2C2_FMP;
+    } else if ( i2c == I2C3 ) {
+        mask = SYSCFG_PMC_I2C3_FMP;
+    } else if ( i2c == I2C4 ) {
+        mask = SYSCFG_PMC_I2C4_FMP;
+    } else {
+        return;
+    }
+    RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;
+    if( on )
+        SYSCFG->PMC |= mask;
+    else
+        SYSCFG->PMC &= ~mask;
+}
+
+
 /**
  *  @brief  I2CMaster_Init
  *
@@ -567,6 +756,8 @@ struct Default_Timing_t *pTiming;
  */
 int
 I2CMaster_Init( I2C_TypeDef *i2c, uint32_t conf, uint32_t timing) {
+RunTimeInfo_t *p;
+uint32_t kernelfreq;
 int index;
 
 
@@ -587,13 +778,21 @@ int index;
     // Configure pins
     I2CMaster_ConfigurePins(i2c);
 
-    // If timing parameter = 0, try to find one in the table
+    // If timing parameter = 0, calculate it for the actual clock or find one in the table
+    kernelfreq = 0;
     if( timing == 0 ) {
-        timing = GetPreCalculatedTiming(conf);
+        kernelfreq = I2CMaster_GetKernelClockFrequency(i2c);
+        timing = I2CMaster_CalculateTiming(kernelfreq,conf,I2C_RISETIME,I2C_FALLTIME);
+        if( timing == 0 ) {
+            kernelfreq = 0;
+            timing = GetPreCalculatedTiming(conf);
+        }
         if( timing == 0 )
-            return 0;  /* Could not find a pre calculated timing */
+            return 0;  /* Could not find a timing */
     }
 
+    I2CMaster_SetFastModePlus(i2c,(conf&I2C_CONF_MODE_MASK) == I2C_CONF_MODE_FASTPLUS);
+
     uint32_t dnf = (conf&I2C_CONF_FILTER_DNF_MASK)>>I2C_CONF_FILTER_DNF_Pos;
     // Configure filters
     if( (conf&I2C_CONF_FILTER_NONE)!=0 ) {
@@ -662,9 +861,51 @@ int index;
     // Set flag to Ready
     I2CMaster_SetStatus(i2c,I2C_READY);
 
+    // Store info for clock changes
+    p = FindRunTimeInfo(i2c);
+    if( p ) {
+        p->conf       = conf;
+        p->kernelfreq = kernelfreq;
+    }
+
     return timing;
 }
 
+/**
+ *  @brief  I2CMaster_ClockChange
+ *
+ *  @note   Clock change callback (see dvfs.h). Before the change, it waits until
+ *          the bus is free. After it, when the I2CCLK frequency changed, TIMINGR
+ *          is recalculated. It can only be written with PE cleared
+ *
+ *  @note   Only the I2Cs whose timing was calculated by I2CMaster_Init are
+ *          affected. The default I2CCLK (HSI) does not change
+ */
+void
+I2CMaster_ClockChange( int phase ) {
+RunTimeInfo_t *p;
+uint32_t freq,timing;
+
+    for(p=RunTimeInfo;p->i2c;p++) {
+        if( p->status == I2C_UNINITIALIZED || p->kernelfreq == 0 )
+            continue;
+        if( DVFS_BEFORE(phase) ) {
+            while( (p->i2c->ISR&I2C_ISR_BUSY) != 0 ) {}
+        } else {
+            freq = I2CMaster_GetKernelClockFrequency(p->i2c);
+            if( freq == p->kernelfreq )
+                continue;
+            timing = I2CMaster_CalculateTiming(freq,p->conf,I2C_RISETIME,I2C_FALLTIME);
+            if( timing == 0 )
+                continue;
+            I2CMaster_Disable(p->i2c);
+            p->i2c->TIMINGR = timing;
+            I2CMaster_Enable(p->i2c);
+            p->kernelfreq = freq;
+        }
+    }
+}
+
 
 /**
  * @brief  I2C Master detects a slave
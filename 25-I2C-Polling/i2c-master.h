@@ -71,6 +71,20 @@ typedef enum {
         I2C_ERROR = 7
      } I2C_Status_t;
 
+/**
+ * @brief   Rise and fall times of the bus (ns) used to calculate the timing
+ *
+ * @note    They depend on the pull-up resistors and the bus capacitance
+ */
+///@{
+#ifndef I2C_RISETIME
+#define I2C_RISETIME                 (100)
+#endif
+#ifndef I2C_FALLTIME
+#define I2C_FALLTIME                 (10)
+#endif
+///@}
+
 /* Function prototypes */
 
 int I2CMaster_Init(         I2C_TypeDef *i2c,
@@ -78,6 +92,13 @@ int I2CMaster_Init(         I2C_TypeDef *i2c,
                             uint32_t timing
                             );
 
+uint32_t I2CMaster_CalculateTiming(
+                            uint32_t freq,
+                            uint32_t conf,
+                            uint32_t tr,
+                            uint32_t tf
+                            );
+
 int I2CMaster_Write(        I2C_TypeDef *i2c,
                             uint16_t address,
                             uint8_t *data,
@@ -102,5 +123,7 @@ int I2CMaster_Detect(       I2C_TypeDef *i2c,
 I2C_Status_t
 I2CMaster_GetStatus(        I2C_TypeDef *i2c );
 
+void I2CMaster_ClockChange( int phase );
+
 
 #endif // I2C_MASTER_H
@@ -19,9 +19,15 @@
 #include "system_stm32f746.h"
 #include "led.h"
 #include "i2c-master.h"
+#include "uart.h"
+#include "sdram.h"
+#include "dvfs.h"
+#ifdef USE_GOVERNORDEMO
+#include "governor.h"
+#endif
 
 
-#define OPERATING_FREQUENCY (200000000)
+#define OPERATING_POINT     DVFS_200MHZ
 
 /**
  * @brief   Quick and dirty delay routine
@@ -54,6 +60,138 @@ void ms_delay(volatile int ms) {
 #define TOUCH_ADDR              0x38
 #define AUDIO_ADDR              0x1A
 
+#ifdef USE_STOPDEMO
+/**
+ * @brief   Stop mode demo
+ *
+ * @note    The user button (PI11, high when pressed) wakes the core through
+ *          EXTI line 11. A pattern written in the SDRAM is checked after each
+ *          wakeup, since it is kept in self-refresh during Stop mode
+ */
+///@{
+#define BUTTON_LINE             11
+#define PATTERN_WORDS           16384
+#define PATTERN(I)              (0xA5000000U^((I)*2654435761U))
+
+void EXTI15_10_IRQHandler(void) {
+
+    EXTI->PR = 1U<<BUTTON_LINE;
+}
+
+static void
+ButtonInit(void) {
+
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOIEN;
+    RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;
+    __DSB();
+
+    GPIOI->MODER &= ~(3U<<(2*BUTTON_LINE));             // Input
+    SYSCFG->EXTICR[2] = (SYSCFG->EXTICR[2]&~SYSCFG_EXTICR3_EXTI11)
+                        |SYSCFG_EXTICR3_EXTI11_PI;
+    EXTI->RTSR |= 1U<<BUTTON_LINE;                      // On press
+    EXTI->IMR  |= 1U<<BUTTON_LINE;
+    EXTI->PR    = 1U<<BUTTON_LINE;
+    NVIC_EnableIRQ(EXTI15_10_IRQn);
+}
+
+static void
+StopTest(void) {
+volatile uint32_t *sdram = (volatile uint32_t *) SDRAM_ADDRESS;
+DVFS_StopStats stats;
+uint32_t i,errors;
+
+    for(i=0;i<PATTERN_WORDS;i++)
+        sdram[i] = PATTERN(i);
+
+    printf("Stop mode. Press the user button\n");
+    DVFS_Stop(DVFS_STOP_LPREGULATOR);
+
+    errors = 0;
+    for(i=0;i<PATTERN_WORDS;i++) {
+        if( sdram[i] != PATTERN(i) )
+            errors++;
+    }
+    DVFS_GetStopStats(&stats);
+    printf("Wakeup %lu: resume %lu us (clocks %lu us, max %lu us), SDRAM errors %lu\n",
+            stats.stops,stats.resumelast,stats.clocklast,stats.resumemax,errors);
+}
+///@}
+#endif
+
+#ifdef USE_GOVERNORDEMO
+/**
+ * @brief   Governor demo
+ *
+ * @note    Every ms, the SysTick wakes the main loop, which does some work and
+ *          sleeps (Governor_Sleep). The work is a number of cycles, so it takes
+ *          longer at a lower frequency. It changes every 5 s
+ *
+ *          | Phase | Cycles/ms | Load at 200 MHz | Expected point           |
+ *          |-------|-----------|-----------------|--------------------------|
+ *          | 0     | 10000     | 5%              | 50 MHz (20%)             |
+ *          | 1     | 140000    | 70%             | 200 MHz                  |
+ *          | 2     | 40000     | 20%             | 100 MHz (40%)            |
+ *          | 3     | 10000     | 5%              | 100 MHz, floor of 100 MHz|
+ *
+ *          The transitions are printed every 20 s
+ */
+///@{
+#define FLOOR_DEMO              0           // floor id
+
+static volatile uint32_t tick_ms = 0;
+
+void SysTick_Handler(void) {
+
+    tick_ms++;
+}
+
+static void
+Work(uint32_t cycles) {
+uint32_t start = DWT->CYCCNT;
+
+    while( DWT->CYCCNT-start < cycles ) {}
+}
+
+static void
+GovernorDemo(void) {
+static const uint32_t work[] = { 10000, 140000, 40000, 10000 };
+Governor_Stats st;
+uint32_t lastms = 0;
+int phase = -1;
+int op;
+
+    SysTick_Config(SystemCoreClock/1000);
+    if( Governor_Init() < 0 )
+        printf("Governor not initialized\n");
+
+    for(;;) {
+        Governor_Sleep();
+        if( tick_ms == lastms )
+            continue;
+        lastms = tick_ms;
+
+        if( (lastms%5000) == 0 || phase < 0 ) {
+            phase = (lastms/5000)%4;
+            Governor_SetFloor(FLOOR_DEMO,phase == 3 ? 100000000 : 0);
+        }
+        Work(work[phase]);
+
+        if( (lastms%500) == 0 )
+            LED_Toggle();
+        op = Governor_Poll();
+        if( (lastms%20000) == 0 ) {
+            Governor_GetStats(&st);
+            printf("Point %d (%lu MHz), ms at 216/200/100/50 MHz: %lu %lu %lu %lu\n",op,
+                    (unsigned long) SystemCoreClock/1000000,
+                    (unsigned long) st.mstotal[0],(unsigned long) st.mstotal[1],
+                    (unsigned long) st.mstotal[2],(unsigned long) st.mstotal[3]);
+            Governor_DumpLog();
+        }
+    }
+}
+///@}
+#endif
+
 /**
  * @brief   main
  *
@@ -66,7 +204,22 @@ int main(void) {
 int rc;
 
     printf("Starting.....\n");
-    SystemSetCoreClockFrequency(OPERATING_FREQUENCY);
+
+    /*
+     * Drivers that must follow the clock changes
+     */
+    DVFS_RegisterCallback(UART_ClockChange);
+    DVFS_RegisterCallback(I2CMaster_ClockChange);
+    DVFS_RegisterCallback(SDRAM_ClockChange);
+    DVFS_SetOperatingPoint(OPERATING_POINT);
+
+#ifdef USE_STOPDEMO
+    // HCLK must be 200 MHz
+    rc = SDRAM_Init();
+    if( rc < 0 )
+        printf("SDRAM Error (%d)\n",rc);
+    ButtonInit();
+#endif
 
     LED_Init();
 
@@ -96,11 +249,39 @@ int rc;
      } else {
         printf("OK\n");
      }
+#ifdef USE_GOVERNORDEMO
+    GovernorDemo();
+#endif
      /*
       * Blink
       */
     for (;;) {
        ms_delay(500);
        LED_Toggle();
+#ifdef USE_DVFSDEMO
+       /*
+        * Every 10 toggles, go to the next operating point and test the I2C
+        */
+       static int cnt = 0, op = OPERATING_POINT;
+       if( ++cnt == 10 ) {
+           cnt = 0;
+           if( DVFS_GetFrequency(++op) == 0 )
+               op = 0;
+           DVFS_SetOperatingPoint(op);
+           rc = I2CMaster_Detect(I2C3,TOUCH_ADDR);
+           printf("%lu MHz: Touch Controller %s\n",(unsigned long) SystemCoreClock/1000000,
+                                                   rc<0?"not detected":"OK");
+       }
+#endif
+#ifdef USE_STOPDEMO
+       /*
+        * Every 10 toggles, enter Stop mode until the button is pressed
+        */
+       static int stopcnt = 0;
+       if( ++stopcnt == 10 ) {
+           stopcnt = 0;
+           StopTest();
+       }
+#endif
     }
 }
@@ -0,0 +1,410 @@
+#ifndef PERIPH_HPP
+#define PERIPH_HPP
+/**
+ * @file    periph.hpp
+ *
+ * @brief   C++17 wrappers for GPIO pins, UARTs and I2C masters with the
+ *          configuration as template parameters
+ *
+ * @note    The register values (masks, BRR, TIMINGR, ...) are constexpr, so they
+ *          are calculated by the compiler, and a configuration that can not work
+ *          (baud rate out of range, no TIMINGR for the I2C speed) is a compile
+ *          error. All functions are static and inline and access the registers
+ *          directly, except the I2C functions, that call i2c-master.c with a
+ *          constant pointer and the precalculated timing
+ *
+ * @note    Template arguments must be constant expressions and the CMSIS
+ *          pointers (GPIOI, I2C1, ...) are casts, so ports are given by the
+ *          Port enumeration and UARTs and I2Cs by their number
+ *
+ *          GpioPin<Port::I,1>              led;            // green LED
+ *          Uart<1,115200,Over8>            console;        // ST-Link VCP
+ *          I2cMaster<1,FastModePlus>       ext;            // Arduino connector
+ *
+ * @note    The constructors of Uart and I2cMaster initialize the peripheral.
+ *          The startup code does not run the constructors of global objects
+ *          (there is no call of the init_array), so the objects must be local
+ *          to main or init() must be called
+ *
+ * @note    The kernel clock of the UARTs and I2Cs is HSI (16 MHz) or LSE, that
+ *          do not change with SystemSetCoreClockFrequency, so BRR and TIMINGR
+ *          can be constants. For APB or SYSCLK as kernel clock, use the C
+ *          drivers (uart2.c and i2c-master.c follow the clock changes)
+ *
+ * @note    Compile with -std=c++17 -fno-exceptions -fno-rtti
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+
+extern "C" {
+#include "i2c-master.h"
+}
+
+namespace stm32 {
+
+/**
+ * @brief   GPIO ports (base addresses)
+ */
+enum class Port : uint32_t {
+    A = GPIOA_BASE, B = GPIOB_BASE, C = GPIOC_BASE, D = GPIOD_BASE,
+    E = GPIOE_BASE, F = GPIOF_BASE, G = GPIOG_BASE, H = GPIOH_BASE,
+    I = GPIOI_BASE, J = GPIOJ_BASE, K = GPIOK_BASE
+};
+
+/**
+ * @brief   Output speed and pull-up/pull-down (values of OSPEEDR and PUPDR)
+ */
+///@{
+enum class Speed : uint32_t { Low = 0, Medium = 1, High = 2, VeryHigh = 3 };
+enum class Pull  : uint32_t { None = 0, Up = 1, Down = 2 };
+///@}
+
+/**
+ * @brief   GPIO pin
+ *
+ * @note    set, clear and write use BSRR, so they do not need a read-modify-write
+ *          and can be used in interrupts
+ */
+template<Port P, unsigned N>
+class GpioPin {
+    static_assert(N < 16, "GPIO pin must be 0 to 15");
+
+    static constexpr uint32_t base      = static_cast<uint32_t>(P);
+    static constexpr uint32_t field2    = 3UL<<(2*N);           // MODER, OSPEEDR, PUPDR
+    static constexpr uint32_t afindex   = N/8;
+    static constexpr uint32_t afpos     = 4*(N%8);
+
+    static constexpr uint32_t MODE_INPUT     = 0;
+    static constexpr uint32_t MODE_OUTPUT    = 1;
+    static constexpr uint32_t MODE_ALTERNATE = 2;
+
+public:
+    static constexpr uint32_t mask      = 1UL<<N;
+    static constexpr uint32_t clockmask = 1UL<<((base-GPIOA_BASE)/(GPIOB_BASE-GPIOA_BASE));
+
+    static GPIO_TypeDef *regs() { return reinterpret_cast<GPIO_TypeDef *>(base); }
+
+    static void enableClock() {
+        RCC->AHB1ENR |= clockmask;
+        __DSB();
+    }
+
+    static void configure(uint32_t mode, bool opendrain, Speed speed, Pull pull, uint32_t af) {
+        GPIO_TypeDef *gpio = regs();
+
+        enableClock();
+        gpio->AFR[afindex] = (gpio->AFR[afindex]&~(0xFUL<<afpos))|(af<<afpos);
+        gpio->OSPEEDR = (gpio->OSPEEDR&~field2)|(static_cast<uint32_t>(speed)<<(2*N));
+        gpio->PUPDR   = (gpio->PUPDR&~field2)|(static_cast<uint32_t>(pull)<<(2*N));
+        gpio->OTYPER  = (gpio->OTYPER&~mask)|(opendrain?mask:0);
+        gpio->MODER   = (gpio->MODER&~field2)|(mode<<(2*N));
+    }
+
+    static void input(Pull pull = Pull::None) {
+        configure(MODE_INPUT,false,Speed::Low,pull,0);
+    }
+
+    static void output(bool initial = false, Speed speed = Speed::Low) {
+        write(initial);                             // no glitch when mode changes
+        configure(MODE_OUTPUT,false,speed,Pull::None,0);
+    }
+
+    static void alternate(uint32_t af, bool opendrain = false,
+                          Speed speed = Speed::High, Pull pull = Pull::None) {
+        configure(MODE_ALTERNATE,opendrain,speed,pull,af);
+    }
+
+    static void set()           { regs()->BSRR = mask; }
+    static void clear()         { regs()->BSRR = mask<<16; }
+    static void write(bool v)   { regs()->BSRR = v ? mask : mask<<16; }
+    static bool read()          { return (regs()->IDR&mask) != 0; }
+
+    static void toggle() {
+        uint32_t odr = regs()->ODR;
+        regs()->BSRR = ((odr&mask)<<16)|(~odr&mask);
+    }
+};
+
+/**
+ * @brief   UART oversampling and kernel clock (UARTxSEL in RCC->DCKCFGR2)
+ */
+///@{
+enum Oversampling { Over16 = 0, Over8 = 1 };
+enum class UartClock : uint32_t { Hsi = 2, Lse = 3 };
+///@}
+
+namespace detail {
+
+/**
+ * @brief   UARTs of the board (same pins as uarttab in uart2.c)
+ */
+struct UartInfo {
+    uint32_t    base;
+    bool        apb2;                       // enable bit in APB2ENR, else APB1ENR
+    uint32_t    enable;
+    Port        txport;
+    unsigned    txpin;
+    unsigned    txaf;
+    Port        rxport;
+    unsigned    rxpin;
+    unsigned    rxaf;
+};
+
+inline constexpr UartInfo uartinfo[] = {
+/*    Device        APB2    Enable                  TX             RX           */
+    { USART1_BASE,  true,   RCC_APB2ENR_USART1EN,   Port::A, 9,7,  Port::B, 7,7 },
+    { USART2_BASE,  false,  RCC_APB1ENR_USART2EN,   Port::A, 2,7,  Port::A, 3,7 },
+    { USART3_BASE,  false,  RCC_APB1ENR_USART3EN,   Port::D, 8,7,  Port::D, 9,7 },
+    { UART4_BASE,   false,  RCC_APB1ENR_UART4EN,    Port::C,10,8,  Port::C,11,8 },
+    { UART5_BASE,   false,  RCC_APB1ENR_UART5EN,    Port::C,12,7,  Port::D, 2,8 },
+    { USART6_BASE,  true,   RCC_APB2ENR_USART6EN,   Port::C, 6,8,  Port::C, 7,8 },
+    { UART7_BASE,   false,  RCC_APB1ENR_UART7EN,    Port::E, 8,8,  Port::E, 7,8 },
+    { UART8_BASE,   false,  RCC_APB1ENR_UART8EN,    Port::E, 1,8,  Port::E, 0,8 },
+};
+
+/**
+ * @brief   Same calculation as I2CMaster_CalculateTiming (i2c-master.c)
+ *
+ * @note    Returns TIMINGR or 0 when there is no solution
+ */
+constexpr uint32_t
+i2cTiming(uint32_t freq, uint32_t conf, uint32_t tr, uint32_t tf) {
+    // Speed, tLOW, tHIGH, tVDDAT, tSUDAT (ns) and minimal I2CCLK with analog filter
+    constexpr uint32_t bus[3][6] = {
+        {  100000,   4700,  4000,  3450,  250,   2000000 },
+        {  400000,   1300,   600,   900,  100,  10000000 },
+        { 1000000,    500,   260,   450,   50,  22500000 },
+    };
+    constexpr uint32_t TAFMIN = 50;
+    constexpr uint32_t TAFMAX = 150;
+    auto divceil = [](uint32_t a, uint32_t b) { return (a+b-1)/b; };
+
+    uint32_t mode = conf&I2C_CONF_MODE_MASK;
+    if( mode > I2C_CONF_MODE_FASTPLUS || freq == 0 )
+        return 0;
+    const uint32_t *bt = bus[mode>>I2C_CONF_MODE_Pos];
+
+    uint32_t filter = conf&I2C_CONF_FILTER_MASK;
+    uint32_t tafmin = 0, tafmax = 0;
+    if( filter == I2C_CONF_FILTER_ANALOG || filter == I2C_CONF_FILTER_BOTH ) {
+        tafmin = TAFMIN;
+        tafmax = TAFMAX;
+        if( freq < bt[5] )
+            return 0;
+    }
+    uint32_t dnf = 0;
+    if( filter == I2C_CONF_FILTER_DIGITAL || filter == I2C_CONF_FILTER_BOTH )
+        dnf = (conf&I2C_CONF_FILTER_DNF_MASK)>>I2C_CONF_FILTER_DNF_Pos;
+
+    if( bt[3] <= tr+tafmax )
+        return 0;
+
+    uint32_t tclk   = divceil(1000000000UL,freq/1000);          // ps
+    uint32_t period = 1000000000UL/(bt[0]/1000);                // ps
+    uint32_t tsync  = (tr+tf+2*tafmin)*1000+2*(dnf+2)*tclk;
+    if( tsync >= period )
+        return 0;
+
+    for(uint32_t presc=0;presc<16;presc++) {
+        uint32_t tpresc = (presc+1)*tclk;
+
+        int32_t sdadelmin = (int32_t) ((tf+tafmin)*1000)-(int32_t) ((dnf+3)*tclk);
+        sdadelmin = sdadelmin <= 0 ? 0 : (int32_t) divceil((uint32_t) sdadelmin,tpresc);
+        int32_t sdadelmax = (int32_t) ((bt[3]-tr-tafmax)*1000)-(int32_t) ((dnf+4)*tclk);
+        if( sdadelmax < 0 )
+            continue;
+        sdadelmax = sdadelmax/(int32_t) tpresc;
+        if( sdadelmin > 15 || sdadelmin > sdadelmax )
+            continue;
+        uint32_t sdadel = sdadelmin;
+
+        uint32_t scldel = divceil((tr+bt[4])*1000,tpresc);
+        scldel = scldel > 0 ? scldel-1 : 0;
+        if( scldel > 15 )
+            continue;
+
+        uint32_t lowmin  = divceil(bt[1]*1000,tpresc);
+        uint32_t highmin = divceil(bt[2]*1000,tpresc);
+        uint32_t total   = divceil(period-tsync,tpresc);
+        if( total < lowmin+highmin )
+            total = lowmin+highmin;
+        uint32_t sclh = highmin;
+        uint32_t scll = total-sclh;
+        if( scll > 256 || sclh > 256 )
+            continue;
+
+        return (presc<<I2C_TIMINGR_PRESC_Pos)
+              |(scldel<<I2C_TIMINGR_SCLDEL_Pos)
+              |(sdadel<<I2C_TIMINGR_SDADEL_Pos)
+              |((sclh-1)<<I2C_TIMINGR_SCLH_Pos)
+              |((scll-1)<<I2C_TIMINGR_SCLL_Pos);
+    }
+    return 0;
+}
+
+} // namespace detail
+
+/**
+ * @brief   UART (8 bits, no parity, 1 stop bit) with polling
+ *
+ * @note    BRR is rounded to the nearest value. A baud rate with an error
+ *          larger than 2% is a compile error
+ *
+ * @note    No interrupts are enabled, so it does not conflict with the interrupt
+ *          routines of uart2.c, but a UART must not be used by both
+ */
+template<unsigned N, uint32_t Baud, Oversampling Over = Over16,
+         UartClock Clock = UartClock::Hsi>
+class Uart {
+    static_assert(N >= 1 && N <= 8, "UART must be 1 to 8");
+    static_assert(Baud > 0, "Baud rate must not be 0");
+
+    static constexpr detail::UartInfo info = detail::uartinfo[N-1];
+    static constexpr uint32_t dckpos = 2*(N-1);
+
+public:
+    using TxPin = GpioPin<info.txport,info.txpin>;
+    using RxPin = GpioPin<info.rxport,info.rxpin>;
+
+    static constexpr uint32_t kernelfreq = Clock == UartClock::Hsi ? HSI_FREQ : LSE_FREQ;
+    static constexpr uint32_t div  = ((Over==Over8?2:1)*kernelfreq+Baud/2)/Baud;
+    static_assert(div >= 16 && div <= 0xFFFF, "Baud rate out of range for the kernel clock");
+    static constexpr uint32_t brr  = Over==Over8 ? (div&~0xFUL)|((div&0xFUL)>>1) : div;
+    static constexpr uint32_t real = (Over==Over8?2:1)*kernelfreq/div;
+    static_assert((real > Baud ? real-Baud : Baud-real)*50 <= Baud, "Baud rate error larger than 2%");
+    static constexpr uint32_t cr1  = USART_CR1_TE|USART_CR1_RE|USART_CR1_UE
+                                    |(Over==Over8?USART_CR1_OVER8:0);
+
+    Uart() { init(); }
+
+    static USART_TypeDef *regs() { return reinterpret_cast<USART_TypeDef *>(info.base); }
+
+    static void init() {
+        USART_TypeDef *uart = regs();
+
+        if( Clock == UartClock::Hsi ) {
+            RCC->CR |= RCC_CR_HSION;
+            while( (RCC->CR&RCC_CR_HSIRDY) == 0 ) {}
+        }
+        RCC->DCKCFGR2 = (RCC->DCKCFGR2&~(3UL<<dckpos))|(static_cast<uint32_t>(Clock)<<dckpos);
+        if( info.apb2 )
+            RCC->APB2ENR |= info.enable;
+        else
+            RCC->APB1ENR |= info.enable;
+        __DSB();
+
+        TxPin::alternate(info.txaf);
+        RxPin::alternate(info.rxaf,false,Speed::High,Pull::Up);
+
+        uart->CR1 = 0;                              // BRR only with UE cleared
+        uart->CR2 = 0;
+        uart->CR3 = 0;
+        uart->BRR = brr;
+        uart->CR1 = cr1;
+    }
+
+    static bool writable() { return (regs()->ISR&USART_ISR_TXE) != 0; }
+    static bool readable() { return (regs()->ISR&USART_ISR_RXNE) != 0; }
+
+    static void write(uint8_t c) {
+        while( !writable() ) {}
+        regs()->TDR = c;
+    }
+
+    static void write(const char *s) {
+        while( *s ) write(static_cast<uint8_t>(*s++));
+    }
+
+    /// Waits for a character. An overrun is cleared, the lost data is ignored
+    static uint8_t read() {
+        USART_TypeDef *uart = regs();
+
+        while( !readable() ) {
+            if( uart->ISR&USART_ISR_ORE )
+                uart->ICR = USART_ICR_ORECF;
+        }
+        return static_cast<uint8_t>(uart->RDR);
+    }
+
+    /// Waits until the last character was transmitted
+    static void flush() {
+        while( (regs()->ISR&USART_ISR_TC) == 0 ) {}
+    }
+};
+
+/**
+ * @brief   I2C speed and filters (configuration of I2CMaster_Init)
+ */
+///@{
+enum I2cSpeed : uint32_t {
+    Standard        = I2C_CONF_MODE_NORMAL,
+    Fast            = I2C_CONF_MODE_FAST,
+    FastModePlus    = I2C_CONF_MODE_FASTPLUS
+};
+enum I2cFilter : uint32_t {
+    FilterNone      = I2C_CONF_FILTER_NONE,
+    FilterAnalog    = I2C_CONF_FILTER_ANALOG,
+    FilterDigital   = I2C_CONF_FILTER_DIGITAL,
+    FilterBoth      = I2C_CONF_FILTER_BOTH
+};
+///@}
+
+/**
+ * @brief   I2C master with HSI (16 MHz) as kernel clock
+ *
+ * @note    TIMINGR is calculated by the compiler and given to I2CMaster_Init,
+ *          so there is no calculation or table search at run time. With HSI,
+ *          Fast Mode Plus is only possible without the analog filter
+ *
+ * @note    Only I2C1 and I2C3 have pins in i2c-master.c
+ */
+template<unsigned N, I2cSpeed Mode = Standard, I2cFilter Filter = FilterNone, unsigned DNF = 0>
+class I2cMaster {
+    static_assert(N == 1 || N == 3, "Only I2C1 and I2C3 are available");
+    static_assert(DNF < 16, "DNF must be 0 to 15");
+
+    static constexpr uint32_t base = N == 1 ? I2C1_BASE : I2C3_BASE;
+
+public:
+    static constexpr uint32_t conf   = Mode|Filter|(DNF<<I2C_CONF_FILTER_DNF_Pos)|I2C_CONF_CLOCK_HSICLK;
+    static constexpr uint32_t timing = detail::i2cTiming(HSI_FREQ,conf,I2C_RISETIME,I2C_FALLTIME);
+    static_assert(timing != 0, "No TIMINGR for this speed and filter with HSI (16 MHz)");
+
+    I2cMaster() { init(); }
+
+    static I2C_TypeDef *regs() { return reinterpret_cast<I2C_TypeDef *>(base); }
+
+    static int init() {
+        return I2CMaster_Init(regs(),conf,timing);
+    }
+
+    static int write(uint16_t address, uint8_t *data, uint16_t n) {
+        return I2CMaster_Write(regs(),address,data,n);
+    }
+
+    static int read(uint16_t address, uint8_t *data, uint16_t n) {
+        return I2CMaster_Read(regs(),address,data,n);
+    }
+
+    static int writeAndRead(uint16_t address, uint8_t *wdata, int nwrite,
+                                              uint8_t *rdata, int nread) {
+        return I2CMaster_WriteAndRead(regs(),address,wdata,nwrite,rdata,nread);
+    }
+
+    static int detect(uint16_t address) {
+        return I2CMaster_Detect(regs(),address);
+    }
+
+    static I2C_Status_t status() {
+        return I2CMaster_GetStatus(regs());
+    }
+};
+
+} // namespace stm32
+
+#endif // PERIPH_HPP
@@ -14,6 +14,7 @@
 #include "system_stm32f746.h"
 #include "gpio.h"
 #include "sdram.h"
+#include "dvfs.h"
 
 /**
  *  @brief  Pin initialization routines
@@ -37,6 +38,14 @@
 #define SDRAM_BANK2             1
 ///}
 
+/**
+ * @brief   Set by SDRAM_InitEx
+ */
+///@{
+static int SDRAMInitialized = 0;
+static int SDRAMBank = SDRAM_BANK1;
+///@}
+
 /**
  *  @brief  SDRAMBIT    generates bit mask
  */
@@ -994,6 +1003,32 @@ uint32_t sdtr1,sdtr2;
 
 }
 
+/**
+ *  @brief  Set Refresh Count
+ *
+ */
+static void
+SetRefreshCount(uint32_t count) {
+
+    FMC_Bank5_6->SDRTR = (FMC_Bank5_6->SDRTR&~(FMC_SDRTR_COUNT_Msk))
+                |(count<<FMC_SDRTR_COUNT_Pos);
+}
+
+/**
+ *  @brief  Calculate Refresh Count for a HCLK frequency
+ *
+ *  @note   See SDRAM_REFRESH. count = f_SDCLK*15.625 us - 20
+ */
+static uint32_t
+CalculateRefreshCount(uint32_t hclk) {
+uint32_t count;
+
+    count = (uint32_t) (((uint64_t) hclk/SDRAM_SDCLK*15625)/1000000000);
+    if( count < 20+42 )             // It must be greater than 41
+        return 42;
+    return count-20;
+}
+
 /**
  *  @brief  Configure Refresh Rate
  *
@@ -1002,8 +1037,7 @@ static void
 ConfigureSDRAMRefresh(int bank) {
 
     /* Set refresh count */
-    FMC_Bank5_6->SDRTR = (FMC_Bank5_6->SDRTR&~(FMC_SDRTR_COUNT_Msk))
-                |(SDRAM_REFRESH<<FMC_SDRTR_COUNT_Pos);
+    SetRefreshCount(SDRAM_REFRESH);
 
     /* Disable write protection */
     FMC_Bank5_6->SDCR[bank] &= ~(FMC_SDCR1_WP);
@@ -1077,9 +1111,29 @@ int timeout = 0x7FFF;
     while( (FMC_Bank5_6->SDSR&FMC_SDSR_BUSY) &&(timeout-->0) ) {}
 
     if( FMC_Bank5_6->SDSR&FMC_SDSR_BUSY )
-        return 0;
-    else
         return -1;
+    else
+        return 0;
+}
+
+/**
+ *  @brief  Status modes (SDSR MODES1 and MODES2)
+ */
+///@{
+#define SDRAM_STATUS_NORMAL         0
+#define SDRAM_STATUS_SELFREFRESH    1
+#define SDRAM_STATUS_POWERDOWN      2
+///@}
+
+/**
+ *  @brief  Get the status mode of a bank
+ */
+static uint32_t
+GetStatusMode(int bank) {
+
+    if( bank == SDRAM_BANK2 )
+        return (FMC_Bank5_6->SDSR&FMC_SDSR_MODES2)>>FMC_SDSR_MODES2_Pos;
+    return (FMC_Bank5_6->SDSR&FMC_SDSR_MODES1)>>FMC_SDSR_MODES1_Pos;
 }
 
 
@@ -1149,9 +1203,87 @@ SDRAM_InitEx(int bank) {
     /* Configure Refresh */
     ConfigureSDRAMRefresh(bank);
 
+    SDRAMBank = bank;
+    SDRAMInitialized = 1;
+
     return 0;
 }
 
+/**
+ * @brief   SDRAM_EnterSelfRefresh
+ *
+ * @note    The SDRAM refreshes itself with its own clock and keeps the data
+ *          while SDCLK is stopped, e.g., in Stop mode. It must not be accessed
+ *          until SDRAM_ExitSelfRefresh
+ *
+ * @note    Returns 0, -1 when not initialized or -2 on timeout
+ */
+int
+SDRAM_EnterSelfRefresh(void) {
+int timeout = DEFAULT_TIMEOUT;
+
+    if( !SDRAMInitialized )
+        return -1;
+
+    __DSB();                        // Pending writes go before the command
+    if( SendCommand(SDRAMBank,SDRAM_MODE_SELFREFRESH,0) < 0 )
+        return -2;
+    while( GetStatusMode(SDRAMBank) != SDRAM_STATUS_SELFREFRESH && timeout-- > 0 ) {}
+    return timeout >= 0 ? 0 : -2;
+}
+
+/**
+ * @brief   SDRAM_ExitSelfRefresh
+ *
+ * @note    SDCLK must be running (HCLK restored). The FMC waits tXSR (SDTR)
+ *          before the next access
+ *
+ * @note    Returns 0, -1 when not initialized or -2 on timeout
+ */
+int
+SDRAM_ExitSelfRefresh(void) {
+int timeout = DEFAULT_TIMEOUT;
+
+    if( !SDRAMInitialized )
+        return -1;
+
+    if( SendCommand(SDRAMBank,SDRAM_MODE_NORMAL,0) < 0 )
+        return -2;
+    while( GetStatusMode(SDRAMBank) != SDRAM_STATUS_NORMAL && timeout-- > 0 ) {}
+    return timeout >= 0 ? 0 : -2;
+}
+
+/**
+ * @brief   SDRAM clock change callback (see dvfs.h)
+ *
+ * @note    SDCLK is HCLK/SDRAM_SDCLK, so only the refresh count must follow
+ *          HCLK. Before the change, it is set for HSI, the lowest frequency
+ *          used during the change, so the rows are refreshed more often. After
+ *          it, it is set for the new HCLK
+ *
+ * @note    The SDTR timings are in SDCLK cycles and were set for 100 MHz. They
+ *          still hold for lower frequencies, but not for HCLK above 200 MHz
+ *
+ * @note    Before Stop mode, the SDRAM enters self-refresh, and leaves it
+ *          after the wakeup, before the refresh count is set
+ */
+void
+SDRAM_ClockChange(int phase) {
+
+    if( !SDRAMInitialized )
+        return;
+
+    if( DVFS_BEFORE(phase) ) {
+        SetRefreshCount(CalculateRefreshCount(HSI_FREQ));
+        if( phase == DVFS_PRESTOP )
+            SDRAM_EnterSelfRefresh();
+    } else {
+        if( phase == DVFS_POSTSTOP )
+            SDRAM_ExitSelfRefresh();
+        SetRefreshCount(CalculateRefreshCount(SystemCoreClock));
+    }
+}
+
 
 /**
  * @brief   SDRAM Init
@@ -8,6 +8,9 @@
  */
 
 int SDRAM_Init();
+void SDRAM_ClockChange(int phase);
+int SDRAM_EnterSelfRefresh(void);
+int SDRAM_ExitSelfRefresh(void);
 
 /**
  *  @brief  SystemCoreClock for correct working of the SDRAM
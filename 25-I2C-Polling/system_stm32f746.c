@@ -193,7 +193,7 @@ static inline void LockFlashRegisters(void) {
 
 static void inline SetFlashWaitStates(int n) {
 
-    FLASH->ACR = (FLASH->CR&~FLASH_ACR_LATENCY)|((n)<<FLASH_ACR_LATENCY_Pos);
+    FLASH->ACR = (FLASH->ACR&~FLASH_ACR_LATENCY)|((n)<<FLASH_ACR_LATENCY_Pos);
 
 }
 
@@ -226,9 +226,9 @@ int i,j;
  *
  **/
 static void inline ConfigureFlashWaitStates(uint32_t freq, uint32_t voltage) {
-uint32_t ws;
+int ws;
 
-    ws = FindFlashWaitStates(freq,voltage);
+    ws = FindFlashWaitStates(freq/1000000,voltage);
 
     if( ws < 0 )
         return;
@@ -373,7 +373,7 @@ void SystemSetAPB2Prescaler(uint32_t div) {
 uint32_t ppre2;
 uint32_t p2;
 
-    if( SystemCoreClock/div > 54000000 )
+    if( SystemCoreClock/div > 108000000 )
         return;
         
     p2 = SystemFindLargestPower2Exp(div);
@@ -581,7 +581,7 @@ PLLConfiguration_t pllconfig;
         pllconfig.source = pllsrc;
         pllconfig.M = (rcc_pllcfgr & RCC_PLLCFGR_PLLM)>>RCC_PLLCFGR_PLLM_Pos;
         pllconfig.N = (rcc_pllcfgr & RCC_PLLCFGR_PLLN)>>RCC_PLLCFGR_PLLN_Pos;
-        pllconfig.P = (rcc_pllcfgr & RCC_PLLCFGR_PLLP)>>RCC_PLLCFGR_PLLP_Pos;
+        pllconfig.P = ((rcc_pllcfgr & RCC_PLLCFGR_PLLP)>>RCC_PLLCFGR_PLLP_Pos)*2+2;
         sysclk_freq = CalculateMainPLLOutFrequency(&pllconfig);
       break;
     }
@@ -722,7 +722,7 @@ int      pllwascoreclock = 0;
     // If core clock source is PLL change it to HSI
     if( (RCC->CFGR&RCC_CFGR_SWS) == RCC_CFGR_SWS_PLL ) {
         SystemEnableHSI();
-        RCC->CFGR = (RCC->CFGR&RCC_CFGR_SW)|RCC_CFGR_SW_HSI;
+        RCC->CFGR = (RCC->CFGR&~RCC_CFGR_SW)|RCC_CFGR_SW_HSI;
         pllwascoreclock = 1;
     }
     // Disable Main PLL
@@ -757,7 +757,7 @@ int      pllwascoreclock = 0;
                  (
                    ((pllconfig->M<<RCC_PLLCFGR_PLLM_Pos)&RCC_PLLCFGR_PLLM)
                   |((pllconfig->N<<RCC_PLLCFGR_PLLN_Pos)&RCC_PLLCFGR_PLLN)
-                  |((pllconfig->P<<RCC_PLLCFGR_PLLP_Pos)&RCC_PLLCFGR_PLLP)
+                  |(((pllconfig->P/2-1)<<RCC_PLLCFGR_PLLP_Pos)&RCC_PLLCFGR_PLLP)
                   |((pllconfig->Q<<RCC_PLLCFGR_PLLQ_Pos)&RCC_PLLCFGR_PLLQ)
                   |((src<<RCC_PLLCFGR_PLLSRC_Pos)&RCC_PLLCFGR_PLLSRC)
                  );
@@ -770,7 +770,7 @@ int      pllwascoreclock = 0;
 
     /* If it was the core clock, change back */
     if( pllwascoreclock ) {
-        RCC->CFGR = (RCC->CFGR&RCC_CFGR_SW)|RCC_CFGR_SW_PLL;
+        RCC->CFGR = (RCC->CFGR&~RCC_CFGR_SW)|RCC_CFGR_SW_PLL;
     }
 }
 
@@ -979,7 +979,7 @@ PLLConfiguration_t clockconf;
     }
     clockconf.source = CLOCKSRC_HSE;     /* Clock source   */
     clockconf.M = HSE_FREQ/1000000;      /* f_IN = 1 MHz   */
-    clockconf.N = 2*freq;                /* f_PLL = 400 MHz*/
+    clockconf.N = 2*(freq/1000000);      /* f_PLL = 400 MHz*/
     clockconf.P = 2;                     /* f_OUT = 200 MHz*/
     clockconf.Q = 2;                     /* Not used */
     clockconf.R = 2;                     /* Not used */
@@ -156,5 +156,6 @@ int UART_ReadString(int uartn, char *s, int n);
 int UART_GetStatus(int uartn);
 
 int UART_Flush(int uartn);
+void UART_ClockChange(int phase);
 
 #endif // UART_H
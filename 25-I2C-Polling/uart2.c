@@ -16,6 +16,7 @@
 #include "gpio.h"
 #include "uart.h"
 #include "fifo.h"
+#include "dvfs.h"
 
 /**
  ** @brief Bit manipulation macros
@@ -39,7 +40,9 @@ typedef struct {
     unsigned            irqn     :10;
     unsigned            useinputfifo:1;
     unsigned            useoutputfifo:1;
+    unsigned            initialized:1;
     } conf;
+    unsigned                config;
     // Could be unions
     FIFO                    inputfifo;
     FIFO                    outputfifo;
@@ -98,6 +101,39 @@ void UART_EnableClock(USART_TypeDef *uart) {
 }
 
 
+/**
+ * @brief   Get UART kernel clock frequency for the clock source in config
+ */
+static uint32_t GetClockFrequency(unsigned config) {
+
+    switch(config&UART_CLOCK_M) {
+    case UART_CLOCK_APB:    return SystemGetAPB1Frequency();
+    case UART_CLOCK_SYSCLK: return SystemCoreClock;
+    case UART_CLOCK_HSI:    return HSI_FREQ;
+    case UART_CLOCK_LSE:    return LSE_FREQ;
+    }
+    return 0;
+}
+
+/**
+ * @brief   Set BRR for the baud rate in config
+ *
+ * @note    BRR can only be written with UE cleared
+ */
+static void SetBaudRate(USART_TypeDef *uart, unsigned config, uint32_t uartfreq) {
+uint32_t baudrate,div;
+
+    baudrate = ((config&UART_BAUD_M)>>UART_BAUD_P);
+
+    if( (config&UART_OVER8) == 0 ) {
+        div = uartfreq/baudrate;
+        uart->BRR = div;
+    } else {
+        div = 2*uartfreq/baudrate;
+        uart->BRR = (div&~0xF)|((div&0xF)>>1);
+    }
+}
+
 /**
  * @brief   Interrupt processing
  *
@@ -222,7 +258,7 @@ FIFO out;
  **/
 int
 UART_InitExt(int uartn, unsigned config, FIFO in, FIFO out) {
-uint32_t baudrate,div,t,over;
+uint32_t t;
 USART_TypeDef * uart;
 uint32_t uartfreq;
 uint32_t cr1,cr2,cr3,ckcfgr;
@@ -300,10 +336,8 @@ uint32_t cr1,cr2,cr3,ckcfgr;
     }
     if( config&UART_OVER8 ) {
         cr1 |= USART_CR1_OVER8;
-        over = 8;
     } else {
         cr1 &= ~USART_CR1_OVER8;
-        over = 16;
     }
 
     // Configure UART CR2 register
@@ -333,15 +367,7 @@ uint32_t cr1,cr2,cr3,ckcfgr;
     cr3 = 0;
 
     // Configure UART BRR register (baudrate)
-    baudrate = ((config&UART_BAUD_M)>>UART_BAUD_P);
-
-    if( over == 16 ) {
-        div = uartfreq/baudrate;
-        uart->BRR = div;
-    } else {
-        div = 2*uartfreq/baudrate;
-        uart->BRR = (div&~0xF)|((div&0xF)>>1);
-    }
+    SetBaudRate(uart,config,uartfreq);
 
     // Set configuration
     uart->CR1 = cr1;
@@ -360,9 +386,50 @@ uint32_t cr1,cr2,cr3,ckcfgr;
     // Enable UART
     uart->CR1 |= USART_CR1_TE|USART_CR1_RE;
     uart->CR1 |= USART_CR1_UE;
+
+    uarttab[uartn].config = config;
+    uarttab[uartn].conf.initialized = 1;
     return 0;
 }
 
+/**
+ ** @brief UART clock change callback (see dvfs.h)
+ **
+ ** @note  Only the UARTs clocked by APB or SYSCLK are affected. Before the change
+ **        it waits until the output buffer is empty and the transmission is
+ **        complete. After it, BRR is set for the new frequency with UE cleared
+ **
+ ** @note  A character being received during the change is lost
+ **/
+void
+UART_ClockChange(int phase) {
+USART_TypeDef *uart;
+unsigned clock;
+int uartn;
+
+    for(uartn=0;uartn<uarttabsize;uartn++) {
+        if( !uarttab[uartn].conf.initialized )
+            continue;
+        clock = uarttab[uartn].config&UART_CLOCK_M;
+        if( clock != UART_CLOCK_APB && clock != UART_CLOCK_SYSCLK )
+            continue;
+
+        uart = uarttab[uartn].device;
+        if( DVFS_BEFORE(phase) ) {
+            if( uarttab[uartn].conf.useoutputfifo ) {
+                while( !fifo_empty(uarttab[uartn].outputfifo) ) {}
+            } else {
+                while( uarttab[uartn].outputbuffer != 0 ) {}
+            }
+            while( (uart->ISR&USART_ISR_TC) == 0 ) {}
+        } else {
+            uart->CR1 &= ~USART_CR1_UE;
+            SetBaudRate(uart,uarttab[uartn].config,GetClockFrequency(uarttab[uartn].config));
+            uart->CR1 |= USART_CR1_UE;
+        }
+    }
+}
+
 /**
  ** @brief UART Send a character
  **
@@ -0,0 +1,45 @@
+/**
+ * @file     main.c
+ * @brief    Scheduler benchmark
+ * @version  V1.0
+ * @date     15/10/2026
+ *
+ * @note     The same benchmark (schedbench.c) runs on the scheduler chosen by
+ *           SCHED in the Makefile (see sched.h). The table is printed once
+ *           thru the UART or, when STDIO_USE_SWO is defined, thru the SWO pin
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "sched.h"
+#include "schedbench.h"
+#ifdef STDIO_USE_SWO
+#include "swo.h"
+#endif
+
+/**
+ * @brief   main
+ *
+ * @note    Sched_Run never returns
+ */
+int main(void) {
+
+    /* configure clock to 200 MHz */
+    SystemConfigMainPLL(&MainPLLConfiguration_200MHz);
+    SystemSetCoreClock(CLOCKSRC_PLL,1);
+
+#ifdef STDIO_USE_SWO
+    /* Enable stimulus ports for stdio, logs, counters and events */
+    SWO_Init(0,0xF);
+#endif
+
+    Sched_Init();
+
+    SchedBench_Init();
+
+    Sched_Run(SchedBench_Control);
+
+    for(;;) {}
+}
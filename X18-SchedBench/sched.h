@@ -0,0 +1,78 @@
+#ifndef SCHED_H
+#define SCHED_H
+/**
+ * @file    sched.h
+ *
+ * @note    Common interface to the schedulers compared by the benchmark
+ *
+ * @note    Each directory has the copy of a scheduler and a sched.c that
+ *          implements this interface with it. Only one is linked, chosen by
+ *          SCHED in the Makefile
+ *
+ *  SCHED | Directory | Scheduler
+ *  ------|-----------|-------------------------------------------------
+ *  TTE1  | tte1      | Time Triggered Executive v1 (15-TimeTriggered-v1)
+ *  TTE2  | tte2      | Time Triggered Executive v2 (16-TimeTriggered-v2)
+ *  UCOS2 | ucos2     | uC/OS-II (17-ucos2)
+ *
+ * @note    All of them use SysTick at SCHED_TICKHZ, clocked by the core
+ *          clock, so the cycles since the last tick are SysTick->LOAD minus
+ *          SysTick->VAL for all of them
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Tick frequency (Hz)
+ */
+#ifndef SCHED_TICKHZ
+#define SCHED_TICKHZ                1000
+#endif
+
+/**
+ * @brief   Tasks added with Sched_Add (besides the event task)
+ */
+#ifndef SCHED_MAXTASKS
+#define SCHED_MAXTASKS              8
+#endif
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define SCHED_OK                    (0)
+#define SCHED_ERROR_FULL            (-1)
+///@}
+
+typedef void (*Sched_Task)(void);
+
+/**
+ * @brief   API
+ *
+ * @note    Sched_Add: the task runs first at the next tick and then every
+ *          period ticks. Tasks released at the same tick run in priority
+ *          order (0 is the highest). Returns an id for Sched_Remove
+ *
+ * @note    Sched_AddEvent: the task runs after each Sched_Signal, as soon as
+ *          the scheduler can. Sched_Signal is called as the last statement of
+ *          an interrupt routine
+ *
+ * @note    Sched_Run starts the scheduler and never returns. control is
+ *          called in the background (main loop or lowest priority task). It
+ *          can add and remove tasks
+ */
+///@{
+const char *Sched_Name(void);
+void        Sched_Init(void);
+int         Sched_Add(Sched_Task task, uint32_t period, uint32_t prio);
+void        Sched_Remove(int id);
+int         Sched_AddEvent(Sched_Task task);
+void        Sched_RemoveEvent(void);
+void        Sched_Signal(void);
+void        Sched_Run(Sched_Task control);
+///@}
+
+#endif // SCHED_H
@@ -0,0 +1,393 @@
+/**
+ * @file    schedbench.c
+ *
+ * @note    Scheduler benchmark (see schedbench.h)
+ *
+ * @note    The task bodies read the cycles since the tick from SysTick at
+ *          their start and at their end. The last task of a tick (the one
+ *          with the lowest priority, added last) closes the tick. The tasks
+ *          are added in the first half of a tick, so all of them are released
+ *          at the same tick
+ *
+ * @note    The counters are only written by the tasks (or the event task),
+ *          and read by SchedBench_Control after they are removed
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "sched.h"
+#include "schedbench.h"
+
+/**
+ * @brief   Phases
+ */
+///@{
+#define STATE_START                 0
+#define STATE_DISPATCH              1
+#define STATE_EVENT                 2
+#define STATE_REPORT                3
+#define STATE_DONE                  4
+///@}
+
+/// Rows of the table: 1, 2, 4 ... SCHED_MAXTASKS tasks
+#define ROWS                        8
+
+static int state = STATE_START;
+
+/**
+ * @brief   Dispatch measurements
+ */
+///@{
+static SchedBench_Result results[ROWS];
+static int nresults = 0;
+
+static volatile struct {
+    SchedBench_Result  *result;             ///< null when not recorded
+    uint32_t            ntasks;
+    uint32_t            ticks;              ///< closed ticks
+    int                 started;            ///< first task ran in this tick
+    uint32_t            body;               ///< cycles in the bodies
+    uint32_t            lastend;            ///< end of the previous task
+} run;
+
+static int ids[SCHED_MAXTASKS];
+static volatile uint32_t workcounter[SCHED_MAXTASKS];
+///@}
+
+/**
+ * @brief   Event measurements
+ */
+///@{
+static volatile struct {
+    uint32_t            pending;
+    uint32_t            time;               ///< CYCCNT at the update event
+    uint32_t            count;
+    uint32_t            missed;             ///< interrupts with one pending
+    SchedBench_Stat     latency;
+} event;
+
+static uint32_t cyclespercount = 1;         ///< core cycles per TIM6 count
+///@}
+
+/**
+ * @brief   Statistics
+ */
+static void
+stat_clear(volatile SchedBench_Stat *st) {
+
+    st->count = 0;
+    st->min   = UINT32_MAX;
+    st->max   = 0;
+    st->sum   = 0;
+}
+
+static void
+stat_add(volatile SchedBench_Stat *st, uint32_t v) {
+
+    st->count++;
+    st->sum += v;
+    if( v < st->min ) st->min = v;
+    if( v > st->max ) st->max = v;
+}
+
+static inline uint32_t
+stat_avg(const SchedBench_Stat *st) {
+
+    return st->count ? (uint32_t) (st->sum/st->count) : 0;
+}
+
+/**
+ * @brief   Cycles since the last tick
+ */
+static inline uint32_t
+sincetick(void) {
+
+    return SysTick->LOAD-SysTick->VAL;
+}
+
+/**
+ * @brief   Body of the periodic task i
+ *
+ * @note    A tick where SysTick wrapped around (overrun) is discarded
+ */
+static void
+bench_task(uint32_t i) {
+SchedBench_Result *r = run.result;
+uint32_t start,end;
+
+    start = sincetick();
+    workcounter[i]++;
+    end = sincetick();
+
+    if( i == 0 ) {
+        run.started = 1;
+        run.body    = 0;
+    } else if( !run.started || start < run.lastend ) {
+        run.started = 0;
+        return;
+    }
+    if( end < start ) {
+        run.started = 0;
+        return;
+    }
+    if( r && run.ticks >= SCHEDBENCH_SETTLE ) {
+        if( i == 0 )
+            stat_add(&r->releasefirst,start);
+        else
+            stat_add(&r->switches,start-run.lastend);
+        if( i == run.ntasks-1 )
+            stat_add(&r->releaselast,start);
+    }
+    run.body   += end-start;
+    run.lastend = end;
+
+    if( i == run.ntasks-1 ) {
+        if( r && run.ticks >= SCHEDBENCH_SETTLE )
+            stat_add(&r->overhead,end-run.body);
+        run.ticks++;
+        run.started = 0;
+    }
+}
+
+/**
+ * @brief   Periodic tasks (the schedulers call functions without parameters)
+ */
+///@{
+static void task0(void) { bench_task(0); }
+static void task1(void) { bench_task(1); }
+static void task2(void) { bench_task(2); }
+static void task3(void) { bench_task(3); }
+static void task4(void) { bench_task(4); }
+static void task5(void) { bench_task(5); }
+static void task6(void) { bench_task(6); }
+static void task7(void) { bench_task(7); }
+
+static const Sched_Task tasks[] = {
+    task0, task1, task2, task3, task4, task5, task6, task7
+};
+///@}
+
+#if SCHED_MAXTASKS > 8
+#error Only 8 task functions are defined
+#endif
+
+/**
+ * @brief   Event task
+ */
+static void
+bench_event(void) {
+uint32_t latency = DWT->CYCCNT-event.time;
+
+    if( !event.pending )
+        return;
+    if( event.count >= SCHEDBENCH_SETTLE )
+        stat_add(&event.latency,latency);
+    event.count++;
+    event.pending = 0;
+}
+
+/**
+ * @brief   Event interrupt
+ *
+ * @note    The time of the update event is the entry time minus the counter,
+ *          so the latency includes the entry of this routine
+ */
+void
+TIM6_DAC_IRQHandler(void) {
+uint32_t now = DWT->CYCCNT;
+uint32_t cnt = TIM6->CNT;
+
+    TIM6->SR = ~TIM_SR_UIF;
+    if( event.pending ) {
+        event.missed++;
+        return;
+    }
+    event.time    = now-cnt*cyclespercount;
+    event.pending = 1;
+    Sched_Signal();
+}
+
+/**
+ * @brief   Start and stop TIM6
+ *
+ * @note    The period (SCHEDBENCH_EVENTPERIOD us) is counted with a prescaler
+ *          when it does not fit in 16 bits
+ */
+static void
+timer_start(void) {
+uint32_t timerfreq,ticks,psc;
+
+    // TIM6 is clocked by 2*APB1, unless the APB1 prescaler is 1
+    timerfreq = SystemGetAPB1Frequency();
+    if( SystemGetAPB1Prescaler() != 1 )
+        timerfreq *= 2;
+    ticks = (uint32_t) (((uint64_t) timerfreq*SCHEDBENCH_EVENTPERIOD)/1000000);
+    psc   = ticks/65536+1;
+    cyclespercount = SystemCoreClock/(timerfreq/psc);
+
+    RCC->APB1ENR |= RCC_APB1ENR_TIM6EN;
+    __DSB();
+    TIM6->CR1  = TIM_CR1_URS;
+    TIM6->PSC  = psc-1;
+    TIM6->ARR  = ticks/psc-1;
+    TIM6->EGR  = TIM_EGR_UG;
+    TIM6->SR   = 0;
+    TIM6->DIER = TIM_DIER_UIE;
+
+    NVIC_SetPriority(TIM6_DAC_IRQn,SCHEDBENCH_IRQPRIO);
+    NVIC_ClearPendingIRQ(TIM6_DAC_IRQn);
+    NVIC_EnableIRQ(TIM6_DAC_IRQn);
+    TIM6->CR1 |= TIM_CR1_CEN;
+}
+
+static void
+timer_stop(void) {
+
+    TIM6->CR1 &= ~TIM_CR1_CEN;
+    TIM6->DIER = 0;
+    NVIC_DisableIRQ(TIM6_DAC_IRQn);
+    NVIC_ClearPendingIRQ(TIM6_DAC_IRQn);
+}
+
+/**
+ * @brief   Add and remove the periodic tasks
+ *
+ * @note    The tasks are added in the first half of a tick, so the next tick
+ *          does not come between two of them
+ */
+static void
+addtasks(uint32_t n, SchedBench_Result *r) {
+uint32_t i;
+
+    run.result  = r;
+    run.ntasks  = n;
+    run.ticks   = 0;
+    run.started = 0;
+    if( r ) {
+        r->ntasks = n;
+        stat_clear(&r->overhead);
+        stat_clear(&r->switches);
+        stat_clear(&r->releasefirst);
+        stat_clear(&r->releaselast);
+    }
+    while( sincetick() > SysTick->LOAD/2 ) {}
+    for(i=0;i<n;i++)
+        ids[i] = Sched_Add(tasks[i],SCHEDBENCH_PERIOD,i);
+}
+
+static void
+removetasks(void) {
+uint32_t i;
+
+    for(i=0;i<run.ntasks;i++)
+        Sched_Remove(ids[i]);
+}
+
+/**
+ * @brief   Table
+ *
+ * @note    jitter is the difference between the latest and the earliest
+ *          start, measured from the tick
+ */
+static void
+report(void) {
+const SchedBench_Result *r;
+int i;
+
+    printf("\nScheduler %s, core %lu MHz, tick %u Hz, times in cycles\n",
+            Sched_Name(),(unsigned long) (SystemCoreClock/1000000),
+            (unsigned) SCHED_TICKHZ);
+    printf("tasks  overhead   max | switch    avg    max | jitter first  last\n");
+    for(i=0;i<nresults;i++) {
+        r = &results[i];
+        printf("%5lu  %8lu %5lu | %6lu %6lu %6lu | %12lu %5lu\n",
+                (unsigned long) r->ntasks,
+                (unsigned long) stat_avg(&r->overhead),
+                (unsigned long) r->overhead.max,
+                (unsigned long) (r->switches.count ? r->switches.min : 0),
+                (unsigned long) stat_avg(&r->switches),
+                (unsigned long) r->switches.max,
+                (unsigned long) (r->releasefirst.max-r->releasefirst.min),
+                (unsigned long) (r->releaselast.max-r->releaselast.min));
+    }
+    printf("isr->task  min %lu avg %lu max %lu (%lu events, %lu missed, %u tasks)\n",
+            (unsigned long) event.latency.min,
+            (unsigned long) stat_avg((const SchedBench_Stat *) &event.latency),
+            (unsigned long) event.latency.max,
+            (unsigned long) event.latency.count,
+            (unsigned long) event.missed,
+            (unsigned) SCHEDBENCH_EVENTLOAD);
+}
+
+/**
+ * @brief   SchedBench_Init
+ *
+ * @note    Enables the cycle counter. Called before Sched_Run
+ */
+void
+SchedBench_Init(void) {
+
+    if( (DWT->CTRL&DWT_CTRL_CYCCNTENA_Msk) == 0 ) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->LAR = 0xC5ACCE55;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+    state = STATE_START;
+}
+
+/**
+ * @brief   SchedBench_Control
+ *
+ * @note    Called in the background. Returns at once while a phase runs
+ */
+void
+SchedBench_Control(void) {
+uint32_t n;
+
+    switch(state) {
+    case STATE_START:
+        nresults = 0;
+        addtasks(1,&results[nresults]);
+        state = STATE_DISPATCH;
+        break;
+    case STATE_DISPATCH:
+        if( run.ticks < SCHEDBENCH_SETTLE+SCHEDBENCH_SAMPLES )
+            break;
+        removetasks();
+        n = run.ntasks;
+        nresults++;
+        if( 2*n <= SCHED_MAXTASKS && nresults < ROWS ) {
+            addtasks(2*n,&results[nresults]);
+            break;
+        }
+        event.pending = 0;
+        event.count   = 0;
+        event.missed  = 0;
+        stat_clear(&event.latency);
+        addtasks(SCHEDBENCH_EVENTLOAD,0);
+        Sched_AddEvent(bench_event);
+        timer_start();
+        state = STATE_EVENT;
+        break;
+    case STATE_EVENT:
+        if( event.count < SCHEDBENCH_SETTLE+SCHEDBENCH_SAMPLES )
+            break;
+        timer_stop();
+        Sched_RemoveEvent();
+        removetasks();
+        state = STATE_REPORT;
+        break;
+    case STATE_REPORT:
+        report();
+        state = STATE_DONE;
+        break;
+    default:
+        break;
+    }
+}
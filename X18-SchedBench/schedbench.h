@@ -0,0 +1,85 @@
+#ifndef SCHEDBENCH_H
+#define SCHEDBENCH_H
+/**
+ * @file    schedbench.h
+ *
+ * @note    Scheduler benchmark, the same for all schedulers (sched.h)
+ *
+ * @note    Measurements, all in core cycles (DWT->CYCCNT and SysTick)
+ *
+ *  - Dispatch overhead per tick, for 1 to SCHED_MAXTASKS tasks released at
+ *    the same tick: the time from the tick to the end of the last task minus
+ *    the time spent in the task bodies. It includes the tick interrupt, the
+ *    dispatcher and the switches
+ *  - Switch time: from the end of a task to the start of the next one
+ *    released at the same tick
+ *  - Release jitter: variation of the start of the first and of the last
+ *    task, measured from the tick
+ *  - ISR to task latency: from the entry of the TIM6 interrupt to the start
+ *    of the event task, with SCHEDBENCH_EVENTLOAD periodic tasks running.
+ *    The timer period is not a multiple of the tick, so the interrupt falls
+ *    at all points of the tick
+ *
+ * @note    SchedBench_Control is called in the background by the scheduler.
+ *          It goes thru the phases and prints the table with printf at the
+ *          end (UART or SWO, see syscalls.c)
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Parameters
+ *
+ * @note    The periodic tasks have a period of SCHEDBENCH_PERIOD ticks. It is
+ *          2 because the v1 executive can not run a task at every tick (see
+ *          tte1/sched.c)
+ */
+///@{
+#ifndef SCHEDBENCH_PERIOD
+#define SCHEDBENCH_PERIOD           2
+#endif
+#ifndef SCHEDBENCH_SAMPLES
+#define SCHEDBENCH_SAMPLES          1000    ///< ticks or events for each phase
+#endif
+#ifndef SCHEDBENCH_SETTLE
+#define SCHEDBENCH_SETTLE           10      ///< ticks discarded at the start
+#endif
+#ifndef SCHEDBENCH_EVENTPERIOD
+#define SCHEDBENCH_EVENTPERIOD      1013    ///< us, TIM6
+#endif
+#ifndef SCHEDBENCH_EVENTLOAD
+#define SCHEDBENCH_EVENTLOAD        4       ///< periodic tasks in event phase
+#endif
+#ifndef SCHEDBENCH_IRQPRIO
+#define SCHEDBENCH_IRQPRIO          8       ///< uC/OS-II kernel aware level
+#endif
+///@}
+
+/**
+ * @brief   Min, max and sum of a measurement
+ */
+typedef struct {
+    uint32_t    count;
+    uint32_t    min;
+    uint32_t    max;
+    uint64_t    sum;
+} SchedBench_Stat;
+
+/**
+ * @brief   Results for a number of tasks
+ */
+typedef struct {
+    uint32_t        ntasks;
+    SchedBench_Stat overhead;           ///< per tick
+    SchedBench_Stat switches;
+    SchedBench_Stat releasefirst;       ///< start of the first task
+    SchedBench_Stat releaselast;        ///< start of the last task
+} SchedBench_Result;
+
+void SchedBench_Init(void);
+void SchedBench_Control(void);
+
+#endif // SCHEDBENCH_H
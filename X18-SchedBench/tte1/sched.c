@@ -0,0 +1,118 @@
+/**
+ * @file    sched.c
+ *
+ * @note    Benchmark interface (sched.h) with the Time Triggered Executive v1
+ *
+ * @note    Task_Update reloads the delay with the period and decrements it at
+ *          the next tick, so a task added with period p runs every p+1 ticks
+ *          and a period of 1 tick is not possible (0 is a one shot task).
+ *          Sched_Add passes period-1, so period must be at least 2
+ *
+ * @note    There is no priority: the tasks run in the order of the table,
+ *          which is the order they were added in. There is no event either:
+ *          Sched_Signal sets a flag, polled by a task at the shortest period
+ *          (2 ticks), so the latency includes up to 2 ticks of waiting
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "tte.h"
+#include "sched.h"
+
+static Sched_Task eventtask = 0;
+static int eventid = -1;
+static volatile uint32_t eventflag = 0;
+
+/**
+ * @brief   SysTick interrupt
+ */
+void
+SysTick_Handler(void) {
+
+    Task_Update();
+}
+
+/**
+ * @brief   Event poller
+ */
+static void
+eventpoll(void) {
+
+    if( eventflag ) {
+        eventflag = 0;
+        if( eventtask )
+            eventtask();
+    }
+}
+
+const char *
+Sched_Name(void) {
+
+    return "TTE v1";
+}
+
+void
+Sched_Init(void) {
+
+    Task_Init();
+    SysTick_Config(SystemCoreClock/SCHED_TICKHZ);
+}
+
+int
+Sched_Add(Sched_Task task, uint32_t period, uint32_t prio) {
+int32_t id;
+
+    (void) prio;
+    if( period < 2 )
+        period = 2;
+    id = Task_Add(task,period-1,0);
+    return id < 0 ? SCHED_ERROR_FULL : id;
+}
+
+void
+Sched_Remove(int id) {
+
+    if( id >= 0 )
+        Task_Delete(id);
+}
+
+int
+Sched_AddEvent(Sched_Task task) {
+int32_t id;
+
+    eventtask = task;
+    eventflag = 0;
+    id = Task_Add(eventpoll,1,0);
+    if( id < 0 )
+        return SCHED_ERROR_FULL;
+    eventid = id;
+    return SCHED_OK;
+}
+
+void
+Sched_RemoveEvent(void) {
+
+    Sched_Remove(eventid);
+    eventid   = -1;
+    eventtask = 0;
+}
+
+void
+Sched_Signal(void) {
+
+    eventflag = 1;
+}
+
+void
+Sched_Run(Sched_Task control) {
+
+    for(;;) {
+        Task_Dispatch();
+        control();
+    }
+}
@@ -0,0 +1,116 @@
+/**
+ * @file    sched.c
+ *
+ * @note    Benchmark interface (sched.h) with the Time Triggered Executive v2
+ *
+ * @note    The periodic tasks are cooperative tasks run by Task_Dispatch in
+ *          the main loop, in priority order. Priority 0 is left for the event
+ *          poller, so Sched_Add uses prio+1
+ *
+ * @note    There is no event: Sched_Signal sets a flag, polled by a task
+ *          released at every tick. The latency includes up to a tick of
+ *          waiting
+ *
+ * @note    Task_Init must be called after SysTick_Config, which sets the
+ *          SysTick priority (see tte-v2.c). PendSV_Handler is in tte-v2.c
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "tte.h"
+#include "sched.h"
+
+static Sched_Task eventtask = 0;
+static int eventid = -1;
+static volatile uint32_t eventflag = 0;
+
+/**
+ * @brief   SysTick interrupt
+ */
+void
+SysTick_Handler(void) {
+
+    Task_Update();
+}
+
+/**
+ * @brief   Event poller
+ */
+static void
+eventpoll(void) {
+
+    if( eventflag ) {
+        eventflag = 0;
+        if( eventtask )
+            eventtask();
+    }
+}
+
+const char *
+Sched_Name(void) {
+
+    return "TTE v2";
+}
+
+void
+Sched_Init(void) {
+
+    SysTick_Config(SystemCoreClock/SCHED_TICKHZ);
+    Task_Init();
+}
+
+int
+Sched_Add(Sched_Task task, uint32_t period, uint32_t prio) {
+int32_t id;
+
+    id = Task_AddWithPriority(task,period,0,prio+1);
+    return id < 0 ? SCHED_ERROR_FULL : id;
+}
+
+void
+Sched_Remove(int id) {
+
+    if( id >= 0 )
+        Task_Delete(id);
+}
+
+int
+Sched_AddEvent(Sched_Task task) {
+int32_t id;
+
+    eventtask = task;
+    eventflag = 0;
+    id = Task_AddWithPriority(eventpoll,1,0,0);
+    if( id < 0 )
+        return SCHED_ERROR_FULL;
+    eventid = id;
+    return SCHED_OK;
+}
+
+void
+Sched_RemoveEvent(void) {
+
+    Sched_Remove(eventid);
+    eventid   = -1;
+    eventtask = 0;
+}
+
+void
+Sched_Signal(void) {
+
+    eventflag = 1;
+}
+
+void
+Sched_Run(Sched_Task control) {
+
+    for(;;) {
+        Task_Dispatch();
+        control();
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef TTE_H
+#define TTE_H
+/**
+ * @file     tte.h
+ * @brief    Time Triggered Kernel
+ * @version  V1.0
+ * @date     23/01/2016
+ *
+ * @note     Direct access to registers
+ * @note     No library except CMSIS is used
+ *
+ *
+ ******************************************************************************/
+
+/**
+ * @brief Priority of the tasks added by Task_Add (0 is the highest)
+ */
+#ifndef TASK_PRIORITY_DEFAULT
+#define TASK_PRIORITY_DEFAULT 8
+#endif
+
+/// Returned by Task_GetIdleTicks when there is no task
+#define TASK_IDLE_FOREVER 0xFFFFFFFFUL
+
+/**
+ * @brief Measurements of a task (cycles of DWT->CYCCNT)
+ *
+ * @note The release delay is the time from the tick interrupt to the start
+ *       of the task. Its variation is the jitter
+ */
+typedef struct {
+    uint32_t    runs;           // activations measured
+    uint32_t    execmin;        // execution time
+    uint32_t    execmax;
+    uint64_t    exectotal;
+    uint32_t    releasemin;     // release delay
+    uint32_t    releasemax;
+    uint32_t    budgetovers;    // activations longer than the budget
+} TaskStats;
+
+/**
+ * @brief Static schedule (generated by tools/mksched)
+ *
+ * @note The tasks of tick t of the hyperperiod are
+ *       tasks[list[index[t]]] to tasks[list[index[t+1]-1]]
+ */
+typedef struct {
+    uint32_t            hyperperiod;    // ticks
+    uint32_t            ntasks;
+    void        (* const *tasks)(void);
+    const uint16_t      *index;         // hyperperiod+1 entries
+    const uint8_t       *list;
+} TaskSchedule;
+
+/**
+ * @brief TTE API
+ *
+ */
+//@{
+uint32_t Task_Init(void);
+ int32_t Task_Add(void (*task)(void), uint32_t period, uint32_t delay);
+ int32_t Task_AddWithPriority(void (*task)(void), uint32_t period, uint32_t delay,
+                              uint32_t priority);
+ int32_t Task_AddPreemptive(void (*task)(void), uint32_t period, uint32_t delay,
+                            uint32_t priority);
+uint32_t Task_Delete(uint32_t i); // Do not use
+uint32_t Task_Dispatch(void);
+void     Task_Update(void);
+uint32_t Task_ModifyPeriod(uint32_t taskno, uint32_t newperiod);
+uint32_t Task_GetOverruns(uint32_t *maxbacklog);
+void     Task_SetOverrunHandler(void (*handler)(uint32_t backlog));
+uint32_t Task_GetIdleTicks(void);
+void     Task_Advance(uint32_t ticks);
+uint32_t Task_SetBudget(uint32_t taskno, uint32_t cycles);
+void     Task_SetBudgetHandler(void (*handler)(uint32_t taskno, uint32_t cycles));
+uint32_t Task_GetStats(uint32_t taskno, TaskStats *st);
+void     Task_ResetStats(void);
+void     Task_PrintStats(int (*print)(const char *fmt, ...));
+void     Task_SetSchedule(const TaskSchedule *schedule);
+//@}
+#endif
@@ -0,0 +1,198 @@
+/**
+ * @file    sched.c
+ *
+ * @note    Benchmark interface (sched.h) with uC/OS-II
+ *
+ * @note    Each periodic task is a uC/OS-II task that calls the task function
+ *          and waits period ticks with OSTimeDly. The priority of the task is
+ *          SCHED_TASK_PRIO+prio, so the tasks released at the same tick run
+ *          in priority order and each one is a context switch
+ *
+ * @note    The event task waits on a semaphore posted by Sched_Signal. The
+ *          interrupt must have a priority below CPU_CFG_KA_IPL_BOUNDARY
+ *          (kernel aware)
+ *
+ * @note    The control task has the lowest priority but the idle task. It
+ *          starts the tick and calls control every 100 ms
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "ucos_ii.h"
+#include "app_cfg.h"
+#include "sched.h"
+
+#if SCHED_TICKHZ != OS_TICKS_PER_SEC
+#error SCHED_TICKHZ must be equal to OS_TICKS_PER_SEC (os_cfg.h)
+#endif
+#if SCHED_TASK_PRIO+SCHED_MAXTASKS > SCHED_CONTROL_PRIO
+#error The periodic tasks must have a higher priority than the control task
+#endif
+
+/**
+ * @brief   Periodic tasks, indexed by prio
+ */
+typedef struct {
+    Sched_Task  task;
+    uint32_t    period;
+} Slot;
+
+static Slot slots[SCHED_MAXTASKS];
+static OS_STK taskstacks[SCHED_MAXTASKS][SCHED_TASK_STK_SIZE];
+static OS_STK eventstack[SCHED_TASK_STK_SIZE];
+static OS_STK controlstack[SCHED_CONTROL_STK_SIZE];
+
+static OS_EVENT *eventsem = 0;
+static Sched_Task eventtask = 0;
+static Sched_Task controltask = 0;
+
+/**
+ * @brief   Create a task with stack checking
+ */
+static INT8U
+createtask(void (*task)(void *), void *param, OS_STK *stack, INT32U size,
+           INT8U prio, INT16U opt) {
+
+    return OSTaskCreateExt(task,param,&stack[size-1],prio,prio,&stack[0],size,
+                           (void *) 0,OS_TASK_OPT_STK_CHK|OS_TASK_OPT_STK_CLR|opt);
+}
+
+/**
+ * @brief   Body of a periodic task
+ *
+ * @note    The first delay is a tick, so it runs first at the next tick
+ */
+static void
+periodictask(void *param) {
+Slot *s = (Slot *) param;
+INT32U delay = 1;
+
+    while(1) {
+        OSTimeDly(delay);
+        s->task();
+        delay = s->period;
+    }
+}
+
+/**
+ * @brief   Body of the event task
+ */
+static void
+eventloop(void *param) {
+INT8U err;
+
+    (void) param;
+    while(1) {
+        OSSemPend(eventsem,0,&err);
+        if( err == OS_ERR_NONE && eventtask )
+            eventtask();
+    }
+}
+
+/**
+ * @brief   Body of the control task
+ *
+ * @note    It calls printf, so the FPU context is saved (see 17-ucos2)
+ */
+static void
+controlloop(void *param) {
+
+    (void) param;
+    OS_CPU_SysTickInit(SystemCoreClock/OS_TICKS_PER_SEC);
+    while(1) {
+        controltask();
+        OSTimeDly(SCHED_TICKHZ/10);
+    }
+}
+
+const char *
+Sched_Name(void) {
+
+    return "uC/OS-II";
+}
+
+void
+Sched_Init(void) {
+
+    OSInit();
+    eventsem = OSSemCreate(0);
+}
+
+int
+Sched_Add(Sched_Task task, uint32_t period, uint32_t prio) {
+Slot *s;
+
+    if( prio >= SCHED_MAXTASKS || slots[prio].task )
+        return SCHED_ERROR_FULL;
+    s = &slots[prio];
+    s->task   = task;
+    s->period = period ? period : 1;
+    if( createtask(periodictask,s,taskstacks[prio],SCHED_TASK_STK_SIZE,
+                   SCHED_TASK_PRIO+prio,0) != OS_ERR_NONE ) {
+        s->task = 0;
+        return SCHED_ERROR_FULL;
+    }
+    return prio;
+}
+
+void
+Sched_Remove(int id) {
+
+    if( id < 0 || id >= SCHED_MAXTASKS || !slots[id].task )
+        return;
+    OSTaskDel(SCHED_TASK_PRIO+id);
+    slots[id].task = 0;
+}
+
+int
+Sched_AddEvent(Sched_Task task) {
+
+    if( !eventsem || eventtask )
+        return SCHED_ERROR_FULL;
+    eventtask = task;
+    if( createtask(eventloop,0,eventstack,SCHED_TASK_STK_SIZE,
+                   SCHED_EVENT_PRIO,0) != OS_ERR_NONE ) {
+        eventtask = 0;
+        return SCHED_ERROR_FULL;
+    }
+    return SCHED_OK;
+}
+
+void
+Sched_RemoveEvent(void) {
+
+    if( !eventtask )
+        return;
+    OSTaskDel(SCHED_EVENT_PRIO);
+    eventtask = 0;
+}
+
+/**
+ * @brief   Sched_Signal
+ *
+ * @note    The interrupt routines of this project do not call OSIntEnter, so
+ *          it is done here. OSIntExit switches to the event task at the
+ *          return of the interrupt
+ */
+void
+Sched_Signal(void) {
+
+    OSIntEnter();
+    OSSemPost(eventsem);
+    OSIntExit();
+}
+
+void
+Sched_Run(Sched_Task control) {
+
+    controltask = control;
+    createtask(controlloop,0,controlstack,SCHED_CONTROL_STK_SIZE,
+               SCHED_CONTROL_PRIO,OS_TASK_OPT_SAVE_FP);
+    __enable_irq();
+    OSStart();
+}
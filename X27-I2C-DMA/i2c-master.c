@@ -10,8 +10,10 @@
  *          * Interrupt
  *          * Direct Memory Access (DMA)
  *
- * @note    For now, one can use Polling or Interrupt, by defining
- *          USE_POLLING or USE_INTERRUPT at the beginning
+ * @note    This module uses DMA for the data and interrupts for the control of
+ *          the transfer. Transactions are queued for each bus, so many devices
+ *          can share it without the CPU waiting. I2CMaster_Write, Read and
+ *          WriteAndRead are blocking versions built on I2CMaster_Submit.
  * @author  Hans
  */
 
@@ -19,15 +21,7 @@
 #include "system_stm32f746.h"
 #include "i2c-master.h"
 #include "gpio.h"
-
-
-/**
- * @brief Implementation
- *
- * @note  Uncomment only one
- */
-//#define USE_POLLING
-#define USE_INTERRUPT
+#include "dma.h"
 
 
 /**
@@ -189,119 +183,7 @@ static I2C_Configuration_t i2c_configuration[] = {
 };
 
 
-#ifdef USE_INTERRUPT
-/**
- * @brief  Interrupt routines and data structures for I2C
- *
- */
-///@{
-
-#define I2C_OPERATION_WRITE             0
-#define I2C_OPERATION_READ              1
-#define I2C_OPERATION_WRITE_READ        2
-
-typedef struct {
-    unsigned char *pointer;
-    int           operation;
-    int           count;
-    int           status;
-} I2C_Info;
-
-static I2C_Info     i2c1_info;  // Info for I2C1
-static I2C_Info     i2c2_info;  // Info for I2C2
-static I2C_Info     i2c3_info;  // Info for I2C3
-static I2C_Info     i2c4_info;  // Info for I2C4
-
-/**
- * @brief Process I2C Error Interrupts
- *
- * @param i2c
- * @param i2cinfo
- */
-void I2C_ProcessErrorInterrupt(I2C_TypeDef *i2c, I2C_Info *i2cinfo) {
-
-    // TODO
-
-}
-
-/**
- * @brief Process I2C Event Interrupt
- *
- * @param i2c
- * @param i2cinfo
- */
-void I2C_ProcessEventInterrupt(I2C_TypeDef *i2c, I2C_Info *i2cinfo) {
-
-    // TODO
-
-}
-
-/**
- * @brief I2C1 Event interrupt
- */
-void I2C1_EV_IRQHandler(void) {
-
-    I2C_ProcessEventInterrupt(I2C1,&i2c1_info);
-}
-
-/**
- * @brief I2C1 Error interrupt
- */
-void I2C1_ER_IRQHandler(void) {
-
-    I2C_ProcessErrorInterrupt(I2C1,&i2c1_info);
-}
-
-/**
- * @brief I2C2 Event interrupt
- */
-void I2C2_EV_IRQHandler(void) {
-
-    I2C_ProcessEventInterrupt(I2C2,&i2c2_info);
-}
-
-/**
- * @brief I2C2 Error interrupt
- */
-void I2C2_ER_IRQHandler(void) {
-
-    I2C_ProcessErrorInterrupt(I2C2,&i2c2_info);
-}
-
-/**
- * @brief I2C3 Event interrupt
- */
-void I2C3_EV_IRQHandler(void) {
-
-    I2C_ProcessEventInterrupt(I2C3,&i2c3_info);
-}
-
-/**
- * @brief I2C3 Error interrupt
- */
-void I2C3_ER_IRQHandler(void) {
-
-    I2C_ProcessErrorInterrupt(I2C3,&i2c3_info);
-}
-
-/**
- * @brief I2C4 Event interrupt
- */
-void I2C4_EV_IRQHandler(void) {
-
-    I2C_ProcessEventInterrupt(I2C4,&i2c4_info);
-}
-
-/**
- * @brief I2C1 Error interrupt
- */
-void I2C4_ER_IRQHandler(void) {
-
-    I2C_ProcessErrorInterrupt(I2C4,&i2c4_info);
-}
-///@}
-
-#endif // USE_INTERRUPT
+static int I2CMaster_EngineInit( I2C_TypeDef *i2c );
 
 /**
  *  @brief  ConfigurePins
@@ -484,86 +366,532 @@ int index;
     i2c->CR1 |= I2C_CR1_PE;
     i2c->CR1 |= I2C_CR1_PE;
 
+    // Interrupts and DMA for the transaction queue
+    return I2CMaster_EngineInit(i2c);
+}
+
+/**
+ * @brief  Transaction engine
+ *
+ * @note   Each bus has a queue of transactions. The first one is being
+ *         transferred and the others wait for it. A transaction is an optional
+ *         write phase and an optional read phase, joined by a repeated start.
+ *
+ *          SAAAAAAAW*DDDDDDDD*...*DDDDDDDD*SAAAAAAAR*DDDDDDDD*...DDDDDDDD*P
+ *
+ * @note   Data phases are done by DMA. The event interrupt drives the rest:
+ *         - TCR: more than 255 bytes: NBYTES is reloaded with the next chunk
+ *         - TC:  write phase done: the read phase starts with a repeated start
+ *         - STOPF: transaction done: the callback is called and the next
+ *           transaction is started
+ *         - NACKF: slave did not acknowledge: STOP and failure
+ *
+ * @note   The DMA1 streams are allocated by dma.c. When they are free, all
+ *         four buses get the streams below and can work at the same time
+ *
+ *          | I2C   | RX Stream/Channel | TX Stream/Channel |
+ *          |-------|-------------------|-------------------|
+ *          | I2C1  |       0 / 1       |       6 / 1       |
+ *          | I2C2  |       3 / 7       |       7 / 7       |
+ *          | I2C3  |       1 / 1       |       4 / 3       |
+ *          | I2C4  |       2 / 2       |       5 / 2       |
+ *
+ * @note   The data cache is cleaned over the write buffer and invalidated over
+ *         the read buffer. Read buffers should be aligned and padded to 32
+ *         bytes (cache line), so that no other data share their lines.
+ *
+ * @note   Timeouts are counted by I2CMaster_ProcessTimeouts, that must be
+ *         called every ms (e.g. from SysTick_Handler). A transaction that
+ *         does not finish in I2C_TIMEOUT_MS is aborted, the I2C is reset and
+ *         the next transaction is started.
+ */
+///@{
+typedef struct {
+    I2C_TypeDef             *i2c;
+    int                     rxrequest;      // DMA_REQ_*
+    int                     txrequest;
+    IRQn_Type               evirq;
+    IRQn_Type               erirq;
+} I2C_DMAConfiguration_t;
+
+static const I2C_DMAConfiguration_t i2c_dmaconfiguration[] = {
+    { I2C1, DMA_REQ_I2C1_RX, DMA_REQ_I2C1_TX, I2C1_EV_IRQn, I2C1_ER_IRQn },
+    { I2C2, DMA_REQ_I2C2_RX, DMA_REQ_I2C2_TX, I2C2_EV_IRQn, I2C2_ER_IRQn },
+    { I2C3, DMA_REQ_I2C3_RX, DMA_REQ_I2C3_TX, I2C3_EV_IRQn, I2C3_ER_IRQn },
+    { I2C4, DMA_REQ_I2C4_RX, DMA_REQ_I2C4_TX, I2C4_EV_IRQn, I2C4_ER_IRQn },
+};
+#define I2C_NBUSES (sizeof(i2c_dmaconfiguration)/sizeof(i2c_dmaconfiguration[0]))
+
+#define PHASE_IDLE                      0
+#define PHASE_WRITE                     1
+#define PHASE_READ                      2
+
+typedef struct {
+    I2C_Transaction         *first;         // being transferred
+    I2C_Transaction         *last;
+    int                     phase;
+    uint32_t                remaining;      // bytes of the phase not in NBYTES yet
+    int                     error;
+    volatile uint32_t       timer;          // ms left for the transaction
+    int                     dmaready;       // streams allocated
+    int                     rxdma;          // DMA stream handles
+    int                     txdma;
+} I2C_Bus_t;
+
+static I2C_Bus_t            i2c_bus[I2C_NBUSES];
+///@}
+
+/**
+ * @brief  Find bus index for a specific I2C
+ */
+static int FindBus( I2C_TypeDef *i2c ) {
+unsigned k;
+
+    for(k=0;k<I2C_NBUSES;k++) {
+        if( i2c_dmaconfiguration[k].i2c == i2c )
+            return k;
+    }
+    return -1;
+}
+
+/**
+ * @brief  Cache maintenance over whole lines
+ */
+///@{
+static void CleanBuffer( const uint8_t *p, uint32_t n ) {
+uint32_t a = (uint32_t) p&~31U;
+
+    SCB_CleanDCache_by_Addr((uint32_t *) a,(((uint32_t) p+n+31)&~31U)-a);
+}
+
+static void CleanInvalidateBuffer( uint8_t *p, uint32_t n ) {
+uint32_t a = (uint32_t) p&~31U;
+
+    SCB_CleanInvalidateDCache_by_Addr((uint32_t *) a,(((uint32_t) p+n+31)&~31U)-a);
+}
+
+static void InvalidateBuffer( uint8_t *p, uint32_t n ) {
+uint32_t a = (uint32_t) p&~31U;
+
+    SCB_InvalidateDCache_by_Addr((uint32_t *) a,(((uint32_t) p+n+31)&~31U)-a);
+}
+///@}
+
+/**
+ * @brief  Start the write (read=0) or read (read=1) phase of the first transaction
+ *
+ * @note   Writing CR2 with START generates a start or a repeated start
+ */
+static void StartPhase( int k, int read ) {
+const I2C_DMAConfiguration_t *c = &i2c_dmaconfiguration[k];
+I2C_Bus_t *bus = &i2c_bus[k];
+I2C_Transaction *t = bus->first;
+I2C_TypeDef *i2c = c->i2c;
+uint32_t n,chunk,cr2;
+
+    n = read ? t->nrx : t->ntx;
+    chunk = n > 255 ? 255 : n;
+    bus->remaining = n-chunk;
+    bus->phase = read ? PHASE_READ : PHASE_WRITE;
+
+    cr2 = ((t->addr<<1)&I2C_CR2_SADD_Msk)
+         |(chunk<<I2C_CR2_NBYTES_Pos)
+         |I2C_CR2_START;
+    if( read )
+        cr2 |= I2C_CR2_RD_WRN;
+    if( bus->remaining )
+        cr2 |= I2C_CR2_RELOAD;
+    else if( read || t->nrx == 0 )
+        cr2 |= I2C_CR2_AUTOEND;
+
+    i2c->CR1 &= ~(I2C_CR1_TXDMAEN|I2C_CR1_RXDMAEN);
+    if( n > 0 ) {
+        if( read ) {
+            DMA_Start(bus->rxdma,t->rxdata,0,n);
+            i2c->CR1 |= I2C_CR1_RXDMAEN;
+        } else {
+            DMA_Start(bus->txdma,t->txdata,0,n);
+            i2c->CR1 |= I2C_CR1_TXDMAEN;
+        }
+    }
+    i2c->CR2 = cr2;
+}
+
+/**
+ * @brief  Start the first transaction of the queue
+ */
+static void StartTransaction( int k ) {
+I2C_Bus_t *bus = &i2c_bus[k];
+I2C_Transaction *t = bus->first;
+
+    bus->error = 0;
+    bus->timer = I2C_TIMEOUT_MS;
+    if( t->ntx )
+        CleanBuffer(t->txdata,t->ntx);
+    if( t->nrx )
+        CleanInvalidateBuffer(t->rxdata,t->nrx);
+    i2c_dmaconfiguration[k].i2c->ICR = I2C_ICR_NACKCF|I2C_ICR_STOPCF
+                                      |I2C_ICR_BERRCF|I2C_ICR_ARLOCF|I2C_ICR_OVRCF;
+    StartPhase(k,t->ntx == 0 && t->nrx > 0);
+}
+
+/**
+ * @brief  Finish the first transaction with status and start the next one
+ *
+ * @note   Called from the interrupts
+ */
+static void CompleteTransaction( int k, int status ) {
+const I2C_DMAConfiguration_t *c = &i2c_dmaconfiguration[k];
+I2C_Bus_t *bus = &i2c_bus[k];
+I2C_Transaction *t = bus->first;
+
+    c->i2c->CR1 &= ~(I2C_CR1_TXDMAEN|I2C_CR1_RXDMAEN);
+    DMA_Stop(bus->rxdma);
+    DMA_Stop(bus->txdma);
+    bus->phase = PHASE_IDLE;
+    if( !t )
+        return;
+
+    if( t->nrx )
+        InvalidateBuffer(t->rxdata,t->nrx);
+
+    bus->first = t->next;
+    if( !bus->first )
+        bus->last = 0;
+    else
+        StartTransaction(k);
+
+    t->status = status;
+    if( t->callback )
+        t->callback(t->arg,status);
+}
+
+/**
+ * @brief  Abort the first transaction, resetting the I2C state machine
+ *
+ * @note   PE=0 releases the bus. See I2CMaster_Disable
+ */
+static void AbortTransaction( int k, int status ) {
+I2C_TypeDef *i2c = i2c_dmaconfiguration[k].i2c;
+
+    i2c->CR1 &= ~I2C_CR1_PE;
+    i2c->CR1 &= ~I2C_CR1_PE;
+    i2c->CR1 &= ~I2C_CR1_PE;
+    i2c->CR1 |= I2C_CR1_PE;
+    CompleteTransaction(k,status);
+}
+
+/**
+ * @brief  Enable interrupts and DMA for a bus. Called by I2CMaster_Init
+ *
+ * @note   The DMA streams are allocated once and kept when the bus is
+ *         initialized again. Bytes, direct mode, no DMA interrupts (the I2C
+ *         interrupts tell when a phase ends)
+ */
+static int I2CMaster_EngineInit( I2C_TypeDef *i2c ) {
+const I2C_DMAConfiguration_t *c;
+I2C_Bus_t *bus;
+DMA_Config dc;
+int k;
+
+    k = FindBus(i2c);
+    if( k < 0 )
+        return -1;
+    c   = &i2c_dmaconfiguration[k];
+    bus = &i2c_bus[k];
+
+    if( !bus->dmaready ) {
+        bus->rxdma = DMA_Allocate(c->rxrequest);
+        if( bus->rxdma < 0 )
+            return bus->rxdma;
+        bus->txdma = DMA_Allocate(c->txrequest);
+        if( bus->txdma < 0 ) {
+            DMA_Free(bus->rxdma);
+            return bus->txdma;
+        }
+        bus->dmaready = 1;
+    }
+    dc.psize    = DMA_SIZE_8;
+    dc.msize    = DMA_SIZE_8;
+    dc.burst    = DMA_BURST_SINGLE;
+    dc.priority = 1;
+    dc.flags    = DMA_FLAG_MINC;
+    dc.callback = 0;
+    dc.arg      = 0;
+    dc.dir      = DMA_DIR_P2M;
+    dc.periph   = &(i2c->RXDR);
+    DMA_Configure(bus->rxdma,&dc);
+    dc.dir      = DMA_DIR_M2P;
+    dc.periph   = &(i2c->TXDR);
+    DMA_Configure(bus->txdma,&dc);
+
+    i2c_bus[k].first = i2c_bus[k].last = 0;
+    i2c_bus[k].phase = PHASE_IDLE;
+
+    i2c->CR1 |= I2C_CR1_TCIE|I2C_CR1_STOPIE|I2C_CR1_NACKIE|I2C_CR1_ERRIE;
+
+    NVIC_SetPriority(c->evirq,I2C_IRQ_PRIO);
+    NVIC_SetPriority(c->erirq,I2C_IRQ_PRIO);
+    NVIC_EnableIRQ(c->evirq);
+    NVIC_EnableIRQ(c->erirq);
     return 0;
 }
 
+/**
+ * @brief  I2CMaster_Submit
+ *
+ * @note   Appends a transaction to the queue of the bus. It is started at once
+ *         when the bus is idle. The transaction (and its buffers) must not be
+ *         changed until its status is not I2C_TRANSACTION_PENDING
+ *
+ * @note   Can be called from interrupts, including completion callbacks
+ *
+ * @return 0 if queued, negative for invalid parameters
+ */
+int
+I2CMaster_Submit( I2C_TypeDef *i2c, I2C_Transaction *t ) {
+uint32_t primask;
+int k;
+
+    k = FindBus(i2c);
+    if( k < 0 || (t->ntx && !t->txdata) || (t->nrx && !t->rxdata) )
+        return -1;
+
+    t->status = I2C_TRANSACTION_PENDING;
+    t->next   = 0;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if( i2c_bus[k].last )
+        i2c_bus[k].last->next = t;
+    else
+        i2c_bus[k].first = t;
+    i2c_bus[k].last = t;
+    if( i2c_bus[k].phase == PHASE_IDLE )
+        StartTransaction(k);
+    __set_PRIMASK(primask);
+
+    return 0;
+}
+
+/**
+ * @brief  I2CMaster_ProcessTimeouts
+ *
+ * @note   Must be called every ms
+ */
+void
+I2CMaster_ProcessTimeouts( void ) {
+uint32_t primask;
+unsigned k;
+
+    for(k=0;k<I2C_NBUSES;k++) {
+        if( i2c_bus[k].phase == PHASE_IDLE )
+            continue;
+        primask = __get_PRIMASK();
+        __disable_irq();
+        if( i2c_bus[k].phase != PHASE_IDLE && --i2c_bus[k].timer == 0 )
+            AbortTransaction(k,I2C_TRANSACTION_TIMEOUT);
+        __set_PRIMASK(primask);
+    }
+}
+
+/**
+ * @brief Process I2C Event Interrupt
+ */
+void
+I2CMaster_ProcessEvent( I2C_TypeDef *i2c ) {
+I2C_Bus_t *bus;
+I2C_Transaction *t;
+uint32_t isr,chunk,cr2;
+int k;
+
+    k = FindBus(i2c);
+    if( k < 0 )
+        return;
+    bus = &i2c_bus[k];
+    t   = bus->first;
+    isr = i2c->ISR;
+
+    if( isr&I2C_ISR_NACKF ) {
+        // Without AUTOEND, the STOP must be generated by software
+        i2c->ICR = I2C_ICR_NACKCF;
+        bus->error = I2C_TRANSACTION_NACK;
+        if( (i2c->CR2&I2C_CR2_AUTOEND) == 0 )
+            i2c->CR2 |= I2C_CR2_STOP;
+    }
+
+    if( (isr&I2C_ISR_TCR) && t ) {
+        // Next chunk of the phase. The last one ends with AUTOEND or TC
+        chunk = bus->remaining > 255 ? 255 : bus->remaining;
+        bus->remaining -= chunk;
+        cr2 = (i2c->CR2&~(I2C_CR2_NBYTES_Msk|I2C_CR2_RELOAD|I2C_CR2_AUTOEND))
+             |(chunk<<I2C_CR2_NBYTES_Pos);
+        if( bus->remaining )
+            cr2 |= I2C_CR2_RELOAD;
+        else if( bus->phase == PHASE_READ || t->nrx == 0 )
+            cr2 |= I2C_CR2_AUTOEND;
+        i2c->CR2 = cr2;
+    }
+
+    if( (isr&I2C_ISR_TC) && t ) {
+        if( bus->phase == PHASE_WRITE && t->nrx > 0 && !bus->error )
+            StartPhase(k,1);
+        else
+            i2c->CR2 |= I2C_CR2_STOP;
+    }
+
+    if( isr&I2C_ISR_STOPF ) {
+        i2c->ICR = I2C_ICR_STOPCF;
+        if( bus->phase != PHASE_IDLE )
+            CompleteTransaction(k,bus->error);
+    }
+}
+
+/**
+ * @brief Process I2C Error Interrupt
+ *
+ * @note  After a bus error or an arbitration loss, the I2C releases the bus and
+ *        no STOPF is generated. The transaction is aborted.
+ */
+void
+I2CMaster_ProcessError( I2C_TypeDef *i2c ) {
+uint32_t isr;
+int k;
+
+    k = FindBus(i2c);
+    if( k < 0 )
+        return;
+    isr = i2c->ISR;
+    i2c->ICR = I2C_ICR_BERRCF|I2C_ICR_ARLOCF|I2C_ICR_OVRCF;
+
+    if( i2c_bus[k].phase == PHASE_IDLE )
+        return;
+    if( isr&I2C_ISR_ARLO )
+        AbortTransaction(k,I2C_TRANSACTION_ARLO);
+    else if( isr&(I2C_ISR_BERR|I2C_ISR_OVR) )
+        AbortTransaction(k,I2C_TRANSACTION_BUSERROR);
+}
+
+#ifndef I2C_DONT_IMPLEMENT_IRQ
+/**
+ * @brief I2C Event and Error interrupts
+ */
+///@{
+void I2C1_EV_IRQHandler(void) {
+
+    I2CMaster_ProcessEvent(I2C1);
+}
+
+void I2C1_ER_IRQHandler(void) {
+
+    I2CMaster_ProcessError(I2C1);
+}
+
+void I2C2_EV_IRQHandler(void) {
+
+    I2CMaster_ProcessEvent(I2C2);
+}
+
+void I2C2_ER_IRQHandler(void) {
+
+    I2CMaster_ProcessError(I2C2);
+}
+
+void I2C3_EV_IRQHandler(void) {
+
+    I2CMaster_ProcessEvent(I2C3);
+}
+
+void I2C3_ER_IRQHandler(void) {
+
+    I2CMaster_ProcessError(I2C3);
+}
+
+void I2C4_EV_IRQHandler(void) {
+
+    I2CMaster_ProcessEvent(I2C4);
+}
+
+void I2C4_ER_IRQHandler(void) {
+
+    I2CMaster_ProcessError(I2C4);
+}
+///@}
+#endif
+
+/**
+ * @brief  Transfer
+ *
+ * @note   Queues a transaction and waits for it. It must not be called from an
+ *         interrupt with priority equal or higher than I2C_IRQ_PRIO
+ */
+static int
+I2CMaster_Transfer( I2C_TypeDef *i2c, uint16_t addr, uint8_t *txdata, uint16_t ntx,
+                    uint8_t *rxdata, uint16_t nrx ) {
+I2C_Transaction t;
+int rc;
+
+    t.addr     = addr;
+    t.txdata   = txdata;
+    t.ntx      = ntx;
+    t.rxdata   = rxdata;
+    t.nrx      = nrx;
+    t.callback = 0;
+    t.arg      = 0;
+    rc = I2CMaster_Submit(i2c,&t);
+    if( rc < 0 )
+        return rc;
+    while( t.status == I2C_TRANSACTION_PENDING ) {}
+    return t.status;
+}
+
 /**
  * @brief I2CMaster_Write
  *
- * @note  Send the *n* bytes in the *data array* to slave *addr*
+ * @note  Send the *n* bytes in the *data array* to slave *addr* and waits
  *
  * @param i2c
- * @param address
+ * @param address (7 bit)
  * @param data
  * @param n
- * @return int
+ * @return int: 0 if OK, negative (I2C_TRANSACTION_*) for error
  */
 int
 I2CMaster_Write( I2C_TypeDef *i2c, uint16_t addr, uint8_t *data, uint16_t nbytes) {
-uint8_t *p = data;
-
-    i2c->CR2 =   (i2c->CR2 & ~(
-                     I2C_CR2_SADD_Msk
-                    |I2C_CR2_NBYTES_Msk
-                    |I2C_CR2_ADD10
-                    |I2C_CR2_RD_WRN
-                    |I2C_CR2_HEAD10R
-                    |I2C_CR2_RELOAD
-                    )
-                 )
-                |((addr<<I2C_CR2_SADD_Pos)&I2C_CR2_START_Msk)
-                |((nbytes<<I2C_CR2_NBYTES_Pos)&I2C_CR2_NBYTES_Msk)
-                |I2C_CR2_AUTOEND;
-#ifdef USE_POLLING
-    i2c->TXDR = *p++;
-    i2c->CR2 |= I2C_CR2_START;
-    while(1) {
-        while( (i2c->ISR&I2C_ISR_TXIS) == 0 ) {}
-        nbytes--;
-        if( nbytes == 0 )
-            break;
-        i2c->TXDR = *p++;
-    }
-    i2c->CR2 |= I2C_CR2_STOP;  // should be set before last byte ?
-#endif
-    return 0;
+
+    return I2CMaster_Transfer(i2c,addr,data,nbytes,0,0);
 }
 
 /**
  * @brief I2CMaster_Read
  *
- * @note  Read *n* bytes into the *data array* from slave *addr*
+ * @note  Read *n* bytes into the *data array* from slave *addr* and waits
  *
  * @param i2c
- * @param address
+ * @param address (7 bit)
  * @param data
  * @param n
- * @return int
+ * @return int: 0 if OK, negative (I2C_TRANSACTION_*) for error
  */
 int
 I2CMaster_Read( I2C_TypeDef *i2c, uint16_t addr, uint8_t *data, uint16_t nbytes) {
-uint8_t *p = data;
-
-    i2c->CR2 =   (i2c->CR2 & ~(
-                     I2C_CR2_SADD_Msk
-                    |I2C_CR2_NBYTES_Msk
-                    |I2C_CR2_ADD10
-                    |I2C_CR2_HEAD10R
-                    |I2C_CR2_RELOAD
-                    )
-                 )
-                |((addr<<I2C_CR2_SADD_Pos)&I2C_CR2_START_Msk)
-                |((nbytes<<I2C_CR2_NBYTES_Pos)&I2C_CR2_NBYTES_Msk)
-                |I2C_CR2_AUTOEND
-                |I2C_CR2_RD_WRN;
-#ifdef USE_POLLING
-    i2c->CR2 |= I2C_CR2_START;
-    while(nbytes--) {
-        while( (i2c->ISR&I2C_ISR_RXNE) == 0 ) {}
-        *p++ = i2c->RXDR;
-        nbytes--;
-    }
-#endif
 
-    return 0;
+    return I2CMaster_Transfer(i2c,addr,0,0,data,nbytes);
+}
+
+/**
+ * @brief I2CMaster_WriteAndRead
+ *
+ * @note  Write *nwrite* bytes and, after a repeated start, read *nread* bytes
+ *
+ * @return int: 0 if OK, negative (I2C_TRANSACTION_*) for error
+ */
+int
+I2CMaster_WriteAndRead( I2C_TypeDef *i2c, uint16_t addr,
+                        uint8_t *writedata, int nwrite,
+                        uint8_t *readdata,  int nread ) {
+
+    if( nwrite < 0 || nwrite > 65535 || nread < 0 || nread > 65535 )
+        return -1;
+    return I2CMaster_Transfer(i2c,addr,writedata,nwrite,readdata,nread);
 }
@@ -54,6 +54,58 @@
 #define I2C_TIMING_FASTPLUS_DNF_1       0x00200004
 #define I2C_TIMING_FASTPLUS_DNF_2       0x00200003
 
+/**
+ * @brief   Transaction status
+ */
+///@{
+#define I2C_TRANSACTION_OK              (0)
+#define I2C_TRANSACTION_PENDING         (1)
+#define I2C_TRANSACTION_NACK            (-1)
+#define I2C_TRANSACTION_BUSERROR        (-2)
+#define I2C_TRANSACTION_ARLO            (-3)
+#define I2C_TRANSACTION_TIMEOUT         (-4)
+///@}
+
+/**
+ * @brief   Maximal duration of a transaction (ms)
+ */
+#ifndef I2C_TIMEOUT_MS
+#define I2C_TIMEOUT_MS                  (25)
+#endif
+
+/**
+ * @brief   Priority of the I2C interrupts
+ */
+#ifndef I2C_IRQ_PRIO
+#define I2C_IRQ_PRIO                    (14)
+#endif
+
+/**
+ * @brief   Completion callback
+ *
+ * @note    Called from the I2C interrupt with the transaction status
+ */
+typedef void (*I2C_Callback)(void *arg, int status);
+
+/**
+ * @brief   Transaction
+ *
+ * @note    Write ntx bytes (if any) and then, after a repeated start, read nrx
+ *          bytes (if any). With both zero, only the address is sent (detect).
+ *          Storage is provided by the caller and linked in the bus queue.
+ */
+typedef struct I2C_Transaction_s {
+    uint16_t                    addr;       ///< 7 bit slave address
+    uint16_t                    ntx;
+    uint8_t                     *txdata;
+    uint16_t                    nrx;
+    uint8_t                     *rxdata;
+    I2C_Callback                callback;   ///< can be null
+    void                        *arg;
+    volatile int                status;     ///< I2C_TRANSACTION_*
+    struct I2C_Transaction_s    *next;      ///< internal
+} I2C_Transaction;
+
 int I2CMaster_Init(         I2C_TypeDef *i2c,
                             uint32_t conf,
                             uint32_t timing
@@ -77,4 +129,12 @@ int I2CMaster_WriteAndRead( I2C_TypeDef *i2c,
                             uint8_t *readdata,  int nread
                             );
 
+int I2CMaster_Submit(       I2C_TypeDef *i2c,
+                            I2C_Transaction *t
+                            );
+
+void I2CMaster_ProcessTimeouts(void);
+void I2CMaster_ProcessEvent( I2C_TypeDef *i2c );
+void I2CMaster_ProcessError( I2C_TypeDef *i2c );
+
 #endif // I2C_MASTER_H
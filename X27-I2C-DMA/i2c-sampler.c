@@ -0,0 +1,187 @@
+/**
+ * @file    i2c-sampler.c
+ *
+ * @brief   Periodic sampling of I2C sensors over the transaction queue
+ *
+ * @note    The sensors are kept in a list ordered by bus and period, so the
+ *          reads submitted by a tick for one bus are adjacent and the shorter
+ *          periods go first in its queue
+ *
+ * @note    A read writes data[(seq+1)&1], the buffer not published. It is the
+ *          buffer of sample seq-1, so I2CSampler_Read, that copies data[seq&1],
+ *          is never overwritten while seq does not change
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <string.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "i2c-master.h"
+#include "i2c-sampler.h"
+
+/**
+ * @brief   Sensor list and time (ms)
+ */
+///@{
+static I2CSampler_Sensor    *sensors = 0;
+static volatile uint32_t    ticks = 0;
+///@}
+
+/**
+ * @brief   Completion callback
+ *
+ * @note    Called from the I2C interrupt. The new sample is published by
+ *          incrementing seq after the timestamp
+ */
+static void
+Completed( void *arg, int status ) {
+I2CSampler_Sensor *s = arg;
+
+    s->status = status;
+    if( status == I2C_TRANSACTION_OK ) {
+        s->time[(s->seq+1)&1] = s->start;
+        __DMB();
+        s->seq++;
+    } else {
+        s->errors++;
+    }
+    s->busy = 0;
+}
+
+/**
+ * @brief   I2CSampler_Add
+ *
+ * @note    regsize is the size of the register address (0, 1 or 2 bytes). With
+ *          0, only the read is done. The first read is done at the next tick
+ */
+int
+I2CSampler_Add( I2CSampler_Sensor *s, I2C_TypeDef *i2c, uint16_t address,
+                uint16_t reg, int regsize, uint16_t n, uint32_t period ) {
+I2CSampler_Sensor **p;
+uint32_t primask;
+
+    if( !s || !i2c || n == 0 || n > I2CSAMPLER_MAXDATA || period == 0
+        || regsize < 0 || regsize > 2 )
+        return I2CSAMPLER_ERROR_PARAM;
+
+    s->i2c     = i2c;
+    s->n       = n;
+    s->period  = period;
+    s->seq     = 0;
+    s->status  = I2C_TRANSACTION_OK;
+    s->errors  = 0;
+    s->skipped = 0;
+    s->busy    = 0;
+    if( regsize == 2 ) {
+        s->reg[0] = reg>>8;
+        s->reg[1] = reg;
+    } else {
+        s->reg[0] = reg;
+    }
+    s->t.addr     = address;
+    s->t.ntx      = regsize;
+    s->t.txdata   = s->reg;
+    s->t.nrx      = n;
+    s->t.callback = Completed;
+    s->t.arg      = s;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    s->due = ticks+1;
+    p = &sensors;
+    while( *p && ( (uint32_t) (*p)->i2c < (uint32_t) i2c
+                || ((*p)->i2c == i2c && (*p)->period <= period) ) )
+        p = &(*p)->next;
+    s->next = *p;
+    *p = s;
+    __set_PRIMASK(primask);
+
+    return I2CSAMPLER_OK;
+}
+
+/**
+ * @brief   I2CSampler_Remove
+ *
+ * @note    Waits for the read in the queue. Must not be called from interrupts.
+ *          Returns I2CSAMPLER_ERROR_PARAM when s is not in the list
+ */
+int
+I2CSampler_Remove( I2CSampler_Sensor *s ) {
+I2CSampler_Sensor **p;
+uint32_t primask;
+int found;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    p = &sensors;
+    while( *p && *p != s )
+        p = &(*p)->next;
+    found = (*p != 0);
+    if( found )
+        *p = s->next;
+    __set_PRIMASK(primask);
+
+    if( !found )
+        return I2CSAMPLER_ERROR_PARAM;
+    while( s->busy ) {}
+    return I2CSAMPLER_OK;
+}
+
+/**
+ * @brief   I2CSampler_Read
+ *
+ * @note    Copies the last sample into buf (n bytes) and its time (if not
+ *          null). Returns its number, 0 when there is no sample yet
+ */
+uint32_t
+I2CSampler_Read( I2CSampler_Sensor *s, uint8_t *buf, uint32_t *time ) {
+uint32_t seq;
+
+    do {
+        seq = s->seq;
+        if( seq == 0 )
+            return 0;
+        __DMB();
+        memcpy(buf,s->data[seq&1],s->n);
+        if( time )
+            *time = s->time[seq&1];
+        __DMB();
+    } while( seq != s->seq );
+
+    return seq;
+}
+
+/**
+ * @brief   I2CSampler_Tick
+ *
+ * @note    Must be called every ms. Submits the reads that are due. A sensor
+ *          whose previous read is still in the queue skips the period
+ */
+void
+I2CSampler_Tick( void ) {
+I2CSampler_Sensor *s;
+uint32_t now;
+
+    now = ++ticks;
+    for(s=sensors;s;s=s->next) {
+        if( (int32_t) (now-s->due) < 0 )
+            continue;
+        s->due += s->period;
+        if( (int32_t) (now-s->due) >= 0 )       // late: resynchronize
+            s->due = now+s->period;
+        if( s->busy ) {
+            s->skipped++;
+            continue;
+        }
+        s->busy     = 1;
+        s->start    = now;
+        s->t.rxdata = s->data[(s->seq+1)&1];
+        if( I2CMaster_Submit(s->i2c,&s->t) < 0 ) {
+            s->errors++;
+            s->busy = 0;
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef I2C_SAMPLER_H
+#define I2C_SAMPLER_H
+/**
+ * @file    i2c-sampler.h
+ *
+ * @brief   Periodic sampling of I2C sensors over the transaction queue
+ *
+ * @note    Each sensor registers a block read (register address written, then
+ *          n bytes read after a repeated start) and a period in ms. At each
+ *          I2CSampler_Tick, the reads that are due are submitted together, so
+ *          the reads of the same bus are queued back to back and the interrupt
+ *          of i2c-master.c starts each one at the STOP of the previous one,
+ *          without the main loop
+ *
+ * @note    The bytes are read by DMA into the back buffer of a double buffer.
+ *          When the read succeeds, the buffers are swapped and the sample
+ *          counter is incremented. I2CSampler_Read copies the front buffer
+ *          without locks, and copies again when a new sample arrived meanwhile
+ *
+ * @note    I2CSampler_Tick must be called every ms, e.g., from SysTick_Handler
+ *          with I2CMaster_ProcessTimeouts. The buses must be initialized by
+ *          I2CMaster_Init
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "stm32f746xx.h"
+#include "i2c-master.h"
+
+/**
+ * @brief   Maximal size of a sample
+ *
+ * @note    Multiple of 32, so each buffer fills whole cache lines
+ */
+#ifndef I2CSAMPLER_MAXDATA
+#define I2CSAMPLER_MAXDATA          32
+#endif
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define I2CSAMPLER_OK               (0)
+#define I2CSAMPLER_ERROR_PARAM      (-1)
+///@}
+
+/**
+ * @brief   Sensor
+ *
+ * @note    Storage provided by the caller and linked in the sampler list. The
+ *          fields are set by I2CSampler_Add and must only be read. seq is the
+ *          number of samples read; the last one is in data[seq&1]. skipped
+ *          counts the periods where the previous read was still in the queue
+ */
+typedef struct I2CSampler_Sensor_s {
+    uint8_t                     data[2][I2CSAMPLER_MAXDATA] __attribute__((aligned(32)));
+    I2C_TypeDef                 *i2c;
+    uint16_t                    n;          ///< bytes of a sample
+    uint8_t                     reg[2];     ///< register address (MSB first)
+    uint32_t                    period;     ///< ms
+    volatile uint32_t           seq;
+    volatile uint32_t           time[2];    ///< tick at the start of each sample
+    volatile int                status;     ///< of the last read (I2C_TRANSACTION_*)
+    volatile uint32_t           errors;
+    volatile uint32_t           skipped;
+    volatile int                busy;       ///< internal
+    uint32_t                    due;        ///< internal
+    uint32_t                    start;      ///< internal
+    I2C_Transaction             t;          ///< internal
+    struct I2CSampler_Sensor_s  *next;      ///< internal
+} I2CSampler_Sensor;
+
+int      I2CSampler_Add(     I2CSampler_Sensor *s,
+                             I2C_TypeDef *i2c,
+                             uint16_t address,
+                             uint16_t reg, int regsize,
+                             uint16_t n,
+                             uint32_t period
+                             );
+
+int      I2CSampler_Remove(  I2CSampler_Sensor *s );
+uint32_t I2CSampler_Read(    I2CSampler_Sensor *s, uint8_t *buf, uint32_t *time );
+void     I2CSampler_Tick(    void );
+
+#endif // I2C_SAMPLER_H
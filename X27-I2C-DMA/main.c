@@ -14,6 +14,17 @@
 #include "stm32f746xx.h"
 #include "system_stm32f746.h"
 #include "led.h"
+#ifdef DMA_MEMCPY_BENCHMARK
+#include <stdio.h>
+#include <string.h>
+#include "sdram.h"
+#include "dma.h"
+#endif
+#ifdef I2C_SAMPLER_DEMO
+#include <stdio.h>
+#include "i2c-master.h"
+#include "i2c-sampler.h"
+#endif
 
 
 #define OPERATING_FREQUENCY (200000000)
@@ -41,6 +52,132 @@ void ms_delay(volatile int ms) {
 
 
 
+#ifdef DMA_MEMCPY_BENCHMARK
+/**
+ * @brief   Benchmark of memcpy and DMA_Memcpy
+ *
+ * @note    Copies blocks of several sizes between DTCM, SRAM1 and SDRAM and
+ *          prints the rate (MB/s) of memcpy and of DMA_Memcpy (synchronous, with
+ *          the cache maintenance and forcing DMA for all sizes), measured with the
+ *          DWT cycle counter. The SRAM1 area (BENCH_SRAM1) must not be used by the
+ *          program (.bss and stack)
+ */
+///@{
+#define BENCH_BLOCK     (16384)
+#define BENCH_SRAM1     ((uint8_t *) 0x20020000)
+#define BENCH_SDRAM     ((uint8_t *) SDRAM_ADDRESS)
+
+static uint8_t benchdtcm[2][BENCH_BLOCK] __attribute__((aligned(32)));
+
+static const uint32_t benchsizes[] = { 64, 256, 1024, 4096, 16384 };
+
+static uint32_t Rate( uint32_t n, uint32_t cycles ) {
+
+    if( cycles == 0 )
+        return 0;
+    return (uint32_t) (((uint64_t) n*SystemCoreClock)/cycles/1000000);
+}
+
+static void BenchmarkPair( const char *name, uint8_t *dst, uint8_t *src ) {
+uint32_t cpu,dma,t0;
+unsigned i;
+
+    printf("%-14s",name);
+    for(i=0;i<sizeof(benchsizes)/sizeof(benchsizes[0]);i++) {
+        t0 = DWT->CYCCNT;
+        memcpy(dst,src,benchsizes[i]);
+        cpu = DWT->CYCCNT-t0;
+        t0 = DWT->CYCCNT;
+        DMA_Memcpy(dst,src,benchsizes[i],0,0);
+        dma = DWT->CYCCNT-t0;
+        printf(" %5lu/%-5lu",Rate(benchsizes[i],cpu),Rate(benchsizes[i],dma));
+    }
+    printf("\n");
+}
+
+static void DMAMemcpyBenchmark( void ) {
+unsigned i;
+
+    if( (uint32_t) &benchdtcm[1][BENCH_BLOCK-1] >= 0x20010000 ) {
+        printf("Benchmark buffers are not in DTCM\n");
+        return;
+    }
+    SDRAM_Init();
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    DMA_SetMemcpyThreshold(0);
+
+    for(i=0;i<BENCH_BLOCK;i++)
+        benchdtcm[0][i] = BENCH_SRAM1[i] = BENCH_SDRAM[i] = i;
+
+    printf("memcpy/DMA_Memcpy (MB/s) for");
+    for(i=0;i<sizeof(benchsizes)/sizeof(benchsizes[0]);i++)
+        printf(" %5lu",benchsizes[i]);
+    printf(" bytes\n");
+    BenchmarkPair("DTCM->DTCM",  benchdtcm[1],benchdtcm[0]);
+    BenchmarkPair("DTCM->SRAM1", BENCH_SRAM1,benchdtcm[0]);
+    BenchmarkPair("SRAM1->DTCM", benchdtcm[1],BENCH_SRAM1);
+    BenchmarkPair("SRAM1->SDRAM",BENCH_SDRAM,BENCH_SRAM1);
+    BenchmarkPair("SDRAM->SRAM1",BENCH_SRAM1,BENCH_SDRAM+BENCH_BLOCK);
+    BenchmarkPair("SDRAM->SDRAM",BENCH_SDRAM+BENCH_BLOCK,BENCH_SDRAM);
+    BenchmarkPair("SDRAM->DTCM", benchdtcm[1],BENCH_SDRAM);
+
+    DMA_SetMemcpyThreshold(DMA_MEMCPY_THRESHOLD);
+}
+///@}
+#endif
+
+#ifdef I2C_SAMPLER_DEMO
+/**
+ * @brief   Sampling of the devices on I2C3
+ *
+ * @note    The touch controller (0x38) status registers are read every 10 ms
+ *          and the audio codec (0x1A) ID register (16 bit address) every 500 ms.
+ *          Both reads are queued by SysTick_Handler. The main loop prints the
+ *          last samples each second without accessing the bus
+ */
+///@{
+static I2CSampler_Sensor touchsensor;
+static I2CSampler_Sensor codecsensor;
+static volatile uint32_t seconds = 0;
+
+void SysTick_Handler(void) {
+static uint32_t ms = 0;
+
+    I2CMaster_ProcessTimeouts();
+    I2CSampler_Tick();
+    if( ++ms == 1000 ) {
+        ms = 0;
+        seconds++;
+    }
+}
+
+static void I2CSamplerDemo( void ) {
+uint8_t touch[16];
+uint8_t codec[2];
+uint32_t last = 0;
+uint32_t n,t;
+
+    I2CMaster_Init(I2C3,I2C_CONF_MODE_FAST,I2C_TIMING_FAST_ANALOG);
+    I2CSampler_Add(&touchsensor,I2C3,0x38,0x00,1,sizeof(touch),10);
+    I2CSampler_Add(&codecsensor,I2C3,0x1A,0x0000,2,sizeof(codec),500);
+    SysTick_Config(SystemCoreClock/1000);
+
+    for(;;) {
+        while( seconds == last ) {}
+        last = seconds;
+        n = I2CSampler_Read(&touchsensor,touch,&t);
+        printf("touch: %lu samples (%lu skipped, %lu errors) last at %lu ms: points %u\n",
+                n,touchsensor.skipped,touchsensor.errors,t,touch[2]&0xF);
+        n = I2CSampler_Read(&codecsensor,codec,&t);
+        printf("codec: %lu samples (%lu errors) ID %02X%02X\n",
+                n,codecsensor.errors,codec[0],codec[1]);
+    }
+}
+///@}
+#endif
+
 /**
  * @brief   main
  *
@@ -58,6 +195,14 @@ int main(void) {
 
     SystemConfigPLLSAI(&PLLSAIConfiguration_48MHz);
 
+#ifdef DMA_MEMCPY_BENCHMARK
+    DMAMemcpyBenchmark();
+#endif
+
+#ifdef I2C_SAMPLER_DEMO
+    I2CSamplerDemo();
+#endif
+
     /*
      * Blink LED
      */
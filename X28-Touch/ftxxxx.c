@@ -255,23 +255,6 @@
  *    DDDDDDDD = Data
  */
 
-
-/**
- * @brief Addresses of first register of touch info
- *
- * @note  Its size must be equal to maximum number of touch points
- */
-
-static uint16_t touchaddr[] = {
-    FTXXXX_REG_TOUCH1_XH,
-    FTXXXX_REG_TOUCH2_XH,
-    FTXXXX_REG_TOUCH3_XH,
-    FTXXXX_REG_TOUCH4_XH,
-    FTXXXX_REG_TOUCH5_XH,
-};
-
-static uint16_t touchmax = sizeof(touchaddr)/sizeof(uint16_t);
-
 #define I2C_INTERFACE       I2C3
 #define I2C_ADDRESS         0x38
 
@@ -302,6 +285,45 @@ static const GPIO_PinConfiguration interruptpin = {
     .initial =  0,
 } ;
 
+/**
+ * @brief Interrupt driven sampling
+ *
+ * @note  In trigger mode (ID_G_MODE=1), the FT5336 pulses the INT pin when a
+ *        new sample is ready. The EXTI interrupt starts an asynchronous read of
+ *        the registers 00h-20h (one I2C transaction, by DMA) and the I2C
+ *        interrupt parses them and calls the sample callback. When the previous
+ *        read has not finished, the sample is skipped and counted.
+ */
+///@{
+static FTXXXX_Callback  samplecallback = 0;
+static uint8_t          samplebuffer[64] __attribute__((aligned(32)));
+static uint32_t         sampletime = 0;
+static uint32_t         skipped = 0;
+static FTXXXX_Info      sampleinfo;
+
+static void SampleDone(void *arg, int status) {
+
+    if( status == 0 )
+        FTXXXX_ParseRegisters(samplebuffer,&sampleinfo);
+    else
+        sampleinfo.npoints = 0;
+    if( samplecallback )
+        samplecallback(&sampleinfo,sampletime,status);
+}
+
+static void StartSample(void) {
+
+    if( I2CMaster_IsBusy(I2C_INTERFACE) ) {
+        skipped++;
+        return;
+    }
+    sampletime = DWT->CYCCNT;
+    if( I2CMaster_ReadRegistersDMA(I2C_INTERFACE,I2C_ADDRESS,0,
+                            samplebuffer,FTXXXX_SAMPLESIZE,SampleDone,0) < 0 )
+        skipped++;
+}
+///@}
+
 /**
  * @brief Interrupt routine for the Touch Controller
  *
@@ -322,6 +344,8 @@ void FTXXXX_ProcessInterrupt(void) {
     if( (EXTI->PR&INTPINMASK)!=0 ) {
         state = 1;
         EXTI->PR = INTPINMASK;
+        if( samplecallback )
+            StartSample();
     }
 }
 
@@ -383,7 +407,7 @@ int16_t t = state;
  * @returns 0 if no touch, >0 if a touch is detected
  */
 int
-FTXXX_ReadInterruptPinStatus(void) {
+FTXXXX_ReadInterruptPinStatus(void) {
 uint32_t s;
 
     s = interruptpin.gpio->IDR&INTPINMASK;
@@ -452,8 +476,7 @@ int rc;
 int FTXXXX_ReadRegister( uint8_t reg, uint8_t *pdata ) {
 int rc;
 
-    rc = I2CMaster_Write( I2C_INTERFACE, I2C_ADDRESS, &reg, 1 );
-    rc = I2CMaster_Read( I2C_INTERFACE, I2C_ADDRESS, pdata, 1 );
+    rc = I2CMaster_WriteRead( I2C_INTERFACE, I2C_ADDRESS, &reg, 1, pdata, 1 );
 
     return rc;
 }
@@ -485,8 +508,7 @@ int rc;
 int FTXXXX_ReadSequentialRegisters( uint8_t startreg, uint8_t *pdata, int n ) {
 int rc;
 
-    rc = I2CMaster_Write( I2C_INTERFACE, I2C_ADDRESS, &startreg, 1 );
-    rc = I2CMaster_Read( I2C_INTERFACE, I2C_ADDRESS, pdata, n );
+    rc = I2CMaster_WriteRead( I2C_INTERFACE, I2C_ADDRESS, &startreg, 1, pdata, n );
 
     return rc;
 }
@@ -498,53 +520,97 @@ int rc;
 /**
  * @brief Return touch info
  *
+ * @note  Registers 00h to 20h (status, gesture and all points) are read in a
+ *        single transaction
+ *
  * @param touchinfo a pointer to a TouchInfo struct
  *
  * @return the number of touches
  */
 int
 FTXXXX_ReadTouchInfo( FTXXXX_Info *touchinfo ) {
-uint8_t r;
+uint8_t buffer[FTXXXX_SAMPLESIZE];
 int rc;
-uint8_t buffer[6];
 
-    // Get number of touch points
-    rc = FTXXXX_ReadRegister(FTXXXX_REG_TD_STATUS,&r);
+    rc = FTXXXX_ReadSequentialRegisters( 0, buffer, FTXXXX_SAMPLESIZE );
     if( rc < 0 )
-        goto error;
-    touchinfo->npoints = r&0xF;
+        return -1;
 
-    // Test if there are touch points
-    if( r == 0 )
-        return 0;
+    return FTXXXX_ParseRegisters(buffer,touchinfo);
+}
 
 
-    rc = FTXXXX_ReadRegister(FTXXXX_REG_GEST_ID,&r);
-    if( rc < 0 )
-        goto error;
-    touchinfo->gesture = r;
-
-    /* For each touch point:
-     *    buffer[0]=TOUCHn_XH contains Event Flag, Highest 4-bit of X
-     *    buffer[1]=TOUCHn_XL contains lowest 8-bit of X
-     *    buffer[2]=TOUCHn_YH contains Touch ID, Highest 4-bit of Y
-     *    buffer[3]=TOUCHn_YL contains lowest 8-bit of Y
-     *    buffer[4]=TOUCHn_WEIGHT contains weigth
-     *    buffer[5]=TOUCHn_MISC containts contains Touch area, Direction, Speed;
-     */
-    for(int i=0;i<touchinfo->npoints;i++) {
-        rc = FTXXXX_ReadSequentialRegisters( touchaddr[i], buffer, 6 );
-        if( rc < 0 )
-            goto error;
-        touchinfo->points[i].x = (buffer[0]&0xF)<<8|buffer[1];
-        touchinfo->points[i].y = (buffer[2]&0xF)<<8|buffer[3];
-        touchinfo->points[i].w = buffer[4];
+/**
+ * @brief  Parse touch info from registers
+ *
+ * @param  regs: contents of registers 00h to 20h (FTXXXX_SAMPLESIZE bytes)
+ *
+ * @return the number of touches
+ */
+int
+FTXXXX_ParseRegisters( const uint8_t *regs, FTXXXX_Info *touchinfo ) {
+const uint8_t *p;
+int n;
+
+    n = regs[FTXXXX_REG_TD_STATUS]&FTXXXX_TD_STATUS_NUM_MASK;
+    if( n > FTXXXX_MAXPOINTS )
+        n = FTXXXX_MAXPOINTS;
+    touchinfo->npoints = n;
+    touchinfo->gesture = regs[FTXXXX_REG_GEST_ID];
+
+    p = regs+FTXXXX_REG_TOUCH1_XH;
+    for(int i=0;i<n;i++,p+=6) {
+        touchinfo->points[i].x     = (p[0]&0xF)<<8|p[1];
+        touchinfo->points[i].y     = (p[2]&0xF)<<8|p[3];
+        touchinfo->points[i].w     = p[4];
+        touchinfo->points[i].id    = (p[2]&FTXXXX_TDx_YH_ID_MASK)>>FTXXXX_TDx_YH_ID_SHIFT;
+        touchinfo->points[i].event = (p[0]&FTXXXX_TDx_XH_EVENT_MASK)>>FTXXXX_TDx_XH_EVENT_SHIFT;
     }
+    return n;
+}
+
+/**
+ * @brief  Start interrupt driven sampling
+ *
+ * @note   Sets the trigger mode and enables the DWT cycle counter used to
+ *         timestamp samples. callback is called for each sample
+ *
+ * @note   The blocking read functions must not be used while sampling
+ *
+ * @return 0 if OK, negative for error.
+ */
+int
+FTXXXX_StartSampling( FTXXXX_Callback callback ) {
+int rc;
+
+    rc = FTXXXX_WriteRegister(FTXXXX_REG_MODE,FTXXXX_MODE_VAL_TRIGGER);
+    if( rc < 0 )
+        return rc;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
+    skipped = 0;
+    samplecallback = callback;
+    return 0;
+}
 
-    return touchinfo->npoints;
+/**
+ * @brief  Stop interrupt driven sampling
+ *
+ * @note   A read in progress finishes, but the callback is not called
+ */
+void
+FTXXXX_StopSampling( void ) {
 
-error:
-    return -1;
+    samplecallback = 0;
+}
 
+/**
+ * @brief  Get number of samples skipped because a read was in progress
+ */
+uint32_t
+FTXXXX_GetSkippedSamples( void ) {
 
+    return skipped;
 }
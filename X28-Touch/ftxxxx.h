@@ -37,9 +37,25 @@ typedef struct {
         uint16_t    x;      // X-pos
         uint16_t    y;      // Y-pos
         uint16_t    w;      // Weight
+        uint8_t     id;     // Touch ID (tracks a finger between samples)
+        uint8_t     event;  // Event flag (0=Down, 1=Up, 2=Contact)
     } points[FTXXXX_MAXPOINTS];
 } FTXXXX_Info;
 
+/**
+ * @brief   Number of registers read for a sample (0x00 to TOUCH5_MISC)
+ */
+#define FTXXXX_SAMPLESIZE                   (3+6*5)
+
+/**
+ * @brief   Sample callback
+ *
+ * @note    Called from the I2C interrupt with the touch info, the DWT cycle
+ *          count when the INT pin was asserted and the status of the read
+ *          (0 or negative)
+ */
+typedef void (*FTXXXX_Callback)(const FTXXXX_Info *info, uint32_t time, int status);
+
 
 
 int FTXXXX_Init(void);
@@ -51,6 +67,10 @@ int FTXXXX_WriteSequentialRegisters( uint8_t startreg, uint8_t *pdata, int num);
 int FTXXXX_ReadSequentialRegisters( uint8_t startreg, uint8_t *pdata, int num);
 int FTXXXX_ReadTouchInfo( FTXXXX_Info *touchinfo );
 void FTXXXX_ProcessInterrupt(void);
+int FTXXXX_StartSampling(FTXXXX_Callback callback);
+void FTXXXX_StopSampling(void);
+uint32_t FTXXXX_GetSkippedSamples(void);
+int FTXXXX_ParseRegisters(const uint8_t *regs, FTXXXX_Info *touchinfo);
 
 /*
  * Registers of the FT5336 controller. From the FT5x16 documentation
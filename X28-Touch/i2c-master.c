@@ -2,13 +2,14 @@
  * @file    i2c-master.c
  *
  * @brief   I2C implementation of a master interface for STM32F746 using polling
+ *          and, for register reads, interrupts and DMA
  *
  * @note    Simple implementation. Configured to use 16 MHz HSI as clock source
  *
  * @note    The are three alternatives for the implementation:
  *          * Polling   <- This module
- *          * Interrupt
- *          * Direct Memory Access (DMA)
+ *          * Interrupt <- I2CMaster_ReadRegistersDMA (address phase)
+ *          * Direct Memory Access (DMA) <- I2CMaster_ReadRegistersDMA (data)
  *
  * @note    This module uses the gpio module to configure pins.
  *
@@ -795,3 +796,417 @@ int ninitial = nbytes;
 
     return 0;
 }
+
+
+/**
+ * @brief Maximal number of status checks while waiting for a flag
+ */
+#ifndef I2C_POLL_TIMEOUT
+#define I2C_POLL_TIMEOUT    (100000)
+#endif
+
+/**
+ * @brief  Wait for a flag in ISR
+ *
+ * @note   A NACK ends the transfer: a STOP is generated when AUTOEND is not set
+ *
+ * @return 0 if OK, -1 for NACK, -3 for timeout
+ */
+static int I2CMaster_WaitFlag( I2C_TypeDef *i2c, uint32_t flag ) {
+uint32_t isr;
+int n = I2C_POLL_TIMEOUT;
+
+    while( n-- > 0 ) {
+        isr = i2c->ISR;
+        if( isr&flag )
+            return 0;
+        if( isr&I2C_ISR_NACKF ) {
+            if( (i2c->CR2&I2C_CR2_AUTOEND) == 0 )
+                i2c->CR2 |= I2C_CR2_STOP;
+            n = I2C_POLL_TIMEOUT;
+            while( (i2c->ISR&I2C_ISR_STOPF) == 0 && n-- > 0 ) {}
+            i2c->ICR = I2C_ICR_NACKCF|I2C_ICR_STOPCF;
+            return -1;
+        }
+    }
+    return -3;
+}
+
+/**
+ * @brief  Transfer phase of I2CMaster_WriteRead
+ *
+ * @note   Transfers above 255 bytes are split in chunks with RELOAD. The last
+ *         phase ends with AUTOEND (STOP), the others with TC, so the next phase
+ *         starts with a repeated start
+ */
+static int I2CMaster_TransferPhase( I2C_TypeDef *i2c, uint16_t addr, uint8_t *p,
+                                    uint32_t n, int read, int last ) {
+uint32_t chunk,cr2;
+int rc;
+
+    chunk = n > 255 ? 255 : n;
+    n -= chunk;
+    cr2 = ((addr<<1)&I2C_CR2_SADD_Msk)
+         |(chunk<<I2C_CR2_NBYTES_Pos)
+         |(read ? I2C_CR2_RD_WRN : 0)
+         |(n ? I2C_CR2_RELOAD : (last ? I2C_CR2_AUTOEND : 0))
+         |I2C_CR2_START;
+    i2c->CR2 = cr2;
+
+    for(;;) {
+        while( chunk > 0 ) {
+            rc = I2CMaster_WaitFlag(i2c,read?I2C_ISR_RXNE:I2C_ISR_TXIS);
+            if( rc < 0 )
+                return rc;
+            if( read )
+                *p++ = i2c->RXDR;
+            else
+                i2c->TXDR = *p++;
+            chunk--;
+        }
+        if( n == 0 )
+            break;
+        // NBYTES done with RELOAD: program the next chunk
+        rc = I2CMaster_WaitFlag(i2c,I2C_ISR_TCR);
+        if( rc < 0 )
+            return rc;
+        chunk = n > 255 ? 255 : n;
+        n -= chunk;
+        i2c->CR2 = (i2c->CR2&~(I2C_CR2_NBYTES_Msk|I2C_CR2_RELOAD|I2C_CR2_AUTOEND))
+                  |(chunk<<I2C_CR2_NBYTES_Pos)
+                  |(n ? I2C_CR2_RELOAD : (last ? I2C_CR2_AUTOEND : 0));
+    }
+
+    if( last ) {
+        rc = I2CMaster_WaitFlag(i2c,I2C_ISR_STOPF);
+        i2c->ICR = I2C_ICR_STOPCF;
+    } else {
+        rc = I2CMaster_WaitFlag(i2c,I2C_ISR_TC);
+    }
+    return rc;
+}
+
+/**
+ * @brief I2CMaster_WriteRead
+ *
+ * @note  Writes *wn* bytes from *wbuf* and reads *rn* bytes into *rbuf* from
+ *        slave *addr* (7 bit) in a single transaction, with a repeated start
+ *        between the phases and only one STOP
+ *
+ *        SAAAAAAAW*DDDDDDDD*...*DDDDDDDD*SAAAAAAAR*DDDDDDDD*...DDDDDDDD*P
+ *
+ * @note  Blocking (polling). Either phase can be empty
+ *
+ * @return 0 if OK, -1 for NACK, -2 when the bus is busy, -3 for timeout
+ */
+int
+I2CMaster_WriteRead( I2C_TypeDef *i2c, uint16_t addr,
+                     uint8_t *wbuf, uint32_t wn,
+                     uint8_t *rbuf, uint32_t rn ) {
+int rc = 0;
+
+    if( I2CMaster_IsBusy(i2c) || (i2c->ISR&I2C_ISR_BUSY) )
+        return -2;
+
+    i2c->ICR = I2C_ICR_NACKCF|I2C_ICR_STOPCF|I2C_ICR_BERRCF|I2C_ICR_ARLOCF|I2C_ICR_OVRCF;
+    if( wn > 0 || rn == 0 )
+        rc = I2CMaster_TransferPhase(i2c,addr,wbuf,wn,0,rn==0);
+    if( rc == 0 && rn > 0 )
+        rc = I2CMaster_TransferPhase(i2c,addr,rbuf,rn,1,1);
+
+    if( rc == -3 ) {
+        // Reset state machine and release the bus
+        I2CMaster_Disable(i2c);
+        I2CMaster_Enable(i2c);
+    }
+    return rc;
+}
+
+
+/**
+ * @brief   Asynchronous register reads using interrupts and DMA
+ *
+ * @note    A register read is a write of the register address followed by a
+ *          read with a repeated start
+ *
+ *          SAAAAAAAW*RRRRRRRR*SAAAAAAAR*DDDDDDDD*.....DDDDDDDD*P
+ *
+ *          The write phase is driven by the event interrupt (TXIS and TC). The
+ *          read phase is done by DMA and finishes with AUTOEND. The STOPF
+ *          interrupt calls the callback. The CPU is not used while the bytes
+ *          are being transferred.
+ *
+ * @note    DMA1 request mapping (RM Table 27)
+ *
+ *          | I2C   | RX Stream | Channel |
+ *          |-------|-----------|---------|
+ *          | I2C1  |     0     |    1    |
+ *          | I2C3  |     2     |    3    |
+ *
+ * @note    The data cache is invalidated over the destination buffer. So it
+ *          must be aligned and padded to 32 bytes (cache line size).
+ *
+ * @note    When the I2C_DONT_IMPLEMENT_IRQ compilation flag is defined, the IRQ
+ *          Handlers are not implemented here and I2CMaster_ProcessEvent and
+ *          I2CMaster_ProcessError must be called from handlers elsewhere.
+ */
+///@{
+typedef struct {
+    I2C_TypeDef             *i2c;
+    DMA_Stream_TypeDef      *stream;
+    uint32_t                channel;
+    volatile uint32_t       *ifcr;          // LIFCR or HIFCR
+    uint32_t                ifcrmask;       // All flags of the stream
+    IRQn_Type               evirq;
+    IRQn_Type               erirq;
+} I2C_DMAConfiguration_t;
+
+static const I2C_DMAConfiguration_t i2c_dmaconfiguration[] = {
+    { I2C1, DMA1_Stream0, 1, &(DMA1->LIFCR), 0x3DU<<0,  I2C1_EV_IRQn, I2C1_ER_IRQn },
+    { I2C3, DMA1_Stream2, 3, &(DMA1->LIFCR), 0x3DU<<16, I2C3_EV_IRQn, I2C3_ER_IRQn },
+    { 0,    0,            0, 0,              0,         0,            0            }
+};
+
+typedef struct {
+    volatile int            busy;
+    int                     failed;
+    uint16_t                addr;
+    uint8_t                 reg;
+    uint8_t                 *data;
+    uint16_t                nbytes;
+    I2C_Callback            callback;
+    void                    *arg;
+} AsyncInfo_t;
+
+static AsyncInfo_t asyncinfo[sizeof(i2c_dmaconfiguration)/sizeof(i2c_dmaconfiguration[0])-1];
+///@}
+
+/**
+ * @brief  Find DMA configuration for a specific I2C
+ *
+ * @return index in i2c_dmaconfiguration or -1 when the I2C has no DMA stream
+ */
+static int FindDMAConfiguration( I2C_TypeDef *i2c ) {
+int k = 0;
+
+    while( i2c_dmaconfiguration[k].i2c && i2c_dmaconfiguration[k].i2c != i2c )
+        k++;
+
+    if( i2c_dmaconfiguration[k].i2c )
+        return k;
+    else
+        return -1;
+}
+
+/**
+ * @brief  Finish asynchronous transfer
+ *
+ * @note   Called from the interrupt after the STOP condition or an error
+ */
+static void I2CMaster_FinishAsync( I2C_TypeDef *i2c, int k ) {
+const I2C_DMAConfiguration_t *c = &i2c_dmaconfiguration[k];
+AsyncInfo_t *a = &asyncinfo[k];
+
+    i2c->CR1 &= ~(I2C_CR1_RXDMAEN|I2C_CR1_TXIE|I2C_CR1_TCIE
+                 |I2C_CR1_STOPIE|I2C_CR1_NACKIE|I2C_CR1_ERRIE);
+
+    // Bytes still in the DMA FIFO are a failure too
+    if( c->stream->NDTR != 0 )
+        a->failed = 1;
+    c->stream->CR &= ~DMA_SxCR_EN;
+    while( c->stream->CR&DMA_SxCR_EN ) {}
+    *(c->ifcr) = c->ifcrmask;
+
+    // Discard lines loaded in the cache during the transfer
+    SCB_InvalidateDCache_by_Addr((uint32_t *) a->data,(a->nbytes+31)&~31);
+
+    I2CMaster_SetStatus(i2c,a->failed?I2C_ERROR:I2C_READY);
+    a->busy = 0;
+    if( a->callback )
+        a->callback(a->arg,a->failed?-1:0);
+}
+
+/**
+ * @brief  I2CMaster_ReadRegistersDMA
+ *
+ * @note   Starts the read of n registers from reg on the slave with 7 bit
+ *         address addr into data. It returns immediately and callback is
+ *         called from the interrupt when the transfer finishes
+ *
+ * @note   data must be aligned to 32 bytes and not be accessed until the
+ *         callback
+ *
+ * @return 0 if started, -1 for invalid parameters, -2 when a transfer is
+ *         already in progress
+ */
+int
+I2CMaster_ReadRegistersDMA( I2C_TypeDef *i2c, uint16_t addr, uint8_t reg,
+                            uint8_t *data, uint16_t n,
+                            I2C_Callback callback, void *arg ) {
+const I2C_DMAConfiguration_t *c;
+AsyncInfo_t *a;
+int k;
+
+    k = FindDMAConfiguration(i2c);
+    if( k < 0 || n == 0 || n > 255 || ((uint32_t) data&31) != 0 )
+        return -1;
+
+    c = &i2c_dmaconfiguration[k];
+    a = &asyncinfo[k];
+    if( a->busy || (i2c->ISR&I2C_ISR_BUSY) )
+        return -2;
+
+    a->busy     = 1;
+    a->failed   = 0;
+    a->addr     = addr;
+    a->reg      = reg;
+    a->data     = data;
+    a->nbytes   = n;
+    a->callback = callback;
+    a->arg      = arg;
+
+    // Dirty lines must not be written back over the DMA data
+    SCB_CleanInvalidateDCache_by_Addr((uint32_t *) data,(n+31)&~31);
+
+    // Configure DMA stream: peripheral to memory, byte transfers, direct mode
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN;
+    c->stream->CR &= ~DMA_SxCR_EN;
+    while( c->stream->CR&DMA_SxCR_EN ) {}
+    *(c->ifcr) = c->ifcrmask;
+    c->stream->PAR  = (uint32_t) &(i2c->RXDR);
+    c->stream->M0AR = (uint32_t) data;
+    c->stream->NDTR = n;
+    c->stream->FCR  = 0;
+    c->stream->CR   = (c->channel<<DMA_SxCR_CHSEL_Pos)
+                     |(1<<DMA_SxCR_PL_Pos)
+                     |DMA_SxCR_MINC;
+    c->stream->CR  |= DMA_SxCR_EN;
+
+    NVIC_SetPriority(c->evirq,I2C_IRQ_PRIO);
+    NVIC_SetPriority(c->erirq,I2C_IRQ_PRIO);
+    NVIC_EnableIRQ(c->evirq);
+    NVIC_EnableIRQ(c->erirq);
+
+    I2CMaster_SetStatus(i2c,I2C_WRITING);
+
+    // Write phase: one byte (register address) without AUTOEND
+    i2c->ICR  = I2C_ICR_NACKCF|I2C_ICR_STOPCF|I2C_ICR_BERRCF|I2C_ICR_ARLOCF|I2C_ICR_OVRCF;
+    i2c->CR1 |= I2C_CR1_TXIE|I2C_CR1_TCIE|I2C_CR1_STOPIE|I2C_CR1_NACKIE|I2C_CR1_ERRIE;
+    i2c->CR2  = ((addr<<1)&I2C_CR2_SADD_Msk)
+               |(1<<I2C_CR2_NBYTES_Pos)
+               |I2C_CR2_START;
+
+    return 0;
+}
+
+/**
+ * @brief  I2CMaster_IsBusy
+ *
+ * @return nonzero while an asynchronous transfer is in progress
+ */
+int
+I2CMaster_IsBusy( I2C_TypeDef *i2c ) {
+int k;
+
+    k = FindDMAConfiguration(i2c);
+    if( k < 0 )
+        return 0;
+    return asyncinfo[k].busy;
+}
+
+/**
+ * @brief  I2CMaster_ProcessEvent
+ *
+ * @note   Event interrupt processing for asynchronous transfers
+ */
+void
+I2CMaster_ProcessEvent( I2C_TypeDef *i2c ) {
+AsyncInfo_t *a;
+uint32_t isr;
+int k;
+
+    k = FindDMAConfiguration(i2c);
+    if( k < 0 )
+        return;
+    a   = &asyncinfo[k];
+    isr = i2c->ISR;
+
+    if( isr&I2C_ISR_NACKF ) {
+        // Slave did not acknowledge. Without AUTOEND, the STOP must be generated
+        i2c->ICR = I2C_ICR_NACKCF;
+        a->failed = 1;
+        if( (i2c->CR2&I2C_CR2_AUTOEND) == 0 )
+            i2c->CR2 |= I2C_CR2_STOP;
+    }
+
+    if( (isr&I2C_ISR_TXIS) && !a->failed ) {
+        i2c->TXDR = a->reg;
+    }
+
+    if( (isr&I2C_ISR_TC) && !a->failed ) {
+        // Read phase with repeated start. DMA reads RXDR and AUTOEND stops
+        I2CMaster_SetStatus(i2c,I2C_READING);
+        i2c->CR1 = (i2c->CR1&~I2C_CR1_TXIE)|I2C_CR1_RXDMAEN;
+        i2c->CR2 = ((a->addr<<1)&I2C_CR2_SADD_Msk)
+                  |(a->nbytes<<I2C_CR2_NBYTES_Pos)
+                  |I2C_CR2_RD_WRN
+                  |I2C_CR2_AUTOEND
+                  |I2C_CR2_START;
+    }
+
+    if( isr&I2C_ISR_STOPF ) {
+        i2c->ICR = I2C_ICR_STOPCF;
+        if( a->busy )
+            I2CMaster_FinishAsync(i2c,k);
+    }
+}
+
+/**
+ * @brief  I2CMaster_ProcessError
+ *
+ * @note   Error interrupt processing for asynchronous transfers
+ *
+ * @note   After an arbitration loss, the bus is released by hardware and no
+ *         STOP is seen. A bus error releases it too.
+ */
+void
+I2CMaster_ProcessError( I2C_TypeDef *i2c ) {
+uint32_t isr;
+int k;
+
+    k = FindDMAConfiguration(i2c);
+    if( k < 0 )
+        return;
+    isr = i2c->ISR;
+
+    if( isr&(I2C_ISR_BERR|I2C_ISR_ARLO|I2C_ISR_OVR) ) {
+        i2c->ICR = I2C_ICR_BERRCF|I2C_ICR_ARLOCF|I2C_ICR_OVRCF;
+        asyncinfo[k].failed = 1;
+        if( asyncinfo[k].busy )
+            I2CMaster_FinishAsync(i2c,k);
+    }
+}
+
+#ifndef I2C_DONT_IMPLEMENT_IRQ
+///@{
+void I2C1_EV_IRQHandler(void) {
+
+    I2CMaster_ProcessEvent(I2C1);
+}
+
+void I2C1_ER_IRQHandler(void) {
+
+    I2CMaster_ProcessError(I2C1);
+}
+
+void I2C3_EV_IRQHandler(void) {
+
+    I2CMaster_ProcessEvent(I2C3);
+}
+
+void I2C3_ER_IRQHandler(void) {
+
+    I2CMaster_ProcessError(I2C3);
+}
+///@}
+#endif
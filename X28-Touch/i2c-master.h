@@ -71,6 +71,21 @@ typedef enum {
         I2C_ERROR = 7
      } I2C_Status_t;
 
+/**
+ * @brief   Completion callback of an asynchronous transfer
+ *
+ * @note    Called from the I2C interrupt with status 0 (OK) or negative (NACK,
+ *          bus error or arbitration lost)
+ */
+typedef void (*I2C_Callback)(void *arg, int status);
+
+/**
+ * @brief   Priority of the I2C interrupts used by the asynchronous transfers
+ */
+#ifndef I2C_IRQ_PRIO
+#define I2C_IRQ_PRIO                 (14)
+#endif
+
 /* Function prototypes */
 
 int I2CMaster_Init(         I2C_TypeDef *i2c,
@@ -90,10 +105,10 @@ int I2CMaster_Read(         I2C_TypeDef *i2c,
                             uint16_t n
                             );
 
-int I2CMaster_WriteAndRead( I2C_TypeDef *i2c,
+int I2CMaster_WriteRead(    I2C_TypeDef *i2c,
                             uint16_t address,
-                            uint8_t *writedata, int nwrite,
-                            uint8_t *readdata,  int nread
+                            uint8_t *wbuf, uint32_t wn,
+                            uint8_t *rbuf, uint32_t rn
                             );
 
 int I2CMaster_Detect(       I2C_TypeDef *i2c,
@@ -102,5 +117,20 @@ int I2CMaster_Detect(       I2C_TypeDef *i2c,
 I2C_Status_t
 I2CMaster_GetStatus(        I2C_TypeDef *i2c );
 
+int I2CMaster_ReadRegistersDMA(
+                            I2C_TypeDef *i2c,
+                            uint16_t addr,
+                            uint8_t reg,
+                            uint8_t *data,
+                            uint16_t n,
+                            I2C_Callback callback,
+                            void *arg
+                            );
+
+int I2CMaster_IsBusy(       I2C_TypeDef *i2c );
+
+void I2CMaster_ProcessEvent(I2C_TypeDef *i2c );
+void I2CMaster_ProcessError(I2C_TypeDef *i2c );
+
 
 #endif // I2C_MASTER_H
@@ -0,0 +1,154 @@
+/**
+ * @file    latency.c
+ *
+ * @note    Touch to photon latency histograms
+ *
+ * @note    Each stage keeps count, minimum, maximum, sum and a histogram with
+ *          power of 2 buckets in us. The update is done with the interrupts
+ *          disabled, since marks come from the I2C and LTDC interrupts and
+ *          from the main program
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "latency.h"
+
+/**
+ * @brief   Statistics of all stages
+ */
+static Latency_Stage stages[LATENCY_STAGES];
+
+/**
+ * @brief   Names used by Latency_Print
+ */
+static const char * const stagenames[LATENCY_STAGES] = {
+    "read",
+    "consumed",
+    "rendered",
+    "displayed"
+};
+
+/**
+ * @brief   Bucket of a latency in us (index of the most significant bit plus 1)
+ */
+static int
+bucket(uint32_t us) {
+int b = 0;
+
+    while( us != 0 && b < LATENCY_BUCKETS-1 ) {
+        us >>= 1;
+        b++;
+    }
+    return b;
+}
+
+/**
+ * @brief   Latency_Reset
+ */
+void
+Latency_Reset(void) {
+uint32_t primask;
+int i,j;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    for(i=0;i<LATENCY_STAGES;i++) {
+        stages[i].count = 0;
+        stages[i].min   = UINT32_MAX;
+        stages[i].max   = 0;
+        stages[i].sum   = 0;
+        for(j=0;j<LATENCY_BUCKETS;j++)
+            stages[i].histogram[j] = 0;
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief   Latency_Mark
+ *
+ * @note    Records that stage was reached now by an event whose INT interrupt
+ *          was at DWT cycle t0
+ */
+void
+Latency_Mark(int stage, uint32_t t0) {
+Latency_Stage *s;
+uint32_t primask;
+uint32_t us;
+
+    if( stage < 0 || stage >= LATENCY_STAGES )
+        return;
+    us = (DWT->CYCCNT-t0)/(SystemCoreClock/1000000);
+
+    s = &stages[stage];
+    primask = __get_PRIMASK();
+    __disable_irq();
+    s->count++;
+    s->sum += us;
+    if( s->count == 1 || us < s->min )
+        s->min = us;
+    if( us > s->max )
+        s->max = us;
+    s->histogram[bucket(us)]++;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief   Latency_GetStage
+ */
+void
+Latency_GetStage(int stage, Latency_Stage *s) {
+uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    *s = stages[stage];
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief   Latency_Print
+ *
+ * @note    Prints a line per stage with the time since the INT interrupt and
+ *          the mean increment from the previous stage, followed by the non
+ *          empty buckets. With STDIO_USE_SWO, it goes to the SWO stimulus port
+ */
+void
+Latency_Print(void) {
+Latency_Stage s;
+uint32_t mean,prevmean;
+uint32_t lo,hi;
+int i,j;
+
+    printf("#stage      count      min     mean      max     step (us)\n");
+    prevmean = 0;
+    for(i=0;i<LATENCY_STAGES;i++) {
+        Latency_GetStage(i,&s);
+        if( s.count == 0 ) {
+            printf("%-9s %7u\n",stagenames[i],0U);
+            continue;
+        }
+        mean = (uint32_t) (s.sum/s.count);
+        printf("%-9s %7lu %8lu %8lu %8lu %8ld\n",stagenames[i],
+                (unsigned long) s.count,(unsigned long) s.min,(unsigned long) mean,
+                (unsigned long) s.max,(long) mean-(long) prevmean);
+        prevmean = mean;
+        for(j=0;j<LATENCY_BUCKETS;j++) {
+            if( s.histogram[j] == 0 )
+                continue;
+            lo = j == 0 ? 0 : 1U<<(j-1);
+            hi = (1U<<j)-1;
+            if( j == LATENCY_BUCKETS-1 )
+                printf("    %8lu+          %7lu\n",(unsigned long) lo,
+                        (unsigned long) s.histogram[j]);
+            else
+                printf("    %8lu-%-8lu %7lu\n",(unsigned long) lo,(unsigned long) hi,
+                        (unsigned long) s.histogram[j]);
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+/**
+ * @file    latency.h
+ *
+ * @note    Touch to photon latency histograms
+ *
+ * @note    The origin of all measurements is the DWT cycle counter sampled in
+ *          the interrupt of the INT pin of the touch controller (Touch_Event.time).
+ *          Each stage records the time from that origin to the moment it is
+ *          reached, so the cost of a stage is the difference to the previous one
+ *
+ *          | Stage              | Marked by                                  |
+ *          |--------------------|--------------------------------------------|
+ *          | LATENCY_READ       | touch.c, I2C read done and events queued   |
+ *          | LATENCY_CONSUMED   | Touch_GetEvent, event taken by the UI      |
+ *          | LATENCY_RENDERED   | application, frame with the response drawn |
+ *          | LATENCY_DISPLAYED  | application, LTDC reloaded the new frame   |
+ *
+ * @note    The last two depend on the UI. With LVGL, the rendered mark goes at
+ *          the end of the flush callback and the displayed mark in the reload
+ *          callback (LCD_SetReloadCallback), both with the time of the oldest
+ *          event read by the input device since the previous frame
+ *
+ * @note    The marks in touch.c are compiled only when LATENCY_ENABLE is
+ *          defined. Latency_Mark can be called from interrupts
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Stages
+ */
+///@{
+#define LATENCY_READ            0
+#define LATENCY_CONSUMED        1
+#define LATENCY_RENDERED        2
+#define LATENCY_DISPLAYED       3
+#define LATENCY_STAGES          4
+///@}
+
+/**
+ * @brief   Number of histogram buckets
+ *
+ * @note    Bucket 0 counts latencies below 1 us and bucket i the ones from
+ *          2^(i-1) to 2^i-1 us. The last one counts all above
+ */
+#ifndef LATENCY_BUCKETS
+#define LATENCY_BUCKETS         20
+#endif
+
+/**
+ * @brief   Statistics of a stage (in us)
+ */
+typedef struct {
+    uint32_t    count;
+    uint32_t    min;
+    uint32_t    max;
+    uint64_t    sum;
+    uint32_t    histogram[LATENCY_BUCKETS];
+} Latency_Stage;
+
+void Latency_Reset(void);
+void Latency_Mark(int stage, uint32_t t0);
+void Latency_GetStage(int stage, Latency_Stage *s);
+void Latency_Print(void);
+
+/**
+ * @brief   Marks compiled only when LATENCY_ENABLE is defined
+ */
+#ifdef LATENCY_ENABLE
+#define LATENCY_MARK(STAGE,T0)  Latency_Mark(STAGE,T0)
+#else
+#define LATENCY_MARK(STAGE,T0)
+#endif
+
+#endif // LATENCY_H
@@ -384,6 +384,14 @@ static const GPIO_PinConfiguration configtable[] = {
  */
 static int  LCDCLOCK_Initialized = 0;
 
+/**
+ * @brief   Called at each reload of the shadow registers
+ */
+///@{
+static LCD_ReloadCallback   reloadcallback = 0;
+static void                *reloadarg = 0;
+///@}
+
 /**
  * @brief   Set Clock for LCD
  *
@@ -502,3 +510,60 @@ uint32_t *p = (uint32_t *) frame;
     }
 }
 
+
+/**
+ * @brief   LCD_SetReloadCallback
+ *
+ * @note    cb is called from the LTDC interrupt when the shadow registers are
+ *          reloaded, i.e., when the configuration written before
+ *          LCD_RequestReload is used for the first time. With cb = 0, the
+ *          interrupt is disabled
+ *
+ * @note    The LTDC is enabled, since the reload is done at the vertical
+ *          blanking of a running controller
+ */
+void
+LCD_SetReloadCallback(LCD_ReloadCallback cb, void *arg) {
+
+    NVIC_DisableIRQ(LTDC_IRQn);
+    reloadcallback = cb;
+    reloadarg      = arg;
+    if( cb == 0 )
+        return;
+
+    LTDC->GCR |= LTDC_GCR_LTDCEN;
+    LTDC->ICR  = LTDC_ICR_CRRIF|LTDC_ICR_CLIF;
+    LTDC->IER |= LTDC_IER_RRIE;
+    NVIC_SetPriority(LTDC_IRQn,LCD_IRQLEVEL);
+    NVIC_EnableIRQ(LTDC_IRQn);
+}
+
+/**
+ * @brief   LCD_RequestReload
+ *
+ * @note    The shadow registers (frame buffer address, layer configuration) are
+ *          reloaded at the next vertical blanking
+ */
+void
+LCD_RequestReload(void) {
+
+    LTDC->SRCR = LTDC_SRCR_VBR;
+}
+
+/**
+ * @brief   LCD_TFT_EV_IRQHandler
+ *
+ * @note    Line and reload interrupts. Only the reload is used
+ */
+void LCD_TFT_EV_IRQHandler(void) {
+
+    if( LTDC->ISR&LTDC_ISR_LIF )
+        LTDC->ICR = LTDC_ICR_CLIF;
+
+    if( (LTDC->ISR&LTDC_ISR_RRIF) == 0 )
+        return;
+    LTDC->ICR = LTDC_ICR_CRRIF;
+
+    if( reloadcallback )
+        reloadcallback(reloadarg);
+}
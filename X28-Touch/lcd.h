@@ -35,5 +35,22 @@ extern RGB_t LCD_Frame2[LCD_DW][LCD_DH];
 void LCD_FillFrameBuffer( RGB_t *frame, RGB_t v );
 void LCD_SetClock(uint32_t div);
 
+/**
+ * @brief   Priority of the LTDC interrupt
+ */
+#ifndef LCD_IRQLEVEL
+#define LCD_IRQLEVEL    5
+#endif
+
+/**
+ * @brief   Reload of the shadow registers
+ */
+///@{
+typedef void (*LCD_ReloadCallback)(void *arg);
+
+void LCD_SetReloadCallback(LCD_ReloadCallback cb, void *arg);
+void LCD_RequestReload(void);
+///@}
+
 #endif
 
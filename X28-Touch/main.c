@@ -15,6 +15,11 @@
 #include "system_stm32f746.h"
 #include "led.h"
 #include "lcd.h"
+#include "touch.h"
+#include "latency.h"
+#ifdef STDIO_USE_SWO
+#include "swo.h"
+#endif
 
 
 
@@ -43,15 +48,52 @@ void ms_delay(volatile int ms) {
 
 
 
+/**
+ * @brief   Number of displayed frames between prints of the latency histograms
+ */
+#define LATENCY_PRINTPERIOD 200
+
+/**
+ * @brief   Frame waiting for the reload
+ *
+ * @note    time is the INT time of the oldest event handled in the frame
+ */
+///@{
+static volatile int         framepending = 0;
+static volatile uint32_t    frametime;
+static volatile uint32_t    framesshown = 0;
+///@}
+
+/**
+ * @brief   Called from the LTDC interrupt when the frame is shown
+ */
+static void
+framedisplayed(void *arg) {
+
+    (void) arg;
+    if( !framepending )
+        return;
+    Latency_Mark(LATENCY_DISPLAYED,frametime);
+    framepending = 0;
+    framesshown++;
+}
+
 /**
  * @brief   main
  *
- * @note    Initializes GPIO and blinks LED
+ * @note    Initializes GPIO, LCD and touch and handles touch events. The
+ *          response to an event (LED toggle) stands for the rendering of a
+ *          UI frame, which is shown at the next reload of the LTDC
  *
- * @note    Really a bad idea to blink LED
+ * @note    The latency from the touch interrupt to each stage is printed every
+ *          LATENCY_PRINTPERIOD frames
  */
 
 int main(void) {
+Touch_Event ev;
+uint32_t oldest = 0;
+uint32_t lastprint = 0;
+int n;
 
 
     SystemSetCoreClockFrequency(OPERATING_FREQUENCY);
@@ -64,19 +106,45 @@ int main(void) {
 
     LCD_Init();
 
-    /*
-     * Blink LED
-     */
-    for (;;) {
-#if 1
-       ms_delay(500);
-       LED_Toggle();
-#else
-        ms_delay(500);
-        LED_Set();
-        ms_delay(500);
-        LED_Clear();
-        ms_delay(500);
+#ifdef STDIO_USE_SWO
+    SWO_Init(0,1U<<SWO_PORT_STDIO);
 #endif
+
+    Latency_Reset();
+    LCD_SetReloadCallback(framedisplayed,0);
+
+    if( Touch_Init() < 0 || Touch_StartEvents() < 0 ) {
+        /*
+         * Blink LED
+         */
+        for (;;) {
+           ms_delay(500);
+           LED_Toggle();
+        }
+    }
+
+    for (;;) {
+        /* Consume all events, keeping the time of the oldest */
+        n = 0;
+        while( Touch_GetEvent(&ev) ) {
+            if( n++ == 0 )
+                oldest = ev.time;
+            if( ev.type == TOUCH_EVENT_PRESS )
+                LED_Toggle();
+        }
+        if( n == 0 )
+            continue;
+
+        /* One frame at a time: wait until the previous one is shown */
+        while( framepending ) {}
+        Latency_Mark(LATENCY_RENDERED,oldest);
+        frametime    = oldest;
+        framepending = 1;
+        LCD_RequestReload();
+
+        if( framesshown-lastprint >= LATENCY_PRINTPERIOD ) {
+            lastprint = framesshown;
+            Latency_Print();
+        }
     }
 }
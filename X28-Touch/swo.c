@@ -0,0 +1,129 @@
+/**
+ * @file    swo.c
+ *
+ * @note    Output thru the ITM stimulus ports and SWO pin
+ *
+ * @note    The SWO pin (PB3) is configured as TRACESWO (AF0) after reset.
+ *
+ * @note    It uses the asynchronous NRZ (UART like) protocol of the TPIU.
+ *          The bit rate is the core clock divided by (ACPR+1) and must be
+ *          set the same in the debugger (e.g. openocd tpiu or ST-Link utility).
+ *
+ * @note    When the debugger is not connected or the port is not enabled, the
+ *          output is discarded, so it does not block.
+ */
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "swo.h"
+
+/**
+ * @brief   Initialize TPIU and ITM
+ *
+ * @note    portmask has a bit set for each stimulus port to be enabled.
+ *          If freq is zero, SWO_DEFAULTFREQ is used.
+ *
+ * @note    It must be called again when the core clock changes
+ */
+int
+SWO_Init(unsigned freq, unsigned portmask) {
+
+    if( freq == 0 )
+        freq = SWO_DEFAULTFREQ;
+    if( freq > SystemCoreClock )
+        return -1;
+
+    // Enable trace pins and trace clock
+    DBGMCU->CR |= DBGMCU_CR_TRACE_IOEN;
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+
+    // TPIU: asynchronous NRZ, no formatter
+    TPI->SPPR = 2;
+    TPI->ACPR = SystemCoreClock/freq-1;
+    TPI->FFCR = 0x100;
+
+    // ITM: unlock, enable with ATB ID 1 and synchronization packets
+    ITM->LAR = 0xC5ACCE55;
+    ITM->TCR = 0;
+    ITM->TCR = (1<<ITM_TCR_TraceBusID_Pos)
+              |ITM_TCR_SWOENA_Msk
+              |ITM_TCR_SYNCENA_Msk
+              |ITM_TCR_ITMENA_Msk;
+    ITM->TPR = 0;                           // unprivileged access to all ports
+    ITM->TER = portmask;
+
+    return 0;
+}
+
+/**
+ * @brief   Check if port can be used
+ */
+int
+SWO_IsEnabled(unsigned port) {
+
+    return (port < 32)
+        && (ITM->TCR&ITM_TCR_ITMENA_Msk)
+        && (ITM->TER&(1U<<port));
+}
+
+/**
+ * @brief   Send a char to a stimulus port
+ *
+ * @note    Waits while the stimulus port FIFO is full
+ */
+int
+SWO_WriteChar(unsigned port, int c) {
+
+    if( !SWO_IsEnabled(port) )
+        return -1;
+
+    while( ITM->PORT[port].u32 == 0 ) {}
+    ITM->PORT[port].u8 = (uint8_t) c;
+    return c;
+}
+
+/**
+ * @brief   Send a 32 bit word to a stimulus port
+ *
+ * @note    Used for counters and event markers
+ */
+int
+SWO_WriteWord(unsigned port, unsigned w) {
+
+    if( !SWO_IsEnabled(port) )
+        return -1;
+
+    while( ITM->PORT[port].u32 == 0 ) {}
+    ITM->PORT[port].u32 = w;
+    return 0;
+}
+
+/**
+ * @brief   Send a block of chars to a stimulus port
+ *
+ * @note    Four chars are sent in each 32 bit write, reducing the packet overhead.
+ *          The chars are received in order (little endian)
+ */
+int
+SWO_Write(unsigned port, const char *s, int n) {
+int i = 0;
+uint32_t w;
+
+    if( !SWO_IsEnabled(port) )
+        return n;
+
+    while( n-i >= 4 ) {
+        w = (uint8_t) s[i]
+           |((uint8_t) s[i+1]<<8)
+           |((uint8_t) s[i+2]<<16)
+           |((uint32_t) (uint8_t) s[i+3]<<24);
+        while( ITM->PORT[port].u32 == 0 ) {}
+        ITM->PORT[port].u32 = w;
+        i += 4;
+    }
+    while( i < n ) {
+        while( ITM->PORT[port].u32 == 0 ) {}
+        ITM->PORT[port].u8 = (uint8_t) s[i++];
+    }
+    return n;
+}
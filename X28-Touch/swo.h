@@ -0,0 +1,37 @@
+#ifndef SWO_H
+#define SWO_H
+/**
+ * @file    swo.h
+ *
+ * @note    Output thru the ITM stimulus ports and SWO pin
+ *
+ * @note    Each stimulus port is a separate channel in the debugger, so logs,
+ *          counters and events can be captured separately.
+ */
+
+/**
+ * @brief   Stimulus port assignment
+ */
+///@{
+#define SWO_PORT_STDIO      0               ///< stdout (printf)
+#define SWO_PORT_LOG        1               ///< log messages
+#define SWO_PORT_COUNTER    2               ///< 32 bit counters
+#define SWO_PORT_EVENT      3               ///< event markers
+///@}
+
+/**
+ * @brief   Default SWO bit rate
+ *
+ * @note    It must be a divisor of the core clock
+ */
+#ifndef SWO_DEFAULTFREQ
+#define SWO_DEFAULTFREQ     2000000
+#endif
+
+int  SWO_Init(unsigned freq, unsigned portmask);
+int  SWO_IsEnabled(unsigned port);
+int  SWO_WriteChar(unsigned port, int c);
+int  SWO_WriteWord(unsigned port, unsigned w);
+int  SWO_Write(unsigned port, const char *s, int n);
+
+#endif // SWO_H
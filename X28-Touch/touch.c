@@ -21,6 +21,223 @@
 #include "touch.h"
 #include "i2c-master.h"
 #include "ftxxxx.h"
+#include "touchfilter.h"
+#include "latency.h"
+
+/**
+ * @brief  Event queue
+ *
+ * @note   Single producer (I2C interrupt) and single consumer (Touch_GetEvent).
+ *         Each side only writes its own index, so no locking is needed. The
+ *         barrier makes the entry visible before the index is updated.
+ */
+///@{
+static Touch_Event          queue[TOUCH_QUEUESIZE];
+static volatile uint32_t    head = 0;
+static volatile uint32_t    tail = 0;
+///@}
+
+/**
+ * @brief  State of each finger (indexed by touch ID)
+ *
+ * @note   The FT5336 keeps the ID of a finger while it touches the panel, so
+ *         the IDs are used to match points between samples
+ */
+static struct {
+    uint8_t             pressed;
+    uint8_t             count;
+    uint8_t             multi;              // another finger was down
+    uint16_t            x;                  // last reported position
+    uint16_t            y;
+    uint16_t            startx;             // position at press
+    uint16_t            starty;
+    uint32_t            starttime;
+    TouchFilter_State   filter;
+} fingers[16];
+
+/**
+ * @brief  Pinch state: distance between the two fingers at the last event
+ */
+static int pinchactive = 0;
+static int pinchdistance;
+
+static Touch_Stats stats;
+
+/**
+ * @brief  Insert an event in the queue (interrupt side)
+ */
+static void PutEvent(int type, int id, int x, int y, uint32_t time, int dx, int dy) {
+uint32_t h = head;
+uint32_t next = (h+1)&(TOUCH_QUEUESIZE-1);
+
+    if( next == tail ) {
+        stats.overruns++;
+        return;
+    }
+    queue[h].type = type;
+    queue[h].id   = id;
+    queue[h].x    = x;
+    queue[h].y    = y;
+    queue[h].dx   = dx;
+    queue[h].dy   = dy;
+    queue[h].time = time;
+    __DMB();
+    head = next;
+}
+
+static int Distance(int a, int b) {
+
+    return a > b ? a-b : b-a;
+}
+
+/**
+ * @brief  Integer square root (bitwise)
+ */
+static uint32_t SquareRoot(uint32_t v) {
+uint32_t r = 0, b = 1U<<30;
+
+    while( b > v ) b >>= 2;
+    while( b ) {
+        if( v >= r+b ) {
+            v -= r+b;
+            r = (r>>1)+b;
+        } else {
+            r >>= 1;
+        }
+        b >>= 2;
+    }
+    return r;
+}
+
+/**
+ * @brief  Swipe test at release
+ *
+ * @note   A single finger stroke longer than TOUCH_SWIPEMIN pixels done in
+ *         less than TOUCH_SWIPETIME ms
+ */
+static void DetectSwipe(int id, uint32_t time) {
+int dx = fingers[id].x-fingers[id].startx;
+int dy = fingers[id].y-fingers[id].starty;
+
+    if( fingers[id].multi )
+        return;
+    if( Distance(dx,0) < TOUCH_SWIPEMIN && Distance(dy,0) < TOUCH_SWIPEMIN )
+        return;
+    if( time-fingers[id].starttime > TOUCH_SWIPETIME*(SystemCoreClock/1000) )
+        return;
+    PutEvent(TOUCH_EVENT_SWIPE,id,fingers[id].x,fingers[id].y,time,dx,dy);
+}
+
+/**
+ * @brief  Pinch test after each sample
+ *
+ * @note   With exactly two fingers down, an event is generated each time their
+ *         distance changes TOUCH_PINCHSTEP pixels. It is reported at the middle
+ *         point between the fingers
+ */
+static void DetectPinch(uint32_t time) {
+int f[2], n = 0;
+int dx,dy,d;
+
+    for(int id=0;id<16;id++) {
+        if( fingers[id].pressed ) {
+            if( n < 2 ) f[n] = id;
+            n++;
+        }
+    }
+    if( n >= 2 ) {
+        for(int id=0;id<16;id++)
+            if( fingers[id].pressed ) fingers[id].multi = 1;
+    }
+    if( n != 2 ) {
+        pinchactive = 0;
+        return;
+    }
+
+    dx = fingers[f[1]].x-fingers[f[0]].x;
+    dy = fingers[f[1]].y-fingers[f[0]].y;
+    d  = SquareRoot(dx*dx+dy*dy);
+    if( !pinchactive ) {
+        pinchactive   = 1;
+        pinchdistance = d;
+    } else if( Distance(d,pinchdistance) >= TOUCH_PINCHSTEP ) {
+        PutEvent(TOUCH_EVENT_PINCH,f[0],
+                (fingers[f[0]].x+fingers[f[1]].x)/2,
+                (fingers[f[0]].y+fingers[f[1]].y)/2,
+                time,d-pinchdistance,d);
+        pinchdistance = d;
+    }
+}
+
+/**
+ * @brief  Process a sample (called from the I2C interrupt)
+ *
+ * @note   Coordinates are filtered (median and One Euro, see touchfilter.c)
+ *         before press and move detection
+ *
+ * @note   Fingers not present in the sample, or with the Put Up flag, are
+ *         released at their last position
+ */
+static void ProcessSample(const FTXXXX_Info *info, uint32_t time, int status) {
+uint32_t seen = 0;
+uint32_t h0 = head;
+uint32_t latency;
+int id,x,y;
+
+    if( status < 0 ) {
+        stats.errors++;
+        return;
+    }
+    stats.samples++;
+
+    for(int i=0;i<info->npoints;i++) {
+        id = info->points[i].id&0xF;
+        if( info->points[i].event == 1 )
+            continue;
+        seen |= 1U<<id;
+        x = info->points[i].x;
+        y = info->points[i].y;
+        if( !fingers[id].pressed && fingers[id].count == 0 )
+            TouchFilter_Reset(&fingers[id].filter);
+        TouchFilter_Apply(&fingers[id].filter,&x,&y,time);
+        if( !fingers[id].pressed ) {
+            fingers[id].x = x;
+            fingers[id].y = y;
+            if( ++fingers[id].count >= TOUCH_PRESSCOUNT ) {
+                fingers[id].pressed   = 1;
+                fingers[id].multi     = 0;
+                fingers[id].startx    = x;
+                fingers[id].starty    = y;
+                fingers[id].starttime = time;
+                PutEvent(TOUCH_EVENT_PRESS,id,x,y,time,0,0);
+            }
+        } else if( Distance(x,fingers[id].x) >= TOUCH_MOVEMIN
+                || Distance(y,fingers[id].y) >= TOUCH_MOVEMIN ) {
+            fingers[id].x = x;
+            fingers[id].y = y;
+            PutEvent(TOUCH_EVENT_MOVE,id,x,y,time,0,0);
+        }
+    }
+
+    for(id=0;id<16;id++) {
+        if( seen&(1U<<id) )
+            continue;
+        if( fingers[id].pressed ) {
+            PutEvent(TOUCH_EVENT_RELEASE,id,fingers[id].x,fingers[id].y,time,0,0);
+            DetectSwipe(id,time);
+        }
+        fingers[id].pressed = 0;
+        fingers[id].count = 0;
+    }
+
+    DetectPinch(time);
+
+    latency = DWT->CYCCNT-time;
+    if( latency > stats.maxlatency )
+        stats.maxlatency = latency;
+    if( head != h0 )
+        LATENCY_MARK(LATENCY_READ,time);
+}
 
 
 /**
@@ -72,7 +289,7 @@ int n = 0;
         if( n > 0 ) {
             if( n > nmax ) n = nmax;
             for(int i=0;i<n;i++) {
-                touchinfo[i].id    = buffer.gesture;
+                touchinfo[i].id    = buffer.points[i].id;
                 touchinfo[i].x     = buffer.points[i].x;
                 touchinfo[i].y     = buffer.points[i].y;
                 touchinfo[i].weight= buffer.points[i].w;
@@ -81,3 +298,65 @@ int n = 0;
     }
     return n;
 }
+
+
+/**
+ * @brief  Start event generation
+ *
+ * @note   Samples are read by interrupts and DMA when the controller signals
+ *         them. Touch_ReadInfo must not be used while events are enabled
+ *
+ * @return 0 if OK, negative for error.
+ */
+int
+Touch_StartEvents(void) {
+
+    head = tail = 0;
+    pinchactive = 0;
+    for(int i=0;i<16;i++)
+        fingers[i].pressed = fingers[i].count = 0;
+    stats.samples = stats.errors = stats.skipped = 0;
+    stats.overruns = stats.maxlatency = 0;
+
+    return FTXXXX_StartSampling(ProcessSample);
+}
+
+/**
+ * @brief  Stop event generation
+ */
+void
+Touch_StopEvents(void) {
+
+    FTXXXX_StopSampling();
+}
+
+/**
+ * @brief  Get next event
+ *
+ * @note   Does not block
+ *
+ * @return 1 if an event was returned in ev, 0 when the queue is empty
+ */
+int
+Touch_GetEvent(Touch_Event *ev) {
+uint32_t t = tail;
+
+    if( t == head )
+        return 0;
+    __DMB();
+    *ev = queue[t];
+    __DMB();
+    tail = (t+1)&(TOUCH_QUEUESIZE-1);
+    LATENCY_MARK(LATENCY_CONSUMED,ev->time);
+    return 1;
+}
+
+/**
+ * @brief  Get statistics of the event pipeline
+ */
+void
+Touch_GetStats(Touch_Stats *st) {
+
+    *st = stats;
+    st->skipped = FTXXXX_GetSkippedSamples();
+}
@@ -24,8 +24,84 @@ typedef struct {
     uint16_t misc;
 } Touch_Info;
 
+/**
+ * @brief   Touch events
+ */
+///@{
+#define TOUCH_EVENT_PRESS       1
+#define TOUCH_EVENT_MOVE        2
+#define TOUCH_EVENT_RELEASE     3
+#define TOUCH_EVENT_SWIPE       4
+#define TOUCH_EVENT_PINCH       5
+///@}
+
+/**
+ * @brief   Event queue size (power of 2)
+ */
+#ifndef TOUCH_QUEUESIZE
+#define TOUCH_QUEUESIZE         32
+#endif
+
+/**
+ * @brief   Debouncing
+ *
+ * @note    A press is reported after TOUCH_PRESSCOUNT consecutive samples with
+ *          the touch and a move when a coordinate changes at least
+ *          TOUCH_MOVEMIN pixels
+ */
+///@{
+#ifndef TOUCH_PRESSCOUNT
+#define TOUCH_PRESSCOUNT        2
+#endif
+#ifndef TOUCH_MOVEMIN
+#define TOUCH_MOVEMIN           2
+#endif
+///@}
+
+/**
+ * @brief   Gestures
+ *
+ * @note    A swipe is a single finger stroke of at least TOUCH_SWIPEMIN pixels
+ *          in at most TOUCH_SWIPETIME ms, reported after the release. A pinch
+ *          event is generated when the distance between two fingers changes
+ *          TOUCH_PINCHSTEP pixels
+ */
+///@{
+#ifndef TOUCH_SWIPEMIN
+#define TOUCH_SWIPEMIN          40
+#endif
+#ifndef TOUCH_SWIPETIME
+#define TOUCH_SWIPETIME         300
+#endif
+#ifndef TOUCH_PINCHSTEP
+#define TOUCH_PINCHSTEP         8
+#endif
+///@}
+
+typedef struct {
+    uint8_t     type;                       ///< TOUCH_EVENT_*
+    uint8_t     id;                         ///< finger
+    uint16_t    x;
+    uint16_t    y;
+    int16_t     dx;                         ///< SWIPE: displacement, PINCH: distance change
+    int16_t     dy;                         ///< SWIPE: displacement, PINCH: distance
+    uint32_t    time;                       ///< DWT cycles at the INT pin
+} Touch_Event;
+
+typedef struct {
+    uint32_t    samples;                    ///< samples processed
+    uint32_t    errors;                     ///< failed I2C reads
+    uint32_t    skipped;                    ///< INT while a read was in progress
+    uint32_t    overruns;                   ///< events lost with the queue full
+    uint32_t    maxlatency;                 ///< INT to events queued (cycles)
+} Touch_Stats;
+
 int Touch_Init(void);
 int Touch_ReadInfo(Touch_Info *touch, int nmax );
 int Touch_Detected(void);
+int Touch_StartEvents(void);
+void Touch_StopEvents(void);
+int Touch_GetEvent(Touch_Event *ev);
+void Touch_GetStats(Touch_Stats *stats);
 
 #endif // TOUCH_H
@@ -0,0 +1,115 @@
+/**
+ * @file touchfilter.c
+ *
+ * @brief Coordinate filtering for touch points
+ *
+ * @note  For a sample interval Te and a cutoff fc, the low pass filter is
+ *
+ *            y = y + alpha*(x-y)    with alpha = Te/(Te+tau), tau = 1/(2*pi*fc)
+ *
+ *        The speed is the filtered derivative (cutoff TOUCHFILTER_DCUTOFF) and
+ *        the position cutoff is fc = TOUCHFILTER_FCMIN + TOUCHFILTER_BETA*speed.
+ *        Te is in us, tau in us and alpha in Q16.
+ *
+ * @author Hans
+ * @date   2026-10-14
+ */
+
+#include <stdint.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "touchfilter.h"
+
+/**
+ * @brief   Te limits (us). Longer intervals (a pause) reset to the last sample
+ */
+#define TEMAX       200000
+
+/**
+ * @brief   alpha in Q16 for Te (us) and fc (mHz)
+ *
+ * @note    1E9/(2*pi) = 159154943
+ */
+static uint32_t Alpha(uint32_t te, uint32_t fc) {
+uint32_t tau = 159154943U/fc;
+
+    return (uint32_t) (((uint64_t) te<<16)/(te+tau));
+}
+
+static int Median3(const int16_t *h) {
+int a = h[0], b = h[1], c = h[2];
+
+    if( a > b ) { int t = a; a = b; b = t; }
+    if( b > c ) b = c;
+    return a > b ? a : b;
+}
+
+static int32_t Abs(int32_t v) {
+
+    return v < 0 ? -v : v;
+}
+
+/**
+ * @brief  Reset filter
+ *
+ * @note   Must be called when a new touch starts
+ */
+void
+TouchFilter_Reset(TouchFilter_State *f) {
+
+    f->n = 0;
+}
+
+/**
+ * @brief  Filter a sample
+ *
+ * @note   *x and *y are replaced by the filtered coordinates
+ */
+void
+TouchFilter_Apply(TouchFilter_State *f, int *x, int *y, uint32_t time) {
+uint32_t te,a,fc;
+int32_t mx,my,dx,dy,speed;
+
+    te = (time-f->time)/(SystemCoreClock/1000000);
+    f->time = time;
+
+    if( f->n == 0 || te > TEMAX ) {
+        f->hx[0] = f->hx[1] = f->hx[2] = *x;
+        f->hy[0] = f->hy[1] = f->hy[2] = *y;
+        f->n  = 1;
+        f->x  = *x*16;
+        f->y  = *y*16;
+        f->vx = f->vy = 0;
+        return;
+    }
+    if( te == 0 )
+        te = 1;
+
+    f->hx[0] = f->hx[1]; f->hx[1] = f->hx[2]; f->hx[2] = *x;
+    f->hy[0] = f->hy[1]; f->hy[1] = f->hy[2]; f->hy[2] = *y;
+    if( f->n < 3 ) {
+        f->n++;
+        mx = *x*16;
+        my = *y*16;
+    } else {
+        mx = Median3(f->hx)*16;
+        my = Median3(f->hy)*16;
+    }
+
+    // Speed in pixels/s
+    dx = (int32_t) (((int64_t) (mx-f->x)*1000000)/te/16);
+    dy = (int32_t) (((int64_t) (my-f->y)*1000000)/te/16);
+    a  = Alpha(te,TOUCHFILTER_DCUTOFF);
+    f->vx += (int32_t) (((int64_t) (dx-f->vx)*a)>>16);
+    f->vy += (int32_t) (((int64_t) (dy-f->vy)*a)>>16);
+
+    speed = Abs(f->vx)+Abs(f->vy);
+    fc = TOUCHFILTER_FCMIN+TOUCHFILTER_BETA*(uint32_t) speed;
+    a  = Alpha(te,fc);
+    f->x += (int32_t) (((int64_t) (mx-f->x)*a)>>16);
+    f->y += (int32_t) (((int64_t) (my-f->y)*a)>>16);
+
+    *x = (f->x+8)>>4;
+    *y = (f->y+8)>>4;
+}
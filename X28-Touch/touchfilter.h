@@ -0,0 +1,55 @@
+#ifndef TOUCHFILTER_H
+#define TOUCHFILTER_H
+/**
+ * @file touchfilter.h
+ *
+ * @brief Coordinate filtering for touch points
+ *
+ * @note  A 3 sample median removes isolated spikes and a One Euro filter
+ *        (Casiez et al., 2012) smooths the result. The One Euro filter is a
+ *        first order low pass filter whose cutoff frequency grows with the
+ *        speed of the point: a slow finger gets a low cutoff (no jitter) and a
+ *        fast one a high cutoff (no lag).
+ *
+ * @note  All calculations are in fixed point. The sample interval is derived
+ *        from the timestamps, so the filter works with any sampling rate.
+ *
+ * @author Hans
+ * @date   2026-10-14
+ */
+
+/**
+ * @brief   One Euro parameters
+ *
+ * @note    Cutoffs in mHz. BETA is the cutoff increase in mHz for each pixel/s
+ */
+///@{
+#ifndef TOUCHFILTER_FCMIN
+#define TOUCHFILTER_FCMIN           1000
+#endif
+#ifndef TOUCHFILTER_BETA
+#define TOUCHFILTER_BETA            40
+#endif
+#ifndef TOUCHFILTER_DCUTOFF
+#define TOUCHFILTER_DCUTOFF         1000
+#endif
+///@}
+
+/**
+ * @brief   Filter state of a point
+ */
+typedef struct {
+    int16_t     hx[3];                      ///< last raw coordinates
+    int16_t     hy[3];
+    uint8_t     n;                          ///< samples in the history
+    int32_t     x;                          ///< filtered position (1/16 pixel)
+    int32_t     y;
+    int32_t     vx;                         ///< filtered speed (pixels/s)
+    int32_t     vy;
+    uint32_t    time;                       ///< DWT cycles of the last sample
+} TouchFilter_State;
+
+void TouchFilter_Reset(TouchFilter_State *f);
+void TouchFilter_Apply(TouchFilter_State *f, int *x, int *y, uint32_t time);
+
+#endif // TOUCHFILTER_H
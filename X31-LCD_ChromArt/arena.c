@@ -0,0 +1,248 @@
+/**
+ *  @file   arena.c
+ *
+ *  @note   Arena (bump pointer) allocator (see arena.h)
+ *
+ *  @note
+ *    An arena is an area and the offset of its first free byte (top). An
+ *    allocation aligns top, returns it and adds the size. So allocation runs in
+ *    O(1) time and there is no header. A mark is a copy of top.
+ *
+ *  @note
+ *    With ARENA_GUARD, each allocation is followed by a trailer with a guard
+ *    word and the top before the allocation. Arena_Check walks the trailers from
+ *    the top down and verifies the guard words. It is called by Arena_Release
+ *    and Arena_Reset, so a buffer overrun is found at the end of the frame.
+ *
+ */
+
+#include <stdint.h>
+
+#include "arena.h"
+
+/**
+ *  @brief  Maximal number of arenas
+ */
+#define  MAXARENAS  8
+
+/**
+ *  @brief  Guard word
+ */
+#define  GUARD      (0xFDFDFDFDUL)
+
+/**
+ *  @brief  Trailer after each allocation with ARENA_GUARD
+ */
+typedef struct {
+    uint32_t            guard;                  /// GUARD
+    uint32_t            prevtop;                /// top before the allocation
+} TRAILER_t;
+
+/**
+ *  @brief  Arena
+ */
+typedef struct arena_s {
+    char               *base;                   /// start of area
+    uint32_t            size;                   /// size of area
+    uint32_t            top;                    /// offset of first free byte
+    int                 flags;                  /// ARENA_GUARD
+    int                 used;                   /// entry in use
+    uint32_t            highwater;              /// maximal value of top
+    unsigned            allocs;                 /// counter of allocations
+    unsigned            failures;               /// counter of failed allocations
+    unsigned            resets;                 /// counter of resets and releases
+    unsigned            guarderrors;            /// counter of overwritten guards
+} ARENA_t;
+
+/**
+ *  @brief  Arena area
+ */
+static ARENA_t  arenaarea[MAXARENAS];
+
+static inline uint32_t roundup(uint32_t n, uint32_t a) { return (n+a-1)&~(a-1); }
+
+/**
+ *  @brief  Arena_Create
+ *
+ *  @note   addr must be aligned to 4 with ARENA_GUARD. Returns 0 when there is
+ *          no free entry or the area is invalid
+ */
+ARENA
+Arena_Create(void *addr, long size, int flags) {
+ARENA_t *a;
+int i;
+
+    if( addr == 0 || size <= 0 )
+        return 0;
+    if( (flags&ARENA_GUARD) && ((uintptr_t) addr&3) != 0 )
+        return 0;
+
+    for(i=0;i<MAXARENAS&&arenaarea[i].used;i++) {}
+    if( i == MAXARENAS )
+        return 0;
+
+    a = &arenaarea[i];
+    a->base         = (char *) addr;
+    a->size         = (uint32_t) size;
+    a->top          = 0;
+    a->flags        = flags;
+    a->highwater    = 0;
+    a->allocs       = 0;
+    a->failures     = 0;
+    a->resets       = 0;
+    a->guarderrors  = 0;
+    a->used         = 1;
+    return a;
+}
+
+/**
+ *  @brief  Arena_Destroy
+ *
+ *  @note   The area is not freed. It belongs to the caller
+ */
+void
+Arena_Destroy(ARENA arena) {
+
+    arena->used = 0;
+}
+
+/**
+ *  @brief  Arena_AllocAligned
+ *
+ *  @note   align must be a power of 2 (ARENA_ALIGN is used otherwise). The
+ *          address is aligned, not the offset, so the area can start anywhere.
+ *          Returns 0 when the arena is full (counted in failures)
+ */
+void *
+Arena_AllocAligned(ARENA arena, unsigned size, unsigned align) {
+uintptr_t base = (uintptr_t) arena->base;
+uint32_t start,end;
+TRAILER_t *t;
+
+    if( align == 0 || (align&(align-1)) != 0 )
+        align = ARENA_ALIGN;
+
+    start = (uint32_t) (roundup(base+arena->top,align)-base);
+    end   = start+size;
+    if( arena->flags&ARENA_GUARD )
+        end = roundup(end,4)+sizeof(TRAILER_t);
+    if( end > arena->size || end < start || start < arena->top ) {
+        arena->failures++;
+        return 0;
+    }
+
+    if( arena->flags&ARENA_GUARD ) {
+        t = (TRAILER_t *) (arena->base+end-sizeof(TRAILER_t));
+        t->guard   = GUARD;
+        t->prevtop = arena->top;
+    }
+    arena->top = end;
+    if( end > arena->highwater )
+        arena->highwater = end;
+    arena->allocs++;
+    return arena->base+start;
+}
+
+/**
+ *  @brief  Arena_Alloc
+ */
+void *
+Arena_Alloc(ARENA arena, unsigned size) {
+
+    return Arena_AllocAligned(arena,size,ARENA_ALIGN);
+}
+
+/**
+ *  @brief  Arena_AllocDMA
+ *
+ *  @note   Start and size aligned to the cache line (32 bytes on Cortex-M7)
+ */
+void *
+Arena_AllocDMA(ARENA arena, unsigned size) {
+
+    return Arena_AllocAligned(arena,roundup(size,ARENA_CACHELINE),ARENA_CACHELINE);
+}
+
+/**
+ *  @brief  Arena_Check
+ *
+ *  @note   Returns the number of overwritten guard words found (0 or 1, the walk
+ *          stops at the first one) or 0 without ARENA_GUARD
+ */
+int
+Arena_Check(ARENA arena) {
+uint32_t top = arena->top;
+TRAILER_t *t;
+
+    if( (arena->flags&ARENA_GUARD) == 0 )
+        return 0;
+
+    while( top > 0 ) {
+        t = (TRAILER_t *) (arena->base+top-sizeof(TRAILER_t));
+        if( t->guard != GUARD || t->prevtop >= top ) {
+            arena->guarderrors++;
+            return 1;
+        }
+        top = t->prevtop;
+    }
+    return 0;
+}
+
+/**
+ *  @brief  Arena_Mark
+ */
+ARENA_MARK
+Arena_Mark(ARENA arena) {
+
+    return arena->top;
+}
+
+/**
+ *  @brief  Arena_Release
+ *
+ *  @note   Frees all allocations done after mark. The guards are checked first
+ */
+void
+Arena_Release(ARENA arena, ARENA_MARK mark) {
+
+    (void) Arena_Check(arena);
+    if( mark < arena->top )
+        arena->top = mark;
+    arena->resets++;
+}
+
+/**
+ *  @brief  Arena_Reset
+ */
+void
+Arena_Reset(ARENA arena) {
+
+    Arena_Release(arena,0);
+}
+
+/**
+ *  @brief  Arena_Available
+ *
+ *  @note   Bytes after top (an allocation can get less because of alignment and
+ *          the guard)
+ */
+long
+Arena_Available(ARENA arena) {
+
+    return (long) (arena->size-arena->top);
+}
+
+/**
+ *  @brief  Arena_GetStats
+ */
+void
+Arena_GetStats(ARENA arena, ARENA_Stats *stats) {
+
+    stats->size         = (long) arena->size;
+    stats->inuse        = (long) arena->top;
+    stats->highwater    = (long) arena->highwater;
+    stats->allocs       = arena->allocs;
+    stats->failures     = arena->failures;
+    stats->resets       = arena->resets;
+    stats->guarderrors  = arena->guarderrors;
+}
@@ -0,0 +1,77 @@
+#ifndef ARENA_H
+#define ARENA_H
+/**
+ *  @file   arena.h
+ *
+ *  @note   Arena (bump pointer) allocator for buffers that all die at the same
+ *          time, e.g. at the end of a frame or of a burst of packets
+ *
+ *  @note   The memory is given by the caller: a block got from a buddy pool in
+ *          SDRAM, a static area in DTCM, ... There is no free. Arena_Mark and
+ *          Arena_Release free all allocations done after the mark, Arena_Reset
+ *          frees all
+ *
+ *  @note   Not reentrant. An arena must be used by only one thread and not in
+ *          interrupts
+ *
+ *  @author Hans
+ *  @date   15/10/2026
+ */
+
+#include <stdint.h>
+
+/**
+ *  @brief  Handle for an arena
+ */
+typedef struct arena_s *ARENA;
+
+/**
+ *  @brief  Position returned by Arena_Mark
+ */
+typedef uint32_t ARENA_MARK;
+
+/**
+ *  @brief  Alignments
+ *
+ *  @note   Arena_Alloc uses ARENA_ALIGN (double and uint64_t). Arena_AllocDMA
+ *          aligns start and size to the cache line, so a cache clean or
+ *          invalidate of the buffer does not touch other data
+ */
+///@{
+#define ARENA_ALIGN                 (8)
+#define ARENA_CACHELINE             (32)
+///@}
+
+/**
+ *  @brief  Flags for Arena_Create
+ */
+///@{
+#define ARENA_GUARD                 (1)     ///< Guard word after each allocation
+///@}
+
+/**
+ *  @brief  Statistics of an arena
+ */
+typedef struct {
+    long        size;                       ///< size of the area
+    long        inuse;                      ///< bytes from the start to the top
+    long        highwater;                  ///< maximal value of inuse
+    unsigned    allocs;                     ///< allocations that succeeded
+    unsigned    failures;                   ///< allocations that did not fit
+    unsigned    resets;                     ///< calls of Arena_Reset and Arena_Release
+    unsigned    guarderrors;                ///< overwritten guard words found
+} ARENA_Stats;
+
+ARENA       Arena_Create(void *addr, long size, int flags);
+void        Arena_Destroy(ARENA arena);
+void       *Arena_Alloc(ARENA arena, unsigned size);
+void       *Arena_AllocAligned(ARENA arena, unsigned size, unsigned align);
+void       *Arena_AllocDMA(ARENA arena, unsigned size);
+ARENA_MARK  Arena_Mark(ARENA arena);
+void        Arena_Release(ARENA arena, ARENA_MARK mark);
+void        Arena_Reset(ARENA arena);
+int         Arena_Check(ARENA arena);
+long        Arena_Available(ARENA arena);
+void        Arena_GetStats(ARENA arena, ARENA_Stats *stats);
+
+#endif
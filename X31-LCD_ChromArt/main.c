@@ -25,23 +25,27 @@
 #define OPERATING_FREQUENCY (200000000)
 
 /**
- * @brief   Quick and dirty delay routine
- *
- * @note    It gives approximately 1ms delay at 16 MHz
- *
- * @note    The COUNTERFOR1MS must be adjusted by trial and error
- *
- * @note    Do not use this or similar in production code
+ * @brief   Milliseconds counter, incremented by SysTick
  */
+static volatile uint32_t tick_ms = 0;
 
-#define COUNTERFOR1MS 300000
+void SysTick_Handler(void) {
 
+    tick_ms++;
+}
 
-void ms_delay(volatile int ms) {
-   while (ms-- > 0) {
-      volatile int x=COUNTERFOR1MS;
-      while (x-- > 0)
-         __NOP();
+/**
+ * @brief   Delay routine
+ *
+ * @note    Sleeps (WFI) between the SysTick interrupts, so it does not depend
+ *          on the core frequency. SysTick must be set to 1 ms after each clock
+ *          change
+ */
+void ms_delay(int ms) {
+uint32_t start = tick_ms;
+
+   while( (tick_ms-start) < (uint32_t) ms ) {
+      __WFI();
    }
 }
 
@@ -152,12 +156,16 @@ void *fbarea1;
 void *fbarea2;
 int format = LCD_FORMAT_RGB888;
 
+    // 1 ms ticks for ms_delay
+    SysTick_Config(SystemCoreClock/1000);
+
     message("Initializing LED");
     LED_Init();
 
     message("Setting clock to operating frequency");
     SystemConfigMainPLL(&MainPLLConfiguration_200MHz);
     SystemSetCoreClock(CLOCKSRC_PLL,1);
+    SysTick_Config(SystemCoreClock/1000);
     printf("Frequency is now %d Hz\n",SystemCoreClock);
 
     messagewithconfirm("Press ENTER to turn OFF backlight without LCD initialization");
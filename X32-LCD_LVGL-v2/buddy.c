@@ -1,3 +1,4 @@
+
 /**
  *  @file   buddy.c
  *
@@ -41,73 +42,325 @@
  *
  *    By observing the two bits, one can determine its status.
  *
+ *  @note
+ *    The two bits of node k are stored side by side, bits 2k (used) and 2k+1 (split) of one
+ *    bit vector in the order of the table above. So a node is tested with one load and the
+ *    nodes of the upper levels, visited by every allocation, share the first words.
+ *
+ *  @note
+ *    A free block is a node with used and split bits cleared whose parent has the split bit
+ *    set (or the root). All free blocks of the same level are linked in a doubly linked list,
+ *    whose nodes are stored inside the free blocks themselves. So Buddy_Alloc and Buddy_Free
+ *    run in O(levels) time and do not need a stack to navigate the tree.
+ *
+ *  @note
+ *    There can be many independent pools. Each one has its own bit vector, sized according
+ *    its size/minsize ratio. They are carved from a small common map area. When it is not
+ *    enough, the bit vector is stored at the head of the managed area, whose blocks are
+ *    marked as used. The caller can also provide an area for them.
+ *
+ *  @note
+ *    Buddy_AllocFrom, Buddy_FreeTo and Buddy_BlockSize (and the functions using the default
+ *    pool) can be called from interrupts. The changes of the bit vectors, free lists and
+ *    counters are done with the interrupts disabled (PRIMASK). The walk is O(levels), so the
+ *    time is bounded. The longest one is in maxlockcycles of the statistics. Creating pools
+ *    and Buddy_SetDMAPool must be done before the interrupts use them.
+ *
  */
 
 #include <stdint.h>
+#include <string.h>
 #ifdef DEBUG
 #include <stdio.h>
-#include <string.h>
 #endif
 
 
 #include "bitvector.h"
 #include "buddy.h"
+#include "profile.h"
 
 /**
- *  @brief  pool->mapsizeMAX
+ *  @brief  Use DWT cycle counter to measure latency of Buddy_AllocFrom and Buddy_FreeTo
  *
- *  Define the bitmap size used to manage the allocation process
+ *  @note   Set to 0 when compiling for a host or a processor without DWT
+ */
+#ifndef BUDDY_CYCLECOUNTER
+#define BUDDY_CYCLECOUNTER  1
+#endif
+
+/**
+ *  @brief  Disable interrupts while a pool is changed
  *
- *  @note   It limits the ratio POLL_SIZE/POLL_MINSIZE
+ *  @note   Set to 0 when compiling for a host or when no interrupt routine uses the
+ *          allocator
  */
-#define  MAXRATIO   2048
+#ifndef BUDDY_IRQSAFE
+#define BUDDY_IRQSAFE       1
+#endif
 
-#define  MAPSIZEMAX   (MAXRATIO*2)
+#if BUDDY_CYCLECOUNTER || BUDDY_IRQSAFE
+#include "stm32f746xx.h"
+#endif
 
 /**
- *  @brief  Buddy area pool
+ *  @brief  Maximal number of pools
+ */
+#define  MAXPOOLS   4
+
+/**
+ *  @brief  Maximal number of levels in the tree
  *
- *  @note   There is only one pool!!!
+ *  @note   It limits the ratio size/minsize of a pool to 2^(MAXLEVELS-1)
+ *
+ *  @note   Defined in buddy.h because it is used in BUDDY_Stats
  */
-typedef struct {
+#define  MAXLEVELS  BUDDY_MAXLEVELS
+
+/**
+ *  @brief  MAPAREASIZE
+ *
+ *  Define the number of tree nodes available to all pools in the common map area
+ *
+ *  @note   A pool with ratio size/minsize uses 2*ratio nodes. The default is enough
+ *          for MAXPOOLS pools with a 1024 ratio. Larger pools store their bit vectors
+ *          in the managed area
+ */
+#define  MAPAREASIZE   (MAXPOOLS*1024*2)
+
+/**
+ *  @brief  Node of the free lists
+ *
+ *  @note   It is stored in the first bytes of the free block. So the minimal block size
+ *          must be at least sizeof(FREEBLOCK_t)
+ */
+typedef struct freeblock_s {
+    struct freeblock_s  *next;                  /// next free block of the same level
+    struct freeblock_s  *prev;                  /// previous free block of the same level
+} FREEBLOCK_t;
+
+/**
+ *  @brief  Buddy area pool
+ */
+typedef struct buddypool_s {
     char        *baseaddress;                   /// base address of area to be managed
     long        size;                           /// size of area to be managed (=power of 2)
     long        minimalsize;                    /// minimal block size
     long        mapsize;                        /// size/minimalsize
     long        treesize;                       /// pool->mapsize*2-1
-    BV_TYPE     used[MAPSIZEMAX];               /// bit vector to store free(0) or used(1) block
-    BV_TYPE     split[MAPSIZEMAX];              /// bit vector to signal if a block was split
+    int         levels;                         /// number of levels in the tree
+    FREEBLOCK_t *freelist[MAXLEVELS];           /// list of free blocks for each level
+    BV_TYPE     *state;                         /// used (bit 2k) and split (bit 2k+1) of node k
+    // Statistics
+    unsigned    nfree[MAXLEVELS];               /// number of free blocks in each level
+    long        inuse;                          /// bytes in allocated blocks
+    long        highwater;                      /// maximal value of inuse
+    unsigned    allocs;                         /// number of allocations
+    unsigned    frees;                          /// number of frees
+    unsigned    failures;                       /// number of failed allocations
+    unsigned    inplace;                        /// number of reallocations done in place
+    uint32_t    maxlockcycles;                  /// longest time with interrupts disabled
+    unsigned    alloccycles[BUDDY_HISTOGRAMSIZE];   /// histogram of Buddy_AllocFrom latency
+    unsigned    freecycles[BUDDY_HISTOGRAMSIZE];    /// histogram of Buddy_FreeTo latency
 } POOL_t;
 
 /**
- *  @brief  Buddy area
+ *  @brief  Buddy areas
  */
 ///@{
-static POOL_t   poolarea;
-static POOL_t   *pool = &poolarea;
+static POOL_t   poolarea[MAXPOOLS];
+static int      poolcount = 0;
+static POOL     defaultpool = 0;
+static POOL     dmapool = 0;
 ///@}
-#define TREESIZE       (pool->mapsize*2-1)                    ///< Number of elements in the tree
 
 /**
- *  @brief  Structure used to navigate the allocation tree
+ *  @brief  Area for the bit vectors of all pools
  */
+///@{
+static BV_TYPE  maparea[2*BV_SIZE(MAPAREASIZE)];
+static int      mapused = 0;                    /// number of BV_TYPE elements already used
+///@}
 
-typedef struct {
-    int         level;      ///< level of node
-    int         index;      ///< index of node
-    int         size;       ///< size of block
-    uint32_t    addr;       ///< address of block
-} nodeinfo;
+#define TREESIZE(POOL)  ((POOL)->mapsize*2-1)                 ///< Number of elements in the tree
 
+static inline int isodd(int n) { return n&1; }
+static inline int iseven(int n) { return (n&1)^1; }
+static inline int ispowerof2(long n) { return (n>0)&&((n&(n-1))==0); }
 
 /**
- *  @brief  buddy_init
+ *  @brief  State of a node
+ *
+ *  @note   The two bits of a node are in the same word, so nodestate reads both
  */
-int
-Buddy_Init(char *address, long size, long minsize) {
+///@{
+#define NODE_USED       1
+#define NODE_SPLIT      2
 
-    if( size/minsize > MAXRATIO )
-        return -1;
+static inline int
+nodestate(POOL pool, int k) {
+    return (pool->state[bv_index(2*k)]>>bv_bit(2*k))&(NODE_USED|NODE_SPLIT);
+}
+static inline int isused(POOL pool, int k) { return bv_test(pool->state,2*k) != 0; }
+static inline void setused(POOL pool, int k) { bv_set(pool->state,2*k); }
+static inline void clearused(POOL pool, int k) { bv_clear(pool->state,2*k); }
+static inline void setsplit(POOL pool, int k) { bv_set(pool->state,2*k+1); }
+static inline void clearsplit(POOL pool, int k) { bv_clear(pool->state,2*k+1); }
+///@}
+
+/**
+ *  @brief  Cycle counter
+ *
+ *  @note   Returns 0 when BUDDY_CYCLECOUNTER is 0
+ */
+static inline uint32_t
+getcycles(void) {
+#if BUDDY_CYCLECOUNTER
+    return DWT->CYCCNT;
+#else
+    return 0;
+#endif
+}
+
+/**
+ *  @brief  Critical section
+ *
+ *  @note   Saves and restores PRIMASK, so it can be nested and used in interrupts
+ */
+///@{
+static inline uint32_t
+lock(void) {
+#if BUDDY_IRQSAFE
+uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    return primask;
+#else
+    return 0;
+#endif
+}
+
+static inline void
+unlock(uint32_t primask) {
+#if BUDDY_IRQSAFE
+    __set_PRIMASK(primask);
+#else
+    (void) primask;
+#endif
+}
+///@}
+
+/**
+ *  @brief  Enable cycle counter
+ */
+static void
+enablecyclecounter(void) {
+#if BUDDY_CYCLECOUNTER
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;                      // Unlock access on Cortex-M7
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+/**
+ *  @brief  Add a sample to a histogram indexed by log2 of cycles
+ */
+static inline void
+addsample(unsigned *histogram, uint32_t cycles) {
+int b;
+
+    b = (cycles==0)?0:31-__builtin_clz(cycles);
+    if( b >= BUDDY_HISTOGRAMSIZE )
+        b = BUDDY_HISTOGRAMSIZE-1;
+    histogram[b]++;
+}
+
+/**
+ *  @brief  Index of first node of a level
+ */
+static inline int
+firstnode(int level) {
+    return (1<<level)-1;
+}
+
+/**
+ *  @brief  Size of blocks of a level
+ */
+static inline long
+blocksize(POOL pool, int level) {
+    return pool->size>>level;
+}
+
+/**
+ *  @brief  Address of block corresponding to node k of a level
+ */
+static inline FREEBLOCK_t *
+nodeaddress(POOL pool, int k, int level) {
+    return (FREEBLOCK_t *) (pool->baseaddress+(k-firstnode(level))*blocksize(pool,level));
+}
+
+/**
+ *  @brief  Index of node corresponding to block at address b of a level
+ */
+static inline int
+nodeindex(POOL pool, FREEBLOCK_t *b, int level) {
+    return firstnode(level)+((char *) b-pool->baseaddress)/blocksize(pool,level);
+}
+
+/**
+ *  @brief  Insert node k in the free list of its level
+ */
+static void
+freelist_insert(POOL pool, int k, int level) {
+FREEBLOCK_t *b = nodeaddress(pool,k,level);
+
+    b->prev = 0;
+    b->next = pool->freelist[level];
+    if( b->next )
+        b->next->prev = b;
+    pool->freelist[level] = b;
+    pool->nfree[level]++;
+}
+
+/**
+ *  @brief  Remove node k from the free list of its level
+ */
+static void
+freelist_remove(POOL pool, int k, int level) {
+FREEBLOCK_t *b = nodeaddress(pool,k,level);
+
+    if( b->prev )
+        b->prev->next = b->next;
+    else
+        pool->freelist[level] = b->next;
+    if( b->next )
+        b->next->prev = b->prev;
+    pool->nfree[level]--;
+}
+
+/**
+ *  @brief  Buddy_MapSize
+ *
+ *  @note   Returns the size in bytes of the bit vector needed to manage a pool
+ */
+long
+Buddy_MapSize(long size, long minsize) {
+
+    if( minsize <= 0 )
+        return 0;
+    return BV_SIZE(4*(size/minsize))*sizeof(BV_TYPE);
+}
+
+/**
+ *  @brief  initpool
+ *
+ *  @note   Initializes a pool descriptor using the bit vector at map
+ *
+ *  @note   The free lists are empty. The caller must insert the free blocks
+ */
+static int
+initpool(POOL pool, char *address, long size, long minsize, BV_TYPE *map) {
+long s;
+int  l;
 
     pool->baseaddress = address;                /// base address of area to be managed
     pool->size        = size;                   /// size of area to be managed (=power of 2)
@@ -115,221 +368,696 @@ Buddy_Init(char *address, long size, long minsize) {
     pool->mapsize     = size/minsize;           /// size/minimalsize
     pool->treesize    = 2*pool->mapsize-1;      /// pool->mapsize*2-1
 
-    bv_clearall(pool->used,pool->mapsize*2);    /// Clear used block flags
-    bv_clearall(pool->split,pool->mapsize*2);   /// Clear split block flags
+    l = 1;
+    for(s=size;s>minsize;s/=2) l++;
+    pool->levels      = l;                      /// log2(mapsize)+1
+
+    pool->state       = map;
+    bv_clearall(pool->state,pool->mapsize*4);   /// Clear used and split flags
+
+    for(l=0;l<MAXLEVELS;l++) {
+        pool->freelist[l] = 0;
+        pool->nfree[l] = 0;
+    }
+    pool->inuse = 0;
+    Buddy_ResetStats(pool);
+    enablecyclecounter();
 
     return 0;
 }
 
 /**
- *  @brief  buddy_alloc
+ *  @brief  reservehead
+ *
+ *  @note   Marks the blocks at the head of the area as used, like an allocation of
+ *          n bytes. It does not write in the reserved area, where the bit vectors are.
  */
-void *
-Buddy_Alloc(unsigned size) {
+static void
+reservehead(POOL pool, long n) {
+int k = 0;
+int l = 0;
+
+    while( (l < pool->levels-1) && (blocksize(pool,l+1) >= n) ) {
+        setsplit(pool,k);
+        k = 2*k+1;
+        l++;
+        freelist_insert(pool,k+1,l);
+    }
+    setused(pool,k);
+    pool->inuse     = blocksize(pool,l);
+    pool->highwater = pool->inuse;
+}
+
+/**
+ *  @brief  checkparameters
+ *
+ *  @note   Returns -1 when the parameters can not be used to create a pool
+ */
+static int
+checkparameters(long size, long minsize) {
+long s;
+int  l;
+
+    if( poolcount >= MAXPOOLS )
+        return -1;
+
+    if( !ispowerof2(size) || !ispowerof2(minsize) || (minsize > size) )
+        return -1;
+
+    if( minsize < (long) sizeof(FREEBLOCK_t) )
+        return -1;
+
+    l = 1;
+    for(s=size;s>minsize;s/=2) l++;
+    if( l > MAXLEVELS )
+        return -1;
+
+    return 0;
+}
+
+/**
+ *  @brief  Buddy_CreatePoolWithMap
+ *
+ *  @note   Creates a pool to manage the area at address with size bytes. The bit vectors
+ *          are stored in the area at map, which must have at least
+ *          Buddy_MapSize(size,minsize) bytes and be aligned to a word.
+ *
+ *  @note   Returns 0 when there is no more pools or map is too small
+ */
+POOL
+Buddy_CreatePoolWithMap(char *address, long size, long minsize, void *map, long mapbytes) {
+POOL pool;
+
+    if( checkparameters(size,minsize) < 0 )
+        return 0;
+
+    if( (map == 0) || (mapbytes < Buddy_MapSize(size,minsize)) )
+        return 0;
+
+    pool = &poolarea[poolcount++];
+    initpool(pool,address,size,minsize,(BV_TYPE *) map);
+    freelist_insert(pool,0,0);                  /// The whole area is free
+
+    return pool;
+}
+
+/**
+ *  @brief  Buddy_CreatePool
+ *
+ *  @note   Creates a pool to manage the area at address with size bytes. The
+ *          allocated blocks have at least minsize bytes.
+ *
+ *  @note   size and minsize must be powers of 2
+ *
+ *  @note   The bit vectors are stored in the common map area. When there is no space
+ *          there, they are stored at the head of the managed area. The blocks used by
+ *          them are marked as used, so size/(2*minsize) bytes are lost.
+ *
+ *  @note   Returns 0 when there is no more pools or the parameters are invalid
+ */
+POOL
+Buddy_CreatePool(char *address, long size, long minsize) {
+POOL pool;
+int  mapelements;
+long mapbytes;
+
+    if( checkparameters(size,minsize) < 0 )
+        return 0;
+
+    mapbytes    = Buddy_MapSize(size,minsize);
+    mapelements = mapbytes/sizeof(BV_TYPE);
+
+    if( mapused+mapelements <= (int) (sizeof(maparea)/sizeof(BV_TYPE)) ) {
+        pool = &poolarea[poolcount++];
+        initpool(pool,address,size,minsize,&maparea[mapused]);
+        freelist_insert(pool,0,0);              /// The whole area is free
+        mapused += mapelements;
+        return pool;
+    }
+
+    // Bit vectors at the head of managed area
+    if( mapbytes >= size )
+        return 0;
+
+    pool = &poolarea[poolcount++];
+    initpool(pool,address,size,minsize,(BV_TYPE *) address);
+    reservehead(pool,mapbytes);
+
+    return pool;
+}
+
+/**
+ *  @brief  allocblock
+ *
+ *  @note   Finds the smallest free block that fits, splitting larger blocks when
+ *          needed. The right halves generated by the splits are put in the free lists.
+ */
+static void *
+allocblock(POOL pool, unsigned size) {
 int level;
-int s;
-int k;
 int l;
-uint32_t a;
-
-nodeinfo stack[MAXRATIO];
-int sp;
-nodeinfo node;
+int k;
+FREEBLOCK_t *b;
 
     // Too big?
     if( size > pool->size )
         return 0;
 
+    // Find level where blocks fit
+    level = pool->levels-1;
+    while( blocksize(pool,level) < size )
+        level--;
+
+    // Find nearest level with a free block
+    l = level;
+    while( (l >= 0) && (pool->freelist[l] == 0) )
+        l--;
+
     // Already full
-    if( bv_test(pool->used,0) )
+    if( l < 0 )
         return 0;
 
-    sp = 0;
-    stack[sp].level = 0;
-    stack[sp].index = 0;
-    stack[sp].size = pool->size;
-    stack[sp].addr = 0;
-    sp++;
-
-    while( sp > 0 ) {
-        sp--;
-        node = stack[sp];
-        k = node.index;
-        s = node.size;
-        a = node.addr;
-        l = node.level;
-
-        // test if block already used
-        if( bv_test(pool->used,k) )
-            continue;
-        // test if need full block
-        if( (size > s/2) || (s == pool->minimalsize) ) {
-            // if already split, try another block
-            if( bv_test(pool->split,k) == 0 ) {
-                // reserve it
-                bv_set(pool->used,k);
-                return (void *) ((char *) pool->baseaddress+a);
-            }
-        }
-        s /= 2;
-        if( size > s )
-            continue;
+    b = pool->freelist[l];
+    k = nodeindex(pool,b,l);
+    freelist_remove(pool,k,l);
 
-        // Mark as split
-        bv_set(pool->split,k);
-        // Try left and right leaves.
+    // Split until the requested size is reached
+    while( l < level ) {
+        setsplit(pool,k);
+        k = 2*k+1;
         l++;
-        //Left must be on top of stack
-        stack[sp].index = 2*k+2;
-        stack[sp].addr  = a+s;
-        stack[sp].size  = s;
-        stack[sp].level = l;
-        sp++;
-        stack[sp].index = 2*k+1;
-        stack[sp].addr  = a;
-        stack[sp].size  = s;
-        stack[sp].level = l;
-        sp++;
+        freelist_insert(pool,k+1,l);
     }
-    return 0;
+
+    // reserve it
+    setused(pool,k);
+    pool->inuse += blocksize(pool,level);
+    if( pool->inuse > pool->highwater )
+        pool->highwater = pool->inuse;
+    return (void *) b;
 }
 
-static inline int isodd(int n) { return n&1; }
-static inline int iseven(int n) { return (n&1)^1; }
+/**
+ *  @brief  Buddy_AllocFrom
+ *
+ *  @note   Allocates a block with at least size bytes from pool
+ */
+void *
+Buddy_AllocFrom(POOL pool, unsigned size) {
+uint32_t primask,start,cycles;
+void *p;
+
+    if( pool == 0 )
+        return 0;
+
+    primask = lock();
+    start = getcycles();
+    p = allocblock(pool,size);
+    cycles = getcycles()-start;
+    addsample(pool->alloccycles,cycles);
+    if( p )
+        pool->allocs++;
+    else
+        pool->failures++;
+    if( cycles > pool->maxlockcycles )
+        pool->maxlockcycles = cycles;
+    unlock(primask);
+    return p;
+}
 
 /**
- *  @brief  buddy_free
+ *  @brief  Buddy_AllocAlignedFrom
+ *
+ *  @note   Allocates a block with at least size bytes whose address and size are
+ *          multiples of align (a power of 2). A block is aligned to its size
+ *          from the base of the pool, so size is rounded up to align and the base
+ *          must be aligned to align. Returns 0 otherwise
  */
-void Buddy_Free(void *addr) {
-uint32_t disp = (char *) addr - (char *)pool->baseaddress;       // 4 GB limit
-int b,d,k,p;
+void *
+Buddy_AllocAlignedFrom(POOL pool, unsigned size, unsigned align) {
 
-    d = disp/pool->minimalsize;
+    if( pool == 0 )
+        return 0;
 
-    k = pool->mapsize+d-1;
-    // Free if it is not
-    bv_clear(pool->used,k);
-    bv_clear(pool->split,k);
-    // Find block to be freed
-    while( k > 0 ) {
-            k /= 2;
-        if( bv_test(pool->used,k) ) {
-            bv_clear(pool->used,k);
-            bv_clear(pool->split,k);
-            break;
-        }
+    if( !ispowerof2(align) || ((uintptr_t) pool->baseaddress&(align-1)) != 0 ) {
+        uint32_t primask = lock();
+        pool->failures++;
+        unlock(primask);
+        return 0;
     }
-    // Adjust parents
+    size = (size+align-1)&~(align-1);
+    if( size == 0 )
+        size = align;
+    return Buddy_AllocFrom(pool,size);
+}
+
+/**
+ *  @brief  freeblock
+ *
+ *  @note   Coalesces the block with its buddies while they are free.
+ */
+static int
+freeblock(POOL pool, void *addr) {
+uint32_t disp;
+int b,k,level;
+
+    disp = (char *) addr - (char *)pool->baseaddress;       // 4 GB limit
+    if( (disp >= pool->size) || (disp%pool->minimalsize) != 0 )
+        return -1;
+
+    level = pool->levels-1;
+    k = pool->mapsize+disp/pool->minimalsize-1;
+
+    // Find block to be freed. It is the used node among those starting at addr
+    while( !isused(pool,k) ) {
+        // Only left nodes have the same address as their parents
+        if( (k == 0) || iseven(k) )
+            return -1;
+        k = (k-1)/2;
+        level--;
+    }
+    clearused(pool,k);
+    pool->inuse -= blocksize(pool,level);
+
+    // Join with buddy while it is free
     while( k > 0 ) {
         // find buddy
-
         if( isodd(k) )
             b = k+1;
         else
             b = k-1;
-        if(  (bv_test(pool->used,k)==0)
-           &&(bv_test(pool->used,b)==0)
-           &&(bv_test(pool->split,k)==0)
-           &&(bv_test(pool->split,b))    ) {
-            p = k/2;
-            bv_clear(pool->split,p);
-        }
-        k /= 2;
+        if( nodestate(pool,b) != 0 )
+            break;
+        freelist_remove(pool,b,level);
+        k = (k-1)/2;
+        level--;
+        clearsplit(pool,k);
     }
+    freelist_insert(pool,k,level);
+    return 0;
 }
 
+/**
+ *  @brief  Buddy_FreeTo
+ *
+ *  @note   Returns the block at addr to pool
+ */
+void
+Buddy_FreeTo(POOL pool, void *addr) {
+uint32_t primask,start,cycles;
 
+    if( pool == 0 )
+        return;
 
-#ifdef DEBUG
+    primask = lock();
+    start = getcycles();
+    if( freeblock(pool,addr) == 0 ) {
+        cycles = getcycles()-start;
+        addsample(pool->freecycles,cycles);
+        pool->frees++;
+        if( cycles > pool->maxlockcycles )
+            pool->maxlockcycles = cycles;
+    }
+    unlock(primask);
+}
 
 /**
- *  @brief  fillmap
+ *  @brief  resizeblock
+ *
+ *  @note   Changes the size of the used block at addr without moving it. To shrink,
+ *          the block is split and the right halves are put in the free lists. To
+ *          grow, the block must be the left half and its buddy must be free at each
+ *          level up to the new size. Returns -1 when it can not be done in place
  */
-static void
-fillmap(char *m,int start, int end, char c) {
-int i;
+static int
+resizeblock(POOL pool, void *addr, unsigned size) {
+uint32_t disp;
+int b,k,level,newlevel,l;
 
-    for(i=start;i<end;i++) {
-        if( c == '-' || m[i] == '-' )
-            m[i] = c;
-        else
-            m[i] = '*';
+    if( size > pool->size )
+        return -1;
+
+    disp = (char *) addr - (char *)pool->baseaddress;       // 4 GB limit
+    if( (disp >= pool->size) || (disp%pool->minimalsize) != 0 )
+        return -1;
+
+    level = pool->levels-1;
+    k = pool->mapsize+disp/pool->minimalsize-1;
+    while( !isused(pool,k) ) {
+        if( (k == 0) || iseven(k) )
+            return -1;
+        k = (k-1)/2;
+        level--;
     }
 
+    newlevel = pool->levels-1;
+    while( blocksize(pool,newlevel) < size )
+        newlevel--;
+
+    if( newlevel < level ) {
+        // Check that the buddies are free before changing anything
+        b = k;
+        for(l=level;l>newlevel;l--) {
+            if( (b == 0) || iseven(b) )
+                return -1;
+            if( nodestate(pool,b+1) != 0 )
+                return -1;
+            b = (b-1)/2;
+        }
+        clearused(pool,k);
+        for(l=level;l>newlevel;l--) {
+            freelist_remove(pool,k+1,l);
+            k = (k-1)/2;
+            clearsplit(pool,k);
+        }
+        setused(pool,k);
+        pool->inuse += blocksize(pool,newlevel)-blocksize(pool,level);
+        if( pool->inuse > pool->highwater )
+            pool->highwater = pool->inuse;
+    } else if( newlevel > level ) {
+        clearused(pool,k);
+        for(l=level;l<newlevel;l++) {
+            setsplit(pool,k);
+            k = 2*k+1;
+            freelist_insert(pool,k+1,l+1);
+        }
+        setused(pool,k);
+        pool->inuse -= blocksize(pool,level)-blocksize(pool,newlevel);
+    }
+    return 0;
 }
 
+/**
+ *  @brief  Buddy_ReallocFrom
+ *
+ *  @note   Changes the size of the block at addr to at least size bytes, like
+ *          realloc. The block is resized in place when possible (shrinking, or
+ *          growing into free buddies). Otherwise a new block is allocated, the data
+ *          copied and the old block freed. Returns 0 when there is no space, and
+ *          then the old block is not changed. addr equal to 0 allocates, size equal
+ *          to 0 frees
+ */
+void *
+Buddy_ReallocFrom(POOL pool, void *addr, unsigned size) {
+uint32_t primask,start,cycles;
+long oldsize;
+void *p;
+int rc;
+
+    if( pool == 0 )
+        return 0;
+    if( addr == 0 )
+        return Buddy_AllocFrom(pool,size);
+    if( size == 0 ) {
+        Buddy_FreeTo(pool,addr);
+        return 0;
+    }
+
+    primask = lock();
+    start = getcycles();
+    rc = resizeblock(pool,addr,size);
+    cycles = getcycles()-start;
+    if( rc == 0 )
+        pool->inplace++;
+    if( cycles > pool->maxlockcycles )
+        pool->maxlockcycles = cycles;
+    unlock(primask);
+    if( rc == 0 )
+        return addr;
+
+    oldsize = Buddy_BlockSize(pool,addr);
+    if( oldsize == 0 )
+        return 0;
+    p = Buddy_AllocFrom(pool,size);
+    if( p == 0 )
+        return 0;
+    memcpy(p,addr,(oldsize<(long)size)?oldsize:size);
+    Buddy_FreeTo(pool,addr);
+    return p;
+}
 
 /**
- *  @brief  buildmap
+ *  @brief  Buddy_BlockSize
+ *
+ *  @note   Returns the size of the allocated block at addr or 0 if addr is not
+ *          an allocated block of pool
  */
-static void
-buildmap(char *m) {
-int level;
-int s;
-int k;
-int l;
-uint32_t a;
-nodeinfo stack[pool->mapsize];
-int sp;
-nodeinfo node;
-
-    fillmap(m,0,pool->mapsize,'-');
-
-    sp = 0;
-    stack[sp].level = 0;
-    stack[sp].index = 0;
-    stack[sp].size = pool->size/pool->minimalsize;
-    stack[sp].addr = 0;
-    sp++;
-
-    while(sp>0) {
-        sp--;
-        node = stack[sp];
-        k = node.index;
-        s = node.size;
-        a = node.addr;
-        l = node.level;
-        // test if block already used
-        if( bv_test(pool->used,k) ) {
-            fillmap(m,a,a+s,'U');
+long
+Buddy_BlockSize(POOL pool, void *addr) {
+uint32_t disp,primask;
+int k,level;
+
+    if( pool == 0 )
+        return 0;
+
+    disp = (char *) addr - (char *)pool->baseaddress;       // 4 GB limit
+    if( (disp >= pool->size) || (disp%pool->minimalsize) != 0 )
+        return 0;
+
+    level = pool->levels-1;
+    k = pool->mapsize+disp/pool->minimalsize-1;
+    primask = lock();
+    while( !isused(pool,k) ) {
+        if( (k == 0) || iseven(k) ) {
+            unlock(primask);
+            return 0;
         }
+        k = (k-1)/2;
+        level--;
+    }
+    unlock(primask);
+    return blocksize(pool,level);
+}
 
-        if( s == 1 )
-            continue;
+/**
+ *  @brief  Buddy_GetPoolStats
+ *
+ *  @note   Fills stats with the counters of pool. Available in release builds
+ */
+void
+Buddy_GetPoolStats(POOL pool, BUDDY_Stats *stats) {
+int l;
+int i;
 
-        s /= 2;
-        // Try left and right leaves.
-        l++;
-        //Left must be on top of stack
-        stack[sp].index = 2*k+2;
-        stack[sp].addr  = a+s;
-        stack[sp].size  = s;
-        stack[sp].level = l;
-        sp++;
-        stack[sp].index = 2*k+1;
-        stack[sp].addr  = a;
-        stack[sp].size  = s;
-        stack[sp].level = l;
-        sp++;
+    stats->size         = pool->size;
+    stats->minsize      = pool->minimalsize;
+    stats->orders       = pool->levels;
+    stats->inuse        = pool->inuse;
+    stats->highwater    = pool->highwater;
+    stats->largestfree  = 0;
+    stats->allocs       = pool->allocs;
+    stats->frees        = pool->frees;
+    stats->failures     = pool->failures;
+    stats->inplace      = pool->inplace;
+    stats->maxlockcycles = pool->maxlockcycles;
+    for(l=0;l<BUDDY_MAXLEVELS;l++)
+        stats->freeblocks[l] = 0;
+    for(l=pool->levels-1;l>=0;l--) {
+        // order 0 is the minimal block size
+        stats->freeblocks[pool->levels-1-l] = pool->nfree[l];
+        if( pool->nfree[l] )
+            stats->largestfree = blocksize(pool,l);
+    }
+    for(i=0;i<BUDDY_HISTOGRAMSIZE;i++) {
+        stats->alloccycles[i] = pool->alloccycles[i];
+        stats->freecycles[i]  = pool->freecycles[i];
+    }
+}
 
+/**
+ *  @brief  Buddy_ResetStats
+ *
+ *  @note   Clears counters and histograms. The high-water mark is set to current usage
+ */
+void
+Buddy_ResetStats(POOL pool) {
+int i;
+
+    pool->highwater = pool->inuse;
+    pool->allocs    = 0;
+    pool->frees     = 0;
+    pool->failures  = 0;
+    pool->inplace   = 0;
+    pool->maxlockcycles = 0;
+    for(i=0;i<BUDDY_HISTOGRAMSIZE;i++) {
+        pool->alloccycles[i] = 0;
+        pool->freecycles[i]  = 0;
     }
+}
+
+/**
+ *  @brief  buddy_init
+ *
+ *  @note   Creates the default pool used by Buddy_Alloc and Buddy_Free
+ */
+int
+Buddy_Init(char *address, long size, long minsize) {
+POOL pool;
+
+    pool = Buddy_CreatePool(address,size,minsize);
+    if( pool == 0 )
+        return -1;
+
+    defaultpool = pool;
+    return 0;
+}
+
+/**
+ *  @brief  buddy_alloc
+ *
+ *  @note   Uses the default pool
+ */
+void *
+Buddy_Alloc(unsigned size) {
+void *p;
+
+    PROFILE_BEGIN(Buddy_Alloc);
+    p = Buddy_AllocFrom(defaultpool,size);
+    PROFILE_END(Buddy_Alloc);
+    return p;
+}
+
+/**
+ *  @brief  Buddy_AllocAligned
+ *
+ *  @note   Uses the default pool
+ */
+void *
+Buddy_AllocAligned(unsigned size, unsigned align) {
+
+    return Buddy_AllocAlignedFrom(defaultpool,size,align);
+}
+
+/**
+ *  @brief  buddy_free
+ *
+ *  @note   Uses the default pool or the DMA pool, when addr is in its area
+ */
+void
+Buddy_Free(void *addr) {
+
+    if( dmapool && (uint32_t) ((char *) addr-dmapool->baseaddress) < (uint32_t) dmapool->size )
+        Buddy_FreeTo(dmapool,addr);
+    else
+        Buddy_FreeTo(defaultpool,addr);
+}
+
+/**
+ *  @brief  Buddy_Realloc
+ *
+ *  @note   Uses the default pool or the DMA pool, when addr is in its area
+ */
+void *
+Buddy_Realloc(void *addr, unsigned size) {
+
+    if( addr && dmapool && (uint32_t) ((char *) addr-dmapool->baseaddress) < (uint32_t) dmapool->size )
+        return Buddy_ReallocFrom(dmapool,addr,size);
+    return Buddy_ReallocFrom(defaultpool,addr,size);
+}
+
+/**
+ *  @brief  Buddy_SetDMAPool
+ *
+ *  @note   pool should be in a non cacheable region (MPU), so the buffers need no
+ *          cache maintenance. 0 to use the default pool
+ */
+void
+Buddy_SetDMAPool(POOL pool) {
+
+    dmapool = pool;
+}
+
+/**
+ *  @brief  Buddy_AllocDMA
+ *
+ *  @note   Block aligned to BUDDY_CACHELINE (start and size) from the DMA pool or,
+ *          when there is none, from the default pool. A block from the default
+ *          pool is cacheable: clean it before a transmission and invalidate it
+ *          after a reception
+ */
+void *
+Buddy_AllocDMA(unsigned size) {
+
+    if( dmapool )
+        return Buddy_AllocAlignedFrom(dmapool,size,BUDDY_CACHELINE);
+    return Buddy_AllocAlignedFrom(defaultpool,size,BUDDY_CACHELINE);
+}
+
+/**
+ *  @brief  buddy_getstats
+ *
+ *  @note   Uses the default pool. Returns -1 if there is no default pool
+ */
+int
+Buddy_GetStats(BUDDY_Stats *stats) {
+
+    if( defaultpool == 0 )
+        return -1;
+    Buddy_GetPoolStats(defaultpool,stats);
+    return 0;
+}
+
+
+
+#ifdef DEBUG
+
+/**
+ *  @brief  Number of minimal blocks shown in each line of the map
+ */
+#define MAPLINE     64
+
+/**
+ *  @brief  mapchar
+ *
+ *  @note   Returns the status of leaf d: '-' free, 'U' used, '*' used more than once (error)
+ */
+static char
+mapchar(POOL pool, int d) {
+int k;
+int n = 0;
 
-    m[pool->mapsize] = '\0';
+    k = pool->mapsize+d-1;
+    for(;;) {
+        if( isused(pool,k) )
+            n++;
+        if( k == 0 )
+            break;
+        k = (k-1)/2;
+    }
+    return n==0?'-':n==1?'U':'*';
 }
 
 
+/**
+ *  @brief  print allocation map of a pool
+ *
+ *  @note   Uses a fixed size buffer, so it can be used with large pools
+ */
+void Buddy_PrintPoolMap(POOL pool) {
+char line[MAPLINE+1];
+int  d;
+int  i;
+
+    for(d=0;d<pool->mapsize;d+=MAPLINE) {
+        for(i=0;(i<MAPLINE)&&(d+i<pool->mapsize);i++)
+            line[i] = mapchar(pool,d+i);
+        line[i] = '\0';
+        printf("|%s|\n",line);
+    }
+}
+
 /**
  *  @brief  print allocation map
  */
 void Buddy_PrintMap(void) {
-char map[pool->mapsize+1];
-    buildmap(map);
-    printf("|%s|\n",map);
-}
 
+    if( defaultpool )
+        Buddy_PrintPoolMap(defaultpool);
+}
 
 
 void Buddy_PrintAddresses(void) {
+POOL pool = defaultpool;
 int level;
 int k;
 int lim;
@@ -337,12 +1065,15 @@ uint32_t addr;
 uint32_t size;
 int delta;
 
+    if( pool == 0 )
+        return;
+
     level = 0;
     size = pool->size;
     lim = 0;
     addr = 0;
     delta = 1;
-    for(k=0;k<TREESIZE;k++) {
+    for(k=0;k<TREESIZE(pool);k++) {
         printf("level = %-2d node = %-3d address = %08X  size=%08X\n",level,k,addr,size);
         if( k == lim ) {
             level++;
@@ -358,4 +1089,3 @@ int delta;
 }
 
 #endif
-
@@ -7,6 +7,8 @@
  * @author  Hans
  */
 
+#include <stdint.h>
+
 
 typedef struct {
     unsigned long   address;                ///< Address of 1st byte of 1st line
@@ -49,12 +51,62 @@ typedef struct {
 #define DMA2D_A8                      9
 #define DMA2D_A4                     10
 
+/**
+ * @brief   Job queue
+ *
+ * @note    DMA2D_QUEUESIZE jobs can wait. The DMA2D interrupt starts the next one
+ */
+///@{
+#ifndef DMA2D_QUEUESIZE
+#define DMA2D_QUEUESIZE              16
+#endif
+#ifndef DMA2D_IRQLEVEL
+#define DMA2D_IRQLEVEL                6
+#endif
+///@}
+
+/**
+ * @brief   Fence returned by DMA2D_Submit*. 0 means not queued
+ */
+typedef uint32_t DMA2D_Fence;
+
+/**
+ * @brief   Completion callback. status is 0 when OK and -1 on DMA2D error
+ *
+ * @note    Called from the DMA2D interrupt
+ */
+typedef void (*DMA2D_Callback)(void *arg, int status);
+
 int DMA2D_Init(void);
 int DMA2D_IsReady(void);
 int DMA2D_Abort(void);
 int DMA2D_Suspend(void);
 int DMA2D_Resume(void);
+/**
+ * @brief   Layers with CLUT (for DMA2D_LoadCLUT)
+ */
+///@{
+#define DMA2D_FOREGROUND              0
+#define DMA2D_BACKGROUND              1
+///@}
+
 int DMA2D_FillRegion(const DMA2DRegion *r, unsigned c);
+int DMA2D_CopyRegion(const DMA2DRegion *src, const DMA2DRegion *dst);
+int DMA2D_BlendRegion(const DMA2DRegion *fg, const DMA2DRegion *bg,
+                      const DMA2DRegion *dst, unsigned alpha);
+int DMA2D_LoadCLUT(int layer, const uint32_t *clut, unsigned n);
+int DMA2D_SetForegroundColor(unsigned c);
+
+DMA2D_Fence DMA2D_SubmitFill(const DMA2DRegion *r, unsigned c, DMA2D_Callback cb, void *arg);
+DMA2D_Fence DMA2D_SubmitCopy(const DMA2DRegion *src, const DMA2DRegion *dst,
+                             DMA2D_Callback cb, void *arg);
+DMA2D_Fence DMA2D_SubmitBlend(const DMA2DRegion *fg, const DMA2DRegion *bg,
+                              const DMA2DRegion *dst, unsigned alpha,
+                              DMA2D_Callback cb, void *arg);
+int      DMA2D_FenceDone(DMA2D_Fence f);
+void     DMA2D_WaitFence(DMA2D_Fence f);
+int      DMA2D_IsIdle(void);
+unsigned DMA2D_GetErrors(void);
 
 
 #endif
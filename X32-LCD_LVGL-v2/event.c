@@ -0,0 +1,164 @@
+/**
+ * @file    event.c
+ *
+ * @note    Event loop (see event.h)
+ *
+ * @note    The events are in a MPSCQ (mpscq.c): Event_Post reserves a slot
+ *          with LDREX/STREX, without disabling the interrupts. Event_Dispatch
+ *          takes up to EVENT_BATCH events at a time, which frees their slots
+ *          before the handlers run
+ *
+ * @note    Event_Sleep tests the queue with the interrupts masked by PRIMASK.
+ *          An interrupt pending at WFI still wakes the core, so an event posted
+ *          after the test is not missed. The interrupt runs after
+ *          __enable_irq
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "stm32f746xx.h"
+#include "mpscq.h"
+#include "event.h"
+
+#if (EVENT_QUEUESIZE&(EVENT_QUEUESIZE-1)) != 0
+#error "EVENT_QUEUESIZE must be a power of 2"
+#endif
+
+/**
+ * @brief   Events taken from the queue at a time
+ */
+#define EVENT_BATCH                     8
+
+/**
+ * @brief   Element of the queue
+ */
+typedef struct {
+    Event_Handler       handler;
+    uint32_t            arg;
+} Event;
+
+/**
+ * @brief   State
+ */
+///@{
+static DECLARE_MPSCQ_AREA(queuearea,Event,EVENT_QUEUESIZE);
+static MPSCQ                queue = 0;
+static Event_Statistics     stats;
+///@}
+
+/**
+ * @brief   Event_Init
+ *
+ * @note    Must be called before the interrupts that post events are enabled
+ */
+void
+Event_Init(void) {
+
+    queue = MPSCQ_Init(queuearea,sizeof(Event),EVENT_QUEUESIZE);
+    memset(&stats,0,sizeof(stats));
+}
+
+/**
+ * @brief   Event_Post
+ *
+ * @note    Never waits. Returns EVENT_ERROR_FULL when the queue is full (the
+ *          event is lost and counted in overflows)
+ */
+int
+Event_Post(Event_Handler handler, uint32_t arg) {
+Event ev;
+
+    ev.handler = handler;
+    ev.arg     = arg;
+    if( MPSCQ_Post(queue,&ev) != MPSCQ_OK )
+        return EVENT_ERROR_FULL;
+    return EVENT_OK;
+}
+
+/**
+ * @brief   Event_Pending
+ *
+ * @note    Returns 1 when an event can be dispatched
+ */
+int
+Event_Pending(void) {
+
+    return MPSCQ_Pending(queue);
+}
+
+/**
+ * @brief   Event_Dispatch
+ *
+ * @note    Runs the handlers of the events in the queue, including the ones
+ *          posted meanwhile. Returns the number of handlers run
+ */
+int
+Event_Dispatch(void) {
+Event batch[EVENT_BATCH];
+int i,k;
+int n = 0;
+
+    while( (k=MPSCQ_GetBatch(queue,batch,EVENT_BATCH)) > 0 ) {
+        for(i=0;i<k;i++)
+            batch[i].handler(batch[i].arg);
+        n += k;
+    }
+    stats.dispatched += n;
+    return n;
+}
+
+/**
+ * @brief   Event_Sleep
+ *
+ * @note    Executes WFI when no event is waiting. Returns after the next
+ *          interrupt (SysTick at the latest)
+ */
+void
+Event_Sleep(void) {
+uint32_t start;
+
+    __disable_irq();
+    if( !Event_Pending() ) {
+        start = DWT->CYCCNT;
+        __DSB();
+        __WFI();
+        stats.sleepcycles += DWT->CYCCNT-start;
+        stats.sleeps++;
+    }
+    __enable_irq();
+}
+
+/**
+ * @brief   Event_Loop
+ *
+ * @note    Never returns
+ */
+void
+Event_Loop(void) {
+
+    for(;;) {
+        Event_Dispatch();
+        Event_Sleep();
+    }
+}
+
+/**
+ * @brief   Event_GetStatistics
+ */
+void
+Event_GetStatistics(Event_Statistics *s) {
+MPSCQ_Statistics qs;
+uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    MPSCQ_GetStatistics(queue,&qs);
+    stats.posted    = qs.posted;
+    stats.overflows = qs.overflows;
+    stats.maxdepth  = qs.maxdepth;
+    *s = stats;
+    __set_PRIMASK(primask);
+}
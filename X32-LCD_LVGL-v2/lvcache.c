@@ -0,0 +1,617 @@
+/**
+ * @file    lvcache.c
+ *
+ * @note    Cache of decoded images and glyph bitmaps for LVGL in SDRAM
+ *
+ * @note    Entries are kept in a static table. Each used entry is in a hash
+ *          chain (lookup) and in a doubly linked list in order of use (head is
+ *          the most recently used). Eviction starts at the tail and skips the
+ *          entries still opened by LVGL
+ *
+ * @note    Images drawn by lvport.c (LVPORT_USEGPU) are read by DMA2D jobs that
+ *          may still be queued when LVGL closes the image. Before the memory of
+ *          an evicted image is freed, the DMA2D queue is drained
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#ifdef USE_LVGL
+
+#include <stdint.h>
+#include <string.h>
+
+#include "lvgl.h"
+#include "buddy.h"
+#include "dma2d.h"
+#include "lvcache.h"
+
+/**
+ * @brief   Addresses above it are in external memories (QSPI flash, SDRAM).
+ *          Below are internal flash (ITCM and AXIM) and RAM
+ */
+#define QSPI_ADDRESS                0x90000000
+
+/**
+ * @brief   Addresses below it are in internal flash
+ */
+#define RAM_ADDRESS                 0x20000000
+
+/**
+ * @brief   Size classes of small items
+ *
+ * @note    Chunks of 32<<i bytes, i=0..SLABCLASSES-1, taken from pages of
+ *          SLABPAGE bytes (the minimal block of the buddy allocator)
+ */
+///@{
+#define SLABPAGE                    4096
+#define SLABMIN                     32
+#define SLABCLASSES                 7
+///@}
+
+/**
+ * @brief   Number of hash chains (power of 2)
+ */
+#define HASHSIZE                    256
+
+/**
+ * @brief   Entry kinds
+ */
+///@{
+#define KIND_FREE                   0
+#define KIND_IMAGE                  1
+#define KIND_FILE                   2       ///< image from a file, path at start of data
+#define KIND_GLYPH                  3
+///@}
+
+/**
+ * @brief   Cache entry
+ *
+ * @note    Keys: images use src, frame_id and color. Files use the hash of the
+ *          path as key1 and compare the copy of the path. Glyphs use the font
+ *          wrapper and the letter
+ */
+typedef struct entry {
+    struct entry       *prev;               ///< LRU list
+    struct entry       *next;
+    struct entry       *hnext;              ///< hash chain or free list
+    uintptr_t           key1;
+    uint32_t            key2;
+    uint32_t            key3;
+    uint8_t             kind;
+    uint8_t             refs;               ///< opened by LVGL
+    uint32_t            cost;               ///< chunk or block size
+    uint8_t            *mem;                ///< allocated memory
+    uint8_t            *data;               ///< pixels or bitmap (in mem)
+    lv_img_header_t     header;
+} entry;
+
+/**
+ * @brief   Cache state
+ */
+///@{
+static entry            entries[LVCACHE_MAXENTRIES];
+static entry           *hashtable[HASHSIZE];
+static entry           *freeentries = 0;
+static entry           *lruhead = 0;
+static entry           *lrutail = 0;
+static void            *freechunks[SLABCLASSES];
+static LVCache_Stats    stats;
+static lv_img_decoder_t *decoder = 0;
+static int              busy = 0;           ///< opening with the other decoders
+///@}
+
+/**
+ * @brief   FNV-1a hash of a path
+ */
+static uint32_t
+pathhash(const char *s) {
+uint32_t h = 2166136261U;
+
+    while( *s ) {
+        h ^= (uint8_t) *s++;
+        h *= 16777619U;
+    }
+    return h;
+}
+
+static unsigned
+hashindex(uintptr_t key1, uint32_t key2) {
+
+    return (((uint32_t) key1^(key2*0x9E3779B1U))*0x9E3779B1U)>>24&(HASHSIZE-1);
+}
+
+/**
+ * @brief   Memory of the cache
+ *
+ * @note    Items up to 2048 bytes use chunks of the smallest class that fits.
+ *          The rest use a buddy block. The cost is the size really taken
+ */
+///@{
+static int
+sizeclass(unsigned size) {
+unsigned s = SLABMIN;
+int c = 0;
+
+    while( s < size ) {
+        s <<= 1;
+        c++;
+    }
+    return c < SLABCLASSES ? c : -1;
+}
+
+static void *
+memalloc(uint32_t cost) {
+uint8_t *page;
+void *p;
+int c,i;
+
+    c = sizeclass(cost);
+    if( c < 0 )
+        return Buddy_Alloc(cost);
+    if( freechunks[c] == 0 ) {
+        page = Buddy_Alloc(SLABPAGE);
+        if( page == 0 )
+            return 0;
+        for(i=SLABPAGE-cost;i>=0;i-=cost) {
+            *(void **) (page+i) = freechunks[c];
+            freechunks[c] = page+i;
+        }
+    }
+    p = freechunks[c];
+    freechunks[c] = *(void **) p;
+    return p;
+}
+
+static void
+memfree(void *p, uint32_t cost) {
+int c;
+
+    c = sizeclass(cost);
+    if( c < 0 ) {
+        Buddy_Free(p);
+        return;
+    }
+    *(void **) p = freechunks[c];
+    freechunks[c] = p;
+}
+///@}
+
+/**
+ * @brief   LRU list
+ */
+///@{
+static void
+lruunlink(entry *e) {
+
+    if( e->prev )
+        e->prev->next = e->next;
+    else
+        lruhead = e->next;
+    if( e->next )
+        e->next->prev = e->prev;
+    else
+        lrutail = e->prev;
+    e->prev = e->next = 0;
+}
+
+static void
+lrufront(entry *e) {
+
+    e->prev = 0;
+    e->next = lruhead;
+    if( lruhead )
+        lruhead->prev = e;
+    else
+        lrutail = e;
+    lruhead = e;
+}
+///@}
+
+/**
+ * @brief   Removes an entry and frees its memory
+ */
+static void
+release(entry *e) {
+entry **pp;
+
+    pp = &hashtable[hashindex(e->key1,e->key2)];
+    while( *pp != e )
+        pp = &(*pp)->hnext;
+    *pp = e->hnext;
+    lruunlink(e);
+
+    if( e->kind != KIND_GLYPH ) {
+        while( !DMA2D_IsIdle() ) {}         // a queued blend may read the pixels
+    }
+    memfree(e->mem,e->cost);
+    stats.bytes -= e->cost;
+    stats.entries--;
+
+    e->kind  = KIND_FREE;
+    e->hnext = freeentries;
+    freeentries = e;
+}
+
+/**
+ * @brief   Evicts the least recently used entry not opened by LVGL. Returns
+ *          0 when there is none
+ */
+static int
+evictone(void) {
+entry *e;
+
+    for(e=lrutail;e!=0;e=e->prev) {
+        if( e->refs == 0 ) {
+            release(e);
+            stats.evictions++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief   Creates an entry with cost bytes, evicting as needed
+ *
+ * @note    Evicts also when the buddy allocator has no memory left. The entry
+ *          is not in the hash table nor in the LRU list yet
+ */
+static entry *
+newentry(unsigned size) {
+uint32_t cost;
+entry *e;
+void *p;
+
+    cost = size > SLABMIN<<(SLABCLASSES-1) ? (uint32_t) SLABPAGE : (uint32_t) SLABMIN;
+    while( cost < size )
+        cost <<= 1;
+    if( cost > LVCACHE_SIZE )
+        return 0;
+
+    while( stats.bytes+cost > LVCACHE_SIZE || freeentries == 0 ) {
+        if( !evictone() )
+            return 0;
+    }
+    while( (p = memalloc(cost)) == 0 ) {
+        if( !evictone() )
+            return 0;
+    }
+    e = freeentries;
+    freeentries = e->hnext;
+    memset(e,0,sizeof(*e));
+    e->mem  = p;
+    e->data = p;
+    e->cost = cost;
+    return e;
+}
+
+/**
+ * @brief   Inserts a new entry at the front of the list
+ */
+static void
+insert(entry *e) {
+unsigned h;
+
+    h = hashindex(e->key1,e->key2);
+    e->hnext = hashtable[h];
+    hashtable[h] = e;
+    lrufront(e);
+    stats.bytes += e->cost;
+    stats.entries++;
+}
+
+/**
+ * @brief   Finds an entry and moves it to the front of the list
+ */
+static entry *
+lookup(int kind, uintptr_t key1, uint32_t key2, uint32_t key3, const char *path) {
+entry *e;
+
+    for(e=hashtable[hashindex(key1,key2)];e!=0;e=e->hnext) {
+        if( e->kind == kind && e->key1 == key1 && e->key2 == key2 && e->key3 == key3
+                && (path == 0 || strcmp((const char *) e->mem,path) == 0) ) {
+            lruunlink(e);
+            lrufront(e);
+            return e;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief   Image decoder
+ *
+ * @note    While the image is opened with the other decoders (busy), the
+ *          callbacks refuse all images, so they are not called recursively
+ */
+///@{
+static lv_res_t
+decoderinfo(lv_img_decoder_t *dec, const void *src, lv_img_header_t *header) {
+lv_res_t res;
+
+    (void) dec;
+    if( busy || lv_img_src_get_type(src) == LV_IMG_SRC_SYMBOL )
+        return LV_RES_INV;
+    busy = 1;
+    res = lv_img_decoder_get_info(src,header);
+    busy = 0;
+    return res;
+}
+
+/**
+ * @brief   Copies the decoded image into the entry. Returns -1 when the other
+ *          decoder gives neither pixels nor lines
+ */
+static int
+decodeinto(entry *e, lv_img_decoder_dsc_t *inner, int w, int h, int px) {
+uint8_t *p;
+int y;
+
+    p = e->data;
+    if( inner->img_data != 0 && (inner->header.cf == LV_IMG_CF_TRUE_COLOR
+                              || inner->header.cf == LV_IMG_CF_TRUE_COLOR_ALPHA
+                              || inner->header.cf == LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED) ) {
+        memcpy(p,inner->img_data,(size_t) w*h*px);
+        return 0;
+    }
+    if( inner->decoder == 0 || inner->decoder->read_line_cb == 0 )
+        return -1;
+    for(y=0;y<h;y++,p+=w*px) {
+        if( lv_img_decoder_read_line(inner,0,y,w,p) != LV_RES_OK )
+            return -1;
+    }
+    return 0;
+}
+
+static lv_res_t
+decoderopen(lv_img_decoder_t *dec, lv_img_decoder_dsc_t *dsc) {
+lv_img_decoder_dsc_t inner;
+const lv_img_dsc_t *img;
+const char *path = 0;
+lv_img_cf_t cf;
+unsigned pathsize = 0;
+uintptr_t key1;
+entry *e;
+int kind,w,h,px;
+lv_res_t res;
+
+    (void) dec;
+    if( busy )
+        return LV_RES_INV;
+
+    cf = dsc->header.cf;
+    if( dsc->src_type == LV_IMG_SRC_VARIABLE ) {
+        img = dsc->src;
+        if( (uintptr_t) img->data < QSPI_ADDRESS
+                && (cf == LV_IMG_CF_TRUE_COLOR || cf == LV_IMG_CF_TRUE_COLOR_ALPHA
+                 || cf == LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED) ) {
+            stats.passthrough++;
+            return LV_RES_INV;              // the built-in decoder uses it in place
+        }
+        kind = KIND_IMAGE;
+        key1 = (uintptr_t) dsc->src;
+    } else if( dsc->src_type == LV_IMG_SRC_FILE ) {
+        path = dsc->src;
+        pathsize = (strlen(path)+1+3)&~3U;  // keeps the pixels aligned
+        kind = KIND_FILE;
+        key1 = pathhash(path);
+    } else {
+        return LV_RES_INV;
+    }
+
+    e = lookup(kind,key1,dsc->frame_id,dsc->color.full,path);
+    if( e != 0 ) {
+        stats.hits++;
+    } else {
+        stats.misses++;
+        busy = 1;
+        res = lv_img_decoder_open(&inner,dsc->src,dsc->color,dsc->frame_id);
+        busy = 0;
+        if( res != LV_RES_OK ) {
+            stats.failures++;
+            return LV_RES_INV;
+        }
+        w  = inner.header.w;
+        h  = inner.header.h;
+        if( lv_img_cf_has_alpha(inner.header.cf) )
+            px = LV_IMG_PX_SIZE_ALPHA_BYTE;
+        else
+            px = sizeof(lv_color_t);
+        e = newentry(pathsize+(unsigned) w*h*px);
+        if( e == 0 ) {
+            lv_img_decoder_close(&inner);
+            stats.failures++;
+            return LV_RES_INV;
+        }
+        e->data += pathsize;
+        if( decodeinto(e,&inner,w,h,px) < 0 ) {
+            lv_img_decoder_close(&inner);
+            memfree(e->mem,e->cost);
+            e->hnext = freeentries;
+            freeentries = e;
+            stats.failures++;
+            return LV_RES_INV;
+        }
+        if( path )
+            strcpy((char *) e->mem,path);
+        e->kind   = kind;
+        e->key1   = key1;
+        e->key2   = dsc->frame_id;
+        e->key3   = dsc->color.full;
+        e->header = inner.header;
+        if( lv_img_cf_is_chroma_keyed(inner.header.cf) )
+            e->header.cf = LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED;
+        else if( px == LV_IMG_PX_SIZE_ALPHA_BYTE )
+            e->header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA;
+        else
+            e->header.cf = LV_IMG_CF_TRUE_COLOR;
+        lv_img_decoder_close(&inner);
+        insert(e);
+    }
+
+    e->refs++;
+    dsc->header       = e->header;
+    dsc->img_data     = e->data;
+    dsc->palette      = 0;
+    dsc->palette_size = 0;
+    dsc->user_data    = e;
+    return LV_RES_OK;
+}
+
+static void
+decoderclose(lv_img_decoder_t *dec, lv_img_decoder_dsc_t *dsc) {
+entry *e = dsc->user_data;
+
+    (void) dec;
+    if( e != 0 && e->refs > 0 )
+        e->refs--;
+    dsc->user_data = 0;
+}
+///@}
+
+/**
+ * @brief   Glyph bitmap callback of the wrapped fonts
+ *
+ * @note    The size of the bitmap comes from the glyph descriptor. Bitmaps are
+ *          packed, without padding at the end of the lines. Compressed fonts
+ *          with 3 bits/pixel are decompressed to 4 bits/pixel
+ */
+static const uint8_t *
+glyphbitmap(const lv_font_t *font, uint32_t letter) {
+const LVCache_Font *f = (const LVCache_Font *) font;
+const lv_font_t *orig = f->original;
+lv_font_glyph_dsc_t g;
+const uint8_t *bitmap;
+unsigned bpp,size;
+entry *e;
+
+    e = lookup(KIND_GLYPH,(uintptr_t) f,letter,0,0);
+    if( e != 0 ) {
+        stats.hits++;
+        return e->data;
+    }
+
+    bitmap = orig->get_glyph_bitmap(orig,letter);
+    if( bitmap == 0 || (uintptr_t) bitmap < RAM_ADDRESS ) {
+        stats.passthrough++;
+        return bitmap;
+    }
+    stats.misses++;
+    if( !orig->get_glyph_dsc(orig,&g,letter,0) ) {
+        stats.failures++;
+        return bitmap;
+    }
+    bpp  = g.bpp == 3 ? 4 : g.bpp;
+    size = ((unsigned) g.box_w*g.box_h*bpp+7)/8;
+    if( size == 0 )
+        return bitmap;
+    e = newentry(size);
+    if( e == 0 ) {
+        stats.failures++;
+        return bitmap;
+    }
+    memcpy(e->data,bitmap,size);
+    e->kind = KIND_GLYPH;
+    e->key1 = (uintptr_t) f;
+    e->key2 = letter;
+    insert(e);
+    return e->data;
+}
+
+/**
+ * @brief   LVCache_Init
+ *
+ * @note    Registers the image decoder. Must be called after lv_init and
+ *          Buddy_Init (LVPort_Init calls it)
+ *
+ * @note    Returns 0 when OK or LVCACHE_ERROR_LVGL
+ */
+int
+LVCache_Init(void) {
+int i;
+
+    memset(hashtable,0,sizeof(hashtable));
+    memset(freechunks,0,sizeof(freechunks));
+    memset(&stats,0,sizeof(stats));
+    lruhead = lrutail = 0;
+    freeentries = 0;
+    for(i=LVCACHE_MAXENTRIES-1;i>=0;i--) {
+        entries[i].kind  = KIND_FREE;
+        entries[i].hnext = freeentries;
+        freeentries = &entries[i];
+    }
+
+    // The last decoder created is the first tried by lv_img_decoder_open
+    decoder = lv_img_decoder_create();
+    if( decoder == 0 )
+        return LVCACHE_ERROR_LVGL;
+    lv_img_decoder_set_info_cb(decoder,decoderinfo);
+    lv_img_decoder_set_open_cb(decoder,decoderopen);
+    lv_img_decoder_set_close_cb(decoder,decoderclose);
+    return LVCACHE_OK;
+}
+
+/**
+ * @brief   LVCache_WrapFont
+ *
+ * @note    Fills wrapper with a copy of font whose glyph bitmaps are cached
+ *          and returns it, to be used instead of font (lv_obj_set_style_text_font).
+ *          wrapper must not be freed while in use
+ */
+const lv_font_t *
+LVCache_WrapFont(LVCache_Font *wrapper, const lv_font_t *font) {
+
+    wrapper->font = *font;
+    wrapper->original = font;
+    wrapper->font.get_glyph_bitmap = glyphbitmap;
+    return &wrapper->font;
+}
+
+/**
+ * @brief   LVCache_Invalidate
+ *
+ * @note    Removes all frames and colors of an image (lv_img_dsc_t pointer or
+ *          path), e.g. after its data changed. Images opened are kept
+ */
+void
+LVCache_Invalidate(const void *src) {
+entry *e;
+int i;
+
+    for(i=0;i<LVCACHE_MAXENTRIES;i++) {
+        e = &entries[i];
+        if( e->refs != 0 )
+            continue;
+        if( (e->kind == KIND_IMAGE && e->key1 == (uintptr_t) src)
+                || (e->kind == KIND_FILE && lv_img_src_get_type(src) == LV_IMG_SRC_FILE
+                    && strcmp((const char *) e->mem,src) == 0) )
+            release(e);
+    }
+}
+
+/**
+ * @brief   LVCache_Flush
+ *
+ * @note    Removes all entries not opened by LVGL
+ */
+void
+LVCache_Flush(void) {
+int i;
+
+    for(i=0;i<LVCACHE_MAXENTRIES;i++) {
+        if( entries[i].kind != KIND_FREE && entries[i].refs == 0 )
+            release(&entries[i]);
+    }
+}
+
+/**
+ * @brief   LVCache_GetStats
+ */
+void
+LVCache_GetStats(LVCache_Stats *st) {
+
+    *st = stats;
+}
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef LVCACHE_H
+#define LVCACHE_H
+/**
+ * @file    lvcache.h
+ *
+ * @note    Cache of decoded images and glyph bitmaps for LVGL in SDRAM
+ *
+ * @note    Images are cached by an image decoder registered in front of the
+ *          others. On a miss, it opens the image with the other decoders and
+ *          keeps the decoded pixels (true color, with alpha byte when the image
+ *          has alpha). On a hit, the image is drawn from the copy without
+ *          decoding. Raw true color images in internal flash or RAM are not
+ *          cached, since LVGL draws them in place. Images in QSPI flash
+ *          (0x90000000) are cached
+ *
+ * @note    Glyph bitmaps are cached for the fonts wrapped with LVCache_WrapFont.
+ *          Bitmaps in internal flash are used in place. Compressed fonts and
+ *          fonts in QSPI flash or loaded in RAM are the ones that profit
+ *
+ * @note    Memory comes from the buddy allocator (Buddy_Init must be called
+ *          before). Blocks have at least 4096 bytes, so small items (glyphs)
+ *          are taken from pages of 4096 bytes divided in chunks of 32 to 2048
+ *          bytes. Pages are not given back to the buddy allocator
+ *
+ * @note    When the total exceeds LVCACHE_SIZE bytes or all LVCACHE_MAXENTRIES
+ *          entries are used, the least recently used items are evicted. Images
+ *          opened by LVGL are not evicted until closed
+ *
+ * @note    LVCACHE_SIZE and LVCACHE_MAXENTRIES are set in lv_conf.h. Written for
+ *          the v8.3 style decoder and font API of LVGL v9.0.0-dev. Only compiled
+ *          when USE_LVGL is defined. Not reentrant: call from the LVGL thread
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "lvgl.h"
+
+/**
+ * @brief   Budget in bytes and number of entries
+ */
+///@{
+#ifndef LVCACHE_SIZE
+#define LVCACHE_SIZE                (4*1024*1024)
+#endif
+#ifndef LVCACHE_MAXENTRIES
+#define LVCACHE_MAXENTRIES          512
+#endif
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define LVCACHE_OK                  (0)
+#define LVCACHE_ERROR_NOMEMORY      (-1)
+#define LVCACHE_ERROR_LVGL          (-2)
+///@}
+
+/**
+ * @brief   Font wrapped by LVCache_WrapFont
+ *
+ * @note    font must be the first field: LVGL calls the callbacks with a pointer
+ *          to it
+ */
+typedef struct {
+    lv_font_t           font;
+    const lv_font_t    *original;
+} LVCache_Font;
+
+/**
+ * @brief   Counters
+ *
+ * @note    bytes is the memory charged to the cache (chunk or block size of
+ *          each item)
+ */
+typedef struct {
+    uint32_t    hits;
+    uint32_t    misses;
+    uint32_t    evictions;
+    uint32_t    passthrough;                ///< images or glyphs used in place
+    uint32_t    failures;                   ///< not decoded or no memory
+    uint32_t    entries;
+    uint32_t    bytes;
+} LVCache_Stats;
+
+int             LVCache_Init(void);
+const lv_font_t *LVCache_WrapFont(LVCache_Font *wrapper, const lv_font_t *font);
+void            LVCache_Invalidate(const void *src);
+void            LVCache_Flush(void);
+void            LVCache_GetStats(LVCache_Stats *stats);
+
+#endif // LVCACHE_H
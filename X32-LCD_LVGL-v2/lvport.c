@@ -0,0 +1,425 @@
+/**
+ * @file    lvport.c
+ *
+ * @note    LVGL display driver using the LTDC frame buffer and DMA2D
+ *
+ * @note    Written for the LVGL display API of v9.0.0-dev (lv_conf.h). The layer
+ *          must be configured and its frame buffer set before LVPort_Init
+ *
+ * @note    The flush callback only queues a DMA2D copy (DMA2D_SubmitCopy). The
+ *          completion callback runs in the DMA2D interrupt and calls
+ *          lv_disp_flush_ready, so LVGL can render into the other draw buffer
+ *          while the copy is done
+ *
+ * @note    When LVPORT_USEGPU is set, the blend step of the software renderer
+ *          is replaced. Fills, image blits and opacity blends without masks are
+ *          queued in DMA2D. Everything else goes to lv_draw_sw_blend_basic. The
+ *          CPU waits for the last queued operation before it touches the draw
+ *          buffer again (next CPU blend, wait_for_finish or buffer_copy)
+ *
+ * @note    The CPU load is the fraction of the time spent in lv_timer_handler,
+ *          measured with the DWT cycle counter. The main loop must sleep (WFI)
+ *          between calls to LVPort_Handler
+ *
+ * @note    With LVPort_Start, lv_timer_handler runs in an event handler. Its
+ *          result (ms until the next LVGL timer) sets lvtimer, a one shot
+ *          software timer, so Event_Sleep keeps the CPU in WFI until then
+ *          (waking only for the SysTick). LVPort_Wake posts an event that stops
+ *          lvtimer and runs lv_timer_handler at once. It is posted only once
+ *          until it runs, so a burst of interrupts costs one run
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#ifdef USE_LVGL
+
+#include <stdint.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "lvgl.h"
+#include "lcd.h"
+#include "dma2d.h"
+#include "cache.h"
+#include "event.h"
+#include "swtimer.h"
+#include "lvport.h"
+#include "lvcache.h"
+
+/**
+ * @brief   Draw buffers
+ *
+ * @note    They are in .bss (DTCM and SRAM1). Aligned to cache lines, because
+ *          DMA2D_SubmitCopy cleans them from the data cache
+ */
+///@{
+#define BUFPIXELS       (480*LVPORT_BUFLINES)
+static lv_color_t drawbuf1[BUFPIXELS] CACHE_ALIGNED;
+static lv_color_t drawbuf2[BUFPIXELS] CACHE_ALIGNED;
+///@}
+
+/**
+ * @brief   Driver state
+ */
+///@{
+static lv_disp_t        *display = 0;
+static int              lcdlayer = 1;
+static LVPort_Stats     stats;
+static volatile unsigned errors = 0;
+///@}
+
+/**
+ * @brief   Scheduling by the event loop (LVPort_Start)
+ */
+///@{
+static SWTimer          lvtimer;
+static int              started = 0;
+static volatile int     wakeposted = 0;
+static volatile unsigned wakeups = 0;
+///@}
+
+/**
+ * @brief   Measurement window
+ */
+///@{
+static uint32_t         windowstart = 0;
+static uint32_t         busycycles  = 0;
+static unsigned         frames      = 0;
+///@}
+
+#if LVPORT_USEGPU
+/**
+ * @brief   Last DMA2D operation queued by the renderer (0 = none)
+ */
+static DMA2D_Fence      lastfence = 0;
+
+/**
+ * @brief   gpuwait
+ *
+ * @note    Waits until the draw buffer is not being written by DMA2D
+ */
+static void
+gpuwait(void) {
+
+    if( lastfence ) {
+        DMA2D_WaitFence(lastfence);
+        lastfence = 0;
+    }
+}
+
+/**
+ * @brief   gpublend
+ *
+ * @note    Replacement for the blend step of the software renderer
+ *
+ * @note    The draw buffer and the source images are RGB565 (LV_COLOR_DEPTH=16)
+ */
+static void
+gpublend(lv_draw_ctx_t *ctx, const lv_draw_sw_blend_dsc_t *dsc) {
+lv_area_t area;
+int w,h;
+DMA2D_Fence f = 0;
+
+    if( dsc->opa <= LV_OPA_MIN )
+        return;
+    if( dsc->mask_buf && dsc->mask_res == LV_DRAW_MASK_RES_TRANSP )
+        return;
+    if( !_lv_area_intersect(&area,dsc->blend_area,ctx->clip_area) )
+        return;
+
+    w = lv_area_get_width(&area);
+    h = lv_area_get_height(&area);
+
+    if( ( dsc->mask_buf == 0 || dsc->mask_res == LV_DRAW_MASK_RES_FULL_COVER )
+     && dsc->blend_mode == LV_BLEND_MODE_NORMAL
+     && w*h >= LVPORT_GPU_MINPIXELS ) {
+        DECLARE_REGION(dst,ctx->buf,area.x1-ctx->buf_area->x1,area.y1-ctx->buf_area->y1,
+                       w,h,DMA2D_RGB565,lv_area_get_width(ctx->buf_area)*sizeof(lv_color_t));
+        if( dsc->src_buf == 0 ) {
+            if( dsc->opa >= LV_OPA_MAX )
+                f = DMA2D_SubmitFill(&dst,lv_color_to16(dsc->color),0,0);
+        } else {
+            DECLARE_REGION(src,dsc->src_buf,area.x1-dsc->blend_area->x1,
+                           area.y1-dsc->blend_area->y1,w,h,DMA2D_RGB565,
+                           lv_area_get_width(dsc->blend_area)*sizeof(lv_color_t));
+            if( dsc->opa >= LV_OPA_MAX )
+                f = DMA2D_SubmitCopy(&src,&dst,0,0);
+            else
+                f = DMA2D_SubmitBlend(&src,&dst,&dst,dsc->opa,0,0);
+        }
+    }
+    if( f ) {
+        lastfence = f;
+        stats.gpublends++;
+        return;
+    }
+
+    gpuwait();
+    lv_draw_sw_blend_basic(ctx,dsc);
+    stats.swblends++;
+}
+
+/**
+ * @brief   gpuwaitforfinish
+ */
+static void
+gpuwaitforfinish(lv_draw_ctx_t *ctx) {
+
+    gpuwait();
+    lv_draw_sw_wait_for_finish(ctx);
+}
+
+/**
+ * @brief   gpubuffercopy
+ *
+ * @note    Used by LVGL for layers. Done by the CPU after the DMA2D operations
+ */
+static void
+gpubuffercopy(lv_draw_ctx_t *ctx, void *dstbuf, lv_coord_t dststride,
+              const lv_area_t *dstarea, void *srcbuf, lv_coord_t srcstride,
+              const lv_area_t *srcarea) {
+
+    gpuwait();
+    lv_draw_sw_buffer_copy(ctx,dstbuf,dststride,dstarea,srcbuf,srcstride,srcarea);
+}
+
+/**
+ * @brief   gpuctxinit
+ *
+ * @note    Initializes a software draw context and replaces some hooks
+ */
+static void
+gpuctxinit(lv_disp_t *disp, lv_draw_ctx_t *ctx) {
+lv_draw_sw_ctx_t *swctx = (lv_draw_sw_ctx_t *) ctx;
+
+    lv_draw_sw_init_ctx(disp,ctx);
+    swctx->blend                     = gpublend;
+    swctx->base_draw.wait_for_finish = gpuwaitforfinish;
+    swctx->base_draw.buffer_copy     = gpubuffercopy;
+}
+
+/**
+ * @brief   gpuctxdeinit
+ */
+static void
+gpuctxdeinit(lv_disp_t *disp, lv_draw_ctx_t *ctx) {
+
+    gpuwait();
+    lv_draw_sw_deinit_ctx(disp,ctx);
+}
+#endif
+
+/**
+ * @brief   flushdone
+ *
+ * @note    DMA2D completion callback. Called in interrupt context
+ */
+static void
+flushdone(void *arg, int status) {
+
+    if( status )
+        errors++;
+    lv_disp_flush_ready((lv_disp_t *) arg);
+    LVPort_Wake();
+}
+
+/**
+ * @brief   flush
+ *
+ * @note    Copies the rendered area into the frame buffer. The LCD format codes
+ *          are the same as the DMA2D ones
+ */
+static void
+flush(lv_disp_t *disp, const lv_area_t *area, lv_color_t *colors) {
+int w,h;
+
+    w = area->x2-area->x1+1;
+    h = area->y2-area->y1+1;
+
+    DECLARE_REGION(src,colors,0,0,w,h,DMA2D_RGB565,w*sizeof(lv_color_t));
+    DECLARE_REGION(dst,LCD_GetFrameBufferAddress(lcdlayer),area->x1,area->y1,w,h,
+                   LCD_GetFormat(lcdlayer),LCD_GetPitch(lcdlayer));
+
+    stats.flushes++;
+    if( lv_disp_flush_is_last(disp) )
+        frames++;
+
+    if( DMA2D_SubmitCopy(&src,&dst,flushdone,disp) != 0 )
+        return;
+
+    // Queue full or invalid region: copy now and wait
+    stats.fallbacks++;
+    if( DMA2D_CopyRegion(&src,&dst) == 0 ) {
+        while( !DMA2D_IsReady() ) {}
+    }
+    lv_disp_flush_ready(disp);
+}
+
+/**
+ * @brief   LVPort_Init
+ *
+ * @note    Initializes LVGL, DMA2D, the image cache (lvcache.h) and the display
+ *          driver for a layer. The layer must have the size of the display.
+ *          Buddy_Init must be called before
+ *
+ * @note    Returns 0 when OK, -1 on error
+ */
+int
+LVPort_Init(int layer) {
+
+    if( LCD_GetWidth(layer)*LVPORT_BUFLINES > BUFPIXELS )
+        return -1;
+
+    // Enable cycle counter
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    if( DMA2D_Init() < 0 )
+        return -1;
+
+    lv_init();
+#if LVCACHE_SIZE > 0
+    if( LVCache_Init() < 0 )
+        return -1;
+#endif
+
+    lcdlayer = layer;
+    display = lv_disp_create(LCD_GetWidth(layer),LCD_GetHeight(layer));
+    if( display == 0 )
+        return -1;
+    lv_disp_set_flush_cb(display,flush);
+    lv_disp_set_draw_buffers(display,drawbuf1,drawbuf2,BUFPIXELS,
+                             LV_DISP_RENDER_MODE_PARTIAL);
+#if LVPORT_USEGPU
+    lv_disp_set_draw_ctx(display,gpuctxinit,gpuctxdeinit,sizeof(lv_draw_sw_ctx_t));
+#endif
+
+    windowstart = DWT->CYCCNT;
+    busycycles  = 0;
+    frames      = 0;
+    return 0;
+}
+
+/**
+ * @brief   LVPort_Handler
+ *
+ * @note    Runs lv_timer_handler and updates the measurements once a second.
+ *          Must be called in the main loop (or by LVPort_Start). Returns the
+ *          time in ms until it must be called again (LV_NO_TIMER_READY when no
+ *          LVGL timer is running)
+ */
+uint32_t
+LVPort_Handler(void) {
+uint32_t start,now,elapsed;
+uint32_t next;
+
+    start = DWT->CYCCNT;
+    next = lv_timer_handler();
+    now = DWT->CYCCNT;
+    busycycles += now-start;
+    stats.runs++;
+
+    elapsed = now-windowstart;
+    if( elapsed >= SystemCoreClock ) {
+        stats.fps     = (uint32_t) (((uint64_t) frames*SystemCoreClock)/elapsed);
+        stats.cpuload = (uint32_t) (((uint64_t) busycycles*100)/elapsed);
+        stats.errors  = errors;
+        stats.wakeups = wakeups;
+        windowstart = now;
+        busycycles  = 0;
+        frames      = 0;
+    }
+    return next;
+}
+
+/**
+ * @brief   run
+ *
+ * @note    Runs LVGL now and sets lvtimer for the next run. At least one tick
+ *          later, so a timer due now does not run it again in the same
+ *          SWTimer_Process
+ */
+static void
+run(void) {
+uint32_t next;
+
+    SWTimer_Stop(&lvtimer);
+    next = LVPort_Handler();
+    if( next > LVPORT_MAXSLEEP )
+        next = LVPORT_MAXSLEEP;
+    next = SWTIMER_MS(next);
+    SWTimer_Start(&lvtimer,next ? next : 1,0);
+}
+
+/**
+ * @brief   lvtimerexpired
+ *
+ * @note    lvtimer callback (event loop)
+ */
+static void
+lvtimerexpired(void *arg) {
+
+    run();
+}
+
+/**
+ * @brief   lvwakeup
+ *
+ * @note    Event posted by LVPort_Wake. The flag is cleared before the run, so
+ *          an interrupt during lv_timer_handler posts it again
+ */
+static void
+lvwakeup(uint32_t arg) {
+
+    wakeposted = 0;
+    run();
+}
+
+/**
+ * @brief   LVPort_Start
+ *
+ * @note    Runs LVGL from the event loop from now on. Event_Init must have
+ *          been called and SysTick_Handler must call SWTimer_Tick. The main
+ *          loop must then be Event_Loop (or Event_Dispatch and Event_Sleep)
+ *          instead of calling LVPort_Handler
+ */
+void
+LVPort_Start(void) {
+
+    SWTimer_Init(&lvtimer,lvtimerexpired,0);
+    started = 1;
+    SWTimer_Start(&lvtimer,0,0);
+}
+
+/**
+ * @brief   LVPort_Wake
+ *
+ * @note    Asks for a run of lv_timer_handler as soon as possible. Can be called
+ *          from interrupts (end of a flush, touch controller). Does nothing
+ *          before LVPort_Start
+ */
+void
+LVPort_Wake(void) {
+
+    if( !started || wakeposted )
+        return;
+    wakeposted = 1;
+    if( Event_Post(lvwakeup,0) == EVENT_OK )
+        wakeups++;
+    else
+        wakeposted = 0;                     // lvtimer runs it later
+}
+
+/**
+ * @brief   LVPort_GetStats
+ */
+void
+LVPort_GetStats(LVPort_Stats *s) {
+
+    *s = stats;
+}
+
+#endif // USE_LVGL
@@ -0,0 +1,84 @@
+#ifndef LVPORT_H
+#define LVPORT_H
+/**
+ * @file    lvport.h
+ *
+ * @note    LVGL display driver using the LTDC frame buffer and DMA2D
+ *
+ * @note    LVGL renders into one of two partial draw buffers (in DTCM/SRAM1) while
+ *          DMA2D copies the other one into the frame buffer, converting RGB565 to
+ *          the layer format. lv_disp_flush_ready is called by the DMA2D interrupt
+ *
+ * @note    LVPort_Start runs LVGL from the event loop (event.h): lv_timer_handler
+ *          is called by a software timer (swtimer.h) set to the time it returns,
+ *          so the CPU sleeps until the next LVGL timer is due. LVPort_Wake,
+ *          called by the DMA2D interrupt at the end of a flush or by an input
+ *          interrupt (touch), runs it at once. SysTick_Handler must call
+ *          lv_tick_inc(1) and SWTimer_Tick
+ *
+ * @note    Only compiled when USE_LVGL is defined (see Makefile)
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Number of lines in each draw buffer
+ *
+ * @note    With 480 pixels/line and RGB565, 20 lines take 19200 bytes
+ */
+#ifndef LVPORT_BUFLINES
+#define LVPORT_BUFLINES             20
+#endif
+
+/**
+ * @brief   Use of DMA2D for rendering (LVGL draw context)
+ *
+ * @note    Blends with fewer than LVPORT_GPU_MINPIXELS pixels are done by the
+ *          software renderer, since setting up the DMA2D takes longer
+ */
+///@{
+#ifndef LVPORT_USEGPU
+#define LVPORT_USEGPU               1
+#endif
+#ifndef LVPORT_GPU_MINPIXELS
+#define LVPORT_GPU_MINPIXELS        100
+#endif
+///@}
+
+/**
+ * @brief   Longest time between two calls of lv_timer_handler (ms)
+ *
+ * @note    Used when no LVGL timer is running (LV_NO_TIMER_READY)
+ */
+#ifndef LVPORT_MAXSLEEP
+#define LVPORT_MAXSLEEP             500
+#endif
+
+/**
+ * @brief   Measurements
+ *
+ * @note    fps and cpuload are calculated over the last second. The others are
+ *          counted since LVPort_Init
+ */
+typedef struct {
+    unsigned    fps;                        ///< frames completely flushed
+    unsigned    cpuload;                    ///< % of time inside lv_timer_handler
+    unsigned    flushes;                    ///< number of flush_cb calls
+    unsigned    fallbacks;                  ///< flushes not queued (DMA2D queue full)
+    unsigned    errors;                     ///< DMA2D transfer errors
+    unsigned    gpublends;                  ///< blends done by DMA2D
+    unsigned    swblends;                   ///< blends done by the CPU
+    unsigned    runs;                       ///< lv_timer_handler calls
+    unsigned    wakeups;                    ///< runs requested by LVPort_Wake
+} LVPort_Stats;
+
+int      LVPort_Init(int layer);
+uint32_t LVPort_Handler(void);
+void     LVPort_Start(void);
+void     LVPort_Wake(void);
+void     LVPort_GetStats(LVPort_Stats *stats);
+
+#endif // LVPORT_H
@@ -19,6 +19,14 @@
 #include "sdram.h"
 #include "buddy.h"
 #include "lcd.h"
+#include "cache.h"
+#ifdef USE_LVGL
+#include "lvgl.h"
+#include "lvport.h"
+#include "lvcache.h"
+#include "event.h"
+#include "swtimer.h"
+#endif
 
 
 
@@ -137,6 +145,117 @@ char *q;
 }
 
 
+#ifdef USE_LVGL
+/**
+ * @brief   Systick routine
+ *
+ * @note    It is called every 1ms and gives the time base of LVGL and of the
+ *          software timers
+ */
+void SysTick_Handler(void) {
+
+    lv_tick_inc(1);
+    SWTimer_Tick();
+}
+
+/**
+ * @brief   LVGL demo state
+ */
+///@{
+static lv_obj_t     *demolabel;
+static lv_obj_t     *demobox;
+static int          demolayer = 1;
+static int          demox = 0;
+static int          demodx = 4;
+static SWTimer      movetimer;
+static SWTimer      reporttimer;
+///@}
+
+/**
+ * @brief   movebox
+ *
+ * @note    movetimer callback (every 20 ms)
+ */
+static void movebox(void *arg) {
+
+    demox += demodx;
+    if( demox <= 0 || demox >= LCD_GetWidth(demolayer)-80 )
+        demodx = -demodx;
+    lv_obj_set_x(demobox,demox);
+}
+
+/**
+ * @brief   report
+ *
+ * @note    reporttimer callback (every second). idle is the time in WFI
+ */
+static void report(void *arg) {
+static uint32_t lastsleepcycles = 0;
+LVPort_Stats st;
+LVCache_Stats cs;
+Event_Statistics es;
+unsigned idle;
+
+    LVPort_GetStats(&st);
+    Event_GetStatistics(&es);
+    idle = (unsigned) (((uint64_t) (es.sleepcycles-lastsleepcycles)*100)/SystemCoreClock);
+    lastsleepcycles = es.sleepcycles;
+    lv_label_set_text_fmt(demolabel,"%u fps  CPU %u%%",st.fps,st.cpuload);
+    printf("fps=%u cpu=%u%% idle=%u%% runs=%u wakeups=%u flushes=%u fallbacks=%u errors=%u gpu=%u sw=%u\n",
+            st.fps,st.cpuload,idle,st.runs,st.wakeups,st.flushes,st.fallbacks,
+            st.errors,st.gpublends,st.swblends);
+#if LVCACHE_SIZE > 0
+    LVCache_GetStats(&cs);
+    printf("cache hits=%lu misses=%lu evictions=%lu inplace=%lu failures=%lu entries=%lu bytes=%lu\n",
+            (unsigned long) cs.hits,(unsigned long) cs.misses,
+            (unsigned long) cs.evictions,(unsigned long) cs.passthrough,
+            (unsigned long) cs.failures,(unsigned long) cs.entries,
+            (unsigned long) cs.bytes);
+#endif
+}
+
+/**
+ * @brief   lvgldemo
+ *
+ * @note    Moves a box over the screen and shows the FPS and CPU load
+ *          measured by the LVGL port. The label uses the default font through
+ *          the glyph cache. Returns only when LVGL can not be initialized
+ *
+ * @note    Everything runs in the event loop: the box and the report are moved
+ *          by software timers and LVGL by LVPort_Start. The CPU sleeps between
+ *          them
+ */
+static void lvgldemo(int layer) {
+static LVCache_Font labelfont;
+
+    if( LVPort_Init(layer) < 0 ) {
+        message("Cannot initialize LVGL");
+        return;
+    }
+    Event_Init();
+    SysTick_Config(SystemCoreClock/1000);
+
+    demolayer = layer;
+    demobox = lv_obj_create(lv_scr_act());
+    lv_obj_set_size(demobox,80,80);
+    lv_obj_set_pos(demobox,0,96);
+
+    demolabel = lv_label_create(lv_scr_act());
+    lv_obj_set_pos(demolabel,8,8);
+#if LVCACHE_SIZE > 0
+    lv_obj_set_style_text_font(demolabel,LVCache_WrapFont(&labelfont,LV_FONT_DEFAULT),0);
+#endif
+
+    SWTimer_Init(&movetimer,movebox,0);
+    SWTimer_Start(&movetimer,SWTIMER_MS(20),SWTIMER_MS(20));
+    SWTimer_Init(&reporttimer,report,0);
+    SWTimer_Start(&reporttimer,SWTIMER_MS(1000),SWTIMER_MS(1000));
+
+    LVPort_Start();
+    Event_Loop();
+}
+#endif
+
 /**
  * @brief   main
  *
@@ -169,6 +288,9 @@ int format = LCD_FORMAT_RGB888;
     messagewithconfirm("Press ENTER to turn OFF backlight");
     LCD_TurnBacklightOff();
 
+    message("Configuring MPU (SDRAM write through)");
+    Cache_Init();
+
     message("Initializing SDRAM");
     SDRAM_Init();
 
@@ -240,6 +362,11 @@ int format = LCD_FORMAT_RGB888;
     LCD_DisableLayer(2);
     LCD_EnableLayer(1);
 
+#ifdef USE_LVGL
+    messagewithconfirm("Press ENTER to start LVGL");
+    lvgldemo(1);
+#endif
+
     /*
      * Show some screens
      */
@@ -0,0 +1,155 @@
+/**
+ * @file    mpscq.c
+ *
+ * @note    Lock-free multi-producer single-consumer queue (see mpscq.h)
+ *
+ * @note    Each slot is a sequence number followed by the element. seq == head
+ *          when the slot is free for the producer that reserves head,
+ *          seq == tail+1 when it was written and can be taken. A producer
+ *          reserves head with LDREX/STREX. An interrupt between them clears the
+ *          exclusive monitor (exception entry), so the STREX fails and the
+ *          reservation is retried
+ *
+ * @note    A producer interrupted after the reservation and before marking the
+ *          slot as ready only delays the consumer, which stops at the first
+ *          slot not ready. The consumer runs in thread mode, so it runs only
+ *          after all interrupted producers returned
+ *
+ * @note    The overflow counter is incremented with LDREX/STREX too, because
+ *          producers of different priorities can fail at the same time
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "stm32f746xx.h"
+#include "mpscq.h"
+
+/**
+ * @brief   Slot i of the queue
+ */
+static inline volatile uint32_t *
+slot(MPSCQ q, uint32_t i) {
+
+    return &q->slots[(i&q->mask)*q->slotsize];
+}
+
+/**
+ * @brief   MPSCQ_Init
+ *
+ * @note    area must have been declared with DECLARE_MPSCQ_AREA with the same
+ *          element size and n. n must be a power of 2. Returns 0 when not.
+ *
+ * @note    Must be called before the interrupts that post to it are enabled
+ */
+MPSCQ
+MPSCQ_Init(void *area, unsigned elemsize, unsigned n) {
+MPSCQ q = (MPSCQ) area;
+uint32_t i;
+
+    if( n == 0 || (n&(n-1)) != 0 || elemsize == 0 )
+        return 0;
+
+    q->head      = 0;
+    q->tail      = 0;
+    q->mask      = n-1;
+    q->elemsize  = elemsize;
+    q->slotsize  = MPSCQ_SLOTWORDS(elemsize);
+    q->overflows = 0;
+    q->maxdepth  = 0;
+    for(i=0;i<n;i++)
+        *slot(q,i) = i;
+    return q;
+}
+
+/**
+ * @brief   MPSCQ_Post
+ *
+ * @note    Copies the element to the queue. Never waits. Returns
+ *          MPSCQ_ERROR_FULL when the queue is full (the element is lost and
+ *          counted in overflows)
+ */
+int
+MPSCQ_Post(MPSCQ q, const void *elem) {
+volatile uint32_t *s;
+uint32_t pos;
+uint32_t v;
+
+    do {
+        pos = __LDREXW((uint32_t *) &q->head);
+        s = slot(q,pos);
+        if( *s != pos ) {
+            __CLREX();
+            do {
+                v = __LDREXW((uint32_t *) &q->overflows);
+            } while( __STREXW(v+1,(uint32_t *) &q->overflows) != 0 );
+            return MPSCQ_ERROR_FULL;
+        }
+    } while( __STREXW(pos+1,(uint32_t *) &q->head) != 0 );
+
+    memcpy((void *) (s+1),elem,q->elemsize);
+    __DMB();
+    *s = pos+1;
+    return MPSCQ_OK;
+}
+
+/**
+ * @brief   MPSCQ_GetBatch
+ *
+ * @note    Copies up to n elements to elems, in the order of the reservation,
+ *          and frees their slots. Returns the number of elements copied.
+ *          Consumer only (thread mode)
+ */
+int
+MPSCQ_GetBatch(MPSCQ q, void *elems, int n) {
+volatile uint32_t *s;
+uint8_t *p = (uint8_t *) elems;
+uint32_t depth;
+int k = 0;
+
+    depth = q->head-q->tail;
+    if( depth > q->maxdepth )
+        q->maxdepth = depth;
+
+    while( k < n ) {
+        s = slot(q,q->tail);
+        if( *s != q->tail+1 )
+            break;
+        __DMB();
+        memcpy(p,(const void *) (s+1),q->elemsize);
+        __DMB();
+        *s = q->tail+q->mask+1;                 // free for the next round
+        q->tail++;
+        p += q->elemsize;
+        k++;
+    }
+    return k;
+}
+
+/**
+ * @brief   MPSCQ_Pending
+ *
+ * @note    Returns 1 when an element can be taken
+ */
+int
+MPSCQ_Pending(MPSCQ q) {
+
+    return *slot(q,q->tail) == q->tail+1;
+}
+
+/**
+ * @brief   MPSCQ_GetStatistics
+ *
+ * @note    received counts the elements taken, so posted-received is the
+ *          number of elements in the queue (or being written)
+ */
+void
+MPSCQ_GetStatistics(MPSCQ q, MPSCQ_Statistics *s) {
+
+    s->posted    = q->head;
+    s->received  = q->tail;
+    s->overflows = q->overflows;
+    s->maxdepth  = q->maxdepth;
+}
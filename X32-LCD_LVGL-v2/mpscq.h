@@ -0,0 +1,93 @@
+#ifndef MPSCQ_H
+#define MPSCQ_H
+/**
+ * @file    mpscq.h
+ *
+ * @note    Lock-free queue of fixed size elements, with many producers
+ *          (interrupt routines of any priority and the main loop) and one
+ *          consumer (the main loop)
+ *
+ * @note    FIFO_t (fifo.c) stores chars and has one producer. Here the
+ *          elements are of any type (a struct copied with memcpy) and
+ *          MPSCQ_Post does not disable the interrupts: the slot is reserved
+ *          with LDREX/STREX on the head counter and marked as ready by its
+ *          sequence number after the element is written. event.c keeps its
+ *          events in one of these queues
+ *
+ * @note    The consumer takes up to n elements in one call (MPSCQ_GetBatch),
+ *          freeing their slots before it processes them
+ *
+ * @note    The area is given by the caller, declared with DECLARE_MPSCQ_AREA:
+ *
+ *              static DECLARE_MPSCQ_AREA(rxarea,RxEvent,16);
+ *              static MPSCQ rxq;
+ *              ...
+ *              rxq = MPSCQ_Init(rxarea,sizeof(RxEvent),16);
+ *              ...
+ *              MPSCQ_Post(rxq,&ev);                    // in the interrupts
+ *              n = MPSCQ_GetBatch(rxq,evs,8);          // in the main loop
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Header of a queue. Followed by the slots in the same area
+ *
+ * @note    head and tail are free running counters. head counts reservations,
+ *          so it is the number of elements posted
+ */
+typedef struct mpscq_s {
+    volatile uint32_t   head;               ///< reserved by MPSCQ_Post
+    uint32_t            tail;               ///< taken by MPSCQ_GetBatch
+    uint32_t            mask;               ///< number of slots - 1
+    uint32_t            elemsize;
+    uint32_t            slotsize;           ///< sequence number + element
+    volatile uint32_t   overflows;          ///< MPSCQ_Post with the queue full
+    uint32_t            maxdepth;           ///< elements waiting at a get
+    uint32_t            slots[];            ///< flexible array
+} MPSCQ_t;
+
+typedef MPSCQ_t *MPSCQ;
+
+/**
+ * @brief   Size of a slot in words and declaration of an area for N
+ *          elements of type TYPE (N must be a power of 2)
+ */
+///@{
+#define MPSCQ_SLOTWORDS(SIZE)       (1+((SIZE)+sizeof(uint32_t)-1)/sizeof(uint32_t))
+#define DECLARE_MPSCQ_AREA(AREANAME,TYPE,N) uint32_t AREANAME[ \
+                        sizeof(MPSCQ_t)/sizeof(uint32_t)+(N)*MPSCQ_SLOTWORDS(sizeof(TYPE)) \
+                        ]
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define MPSCQ_OK                    (0)
+#define MPSCQ_ERROR_FULL            (-1)
+///@}
+
+/**
+ * @brief   Statistics
+ */
+typedef struct {
+    uint32_t    posted;
+    uint32_t    received;
+    uint32_t    overflows;
+    uint32_t    maxdepth;
+} MPSCQ_Statistics;
+
+MPSCQ   MPSCQ_Init(void *area, unsigned elemsize, unsigned n);
+int     MPSCQ_Post(MPSCQ q, const void *elem);
+int     MPSCQ_GetBatch(MPSCQ q, void *elems, int n);
+int     MPSCQ_Pending(MPSCQ q);
+void    MPSCQ_GetStatistics(MPSCQ q, MPSCQ_Statistics *s);
+
+#define MPSCQ_Get(Q,E)              MPSCQ_GetBatch((Q),(E),1)
+#define MPSCQ_Capacity(Q)           ((Q)->mask+1)
+
+#endif // MPSCQ_H
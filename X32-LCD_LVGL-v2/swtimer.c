@@ -0,0 +1,300 @@
+/**
+ * @file    swtimer.c
+ *
+ * @note    Software timers on a hierarchical timing wheel (see swtimer.h)
+ *
+ * @note    Each slot is a circular doubly linked list with a sentinel. wheeltime
+ *          is the next tick to process. SWTimer_Process moves it up to ticks,
+ *          cascading when the index in the first level is 0 and running the
+ *          timers of each slot. The slot is first moved to a local list, so a
+ *          callback can stop or start any timer, including the one running
+ *
+ * @note    A timer that expires at or before wheeltime (start with 0 ticks or a
+ *          late periodic restart) is linked in the slot of wheeltime. The slot
+ *          is processed again until it stays empty, so it runs in the same
+ *          SWTimer_Process
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "event.h"
+#include "swtimer.h"
+
+/**
+ * @brief   Wheel geometry
+ */
+///@{
+#define ROOTBITS            8
+#define LEVELBITS           6
+#define ROOTSIZE            (1<<ROOTBITS)
+#define LEVELSIZE           (1<<LEVELBITS)
+#define ROOTMASK            (ROOTSIZE-1)
+#define LEVELMASK           (LEVELSIZE-1)
+#define LEVELS              4
+#define LEVELSHIFT(L)       (ROOTBITS+(L)*LEVELBITS)
+///@}
+
+/**
+ * @brief   State
+ */
+///@{
+static SWTimer              root[ROOTSIZE];         // sentinels
+static SWTimer              level[LEVELS][LEVELSIZE];
+static int                  initialized = 0;
+static volatile uint32_t    ticks = 0;              // incremented by SWTimer_Tick
+static uint32_t             wheeltime = 0;          // next tick to process
+static volatile uint32_t    posted = 0;
+static uint32_t             cyclehigh = 0;
+static uint32_t             cyclelast = 0;
+///@}
+
+/**
+ * @brief   List operations
+ */
+///@{
+static void list_init(SWTimer *head) {
+
+    head->next = head->prev = head;
+}
+
+static void list_add(SWTimer *head, SWTimer *t) {
+
+    t->prev = head->prev;
+    t->next = head;
+    head->prev->next = t;
+    head->prev = t;
+}
+
+static void list_del(SWTimer *t) {
+
+    t->prev->next = t->next;
+    t->next->prev = t->prev;
+    t->next = t->prev = 0;
+}
+///@}
+
+/**
+ * @brief   Initializes the sentinels at the first use
+ */
+static void wheel_init(void) {
+int i,j;
+
+    for(i=0;i<ROOTSIZE;i++)
+        list_init(&root[i]);
+    for(i=0;i<LEVELS;i++) {
+        for(j=0;j<LEVELSIZE;j++)
+            list_init(&level[i][j]);
+    }
+    wheeltime = ticks;
+    initialized = 1;
+}
+
+/**
+ * @brief   Links a timer in the slot of its expiration time
+ */
+static void wheel_add(SWTimer *t) {
+uint32_t expires = t->expires;
+uint32_t delta = expires-wheeltime;
+int l;
+
+    if( (int32_t) delta < 0 ) {
+        list_add(&root[wheeltime&ROOTMASK],t);
+        return;
+    }
+    if( delta < ROOTSIZE ) {
+        list_add(&root[expires&ROOTMASK],t);
+        return;
+    }
+    for(l=0;l<LEVELS-1;l++) {
+        if( delta < (1UL<<LEVELSHIFT(l+1)) )
+            break;
+    }
+    list_add(&level[l][(expires>>LEVELSHIFT(l))&LEVELMASK],t);
+}
+
+/**
+ * @brief   Moves all timers of the list head to the list work
+ */
+static void list_move(SWTimer *head, SWTimer *work) {
+
+    if( head->next == head ) {
+        list_init(work);
+        return;
+    }
+    work->next = head->next;
+    work->prev = head->prev;
+    work->next->prev = work;
+    work->prev->next = work;
+    list_init(head);
+}
+
+/**
+ * @brief   Moves the timers of a slot of level l to the levels below
+ *
+ * @note    Returns the index of the slot, 0 when the next level must cascade
+ */
+static int wheel_cascade(int l) {
+int index = (wheeltime>>LEVELSHIFT(l))&LEVELMASK;
+SWTimer work;
+SWTimer *t;
+
+    list_move(&level[l][index],&work);
+    while( (t = work.next) != &work ) {
+        list_del(t);
+        wheel_add(t);
+    }
+    return index;
+}
+
+/**
+ * @brief   SWTimer_Init
+ */
+void
+SWTimer_Init(SWTimer *t, SWTimer_Callback callback, void *arg) {
+
+    t->next     = t->prev = 0;
+    t->expires  = 0;
+    t->period   = 0;
+    t->callback = callback;
+    t->arg      = arg;
+}
+
+/**
+ * @brief   SWTimer_Start
+ *
+ * @note    The callback runs after delay ticks, then every period ticks (0 for
+ *          one shot). Restarts the timer if it is running. delay and period
+ *          are limited to SWTIMER_MAXDELAY
+ */
+void
+SWTimer_Start(SWTimer *t, uint32_t delay, uint32_t period) {
+
+    if( !initialized )
+        wheel_init();
+    if( t->next )
+        list_del(t);
+    if( delay > SWTIMER_MAXDELAY )  delay  = SWTIMER_MAXDELAY;
+    if( period > SWTIMER_MAXDELAY ) period = SWTIMER_MAXDELAY;
+    t->expires = ticks+delay;
+    t->period  = period;
+    wheel_add(t);
+}
+
+/**
+ * @brief   SWTimer_Stop
+ */
+void
+SWTimer_Stop(SWTimer *t) {
+
+    if( t->next )
+        list_del(t);
+}
+
+/**
+ * @brief   SWTimer_IsRunning
+ */
+int
+SWTimer_IsRunning(const SWTimer *t) {
+
+    return t->next != 0;
+}
+
+/**
+ * @brief   SWTimer_Tick
+ *
+ * @note    Called by SysTick_Handler. Posts SWTimer_Process once until it runs
+ */
+void
+SWTimer_Tick(void) {
+
+    ticks++;
+    (void) SWTimer_GetCycles();             // do not miss a wrap of CYCCNT
+    if( !posted ) {
+        posted = 1;
+        if( Event_Post(SWTimer_Process,0) != EVENT_OK )
+            posted = 0;                     // try again at the next tick
+    }
+}
+
+/**
+ * @brief   SWTimer_Process
+ *
+ * @note    Event handler. Runs the timers expired up to the current tick
+ */
+void
+SWTimer_Process(uint32_t arg) {
+SWTimer work;
+SWTimer *head,*t;
+int index,l;
+
+    posted = 0;
+    if( !initialized )
+        return;
+
+    while( (int32_t) (ticks-wheeltime) >= 0 ) {
+        index = wheeltime&ROOTMASK;
+        if( index == 0 ) {
+            for(l=0;l<LEVELS&&wheel_cascade(l)==0;l++) {}
+        }
+
+        // Timers started for this tick by the callbacks are added to head
+        head = &root[index];
+        while( head->next != head ) {
+            list_move(head,&work);
+            while( (t = work.next) != &work ) {
+                list_del(t);
+                if( t->period ) {
+                    t->expires += t->period;
+                    wheel_add(t);
+                }
+                t->callback(t->arg);
+            }
+        }
+        wheeltime++;
+    }
+}
+
+/**
+ * @brief   SWTimer_GetTicks
+ */
+uint32_t
+SWTimer_GetTicks(void) {
+
+    return ticks;
+}
+
+/**
+ * @brief   SWTimer_GetCycles
+ *
+ * @note    DWT->CYCCNT extended to 64 bits. The cycle counter must be enabled
+ *          (Profile_Init or NetBench_Init)
+ */
+uint64_t
+SWTimer_GetCycles(void) {
+uint32_t primask;
+uint32_t c;
+uint64_t r;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    c = DWT->CYCCNT;
+    if( c < cyclelast )
+        cyclehigh++;
+    cyclelast = c;
+    r = ((uint64_t) cyclehigh<<32)|c;
+    __set_PRIMASK(primask);
+    return r;
+}
+
+/**
+ * @brief   SWTimer_GetMicroseconds
+ */
+uint64_t
+SWTimer_GetMicroseconds(void) {
+
+    return SWTimer_GetCycles()/(SystemCoreClock/1000000);
+}
@@ -153,7 +153,7 @@ int pos;
     gpio->OSPEEDR = (gpio->OSPEEDR&~(3<<pos2))| (conf->ospeed<<pos2);
     gpio->PUPDR   = (gpio->PUPDR&~(3<<pos2))  | (conf->pupd<<pos2);
     gpio->OTYPER  = (gpio->OTYPER&~(BIT(pos)))| (conf->otype<<pos);
-    gpio->ODR     = (gpio->ODR&~(BIT(pos)))   | (conf->initial<<pos);
+    gpio->BSRR    = conf->initial ? BIT(pos) : BIT(pos+16);
 
 }
 
@@ -207,7 +207,7 @@ int pos;
     gpio->OSPEEDR = (gpio->OSPEEDR&~(3<<pos2)) | (OSPEEDDEFAULT<<pos2);
     gpio->PUPDR   = (gpio->PUPDR&~(3<<pos2))   | (PUPDDEFAULT<<pos2);
     gpio->OTYPER  = (gpio->OTYPER&~(BIT(pos))) | (OTYPEDEFAULT<<pos);
-    gpio->ODR     = (gpio->ODR&~BIT(pos))      | (INITIALDEFAULT<<pos);
+    gpio->BSRR    = INITIALDEFAULT ? BIT(pos) : BIT(pos+16);
 }
 
 /**
@@ -283,7 +283,7 @@ unsigned pos2,pos4;
         gpio->OTYPER  = (gpio->OTYPER&~(1<<(pin))) | (otype<<(pin));
         gpio->OSPEEDR = (gpio->OSPEEDR&~(3<<pos2)) | (ospeed<<pos2);
         gpio->PUPDR   = (gpio->PUPDR&~(3<<pos2))   | (pupd<<pos2);
-        gpio->ODR     = (gpio->ODR&~(1<<(pin)))    | (init<<pos2);
+        gpio->BSRR    = init ? BIT(pin) : BIT(pin+16);
         break;
     case 2:         /*& Alternate function */
          if( pin < 8 ) {    // Use AFRL
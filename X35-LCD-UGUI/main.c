@@ -19,6 +19,9 @@
 #include "sdram.h"
 #include "buddy.h"
 #include "lcd.h"
+#ifdef USE_UGUI
+#include "ugport.h"
+#endif
 
 
 
@@ -137,6 +140,40 @@ char *q;
 }
 
 
+#ifdef USE_UGUI
+/**
+ * @brief   uguidemo
+ *
+ * @note    Draws the same screen with UGUI without and with the driver hooks
+ *          and prints the time of each
+ */
+static void uguidemo(int layer) {
+UGPort_Stats st;
+uint32_t tsw,thw;
+unsigned mhz = SystemCoreClock/1000000;
+
+    if( UGPort_Init(layer) < 0 ) {
+        message("Cannot initialize UGUI");
+        return;
+    }
+
+    UGPort_Accelerate(0);
+    tsw = UGPort_DrawTestFrame();
+    LCD_ReloadLayerByVerticalBlanking(layer);
+    printf("Frame without hooks: %u cycles (%u us)\n",(unsigned) tsw,(unsigned) tsw/mhz);
+
+    messagewithconfirm("Press ENTER to draw it again with the hooks");
+    UGPort_Accelerate(1);
+    thw = UGPort_DrawTestFrame();
+    LCD_ReloadLayerByVerticalBlanking(layer);
+    printf("Frame with hooks:    %u cycles (%u us)\n",(unsigned) thw,(unsigned) thw/mhz);
+
+    UGPort_GetStats(&st);
+    printf("pixels=%u cpufills=%u gpufills=%u lines=%u areas=%u\n",
+            st.pixels,st.cpufills,st.gpufills,st.lines,st.areas);
+}
+#endif
+
 /**
  * @brief   main
  *
@@ -240,6 +277,11 @@ int format = LCD_FORMAT_RGB888;
     LCD_DisableLayer(2);
     LCD_EnableLayer(1);
 
+#ifdef USE_UGUI
+    messagewithconfirm("Press ENTER to draw a screen with UGUI");
+    uguidemo(1);
+#endif
+
     /*
      * Show some screens
      */
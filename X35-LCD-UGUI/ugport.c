@@ -0,0 +1,369 @@
+/**
+ * @file    ugport.c
+ *
+ * @note    UGUI display driver using the LTDC frame buffer and DMA2D
+ *
+ * @note    Written for UGUI v0.3 (ugui.h, ugui_config.h with USE_COLOR_RGB888).
+ *          The layer must be configured and its frame buffer set before
+ *          UGPort_Init
+ *
+ * @note    Without drivers, UGUI calls the set pixel function for every pixel
+ *          of a filled frame. The hooks registered here do it a row at a time:
+ *          - fill frame: DMA2D register to memory fill for large frames,
+ *            LCD_DrawHorizontalLine for each row otherwise
+ *          - draw line: horizontal and vertical lines with LCD_DrawHorizontalLine
+ *            and LCD_DrawVerticalLine. Other lines are left to UGUI
+ *          - fill area: pixel writer that walks the area with a pointer, used by
+ *            UGUI for characters and bitmaps
+ *
+ * @note    A DMA2D fill is started and not waited for. The CPU waits only when
+ *          it writes to the frame buffer again
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#ifdef USE_UGUI
+
+#include <stdint.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "ugui.h"
+#include "lcd.h"
+#include "dma2d.h"
+#include "ugport.h"
+
+/**
+ * @brief   Driver state
+ */
+///@{
+static UG_GUI           gui;
+static int              lcdlayer = 1;
+static char             *fb      = 0;
+static int              width    = 0;
+static int              height   = 0;
+static int              pitch    = 0;
+static int              ps       = 0;
+static int              format   = 0;
+static int              gpubusy  = 0;
+static UGPort_Stats     stats;
+///@}
+
+/**
+ * @brief   Window of the fill area hook
+ */
+///@{
+static int              ax1, ax2, ay2;
+static int              ax, ay;
+static char             *ap;
+///@}
+
+/**
+ * @brief   gpuwait
+ *
+ * @note    Waits until DMA2D is not writing the frame buffer
+ */
+static void
+gpuwait(void) {
+
+    if( gpubusy ) {
+        while( !DMA2D_IsIdle() ) {}
+        gpubusy = 0;
+    }
+}
+
+/**
+ * @brief   tolayer
+ *
+ * @note    Converts an UGUI color (0x00RRGGBB) to the layer format
+ */
+static unsigned
+tolayer(UG_COLOR c) {
+
+    switch(format) {
+    case LCD_FORMAT_ARGB8888:
+        return c|0xFF000000;
+    case LCD_FORMAT_RGB565:
+        return ((c>>8)&0xF800)|((c>>5)&0x07E0)|((c>>3)&0x001F);
+    default:
+        return c;
+    }
+}
+
+/**
+ * @brief   store
+ *
+ * @note    Writes a pixel (little endian, like LCD_DrawHorizontalLine)
+ */
+static inline void
+store(char *p, unsigned c) {
+
+    switch(ps) {
+    case 4: p[3] = (c>>24)&0xFF;
+    case 3: p[2] = (c>>16)&0xFF;
+    case 2: p[1] = (c>>8)&0xFF;
+    case 1: p[0] = c&0xFF;
+    }
+}
+
+/**
+ * @brief   pset
+ *
+ * @note    Set pixel function required by UGUI
+ */
+static void
+pset(UG_S16 x, UG_S16 y, UG_COLOR c) {
+
+    if( (unsigned) x >= (unsigned) width || (unsigned) y >= (unsigned) height )
+        return;
+    gpuwait();
+    store(fb+y*pitch+x*ps,tolayer(c));
+    stats.pixels++;
+}
+
+/**
+ * @brief   order
+ *
+ * @note    Sorts the corners and clips them to the layer. Returns 0 if nothing
+ *          is visible
+ */
+static int
+order(int *x1, int *y1, int *x2, int *y2) {
+int t;
+
+    if( *x1 > *x2 ) { t = *x1; *x1 = *x2; *x2 = t; }
+    if( *y1 > *y2 ) { t = *y1; *y1 = *y2; *y2 = t; }
+    if( *x2 < 0 || *y2 < 0 || *x1 >= width || *y1 >= height )
+        return 0;
+    if( *x1 < 0 )       *x1 = 0;
+    if( *y1 < 0 )       *y1 = 0;
+    if( *x2 >= width )  *x2 = width-1;
+    if( *y2 >= height ) *y2 = height-1;
+    return 1;
+}
+
+/**
+ * @brief   hwfillframe
+ *
+ * @note    Fill frame hook. Corners are inclusive
+ */
+static UG_RESULT
+hwfillframe(UG_S16 x1, UG_S16 y1, UG_S16 x2, UG_S16 y2, UG_COLOR c) {
+int xa = x1, ya = y1, xb = x2, yb = y2;
+int w,h,y;
+unsigned lc;
+
+    if( !order(&xa,&ya,&xb,&yb) )
+        return UG_RESULT_OK;
+
+    w  = xb-xa+1;
+    h  = yb-ya+1;
+    lc = tolayer(c);
+
+    if( w*h >= UGPORT_DMA2D_MINPIXELS ) {
+        DECLARE_REGION(r,fb,xa,ya,w,h,format,pitch);
+        /* Fails for formats that DMA2D can not write (L8, AL44, AL88) */
+        if( DMA2D_FillRegion(&r,lc) == 0 ) {
+            gpubusy = 1;
+            stats.gpufills++;
+            return UG_RESULT_OK;
+        }
+    }
+
+    gpuwait();
+    for(y=ya;y<=yb;y++)
+        LCD_DrawHorizontalLine(lcdlayer,xa,y,w,lc);
+    stats.cpufills++;
+    return UG_RESULT_OK;
+}
+
+/**
+ * @brief   hwdrawline
+ *
+ * @note    Draw line hook. Only horizontal and vertical lines are handled. For
+ *          the others UGUI uses its own algorithm with pset
+ */
+static UG_RESULT
+hwdrawline(UG_S16 x1, UG_S16 y1, UG_S16 x2, UG_S16 y2, UG_COLOR c) {
+int xa = x1, ya = y1, xb = x2, yb = y2;
+
+    if( xa != xb && ya != yb )
+        return UG_RESULT_FAIL;
+
+    if( order(&xa,&ya,&xb,&yb) ) {
+        gpuwait();
+        if( ya == yb )
+            LCD_DrawHorizontalLine(lcdlayer,xa,ya,xb-xa+1,tolayer(c));
+        else
+            LCD_DrawVerticalLine(lcdlayer,xa,ya,yb-ya+1,tolayer(c));
+    }
+    stats.lines++;
+    return UG_RESULT_OK;
+}
+
+#ifdef DRIVER_FILL_AREA
+/**
+ * @brief   pushpixels
+ *
+ * @note    Writes n pixels into the window set by hwfillarea, row by row.
+ *          Pixels outside the layer are skipped
+ */
+static void
+pushpixels(UG_U16 n, UG_COLOR c) {
+unsigned lc = tolayer(c);
+
+    while( n > 0 && ay <= ay2 ) {
+        if( (unsigned) ax < (unsigned) width && (unsigned) ay < (unsigned) height )
+            store(ap,lc);
+        ap += ps;
+        ax++;
+        n--;
+        if( ax > ax2 ) {
+            ax = ax1;
+            ay++;
+            ap = fb+ay*pitch+ax1*ps;
+        }
+    }
+}
+
+/**
+ * @brief   hwfillarea
+ *
+ * @note    Fill area hook. Sets the window and returns the pixel writer
+ */
+static void *
+hwfillarea(UG_S16 x1, UG_S16 y1, UG_S16 x2, UG_S16 y2) {
+int t;
+
+    if( x1 > x2 ) { t = x1; x1 = x2; x2 = t; }
+    if( y1 > y2 ) { t = y1; y1 = y2; y2 = t; }
+
+    gpuwait();
+    ax1 = ax = x1;
+    ax2 = x2;
+    ay  = y1;
+    ay2 = y2;
+    ap  = fb+ay*pitch+ax*ps;
+    stats.areas++;
+    return (void *) pushpixels;
+}
+#endif
+
+/**
+ * @brief   UGPort_Init
+ *
+ * @note    Initializes UGUI for the layer and registers the hooks (enabled).
+ *          Returns -1 if the layer has no frame buffer
+ */
+int
+UGPort_Init(int layer) {
+
+    fb = (char *) LCD_GetFrameBufferAddress(layer);
+    if( fb == 0 )
+        return -1;
+
+    lcdlayer = layer;
+    width    = LCD_GetWidth(layer);
+    height   = LCD_GetHeight(layer);
+    pitch    = LCD_GetPitch(layer);
+    ps       = LCD_GetPixelSize(layer);
+    format   = LCD_GetFormat(layer);
+    gpubusy  = 0;
+
+    stats.pixels   = 0;
+    stats.cpufills = 0;
+    stats.gpufills = 0;
+    stats.lines    = 0;
+    stats.areas    = 0;
+
+    /* DWT cycle counter for UGPort_DrawTestFrame */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    DMA2D_Init();
+
+    UG_Init(&gui,pset,width,height);
+    UG_SelectGUI(&gui);
+
+    UG_DriverRegister(DRIVER_FILL_FRAME,(void *) hwfillframe);
+    UG_DriverRegister(DRIVER_DRAW_LINE,(void *) hwdrawline);
+#ifdef DRIVER_FILL_AREA
+    UG_DriverRegister(DRIVER_FILL_AREA,(void *) hwfillarea);
+#endif
+    UGPort_Accelerate(1);
+
+    return 0;
+}
+
+/**
+ * @brief   UGPort_Accelerate
+ *
+ * @note    Enables (on!=0) or disables the hooks. When disabled, UGUI draws
+ *          everything with pset
+ */
+void
+UGPort_Accelerate(int on) {
+
+    gpuwait();
+    if( on ) {
+        UG_DriverEnable(DRIVER_FILL_FRAME);
+        UG_DriverEnable(DRIVER_DRAW_LINE);
+#ifdef DRIVER_FILL_AREA
+        UG_DriverEnable(DRIVER_FILL_AREA);
+#endif
+    } else {
+        UG_DriverDisable(DRIVER_FILL_FRAME);
+        UG_DriverDisable(DRIVER_DRAW_LINE);
+#ifdef DRIVER_FILL_AREA
+        UG_DriverDisable(DRIVER_FILL_AREA);
+#endif
+    }
+}
+
+/**
+ * @brief   UGPort_DrawTestFrame
+ *
+ * @note    Draws a screen with frames, lines and text and returns the number of
+ *          core clock cycles used (including the wait for DMA2D)
+ */
+uint32_t
+UGPort_DrawTestFrame(void) {
+static const UG_COLOR colors[] = {
+    C_RED, C_GREEN, C_BLUE, C_YELLOW, C_CYAN, C_MAGENTA, C_WHITE, C_GRAY
+};
+uint32_t t0;
+int i;
+
+    t0 = DWT->CYCCNT;
+
+    UG_FillScreen(C_BLACK);
+    for(i=0;i<8;i++)
+        UG_FillFrame(8+i*58,8,56+i*58,56,colors[i]);
+    UG_DrawFrame(4,4,width-5,height-5,C_WHITE);
+    for(i=64;i<height-8;i+=8)
+        UG_DrawLine(8,i,width/2-8,i,C_GRAY);
+    for(i=0;i<8;i++)
+        UG_DrawLine(width/2,64,width-8-i*24,height-8,colors[i]);
+
+    UG_FontSelect(&FONT_8X12);
+    UG_SetForecolor(C_WHITE);
+    UG_SetBackcolor(C_BLACK);
+    UG_PutString(8,height-28,"UGUI on STM32F746");
+
+    gpuwait();
+
+    return DWT->CYCCNT-t0;
+}
+
+/**
+ * @brief   UGPort_GetStats
+ */
+void
+UGPort_GetStats(UGPort_Stats *st) {
+
+    *st = stats;
+}
+
+#endif // USE_UGUI
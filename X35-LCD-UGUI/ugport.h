@@ -0,0 +1,45 @@
+#ifndef UGPORT_H
+#define UGPORT_H
+/**
+ * @file    ugport.h
+ *
+ * @note    UGUI display driver using the LTDC frame buffer and DMA2D
+ *
+ * @note    UGUI draws everything with a set pixel function. The fill frame,
+ *          draw line and fill area hooks of UGUI are registered, so rectangles
+ *          and lines are drawn with whole rows (LCD_DrawHorizontalLine or DMA2D)
+ *
+ * @note    Only compiled when USE_UGUI is defined (see Makefile)
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Fills with fewer pixels are done by the CPU
+ *
+ * @note    The setup of the DMA2D takes longer than writing a few lines
+ */
+#ifndef UGPORT_DMA2D_MINPIXELS
+#define UGPORT_DMA2D_MINPIXELS      256
+#endif
+
+/**
+ * @brief   Counters since UGPort_Init
+ */
+typedef struct {
+    unsigned    pixels;                     ///< calls to the set pixel function
+    unsigned    cpufills;                   ///< frames filled by the CPU
+    unsigned    gpufills;                   ///< frames filled by DMA2D
+    unsigned    lines;                      ///< lines drawn by the hook
+    unsigned    areas;                      ///< areas written by the fill area hook
+} UGPort_Stats;
+
+int      UGPort_Init(int layer);
+void     UGPort_Accelerate(int on);
+uint32_t UGPort_DrawTestFrame(void);
+void     UGPort_GetStats(UGPort_Stats *stats);
+
+#endif // UGPORT_H
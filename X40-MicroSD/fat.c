@@ -0,0 +1,896 @@
+/**
+ * @file    fat.c
+ *
+ * @note    FAT32 file system for logging (see fat.h)
+ *
+ * @note    Layout of a FAT32 volume (sectors)
+ *
+ *          | Region                  | Start                    | Size                |
+ *          |-------------------------|--------------------------|---------------------|
+ *          | Reserved (boot, FSInfo) | start                    | reserved            |
+ *          | FATs                    | start+reserved           | numfats*fatsize     |
+ *          | Data                    | fatstart+numfats*fatsize | clusters*secperclus |
+ *
+ *          Cluster 2 is the first of the data region. Each FAT entry has 28
+ *          bits: 0 free, 0x0FFFFFF8 or more end of chain, otherwise the next
+ *          cluster
+ *
+ * @note    The volume is the first partition of the MBR (types 0x0B and 0x0C)
+ *          or, when there is no partition table, the whole card
+ *
+ * @note    The free cluster count of FSInfo is set to unknown at the first
+ *          change of the FAT, as allowed by the specification
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <string.h>
+#include "sdram.h"
+#include "sdcard.h"
+#include "fat.h"
+
+#define SECTORSIZE                      512
+#define DIRENTRYSIZE                    32
+
+/**
+ * @brief   FAT entries
+ */
+///@{
+#define FAT_FREE                        0
+#define FAT_EOC                         0x0FFFFFFFU
+#define FAT_ISEOC(C)                    ((C) >= 0x0FFFFFF8U)
+#define FAT_MASK                        0x0FFFFFFFU
+///@}
+
+/**
+ * @brief   Directory entry fields
+ */
+///@{
+#define DIR_NAME                        0
+#define DIR_ATTR                        11
+#define DIR_FSTCLUSHI                   20
+#define DIR_WRTTIME                     22
+#define DIR_FSTCLUSLO                   26
+#define DIR_FILESIZE                    28
+#define ATTR_LONGNAME                   0x0F
+#define ATTR_DIRECTORY                  0x10
+#define ATTR_VOLUMEID                   0x08
+#define ENTRY_FREE                      0xE5
+#define ENTRY_END                       0x00
+///@}
+
+/**
+ * @brief   Volume information
+ */
+static struct {
+    int         mounted;
+    uint32_t    start;                  // first sector of the volume
+    uint32_t    fatstart;
+    uint32_t    fatsize;                // sectors of one FAT
+    uint32_t    numfats;
+    uint32_t    datastart;
+    uint32_t    secperclus;
+    uint32_t    clustersize;            // bytes
+    uint32_t    clusters;               // data clusters (2..clusters+1)
+    uint32_t    rootcluster;
+    uint32_t    fsinfo;                 // sector or 0
+    int         fsinfovalid;            // free count not invalidated yet
+    uint32_t    nextfree;               // hint for allocation
+} fs;
+
+/**
+ * @brief   Sector cache (write back, LRU)
+ */
+///@{
+typedef struct {
+    uint32_t    sector;
+    uint32_t    lastuse;
+    uint8_t     valid;
+    uint8_t     dirty;
+} CacheEntry;
+
+static CacheEntry   cache[FAT_CACHESECTORS];
+static uint32_t     cacheclock = 0;
+#define CACHEDATA(I)    ((uint8_t *) (FAT_MEMORY)+(I)*SECTORSIZE)
+///@}
+
+/**
+ * @brief   Write buffers
+ */
+///@{
+static uint8_t      bufferused[FAT_MAXFILES];
+#define BUFFERDATA(I)   ((uint8_t *) (FAT_MEMORY)+FAT_CACHESECTORS*SECTORSIZE\
+                                     +(I)*FAT_BUFFERSIZE)
+///@}
+
+/**
+ * @brief   Little endian fields
+ */
+///@{
+static uint32_t ld16( const uint8_t *p ) {
+
+    return p[0]|(p[1]<<8);
+}
+
+static uint32_t ld32( const uint8_t *p ) {
+
+    return p[0]|(p[1]<<8)|(p[2]<<16)|((uint32_t) p[3]<<24);
+}
+
+static void st16( uint8_t *p, uint32_t v ) {
+
+    p[0] = v;
+    p[1] = v>>8;
+}
+
+static void st32( uint8_t *p, uint32_t v ) {
+
+    p[0] = v;
+    p[1] = v>>8;
+    p[2] = v>>16;
+    p[3] = v>>24;
+}
+///@}
+
+/**
+ * @brief  Write a cached sector and its copies in the other FATs
+ */
+static int WriteBack( int i ) {
+uint32_t s = cache[i].sector;
+uint32_t k;
+
+    if( SD_WriteBlocks(s,CACHEDATA(i),1) < 0 )
+        return FAT_ERROR_IO;
+    if( s >= fs.fatstart && s < fs.fatstart+fs.fatsize ) {
+        for(k=1;k<fs.numfats;k++) {
+            if( SD_WriteBlocks(s+k*fs.fatsize,CACHEDATA(i),1) < 0 )
+                return FAT_ERROR_IO;
+        }
+    }
+    cache[i].dirty = 0;
+    return FAT_OK;
+}
+
+/**
+ * @brief  Get a sector thru the cache
+ *
+ * @note   Returns a pointer to the data or 0. When write is set, the sector
+ *         is marked dirty
+ */
+static uint8_t *CacheGet( uint32_t sector, int write ) {
+int i, victim = 0;
+
+    for(i=0;i<FAT_CACHESECTORS;i++) {
+        if( cache[i].valid && cache[i].sector == sector )
+            break;
+        if( cache[i].lastuse < cache[victim].lastuse )
+            victim = i;                     // invalid entries have lastuse 0
+    }
+    if( i < FAT_CACHESECTORS ) {
+        victim = i;
+    } else {
+        if( cache[victim].valid && cache[victim].dirty && WriteBack(victim) < 0 )
+            return 0;
+        cache[victim].valid   = 0;
+        cache[victim].lastuse = 0;
+        if( SD_ReadBlocks(sector,CACHEDATA(victim),1) < 0 )
+            return 0;
+        cache[victim].sector = sector;
+        cache[victim].valid  = 1;
+        cache[victim].dirty  = 0;
+    }
+    cache[victim].lastuse = ++cacheclock;
+    if( write )
+        cache[victim].dirty = 1;
+    return CACHEDATA(victim);
+}
+
+/**
+ * @brief  Write all dirty sectors, in sector order
+ */
+static int CacheFlush( void ) {
+int i, next;
+
+    for(;;) {
+        next = -1;
+        for(i=0;i<FAT_CACHESECTORS;i++) {
+            if( cache[i].valid && cache[i].dirty
+             && (next < 0 || cache[i].sector < cache[next].sector) )
+                next = i;
+        }
+        if( next < 0 )
+            return FAT_OK;
+        if( WriteBack(next) < 0 )
+            return FAT_ERROR_IO;
+    }
+}
+
+/**
+ * @brief  Drop cached copies of sectors written directly
+ */
+static void CacheInvalidate( uint32_t sector, uint32_t n ) {
+int i;
+
+    for(i=0;i<FAT_CACHESECTORS;i++) {
+        if( cache[i].valid && cache[i].sector-sector < n ) {
+            cache[i].valid   = 0;
+            cache[i].lastuse = 0;
+        }
+    }
+}
+
+static uint32_t ClusterSector( uint32_t c ) {
+
+    return fs.datastart+(c-2)*fs.secperclus;
+}
+
+/**
+ * @brief  FAT entry of cluster c (FAT_EOC on errors)
+ */
+static uint32_t GetEntry( uint32_t c ) {
+uint8_t *p;
+
+    if( c < 2 || c >= fs.clusters+2 )
+        return FAT_EOC;
+    p = CacheGet(fs.fatstart+c/(SECTORSIZE/4),0);
+    if( !p )
+        return FAT_EOC;
+    return ld32(p+(c%(SECTORSIZE/4))*4)&FAT_MASK;
+}
+
+/**
+ * @brief  Set the FAT entry of cluster c (the upper 4 bits are kept)
+ */
+static int SetEntry( uint32_t c, uint32_t v ) {
+uint8_t *p;
+
+    if( c < 2 || c >= fs.clusters+2 )
+        return FAT_ERROR_CORRUPT;
+    if( fs.fsinfovalid && fs.fsinfo ) {
+        p = CacheGet(fs.start+fs.fsinfo,1);
+        if( !p )
+            return FAT_ERROR_IO;
+        st32(p+488,0xFFFFFFFFU);        // free count unknown
+        st32(p+492,0xFFFFFFFFU);        // no hint
+        fs.fsinfovalid = 0;
+    }
+    p = CacheGet(fs.fatstart+c/(SECTORSIZE/4),1);
+    if( !p )
+        return FAT_ERROR_IO;
+    p += (c%(SECTORSIZE/4))*4;
+    st32(p,(ld32(p)&~FAT_MASK)|(v&FAT_MASK));
+    return FAT_OK;
+}
+
+/**
+ * @brief  Append a free cluster to the chain of f
+ *
+ * @note   The search starts after the last allocated cluster, so the clusters
+ *         of a file are contiguous while the card has free space after them
+ */
+static int AllocateCluster( FAT_File *f, uint32_t *cluster ) {
+uint32_t c, k;
+int rc;
+
+    c = f->lastcluster ? f->lastcluster+1 : fs.nextfree;
+    for(k=0;k<fs.clusters;k++,c++) {
+        if( c < 2 || c >= fs.clusters+2 )
+            c = 2;
+        if( GetEntry(c) == FAT_FREE )
+            break;
+    }
+    if( k == fs.clusters )
+        return FAT_ERROR_FULL;
+
+    rc = SetEntry(c,FAT_EOC);
+    if( rc < 0 )
+        return rc;
+    if( f->lastcluster ) {
+        rc = SetEntry(f->lastcluster,c);
+        if( rc < 0 )
+            return rc;
+    } else {
+        f->firstcluster = c;
+        f->changed = 1;
+    }
+    f->lastcluster = c;
+    f->nclusters++;
+    fs.nextfree = c+1;
+    *cluster = c;
+    return FAT_OK;
+}
+
+/**
+ * @brief  Free a chain starting at cluster c
+ */
+static int FreeChain( uint32_t c ) {
+uint32_t next;
+int rc;
+
+    while( c >= 2 && !FAT_ISEOC(c) ) {
+        next = GetEntry(c);
+        rc = SetEntry(c,FAT_FREE);
+        if( rc < 0 )
+            return rc;
+        if( next == FAT_FREE )
+            return FAT_ERROR_CORRUPT;
+        c = next;
+    }
+    return FAT_OK;
+}
+
+/**
+ * @brief  Next cluster of the chain, allocating one at the end when alloc
+ *         is set. Returns 0 at the end of the chain
+ */
+static uint32_t NextCluster( FAT_File *f, uint32_t c, int alloc ) {
+uint32_t n;
+
+    n = GetEntry(c);
+    if( !FAT_ISEOC(n) && n >= 2 )
+        return n;
+    if( !alloc || AllocateCluster(f,&n) < 0 )
+        return 0;
+    return n;
+}
+
+/**
+ * @brief  Convert a name to the 11 characters of a directory entry
+ */
+static int MakeName( const char *name, uint8_t *n83 ) {
+int i = 0, end = 8;
+char c;
+
+    memset(n83,' ',11);
+    while( (c=*name++) != 0 ) {
+        if( c == '.' && end == 8 && i > 0 ) {
+            i = end;
+            end = 11;
+            continue;
+        }
+        if( c >= 'a' && c <= 'z' )
+            c -= 'a'-'A';
+        if( c <= ' ' || strchr("\"*+,./:;<=>?[\\]|",c) || i >= end )
+            return FAT_ERROR_PARAMETER;
+        n83[i++] = c;
+    }
+    return i == 0 ? FAT_ERROR_PARAMETER : FAT_OK;
+}
+
+/**
+ * @brief  Find the entry with name in the root directory
+ *
+ * @note   When not found, the first free entry is returned with found=0.
+ *         *sector is 0 when there is no free entry either
+ */
+static int FindEntry( const uint8_t *n83, uint32_t *sector, uint16_t *offset, int *found ) {
+uint32_t c = fs.rootcluster, s, o;
+uint8_t *p;
+FAT_File dir;
+
+    memset(&dir,0,sizeof(dir));
+    *sector = 0;
+    *found  = 0;
+    while( c ) {
+        for(s=0;s<fs.secperclus;s++) {
+            p = CacheGet(ClusterSector(c)+s,0);
+            if( !p )
+                return FAT_ERROR_IO;
+            for(o=0;o<SECTORSIZE;o+=DIRENTRYSIZE) {
+                if( p[o] == ENTRY_END || p[o] == ENTRY_FREE ) {
+                    if( *sector == 0 ) {
+                        *sector = ClusterSector(c)+s;
+                        *offset = o;
+                    }
+                    if( p[o] == ENTRY_END )
+                        return FAT_OK;
+                    continue;
+                }
+                if( (p[o+DIR_ATTR]&ATTR_LONGNAME) == ATTR_LONGNAME
+                 || (p[o+DIR_ATTR]&(ATTR_VOLUMEID|ATTR_DIRECTORY)) )
+                    continue;
+                if( memcmp(p+o,n83,11) == 0 ) {
+                    *sector = ClusterSector(c)+s;
+                    *offset = o;
+                    *found = 1;
+                    return FAT_OK;
+                }
+            }
+        }
+        c = NextCluster(&dir,c,0);
+    }
+    return FAT_OK;
+}
+
+/**
+ * @brief  Write the size and first cluster of f in its directory entry
+ */
+static int UpdateEntry( FAT_File *f ) {
+uint8_t *p;
+
+    if( !f->changed )
+        return FAT_OK;
+    p = CacheGet(f->dirsector,1);
+    if( !p )
+        return FAT_ERROR_IO;
+    p += f->diroffset;
+    st16(p+DIR_FSTCLUSHI,f->firstcluster>>16);
+    st16(p+DIR_FSTCLUSLO,f->firstcluster);
+    st32(p+DIR_WRTTIME,FAT_TIMESTAMP);
+    st32(p+DIR_FILESIZE,f->size);
+    f->changed = 0;
+    return FAT_OK;
+}
+
+/**
+ * @brief  Write n sectors of a buffer directly to the card
+ */
+static int WriteRun( uint32_t lba, const uint8_t *data, uint32_t n ) {
+
+    CacheInvalidate(lba,n);
+    return SD_WriteBlocks(lba,data,n) < 0 ? FAT_ERROR_IO : FAT_OK;
+}
+
+/**
+ * @brief  Write the sectors of the buffer that are not on the card yet
+ *
+ * @note   The last sector of the buffer is written again after a partial
+ *         flush. Contiguous clusters are written by one request. When the
+ *         buffer is full, it moves to the next cluster
+ */
+static int FlushBuffer( FAT_File *f ) {
+uint32_t s0, s1, s, n, ci, c, lba;
+uint32_t runlba = 0, runlen = 0, runbuf = 0;
+
+    s0 = f->bufsaved/SECTORSIZE;
+    s1 = (f->buflen+SECTORSIZE-1)/SECTORSIZE;
+    if( s0 >= s1 )
+        return FAT_OK;
+
+    c = f->bufcluster;
+    if( c == 0 ) {
+        if( f->lastcluster )
+            c = NextCluster(f,f->lastcluster,1);
+        else if( AllocateCluster(f,&c) < 0 )
+            c = 0;
+        if( c == 0 )
+            return FAT_ERROR_FULL;
+        f->bufcluster = c;
+    }
+    for(ci=0;ci<s0/fs.secperclus;ci++) {
+        c = NextCluster(f,c,1);
+        if( c == 0 )
+            return FAT_ERROR_FULL;
+    }
+
+    for(s=s0;s<s1;s+=n) {
+        if( s/fs.secperclus != ci ) {
+            ci++;
+            c = NextCluster(f,c,1);
+            if( c == 0 )
+                return FAT_ERROR_FULL;
+        }
+        lba = ClusterSector(c)+s%fs.secperclus;
+        n = (ci+1)*fs.secperclus;
+        n = (n < s1 ? n : s1)-s;
+        if( runlen && runlba+runlen == lba ) {
+            runlen += n;
+            continue;
+        }
+        if( runlen && WriteRun(runlba,f->buffer+runbuf,runlen) < 0 )
+            return FAT_ERROR_IO;
+        runlba = lba;
+        runbuf = s*SECTORSIZE;
+        runlen = n;
+    }
+    if( WriteRun(runlba,f->buffer+runbuf,runlen) < 0 )
+        return FAT_ERROR_IO;
+    f->bufsaved = f->buflen;
+
+    if( f->buflen == FAT_BUFFERSIZE ) {
+        f->bufpos   += FAT_BUFFERSIZE;
+        f->buflen    = 0;
+        f->bufsaved  = 0;
+        f->bufcluster = NextCluster(f,c,0);
+    }
+    return FAT_OK;
+}
+
+/**
+ * @brief  Walk the chain of f, setting lastcluster and nclusters
+ */
+static int WalkChain( FAT_File *f ) {
+uint32_t c = f->firstcluster, n;
+
+    f->lastcluster = 0;
+    f->nclusters = 0;
+    while( c ) {
+        f->lastcluster = c;
+        if( ++f->nclusters > fs.clusters )
+            return FAT_ERROR_CORRUPT;
+        n = GetEntry(c);
+        if( n == FAT_FREE || (n < 2) )
+            return FAT_ERROR_CORRUPT;
+        c = FAT_ISEOC(n) ? 0 : n;
+    }
+    return FAT_OK;
+}
+
+/**
+ * @brief  Cluster number i of the chain of f (0 when the chain is shorter)
+ */
+static uint32_t ClusterOfChain( FAT_File *f, uint32_t i ) {
+uint32_t c = f->firstcluster;
+
+    while( c && i-- )
+        c = NextCluster(f,c,0);
+    return c;
+}
+
+/**
+ * @brief  FAT_Mount
+ *
+ * @note   Reads the MBR and the boot sector of the volume
+ */
+int
+FAT_Mount( void ) {
+uint8_t *p;
+uint32_t totsec, reserved;
+int i;
+
+    fs.mounted = 0;
+    for(i=0;i<FAT_CACHESECTORS;i++) {
+        cache[i].valid   = 0;
+        cache[i].lastuse = 0;
+    }
+    for(i=0;i<FAT_MAXFILES;i++)
+        bufferused[i] = 0;
+
+    fs.start = 0;
+    p = CacheGet(0,0);
+    if( !p )
+        return FAT_ERROR_IO;
+    if( p[510] != 0x55 || p[511] != 0xAA )
+        return FAT_ERROR_NOFS;
+    if( memcmp(p+82,"FAT32",5) != 0 ) {
+        // MBR: first partition
+        if( p[446+4] != 0x0B && p[446+4] != 0x0C )
+            return (p[446+4] == 0x07) ? FAT_ERROR_UNSUPPORTED : FAT_ERROR_NOFS;
+        fs.start = ld32(p+446+8);
+        p = CacheGet(fs.start,0);
+        if( !p )
+            return FAT_ERROR_IO;
+        if( p[510] != 0x55 || p[511] != 0xAA )
+            return FAT_ERROR_NOFS;
+    }
+
+    if( ld16(p+11) != SECTORSIZE || ld16(p+17) != 0 || ld16(p+22) != 0 )
+        return FAT_ERROR_UNSUPPORTED;       // not FAT32 with 512 byte sectors
+    fs.secperclus  = p[13];
+    reserved       = ld16(p+14);
+    fs.numfats     = p[16];
+    totsec         = ld16(p+19) ? ld16(p+19) : ld32(p+32);
+    fs.fatsize     = ld32(p+36);
+    fs.rootcluster = ld32(p+44);
+    fs.fsinfo      = ld16(p+48);
+    if( fs.secperclus == 0 || (fs.secperclus&(fs.secperclus-1)) || fs.numfats == 0
+     || fs.fatsize == 0 )
+        return FAT_ERROR_NOFS;
+    fs.clustersize = fs.secperclus*SECTORSIZE;
+    if( FAT_BUFFERSIZE%fs.clustersize )
+        return FAT_ERROR_UNSUPPORTED;
+
+    fs.fatstart  = fs.start+reserved;
+    fs.datastart = fs.fatstart+fs.numfats*fs.fatsize;
+    fs.clusters  = (totsec-reserved-fs.numfats*fs.fatsize)/fs.secperclus;
+    if( fs.clusters < 65525 || fs.clusters+2 > fs.fatsize*(SECTORSIZE/4) )
+        return FAT_ERROR_UNSUPPORTED;       // FAT16 volume or inconsistent
+    if( fs.fsinfo == 0 || fs.fsinfo >= reserved )
+        fs.fsinfo = 0;
+    if( fs.fsinfo ) {
+        p = CacheGet(fs.start+fs.fsinfo,0);
+        if( !p )
+            return FAT_ERROR_IO;
+        if( ld32(p) != 0x41615252U || ld32(p+484) != 0x61417272U )
+            fs.fsinfo = 0;
+    }
+    fs.fsinfovalid = 1;
+    fs.nextfree = 2;
+    fs.mounted = 1;
+    return FAT_OK;
+}
+
+/**
+ * @brief  FAT_Unmount
+ *
+ * @note   Writes the cache. The files must be closed before
+ */
+int
+FAT_Unmount( void ) {
+int rc;
+
+    if( !fs.mounted )
+        return FAT_ERROR_NOTMOUNTED;
+    rc = CacheFlush();
+    fs.mounted = 0;
+    return rc;
+}
+
+/**
+ * @brief  FAT_GetFreeClusters
+ *
+ * @note   Counts the free entries of the FAT. It reads the whole FAT
+ */
+int
+FAT_GetFreeClusters( uint32_t *count, uint32_t *clustersize ) {
+uint32_t c, n = 0;
+
+    if( !fs.mounted )
+        return FAT_ERROR_NOTMOUNTED;
+    for(c=2;c<fs.clusters+2;c++) {
+        if( GetEntry(c) == FAT_FREE )
+            n++;
+    }
+    *count = n;
+    *clustersize = fs.clustersize;
+    return FAT_OK;
+}
+
+/**
+ * @brief  FAT_Open
+ *
+ * @note   With FAT_WRITE, the last partial cluster is read into the buffer and
+ *         the data is appended after it
+ */
+int
+FAT_Open( FAT_File *f, const char *name, unsigned flags ) {
+uint8_t n83[11];
+uint8_t *p;
+int rc, found, i;
+
+    if( !fs.mounted )
+        return FAT_ERROR_NOTMOUNTED;
+    if( (flags&(FAT_READ|FAT_WRITE)) == 0
+     || ((flags&(FAT_CREATE|FAT_TRUNCATE)) && !(flags&FAT_WRITE)) )
+        return FAT_ERROR_PARAMETER;
+    rc = MakeName(name,n83);
+    if( rc < 0 )
+        return rc;
+
+    memset(f,0,sizeof(*f));
+    rc = FindEntry(n83,&f->dirsector,&f->diroffset,&found);
+    if( rc < 0 )
+        return rc;
+    if( !found ) {
+        if( !(flags&FAT_CREATE) )
+            return FAT_ERROR_NOTFOUND;
+        if( f->dirsector == 0 )
+            return FAT_ERROR_FULL;
+        p = CacheGet(f->dirsector,1);
+        if( !p )
+            return FAT_ERROR_IO;
+        p += f->diroffset;
+        memset(p,0,DIRENTRYSIZE);
+        memcpy(p+DIR_NAME,n83,11);
+        st32(p+DIR_WRTTIME,FAT_TIMESTAMP);
+        st32(p+14,FAT_TIMESTAMP);           // creation time and date
+        st16(p+18,FAT_TIMESTAMP>>16);       // access date
+    } else {
+        p = CacheGet(f->dirsector,0);
+        if( !p )
+            return FAT_ERROR_IO;
+        p += f->diroffset;
+        f->firstcluster = (ld16(p+DIR_FSTCLUSHI)<<16)|ld16(p+DIR_FSTCLUSLO);
+        f->size = ld32(p+DIR_FILESIZE);
+    }
+    f->flags = flags;
+
+    rc = WalkChain(f);
+    if( rc < 0 )
+        return rc;
+    if( (uint64_t) f->nclusters*fs.clustersize < f->size )
+        return FAT_ERROR_CORRUPT;
+    if( (flags&FAT_TRUNCATE) && f->firstcluster ) {
+        rc = FreeChain(f->firstcluster);
+        if( rc < 0 )
+            return rc;
+        f->firstcluster = f->lastcluster = 0;
+        f->nclusters = 0;
+        f->size = 0;
+        f->changed = 1;
+    }
+    f->cluster = f->firstcluster;
+
+    if( flags&FAT_WRITE ) {
+        for(i=0;i<FAT_MAXFILES&&bufferused[i];i++) {}
+        if( i == FAT_MAXFILES )
+            return FAT_ERROR_TOOMANYFILES;
+        f->buffer = BUFFERDATA(i);
+        f->bufpos = f->size-f->size%fs.clustersize;
+        f->buflen = f->bufsaved = f->size-f->bufpos;
+        f->bufcluster = ClusterOfChain(f,f->bufpos/fs.clustersize);
+        if( f->buflen ) {
+            rc = SD_ReadBlocks(ClusterSector(f->bufcluster),f->buffer,
+                               (f->buflen+SECTORSIZE-1)/SECTORSIZE);
+            if( rc < 0 )
+                return FAT_ERROR_IO;
+        }
+        bufferused[i] = 1;
+    }
+    return FAT_OK;
+}
+
+/**
+ * @brief  FAT_Read
+ *
+ * @note   Returns the number of bytes read (0 at the end of the file)
+ *
+ * @note   Whole sectors are read directly into data when it is 32 byte
+ *         aligned. Otherwise they go thru the cache
+ */
+int
+FAT_Read( FAT_File *f, void *data, uint32_t n ) {
+uint8_t *d = data, *p;
+uint32_t off, sec, k, ns, done = 0;
+
+    if( !(f->flags&FAT_READ) || (f->flags&FAT_WRITE) )
+        return FAT_ERROR_PARAMETER;
+    if( n > f->size-f->pos )
+        n = f->size-f->pos;
+    while( done < n ) {
+        off = f->pos%fs.clustersize;
+        if( off == 0 && f->pos ) {
+            f->cluster = NextCluster(f,f->cluster,0);
+            if( f->cluster == 0 )
+                return FAT_ERROR_CORRUPT;
+        }
+        sec = ClusterSector(f->cluster)+off/SECTORSIZE;
+        if( off%SECTORSIZE == 0 && n-done >= SECTORSIZE && ((uint32_t) d&31) == 0 ) {
+            ns = (fs.clustersize-off)/SECTORSIZE;
+            if( ns > (n-done)/SECTORSIZE )
+                ns = (n-done)/SECTORSIZE;
+            if( SD_ReadBlocks(sec,d,ns) < 0 )
+                return FAT_ERROR_IO;
+            k = ns*SECTORSIZE;
+        } else {
+            p = CacheGet(sec,0);
+            if( !p )
+                return FAT_ERROR_IO;
+            k = SECTORSIZE-off%SECTORSIZE;
+            if( k > n-done )
+                k = n-done;
+            memcpy(d,p+off%SECTORSIZE,k);
+        }
+        d += k;
+        done += k;
+        f->pos += k;
+    }
+    return done;
+}
+
+/**
+ * @brief  FAT_Write
+ *
+ * @note   Appends n bytes. Returns n or a negative error
+ */
+int
+FAT_Write( FAT_File *f, const void *data, uint32_t n ) {
+const uint8_t *d = data;
+uint32_t k, left = n;
+int rc;
+
+    if( !(f->flags&FAT_WRITE) || !f->buffer )
+        return FAT_ERROR_PARAMETER;
+    if( n > 0xFFFFFFFFU-f->size )
+        return FAT_ERROR_FULL;
+    while( left ) {
+        k = FAT_BUFFERSIZE-f->buflen;
+        if( k > left )
+            k = left;
+        memcpy(f->buffer+f->buflen,d,k);
+        f->buflen += k;
+        f->size   += k;
+        f->changed = 1;
+        d    += k;
+        left -= k;
+        if( f->buflen == FAT_BUFFERSIZE ) {
+            rc = FlushBuffer(f);
+            if( rc < 0 )
+                return rc;
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief  FAT_Preallocate
+ *
+ * @note   Reserves clusters for n bytes after the current end of the file and
+ *         writes the FAT. The file size does not change
+ */
+int
+FAT_Preallocate( FAT_File *f, uint32_t n ) {
+uint64_t needed;
+uint32_t c;
+int rc;
+
+    if( !(f->flags&FAT_WRITE) )
+        return FAT_ERROR_PARAMETER;
+    needed = ((uint64_t) f->size+n+fs.clustersize-1)/fs.clustersize;
+    while( f->nclusters < needed ) {
+        rc = AllocateCluster(f,&c);
+        if( rc < 0 )
+            return rc;
+        if( f->bufcluster == 0 && f->nclusters == f->bufpos/fs.clustersize+1 )
+            f->bufcluster = c;
+    }
+    rc = UpdateEntry(f);
+    if( rc < 0 )
+        return rc;
+    return CacheFlush();
+}
+
+/**
+ * @brief  FAT_Sync
+ *
+ * @note   Writes the buffer, the directory entry and the FAT
+ */
+int
+FAT_Sync( FAT_File *f ) {
+int rc;
+
+    if( f->flags&FAT_WRITE ) {
+        rc = FlushBuffer(f);
+        if( rc < 0 )
+            return rc;
+        rc = UpdateEntry(f);
+        if( rc < 0 )
+            return rc;
+    }
+    return CacheFlush();
+}
+
+/**
+ * @brief  FAT_Close
+ *
+ * @note   For files open for writing, the clusters after the end of the file
+ *         (preallocated and not used) are freed
+ */
+int
+FAT_Close( FAT_File *f ) {
+uint32_t needed, c;
+int rc, i;
+
+    if( !(f->flags&FAT_WRITE) ) {
+        f->flags = 0;
+        return FAT_OK;
+    }
+    rc = FlushBuffer(f);
+    if( rc == FAT_OK ) {
+        needed = (f->size+fs.clustersize-1)/fs.clustersize;
+        if( f->nclusters > needed ) {
+            if( needed == 0 ) {
+                rc = FreeChain(f->firstcluster);
+                f->firstcluster = 0;
+                f->changed = 1;
+            } else {
+                c = ClusterOfChain(f,needed-1);
+                rc = FreeChain(NextCluster(f,c,0));
+                if( rc == FAT_OK )
+                    rc = SetEntry(c,FAT_EOC);
+            }
+        }
+    }
+    if( rc == FAT_OK )
+        rc = UpdateEntry(f);
+    if( rc == FAT_OK )
+        rc = CacheFlush();
+    for(i=0;i<FAT_MAXFILES;i++) {
+        if( f->buffer == BUFFERDATA(i) )
+            bufferused[i] = 0;
+    }
+    f->buffer = 0;
+    f->flags = 0;
+    return rc;
+}
@@ -0,0 +1,126 @@
+#ifndef FAT_H
+#define FAT_H
+/**
+ * @file    fat.h
+ *
+ * @note    FAT32 file system on the MicroSD card (sdcard.c), for logging
+ *
+ * @note    Only the root directory and 8.3 names (long names are skipped).
+ *          Files are read sequentially and written by appending
+ *
+ * @note    FAT and directory sectors go thru a write back sector cache in
+ *          SDRAM. They are written to the card by FAT_Sync and FAT_Close (and
+ *          when a dirty sector is replaced), with all copies of the FAT
+ *
+ * @note    Each file open for writing has a buffer of FAT_BUFFERSIZE bytes in
+ *          SDRAM that starts at a cluster boundary. The card is written when
+ *          the buffer is full, so it gets writes of FAT_BUFFERSIZE bytes (one
+ *          multiple block write when the clusters are contiguous) instead of
+ *          512 byte updates. FAT_Sync writes a partial buffer
+ *
+ * @note    FAT_Preallocate reserves clusters for the data to be appended in
+ *          one pass, so the FAT is written once and not at every new cluster.
+ *          FAT_Close frees the clusters that were not used
+ *
+ * @note    SDRAM_Init and SD_Init must be called before FAT_Mount
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Memory in SDRAM
+ *
+ * @note    FAT_CACHESECTORS*512 bytes for the cache followed by the buffers
+ *          (FAT_MAXFILES*FAT_BUFFERSIZE bytes)
+ *
+ * @note    FAT_BUFFERSIZE must be a multiple of the cluster size. 64 KB is the
+ *          largest cluster with 512 byte sectors
+ */
+///@{
+#ifndef FAT_MEMORY
+#define FAT_MEMORY                      SDRAM_ADDRESS
+#endif
+#ifndef FAT_CACHESECTORS
+#define FAT_CACHESECTORS                64
+#endif
+#ifndef FAT_BUFFERSIZE
+#define FAT_BUFFERSIZE                  65536
+#endif
+#ifndef FAT_MAXFILES
+#define FAT_MAXFILES                    4
+#endif
+///@}
+
+/**
+ * @brief   Date and time of the files created or written (FAT format)
+ *
+ * @note    There is no RTC here. Default is 01/01/2026 00:00
+ */
+#ifndef FAT_TIMESTAMP
+#define FAT_TIMESTAMP                   ((uint32_t) ((2026-1980)<<9|1<<5|1)<<16)
+#endif
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define FAT_OK                          0
+#define FAT_ERROR_IO                    -1      // card access failed
+#define FAT_ERROR_NOFS                  -2      // no FAT file system
+#define FAT_ERROR_UNSUPPORTED           -3      // FAT12/16, exFAT, sector size
+#define FAT_ERROR_NOTFOUND              -4
+#define FAT_ERROR_FULL                  -5      // no free cluster or entry
+#define FAT_ERROR_PARAMETER             -6
+#define FAT_ERROR_NOTMOUNTED            -7
+#define FAT_ERROR_TOOMANYFILES          -8
+#define FAT_ERROR_CORRUPT               -9      // broken cluster chain
+///@}
+
+/**
+ * @brief   Flags for FAT_Open
+ */
+///@{
+#define FAT_READ                        0x01
+#define FAT_WRITE                       0x02    // append at the end
+#define FAT_CREATE                      0x04    // create when not found
+#define FAT_TRUNCATE                    0x08    // start with an empty file
+///@}
+
+/**
+ * @brief   An open file
+ *
+ * @note    The fields are private
+ */
+typedef struct {
+    uint32_t    firstcluster;           // 0 for empty files
+    uint32_t    lastcluster;
+    uint32_t    nclusters;              // length of the chain
+    uint32_t    size;
+    uint32_t    pos;                    // read position
+    uint32_t    cluster;                // cluster of pos (reads)
+    uint32_t    bufpos;                 // file offset of the buffer
+    uint32_t    bufcluster;             // cluster of bufpos, 0 to allocate
+    uint32_t    buflen;
+    uint32_t    bufsaved;               // bytes of the buffer on the card
+    uint8_t     *buffer;
+    uint32_t    dirsector;
+    uint16_t    diroffset;
+    uint8_t     flags;
+    uint8_t     changed;                // directory entry must be updated
+} FAT_File;
+
+int FAT_Mount(void);
+int FAT_Unmount(void);
+int FAT_GetFreeClusters(uint32_t *count, uint32_t *clustersize);
+
+int FAT_Open(FAT_File *f, const char *name, unsigned flags);
+int FAT_Read(FAT_File *f, void *data, uint32_t n);
+int FAT_Write(FAT_File *f, const void *data, uint32_t n);
+int FAT_Preallocate(FAT_File *f, uint32_t n);
+int FAT_Sync(FAT_File *f);
+int FAT_Close(FAT_File *f);
+
+#endif // FAT_H
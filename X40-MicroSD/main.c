@@ -1,28 +1,41 @@
 /**
  * @file     main.c
- * @brief    Blink LEDs using counting delays and CMSIS (Heavy use of macros)
+ * @brief    MicroSD card thru SDMMC1 with DMA: identification and benchmark
  * @version  V1.0
  * @date     06/10/2020
  *
- * @note     The blinking frequency depends on core frequency
- * @note     Direct access to registers
- * @note     No library used
+ * @note     SDMMCCLK (48 MHz) comes from PLLSAI P
+ * @note     The read benchmark reads the first BENCH_MB MB of the card
+ * @note     The write benchmark (SD_WRITETEST) writes BENCH_MB MB near the end
+ *           of the card, destroying its contents, and reads them back
+ * @note     The log benchmark (FAT_LOGTEST) appends BENCH_MB MB in lines to the
+ *           file BENCH.LOG of the FAT32 file system
+ * @note     The stream benchmark (STREAMLOG_TEST) logs samples at STREAM_RATE
+ *           bytes/s to the blocks before the write benchmark area, destroying
+ *           their contents
  *
  *
  ******************************************************************************/
 
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "stm32f746xx.h"
 #include "system_stm32f746.h"
 #include "led.h"
+#include "sdcard.h"
+#include "sdram.h"
+#include "fat.h"
+#include "buddy.h"
+#include "streamlog.h"
 
 
 
 
 static volatile uint32_t tick_ms = 0;
 static volatile uint32_t delay_ms = 0;
+static volatile uint32_t time_ms = 0;
 static int led_initialized = 0;
 
 #define INTERVAL 500
@@ -41,6 +54,8 @@ void SysTick_Handler(void) {
 
     if( delay_ms > 0 ) delay_ms--;
 
+    time_ms++;
+    SD_ProcessTimeouts();
 }
 
 void Delay(uint32_t delay) {
@@ -50,14 +65,230 @@ void Delay(uint32_t delay) {
 
 }
 
+/**
+ * @brief   Benchmark parameters
+ *
+ * @note    Two buffers of BENCH_BLOCKS blocks are used alternately, so one is
+ *          filled while the other one is transferred
+ */
+///@{
+#define BENCH_MB            8
+#define BENCH_BLOCKS        64                  // 32 KB per request
+#define BENCH_REQUESTS      (BENCH_MB*1024*1024/(BENCH_BLOCKS*SD_BLOCKSIZE))
+///@}
+
+static uint8_t buffer[2][BENCH_BLOCKS*SD_BLOCKSIZE] __attribute__((aligned(32)));
+
+/**
+ * @brief   Print a rate in MB/s
+ */
+static void PrintRate(const char *name, uint32_t bytes, uint32_t ms) {
+uint32_t kbs;
+
+    if( ms == 0 )
+        ms = 1;
+    kbs = (uint32_t) ((uint64_t) bytes*1000/1024/ms);
+    printf("%s: %u bytes in %u ms = %u.%02u MB/s\n",name,(unsigned) bytes,(unsigned) ms,
+            (unsigned) (kbs/1024),(unsigned) (kbs%1024*100/1024));
+}
+
+/**
+ * @brief   Sequential transfer of BENCH_MB MB from block first
+ *
+ * @note    For writes, the buffer of request i is filled with a pattern after
+ *          request i-2 completed, while request i-1 is being written
+ */
+static int Bench(uint32_t op, uint32_t first) {
+static SD_Request req[2];
+uint32_t start, i, j;
+uint32_t *p;
+int k, rc = SD_OK;
+
+    req[0].status = req[1].status = SD_OK;
+    start = time_ms;
+    for(i=0;i<BENCH_REQUESTS;i++) {
+        k = i&1;
+        while( req[k].status == SD_PENDING ) {}
+        if( req[k].status < 0 ) {
+            rc = req[k].status;
+            break;
+        }
+        if( op == SD_WRITE ) {
+            p = (uint32_t *) buffer[k];
+            for(j=0;j<sizeof(buffer[0])/4;j++)
+                p[j] = (first+i*BENCH_BLOCKS)*SD_BLOCKSIZE+j*4;
+        }
+        req[k].op       = op;
+        req[k].block    = first+i*BENCH_BLOCKS;
+        req[k].count    = BENCH_BLOCKS;
+        req[k].data     = buffer[k];
+        req[k].callback = 0;
+        req[k].arg      = 0;
+        rc = SD_Submit(&req[k]);
+        if( rc < 0 )
+            break;
+    }
+    for(k=0;k<2;k++) {
+        while( req[k].status == SD_PENDING ) {}
+        if( rc == SD_OK && req[k].status < 0 )
+            rc = req[k].status;
+    }
+    if( rc < 0 ) {
+        printf("%s error %d at request %u\n",op==SD_WRITE?"Write":"Read",rc,(unsigned) i);
+        return rc;
+    }
+    PrintRate(op==SD_WRITE?"Sequential write":"Sequential read",
+              BENCH_MB*1024*1024,time_ms-start);
+    return SD_OK;
+}
+
+#ifdef SD_WRITETEST
+/**
+ * @brief   Read back and compare the pattern written by Bench
+ */
+static int Verify(uint32_t first) {
+uint32_t i, j, *p;
+int rc;
+
+    for(i=0;i<BENCH_REQUESTS;i++) {
+        rc = SD_ReadBlocks(first+i*BENCH_BLOCKS,buffer[0],BENCH_BLOCKS);
+        if( rc < 0 )
+            return rc;
+        p = (uint32_t *) buffer[0];
+        for(j=0;j<sizeof(buffer[0])/4;j++) {
+            if( p[j] != (first+i*BENCH_BLOCKS)*SD_BLOCKSIZE+j*4 ) {
+                printf("Mismatch at block %u\n",(unsigned) (first+i*BENCH_BLOCKS+j/128));
+                return SD_ERROR_DATA;
+            }
+        }
+    }
+    printf("Verify OK\n");
+    return SD_OK;
+}
+#endif
+
+#ifdef FAT_LOGTEST
+/**
+ * @brief   Append BENCH_MB MB to BENCH.LOG in writes of 100 bytes
+ *
+ * @note    The clusters are preallocated, so the FAT is written once. The
+ *          file is synced every second, as a logger would do
+ */
+static int LogBench(void) {
+FAT_File f;
+char line[100];
+uint32_t start, lastsync, i, n;
+int rc;
+
+    rc = FAT_Open(&f,"BENCH.LOG",FAT_WRITE|FAT_CREATE|FAT_TRUNCATE);
+    if( rc < 0 ) {
+        printf("FAT_Open error %d\n",rc);
+        return rc;
+    }
+    rc = FAT_Preallocate(&f,BENCH_MB*1024*1024);
+    if( rc < 0 )
+        printf("FAT_Preallocate error %d\n",rc);
+    n = BENCH_MB*1024*1024/sizeof(line);
+    start = lastsync = time_ms;
+    for(i=0;i<n&&rc>=0;i++) {
+        snprintf(line,sizeof(line),"%08u %08u ",(unsigned) i,(unsigned) time_ms);
+        memset(line+18,'x',sizeof(line)-19);
+        line[sizeof(line)-1] = '\n';
+        rc = FAT_Write(&f,line,sizeof(line));
+        if( rc >= 0 && time_ms-lastsync >= 1000 ) {
+            rc = FAT_Sync(&f);
+            lastsync = time_ms;
+        }
+    }
+    if( rc >= 0 )
+        rc = FAT_Close(&f);
+    if( rc < 0 ) {
+        printf("Log error %d\n",rc);
+        return rc;
+    }
+    PrintRate("Log file",n*sizeof(line),time_ms-start);
+    return FAT_OK;
+}
+#endif
+
+#ifdef STREAMLOG_TEST
+/**
+ * @brief   Stream benchmark parameters
+ *
+ * @note    The pool takes 4 MB of SDRAM after the FAT memory. Four buffers of
+ *          256 KB hold 768 KB waiting for the card at 2 MB/s, about 370 ms
+ */
+///@{
+#define STREAM_POOL         ((char *) SDRAM_ADDRESS+0x100000)
+#define STREAM_POOLSIZE     0x400000
+#define STREAM_BUFFERS      4
+#define STREAM_BUFFERSIZE   (256*1024)
+#define STREAM_RATE         (2*1024*1024)
+#define STREAM_SECONDS      8
+#define STREAM_BLOCKS       (STREAM_RATE/SD_BLOCKSIZE*STREAM_SECONDS)
+///@}
+
+typedef struct {
+    uint32_t    index;
+    uint32_t    time;
+    int32_t     value[2];
+} Sample;
+
+/**
+ * @brief   Log STREAM_SECONDS s of samples to the blocks from first
+ *
+ * @note    Every ms, the samples due are generated and given to StreamLog_Put,
+ *          as an acquisition interrupt would do
+ */
+static int StreamBench(uint32_t first) {
+POOL pool;
+Sample s[STREAM_RATE/1000/sizeof(Sample)];
+StreamLog_Stats stats;
+uint32_t start, now, last, i, n, blocks;
+int rc;
+
+    pool = Buddy_CreatePool(STREAM_POOL,STREAM_POOLSIZE,4096);
+    rc = StreamLog_Start(pool,STREAM_BUFFERS,STREAM_BUFFERSIZE,sizeof(Sample),
+                         first,STREAM_BLOCKS);
+    if( rc < 0 ) {
+        printf("StreamLog_Start error %d\n",rc);
+        return rc;
+    }
+    n = 0;
+    start = last = time_ms;
+    while( (now=time_ms)-start < STREAM_SECONDS*1000 ) {
+        if( now == last )
+            continue;
+        last = now;
+        for(i=0;i<sizeof(s)/sizeof(s[0]);i++) {
+            s[i].index    = n++;
+            s[i].time     = now;
+            s[i].value[0] = (int32_t) i;
+            s[i].value[1] = -(int32_t) i;
+        }
+        StreamLog_Put(s,sizeof(s)/sizeof(s[0]));
+    }
+    StreamLog_GetStats(&stats);
+    rc = StreamLog_Stop(&blocks);
+    printf("Stream: %u samples, %u dropped, %u write errors, high water %u KB of %u KB\n",
+            (unsigned) stats.samples,(unsigned) stats.dropped,(unsigned) stats.writeerrors,
+            (unsigned) (stats.highwater/1024),
+            (unsigned) (stats.nbuffers*stats.buffersize/1024));
+    PrintRate("Stream",blocks*SD_BLOCKSIZE,STREAM_SECONDS*1000);
+    return rc;
+}
+#endif
+
 
 /**
  * @brief   main
  *
- * @note    Initializes GPIO and blinks LED
+ * @note    Initializes the card and runs the benchmarks
  */
 
 int main(void) {
+SD_CardInfo info;
+int rc;
 
     /* Set Clock to 200 MHz */
     SystemConfigMainPLL(&MainPLLConfiguration_200MHz);
@@ -70,6 +301,34 @@ int main(void) {
 
     SystemConfigPLLSAI(&PLLSAIConfiguration_48MHz);
 
+    rc = SD_Init();
+    if( rc < 0 ) {
+        printf("SD_Init error %d\n",rc);
+        for(;;) {}
+    }
+    SD_GetCardInfo(&info);
+    printf("%s card: %u MB, RCA %04X, 4 bit bus at %u MHz (%s speed)\n",
+            info.highcapacity?"SDHC/SDXC":"SDSC",(unsigned) (info.blocks/2048),
+            info.rca,(unsigned) (info.busclock/1000000),info.highspeed?"high":"default");
+
+    Bench(SD_READ,0);
+#ifdef FAT_LOGTEST
+    SDRAM_Init();
+    rc = FAT_Mount();
+    if( rc < 0 )
+        printf("FAT_Mount error %d\n",rc);
+    else
+        LogBench();
+    FAT_Unmount();
+#endif
+#ifdef STREAMLOG_TEST
+    SDRAM_Init();
+    StreamBench(info.blocks-BENCH_REQUESTS*BENCH_BLOCKS-STREAM_BLOCKS);
+#endif
+#ifdef SD_WRITETEST
+    if( Bench(SD_WRITE,info.blocks-BENCH_REQUESTS*BENCH_BLOCKS) == SD_OK )
+        Verify(info.blocks-BENCH_REQUESTS*BENCH_BLOCKS);
+#endif
 
     /*
      * Blink LED
@@ -0,0 +1,69 @@
+#ifndef STREAMLOG_H
+#define STREAMLOG_H
+/**
+ * @file    streamlog.h
+ *
+ * @note    Streaming logger from memory to the MicroSD card
+ *
+ * @note    Samples of a fixed size are copied by StreamLog_Put into a ring of
+ *          large buffers allocated from a buddy pool (in SDRAM). A full buffer
+ *          is submitted to the SD driver (sdcard.c) as one multiple block write
+ *          and the next one is filled meanwhile. The writes run in the SDMMC1
+ *          interrupt, so the producer never waits for the card
+ *
+ * @note    A card can stop for 100 ms or more while it erases or moves data.
+ *          If the rate is R bytes/s and the pause T s, the buffers must hold
+ *          R*T bytes besides the one being filled. When all are waiting for the
+ *          card, samples are dropped and counted, the stream does not stall
+ *
+ * @note    The data goes to a range of blocks of the card, written
+ *          sequentially. For a file, it can be a preallocated contiguous area
+ *
+ * @note    StreamLog_Put has one producer (a task or an interrupt). Buffers are
+ *          released in the SD completion callback, without locks
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "buddy.h"
+
+/**
+ * @brief   Maximal number of buffers
+ */
+#ifndef STREAMLOG_MAXBUFFERS
+#define STREAMLOG_MAXBUFFERS            8
+#endif
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define STREAMLOG_OK                    0
+#define STREAMLOG_ERROR_PARAMETER       -1
+#define STREAMLOG_ERROR_NOMEMORY        -2
+#define STREAMLOG_ERROR_NOTSTARTED      -3
+///@}
+
+/**
+ * @brief   Counters
+ */
+typedef struct {
+    uint32_t    samples;                // accepted
+    uint32_t    dropped;                // no free buffer or area full
+    uint32_t    blockswritten;
+    uint32_t    writeerrors;            // failed writes (data lost)
+    uint32_t    pending;                // buffers waiting for the card now
+    uint32_t    highwater;              // maximal bytes waiting for the card
+    uint32_t    buffersize;
+    uint32_t    nbuffers;
+} StreamLog_Stats;
+
+int  StreamLog_Start(POOL pool, uint32_t nbuffers, uint32_t buffersize,
+                     uint32_t samplesize, uint32_t firstblock, uint32_t nblocks);
+int  StreamLog_Put(const void *samples, uint32_t count);
+int  StreamLog_Stop(uint32_t *blocks);
+void StreamLog_GetStats(StreamLog_Stats *stats);
+
+#endif // STREAMLOG_H
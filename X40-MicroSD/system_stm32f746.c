@@ -70,6 +70,7 @@ const PLLConfiguration_t  MainPLLConfiguration_Max = {
  *
  * @note    So the R output must be 18, 36, 72 or 144 MHz.
  *          But USB, RNG and SDMMC needs 48 MHz. The LCM of 48 and 9 is 144.
+ *          P is even, so the VCO runs at 2*144 MHz.
  *
  *          f_LCDCLK  = 9 MHz        PLLSAIRDIV=8
  *
@@ -77,10 +78,10 @@ const PLLConfiguration_t  MainPLLConfiguration_Max = {
 const PLLConfiguration_t  PLLSAIConfiguration_48MHz = {
     .source         = RCC_PLLCFGR_PLLSRC_HSI,
     .M              = HSE_FREQ/1000,                        // f_IN = 1 MHz
-    .N              = 144,                                  // f_VCO = 144 MHz
-    .P              = 3,                                    // f_P = 48 MHz
-    .Q              = 3,                                    // f_Q = 48 MHz
-    .R              = 2                                     // f_R = 72 MHz
+    .N              = 288,                                  // f_VCO = 288 MHz
+    .P              = 6,                                    // f_P = 48 MHz
+    .Q              = 6,                                    // f_Q = 48 MHz
+    .R              = 4                                     // f_R = 72 MHz
 };
 
 
@@ -193,7 +194,7 @@ static inline void LockFlashRegisters(void) {
 
 static void inline SetFlashWaitStates(int n) {
 
-    FLASH->ACR = (FLASH->CR&~FLASH_ACR_LATENCY)|((n)<<FLASH_ACR_LATENCY_Pos);
+    FLASH->ACR = (FLASH->ACR&~FLASH_ACR_LATENCY)|((n)<<FLASH_ACR_LATENCY_Pos);
 
 }
 
@@ -226,9 +227,9 @@ int i,j;
  *
  **/
 static void inline ConfigureFlashWaitStates(uint32_t freq, uint32_t voltage) {
-uint32_t ws;
+int ws;
 
-    ws = FindFlashWaitStates(freq,voltage);
+    ws = FindFlashWaitStates(freq/1000000,voltage);
 
     if( ws < 0 )
         return;
@@ -373,7 +374,7 @@ void SystemSetAPB2Prescaler(uint32_t div) {
 uint32_t ppre2;
 uint32_t p2;
 
-    if( SystemCoreClock/div > 54000000 )
+    if( SystemCoreClock/div > 108000000 )
         return;
         
     p2 = SystemFindLargestPower2Exp(div);
@@ -477,19 +478,19 @@ int  SystemGetPLLConfiguration(uint32_t whichone, PLLConfiguration_t *pllconfig)
     case PLL_MAIN:
         pllconfig->N = (RCC->PLLCFGR&RCC_PLLCFGR_PLLN_Msk)>>RCC_PLLCFGR_PLLN_Pos;
         pllconfig->P = (RCC->PLLCFGR&RCC_PLLCFGR_PLLP_Msk)>>RCC_PLLCFGR_PLLP_Pos;
-        pllconfig->Q = (RCC->PLLCFGR&RCC_PLLCFGR_PLLP_Msk)>>RCC_PLLCFGR_PLLQ_Pos;
+        pllconfig->Q = (RCC->PLLCFGR&RCC_PLLCFGR_PLLQ_Msk)>>RCC_PLLCFGR_PLLQ_Pos;
         pllconfig->R = 0;
         break;
     case PLL_SAI:
         pllconfig->N = (RCC->PLLSAICFGR&RCC_PLLSAICFGR_PLLSAIN_Msk)>>RCC_PLLSAICFGR_PLLSAIN_Pos;
         pllconfig->P = (RCC->PLLSAICFGR&RCC_PLLSAICFGR_PLLSAIP_Msk)>>RCC_PLLSAICFGR_PLLSAIP_Pos;
-        pllconfig->Q = (RCC->PLLSAICFGR&RCC_PLLSAICFGR_PLLSAIR_Msk)>>RCC_PLLSAICFGR_PLLSAIQ_Pos;
+        pllconfig->Q = (RCC->PLLSAICFGR&RCC_PLLSAICFGR_PLLSAIQ_Msk)>>RCC_PLLSAICFGR_PLLSAIQ_Pos;
         pllconfig->R = (RCC->PLLSAICFGR&RCC_PLLSAICFGR_PLLSAIR_Msk)>>RCC_PLLSAICFGR_PLLSAIR_Pos;
         break;
     case PLL_I2S:
         pllconfig->N = (RCC->PLLI2SCFGR&RCC_PLLI2SCFGR_PLLI2SN_Msk)>>RCC_PLLI2SCFGR_PLLI2SN_Pos;
         pllconfig->P = (RCC->PLLI2SCFGR&RCC_PLLI2SCFGR_PLLI2SP_Msk)>>RCC_PLLI2SCFGR_PLLI2SP_Pos;
-        pllconfig->Q = (RCC->PLLI2SCFGR&RCC_PLLI2SCFGR_PLLI2SR_Msk)>>RCC_PLLI2SCFGR_PLLI2SQ_Pos;
+        pllconfig->Q = (RCC->PLLI2SCFGR&RCC_PLLI2SCFGR_PLLI2SQ_Msk)>>RCC_PLLI2SCFGR_PLLI2SQ_Pos;
         pllconfig->R = (RCC->PLLI2SCFGR&RCC_PLLI2SCFGR_PLLI2SR_Msk)>>RCC_PLLI2SCFGR_PLLI2SR_Pos;
         break;
     }
@@ -581,7 +582,7 @@ PLLConfiguration_t pllconfig;
         pllconfig.source = pllsrc;
         pllconfig.M = (rcc_pllcfgr & RCC_PLLCFGR_PLLM)>>RCC_PLLCFGR_PLLM_Pos;
         pllconfig.N = (rcc_pllcfgr & RCC_PLLCFGR_PLLN)>>RCC_PLLCFGR_PLLN_Pos;
-        pllconfig.P = (rcc_pllcfgr & RCC_PLLCFGR_PLLP)>>RCC_PLLCFGR_PLLP_Pos;
+        pllconfig.P = ((rcc_pllcfgr & RCC_PLLCFGR_PLLP)>>RCC_PLLCFGR_PLLP_Pos)*2+2;
         sysclk_freq = CalculateMainPLLOutFrequency(&pllconfig);
       break;
     }
@@ -722,7 +723,7 @@ int      pllwascoreclock = 0;
     // If core clock source is PLL change it to HSI
     if( (RCC->CFGR&RCC_CFGR_SWS) == RCC_CFGR_SWS_PLL ) {
         SystemEnableHSI();
-        RCC->CFGR = (RCC->CFGR&RCC_CFGR_SW)|RCC_CFGR_SW_HSI;
+        RCC->CFGR = (RCC->CFGR&~RCC_CFGR_SW)|RCC_CFGR_SW_HSI;
         pllwascoreclock = 1;
     }
     // Disable Main PLL
@@ -757,7 +758,7 @@ int      pllwascoreclock = 0;
                  (
                    ((pllconfig->M<<RCC_PLLCFGR_PLLM_Pos)&RCC_PLLCFGR_PLLM)
                   |((pllconfig->N<<RCC_PLLCFGR_PLLN_Pos)&RCC_PLLCFGR_PLLN)
-                  |((pllconfig->P<<RCC_PLLCFGR_PLLP_Pos)&RCC_PLLCFGR_PLLP)
+                  |(((pllconfig->P/2-1)<<RCC_PLLCFGR_PLLP_Pos)&RCC_PLLCFGR_PLLP)
                   |((pllconfig->Q<<RCC_PLLCFGR_PLLQ_Pos)&RCC_PLLCFGR_PLLQ)
                   |((src<<RCC_PLLCFGR_PLLSRC_Pos)&RCC_PLLCFGR_PLLSRC)
                  );
@@ -770,7 +771,7 @@ int      pllwascoreclock = 0;
 
     /* If it was the core clock, change back */
     if( pllwascoreclock ) {
-        RCC->CFGR = (RCC->CFGR&RCC_CFGR_SW)|RCC_CFGR_SW_PLL;
+        RCC->CFGR = (RCC->CFGR&~RCC_CFGR_SW)|RCC_CFGR_SW_PLL;
     }
 }
 
@@ -806,7 +807,7 @@ uint32_t clocksource;
 
     rcc_pllsaicfgr |= (
                         ((pllconfig->N<<RCC_PLLSAICFGR_PLLSAIN_Pos)&RCC_PLLSAICFGR_PLLSAIN)
-                       |((pllconfig->P<<RCC_PLLSAICFGR_PLLSAIP_Pos)&RCC_PLLSAICFGR_PLLSAIP)
+                       |(((pllconfig->P/2-1)<<RCC_PLLSAICFGR_PLLSAIP_Pos)&RCC_PLLSAICFGR_PLLSAIP)
                        |((pllconfig->Q<<RCC_PLLSAICFGR_PLLSAIQ_Pos)&RCC_PLLSAICFGR_PLLSAIQ)
                        |((pllconfig->R<<RCC_PLLSAICFGR_PLLSAIR_Pos)&RCC_PLLSAICFGR_PLLSAIR)
                       );
@@ -852,7 +853,7 @@ uint32_t clocksource;
 
     rcc_plli2scfgr |= (
                         ((pllconfig->N<<RCC_PLLI2SCFGR_PLLI2SN_Pos)&RCC_PLLI2SCFGR_PLLI2SN)
-                       |((pllconfig->P<<RCC_PLLI2SCFGR_PLLI2SP_Pos)&RCC_PLLI2SCFGR_PLLI2SP)
+                       |(((pllconfig->P/2-1)<<RCC_PLLI2SCFGR_PLLI2SP_Pos)&RCC_PLLI2SCFGR_PLLI2SP)
                        |((pllconfig->Q<<RCC_PLLI2SCFGR_PLLI2SQ_Pos)&RCC_PLLI2SCFGR_PLLI2SQ)
                        |((pllconfig->R<<RCC_PLLI2SCFGR_PLLI2SR_Pos)&RCC_PLLI2SCFGR_PLLI2SR)
                       );
@@ -979,7 +980,7 @@ PLLConfiguration_t clockconf;
     }
     clockconf.source = CLOCKSRC_HSE;     /* Clock source   */
     clockconf.M = HSE_FREQ/1000000;      /* f_IN = 1 MHz   */
-    clockconf.N = 2*freq;                /* f_PLL = 400 MHz*/
+    clockconf.N = 2*(freq/1000000);      /* f_PLL = 400 MHz*/
     clockconf.P = 2;                     /* f_OUT = 200 MHz*/
     clockconf.Q = 2;                     /* Not used */
     clockconf.R = 2;                     /* Not used */
@@ -0,0 +1,788 @@
+/**
+ * @file    kvstore.c
+ *
+ * @note    Log structured key/value store (see kvstore.h)
+ *
+ * @note    Block (subsector) layout
+ *
+ *          | Offset | Size | Content                                    |
+ *          |--------|------|--------------------------------------------|
+ *          |    0   |   4  | BLOCK_MAGIC (programmed after the sequence) |
+ *          |    4   |   4  | sequence number (order of use)             |
+ *          |    8   |   4  | 0 when obsolete (before the erase)         |
+ *          |   12   |   4  | FFFFFFFFh                                  |
+ *          |   16   |      | records                                    |
+ *
+ * @note    Record layout (padded to 4 bytes with FFh)
+ *
+ *          | Offset | Size | Content                                    |
+ *          |--------|------|--------------------------------------------|
+ *          |    0   |   1  | RECORD_COMMITTED (programmed last)         |
+ *          |    1   |   1  | key length, RECORD_DELETED for a deletion  |
+ *          |    2   |   2  | value length                               |
+ *          |    4   |   4  | CRC32 of bytes 1-3, key and value          |
+ *          |    8   |      | key (without 0) and value                  |
+ *
+ * @note    An index entry points to the current record of its key (in the
+ *          queue or in the flash) and to the last one programmed (stored).
+ *          The compaction copies only the stored records, so a record waiting
+ *          in the queue never makes the previous one dead. A deleted key keeps
+ *          its entry (with size 0) until the deletion is programmed. The
+ *          compaction always takes the oldest block, so there is no older
+ *          record that a deletion in it must hide and deletions are dropped
+ *
+ * @note    Only the newest block can have an interrupted record. At mount, it
+ *          ends the scan of the block and the rest of it is not used
+ *
+ * @note    Records of the user open a new block only when another erased
+ *          block remains for the compaction. The compaction starts when less
+ *          than MINERASED blocks are erased and the queue waits until it ends.
+ *          The live records of the oldest block fit in the rest of the active
+ *          block and one erased block, and CAPACITY leaves two blocks for the
+ *          fragmentation and the compaction
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <string.h>
+#include "qspi.h"
+#include "crc.h"
+#include "kvstore.h"
+
+/**
+ * @brief   Layout
+ */
+///@{
+#define BLOCKSIZE                       QSPI_SUBSECTORSIZE
+#define BLOCK_MAGIC                     0x3130564B      // "KV01"
+#define BLOCK_HEADERSIZE                16
+#define RECORD_HEADERSIZE               8
+#define RECORD_COMMITTED                0xA5
+#define RECORD_DELETED                  0x80
+#define RECORD_KEYLEN                   0x7F
+#define RECORDSIZE(K,N)                 ((RECORD_HEADERSIZE+(K)+(N)+3)&~3U)
+#define RECORDMAX                       RECORDSIZE(KV_KEYMAX,KV_VALUEMAX)
+#define BLOCKDATA                       (BLOCKSIZE-BLOCK_HEADERSIZE)
+#define CAPACITY                        ((KV_BLOCKS-3)*(BLOCKDATA-RECORDMAX)-KV_QUEUESIZE)
+#define MINERASED                       2
+///@}
+
+/**
+ * @brief   Index (hash table with linear probing)
+ *
+ * @note    location is the offset of the record in the store or QUEUED plus its
+ *          offset in the queue. It holds the keys and the deletions in the queue
+ */
+///@{
+#define TABLESIZE                       (2*KV_MAXKEYS)
+#define EMPTY                           0xFFFFFFFF
+#define QUEUED                          0x80000000
+///@}
+
+#if KV_BLOCKS < 4
+#error "KV_BLOCKS must be at least 4"
+#endif
+#if KV_KEYMAX > RECORD_KEYLEN || KV_VALUEMAX > 65535
+#error "KV_KEYMAX or KV_VALUEMAX too large"
+#endif
+#if KV_QUEUESIZE < RECORDMAX || KV_QUEUESIZE > 32768
+#error "KV_QUEUESIZE smaller than a record or too large"
+#endif
+#if (KV_MAXKEYS&(KV_MAXKEYS-1)) != 0 || KV_QUEUEMAX >= KV_MAXKEYS
+#error "KV_MAXKEYS must be a power of 2 larger than KV_QUEUEMAX"
+#endif
+
+/**
+ * @brief   Index entry
+ */
+typedef struct {
+    uint32_t    hash;
+    uint32_t    location;
+    uint32_t    stored;                 // last programmed record or EMPTY
+    uint16_t    size;                   // record, 0 when deleted
+    uint16_t    valuelen;
+} Entry;
+
+/**
+ * @brief   Block state (used=0 when erased)
+ */
+typedef struct {
+    uint32_t    seq;
+    uint32_t    used;                   // offset of the free area
+} Block;
+
+/**
+ * @brief   Queued record
+ */
+typedef struct {
+    uint16_t    offset;
+    uint16_t    size;
+} Pending;
+
+/**
+ * @brief   Store state
+ */
+///@{
+static Entry        table[TABLESIZE];
+static Block        blocks[KV_BLOCKS];
+static uint8_t      queue[KV_QUEUESIZE] __attribute__((aligned(4)));
+static Pending      pending[KV_QUEUEMAX];
+static uint32_t     rbuf[RECORDMAX/4];      // record being read or copied
+static int          mounted = 0;
+static int          active = -1;            // block receiving the records
+static int          victim = -1;            // block being compacted
+static uint32_t     scan;                   // next record of the victim
+static uint32_t     nextseq;
+static uint32_t     erasedblocks;
+static uint32_t     keys;
+static uint32_t     livebytes;
+static uint32_t     qfirst, qcount, qin, qout;
+static uint32_t     erases;
+static uint32_t     compactions;
+///@}
+
+/**
+ * @brief  CRC of a record
+ *
+ * @note   CRC-32 of zlib, computed by the CRC unit (see crc.c)
+ */
+static uint32_t RecordCRC( const uint8_t *r ) {
+uint32_t keylen = r[1]&RECORD_KEYLEN;
+uint32_t n = r[2]|r[3]<<8;
+uint32_t crc;
+
+    crc = CRC32_Update(0,r+1,3);
+    return CRC32_Update(crc,r+RECORD_HEADERSIZE,keylen+n);
+}
+
+/**
+ * @brief  Hash of a key (FNV-1a)
+ */
+static uint32_t Hash( const char *key, uint32_t keylen ) {
+uint32_t h = 2166136261U;
+
+    while( keylen-- )
+        h = (h^(uint8_t) *key++)*16777619U;
+    return h;
+}
+
+/**
+ * @brief  Build a record with the commit byte erased. Returns its size
+ */
+static uint32_t Build( uint8_t *r, const char *key, uint32_t keylen,
+                       const void *value, uint32_t n, uint32_t flags ) {
+uint32_t size = RECORDSIZE(keylen,n);
+uint32_t crc;
+
+    memset(r,0xFF,size);
+    r[1] = keylen|flags;
+    r[2] = n&0xFF;
+    r[3] = n>>8;
+    memcpy(r+RECORD_HEADERSIZE,key,keylen);
+    if( n )
+        memcpy(r+RECORD_HEADERSIZE+keylen,value,n);
+    crc = RecordCRC(r);
+    memcpy(r+4,&crc,4);
+    return size;
+}
+
+/**
+ * @brief  Check that an area of the store is erased
+ */
+static int Blank( uint32_t offset, uint32_t n ) {
+uint32_t k, i;
+
+    while( n ) {
+        k = n > sizeof(rbuf) ? sizeof(rbuf) : n;
+        if( QSPI_Read(KV_ADDRESS+offset,rbuf,k) != QSPI_OK )
+            return 0;
+        for(i=0;i<k/4;i++) {
+            if( rbuf[i] != 0xFFFFFFFF )
+                return 0;
+        }
+        offset += k;
+        n -= k;
+    }
+    return 1;
+}
+
+/**
+ * @brief  Compare the key of the record at location
+ */
+static int SameKey( uint32_t location, const char *key, uint32_t keylen ) {
+uint8_t h[RECORD_HEADERSIZE+KV_KEYMAX];
+const uint8_t *r = h;
+
+    if( location&QUEUED )
+        r = queue+(location&~QUEUED);
+    else if( QSPI_Read(KV_ADDRESS+location,h,RECORD_HEADERSIZE+keylen) != QSPI_OK )
+        return 0;
+    return (r[1]&RECORD_KEYLEN) == keylen && memcmp(r+RECORD_HEADERSIZE,key,keylen) == 0;
+}
+
+/**
+ * @brief  Find a key in the index
+ *
+ * @note   Returns 1 and its slot when found, else 0 and the free slot
+ */
+static int Find( const char *key, uint32_t keylen, uint32_t hash, uint32_t *slot ) {
+uint32_t i = hash&(TABLESIZE-1);
+
+    while( table[i].location != EMPTY ) {
+        if( table[i].hash == hash && SameKey(table[i].location,key,keylen) ) {
+            *slot = i;
+            return 1;
+        }
+        i = (i+1)&(TABLESIZE-1);
+    }
+    *slot = i;
+    return 0;
+}
+
+/**
+ * @brief  Remove an entry, moving back the following ones of its cluster
+ */
+static void Remove( uint32_t i ) {
+uint32_t j = i, k;
+
+    for(;;) {
+        j = (j+1)&(TABLESIZE-1);
+        if( table[j].location == EMPTY )
+            break;
+        k = table[j].hash&(TABLESIZE-1);
+        // Move it when its home slot is not in (i,j]
+        if( (i < j) ? (k <= i || k > j) : (k <= i && k > j) ) {
+            table[i] = table[j];
+            i = j;
+        }
+    }
+    table[i].location = EMPTY;
+}
+
+/**
+ * @brief  Set the entry of the key of a record to location
+ *
+ * @note   For a record of the flash (mount), stored is set too and a deletion
+ *         removes the entry. For a queued one, a deletion leaves an entry with
+ *         size 0
+ */
+static int Update( const uint8_t *r, uint32_t location, uint32_t size ) {
+const char *key = (const char *) r+RECORD_HEADERSIZE;
+uint32_t keylen = r[1]&RECORD_KEYLEN;
+uint32_t hash = Hash(key,keylen);
+uint32_t slot;
+int found = Find(key,keylen,hash,&slot);
+
+    if( found ) {
+        livebytes -= table[slot].size;
+        if( table[slot].size )
+            keys--;
+    }
+    if( r[1]&RECORD_DELETED ) {
+        if( !found )
+            return KV_OK;
+        if( !(location&QUEUED) ) {
+            Remove(slot);
+            return KV_OK;
+        }
+        size = 0;
+    } else {
+        if( keys >= KV_MAXKEYS )
+            return KV_ERROR_TOOMANYKEYS;
+        keys++;
+    }
+    if( !found ) {
+        table[slot].hash   = hash;
+        table[slot].stored = EMPTY;
+    }
+    table[slot].location = location;
+    if( !(location&QUEUED) )
+        table[slot].stored = location;
+    table[slot].size     = size;
+    table[slot].valuelen = r[2]|r[3]<<8;
+    livebytes += size;
+    return KV_OK;
+}
+
+/**
+ * @brief  Clear the RAM state
+ */
+static void Reset( void ) {
+uint32_t i;
+
+    for(i=0;i<TABLESIZE;i++)
+        table[i].location = EMPTY;
+    for(i=0;i<KV_BLOCKS;i++) {
+        blocks[i].seq  = 0;
+        blocks[i].used = 0;
+    }
+    active       = -1;
+    victim       = -1;
+    nextseq      = 0;
+    erasedblocks = KV_BLOCKS;
+    keys         = 0;
+    livebytes    = 0;
+    qfirst = qcount = qin = qout = 0;
+}
+
+/**
+ * @brief  Erase a block, marking it obsolete first when it was used
+ */
+static int EraseBlock( uint32_t b ) {
+uint32_t address = KV_ADDRESS+b*BLOCKSIZE;
+uint32_t zero = 0;
+
+    if( blocks[b].used )
+        QSPI_Write(address+8,&zero,4);
+    erases++;
+    if( QSPI_EraseSubsector(address) != QSPI_OK )
+        return KV_ERROR_IO;
+    if( blocks[b].used )
+        erasedblocks++;
+    blocks[b].used = 0;
+    return KV_OK;
+}
+
+/**
+ * @brief  Make the next erased block (in turn) the active one
+ *
+ * @note   reserve erased blocks are left for the compaction
+ */
+static int OpenBlock( uint32_t reserve ) {
+uint32_t address, magic = BLOCK_MAGIC;
+uint32_t i, b;
+
+    if( erasedblocks <= reserve )
+        return KV_ERROR_FULL;
+    b = active < 0 ? 0 : (uint32_t) active;
+    for(i=0;i<KV_BLOCKS;i++) {
+        b = (b+1)%KV_BLOCKS;
+        if( blocks[b].used == 0 )
+            break;
+    }
+    address = KV_ADDRESS+b*BLOCKSIZE;
+    blocks[b].seq  = nextseq++;
+    blocks[b].used = BLOCKSIZE;             // until the header is written
+    erasedblocks--;
+    active = b;
+    if( QSPI_Write(address+4,&blocks[b].seq,4) != QSPI_OK
+     || QSPI_Write(address,&magic,4) != QSPI_OK )
+        return KV_ERROR_IO;
+    blocks[b].used = BLOCK_HEADERSIZE;
+    return KV_OK;
+}
+
+/**
+ * @brief  Program a record in the active block
+ *
+ * @note   The body is programmed first and then the commit byte. After an
+ *         error, the block is not used anymore
+ */
+static int Append( const uint8_t *r, uint32_t size, uint32_t reserve, uint32_t *location ) {
+uint32_t offset;
+uint8_t commit = RECORD_COMMITTED;
+int rc;
+
+    if( active < 0 || blocks[active].used+size > BLOCKSIZE ) {
+        rc = OpenBlock(reserve);
+        if( rc < 0 )
+            return rc;
+    }
+    offset = active*BLOCKSIZE+blocks[active].used;
+    if( QSPI_Write(KV_ADDRESS+offset+1,r+1,size-1) != QSPI_OK
+     || QSPI_Write(KV_ADDRESS+offset,&commit,1) != QSPI_OK ) {
+        blocks[active].used = BLOCKSIZE;
+        return KV_ERROR_IO;
+    }
+    blocks[active].used += size;
+    *location = offset;
+    return KV_OK;
+}
+
+/**
+ * @brief  Read and check the record at offset of the block
+ *
+ * @note   Returns its size in rbuf, 0 at the end of the records and a negative
+ *         value for an invalid (interrupted) record
+ */
+static int ReadRecord( uint32_t b, uint32_t offset ) {
+uint8_t *r = (uint8_t *) rbuf;
+uint32_t keylen, n, size, crc;
+
+    if( offset+RECORD_HEADERSIZE > BLOCKSIZE )
+        return 0;
+    if( QSPI_Read(KV_ADDRESS+b*BLOCKSIZE+offset,r,RECORD_HEADERSIZE) != QSPI_OK )
+        return KV_ERROR_IO;
+    if( rbuf[0] == 0xFFFFFFFF && rbuf[1] == 0xFFFFFFFF )
+        return 0;
+    keylen = r[1]&RECORD_KEYLEN;
+    n = r[2]|r[3]<<8;
+    size = RECORDSIZE(keylen,n);
+    if( r[0] != RECORD_COMMITTED || keylen == 0 || keylen > KV_KEYMAX
+     || n > KV_VALUEMAX || offset+size > BLOCKSIZE )
+        return KV_ERROR_IO;
+    if( QSPI_Read(KV_ADDRESS+b*BLOCKSIZE+offset+RECORD_HEADERSIZE,
+                  r+RECORD_HEADERSIZE,size-RECORD_HEADERSIZE) != QSPI_OK )
+        return KV_ERROR_IO;
+    memcpy(&crc,r+4,4);
+    if( crc != RecordCRC(r) )
+        return KV_ERROR_IO;
+    return size;
+}
+
+/**
+ * @brief  Add the records of a block to the index
+ */
+static int ScanBlock( uint32_t b ) {
+uint32_t offset = BLOCK_HEADERSIZE;
+int size, rc;
+
+    while( (size = ReadRecord(b,offset)) > 0 ) {
+        rc = Update((uint8_t *) rbuf,b*BLOCKSIZE+offset,size);
+        if( rc < 0 )
+            return rc;
+        offset += size;
+    }
+    blocks[b].used = size < 0 ? BLOCKSIZE : offset;
+    return KV_OK;
+}
+
+/**
+ * @brief  Space for a record at the end of the queue
+ *
+ * @note   Returns the offset or -1. A record is not split: when it does not fit
+ *         at the end of the buffer, it goes to the start and the end is unused
+ */
+static int QueueSpace( uint32_t size ) {
+
+    if( qcount == KV_QUEUEMAX )
+        return -1;
+    if( qcount == 0 ) {
+        qin = qout = 0;
+        return 0;
+    }
+    if( qin > qout ) {
+        if( KV_QUEUESIZE-qin >= size )
+            return qin;
+        if( qout >= size )
+            return 0;
+        return -1;
+    }
+    if( qout-qin >= size )
+        return qin;
+    return -1;
+}
+
+/**
+ * @brief  Add the record built at offset to the queue
+ */
+static void QueuePush( uint32_t offset, uint32_t size ) {
+Pending *p = &pending[(qfirst+qcount)%KV_QUEUEMAX];
+
+    p->offset = offset;
+    p->size   = size;
+    qin = offset+size;
+    qcount++;
+}
+
+/**
+ * @brief  Wait for space in the queue, processing it
+ */
+static int QueueWait( uint32_t size ) {
+int offset, rc;
+
+    while( (offset = QueueSpace(size)) < 0 ) {
+        rc = KV_Process();
+        if( rc < 0 )
+            return rc;
+    }
+    return offset;
+}
+
+/**
+ * @brief  Program the oldest queued record
+ */
+static int ProgramQueued( void ) {
+Pending *p = &pending[qfirst];
+const uint8_t *r = queue+p->offset;
+const char *key = (const char *) r+RECORD_HEADERSIZE;
+uint32_t keylen = r[1]&RECORD_KEYLEN;
+uint32_t location, slot;
+int rc;
+
+    rc = Append(r,p->size,1,&location);
+    if( rc < 0 )
+        return rc;
+    if( Find(key,keylen,Hash(key,keylen),&slot) ) {
+        if( r[1]&RECORD_DELETED ) {
+            if( table[slot].location == (QUEUED|p->offset) )
+                Remove(slot);
+            else
+                table[slot].stored = EMPTY;
+        } else {
+            if( table[slot].location == (QUEUED|p->offset) )
+                table[slot].location = location;
+            table[slot].stored = location;
+        }
+    }
+    qout = p->offset+p->size;
+    qfirst = (qfirst+1)%KV_QUEUEMAX;
+    qcount--;
+    return KV_OK;
+}
+
+/**
+ * @brief  Choose the oldest block (not the active one) for the compaction
+ */
+static void StartCompaction( void ) {
+uint32_t b;
+
+    for(b=0;b<KV_BLOCKS;b++) {
+        if( blocks[b].used == 0 || (int) b == active )
+            continue;
+        if( victim < 0 || (int32_t) (blocks[b].seq-blocks[victim].seq) < 0 )
+            victim = b;
+    }
+    if( victim >= 0 ) {
+        scan = BLOCK_HEADERSIZE;
+        compactions++;
+    }
+}
+
+/**
+ * @brief  Copy one live record of the victim or erase it at the end
+ */
+static int CompactStep( void ) {
+uint8_t *r = (uint8_t *) rbuf;
+const char *key = (const char *) r+RECORD_HEADERSIZE;
+uint32_t keylen, location, slot;
+int size, rc;
+
+    size = scan < blocks[victim].used ? ReadRecord(victim,scan) : 0;
+    if( size <= 0 ) {
+        rc = EraseBlock(victim);
+        if( rc < 0 )
+            return rc;
+        victim = -1;
+        return KV_OK;
+    }
+    keylen = r[1]&RECORD_KEYLEN;
+    if( !(r[1]&RECORD_DELETED)
+     && Find(key,keylen,Hash(key,keylen),&slot)
+     && table[slot].stored == victim*BLOCKSIZE+scan ) {
+        rc = Append(r,size,0,&location);
+        if( rc < 0 )
+            return rc;
+        if( table[slot].location == table[slot].stored )
+            table[slot].location = location;
+        table[slot].stored = location;
+    }
+    scan += size;
+    return KV_OK;
+}
+
+/**
+ * @brief  KV_Mount
+ *
+ * @note   Erases the blocks with an invalid header (interrupted erase or block
+ *         opening) and the obsolete ones, then scans the others in the order
+ *         of use to build the index
+ */
+int
+KV_Mount( void ) {
+uint32_t header[BLOCK_HEADERSIZE/4];
+uint32_t order[KV_BLOCKS];
+uint32_t n = 0, i, j, b;
+int rc;
+
+    mounted = 0;
+    Reset();
+    for(b=0;b<KV_BLOCKS;b++) {
+        if( QSPI_Read(KV_ADDRESS+b*BLOCKSIZE,header,sizeof(header)) != QSPI_OK )
+            return KV_ERROR_IO;
+        if( header[0] == BLOCK_MAGIC && header[2] == 0xFFFFFFFF ) {
+            blocks[b].seq  = header[1];
+            blocks[b].used = BLOCKSIZE;
+            erasedblocks--;
+            // Insert in the order of use
+            for(i=n;i>0&&(int32_t) (blocks[order[i-1]].seq-header[1])>0;i--)
+                order[i] = order[i-1];
+            order[i] = b;
+            n++;
+        } else if( !Blank(b*BLOCKSIZE,BLOCKSIZE) ) {
+            if( EraseBlock(b) < 0 )
+                return KV_ERROR_IO;
+        }
+    }
+    for(j=0;j<n;j++) {
+        rc = ScanBlock(order[j]);
+        if( rc < 0 )
+            return rc;
+    }
+    if( n ) {
+        active  = order[n-1];
+        nextseq = blocks[active].seq+1;
+        // An interrupted write can leave programmed bits after the last record
+        b = blocks[active].used;
+        if( !Blank(active*BLOCKSIZE+b,BLOCKSIZE-b) )
+            blocks[active].used = BLOCKSIZE;
+    }
+    mounted = 1;
+    return KV_OK;
+}
+
+/**
+ * @brief  KV_Format
+ *
+ * @note   Erases all the blocks and mounts the empty store
+ */
+int
+KV_Format( void ) {
+uint32_t b;
+
+    mounted = 0;
+    Reset();
+    for(b=0;b<KV_BLOCKS;b++) {
+        if( EraseBlock(b) < 0 )
+            return KV_ERROR_IO;
+    }
+    mounted = 1;
+    return KV_OK;
+}
+
+/**
+ * @brief  KV_Get
+ *
+ * @note   Copies up to size bytes of the value and returns its length
+ */
+int
+KV_Get( const char *key, void *value, uint32_t size ) {
+uint32_t keylen, slot, n, location;
+
+    if( !mounted )
+        return KV_ERROR_NOTMOUNTED;
+    if( !key || (keylen = strlen(key)) == 0 || keylen > KV_KEYMAX || (size && !value) )
+        return KV_ERROR_PARAMETER;
+    if( !Find(key,keylen,Hash(key,keylen),&slot) || table[slot].size == 0 )
+        return KV_ERROR_NOTFOUND;
+    n = table[slot].valuelen;
+    if( size > n )
+        size = n;
+    location = table[slot].location;
+    if( location&QUEUED )
+        memcpy(value,queue+(location&~QUEUED)+RECORD_HEADERSIZE+keylen,size);
+    else if( size && QSPI_Read(KV_ADDRESS+location+RECORD_HEADERSIZE+keylen,value,size) != QSPI_OK )
+        return KV_ERROR_IO;
+    return n;
+}
+
+/**
+ * @brief  KV_Set
+ *
+ * @note   The record is queued and the index points to it until KV_Process
+ *         programs it
+ */
+int
+KV_Set( const char *key, const void *value, uint32_t n ) {
+uint32_t keylen, size, hash, slot, live;
+int found, offset;
+
+    if( !mounted )
+        return KV_ERROR_NOTMOUNTED;
+    if( !key || (keylen = strlen(key)) == 0 || keylen > KV_KEYMAX
+     || n > KV_VALUEMAX || (n && !value) )
+        return KV_ERROR_PARAMETER;
+    size = RECORDSIZE(keylen,n);
+    offset = QueueWait(size);
+    if( offset < 0 )
+        return offset;
+    hash = Hash(key,keylen);
+    found = Find(key,keylen,hash,&slot) && table[slot].size;
+    if( !found && keys >= KV_MAXKEYS )
+        return KV_ERROR_TOOMANYKEYS;
+    live = livebytes+size-(found ? table[slot].size : 0);
+    if( live > CAPACITY )
+        return KV_ERROR_FULL;
+    Build(queue+offset,key,keylen,value,n,0);
+    QueuePush(offset,size);
+    return Update(queue+offset,QUEUED|offset,size);
+}
+
+/**
+ * @brief  KV_Delete
+ */
+int
+KV_Delete( const char *key ) {
+uint32_t keylen, size, slot;
+int offset;
+
+    if( !mounted )
+        return KV_ERROR_NOTMOUNTED;
+    if( !key || (keylen = strlen(key)) == 0 || keylen > KV_KEYMAX )
+        return KV_ERROR_PARAMETER;
+    size = RECORDSIZE(keylen,0);
+    offset = QueueWait(size);
+    if( offset < 0 )
+        return offset;
+    if( !Find(key,keylen,Hash(key,keylen),&slot) || table[slot].size == 0 )
+        return KV_ERROR_NOTFOUND;
+    Build(queue+offset,key,keylen,0,0,RECORD_DELETED);
+    QueuePush(offset,size);
+    return Update(queue+offset,QUEUED|offset,size);
+}
+
+/**
+ * @brief  KV_Process
+ *
+ * @note   Does one step: a compaction step (copy of a record or erase of the
+ *         victim) or the programming of a queued record. A subsector erase
+ *         blocks for tens of ms
+ */
+int
+KV_Process( void ) {
+
+    if( !mounted )
+        return KV_ERROR_NOTMOUNTED;
+    if( victim < 0 && erasedblocks < MINERASED )
+        StartCompaction();
+    if( victim >= 0 )
+        return CompactStep();
+    if( qcount )
+        return ProgramQueued();
+    return KV_OK;
+}
+
+/**
+ * @brief  KV_Sync
+ *
+ * @note   Programs all queued records
+ */
+int
+KV_Sync( void ) {
+int rc;
+
+    if( !mounted )
+        return KV_ERROR_NOTMOUNTED;
+    while( qcount || victim >= 0 ) {
+        rc = KV_Process();
+        if( rc < 0 )
+            return rc;
+    }
+    return KV_OK;
+}
+
+/**
+ * @brief  KV_GetStats
+ */
+void
+KV_GetStats( KV_Stats *stats ) {
+
+    stats->keys         = keys;
+    stats->livebytes    = livebytes;
+    stats->capacity     = CAPACITY;
+    stats->erasedblocks = erasedblocks;
+    stats->pending      = qcount;
+    stats->erases       = erases;
+    stats->compactions  = compactions;
+}
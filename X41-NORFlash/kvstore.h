@@ -0,0 +1,104 @@
+#ifndef KVSTORE_H
+#define KVSTORE_H
+/**
+ * @file    kvstore.h
+ *
+ * @note    Log structured key/value store in the QSPI flash (qspi.c)
+ *
+ * @note    The store is an area of KV_BLOCKS subsectors (4 KB). Records (key,
+ *          value) are only appended, so an update never erases: the new record
+ *          makes the old one dead. When few blocks are erased, the oldest block
+ *          is compacted: its live records are appended again and it is erased.
+ *          The blocks are used in turn, so the erases are spread over all of
+ *          them (wear leveling)
+ *
+ * @note    A RAM index (hash table) built by KV_Mount gives the address of the
+ *          last record of each key, so KV_Get reads the value directly
+ *
+ * @note    KV_Set and KV_Delete only copy the record to a RAM queue and update
+ *          the index. KV_Process, called in the main loop, programs the queued
+ *          records and does the compaction and erase steps. KV_Sync waits until
+ *          everything is in the flash. KV_Set blocks only when the queue is full
+ *
+ * @note    A record is programmed with its first byte erased and this byte is
+ *          programmed last (commit). Records without commit or with a bad CRC
+ *          are ignored at mount, so a power failure loses at most the records
+ *          not yet committed and never corrupts the older ones
+ *
+ * @note    Keys are strings of up to KV_KEYMAX characters. Values have up to
+ *          KV_VALUEMAX bytes
+ *
+ * @note    The functions must not be called from interrupts
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Configuration
+ *
+ * @note    KV_ADDRESS is an offset in the QSPI flash, aligned to a subsector.
+ *          The default area is the 64 KB before the last sector
+ */
+///@{
+#ifndef KV_ADDRESS
+#define KV_ADDRESS                      (QSPI_SIZE-2*QSPI_SECTORSIZE)
+#endif
+#ifndef KV_BLOCKS
+#define KV_BLOCKS                       16
+#endif
+#ifndef KV_MAXKEYS
+#define KV_MAXKEYS                      128     // power of 2
+#endif
+#ifndef KV_KEYMAX
+#define KV_KEYMAX                       32
+#endif
+#ifndef KV_VALUEMAX
+#define KV_VALUEMAX                     256
+#endif
+#ifndef KV_QUEUESIZE
+#define KV_QUEUESIZE                    4096    // bytes of queued records
+#endif
+#ifndef KV_QUEUEMAX
+#define KV_QUEUEMAX                     32      // queued records
+#endif
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define KV_OK                           0
+#define KV_ERROR_NOTFOUND               -1
+#define KV_ERROR_FULL                   -2      // no space for the live data
+#define KV_ERROR_PARAMETER              -3
+#define KV_ERROR_IO                     -4      // QSPI error
+#define KV_ERROR_NOTMOUNTED             -5
+#define KV_ERROR_TOOMANYKEYS            -6
+///@}
+
+/**
+ * @brief   Counters
+ */
+typedef struct {
+    uint32_t    keys;
+    uint32_t    livebytes;              // records of the current values
+    uint32_t    capacity;               // maximal livebytes
+    uint32_t    erasedblocks;
+    uint32_t    pending;                // queued records
+    uint32_t    erases;                 // since KV_Mount
+    uint32_t    compactions;            // since KV_Mount
+} KV_Stats;
+
+int  KV_Mount(void);
+int  KV_Format(void);
+int  KV_Get(const char *key, void *value, uint32_t size);
+int  KV_Set(const char *key, const void *value, uint32_t n);
+int  KV_Delete(const char *key);
+int  KV_Process(void);
+int  KV_Sync(void);
+void KV_GetStats(KV_Stats *stats);
+
+#endif // KVSTORE_H
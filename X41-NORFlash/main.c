@@ -1,28 +1,39 @@
 /**
  * @file     main.c
- * @brief    Blink LEDs using counting delays and CMSIS (Heavy use of macros)
+ * @brief    QSPI NOR flash: identification, memory mapped mode and benchmark
  * @version  V1.0
  * @date     06/10/2020
  *
- * @note     The blinking frequency depends on core frequency
- * @note     Direct access to registers
- * @note     No library used
+ * @note     A table and a function are linked in the QSPI flash (make
+ *           flash-qspi writes them) and used in place. The startup code has
+ *           mapped the flash before main (QSPI_StartupInit)
+ * @note     The read benchmark reads BENCH_MB MB in memory mapped mode and
+ *           with indirect DMA reads, and computes its CRC-32 in place
+ * @note     The write benchmark (QSPI_WRITETEST) erases the last sector of the
+ *           QSPI flash, programs it and reads it back
+ * @note     The key/value store keeps a boot counter and measures KV_Set and
+ *           KV_Get (in cycles) and KV_Sync
  *
  *
  ******************************************************************************/
 
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "stm32f746xx.h"
 #include "system_stm32f746.h"
 #include "led.h"
+#include "qspi.h"
+#include "kvstore.h"
+#include "crc.h"
 
 
 
 
 static volatile uint32_t tick_ms = 0;
 static volatile uint32_t delay_ms = 0;
+static volatile uint32_t time_ms = 0;
 static int led_initialized = 0;
 
 #define INTERVAL 500
@@ -41,6 +52,8 @@ void SysTick_Handler(void) {
 
     if( delay_ms > 0 ) delay_ms--;
 
+    time_ms++;
+    QSPI_Tick();
 }
 
 void Delay(uint32_t delay) {
@@ -50,14 +63,194 @@ void Delay(uint32_t delay) {
 
 }
 
+/**
+ * @brief   Benchmark parameters
+ */
+///@{
+#define BENCH_MB            4
+#define BENCH_CHUNK         32768
+///@}
+
+static uint8_t buffer[BENCH_CHUNK] __attribute__((aligned(32)));
+
+/**
+ * @brief   Table read in place in the QSPI flash
+ */
+static const uint32_t qspitable[256] QSPI_CONST = {
+#define R4(N)   (N)*2654435761U,((N)+1)*2654435761U,((N)+2)*2654435761U,((N)+3)*2654435761U
+#define R16(N)  R4(N),R4((N)+4),R4((N)+8),R4((N)+12)
+#define R64(N)  R16(N),R16((N)+16),R16((N)+32),R16((N)+48)
+    R64(0), R64(64), R64(128), R64(192)
+};
+
+/**
+ * @brief   Function executed in place in the QSPI flash
+ */
+static uint32_t QSPI_CODE Checksum(const uint32_t *p, uint32_t n) {
+uint32_t sum = 0;
+
+    while( n-- )
+        sum = (sum<<1|sum>>31)^*p++;
+    return sum;
+}
+
+/**
+ * @brief   Same function in the internal flash, to check the result
+ */
+static uint32_t ChecksumInternal(const uint32_t *p, uint32_t n) {
+uint32_t sum = 0;
+
+    while( n-- )
+        sum = (sum<<1|sum>>31)^*p++;
+    return sum;
+}
+
+/**
+ * @brief   Print a rate in MB/s
+ */
+static void PrintRate(const char *name, uint32_t bytes, uint32_t ms) {
+uint32_t kbs;
+
+    if( ms == 0 )
+        ms = 1;
+    kbs = (uint32_t) ((uint64_t) bytes*1000/1024/ms);
+    printf("%s: %u bytes in %u ms = %u.%02u MB/s\n",name,(unsigned) bytes,(unsigned) ms,
+            (unsigned) (kbs/1024),(unsigned) (kbs%1024*100/1024));
+}
+
+/**
+ * @brief   Read BENCH_MB MB in memory mapped mode and with QSPI_Read
+ *
+ * @note    In memory mapped mode, the words are summed in place, so each cache
+ *          line fill is a read of the flash
+ */
+static void Bench(void) {
+const volatile uint32_t *p;
+uint32_t start, i, a, sum = 0;
+int rc = QSPI_OK;
+
+    QSPI_EnableMemoryMapped();
+    p = (const volatile uint32_t *) QSPI_ADDRESS;
+    start = time_ms;
+    for(i=0;i<BENCH_MB*1024*1024/4;i++)
+        sum += p[i];
+    PrintRate("Memory mapped read",BENCH_MB*1024*1024,time_ms-start);
+
+    QSPI_DisableMemoryMapped();
+    start = time_ms;
+    for(a=0;a<BENCH_MB*1024*1024&&rc==QSPI_OK;a+=BENCH_CHUNK)
+        rc = QSPI_Read(a,buffer,BENCH_CHUNK);
+    if( rc < 0 )
+        printf("QSPI_Read error %d\n",rc);
+    else
+        PrintRate("DMA read",BENCH_MB*1024*1024,time_ms-start);
+    QSPI_EnableMemoryMapped();
+
+    start = time_ms;
+    sum = CRC32_Update(0,(const void *) QSPI_ADDRESS,BENCH_MB*1024*1024);
+    PrintRate("CRC-32 in place",BENCH_MB*1024*1024,time_ms-start);
+    printf("CRC-32 %08X\n",(unsigned) sum);
+}
+
+#ifdef QSPI_WRITETEST
+/**
+ * @brief   Erase, program and read back the last sector
+ */
+static int WriteBench(void) {
+uint32_t address = QSPI_SIZE-QSPI_SECTORSIZE;
+uint32_t start, i, j;
+uint32_t *w = (uint32_t *) buffer;
+int rc;
+
+    start = time_ms;
+    rc = QSPI_EraseSector(address);
+    if( rc < 0 ) {
+        printf("QSPI_EraseSector error %d\n",rc);
+        return rc;
+    }
+    printf("Sector erase: %u ms\n",(unsigned) (time_ms-start));
+
+    start = time_ms;
+    for(i=0;i<QSPI_SECTORSIZE;i+=BENCH_CHUNK) {
+        for(j=0;j<BENCH_CHUNK/4;j++)
+            w[j] = address+i+j*4;
+        rc = QSPI_Write(address+i,buffer,BENCH_CHUNK);
+        if( rc < 0 ) {
+            printf("QSPI_Write error %d\n",rc);
+            return rc;
+        }
+    }
+    PrintRate("Program",QSPI_SECTORSIZE,time_ms-start);
+
+    // Read back in memory mapped mode
+    w = (uint32_t *) (QSPI_ADDRESS+address);
+    for(j=0;j<QSPI_SECTORSIZE/4;j++) {
+        if( w[j] != address+j*4 ) {
+            printf("Mismatch at %08X\n",(unsigned) (address+j*4));
+            return QSPI_ERROR_PROGRAM;
+        }
+    }
+    printf("Verify OK\n");
+    return QSPI_OK;
+}
+#endif
+
+/**
+ * @brief   Key/value store: boot counter and timing
+ */
+#define KV_SETS             16
+
+static void KVDemo(void) {
+uint32_t boots = 0, start, cycles, i;
+KV_Stats stats;
+int rc;
+
+    rc = KV_Mount();
+    if( rc < 0 ) {
+        printf("KV_Mount error %d, formatting\n",rc);
+        rc = KV_Format();
+        if( rc < 0 ) {
+            printf("KV_Format error %d\n",rc);
+            return;
+        }
+    }
+    KV_Get("boots",&boots,sizeof(boots));
+    boots++;
+    KV_Set("boots",&boots,sizeof(boots));
+    printf("Boot %u\n",(unsigned) boots);
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    start = DWT->CYCCNT;
+    for(i=0;i<KV_SETS;i++)
+        KV_Set("counter",&i,sizeof(i));
+    cycles = DWT->CYCCNT-start;
+    printf("KV_Set: %u cycles\n",(unsigned) (cycles/KV_SETS));
+    start = DWT->CYCCNT;
+    KV_Get("boots",&boots,sizeof(boots));
+    printf("KV_Get: %u cycles\n",(unsigned) (DWT->CYCCNT-start));
+
+    start = time_ms;
+    rc = KV_Sync();
+    if( rc < 0 )
+        printf("KV_Sync error %d\n",rc);
+    else
+        printf("KV_Sync: %u ms\n",(unsigned) (time_ms-start));
+    KV_GetStats(&stats);
+    printf("%u keys, %u/%u bytes, %u erased blocks, %u erases\n",
+            (unsigned) stats.keys,(unsigned) stats.livebytes,(unsigned) stats.capacity,
+            (unsigned) stats.erasedblocks,(unsigned) stats.erases);
+}
 
 /**
  * @brief   main
  *
- * @note    Initializes GPIO and blinks LED
+ * @note    Checks the QSPI flash, uses its code and constants and runs the
+ *          benchmarks
  */
 
 int main(void) {
+uint8_t id[3];
 
     /* Set Clock to 200 MHz */
     SystemConfigMainPLL(&MainPLLConfiguration_200MHz);
@@ -70,9 +263,29 @@ int main(void) {
 
     SystemConfigPLLSAI(&PLLSAIConfiguration_48MHz);
 
+    if( !QSPI_IsMemoryMapped() ) {
+        printf("QSPI flash not initialized\n");
+        for(;;) {}
+    }
+    if( CRC_Init() != CRC_OK )
+        printf("CRC unit self test failed, CRC in software\n");
+
+    QSPI_ReadID(id);
+    printf("QSPI flash ID %02X %02X %02X\n",id[0],id[1],id[2]);
+
+    printf("Checksum in place %08X, internal %08X\n",
+            (unsigned) Checksum(qspitable,256),(unsigned) ChecksumInternal(qspitable,256));
+
+    Bench();
+#ifdef QSPI_WRITETEST
+    WriteBench();
+#endif
+    KVDemo();
 
     /*
      * Blink LED
      */
-    for (;;) {}
+    for (;;) {
+        KV_Process();
+    }
 }
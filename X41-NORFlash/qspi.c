@@ -0,0 +1,811 @@
+/**
+ * @file    qspi.c
+ *
+ * @note    QUADSPI driver for the N25Q128A NOR flash (see qspi.h)
+ *
+ * @note    Pins of the STM32F746 Discovery board
+ *
+ *          | Signal | Pin  | AF |
+ *          |--------|------|----|
+ *          | CLK    | PB2  |  9 |
+ *          | NCS    | PB6  | 10 |
+ *          | IO0    | PD11 |  9 |
+ *          | IO1    | PD12 |  9 |
+ *          | IO2    | PE2  |  9 |
+ *          | IO3    | PD13 |  9 |
+ *
+ * @note    The QUADSPI kernel clock is HCLK (200 MHz). PRESCALER=1 gives
+ *          100 MHz, below the 108 MHz of the flash. The fast read commands
+ *          need 10 dummy cycles at this frequency, and they are set in the
+ *          volatile configuration register by QSPI_Init
+ *
+ * @note    In memory mapped mode, the QUADSPI sends EBh with the address of
+ *          each cache line fetch and goes on reading while addresses are
+ *          sequential: 4 bits per clock, i.e. 50 MB/s minus the command
+ *          overhead
+ *
+ * @note    DMA2 Stream 7 channel 3 moves the data between memory and the
+ *          QUADSPI FIFO, with words when buffer and size are word aligned.
+ *          DMA cannot read the ITCM: constants linked at 0x00200000 (ITCM flash)
+ *          are read thru the AXIM alias at 0x08000000, and the ITCM RAM is
+ *          copied by the CPU. Short transfers are done by the CPU. The stream
+ *          is reserved in the allocator of dma.c, but not driven by it
+ *
+ * @note    Cache_Init must be called before QSPI_Init (see qspi.h)
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <string.h>
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "gpio.h"
+#include "cache.h"
+#include "dma.h"
+#include "qspi.h"
+
+/**
+ * @brief   Commands
+ */
+///@{
+#define CMD_RESET_ENABLE                0x66
+#define CMD_RESET_MEMORY                0x99
+#define CMD_READ_ID                     0x9F
+#define CMD_READ_STATUS                 0x05
+#define CMD_READ_FLAG_STATUS            0x70
+#define CMD_CLEAR_FLAG_STATUS           0x50
+#define CMD_READ_VOLATILE_CONFIG        0x85
+#define CMD_WRITE_VOLATILE_CONFIG       0x81
+#define CMD_WRITE_ENABLE                0x06
+#define CMD_QUAD_IO_FAST_READ           0xEB
+#define CMD_QUAD_INPUT_FAST_PROGRAM     0x32
+#define CMD_SUBSECTOR_ERASE             0x20
+#define CMD_SECTOR_ERASE                0xD8
+#define CMD_BULK_ERASE                  0xC7
+///@}
+
+/**
+ * @brief   Register bits of the flash
+ */
+///@{
+#define STATUS_WIP                      0x01    // write in progress
+#define STATUS_WEL                      0x02    // write enable latch
+#define FLAG_READY                      0x80
+#define FLAG_ERASE                      0x20
+#define FLAG_PROGRAM                    0x10
+#define FLAG_PROTECTION                 0x02
+#define VCR_XIPOFF                      0x08
+#define VCR_WRAP                        0x07
+#define VCR_DUMMY_Pos                   4
+///@}
+
+/**
+ * @brief   ID of the N25Q128A (manufacturer, type, capacity)
+ */
+///@{
+#define ID_MICRON                       0x20
+#define ID_CAPACITY_16MB                0x18
+///@}
+
+/**
+ * @brief   Timing
+ */
+///@{
+#define PRESCALER                       1       // 100 MHz
+#define CSHIGHTIME                      5       // 6 cycles (60 ns > tSHSL 50 ns)
+#define FSIZE                           23      // 2^(23+1) bytes
+#define DUMMYCYCLES                     10
+///@}
+
+/**
+ * @brief   Timeouts in ms (maximal times of the data sheet plus a margin)
+ */
+///@{
+#define TIMEOUT_TRANSFER                100
+#define TIMEOUT_PROGRAM                 10      // 5 ms
+#define TIMEOUT_SUBSECTOR               1000    // 0.8 s
+#define TIMEOUT_SECTOR                  3500    // 3 s
+#define TIMEOUT_CHIP                    260000  // 250 s
+///@}
+
+/**
+ * @brief   Fields of CCR
+ */
+///@{
+#define LINES_NONE                      0
+#define LINES_1                         1
+#define LINES_4                         3
+#define FMODE_WRITE                     0
+#define FMODE_READ                      1
+#define FMODE_POLL                      2
+#define FMODE_MAPPED                    3
+#define CCR(INS,IL,AL,DCYC,DL)          ((INS)<<QUADSPI_CCR_INSTRUCTION_Pos\
+                                        |(IL)<<QUADSPI_CCR_IMODE_Pos\
+                                        |(AL)<<QUADSPI_CCR_ADMODE_Pos\
+                                        |((AL)?2U:0U)<<QUADSPI_CCR_ADSIZE_Pos\
+                                        |(DCYC)<<QUADSPI_CCR_DCYC_Pos\
+                                        |(DL)<<QUADSPI_CCR_DMODE_Pos)
+#define CCR_COMMAND(INS)                CCR(INS,LINES_1,LINES_NONE,0,LINES_NONE)
+#define CCR_REGISTER(INS)               CCR(INS,LINES_1,LINES_NONE,0,LINES_1)
+#define CCR_ERASE(INS)                  CCR(INS,LINES_1,LINES_1,0,LINES_NONE)
+#define CCR_READ                        CCR(CMD_QUAD_IO_FAST_READ,LINES_1,LINES_4,\
+                                            DUMMYCYCLES,LINES_4)
+#define CCR_PROGRAM                     CCR(CMD_QUAD_INPUT_FAST_PROGRAM,LINES_1,\
+                                            LINES_1,0,LINES_4)
+///@}
+
+/**
+ * @brief   DMA configuration (DMA2 Stream 7, channel 3)
+ */
+///@{
+#define DMASTREAM                       DMA2_Stream7
+#define DMACHANNEL                      3
+#define DMAIFCR                         (DMA2->HIFCR)
+#define DMAISR                          (DMA2->HISR)
+#define DMAFLAGS                        (0x3DU<<22)
+#define DMA_TC                          (1U<<27)
+#define DMA_ERRORS                      ((1U<<25)|(1U<<24))
+#define DMAMIN                          32      // smaller with the CPU
+#define DMAMAX                          65532   // bytes per transfer
+///@}
+
+/**
+ * @brief   Pins
+ */
+static const GPIO_PinConfiguration qspipins[] = {
+    /*  gpio, pin, af, mode, otype, ospeed, pupd, initial */
+    { GPIOB,  2,   9,    2,     0,      3,    0,       0 },     // CLK
+    { GPIOB,  6,  10,    2,     0,      3,    1,       0 },     // NCS
+    { GPIOD, 11,   9,    2,     0,      3,    0,       0 },     // IO0
+    { GPIOD, 12,   9,    2,     0,      3,    0,       0 },     // IO1
+    { GPIOE,  2,   9,    2,     0,      3,    0,       0 },     // IO2
+    { GPIOD, 13,   9,    2,     0,      3,    0,       0 },     // IO3
+    { 0,      0,   0,    0,     0,      0,    0,       0 }
+};
+
+/**
+ * @brief   Driver state
+ */
+///@{
+static int                  initialized = 0;
+static int                  mapped = 0;     // memory mapped mode requested
+static volatile uint32_t    now = 0;        // ms
+static int                  dmareserved = 0;
+static int                  pending = 0;    // error code of the operation started
+static uint32_t             pendingaddress;
+static uint32_t             pendingsize;
+static uint32_t             pendingstart;
+static uint32_t             pendingms;
+///@}
+
+/**
+ * @brief  Wait for a flag of SR
+ */
+static int WaitFlag( uint32_t flag, uint32_t ms ) {
+uint32_t start = now;
+
+    while( (QUADSPI->SR&flag) == 0 ) {
+        if( QUADSPI->SR&QUADSPI_SR_TEF )
+            return QSPI_ERROR_TRANSFER;
+        if( now-start > ms )
+            return QSPI_ERROR_TIMEOUT;
+    }
+    return QSPI_OK;
+}
+
+/**
+ * @brief  Stop the current command (also ends memory mapped mode)
+ */
+static void Abort( void ) {
+
+    QUADSPI->CR |= QUADSPI_CR_ABORT;
+    while( QUADSPI->CR&QUADSPI_CR_ABORT ) {}
+    DMASTREAM->CR &= ~DMA_SxCR_EN;
+    while( DMASTREAM->CR&DMA_SxCR_EN ) {}
+    DMAIFCR = DMAFLAGS;
+    QUADSPI->CR &= ~QUADSPI_CR_DMAEN;
+    QUADSPI->FCR = QUADSPI_FCR_CTEF|QUADSPI_FCR_CTCF|QUADSPI_FCR_CSMF|QUADSPI_FCR_CTOF;
+}
+
+/**
+ * @brief  Address of a buffer for the DMA, 0 when it cannot access it
+ */
+static uint32_t DMAAddress( const void *p ) {
+uint32_t a = (uint32_t) p;
+
+    if( a >= 0x00200000 && a < 0x00300000 )        // ITCM flash
+        return a-0x00200000+0x08000000;
+    if( a < 0x00200000 )                            // ITCM RAM
+        return 0;
+    if( a >= QSPI_ADDRESS && a < QSPI_ADDRESS+QSPI_SIZE )
+        return 0;
+    return a;
+}
+
+/**
+ * @brief  Start the DMA stream between a buffer and the QUADSPI FIFO
+ *
+ * @note   dir is 0 for reads (peripheral to memory) and 1 for writes. size is
+ *         0 for bytes and 2 for words
+ */
+static void StartStream( uint32_t a, uint32_t n, uint32_t dir, uint32_t size ) {
+
+    DMASTREAM->CR &= ~DMA_SxCR_EN;
+    while( DMASTREAM->CR&DMA_SxCR_EN ) {}
+    DMAIFCR = DMAFLAGS;
+    DMASTREAM->PAR  = (uint32_t) &(QUADSPI->DR);
+    DMASTREAM->M0AR = a;
+    DMASTREAM->NDTR = n>>size;
+    DMASTREAM->FCR  = 0;                    // direct mode
+    DMASTREAM->CR   = (DMACHANNEL<<DMA_SxCR_CHSEL_Pos)
+                     |(2<<DMA_SxCR_PL_Pos)
+                     |(dir<<DMA_SxCR_DIR_Pos)
+                     |(size<<DMA_SxCR_MSIZE_Pos)
+                     |(size<<DMA_SxCR_PSIZE_Pos)
+                     |DMA_SxCR_MINC;
+    DMASTREAM->CR  |= DMA_SxCR_EN;
+}
+
+/**
+ * @brief  Send a command in indirect mode
+ *
+ * @note   ccr gives the instruction and the phases. The n bytes of data are
+ *         read (fmode FMODE_READ) or written (FMODE_WRITE)
+ */
+static int Transfer( uint32_t ccr, uint32_t fmode, uint32_t address,
+                     uint8_t *data, uint32_t n ) {
+volatile uint8_t *dr = (volatile uint8_t *) &(QUADSPI->DR);
+uint32_t a = 0, size = 0, i, start;
+int rc;
+
+    while( QUADSPI->SR&QUADSPI_SR_BUSY ) {}
+    QUADSPI->FCR = QUADSPI_FCR_CTEF|QUADSPI_FCR_CTCF|QUADSPI_FCR_CSMF|QUADSPI_FCR_CTOF;
+
+    if( n >= DMAMIN )
+        a = DMAAddress(data);
+    if( a ) {
+        if( ((a|n)&3) == 0 )
+            size = 2;
+        if( fmode == FMODE_WRITE )
+            Cache_CleanRange(data,n);
+        else
+            Cache_CleanInvalidateRange(data,n);
+        QUADSPI->CR = (QUADSPI->CR&~QUADSPI_CR_FTHRES)
+                     |((size?3U:0U)<<QUADSPI_CR_FTHRES_Pos)
+                     |QUADSPI_CR_DMAEN;
+        StartStream(a,n,fmode==FMODE_WRITE,size);
+    } else {
+        QUADSPI->CR &= ~(QUADSPI_CR_FTHRES|QUADSPI_CR_DMAEN);
+    }
+
+    if( n )
+        QUADSPI->DLR = n-1;
+    QUADSPI->CCR = ccr|fmode<<QUADSPI_CCR_FMODE_Pos;
+    if( ccr&QUADSPI_CCR_ADMODE )
+        QUADSPI->AR = address;
+
+    rc = QSPI_OK;
+    start = now;
+    if( a ) {
+        while( (DMAISR&(DMA_TC|DMA_ERRORS)) == 0 && rc == QSPI_OK ) {
+            if( QUADSPI->SR&QUADSPI_SR_TEF )
+                rc = QSPI_ERROR_TRANSFER;
+            else if( now-start > TIMEOUT_TRANSFER )
+                rc = QSPI_ERROR_TIMEOUT;
+        }
+        if( DMAISR&DMA_ERRORS )
+            rc = QSPI_ERROR_TRANSFER;
+    } else {
+        for(i=0;i<n&&rc==QSPI_OK;i++) {
+            if( fmode == FMODE_WRITE ) {
+                while( (QUADSPI->SR&QUADSPI_SR_FTF) == 0 && now-start <= TIMEOUT_TRANSFER ) {}
+            } else {
+                while( (QUADSPI->SR&QUADSPI_SR_FLEVEL) == 0 && now-start <= TIMEOUT_TRANSFER ) {}
+            }
+            if( now-start > TIMEOUT_TRANSFER )
+                rc = QSPI_ERROR_TIMEOUT;
+            else if( fmode == FMODE_WRITE )
+                *dr = data[i];
+            else
+                data[i] = *dr;
+        }
+    }
+    if( rc == QSPI_OK )
+        rc = WaitFlag(QUADSPI_SR_TCF,TIMEOUT_TRANSFER);
+    if( rc < 0 ) {
+        Abort();
+        return rc;
+    }
+    QUADSPI->FCR = QUADSPI_FCR_CTCF;
+    if( a ) {
+        QUADSPI->CR &= ~QUADSPI_CR_DMAEN;
+        if( fmode == FMODE_READ )
+            Cache_InvalidateRange(data,n);
+    }
+    return QSPI_OK;
+}
+
+/**
+ * @brief  Send a command without address nor data
+ */
+static int Command( uint32_t cmd ) {
+
+    return Transfer(CCR_COMMAND(cmd),FMODE_WRITE,0,0,0);
+}
+
+/**
+ * @brief  Read a register of the flash until (reg&mask) == match
+ *
+ * @note   Uses the automatic polling mode of the QUADSPI
+ */
+static int Poll( uint32_t cmd, uint32_t mask, uint32_t match, uint32_t ms ) {
+int rc;
+
+    while( QUADSPI->SR&QUADSPI_SR_BUSY ) {}
+    QUADSPI->FCR  = QUADSPI_FCR_CTEF|QUADSPI_FCR_CTCF|QUADSPI_FCR_CSMF|QUADSPI_FCR_CTOF;
+    QUADSPI->CR   = (QUADSPI->CR&~QUADSPI_CR_DMAEN)|QUADSPI_CR_APMS;
+    QUADSPI->PSMKR = mask;
+    QUADSPI->PSMAR = match;
+    QUADSPI->PIR  = 16;                     // cycles between reads
+    QUADSPI->DLR  = 0;
+    QUADSPI->CCR  = CCR_REGISTER(cmd)|FMODE_POLL<<QUADSPI_CCR_FMODE_Pos;
+    rc = WaitFlag(QUADSPI_SR_SMF,ms);
+    if( rc < 0 ) {
+        Abort();
+        return rc;
+    }
+    QUADSPI->FCR = QUADSPI_FCR_CSMF;
+    return QSPI_OK;
+}
+
+/**
+ * @brief  Set the write enable latch
+ */
+static int WriteEnable( void ) {
+int rc;
+
+    rc = Command(CMD_WRITE_ENABLE);
+    if( rc == QSPI_OK )
+        rc = Poll(CMD_READ_STATUS,STATUS_WEL,STATUS_WEL,TIMEOUT_TRANSFER);
+    return rc;
+}
+
+/**
+ * @brief  Check the result of a finished program or erase
+ */
+static int CheckFlags( int error ) {
+uint8_t flags;
+int rc;
+
+    rc = Transfer(CCR_REGISTER(CMD_READ_FLAG_STATUS),FMODE_READ,0,&flags,1);
+    if( rc < 0 )
+        return rc;
+    if( (flags&(FLAG_ERASE|FLAG_PROGRAM|FLAG_PROTECTION)) == 0 )
+        return QSPI_OK;
+    Command(CMD_CLEAR_FLAG_STATUS);
+    return (flags&FLAG_PROTECTION) ? QSPI_ERROR_PROTECTED : error;
+}
+
+/**
+ * @brief  Wait for the end of a program or erase and check its result
+ */
+static int WaitReady( uint32_t ms, int error ) {
+int rc;
+
+    rc = Poll(CMD_READ_STATUS,STATUS_WIP,0,ms);
+    if( rc < 0 )
+        return rc;
+    return CheckFlags(error);
+}
+
+/**
+ * @brief  Enter memory mapped mode (QUADSPI not busy)
+ */
+static void EnterMemoryMapped( void ) {
+
+    while( QUADSPI->SR&QUADSPI_SR_BUSY ) {}
+    QUADSPI->CR &= ~(QUADSPI_CR_DMAEN|QUADSPI_CR_TCEN);
+    QUADSPI->CCR = CCR_READ|FMODE_MAPPED<<QUADSPI_CCR_FMODE_Pos;
+    Cache_SetRegion(QSPI_MPUREGION+1,QSPI_ADDRESS,QSPI_SIZE,CACHE_WRITETHROUGH);
+    __DSB();
+    __ISB();
+}
+
+/**
+ * @brief  Leave memory mapped mode before an indirect command
+ */
+static void LeaveMemoryMapped( void ) {
+
+    if( !mapped )
+        return;
+    Cache_DisableRegion(QSPI_MPUREGION+1);
+    __DSB();
+    __ISB();
+    Abort();
+}
+
+/**
+ * @brief  Back to memory mapped mode after a change of the flash contents
+ *
+ * @note   The cached lines of the changed area are discarded (n=0 for all)
+ */
+static void Restore( uint32_t address, uint32_t n ) {
+
+    if( n )
+        Cache_InvalidateRange((void *) (QSPI_ADDRESS+address),n);
+    else
+        SCB_CleanInvalidateDCache();
+    SCB_InvalidateICache();
+    if( mapped )
+        EnterMemoryMapped();
+}
+
+/**
+ * @brief  QSPI_Init
+ *
+ * @note   Resets the flash, checks its ID and sets the dummy cycles. The flash
+ *         is left in indirect mode
+ */
+int
+QSPI_Init( void ) {
+uint8_t id[3];
+uint8_t vcr;
+int rc;
+
+    initialized = 0;
+    mapped = 0;
+    pending = 0;
+
+    // The QSPI area is a device until memory mapped mode
+    Cache_SetRegion(QSPI_MPUREGION,QSPI_ADDRESS,0x10000000,CACHE_DEVICE|CACHE_XN);
+    Cache_DisableRegion(QSPI_MPUREGION+1);
+    __DSB();
+    __ISB();
+
+    GPIO_ConfigureMultiplePins(qspipins);
+
+    RCC->AHB3ENR |= RCC_AHB3ENR_QSPIEN;
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+    __DSB();
+
+    // The stream is programmed here, so dma.c must not give it to others
+    if( !dmareserved && DMA_Allocate(DMA_REQ_QUADSPI) >= 0 )
+        dmareserved = 1;
+
+    RCC->AHB3RSTR |= RCC_AHB3RSTR_QSPIRST;
+    RCC->AHB3RSTR &= ~RCC_AHB3RSTR_QSPIRST;
+
+    QUADSPI->CR  = (PRESCALER<<QUADSPI_CR_PRESCALER_Pos)|QUADSPI_CR_SSHIFT;
+    QUADSPI->DCR = (FSIZE<<QUADSPI_DCR_FSIZE_Pos)|(CSHIGHTIME<<QUADSPI_DCR_CSHT_Pos);
+    QUADSPI->CR |= QUADSPI_CR_EN;
+
+    // A reset ends an operation or a mode left by a previous program
+    rc = Command(CMD_RESET_ENABLE);
+    if( rc == QSPI_OK )
+        rc = Command(CMD_RESET_MEMORY);
+    if( rc == QSPI_OK )
+        rc = Poll(CMD_READ_STATUS,STATUS_WIP,0,TIMEOUT_TRANSFER);
+    if( rc < 0 )
+        return rc;
+
+    rc = Transfer(CCR_REGISTER(CMD_READ_ID),FMODE_READ,0,id,3);
+    if( rc < 0 )
+        return rc;
+    if( id[0] != ID_MICRON || id[2] != ID_CAPACITY_16MB )
+        return QSPI_ERROR_ID;
+
+    rc = Transfer(CCR_REGISTER(CMD_READ_VOLATILE_CONFIG),FMODE_READ,0,&vcr,1);
+    if( rc < 0 )
+        return rc;
+    vcr = (vcr&VCR_WRAP)|VCR_XIPOFF|(DUMMYCYCLES<<VCR_DUMMY_Pos);
+    rc = WriteEnable();
+    if( rc == QSPI_OK )
+        rc = Transfer(CCR_REGISTER(CMD_WRITE_VOLATILE_CONFIG),FMODE_WRITE,0,&vcr,1);
+    if( rc == QSPI_OK )
+        rc = Poll(CMD_READ_STATUS,STATUS_WIP,0,TIMEOUT_TRANSFER);
+    if( rc < 0 )
+        return rc;
+
+    initialized = 1;
+    return QSPI_OK;
+}
+
+/**
+ * @brief  QSPI_ReadID
+ *
+ * @note   Manufacturer (20h), memory type (BAh) and capacity (18h)
+ */
+int
+QSPI_ReadID( uint8_t id[3] ) {
+int rc;
+
+    if( !initialized )
+        return QSPI_ERROR_NOTINITIALIZED;
+    QSPI_Wait();
+    LeaveMemoryMapped();
+    rc = Transfer(CCR_REGISTER(CMD_READ_ID),FMODE_READ,0,id,3);
+    if( mapped )
+        EnterMemoryMapped();
+    return rc;
+}
+
+/**
+ * @brief  QSPI_Read
+ *
+ * @note   In memory mapped mode, it is a copy
+ */
+int
+QSPI_Read( uint32_t address, void *data, uint32_t n ) {
+uint8_t *p = data;
+uint32_t k;
+int rc = QSPI_OK;
+
+    if( !initialized )
+        return QSPI_ERROR_NOTINITIALIZED;
+    if( address >= QSPI_SIZE || n > QSPI_SIZE-address )
+        return QSPI_ERROR_PARAMETER;
+    QSPI_Wait();
+    if( mapped ) {
+        memcpy(data,(const void *) (QSPI_ADDRESS+address),n);
+        return QSPI_OK;
+    }
+    while( n && rc == QSPI_OK ) {
+        k = n > DMAMAX ? DMAMAX : n;
+        rc = Transfer(CCR_READ,FMODE_READ,address,p,k);
+        address += k;
+        p += k;
+        n -= k;
+    }
+    return rc;
+}
+
+/**
+ * @brief  QSPI_Write
+ *
+ * @note   Programs page by page (256 bytes). The area must be erased
+ */
+int
+QSPI_Write( uint32_t address, const void *data, uint32_t n ) {
+const uint8_t *p = data;
+uint32_t a = address, k, total = n;
+int rc = QSPI_OK;
+
+    if( !initialized )
+        return QSPI_ERROR_NOTINITIALIZED;
+    if( address >= QSPI_SIZE || n > QSPI_SIZE-address )
+        return QSPI_ERROR_PARAMETER;
+    QSPI_Wait();
+    LeaveMemoryMapped();
+    while( n && rc == QSPI_OK ) {
+        k = QSPI_PAGESIZE-a%QSPI_PAGESIZE;
+        if( k > n )
+            k = n;
+        rc = WriteEnable();
+        if( rc == QSPI_OK )
+            rc = Transfer(CCR_PROGRAM,FMODE_WRITE,a,(uint8_t *) p,k);
+        if( rc == QSPI_OK )
+            rc = WaitReady(TIMEOUT_PROGRAM,QSPI_ERROR_PROGRAM);
+        a += k;
+        p += k;
+        n -= k;
+    }
+    Restore(address,total);
+    return rc;
+}
+
+/**
+ * @brief  Start an operation that ends in the flash (program or erase)
+ *
+ * @note   The command (and the data) are sent, and the flash is left in
+ *         indirect mode until QSPI_Busy sees the end. error is the code
+ *         returned when the flash reports a failure
+ */
+static int Start( uint32_t ccr, uint32_t address, const uint8_t *data, uint32_t n,
+                  uint32_t size, uint32_t ms, int error ) {
+int rc;
+
+    QSPI_Wait();
+    LeaveMemoryMapped();
+    rc = WriteEnable();
+    if( rc == QSPI_OK )
+        rc = Transfer(ccr,FMODE_WRITE,address,(uint8_t *) data,n);
+    if( rc < 0 ) {
+        Restore(address,size);
+        return rc;
+    }
+    pending        = error;
+    pendingaddress = address;
+    pendingsize    = size;
+    pendingstart   = now;
+    pendingms      = ms;
+    return QSPI_OK;
+}
+
+/**
+ * @brief  Erase the subsector (4 KB), sector (64 KB) or whole flash
+ */
+///@{
+static int StartErase( uint32_t cmd, uint32_t address, uint32_t size, uint32_t ms ) {
+
+    if( !initialized )
+        return QSPI_ERROR_NOTINITIALIZED;
+    if( address >= QSPI_SIZE )
+        return QSPI_ERROR_PARAMETER;
+    address &= ~(size-1);
+    if( cmd == CMD_BULK_ERASE )
+        return Start(CCR_COMMAND(cmd),0,0,0,0,ms,QSPI_ERROR_ERASE);
+    return Start(CCR_ERASE(cmd),address,0,0,size,ms,QSPI_ERROR_ERASE);
+}
+
+static int Erase( uint32_t cmd, uint32_t address, uint32_t size, uint32_t ms ) {
+int rc;
+
+    rc = StartErase(cmd,address,size,ms);
+    if( rc == QSPI_OK )
+        rc = QSPI_Wait();
+    return rc;
+}
+
+int
+QSPI_EraseSubsector( uint32_t address ) {
+
+    return Erase(CMD_SUBSECTOR_ERASE,address,QSPI_SUBSECTORSIZE,TIMEOUT_SUBSECTOR);
+}
+
+int
+QSPI_EraseSector( uint32_t address ) {
+
+    return Erase(CMD_SECTOR_ERASE,address,QSPI_SECTORSIZE,TIMEOUT_SECTOR);
+}
+
+int
+QSPI_EraseChip( void ) {
+
+    return Erase(CMD_BULK_ERASE,0,QSPI_SIZE,TIMEOUT_CHIP);
+}
+///@}
+
+/**
+ * @brief  Non blocking program and erase
+ *
+ * @note   They return after sending the command. The next call to QSPI_Busy
+ *         that returns 0 or an error ends the operation and goes back to
+ *         memory mapped mode. Other functions wait for the end before
+ *         starting
+ *
+ * @note   QSPI_StartWrite programs at most a page and the bytes must not
+ *         cross its end. The data are copied to the flash before it returns
+ */
+///@{
+int
+QSPI_StartWrite( uint32_t address, const void *data, uint32_t n ) {
+
+    if( !initialized )
+        return QSPI_ERROR_NOTINITIALIZED;
+    if( address >= QSPI_SIZE || n == 0 || n > QSPI_PAGESIZE-address%QSPI_PAGESIZE )
+        return QSPI_ERROR_PARAMETER;
+    return Start(CCR_PROGRAM,address,data,n,n,TIMEOUT_PROGRAM,QSPI_ERROR_PROGRAM);
+}
+
+int
+QSPI_StartEraseSubsector( uint32_t address ) {
+
+    return StartErase(CMD_SUBSECTOR_ERASE,address,QSPI_SUBSECTORSIZE,TIMEOUT_SUBSECTOR);
+}
+
+int
+QSPI_StartEraseSector( uint32_t address ) {
+
+    return StartErase(CMD_SECTOR_ERASE,address,QSPI_SECTORSIZE,TIMEOUT_SECTOR);
+}
+
+/**
+ * @brief  QSPI_Busy
+ *
+ * @note   Returns 1 while the operation started is running, 0 when it is
+ *         finished (or none was started) and a negative value when it failed
+ *         or timed out. The result is returned once
+ */
+int
+QSPI_Busy( void ) {
+uint8_t status;
+int rc;
+
+    if( !pending )
+        return 0;
+    rc = Transfer(CCR_REGISTER(CMD_READ_STATUS),FMODE_READ,0,&status,1);
+    if( rc == QSPI_OK && (status&STATUS_WIP) ) {
+        if( now-pendingstart <= pendingms )
+            return 1;
+        rc = QSPI_ERROR_TIMEOUT;
+    }
+    if( rc == QSPI_OK )
+        rc = CheckFlags(pending);
+    pending = 0;
+    Restore(pendingaddress,pendingsize);
+    return rc;
+}
+
+/**
+ * @brief  QSPI_Wait
+ *
+ * @note   Waits for the end of the operation started and returns its result
+ */
+int
+QSPI_Wait( void ) {
+int rc;
+
+    while( (rc = QSPI_Busy()) > 0 ) {}
+    return rc;
+}
+///@}
+
+/**
+ * @brief  QSPI_EnableMemoryMapped
+ */
+int
+QSPI_EnableMemoryMapped( void ) {
+
+    if( !initialized )
+        return QSPI_ERROR_NOTINITIALIZED;
+    QSPI_Wait();
+    if( !mapped ) {
+        EnterMemoryMapped();
+        mapped = 1;
+    }
+    return QSPI_OK;
+}
+
+/**
+ * @brief  QSPI_DisableMemoryMapped
+ */
+int
+QSPI_DisableMemoryMapped( void ) {
+
+    if( !initialized )
+        return QSPI_ERROR_NOTINITIALIZED;
+    QSPI_Wait();
+    LeaveMemoryMapped();
+    mapped = 0;
+    return QSPI_OK;
+}
+
+/**
+ * @brief  QSPI_IsMemoryMapped
+ */
+int
+QSPI_IsMemoryMapped( void ) {
+
+    return mapped;
+}
+
+/**
+ * @brief  QSPI_StartupInit
+ *
+ * @note   Called by Reset_Handler after SystemInit and before main. It sets the
+ *         MPU (Cache_Init) and enters memory mapped mode. The core clock is
+ *         still HSI (16 MHz), so the flash is read at 8 MHz until main changes
+ *         it (the prescaler is kept)
+ *
+ * @note   When it fails, the flash is not mapped. main can check it with
+ *         QSPI_IsMemoryMapped
+ */
+void
+QSPI_StartupInit( void ) {
+
+    Cache_Init();
+    if( QSPI_Init() == QSPI_OK )
+        QSPI_EnableMemoryMapped();
+}
+
+/**
+ * @brief  QSPI_Tick
+ *
+ * @note   Must be called every ms
+ */
+void
+QSPI_Tick( void ) {
+
+    now++;
+}
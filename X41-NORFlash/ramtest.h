@@ -0,0 +1,73 @@
+#ifndef RAMTEST_H
+#define RAMTEST_H
+/**
+ * @file    ramtest.h
+ *
+ * @note    Memory diagnostics for the SDRAM (or any RAM area)
+ *
+ * @note    Tests
+ *
+ *          | Test        | Detects                                        |
+ *          |-------------|------------------------------------------------|
+ *          | data bus    | stuck and shorted data lines (walking 1 and 0) |
+ *          | address bus | stuck and shorted address lines                |
+ *          | March C-    | stuck, transition and coupling cell faults     |
+ *
+ * @note    March C- uses 64 bit accesses (LDRD/STRD) on blocks of 4 cells and
+ *          the first element (fill) can be done by DMA2 Stream 0 (memory to
+ *          memory). The cycles of each test are counted with DWT->CYCCNT
+ *
+ * @note    The area is overwritten. It must not be cacheable (the default for
+ *          the SDRAM at 0xC0000000) and must not hold the stack
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Tests for RAMTest_Run
+ */
+///@{
+#define RAMTEST_DATABUS                 0x01
+#define RAMTEST_ADDRESSBUS              0x02
+#define RAMTEST_MARCHC                  0x04
+#define RAMTEST_DMAFILL                 0x08    // March C- fill by DMA
+#define RAMTEST_QUICK                   (RAMTEST_DATABUS|RAMTEST_ADDRESSBUS)
+#define RAMTEST_ALL                     (RAMTEST_QUICK|RAMTEST_MARCHC|RAMTEST_DMAFILL)
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define RAMTEST_OK                      0
+#define RAMTEST_ERROR                   -1      // memory fault
+#define RAMTEST_ERROR_PARAMETER         -2
+#define RAMTEST_ERROR_DMA               -3
+///@}
+
+/**
+ * @brief   Result of a test
+ *
+ * @note    address, expected and actual are the ones of the first error (the
+ *          32 bit half that differs for 64 bit cells)
+ */
+typedef struct {
+    uint32_t    errors;
+    uint32_t    address;
+    uint32_t    expected;
+    uint32_t    actual;
+    uint32_t    cycles;
+} RAMTest_Result;
+
+int RAMTest_DataBus(void *address, RAMTest_Result *result);
+int RAMTest_AddressBus(void *address, uint32_t size, RAMTest_Result *result);
+int RAMTest_MarchC(void *address, uint32_t size, uint32_t background,
+                   uint32_t flags, RAMTest_Result *result);
+int RAMTest_Fill(void *address, uint32_t size, uint32_t value);
+int RAMTest_Run(void *address, uint32_t size, uint32_t flags);
+int ramtest(void *startaddress, unsigned size);
+
+#endif // RAMTEST_H
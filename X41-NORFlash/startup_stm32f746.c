@@ -35,6 +35,9 @@ void _main(void)                          WEAK_ATTRIBUTE;
 /* inicializacao CMSIS  */
 void SystemInit(void)                     WEAK_ATTRIBUTE;
 
+/* flash QSPI em modo mapeado (qspi.c). Zero quando qspi.c nao esta ligado */
+void QSPI_StartupInit(void)               __attribute__((weak));
+
 /* rotina de interrupcao default */
 void Default_Handler(void)                WEAK_ATTRIBUTE;
 
@@ -101,7 +104,7 @@ void TIM8_BRK_TIM12_IRQHandler(void)      WEAK_DEFAULT_ATTRIBUTE;
 void TIM8_UP_TIM13_IRQHandler(void)       WEAK_DEFAULT_ATTRIBUTE;
 void TIM8_TRG_COM_TIM14_IRQHandler(void)  WEAK_DEFAULT_ATTRIBUTE;
 void TIM8_CC_IRQHandler(void)             WEAK_DEFAULT_ATTRIBUTE;
-void DAM1_Stream7_IRQHandler(void)        WEAK_DEFAULT_ATTRIBUTE;
+void DMA1_Stream7_IRQHandler(void)        WEAK_DEFAULT_ATTRIBUTE;
 void FSMC_IRQHandler(void)                WEAK_DEFAULT_ATTRIBUTE;
 void SDMMC1_IRQHandler(void)              WEAK_DEFAULT_ATTRIBUTE;
 void TIM5_IRQHandler(void)                WEAK_DEFAULT_ATTRIBUTE;
@@ -250,7 +253,7 @@ void(*nvictable[])(void) = {
     TIM8_UP_TIM13_IRQHandler,       /* IRQ = 44 : TIM8 Update and TIM13 global interrupt */
     TIM8_TRG_COM_TIM14_IRQHandler,  /* IRQ = 45 : TIM8 Trigger and Commutation and TIM14 interrupt */
     TIM8_CC_IRQHandler,             /* IRQ = 46 : TIM8 Capture Compare interrupt */
-    DAM1_Stream7_IRQHandler,        /* IRQ = 47 : DMA1 Stream7 global interrupt */
+    DMA1_Stream7_IRQHandler,        /* IRQ = 47 : DMA1 Stream7 global interrupt */
     FSMC_IRQHandler,                /* IRQ = 48 : FSMC global interrupt */
     SDMMC1_IRQHandler,              /* IRQ = 49 : SDIO global interrupt */
     TIM5_IRQHandler,                /* IRQ = 50 : TIM5 global interrupt */
@@ -386,6 +389,10 @@ unsigned long *pDest;
     /* Step 3 : Call SystemInit conforme CMSIS */
     SystemInit();
 
+    /* Step 3a: Map the QSPI flash when the driver is linked (qspi.c) */
+    if( QSPI_StartupInit )
+        QSPI_StartupInit();
+
     /* Step 4 : Call _main to initialize library */
     _main();
 
@@ -19,6 +19,11 @@
 #include "stm32f746xx.h"
 #include "system_stm32f746.h"
 #include "sdram.h"
+#include "ramtest.h"
+#include "usbcdc.h"
+#include "usbmsc.h"
+#include "usbbulk.h"
+#include "sdcard.h"
 #include "led.h"
 
 
@@ -26,6 +31,7 @@
 
 static volatile uint32_t tick_ms = 0;
 static volatile uint32_t delay_ms = 0;
+static volatile uint32_t uptime_ms = 0;
 static int led_initialized = 0;
 
 #define INTERVAL 500
@@ -43,6 +49,9 @@ void SysTick_Handler(void) {
     }
 
     if( delay_ms > 0 ) delay_ms--;
+    uptime_ms++;
+
+    SD_ProcessTimeouts();
 
 }
 
@@ -184,6 +193,20 @@ static long int a = 16807L, m = 2147483647L, q = 127773L, r = 2836L;
  * @brief   main
  *
  * @note    Initializes GPIO and SDRAM, blinks LED and test SDRAM access
+ *
+ * @note    The SDRAM is checked after its initialization by the bus tests and
+ *          March C- (ramtest.c)
+ *
+ * @note    The USB CDC device is started after the clock configuration. With
+ *          TTY_USBCDC, it is the console (open the port to see the output)
+ *
+ * @note    Options 11 and 12 replace it by a mass storage device with the SD
+ *          card or with a RAM disk in the SDRAM (that the SDRAM tests erase)
+ *
+ * @note    Option 14 selects the core used by options 11, 12 and 15: OTG_FS
+ *          (replacing the CDC device) or OTG_HS (high speed, USB HS connector).
+ *          Option 15 starts the vendor bulk device and option 16 measures its
+ *          throughput while the host reads or writes it
  */
 #define LINEMAX 100
 int main(void) {
@@ -199,9 +222,17 @@ char line[LINEMAX+1];
 
     SysTick_Config(SystemCoreClock/1000);
 
+    /* 48 MHz for USB */
+    SystemConfigPLLSAI(&PLLSAIConfiguration_48MHz);
+    int rc = USBCDC_Init(USBD_CORE_FS);
+    if( rc < 0 )
+        printf("USBCDC_Init error %d\n",rc);
+
     printf("Press ENTER to initialize ExtRAM\n");
     fgets(line,LINEMAX,stdin);
     SDRAM_Init();
+    printf("SDRAM self test: %d errors\n",
+            RAMTest_Run((void *) SDRAM_ADDRESS,SDRAM_SIZE,RAMTEST_ALL));
 
     uint16_t w = 0x1234;
     uint16_t wr;
@@ -209,6 +240,7 @@ char line[LINEMAX+1];
     uint32_t lw = 0x12345678;
     uint32_t lwr;
     uint32_t *lp = (uint32_t *) 0xC0000000;
+    int usbcore = USBD_CORE_FS;
     while(1) {
         puts("Choose test");
         puts("1 - Write pattern using 16 bit access");
@@ -218,6 +250,16 @@ char line[LINEMAX+1];
         puts("5 - Write random pattern using 32-bit access");
         puts("6 - Write random pattern using 32-bit access");
         puts("7 - Reset apontadores");
+        puts("8 - Bus tests and March C- (CPU fill)");
+        puts("9 - Bus tests and March C- (DMA fill)");
+        puts("10 - USB CDC throughput (4 MB)");
+        puts("11 - USB mass storage (SD card)");
+        puts("12 - USB mass storage (RAM disk in SDRAM)");
+        puts("13 - USB mass storage statistics");
+        puts(usbcore == USBD_CORE_FS ? "14 - USB core for 11, 12 and 15: OTG_FS (change)"
+                                     : "14 - USB core for 11, 12 and 15: OTG_HS (change)");
+        puts("15 - USB vendor bulk device");
+        puts("16 - USB vendor bulk throughput (1 s)");
         fputs(">",stdout);
         fgets(line,100,stdin);
         int test = atoi(line);
@@ -310,6 +352,82 @@ char line[LINEMAX+1];
             p = (uint16_t *) 0xC0000000;
             lw = 0x12345678;
             lp = (uint32_t *) 0xC0000000;
+            break;
+        case 8:
+            RAMTest_Run((void *) SDRAM_ADDRESS,SDRAM_SIZE,RAMTEST_QUICK|RAMTEST_MARCHC);
+            break;
+        case 9:
+            RAMTest_Run((void *) SDRAM_ADDRESS,SDRAM_SIZE,RAMTEST_ALL);
+            break;
+        case 10:
+            if( !USBCDC_IsConnected() ) {
+                puts("USB CDC port not open");
+                break;
+            } else {
+                static char block[1024];
+                uint32_t start, ms;
+
+                for(k=0;k<(int) sizeof(block);k++)
+                    block[k] = ' '+k%64;
+                block[sizeof(block)-1] = '\n';
+                start = uptime_ms;
+                for(k=0;k<4096;k++)
+                    USBCDC_Write(block,sizeof(block));
+                ms = uptime_ms-start;
+                printf("\n4 MB in %u ms (%u kB/s)\n",
+                        (unsigned) ms,(unsigned) (ms?4194304/ms:0));
+            }
+            break;
+        case 11:
+            rc = SD_Init();
+            if( rc < 0 ) {
+                printf("SD_Init error %d\n",rc);
+                break;
+            }
+            rc = USBMSC_Init(usbcore,USBMSC_MEDIA_SD,0,0);
+            printf("USB mass storage (SD card): %d\n",rc);
+            break;
+        case 12:
+            rc = USBMSC_Init(usbcore,USBMSC_MEDIA_RAM,(void *) SDRAM_ADDRESS,SDRAM_SIZE);
+            printf("USB mass storage (RAM disk): %d\n",rc);
+            break;
+        case 13: {
+                USBMSC_Statistics stats;
+
+                USBMSC_GetStatistics(&stats);
+                printf("%u commands, %u blocks read (%u read-ahead hits), "
+                       "%u blocks written, %u errors\n",
+                        (unsigned) stats.commands,(unsigned) stats.readblocks,
+                        (unsigned) stats.readahead,(unsigned) stats.writeblocks,
+                        (unsigned) stats.errors);
+            }
+            break;
+        case 14:
+            usbcore = (usbcore == USBD_CORE_FS) ? USBD_CORE_HS : USBD_CORE_FS;
+            break;
+        case 15:
+            rc = USBBULK_Init(usbcore);
+            printf("USB vendor bulk device: %d\n",rc);
+            break;
+        case 16:
+            if( !USBBULK_IsConfigured() ) {
+                puts("USB vendor bulk device not configured");
+                break;
+            } else {
+                USBBULK_Statistics s0, s1;
+                uint32_t start, ms;
+
+                USBBULK_GetStatistics(&s0);
+                start = uptime_ms;
+                Delay(1000);
+                USBBULK_GetStatistics(&s1);
+                ms = uptime_ms-start;
+                printf("%s speed: IN %u kB/s, OUT %u kB/s\n",
+                        USBBULK_IsHighSpeed() ? "High" : "Full",
+                        (unsigned) ((s1.inbytes-s0.inbytes)/ms),
+                        (unsigned) ((s1.outbytes-s0.outbytes)/ms));
+            }
+            break;
         }
     }
 }
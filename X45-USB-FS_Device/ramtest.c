@@ -0,0 +1,388 @@
+/**
+ * @file    ramtest.c
+ *
+ * @brief   Memory diagnostics (see ramtest.h)
+ *
+ * @note    Stack must be in a different memory unit
+ *
+ * @note    The address bus test uses 16 bit accesses, so the first address line
+ *          of the 16 bit SDRAM bus (byte address bit 1) is tested too
+ *
+ * @note    March C- with the background b and its complement ~b
+ *
+ *          | Element | Order      | Operations |
+ *          |---------|------------|------------|
+ *          |  M0     | any        | w b        |
+ *          |  M1     | ascending  | r b, w ~b  |
+ *          |  M2     | ascending  | r ~b, w b  |
+ *          |  M3     | descending | r b, w ~b  |
+ *          |  M4     | descending | r ~b, w b  |
+ *          |  M5     | any        | r b        |
+ *
+ *          The cells have 64 bits. Four cells are read (LDRD) and then written
+ *          (STRD), so the reads and the writes are bursts of the FMC. Each cell
+ *          is still read before it is written in the order of the element
+ *
+ * @note    The fill (M0) by DMA uses a memory to memory transfer of DMA2
+ *          Stream 0 from a fixed word, with bursts of 4 words. The FIFO is
+ *          required in this mode
+ *
+ * @author  Hans
+ *
+ * @version 2.0
+ *
+ * @date    15/10/2026
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "ramtest.h"
+
+/**
+ * @brief   Patterns of the address bus test
+ */
+///@{
+#define PATTERN                         0xAAAA
+#define ANTIPATTERN                     0x5555
+///@}
+
+/**
+ * @brief   DMA configuration (DMA2 Stream 0, memory to memory)
+ */
+///@{
+#define DMASTREAM                       DMA2_Stream0
+#define DMACHANNEL                      0
+#define DMAIFCR                         (DMA2->LIFCR)
+#define DMAISR                          (DMA2->LISR)
+#define DMAFLAGS                        (0x3DU<<0)
+#define DMA_TC                          (1U<<5)
+#define DMA_ERRORS                      ((1U<<3)|(1U<<2))
+#define DMAMAX                          (65532U*4U)     // bytes per transfer
+///@}
+
+/**
+ * @brief   Word copied by the DMA fill
+ */
+static volatile uint32_t fillvalue;
+
+/**
+ *  @brief  Enable DWT cycle counter
+ */
+static void
+EnableCycleCounter(void) {
+
+    if( (DWT->CTRL&DWT_CTRL_CYCCNTENA_Msk) == 0 ) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->LAR = 0xC5ACCE55;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+}
+
+/**
+ *  @brief  Clear a result and start counting
+ */
+static uint32_t
+Start(RAMTest_Result *r) {
+
+    r->errors   = 0;
+    r->address  = 0;
+    r->expected = 0;
+    r->actual   = 0;
+    r->cycles   = 0;
+    EnableCycleCounter();
+    return DWT->CYCCNT;
+}
+
+/**
+ *  @brief  Count an error and keep the first one
+ */
+static void
+Fail(RAMTest_Result *r, const volatile void *address, uint32_t expected, uint32_t actual) {
+
+    if( r->errors++ == 0 ) {
+        r->address  = (uint32_t) address;
+        r->expected = expected;
+        r->actual   = actual;
+    }
+}
+
+/**
+ *  @brief  Find the wrong cells of a block of 4
+ *
+ *  @note   Called only on a mismatch, so the loops of the elements stay short
+ */
+static void __attribute__((noinline))
+Mismatch(volatile uint64_t *p, uint64_t expected, RAMTest_Result *r) {
+uint64_t v;
+uint32_t i;
+
+    for(i=0;i<4;i++) {
+        v = p[i];
+        if( v == expected )
+            continue;
+        if( (uint32_t) v != (uint32_t) expected )
+            Fail(r,&p[i],(uint32_t) expected,(uint32_t) v);
+        else
+            Fail(r,(volatile uint32_t *) &p[i]+1,(uint32_t) (expected>>32),(uint32_t) (v>>32));
+    }
+}
+
+/**
+ *  @brief  March element: read rd and, when write is set, write wr in each cell
+ */
+static void
+Element(volatile uint64_t *p, uint32_t n, int down, uint64_t rd, uint64_t wr,
+        int write, RAMTest_Result *r) {
+uint64_t a, b, c, d;
+uint32_t i;
+
+    if( !down ) {
+        for(i=0;i<n;i+=4) {
+            a = p[i]; b = p[i+1]; c = p[i+2]; d = p[i+3];
+            if( ((a^rd)|(b^rd)|(c^rd)|(d^rd)) != 0 )
+                Mismatch(p+i,rd,r);
+            if( write ) {
+                p[i] = wr; p[i+1] = wr; p[i+2] = wr; p[i+3] = wr;
+            }
+        }
+    } else {
+        for(i=n;i>0;) {
+            i -= 4;
+            d = p[i+3]; c = p[i+2]; b = p[i+1]; a = p[i];
+            if( ((a^rd)|(b^rd)|(c^rd)|(d^rd)) != 0 )
+                Mismatch(p+i,rd,r);
+            if( write ) {
+                p[i+3] = wr; p[i+2] = wr; p[i+1] = wr; p[i] = wr;
+            }
+        }
+    }
+}
+
+/**
+ * @brief   RAMTest_DataBus
+ *
+ * @note    Walking 1 and walking 0 on a word at address. The next word gets the
+ *          complement, so a floating line does not keep the value written
+ */
+int
+RAMTest_DataBus(void *address, RAMTest_Result *result) {
+volatile uint32_t *p = address;
+uint32_t start, bit, w;
+
+    if( ((uint32_t) address&3) != 0 || !result )
+        return RAMTEST_ERROR_PARAMETER;
+    start = Start(result);
+    for(bit=0;bit<32;bit++) {
+        w = 1U<<bit;
+        p[0] = w;
+        p[1] = ~w;
+        __DSB();
+        if( p[0] != w )
+            Fail(result,p,w,p[0]);
+        p[0] = ~w;
+        p[1] = w;
+        __DSB();
+        if( p[0] != ~w )
+            Fail(result,p,~w,p[0]);
+    }
+    result->cycles = DWT->CYCCNT-start;
+    return result->errors ? RAMTEST_ERROR : RAMTEST_OK;
+}
+
+/**
+ * @brief   RAMTest_AddressBus
+ *
+ * @note    Writes PATTERN at the offsets that are powers of 2 and then changes
+ *          each of them (and offset 0) in turn: a change seen at another offset
+ *          is a stuck or shorted address line
+ */
+int
+RAMTest_AddressBus(void *address, uint32_t size, RAMTest_Result *result) {
+volatile uint16_t *p = address;
+uint32_t n = size/2;
+uint32_t start, off, test;
+
+    if( ((uint32_t) address&1) != 0 || n < 2 || !result )
+        return RAMTEST_ERROR_PARAMETER;
+    start = Start(result);
+    for(off=1;off<n;off<<=1)
+        p[off] = PATTERN;
+    p[0] = ANTIPATTERN;
+    __DSB();
+    for(off=1;off<n;off<<=1) {
+        if( p[off] != PATTERN )
+            Fail(result,&p[off],PATTERN,p[off]);
+    }
+    p[0] = PATTERN;
+    for(test=1;test<n;test<<=1) {
+        p[test] = ANTIPATTERN;
+        __DSB();
+        if( p[0] != PATTERN )
+            Fail(result,&p[0],PATTERN,p[0]);
+        for(off=1;off<n;off<<=1) {
+            if( off != test && p[off] != PATTERN )
+                Fail(result,&p[off],PATTERN,p[off]);
+        }
+        p[test] = PATTERN;
+    }
+    result->cycles = DWT->CYCCNT-start;
+    return result->errors ? RAMTEST_ERROR : RAMTEST_OK;
+}
+
+/**
+ * @brief   RAMTest_Fill
+ *
+ * @note    Fills the area with value using DMA2 Stream 0. address and size must
+ *          be multiples of 16 (a burst never crosses a 1 KB boundary)
+ */
+int
+RAMTest_Fill(void *address, uint32_t size, uint32_t value) {
+uint32_t a = (uint32_t) address;
+uint32_t k, start, timeout = SystemCoreClock/10;    // 100 ms
+
+    if( (a&15) != 0 || (size&15) != 0 )
+        return RAMTEST_ERROR_PARAMETER;
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+    __DSB();
+    EnableCycleCounter();
+    fillvalue = value;
+    while( size ) {
+        k = size > DMAMAX ? DMAMAX : size;
+        DMASTREAM->CR &= ~DMA_SxCR_EN;
+        while( DMASTREAM->CR&DMA_SxCR_EN ) {}
+        DMAIFCR = DMAFLAGS;
+        DMASTREAM->PAR  = (uint32_t) &fillvalue;    // source, not incremented
+        DMASTREAM->M0AR = a;
+        DMASTREAM->NDTR = k/4;
+        DMASTREAM->FCR  = DMA_SxFCR_DMDIS|(3<<DMA_SxFCR_FTH_Pos);
+        DMASTREAM->CR   = (DMACHANNEL<<DMA_SxCR_CHSEL_Pos)
+                         |(2<<DMA_SxCR_PL_Pos)
+                         |(2<<DMA_SxCR_DIR_Pos)     // memory to memory
+                         |(1<<DMA_SxCR_MBURST_Pos)  // INC4
+                         |(2<<DMA_SxCR_MSIZE_Pos)
+                         |(2<<DMA_SxCR_PSIZE_Pos)
+                         |DMA_SxCR_MINC;
+        DMASTREAM->CR  |= DMA_SxCR_EN;
+        start = DWT->CYCCNT;
+        while( (DMAISR&(DMA_TC|DMA_ERRORS)) == 0 ) {
+            if( DWT->CYCCNT-start > timeout )
+                break;
+        }
+        if( (DMAISR&DMA_TC) == 0 ) {
+            DMASTREAM->CR &= ~DMA_SxCR_EN;
+            return RAMTEST_ERROR_DMA;
+        }
+        a += k;
+        size -= k;
+    }
+    return RAMTEST_OK;
+}
+
+/**
+ * @brief   RAMTest_MarchC
+ *
+ * @note    March C- on size bytes with 64 bit cells. address and size must be
+ *          multiples of 32. The cells get background (in both halves) and its
+ *          complement. With RAMTEST_DMAFILL, M0 is done by the DMA
+ */
+int
+RAMTest_MarchC(void *address, uint32_t size, uint32_t background,
+               uint32_t flags, RAMTest_Result *result) {
+volatile uint64_t *p = address;
+uint64_t b0 = (uint64_t) background<<32|background;
+uint64_t b1 = ~b0;
+uint32_t n = size/8;
+uint32_t start, i;
+int rc;
+
+    if( ((uint32_t) address&31) != 0 || size == 0 || (size&31) != 0 || !result )
+        return RAMTEST_ERROR_PARAMETER;
+    start = Start(result);
+    if( flags&RAMTEST_DMAFILL ) {
+        rc = RAMTest_Fill(address,size,background);
+        if( rc < 0 )
+            return rc;
+    } else {
+        for(i=0;i<n;i+=4) {
+            p[i] = b0; p[i+1] = b0; p[i+2] = b0; p[i+3] = b0;
+        }
+    }
+    __DSB();
+    Element(p,n,0,b0,b1,1,result);
+    Element(p,n,0,b1,b0,1,result);
+    Element(p,n,1,b0,b1,1,result);
+    Element(p,n,1,b1,b0,1,result);
+    Element(p,n,0,b0,b0,0,result);
+    result->cycles = DWT->CYCCNT-start;
+    return result->errors ? RAMTEST_ERROR : RAMTEST_OK;
+}
+
+/**
+ *  @brief  Print the result of a test
+ */
+static void
+Report(const char *test, uint32_t size, int rc, const RAMTest_Result *r) {
+uint32_t us = r->cycles/(SystemCoreClock/1000000);
+
+    if( rc < 0 && rc != RAMTEST_ERROR ) {
+        printf("%s: error %d\n",test,rc);
+        return;
+    }
+    printf("%s: %u bytes in %u us, %u errors\n",test,(unsigned) size,(unsigned) us,
+            (unsigned) r->errors);
+    if( r->errors )
+        printf("  first at %08X: wrote %08X read %08X\n",(unsigned) r->address,
+                (unsigned) r->expected,(unsigned) r->actual);
+}
+
+/**
+ * @brief   RAMTest_Run
+ *
+ * @note    Runs the tests selected by flags on the area and prints the time
+ *          and the errors of each one. March C- uses background 0 and leaves
+ *          the area cleared
+ *
+ * @note    Returns the total number of errors or a negative value
+ */
+int
+RAMTest_Run(void *address, uint32_t size, uint32_t flags) {
+RAMTest_Result r;
+int rc, errors = 0;
+
+    if( flags&RAMTEST_DATABUS ) {
+        rc = RAMTest_DataBus(address,&r);
+        Report("Data bus",8,rc,&r);
+        if( rc < 0 && rc != RAMTEST_ERROR )
+            return rc;
+        errors += r.errors;
+    }
+    if( flags&RAMTEST_ADDRESSBUS ) {
+        rc = RAMTest_AddressBus(address,size,&r);
+        Report("Address bus",size,rc,&r);
+        if( rc < 0 && rc != RAMTEST_ERROR )
+            return rc;
+        errors += r.errors;
+    }
+    if( flags&RAMTEST_MARCHC ) {
+        rc = RAMTest_MarchC(address,size,0,flags,&r);
+        Report("March C-",size,rc,&r);
+        if( rc < 0 && rc != RAMTEST_ERROR )
+            return rc;
+        errors += r.errors;
+    }
+    return errors;
+}
+
+/**
+ * @brief   ramtest
+ *
+ * @note    All tests on the area
+ */
+int
+ramtest( void *startaddress, unsigned size) {
+
+    return RAMTest_Run(startaddress,size,RAMTEST_ALL);
+}
@@ -0,0 +1,874 @@
+/**
+ * @file    sdcard.c
+ *
+ * @note    MicroSD block driver for SDMMC1 (see sdcard.h)
+ *
+ * @note    Pins of the STM32F746 Discovery board (AF12)
+ *
+ *          | Signal | Pin  |
+ *          |--------|------|
+ *          | CK     | PC12 |
+ *          | CMD    | PD2  |
+ *          | D0-D3  | PC8-PC11 |
+ *          | Detect | PC13 (low when a card is present) |
+ *
+ * @note    SDMMC_CK = SDMMCCLK/(CLKDIV+2) or SDMMCCLK when BYPASS is set. With
+ *          SDMMCCLK = 48 MHz, CLKDIV=118 gives 400 kHz for the identification,
+ *          CLKDIV=0 gives 24 MHz (default speed) and BYPASS 48 MHz (high speed)
+ *
+ * @note    SD_Init sends the commands by polling. The requests run in the
+ *          SDMMC1 interrupt, thru these states
+ *
+ *          | State      | Waiting for                                  |
+ *          |------------|----------------------------------------------|
+ *          | APPCMD     | CMD55 response (before ACMD23)               |
+ *          | ERASECOUNT | ACMD23 response (pre-erase hint)             |
+ *          | XFERCMD    | CMD17/18/24/25 response                      |
+ *          | DATA       | DATAEND (DMA transfers the blocks)           |
+ *          | STOP       | CMD12 response                               |
+ *          | STATUS     | CMD13 response (card programming the blocks) |
+ *          | PROGRAM    | the next ms to send CMD13 again              |
+ *
+ * @note    The DMA stream uses peripheral flow control, so SDMMC1 tells when
+ *          the transfer ends, and the FIFO with bursts of 4 words
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "gpio.h"
+#include "sdcard.h"
+
+/**
+ * @brief   Commands
+ */
+///@{
+#define CMD_GO_IDLE_STATE               0
+#define CMD_ALL_SEND_CID                2
+#define CMD_SEND_RELATIVE_ADDR          3
+#define CMD_SWITCH_FUNC                 6
+#define CMD_SELECT_CARD                 7
+#define CMD_SEND_IF_COND                8
+#define CMD_SEND_CSD                    9
+#define CMD_STOP_TRANSMISSION           12
+#define CMD_SEND_STATUS                 13
+#define CMD_SET_BLOCKLEN                16
+#define CMD_READ_SINGLE_BLOCK           17
+#define CMD_READ_MULTIPLE_BLOCK         18
+#define CMD_WRITE_BLOCK                 24
+#define CMD_WRITE_MULTIPLE_BLOCK        25
+#define CMD_APP_CMD                     55
+#define ACMD_SET_BUS_WIDTH              6
+#define ACMD_SET_WR_BLK_ERASE_COUNT     23
+#define ACMD_SD_SEND_OP_COND            41
+///@}
+
+/**
+ * @brief   Response types
+ */
+///@{
+#define RESP_NONE                       0
+#define RESP_SHORT                      1       // R1, R1b, R6 and R7
+#define RESP_SHORT_NOCRC                2       // R3 (OCR)
+#define RESP_LONG                       3       // R2 (CID and CSD)
+///@}
+
+/**
+ * @brief   Card status (R1)
+ */
+///@{
+#define R1_ERRORS                       0xFDFFE008U
+#define R1_READY_FOR_DATA               (1U<<8)
+#define R1_STATE(R)                     (((R)>>9)&0xF)
+#define R1_STATE_TRAN                   4
+///@}
+
+/**
+ * @brief   OCR and ACMD41 argument
+ */
+///@{
+#define OCR_BUSY                        (1U<<31)        // 1 when ready
+#define OCR_HCS                         (1U<<30)
+#define OCR_VOLTAGES                    0x00FF8000U     // 2.7-3.6 V
+///@}
+
+/**
+ * @brief   SDMMC clock
+ */
+///@{
+#define SDMMCCLK                        48000000U
+#define CLKDIV_INIT                     118             // 400 kHz
+#define CLKDIV_DEFAULTSPEED             0               // 24 MHz
+///@}
+
+/**
+ * @brief   Data timeout (in SDMMC_CK cycles) for 250 ms
+ */
+#define DATATIMEOUT(BUSCLOCK)           ((BUSCLOCK)/4)
+
+/**
+ * @brief   CMD13 sent at once after a write before waiting the next ms
+ */
+#define STATUS_POLLS                    8
+
+/**
+ * @brief   Flags
+ */
+///@{
+#define STA_DATAERRORS                  (SDMMC_STA_DCRCFAIL|SDMMC_STA_DTIMEOUT\
+                                        |SDMMC_STA_TXUNDERR|SDMMC_STA_RXOVERR)
+#define ICR_STATIC                      0x004005FFU
+#define MASK_CMD                        (SDMMC_MASK_CCRCFAILIE|SDMMC_MASK_CTIMEOUTIE\
+                                        |SDMMC_MASK_CMDRENDIE)
+#define MASK_DATA                       (SDMMC_MASK_DCRCFAILIE|SDMMC_MASK_DTIMEOUTIE\
+                                        |SDMMC_MASK_TXUNDERRIE|SDMMC_MASK_RXOVERRIE\
+                                        |SDMMC_MASK_DATAENDIE)
+///@}
+
+/**
+ * @brief   DMA configuration (DMA2 Stream 3, channel 4)
+ */
+///@{
+#define DMASTREAM                       DMA2_Stream3
+#define DMACHANNEL                      4
+#define DMAIFCR                         (DMA2->LIFCR)
+#define DMAFLAGS                        (0x3DU<<22)
+///@}
+
+/**
+ * @brief   Pins
+ */
+///@{
+static const GPIO_PinConfiguration sdpins[] = {
+    /*  gpio, pin, af, mode, otype, ospeed, pupd, initial */
+    { GPIOC,  8,  12,    2,     0,      3,    1,       0 },     // D0
+    { GPIOC,  9,  12,    2,     0,      3,    1,       0 },     // D1
+    { GPIOC, 10,  12,    2,     0,      3,    1,       0 },     // D2
+    { GPIOC, 11,  12,    2,     0,      3,    1,       0 },     // D3
+    { GPIOC, 12,  12,    2,     0,      3,    0,       0 },     // CK
+    { GPIOD,  2,  12,    2,     0,      3,    1,       0 },     // CMD
+    { 0,      0,   0,    0,     0,      0,    0,       0 }
+};
+
+static const GPIO_PinConfiguration detectpin =
+    { GPIOC, 13,   0,    0,     0,      0,    1,       0 };
+///@}
+
+/**
+ * @brief   States of a request
+ */
+enum { ST_IDLE, ST_APPCMD, ST_ERASECOUNT, ST_XFERCMD, ST_DATA, ST_STOP,
+       ST_STATUS, ST_PROGRAM };
+
+/**
+ * @brief   Driver state
+ */
+///@{
+static SD_CardInfo          card;
+static int                  initialized = 0;
+static SD_Request           *first = 0;     // being transferred
+static SD_Request           *last  = 0;
+static volatile int         state = ST_IDLE;
+static int                  error;          // reported after CMD12
+static int                  polls;
+static volatile uint32_t    timer;          // ms left for the request
+static volatile uint32_t    now = 0;        // ms
+///@}
+
+/**
+ * @brief  Cache maintenance over whole lines
+ */
+///@{
+static void CleanBuffer( const uint8_t *p, uint32_t n ) {
+uint32_t a = (uint32_t) p&~31U;
+
+    SCB_CleanDCache_by_Addr((uint32_t *) a,(((uint32_t) p+n+31)&~31U)-a);
+}
+
+static void CleanInvalidateBuffer( uint8_t *p, uint32_t n ) {
+uint32_t a = (uint32_t) p&~31U;
+
+    SCB_CleanInvalidateDCache_by_Addr((uint32_t *) a,(((uint32_t) p+n+31)&~31U)-a);
+}
+
+static void InvalidateBuffer( uint8_t *p, uint32_t n ) {
+uint32_t a = (uint32_t) p&~31U;
+
+    SCB_InvalidateDCache_by_Addr((uint32_t *) a,(((uint32_t) p+n+31)&~31U)-a);
+}
+///@}
+
+/**
+ * @brief  Stop the DMA stream and clear its flags
+ */
+static void StopStream( void ) {
+
+    DMASTREAM->CR &= ~DMA_SxCR_EN;
+    while( DMASTREAM->CR&DMA_SxCR_EN ) {}
+    DMAIFCR = DMAFLAGS;
+}
+
+/**
+ * @brief  Start the DMA stream between a buffer and the SDMMC FIFO
+ *
+ * @note   dir is 0 for reads (peripheral to memory) and 1 for writes
+ */
+static void StartStream( uint8_t *p, uint32_t n, uint32_t dir ) {
+
+    StopStream();
+    DMASTREAM->PAR  = (uint32_t) &(SDMMC1->FIFO);
+    DMASTREAM->M0AR = (uint32_t) p;
+    DMASTREAM->NDTR = n/4;                  // ignored (peripheral flow control)
+    DMASTREAM->FCR  = DMA_SxFCR_DMDIS|(3<<DMA_SxFCR_FTH_Pos);
+    DMASTREAM->CR   = (DMACHANNEL<<DMA_SxCR_CHSEL_Pos)
+                     |(3<<DMA_SxCR_PL_Pos)
+                     |(dir<<DMA_SxCR_DIR_Pos)
+                     |(1<<DMA_SxCR_MBURST_Pos)
+                     |(1<<DMA_SxCR_PBURST_Pos)
+                     |(2<<DMA_SxCR_MSIZE_Pos)
+                     |(2<<DMA_SxCR_PSIZE_Pos)
+                     |DMA_SxCR_MINC
+                     |DMA_SxCR_PFCTRL;
+    DMASTREAM->CR  |= DMA_SxCR_EN;
+}
+
+/**
+ * @brief  Wait for ms milliseconds (counted by SD_ProcessTimeouts)
+ */
+static void Wait( uint32_t ms ) {
+uint32_t start = now;
+
+    while( now-start < ms ) {}
+}
+
+/**
+ * @brief  Start a command without waiting
+ */
+static void StartCommand( uint32_t cmd, uint32_t arg, int resp ) {
+uint32_t w;
+
+    switch(resp) {
+    case RESP_NONE: w = 0;                      break;
+    case RESP_LONG: w = SDMMC_CMD_WAITRESP;     break;
+    default:        w = SDMMC_CMD_WAITRESP_0;   break;
+    }
+    SDMMC1->ICR = ICR_STATIC&~(STA_DATAERRORS|SDMMC_STA_DATAEND|SDMMC_STA_DBCKEND);
+    SDMMC1->ARG = arg;
+    SDMMC1->CMD = (cmd<<SDMMC_CMD_CMDINDEX_Pos)|w|SDMMC_CMD_CPSMEN;
+}
+
+/**
+ * @brief  Status of a command from the SDMMC flags
+ *
+ * @note   Returns SD_PENDING while the response did not arrive. The CRC error
+ *         of R3 is expected, since it has no CRC
+ */
+static int CommandStatus( uint32_t sta, int resp ) {
+
+    if( resp == RESP_NONE )
+        return (sta&SDMMC_STA_CMDSENT) ? SD_OK : SD_PENDING;
+    if( sta&SDMMC_STA_CTIMEOUT )
+        return SD_ERROR_TIMEOUT;
+    if( sta&SDMMC_STA_CCRCFAIL )
+        return resp == RESP_SHORT_NOCRC ? SD_OK : SD_ERROR_CRC;
+    if( (sta&SDMMC_STA_CMDREND) == 0 )
+        return SD_PENDING;
+    return SD_OK;
+}
+
+/**
+ * @brief  Send a command and wait for the response (polling)
+ *
+ * @note   R1 error bits are checked when check is not zero
+ */
+static int SendCommand( uint32_t cmd, uint32_t arg, int resp, int check ) {
+int rc;
+
+    StartCommand(cmd,arg,resp);
+    while( (rc=CommandStatus(SDMMC1->STA,resp)) == SD_PENDING ) {}
+    SDMMC1->ICR = SDMMC_ICR_CCRCFAILC|SDMMC_ICR_CTIMEOUTC
+                 |SDMMC_ICR_CMDRENDC|SDMMC_ICR_CMDSENTC;
+    if( rc == SD_OK && check && (SDMMC1->RESP1&R1_ERRORS) )
+        rc = SD_ERROR_CARD;
+    return rc;
+}
+
+static int SendAppCommand( uint32_t acmd, uint32_t arg, int resp, int check ) {
+int rc;
+
+    rc = SendCommand(CMD_APP_CMD,(uint32_t) card.rca<<16,RESP_SHORT,1);
+    if( rc < 0 )
+        return rc;
+    return SendCommand(acmd,arg,resp,check);
+}
+
+/**
+ * @brief  Wait until the card is in the transfer state and ready for data
+ */
+static int WaitTransferState( void ) {
+uint32_t start = now;
+int rc;
+
+    do {
+        rc = SendCommand(CMD_SEND_STATUS,(uint32_t) card.rca<<16,RESP_SHORT,1);
+        if( rc < 0 )
+            return rc;
+        if( R1_STATE(SDMMC1->RESP1) == R1_STATE_TRAN
+         && (SDMMC1->RESP1&R1_READY_FOR_DATA) )
+            return SD_OK;
+    } while( now-start < SD_REQUEST_TIMEOUT_MS );
+    return SD_ERROR_TIMEOUT;
+}
+
+/**
+ * @brief  Capacity in blocks from the CSD
+ *
+ * @note   csd[0] has bits 127-96 and csd[3] bits 31-0
+ */
+static uint32_t CapacityFromCSD( const uint32_t *csd ) {
+uint32_t csize, mult, blen;
+
+    if( (csd[0]>>30) == 1 ) {               // CSD 2.0: C_SIZE[69:48]
+        csize = ((csd[1]&0x3F)<<16)|(csd[2]>>16);
+        return (csize+1)*1024;
+    }
+    csize = ((csd[1]&0x3FF)<<2)|(csd[2]>>30);   // C_SIZE[73:62]
+    mult  = (csd[2]>>15)&0x7;                   // C_SIZE_MULT[49:47]
+    blen  = (csd[1]>>16)&0xF;                   // READ_BL_LEN[83:80]
+    return ((csize+1)<<(mult+2+blen))/SD_BLOCKSIZE;
+}
+
+/**
+ * @brief  Switch to the high speed mode (CMD6)
+ *
+ * @note   The 64 byte switch status is read thru the FIFO. In the status,
+ *         bit 1 of byte 13 tells that high speed is supported and the low
+ *         nibble of byte 16 is the function selected in group 1
+ */
+static int SwitchHighSpeed( void ) {
+uint32_t status[16];
+uint8_t *b = (uint8_t *) status;
+uint32_t sta;
+int rc, n = 0;
+
+    SDMMC1->DTIMER = DATATIMEOUT(card.busclock);
+    SDMMC1->DLEN   = sizeof(status);
+    SDMMC1->DCTRL  = (6<<SDMMC_DCTRL_DBLOCKSIZE_Pos)|SDMMC_DCTRL_DTDIR|SDMMC_DCTRL_DTEN;
+    rc = SendCommand(CMD_SWITCH_FUNC,0x80FFFFF1U,RESP_SHORT,1);
+    if( rc < 0 ) {
+        SDMMC1->DCTRL = 0;
+        return rc;
+    }
+    for(;;) {
+        sta = SDMMC1->STA;
+        if( sta&STA_DATAERRORS ) {
+            rc = SD_ERROR_DATA;
+            break;
+        }
+        if( sta&SDMMC_STA_RXDAVL ) {
+            if( n < 16 )
+                status[n++] = SDMMC1->FIFO;
+            else
+                (void) SDMMC1->FIFO;
+        } else if( sta&SDMMC_STA_DATAEND ) {
+            break;
+        }
+    }
+    SDMMC1->DCTRL = 0;
+    SDMMC1->ICR   = ICR_STATIC;
+    if( rc < 0 )
+        return rc;
+    if( n < 16 || (b[13]&0x02) == 0 || (b[16]&0xF) != 1 )
+        return SD_ERROR_UNSUPPORTED;
+    return SD_OK;
+}
+
+/**
+ * @brief  SD_IsCardPresent
+ */
+int
+SD_IsCardPresent( void ) {
+static int configured = 0;
+
+    if( !configured ) {
+        GPIO_ConfigureSinglePin(&detectpin);
+        configured = 1;
+    }
+    return (GPIOC->IDR&(1U<<13)) == 0;
+}
+
+/**
+ * @brief  SD_Init
+ *
+ * @note   Configures the pins, SDMMC1 and DMA2 and identifies the card
+ *
+ * @note   The requests in the queue are lost (SD_Init must not be called while
+ *         there are pending requests)
+ */
+int
+SD_Init( void ) {
+uint32_t start, ocr, arg;
+int rc, v2;
+
+    initialized = 0;
+    NVIC_DisableIRQ(SDMMC1_IRQn);
+    first = last = 0;
+    state = ST_IDLE;
+
+    if( !SD_IsCardPresent() )
+        return SD_ERROR_NOCARD;
+    if( (RCC->CR&RCC_CR_PLLSAIRDY) == 0 )
+        return SD_ERROR_NOCLOCK;
+
+    GPIO_ConfigureMultiplePins(sdpins);
+
+    // SDMMCCLK = CK48 = PLLSAI P
+    RCC->DCKCFGR2 = (RCC->DCKCFGR2&~RCC_DCKCFGR2_SDMMC1SEL)|RCC_DCKCFGR2_CK48MSEL;
+    RCC->APB2ENR |= RCC_APB2ENR_SDMMC1EN;
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+    __DSB();
+    RCC->APB2RSTR |= RCC_APB2RSTR_SDMMC1RST;
+    RCC->APB2RSTR &= ~RCC_APB2RSTR_SDMMC1RST;
+
+    SDMMC1->POWER = 3<<SDMMC_POWER_PWRCTRL_Pos;
+    SDMMC1->CLKCR = (CLKDIV_INIT<<SDMMC_CLKCR_CLKDIV_Pos)|SDMMC_CLKCR_CLKEN;
+    card.busclock = SDMMCCLK/(CLKDIV_INIT+2);
+    card.rca = 0;
+    Wait(2);                                // 74 clocks and power up
+
+    SendCommand(CMD_GO_IDLE_STATE,0,RESP_NONE,0);
+
+    // Version 2.0 cards answer CMD8 with the check pattern
+    rc = SendCommand(CMD_SEND_IF_COND,0x1AA,RESP_SHORT,0);
+    if( rc == SD_OK && (SDMMC1->RESP1&0xFFF) != 0x1AA )
+        return SD_ERROR_UNSUPPORTED;
+    if( rc != SD_OK && rc != SD_ERROR_TIMEOUT )
+        return rc;
+    v2 = rc == SD_OK;
+
+    arg = OCR_VOLTAGES|(v2?OCR_HCS:0);
+    start = now;
+    do {
+        rc = SendAppCommand(ACMD_SD_SEND_OP_COND,arg,RESP_SHORT_NOCRC,0);
+        if( rc < 0 )
+            return rc;
+        ocr = SDMMC1->RESP1;
+        if( ocr&OCR_BUSY )
+            break;
+    } while( now-start < SD_INIT_TIMEOUT_MS );
+    if( (ocr&OCR_BUSY) == 0 )
+        return SD_ERROR_TIMEOUT;
+    card.highcapacity = (ocr&OCR_HCS) != 0;
+
+    rc = SendCommand(CMD_ALL_SEND_CID,0,RESP_LONG,0);
+    if( rc < 0 )
+        return rc;
+    card.cid[0] = SDMMC1->RESP1;
+    card.cid[1] = SDMMC1->RESP2;
+    card.cid[2] = SDMMC1->RESP3;
+    card.cid[3] = SDMMC1->RESP4;
+
+    rc = SendCommand(CMD_SEND_RELATIVE_ADDR,0,RESP_SHORT,0);
+    if( rc < 0 )
+        return rc;
+    if( SDMMC1->RESP1&0xE000 )              // error bits of R6
+        return SD_ERROR_CARD;
+    card.rca = SDMMC1->RESP1>>16;
+
+    rc = SendCommand(CMD_SEND_CSD,(uint32_t) card.rca<<16,RESP_LONG,0);
+    if( rc < 0 )
+        return rc;
+    card.csd[0] = SDMMC1->RESP1;
+    card.csd[1] = SDMMC1->RESP2;
+    card.csd[2] = SDMMC1->RESP3;
+    card.csd[3] = SDMMC1->RESP4;
+    card.blocks = CapacityFromCSD(card.csd);
+
+    rc = SendCommand(CMD_SELECT_CARD,(uint32_t) card.rca<<16,RESP_SHORT,1);
+    if( rc < 0 )
+        return rc;
+    rc = WaitTransferState();
+    if( rc < 0 )
+        return rc;
+    if( !card.highcapacity ) {
+        rc = SendCommand(CMD_SET_BLOCKLEN,SD_BLOCKSIZE,RESP_SHORT,1);
+        if( rc < 0 )
+            return rc;
+    }
+
+    // 4 bit bus at 24 MHz
+    rc = SendAppCommand(ACMD_SET_BUS_WIDTH,2,RESP_SHORT,1);
+    if( rc < 0 )
+        return rc;
+    SDMMC1->CLKCR = (CLKDIV_DEFAULTSPEED<<SDMMC_CLKCR_CLKDIV_Pos)
+                   |SDMMC_CLKCR_WIDBUS_0|SDMMC_CLKCR_CLKEN;
+    card.busclock = SDMMCCLK/(CLKDIV_DEFAULTSPEED+2);
+
+    // High speed (48 MHz) needs the switch command class (10) in CSD CCC
+    card.highspeed = 0;
+    if( (card.csd[1]>>20)&(1U<<10) ) {
+        if( SwitchHighSpeed() == SD_OK ) {
+            Wait(1);
+            SDMMC1->CLKCR |= SDMMC_CLKCR_BYPASS;
+            card.highspeed = 1;
+            card.busclock = SDMMCCLK;
+        }
+        rc = WaitTransferState();
+        if( rc < 0 )
+            return rc;
+    }
+
+    StopStream();
+    SDMMC1->MASK = 0;
+    SDMMC1->ICR  = ICR_STATIC;
+    NVIC_SetPriority(SDMMC1_IRQn,SD_IRQ_PRIO);
+    NVIC_ClearPendingIRQ(SDMMC1_IRQn);
+    NVIC_EnableIRQ(SDMMC1_IRQn);
+    initialized = 1;
+    return SD_OK;
+}
+
+/**
+ * @brief  SD_GetCardInfo
+ */
+int
+SD_GetCardInfo( SD_CardInfo *info ) {
+
+    if( !initialized )
+        return SD_ERROR_NOTINITIALIZED;
+    *info = card;
+    return SD_OK;
+}
+
+/**
+ * @brief  Address of a block in the commands (bytes for standard capacity)
+ */
+static uint32_t BlockAddress( uint32_t block ) {
+
+    return card.highcapacity ? block : block*SD_BLOCKSIZE;
+}
+
+/**
+ * @brief  Send the read or write command of the first request
+ *
+ * @note   For reads, the data path is enabled before the command, since the
+ *         card sends the data right after the response
+ */
+static void StartTransfer( void ) {
+SD_Request *r = first;
+uint32_t cmd, n = r->count*SD_BLOCKSIZE;
+
+    SDMMC1->DTIMER = DATATIMEOUT(card.busclock);
+    SDMMC1->DLEN   = n;
+    SDMMC1->ICR    = ICR_STATIC;
+    if( r->op == SD_READ ) {
+        StartStream(r->data,n,0);
+        SDMMC1->DCTRL = (9<<SDMMC_DCTRL_DBLOCKSIZE_Pos)|SDMMC_DCTRL_DMAEN
+                       |SDMMC_DCTRL_DTDIR|SDMMC_DCTRL_DTEN;
+        cmd = r->count > 1 ? CMD_READ_MULTIPLE_BLOCK : CMD_READ_SINGLE_BLOCK;
+    } else {
+        StartStream(r->data,n,1);
+        cmd = r->count > 1 ? CMD_WRITE_MULTIPLE_BLOCK : CMD_WRITE_BLOCK;
+    }
+    state = ST_XFERCMD;
+    SDMMC1->MASK = MASK_CMD|MASK_DATA;
+    StartCommand(cmd,BlockAddress(r->block),RESP_SHORT);
+}
+
+/**
+ * @brief  Start the first request of the queue
+ */
+static void StartRequest( void ) {
+SD_Request *r = first;
+
+    timer = SD_REQUEST_TIMEOUT_MS;
+    error = SD_OK;
+    if( r->op == SD_READ ) {
+        CleanInvalidateBuffer(r->data,r->count*SD_BLOCKSIZE);
+        StartTransfer();
+    } else {
+        CleanBuffer(r->data,r->count*SD_BLOCKSIZE);
+        if( r->count > 1 ) {
+            state = ST_APPCMD;
+            SDMMC1->MASK = MASK_CMD;
+            StartCommand(CMD_APP_CMD,(uint32_t) card.rca<<16,RESP_SHORT);
+        } else {
+            StartTransfer();
+        }
+    }
+}
+
+/**
+ * @brief  Finish the first request with status and start the next one
+ */
+static void CompleteRequest( int status ) {
+SD_Request *r = first;
+
+    SDMMC1->MASK  = 0;
+    SDMMC1->DCTRL = 0;
+    SDMMC1->ICR   = ICR_STATIC;
+    StopStream();
+    state = ST_IDLE;
+    if( !r )
+        return;
+
+    if( r->op == SD_READ )
+        InvalidateBuffer(r->data,r->count*SD_BLOCKSIZE);
+
+    first = r->next;
+    if( !first )
+        last = 0;
+    else
+        StartRequest();
+
+    r->status = status;
+    if( r->callback )
+        r->callback(r->arg,status);
+}
+
+/**
+ * @brief  Abort the first request after a timeout
+ *
+ * @note   The command and data paths are stopped and CMD12 is sent by polling,
+ *         so the card is back in the transfer state for the next request
+ */
+static void AbortRequest( int status ) {
+
+    SDMMC1->MASK  = 0;
+    SDMMC1->CMD   = 0;
+    SDMMC1->DCTRL = 0;
+    StopStream();
+    SendCommand(CMD_STOP_TRANSMISSION,0,RESP_SHORT,0);
+    CompleteRequest(status);
+}
+
+/**
+ * @brief  Send CMD12 after a transfer of many blocks or after an error
+ */
+static void StopTransfer( int status ) {
+
+    error = status;
+    SDMMC1->DCTRL = 0;
+    state = ST_STOP;
+    SDMMC1->MASK = MASK_CMD;
+    StartCommand(CMD_STOP_TRANSMISSION,0,RESP_SHORT);
+}
+
+/**
+ * @brief  Ask the card status while it programs the written blocks
+ */
+static void StartStatus( void ) {
+
+    state = ST_STATUS;
+    SDMMC1->MASK = MASK_CMD;
+    StartCommand(CMD_SEND_STATUS,(uint32_t) card.rca<<16,RESP_SHORT);
+}
+
+/**
+ * @brief  SDMMC1 interrupt
+ */
+void
+SDMMC1_IRQHandler( void ) {
+SD_Request *r = first;
+uint32_t sta = SDMMC1->STA;
+int rc;
+
+    if( !r || state == ST_IDLE || state == ST_PROGRAM ) {
+        SDMMC1->MASK = 0;
+        SDMMC1->ICR  = ICR_STATIC;
+        return;
+    }
+
+    if( state != ST_DATA ) {
+        rc = CommandStatus(sta,RESP_SHORT);
+        if( rc == SD_PENDING )
+            return;
+        SDMMC1->ICR = SDMMC_ICR_CCRCFAILC|SDMMC_ICR_CTIMEOUTC|SDMMC_ICR_CMDRENDC;
+        if( rc == SD_OK && (SDMMC1->RESP1&R1_ERRORS) )
+            rc = SD_ERROR_CARD;
+
+        switch(state) {
+        case ST_APPCMD:
+            if( rc < 0 ) {
+                CompleteRequest(rc);
+                return;
+            }
+            state = ST_ERASECOUNT;
+            StartCommand(ACMD_SET_WR_BLK_ERASE_COUNT,r->count,RESP_SHORT);
+            return;
+        case ST_ERASECOUNT:
+            // Only a hint. A card that does not accept it is written anyway
+            StartTransfer();
+            return;
+        case ST_XFERCMD:
+            if( rc < 0 ) {
+                if( r->count > 1 )
+                    StopTransfer(rc);
+                else
+                    CompleteRequest(rc);
+                return;
+            }
+            state = ST_DATA;
+            if( r->op == SD_WRITE )
+                SDMMC1->DCTRL = (9<<SDMMC_DCTRL_DBLOCKSIZE_Pos)|SDMMC_DCTRL_DMAEN
+                               |SDMMC_DCTRL_DTEN;
+            break;                          // the data may have ended too
+        case ST_STOP:
+            if( error == SD_OK )
+                error = rc;
+            if( error < 0 || r->op == SD_READ ) {
+                CompleteRequest(error);
+                return;
+            }
+            polls = 0;
+            StartStatus();
+            return;
+        case ST_STATUS:
+            if( rc < 0 ) {
+                CompleteRequest(rc);
+                return;
+            }
+            if( R1_STATE(SDMMC1->RESP1) == R1_STATE_TRAN
+             && (SDMMC1->RESP1&R1_READY_FOR_DATA) ) {
+                CompleteRequest(SD_OK);
+                return;
+            }
+            if( ++polls < STATUS_POLLS ) {
+                StartCommand(CMD_SEND_STATUS,(uint32_t) card.rca<<16,RESP_SHORT);
+                return;
+            }
+            SDMMC1->MASK = 0;
+            state = ST_PROGRAM;             // SD_ProcessTimeouts asks again
+            return;
+        }
+    }
+
+    // ST_DATA
+    if( sta&STA_DATAERRORS ) {
+        SDMMC1->ICR = STA_DATAERRORS;
+        StopStream();
+        rc = (sta&SDMMC_STA_DCRCFAIL) ? SD_ERROR_CRC
+           : (sta&SDMMC_STA_DTIMEOUT) ? SD_ERROR_TIMEOUT : SD_ERROR_DATA;
+        if( r->count > 1 )
+            StopTransfer(rc);
+        else
+            CompleteRequest(rc);
+        return;
+    }
+    if( (sta&SDMMC_STA_DATAEND) == 0 )
+        return;
+    SDMMC1->ICR = SDMMC_ICR_DATAENDC|SDMMC_ICR_DBCKENDC;
+    // The DMA stream disables itself after the last word (flow control)
+    while( DMASTREAM->CR&DMA_SxCR_EN ) {}
+    if( r->count > 1 ) {
+        StopTransfer(SD_OK);
+    } else if( r->op == SD_WRITE ) {
+        polls = 0;
+        StartStatus();
+    } else {
+        CompleteRequest(SD_OK);
+    }
+}
+
+/**
+ * @brief  SD_Submit
+ *
+ * @note   Appends a request to the queue. It is started at once when the
+ *         driver is idle. The request (and its buffer) must not be changed
+ *         until its status is not SD_PENDING
+ *
+ * @note   Can be called from interrupts, including completion callbacks
+ *
+ * @return SD_OK if queued, negative for invalid parameters
+ */
+int
+SD_Submit( SD_Request *r ) {
+uint32_t primask;
+
+    if( !initialized )
+        return SD_ERROR_NOTINITIALIZED;
+    if( r->count == 0 || r->block >= card.blocks || r->count > card.blocks-r->block
+     || (r->op != SD_READ && r->op != SD_WRITE) || ((uint32_t) r->data&3) )
+        return SD_ERROR_PARAMETER;
+
+    r->status = SD_PENDING;
+    r->next   = 0;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if( last )
+        last->next = r;
+    else
+        first = r;
+    last = r;
+    if( state == ST_IDLE )
+        StartRequest();
+    __set_PRIMASK(primask);
+
+    return SD_OK;
+}
+
+/**
+ * @brief  Blocking transfer built on SD_Submit
+ */
+static int Transfer( uint32_t op, uint32_t block, uint8_t *data, uint32_t count ) {
+SD_Request r;
+int rc;
+
+    r.op       = op;
+    r.block    = block;
+    r.count    = count;
+    r.data     = data;
+    r.callback = 0;
+    r.arg      = 0;
+    rc = SD_Submit(&r);
+    if( rc < 0 )
+        return rc;
+    while( r.status == SD_PENDING ) {}
+    return r.status;
+}
+
+/**
+ * @brief  SD_ReadBlocks
+ */
+int
+SD_ReadBlocks( uint32_t block, uint8_t *data, uint32_t count ) {
+
+    return Transfer(SD_READ,block,data,count);
+}
+
+/**
+ * @brief  SD_WriteBlocks
+ */
+int
+SD_WriteBlocks( uint32_t block, const uint8_t *data, uint32_t count ) {
+
+    return Transfer(SD_WRITE,block,(uint8_t *) data,count);
+}
+
+/**
+ * @brief  SD_ProcessTimeouts
+ *
+ * @note   Must be called every ms
+ */
+void
+SD_ProcessTimeouts( void ) {
+uint32_t primask;
+
+    now++;
+    if( state == ST_IDLE )
+        return;
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if( state != ST_IDLE ) {
+        if( --timer == 0 ) {
+            AbortRequest(SD_ERROR_TIMEOUT);
+        } else if( state == ST_PROGRAM ) {
+            polls = 0;
+            StartStatus();
+        }
+    }
+    __set_PRIMASK(primask);
+}
@@ -0,0 +1,132 @@
+#ifndef SDCARD_H
+#define SDCARD_H
+/**
+ * @file    sdcard.h
+ *
+ * @note    MicroSD block driver using SDMMC1 with a 4 bit bus and DMA
+ *
+ * @note    SD_Init identifies the card at 400 kHz, selects the 4 bit bus and,
+ *          when the card supports it, the high speed mode. The bus clock is
+ *          then 48 MHz (high speed) or 24 MHz (default speed)
+ *
+ * @note    Transfers of many blocks use READ_MULTIPLE_BLOCK (CMD18) and
+ *          WRITE_MULTIPLE_BLOCK (CMD25) with DMA2 Stream 3 and are ended by
+ *          STOP_TRANSMISSION (CMD12). Before a write, SET_WR_BLK_ERASE_COUNT
+ *          (ACMD23) tells the card how many blocks will be written, so it can
+ *          erase them in advance (pre-erase)
+ *
+ * @note    Requests are queued and run one after the other by the SDMMC1
+ *          interrupt, so the CPU can fill a buffer while another one is written.
+ *          SD_ReadBlocks and SD_WriteBlocks are blocking versions built on
+ *          SD_Submit
+ *
+ * @note    SD_ProcessTimeouts must be called every ms (e.g. from SysTick_Handler).
+ *          It counts the timeouts of SD_Init and of the requests and polls the
+ *          card while it programs the written data
+ *
+ * @note    The buffers are accessed by DMA. They must be word aligned and, when
+ *          the data cache is enabled, aligned to 32 bytes (cache line) and
+ *          a multiple of 32 bytes long. Blocks are always 512 bytes
+ *
+ * @note    SDMMCCLK comes from the 48 MHz clock (CK48), that must be generated
+ *          by the P output of PLLSAI (PLLSAIConfiguration_48MHz) before SD_Init
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#define SD_BLOCKSIZE                    512
+
+/**
+ * @brief   Status of a request and return values
+ */
+///@{
+#define SD_OK                           0
+#define SD_PENDING                      1
+#define SD_ERROR_NOCARD                 -1
+#define SD_ERROR_TIMEOUT                -2
+#define SD_ERROR_CRC                    -3
+#define SD_ERROR_CARD                   -4      // error bits in card status
+#define SD_ERROR_UNSUPPORTED            -5
+#define SD_ERROR_DATA                   -6      // FIFO overrun or underrun
+#define SD_ERROR_PARAMETER              -7
+#define SD_ERROR_NOTINITIALIZED         -8
+#define SD_ERROR_NOCLOCK                -9      // PLLSAI not running
+///@}
+
+/**
+ * @brief   Timeouts in ms
+ */
+///@{
+#ifndef SD_INIT_TIMEOUT_MS
+#define SD_INIT_TIMEOUT_MS              1000    // ACMD41 loop
+#endif
+#ifndef SD_REQUEST_TIMEOUT_MS
+#define SD_REQUEST_TIMEOUT_MS           1000    // for each request
+#endif
+///@}
+
+/**
+ * @brief   SDMMC1 interrupt priority
+ */
+#ifndef SD_IRQ_PRIO
+#define SD_IRQ_PRIO                     6
+#endif
+
+/**
+ * @brief   Request operations
+ */
+///@{
+#define SD_READ                         0
+#define SD_WRITE                        1
+///@}
+
+/**
+ * @brief   Completion callback
+ *
+ * @note    Called from the SDMMC1 interrupt with the request status
+ */
+typedef void (*SD_Callback)(void *arg, int status);
+
+/**
+ * @brief   A request
+ *
+ * @note    It must not be changed while its status is SD_PENDING
+ */
+typedef struct SD_Request_s {
+    uint32_t                op;         ///< SD_READ or SD_WRITE
+    uint32_t                block;      ///< first block
+    uint32_t                count;      ///< number of blocks
+    uint8_t                 *data;
+    SD_Callback             callback;   ///< can be null
+    void                    *arg;
+    volatile int            status;     ///< SD_PENDING until completed
+    struct SD_Request_s     *next;      ///< used by the queue
+} SD_Request;
+
+/**
+ * @brief   Card information
+ */
+typedef struct {
+    uint32_t    blocks;                 // capacity in 512 byte blocks
+    uint32_t    busclock;               // Hz
+    uint16_t    rca;                    // relative card address
+    uint8_t     highcapacity;           // SDHC/SDXC (block addressing)
+    uint8_t     highspeed;              // high speed mode selected
+    uint32_t    cid[4];
+    uint32_t    csd[4];
+} SD_CardInfo;
+
+int  SD_Init(void);
+int  SD_IsCardPresent(void);
+int  SD_GetCardInfo(SD_CardInfo *info);
+
+int  SD_Submit(SD_Request *r);
+int  SD_ReadBlocks(uint32_t block, uint8_t *data, uint32_t count);
+int  SD_WriteBlocks(uint32_t block, const uint8_t *data, uint32_t count);
+
+void SD_ProcessTimeouts(void);
+
+#endif // SDCARD_H
@@ -2,11 +2,18 @@
  * @file    ttyemul.c
  *
  * @note    TTY emulation for a UART
+ *
+ * @note    With TTY_USBCDC defined, the I/O goes thru the USB CDC device
+ *          (usbcdc.c) instead of the UART. It must be initialized by main
+ *          (USBCDC_Init) after the clock configuration
  */
 
 #include "ttyemul.h"
 #include "uart.h"
 #include "fifo.h"
+#ifdef TTY_USBCDC
+#include "usbcdc.h"
+#endif
 
 /// Backspace used in line buffered mode
 #define TTY_BS          '\b'
@@ -26,33 +33,75 @@ static unsigned ttyconfig = TTY_IECHO|TTY_OCRLF|TTY_ICRLF|TTY_LINEBUFFERED;
 static const unsigned uartconfig =  UART_NOPARITY | UART_8BITS | UART_STOP_2 |
                                     UART_BAUD_9600;
 
+/**
+ * @brief   Character I/O
+ */
+#ifdef TTY_USBCDC
+#define TTY_WRITECHAR(C)    USBCDC_PutChar(C)
+#define TTY_READCHAR()      USBCDC_GetChar()
+#define TTY_FLUSH()         USBCDC_Flush()
+#else
+#define TTY_WRITECHAR(C)    UART_WriteChar(UART_N,C)
+#define TTY_READCHAR()      UART_ReadChar(UART_N)
+#define TTY_FLUSH()         UART_Flush(UART_N)
+#endif
+
 /**
  *  @brief  tty_init
  */
 int tty_init(int chn) {
 
+#ifndef TTY_USBCDC
     UART_Init(  UART_N,uartconfig );
+#endif
 
     return 0;
 }
 /**
  *  @brief  tty_write
+ *
+ *  @note   For USB, the text between line feeds is written in one call
  */
 int tty_write(int chn, char *ptr, int len) {
 int cnt;
-char ch;
 int i;
+#ifdef TTY_USBCDC
+int k;
+
+    cnt = 0;
+    i = 0;
+    while( i < len ) {
+        for(k=i;k<len&&ptr[k]!='\n';k++) {}
+        if( k > i ) {
+            USBCDC_Write(ptr+i,k-i);
+            cnt += k-i;
+        }
+        if( k < len ) {
+            if( ttyconfig&TTY_OCRLF ) {
+                USBCDC_Write("\r\n",2);
+                cnt += 2;
+            } else {
+                USBCDC_Write("\n",1);
+                cnt++;
+            }
+            k++;
+        }
+        i = k;
+    }
+#else
+char ch;
 
     cnt = 0;
     for (i = 0; i < len; i++) {
         ch = *ptr++;
         if( (ch == '\n') && ttyconfig&TTY_OCRLF ) {
-            UART_WriteChar(UART_N,'\r');
+            TTY_WRITECHAR('\r');
             cnt++;
         }
-        UART_WriteChar(UART_N,ch);
+        TTY_WRITECHAR(ch);
         cnt++;
     }
+#endif
     return cnt;
 }
 
@@ -79,9 +128,9 @@ int cnt;
 int ch;
 
     for(cnt=0;cnt < len;cnt++ ) {
-        ch = UART_ReadChar(UART_N);
+        ch = TTY_READCHAR();
         if( ttyconfig&TTY_IECHO )
-            UART_WriteChar(UART_N,ch);
+            TTY_WRITECHAR(ch);
         ptr[cnt] = ch;
     }
 
@@ -98,18 +147,18 @@ int cnt;
 int ch;
 
     cnt = 0;
-    UART_Flush(UART_N);
-    while ( ((ch=UART_ReadChar(UART_N)) != '\n') && (ch!='\r') ) {
+    TTY_FLUSH();
+    while ( ((ch=TTY_READCHAR()) != '\n') && (ch!='\r') ) {
         if( ch == TTY_BS ) {
             if( cnt > 0 ) {
                 cnt--;
-                UART_WriteChar(UART_N,'\b');
-                UART_WriteChar(UART_N,' ');
-                UART_WriteChar(UART_N,'\b');
+                TTY_WRITECHAR('\b');
+                TTY_WRITECHAR(' ');
+                TTY_WRITECHAR('\b');
             }
         } else {
             if( ttyconfig&TTY_IECHO )
-                UART_WriteChar(UART_N,ch);
+                TTY_WRITECHAR(ch);
             if( cnt < len )         // overflow characters not stored
                 ptr[cnt++] = ch;
         }
@@ -119,8 +168,8 @@ int ch;
         ptr[cnt++] = '\n';
     }
     if(ttyconfig&TTY_ICRLF ) {
-        UART_WriteChar(UART_N,'\r');
-        UART_WriteChar(UART_N,'\n');
+        TTY_WRITECHAR('\r');
+        TTY_WRITECHAR('\n');
     }
     return cnt;
 }
@@ -0,0 +1,189 @@
+/**
+ * @file    usbbulk.c
+ *
+ * @note    USB vendor specific bulk device (see usbbulk.h)
+ *
+ * @note    Interface and endpoints
+ *
+ *          | Interface | Class           | Endpoints                          |
+ *          |-----------|-----------------|------------------------------------|
+ *          | 0         | Vendor (0xFF)   | 0x01 bulk OUT, 0x81 bulk IN        |
+ *
+ * @note    The packets have 64 bytes at full speed and 512 bytes at high
+ *          speed. TX FIFOs (words): EP0 16 and EP1 128 (OTG_FS) or 512
+ *          (OTG_HS, 4 packets)
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <string.h>
+#include "stm32f746xx.h"
+#include "usbd.h"
+#include "usbbulk.h"
+
+/**
+ * @brief   Endpoints
+ */
+///@{
+#define EP_OUT                          0x01
+#define EP_IN                           0x81
+#define MPS                             64
+#define HSMPS                           512
+///@}
+
+#if USBBULK_BUFSIZE%HSMPS != 0 || USBBULK_BUFSIZE/MPS > USBD_MAXPACKETS
+#error "USBBULK_BUFSIZE must be a multiple of 512 with at most 1023 packets of 64 bytes"
+#endif
+
+/**
+ * @brief   Descriptors
+ */
+///@{
+static const uint8_t devicedescriptor[18] = {
+    18, 1,                                  // bLength, DEVICE
+    0x00, 0x02,                             // USB 2.0
+    0x00, 0x00, 0x00,                       // class in the interface
+    USBD_EP0SIZE,
+    0x83, 0x04,                             // idVendor
+    0x30, 0x57,                             // idProduct
+    0x00, 0x02,                             // bcdDevice
+    1, 2, 3,                                // strings
+    1                                       // configurations
+};
+
+static const uint8_t configurationdescriptor[32] = {
+    9, 2, 32, 0, 1, 1, 0, 0x80, 50,         // 1 interface, bus powered 100 mA
+    9, 4, 0, 0, 2, 0xFF, 0x00, 0x00, 0,     // vendor specific
+    7, 5, EP_IN, USBD_EP_BULK, MPS, 0, 0,
+    7, 5, EP_OUT, USBD_EP_BULK, MPS, 0, 0
+};
+
+static const uint8_t hsconfigurationdescriptor[32] = {
+    9, 2, 32, 0, 1, 1, 0, 0x80, 50,
+    9, 4, 0, 0, 2, 0xFF, 0x00, 0x00, 0,
+    7, 5, EP_IN, USBD_EP_BULK, HSMPS&0xFF, HSMPS>>8, 0,
+    7, 5, EP_OUT, USBD_EP_BULK, HSMPS&0xFF, HSMPS>>8, 0
+};
+
+static const char * const strings[] = {
+    "Hans",
+    "STM32F746 Discovery Bulk Test",
+    "0001"
+};
+///@}
+
+/**
+ * @brief   State
+ */
+///@{
+static USBD_Device          device;
+static uint32_t             srcbuf[USBBULK_BUFSIZE/4] __attribute__((aligned(32)));
+static uint32_t             sinkbuf[USBBULK_BUFSIZE/4] __attribute__((aligned(32)));
+static volatile USBBULK_Statistics stats;
+///@}
+
+/**
+ * @brief  Class callbacks
+ *
+ * @note   A transfer is started again as soon as one ends
+ */
+///@{
+static void Configure( USBD_Device *dev, int configured ) {
+uint32_t mps;
+
+    if( configured ) {
+        mps = USBD_IsHighSpeed(dev) ? HSMPS : MPS;
+        USBD_OpenEndpoint(dev,EP_IN,USBD_EP_BULK,mps);
+        USBD_OpenEndpoint(dev,EP_OUT,USBD_EP_BULK,mps);
+        USBD_Transmit(dev,EP_IN,srcbuf,sizeof(srcbuf));
+        USBD_Receive(dev,EP_OUT,sinkbuf,sizeof(sinkbuf));
+    }
+}
+
+static void Transmitted( USBD_Device *dev, uint32_t ep ) {
+
+    if( ep != USBD_EPNUM(EP_IN) )
+        return;
+    stats.inbytes += sizeof(srcbuf);
+    stats.intransfers++;
+    USBD_Transmit(dev,EP_IN,srcbuf,sizeof(srcbuf));
+}
+
+static void Received( USBD_Device *dev, uint32_t ep, uint32_t n ) {
+
+    if( ep != USBD_EPNUM(EP_OUT) )
+        return;
+    stats.outbytes += n;
+    stats.outtransfers++;
+    USBD_Receive(dev,EP_OUT,sinkbuf,sizeof(sinkbuf));
+}
+///@}
+
+static const USBD_Class bulkclass = {
+    .device         = devicedescriptor,
+    .configuration  = configurationdescriptor,
+    .hsconfiguration = hsconfigurationdescriptor,
+    .strings        = strings,
+    .nstrings       = sizeof(strings)/sizeof(strings[0]),
+    .txfifo         = { 16, 128, 0, 0, 0, 0 },
+    .hstxfifo       = { 16, 512, 0, 0, 0, 0 },
+    .configure      = Configure,
+    .setup          = 0,
+    .ep0received    = 0,
+    .transmitted    = Transmitted,
+    .received       = Received,
+    .cleared        = 0
+};
+
+/**
+ * @brief  USBBULK_Init
+ *
+ * @note   For USBD_CORE_FS, PLLSAI must give 48 MHz on its P output
+ */
+int
+USBBULK_Init( int core ) {
+uint32_t i;
+int rc;
+
+    for(i=0;i<USBBULK_BUFSIZE/4;i++)
+        srcbuf[i] = i;
+    memset((void *) &stats,0,sizeof(stats));
+
+    rc = USBD_Init(&device,core,&bulkclass);
+    if( rc < 0 )
+        return rc;
+    USBD_Connect(&device);
+    return USBBULK_OK;
+}
+
+/**
+ * @brief  USBBULK_IsConfigured
+ */
+int
+USBBULK_IsConfigured( void ) {
+
+    return USBD_IsConfigured(&device);
+}
+
+/**
+ * @brief  USBBULK_IsHighSpeed
+ */
+int
+USBBULK_IsHighSpeed( void ) {
+
+    return USBD_IsConfigured(&device) && USBD_IsHighSpeed(&device);
+}
+
+/**
+ * @brief  USBBULK_GetStatistics
+ */
+void
+USBBULK_GetStatistics( USBBULK_Statistics *s ) {
+uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    memcpy(s,(const void *) &stats,sizeof(USBBULK_Statistics));
+    __set_PRIMASK(primask);
+}
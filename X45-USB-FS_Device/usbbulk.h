@@ -0,0 +1,55 @@
+#ifndef USBBULK_H
+#define USBBULK_H
+/**
+ * @file    usbbulk.h
+ *
+ * @note    USB vendor specific device with a bulk IN and a bulk OUT endpoint,
+ *          used to measure the throughput of the device core
+ *
+ * @note    The IN endpoint is a source: it always has a transfer of
+ *          USBBULK_BUFSIZE bytes pending, so the host gets data as fast as it
+ *          reads. The data are 32 bit words counting from 0 in each transfer.
+ *          The OUT endpoint is a sink: the data is received in a buffer and
+ *          discarded
+ *
+ * @note    The counters are free running (they wrap at 4 GB), so the rate is
+ *          the difference between two readings divided by the time between
+ *          them
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "usbd.h"
+
+/**
+ * @brief   Size of a transfer (multiple of 512 and at most 1023 packets)
+ */
+#ifndef USBBULK_BUFSIZE
+#define USBBULK_BUFSIZE                 16384
+#endif
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define USBBULK_OK                      0
+///@}
+
+/**
+ * @brief   Counters
+ */
+typedef struct {
+    uint32_t    inbytes;                // sent to the host
+    uint32_t    outbytes;               // received from the host
+    uint32_t    intransfers;
+    uint32_t    outtransfers;
+} USBBULK_Statistics;
+
+int  USBBULK_Init(int core);
+int  USBBULK_IsConfigured(void);
+int  USBBULK_IsHighSpeed(void);
+void USBBULK_GetStatistics(USBBULK_Statistics *stats);
+
+#endif // USBBULK_H
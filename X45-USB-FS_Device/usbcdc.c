@@ -0,0 +1,406 @@
+/**
+ * @file    usbcdc.c
+ *
+ * @note    USB CDC-ACM device (see usbcdc.h)
+ *
+ * @note    Interfaces and endpoints
+ *
+ *          | Interface | Class           | Endpoints                          |
+ *          |-----------|-----------------|------------------------------------|
+ *          | 0         | Communication   | 0x82 interrupt IN (notifications)  |
+ *          | 1         | Data            | 0x01 bulk OUT, 0x81 bulk IN (64)   |
+ *
+ * @note    TX FIFOs (words): EP0 16, EP1 128 (8 packets) and EP2 16. The RX
+ *          FIFO gets the other 160 words
+ *
+ * @note    At high speed (OTG_HS), the bulk packets have 512 bytes and EP1
+ *          gets 384 words (3 packets). Since the DMA needs word aligned data,
+ *          data not aligned in the TX buffer is copied to txcopy first
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <string.h>
+#include "stm32f746xx.h"
+#include "usbd.h"
+#include "usbcdc.h"
+
+/**
+ * @brief   Endpoints
+ */
+///@{
+#define EP_DATAOUT                      0x01
+#define EP_DATAIN                       0x81
+#define EP_NOTIFY                       0x82
+#define DATAMPS                         64
+#define HSDATAMPS                       512
+#define NOTIFYMPS                       8
+///@}
+
+/**
+ * @brief   Class requests
+ */
+///@{
+#define CDC_SET_LINE_CODING             0x20
+#define CDC_GET_LINE_CODING             0x21
+#define CDC_SET_CONTROL_LINE_STATE      0x22
+#define CDC_SEND_BREAK                  0x23
+
+#define CDC_DTR                         0x01
+///@}
+
+#if (USBCDC_TXBUFSIZE&(USBCDC_TXBUFSIZE-1)) != 0
+#error "USBCDC_TXBUFSIZE must be a power of 2"
+#endif
+#if USBCDC_RXBUFSIZE%HSDATAMPS != 0
+#error "USBCDC_RXBUFSIZE must be a multiple of 512"
+#endif
+
+/**
+ * @brief   Descriptors
+ */
+///@{
+static const uint8_t devicedescriptor[18] = {
+    18, 1,                                  // bLength, DEVICE
+    0x00, 0x02,                             // USB 2.0
+    0x02, 0x00, 0x00,                       // CDC
+    USBD_EP0SIZE,
+    0x83, 0x04,                             // idVendor
+    0x40, 0x57,                             // idProduct
+    0x00, 0x02,                             // bcdDevice
+    1, 2, 3,                                // strings
+    1                                       // configurations
+};
+
+static const uint8_t configurationdescriptor[67] = {
+    9, 2, 67, 0, 2, 1, 0, 0x80, 50,         // 2 interfaces, bus powered 100 mA
+    // Communication interface
+    9, 4, 0, 0, 1, 0x02, 0x02, 0x01, 0,     // CDC, ACM, AT commands
+    5, 0x24, 0x00, 0x10, 0x01,              // Header (CDC 1.10)
+    5, 0x24, 0x01, 0x00, 1,                 // Call management
+    4, 0x24, 0x02, 0x02,                    // ACM (line coding and state)
+    5, 0x24, 0x06, 0, 1,                    // Union
+    7, 5, EP_NOTIFY, USBD_EP_INTERRUPT, NOTIFYMPS, 0, 16,
+    // Data interface
+    9, 4, 1, 0, 2, 0x0A, 0x00, 0x00, 0,
+    7, 5, EP_DATAOUT, USBD_EP_BULK, DATAMPS, 0, 0,
+    7, 5, EP_DATAIN, USBD_EP_BULK, DATAMPS, 0, 0
+};
+
+static const uint8_t hsconfigurationdescriptor[67] = {
+    9, 2, 67, 0, 2, 1, 0, 0x80, 50,
+    9, 4, 0, 0, 1, 0x02, 0x02, 0x01, 0,
+    5, 0x24, 0x00, 0x10, 0x01,
+    5, 0x24, 0x01, 0x00, 1,
+    4, 0x24, 0x02, 0x02,
+    5, 0x24, 0x06, 0, 1,
+    7, 5, EP_NOTIFY, USBD_EP_INTERRUPT, NOTIFYMPS, 0, 8,    // 2^(8-1) microframes
+    9, 4, 1, 0, 2, 0x0A, 0x00, 0x00, 0,
+    7, 5, EP_DATAOUT, USBD_EP_BULK, HSDATAMPS&0xFF, HSDATAMPS>>8, 0,
+    7, 5, EP_DATAIN, USBD_EP_BULK, HSDATAMPS&0xFF, HSDATAMPS>>8, 0
+};
+
+static const char * const strings[] = {
+    "Hans",
+    "STM32F746 Discovery Console",
+    "0001"
+};
+///@}
+
+/**
+ * @brief   State
+ *
+ * @note    txhead is changed only by the writer and txtail only by the
+ *          interrupt (free running counters)
+ */
+///@{
+static USBD_Device          device;
+static uint8_t              linecoding[7] = {
+    0x00, 0xC2, 0x01, 0x00,                 // 115200
+    0, 0, 8                                 // 1 stop bit, no parity, 8 bits
+};
+static volatile uint8_t     dtr = 0;
+static uint32_t             datamps = DATAMPS;
+
+static uint8_t              txbuf[USBCDC_TXBUFSIZE] __attribute__((aligned(4)));
+static uint8_t              txcopy[HSDATAMPS] __attribute__((aligned(4)));
+static volatile uint32_t    txhead = 0;
+static volatile uint32_t    txtail = 0;
+static uint32_t             txsending = 0;
+static uint8_t              txzlp = 0;
+
+static uint8_t              rxbuf[2][USBCDC_RXBUFSIZE] __attribute__((aligned(32)));
+static volatile uint32_t    rxlen[2];
+static volatile uint8_t     rxfull[2];
+static uint32_t             rxpos = 0;
+static uint8_t              rxfill = 0;     // buffer being received
+static uint8_t              rxread = 0;     // buffer being read
+static volatile uint8_t     rxarmed = 0;
+///@}
+
+/**
+ * @brief  Start a transfer of the contiguous data in the TX buffer
+ *
+ * @note   Called in the interrupt or with the interrupts disabled. A transfer
+ *         ending in a full packet is followed by a ZLP when there is nothing
+ *         more to send, so the host returns the data at once
+ */
+static void Kick( void ) {
+uint8_t *p;
+uint32_t tail, n;
+
+    if( txsending || USBD_IsBusy(&device,EP_DATAIN) || !USBD_IsConfigured(&device) )
+        return;
+    tail = txtail&(USBCDC_TXBUFSIZE-1);
+    n = txhead-txtail;
+    if( n > USBCDC_TXBUFSIZE-tail )
+        n = USBCDC_TXBUFSIZE-tail;
+    if( n == 0 ) {
+        if( txzlp ) {
+            txzlp = 0;
+            USBD_Transmit(&device,EP_DATAIN,txbuf,0);
+        }
+        return;
+    }
+    p = txbuf+tail;
+    if( device.dma && (tail&3) ) {
+        if( n > sizeof(txcopy) )
+            n = sizeof(txcopy);
+        memcpy(txcopy,p,n);
+        p = txcopy;
+    }
+    if( USBD_Transmit(&device,EP_DATAIN,p,n) == USBD_OK ) {
+        txsending = n;
+        txzlp = 0;
+    }
+}
+
+/**
+ * @brief  Enable the reception in the free buffer, if there is one
+ */
+static void Arm( void ) {
+
+    if( rxarmed || rxfull[rxfill] )
+        return;
+    if( USBD_Receive(&device,EP_DATAOUT,rxbuf[rxfill],USBCDC_RXBUFSIZE) == USBD_OK )
+        rxarmed = 1;
+}
+
+/**
+ * @brief  Class callbacks
+ */
+///@{
+static void Configure( USBD_Device *dev, int configured ) {
+
+    dtr       = 0;
+    txsending = 0;
+    txzlp     = 0;
+    txtail    = txhead;
+    rxfull[0] = rxfull[1] = 0;
+    rxfill    = rxread = 0;
+    rxpos     = 0;
+    rxarmed   = 0;
+    if( configured ) {
+        datamps = USBD_IsHighSpeed(dev) ? HSDATAMPS : DATAMPS;
+        USBD_OpenEndpoint(dev,EP_NOTIFY,USBD_EP_INTERRUPT,NOTIFYMPS);
+        USBD_OpenEndpoint(dev,EP_DATAIN,USBD_EP_BULK,datamps);
+        USBD_OpenEndpoint(dev,EP_DATAOUT,USBD_EP_BULK,datamps);
+    }
+}
+
+static int Setup( USBD_Device *dev, const USBD_Setup *s ) {
+
+    if( (s->bmRequestType&(USBD_REQ_TYPE|USBD_REQ_RECIPIENT)) != (USBD_REQ_CLASS|USBD_REQ_INTERFACE) )
+        return USBD_ERROR_PARAMETER;
+    switch(s->bRequest) {
+    case CDC_SET_LINE_CODING:
+        return USBD_ControlReceive(dev,linecoding,sizeof(linecoding));
+    case CDC_GET_LINE_CODING:
+        return USBD_ControlSend(dev,linecoding,sizeof(linecoding));
+    case CDC_SET_CONTROL_LINE_STATE:
+        dtr = (s->wValue&CDC_DTR) != 0;
+        if( dtr ) {
+            Arm();
+            Kick();
+        }
+        return USBD_OK;
+    case CDC_SEND_BREAK:
+        return USBD_OK;
+    }
+    return USBD_ERROR_PARAMETER;
+}
+
+static void Transmitted( USBD_Device *dev, uint32_t ep ) {
+
+    if( ep != USBD_EPNUM(EP_DATAIN) )
+        return;
+    if( txsending ) {
+        txzlp = (txsending%datamps) == 0;
+        txtail += txsending;
+        txsending = 0;
+    }
+    Kick();
+}
+
+static void Received( USBD_Device *dev, uint32_t ep, uint32_t n ) {
+
+    if( ep != USBD_EPNUM(EP_DATAOUT) )
+        return;
+    rxarmed = 0;
+    if( n ) {
+        rxlen[rxfill]  = n;
+        rxfull[rxfill] = 1;
+        rxfill ^= 1;
+    }
+    Arm();
+}
+///@}
+
+static const USBD_Class cdcclass = {
+    .device         = devicedescriptor,
+    .configuration  = configurationdescriptor,
+    .hsconfiguration = hsconfigurationdescriptor,
+    .strings        = strings,
+    .nstrings       = sizeof(strings)/sizeof(strings[0]),
+    .txfifo         = { 16, 128, 16, 0, 0, 0 },
+    .hstxfifo       = { 16, 384, 16, 0, 0, 0 },
+    .configure      = Configure,
+    .setup          = Setup,
+    .ep0received    = 0,
+    .transmitted    = Transmitted,
+    .received       = Received,
+    .cleared        = 0
+};
+
+/**
+ * @brief  USBCDC_Init
+ *
+ * @note   PLLSAI must give 48 MHz on its P output
+ */
+int
+USBCDC_Init( int core ) {
+int rc;
+
+    rc = USBD_Init(&device,core,&cdcclass);
+    if( rc < 0 )
+        return rc;
+    USBD_Connect(&device);
+    return USBCDC_OK;
+}
+
+/**
+ * @brief  USBCDC_IsConnected
+ *
+ * @note   Configured and with DTR set by the host
+ */
+int
+USBCDC_IsConnected( void ) {
+
+    return USBD_IsConfigured(&device) && dtr;
+}
+
+/**
+ * @brief  USBCDC_Write
+ *
+ * @note   Copies the data to the TX buffer, waiting for space when it is
+ *         full. Returns n, also when the data is discarded (not connected)
+ */
+int
+USBCDC_Write( const void *data, uint32_t n ) {
+const uint8_t *p = data;
+uint32_t head, k, primask;
+uint32_t left = n;
+
+    while( left ) {
+        if( !USBCDC_IsConnected() )
+            break;
+        k = USBCDC_TXBUFSIZE-(txhead-txtail);
+        if( k == 0 )
+            continue;
+        head = txhead&(USBCDC_TXBUFSIZE-1);
+        if( k > USBCDC_TXBUFSIZE-head )
+            k = USBCDC_TXBUFSIZE-head;
+        if( k > left )
+            k = left;
+        memcpy(txbuf+head,p,k);
+        p    += k;
+        left -= k;
+        __DMB();
+        txhead += k;
+
+        primask = __get_PRIMASK();
+        __disable_irq();
+        Kick();
+        __set_PRIMASK(primask);
+    }
+    return n;
+}
+
+/**
+ * @brief  USBCDC_Read
+ *
+ * @note   Copies up to n received bytes. Returns the number copied (0 when
+ *         there is nothing). Does not wait
+ */
+int
+USBCDC_Read( void *data, uint32_t n ) {
+uint8_t *p = data;
+uint32_t k, cnt, primask;
+
+    cnt = 0;
+    while( cnt < n && rxfull[rxread] ) {
+        k = rxlen[rxread]-rxpos;
+        if( k > n-cnt )
+            k = n-cnt;
+        memcpy(p+cnt,rxbuf[rxread]+rxpos,k);
+        cnt   += k;
+        rxpos += k;
+        if( rxpos >= rxlen[rxread] ) {
+            rxpos = 0;
+            primask = __get_PRIMASK();
+            __disable_irq();
+            rxfull[rxread] = 0;
+            rxread ^= 1;
+            Arm();
+            __set_PRIMASK(primask);
+        }
+    }
+    return cnt;
+}
+
+/**
+ * @brief  USBCDC_PutChar
+ */
+int
+USBCDC_PutChar( int c ) {
+uint8_t b = c;
+
+    USBCDC_Write(&b,1);
+    return c;
+}
+
+/**
+ * @brief  USBCDC_GetChar
+ *
+ * @note   Waits for a character
+ */
+int
+USBCDC_GetChar( void ) {
+uint8_t b;
+
+    while( USBCDC_Read(&b,1) == 0 ) {}
+    return b;
+}
+
+/**
+ * @brief  USBCDC_Flush
+ *
+ * @note   Discards the received data not read yet
+ */
+void
+USBCDC_Flush( void ) {
+uint8_t b[16];
+
+    while( USBCDC_Read(b,sizeof(b)) > 0 ) {}
+}
@@ -0,0 +1,49 @@
+#ifndef USBCDC_H
+#define USBCDC_H
+/**
+ * @file    usbcdc.h
+ *
+ * @note    USB CDC-ACM device (virtual serial port) on the USB device core
+ *
+ * @note    The output goes to a ring buffer. Each time the bulk IN endpoint is
+ *          idle, all the contiguous data of the buffer is sent in one transfer,
+ *          so the FIFO refill in the interrupt is the only per packet work.
+ *          Two receive buffers are used in turn: one is filled by the OUT
+ *          endpoint while the other is read. When both are full, the endpoint
+ *          NAKs (flow control)
+ *
+ * @note    Data is written only when the device is configured and the host
+ *          set DTR (a terminal opened the port). Otherwise it is discarded, so
+ *          the program does not block when there is no terminal
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "usbd.h"
+
+/**
+ * @brief   Buffer sizes
+ */
+///@{
+#define USBCDC_TXBUFSIZE                4096    // power of 2
+#define USBCDC_RXBUFSIZE                512     // each of two, multiple of 512
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define USBCDC_OK                       0
+///@}
+
+int USBCDC_Init(int core);
+int USBCDC_IsConnected(void);
+int USBCDC_Write(const void *data, uint32_t n);
+int USBCDC_Read(void *data, uint32_t n);
+int USBCDC_PutChar(int c);
+int USBCDC_GetChar(void);
+void USBCDC_Flush(void);
+
+#endif // USBCDC_H
@@ -0,0 +1,1382 @@
+/**
+ * @file    usbd.c
+ *
+ * @note    USB device core for OTG_FS and OTG_HS (see usbd.h)
+ *
+ * @note    Pins of the STM32F746 Discovery board (AF10)
+ *
+ *          | Signal | Pin  |   | Signal    | Pin  |   | Signal    | Pin  |
+ *          |--------|------|---|-----------|------|---|-----------|------|
+ *          | DM     | PA11 |   | ULPI_CK   | PA5  |   | ULPI_D3   | PB10 |
+ *          | DP     | PA12 |   | ULPI_STP  | PC0  |   | ULPI_D4   | PB11 |
+ *          |        |      |   | ULPI_DIR  | PC2  |   | ULPI_D5   | PB12 |
+ *          |        |      |   | ULPI_NXT  | PH4  |   | ULPI_D6   | PB13 |
+ *          |        |      |   | ULPI_D0   | PA3  |   | ULPI_D7   | PB5  |
+ *          |        |      |   | ULPI_D1   | PB0  |   |           |      |
+ *          |        |      |   | ULPI_D2   | PB1  |   |           |      |
+ *
+ * @note    The data FIFO RAM of OTG_FS has 1.25 KBytes (320 words) and the one
+ *          of OTG_HS 4 KBytes (1024 words), whose last words keep the DMA
+ *          addresses of the endpoints. The RX FIFO (shared by all OUT
+ *          endpoints) gets the words not used by the TX FIFOs of the class
+ *
+ * @note    With DMA, the SETUP packets are written at DOEPDMA of endpoint 0,
+ *          normally setupbuf, and IN and OUT packets of endpoint 0 go thru
+ *          ep0buf, so the buffers of the class need no alignment
+ *
+ * @note    Endpoint 0 goes thru these states
+ *
+ *          | State     | Waiting for                                   |
+ *          |-----------|-----------------------------------------------|
+ *          | IDLE      | a SETUP packet                                |
+ *          | DATAIN    | the end of a packet of the IN data stage      |
+ *          | DATAOUT   | a packet of the OUT data stage                |
+ *          | STATUSIN  | the end of the IN ZLP of the status stage     |
+ *          | STATUSOUT | the OUT ZLP of the status stage               |
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <string.h>
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "gpio.h"
+#include "usbd.h"
+
+/**
+ * @brief   Register blocks of a core
+ */
+///@{
+#define DEVICE(OTG)     ((USB_OTG_DeviceTypeDef *)((uint32_t)(OTG)+USB_OTG_DEVICE_BASE))
+#define INEP(OTG,I)     ((USB_OTG_INEndpointTypeDef *)((uint32_t)(OTG)+USB_OTG_IN_ENDPOINT_BASE+(I)*USB_OTG_EP_REG_SIZE))
+#define OUTEP(OTG,I)    ((USB_OTG_OUTEndpointTypeDef *)((uint32_t)(OTG)+USB_OTG_OUT_ENDPOINT_BASE+(I)*USB_OTG_EP_REG_SIZE))
+#define FIFO(OTG,I)     ((volatile uint32_t *)((uint32_t)(OTG)+USB_OTG_FIFO_BASE+(I)*USB_OTG_FIFO_SIZE))
+#define PCGCCTL(OTG)    (*(volatile uint32_t *)((uint32_t)(OTG)+USB_OTG_PCGCCTL_BASE))
+///@}
+
+/**
+ * @brief   Fields of the endpoint registers
+ */
+///@{
+#define EPCTL_MPSIZ                     0x7FFU
+#define EPCTL_USBAEP                    (1U<<15)
+#define EPCTL_EPTYP_Pos                 18
+#define EPCTL_STALL                     (1U<<21)
+#define EPCTL_TXFNUM_Pos                22
+#define EPCTL_CNAK                      (1U<<26)
+#define EPCTL_SNAK                      (1U<<27)
+#define EPCTL_SD0PID                    (1U<<28)
+#define EPCTL_EPDIS                     (1U<<30)
+#define EPCTL_EPENA                     (1U<<31)
+
+#define EPTSIZ_XFRSIZ                   0x7FFFFU
+#define EPTSIZ_PKTCNT_Pos               19
+#define EPTSIZ_STUPCNT_Pos              29
+
+#define EPINT_XFRC                      (1U<<0)
+#define EPINT_EPDISD                    (1U<<1)
+#define EPINT_STUP                      (1U<<3)
+#define EPINT_INEPNE                    (1U<<6)
+#define EPINT_TXFE                      (1U<<7)
+#define EPINT_ALL                       0xFB7FU
+
+#define DTXFSTS_INEPTFSAV               0xFFFFU
+///@}
+
+/**
+ * @brief   Fields of GRXSTSP
+ */
+///@{
+#define RXSTS_EPNUM(S)                  ((S)&0xF)
+#define RXSTS_BCNT(S)                   (((S)>>4)&0x7FF)
+#define RXSTS_PKTSTS(S)                 (((S)>>17)&0xF)
+
+#define PKTSTS_OUTDATA                  2
+#define PKTSTS_SETUPDATA                6
+///@}
+
+/**
+ * @brief   Other fields
+ */
+///@{
+#define GRSTCTL_TXFNUM_ALL              (0x10U<<6)
+#define GUSBCFG_TRDT_FS                 (6U<<10)        // HCLK >= 32 MHz
+#define GUSBCFG_TRDT_HS                 (9U<<10)
+#define GAHBCFG_HBSTLEN_INCR4           (3U<<1)
+#define DCFG_DAD_Pos                    4
+#define DCFG_DSPD_HS                    0U
+#define DCFG_DSPD_FSULPI                1U              // full speed, ULPI PHY
+#define DCFG_DSPD_FS                    3U              // internal PHY
+///@}
+
+/**
+ * @brief   Standard requests and descriptor types
+ */
+///@{
+#define REQ_GET_STATUS                  0
+#define REQ_CLEAR_FEATURE               1
+#define REQ_SET_FEATURE                 3
+#define REQ_SET_ADDRESS                 5
+#define REQ_GET_DESCRIPTOR              6
+#define REQ_GET_CONFIGURATION           8
+#define REQ_SET_CONFIGURATION           9
+#define REQ_GET_INTERFACE               10
+#define REQ_SET_INTERFACE               11
+
+#define DESC_DEVICE                     1
+#define DESC_CONFIGURATION              2
+#define DESC_STRING                     3
+#define DESC_DEVICE_QUALIFIER           6
+#define DESC_OTHER_SPEED                7
+
+#define FEATURE_ENDPOINT_HALT           0
+///@}
+
+/**
+ * @brief   States of endpoint 0
+ */
+///@{
+#define EP0_IDLE                        0
+#define EP0_DATAIN                      1
+#define EP0_DATAOUT                     2
+#define EP0_STATUSIN                    3
+#define EP0_STATUSOUT                   4
+///@}
+
+/**
+ * @brief   Configuration
+ */
+///@{
+#define FS_FIFOWORDS                    320
+#define FS_ENDPOINTS                    6
+#define HS_FIFOWORDS                    (1024-2*USBD_MAXEP)
+#define HS_ENDPOINTS                    9
+#define USBD_IRQPRIORITY                6
+#define LOOPTIMEOUT                     1000000
+///@}
+
+/**
+ * @brief   Pins
+ */
+static const GPIO_PinConfiguration fspins[] = {
+    /*  gpio, pin, af, mode, otype, ospeed, pupd, initial */
+    { GPIOA, 11,  10,    2,     0,      3,    0,       0 },     // DM
+    { GPIOA, 12,  10,    2,     0,      3,    0,       0 },     // DP
+    { 0,      0,   0,    0,     0,      0,    0,       0 }
+};
+
+static const GPIO_PinConfiguration hspins[] = {
+    /*  gpio, pin, af, mode, otype, ospeed, pupd, initial */
+    { GPIOA,  5,  10,    2,     0,      3,    0,       0 },     // ULPI_CK
+    { GPIOC,  0,  10,    2,     0,      3,    0,       0 },     // ULPI_STP
+    { GPIOC,  2,  10,    2,     0,      3,    0,       0 },     // ULPI_DIR
+    { GPIOH,  4,  10,    2,     0,      3,    0,       0 },     // ULPI_NXT
+    { GPIOA,  3,  10,    2,     0,      3,    0,       0 },     // ULPI_D0
+    { GPIOB,  0,  10,    2,     0,      3,    0,       0 },     // ULPI_D1
+    { GPIOB,  1,  10,    2,     0,      3,    0,       0 },     // ULPI_D2
+    { GPIOB, 10,  10,    2,     0,      3,    0,       0 },     // ULPI_D3
+    { GPIOB, 11,  10,    2,     0,      3,    0,       0 },     // ULPI_D4
+    { GPIOB, 12,  10,    2,     0,      3,    0,       0 },     // ULPI_D5
+    { GPIOB, 13,  10,    2,     0,      3,    0,       0 },     // ULPI_D6
+    { GPIOB,  5,  10,    2,     0,      3,    0,       0 },     // ULPI_D7
+    { 0,      0,   0,    0,     0,      0,    0,       0 }
+};
+
+/**
+ * @brief   Device of each core (for the interrupt handlers)
+ */
+static USBD_Device *devices[2] = { 0, 0 };
+
+/**
+ * @brief  Cache maintenance over whole lines (DMA)
+ */
+///@{
+static void CleanBuffer( const uint8_t *p, uint32_t n ) {
+uint32_t a = (uint32_t) p&~31U;
+
+    SCB_CleanDCache_by_Addr((uint32_t *) a,(((uint32_t) p+n+31)&~31U)-a);
+}
+
+static void CleanInvalidateBuffer( uint8_t *p, uint32_t n ) {
+uint32_t a = (uint32_t) p&~31U;
+
+    SCB_CleanInvalidateDCache_by_Addr((uint32_t *) a,(((uint32_t) p+n+31)&~31U)-a);
+}
+
+static void InvalidateBuffer( uint8_t *p, uint32_t n ) {
+uint32_t a = (uint32_t) p&~31U;
+
+    SCB_InvalidateDCache_by_Addr((uint32_t *) a,(((uint32_t) p+n+31)&~31U)-a);
+}
+///@}
+
+/**
+ * @brief  Reset the core
+ */
+static int CoreReset( USB_OTG_GlobalTypeDef *otg ) {
+uint32_t n;
+
+    n = 0;
+    while( (otg->GRSTCTL&USB_OTG_GRSTCTL_AHBIDL) == 0 ) {
+        if( ++n > LOOPTIMEOUT )
+            return USBD_ERROR_TIMEOUT;
+    }
+    otg->GRSTCTL |= USB_OTG_GRSTCTL_CSRST;
+    n = 0;
+    while( otg->GRSTCTL&USB_OTG_GRSTCTL_CSRST ) {
+        if( ++n > LOOPTIMEOUT )
+            return USBD_ERROR_TIMEOUT;
+    }
+    return USBD_OK;
+}
+
+/**
+ * @brief  Flush all TX FIFOs and the RX FIFO
+ */
+static void FlushFIFOs( USB_OTG_GlobalTypeDef *otg ) {
+uint32_t n;
+
+    otg->GRSTCTL = USB_OTG_GRSTCTL_TXFFLSH|GRSTCTL_TXFNUM_ALL;
+    n = 0;
+    while( (otg->GRSTCTL&USB_OTG_GRSTCTL_TXFFLSH) && ++n < LOOPTIMEOUT ) {}
+    otg->GRSTCTL = USB_OTG_GRSTCTL_RXFFLSH;
+    n = 0;
+    while( (otg->GRSTCTL&USB_OTG_GRSTCTL_RXFFLSH) && ++n < LOOPTIMEOUT ) {}
+}
+
+/**
+ * @brief  Split the FIFO RAM between the RX FIFO and the TX FIFOs
+ */
+static void ConfigureFIFOs( USBD_Device *dev ) {
+USB_OTG_GlobalTypeDef *otg = dev->otg;
+const uint16_t *txfifo = dev->cls->txfifo;
+uint32_t tx, a, i;
+
+    if( dev->core == USBD_CORE_HS && dev->cls->hsconfiguration )
+        txfifo = dev->cls->hstxfifo;
+    tx = 0;
+    for(i=0;i<dev->neps;i++)
+        tx += txfifo[i];
+
+    a = dev->fifowords-tx;
+    otg->GRXFSIZ = a;
+    otg->DIEPTXF0_HNPTXFSIZ = ((uint32_t) txfifo[0]<<16)|a;
+    a += txfifo[0];
+    for(i=1;i<dev->neps;i++) {
+        otg->DIEPTXF[i-1] = ((uint32_t) txfifo[i]<<16)|a;
+        a += txfifo[i];
+    }
+}
+
+/**
+ * @brief  Read n bytes from the RX FIFO (discarded when p is null)
+ */
+static void ReadFIFO( USBD_Device *dev, uint8_t *p, uint32_t n ) {
+volatile uint32_t *fifo = FIFO(dev->otg,0);
+uint32_t w;
+
+    while( n >= 4 ) {
+        w = *fifo;
+        if( p ) {
+            memcpy(p,&w,4);
+            p += 4;
+        }
+        n -= 4;
+    }
+    if( n ) {
+        w = *fifo;
+        if( p )
+            memcpy(p,&w,n);
+    }
+}
+
+/**
+ * @brief  Write n bytes to the TX FIFO of endpoint ep
+ */
+static void WriteFIFO( USBD_Device *dev, uint32_t ep, const uint8_t *p, uint32_t n ) {
+volatile uint32_t *fifo = FIFO(dev->otg,ep);
+uint32_t w;
+
+    while( n >= 4 ) {
+        memcpy(&w,p,4);
+        *fifo = w;
+        p += 4;
+        n -= 4;
+    }
+    if( n ) {
+        w = 0;
+        memcpy(&w,p,n);
+        *fifo = w;
+    }
+}
+
+/**
+ * @brief  Program an IN transfer of the data in dev->in[ep]
+ *
+ * @note   The packets are written by FillTxFIFO when the TX FIFO is half empty
+ *         or, with DMA, fetched by the core
+ */
+static void StartIn( USBD_Device *dev, uint32_t ep ) {
+USBD_Endpoint *e = &dev->in[ep];
+uint32_t pkt;
+
+    pkt = e->len ? (e->len+e->mps-1)/e->mps : 1;
+    e->count = 0;
+    INEP(dev->otg,ep)->DIEPTSIZ = (pkt<<EPTSIZ_PKTCNT_Pos)|e->len;
+    if( dev->dma ) {
+        if( e->len )
+            CleanBuffer(e->data,e->len);
+        INEP(dev->otg,ep)->DIEPDMA = (uint32_t) e->data;
+        e->count = e->len;
+    }
+    INEP(dev->otg,ep)->DIEPCTL |= EPCTL_CNAK|EPCTL_EPENA;
+    if( e->len && !dev->dma )
+        DEVICE(dev->otg)->DIEPEMPMSK |= 1U<<ep;
+}
+
+/**
+ * @brief  Write packets to the TX FIFO while it has space for them
+ */
+static void FillTxFIFO( USBD_Device *dev, uint32_t ep ) {
+USBD_Endpoint *e = &dev->in[ep];
+USB_OTG_INEndpointTypeDef *in = INEP(dev->otg,ep);
+uint32_t n;
+
+    while( e->count < e->len ) {
+        n = e->len-e->count;
+        if( n > e->mps )
+            n = e->mps;
+        if( (in->DTXFSTS&DTXFSTS_INEPTFSAV) < (n+3)/4 )
+            break;
+        WriteFIFO(dev,ep,e->data+e->count,n);
+        e->count += n;
+    }
+    if( e->count >= e->len )
+        DEVICE(dev->otg)->DIEPEMPMSK &= ~(1U<<ep);
+}
+
+/**
+ * @brief  Prepare endpoint 0 for SETUP packets
+ */
+static void StartSetup( USBD_Device *dev ) {
+
+    OUTEP(dev->otg,0)->DOEPTSIZ = (3U<<EPTSIZ_STUPCNT_Pos)|(1U<<EPTSIZ_PKTCNT_Pos)|(3*8);
+    if( dev->dma ) {
+        // With DMA, the endpoint must be enabled to receive SETUP packets
+        InvalidateBuffer((uint8_t *) dev->setupbuf,sizeof(dev->setupbuf));
+        OUTEP(dev->otg,0)->DOEPDMA = (uint32_t) dev->setupbuf;
+        OUTEP(dev->otg,0)->DOEPCTL |= EPCTL_USBAEP|EPCTL_EPENA;
+    }
+}
+
+/**
+ * @brief  Enable endpoint 0 for one OUT packet (data or status stage)
+ */
+static void StartOut0( USBD_Device *dev ) {
+
+    OUTEP(dev->otg,0)->DOEPTSIZ = (3U<<EPTSIZ_STUPCNT_Pos)|(1U<<EPTSIZ_PKTCNT_Pos)|USBD_EP0SIZE;
+    if( dev->dma ) {
+        InvalidateBuffer((uint8_t *) dev->ep0buf,USBD_EP0SIZE);
+        OUTEP(dev->otg,0)->DOEPDMA = (uint32_t) dev->ep0buf;
+    }
+    OUTEP(dev->otg,0)->DOEPCTL |= EPCTL_CNAK|EPCTL_EPENA;
+}
+
+/**
+ * @brief  Send the next packet of the IN data stage
+ */
+static void SendEP0Packet( USBD_Device *dev ) {
+USBD_Endpoint *e = &dev->in[0];
+uint32_t n;
+
+    n = dev->ep0len-dev->ep0count;
+    if( n > USBD_EP0SIZE )
+        n = USBD_EP0SIZE;
+    e->data = dev->ep0data+dev->ep0count;
+    e->len  = n;
+    if( dev->dma ) {
+        memcpy(dev->ep0buf,e->data,n);
+        e->data = (uint8_t *) dev->ep0buf;
+    }
+    StartIn(dev,0);
+}
+
+/**
+ * @brief  Send the ZLP of the status stage
+ */
+static void SendStatus( USBD_Device *dev ) {
+
+    dev->ep0state = EP0_STATUSIN;
+    dev->in[0].len = 0;
+    StartIn(dev,0);
+}
+
+/**
+ * @brief  Stall endpoint 0 until the next SETUP packet
+ */
+static void StallEP0( USBD_Device *dev ) {
+
+    INEP(dev->otg,0)->DIEPCTL  |= EPCTL_STALL;
+    OUTEP(dev->otg,0)->DOEPCTL |= EPCTL_STALL;
+    dev->ep0state = EP0_IDLE;
+    StartSetup(dev);
+}
+
+/**
+ * @brief  Disable the endpoints other than 0
+ */
+static void CloseEndpoints( USBD_Device *dev ) {
+uint32_t i;
+
+    for(i=1;i<dev->neps;i++) {
+        if( INEP(dev->otg,i)->DIEPCTL&EPCTL_EPENA )
+            INEP(dev->otg,i)->DIEPCTL |= EPCTL_EPDIS|EPCTL_SNAK;
+        INEP(dev->otg,i)->DIEPCTL &= ~(EPCTL_USBAEP|EPCTL_STALL);
+        if( OUTEP(dev->otg,i)->DOEPCTL&EPCTL_EPENA )
+            OUTEP(dev->otg,i)->DOEPCTL |= EPCTL_EPDIS|EPCTL_SNAK;
+        OUTEP(dev->otg,i)->DOEPCTL &= ~(EPCTL_USBAEP|EPCTL_STALL);
+        dev->in[i].busy  = 0;
+        dev->out[i].busy = 0;
+    }
+    DEVICE(dev->otg)->DAINTMSK   = 0x00010001;
+    DEVICE(dev->otg)->DIEPEMPMSK &= 1;
+}
+
+/**
+ * @brief  Build a string descriptor (UTF-16) from an ASCII string
+ */
+static uint32_t StringDescriptor( USBD_Device *dev, uint32_t index ) {
+uint8_t *b = dev->ctrlbuf;
+const char *s;
+uint32_t n;
+
+    if( index == 0 ) {
+        b[0] = 4;
+        b[1] = DESC_STRING;
+        b[2] = 0x09;                        // English (US)
+        b[3] = 0x04;
+        return 4;
+    }
+    if( index > dev->cls->nstrings )
+        return 0;
+    s = dev->cls->strings[index-1];
+    n = 2;
+    while( *s && n+2 <= USBD_CTRLBUFSIZE ) {
+        b[n++] = *s++;
+        b[n++] = 0;
+    }
+    b[0] = n;
+    b[1] = DESC_STRING;
+    return n;
+}
+
+/**
+ * @brief  GET_DESCRIPTOR
+ *
+ * @note   The device qualifier and the other speed configuration exist only
+ *         for a high speed capable device (OTG_HS and a class with a high
+ *         speed configuration). Otherwise they are stalled
+ */
+static int GetDescriptor( USBD_Device *dev, const USBD_Setup *s ) {
+const uint8_t *hs = dev->core == USBD_CORE_HS ? dev->cls->hsconfiguration : 0;
+uint8_t *b = dev->ctrlbuf;
+const uint8_t *d;
+uint32_t n;
+
+    switch(s->wValue>>8) {
+    case DESC_DEVICE:
+        d = dev->cls->device;
+        n = d[0];
+        break;
+    case DESC_CONFIGURATION:
+        d = (hs && dev->speed == USBD_SPEED_HIGH) ? hs : dev->cls->configuration;
+        n = d[2]|(d[3]<<8);
+        break;
+    case DESC_DEVICE_QUALIFIER:
+        if( !hs )
+            return USBD_ERROR_PARAMETER;
+        d = dev->cls->device;
+        b[0] = 10;
+        b[1] = DESC_DEVICE_QUALIFIER;
+        memcpy(b+2,d+2,6);                  // bcdUSB to bMaxPacketSize0
+        b[8] = d[17];                       // configurations
+        b[9] = 0;
+        d = b;
+        n = 10;
+        break;
+    case DESC_OTHER_SPEED:
+        if( !hs )
+            return USBD_ERROR_PARAMETER;
+        d = (dev->speed == USBD_SPEED_HIGH) ? dev->cls->configuration : hs;
+        n = d[2]|(d[3]<<8);
+        if( n > USBD_CTRLBUFSIZE )
+            return USBD_ERROR_PARAMETER;
+        memcpy(b,d,n);
+        b[1] = DESC_OTHER_SPEED;
+        d = b;
+        break;
+    case DESC_STRING:
+        n = StringDescriptor(dev,s->wValue&0xFF);
+        if( n == 0 )
+            return USBD_ERROR_PARAMETER;
+        d = dev->ctrlbuf;
+        break;
+    default:
+        return USBD_ERROR_PARAMETER;
+    }
+    return USBD_ControlSend(dev,d,n);
+}
+
+/**
+ * @brief  SET_CONFIGURATION (only configuration 1)
+ */
+static int SetConfiguration( USBD_Device *dev, uint32_t value ) {
+
+    if( value > 1 || dev->state < USBD_STATE_ADDRESS )
+        return USBD_ERROR_PARAMETER;
+    if( dev->configuration ) {
+        dev->configuration = 0;
+        dev->state = USBD_STATE_ADDRESS;
+        CloseEndpoints(dev);
+        if( dev->cls->configure )
+            dev->cls->configure(dev,0);
+    }
+    if( value ) {
+        dev->configuration = value;
+        dev->state = USBD_STATE_CONFIGURED;
+        if( dev->cls->configure )
+            dev->cls->configure(dev,1);
+    }
+    return USBD_OK;
+}
+
+/**
+ * @brief  Standard requests to the device, an interface or an endpoint
+ *
+ * @note   Returns 1 when the request is not handled here
+ */
+static int StandardRequest( USBD_Device *dev, const USBD_Setup *s ) {
+uint8_t *b = dev->ctrlbuf;
+uint32_t ep;
+
+    switch(s->bmRequestType&USBD_REQ_RECIPIENT) {
+    case USBD_REQ_DEVICE:
+        switch(s->bRequest) {
+        case REQ_GET_STATUS:
+            b[0] = b[1] = 0;                // bus powered, no remote wakeup
+            return USBD_ControlSend(dev,b,2);
+        case REQ_CLEAR_FEATURE:
+        case REQ_SET_FEATURE:
+            return USBD_OK;
+        case REQ_SET_ADDRESS:
+            // The address is used after the status stage (by the core)
+            DEVICE(dev->otg)->DCFG = (DEVICE(dev->otg)->DCFG&~USB_OTG_DCFG_DAD)
+                                    |((s->wValue&0x7F)<<DCFG_DAD_Pos);
+            dev->state = (s->wValue&0x7F) ? USBD_STATE_ADDRESS : USBD_STATE_DEFAULT;
+            return USBD_OK;
+        case REQ_GET_DESCRIPTOR:
+            return GetDescriptor(dev,s);
+        case REQ_GET_CONFIGURATION:
+            b[0] = dev->configuration;
+            return USBD_ControlSend(dev,b,1);
+        case REQ_SET_CONFIGURATION:
+            return SetConfiguration(dev,s->wValue&0xFF);
+        }
+        return USBD_ERROR_PARAMETER;
+    case USBD_REQ_INTERFACE:
+        if( dev->state != USBD_STATE_CONFIGURED )
+            return USBD_ERROR_PARAMETER;
+        switch(s->bRequest) {
+        case REQ_GET_STATUS:
+            b[0] = b[1] = 0;
+            return USBD_ControlSend(dev,b,2);
+        case REQ_GET_INTERFACE:
+            b[0] = 0;                       // no alternate settings
+            return USBD_ControlSend(dev,b,1);
+        case REQ_SET_INTERFACE:
+            return s->wValue == 0 ? USBD_OK : USBD_ERROR_PARAMETER;
+        }
+        return 1;
+    case USBD_REQ_ENDPOINT:
+        ep = USBD_EPNUM(s->wIndex);
+        if( ep >= dev->neps )
+            return USBD_ERROR_PARAMETER;
+        switch(s->bRequest) {
+        case REQ_GET_STATUS:
+            if( s->wIndex&USBD_EPIN )
+                b[0] = (INEP(dev->otg,ep)->DIEPCTL&EPCTL_STALL) ? 1 : 0;
+            else
+                b[0] = (OUTEP(dev->otg,ep)->DOEPCTL&EPCTL_STALL) ? 1 : 0;
+            b[1] = 0;
+            return USBD_ControlSend(dev,b,2);
+        case REQ_SET_FEATURE:
+            if( s->wValue != FEATURE_ENDPOINT_HALT )
+                return USBD_ERROR_PARAMETER;
+            USBD_Stall(dev,s->wIndex);
+            return USBD_OK;
+        case REQ_CLEAR_FEATURE:
+            if( s->wValue != FEATURE_ENDPOINT_HALT )
+                return USBD_ERROR_PARAMETER;
+            // Clearing the halt resets the data toggle
+            if( ep == 0 )
+                return USBD_OK;
+            if( s->wIndex&USBD_EPIN )
+                INEP(dev->otg,ep)->DIEPCTL = (INEP(dev->otg,ep)->DIEPCTL&~EPCTL_STALL)
+                                            |EPCTL_SD0PID;
+            else
+                OUTEP(dev->otg,ep)->DOEPCTL = (OUTEP(dev->otg,ep)->DOEPCTL&~EPCTL_STALL)
+                                             |EPCTL_SD0PID;
+            if( dev->cls->cleared )
+                dev->cls->cleared(dev,s->wIndex&(USBD_EPIN|0x0F));
+            return USBD_OK;
+        }
+        return USBD_ERROR_PARAMETER;
+    }
+    return USBD_ERROR_PARAMETER;
+}
+
+/**
+ * @brief  Process a SETUP packet (in p)
+ *
+ * @note   When no data stage was started, the status stage is an IN ZLP
+ */
+static void SetupReceived( USBD_Device *dev, const uint8_t *p ) {
+USBD_Setup *s = &dev->setup;
+int rc;
+
+    s->bmRequestType = p[0];
+    s->bRequest      = p[1];
+    s->wValue        = p[2]|(p[3]<<8);
+    s->wIndex        = p[4]|(p[5]<<8);
+    s->wLength       = p[6]|(p[7]<<8);
+    dev->ep0state    = EP0_IDLE;
+
+    rc = 1;
+    if( (s->bmRequestType&USBD_REQ_TYPE) == USBD_REQ_STANDARD )
+        rc = StandardRequest(dev,s);
+    if( rc > 0 )
+        rc = dev->cls->setup ? dev->cls->setup(dev,s) : USBD_ERROR_PARAMETER;
+
+    if( rc < 0 ) {
+        StallEP0(dev);
+        return;
+    }
+    if( dev->ep0state == EP0_IDLE ) {
+        if( s->wLength ) {
+            StallEP0(dev);
+            return;
+        }
+        SendStatus(dev);
+    }
+}
+
+/**
+ * @brief  USB reset
+ */
+static void Reset( USBD_Device *dev ) {
+USB_OTG_DeviceTypeDef *d = DEVICE(dev->otg);
+uint32_t i;
+
+    d->DCTL &= ~USB_OTG_DCTL_RWUSIG;
+    FlushFIFOs(dev->otg);
+    for(i=0;i<dev->neps;i++) {
+        INEP(dev->otg,i)->DIEPINT  = EPINT_ALL;
+        OUTEP(dev->otg,i)->DOEPINT = EPINT_ALL;
+    }
+    CloseEndpoints(dev);
+    INEP(dev->otg,0)->DIEPCTL  &= ~EPCTL_STALL;
+    OUTEP(dev->otg,0)->DOEPCTL &= ~EPCTL_STALL;
+    OUTEP(dev->otg,0)->DOEPCTL |= EPCTL_SNAK;
+    dev->in[0].busy = dev->out[0].busy = 0;
+
+    d->DOEPMSK    = EPINT_STUP|EPINT_XFRC|EPINT_EPDISD;
+    d->DIEPMSK    = EPINT_XFRC|EPINT_EPDISD;
+    d->DIEPEMPMSK = 0;
+    d->DCFG      &= ~USB_OTG_DCFG_DAD;
+
+    if( dev->configuration && dev->cls->configure )
+        dev->cls->configure(dev,0);
+    dev->configuration = 0;
+    dev->state    = USBD_STATE_DEFAULT;
+    dev->ep0state = EP0_IDLE;
+    StartSetup(dev);
+}
+
+/**
+ * @brief  End of the enumeration (speed known)
+ */
+static void Enumerated( USBD_Device *dev ) {
+uint32_t trdt;
+
+    // ENUMSPD is 0 at high speed and 1 or 3 at full speed
+    if( (DEVICE(dev->otg)->DSTS&USB_OTG_DSTS_ENUMSPD) == 0 ) {
+        dev->speed = USBD_SPEED_HIGH;
+        trdt = GUSBCFG_TRDT_HS;
+    } else {
+        dev->speed = USBD_SPEED_FULL;
+        trdt = GUSBCFG_TRDT_FS;
+    }
+    INEP(dev->otg,0)->DIEPCTL &= ~EPCTL_MPSIZ;              // 64 bytes
+    dev->in[0].mps = dev->out[0].mps = USBD_EP0SIZE;
+    DEVICE(dev->otg)->DCTL |= USB_OTG_DCTL_CGINAK;
+    dev->otg->GUSBCFG = (dev->otg->GUSBCFG&~USB_OTG_GUSBCFG_TRDT)|trdt;
+}
+
+/**
+ * @brief  Pop an entry of the RX FIFO
+ */
+static void RxFIFOLevel( USBD_Device *dev ) {
+uint32_t sts = dev->otg->GRXSTSP;
+uint32_t ep  = RXSTS_EPNUM(sts);
+uint32_t n   = RXSTS_BCNT(sts);
+USBD_Endpoint *e = &dev->out[ep];
+uint32_t k;
+
+    switch(RXSTS_PKTSTS(sts)) {
+    case PKTSTS_SETUPDATA:
+        if( n == 8 )
+            ReadFIFO(dev,(uint8_t *) dev->setupbuf,8);
+        else
+            ReadFIFO(dev,0,n);
+        break;
+    case PKTSTS_OUTDATA:
+        // Bytes beyond the buffer are discarded (the FIFO is read by words)
+        k = e->data ? e->len-e->count : 0;
+        if( k > n )
+            k = n;
+        if( k ) {
+            ReadFIFO(dev,e->data+e->count,k);
+            e->count += k;
+        }
+        if( (n+3)/4 > (k+3)/4 )
+            ReadFIFO(dev,0,((n+3)/4-(k+3)/4)*4);
+        break;
+    }
+}
+
+/**
+ * @brief  Bytes received by a DMA OUT transfer of len bytes
+ */
+static uint32_t DMAReceived( USBD_Device *dev, uint32_t ep, uint32_t len ) {
+uint32_t left = OUTEP(dev->otg,ep)->DOEPTSIZ&EPTSIZ_XFRSIZ;
+
+    return left < len ? len-left : 0;
+}
+
+/**
+ * @brief  End of an OUT transfer
+ *
+ * @note   With DMA, the count comes from the transfer size left. For
+ *         endpoint 0, the packet is copied from ep0buf
+ */
+static void OutDone( USBD_Device *dev, uint32_t ep ) {
+USBD_Endpoint *e = &dev->out[ep];
+uint32_t n;
+
+    if( dev->dma ) {
+        if( ep != 0 ) {
+            e->count = DMAReceived(dev,ep,e->len);
+            InvalidateBuffer(e->data,e->count);
+        } else if( dev->ep0state == EP0_DATAOUT ) {
+            n = DMAReceived(dev,0,USBD_EP0SIZE);
+            if( n > e->len-e->count )
+                n = e->len-e->count;
+            InvalidateBuffer((uint8_t *) dev->ep0buf,USBD_EP0SIZE);
+            memcpy(e->data+e->count,dev->ep0buf,n);
+            e->count += n;
+        }
+    }
+    if( ep != 0 ) {
+        e->busy = 0;
+        if( dev->cls->received )
+            dev->cls->received(dev,ep,e->count);
+        return;
+    }
+    switch(dev->ep0state) {
+    case EP0_DATAOUT:
+        dev->ep0count = e->count;
+        if( dev->ep0count < dev->ep0len ) {
+            StartOut0(dev);
+            break;
+        }
+        if( dev->cls->ep0received )
+            dev->cls->ep0received(dev);
+        SendStatus(dev);
+        break;
+    case EP0_STATUSOUT:
+        dev->ep0state = EP0_IDLE;
+        StartSetup(dev);
+        break;
+    }
+}
+
+/**
+ * @brief  End of an IN transfer
+ */
+static void InDone( USBD_Device *dev, uint32_t ep ) {
+USBD_Endpoint *e = &dev->in[ep];
+
+    if( ep != 0 ) {
+        e->busy = 0;
+        if( dev->cls->transmitted )
+            dev->cls->transmitted(dev,ep);
+        return;
+    }
+    switch(dev->ep0state) {
+    case EP0_DATAIN:
+        dev->ep0count += e->len;
+        if( dev->ep0count < dev->ep0len ) {
+            SendEP0Packet(dev);
+        } else if( dev->ep0zlp ) {
+            dev->ep0zlp = 0;
+            e->len = 0;
+            StartIn(dev,0);
+        } else {
+            dev->ep0state = EP0_STATUSOUT;
+            dev->out[0].data  = 0;
+            dev->out[0].len   = 0;
+            dev->out[0].count = 0;
+            StartOut0(dev);
+        }
+        break;
+    case EP0_STATUSIN:
+        dev->ep0state = EP0_IDLE;
+        StartSetup(dev);
+        break;
+    }
+}
+
+/**
+ * @brief  Where the last SETUP packet was written
+ *
+ * @note   With DMA, up to 3 back to back SETUP packets are written one after
+ *         the other at DOEPDMA, that is then after the last one. A SETUP
+ *         packet can also come when ep0buf waits for a data or status packet
+ */
+static const uint8_t *LastSetup( USBD_Device *dev ) {
+uint8_t *setupbuf = (uint8_t *) dev->setupbuf;
+uint8_t *ep0buf   = (uint8_t *) dev->ep0buf;
+uint8_t *p;
+
+    if( !dev->dma )
+        return setupbuf;
+    p = (uint8_t *) OUTEP(dev->otg,0)->DOEPDMA-8;
+    if( p >= setupbuf && p <= setupbuf+2*8 ) {
+        InvalidateBuffer(setupbuf,sizeof(dev->setupbuf));
+        return p;
+    }
+    if( p >= ep0buf && p <= ep0buf+USBD_EP0SIZE-8 ) {
+        InvalidateBuffer(ep0buf,USBD_EP0SIZE);
+        return p;
+    }
+    return setupbuf;
+}
+
+/**
+ * @brief  Interrupts of the OUT endpoints
+ */
+static void OutInterrupt( USBD_Device *dev ) {
+USB_OTG_DeviceTypeDef *d = DEVICE(dev->otg);
+uint32_t bits = ((d->DAINT&d->DAINTMSK)>>16)&0xFFFF;
+uint32_t ep, ints;
+
+    for(ep=0;bits;ep++,bits>>=1) {
+        if( (bits&1) == 0 )
+            continue;
+        ints = OUTEP(dev->otg,ep)->DOEPINT&d->DOEPMSK;
+        OUTEP(dev->otg,ep)->DOEPINT = ints;
+        if( ints&EPINT_XFRC )
+            OutDone(dev,ep);
+        if( ints&EPINT_STUP )
+            SetupReceived(dev,LastSetup(dev));
+    }
+}
+
+/**
+ * @brief  Interrupts of the IN endpoints
+ */
+static void InInterrupt( USBD_Device *dev ) {
+USB_OTG_DeviceTypeDef *d = DEVICE(dev->otg);
+uint32_t bits = d->DAINT&d->DAINTMSK&0xFFFF;
+uint32_t ep, ints, mask;
+
+    for(ep=0;bits;ep++,bits>>=1) {
+        if( (bits&1) == 0 )
+            continue;
+        mask = d->DIEPMSK;
+        if( d->DIEPEMPMSK&(1U<<ep) )
+            mask |= EPINT_TXFE;
+        ints = INEP(dev->otg,ep)->DIEPINT&mask;
+        if( ints&EPINT_TXFE )
+            FillTxFIFO(dev,ep);
+        INEP(dev->otg,ep)->DIEPINT = ints&~EPINT_TXFE;
+        if( ints&EPINT_XFRC )
+            InDone(dev,ep);
+    }
+}
+
+/**
+ * @brief  Interrupt handler of a core
+ */
+static void InterruptHandler( USBD_Device *dev ) {
+USB_OTG_GlobalTypeDef *otg = dev->otg;
+uint32_t sts = otg->GINTSTS&otg->GINTMSK;
+
+    if( sts&USB_OTG_GINTSTS_USBRST ) {
+        otg->GINTSTS = USB_OTG_GINTSTS_USBRST;
+        Reset(dev);
+    }
+    if( sts&USB_OTG_GINTSTS_ENUMDNE ) {
+        otg->GINTSTS = USB_OTG_GINTSTS_ENUMDNE;
+        Enumerated(dev);
+    }
+    if( sts&USB_OTG_GINTSTS_RXFLVL ) {
+        while( otg->GINTSTS&USB_OTG_GINTSTS_RXFLVL )
+            RxFIFOLevel(dev);
+    }
+    if( sts&USB_OTG_GINTSTS_OEPINT )
+        OutInterrupt(dev);
+    if( sts&USB_OTG_GINTSTS_IEPINT )
+        InInterrupt(dev);
+    if( sts&USB_OTG_GINTSTS_USBSUSP )
+        otg->GINTSTS = USB_OTG_GINTSTS_USBSUSP;
+    if( sts&USB_OTG_GINTSTS_WKUINT )
+        otg->GINTSTS = USB_OTG_GINTSTS_WKUINT;
+    if( sts&USB_OTG_GINTSTS_SRQINT )
+        otg->GINTSTS = USB_OTG_GINTSTS_SRQINT;
+    if( sts&USB_OTG_GINTSTS_OTGINT )
+        otg->GOTGINT = otg->GOTGINT;
+}
+
+/**
+ * @brief  OTG_FS_IRQHandler
+ */
+void
+OTG_FS_IRQHandler( void ) {
+
+    if( devices[USBD_CORE_FS] )
+        InterruptHandler(devices[USBD_CORE_FS]);
+}
+
+/**
+ * @brief  OTG_HS_Handler (name used in startup_stm32f746.c)
+ */
+void
+OTG_HS_Handler( void ) {
+
+    if( devices[USBD_CORE_HS] )
+        InterruptHandler(devices[USBD_CORE_HS]);
+}
+
+/**
+ * @brief  USBD_Init
+ *
+ * @note   Configures the pins and the core as a device. The device is
+ *         disconnected (soft disconnect) until USBD_Connect
+ *
+ * @note   It can be called again with another class. The device of the
+ *         previous one is then detached (its transfers fail). A device that
+ *         moves to the other core is disconnected from the first one
+ *
+ * @note   On OTG_HS, the core uses its DMA and a class with a high speed
+ *         configuration runs at high speed
+ */
+int
+USBD_Init( USBD_Device *dev, int core, const USBD_Class *cls ) {
+USB_OTG_GlobalTypeDef *otg;
+IRQn_Type irq;
+uint32_t n;
+int rc;
+
+    if( (core != USBD_CORE_FS && core != USBD_CORE_HS)
+        || !cls || !cls->device || !cls->configuration )
+        return USBD_ERROR_PARAMETER;
+    if( core == USBD_CORE_FS && (RCC->CR&RCC_CR_PLLSAIRDY) == 0 )
+        return USBD_ERROR_NOCLOCK;
+
+    irq = (core == USBD_CORE_FS) ? OTG_FS_IRQn : OTG_HS_IRQn;
+    NVIC_DisableIRQ(irq);
+    if( devices[core^1] == dev ) {
+        NVIC_DisableIRQ(dev->irq);
+        DEVICE(dev->otg)->DCTL |= USB_OTG_DCTL_SDIS;
+        devices[core^1] = 0;
+    }
+    // A previous class loses the core
+    if( devices[core] && devices[core] != dev )
+        devices[core]->state = USBD_STATE_DETACHED;
+    memset(dev,0,sizeof(USBD_Device));
+    otg            = (core == USBD_CORE_FS) ? USB_OTG_FS : USB_OTG_HS;
+    dev->otg       = otg;
+    dev->cls       = cls;
+    dev->irq       = irq;
+    dev->core      = core;
+    dev->state     = USBD_STATE_DETACHED;
+    dev->speed     = USBD_SPEED_FULL;
+    dev->in[0].mps = dev->out[0].mps = USBD_EP0SIZE;
+
+    if( core == USBD_CORE_FS ) {
+        dev->fifowords = FS_FIFOWORDS;
+        dev->neps      = FS_ENDPOINTS;
+        dev->dma       = 0;
+        GPIO_ConfigureMultiplePins(fspins);
+
+        // CK48 = PLLSAI P
+        RCC->DCKCFGR2 |= RCC_DCKCFGR2_CK48MSEL;
+        RCC->AHB2ENR  |= RCC_AHB2ENR_OTGFSEN;
+        __DSB();
+        RCC->AHB2RSTR |= RCC_AHB2RSTR_OTGFSRST;
+        RCC->AHB2RSTR &= ~RCC_AHB2RSTR_OTGFSRST;
+
+        otg->GAHBCFG &= ~USB_OTG_GAHBCFG_GINT;
+        otg->GUSBCFG |= USB_OTG_GUSBCFG_PHYSEL;
+        rc = CoreReset(otg);
+        if( rc < 0 )
+            return rc;
+
+        // Internal PHY on
+        otg->GCCFG = USB_OTG_GCCFG_PWRDWN;
+    } else {
+        dev->fifowords = HS_FIFOWORDS;
+        dev->neps      = HS_ENDPOINTS;
+        dev->dma       = 1;
+        GPIO_ConfigureMultiplePins(hspins);
+
+        RCC->AHB1ENR  |= RCC_AHB1ENR_OTGHSEN|RCC_AHB1ENR_OTGHSULPIEN;
+        __DSB();
+        RCC->AHB1RSTR |= RCC_AHB1RSTR_OTGHRST;
+        RCC->AHB1RSTR &= ~RCC_AHB1RSTR_OTGHRST;
+
+        // ULPI PHY, VBUS not driven by the PHY. The reset needs its clock
+        otg->GAHBCFG &= ~USB_OTG_GAHBCFG_GINT;
+        otg->GUSBCFG &= ~(USB_OTG_GUSBCFG_PHYSEL|USB_OTG_GUSBCFG_TSDPS
+                         |USB_OTG_GUSBCFG_ULPIFSLS|USB_OTG_GUSBCFG_ULPIEVBUSD
+                         |USB_OTG_GUSBCFG_ULPIEVBUSI);
+        rc = CoreReset(otg);
+        if( rc < 0 )
+            return rc;
+        otg->GCCFG = 0;
+    }
+
+    // No VBUS sensing (session forced valid)
+    otg->GOTGCTL |= USB_OTG_GOTGCTL_BVALOEN|USB_OTG_GOTGCTL_BVALOVAL;
+
+    // Device mode (takes 25 ms)
+    otg->GUSBCFG = (otg->GUSBCFG&~(USB_OTG_GUSBCFG_FHMOD|USB_OTG_GUSBCFG_TRDT))
+                  |USB_OTG_GUSBCFG_FDMOD|GUSBCFG_TRDT_FS;
+    n = 0;
+    while( otg->GINTSTS&USB_OTG_GINTSTS_CMOD ) {
+        if( ++n > 50*LOOPTIMEOUT )
+            return USBD_ERROR_TIMEOUT;
+    }
+
+    PCGCCTL(otg) = 0;
+    if( core == USBD_CORE_FS )
+        n = DCFG_DSPD_FS;
+    else
+        n = cls->hsconfiguration ? DCFG_DSPD_HS : DCFG_DSPD_FSULPI;
+    DEVICE(otg)->DCFG = (DEVICE(otg)->DCFG&~USB_OTG_DCFG_DSPD)|n;
+    DEVICE(otg)->DCTL |= USB_OTG_DCTL_SDIS;
+
+    ConfigureFIFOs(dev);
+    FlushFIFOs(otg);
+
+    DEVICE(otg)->DIEPMSK    = 0;
+    DEVICE(otg)->DOEPMSK    = 0;
+    DEVICE(otg)->DAINTMSK   = 0;
+    DEVICE(otg)->DIEPEMPMSK = 0;
+    for(n=0;n<dev->neps;n++) {
+        INEP(otg,n)->DIEPCTL  = (n==0) ? 0 : EPCTL_SNAK;
+        INEP(otg,n)->DIEPTSIZ = 0;
+        INEP(otg,n)->DIEPINT  = EPINT_ALL;
+        OUTEP(otg,n)->DOEPCTL  = (n==0) ? 0 : EPCTL_SNAK;
+        OUTEP(otg,n)->DOEPTSIZ = 0;
+        OUTEP(otg,n)->DOEPINT  = EPINT_ALL;
+    }
+
+    otg->GINTSTS = 0xFFFFFFFF;
+    otg->GINTMSK = USB_OTG_GINTMSK_USBRST|USB_OTG_GINTMSK_ENUMDNEM
+                  |USB_OTG_GINTMSK_IEPINT|USB_OTG_GINTMSK_OEPINT
+                  |USB_OTG_GINTMSK_USBSUSPM|USB_OTG_GINTMSK_WUIM
+                  |USB_OTG_GINTMSK_OTGINT|USB_OTG_GINTMSK_SRQIM;
+    if( dev->dma ) {
+        // Bursts of 4 words
+        otg->GAHBCFG = USB_OTG_GAHBCFG_GINT|USB_OTG_GAHBCFG_DMAEN|GAHBCFG_HBSTLEN_INCR4;
+    } else {
+        // TXFE when the TX FIFO is half empty (TXFELVL=0)
+        otg->GINTMSK |= USB_OTG_GINTMSK_RXFLVLM;
+        otg->GAHBCFG  = USB_OTG_GAHBCFG_GINT;
+    }
+
+    devices[core] = dev;
+    NVIC_SetPriority(irq,USBD_IRQPRIORITY);
+    NVIC_ClearPendingIRQ(irq);
+    NVIC_EnableIRQ(irq);
+    return USBD_OK;
+}
+
+/**
+ * @brief  USBD_Connect
+ *
+ * @note   Enables the pull up on DP
+ */
+void
+USBD_Connect( USBD_Device *dev ) {
+
+    DEVICE(dev->otg)->DCTL &= ~USB_OTG_DCTL_SDIS;
+}
+
+/**
+ * @brief  USBD_Disconnect
+ */
+void
+USBD_Disconnect( USBD_Device *dev ) {
+
+    DEVICE(dev->otg)->DCTL |= USB_OTG_DCTL_SDIS;
+}
+
+/**
+ * @brief  USBD_IsConfigured
+ */
+int
+USBD_IsConfigured( USBD_Device *dev ) {
+
+    return dev->state == USBD_STATE_CONFIGURED;
+}
+
+/**
+ * @brief  USBD_IsHighSpeed
+ *
+ * @note   Known after the reset, so it is used by the configure callback to
+ *         choose the packet size of the bulk endpoints
+ */
+int
+USBD_IsHighSpeed( USBD_Device *dev ) {
+
+    return dev->speed == USBD_SPEED_HIGH;
+}
+
+/**
+ * @brief  USBD_OpenEndpoint
+ *
+ * @note   Called by the configure callback. ep is the address (bit 7 set for
+ *         IN). The IN endpoint n uses TX FIFO n
+ */
+int
+USBD_OpenEndpoint( USBD_Device *dev, uint32_t ep, uint32_t type, uint32_t mps ) {
+uint32_t n = USBD_EPNUM(ep);
+USBD_Endpoint *e;
+
+    if( n == 0 || n >= dev->neps || type > USBD_EP_INTERRUPT || mps == 0 || mps > 1024 )
+        return USBD_ERROR_PARAMETER;
+
+    if( ep&USBD_EPIN ) {
+        e = &dev->in[n];
+        INEP(dev->otg,n)->DIEPCTL = mps|(type<<EPCTL_EPTYP_Pos)|(n<<EPCTL_TXFNUM_Pos)
+                                   |EPCTL_SD0PID|EPCTL_USBAEP|EPCTL_SNAK;
+        DEVICE(dev->otg)->DAINTMSK |= 1U<<n;
+    } else {
+        e = &dev->out[n];
+        OUTEP(dev->otg,n)->DOEPCTL = mps|(type<<EPCTL_EPTYP_Pos)
+                                    |EPCTL_SD0PID|EPCTL_USBAEP|EPCTL_SNAK;
+        DEVICE(dev->otg)->DAINTMSK |= 1U<<(16+n);
+    }
+    e->mps  = mps;
+    e->type = type;
+    e->busy = 0;
+    return USBD_OK;
+}
+
+/**
+ * @brief  USBD_Transmit
+ *
+ * @note   Starts an IN transfer of len bytes (at most 1023 packets). A len
+ *         multiple of the packet size is not ended by a ZLP (send it with a
+ *         transfer of length 0). The data must not change until the
+ *         transmitted callback. With DMA, it must be word aligned
+ */
+int
+USBD_Transmit( USBD_Device *dev, uint32_t ep, const void *data, uint32_t len ) {
+uint32_t n = USBD_EPNUM(ep);
+USBD_Endpoint *e;
+
+    if( n == 0 || n >= dev->neps || (dev->dma && ((uint32_t) data&3)) )
+        return USBD_ERROR_PARAMETER;
+    if( dev->state != USBD_STATE_CONFIGURED )
+        return USBD_ERROR_NOTCONFIGURED;
+    e = &dev->in[n];
+    if( e->mps == 0 || (len+e->mps-1)/e->mps > USBD_MAXPACKETS )
+        return USBD_ERROR_PARAMETER;
+    if( e->busy )
+        return USBD_ERROR_BUSY;
+
+    NVIC_DisableIRQ(dev->irq);
+    e->data = (uint8_t *) data;
+    e->len  = len;
+    e->busy = 1;
+    StartIn(dev,n);
+    NVIC_EnableIRQ(dev->irq);
+    return USBD_OK;
+}
+
+/**
+ * @brief  USBD_Receive
+ *
+ * @note   Starts an OUT transfer of up to len bytes (a multiple of the packet
+ *         size). It ends when len bytes or a short packet arrived. Until then,
+ *         the endpoint NAKs when the RX FIFO is full. With DMA, the data must
+ *         be aligned to a cache line (32 bytes)
+ */
+int
+USBD_Receive( USBD_Device *dev, uint32_t ep, void *data, uint32_t len ) {
+uint32_t n = USBD_EPNUM(ep);
+USBD_Endpoint *e;
+uint32_t pkt;
+
+    if( n == 0 || n >= dev->neps || (dev->dma && ((uint32_t) data&31)) )
+        return USBD_ERROR_PARAMETER;
+    if( dev->state != USBD_STATE_CONFIGURED )
+        return USBD_ERROR_NOTCONFIGURED;
+    e = &dev->out[n];
+    if( e->mps == 0 || len == 0 || len%e->mps != 0 )
+        return USBD_ERROR_PARAMETER;
+    pkt = len/e->mps;
+    if( pkt > USBD_MAXPACKETS )
+        return USBD_ERROR_PARAMETER;
+    if( e->busy )
+        return USBD_ERROR_BUSY;
+
+    NVIC_DisableIRQ(dev->irq);
+    e->data  = data;
+    e->len   = len;
+    e->count = 0;
+    e->busy  = 1;
+    OUTEP(dev->otg,n)->DOEPTSIZ = (pkt<<EPTSIZ_PKTCNT_Pos)|len;
+    if( dev->dma ) {
+        CleanInvalidateBuffer(e->data,len);
+        OUTEP(dev->otg,n)->DOEPDMA = (uint32_t) e->data;
+    }
+    OUTEP(dev->otg,n)->DOEPCTL |= EPCTL_CNAK|EPCTL_EPENA;
+    NVIC_EnableIRQ(dev->irq);
+    return USBD_OK;
+}
+
+/**
+ * @brief  USBD_IsBusy
+ */
+int
+USBD_IsBusy( USBD_Device *dev, uint32_t ep ) {
+uint32_t n = USBD_EPNUM(ep);
+
+    if( n >= dev->neps )
+        return 0;
+    return (ep&USBD_EPIN) ? dev->in[n].busy : dev->out[n].busy;
+}
+
+/**
+ * @brief  USBD_Stall
+ *
+ * @note   The halt is cleared by the host (CLEAR_FEATURE)
+ */
+void
+USBD_Stall( USBD_Device *dev, uint32_t ep ) {
+uint32_t n = USBD_EPNUM(ep);
+
+    if( n >= dev->neps )
+        return;
+    if( ep&USBD_EPIN )
+        INEP(dev->otg,n)->DIEPCTL |= EPCTL_STALL;
+    else
+        OUTEP(dev->otg,n)->DOEPCTL |= EPCTL_STALL;
+}
+
+/**
+ * @brief  USBD_Abort
+ *
+ * @note   Stops the transfer of an endpoint (e.g. at a class reset). The data
+ *         not sent yet is flushed from the TX FIFO. No callback is called
+ */
+void
+USBD_Abort( USBD_Device *dev, uint32_t ep ) {
+USB_OTG_INEndpointTypeDef *in;
+USB_OTG_OUTEndpointTypeDef *out;
+uint32_t n = USBD_EPNUM(ep);
+uint32_t k;
+
+    if( n == 0 || n >= dev->neps )
+        return;
+    NVIC_DisableIRQ(dev->irq);
+    if( ep&USBD_EPIN ) {
+        in = INEP(dev->otg,n);
+        if( in->DIEPCTL&EPCTL_EPENA ) {
+            in->DIEPCTL |= EPCTL_SNAK;
+            for(k=0;(in->DIEPINT&EPINT_INEPNE)==0&&k<LOOPTIMEOUT;k++) {}
+            in->DIEPCTL |= EPCTL_EPDIS|EPCTL_SNAK;
+            for(k=0;(in->DIEPINT&EPINT_EPDISD)==0&&k<LOOPTIMEOUT;k++) {}
+            in->DIEPINT = EPINT_EPDISD|EPINT_INEPNE;
+        }
+        dev->otg->GRSTCTL = USB_OTG_GRSTCTL_TXFFLSH|(n<<6);
+        for(k=0;(dev->otg->GRSTCTL&USB_OTG_GRSTCTL_TXFFLSH)&&k<LOOPTIMEOUT;k++) {}
+        DEVICE(dev->otg)->DIEPEMPMSK &= ~(1U<<n);
+        dev->in[n].busy = 0;
+    } else {
+        out = OUTEP(dev->otg,n);
+        if( out->DOEPCTL&EPCTL_EPENA ) {
+            // An OUT endpoint is disabled under the global OUT NAK
+            DEVICE(dev->otg)->DCTL |= USB_OTG_DCTL_SGONAK;
+            for(k=0;(dev->otg->GINTSTS&USB_OTG_GINTSTS_BOUTNAKEFF)==0&&k<LOOPTIMEOUT;k++) {}
+            out->DOEPCTL |= EPCTL_EPDIS|EPCTL_SNAK;
+            for(k=0;(out->DOEPINT&EPINT_EPDISD)==0&&k<LOOPTIMEOUT;k++) {}
+            out->DOEPINT = EPINT_EPDISD;
+            DEVICE(dev->otg)->DCTL |= USB_OTG_DCTL_CGONAK;
+        }
+        dev->out[n].busy = 0;
+        dev->out[n].data = 0;
+    }
+    NVIC_EnableIRQ(dev->irq);
+}
+
+/**
+ * @brief  USBD_ControlSend
+ *
+ * @note   Starts the IN data stage of a control request (from the setup
+ *         callback). The length is limited to wLength and a ZLP is sent when
+ *         the data ends in a full packet before wLength
+ */
+int
+USBD_ControlSend( USBD_Device *dev, const void *data, uint32_t len ) {
+
+    if( len > dev->setup.wLength )
+        len = dev->setup.wLength;
+    dev->ep0data  = (uint8_t *) data;
+    dev->ep0len   = len;
+    dev->ep0count = 0;
+    dev->ep0zlp   = len && len < dev->setup.wLength && len%USBD_EP0SIZE == 0;
+    dev->ep0state = EP0_DATAIN;
+    SendEP0Packet(dev);
+    return USBD_OK;
+}
+
+/**
+ * @brief  USBD_ControlReceive
+ *
+ * @note   Starts the OUT data stage of a control request (from the setup
+ *         callback). The ep0received callback is called when the data arrived
+ */
+int
+USBD_ControlReceive( USBD_Device *dev, void *data, uint32_t len ) {
+
+    if( len > dev->setup.wLength )
+        len = dev->setup.wLength;
+    if( len == 0 )
+        return USBD_ERROR_PARAMETER;
+    dev->ep0data  = data;
+    dev->ep0len   = len;
+    dev->ep0count = 0;
+    dev->ep0state = EP0_DATAOUT;
+    dev->out[0].data  = data;
+    dev->out[0].len   = len;
+    dev->out[0].count = 0;
+    StartOut0(dev);
+    return USBD_OK;
+}
@@ -0,0 +1,1007 @@
+/**
+ * @file    usbmsc.c
+ *
+ * @note    USB mass storage device, Bulk-Only Transport (see usbmsc.h)
+ *
+ * @note    A command goes thru these states
+ *
+ *          | State   | Waiting for                                          |
+ *          |---------|------------------------------------------------------|
+ *          | CBW     | the command block wrapper (OUT)                      |
+ *          | REPLY   | the end of the data of a small reply (IN)            |
+ *          | READ    | the blocks read from the medium and sent (IN)        |
+ *          | WRITE   | the blocks received (OUT) and queued to the medium   |
+ *          | SYNC    | the end of the queued writes                         |
+ *          | CSW     | the end of the command status wrapper (IN)           |
+ *          | CSWWAIT | the host to clear the halt of the IN endpoint        |
+ *          | RESET   | the reset recovery after an invalid CBW              |
+ *
+ * @note    Buffers of the SD card
+ *
+ *          | State   | Meaning                                              |
+ *          |---------|------------------------------------------------------|
+ *          | FREE    | unused                                               |
+ *          | LOADING | being read from the card                             |
+ *          | READY   | read, waiting to be sent                             |
+ *          | SENDING | being sent to the host                               |
+ *          | FILLING | being received from the host                         |
+ *          | WRITING | being written to the card                            |
+ *
+ * @note    A read-ahead buffer (ahead) holds the blocks after the last read.
+ *          It is used by a read starting there and dropped by other commands.
+ *          A buffer dropped while it is being read is marked stale and freed
+ *          when the card is done
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <string.h>
+#include "stm32f746xx.h"
+#include "usbd.h"
+#include "sdcard.h"
+#include "usbmsc.h"
+
+/**
+ * @brief   Endpoints
+ */
+///@{
+#define EP_OUT                          0x01
+#define EP_IN                           0x81
+#define MPS                             64
+#define HSMPS                           512
+///@}
+
+/**
+ * @brief   Bulk-Only Transport
+ */
+///@{
+#define CBW_SIGNATURE                   0x43425355
+#define CSW_SIGNATURE                   0x53425355
+#define CBW_SIZE                        31
+#define CSW_SIZE                        13
+#define CBW_DIRIN                       0x80
+
+#define CSW_PASSED                      0
+#define CSW_FAILED                      1
+#define CSW_PHASEERROR                  2
+
+#define BOT_RESET                       0xFF
+#define BOT_GET_MAX_LUN                 0xFE
+///@}
+
+/**
+ * @brief   SCSI commands
+ */
+///@{
+#define SCSI_TEST_UNIT_READY            0x00
+#define SCSI_REQUEST_SENSE              0x03
+#define SCSI_INQUIRY                    0x12
+#define SCSI_MODE_SENSE6                0x1A
+#define SCSI_START_STOP_UNIT            0x1B
+#define SCSI_PREVENT_ALLOW              0x1E
+#define SCSI_READ_FORMAT_CAPACITIES     0x23
+#define SCSI_READ_CAPACITY10            0x25
+#define SCSI_READ10                     0x28
+#define SCSI_WRITE10                    0x2A
+#define SCSI_VERIFY10                   0x2F
+#define SCSI_SYNCHRONIZE_CACHE10        0x35
+#define SCSI_MODE_SENSE10               0x5A
+///@}
+
+/**
+ * @brief   Sense keys and additional sense codes
+ */
+///@{
+#define SENSE_NONE                      0x00
+#define SENSE_NOT_READY                 0x02
+#define SENSE_MEDIUM_ERROR              0x03
+#define SENSE_ILLEGAL_REQUEST           0x05
+
+#define ASC_WRITE_ERROR                 0x0C
+#define ASC_READ_ERROR                  0x11
+#define ASC_INVALID_COMMAND             0x20
+#define ASC_LBA_OUT_OF_RANGE            0x21
+#define ASC_INVALID_FIELD               0x24
+#define ASC_MEDIUM_NOT_PRESENT          0x3A
+///@}
+
+/**
+ * @brief   States
+ */
+///@{
+#define ST_IDLE                         0       // not configured
+#define ST_CBW                          1
+#define ST_REPLY                        2
+#define ST_READ                         3
+#define ST_WRITE                        4
+#define ST_SYNC                         5
+#define ST_CSW                          6
+#define ST_CSWWAIT                      7
+#define ST_RESET                        8
+
+#define BUF_FREE                        0
+#define BUF_LOADING                     1
+#define BUF_READY                       2
+#define BUF_SENDING                     3
+#define BUF_FILLING                     4
+#define BUF_WRITING                     5
+///@}
+
+/**
+ * @brief   Blocks per transfer of the RAM disk (at most 1023 packets)
+ */
+#define RAMBLOCKS                       64
+
+#define BLOCKSIZE                       512
+
+/**
+ * @brief   Descriptors
+ */
+///@{
+static const uint8_t devicedescriptor[18] = {
+    18, 1,                                  // bLength, DEVICE
+    0x00, 0x02,                             // USB 2.0
+    0x00, 0x00, 0x00,                       // class in the interface
+    USBD_EP0SIZE,
+    0x83, 0x04,                             // idVendor
+    0x20, 0x57,                             // idProduct
+    0x00, 0x02,                             // bcdDevice
+    1, 2, 3,                                // strings
+    1                                       // configurations
+};
+
+static const uint8_t configurationdescriptor[32] = {
+    9, 2, 32, 0, 1, 1, 0, 0x80, 50,         // 1 interface, bus powered 100 mA
+    9, 4, 0, 0, 2, 0x08, 0x06, 0x50, 0,     // mass storage, SCSI, Bulk-Only
+    7, 5, EP_IN, USBD_EP_BULK, MPS, 0, 0,
+    7, 5, EP_OUT, USBD_EP_BULK, MPS, 0, 0
+};
+
+static const uint8_t hsconfigurationdescriptor[32] = {
+    9, 2, 32, 0, 1, 1, 0, 0x80, 50,
+    9, 4, 0, 0, 2, 0x08, 0x06, 0x50, 0,
+    7, 5, EP_IN, USBD_EP_BULK, HSMPS&0xFF, HSMPS>>8, 0,
+    7, 5, EP_OUT, USBD_EP_BULK, HSMPS&0xFF, HSMPS>>8, 0
+};
+
+static const char * const strings[] = {
+    "Hans",
+    "STM32F746 Discovery Disk",
+    "000000000001"                          // at least 12 digits (BOT)
+};
+///@}
+
+/**
+ * @brief   Buffer of the SD card
+ */
+typedef struct {
+    uint8_t         *data;
+    SD_Request      req;
+    uint32_t        block;
+    uint32_t        count;
+    uint8_t         state;
+    uint8_t         ahead;                  // read-ahead
+    uint8_t         stale;                  // dropped while loading
+} Buffer;
+
+/**
+ * @brief   State
+ */
+///@{
+static USBD_Device          device;
+static int                  media = USBMSC_MEDIA_SD;
+static uint8_t              *ramdisk = 0;
+static uint32_t             blocks = 0;
+static int                  ready = 0;
+static volatile uint8_t     state = ST_IDLE;
+
+static uint32_t             mps = MPS;      // of the bulk endpoints
+static uint32_t             cbwbuf[HSMPS/4] __attribute__((aligned(32)));
+static uint8_t              cswbuf[CSW_SIZE] __attribute__((aligned(4)));
+static uint8_t              reply[36] __attribute__((aligned(4)));
+static uint8_t              maxlun = 0;
+
+static uint32_t             tag;
+static uint32_t             datalength;     // dCBWDataTransferLength
+static uint8_t              dirin;
+static uint8_t              status;
+static uint32_t             residue;
+static uint32_t             replylen;
+
+static uint8_t              sensekey = SENSE_NONE;
+static uint8_t              asc = 0;
+static uint8_t              deferred = 0;   // write error not reported yet
+
+static uint32_t             start;          // first block of the command
+static uint32_t             current;        // next block to move over USB
+static uint32_t             next;           // next block to read from the card
+static uint32_t             end;
+static uint32_t             ramcount;       // blocks of the RAM disk transfer
+static uint8_t              readerror;
+
+static uint8_t              sdbuf[2][USBMSC_BUFBLOCKS*BLOCKSIZE] __attribute__((aligned(32)));
+static Buffer               buffers[2];
+
+static USBMSC_Statistics    stats;
+///@}
+
+static void Pump( void );
+
+/**
+ * @brief  Little endian fields (BOT)
+ */
+///@{
+static void PutLE32( uint8_t *p, uint32_t v ) {
+
+    p[0] = v;
+    p[1] = v>>8;
+    p[2] = v>>16;
+    p[3] = v>>24;
+}
+
+static uint32_t GetLE32( const uint8_t *p ) {
+
+    return p[0]|((uint32_t) p[1]<<8)|((uint32_t) p[2]<<16)|((uint32_t) p[3]<<24);
+}
+///@}
+
+/**
+ * @brief  Big endian fields (SCSI)
+ */
+///@{
+static void Put32( uint8_t *p, uint32_t v ) {
+
+    p[0] = v>>24;
+    p[1] = v>>16;
+    p[2] = v>>8;
+    p[3] = v;
+}
+
+static uint32_t Get32( const uint8_t *p ) {
+
+    return ((uint32_t) p[0]<<24)|((uint32_t) p[1]<<16)|((uint32_t) p[2]<<8)|p[3];
+}
+
+static uint32_t Get16( const uint8_t *p ) {
+
+    return ((uint32_t) p[0]<<8)|p[1];
+}
+///@}
+
+/**
+ * @brief  Wait for the next CBW
+ */
+static void ReceiveCBW( void ) {
+
+    state = ST_CBW;
+    USBD_Receive(&device,EP_OUT,cbwbuf,mps);
+}
+
+/**
+ * @brief  Send the CSW with status and residue
+ */
+static void SendCSW( void ) {
+uint8_t *p = cswbuf;
+
+    PutLE32(p,CSW_SIGNATURE);
+    PutLE32(p+4,tag);
+    PutLE32(p+8,residue);
+    p[12] = status;
+    if( status != CSW_PASSED )
+        stats.errors++;
+    state = ST_CSW;
+    USBD_Transmit(&device,EP_IN,cswbuf,CSW_SIZE);
+}
+
+/**
+ * @brief  End of the data sent to the host
+ *
+ * @note   When the host expects more, the IN endpoint is stalled if the data
+ *         did not end in a short packet. The CSW is sent after the host
+ *         clears the halt
+ */
+static void EndDataIn( uint32_t sent ) {
+
+    residue = datalength-sent;
+    if( residue && sent%mps == 0 ) {
+        USBD_Stall(&device,EP_IN);
+        state = ST_CSWWAIT;
+        return;
+    }
+    SendCSW();
+}
+
+/**
+ * @brief  End a command without (more) data
+ *
+ * @note   The endpoint of the data the host expects is stalled
+ */
+static void NoData( void ) {
+
+    residue = datalength;
+    if( datalength == 0 ) {
+        SendCSW();
+    } else if( dirin ) {
+        USBD_Stall(&device,EP_IN);
+        state = ST_CSWWAIT;
+    } else {
+        USBD_Stall(&device,EP_OUT);
+        SendCSW();
+    }
+}
+
+/**
+ * @brief  Fail a command
+ */
+static void Fail( uint8_t key, uint8_t code ) {
+
+    sensekey = key;
+    asc      = code;
+    status   = CSW_FAILED;
+    NoData();
+}
+
+/**
+ * @brief  Send len bytes of reply (at most the length expected by the host)
+ */
+static void SendReply( uint32_t len ) {
+
+    if( datalength && !dirin ) {
+        status = CSW_PHASEERROR;
+        NoData();
+        return;
+    }
+    if( len > datalength )
+        len = datalength;
+    if( len == 0 ) {
+        EndDataIn(0);
+        return;
+    }
+    replylen = len;
+    state = ST_REPLY;
+    USBD_Transmit(&device,EP_IN,reply,len);
+}
+
+/**
+ * @brief  Drop the read-ahead buffer
+ */
+static void DropAhead( void ) {
+Buffer *b;
+int i;
+
+    for(i=0;i<2;i++) {
+        b = &buffers[i];
+        if( !b->ahead )
+            continue;
+        b->ahead = 0;
+        if( b->state == BUF_LOADING )
+            b->stale = 1;
+        else if( b->state == BUF_READY )
+            b->state = BUF_FREE;
+    }
+}
+
+/**
+ * @brief  Completion of a card request (SDMMC1 interrupt)
+ */
+static void SDDone( void *arg, int rc ) {
+Buffer *b = arg;
+uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if( b->state == BUF_LOADING ) {
+        if( b->stale || rc < 0 ) {
+            if( rc < 0 && !b->stale && !b->ahead )
+                readerror = 1;
+            b->state = BUF_FREE;
+            b->stale = 0;
+            b->ahead = 0;
+        } else {
+            b->state = BUF_READY;
+        }
+    } else if( b->state == BUF_WRITING ) {
+        if( rc < 0 )
+            deferred = 1;
+        b->state = BUF_FREE;
+    }
+    Pump();
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Read count blocks from the card into a free buffer
+ */
+static int Load( Buffer *b, uint32_t block, uint32_t count, int ahead ) {
+int rc;
+
+    b->block         = block;
+    b->count         = count;
+    b->ahead         = ahead;
+    b->stale         = 0;
+    b->state         = BUF_LOADING;
+    b->req.op        = SD_READ;
+    b->req.block     = block;
+    b->req.count     = count;
+    b->req.data      = b->data;
+    b->req.callback  = SDDone;
+    b->req.arg       = b;
+    rc = SD_Submit(&b->req);
+    if( rc < 0 ) {
+        b->state = BUF_FREE;
+        b->ahead = 0;
+    }
+    return rc;
+}
+
+/**
+ * @brief  Read the blocks after the last read into a free buffer
+ */
+static void ReadAhead( void ) {
+int i;
+
+    if( media != USBMSC_MEDIA_SD || end >= blocks )
+        return;
+    for(i=0;i<2;i++) {
+        if( buffers[i].state == BUF_FREE ) {
+            Load(&buffers[i],end,blocks-end < USBMSC_BUFBLOCKS ? blocks-end : USBMSC_BUFBLOCKS,1);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief  Advance a READ(10)
+ */
+static void PumpRead( void ) {
+Buffer *b;
+uint32_t k;
+int i;
+
+    if( USBD_IsBusy(&device,EP_IN) )
+        return;
+    if( media == USBMSC_MEDIA_RAM ) {
+        k = end-current;
+        if( k > RAMBLOCKS )
+            k = RAMBLOCKS;
+        ramcount = k;
+        USBD_Transmit(&device,EP_IN,ramdisk+current*BLOCKSIZE,k*BLOCKSIZE);
+        return;
+    }
+
+    if( readerror ) {
+        // Stop the data at the blocks already sent
+        for(i=0;i<2;i++) {
+            b = &buffers[i];
+            if( b->state == BUF_LOADING && !b->ahead )
+                b->stale = 1;
+            else if( b->state == BUF_READY && !b->ahead )
+                b->state = BUF_FREE;
+        }
+        readerror = 0;
+        sensekey  = SENSE_MEDIUM_ERROR;
+        asc       = ASC_READ_ERROR;
+        status    = CSW_FAILED;
+        EndDataIn((current-start)*BLOCKSIZE);
+        return;
+    }
+
+    for(i=0;i<2;i++) {
+        b = &buffers[i];
+        if( b->state == BUF_FREE && next < end ) {
+            k = end-next;
+            if( k > USBMSC_BUFBLOCKS )
+                k = USBMSC_BUFBLOCKS;
+            if( Load(b,next,k,0) < 0 ) {
+                readerror = 1;
+                PumpRead();
+                return;
+            }
+            next += k;
+        }
+    }
+    for(i=0;i<2;i++) {
+        b = &buffers[i];
+        if( b->state == BUF_READY && !b->ahead && b->block == current ) {
+            b->state = BUF_SENDING;
+            USBD_Transmit(&device,EP_IN,b->data,b->count*BLOCKSIZE);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief  Advance a WRITE(10)
+ */
+static void PumpWrite( void ) {
+Buffer *b;
+uint32_t k;
+int i;
+
+    if( current >= end || USBD_IsBusy(&device,EP_OUT) )
+        return;
+    if( media == USBMSC_MEDIA_RAM ) {
+        k = end-current;
+        if( k > RAMBLOCKS )
+            k = RAMBLOCKS;
+        ramcount = k;
+        USBD_Receive(&device,EP_OUT,ramdisk+current*BLOCKSIZE,k*BLOCKSIZE);
+        return;
+    }
+    for(i=0;i<2;i++) {
+        b = &buffers[i];
+        if( b->state == BUF_FREE ) {
+            k = end-current;
+            if( k > USBMSC_BUFBLOCKS )
+                k = USBMSC_BUFBLOCKS;
+            b->block = current;
+            b->count = k;
+            b->ahead = 0;
+            b->state = BUF_FILLING;
+            USBD_Receive(&device,EP_OUT,b->data,k*BLOCKSIZE);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief  SYNCHRONIZE CACHE ends when no write is queued
+ */
+static void CheckSync( void ) {
+int i;
+
+    for(i=0;i<2;i++) {
+        if( buffers[i].state == BUF_WRITING )
+            return;
+    }
+    if( deferred ) {
+        deferred = 0;
+        Fail(SENSE_MEDIUM_ERROR,ASC_WRITE_ERROR);
+        return;
+    }
+    NoData();
+}
+
+/**
+ * @brief  Continue the current command after an event
+ */
+static void Pump( void ) {
+
+    switch(state) {
+    case ST_READ:   PumpRead();     break;
+    case ST_WRITE:  PumpWrite();    break;
+    case ST_SYNC:   CheckSync();    break;
+    }
+}
+
+/**
+ * @brief  Check the range and the data length of READ(10) and WRITE(10)
+ *
+ * @note   Returns 0 when the command was ended
+ */
+static int CheckTransfer( const uint8_t *cb, int in ) {
+uint32_t lba = Get32(cb+2);
+uint32_t n   = Get16(cb+7);
+
+    if( !ready ) {
+        Fail(SENSE_NOT_READY,ASC_MEDIUM_NOT_PRESENT);
+        return 0;
+    }
+    if( lba > blocks || n > blocks-lba ) {
+        Fail(SENSE_ILLEGAL_REQUEST,ASC_LBA_OUT_OF_RANGE);
+        return 0;
+    }
+    if( (datalength && dirin != in) || datalength < n*BLOCKSIZE ) {
+        status = CSW_PHASEERROR;
+        NoData();
+        return 0;
+    }
+    if( n == 0 ) {
+        NoData();
+        return 0;
+    }
+    start = current = next = lba;
+    end = lba+n;
+    return 1;
+}
+
+/**
+ * @brief  READ(10)
+ */
+static void Read( const uint8_t *cb ) {
+Buffer *b;
+int i;
+
+    if( !CheckTransfer(cb,1) )
+        return;
+    stats.readblocks += end-start;
+    readerror = 0;
+    state = ST_READ;
+
+    if( media == USBMSC_MEDIA_SD ) {
+        for(i=0;i<2;i++) {
+            b = &buffers[i];
+            if( !b->ahead )
+                continue;
+            if( b->block == start ) {
+                // Read-ahead hit: the blocks after end are not sent
+                b->ahead = 0;
+                if( b->count > end-start )
+                    b->count = end-start;
+                next = start+b->count;
+                stats.readahead++;
+            }
+        }
+        DropAhead();
+    }
+    PumpRead();
+}
+
+/**
+ * @brief  WRITE(10)
+ */
+static void Write( const uint8_t *cb ) {
+
+    if( !CheckTransfer(cb,0) )
+        return;
+    stats.writeblocks += end-start;
+    DropAhead();
+    state = ST_WRITE;
+    PumpWrite();
+}
+
+/**
+ * @brief  Execute a SCSI command
+ */
+static void Command( const uint8_t *cb ) {
+
+    stats.commands++;
+    status  = CSW_PASSED;
+    residue = 0;
+
+    if( deferred && cb[0] != SCSI_REQUEST_SENSE && cb[0] != SCSI_INQUIRY
+                 && cb[0] != SCSI_SYNCHRONIZE_CACHE10 ) {
+        deferred = 0;
+        Fail(SENSE_MEDIUM_ERROR,ASC_WRITE_ERROR);
+        return;
+    }
+
+    switch(cb[0]) {
+    case SCSI_TEST_UNIT_READY:
+        if( !ready ) {
+            Fail(SENSE_NOT_READY,ASC_MEDIUM_NOT_PRESENT);
+            return;
+        }
+        NoData();
+        break;
+    case SCSI_REQUEST_SENSE:
+        memset(reply,0,18);
+        reply[0]  = 0x70;                   // current error, fixed format
+        reply[2]  = sensekey;
+        reply[7]  = 10;
+        reply[12] = asc;
+        sensekey  = SENSE_NONE;
+        asc       = 0;
+        SendReply(cb[4] < 18 ? cb[4] : 18);
+        break;
+    case SCSI_INQUIRY:
+        if( cb[1]&0x01 ) {                  // no vital product data pages
+            Fail(SENSE_ILLEGAL_REQUEST,ASC_INVALID_FIELD);
+            return;
+        }
+        memset(reply,0,36);
+        reply[0] = 0x00;                    // direct access block device
+        reply[1] = 0x80;                    // removable
+        reply[2] = 0x04;                    // SPC-2
+        reply[3] = 0x02;
+        reply[4] = 36-5;
+        memcpy(reply+8,"STM32F7 ",8);
+        memcpy(reply+16,media==USBMSC_MEDIA_SD?"SD card         ":"RAM disk        ",16);
+        memcpy(reply+32,"1.0 ",4);
+        SendReply(Get16(cb+3) < 36 ? Get16(cb+3) : 36);
+        break;
+    case SCSI_MODE_SENSE6:
+        memset(reply,0,4);
+        reply[0] = 3;                       // not write protected
+        SendReply(cb[4] < 4 ? cb[4] : 4);
+        break;
+    case SCSI_MODE_SENSE10:
+        memset(reply,0,8);
+        reply[1] = 6;
+        SendReply(Get16(cb+7) < 8 ? Get16(cb+7) : 8);
+        break;
+    case SCSI_READ_FORMAT_CAPACITIES:
+        if( !ready ) {
+            Fail(SENSE_NOT_READY,ASC_MEDIUM_NOT_PRESENT);
+            return;
+        }
+        memset(reply,0,12);
+        reply[3] = 8;
+        Put32(reply+4,blocks);
+        Put32(reply+8,(0x02U<<24)|BLOCKSIZE);   // formatted media
+        SendReply(Get16(cb+7) < 12 ? Get16(cb+7) : 12);
+        break;
+    case SCSI_READ_CAPACITY10:
+        if( !ready ) {
+            Fail(SENSE_NOT_READY,ASC_MEDIUM_NOT_PRESENT);
+            return;
+        }
+        Put32(reply,blocks-1);
+        Put32(reply+4,BLOCKSIZE);
+        SendReply(8);
+        break;
+    case SCSI_READ10:
+        Read(cb);
+        break;
+    case SCSI_WRITE10:
+        Write(cb);
+        break;
+    case SCSI_SYNCHRONIZE_CACHE10:
+        state = ST_SYNC;
+        CheckSync();
+        break;
+    case SCSI_START_STOP_UNIT:
+    case SCSI_PREVENT_ALLOW:
+    case SCSI_VERIFY10:
+        NoData();
+        break;
+    default:
+        Fail(SENSE_ILLEGAL_REQUEST,ASC_INVALID_COMMAND);
+        break;
+    }
+}
+
+/**
+ * @brief  A CBW arrived
+ *
+ * @note   An invalid CBW stalls both endpoints until the reset recovery
+ */
+static void CommandReceived( const uint8_t *p, uint32_t n ) {
+
+    if( n != CBW_SIZE || GetLE32(p) != CBW_SIGNATURE || p[14] == 0 || p[14] > 16 ) {
+        state = ST_RESET;
+        USBD_Stall(&device,EP_IN);
+        USBD_Stall(&device,EP_OUT);
+        return;
+    }
+    tag        = GetLE32(p+4);
+    datalength = GetLE32(p+8);
+    dirin      = (p[12]&CBW_DIRIN) != 0;
+    Command(p+15);
+}
+
+/**
+ * @brief  Abort the current command (Bulk-Only reset or USB reset)
+ */
+static void Abort( void ) {
+Buffer *b;
+int i;
+
+    USBD_Abort(&device,EP_IN);
+    USBD_Abort(&device,EP_OUT);
+    for(i=0;i<2;i++) {
+        b = &buffers[i];
+        b->ahead = 0;
+        if( b->state == BUF_LOADING )
+            b->stale = 1;
+        else if( b->state != BUF_WRITING )
+            b->state = BUF_FREE;
+    }
+    readerror = 0;
+}
+
+/**
+ * @brief  Class callbacks
+ */
+///@{
+static void Configure( USBD_Device *dev, int configured ) {
+
+    Abort();
+    state = ST_IDLE;
+    if( configured ) {
+        mps = USBD_IsHighSpeed(dev) ? HSMPS : MPS;
+        USBD_OpenEndpoint(dev,EP_IN,USBD_EP_BULK,mps);
+        USBD_OpenEndpoint(dev,EP_OUT,USBD_EP_BULK,mps);
+        ReceiveCBW();
+    }
+}
+
+static int Setup( USBD_Device *dev, const USBD_Setup *s ) {
+
+    if( (s->bmRequestType&(USBD_REQ_TYPE|USBD_REQ_RECIPIENT)) != (USBD_REQ_CLASS|USBD_REQ_INTERFACE)
+     || s->wIndex != 0 )
+        return USBD_ERROR_PARAMETER;
+    switch(s->bRequest) {
+    case BOT_RESET:
+        if( s->wValue != 0 || s->wLength != 0 )
+            return USBD_ERROR_PARAMETER;
+        // The host then clears the halts of both endpoints
+        Abort();
+        ReceiveCBW();
+        return USBD_OK;
+    case BOT_GET_MAX_LUN:
+        return USBD_ControlSend(dev,&maxlun,1);
+    }
+    return USBD_ERROR_PARAMETER;
+}
+
+static void Transmitted( USBD_Device *dev, uint32_t ep ) {
+int i;
+
+    switch(state) {
+    case ST_REPLY:
+        EndDataIn(replylen);
+        break;
+    case ST_READ:
+        if( media == USBMSC_MEDIA_RAM ) {
+            current += ramcount;
+        } else {
+            for(i=0;i<2;i++) {
+                if( buffers[i].state == BUF_SENDING ) {
+                    buffers[i].state = BUF_FREE;
+                    current += buffers[i].count;
+                }
+            }
+        }
+        if( current == end ) {
+            EndDataIn((end-start)*BLOCKSIZE);
+            ReadAhead();
+        } else {
+            PumpRead();
+        }
+        break;
+    case ST_CSW:
+        ReceiveCBW();
+        break;
+    }
+}
+
+static void Received( USBD_Device *dev, uint32_t ep, uint32_t n ) {
+Buffer *b = 0;
+int i, rc;
+
+    switch(state) {
+    case ST_CBW:
+        CommandReceived(dev->out[ep].data,n);
+        break;
+    case ST_WRITE:
+        if( media == USBMSC_MEDIA_RAM ) {
+            if( n != ramcount*BLOCKSIZE ) {
+                status = CSW_PHASEERROR;
+                residue = datalength-(current-start)*BLOCKSIZE-n;
+                SendCSW();
+                return;
+            }
+            current += ramcount;
+        } else {
+            for(i=0;i<2;i++) {
+                if( buffers[i].state == BUF_FILLING )
+                    b = &buffers[i];
+            }
+            if( !b )
+                return;
+            if( n != b->count*BLOCKSIZE ) {
+                b->state = BUF_FREE;
+                status = CSW_PHASEERROR;
+                residue = datalength-(current-start)*BLOCKSIZE-n;
+                SendCSW();
+                return;
+            }
+            b->state         = BUF_WRITING;
+            b->req.op        = SD_WRITE;
+            b->req.block     = b->block;
+            b->req.count     = b->count;
+            b->req.data      = b->data;
+            b->req.callback  = SDDone;
+            b->req.arg       = b;
+            rc = SD_Submit(&b->req);
+            if( rc < 0 ) {
+                b->state = BUF_FREE;
+                deferred = 1;
+            }
+            current += b->count;
+        }
+        if( current == end ) {
+            // Write-behind: the last blocks may still be written to the card
+            residue = datalength-(end-start)*BLOCKSIZE;
+            if( residue )
+                USBD_Stall(&device,EP_OUT);
+            if( deferred ) {
+                deferred = 0;
+                sensekey = SENSE_MEDIUM_ERROR;
+                asc      = ASC_WRITE_ERROR;
+                status   = CSW_FAILED;
+            }
+            SendCSW();
+        } else {
+            PumpWrite();
+        }
+        break;
+    }
+}
+
+static void Cleared( USBD_Device *dev, uint32_t ep ) {
+
+    if( state == ST_RESET ) {
+        // Stalled until the reset recovery
+        USBD_Stall(dev,ep);
+        return;
+    }
+    if( ep == EP_IN && state == ST_CSWWAIT )
+        SendCSW();
+}
+///@}
+
+static const USBD_Class mscclass = {
+    .device         = devicedescriptor,
+    .configuration  = configurationdescriptor,
+    .hsconfiguration = hsconfigurationdescriptor,
+    .strings        = strings,
+    .nstrings       = sizeof(strings)/sizeof(strings[0]),
+    .txfifo         = { 16, 128, 0, 0, 0, 0 },
+    .hstxfifo       = { 16, 512, 0, 0, 0, 0 },
+    .configure      = Configure,
+    .setup          = Setup,
+    .ep0received    = 0,
+    .transmitted    = Transmitted,
+    .received       = Received,
+    .cleared        = Cleared
+};
+
+/**
+ * @brief  USBMSC_Init
+ *
+ * @note   For USBMSC_MEDIA_SD, SD_Init must have been called (ram and size
+ *         are not used). For USBMSC_MEDIA_RAM, ram is the RAM disk (aligned
+ *         to 32 bytes, for the DMA of OTG_HS) with size bytes. It is not
+ *         formatted
+ */
+int
+USBMSC_Init( int core, int m, void *ram, uint32_t size ) {
+SD_CardInfo info;
+int rc;
+
+    ready = 0;
+    if( m == USBMSC_MEDIA_SD ) {
+        if( SD_GetCardInfo(&info) < 0 )
+            return USBMSC_ERROR_MEDIA;
+        blocks = info.blocks;
+    } else if( m == USBMSC_MEDIA_RAM ) {
+        if( !ram || ((uint32_t) ram&31) || size < BLOCKSIZE )
+            return USBD_ERROR_PARAMETER;
+        ramdisk = ram;
+        blocks  = size/BLOCKSIZE;
+    } else {
+        return USBD_ERROR_PARAMETER;
+    }
+    media = m;
+    buffers[0].data = sdbuf[0];
+    buffers[1].data = sdbuf[1];
+    memset(&stats,0,sizeof(stats));
+
+    rc = USBD_Init(&device,core,&mscclass);
+    if( rc < 0 )
+        return rc;
+    ready = 1;
+    USBD_Connect(&device);
+    return USBMSC_OK;
+}
+
+/**
+ * @brief  USBMSC_IsConfigured
+ */
+int
+USBMSC_IsConfigured( void ) {
+
+    return USBD_IsConfigured(&device);
+}
+
+/**
+ * @brief  USBMSC_GetStatistics
+ */
+void
+USBMSC_GetStatistics( USBMSC_Statistics *s ) {
+
+    *s = stats;
+}
@@ -0,0 +1,77 @@
+#ifndef USBMSC_H
+#define USBMSC_H
+/**
+ * @file    usbmsc.h
+ *
+ * @note    USB mass storage device (Bulk-Only Transport, SCSI transparent
+ *          command set) on the USB device core
+ *
+ * @note    The medium is the MicroSD card (sdcard.c) or a RAM disk, e.g. in
+ *          the SDRAM. Blocks are 512 bytes
+ *
+ * @note    For the SD card, the data goes thru two buffers of USBMSC_BUFBLOCKS
+ *          blocks. While one is sent to (or received from) the host, the other
+ *          is read from (or written to) the card. After a read, the blocks
+ *          that follow are read in advance (read-ahead), so a sequential read
+ *          finds its first blocks ready. A write is reported complete when its
+ *          last blocks were received and queued to the card (write-behind). A
+ *          write error is then reported by the next command (deferred error)
+ *          and SYNCHRONIZE CACHE waits for the queued writes
+ *
+ * @note    For the RAM disk, the data goes directly between the endpoint
+ *          FIFOs (or the DMA of OTG_HS) and the RAM disk
+ *
+ * @note    On OTG_HS, the device runs at high speed (bulk packets of 512
+ *          bytes)
+ *
+ * @note    Everything runs in the OTG and SDMMC1 interrupts, that must have
+ *          the same priority (USBD_IRQPRIORITY and SD_IRQ_PRIO)
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "usbd.h"
+
+/**
+ * @brief   Media
+ */
+///@{
+#define USBMSC_MEDIA_SD                 0
+#define USBMSC_MEDIA_RAM                1
+///@}
+
+/**
+ * @brief   Buffer size for the SD card (in 512 byte blocks)
+ */
+#ifndef USBMSC_BUFBLOCKS
+#define USBMSC_BUFBLOCKS                32
+#endif
+
+/**
+ * @brief   Return values
+ *
+ * @note    The errors of USBD_Init are also returned
+ */
+///@{
+#define USBMSC_OK                       0
+#define USBMSC_ERROR_MEDIA              -10     // SD card not initialized
+///@}
+
+/**
+ * @brief   Counters
+ */
+typedef struct {
+    uint32_t    commands;
+    uint32_t    readblocks;
+    uint32_t    writeblocks;
+    uint32_t    readahead;              // reads that found their first blocks
+    uint32_t    errors;                 // commands failed
+} USBMSC_Statistics;
+
+int  USBMSC_Init(int core, int media, void *ram, uint32_t size);
+int  USBMSC_IsConfigured(void);
+void USBMSC_GetStatistics(USBMSC_Statistics *stats);
+
+#endif // USBMSC_H
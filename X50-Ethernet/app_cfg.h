@@ -0,0 +1,117 @@
+/*
+*********************************************************************************************************
+*                                            EXAMPLE CODE
+*
+*               This file is provided as an example on how to use Micrium products.
+*
+*               Please feel free to use any application code labeled as 'EXAMPLE CODE' in
+*               your application products.  Example code may be used as is, in whole or in
+*               part, or may be used as a reference only. This file can be modified as
+*               required to meet the end-product requirements.
+*
+*********************************************************************************************************
+*/
+
+/*
+*********************************************************************************************************
+*
+*                                      APPLICATION CONFIGURATION
+*
+*                                            EXAMPLE CODE
+*
+* Filename : app_cfg.h
+*********************************************************************************************************
+*/
+
+#ifndef  _APP_CFG_H_
+#define  _APP_CFG_H_
+
+
+/*
+*********************************************************************************************************
+*                                            INCLUDE FILES
+*********************************************************************************************************
+*/
+
+#include  <stdarg.h>
+#include  <stdio.h>
+
+
+/*
+*********************************************************************************************************
+*                                       MODULE ENABLE / DISABLE
+*********************************************************************************************************
+*/
+
+
+/*
+*********************************************************************************************************
+*                                           TASK PRIORITIES
+*********************************************************************************************************
+*/
+
+#define  APP_CFG_STARTUP_TASK_PRIO          3u
+
+#define  OS_TASK_TMR_PRIO                  (OS_LOWEST_PRIO - 2u)
+
+
+/* The tcpip thread has priority TCPIP_THREAD_PRIO (lwipopts.h), above the application */
+#define  TASKAPP_PRIO                      (10)
+
+/*
+*********************************************************************************************************
+*                                          TASK STACK SIZES
+*                             Size of the task stacks (# of OS_STK entries)
+*********************************************************************************************************
+*/
+
+#define  APP_CFG_STARTUP_TASK_STK_SIZE    512u
+
+#define TASKAPP_STK_SIZE                  512
+
+/*
+*********************************************************************************************************
+*                                     TRACE / DEBUG CONFIGURATION
+*********************************************************************************************************
+*/
+
+#ifndef  TRACE_LEVEL_OFF
+#define  TRACE_LEVEL_OFF                    0u
+#endif
+
+#ifndef  TRACE_LEVEL_INFO
+#define  TRACE_LEVEL_INFO                   1u
+#endif
+
+#ifndef  TRACE_LEVEL_DBG
+#define  TRACE_LEVEL_DBG                    2u
+#endif
+
+#define  APP_TRACE_LEVEL                   TRACE_LEVEL_OFF
+#define  APP_TRACE                         printf
+
+#define  APP_TRACE_INFO(x)    ((APP_TRACE_LEVEL >= TRACE_LEVEL_INFO)  ? (void)(APP_TRACE x) : (void)0)
+#define  APP_TRACE_DBG(x)     ((APP_TRACE_LEVEL >= TRACE_LEVEL_DBG)   ? (void)(APP_TRACE x) : (void)0)
+
+/*
+ * See os_cpu.h for explanation
+ *
+ * CPU_CFG_NVIC_PRIO_BITS
+ *      STM32F746 has 16 priority levels. This means 4 bit encoding.
+ *      See definition of __NVIC_PRIO_BITS in stm32f746.h CMSIS file
+ *
+ * CPU_CFG_KA_IPL_BOUNDARY
+ *      Since the port is using BASEPRI to separate kernel vs non-kernel aware ISR,
+ *      For example, if CPU_CFG_KA_IPL_BOUNDARY is set to 4 then external interrupt priorities
+ *      4-7 will be kernel aware while priorities 0-3 will be use as non-kernel aware.
+ *
+ */
+#define CPU_CFG_KA_IPL_BOUNDARY                 8
+#define CPU_CFG_NVIC_PRIO_BITS                  4
+/*
+*********************************************************************************************************
+*                                             MODULE END
+*********************************************************************************************************
+*/
+
+#endif                                                          /* End of module include.              */
@@ -0,0 +1,262 @@
+/**
+ * @file    bootcache.c
+ *
+ * @note    Configuration of the last good boot in the backup SRAM (see
+ *          bootcache.h)
+ *
+ * @note    The record is in the section .backupram (linker script), that is
+ *          not initialized by the startup code. The backup SRAM is in the
+ *          peripheral region, so it is not cached and is written at once
+ *
+ * @note    Only the reset flags in RCC_CSR decide a warm boot. They are cleared
+ *          here (RMVF), so no other module can read them later
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "crc.h"
+#include "bootcache.h"
+
+/**
+ * @brief   Record header
+ */
+///@{
+#define BOOTCACHE_MAGIC             0x54424F4FU     // "OOBT"
+#define BOOTCACHE_VERSION           1
+#define BOOTCACHE_FLAG_STATE        0x0001          // state saved by a good boot
+#define BOOTCACHE_FLAG_TRIAL        0x0002          // warm boot not completed
+///@}
+
+/**
+ * @brief   Resets after which the hardware state is not trusted
+ */
+#define BOOTCACHE_COLDRESETS    (RCC_CSR_PORRSTF|RCC_CSR_BORRSTF|RCC_CSR_IWDGRSTF \
+                                |RCC_CSR_WWDGRSTF|RCC_CSR_LPWRRSTF)
+
+/**
+ * @brief   Record in the backup SRAM
+ *
+ * @note    The CRC covers all fields before it
+ */
+typedef struct {
+    uint32_t            magic;
+    uint16_t            version;
+    uint16_t            size;
+    uint32_t            flags;
+    uint32_t            warmboots;
+    uint32_t            coldboots;
+    uint32_t            fallbacks;
+    BootCache_State     state;
+    uint32_t            crc;
+} BootCache_Record;
+
+static BootCache_Record record __attribute__((section(".backupram")));
+
+/**
+ * @brief   State of this boot
+ */
+///@{
+static int                  warm = 0;
+static uint32_t             resetflags = 0;
+static uint32_t             markus = 0;         // us until the last mark
+static uint32_t             markcycles = 0;     // DWT->CYCCNT at the last mark
+static uint32_t             markfreq = 0;       // SystemCoreClock since then
+static uint32_t             marks[BOOTCACHE_MARKS];
+///@}
+
+/**
+ * @brief   CRC of the record
+ */
+static uint32_t
+Checksum(void) {
+
+    return CRC_Compute(&CRC_32,&record,offsetof(BootCache_Record,crc));
+}
+
+/**
+ * @brief   Writes the CRC after a change of the record
+ */
+static void
+Seal(void) {
+
+    record.crc = Checksum();
+    __DSB();
+}
+
+/**
+ * @brief   Returns 1 when the record has the layout of this firmware and a
+ *          right CRC
+ */
+static int
+Valid(void) {
+
+    return record.magic == BOOTCACHE_MAGIC
+        && record.version == BOOTCACHE_VERSION
+        && record.size == sizeof(BootCache_Record)
+        && record.crc == Checksum();
+}
+
+/**
+ * @brief   BootCache_Init
+ *
+ * @note    Must be called first in main, before the clock is changed. Enables
+ *          the backup SRAM and the cycle counter and finds the reset cause.
+ *          Returns BOOTCACHE_WARM when BootCache_Get has a state to use
+ */
+int
+BootCache_Init(void) {
+int valid;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;                  // Unlock access on Cortex-M7
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    markcycles = DWT->CYCCNT;
+    markfreq   = SystemCoreClock;
+    markus     = 0;
+    memset(marks,0,sizeof(marks));
+
+    // Write access to the backup domain needs the PWR clock and DBP
+    RCC->APB1ENR |= RCC_APB1ENR_PWREN;
+    __DSB();
+    PWR->CR1 |= PWR_CR1_DBP;
+    RCC->AHB1ENR |= RCC_AHB1ENR_BKPSRAMEN;
+    __DSB();
+
+    resetflags = RCC->CSR;
+    RCC->CSR |= RCC_CSR_RMVF;
+
+    valid = Valid();
+    if( !valid ) {
+        memset(&record,0,sizeof(record));
+        record.magic   = BOOTCACHE_MAGIC;
+        record.version = BOOTCACHE_VERSION;
+        record.size    = sizeof(BootCache_Record);
+    }
+
+    warm = 0;
+    if( valid && !(resetflags&BOOTCACHE_COLDRESETS)
+              && (record.flags&BOOTCACHE_FLAG_STATE) ) {
+        if( record.flags&BOOTCACHE_FLAG_TRIAL ) {
+            // The last warm boot did not reach BootCache_Save
+            record.fallbacks++;
+        } else {
+            record.flags |= BOOTCACHE_FLAG_TRIAL;
+            record.warmboots++;
+            warm = 1;
+        }
+    }
+    if( !warm )
+        record.coldboots++;
+    Seal();
+
+    return warm ? BOOTCACHE_WARM : BOOTCACHE_COLD;
+}
+
+/**
+ * @brief   BootCache_IsWarm
+ */
+int
+BootCache_IsWarm(void) {
+
+    return warm;
+}
+
+/**
+ * @brief   BootCache_Get
+ *
+ * @note    State saved by the last good boot, NULL when this boot is cold
+ */
+const BootCache_State *
+BootCache_Get(void) {
+
+    return warm ? &record.state : NULL;
+}
+
+/**
+ * @brief   BootCache_Save
+ *
+ * @note    Writes the state of this boot and ends the trial of a warm boot.
+ *          Called when the boot is complete and each time the state changes
+ */
+int
+BootCache_Save(const BootCache_State *st) {
+
+    if( st == NULL )
+        return BOOTCACHE_ERROR_PARAM;
+    if( st != &record.state )
+        record.state = *st;
+    record.flags = BOOTCACHE_FLAG_STATE;
+    Seal();
+    return BOOTCACHE_OK;
+}
+
+/**
+ * @brief   BootCache_Invalidate
+ *
+ * @note    The next boot is cold (e.g. after a change of configuration)
+ */
+void
+BootCache_Invalidate(void) {
+
+    record.flags = 0;
+    Seal();
+}
+
+/**
+ * @brief   BootCache_Mark
+ *
+ * @note    Time of a step of the boot. The cycles since the last mark are
+ *          converted with the SystemCoreClock of that mark. The cycle counter
+ *          wraps after 21 s at 200 MHz, so a mark later than that is wrong
+ */
+void
+BootCache_Mark(int mark) {
+uint32_t now = DWT->CYCCNT;
+
+    if( mark < 0 || mark >= BOOTCACHE_MARKS )
+        return;
+    markus    += (now-markcycles)/(markfreq/1000000);
+    markcycles = now;
+    markfreq   = SystemCoreClock;
+    marks[mark] = markus;
+}
+
+/**
+ * @brief   BootCache_GetStats
+ */
+void
+BootCache_GetStats(BootCache_Stats *st) {
+
+    st->warmboots  = record.warmboots;
+    st->coldboots  = record.coldboots;
+    st->fallbacks  = record.fallbacks;
+    st->resetflags = resetflags;
+    memcpy(st->mark,marks,sizeof(st->mark));
+}
+
+/**
+ * @brief   BootCache_Report
+ *
+ * @note    Prints a line with the steps of this boot
+ *
+ *          BOOT,warm|cold,clock_us,sdram_us,network_us,link_us,warmboots,coldboots,fallbacks
+ */
+void
+BootCache_Report(void) {
+
+    printf("BOOT,%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n",warm?"warm":"cold",
+            (unsigned long) marks[BOOTCACHE_MARK_CLOCK],
+            (unsigned long) marks[BOOTCACHE_MARK_SDRAM],
+            (unsigned long) marks[BOOTCACHE_MARK_NETWORK],
+            (unsigned long) marks[BOOTCACHE_MARK_LINK],
+            (unsigned long) record.warmboots,(unsigned long) record.coldboots,
+            (unsigned long) record.fallbacks);
+}
@@ -0,0 +1,102 @@
+#ifndef BOOTCACHE_H
+#define BOOTCACHE_H
+/**
+ * @file    bootcache.h
+ *
+ * @note    Configuration found by the last good boot, kept in the backup SRAM
+ *          (4 KB at 0x4002_4000) for the next warm reset
+ *
+ * @note    The backup SRAM keeps its contents while VDD (or VBAT) is present.
+ *          A record has a header and a CRC-32 (crc.c, in software before
+ *          CRC_Init). BootCache_Init finds the reset cause in RCC_CSR: after a
+ *          software or pin reset, a valid record is given by BootCache_Get and
+ *          the boot can skip the probing (see main.c). After a power on, a brown
+ *          out, a watchdog or a low power reset, the boot is cold
+ *
+ * @note    A warm boot marks the record as in trial. BootCache_Save, called
+ *          when the boot reached the link up, writes the new state and ends
+ *          the trial. When a warm boot never gets there (a reset or the
+ *          watchdog), the next boot finds the trial mark and is cold
+ *
+ * @note    BootCache_Mark stores the time since BootCache_Init at each step of
+ *          the boot, using the DWT cycle counter and the SystemCoreClock of the
+ *          interval, so the steps before the PLL are counted at 16 MHz (HSI)
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "system_stm32f746.h"
+
+/**
+ * @brief   Parameters
+ */
+///@{
+#ifndef BOOTCACHE_CALIBRATIONS
+#define BOOTCACHE_CALIBRATIONS      8       ///< words for calibration values
+#endif
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define BOOTCACHE_COLD              (0)
+#define BOOTCACHE_WARM              (1)
+#define BOOTCACHE_OK                (0)
+#define BOOTCACHE_ERROR_PARAM       (-1)
+///@}
+
+/**
+ * @brief   Steps of the boot (BootCache_Mark)
+ */
+///@{
+#define BOOTCACHE_MARK_CLOCK        0       ///< PLL running
+#define BOOTCACHE_MARK_SDRAM        1       ///< SDRAM initialized
+#define BOOTCACHE_MARK_NETWORK      2       ///< lwIP and ETH initialized
+#define BOOTCACHE_MARK_LINK         3       ///< link up
+#define BOOTCACHE_MARKS             4
+///@}
+
+/**
+ * @brief   State kept across resets
+ *
+ * @note    Addresses in network order (ip4_addr_t). Calibration values are
+ *          free for the modules that measure something at boot
+ */
+typedef struct {
+    PLLConfiguration_t  pll;                ///< main PLL of the last good boot
+    uint32_t    linkinfo;                   ///< ETH_LINKINFO_* of the last link
+    uint32_t    ipaddr;                     ///< last address (lease)
+    uint32_t    netmask;
+    uint32_t    gateway;
+    uint32_t    calibration[BOOTCACHE_CALIBRATIONS];
+} BootCache_State;
+
+/**
+ * @brief   Statistics
+ *
+ * @note    Kept in the record, so they count the boots since the last cold
+ *          start that found a valid record. fallbacks are the warm resets that
+ *          found the trial mark of a boot that did not complete
+ */
+typedef struct {
+    uint32_t    warmboots;                  ///< warm boots using the record
+    uint32_t    coldboots;
+    uint32_t    fallbacks;
+    uint32_t    resetflags;                 ///< RCC_CSR of this boot
+    uint32_t    mark[BOOTCACHE_MARKS];      ///< us since BootCache_Init
+} BootCache_Stats;
+
+int  BootCache_Init(void);
+int  BootCache_IsWarm(void);
+const BootCache_State *BootCache_Get(void);
+int  BootCache_Save(const BootCache_State *st);
+void BootCache_Invalidate(void);
+void BootCache_Mark(int mark);
+void BootCache_GetStats(BootCache_Stats *st);
+void BootCache_Report(void);
+
+#endif // BOOTCACHE_H
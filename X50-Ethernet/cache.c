@@ -0,0 +1,189 @@
+/**
+ * @file    cache.c
+ *
+ * @note    MPU configuration and cache maintenance for DMA buffers
+ *
+ * @note    Without MPU, the SDRAM at 0xC0000000 is in the external device area of
+ *          the default memory map: not cacheable and not executable and every
+ *          unaligned access faults. Cache_Init changes it to
+ *
+ *          | Region | Area                  | Type                        |
+ *          |--------|-----------------------|-----------------------------|
+ *          |   0    | SDRAM (8 MB)          | normal, write through       |
+ *          |   1    | .nocache section      | normal, not cacheable       |
+ *          |   2    | .sram2 section        | normal, not cacheable       |
+ *
+ *          Write through keeps the frame buffers coherent with the LTDC, which
+ *          reads them while the CPU draws, without cleaning the cache.
+ *
+ * @note    The .nocache section is defined in the linker script. Its size must
+ *          be a power of 2 (at least 32 bytes) and it must be aligned to its size.
+ *          When the linker script does not have it, region 1 is not used.
+ *          The same holds for the .sram2 section (SRAM2, 16 KB) and region 2.
+ */
+
+#include "stm32f746xx.h"
+#include "sdram.h"
+#include "cache.h"
+
+/**
+ * @brief   Limits of the .nocache section
+ *
+ * @note    Weak, so they are zero when not defined by the linker script
+ */
+extern char _nocache_start[] __attribute__((weak));
+extern char _nocache_end[] __attribute__((weak));
+extern char _sram2_start[] __attribute__((weak));
+extern char _sram2_end[] __attribute__((weak));
+
+/**
+ * @brief   Attribute bits (TEX,S,C,B) for each memory type
+ */
+static const uint32_t typeattr[] = {
+    /* CACHE_WRITEBACK    */ (1<<MPU_RASR_TEX_Pos)|MPU_RASR_C_Msk|MPU_RASR_B_Msk,
+    /* CACHE_WRITETHROUGH */ MPU_RASR_C_Msk,
+    /* CACHE_NONCACHEABLE */ (1<<MPU_RASR_TEX_Pos)|MPU_RASR_S_Msk,
+    /* CACHE_DEVICE       */ MPU_RASR_S_Msk|MPU_RASR_B_Msk,
+};
+
+/**
+ * @brief   Cache_SetRegion
+ *
+ * @note    size must be a power of 2 (32 bytes to 4 GB) and base must be aligned
+ *          to it. Full access is given to privileged and unprivileged code.
+ *
+ * @note    The MPU must be enabled after all regions are set (see Cache_Init)
+ */
+int
+Cache_SetRegion(int region, uint32_t base, uint32_t size, unsigned type) {
+uint32_t rasr;
+int log2size;
+
+    if( (region < 0) || (region >= (int) ((MPU->TYPE&MPU_TYPE_DREGION_Msk)>>MPU_TYPE_DREGION_Pos)) )
+        return -1;
+    if( (size < 32) || (size&(size-1)) )
+        return -2;
+    if( base&(size-1) )
+        return -3;
+
+    log2size = 31-__builtin_clz(size);
+    rasr = typeattr[type&CACHE_TYPE_MASK]
+          |(3<<MPU_RASR_AP_Pos)                 // full access
+          |((log2size-1)<<MPU_RASR_SIZE_Pos)
+          |MPU_RASR_ENABLE_Msk;
+    if( type&CACHE_XN )
+        rasr |= MPU_RASR_XN_Msk;
+
+    MPU->RNR  = region;
+    MPU->RBAR = base;
+    MPU->RASR = rasr;
+    return 0;
+}
+
+/**
+ * @brief   Cache_DisableRegion
+ */
+int
+Cache_DisableRegion(int region) {
+
+    MPU->RNR  = region;
+    MPU->RASR = 0;
+    return 0;
+}
+
+/**
+ * @brief   Cache_Init
+ *
+ * @note    Configures the MPU regions (see table above). The default memory map
+ *          is used for all other areas.
+ *
+ * @note    Must be called before using the SDRAM and the .nocache section. The
+ *          data cache is cleaned and invalidated, because the attributes change.
+ */
+int
+Cache_Init(void) {
+uint32_t nocachesize,sram2size;
+int rc;
+
+    SCB_CleanInvalidateDCache();
+
+    __DMB();
+    MPU->CTRL = 0;
+
+    rc = Cache_SetRegion(CACHE_REGION_SDRAM,SDRAM_ADDRESS,SDRAM_SIZE,CACHE_WRITETHROUGH);
+
+    nocachesize = _nocache_end-_nocache_start;
+    if( (rc == 0) && (_nocache_start != 0) && (nocachesize != 0) )
+        rc = Cache_SetRegion(CACHE_REGION_NOCACHE,(uint32_t) _nocache_start,nocachesize,
+                             CACHE_NONCACHEABLE|CACHE_XN);
+
+    sram2size = _sram2_end-_sram2_start;
+    if( (rc == 0) && (_sram2_start != 0) && (sram2size != 0) )
+        rc = Cache_SetRegion(CACHE_REGION_SRAM2,(uint32_t) _sram2_start,sram2size,
+                             CACHE_NONCACHEABLE|CACHE_XN);
+
+    MPU->CTRL = MPU_CTRL_PRIVDEFENA_Msk|MPU_CTRL_ENABLE_Msk;
+    __DSB();
+    __ISB();
+
+    return rc;
+}
+
+/**
+ * @brief   Cache_CleanRange
+ *
+ * @note    Writes dirty lines to memory. Must be called before a DMA reads the area
+ *
+ * @note    The range is extended to whole lines. It does not change memory contents
+ */
+void
+Cache_CleanRange(const void *p, uint32_t n) {
+uint32_t a = (uint32_t) p;
+
+    if( n == 0 )
+        return;
+    SCB_CleanDCache_by_Addr((uint32_t *) (a&~(CACHE_LINESIZE-1)),n+(a&(CACHE_LINESIZE-1)));
+}
+
+/**
+ * @brief   Cache_InvalidateRange
+ *
+ * @note    Discards cached lines. Must be called before the CPU reads an area
+ *          written by a DMA (and before the DMA starts, if there can be dirty lines)
+ *
+ * @note    Lines partially outside the area are cleaned first, so neighbour data
+ *          is not lost. But what the DMA wrote there can be overwritten.
+ */
+void
+Cache_InvalidateRange(void *p, uint32_t n) {
+uint32_t a = (uint32_t) p;
+uint32_t e = a+n;
+
+    if( n == 0 )
+        return;
+    if( a&(CACHE_LINESIZE-1) ) {
+        a &= ~(CACHE_LINESIZE-1);
+        SCB_CleanInvalidateDCache_by_Addr((uint32_t *) a,CACHE_LINESIZE);
+        a += CACHE_LINESIZE;
+    }
+    if( (e&(CACHE_LINESIZE-1)) && (e > a) ) {
+        e &= ~(CACHE_LINESIZE-1);
+        SCB_CleanInvalidateDCache_by_Addr((uint32_t *) e,CACHE_LINESIZE);
+    }
+    if( e > a )
+        SCB_InvalidateDCache_by_Addr((uint32_t *) a,e-a);
+}
+
+/**
+ * @brief   Cache_CleanInvalidateRange
+ *
+ * @note    Writes dirty lines to memory and discards them
+ */
+void
+Cache_CleanInvalidateRange(void *p, uint32_t n) {
+uint32_t a = (uint32_t) p;
+
+    if( n == 0 )
+        return;
+    SCB_CleanInvalidateDCache_by_Addr((uint32_t *) (a&~(CACHE_LINESIZE-1)),n+(a&(CACHE_LINESIZE-1)));
+}
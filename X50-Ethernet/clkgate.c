@@ -0,0 +1,172 @@
+/**
+ * @file    clkgate.c
+ *
+ * @note    Peripheral clock gating with reference counts (see clkgate.h)
+ *
+ * @note    The counters are 8 bits. A driver that enables a clock at each
+ *          configuration call (GPIO_EnableClock) saturates it at 255, so the
+ *          clock is never released. That is the behavior before this module
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "stm32f746xx.h"
+#include "clkgate.h"
+
+/**
+ * @brief   Enable and Sleep mode enable registers
+ */
+///@{
+static volatile uint32_t *const enr[CLKGATE_NREGS] = {
+    &RCC->AHB1ENR, &RCC->AHB2ENR, &RCC->AHB3ENR, &RCC->APB1ENR, &RCC->APB2ENR
+};
+static volatile uint32_t *const lpenr[CLKGATE_NREGS] = {
+    &RCC->AHB1LPENR, &RCC->AHB2LPENR, &RCC->AHB3LPENR, &RCC->APB1LPENR, &RCC->APB2LPENR
+};
+///@}
+
+/**
+ * @brief   Counters of users and of users that need the clock in Sleep mode
+ */
+///@{
+#define MAXCOUNT                    255
+static uint8_t count[CLKGATE_NREGS][32];
+static uint8_t sleepcount[CLKGATE_NREGS][32];
+///@}
+
+/**
+ * @brief   ClkGate_Enable
+ *
+ * @note    Returns the number of users or CLKGATE_ERROR_PARAM. The peripheral
+ *          can be accessed when it returns
+ */
+int
+ClkGate_Enable(unsigned id, int flags) {
+unsigned reg = id>>5;
+uint32_t m = 1U<<(id&31);
+uint32_t primask;
+int n;
+
+    if( reg >= CLKGATE_NREGS )
+        return CLKGATE_ERROR_PARAM;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if( count[reg][id&31] < MAXCOUNT )
+        count[reg][id&31]++;
+    if( (flags&CLKGATE_SLEEP) && sleepcount[reg][id&31] < MAXCOUNT )
+        sleepcount[reg][id&31]++;
+    if( sleepcount[reg][id&31] )
+        *lpenr[reg] |= m;
+    else
+        *lpenr[reg] &= ~m;
+    *enr[reg] |= m;
+    // Read back: the clock is only active 2 bus cycles after the write
+    (void) *enr[reg];
+    n = count[reg][id&31];
+    __set_PRIMASK(primask);
+    __DSB();
+
+    return n;
+}
+
+/**
+ * @brief   ClkGate_Disable
+ *
+ * @note    flags must be the ones given to ClkGate_Enable. Returns the number
+ *          of users left or CLKGATE_ERROR_UNDERFLOW when there was none
+ *
+ * @note    A saturated counter is not decremented
+ */
+int
+ClkGate_Disable(unsigned id, int flags) {
+unsigned reg = id>>5;
+uint32_t m = 1U<<(id&31);
+uint32_t primask;
+int n;
+
+    if( reg >= CLKGATE_NREGS )
+        return CLKGATE_ERROR_PARAM;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    n = count[reg][id&31];
+    if( n == 0 ) {
+        __set_PRIMASK(primask);
+        return CLKGATE_ERROR_UNDERFLOW;
+    }
+    if( n < MAXCOUNT )
+        count[reg][id&31] = --n;
+    if( (flags&CLKGATE_SLEEP) && sleepcount[reg][id&31] > 0
+        && sleepcount[reg][id&31] < MAXCOUNT )
+        sleepcount[reg][id&31]--;
+    if( n == 0 ) {
+        sleepcount[reg][id&31] = 0;
+        *enr[reg]   &= ~m;
+        *lpenr[reg] &= ~m;
+    } else if( sleepcount[reg][id&31] == 0 ) {
+        *lpenr[reg] &= ~m;
+    }
+    __set_PRIMASK(primask);
+
+    return n;
+}
+
+/**
+ * @brief   ClkGate_GetCount
+ */
+int
+ClkGate_GetCount(unsigned id) {
+
+    if( (id>>5) >= CLKGATE_NREGS )
+        return CLKGATE_ERROR_PARAM;
+    return count[id>>5][id&31];
+}
+
+/**
+ * @brief   ClkGate_GetMask
+ *
+ * @note    Returns the bits of register reg held by users and, in *sleepmask
+ *          (when not null), the ones kept in Sleep mode
+ */
+uint32_t
+ClkGate_GetMask(int reg, uint32_t *sleepmask) {
+uint32_t m,sm;
+int i;
+
+    m  = 0;
+    sm = 0;
+    if( reg >= 0 && reg < CLKGATE_NREGS ) {
+        for(i=0;i<32;i++) {
+            if( count[reg][i] )      m  |= 1U<<i;
+            if( sleepcount[reg][i] ) sm |= 1U<<i;
+        }
+    }
+    if( sleepmask )
+        *sleepmask = sm;
+    return m;
+}
+
+/**
+ * @brief   ClkGate_Report
+ *
+ * @note    Uses printf. For each register: bits held, bits kept in Sleep and
+ *          the values of the ENR and LPENR registers
+ */
+void
+ClkGate_Report(void) {
+static const char *const names[CLKGATE_NREGS] = { "AHB1", "AHB2", "AHB3", "APB1", "APB2" };
+uint32_t m,sm;
+int reg;
+
+    for(reg=0;reg<CLKGATE_NREGS;reg++) {
+        m = ClkGate_GetMask(reg,&sm);
+        printf("Clocks %s: used %08lX sleep %08lX ENR %08lX LPENR %08lX\n",
+                names[reg],(unsigned long) m,(unsigned long) sm,
+                (unsigned long) *enr[reg],(unsigned long) *lpenr[reg]);
+    }
+}
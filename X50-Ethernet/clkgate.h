@@ -0,0 +1,111 @@
+#ifndef CLKGATE_H
+#define CLKGATE_H
+/**
+ * @file    clkgate.h
+ *
+ * @note    Peripheral clock gating with reference counts
+ *
+ * @note    Each enable bit of RCC (AHB1ENR, AHB2ENR, AHB3ENR, APB1ENR and
+ *          APB2ENR) has a counter. ClkGate_Enable sets the bit when its counter
+ *          goes from 0 to 1 and ClkGate_Disable clears it when it goes back to
+ *          0. So a driver can release its clock without stopping a peripheral
+ *          used by another one (e.g. DMA2 used by qspi.c and dma.c)
+ *
+ * @note    In Sleep mode (WFI in Event_Sleep), a peripheral is clocked only if
+ *          its bit in RCC_xxxLPENR is set too. They are all set at reset. For
+ *          the bits managed here, the LP bit is set only while a user that
+ *          passed CLKGATE_SLEEP holds it: peripherals that work while the core
+ *          sleeps (ETH, FMC, DMA, UART reception, timers). The others are
+ *          stopped in Sleep
+ *
+ * @note    The GPIO clocks are only needed to access the GPIO registers. Pin
+ *          levels, alternate functions and EXTI lines work without them, so
+ *          the GPIOs are enabled without CLKGATE_SLEEP
+ *
+ * @note    Bits never given to ClkGate_Enable (memories, SystemInit) are not
+ *          changed
+ *
+ * @note    Can be called from interrupts (it disables them for a few cycles)
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "stm32f746xx.h"
+
+/**
+ * @brief   Identifier of an enable bit: register and bit position
+ */
+///@{
+#define CLKGATE_AHB1                0
+#define CLKGATE_AHB2                1
+#define CLKGATE_AHB3                2
+#define CLKGATE_APB1                3
+#define CLKGATE_APB2                4
+#define CLKGATE_NREGS               5
+
+#define CLKGATE_ID(REG,BIT)         (((REG)<<5)|(BIT))
+///@}
+
+/**
+ * @brief   Identifiers used by the drivers of this project
+ */
+///@{
+#define CLKGATE_GPIOA               CLKGATE_ID(CLKGATE_AHB1,RCC_AHB1ENR_GPIOAEN_Pos)
+#define CLKGATE_GPIOB               CLKGATE_ID(CLKGATE_AHB1,RCC_AHB1ENR_GPIOBEN_Pos)
+#define CLKGATE_GPIOC               CLKGATE_ID(CLKGATE_AHB1,RCC_AHB1ENR_GPIOCEN_Pos)
+#define CLKGATE_GPIOD               CLKGATE_ID(CLKGATE_AHB1,RCC_AHB1ENR_GPIODEN_Pos)
+#define CLKGATE_GPIOE               CLKGATE_ID(CLKGATE_AHB1,RCC_AHB1ENR_GPIOEEN_Pos)
+#define CLKGATE_GPIOF               CLKGATE_ID(CLKGATE_AHB1,RCC_AHB1ENR_GPIOFEN_Pos)
+#define CLKGATE_GPIOG               CLKGATE_ID(CLKGATE_AHB1,RCC_AHB1ENR_GPIOGEN_Pos)
+#define CLKGATE_GPIOH               CLKGATE_ID(CLKGATE_AHB1,RCC_AHB1ENR_GPIOHEN_Pos)
+#define CLKGATE_GPIOI               CLKGATE_ID(CLKGATE_AHB1,RCC_AHB1ENR_GPIOIEN_Pos)
+#define CLKGATE_GPIOJ               CLKGATE_ID(CLKGATE_AHB1,RCC_AHB1ENR_GPIOJEN_Pos)
+#define CLKGATE_GPIOK               CLKGATE_ID(CLKGATE_AHB1,RCC_AHB1ENR_GPIOKEN_Pos)
+#define CLKGATE_CRC                 CLKGATE_ID(CLKGATE_AHB1,RCC_AHB1ENR_CRCEN_Pos)
+#define CLKGATE_DMA1                CLKGATE_ID(CLKGATE_AHB1,RCC_AHB1ENR_DMA1EN_Pos)
+#define CLKGATE_DMA2                CLKGATE_ID(CLKGATE_AHB1,RCC_AHB1ENR_DMA2EN_Pos)
+#define CLKGATE_DMA2D               CLKGATE_ID(CLKGATE_AHB1,RCC_AHB1ENR_DMA2DEN_Pos)
+#define CLKGATE_ETHMAC              CLKGATE_ID(CLKGATE_AHB1,RCC_AHB1ENR_ETHMACEN_Pos)
+#define CLKGATE_ETHMACTX            CLKGATE_ID(CLKGATE_AHB1,RCC_AHB1ENR_ETHMACTXEN_Pos)
+#define CLKGATE_ETHMACRX            CLKGATE_ID(CLKGATE_AHB1,RCC_AHB1ENR_ETHMACRXEN_Pos)
+#define CLKGATE_ETHMACPTP           CLKGATE_ID(CLKGATE_AHB1,RCC_AHB1ENR_ETHMACPTPEN_Pos)
+#define CLKGATE_RNG                 CLKGATE_ID(CLKGATE_AHB2,RCC_AHB2ENR_RNGEN_Pos)
+#define CLKGATE_FMC                 CLKGATE_ID(CLKGATE_AHB3,RCC_AHB3ENR_FMCEN_Pos)
+#define CLKGATE_QSPI                CLKGATE_ID(CLKGATE_AHB3,RCC_AHB3ENR_QSPIEN_Pos)
+#define CLKGATE_TIM6                CLKGATE_ID(CLKGATE_APB1,RCC_APB1ENR_TIM6EN_Pos)
+#define CLKGATE_USART2              CLKGATE_ID(CLKGATE_APB1,RCC_APB1ENR_USART2EN_Pos)
+#define CLKGATE_USART3              CLKGATE_ID(CLKGATE_APB1,RCC_APB1ENR_USART3EN_Pos)
+#define CLKGATE_UART4               CLKGATE_ID(CLKGATE_APB1,RCC_APB1ENR_UART4EN_Pos)
+#define CLKGATE_UART5               CLKGATE_ID(CLKGATE_APB1,RCC_APB1ENR_UART5EN_Pos)
+#define CLKGATE_UART7               CLKGATE_ID(CLKGATE_APB1,RCC_APB1ENR_UART7EN_Pos)
+#define CLKGATE_UART8               CLKGATE_ID(CLKGATE_APB1,RCC_APB1ENR_UART8EN_Pos)
+#define CLKGATE_USART1              CLKGATE_ID(CLKGATE_APB2,RCC_APB2ENR_USART1EN_Pos)
+#define CLKGATE_USART6              CLKGATE_ID(CLKGATE_APB2,RCC_APB2ENR_USART6EN_Pos)
+#define CLKGATE_SYSCFG              CLKGATE_ID(CLKGATE_APB2,RCC_APB2ENR_SYSCFGEN_Pos)
+///@}
+
+/**
+ * @brief   Flags
+ */
+///@{
+#define CLKGATE_SLEEP               (1)     ///< keep the clock in Sleep mode
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define CLKGATE_ERROR_PARAM         (-1)
+#define CLKGATE_ERROR_UNDERFLOW     (-2)
+///@}
+
+int      ClkGate_Enable(unsigned id, int flags);
+int      ClkGate_Disable(unsigned id, int flags);
+int      ClkGate_GetCount(unsigned id);
+uint32_t ClkGate_GetMask(int reg, uint32_t *sleepmask);
+void     ClkGate_Report(void);
+
+#endif // CLKGATE_H
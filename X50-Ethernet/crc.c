@@ -0,0 +1,297 @@
+/**
+ * @file    crc.c
+ *
+ * @note    CRC unit driver (see crc.h)
+ *
+ * @note    The unit shifts the data MSB first and CRC_DR holds the register in
+ *          normal (not reflected) form, in its lower width bits. For a reflected
+ *          CRC, the input is bit reversed by the unit (REV_IN) and the output by
+ *          __RBIT. The words are written with REV_IN by word, and the bytes
+ *          before and after them with REV_IN by byte. For a normal CRC, the
+ *          words are byte swapped by __REV, and DMA writes bytes
+ *
+ * @note    A CRC can be continued from a returned value: the register is
+ *          rebuilt by undoing the final xor and the reflection
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include "stm32f746xx.h"
+#include "cache.h"
+#include "dma.h"
+#include "crc.h"
+#include "clkgate.h"
+
+/**
+ * @brief   Predefined CRCs
+ */
+///@{
+const CRC_Config CRC_32         = { 0x04C11DB7, 0xFFFFFFFF, 0xFFFFFFFF, 32, 1 };
+const CRC_Config CRC_16_CCITT   = { 0x1021,     0xFFFF,     0x0000,     16, 0 };
+const CRC_Config CRC_16_ARC     = { 0x8005,     0x0000,     0x0000,     16, 1 };
+const CRC_Config CRC_16_MODBUS  = { 0x8005,     0xFFFF,     0x0000,     16, 1 };
+const CRC_Config CRC_8          = { 0x07,       0x00,       0x00,        8, 0 };
+///@}
+
+/**
+ * @brief   CR fields
+ */
+///@{
+#define REV_NONE                        (0U<<CRC_CR_REV_IN_Pos)
+#define REV_BYTE                        (1U<<CRC_CR_REV_IN_Pos)
+#define REV_WORD                        (3U<<CRC_CR_REV_IN_Pos)
+///@}
+
+/**
+ * @brief   State
+ */
+///@{
+static int              initialized = 0;
+static volatile int     busy = 0;
+static volatile int     dmastatus;
+///@}
+
+/**
+ * @brief  Mask of a width
+ */
+static uint32_t Mask( uint32_t width ) {
+
+    return width == 32 ? 0xFFFFFFFF : (1U<<width)-1;
+}
+
+/**
+ * @brief  Take the unit. Returns 0 when in use or not initialized
+ */
+static int Lock( void ) {
+uint32_t primask;
+int ok;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    ok = initialized && !busy;
+    if( ok )
+        busy = 1;
+    __set_PRIMASK(primask);
+    return ok;
+}
+
+/**
+ * @brief  CRC in software (bitwise, register aligned to bit 31)
+ */
+static uint32_t Software( const CRC_Config *conf, uint32_t reg,
+                          const uint8_t *p, uint32_t n ) {
+uint32_t shift = 32-conf->width;
+uint32_t poly = conf->poly<<shift;
+uint32_t r = reg<<shift;
+uint32_t b;
+int i;
+
+    while( n-- ) {
+        b = *p++;
+        if( conf->reflect )
+            b = __RBIT(b)>>24;
+        r ^= b<<24;
+        for(i=0;i<8;i++)
+            r = (r&0x80000000) ? (r<<1)^poly : r<<1;
+    }
+    return r>>shift;
+}
+
+/**
+ * @brief  DMA callback
+ */
+static void DMADone( void *arg, int event ) {
+
+    (void) arg;
+    dmastatus = event;
+}
+
+/**
+ * @brief  Feed a block to CRC_DR with a DMA2 stream
+ *
+ * @note   Words when size is 4 (aligned block), bytes when size is 1. Returns
+ *         the number of bytes done, 0 when no stream is free
+ */
+static uint32_t Feed( const uint8_t *p, uint32_t n, int size ) {
+DMA_Config dc;
+uint32_t done,k;
+int h;
+
+    h = DMA_Allocate(DMA_REQ_MEM2MEM);
+    if( h < 0 )
+        return 0;
+
+    dc.dir      = DMA_DIR_M2M;
+    dc.psize    = size;
+    dc.msize    = size;
+    dc.burst    = DMA_BURST_SINGLE;
+    dc.priority = 0;
+    dc.flags    = DMA_FLAG_PINC;            // CRC_DR is not incremented
+    dc.callback = DMADone;
+    dc.arg      = 0;
+
+    Cache_CleanRange(p,n);
+    done = 0;
+    while( n-done >= (uint32_t) size ) {
+        k = (n-done)/size;
+        if( k > 65535 )
+            k = 65535;
+        dc.periph = (void *) (p+done);
+        dmastatus = 0;
+        if( DMA_Configure(h,&dc) < 0 || DMA_Start(h,(void *) &CRC->DR,0,k) < 0 )
+            break;
+        while( dmastatus == 0 ) {}
+        if( dmastatus != DMA_EVENT_FULL )
+            break;
+        done += k*size;
+    }
+    DMA_Free(h);
+    return done;
+}
+
+/**
+ * @brief  CRC with the unit
+ */
+static uint32_t Hardware( const CRC_Config *conf, uint32_t reg,
+                          const uint8_t *p, uint32_t n ) {
+volatile uint8_t *dr8 = (volatile uint8_t *) &CRC->DR;
+uint32_t polysize,rev,k;
+uint32_t w;
+
+    polysize = conf->width == 32 ? 0 : conf->width == 16 ? 1 : conf->width == 8 ? 2 : 3;
+    rev      = conf->reflect ? REV_BYTE : REV_NONE;
+
+    CRC->POL  = conf->poly;
+    CRC->INIT = reg;
+    CRC->CR   = (polysize<<CRC_CR_POLYSIZE_Pos)|rev|CRC_CR_RESET;
+
+    // Bytes up to a word boundary
+    while( n && ((uint32_t) p&3) != 0 ) {
+        *dr8 = *p++;
+        n--;
+    }
+
+    // Large blocks by DMA (bytes for a normal CRC)
+    if( n >= CRC_DMA_THRESHOLD ) {
+        if( conf->reflect ) {
+            CRC->CR = (polysize<<CRC_CR_POLYSIZE_Pos)|REV_WORD;
+            k = Feed(p,n,DMA_SIZE_32);
+            CRC->CR = (polysize<<CRC_CR_POLYSIZE_Pos)|REV_BYTE;
+        } else {
+            k = Feed(p,n,DMA_SIZE_8);
+        }
+        p += k;
+        n -= k;
+    }
+
+    // Words, then bytes
+    if( n >= 4 ) {
+        if( conf->reflect ) {
+            CRC->CR = (polysize<<CRC_CR_POLYSIZE_Pos)|REV_WORD;
+            while( n >= 4 ) {
+                CRC->DR = *(const uint32_t *) p;
+                p += 4;
+                n -= 4;
+            }
+            CRC->CR = (polysize<<CRC_CR_POLYSIZE_Pos)|REV_BYTE;
+        } else {
+            while( n >= 4 ) {
+                w = *(const uint32_t *) p;
+                CRC->DR = __REV(w);
+                p += 4;
+                n -= 4;
+            }
+        }
+    }
+    while( n-- )
+        *dr8 = *p++;
+
+    return CRC->DR&Mask(conf->width);
+}
+
+/**
+ * @brief  Register from a final value and back
+ */
+///@{
+static uint32_t Unfinish( const CRC_Config *conf, uint32_t crc ) {
+
+    crc = (crc^conf->xorout)&Mask(conf->width);
+    if( conf->reflect )
+        crc = __RBIT(crc)>>(32-conf->width);
+    return crc;
+}
+
+static uint32_t Finish( const CRC_Config *conf, uint32_t reg ) {
+
+    if( conf->reflect )
+        reg = __RBIT(reg)>>(32-conf->width);
+    return (reg^conf->xorout)&Mask(conf->width);
+}
+///@}
+
+/**
+ * @brief  Register after a block
+ */
+static uint32_t Compute( const CRC_Config *conf, uint32_t reg,
+                         const void *p, uint32_t n ) {
+
+    if( !Lock() )
+        return Software(conf,reg,(const uint8_t *) p,n);
+    reg = Hardware(conf,reg,(const uint8_t *) p,n);
+    busy = 0;
+    return reg;
+}
+
+/**
+ * @brief  CRC_Init
+ *
+ * @note   Enables the unit and checks it with CRC_32 of "123456789"
+ */
+int
+CRC_Init( void ) {
+static const char check[] = "123456789";
+
+    // Fed by the CPU or by a DMA it waits for, so not needed in Sleep mode
+    if( ClkGate_GetCount(CLKGATE_CRC) == 0 )
+        ClkGate_Enable(CLKGATE_CRC,0);
+
+    initialized = 1;
+    if( CRC_Compute(&CRC_32,check,9) != 0xCBF43926 ) {
+        initialized = 0;
+        return CRC_ERROR_SELFTEST;
+    }
+    return CRC_OK;
+}
+
+/**
+ * @brief  CRC_Compute
+ */
+uint32_t
+CRC_Compute( const CRC_Config *conf, const void *p, uint32_t n ) {
+
+    return Finish(conf,Compute(conf,conf->init&Mask(conf->width),p,n));
+}
+
+/**
+ * @brief  CRC_Update
+ *
+ * @note   Continues a CRC returned by CRC_Compute or CRC_Update, so a stream can
+ *         be checked in parts
+ */
+uint32_t
+CRC_Update( const CRC_Config *conf, uint32_t crc, const void *p, uint32_t n ) {
+
+    return Finish(conf,Compute(conf,Unfinish(conf,crc),p,n));
+}
+
+/**
+ * @brief  CRC32_Update
+ *
+ * @note   Same as crc32() of zlib: starts with crc=0
+ */
+uint32_t
+CRC32_Update( uint32_t crc, const void *p, uint32_t n ) {
+
+    return CRC_Update(&CRC_32,crc,p,n);
+}
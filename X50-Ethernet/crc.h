@@ -0,0 +1,74 @@
+#ifndef CRC_H
+#define CRC_H
+/**
+ * @file    crc.h
+ *
+ * @brief   CRC calculation with the CRC unit
+ *
+ * @note    The unit computes CRCs of 7, 8, 16 or 32 bits with any polynomial.
+ *          A CRC is described by its parameters as in the usual catalogues
+ *          (polynomial without the top bit, initial value, reflection of input
+ *          and output and final xor), so a new one needs only a CRC_Config
+ *
+ * @note    Blocks with at least CRC_DMA_THRESHOLD bytes are fed to the unit by a
+ *          DMA2 stream (memory to memory, to the fixed address of CRC_DR) and the
+ *          CPU waits for the end. Smaller blocks, or when no DMA2 stream is free,
+ *          are written by the CPU. The data cache is cleaned over the block
+ *
+ * @note    There is only one unit. When it is in use (e.g. by an interrupt
+ *          routine), or before CRC_Init, the CRC is computed in software with
+ *          the same result
+ *
+ * @note    With DMA, the CPU waits for the DMA interrupt. It must not be called
+ *          from an interrupt routine with a priority equal or higher than
+ *          DMA_IRQ_PRIO
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Parameters of a CRC
+ */
+typedef struct {
+    uint32_t    poly;                   ///< polynomial (normal form)
+    uint32_t    init;                   ///< initial value (not reflected)
+    uint32_t    xorout;                 ///< xor'ed with the final value
+    uint8_t     width;                  ///< 7, 8, 16 or 32
+    uint8_t     reflect;                ///< input and output reflected (LSB first)
+} CRC_Config;
+
+/**
+ * @brief   Predefined CRCs (with the CRC of "123456789")
+ */
+///@{
+extern const CRC_Config CRC_32;                 ///< Ethernet, zlib, PNG (CBF43926h)
+extern const CRC_Config CRC_16_CCITT;           ///< CCITT-FALSE (29B1h)
+extern const CRC_Config CRC_16_ARC;             ///< (BB3Dh)
+extern const CRC_Config CRC_16_MODBUS;          ///< (4B37h)
+extern const CRC_Config CRC_8;                  ///< SMBus (F4h)
+///@}
+
+/**
+ * @brief   Minimal size of a block fed by DMA
+ */
+#ifndef CRC_DMA_THRESHOLD
+#define CRC_DMA_THRESHOLD               (4096)
+#endif
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define CRC_OK                          (0)
+#define CRC_ERROR_SELFTEST              (-1)    ///< unit not used
+///@}
+
+int      CRC_Init(void);
+uint32_t CRC_Compute(const CRC_Config *conf, const void *p, uint32_t n);
+uint32_t CRC_Update(const CRC_Config *conf, uint32_t crc, const void *p, uint32_t n);
+uint32_t CRC32_Update(uint32_t crc, const void *p, uint32_t n);
+
+#endif // CRC_H
@@ -5,6 +5,10 @@
  *
  * @note    This version uses the standard library vprintf function.
  *
+ * @note    When MESSAGE_DEFERRED is defined, MESSAGE and MESSAGEV only store the
+ *          format and arguments in the trace buffer (tracelog.h). They are
+ *          printed by Trace_Flush in the main loop.
+ *
  * @note    Another version using a macro with variable number of arguments was
  *          tried. But such macros must have at least two arguments. Dismissed!!!!
  */
@@ -27,6 +31,21 @@ static void message(char *msg,...) {
     va_end(args);
 }
 
+#ifdef MESSAGE_DEFERRED
+/*
+ * Messages are stored in a trace buffer and printed later by Trace_Flush
+ */
+#include "tracelog.h"
+
+#define MESSAGE(TEXT)  \
+        do {\
+            if( verbose ) TRACE(TEXT); \
+        } while(0)
+#define MESSAGEV(TEXT,...) \
+        do { \
+            if ( verbose ) TRACE(TEXT, __VA_ARGS__); \
+        } while(0)
+#else
 #define MESSAGE(TEXT)  \
         do {\
             if( verbose ) message(TEXT); \
@@ -39,6 +58,7 @@ static void message(char *msg,...) {
 #else
 #define MESSAGEV
 #endif
+#endif
 ///@}
 
 #endif   // DEBUGMESSAGES_H
\ No newline at end of file
@@ -0,0 +1,788 @@
+/**
+ * @file    dma.c
+ *
+ * @brief   Allocation and configuration of the DMA1/DMA2 streams (see dma.h)
+ *
+ * @note    Request mapping (RM0385 Tables 27 and 28). The first alternative is
+ *          tried first. They are ordered so that the usual combinations (all
+ *          four I2C, all UARTs) get disjoint streams
+ *
+ * @note    A stream is configured by DMA_Configure and the registers are only
+ *          written by DMA_Start, with the stream disabled
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <string.h>
+#include "stm32f746xx.h"
+#include "dma.h"
+#include "clkgate.h"
+
+/**
+ * @brief   Routes of the requests
+ *
+ * @note    Stream handle (0-7 DMA1, 8-15 DMA2) and channel. NOROUTE when there is
+ *          only one alternative
+ */
+///@{
+#define NOROUTE                         (0xFF)
+#define D1(S)                           (S)
+#define D2(S)                           (8+(S))
+
+typedef struct {
+    uint8_t     stream;
+    uint8_t     channel;
+} DMA_Route;
+
+static const DMA_Route routetab[][2] = {
+    [DMA_REQ_SPI1_RX]   = { { D2(0), 3 }, { D2(2), 3 } },
+    [DMA_REQ_SPI1_TX]   = { { D2(3), 3 }, { D2(5), 3 } },
+    [DMA_REQ_SPI2_RX]   = { { D1(3), 0 }, { NOROUTE, 0 } },
+    [DMA_REQ_SPI2_TX]   = { { D1(4), 0 }, { NOROUTE, 0 } },
+    [DMA_REQ_SPI3_RX]   = { { D1(0), 0 }, { D1(2), 0 } },
+    [DMA_REQ_SPI3_TX]   = { { D1(5), 0 }, { D1(7), 0 } },
+    [DMA_REQ_SPI4_RX]   = { { D2(0), 4 }, { D2(3), 5 } },
+    [DMA_REQ_SPI4_TX]   = { { D2(1), 4 }, { D2(4), 5 } },
+    [DMA_REQ_SPI5_RX]   = { { D2(3), 2 }, { D2(5), 7 } },
+    [DMA_REQ_SPI5_TX]   = { { D2(4), 2 }, { D2(6), 7 } },
+    [DMA_REQ_SPI6_RX]   = { { D2(6), 1 }, { NOROUTE, 0 } },
+    [DMA_REQ_SPI6_TX]   = { { D2(5), 1 }, { NOROUTE, 0 } },
+    [DMA_REQ_I2C1_RX]   = { { D1(0), 1 }, { D1(5), 1 } },
+    [DMA_REQ_I2C1_TX]   = { { D1(6), 1 }, { D1(7), 1 } },
+    [DMA_REQ_I2C2_RX]   = { { D1(3), 7 }, { D1(2), 7 } },
+    [DMA_REQ_I2C2_TX]   = { { D1(7), 7 }, { NOROUTE, 0 } },
+    [DMA_REQ_I2C3_RX]   = { { D1(1), 1 }, { D1(2), 3 } },
+    [DMA_REQ_I2C3_TX]   = { { D1(4), 3 }, { NOROUTE, 0 } },
+    [DMA_REQ_I2C4_RX]   = { { D1(2), 2 }, { NOROUTE, 0 } },
+    [DMA_REQ_I2C4_TX]   = { { D1(5), 2 }, { NOROUTE, 0 } },
+    [DMA_REQ_USART1_RX] = { { D2(2), 4 }, { D2(5), 4 } },
+    [DMA_REQ_USART1_TX] = { { D2(7), 4 }, { NOROUTE, 0 } },
+    [DMA_REQ_USART2_RX] = { { D1(5), 4 }, { NOROUTE, 0 } },
+    [DMA_REQ_USART2_TX] = { { D1(6), 4 }, { NOROUTE, 0 } },
+    [DMA_REQ_USART3_RX] = { { D1(1), 4 }, { NOROUTE, 0 } },
+    [DMA_REQ_USART3_TX] = { { D1(3), 4 }, { D1(4), 7 } },
+    [DMA_REQ_UART4_RX]  = { { D1(2), 4 }, { NOROUTE, 0 } },
+    [DMA_REQ_UART4_TX]  = { { D1(4), 4 }, { NOROUTE, 0 } },
+    [DMA_REQ_UART5_RX]  = { { D1(0), 4 }, { NOROUTE, 0 } },
+    [DMA_REQ_UART5_TX]  = { { D1(7), 4 }, { NOROUTE, 0 } },
+    [DMA_REQ_USART6_RX] = { { D2(1), 5 }, { D2(2), 5 } },
+    [DMA_REQ_USART6_TX] = { { D2(6), 5 }, { D2(7), 5 } },
+    [DMA_REQ_UART7_RX]  = { { D1(3), 5 }, { NOROUTE, 0 } },
+    [DMA_REQ_UART7_TX]  = { { D1(1), 5 }, { NOROUTE, 0 } },
+    [DMA_REQ_UART8_RX]  = { { D1(6), 5 }, { NOROUTE, 0 } },
+    [DMA_REQ_UART8_TX]  = { { D1(0), 5 }, { NOROUTE, 0 } },
+    [DMA_REQ_SDMMC1]    = { { D2(3), 4 }, { D2(6), 4 } },
+    [DMA_REQ_QUADSPI]   = { { D2(7), 3 }, { NOROUTE, 0 } },
+    [DMA_REQ_SAI1_A]    = { { D2(1), 0 }, { D2(3), 0 } },
+    [DMA_REQ_SAI1_B]    = { { D2(5), 0 }, { D2(4), 1 } },
+    [DMA_REQ_SAI2_A]    = { { D2(4), 3 }, { NOROUTE, 0 } },
+    [DMA_REQ_SAI2_B]    = { { D2(6), 3 }, { NOROUTE, 0 } },
+    [DMA_REQ_ADC1]      = { { D2(0), 0 }, { D2(4), 0 } },
+    [DMA_REQ_ADC2]      = { { D2(2), 1 }, { D2(3), 1 } },
+    [DMA_REQ_ADC3]      = { { D2(0), 2 }, { D2(1), 2 } },
+    [DMA_REQ_DAC1]      = { { D1(5), 7 }, { NOROUTE, 0 } },
+    [DMA_REQ_DAC2]      = { { D1(6), 7 }, { NOROUTE, 0 } },
+    [DMA_REQ_DCMI]      = { { D2(1), 1 }, { D2(7), 1 } },
+    [DMA_REQ_MEM2MEM]   = { { NOROUTE, 0 }, { NOROUTE, 0 } },   // any DMA2 stream
+};
+#define NREQUESTS (sizeof(routetab)/sizeof(routetab[0]))
+///@}
+
+/**
+ * @brief   Streams
+ */
+///@{
+#define NSTREAMS                        (16)
+
+static DMA_Stream_TypeDef * const streamtab[NSTREAMS] = {
+    DMA1_Stream0, DMA1_Stream1, DMA1_Stream2, DMA1_Stream3,
+    DMA1_Stream4, DMA1_Stream5, DMA1_Stream6, DMA1_Stream7,
+    DMA2_Stream0, DMA2_Stream1, DMA2_Stream2, DMA2_Stream3,
+    DMA2_Stream4, DMA2_Stream5, DMA2_Stream6, DMA2_Stream7
+};
+
+static const IRQn_Type irqtab[NSTREAMS] = {
+    DMA1_Stream0_IRQn, DMA1_Stream1_IRQn, DMA1_Stream2_IRQn, DMA1_Stream3_IRQn,
+    DMA1_Stream4_IRQn, DMA1_Stream5_IRQn, DMA1_Stream6_IRQn, DMA1_Stream7_IRQn,
+    DMA2_Stream0_IRQn, DMA2_Stream1_IRQn, DMA2_Stream2_IRQn, DMA2_Stream3_IRQn,
+    DMA2_Stream4_IRQn, DMA2_Stream5_IRQn, DMA2_Stream6_IRQn, DMA2_Stream7_IRQn
+};
+
+typedef struct {
+    int                 used;
+    uint32_t            channel;
+    uint32_t            cr;             // without EN
+    uint32_t            fcr;
+    uint32_t            block;          // bytes of a memory burst (1 in direct mode)
+    int                 psize;
+    volatile void       *periph;
+    DMA_Callback        callback;
+    void                *arg;
+} DMA_StreamInfo;
+
+static DMA_StreamInfo   streaminfo[NSTREAMS];
+///@}
+
+/**
+ * @brief   Interrupt flags
+ *
+ * @note    Position of the flags of a stream in LISR/HISR (and LIFCR/HIFCR)
+ */
+///@{
+#define FLAG_FE                         (1U<<0)
+#define FLAG_DME                        (1U<<2)
+#define FLAG_TE                         (1U<<3)
+#define FLAG_HT                         (1U<<4)
+#define FLAG_TC                         (1U<<5)
+#define FLAG_ALL                        (0x3DU)
+
+static const uint8_t flagpos[4] = { 0, 6, 16, 22 };
+///@}
+
+/**
+ * @brief   Get and clear the flags of a stream
+ */
+static uint32_t GetAndClearFlags( int h ) {
+DMA_TypeDef *dma = h < 8 ? DMA1 : DMA2;
+uint32_t pos = flagpos[h&3];
+uint32_t flags;
+
+    if( (h&4) == 0 ) {
+        flags = (dma->LISR>>pos)&FLAG_ALL;
+        dma->LIFCR = flags<<pos;
+    } else {
+        flags = (dma->HISR>>pos)&FLAG_ALL;
+        dma->HIFCR = flags<<pos;
+    }
+    return flags;
+}
+
+/**
+ * @brief   Clear all flags of a stream
+ */
+static void ClearFlags( int h ) {
+DMA_TypeDef *dma = h < 8 ? DMA1 : DMA2;
+
+    if( (h&4) == 0 )
+        dma->LIFCR = FLAG_ALL<<flagpos[h&3];
+    else
+        dma->HIFCR = FLAG_ALL<<flagpos[h&3];
+}
+
+/**
+ * @brief   Largest burst (beats) that fits in the 16 byte FIFO
+ */
+static int FitBurst( int size ) {
+
+    return size == 4 ? 4 : size == 2 ? 8 : 16;
+}
+
+/**
+ * @brief   Burst encoding for MBURST and PBURST
+ */
+static uint32_t BurstCode( int beats ) {
+
+    return beats == 16 ? 3 : beats == 8 ? 2 : beats == 4 ? 1 : 0;
+}
+
+/**
+ * @brief  DMA_Allocate
+ *
+ * @note   Takes the first free stream that serves the request and enables the
+ *         clock of its controller and its interrupt. The clock is kept in Sleep
+ *         mode and released by DMA_Free of its last stream
+ *
+ * @return handle (0-15) or DMA_ERROR_*
+ */
+int
+DMA_Allocate( int request ) {
+const DMA_Route *r;
+uint32_t primask;
+int h,k;
+
+    if( request < 0 || request >= (int) NREQUESTS )
+        return DMA_ERROR_PARAMETER;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    h = -1;
+    if( request == DMA_REQ_MEM2MEM ) {
+        for(k=NSTREAMS-1;k>=8;k--) {
+            if( !streaminfo[k].used ) {
+                h = k;
+                streaminfo[h].channel = 0;
+                break;
+            }
+        }
+    } else {
+        r = routetab[request];
+        for(k=0;k<2;k++) {
+            if( r[k].stream != NOROUTE && !streaminfo[r[k].stream].used ) {
+                h = r[k].stream;
+                streaminfo[h].channel = r[k].channel;
+                break;
+            }
+        }
+    }
+    if( h >= 0 )
+        streaminfo[h].used = 1;
+    __set_PRIMASK(primask);
+
+    if( h < 0 )
+        return DMA_ERROR_BUSY;
+
+    ClkGate_Enable(h < 8 ? CLKGATE_DMA1 : CLKGATE_DMA2,CLKGATE_SLEEP);
+
+    streaminfo[h].callback = 0;
+    streaminfo[h].cr       = 0;
+    streaminfo[h].fcr      = 0;
+    DMA_Stop(h);
+
+    NVIC_SetPriority(irqtab[h],DMA_IRQ_PRIO);
+    NVIC_ClearPendingIRQ(irqtab[h]);
+    NVIC_EnableIRQ(irqtab[h]);
+    return h;
+}
+
+/**
+ * @brief  DMA_Free
+ */
+void
+DMA_Free( int h ) {
+
+    if( h < 0 || h >= NSTREAMS || !streaminfo[h].used )
+        return;
+    DMA_Stop(h);
+    NVIC_DisableIRQ(irqtab[h]);
+    streaminfo[h].used = 0;
+    ClkGate_Disable(h < 8 ? CLKGATE_DMA1 : CLKGATE_DMA2,CLKGATE_SLEEP);
+}
+
+/**
+ * @brief  DMA_Configure
+ *
+ * @note   The FIFO is used for bursts, for memory to memory transfers and when
+ *         psize and msize differ. Its threshold is the size of a memory burst
+ *         (RM0385 Table 48), so a burst never waits for more data than the FIFO
+ *         holds
+ *
+ * @note   The interrupts are only enabled when there is a callback
+ */
+int
+DMA_Configure( int h, const DMA_Config *conf ) {
+DMA_StreamInfo *s;
+uint32_t cr,fcr;
+int msize,mbeats,pbeats;
+
+    if( h < 0 || h >= NSTREAMS || !streaminfo[h].used )
+        return DMA_ERROR_PARAMETER;
+    if( conf->dir == DMA_DIR_M2M && h < 8 )
+        return DMA_ERROR_PARAMETER;
+    if( conf->psize != 1 && conf->psize != 2 && conf->psize != 4 )
+        return DMA_ERROR_PARAMETER;
+    s = &streaminfo[h];
+
+    msize  = conf->msize;
+    mbeats = conf->burst;
+    if( mbeats == DMA_BURST_SINGLE && conf->dir != DMA_DIR_M2M
+        && (msize == 0 || msize == conf->psize) ) {
+        // Direct mode
+        msize  = conf->psize;
+        mbeats = 1;
+        pbeats = 1;
+        fcr    = 0;
+    } else {
+        if( msize != 1 && msize != 2 && msize != 4 )
+            return DMA_ERROR_PARAMETER;
+        if( mbeats == DMA_BURST_AUTO )
+            mbeats = FitBurst(msize);
+        else if( mbeats == DMA_BURST_SINGLE )
+            mbeats = 1;
+        if( mbeats*msize > 16 )
+            return DMA_ERROR_PARAMETER;
+        // Peripheral bursts only between memories, not larger than the threshold
+        // and only from an address aligned to the burst (1 KB boundary)
+        pbeats = 1;
+        if( conf->dir == DMA_DIR_M2M ) {
+            pbeats = FitBurst(conf->psize);
+            while( pbeats > 1 && pbeats*conf->psize > mbeats*msize )
+                pbeats = pbeats == 4 ? 1 : pbeats/2;
+            if( ((uint32_t) conf->periph%(pbeats*conf->psize)) != 0 )
+                pbeats = 1;
+        }
+        fcr = DMA_SxFCR_DMDIS
+             |((mbeats*msize <= 4 ? 0 : mbeats*msize <= 8 ? 1 : 3)<<DMA_SxFCR_FTH_Pos);
+        if( conf->callback )
+            fcr |= DMA_SxFCR_FEIE;
+    }
+
+    cr = (s->channel<<DMA_SxCR_CHSEL_Pos)
+        |(BurstCode(mbeats)<<DMA_SxCR_MBURST_Pos)
+        |(BurstCode(pbeats)<<DMA_SxCR_PBURST_Pos)
+        |((conf->priority&3)<<DMA_SxCR_PL_Pos)
+        |((uint32_t)(msize>>1)<<DMA_SxCR_MSIZE_Pos)
+        |((uint32_t)(conf->psize>>1)<<DMA_SxCR_PSIZE_Pos)
+        |((uint32_t) conf->dir<<DMA_SxCR_DIR_Pos);
+    if( conf->flags&DMA_FLAG_MINC )
+        cr |= DMA_SxCR_MINC;
+    if( conf->flags&DMA_FLAG_PINC )
+        cr |= DMA_SxCR_PINC;
+    if( conf->flags&DMA_FLAG_CIRCULAR )
+        cr |= DMA_SxCR_CIRC;
+    if( conf->flags&DMA_FLAG_DOUBLEBUFFER )
+        cr |= DMA_SxCR_DBM|DMA_SxCR_CIRC;
+    if( conf->flags&DMA_FLAG_PFCTRL )
+        cr |= DMA_SxCR_PFCTRL;
+    if( conf->callback ) {
+        cr |= DMA_SxCR_TCIE|DMA_SxCR_TEIE|DMA_SxCR_DMEIE;
+        if( conf->flags&DMA_FLAG_HALF )
+            cr |= DMA_SxCR_HTIE;
+    }
+
+    DMA_Stop(h);
+    s->cr       = cr;
+    s->fcr      = fcr;
+    s->block    = mbeats*msize;
+    s->psize    = conf->psize;
+    s->periph   = conf->periph;
+    s->callback = conf->callback;
+    s->arg      = conf->arg;
+    return DMA_OK;
+}
+
+/**
+ * @brief  DMA_Start
+ *
+ * @note   Transfers n items of psize bytes between the peripheral and m0 (and
+ *         m1 in double buffer mode). For memory to memory, the source is the
+ *         peripheral address given to DMA_Configure and the destination is m0
+ *
+ * @note   With bursts, the buffers must be aligned to the burst size, so a burst
+ *         does not cross a 1 KB boundary, and n*psize must be a multiple of it
+ */
+int
+DMA_Start( int h, void *m0, void *m1, uint32_t n ) {
+DMA_Stream_TypeDef *stream;
+DMA_StreamInfo *s;
+
+    if( h < 0 || h >= NSTREAMS || !streaminfo[h].used || n == 0 || n > 65535 )
+        return DMA_ERROR_PARAMETER;
+    s = &streaminfo[h];
+    if( ((uint32_t) m0%s->block) != 0 || ((uint32_t) m1%s->block) != 0
+        || ((n*s->psize)%s->block) != 0 )
+        return DMA_ERROR_ALIGNMENT;
+
+    stream = streamtab[h];
+    DMA_Stop(h);
+    stream->PAR  = (uint32_t) s->periph;
+    stream->M0AR = (uint32_t) m0;
+    stream->M1AR = (uint32_t) m1;
+    stream->NDTR = n;
+    stream->FCR  = s->fcr;
+    stream->CR   = s->cr;
+    stream->CR  |= DMA_SxCR_EN;
+    return DMA_OK;
+}
+
+/**
+ * @brief  DMA_Stop
+ *
+ * @note   Waits for the current burst to end and clears the flags
+ */
+void
+DMA_Stop( int h ) {
+DMA_Stream_TypeDef *stream;
+
+    if( h < 0 || h >= NSTREAMS )
+        return;
+    stream = streamtab[h];
+    stream->CR &= ~DMA_SxCR_EN;
+    while( stream->CR&DMA_SxCR_EN ) {}
+    ClearFlags(h);
+}
+
+/**
+ * @brief  DMA_Remaining
+ *
+ * @note   Items not transferred yet (NDTR)
+ */
+uint32_t
+DMA_Remaining( int h ) {
+
+    if( h < 0 || h >= NSTREAMS )
+        return 0;
+    return streamtab[h]->NDTR;
+}
+
+/**
+ * @brief  DMA_CurrentBuffer
+ *
+ * @note   Buffer (0 or 1) being transferred in double buffer mode
+ */
+int
+DMA_CurrentBuffer( int h ) {
+
+    if( h < 0 || h >= NSTREAMS )
+        return DMA_ERROR_PARAMETER;
+    return (streamtab[h]->CR&DMA_SxCR_CT) ? 1 : 0;
+}
+
+/**
+ * @brief  DMA_SetBuffer
+ *
+ * @note   Changes buffer k (0 or 1) in double buffer mode. Only the buffer that
+ *         is not being transferred can be changed while the stream runs
+ */
+int
+DMA_SetBuffer( int h, int k, void *m ) {
+DMA_Stream_TypeDef *stream;
+
+    if( h < 0 || h >= NSTREAMS || k < 0 || k > 1 )
+        return DMA_ERROR_PARAMETER;
+    if( ((uint32_t) m%streaminfo[h].block) != 0 )
+        return DMA_ERROR_ALIGNMENT;
+    stream = streamtab[h];
+    if( (stream->CR&DMA_SxCR_EN) && DMA_CurrentBuffer(h) == k )
+        return DMA_ERROR_BUSY;
+    if( k == 0 )
+        stream->M0AR = (uint32_t) m;
+    else
+        stream->M1AR = (uint32_t) m;
+    return DMA_OK;
+}
+
+/**
+ * @brief  Process the interrupt of a stream
+ *
+ * @note   A transfer error disables the stream. A FIFO error is only reported
+ *         when the FIFO is used
+ */
+static void ProcessInterrupt( int h ) {
+DMA_StreamInfo *s = &streaminfo[h];
+uint32_t flags;
+
+    flags = GetAndClearFlags(h);
+    if( (s->fcr&DMA_SxFCR_DMDIS) == 0 )
+        flags &= ~FLAG_FE;
+    if( !s->callback )
+        return;
+
+    if( flags&(FLAG_TE|FLAG_DME|FLAG_FE) )
+        s->callback(s->arg,DMA_EVENT_ERROR);
+    if( (flags&FLAG_HT) && (s->cr&DMA_SxCR_HTIE) )
+        s->callback(s->arg,DMA_EVENT_HALF);
+    if( flags&FLAG_TC )
+        s->callback(s->arg,DMA_EVENT_FULL);
+}
+
+/**
+ * @brief  Memory copy and fill
+ *
+ * @note   One operation for each DMA2 stream. The block is split in chunks of at
+ *         most 65535 items, started one after the other by the interrupt
+ */
+///@{
+typedef struct {
+    volatile int        busy;
+    int                 h;
+    uint8_t             *dst;           // of the next chunk
+    const uint8_t       *src;           // idem (not used for fill)
+    uint32_t            remaining;      // bytes not started yet
+    uint32_t            n;              // bytes of the current chunk
+    uint8_t             *start;         // of the whole block
+    uint32_t            total;
+    int                 fill;
+    volatile int        status;
+    DMA_Callback        callback;
+    void                *arg;
+} DMA_MemOp;
+
+static DMA_MemOp        memop[8];
+static uint32_t         mempattern[8][8] __attribute__((aligned(32)));
+static uint32_t         memthreshold = DMA_MEMCPY_THRESHOLD;
+///@}
+
+/**
+ * @brief  Cache maintenance over whole lines
+ */
+///@{
+static void CleanBuffer( const void *p, uint32_t n ) {
+uint32_t a = (uint32_t) p&~31U;
+
+    SCB_CleanDCache_by_Addr((uint32_t *) a,(((uint32_t) p+n+31)&~31U)-a);
+}
+
+static void CleanInvalidateBuffer( void *p, uint32_t n ) {
+uint32_t a = (uint32_t) p&~31U;
+
+    SCB_CleanInvalidateDCache_by_Addr((uint32_t *) a,(((uint32_t) p+n+31)&~31U)-a);
+}
+
+static void InvalidateBuffer( void *p, uint32_t n ) {
+uint32_t a = (uint32_t) p&~31U;
+
+    SCB_InvalidateDCache_by_Addr((uint32_t *) a,(((uint32_t) p+n+31)&~31U)-a);
+}
+///@}
+
+static void MemDone( void *arg, int event );
+
+/**
+ * @brief  Start the next chunk of an operation
+ *
+ * @note   The destination is 16 byte aligned, so its bursts are 4 words. The
+ *         source is read in words (or bytes when it is not word aligned)
+ */
+static int StartChunk( DMA_MemOp *op ) {
+DMA_Config dc;
+uint32_t n,max;
+int rc;
+
+    dc.dir      = DMA_DIR_M2M;
+    dc.psize    = (op->fill || ((uint32_t) op->src&3) == 0) ? DMA_SIZE_32 : DMA_SIZE_8;
+    dc.msize    = DMA_SIZE_32;
+    dc.burst    = DMA_BURST_4;
+    dc.priority = 0;                        // peripherals first
+    dc.flags    = DMA_FLAG_MINC;
+    dc.callback = MemDone;
+    dc.arg      = op;
+    if( op->fill ) {
+        dc.periph = mempattern[op->h-8];
+    } else {
+        dc.periph = (void *) op->src;
+        dc.flags |= DMA_FLAG_PINC;
+    }
+    rc = DMA_Configure(op->h,&dc);
+    if( rc < 0 )
+        return rc;
+
+    max = dc.psize == DMA_SIZE_32 ? 65532*4 : 65520;
+    n = op->remaining > max ? max : op->remaining;
+    op->n = n;
+    return DMA_Start(op->h,op->dst,0,n/dc.psize);
+}
+
+/**
+ * @brief  Finish an operation
+ */
+static void MemFinish( DMA_MemOp *op, int status ) {
+DMA_Callback cb = op->callback;
+void *arg = op->arg;
+
+    InvalidateBuffer(op->start,op->total);
+    DMA_Free(op->h);
+    op->status = status;
+    op->busy = 0;
+    if( cb )
+        cb(arg,status == DMA_OK ? DMA_EVENT_FULL : DMA_EVENT_ERROR);
+}
+
+/**
+ * @brief  Callback of the streams used for copy and fill
+ */
+static void MemDone( void *arg, int event ) {
+DMA_MemOp *op = (DMA_MemOp *) arg;
+
+    if( !op->busy || event == DMA_EVENT_HALF )
+        return;
+    if( event == DMA_EVENT_ERROR ) {
+        MemFinish(op,DMA_ERROR_TRANSFER);
+        return;
+    }
+    op->dst       += op->n;
+    op->remaining -= op->n;
+    if( !op->fill )
+        op->src   += op->n;
+    if( op->remaining == 0 )
+        MemFinish(op,DMA_OK);
+    else if( StartChunk(op) < 0 )
+        MemFinish(op,DMA_ERROR_TRANSFER);
+}
+
+/**
+ * @brief  Copy (fill<0) or fill n bytes
+ */
+static int MemStart( uint8_t *d, const uint8_t *s, int fill, uint32_t n,
+                     DMA_Callback cb, void *arg ) {
+DMA_MemOp *op;
+uint32_t head,body,tail;
+int h,rc;
+
+    head = (16-((uint32_t) d&15))&15;
+    if( head > n )
+        head = n;
+    body = (n-head)&~15U;
+    tail = n-head-body;
+
+    h = -1;
+    if( body >= 16 && body >= memthreshold )
+        h = DMA_Allocate(DMA_REQ_MEM2MEM);
+    if( h < 0 ) {
+        // By the CPU
+        if( fill >= 0 )
+            memset(d,fill,n);
+        else
+            memcpy(d,s,n);
+        if( cb )
+            cb(arg,DMA_EVENT_FULL);
+        return DMA_OK;
+    }
+
+    // The edges by the CPU, before the DMA writes the lines between them
+    if( fill >= 0 ) {
+        memset(d,fill,head);
+        memset(d+head+body,fill,tail);
+        mempattern[h-8][0] = (fill&0xFF)*0x01010101U;
+        CleanBuffer(mempattern[h-8],4);
+    } else {
+        memcpy(d,s,head);
+        memcpy(d+head+body,s+head+body,tail);
+        CleanBuffer(s+head,body);
+    }
+    CleanInvalidateBuffer(d+head,body);
+
+    op = &memop[h-8];
+    op->h         = h;
+    op->dst       = d+head;
+    op->src       = s ? s+head : 0;
+    op->remaining = body;
+    op->start     = d+head;
+    op->total     = body;
+    op->fill      = fill >= 0;
+    op->status    = DMA_OK;
+    op->callback  = cb;
+    op->arg       = arg;
+    op->busy      = 1;
+
+    rc = StartChunk(op);
+    if( rc < 0 ) {
+        op->busy = 0;
+        DMA_Free(h);
+        return rc;
+    }
+    if( cb )
+        return DMA_OK;
+
+    while( op->busy ) {}
+    return op->status;
+}
+
+/**
+ * @brief  DMA_Memcpy
+ *
+ * @note   Source and destination must not overlap
+ */
+int
+DMA_Memcpy( void *dst, const void *src, uint32_t n, DMA_Callback cb, void *arg ) {
+
+    return MemStart((uint8_t *) dst,(const uint8_t *) src,-1,n,cb,arg);
+}
+
+/**
+ * @brief  DMA_Memset
+ */
+int
+DMA_Memset( void *dst, int v, uint32_t n, DMA_Callback cb, void *arg ) {
+
+    return MemStart((uint8_t *) dst,0,v&0xFF,n,cb,arg);
+}
+
+/**
+ * @brief  DMA_SetMemcpyThreshold
+ *
+ * @note   Smallest block done by DMA (0 for all). The default is
+ *         DMA_MEMCPY_THRESHOLD
+ */
+void
+DMA_SetMemcpyThreshold( uint32_t n ) {
+
+    memthreshold = n;
+}
+
+#ifndef DMA_DONT_IMPLEMENT_IRQ
+/**
+ * @brief  DMA stream interrupts
+ */
+///@{
+void DMA1_Stream0_IRQHandler(void) {
+
+    ProcessInterrupt(D1(0));
+}
+
+void DMA1_Stream1_IRQHandler(void) {
+
+    ProcessInterrupt(D1(1));
+}
+
+void DMA1_Stream2_IRQHandler(void) {
+
+    ProcessInterrupt(D1(2));
+}
+
+void DMA1_Stream3_IRQHandler(void) {
+
+    ProcessInterrupt(D1(3));
+}
+
+void DMA1_Stream4_IRQHandler(void) {
+
+    ProcessInterrupt(D1(4));
+}
+
+void DMA1_Stream5_IRQHandler(void) {
+
+    ProcessInterrupt(D1(5));
+}
+
+void DMA1_Stream6_IRQHandler(void) {
+
+    ProcessInterrupt(D1(6));
+}
+
+void DMA1_Stream7_IRQHandler(void) {
+
+    ProcessInterrupt(D1(7));
+}
+
+void DMA2_Stream0_IRQHandler(void) {
+
+    ProcessInterrupt(D2(0));
+}
+
+void DMA2_Stream1_IRQHandler(void) {
+
+    ProcessInterrupt(D2(1));
+}
+
+void DMA2_Stream2_IRQHandler(void) {
+
+    ProcessInterrupt(D2(2));
+}
+
+void DMA2_Stream3_IRQHandler(void) {
+
+    ProcessInterrupt(D2(3));
+}
+
+void DMA2_Stream4_IRQHandler(void) {
+
+    ProcessInterrupt(D2(4));
+}
+
+void DMA2_Stream5_IRQHandler(void) {
+
+    ProcessInterrupt(D2(5));
+}
+
+void DMA2_Stream6_IRQHandler(void) {
+
+    ProcessInterrupt(D2(6));
+}
+
+void DMA2_Stream7_IRQHandler(void) {
+
+    ProcessInterrupt(D2(7));
+}
+///@}
+#endif
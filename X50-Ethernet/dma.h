@@ -0,0 +1,216 @@
+#ifndef DMA_H
+#define DMA_H
+/**
+ * @file    dma.h
+ *
+ * @brief   Allocation and configuration of the DMA1/DMA2 streams
+ *
+ * @note    Each peripheral request (e.g. I2C1 RX) can be served by one or two
+ *          stream/channel pairs (RM0385 Tables 27 and 28). DMA_Allocate takes
+ *          the first free one, so the peripherals share the 16 streams without
+ *          a fixed assignment. A stream is identified by a handle: 0-7 for
+ *          DMA1 Stream0-7 and 8-15 for DMA2 Stream0-7
+ *
+ * @note    Only DMA2 can do memory to memory transfers
+ *
+ * @note    Cache maintenance of the buffers is done by the caller, except for
+ *          DMA_Memcpy and DMA_Memset
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "irqprio.h"
+
+/**
+ * @brief   Requests
+ */
+///@{
+#define DMA_REQ_SPI1_RX                 (0)
+#define DMA_REQ_SPI1_TX                 (1)
+#define DMA_REQ_SPI2_RX                 (2)
+#define DMA_REQ_SPI2_TX                 (3)
+#define DMA_REQ_SPI3_RX                 (4)
+#define DMA_REQ_SPI3_TX                 (5)
+#define DMA_REQ_SPI4_RX                 (6)
+#define DMA_REQ_SPI4_TX                 (7)
+#define DMA_REQ_SPI5_RX                 (8)
+#define DMA_REQ_SPI5_TX                 (9)
+#define DMA_REQ_SPI6_RX                 (10)
+#define DMA_REQ_SPI6_TX                 (11)
+#define DMA_REQ_I2C1_RX                 (12)
+#define DMA_REQ_I2C1_TX                 (13)
+#define DMA_REQ_I2C2_RX                 (14)
+#define DMA_REQ_I2C2_TX                 (15)
+#define DMA_REQ_I2C3_RX                 (16)
+#define DMA_REQ_I2C3_TX                 (17)
+#define DMA_REQ_I2C4_RX                 (18)
+#define DMA_REQ_I2C4_TX                 (19)
+#define DMA_REQ_USART1_RX               (20)
+#define DMA_REQ_USART1_TX               (21)
+#define DMA_REQ_USART2_RX               (22)
+#define DMA_REQ_USART2_TX               (23)
+#define DMA_REQ_USART3_RX               (24)
+#define DMA_REQ_USART3_TX               (25)
+#define DMA_REQ_UART4_RX                (26)
+#define DMA_REQ_UART4_TX                (27)
+#define DMA_REQ_UART5_RX                (28)
+#define DMA_REQ_UART5_TX                (29)
+#define DMA_REQ_USART6_RX               (30)
+#define DMA_REQ_USART6_TX               (31)
+#define DMA_REQ_UART7_RX                (32)
+#define DMA_REQ_UART7_TX                (33)
+#define DMA_REQ_UART8_RX                (34)
+#define DMA_REQ_UART8_TX                (35)
+#define DMA_REQ_SDMMC1                  (36)
+#define DMA_REQ_QUADSPI                 (37)
+#define DMA_REQ_SAI1_A                  (38)
+#define DMA_REQ_SAI1_B                  (39)
+#define DMA_REQ_SAI2_A                  (40)
+#define DMA_REQ_SAI2_B                  (41)
+#define DMA_REQ_ADC1                    (42)
+#define DMA_REQ_ADC2                    (43)
+#define DMA_REQ_ADC3                    (44)
+#define DMA_REQ_DAC1                    (45)
+#define DMA_REQ_DAC2                    (46)
+#define DMA_REQ_DCMI                    (47)
+#define DMA_REQ_MEM2MEM                 (48)
+///@}
+
+/**
+ * @brief   Direction
+ */
+///@{
+#define DMA_DIR_P2M                     (0)
+#define DMA_DIR_M2P                     (1)
+#define DMA_DIR_M2M                     (2)
+///@}
+
+/**
+ * @brief   Data sizes (bytes)
+ */
+///@{
+#define DMA_SIZE_8                      (1)
+#define DMA_SIZE_16                     (2)
+#define DMA_SIZE_32                     (4)
+///@}
+
+/**
+ * @brief   Memory burst (beats)
+ *
+ * @note    With DMA_BURST_SINGLE, the stream works in direct mode (no FIFO) and
+ *          the memory size is the peripheral size. Otherwise the FIFO is used and
+ *          its threshold is set to the burst size, that must not exceed the
+ *          16 byte FIFO. DMA_BURST_AUTO uses the largest burst that fits
+ */
+///@{
+#define DMA_BURST_SINGLE                (0)
+#define DMA_BURST_4                     (4)
+#define DMA_BURST_8                     (8)
+#define DMA_BURST_16                    (16)
+#define DMA_BURST_AUTO                  (-1)
+///@}
+
+/**
+ * @brief   Flags
+ */
+///@{
+#define DMA_FLAG_MINC                   (1U<<0)     ///< increment memory address
+#define DMA_FLAG_PINC                   (1U<<1)     ///< increment peripheral address
+#define DMA_FLAG_CIRCULAR               (1U<<2)
+#define DMA_FLAG_DOUBLEBUFFER           (1U<<3)     ///< implies circular
+#define DMA_FLAG_HALF                   (1U<<4)     ///< half transfer callback
+#define DMA_FLAG_PFCTRL                 (1U<<5)     ///< peripheral flow control (SDMMC)
+///@}
+
+/**
+ * @brief   Events passed to the callback
+ *
+ * @note    In double buffer mode, DMA_EVENT_FULL means that the buffer given by
+ *          DMA_CurrentBuffer()^1 was completed and can be refilled
+ */
+///@{
+#define DMA_EVENT_HALF                  (1)
+#define DMA_EVENT_FULL                  (2)
+#define DMA_EVENT_ERROR                 (3)
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define DMA_OK                          (0)
+#define DMA_ERROR_PARAMETER             (-1)
+#define DMA_ERROR_BUSY                  (-2)        ///< no free stream for request
+#define DMA_ERROR_ALIGNMENT             (-3)
+#define DMA_ERROR_TRANSFER              (-4)
+///@}
+
+/**
+ * @brief   Priority of the DMA interrupts (see irqprio.h)
+ */
+#ifndef DMA_IRQ_PRIO
+#define DMA_IRQ_PRIO                    IRQPRIO_DMA
+#endif
+
+/**
+ * @brief   Callback
+ *
+ * @note    Called from the DMA interrupt
+ */
+typedef void (*DMA_Callback)(void *arg, int event);
+
+/**
+ * @brief   Configuration of a stream
+ */
+typedef struct {
+    int                 dir;            ///< DMA_DIR_*
+    volatile void       *periph;        ///< peripheral register (or source for M2M)
+    int                 psize;          ///< DMA_SIZE_*
+    int                 msize;          ///< DMA_SIZE_* (ignored in direct mode)
+    int                 burst;          ///< DMA_BURST_*
+    int                 priority;       ///< 0 (low) to 3 (very high)
+    uint32_t            flags;          ///< DMA_FLAG_*
+    DMA_Callback        callback;       ///< can be null
+    void                *arg;
+} DMA_Config;
+
+int      DMA_Allocate(int request);
+void     DMA_Free(int h);
+int      DMA_Configure(int h, const DMA_Config *conf);
+int      DMA_Start(int h, void *m0, void *m1, uint32_t n);
+void     DMA_Stop(int h);
+uint32_t DMA_Remaining(int h);
+int      DMA_CurrentBuffer(int h);
+int      DMA_SetBuffer(int h, int k, void *m);
+
+/**
+ * @brief   Memory copy and fill
+ *
+ * @note    Done by a DMA2 stream with 4 word bursts. Blocks smaller than the
+ *          threshold, or when no DMA2 stream is free, are done by the CPU. The
+ *          bytes before the first 16 byte aligned destination address and the
+ *          last n%16 bytes are always done by the CPU
+ *
+ * @note    The data cache is cleaned over the source and invalidated over the
+ *          destination. The destination should be aligned and padded to 32
+ *          bytes (cache line), so that no other data share its lines
+ *
+ * @note    With a callback, the functions return at once and the callback is
+ *          called (from the DMA interrupt or, when done by the CPU, before they
+ *          return) with DMA_EVENT_FULL or DMA_EVENT_ERROR. Without one, they
+ *          wait for the end of the transfer
+ */
+///@{
+#ifndef DMA_MEMCPY_THRESHOLD
+#define DMA_MEMCPY_THRESHOLD            (1024)
+#endif
+
+int      DMA_Memcpy(void *dst, const void *src, uint32_t n, DMA_Callback cb, void *arg);
+int      DMA_Memset(void *dst, int v, uint32_t n, DMA_Callback cb, void *arg);
+void     DMA_SetMemcpyThreshold(uint32_t n);
+///@}
+
+#endif // DMA_H
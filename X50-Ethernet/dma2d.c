@@ -0,0 +1,889 @@
+/**
+ * @file    dma2d.c
+ *
+ * @date    11/04/2021
+ * @author  Hans
+ *
+ * @brief   DMA2D (also called Chrome-Art Accelerator) is a specialized DMS unit than can:
+ *          1.  Fill a part or the whole of an image with a specific color
+ *          2.  Copy part or the whole of an image into a specific part of another image
+ *          3   Identical to the former but doing a pixel format conversion
+ *          4   Blend a part of an image into a destination image doing a pixel format conversion
+ *          5   Blend two images and copy into a destination image doing a pixel format conversion
+ *
+ * @brief   It can use a LUT (Look-Up Table)
+ *
+ * @brief   Pixel Format Conversion accepts inputs in ARGB8888, RGB888, RGB565, ARGB1555, ARGB4444,
+ *          L8, AL44, AL88, L4, A8 and A4 format and converts to outputs in ARGB8888, RGB888,
+ *          RGB565, ARGB1555 and ARGB4444 format
+ */
+
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+
+#include "dma2d.h"
+#include "cache.h"
+#include "clkgate.h"
+
+/**
+ * @brief   structure to hold parameters as used by DMA2D unit
+  *
+ * @note    Width and offset are in pixels as required by NLR and xxOR registers
+ */
+
+typedef struct {
+    unsigned        area;               ///< Address of first byte of 1st line
+    unsigned        w;                  ///< Width (pixels)
+    unsigned        h;                  ///< Height
+    unsigned        offset;             ///< Offset in pixels to start of next line
+    unsigned        pixelformat;        ///< Pixel format
+    unsigned        size;               ///< Size in bytes of the memory touched
+} Params;
+
+
+/**
+ * @brief Size in bits and in bytes of a pixel
+ */
+///@{
+static unsigned char pixelsizebits[] = {
+/*      0       1        2          3          4      5      6      7    8    9   10 */
+/* ARGB8888  RGB888   RGB565   ARGB1555   ARGB4444   L8   AL44   AL88   L4   A8   A4 */
+/*    I/O     1/O......I/O        I/O        I/O      I      I      I    I    I    I */
+       32,     24,      16,        16,        16,     8,     8,    16,   4,   8,   4
+};
+static unsigned char pixelsize[] = {
+/*      0       1        2          3          4      5      6      7    8    9   10 */
+/* ARGB8888  RGB888   RGB565   ARGB1555   ARGB4444   L8   AL44   AL88   L4   A8   A4 */
+/*    I/O     1/O......I/O        I/O        I/O      I      I      I    I    I    I */
+        4,      3,       2,         2,         2,     1,     1,     2,   1,   1,   1
+};
+///@}
+
+/**
+ * @brief   Last pixel format usable as output
+ */
+#define LASTOUTPUTFORMAT    DMA2D_ARGB4444
+
+/**
+ * @brief   Last valid pixel format
+ */
+#define LASTINPUTFORMAT     DMA2D_A4
+
+/**
+ * @brief   Size of CLUT (entries)
+ */
+#define CLUTSIZE            256
+
+
+/**
+ * @brief   calcParamsFromRegion
+ *
+ * @note    Converts the region description to DMA2D units: start address of
+ *          the first pixel (x,y), width and line offset in pixels
+ *
+ * @note    For 4-bit formats (L4, A4), x must be even
+ */
+static int
+calcParamsFromRegion(const DMA2DRegion *r, Params *p) {
+unsigned bits;
+unsigned ps;
+
+    if( r->pixelformat > LASTINPUTFORMAT )
+        return -1;
+
+    bits = pixelsizebits[r->pixelformat];
+    ps   = pixelsize[r->pixelformat];
+
+    p->pixelformat = r->pixelformat;
+    if( bits < 8 )
+        p->area = (unsigned) (r->address) + r->y*r->linesize + r->x/2;
+    else
+        p->area = (unsigned) (r->address) + r->y*r->linesize + r->x*ps;
+    p->w    = r->w;
+    p->h    = r->h;
+    p->offset= r->linesize*8/bits - r->w;
+    p->size = r->h*r->linesize;
+
+    return 0;
+}
+
+
+/**
+ * @brief   Operations
+ */
+///@{
+#define OP_FILL             0
+#define OP_COPY             1
+#define OP_BLEND            2
+#define OP_BATCH            3
+///@}
+
+/**
+ * @brief   Job: an operation with all parameters already converted
+ *
+ * @note    Used for synchronous and queued operations
+ */
+typedef struct {
+    unsigned        op;                 ///< OP_FILL, OP_COPY, OP_BLEND or OP_BATCH
+    Params          fg;                 ///< source or foreground
+    Params          bg;                 ///< background (blend only)
+    Params          dst;                ///< destination
+    unsigned        color;              ///< fill color
+    unsigned        alpha;              ///< foreground alpha (blend only)
+    DMA2D_Callback  callback;           ///< called at the end (queued only)
+    void           *arg;                ///< argument for callback
+    DMA2D_Fence     fence;              ///< fence value of the job
+    unsigned        batch;              ///< batch of an OP_BATCH job
+} Job;
+
+/**
+ * @brief   Job queue
+ *
+ * @note    jobqueue[queuetail] is the one running while queuecount > 0
+ */
+///@{
+static Job              jobqueue[DMA2D_QUEUESIZE];
+static unsigned         queuehead = 0;
+static unsigned         queuetail = 0;
+static volatile unsigned queuecount = 0;
+static DMA2D_Fence      lastfence = 0;
+static volatile DMA2D_Fence donefence = 0;
+static volatile unsigned errorcount = 0;
+///@}
+
+/**
+ * @brief   Batches
+ *
+ * @note    A batch is a list of jobs prepared in advance that takes a single
+ *          entry of the queue. The interrupt starts its jobs one after the
+ *          other and the entry ends with the last one
+ */
+///@{
+typedef struct {
+    volatile int    inuse;
+    unsigned        count;              ///< jobs in the batch
+    unsigned        next;               ///< job running
+    int             status;             ///< -1 when a job failed
+    Job             jobs[DMA2D_BATCHSIZE];
+} Batch;
+
+static Batch            batches[DMA2D_MAXBATCHES];
+///@}
+
+
+/**
+ * @brief   waitAndClear
+ *
+ * @note    Waits until previous operation and all queued ones are done and
+ *          clear its flags
+ *
+ * @note    So synchronous functions can not be called from a job callback
+ */
+static void
+waitAndClear(void) {
+
+    while( queuecount > 0 ) {}
+    while( !DMA2D_IsReady() ) {}
+
+    DMA2D->IFCR = DMA2D_IFCR_CTCIF|DMA2D_IFCR_CTEIF|DMA2D_IFCR_CCTCIF|DMA2D_IFCR_CAECIF;
+}
+
+
+/**
+ * @brief   prepareFill
+ *
+ * @note    Fills job for a register to memory operation. Returns -1 if invalid
+ *
+ * @note    The lines of the region are cleaned and invalidated in the data cache,
+ *          so no dirty line overwrites the fill later.
+ */
+static int
+prepareFill(Job *j, const DMA2DRegion *r, unsigned c) {
+
+    if( calcParamsFromRegion(r,&j->dst) < 0 || j->dst.pixelformat > LASTOUTPUTFORMAT )
+        return -1;
+
+    j->op    = OP_FILL;
+    j->color = c;
+
+    /* Memory written by DMA2D must not be in cache */
+    Cache_CleanInvalidateRange((void *) j->dst.area,j->dst.size);
+
+    return 0;
+}
+
+
+/**
+ * @brief   prepareCopy
+ *
+ * @note    Fills job for a memory to memory operation, with pixel format conversion
+ *          when the formats differ. Returns -1 if invalid
+ *
+ * @note    The source is cleaned from the data cache and the destination is
+ *          cleaned and invalidated
+ */
+static int
+prepareCopy(Job *j, const DMA2DRegion *src, const DMA2DRegion *dst) {
+
+    if( calcParamsFromRegion(src,&j->fg) < 0 || calcParamsFromRegion(dst,&j->dst) < 0 )
+        return -1;
+    if( j->dst.pixelformat > LASTOUTPUTFORMAT )
+        return -1;
+    if( j->fg.w > j->dst.w || j->fg.h > j->dst.h )
+        return -1;
+
+    j->op = OP_COPY;
+
+    Cache_CleanRange((void *) j->fg.area,j->fg.size);
+    Cache_CleanInvalidateRange((void *) j->dst.area,j->dst.size);
+
+    return 0;
+}
+
+
+/**
+ * @brief   prepareBlend
+ *
+ * @note    Fills job for a memory to memory operation with blending. Returns -1
+ *          if invalid
+ */
+static int
+prepareBlend(Job *j, const DMA2DRegion *fg, const DMA2DRegion *bg,
+             const DMA2DRegion *dst, unsigned alpha) {
+
+    if( calcParamsFromRegion(fg,&j->fg) < 0 || calcParamsFromRegion(bg,&j->bg) < 0
+     || calcParamsFromRegion(dst,&j->dst) < 0 )
+        return -1;
+    if( j->dst.pixelformat > LASTOUTPUTFORMAT )
+        return -1;
+    if( j->fg.w > j->bg.w || j->fg.h > j->bg.h || j->fg.w > j->dst.w || j->fg.h > j->dst.h )
+        return -1;
+
+    j->op    = OP_BLEND;
+    j->alpha = alpha >= 255 ? 255 : alpha;
+
+    Cache_CleanRange((void *) j->fg.area,j->fg.size);
+    Cache_CleanRange((void *) j->bg.area,j->bg.size);
+    Cache_CleanInvalidateRange((void *) j->dst.area,j->dst.size);
+
+    return 0;
+}
+
+
+/**
+ * @brief   startJob
+ *
+ * @note    Programs the DMA2D registers for the job and starts it
+ *
+ * @note    irqflags are set in CR (DMA2D_CR_TCIE|DMA2D_CR_TEIE for queued jobs)
+ */
+static void
+startJob(const Job *j, uint32_t irqflags) {
+const Params *pf = &j->fg;
+const Params *pb = &j->bg;
+const Params *pd = &j->dst;
+unsigned am;
+Batch *b;
+
+    switch(j->op) {
+    case OP_BATCH:
+        b = &batches[j->batch];
+        b->next = 0;
+        startJob(&b->jobs[0],irqflags);
+        return;
+    case OP_FILL:
+        /* Set register to memory mode (MODE=11) */
+        DMA2D->CR = DMA2D_CR_MODE_0|DMA2D_CR_MODE_1|irqflags;
+        /* Set color source */
+        DMA2D->OCOLR = j->color;
+        /* Set pixel per line and number of lines */
+        DMA2D->NLR = (pd->w<<DMA2D_NLR_PL_Pos)|(pd->h<<DMA2D_NLR_NL_Pos);
+        /* Offset to next start of line */
+        DMA2D->OOR = pd->offset;
+        break;
+    case OP_COPY:
+        /* Memory to memory (MODE=00) or with pixel format conversion (MODE=01) */
+        if( pf->pixelformat == pd->pixelformat )
+            DMA2D->CR = irqflags;
+        else
+            DMA2D->CR = DMA2D_CR_MODE_0|irqflags;
+        /* Source */
+        DMA2D->FGMAR = pf->area;
+        DMA2D->FGOR  = pf->offset;
+        DMA2D->FGPFCCR = (DMA2D->FGPFCCR&~(DMA2D_FGPFCCR_CM|DMA2D_FGPFCCR_AM|DMA2D_FGPFCCR_ALPHA))
+                         |(pf->pixelformat<<DMA2D_FGPFCCR_CM_Pos);
+        DMA2D->NLR = (pf->w<<DMA2D_NLR_PL_Pos)|(pf->h<<DMA2D_NLR_NL_Pos);
+        DMA2D->OOR = pd->w-pf->w+pd->offset;
+        break;
+    case OP_BLEND:
+        /* Alpha mode: 00 = no modification, 10 = multiply by ALPHA */
+        am = (j->alpha == 255) ? 0 : 2;
+        /* Memory to memory with blending (MODE=10) */
+        DMA2D->CR = DMA2D_CR_MODE_1|irqflags;
+        /* Foreground */
+        DMA2D->FGMAR = pf->area;
+        DMA2D->FGOR  = pf->offset;
+        DMA2D->FGPFCCR = (DMA2D->FGPFCCR&~(DMA2D_FGPFCCR_CM|DMA2D_FGPFCCR_AM|DMA2D_FGPFCCR_ALPHA))
+                         |(pf->pixelformat<<DMA2D_FGPFCCR_CM_Pos)
+                         |(am<<DMA2D_FGPFCCR_AM_Pos)
+                         |(j->alpha<<DMA2D_FGPFCCR_ALPHA_Pos);
+        /* Background */
+        DMA2D->BGMAR = pb->area;
+        DMA2D->BGOR  = pb->w-pf->w+pb->offset;
+        DMA2D->BGPFCCR = (DMA2D->BGPFCCR&~(DMA2D_BGPFCCR_CM|DMA2D_BGPFCCR_AM|DMA2D_BGPFCCR_ALPHA))
+                         |(pb->pixelformat<<DMA2D_BGPFCCR_CM_Pos);
+        DMA2D->NLR = (pf->w<<DMA2D_NLR_PL_Pos)|(pf->h<<DMA2D_NLR_NL_Pos);
+        DMA2D->OOR = pd->w-pf->w+pd->offset;
+        break;
+    }
+
+    /* Destination */
+    DMA2D->OPFCCR = pd->pixelformat;
+    DMA2D->OMAR   = pd->area;
+
+    /* Start operation */
+    DMA2D->CR |= DMA2D_CR_START;
+}
+
+
+/**
+ * @brief   DMA2D_Init
+ *
+ * @note    Initializes de DMA2D (ChromeArt Accelerator) unit
+ *
+ * @note    Enables the DMA2D interrupt used by the job queue
+ */
+int DMA2D_Init(void) {
+int i;
+
+    /* Enable clock for DMA2D unit, kept in Sleep mode (DMA2D_WaitFence) */
+    if( ClkGate_GetCount(CLKGATE_DMA2D) == 0 )
+        ClkGate_Enable(CLKGATE_DMA2D,CLKGATE_SLEEP);
+
+    queuehead  = 0;
+    queuetail  = 0;
+    queuecount = 0;
+    for(i=0;i<DMA2D_MAXBATCHES;i++)
+        batches[i].inuse = 0;
+
+    NVIC_SetPriority(DMA2D_IRQn,DMA2D_IRQLEVEL);
+    NVIC_EnableIRQ(DMA2D_IRQn);
+
+    return 0;
+}
+
+
+/**
+ * @brief   DMA2D_IsReady
+ *
+ * @note    Test if ongoing operation is done and unit is ready to accept new ones
+ *
+ * @note    Queued jobs are not considered. Use DMA2D_IsIdle
+ */
+int DMA2D_IsReady(void) {
+
+    return !(DMA2D->CR & DMA2D_CR_START);
+}
+
+
+/**
+ * @brief   DMA2D_Abort
+ *
+ * @note    Abort on going operation
+ */
+int DMA2D_Abort(void) {
+
+    DMA2D->CR |= DMA2D_CR_SUSP;
+
+    DMA2D->CR |= DMA2D_CR_ABORT;
+
+    return 1;
+}
+
+
+/**
+ * @brief   DMA2D_Suspend
+ *
+ * @note    Suspend the going operation
+ */
+int DMA2D_Suspend(void) {
+
+    DMA2D->CR |= DMA2D_CR_SUSP;
+
+    return 1;
+}
+
+
+/**
+ * @brief   DMA2D_Resume
+ *
+ * @note    Abort on going operation
+ */
+int DMA2D_Resume(void) {
+
+    DMA2D->CR &= ~DMA2D_CR_SUSP;
+
+    return 1;
+}
+
+
+/**
+ * @brief   DMA2D_FillRegion
+ *
+ * @note    Fill specified region with color c
+ *
+ * @note    If the CPU reads the region after the fill, Cache_InvalidateRange must
+ *          be called again after DMA2D_IsReady.
+ *
+ * @note    It waits until all queued jobs are done
+ */
+int DMA2D_FillRegion( const DMA2DRegion *r, unsigned c ) {
+Job j;
+
+    if( prepareFill(&j,r,c) < 0 )
+        return -1;
+
+    /* Wait until previus operation is done and unit is ready to accept a new one */
+    waitAndClear();
+
+    startJob(&j,0);
+
+    return 0;
+}
+
+
+/**
+ * @brief   DMA2D_LoadCLUT
+ *
+ * @note    Loads a color look up table (ARGB8888) used by the L8, AL44 and L4
+ *          formats of the foreground (layer=DMA2D_FOREGROUND) or background
+ *          (layer=DMA2D_BACKGROUND)
+ *
+ * @note    The CLUT is kept by the unit. It is only needed to load it again when
+ *          the palette changes. It waits until the load ends
+ */
+int DMA2D_LoadCLUT(int layer, const uint32_t *clut, unsigned n) {
+
+    if( n == 0 || n > CLUTSIZE )
+        return -1;
+
+    waitAndClear();
+
+    /* DMA2D reads the table from memory */
+    Cache_CleanRange(clut,n*sizeof(uint32_t));
+
+    if( layer == DMA2D_FOREGROUND ) {
+        DMA2D->FGCMAR = (uint32_t) clut;
+        DMA2D->FGPFCCR = (DMA2D->FGPFCCR&~(DMA2D_FGPFCCR_CS|DMA2D_FGPFCCR_CCM))
+                         |((n-1)<<DMA2D_FGPFCCR_CS_Pos);
+        DMA2D->FGPFCCR |= DMA2D_FGPFCCR_START;
+        while( DMA2D->FGPFCCR&DMA2D_FGPFCCR_START ) {}
+    } else {
+        DMA2D->BGCMAR = (uint32_t) clut;
+        DMA2D->BGPFCCR = (DMA2D->BGPFCCR&~(DMA2D_BGPFCCR_CS|DMA2D_BGPFCCR_CCM))
+                         |((n-1)<<DMA2D_BGPFCCR_CS_Pos);
+        DMA2D->BGPFCCR |= DMA2D_BGPFCCR_START;
+        while( DMA2D->BGPFCCR&DMA2D_BGPFCCR_START ) {}
+    }
+    DMA2D->IFCR = DMA2D_IFCR_CCTCIF|DMA2D_IFCR_CCAEIF;
+
+    return 0;
+}
+
+
+/**
+ * @brief   DMA2D_SetForegroundColor
+ *
+ * @note    Color (RGB888) used for A8 and A4 foreground pixels. Those formats
+ *          only have the alpha value
+ */
+int DMA2D_SetForegroundColor(unsigned c) {
+
+    waitAndClear();
+
+    DMA2D->FGCOLR = c&0xFFFFFF;
+
+    return 0;
+}
+
+
+/**
+ * @brief   DMA2D_CopyRegion
+ *
+ * @note    Copy region src to the top left corner of region dst. The size is the
+ *          one of src. It must fit in dst
+ *
+ * @note    When the pixel formats differ, a pixel format conversion is done
+ *          (e.g. RGB565 to ARGB8888). L8, AL44 and L4 sources are expanded using
+ *          the CLUT loaded by DMA2D_LoadCLUT
+ *
+ * @note    The source is cleaned from the data cache and the destination is
+ *          cleaned and invalidated before the start, as in DMA2D_FillRegion
+ */
+int DMA2D_CopyRegion(const DMA2DRegion *src, const DMA2DRegion *dst) {
+Job j;
+
+    if( prepareCopy(&j,src,dst) < 0 )
+        return -1;
+
+    waitAndClear();
+
+    startJob(&j,0);
+
+    return 0;
+}
+
+
+/**
+ * @brief   DMA2D_BlendRegion
+ *
+ * @note    Blends foreground region fg over background region bg and writes the
+ *          result in dst. All have the size of fg. bg and dst can be the same
+ *          region (composition in place)
+ *
+ * @note    alpha multiplies the alpha of each foreground pixel. With 255,
+ *          the alpha of the pixels is used as is
+ *
+ * @note    Sources are converted like in DMA2D_CopyRegion, including CLUT expansion
+ *          and the color set by DMA2D_SetForegroundColor for A8/A4
+ */
+int DMA2D_BlendRegion(const DMA2DRegion *fg, const DMA2DRegion *bg,
+                      const DMA2DRegion *dst, unsigned alpha) {
+Job j;
+
+    if( prepareBlend(&j,fg,bg,dst,alpha) < 0 )
+        return -1;
+
+    waitAndClear();
+
+    startJob(&j,0);
+
+    return 0;
+}
+
+
+/**
+ * @brief   enqueue
+ *
+ * @note    Puts job in the queue and starts it if the unit is idle
+ *
+ * @note    Returns the fence of the job or 0 when the queue is full
+ */
+static DMA2D_Fence
+enqueue(Job *j, DMA2D_Callback cb, void *arg) {
+uint32_t primask;
+Job *q;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if( queuecount >= DMA2D_QUEUESIZE ) {
+        __set_PRIMASK(primask);
+        return 0;
+    }
+    // Fence 0 means error
+    if( ++lastfence == 0 )
+        lastfence = 1;
+    j->fence    = lastfence;
+    j->callback = cb;
+    j->arg      = arg;
+    q = &jobqueue[queuehead];
+    *q = *j;
+    queuehead = (queuehead+1)%DMA2D_QUEUESIZE;
+    if( queuecount++ == 0 ) {
+        DMA2D->IFCR = DMA2D_IFCR_CTCIF|DMA2D_IFCR_CTEIF|DMA2D_IFCR_CCTCIF|DMA2D_IFCR_CAECIF;
+        startJob(q,DMA2D_CR_TCIE|DMA2D_CR_TEIE);
+    }
+    __set_PRIMASK(primask);
+
+    return j->fence;
+}
+
+
+/**
+ * @brief   DMA2D_SubmitFill
+ *
+ * @note    Queues a fill of region r with color c. It does not wait
+ *
+ * @note    cb (it can be 0) is called with arg from the DMA2D interrupt when done
+ *
+ * @note    Returns a fence for DMA2D_WaitFence or 0 on error (invalid region or
+ *          queue full)
+ *
+ * @note    Cache maintenance is done now. The CPU must not write in the regions
+ *          until the job is done
+ */
+DMA2D_Fence DMA2D_SubmitFill(const DMA2DRegion *r, unsigned c, DMA2D_Callback cb, void *arg) {
+Job j;
+
+    if( prepareFill(&j,r,c) < 0 )
+        return 0;
+
+    return enqueue(&j,cb,arg);
+}
+
+
+/**
+ * @brief   DMA2D_SubmitCopy
+ *
+ * @note    Queued version of DMA2D_CopyRegion. See DMA2D_SubmitFill
+ */
+DMA2D_Fence DMA2D_SubmitCopy(const DMA2DRegion *src, const DMA2DRegion *dst,
+                             DMA2D_Callback cb, void *arg) {
+Job j;
+
+    if( prepareCopy(&j,src,dst) < 0 )
+        return 0;
+
+    return enqueue(&j,cb,arg);
+}
+
+
+/**
+ * @brief   DMA2D_SubmitBlend
+ *
+ * @note    Queued version of DMA2D_BlendRegion. See DMA2D_SubmitFill
+ */
+DMA2D_Fence DMA2D_SubmitBlend(const DMA2DRegion *fg, const DMA2DRegion *bg,
+                              const DMA2DRegion *dst, unsigned alpha,
+                              DMA2D_Callback cb, void *arg) {
+Job j;
+
+    if( prepareBlend(&j,fg,bg,dst,alpha) < 0 )
+        return 0;
+
+    return enqueue(&j,cb,arg);
+}
+
+
+/**
+ * @brief   DMA2D_BeginBatch
+ *
+ * @note    Reserves a batch. Returns its handle or -1 when all are in use
+ *          (submitted and not done yet)
+ */
+DMA2D_Batch DMA2D_BeginBatch(void) {
+uint32_t primask;
+int i;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    for(i=0;i<DMA2D_MAXBATCHES;i++) {
+        if( !batches[i].inuse ) {
+            batches[i].inuse  = 1;
+            batches[i].count  = 0;
+            batches[i].status = 0;
+            __set_PRIMASK(primask);
+            return i;
+        }
+    }
+    __set_PRIMASK(primask);
+    return -1;
+}
+
+
+/**
+ * @brief   batchslot
+ *
+ * @note    Returns the next free job of batch b or 0 when it is full
+ */
+static Job *
+batchslot(DMA2D_Batch b) {
+
+    if( b < 0 || b >= DMA2D_MAXBATCHES || !batches[b].inuse
+     || batches[b].count >= DMA2D_BATCHSIZE )
+        return 0;
+    return &batches[b].jobs[batches[b].count];
+}
+
+
+/**
+ * @brief   DMA2D_BatchFill
+ *
+ * @note    Adds a fill to batch b. Cache maintenance is done now, as in
+ *          DMA2D_SubmitFill. Returns -1 when the region is invalid or the
+ *          batch is full
+ */
+int DMA2D_BatchFill(DMA2D_Batch b, const DMA2DRegion *r, unsigned c) {
+Job *j = batchslot(b);
+
+    if( j == 0 || prepareFill(j,r,c) < 0 )
+        return -1;
+    batches[b].count++;
+    return 0;
+}
+
+
+/**
+ * @brief   DMA2D_BatchCopy
+ *
+ * @note    Adds a copy to batch b. See DMA2D_BatchFill
+ */
+int DMA2D_BatchCopy(DMA2D_Batch b, const DMA2DRegion *src, const DMA2DRegion *dst) {
+Job *j = batchslot(b);
+
+    if( j == 0 || prepareCopy(j,src,dst) < 0 )
+        return -1;
+    batches[b].count++;
+    return 0;
+}
+
+
+/**
+ * @brief   DMA2D_BatchBlend
+ *
+ * @note    Adds a blend to batch b. See DMA2D_BatchFill
+ */
+int DMA2D_BatchBlend(DMA2D_Batch b, const DMA2DRegion *fg, const DMA2DRegion *bg,
+                     const DMA2DRegion *dst, unsigned alpha) {
+Job *j = batchslot(b);
+
+    if( j == 0 || prepareBlend(j,fg,bg,dst,alpha) < 0 )
+        return -1;
+    batches[b].count++;
+    return 0;
+}
+
+
+/**
+ * @brief   DMA2D_BatchCount
+ *
+ * @note    Returns the number of jobs in batch b
+ */
+unsigned DMA2D_BatchCount(DMA2D_Batch b) {
+
+    if( b < 0 || b >= DMA2D_MAXBATCHES )
+        return 0;
+    return batches[b].count;
+}
+
+
+/**
+ * @brief   DMA2D_SubmitBatch
+ *
+ * @note    Queues all jobs of batch b as one entry of the queue. cb is called
+ *          after the last one, with status -1 if any of them failed. The batch
+ *          is released when done
+ *
+ * @note    An empty batch is released at once and not queued. Then the fence
+ *          of the last queued job is returned and cb is not called
+ *
+ * @note    Returns a fence or 0 when the queue is full (the batch is kept and
+ *          can be submitted again)
+ */
+DMA2D_Fence DMA2D_SubmitBatch(DMA2D_Batch b, DMA2D_Callback cb, void *arg) {
+Job j;
+
+    if( b < 0 || b >= DMA2D_MAXBATCHES || !batches[b].inuse )
+        return 0;
+    if( batches[b].count == 0 ) {
+        batches[b].inuse = 0;
+        return lastfence;
+    }
+    j.op    = OP_BATCH;
+    j.batch = b;
+    return enqueue(&j,cb,arg);
+}
+
+
+/**
+ * @brief   DMA2D_FenceDone
+ *
+ * @note    Returns 1 when the job with fence f (and all before it) is done
+ *
+ * @note    Fences wrap around, so the comparison is done with the difference
+ */
+int DMA2D_FenceDone(DMA2D_Fence f) {
+
+    return (int32_t) (donefence-f) >= 0;
+}
+
+
+/**
+ * @brief   DMA2D_WaitFence
+ *
+ * @note    Waits (sleeping between interrupts) until the job with fence f is done
+ */
+void DMA2D_WaitFence(DMA2D_Fence f) {
+
+    while( !DMA2D_FenceDone(f) ) {
+        __WFI();
+    }
+}
+
+
+/**
+ * @brief   DMA2D_IsIdle
+ *
+ * @note    Returns 1 when no job is running or queued
+ */
+int DMA2D_IsIdle(void) {
+
+    return (queuecount == 0) && DMA2D_IsReady();
+}
+
+
+/**
+ * @brief   DMA2D_GetErrors
+ *
+ * @note    Returns the number of queued jobs that ended with a transfer or
+ *          configuration error
+ */
+unsigned DMA2D_GetErrors(void) {
+
+    return errorcount;
+}
+
+
+/**
+ * @brief   DMA2D_IRQHandler
+ *
+ * @note    Ends the running job, calls its callback and starts the next one
+ *
+ * @note    Callbacks run in interrupt context. They can submit new jobs
+ */
+void DMA2D_IRQHandler(void) {
+uint32_t isr;
+int status;
+Job *j;
+Batch *b;
+DMA2D_Callback cb;
+void *arg;
+
+    isr = DMA2D->ISR;
+    DMA2D->IFCR = isr&(DMA2D_ISR_TCIF|DMA2D_ISR_TEIF|DMA2D_ISR_CEIF);
+
+    if( (isr&(DMA2D_ISR_TCIF|DMA2D_ISR_TEIF|DMA2D_ISR_CEIF)) == 0 || queuecount == 0 )
+        return;
+
+    status = (isr&(DMA2D_ISR_TEIF|DMA2D_ISR_CEIF)) ? -1 : 0;
+    if( status < 0 )
+        errorcount++;
+
+    j = &jobqueue[queuetail];
+    if( j->op == OP_BATCH ) {
+        // A failed job does not stop the rest of the batch
+        b = &batches[j->batch];
+        if( status < 0 )
+            b->status = -1;
+        if( ++b->next < b->count ) {
+            startJob(&b->jobs[b->next],DMA2D_CR_TCIE|DMA2D_CR_TEIE);
+            return;
+        }
+        status   = b->status;
+        b->inuse = 0;
+    }
+
+    // The slot can be reused after queuecount is decremented
+    cb  = j->callback;
+    arg = j->arg;
+    donefence = j->fence;
+    queuetail = (queuetail+1)%DMA2D_QUEUESIZE;
+    queuecount--;
+
+    if( queuecount > 0 )
+        startJob(&jobqueue[queuetail],DMA2D_CR_TCIE|DMA2D_CR_TEIE);
+
+    if( cb )
+        cb(arg,status);
+}
@@ -0,0 +1,136 @@
+#ifndef DMA2D_H
+#define DMA2D_H
+/**
+ * @file    dma2d.h
+ *
+ * @date    11/04/2021
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "irqprio.h"
+
+
+typedef struct {
+    unsigned long   address;                ///< Address of 1st byte of 1st line
+    unsigned        x;                      ///< Horizontal position inside the englobing region
+    unsigned        y;                      ///< Vertical position inside the englobing region
+    unsigned        w;                      ///< Width of region
+    unsigned        h;                      ///< Height of region (Number of lines)
+    unsigned        pixelformat;            ///< Pixel format used in region
+    unsigned        linesize;               ///< Line size in bytes
+} DMA2DRegion;
+
+#define DECLARE_REGION(NAME,ADDR,X,Y,W,H,PF,LS)       \
+    DMA2DRegion NAME = { (unsigned long ) (ADDR),     \
+                         (unsigned)       (X),        \
+                         (unsigned)       (Y),        \
+                         (unsigned)       (W),        \
+                         (unsigned)       (H),        \
+                         (unsigned)       (PF),       \
+                         (unsigned)       (LS)        \
+                         }
+/**
+ * @brief   Pixel format recognized by the DMA2D
+ *
+ * @brief   Table 35 in section 9.3.4
+ *
+ * @brief   A is transparency (alpha value). 0xFF is opaque. 0 is transparent
+ *
+ * @brief   L is luminance (index to a LUT)
+ *
+ */
+#define DMA2D_ARGB8888                0
+#define DMA2D_RGB888                  1
+#define DMA2D_RGB565                  2
+#define DMA2D_ARGB1555                3
+#define DMA2D_ARGB4444                4
+#define DMA2D_L8                      5
+#define DMA2D_AL44                    6
+#define DMA2D_AL88                    7
+#define DMA2D_L4                      8
+#define DMA2D_A8                      9
+#define DMA2D_A4                     10
+
+/**
+ * @brief   Job queue
+ *
+ * @note    DMA2D_QUEUESIZE jobs can wait. The DMA2D interrupt starts the next one
+ */
+///@{
+#ifndef DMA2D_QUEUESIZE
+#define DMA2D_QUEUESIZE              16
+#endif
+#ifndef DMA2D_IRQLEVEL
+#define DMA2D_IRQLEVEL                IRQPRIO_DMA2D
+#endif
+///@}
+
+/**
+ * @brief   Fence returned by DMA2D_Submit*. 0 means not queued
+ */
+typedef uint32_t DMA2D_Fence;
+
+/**
+ * @brief   Completion callback. status is 0 when OK and -1 on DMA2D error
+ *
+ * @note    Called from the DMA2D interrupt
+ */
+typedef void (*DMA2D_Callback)(void *arg, int status);
+
+/**
+ * @brief   Batches of jobs submitted as one queue entry
+ * @note    DMA2D_MAXBATCHES batches of up to DMA2D_BATCHSIZE jobs each, so a
+ *          batch can be built while the previous one runs
+ */
+///@{
+#ifndef DMA2D_MAXBATCHES
+#define DMA2D_MAXBATCHES              2
+#endif
+#ifndef DMA2D_BATCHSIZE
+#define DMA2D_BATCHSIZE             128
+#endif
+typedef int DMA2D_Batch;
+///@}
+
+int DMA2D_Init(void);
+int DMA2D_IsReady(void);
+int DMA2D_Abort(void);
+int DMA2D_Suspend(void);
+int DMA2D_Resume(void);
+/**
+ * @brief   Layers with CLUT (for DMA2D_LoadCLUT)
+ */
+///@{
+#define DMA2D_FOREGROUND              0
+#define DMA2D_BACKGROUND              1
+///@}
+
+int DMA2D_FillRegion(const DMA2DRegion *r, unsigned c);
+int DMA2D_CopyRegion(const DMA2DRegion *src, const DMA2DRegion *dst);
+int DMA2D_BlendRegion(const DMA2DRegion *fg, const DMA2DRegion *bg,
+                      const DMA2DRegion *dst, unsigned alpha);
+int DMA2D_LoadCLUT(int layer, const uint32_t *clut, unsigned n);
+int DMA2D_SetForegroundColor(unsigned c);
+
+DMA2D_Fence DMA2D_SubmitFill(const DMA2DRegion *r, unsigned c, DMA2D_Callback cb, void *arg);
+DMA2D_Fence DMA2D_SubmitCopy(const DMA2DRegion *src, const DMA2DRegion *dst,
+                             DMA2D_Callback cb, void *arg);
+DMA2D_Fence DMA2D_SubmitBlend(const DMA2DRegion *fg, const DMA2DRegion *bg,
+                              const DMA2DRegion *dst, unsigned alpha,
+                              DMA2D_Callback cb, void *arg);
+DMA2D_Batch DMA2D_BeginBatch(void);
+int      DMA2D_BatchFill(DMA2D_Batch b, const DMA2DRegion *r, unsigned c);
+int      DMA2D_BatchCopy(DMA2D_Batch b, const DMA2DRegion *src, const DMA2DRegion *dst);
+int      DMA2D_BatchBlend(DMA2D_Batch b, const DMA2DRegion *fg, const DMA2DRegion *bg,
+                          const DMA2DRegion *dst, unsigned alpha);
+unsigned DMA2D_BatchCount(DMA2D_Batch b);
+DMA2D_Fence DMA2D_SubmitBatch(DMA2D_Batch b, DMA2D_Callback cb, void *arg);
+int      DMA2D_FenceDone(DMA2D_Fence f);
+void     DMA2D_WaitFence(DMA2D_Fence f);
+int      DMA2D_IsIdle(void);
+unsigned DMA2D_GetErrors(void);
+
+
+#endif
@@ -12,13 +12,19 @@
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "stm32f746xx.h"
 #include "system_stm32f746.h"
 #include "gpio.h"
 #include "eth.h"
+#include "cache.h"
+#include "irqprio.h"
+#include "clkgate.h"
 
 #include "debugmessages.h"
+#include "profile.h"
+#include "pt.h"
 
 /**
  * @brief   Which routine to use for configuring pin
@@ -45,6 +51,7 @@
 static inline void ETH_FlushTXFIFO(void);
 static void ETH_UpdateConfigStatus(void);
 static void ETH_ManualConfig(void);
+static uint16_t ETH_ConfigBCR(void);
 
 
 /**
@@ -110,6 +117,7 @@ static uint32_t ETH_ConfigStatus = ETH_CONFIGSTATUS_LINKDOWN;
 #define ETH_DELAY_AFTERAUTONEGOTIATION  1000
 #define ETH_DELAY_AFTERCONFIG           1000
 #define ETH_DELAY_BETWEENTESTS          1000
+#define ETH_PHYRESETTIME                500         // us before BCR is polled
 ///@}
 
 /**
@@ -120,49 +128,57 @@ static uint32_t ETH_ConfigStatus = ETH_CONFIGSTATUS_LINKDOWN;
 #define ETH_RETRIES_LINK                1000
 //@}
 /**
- * @brief   ETH IRQ Configuration
+ * @brief   ETH IRQ Configuration (see irqprio.h)
  */
 
-#define ETH_IRQLevel                            (5)
+#ifndef ETH_IRQLevel
+#define ETH_IRQLevel                            IRQPRIO_ETH
+#endif
 
 /**
- * @brief   RX and TX descriptors
- * 
- * @note    All sizes are rounded to uint32_t sizes, i.e. multiple of 4.
+ * @brief   RX and TX descriptors and buffers
+ *
+ * @note    Placed by ETH_SetBuffers in the area selected by ETH_BufferConfig.
+ *          The pool and SRAM2 are accessed by the ETH DMA, so they are not
+ *          cacheable (see cache.c)
  */
 ///@{
-#define ETH_TXBUFFERSIZE_INT32UNITS ROUND(ETH_TXBUFFER_SIZE,sizeof(uint32_t))
-#define ETH_RXBUFFERSIZE_INT32UNITS ROUND(ETH_RXBUFFER_SIZE,sizeof(uint32_t))
-#define ETH_TXBUFFERSIZE_INT8UNITS (ETH_TXBUFFERSIZE_INT32UNITS*sizeof(uint32_t))
-#define ETH_RXBUFFERSIZE_INT8UNITS (ETH_RXBUFFERSIZE_INT32UNITS*sizeof(uint32_t))
-
-// where to allocate
-#define EXTRAM     __attribute__ ((section(".sdram")))
-//#define EXTRAM
-    
-#ifdef ETH_ALLOCATE_BUFFERS_DYNAMICALLY
-    // These pointers must be initialized thru a call to ETH_SetBuffers
-    // They must be in a non cacheable area
-    ETH_DMADescriptor               *ETH_TXDescriptors = 0;
-    ETH_DMADescriptor               *ETH_RXDescriptors = 0;
-    static uint32_t                 *ETH_Area;
-    static uint8_t                  *txbuffer = 0;
-    static uint8_t                  *rxbuffer = 0;
-#else 
-    EXTRAM static ETH_DMADescriptor  ETH_TXDesc[ETH_TXBUFFER_COUNT] = { 0 };
-    EXTRAM static ETH_DMADescriptor  ETH_RXDesc[ETH_RXBUFFER_COUNT] = { 0 };
-    ETH_DMADescriptor               *ETH_TXDescriptors = ETH_TXDesc;
-    ETH_DMADescriptor               *ETH_RXDescriptors = ETH_RXDesc;
-// An alternative is to define them as an array of 32-bit integers for alignment
-#define TXBUFFERSIZE (ETH_TXBUFFERSIZE_INT8UNITS*ETH_TXBUFFER_COUNT)
-#define RXBUFFERSIZE (ETH_RXBUFFERSIZE_INT8UNITS*ETH_RXBUFFER_COUNT)
-
-    EXTRAM static uint8_t          txbuffer[TXBUFFERSIZE] 
-                                   __attribute((aligned(sizeof(uint32_t))));
-    EXTRAM static uint8_t          rxbuffer[RXBUFFERSIZE]
-                                   __attribute((aligned(sizeof(uint32_t))));
-#endif
+const ETH_BufferConfig ETH_BUFFERS_DEFAULT = {
+    ETH_TXBUFFER_COUNT, ETH_RXBUFFER_COUNT,
+    ETH_TXBUFFER_SIZE,  ETH_RXBUFFER_SIZE,
+    ETH_PLACEMENT_SDRAM, 0, 0
+};
+const ETH_BufferConfig ETH_BUFFERS_SMALL   = {
+    16, 32,
+    256, 256,
+    ETH_PLACEMENT_SRAM2, 0, 0
+};
+
+#define ETH_FRAMESIZE               (ETH_MTU+18)    // header and CRC
 
+static ETH_BufferConfig             ETH_BufferConf;
+
+NOCACHE static uint32_t             ETH_Pool[ETH_POOL_SIZE/sizeof(uint32_t)];
+
+// SRAM2 section of the linker script. Weak, so they are zero when not defined
+extern char _sram2_start[] __attribute__((weak));
+extern char _sram2_end[] __attribute__((weak));
+
+ETH_DMADescriptor                  *ETH_TXDescriptors = 0;
+ETH_DMADescriptor                  *ETH_RXDescriptors = 0;
+///@}
+
+/**
+ * @brief   Ring positions
+ *
+ * @note    ETH_TXCurrent is the next descriptor to be filled by the CPU and
+ *          ETH_RXCurrent is the next one to be checked for a received frame.
+ *          The DMA keeps its own position (DMACHTDR/DMACHRDR), so the CPU and the
+ *          DMA work on different parts of the rings at the same time
+ */
+///@{
+ETH_DMADescriptor                  *ETH_TXCurrent = 0;
+ETH_DMADescriptor                  *ETH_RXCurrent = 0;
 ///@}
 
 /**
@@ -190,6 +206,8 @@ struct ETH_Callbacks_s ETH_Callbacks       = {0};
 #define ETH_TXDESC0_CIC_BOTH_HW          (3<<22)
 #define ETH_TXDESC0_FIRST                (1<<28)
 #define ETH_TXDESC0_LAST                 (1<<29)
+#define ETH_TXDESC0_TTSS                 (1<<17)
+#define ETH_TXDESC0_TTSE                 (1<<25)
 // These fields are in word 1
 #define ETH_TXDESC1_BUFFER1SIZE_MSK      (0x1FFF)
 #define ETH_TXDESC1_BUFFER1SIZE_POS      (0)
@@ -207,8 +225,11 @@ struct ETH_Callbacks_s ETH_Callbacks       = {0};
 #define ETH_RXDESC0_ERROR_OVERFLOW       (1<<10)
 #define ETH_RXDESC0_FIRST                (1<<9)
 #define ETH_RXDESC0_LAST                 (1<<8)
+#define ETH_RXDESC0_IPHCE                (1<<7)
+#define ETH_RXDESC0_TSV                  (1<<7)     // same bit when timestamping is on
 #define ETH_RXDESC0_ERROR_RECEIVE        (1<<3)
 #define ETH_RXDESC0_ERROR_CRC            (1<<1)
+#define ETH_RXDESC0_ESA                  (1<<0)
 // These fields are in word 1
 #define ETH_RXDESC1_BUFFER1SIZE_MASK     (0x1FFF)
 #define ETH_RXDESC1_BUFFER1SIZE_POS      (0)
@@ -217,8 +238,29 @@ struct ETH_Callbacks_s ETH_Callbacks       = {0};
 #define ETH_RXDESC1_ENDOFRING            (1<<15)
 #define ETH_RXDESC1_CHAINED              (1<<14)
 #define ETH_RXDESC1_DIC                  (1<<31)
+// These fields are in word 4 (enhanced descriptors, valid when ESA is set)
+#define ETH_RXDESC4_IPPE                 (1<<3)
+#define ETH_RXDESC4_IPHE                 (1<<4)
 ///@}
 
+/**
+ * @brief   Timestamping of TX frames (all frames when PTP is used)
+ */
+#ifdef ETH_USE_PTP
+#define ETH_TXDESC0_TS                   ETH_TXDESC0_TTSE
+#else
+#define ETH_TXDESC0_TS                   0
+#endif
+
+/**
+ * @brief   Checksum insertion for TX descriptors
+ */
+#if CHECKSUM_BY_HARDWARE
+#define ETH_TXDESC0_CIC                  ETH_TXDESC0_CIC_BOTH_HW
+#else
+#define ETH_TXDESC0_CIC                  ETH_TXDESC0_CIC_DISABLED
+#endif
+
 /**
  * @brief   Defines for configure PHY
  *
@@ -352,22 +394,6 @@ struct ETH_Callbacks_s ETH_Callbacks       = {0};
 
 
 
-#ifdef ETH_ALLOCATE_BUFFERS_DYNAMICALLY
-/**
- * @brief   Flags for buffer initialization
- * 
- * @note    ETH_Init must run AFTER buffer initialization
- */
-///@{
-#define TXBUFFER_INITIALIZED            1
-#define RXBUFFER_INITIALIZED            2
-
-static uint8_t buffers_initialized = 0;
-///@}
-#endif
-
-
-
 /**
  * @brief   small simple delay routine
  */
@@ -518,22 +544,66 @@ volatile uint32_t t;
     *p = t;
 }
 
+/**
+ * @brief   Driver counters
+ *
+ * @note    Always on, independent of LWIP_STATS. Updated by the receive and
+ *          transmit routines and by the ETH interrupt
+ */
+static ETH_Statistics ETH_Stats;
+static unsigned ETH_DroppedFrames = 0;
+
+/**
+ * @brief   Cycle counter (DWT->CYCCNT) at the last receive interrupt and count
+ *          of these interrupts
+ *
+ * @note    A change of ETH_RXIRQCount tells that ETH_RXIRQTime is new. The count
+ *          is never reset (ETH_RXIRQBase is subtracted for the statistics)
+ */
+///@{
+volatile uint32_t ETH_RXIRQTime = 0;
+volatile uint32_t ETH_RXIRQCount = 0;
+static uint32_t   ETH_RXIRQBase = 0;
+///@}
+
+/**
+ * @brief   A PHY event must be processed (ETH_PHYProcess)
+ *
+ * @note    Set by the PHY interrupt or by ETH_PHYRequestUpdate. Initially set,
+ *          so the first ETH_PHYProcess reads the link state
+ */
+static volatile uint32_t ETH_PHYEventPending = 1;
+
 ////////////////// IRQ Handler /////////////////////////////////////////////////////////////////////
 
 #ifdef ETH_USE_ETH_IRQ
+/**
+ * @brief   Frames received and not processed yet
+ *
+ * @note    Set by the interrupt and cleared by the main loop
+ *          (ETH_ClearRXPending) before it drains the RX ring
+ */
+static volatile uint32_t ETH_RXPending = 0;
+
 /**
  * @brief   ETH interrupt handler
  * 
- * @note    Not tested yet!!!
+ * @note    The RX descriptors have the DIC bit set, so the RS interrupt is
+ *          generated by the receive watchdog (DMARSWTR), ETH_RXWATCHDOG
+ *          units after a frame. Under a flood this gives one interrupt for
+ *          many frames, all processed in the main loop
  */
 
 void ETH_IRQHandler(void) {
 
     // Check if a frame was received
     if( ETH->DMASR&ETH_DMASR_RS ) {
+        ETH->DMASR = ETH_DMASR_RS;
+        ETH_RXPending = 1;
+        ETH_RXIRQTime = DWT->CYCCNT;
+        ETH_RXIRQCount++;
         /* Call back if defined */
         if( ETH_Callbacks.FrameReceived ) ETH_Callbacks.FrameReceived(0);
-        ETH->DMASR = ETH_DMASR_RS;
         /* Set State to Ready */
         ETH_State = ETH_STATE_READY;
     }
@@ -559,6 +629,193 @@ void ETH_IRQHandler(void) {
     // Clear interrupt summary
     ETH->DMASR = ETH_DMASR_NIS;
 }
+
+/**
+ * @brief   ETH_IsRXPending
+ *
+ * @note    Returns 1 when a frame was received since ETH_ClearRXPending
+ */
+int
+ETH_IsRXPending(void) {
+
+    return ETH_RXPending;
+}
+
+/**
+ * @brief   ETH_ClearRXPending
+ *
+ * @note    Must be called before processing the received frames, so a frame
+ *          arriving meanwhile sets it again
+ */
+void
+ETH_ClearRXPending(void) {
+
+    ETH_RXPending = 0;
+}
+#endif
+
+////////////////// IEEE 1588 (PTP) /////////////////////////////////////////////////////////////////
+#ifdef ETH_USE_PTP
+/**
+ * @brief   Bits of PTPTSCR and PTPTSLUR
+ */
+///@{
+#define ETH_PTP_TSE                     (1<<0)      // timestamp enable
+#define ETH_PTP_TSFCU                   (1<<1)      // fine correction
+#define ETH_PTP_TSSTI                   (1<<2)      // initialize time
+#define ETH_PTP_TSSTU                   (1<<3)      // update (add/subtract) time
+#define ETH_PTP_TSARU                   (1<<5)      // update addend
+#define ETH_PTP_TSSSR                   (1<<9)      // sub seconds in ns (digital rollover)
+#define ETH_PTP_TSPTPPSV2E              (1<<10)     // PTP version 2
+#define ETH_PTP_TSSIPV4FE               (1<<13)     // PTP over UDP/IPv4
+#define ETH_PTP_TSSEME                  (1<<14)     // only event messages
+#define ETH_PTP_SUBTRACT                (1u<<31)    // PTPTSLUR: subtract the update
+///@}
+
+/**
+ * @brief   Last descriptor of the last frame queued for transmission
+ */
+static ETH_DMADescriptor *ETH_TXLast = 0;
+
+/**
+ * @brief   Nominal addend, when the PTP clock runs at 10^9/ETH_PTP_INCREMENT Hz
+ */
+static uint32_t ETH_PTPAddend = 0;
+
+/**
+ * @brief   ETH_PTPWait
+ *
+ * @note    Waits until the MAC clears the command bit in PTPTSCR
+ */
+static void
+ETH_PTPWait(uint32_t bit) {
+int retries = 100000;
+
+    while( (ETH->PTPTSCR&bit) && --retries ) {}
+}
+
+/**
+ * @brief   ETH_PTPInit
+ *
+ * @note    Starts the system time at 0 with fine correction. Each HCLK cycle
+ *          adds ETH_PTPAddend to a 32 bit accumulator and every overflow adds
+ *          ETH_PTP_INCREMENT ns to the time. The addend sets the frequency
+ *          (ETH_PTPAdjustFrequency)
+ *
+ * @note    Received PTPv2 event messages over UDP/IPv4 and all transmitted
+ *          frames are timestamped
+ */
+void
+ETH_PTPInit(void) {
+
+    // No timestamp trigger interrupt
+    ETH->MACIMR |= ETH_MACIMR_TSTIM;
+
+    ETH->PTPTSCR = ETH_PTP_TSE|ETH_PTP_TSSSR|ETH_PTP_TSPTPPSV2E
+                  |ETH_PTP_TSSIPV4FE|ETH_PTP_TSSEME;
+    ETH->PTPSSIR = ETH_PTP_INCREMENT;
+
+    ETH_PTPAddend = (uint32_t) ((((uint64_t) 1000000000/ETH_PTP_INCREMENT)<<32)
+                                                            /SystemCoreClock);
+    ETH->PTPTSAR = ETH_PTPAddend;
+    ETH->PTPTSCR |= ETH_PTP_TSARU;
+    ETH_PTPWait(ETH_PTP_TSARU);
+    ETH->PTPTSCR |= ETH_PTP_TSFCU;
+
+    ETH->PTPTSHUR = 0;
+    ETH->PTPTSLUR = 0;
+    ETH->PTPTSCR |= ETH_PTP_TSSTI;
+    ETH_PTPWait(ETH_PTP_TSSTI);
+}
+
+/**
+ * @brief   ETH_PTPGetTime
+ *
+ * @note    Reads the system time. The seconds are read again when the
+ *          nanoseconds wrapped between the two reads
+ */
+void
+ETH_PTPGetTime(ETH_PTPTime *t) {
+uint32_t sec,ns;
+
+    do {
+        sec = ETH->PTPTSHR;
+        ns  = ETH->PTPTSLR;
+    } while( sec != ETH->PTPTSHR );
+    t->seconds     = sec;
+    t->nanoseconds = ns;
+}
+
+/**
+ * @brief   ETH_PTPSetTime
+ */
+void
+ETH_PTPSetTime(const ETH_PTPTime *t) {
+
+    ETH->PTPTSHUR = t->seconds;
+    ETH->PTPTSLUR = t->nanoseconds;
+    ETH->PTPTSCR |= ETH_PTP_TSSTI;
+    ETH_PTPWait(ETH_PTP_TSSTI);
+}
+
+/**
+ * @brief   ETH_PTPAdjustTime
+ *
+ * @note    Adds offset (seconds and nanoseconds with the same sign, |ns| < 10^9)
+ *          to the system time (coarse correction)
+ */
+void
+ETH_PTPAdjustTime(int32_t seconds, int32_t nanoseconds) {
+
+    if( seconds < 0 || nanoseconds < 0 ) {
+        ETH->PTPTSHUR = -seconds;
+        ETH->PTPTSLUR = ETH_PTP_SUBTRACT|(uint32_t) (-nanoseconds);
+    } else {
+        ETH->PTPTSHUR = seconds;
+        ETH->PTPTSLUR = nanoseconds;
+    }
+    ETH->PTPTSCR |= ETH_PTP_TSSTU;
+    ETH_PTPWait(ETH_PTP_TSSTU);
+}
+
+/**
+ * @brief   ETH_PTPAdjustFrequency
+ *
+ * @note    Changes the rate of the system time by ppb parts per billion
+ *          relative to the nominal frequency (fine correction)
+ */
+void
+ETH_PTPAdjustFrequency(int32_t ppb) {
+int64_t addend;
+
+    addend = ETH_PTPAddend + ((int64_t) ETH_PTPAddend*ppb)/1000000000;
+    if( addend > 0xFFFFFFFF ) addend = 0xFFFFFFFF;
+    ETH->PTPTSAR = (uint32_t) addend;
+    ETH->PTPTSCR |= ETH_PTP_TSARU;
+    ETH_PTPWait(ETH_PTP_TSARU);
+}
+
+/**
+ * @brief   ETH_GetLastTXTimeStamp
+ *
+ * @note    Timestamp of the last frame queued by ETH_TransmitFrame or
+ *          ETH_TransmitBuffers, written by the DMA into its last descriptor
+ *
+ * @note    Returns 0 or -1 when the frame was not transmitted yet
+ */
+int
+ETH_GetLastTXTimeStamp(ETH_PTPTime *t) {
+uint32_t status;
+
+    if( ETH_TXLast == 0 )
+        return -1;
+    status = ETH_TXLast->Status;
+    if( (status&ETH_TXDESC0_OWN) || !(status&ETH_TXDESC0_TTSS) )
+        return -1;
+    t->seconds     = ETH_TXLast->TimeStampHigh;
+    t->nanoseconds = ETH_TXLast->TimeStampLow;
+    return 0;
+}
 #endif
 
 ////////////////// MAC Address Management //////////////////////////////////////////////////////////
@@ -643,6 +900,619 @@ uint64_t macaddr_rev;
 
 }
 
+////////////////// VLAN filtering /////////////////////////////////////////////////////////////////
+/**
+ * @brief   VLAN filter state
+ *
+ * @note    Id 0 disables the filter. It is kept across ETH_Init, that reloads
+ *          it into MACVLANTR
+ */
+///@{
+#define ETH_VLAN_MAXID                  4094
+static uint16_t ETH_VLANId = 0;
+static unsigned ETH_VLANFlags = 0;
+///@}
+
+/**
+ * @brief   ETH_LoadVLANFilter
+ *
+ * @note    12 bit comparison (VLANTC), so the priority bits are ignored. A tag
+ *          of 0 disables the comparison
+ */
+static void
+ETH_LoadVLANFilter(void) {
+
+    if( ETH_VLANId )
+        WRITETOREG(ETH->MACVLANTR,ETH_MACVLANTR_VLANTC|ETH_VLANId);
+    else
+        WRITETOREG(ETH->MACVLANTR,0);
+}
+
+/**
+ * @brief   ETH_VLANReject
+ *
+ * @note    Returns 1 when the frame has the tag of another VLAN, or has no tag
+ *          and ETH_VLAN_ACCEPTUNTAGGED is not set. The type and the tag are
+ *          in the first buffer (non cacheable)
+ */
+static int
+ETH_VLANReject(const ETH_DMAFrameInfo *info) {
+const uint8_t *frame;
+
+    if( ETH_VLANId == 0 )
+        return 0;
+    if( info->FrameLength < 18 )
+        return 1;
+
+    frame = (const uint8_t *) info->FirstSegmentDesc->Buffer1Addr;
+    if( frame[12] != 0x81 || frame[13] != 0x00 )
+        return (ETH_VLANFlags&ETH_VLAN_ACCEPTUNTAGGED) == 0;
+    return ((((uint16_t) frame[14]<<8)|frame[15])&0x0FFF) != ETH_VLANId;
+}
+
+/**
+ * @brief   ETH_SetVLANFilter
+ *
+ * @note    Only frames tagged with vid (1-4094) are received, and the untagged
+ *          ones with ETH_VLAN_ACCEPTUNTAGGED. vid 0 receives all frames
+ *
+ * @note    Returns 0 or -1 when vid is not valid
+ */
+int
+ETH_SetVLANFilter(uint16_t vid, unsigned flags) {
+
+    if( vid > ETH_VLAN_MAXID )
+        return -1;
+    ETH_VLANId = vid;
+    ETH_VLANFlags = flags;
+    if( RCC->AHB1ENR&RCC_AHB1ENR_ETHMACEN )
+        ETH_LoadVLANFilter();
+    return 0;
+}
+
+/**
+ * @brief   ETH_GetVLANFilter
+ *
+ * @note    Returns the VLAN id or 0 when the filter is disabled
+ */
+uint16_t
+ETH_GetVLANFilter(void) {
+
+    return ETH_VLANId;
+}
+
+////////////////// Raw frames ///////////////////////////////////////////////////////////////////
+/**
+ * @brief   Raw frame state
+ *
+ * @note    EtherType 0 disables the raw path. ETH_RawSegments is filled for
+ *          each raw frame received
+ */
+///@{
+#define ETH_RAW_MINTYPE                 0x0600
+static uint16_t ETH_RawType = 0;
+static ETH_RawHandler ETH_RawCallback = 0;
+static ETH_Buffer ETH_RawSegments[ETH_MAX_BUFFER_COUNT];
+///@}
+
+/**
+ * @brief   ETH_RawInput
+ *
+ * @note    Returns 1 when the frame has the raw EtherType and was passed to the
+ *          handler. The caller gives its descriptors back to the DMA
+ */
+static int
+ETH_RawInput(const ETH_DMAFrameInfo *info) {
+const uint8_t *frame;
+ETH_DMADescriptor *desc;
+unsigned type,pos,len;
+int n;
+
+    if( ETH_RawCallback == 0 || info->FrameLength < ETH_RAW_HEADER )
+        return 0;
+
+    frame = (const uint8_t *) info->FirstSegmentDesc->Buffer1Addr;
+    type = ((unsigned) frame[12]<<8)|frame[13];
+    if( type == 0x8100 && info->FrameLength >= ETH_RAW_HEADER+4 )
+        type = ((unsigned) frame[16]<<8)|frame[17];
+    if( type != ETH_RawType )
+        return 0;
+
+    // All buffers are full, except the last one. A last buffer with only the
+    // CRC is not passed
+    desc = info->FirstSegmentDesc;
+    pos = 0;
+    for(n=0;n<(int) info->SegmentCount && pos < info->FrameLength;n++) {
+        len = info->FrameLength-pos;
+        if( len > ETH_BufferConf.rxsize )
+            len = ETH_BufferConf.rxsize;
+        ETH_RawSegments[n].data = (const void *) desc->Buffer1Addr;
+        ETH_RawSegments[n].size = len;
+        pos += len;
+        desc = (ETH_DMADescriptor *) desc->Buffer2NextDescAddr;
+    }
+
+    ETH_Stats.rxframes++;
+    ETH_Stats.rxbytes += info->FrameLength;
+    ETH_Stats.rxrawframes++;
+    ETH_RawCallback(ETH_RawSegments,n,info);
+    return 1;
+}
+
+/**
+ * @brief   ETH_SetRawHandler
+ *
+ * @note    Frames with ethertype (0x0600 or more) are passed to handler. A null
+ *          handler or ethertype 0 disables it
+ *
+ * @note    Returns 0 or -1 when ethertype is a length (less than 0x0600)
+ */
+int
+ETH_SetRawHandler(uint16_t ethertype, ETH_RawHandler handler) {
+
+    if( ethertype != 0 && ethertype < ETH_RAW_MINTYPE )
+        return -1;
+    if( ethertype == 0 )
+        handler = 0;
+    ETH_RawType = ethertype;
+    ETH_RawCallback = handler;
+    return 0;
+}
+
+/**
+ * @brief   ETH_RawAlloc
+ *
+ * @note    Returns where the size bytes of the payload must be written, in the
+ *          DMA buffer of the next TX descriptor, or null when the descriptor is
+ *          still owned by the DMA (ring full) or the frame does not fit in it.
+ *          It must be followed by ETH_RawSend, with nothing sent between them
+ */
+uint8_t *
+ETH_RawAlloc(unsigned size) {
+#ifdef ETH_ZEROCOPY_TX
+    // The TX descriptors point to pbufs and not to the DMA buffers
+    (void) size;
+    return 0;
+#else
+ETH_DMADescriptor *desc = ETH_TXCurrent;
+
+    if( size+ETH_RAW_HEADER > ETH_BufferConf.txsize )
+        return 0;
+    if( desc->Status&ETH_TXDESC0_OWN )
+        return 0;
+    return (uint8_t *) desc->Buffer1Addr+ETH_RAW_HEADER;
+#endif
+}
+
+/**
+ * @brief   ETH_RawSend
+ *
+ * @note    Fills the header in front of the payload written after ETH_RawAlloc,
+ *          with the address of MACA0 as source and the raw EtherType, and
+ *          queues the frame. Short frames are padded by the MAC
+ *
+ * @note    Returns 0 or -1 when there is no raw EtherType or the frame could
+ *          not be queued
+ */
+int
+ETH_RawSend(const uint8_t dst[6], unsigned size) {
+uint8_t *frame;
+uint32_t lo,hi;
+
+    if( ETH_RawType == 0 || ETH_RawAlloc(size) == 0 )
+        return -1;
+
+    frame = (uint8_t *) ETH_TXCurrent->Buffer1Addr;
+    memcpy(frame,dst,6);
+    // The first byte of the address is in the low byte of MACA0LR
+    lo = ETH->MACA0LR;
+    hi = ETH->MACA0HR;
+    frame[6]  = lo;
+    frame[7]  = lo>>8;
+    frame[8]  = lo>>16;
+    frame[9]  = lo>>24;
+    frame[10] = hi;
+    frame[11] = hi>>8;
+    frame[12] = ETH_RawType>>8;
+    frame[13] = ETH_RawType;
+
+    return ETH_TransmitFrame(ETH_TXCurrent,size+ETH_RAW_HEADER);
+}
+
+////////////////// Loopback self test //////////////////////////////////////////////////////////////
+/**
+ * @brief   Fills a self test frame
+ *
+ * @note    Own address as destination and source, ETH_SELFTEST_TYPE, the
+ *          sequence number (big endian) and bytes seq+i
+ */
+static void
+ETH_SelfTestFill(uint8_t *frame, unsigned size, uint32_t seq) {
+uint32_t lo = ETH->MACA0LR;
+uint32_t hi = ETH->MACA0HR;
+unsigned i;
+
+    // The first byte of the address is in the low byte of MACA0LR
+    frame[0] = frame[6]  = lo;
+    frame[1] = frame[7]  = lo>>8;
+    frame[2] = frame[8]  = lo>>16;
+    frame[3] = frame[9]  = lo>>24;
+    frame[4] = frame[10] = hi;
+    frame[5] = frame[11] = hi>>8;
+    frame[12] = ETH_SELFTEST_TYPE>>8;
+    frame[13] = ETH_SELFTEST_TYPE&0xFF;
+    frame[14] = seq>>24;
+    frame[15] = seq>>16;
+    frame[16] = seq>>8;
+    frame[17] = seq;
+    for(i=18;i<size;i++)
+        frame[i] = (uint8_t) (seq+i);
+}
+
+/**
+ * @brief   Checks a received self test frame
+ *
+ * @note    Returns 0 or -1 when the frame is not the one ETH_SelfTestFill made.
+ *          Frames lost before it do not make it wrong
+ */
+static int
+ETH_SelfTestCheck(const ETH_DMAFrameInfo *info, unsigned size) {
+const uint8_t *frame = (const uint8_t *) info->FirstSegmentDesc->Buffer1Addr;
+uint32_t seq;
+unsigned i;
+
+    if( info->SegmentCount != 1 || info->FrameLength != size )
+        return -1;
+    if( frame[12] != ETH_SELFTEST_TYPE>>8 || frame[13] != (ETH_SELFTEST_TYPE&0xFF) )
+        return -1;
+    seq = ((uint32_t) frame[14]<<24)|((uint32_t) frame[15]<<16)|(frame[16]<<8)|frame[17];
+    for(i=18;i<size;i++) {
+        if( frame[i] != (uint8_t) (seq+i) )
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief   ETH_SelfTest
+ *
+ * @note    Sends frames of size bytes (without CRC) with the MAC in loopback
+ *          at 100 Mbit/s full duplex, keeping the TX ring full, and checks the
+ *          frames received. Fills res (see ETH_SelfTestResult)
+ *
+ * @note    It writes the frames in the DMA buffers of the TX descriptors, so it
+ *          must be called after ETH_Init and before the rings are given to
+ *          lwIP (stnetif_init calls ETH_Init again). The frame must fit in one
+ *          TX and in one RX buffer. The PHY must give the RMII REF_CLK
+ *
+ * @note    Returns ETH_OK when all frames were received with the right content,
+ *          ETH_ERROR_SELFTEST when not or ETH_ERROR_PARAMETER
+ */
+int
+ETH_SelfTest(unsigned frames, unsigned size, ETH_SelfTestResult *res) {
+ETH_DMADescriptor *desc;
+ETH_DMAFrameInfo info;
+uint32_t maccr,start,last,t,timeout,driver;
+int i,rc;
+
+    memset(res,0,sizeof(*res));
+    if( frames == 0 || size < ETH_SELFTEST_MINSIZE
+     || size > ETH_BufferConf.txsize || size+ETH_CRC > ETH_BufferConf.rxsize )
+        return ETH_ERROR_PARAMETER;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    // Loopback at the MII, so the link state does not matter
+    maccr = ETH->MACCR;
+    ETH->MACCR = maccr|ETH_MACCR_LM|ETH_MACCR_FES|ETH_MACCR_DM;
+    delay(20);
+    ETH_Start();
+
+    timeout = SystemCoreClock/100;          // 10 ms without a frame
+    driver = 0;
+    start = last = DWT->CYCCNT;
+    while( res->sent < frames || res->received+res->errors < res->sent ) {
+        // Keep the TX ring full
+        while( res->sent < frames ) {
+            desc = ETH_TXCurrent;
+            if( desc->Status&ETH_TXDESC0_OWN )
+                break;
+            ETH_SelfTestFill((uint8_t *) desc->Buffer1Addr,size,res->sent);
+            t = DWT->CYCCNT;
+            rc = ETH_TransmitFrame(desc,size);
+            driver += DWT->CYCCNT-t;
+            if( rc < 0 )
+                break;
+            res->sent++;
+        }
+        // Drain the RX ring
+        for(;;) {
+            t = DWT->CYCCNT;
+            rc = ETH_ReceiveFrame(&info);
+            driver += DWT->CYCCNT-t;
+            if( rc != 1 )
+                break;
+            if( ETH_SelfTestCheck(&info,size) < 0 )
+                res->errors++;
+            else
+                res->received++;
+            t = DWT->CYCCNT;
+            desc = info.FirstSegmentDesc;
+            for(i=0;i<info.SegmentCount;i++) {
+                desc->Status = ETH_RXDESC0_OWN;
+                desc = (ETH_DMADescriptor *) desc->Buffer2NextDescAddr;
+            }
+            ETH_ResumeReception();
+            driver += DWT->CYCCNT-t;
+            last = DWT->CYCCNT;
+        }
+        if( DWT->CYCCNT-last > timeout )
+            break;
+    }
+
+    ETH_Stop();
+    ETH->MACCR = maccr;
+    delay(20);
+
+    res->lost   = res->sent-res->received-res->errors;
+    res->cycles = last-start;
+    if( res->received > 0 ) {
+        res->cyclesperframe = driver/res->received;
+        if( res->cycles > 0 ) {
+            res->framespersecond = (uint32_t) (((uint64_t) res->received*SystemCoreClock)
+                                                /res->cycles);
+            res->bytespersecond  = (uint32_t) (((uint64_t) res->received*size*SystemCoreClock)
+                                                /res->cycles);
+        }
+    }
+    if( res->received != frames )
+        return ETH_ERROR_SELFTEST;
+    return ETH_OK;
+}
+
+////////////////// Statistics /////////////////////////////////////////////////////////////////////
+/**
+ * @brief   ETH_GetStatistics
+ *
+ * @note    The CRC and alignment errors are read from the MMC counters. Those
+ *          frames are discarded by the MAC and never reach a descriptor
+ */
+void
+ETH_GetStatistics(ETH_Statistics *st) {
+
+    ETH_Stats.rxirqs = ETH_RXIRQCount-ETH_RXIRQBase;
+    ETH_Stats.rxoverflow = ETH_GetDroppedFrames();
+    ETH_Stats.rxcrcerrors = ETH->MMCRFCECR;
+    ETH_Stats.rxalignerrors = ETH->MMCRFAECR;
+    *st = ETH_Stats;
+}
+
+/**
+ * @brief   ETH_ResetStatistics
+ */
+void
+ETH_ResetStatistics(void) {
+
+    (void) ETH_GetDroppedFrames();
+    ETH->MMCCR |= ETH_MMCCR_CR;             // self clearing
+    memset(&ETH_Stats,0,sizeof(ETH_Stats));
+    ETH_DroppedFrames = 0;
+    ETH_RXIRQBase = ETH_RXIRQCount;
+}
+
+/**
+ * @brief   ETH_ResumeReception
+ *
+ * @note    When the DMA found no free descriptor (RBUS), it is suspended. After
+ *          descriptors are given back, a poll demand restarts it
+ *
+ * @note    Returns 1 when the reception was suspended
+ */
+int
+ETH_ResumeReception(void) {
+
+    if( (ETH->DMASR&ETH_DMASR_RBUS) == 0 )
+        return 0;
+    ETH->DMASR = ETH_DMASR_RBUS;
+    ETH->DMARPDR = 0;
+    ETH_Stats.rxbufferunavailable++;
+    return 1;
+}
+
+////////////////// Multicast filtering /////////////////////////////////////////////////////////////
+/**
+ * @brief   Multicast filter state
+ *
+ * @note    The first ETH_PERFECTFILTER_COUNT groups use the perfect filters
+ *          MACA1 to MACA3. The others set a bit in the 64 bit hash table
+ *          (MACHTHR/MACHTLR). Bins shared by several groups are reference
+ *          counted, so removing a group does not drop the others. A bin that
+ *          reaches 255 is never cleared
+ *
+ * @note    It is kept across ETH_Init, that reloads it into the registers
+ */
+///@{
+#define ETH_PERFECTFILTER_COUNT         3
+#define ETH_MACAHR_AE                   (1u<<31)    // address enable
+static uint8_t  ETH_PerfectFilter[ETH_PERFECTFILTER_COUNT][6];
+static uint8_t  ETH_PerfectFilterUsed[ETH_PERFECTFILTER_COUNT];
+static uint8_t  ETH_HashCount[64];
+static uint32_t ETH_HashTable[2];           // low and high word
+///@}
+
+/**
+ * @brief   ETH_HashIndex
+ *
+ * @note    The MAC uses the upper 6 bits of the bit reversed complement of the
+ *          CRC32 of the destination address. The CRC is computed LSB first
+ *          with the reflected polynomial, so the index is the inverse of its
+ *          lower 6 bits
+ *
+ * @note    Bit 5 selects MACHTHR or MACHTLR, bits 4-0 the bit in the register
+ *
+ * @param   macaddr: address in network order (first byte sent first)
+ */
+unsigned
+ETH_HashIndex(const uint8_t macaddr[6]) {
+uint32_t crc = 0xFFFFFFFF;
+unsigned index = 0;
+int i,k;
+
+    for(i=0;i<6;i++) {
+        crc ^= macaddr[i];
+        for(k=0;k<8;k++)
+            crc = (crc>>1)^((crc&1)?0xEDB88320:0);
+    }
+    crc = ~crc;
+    for(k=0;k<6;k++)
+        index |= ((crc>>k)&1)<<(5-k);
+    return index;
+}
+
+/**
+ * @brief   ETH_SetPerfectFilter
+ *
+ * @note    Programs the perfect filter MACA(n+1). Byte 0 of the address goes
+ *          into bits 7-0 of MACAxLR
+ */
+static void
+ETH_SetPerfectFilter(int n, const uint8_t macaddr[6], int enable) {
+uint32_t hr,lr;
+
+    lr = macaddr[0]|(macaddr[1]<<8)|(macaddr[2]<<16)|((uint32_t) macaddr[3]<<24);
+    hr = macaddr[4]|(macaddr[5]<<8)|(enable?ETH_MACAHR_AE:0);
+    switch(n) {
+    case 0:
+        WRITETOREG(ETH->MACA1HR,hr);
+        WRITETOREG(ETH->MACA1LR,lr);
+        break;
+    case 1:
+        WRITETOREG(ETH->MACA2HR,hr);
+        WRITETOREG(ETH->MACA2LR,lr);
+        break;
+    case 2:
+        WRITETOREG(ETH->MACA3HR,hr);
+        WRITETOREG(ETH->MACA3LR,lr);
+        break;
+    }
+}
+
+/**
+ * @brief   ETH_LoadMulticastFilter
+ *
+ * @note    Writes the multicast filter state into the MAC registers
+ */
+static void
+ETH_LoadMulticastFilter(void) {
+int i;
+
+    for(i=0;i<ETH_PERFECTFILTER_COUNT;i++)
+        ETH_SetPerfectFilter(i,ETH_PerfectFilter[i],ETH_PerfectFilterUsed[i]);
+    WRITETOREG(ETH->MACHTHR,ETH_HashTable[1]);
+    WRITETOREG(ETH->MACHTLR,ETH_HashTable[0]);
+}
+
+/**
+ * @brief   ETH_AddMulticastAddress
+ *
+ * @note    Frames sent to macaddr (network order) are received. A group already
+ *          in a perfect filter is only counted once
+ *
+ * @note    Returns 0 when a perfect filter is used, 1 when the hash table is
+ *          used. Hashed groups can let in frames of other groups in the same bin
+ */
+int
+ETH_AddMulticastAddress(const uint8_t macaddr[6]) {
+unsigned index;
+int i,k,freeslot = -1;
+
+    for(i=0;i<ETH_PERFECTFILTER_COUNT;i++) {
+        if( !ETH_PerfectFilterUsed[i] ) {
+            if( freeslot < 0 ) freeslot = i;
+            continue;
+        }
+        for(k=0;k<6 && ETH_PerfectFilter[i][k]==macaddr[k];k++) {}
+        if( k == 6 && ETH_PerfectFilterUsed[i] < 255 ) {
+            ETH_PerfectFilterUsed[i]++;
+            return 0;
+        }
+    }
+    if( freeslot >= 0 ) {
+        for(k=0;k<6;k++)
+            ETH_PerfectFilter[freeslot][k] = macaddr[k];
+        ETH_PerfectFilterUsed[freeslot] = 1;
+        ETH_SetPerfectFilter(freeslot,macaddr,1);
+        return 0;
+    }
+
+    index = ETH_HashIndex(macaddr);
+    if( ETH_HashCount[index] < 255 )
+        ETH_HashCount[index]++;
+    if( ETH_HashCount[index] == 1 ) {
+        ETH_HashTable[index>>5] |= 1u<<(index&0x1F);
+        if( index&0x20 )
+            WRITETOREG(ETH->MACHTHR,ETH_HashTable[1]);
+        else
+            WRITETOREG(ETH->MACHTLR,ETH_HashTable[0]);
+    }
+    return 1;
+}
+
+/**
+ * @brief   ETH_RemoveMulticastAddress
+ *
+ * @note    Undoes one ETH_AddMulticastAddress of macaddr
+ */
+void
+ETH_RemoveMulticastAddress(const uint8_t macaddr[6]) {
+unsigned index;
+int i,k;
+
+    for(i=0;i<ETH_PERFECTFILTER_COUNT;i++) {
+        if( !ETH_PerfectFilterUsed[i] )
+            continue;
+        for(k=0;k<6 && ETH_PerfectFilter[i][k]==macaddr[k];k++) {}
+        if( k == 6 ) {
+            if( --ETH_PerfectFilterUsed[i] == 0 )
+                ETH_SetPerfectFilter(i,macaddr,0);
+            return;
+        }
+    }
+
+    index = ETH_HashIndex(macaddr);
+    if( ETH_HashCount[index] == 0 || ETH_HashCount[index] == 255 )
+        return;
+    if( --ETH_HashCount[index] == 0 ) {
+        ETH_HashTable[index>>5] &= ~(1u<<(index&0x1F));
+        if( index&0x20 )
+            WRITETOREG(ETH->MACHTHR,ETH_HashTable[1]);
+        else
+            WRITETOREG(ETH->MACHTLR,ETH_HashTable[0]);
+    }
+}
+
+/**
+ * @brief   ETH_GetDroppedFrames
+ *
+ * @note    Frames dropped by the DMA since ETH_Init, because there was no free
+ *          RX descriptor or the RX FIFO overflowed (DMAMFBOCR, cleared on read)
+ *
+ * @note    Frames rejected by the address filter are discarded before the FIFO
+ *          and are not counted by the MAC. They cost neither a DMA transfer nor
+ *          an interrupt
+ */
+unsigned
+ETH_GetDroppedFrames(void) {
+uint32_t v;
+
+    v = ETH->DMAMFBOCR;
+    ETH_DroppedFrames += (v&ETH_DMAMFBOCR_MFC)>>ETH_DMAMFBOCR_MFC_Pos;
+    ETH_DroppedFrames += (v&ETH_DMAMFBOCR_MFA)>>ETH_DMAMFBOCR_MFA_Pos;
+    return ETH_DroppedFrames;
+}
+
 /**
  * @brief   Get MAC Address #0 as a vector of bytes
  *
@@ -730,8 +1600,8 @@ static const GPIO_PinConfiguration pinconfig[] = {
 static void
 ETH_ConfigurePins(void) {
 
-    /* Configure pins from table*/
-    GPIO_ConfigureMultiplePins(pinconfig);
+    /* Configure pins from table, a port at a time */
+    GPIO_ConfigurePinTable(pinconfig);
 
 }
 
@@ -753,7 +1623,7 @@ uint32_t mAND,mOR; // Mask
     // Configure pins in GPIOA
     // 1/REFCLK  2/MDIO  7/CRS_DV
 
-    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN;
+    ClkGate_Enable(CLKGATE_GPIOA,0);
 
     mAND =   GPIO_AFRH_AFRH1_Msk
             |GPIO_AFRH_AFRH2_Msk
@@ -798,7 +1668,7 @@ uint32_t mAND,mOR; // Mask
     // Configure pins in GPIOC
     // 1/MDC  4/RXD0  5/RXD1
 
-    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOCEN;
+    ClkGate_Enable(CLKGATE_GPIOC,0);
 
     mAND =   GPIO_AFRH_AFRH1_Msk
             |GPIO_AFRH_AFRH4_Msk
@@ -843,7 +1713,7 @@ uint32_t mAND,mOR; // Mask
     // Configure pins in GPIOG
     // 11/TX_EN  13/TXD0  14/TXD1
 
-    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOGEN;
+    ClkGate_Enable(CLKGATE_GPIOG,0);
 
     mAND =   GPIO_AFRH_AFRH3_Msk
             |GPIO_AFRH_AFRH5_Msk
@@ -911,47 +1781,73 @@ const uint32_t ETH_RMIIRXER_MASK = (1<<2);
 
 #ifdef ETH_USE_GPIO_INTERRUPT
 /**
- * @brief   Interrupt routine for RMII_RX_ER
- * 
- * @note    The RMII_RXER is connected to pin 2 of GPIO Port G
+ * @brief   Pin used for the PHY interrupt (nINT, active low)
  */
+#define ETH_PHYINT_MASK                 (1<<2)
 
-
+/**
+ * @brief   Interrupt routine for the PHY interrupt
+ * 
+ * @note    nINT of the LAN8742 must be wired to pin 2 of GPIO Port G, taking
+ *          the place of RMII_RX_ER. It stays low until ISFR is read by
+ *          ETH_PHYProcess, so only the falling edge is used
+ *
+ * @note    The LinkStatusChanged callback can wake the task that calls
+ *          ETH_PHYProcess
+ */
 void EXTI2_IRQHandler(void) {
 
-     // TODO
-
+    if( (EXTI->PR&ETH_PHYINT_MASK) != 0 ) {
+        EXTI->PR = ETH_PHYINT_MASK;
+        ETH_PHYEventPending = 1;
+        if( ETH_Callbacks.LinkStatusChanged ) ETH_Callbacks.LinkStatusChanged(0);
+    }
 }
 
 /**
- * @brief  Configure that RMII_RX_ER generates an interrupt
+ * @brief  Configure that the PHY interrupt (PG2) generates an interrupt
  * 
- * @note   Since RMII_RX_ER is connected to pin 2 of GPIO G,
- *         and that only one pin 2 of a GPIO port can generate
- *         an interrupt, this routines configure the EXTI controller
- *         that GPIOG generates the interrupt.
+ * @note   Only one pin 2 of all GPIO ports can generate an interrupt. This
+ *         routine configures the EXTI controller that GPIOG generates it
  */
 void ConfigureEXTI2(void) {
 
-    SYSCFG->EXTICR1 =  (SYSCFG->EXTICR1&~SYSCFG_EXTICR1_EXT2_Msk)
-                      |(SYSCFG_EXTICR1_EXTI2_PG);
+    ClkGate_Enable(CLKGATE_GPIOG,0);
+    ClkGate_Enable(CLKGATE_SYSCFG,0);
+
+    // Input with pull-up (nINT is open drain)
+    GPIOG->MODER = GPIOG->MODER&~GPIO_MODER_MODER2_Msk;
+    GPIOG->PUPDR = (GPIOG->PUPDR&~GPIO_PUPDR_PUPDR2_Msk)|(1<<GPIO_PUPDR_PUPDR2_Pos);
+
+    SYSCFG->EXTICR[0] =  (SYSCFG->EXTICR[0]&~SYSCFG_EXTICR1_EXTI2_Msk)
+                        |(SYSCFG_EXTICR1_EXTI2_PG);
+
+    EXTI->FTSR |= ETH_PHYINT_MASK;      // Only falling edge
+    EXTI->PR    = ETH_PHYINT_MASK;
+    EXTI->IMR  |= ETH_PHYINT_MASK;      // Enable interrupt
+
+    NVIC_SetPriority(EXTI2_IRQn,ETH_IRQLevel);
+    NVIC_EnableIRQ(EXTI2_IRQn);
 }
 #endif
 
 /////////////////////////////////// Clock management ///////////////////////////////////////////////
 /**
  * @brief ETH_EnableClock
+ *
+ * @note  The clocks are kept in Sleep mode: the DMA receives frames and the
+ *        interrupt wakes the core
  */
 void ETH_EnableClock(uint32_t which) {
 
     // Enable PTP clock
-    if( which&ETH_CLOCK_PTP )   RCC->AHB1ENR |= RCC_AHB1ENR_ETHMACPTPEN;
+    if( which&ETH_CLOCK_PTP )   ClkGate_Enable(CLKGATE_ETHMACPTP,CLKGATE_SLEEP);
     // Enable Ethernet MAC Reception clock
-    if( which&ETH_CLOCK_MACRX ) RCC->AHB1ENR |= RCC_AHB1ENR_ETHMACRXEN;
+    if( which&ETH_CLOCK_MACRX ) ClkGate_Enable(CLKGATE_ETHMACRX,CLKGATE_SLEEP);
     // Enable Ethernet Transmission clock
-    if( which&ETH_CLOCK_MACTX ) RCC->AHB1ENR |= RCC_AHB1ENR_ETHMACTXEN;
+    if( which&ETH_CLOCK_MACTX ) ClkGate_Enable(CLKGATE_ETHMACTX,CLKGATE_SLEEP);
     // Enable MAC clock address
-    if( which&ETH_CLOCK_MAC )   RCC->AHB1ENR |= RCC_AHB1ENR_ETHMACEN;
+    if( which&ETH_CLOCK_MAC )   ClkGate_Enable(CLKGATE_ETHMAC,CLKGATE_SLEEP);
 
 }
 
@@ -961,13 +1857,13 @@ void ETH_EnableClock(uint32_t which) {
 void ETH_DisableClock(uint32_t which) {
 
     // Disable PTP clock
-    if( which&ETH_CLOCK_PTP )   RCC->AHB1ENR &= ~RCC_AHB1ENR_ETHMACPTPEN;
+    if( which&ETH_CLOCK_PTP )   ClkGate_Disable(CLKGATE_ETHMACPTP,CLKGATE_SLEEP);
     // Disable Ethernet Reception clock
-    if( which&ETH_CLOCK_MACRX ) RCC->AHB1ENR &= ~RCC_AHB1ENR_ETHMACRXEN;
+    if( which&ETH_CLOCK_MACRX ) ClkGate_Disable(CLKGATE_ETHMACRX,CLKGATE_SLEEP);
     // Disable Ethermet Trasmission clock
-    if( which&ETH_CLOCK_MACTX ) RCC->AHB1ENR &= ~RCC_AHB1ENR_ETHMACTXEN;
+    if( which&ETH_CLOCK_MACTX ) ClkGate_Disable(CLKGATE_ETHMACTX,CLKGATE_SLEEP);
     // Disable MAC clock address
-    if( which&ETH_CLOCK_MAC )   RCC->AHB1ENR &= ~RCC_AHB1ENR_ETHMACEN;
+    if( which&ETH_CLOCK_MAC )   ClkGate_Disable(CLKGATE_ETHMAC,CLKGATE_SLEEP);
 
 }
 
@@ -1015,139 +1911,420 @@ uint32_t macmiiar = ETH->MACMIIAR;
 
 
 /**
- * @brief  ETH_ReadPHYRegister
+ * @brief  ETH_ReadPHYRegister
+ */
+static int ETH_ReadPHYRegister( uint32_t reg, uint16_t *val) {
+uint32_t macmiiar = ETH->MACMIIAR;
+
+    // Set register to 0
+    *val = 0;
+
+    // Set data register to 0
+    ETH->MACMIIDR = 0;
+
+    // Clear all fields except CR
+    macmiiar &= ETH_MACMIIAR_CR_Msk;
+
+    // Set PHY address
+    macmiiar |= (ETH_PHY_ADDRESS<<ETH_MACMIIAR_PA_Pos);
+
+    // Set PHY register
+    macmiiar |= ((reg)<<ETH_MACMIIAR_MR_Pos);
+
+    // Set read operation
+    macmiiar &= ~ETH_MACMIIAR_MW;
+
+    // Wait until PHY is ready
+    while( (ETH->MACMIIAR&ETH_MACMIIAR_MB) == ETH_MACMIIAR_MB  ) {}  // TODO: Add timeout
+
+    // Set busy flag
+    macmiiar |= ETH_MACMIIAR_MB;
+
+    // Start read operation
+    ETH->MACMIIAR = macmiiar;
+
+    // Test if it runs ok
+    delay(10);
+    while( (ETH->MACMIIAR&ETH_MACMIIAR_MB) == ETH_MACMIIAR_MB ) {}  // TODO: Add timeout
+
+    // Read value
+    *val = ETH->MACMIIDR;
+
+    return 0;
+}
+
+////////////////// PHY events //////////////////////////////////////////////////////////////////////
+/**
+ * @brief   State of the link update (ETH_PHYProcess)
+ *
+ * @note    Each state has a MDIO read in progress. ETH_PHYProcess only
+ *          advances when MB is cleared, so it never waits for the PHY
+ */
+///@{
+#define ETH_PHYSTATE_IDLE               0
+#define ETH_PHYSTATE_ISFR               1       // reading ISFR (clears nINT)
+#define ETH_PHYSTATE_BSR                2       // reading BSR
+#define ETH_PHYSTATE_SCSR               3       // reading SCSR (speed/duplex)
+#define ETH_PHYSTATE_INIT               4       // ETH_PHYInitThread running
+
+static int      ETH_PHYState = ETH_PHYSTATE_IDLE;
+static uint16_t ETH_PHYSources = 0;             // last ISFR read
+static int      ETH_LinkState = 0;              // 1 when link up
+static int      ETH_LinkInfo = 0;               // ETH_LINKINFO_* of the link
+///@}
+
+/**
+ * @brief   Warm start (ETH_SetWarmStart)
+ *
+ * @note    Mode of the link before the reset, 0 for a cold start. ETH_WarmStart
+ *          is 1 when the PHY kept its configuration and was not reset again
+ */
+///@{
+static int      ETH_WarmLinkInfo = 0;
+static int      ETH_WarmStart = 0;
+///@}
+
+/**
+ * @brief   ETH_PHYStartRead
+ *
+ * @note    Starts the read of a PHY register and returns without waiting.
+ *          Returns -1 when another MDIO operation is in progress
+ */
+static int
+ETH_PHYStartRead(uint32_t reg) {
+uint32_t macmiiar;
+
+    if( ETH->MACMIIAR&ETH_MACMIIAR_MB )
+        return -1;
+    macmiiar  = ETH->MACMIIAR&ETH_MACMIIAR_CR_Msk;
+    macmiiar |= (ETH_PHY_ADDRESS<<ETH_MACMIIAR_PA_Pos);
+    macmiiar |= (reg<<ETH_MACMIIAR_MR_Pos);
+    macmiiar |= ETH_MACMIIAR_MB;            // read (MW=0)
+    ETH->MACMIIAR = macmiiar;
+    return 0;
+}
+
+/**
+ * @brief   ETH_PHYStartWrite
+ *
+ * @note    Starts the write of a PHY register and returns without waiting.
+ *          Returns -1 when another MDIO operation is in progress
+ */
+static int
+ETH_PHYStartWrite(uint32_t reg, uint16_t val) {
+uint32_t macmiiar;
+
+    if( ETH->MACMIIAR&ETH_MACMIIAR_MB )
+        return -1;
+    macmiiar  = ETH->MACMIIAR&ETH_MACMIIAR_CR_Msk;
+    macmiiar |= (ETH_PHY_ADDRESS<<ETH_MACMIIAR_PA_Pos);
+    macmiiar |= (reg<<ETH_MACMIIAR_MR_Pos);
+    macmiiar |= ETH_MACMIIAR_MW|ETH_MACMIIAR_MB;
+    ETH->MACMIIDR = val;
+    ETH->MACMIIAR = macmiiar;
+    return 0;
+}
+
+/**
+ * @brief   ETH_PHYReadDone
+ *
+ * @note    Returns 1 and the value when the read started by ETH_PHYStartRead
+ *          is finished, 0 otherwise
+ */
+static int
+ETH_PHYReadDone(uint16_t *val) {
+
+    if( ETH->MACMIIAR&ETH_MACMIIAR_MB )
+        return 0;
+    *val = ETH->MACMIIDR;
+    return 1;
+}
+
+/**
+ * @brief   ETH_PHYRequestUpdate
+ *
+ * @note    The next ETH_PHYProcess reads the PHY status. Called by the PHY
+ *          interrupt or periodically, when nINT is not connected
+ */
+void
+ETH_PHYRequestUpdate(void) {
+
+    ETH_PHYEventPending = 1;
+}
+
+/**
+ * @brief   ETH_PHYKeepsConfig
+ *
+ * @note    Returns 1 when BCR has the configuration of ETH_Config and the PHY
+ *          is neither in reset nor powered down, isolated or in loopback. With
+ *          autonegotiation, the speed and duplex bits are not used
+ */
+static int
+ETH_PHYKeepsConfig(uint16_t bcr) {
+uint16_t mask = ETH_PHY_BCR_RESET|ETH_PHY_BCR_LOOPBACK|ETH_PHY_BCR_POWERDOWN
+               |ETH_PHY_BCR_ISOLATE|ETH_PHY_BCR_AUTONEGOTIATIONENABLE;
+
+    if( !(ETH_Config&ETH_CONFIG_AUTONEGOTIATE) )
+        mask |= ETH_PHY_BCR_SPEED100MHz|ETH_PHY_BCR_FULLDUPLEX;
+    return (bcr&mask) == (ETH_ConfigBCR()&mask);
+}
+
+/**
+ * @brief   ETH_PHYInitThread
+ *
+ * @note    PHY reset and configuration as a protothread (pt.h), run by
+ *          ETH_PHYProcess. It waits for the reset and for each MDIO transfer
+ *          without blocking, so the boot continues meanwhile. The manual
+ *          configuration (without ETH_CONFIG_AUTONEGOTIATE) still blocks
+ *
+ * @note    The interrupt sources are enabled in IMR (ISFR is read only). ISFR
+ *          latches them even when nINT is not connected (on the STM32F746G-DISCO
+ *          the pin is REFCLKO), so ETH_PHYProcess also catches a short link
+ *          down when it is only called periodically. Reading ISFR clears it
+ */
+///@{
+static struct pt ETH_PHYInitPT;
+static uint32_t  ETH_PHYInitStart;
+
+static PT_THREAD(ETH_PHYInitThread(struct pt *pt)) {
+static uint16_t value;
+
+    PT_BEGIN(pt);
+
+    // After a warm reset, the PHY keeps the configuration when it was not
+    // reset with the MCU. Then its reset, the autonegotiation restart and the
+    // manual configuration are skipped, and the MAC gets the mode of the last
+    // link until ETH_PHYProcess reads it
+    ETH_WarmStart = 0;
+    if( ETH_WarmLinkInfo ) {
+        PT_WAIT_UNTIL(pt,ETH_PHYStartRead(ETH_PHY_BCR) == 0);
+        PT_WAIT_UNTIL(pt,ETH_PHYReadDone(&value));
+        ETH_WarmStart = ETH_PHYKeepsConfig(value);
+    }
+
+    if( ETH_WarmStart ) {
+        uint32_t maccr = ETH->MACCR&~(ETH_MACCR_FES|ETH_MACCR_DM);
+        if( ETH_WarmLinkInfo&0x2 ) maccr |= ETH_MACCR_FES;
+        if( ETH_WarmLinkInfo&0x4 ) maccr |= ETH_MACCR_DM;
+        WRITETOREG(ETH->MACCR,maccr);
+        MESSAGE("PHY configuration kept\n");
+    } else {
+        // Reset PHY and wait until Soft Reset bit self cleared
+        PT_WAIT_UNTIL(pt,ETH_PHYStartWrite(ETH_PHY_BCR,ETH_PHY_BCR_RESET) == 0);
+        PT_WAIT_ELAPSED(pt,ETH_PHYInitStart,ETH_PHYRESETTIME*(SystemCoreClock/1000000),DWT->CYCCNT);
+        do {
+            PT_WAIT_UNTIL(pt,ETH_PHYStartRead(ETH_PHY_BCR) == 0);
+            PT_WAIT_UNTIL(pt,ETH_PHYReadDone(&value));
+        } while( value&ETH_PHY_BCR_RESET );
+
+        // Autonegotiation runs in the PHY and is completed later (INT6). The
+        // link is not awaited here
+        if( ETH_Config&ETH_CONFIG_AUTONEGOTIATE ) {
+            PT_WAIT_UNTIL(pt,ETH_PHYStartWrite(ETH_PHY_BCR,ETH_PHY_BCR_AUTONEGOTIATIONENABLE) == 0);
+        } else {
+            PT_WAIT_WHILE(pt,ETH->MACMIIAR&ETH_MACMIIAR_MB);
+            ETH_ManualConfig();
+        }
+    }
+    // Only for the first initialization after the reset
+    ETH_WarmLinkInfo = 0;
+
+    PT_WAIT_UNTIL(pt,ETH_PHYStartWrite(ETH_PHY_IMR,ETH_PHY_IMR_INT4|ETH_PHY_IMR_INT6|ETH_PHY_IMR_INT7) == 0);
+    PT_WAIT_UNTIL(pt,ETH_PHYStartRead(ETH_PHY_ISFR) == 0);
+    PT_WAIT_UNTIL(pt,ETH_PHYReadDone(&value));
+
+    MESSAGE("PHY configured\n");
+    PT_END(pt);
+}
+///@}
+
+/**
+ * @brief   ETH_PHYProcess
+ *
+ * @note    Reads ISFR, BSR and SCSR one after the other without blocking. When
+ *          the link is up, the MAC is set to the speed and duplex mode found
+ *          by the PHY. ISFR is read first, so a link down and up between two
+ *          updates is not lost (INT4 is latched)
+ *
+ * @note    Returns ETH_PHY_CHANGED when the link went up or down (see
+ *          ETH_GetLinkState), ETH_PHY_BUSY while an update is in progress and
+ *          ETH_PHY_IDLE otherwise. It must be called from one context only
  */
-static int ETH_ReadPHYRegister( uint32_t reg, uint16_t *val) {
-uint32_t macmiiar = ETH->MACMIIAR;
-
-    // Set register to 0
-    *val = 0;
-
-    // Set data register to 0
-    ETH->MACMIIDR = 0;
+int
+ETH_PHYProcess(void) {
+uint16_t value;
+int up, changed = 0;
+
+    for(;;) {
+        switch(ETH_PHYState) {
+        case ETH_PHYSTATE_INIT:
+            if( PT_SCHEDULE(ETH_PHYInitThread(&ETH_PHYInitPT)) )
+                return ETH_PHY_BUSY;
+            // Link state is read now
+            ETH_PHYState = ETH_PHYSTATE_IDLE;
+            ETH_PHYEventPending = 1;
+            break;
+        case ETH_PHYSTATE_IDLE:
+            if( !ETH_PHYEventPending )
+                return ETH_PHY_IDLE;
+            if( ETH_PHYStartRead(ETH_PHY_ISFR) < 0 )
+                return ETH_PHY_BUSY;
+            ETH_PHYEventPending = 0;
+            ETH_PHYState = ETH_PHYSTATE_ISFR;
+            return ETH_PHY_BUSY;
+        case ETH_PHYSTATE_ISFR:
+            if( !ETH_PHYReadDone(&ETH_PHYSources) )
+                return ETH_PHY_BUSY;
+            // The link went down since the last update
+            if( (ETH_PHYSources&ETH_PHY_ISFR_INT4) && ETH_LinkState ) {
+                ETH_LinkState = 0;
+                ETH_LinkInfo = 0;
+                ETH_ConfigStatus = ETH_CONFIGSTATUS_LINKDOWN;
+                changed = 1;
+            }
+            ETH_PHYStartRead(ETH_PHY_BSR);
+            ETH_PHYState = ETH_PHYSTATE_BSR;
+            break;
+        case ETH_PHYSTATE_BSR:
+            if( !ETH_PHYReadDone(&value) )
+                return ETH_PHY_BUSY;
+            up = (value&ETH_PHY_BSR_LINKUP) != 0;
+            if( up && (ETH_Config&ETH_CONFIG_AUTONEGOTIATE)
+                   && !(value&ETH_PHY_BSR_AUTONEGOTIATIONCOMPLETED) ) {
+                // Wait for the autonegotiation complete event (INT6)
+                up = 0;
+            }
+            if( up ) {
+                ETH_PHYStartRead(ETH_PHY_SCSR);
+                ETH_PHYState = ETH_PHYSTATE_SCSR;
+                break;
+            }
+            if( ETH_LinkState ) {
+                ETH_LinkState = 0;
+                ETH_LinkInfo = 0;
+                ETH_ConfigStatus = ETH_CONFIGSTATUS_LINKDOWN;
+                changed = 1;
+            }
+            ETH_PHYState = ETH_PHYSTATE_IDLE;
+            goto done;
+        case ETH_PHYSTATE_SCSR:
+            if( !ETH_PHYReadDone(&value) )
+                return ETH_PHY_BUSY;
+            ETH_LinkInfo = (value>>2)&0x7;
+            ETH_ConfigStatus = ETH_CONFIGSTATUS_LINKUP;
+            if( ETH_LinkInfo&0x2 ) ETH_ConfigStatus |= ETH_CONFIGSTATUS_100BASET;
+            else                   ETH_ConfigStatus |= ETH_CONFIGSTATUS_10BASET;
+            if( ETH_LinkInfo&0x4 ) ETH_ConfigStatus |= ETH_CONFIGSTATUS_FULLDUPLEX;
+            else                   ETH_ConfigStatus |= ETH_CONFIGSTATUS_HALFDUPLEX;
+            {
+            uint32_t maccr = ETH->MACCR&~(ETH_MACCR_FES|ETH_MACCR_DM);
+            if( ETH_LinkInfo&0x2 ) maccr |= ETH_MACCR_FES;
+            if( ETH_LinkInfo&0x4 ) maccr |= ETH_MACCR_DM;
+            if( maccr != ETH->MACCR )
+                WRITETOREG(ETH->MACCR,maccr);
+            }
+            if( !ETH_LinkState ) {
+                ETH_LinkState = 1;
+                changed = 1;
+            }
+            ETH_PHYState = ETH_PHYSTATE_IDLE;
+            goto done;
+        }
+    }
+done:
+    // Another event arrived during the update
+    if( ETH_PHYEventPending && !changed )
+        return ETH_PHY_BUSY;
+    return changed ? ETH_PHY_CHANGED : ETH_PHY_IDLE;
+}
 
-    // Clear all fields except CR
-    macmiiar &= ETH_MACMIIAR_CR_Msk;
+/**
+ * @brief   ETH_GetPHYEvents
+ *
+ * @note    Sources (ETH_PHY_EVENT_*) found by the last update
+ */
+uint16_t
+ETH_GetPHYEvents(void) {
 
-    // Set PHY address
-    macmiiar |= (ETH_PHY_ADDRESS<<ETH_MACMIIAR_PA_Pos);
+    return ETH_PHYSources;
+}
 
-    // Set PHY register
-    macmiiar |= ((reg)<<ETH_MACMIIAR_MR_Pos);
+/**
+ * @brief   ETH_GetLinkState
+ *
+ * @note    Link state found by the last ETH_PHYProcess. Does not access the PHY
+ */
+int
+ETH_GetLinkState(void) {
 
-    // Set read operation
-    macmiiar &= ~ETH_MACMIIAR_MW;
+    return ETH_LinkState;
+}
 
-    // Wait until PHY is ready
-    while( (ETH->MACMIIAR&ETH_MACMIIAR_MB) == ETH_MACMIIAR_MB  ) {}  // TODO: Add timeout
+/**
+ * @brief   ETH_GetLinkMode
+ *
+ * @note    Speed and duplex mode (ETH_LINKINFO_*) found by the last
+ *          ETH_PHYProcess, 0 when the link is down. Does not access the PHY
+ */
+int
+ETH_GetLinkMode(void) {
 
-    // Set busy flag
-    macmiiar |= ETH_MACMIIAR_MB;
+    return ETH_LinkInfo;
+}
 
-    // Start read operation
-    ETH->MACMIIAR = macmiiar;
+/**
+ * @brief   ETH_SetWarmStart
+ *
+ * @note    Mode (ETH_LINKINFO_*) of the link before a warm reset, 0 for a cold
+ *          start. Must be called before ETH_Init. ETH_PHYInitThread then checks
+ *          BCR and skips the PHY reset and configuration when they are kept
+ */
+void
+ETH_SetWarmStart(int linkinfo) {
 
-    // Test if it runs ok
-    delay(10);
-    while( (ETH->MACMIIAR&ETH_MACMIIAR_MB) == ETH_MACMIIAR_MB ) {}  // TODO: Add timeout
+    ETH_WarmLinkInfo = linkinfo&0x7;
+}
 
-    // Read value
-    *val = ETH->MACMIIDR;
+/**
+ * @brief   ETH_IsWarmStart
+ *
+ * @note    1 when the last ETH_Init kept the PHY configuration
+ */
+int
+ETH_IsWarmStart(void) {
 
-    return 0;
+    return ETH_WarmStart;
 }
 
 /**
  * @brief  Configure PHY
  *
  * @note   PHY is Microchip LAN
+ *
+ * @note   Only starts ETH_PHYInitThread. The reset, the configuration and
+ *         the link are completed by ETH_PHYProcess, which configures the MAC
+ *         when the link comes up
  */
 
 static int ETH_ConfigurePHY(void) {
-uint16_t value;
-int retries;
-int configured = 0;
 
     MESSAGE("Entering ConfigurePHY\n");
 
-    // Reset PHY
-    ETH_WritePHYRegister(ETH_PHY_BCR,ETH_PHY_BCR_RESET);
-    delay(ETH_DELAY_AFTERRESET*100);
-    // Wait until Soft Reset bit self cleared
-    do { 
-        value = 0xFFFF;
-        ETH_ReadPHYRegister(ETH_PHY_BCR,&value);
-        delay(ETH_DELAY_AFTERRESET);
-    } while ( value&ETH_PHY_BCR_RESET );
-
-    // Configure Auto-Negotiation Advertisement Register
-    // Should be done by MODE2_0 pins!!
-    //ETH_WritePHYRegister(ETH_PHY_ANA,ETH_PHY_ANA_ALL);
-    //delay(ETH_DELAY_BETWEENTESTS);
-
-    // It this needed?
-    //value &= ETH_PHY_BCR_LOOPBACK;
-
-    // Wait until connected (linked)
-    retries = ETH_RETRIES_LINK*100;
-    do {
-        value = 0;
-        ETH_ReadPHYRegister(ETH_PHY_BSR,&value);
-        delay(ETH_DELAY_BETWEENTESTS);
-    } while( (retries-->0)&&((value&ETH_PHY_BSR_LINKUP)==0) );
-
-    // Configure using auto negotiation when connected
-    if( (ETH_Config&ETH_CONFIG_AUTONEGOTIATE) && (value&ETH_PHY_BSR_LINKUP) ) {
-        // Start autonegotiating
-        ETH_WritePHYRegister(ETH_PHY_BCR,ETH_PHY_BCR_AUTONEGOTIATIONENABLE);
-        delay(ETH_DELAY_AFTERREGISTERWRITE);
-    
-        // Wait until Auto Negotiation Completed
-        retries = ETH_RETRIES_AUTONEGOTIATION;
-        do {
-            value = 0;
-            ETH_ReadPHYRegister(ETH_PHY_BSR,&value);
-            delay(ETH_DELAY_BETWEENTESTS);
-        } while( (retries-->0)&&((value&ETH_PHY_BSR_AUTONEGOTIATIONCOMPLETED)==0) );
-
-        if( (value&ETH_PHY_BSR_AUTONEGOTIATIONCOMPLETED)  ) {
-            // Autonegotiation completed
-            configured = 1;
-        }           
-    }
-    if( ! configured ) {
-        // Manual configuration
-        ETH_ManualConfig();
-        configured = 1;
+    // ETH_PHYInitThread uses the cycle counter for the reset time
+    if( (DWT->CTRL&DWT_CTRL_CYCCNTENA_Msk) == 0 ) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->LAR = 0xC5ACCE55;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
     }
-    // Update speed and connection in ConfigStatus
-    ETH_UpdateConfigStatus();
 
-    MESSAGEV("Link status = ***%s***\n",ETH_GetLinkInfoString());
-    
-    /*
-     * This code sequence is identical to the one generated by
-     * STM32CubeMX.
-     * 
-     * Since nINT not connected, PHY can not generate interrupts.
-     * According LAN8742A datasheet, change of ISFR does not make sense,
-     * because its fields are Read-Only.
-     * 
-     * But this register is vendor-specific. Maybe it does not work
-     * following the datasheet.
-     * 
-     * From oryx-embedded.com
-     * Any link failure condition is latched in the BMSR register. Reading
-     * the register twice will always return the actual link status
-     */
-    #if 0
-    // Enable interrupt on link status 
-    ETH_ReadPHYRegister(ETH_PHY_ISFR,&value);
-    value |= ETH_PHY_ISFR_INT4;
-    ETH_WritePHYRegister(ETH_PHY_ISFR,value);
-    // Read again to clear
-    ETH_ReadPHYRegister(ETH_PHY_ISFR,&value);
-    #endif
+    PT_INIT(&ETH_PHYInitPT);
+    ETH_PHYState = ETH_PHYSTATE_INIT;
+    ETH_LinkState = 0;
+    ETH_LinkInfo = 0;
+    ETH_PHYEventPending = 0;
+
+    // First steps now, the rest in ETH_PHYProcess
+    ETH_PHYProcess();
 
     return 0;
 }
@@ -1322,10 +2499,16 @@ static int ETH_ConfigureMAC(void) {
     // No deferral check
     // Receiver and transmitter disabled, for now
     maccr |=     0
+#if CHECKSUM_BY_HARDWARE
                 |ETH_MACCR_IPCO         // Checksum by hardware
+#endif
                 |ETH_MACCR_IFG_96Bit    // Interframe gap = 96
                 |ETH_MACCR_RD           // Retry disable = 1
                 |ETH_MACCR_BL_10        // Backoff limit = min(n,4)
+#ifdef ETH_JUMBO
+                |ETH_MACCR_WD           // Receive frames up to 16384 bytes
+                |ETH_MACCR_JD           // Transmit frames up to 16384 bytes
+#endif
                 ;
 
     // Set configuration for Fast Ethernet and Full Duplex, when possible
@@ -1354,12 +2537,14 @@ static int ETH_ConfigureMAC(void) {
     // Source address inverse filter disabled
     // Block all control frames
     // Broadcast frame enabled
-    // Pass all multicast depends on Hash multicast bit
+    // Pass all multicast disabled
     // Destination address inverse filtering normal
-    // Hash multicast perfect
+    // Multicast accepted by the perfect filters MACA1-3 or the hash table
     // No promiscuous mode
     macffr |=    0
                 |ETH_MACFFR_PCF_BlockAll    // Block all control frames
+                |ETH_MACFFR_HPF             // Perfect or hash filter
+                |ETH_MACFFR_HM              // Hash filter for multicast
                 ;
     // Set configuration
     ETH->MACFFR = macffr;
@@ -1368,9 +2553,10 @@ static int ETH_ConfigureMAC(void) {
     ETH->MACFFR = macffr;
 
     /*************** MACHTxR: Hash table high/low register ********************/
+    /*************** MACA1-3: Perfect filters for multicast groups ************/
 
-    ETH->MACHTHR = 0;
-    ETH->MACHTLR = 0;
+    // Groups added before (e.g. by stnetif_init) are kept
+    ETH_LoadMulticastFilter();
 
     /*************** MACMIIAR: MII address register ***************************/
     // Used in ConfigurePHY
@@ -1407,18 +2593,8 @@ static int ETH_ConfigureMAC(void) {
     
     /*************** MACMVLANTR: VLAN tag register ****************************/
 
-    volatile uint32_t macvlantr = ETH->MACVLANTR;
-
-    // Clear all fields
-    macvlantr &= 0;
-
-    // Configure
-    // 16 bit comparison
-    // Tag = 0
-    ETH->MACVLANTR  = macvlantr;
-    macvlantr = ETH->MACVLANTR;
-    delay(ETH_DELAY_AFTERREGISTERWRITE);
-    ETH->MACVLANTR  = macvlantr;
+    // VLAN id set before (ETH_SetVLANFilter) is kept. 0 when not used
+    ETH_LoadVLANFilter();
     
     return 0;
 }
@@ -1530,12 +2706,23 @@ static int ETH_ConfigureDMA(void) {
     // Start/stop receive
     //
     // See Errata: Transmit frame data corruption (Set TSF=1!!!)
+    //
+    // Jumbo frames do not fit the 2 KB FIFOs and use the thresholds. The
+    // corruption of the errata needs the TX FIFO to run empty inside a frame,
+    // and the DMA reads the descriptor buffers much faster than the line rate
 
+#ifdef ETH_JUMBO
+    dmaomr |= ETH_DMAOMR_TTC_256Bytes   // Transmit threshold control
+#else
     dmaomr |= ETH_DMAOMR_RSF            // Receive and Store Forward
              |ETH_DMAOMR_TSF            // Transmit and Store Forward
              |ETH_DMAOMR_TTC_64Bytes    // Transmit threshold control
+#endif
              |ETH_DMAOMR_RTC_64Bytes    // Receive threshold control
         //     |ETH_DMAOMR_OSF            // Operate on second frame
+#if CHECKSUM_BY_HARDWARE
+             |ETH_DMAOMR_DTCEFD         // Checksum errors reported, not dropped
+#endif
              ;
     // Configure DMAOMR
     ETH->DMAOMR = dmaomr;
@@ -1550,24 +2737,20 @@ static int ETH_ConfigureDMA(void) {
 /**
  * @brief   ETH_InitTXDescriptors
  *
- * @note    desc must be an array of DMA Descriptors
- *
- * @note    area must be at least count*ETH_TXBUFFER_SIZE
+ * @note    desc must be an array of count DMA Descriptors
  *
- * @note    desc and area must be static!!!
+ * @note    area must have count buffers of size bytes (multiple of 4)
  */
-
-void ETH_InitTXDescriptors(ETH_DMADescriptor *desc, int count, uint8_t *area) {
+static void
+ETH_InitTXDescriptors(ETH_DMADescriptor *desc, int count, unsigned size, uint8_t *area) {
 int i;
-uint32_t *a = (uint32_t *) area;
 
     ETH_TXDescriptors = desc;
     for(i=0;i<count;i++) {
-        desc->Status    = ETH_TXDESC0_CHAINED | ETH_TXDESC0_CIC_BOTH_HW;
+        desc->Status    = ETH_TXDESC0_CHAINED | ETH_TXDESC0_CIC | ETH_TXDESC0_TS;
         __DSB();
-        SCB_CleanDCache();
-        desc->ControlBufferSize = ETH_TXBUFFERSIZE_INT8UNITS;
-        desc->Buffer1Addr = (uint32_t) (a + i*ETH_TXBUFFERSIZE_INT32UNITS);
+        desc->ControlBufferSize = size;
+        desc->Buffer1Addr = (uint32_t) (area + i*size);
         desc->Buffer2NextDescAddr = (uint32_t) (ETH_TXDescriptors+((i+1)%count));
         desc->ExtendedStatus = 0; 
         desc->Reserved1 = 0;
@@ -1576,36 +2759,29 @@ uint32_t *a = (uint32_t *) area;
         desc++;
     }
 
+    ETH_TXCurrent = ETH_TXDescriptors;
+
     // Write table address to the ETH interface
     ETH->DMATDLAR = (uint32_t) ETH_TXDescriptors;
-
-#ifdef ETH_ALLOCATE_BUFFERS_DYNAMICALLY
-    buffers_initialized |= TXBUFFER_INITIALIZED;
-#endif
-
 }
 
 /**
  * @brief ETH_InitRXDescriptors
  *
- * @note  desc must be an array of DMA Descriptor
+ * @note  desc must be an array of count DMA Descriptors
  *
- * @note  area must be count*ETH_TXBUFFER_SIZE
- *
- * @note  desc and area must be static!!!
+ * @note  area must have count buffers of size bytes (multiple of 4)
  */
-
-
-void ETH_InitRXDescriptors(ETH_DMADescriptor *desc, int count, uint8_t *area) {
+static void
+ETH_InitRXDescriptors(ETH_DMADescriptor *desc, int count, unsigned size, uint8_t *area) {
 int i;
-uint32_t *a = (uint32_t *) area;
 
     ETH_RXDescriptors = desc;
     for(i=0;i<count;i++) {
-        desc->ControlBufferSize = (ETH_RXBUFFER_SIZE<<ETH_RXDESC1_BUFFER1SIZE_POS) 
+        desc->ControlBufferSize = (size<<ETH_RXDESC1_BUFFER1SIZE_POS) 
                                 | ETH_RXDESC1_CHAINED 
                                 | ETH_RXDESC1_DIC;
-        desc->Buffer1Addr =  (uint32_t) (a + i*ETH_RXBUFFERSIZE_INT32UNITS);
+        desc->Buffer1Addr =  (uint32_t) (area + i*size);
         desc->Buffer2NextDescAddr = (uint32_t) (ETH_RXDescriptors+((i+1)%count));
         desc->ExtendedStatus = 0; 
         desc->Reserved1 = 0;
@@ -1617,37 +2793,76 @@ uint32_t *a = (uint32_t *) area;
         desc++;
     }
 
+    ETH_RXCurrent = ETH_RXDescriptors;
+
     // Write table address to the ETH interface
     ETH->DMARDLAR = (uint32_t) ETH_RXDescriptors;
-
-#ifdef ETH_ALLOCATE_BUFFERS_DYNAMICALLY
-    buffers_initialized |= RXBUFFER_INITIALIZED;
-#endif
-
 }
 
-#ifdef ETH_ALLOCATE_BUFFERS_DYNAMICALLY
 /**
- * @brief ETH InitializeBuffers
- *
- * @note  Initialize all descriptors to point to buffers insided area
- *
- * @note  area must be aligned to a word address.]
+ * @brief   ETH_SetBuffers
  *
- * @note  area must have a size equal or largert to (ETH_TXBUFFER_COUNT*ETH_TXBUFFER_SIZE
- *   +ETH_RXBUFFER_COUNT*ETH_TXBUFFER_SIZE) bytes, with ETH_TXBUFFER_SIZE and ETH_RXBUFFER_SIZE
- *   multiple of sizeof(uint32_t)_
+ * @note    Checks the configuration and divides the area into the descriptors,
+ *          the TX buffers and the RX buffers
  */
+static int
+ETH_SetBuffers(const ETH_BufferConfig *conf) {
+uint8_t *area;
+uint32_t areasize,need;
+
+    if( conf->txcount < 2 || conf->txcount > ETH_MAX_BUFFER_COUNT
+     || conf->rxcount < 2 || conf->rxcount > ETH_MAX_BUFFER_COUNT
+     || conf->txsize < ETH_MIN_BUFFER_SIZE || conf->txsize > ETH_MAX_BUFFER_SIZE
+     || conf->rxsize < ETH_MIN_BUFFER_SIZE || conf->rxsize > ETH_MAX_BUFFER_SIZE
+     || (conf->txsize&3) != 0 || (conf->rxsize&3) != 0 )
+        return ETH_ERROR_BUFFERCONFIG;
+
+    // A frame must fit in each ring
+    if( (uint32_t) conf->txcount*conf->txsize < ETH_FRAMESIZE
+     || (uint32_t) conf->rxcount*conf->rxsize < ETH_FRAMESIZE )
+        return ETH_ERROR_BUFFERCONFIG;
+
+    switch( conf->placement ) {
+    case ETH_PLACEMENT_SDRAM:
+        area     = (uint8_t *) ETH_Pool;
+        areasize = sizeof(ETH_Pool);
+        break;
+    case ETH_PLACEMENT_SRAM2:
+        area     = (uint8_t *) _sram2_start;
+        areasize = _sram2_end-_sram2_start;
+        break;
+    case ETH_PLACEMENT_USER:
+        area     = (uint8_t *) conf->area;
+        areasize = conf->areasize;
+        break;
+    default:
+        return ETH_ERROR_BUFFERCONFIG;
+    }
+    need = (conf->txcount+conf->rxcount)*sizeof(ETH_DMADescriptor)
+          +conf->txcount*conf->txsize
+          +conf->rxcount*conf->rxsize;
+    if( area == 0 || ((uint32_t) area&3) != 0 || areasize < need )
+        return ETH_ERROR_NOMEMORY;
+
+    ETH_BufferConf = *conf;
+    ETH_BufferConf.area     = area;
+    ETH_BufferConf.areasize = areasize;
+
+    ETH_TXDescriptors = (ETH_DMADescriptor *) area;
+    ETH_RXDescriptors = ETH_TXDescriptors+conf->txcount;
+    return ETH_OK;
+}
 
-void ETH_InitializeBuffers(char *area) {
-uint32_t *a = (uint32_t *) area;
-
-    ETH_InitTXDescriptors(ETH_TXDesc,ETH_TXBUFFER_COUNT,(uint8_t *) a);
-    a += ETH_TXBUFFERSIZE_INT32UNITS *ETH_TXBUFFER_COUNT;
-    ETH_InitRXDescriptors(ETH_RXDesc,ETH_RXBUFFER_COUNT,(uint8_t *) a);
+/**
+ * @brief   ETH_GetBufferConfig
+ *
+ * @note    Configuration used by ETH_Init, with the area actually used
+ */
+const ETH_BufferConfig *
+ETH_GetBufferConfig(void) {
 
+    return &ETH_BufferConf;
 }
-#endif
 
 /**
  * @brief   ConfigureMediaInterface
@@ -1660,7 +2875,7 @@ static void ConfigureMediaInterface(void) {
 uint32_t media = 1; // RMII PHY Interface
 
     // Enable SYSCFG clock to select the ethernet PHY interface to be used
-    RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;
+    ClkGate_Enable(CLKGATE_SYSCFG,0);
     __NOP();
     __NOP();
     __DSB();
@@ -1675,12 +2890,13 @@ uint32_t media = 1; // RMII PHY Interface
  *
  * @note    Initialize ETH controller
  * 
- * @note    When using dynamically allocated buffers, the must be
- *          registered before calling this function
+ * @note    conf gives the descriptors and buffers (ETH_BufferConfig). When it
+ *          is null, ETH_BUFFERS_DEFAULT is used. Returns ETH_OK or an
+ *          ETH_ERROR_* code, without touching the controller
  * 
  * @note    Initialization steps:
  * 
- *        * Setup buffers
+ *        * Check buffers
  *        * Configure pins for ETH usage
  *        * Configure clocks
  *        * Reset ETH interface
@@ -1690,18 +2906,34 @@ uint32_t media = 1; // RMII PHY Interface
  *        * Configure DMA
  */
 
-void ETH_Init(void) {
+int
+ETH_Init(const ETH_BufferConfig *conf) {
+uint8_t *area;
+int rc;
 
     MESSAGE("Entering ETH Init\n");
 
+    if( conf == 0 )
+        conf = &ETH_BUFFERS_DEFAULT;
+    rc = ETH_SetBuffers(conf);
+    if( rc < 0 )
+        return rc;
+
     // Reset callbacks
     ETH_Callbacks.ErrorDetected    = 0;
     ETH_Callbacks.FrameReceived    = 0;
     ETH_Callbacks.FrameTransmitted = 0;
     ETH_Callbacks.LinkStatusChanged= 0;
+    ETH_DroppedFrames              = 0;
+    memset(&ETH_Stats,0,sizeof(ETH_Stats));
+    ETH_RXIRQBase                  = ETH_RXIRQCount;
 
    // Enable clocks for ETH
+#ifdef ETH_USE_PTP
+    ETH_EnableClock(ETH_CLOCK_MAC|ETH_CLOCK_MACRX|ETH_CLOCK_MACTX|ETH_CLOCK_PTP);
+#else
     ETH_EnableClock(ETH_CLOCK_MAC|ETH_CLOCK_MACRX|ETH_CLOCK_MACTX);
+#endif
 
      // Configure Media Interface
     ConfigureMediaInterface();
@@ -1713,14 +2945,11 @@ void ETH_Init(void) {
     // Soft Reset of the ETH Controller
     ETH_Reset();
  
-#ifdef ETH_ALLOCATE_BUFFERS_DYNAMICALLY
-    if( buffers_initialized != (RXBUFFER_INITIALIZED|TXBUFFER_INITIALIZED ) {
-        while(1) {}
-    }
-#else
-    ETH_InitTXDescriptors(ETH_TXDesc,ETH_TXBUFFER_COUNT,txbuffer);
-    ETH_InitRXDescriptors(ETH_RXDesc,ETH_RXBUFFER_COUNT,rxbuffer);
-#endif
+    // Descriptors, then TX and RX buffers
+    area = (uint8_t *) (ETH_RXDescriptors+conf->rxcount);
+    ETH_InitTXDescriptors(ETH_TXDescriptors,conf->txcount,conf->txsize,area);
+    area += conf->txcount*conf->txsize;
+    ETH_InitRXDescriptors(ETH_RXDescriptors,conf->rxcount,conf->rxsize,area);
 
     // Configure SMI
     ETH_ConfigureSMI();
@@ -1737,14 +2966,32 @@ void ETH_Init(void) {
     // Configure MAC Address
     ETH_SetMACAddress(ETH_MACADDRESS);
 
+    // MMC counters are only read (ETH_GetStatistics). Their interrupts are
+    // masked, since they are enabled after reset
+    ETH->MMCRIMR = ETH_MMCRIMR_RGUFM|ETH_MMCRIMR_RFAEM|ETH_MMCRIMR_RFCEM;
+    ETH->MMCTIMR = ETH_MMCTIMR_TGFM|ETH_MMCTIMR_TGFMSCM|ETH_MMCTIMR_TGFSCM;
+
 #ifdef ETH_USE_ETH_IRQ
+    // Receive interrupt by the watchdog, since RX descriptors have DIC set
+    ETH->DMARSWTR = ETH_RXWATCHDOG;
+
     // Configuring interrupt
     ETH->DMAIER |= (ETH_DMAIER_NISE|ETH_DMAIER_RIE);
 
     NVIC_SetPriority(ETH_IRQn,ETH_IRQLevel);
     NVIC_EnableIRQ(ETH_IRQn);
 #endif
+
+#ifdef ETH_USE_PTP
+    ETH_PTPInit();
+#endif
+
+#ifdef ETH_USE_GPIO_INTERRUPT
+    // PHY interrupt for link changes (ETH_PHYProcess)
+    ConfigureEXTI2();
+#endif
     MESSAGE("Exiting ETH Init\n");
+    return ETH_OK;
 }
 
 
@@ -1798,34 +3045,47 @@ void ETH_Stop(void) {
 
 
 /**
- * @brief   ETH_ManualConfig
- * 
- * @note    Configure PHY using configuration in ETH_Config
+ * @brief   ETH_ConfigBCR
+ *
+ * @note    Value of BCR for the configuration in ETH_Config
  */
 
-static void
-ETH_ManualConfig(void) {
-uint16_t value;
+static uint16_t
+ETH_ConfigBCR(void) {
+uint16_t value = 0;
+
+    if( ETH_Config&ETH_CONFIG_AUTONEGOTIATE )
+        return ETH_PHY_BCR_AUTONEGOTIATIONENABLE;
 
-    MESSAGE("Entering manual configuration\n");
-    value = 0;
     if( ETH_Config&ETH_CONFIG_FULLDUPLEX ) {
         if ( ETH_Config&ETH_CONFIG_100BASET )  {
-            MESSAGE("100BASET FULL DUPLEX\n");
             value |= ETH_PHY_BCR_SPEED100MHz|ETH_PHY_BCR_FULLDUPLEX;
         } else if ( ETH_Config&ETH_CONFIG_10BASET ) {
-            MESSAGE("10BASET FULL DUPLEX\n");
             value |= ETH_PHY_BCR_FULLDUPLEX;
         }
     } else if( ETH_Config&ETH_CONFIG_HALFDUPLEX ) {
         if ( ETH_Config&ETH_CONFIG_100BASET )  {
-            MESSAGE("100BASET HALF DUPLEX\n");
             value |= ETH_PHY_BCR_SPEED100MHz;
-        } else if ( ETH_Config&ETH_CONFIG_10BASET ) {
-            MESSAGE("10BASET HALF DUPLEX\n");
-            value |= 0;
         }
     }
+    return value;
+}
+
+
+/**
+ * @brief   ETH_ManualConfig
+ * 
+ * @note    Configure PHY using configuration in ETH_Config
+ */
+
+static void
+ETH_ManualConfig(void) {
+uint16_t value;
+
+    MESSAGE("Entering manual configuration\n");
+    value = ETH_ConfigBCR();
+    MESSAGEV("%s %s\n",(value&ETH_PHY_BCR_SPEED100MHz)?"100BASET":"10BASET",
+                      (value&ETH_PHY_BCR_FULLDUPLEX)?"FULL DUPLEX":"HALF DUPLEX");
     // Write config
     ETH_WritePHYRegister(ETH_PHY_BCR,value);
     delay(ETH_DELAY_AFTERCONFIG);
@@ -1924,6 +3184,9 @@ volatile uint32_t v;
  * @brief   UpdateLinkStatus
  * 
  * @note    It must be called when there is a change in link status
+ *
+ * @note    It blocks until the link is up or the retries are exhausted.
+ *          ETH_PHYProcess does the same without waiting
  */
 int
 ETH_UpdateLinkStatus(void) {
@@ -2012,12 +3275,17 @@ end:
 /**
  * @brief   Transmit data already in DMA buffer 
  * 
- * @note    size must be smaller or equal to ETH_TXBUFFER_SIZE*ETH_MAX_PACKET_SIZE
+ * @note    size must be smaller or equal to txcount*txsize of ETH_BufferConfig
  * 
- * @note    It uses a default (non OSF) mode, i.e., only one frame beeing
- *          transmitted
+ * @note    desc is the first descriptor of the frame and must be ETH_TXCurrent,
+ *          where the data was copied. When it is null, ETH_TXCurrent is used
+ *
+ * @note    The descriptors are used as a ring. The frame is queued after the
+ *          ones already given to the DMA and the function returns without
+ *          waiting for the transmission. It returns -1 when it does not fit in
+ *          the free descriptors, i.e., the ring is full
  *
- * @note    Buffer can only be modified when there is no TX DMA operation running
+ * @note    A buffer can only be modified when its descriptor has OWN=0
  *
  * @note    Procedure to transmit a multiple buffer frame
  *
@@ -2092,29 +3360,37 @@ uint32_t v;
 int
 ETH_TransmitFrame(ETH_DMADescriptor *desc, unsigned size) {
 int nbuffers,lastbuffersize;
+ETH_DMADescriptor *first,*d;
+int i;
 
     MESSAGE("Entering ETH_TransmitFrame\n");
 
     if( size == 0 )
         return 0;
 
-    // Disable transmission (Temporary fix)
-    ETH_DisableTransmissionDMA();
-
-    ETH->DMASR = 0x0000E7FF; // clear all flags
-
-    desc = ETH_TXDescriptors;
-    // Check OWN bit in the first descriptor. If it is set, DMA is using it
-    if( (desc->Status&ETH_TXDESC0_OWN) != 0 ) {
-        return -1;      // BUSY!!!!!!
-    }
+    // Frames are always queued at the ring position
+    if( desc == 0 )
+        desc = ETH_TXCurrent;
+    first = desc;
 
-    nbuffers = size/ETH_TXBUFFER_SIZE;
-    lastbuffersize = size%ETH_TXBUFFER_SIZE;
+    nbuffers = size/ETH_BufferConf.txsize;
+    lastbuffersize = size%ETH_BufferConf.txsize;
     if( lastbuffersize != 0 ) nbuffers++;
+    else                      lastbuffersize = ETH_BufferConf.txsize;
+    if( nbuffers > ETH_BufferConf.txcount )
+        return -1;
 
     MESSAGEV("nbuffers=%d size=%d\n",nbuffers,size);
-        
+
+    // Check OWN bit in all descriptors of the frame. If one is set, the DMA is
+    // still sending an earlier frame, i.e., the ring is full
+    d = desc;
+    for(i=0;i<nbuffers;i++) {
+        if( (d->Status&ETH_TXDESC0_OWN) != 0 )
+            return -1;      // BUSY!!!!!!
+        d = (ETH_DMADescriptor *) (d->Buffer2NextDescAddr);
+    }
+
     if( nbuffers == 1 ) {
         // Configure first and only descriptor
         MESSAGE("Only one packet\n");
@@ -2127,18 +3403,18 @@ int nbuffers,lastbuffersize;
         // Configure first descriptor
         MESSAGE("First packet\n");
         desc->Status = (desc->Status&~ETH_TXDESC0_LAST)|ETH_TXDESC0_FIRST;
-        desc->ControlBufferSize = ETH_TXBUFFER_SIZE&ETH_TXDESC1_BUFFER1SIZE_MSK;
+        desc->ControlBufferSize = ETH_BufferConf.txsize&ETH_TXDESC1_BUFFER1SIZE_MSK;
         desc = (ETH_DMADescriptor *) (desc->Buffer2NextDescAddr);
         // Must be set after the others
         //desc->Status |= ETH_TXDESC0_OWN;
 
         // Configure intermediate descriptors
-        for(int i=1;i<nbuffers-1;i++) {
+        for(i=1;i<nbuffers-1;i++) {
             MESSAGE("Middle packet\n");
             desc->Status  &= ~(ETH_TXDESC0_FIRST|ETH_TXDESC0_LAST);
-            desc->ControlBufferSize = ETH_TXBUFFER_SIZE&ETH_TXDESC1_BUFFER1SIZE_MSK;
-            desc = (ETH_DMADescriptor *) (desc->Buffer2NextDescAddr);
+            desc->ControlBufferSize = ETH_BufferConf.txsize&ETH_TXDESC1_BUFFER1SIZE_MSK;
             desc->Status |= ETH_TXDESC0_OWN;
+            desc = (ETH_DMADescriptor *) (desc->Buffer2NextDescAddr);
         }
         // Configure last descriptor
         MESSAGE("Last packet\n");
@@ -2148,33 +3424,30 @@ int nbuffers,lastbuffersize;
 
         // Own bit of first descriptor must be set last
         __DSB();
-        ETH_TXDescriptors->Status |= ETH_TXDESC0_OWN;
+        first->Status |= ETH_TXDESC0_OWN;
         __DSB();
     }
 
-    MESSAGEV("Status=%08X\n",ETH_TXDescriptors->Status);
+    MESSAGEV("Status=%08X\n",first->Status);
+
+#ifdef ETH_USE_PTP
+    ETH_TXLast = desc;
+#endif
+
+    // Next frame goes after the last descriptor of this one
+    ETH_TXCurrent = (ETH_DMADescriptor *) (desc->Buffer2NextDescAddr);
+    ETH_Stats.txframes++;
+    ETH_Stats.txbytes += size;
 
-    // Check Transmit buffer status
+    // The DMA suspends when it reaches a descriptor owned by the CPU.
     // To resume processing transmit descriptors, the host should change
     // the ownership of the bit of the descriptor and then issue a Transmit
-    // Poll Demand command.
-    // Make all data in CPU to be written into memory
-    // Clear it and start transmission
-  
+    // Poll Demand command. It does not wait for the end of transmission, so
+    // the next frame can be queued while this one is being sent
     if( ETH->DMASR&ETH_DMASR_TBUS ) {
         ETH->DMASR = ETH_DMASR_TBUS;        // Clear
-        ETH->DMATPDR = 0;                   // Transmit poll demand
     }
-
-    ETH_EnableTransmissionDMA();
-
-    MESSAGE("Testing if transmitted\n");
-    int retries = 100;
-    do {
-        delay(10);
-        MESSAGE("+");
-    } while( (retries-->0) && ((ETH_TXDescriptors->Status&ETH_TXDESC0_OWN)!=0) );
-    MESSAGEV("%s\n",retries?"Done":"Failed");
+    ETH->DMATPDR = 0;                       // Transmit poll demand
 
     MESSAGE("Exiting ETH_TransmitFrame\n");
     return 0;
@@ -2182,6 +3455,103 @@ int nbuffers,lastbuffersize;
 
 
 
+/**
+ * @brief   ETH_TransmitBuffers
+ *
+ * @note    Queues a frame that is in n buffers (scatter-gather). Each buffer gets
+ *          its own descriptor pointing to the data, so nothing is copied into
+ *          the DMA buffers. Buffers in a cacheable area are cleaned here
+ *
+ * @note    The buffers can not be changed or freed until the DMA clears the OWN
+ *          bit of their descriptors
+ *
+ * @note    It changes the buffer addresses of the descriptors, so it can not be
+ *          used together with ETH_TransmitFrame
+ *
+ * @note    The size of each buffer must be smaller than 8192 bytes. Larger
+ *          ones (jumbo frames) must be split by the caller
+ *
+ * @note    Returns the index of the last descriptor of the frame or -1 when
+ *          there are not n free descriptors
+ */
+int
+ETH_TransmitBuffers(const ETH_Buffer *bufs, int n) {
+ETH_DMADescriptor *desc,*first,*last;
+uint32_t status;
+int i;
+
+    if( n <= 0 || n > ETH_BufferConf.txcount )
+        return -1;
+
+    desc = ETH_TXCurrent;
+    for(i=0;i<n;i++) {
+        if( (desc->Status&ETH_TXDESC0_OWN) != 0 )
+            return -1;      // BUSY!!!!!!
+        desc = (ETH_DMADescriptor *) (desc->Buffer2NextDescAddr);
+    }
+
+    first = last = desc = ETH_TXCurrent;
+    for(i=0;i<n;i++) {
+        Cache_CleanRange(bufs[i].data,bufs[i].size);
+        ETH_Stats.txbytes += bufs[i].size;
+        status = desc->Status&~(ETH_TXDESC0_FIRST|ETH_TXDESC0_LAST);
+        if( i == 0 )   status |= ETH_TXDESC0_FIRST;
+        if( i == n-1 ) status |= ETH_TXDESC0_LAST;
+        // Own bit of first descriptor must be set last
+        if( i != 0 )   status |= ETH_TXDESC0_OWN;
+        desc->Buffer1Addr = (uint32_t) bufs[i].data;
+        desc->ControlBufferSize = bufs[i].size&ETH_TXDESC1_BUFFER1SIZE_MSK;
+        __DSB();
+        desc->Status = status;
+        last = desc;
+        desc = (ETH_DMADescriptor *) (desc->Buffer2NextDescAddr);
+    }
+    __DSB();
+    first->Status |= ETH_TXDESC0_OWN;
+    __DSB();
+
+    ETH_TXCurrent = desc;
+    ETH_Stats.txframes++;
+#ifdef ETH_USE_PTP
+    ETH_TXLast = last;
+#endif
+
+    if( ETH->DMASR&ETH_DMASR_TBUS ) {
+        ETH->DMASR = ETH_DMASR_TBUS;        // Clear
+    }
+    ETH->DMATPDR = 0;                       // Transmit poll demand
+
+    return last-ETH_TXDescriptors;
+}
+
+/**
+ * @brief   ETH_GetChecksumError
+ *
+ * @note    Checksum errors detected by the receive checksum offload engine in
+ *          the last descriptor of a frame (ETH_CHECKSUMERROR_*)
+ */
+static inline uint32_t
+ETH_GetChecksumError(ETH_DMADescriptor *desc) {
+uint32_t err = 0;
+#if CHECKSUM_BY_HARDWARE
+uint32_t status = desc->Status;
+uint32_t ext;
+
+    if( status&ETH_RXDESC0_ESA ) {
+        ext = *(volatile uint32_t *) &desc->ExtendedStatus;
+        if( ext&ETH_RXDESC4_IPHE ) err |= ETH_CHECKSUMERROR_HEADER;
+        if( ext&ETH_RXDESC4_IPPE ) err |= ETH_CHECKSUMERROR_PAYLOAD;
+    }
+#ifndef ETH_USE_PTP
+    // With timestamping, this bit is TSV
+    else if( status&ETH_RXDESC0_IPHCE ) {
+        err |= ETH_CHECKSUMERROR_HEADER;
+    }
+#endif
+#endif
+    return err;
+}
+
 /**
  * @brief   Receive data
  *
@@ -2211,6 +3581,11 @@ int nbuffers,lastbuffersize;
  * 
  * @note    All buffers will use the maximum size, except the last one. One must 
  *          get the FL field to get the size of the data in the last buffer.
+ *
+ * @note    The search starts at ETH_RXCurrent, which is advanced past the frame
+ *          found. The caller must set the OWN bit of its descriptors when done,
+ *          so frames can be drained back-to-back while the DMA fills the rest
+ *          of the ring
  */
 
 int
@@ -2220,37 +3595,50 @@ int len;
 ETH_DMADescriptor *desc,*descfirst;
 uint32_t status;
 int first;
+int i;
 int rc = 0;
+int rejected = 0;
+int consumed;
+
+    PROFILE_BEGIN(ETH_ReceiveFrame);
+
+restart:
+    rc = 0;
 
     // Clean RxFrameInfo
     RxFrameInfo->SegmentCount = 0;
     RxFrameInfo->FirstSegmentDesc = 0;
     RxFrameInfo->LastSegmentDesc = 0;
     RxFrameInfo->FrameLength = 0;
+    RxFrameInfo->ChecksumError = 0;
+    RxFrameInfo->TimeStampValid = 0;
 
     MESSAGE("Entering ETH_ReceiveFrame\n");
 
-    PrintDMAStatus(2);
+    if( verbose ) PrintDMAStatus(2);
 
-
-    ETH_EnableReceptionDMA();
-
-    // Searching for First segment
-    desc = ETH_RXDescriptors;/*  */
-    status = desc->Status;
+    // Searching for First segment, starting at the ring position. Segments
+    // of a frame whose first one was lost are given back to the DMA
+    desc = ETH_RXCurrent;
     first = 0;
-    do {
+    for(i=0;i<ETH_BufferConf.rxcount;i++) {
+        status = desc->Status;
         uint32_t x = (status&ETH_RXDESC0_OWN)?1:0;
         message("Processing descriptor at %p (own=%d). ",desc,x);
-        first = ((status&ETH_RXDESC0_OWN)==0)&&((status&ETH_RXDESC0_FIRST)!=0);
+        if( (status&ETH_RXDESC0_OWN) != 0 ) {
+            // DMA has not filled it yet
+            break;
+        }
+        first = (status&ETH_RXDESC0_FIRST)!=0;
         if( first ) {
             // found a first segment
             break;
         }
+        desc->Status = ETH_RXDESC0_OWN;
         desc = (ETH_DMADescriptor *) desc->Buffer2NextDescAddr;
+        ETH_RXCurrent = desc;
         message("Next is %p\n",desc);
-        status = desc->Status;
-    } while ( desc != ETH_RXDescriptors );
+    }
 
 
     if( !first ) {
@@ -2274,6 +3662,7 @@ int rc = 0;
             RxFrameInfo->LastSegmentDesc  = desc;
             RxFrameInfo->SegmentCount = 1;
             RxFrameInfo->FrameLength = (len-4);      // exclude CRC
+            RxFrameInfo->ChecksumError = ETH_GetChecksumError(desc);
             rc = 1;
             break;
         } else if ( status&ETH_RXDESC0_FIRST ) {
@@ -2285,10 +3674,11 @@ int rc = 0;
             RxFrameInfo->FrameLength = (len-4);
         } else if ( status&ETH_RXDESC0_LAST )  {
             MESSAGE("Received last frame\n");
-            // last buffer
+            // last buffer. Its length field is the length of the whole frame
             RxFrameInfo->LastSegmentDesc  = desc;
             RxFrameInfo->SegmentCount++;
-            RxFrameInfo->FrameLength+= (len-4);     // exclude CRC
+            RxFrameInfo->FrameLength = (len-4);     // exclude CRC
+            RxFrameInfo->ChecksumError = ETH_GetChecksumError(desc);
             rc = 1;
             break;
         } else {
@@ -2305,6 +3695,53 @@ int rc = 0;
         status = desc->Status;
     }
 
+    if( rc == 1 ) {
+        // The next frame starts after the last segment. The caller gives the
+        // descriptors of this frame back to the DMA after copying the data
+        ETH_RXCurrent = (ETH_DMADescriptor *) desc->Buffer2NextDescAddr;
+        consumed = ETH_VLANReject(RxFrameInfo);
+        if( consumed )
+            ETH_Stats.rxvlandropped++;
+        else
+            consumed = ETH_RawInput(RxFrameInfo);
+        if( consumed ) {
+            // Other VLAN or raw frame already handled: the descriptors go back
+            // to the DMA, try the next frame
+            desc = RxFrameInfo->FirstSegmentDesc;
+            for(i=0;i<RxFrameInfo->SegmentCount;i++) {
+                desc->Status = ETH_RXDESC0_OWN;
+                desc = (ETH_DMADescriptor *) desc->Buffer2NextDescAddr;
+            }
+            ETH_ResumeReception();
+            // Bounded, so a flood of these frames does not hold the caller
+            if( ++rejected < ETH_BufferConf.rxcount )
+                goto restart;
+            RxFrameInfo->SegmentCount = 0;
+            RxFrameInfo->FirstSegmentDesc = 0;
+            RxFrameInfo->LastSegmentDesc = 0;
+            RxFrameInfo->FrameLength = 0;
+            rc = 0;
+            goto err;
+        }
+        ETH_Stats.rxframes++;
+        ETH_Stats.rxbytes += RxFrameInfo->FrameLength;
+        if( RxFrameInfo->ChecksumError )
+            ETH_Stats.rxchecksumerrors++;
+#ifdef ETH_USE_PTP
+        // The timestamp is in the last descriptor
+        if( desc->Status&ETH_RXDESC0_TSV ) {
+            RxFrameInfo->TimeStamp.seconds     = desc->TimeStampHigh;
+            RxFrameInfo->TimeStamp.nanoseconds = desc->TimeStampLow;
+            RxFrameInfo->TimeStampValid = 1;
+        }
+#endif
+    } else {
+        // Last segment not received yet. Try again later
+        RxFrameInfo->SegmentCount = 0;
+        RxFrameInfo->FirstSegmentDesc = 0;
+        RxFrameInfo->FrameLength = 0;
+    }
+
 err:
     ETH_EnableReceptionDMA();
 
@@ -2322,10 +3759,29 @@ err:
     }
     MESSAGE("Exiting ETH_ReceiveFrame\n");
 
+    PROFILE_END(ETH_ReceiveFrame);
     return rc;
 }
 
 
+/**
+ * @brief   ETH_SetRXBuffer
+ *
+ * @note    Gives a RX descriptor back to the DMA with another buffer. Used when
+ *          the buffer of a received frame is passed up without a copy
+ *
+ * @note    buffer must have rxsize bytes (ETH_BufferConfig), be aligned to a word and be
+ *          in a non cacheable area
+ */
+void
+ETH_SetRXBuffer(ETH_DMADescriptor *desc, uint8_t *buffer) {
+
+    desc->Buffer1Addr = (uint32_t) buffer;
+    __DSB();
+    desc->Status = ETH_RXDESC0_OWN;
+    __DSB();
+}
+
 /**
  * @brief   Check if a frame has been received
  *
@@ -2337,7 +3793,7 @@ ETH_CheckReception(void) {
 ETH_DMADescriptor *desc;
 uint32_t SegmentCount = 0;
 
-    desc = ETH_RXDescriptors;
+    desc = ETH_RXCurrent;
 
     SegmentCount = 0;
     while(desc) {
@@ -2362,7 +3818,7 @@ uint32_t SegmentCount = 0;
         }
         desc = (ETH_DMADescriptor *) desc->Buffer2NextDescAddr;
         // Test if it returned to the start
-        if( desc == ETH_RXDescriptors )
+        if( desc == ETH_RXCurrent )
             break;
     }
     return 0;
@@ -2522,10 +3978,9 @@ uint16_t value;
 
 char const *
 ETH_GetLinkInfoString(void) {
-uint16_t value;
 
-    value = ETH_GetLinkInfo();
-    return linkinfo[value];
+    // Found by ETH_PHYProcess, so the PHY is not accessed
+    return linkinfo[ETH_LinkInfo];
 }
 
 
@@ -10,14 +10,6 @@
 #include "stm32f746xx.h"
 #include "system_stm32f746.h"
 
-/**
- * @brief By setting this symbol, no buffer is statically allocated.
- *        The buffers must be allocated and then setting using
- *        ETH_SetBuffers (TBD!)
- * 
- */
-
-//#define ETH_ALLOCATE_BUFFERS_DYNAMICALLY  (1)
 /*
  * @brief  Compilation flag
  *
@@ -63,6 +55,17 @@ typedef struct {
  */
 #define ETH_DMADESCRIPTOR_STATUS_OWN        (1<<31)
 
+/**
+ * @brief   IEEE 1588 (PTP) time
+ *
+ * @note    The sub second field counts nanoseconds (digital rollover), so it is
+ *          always less than 10^9
+ */
+typedef struct {
+    uint32_t            seconds;
+    uint32_t            nanoseconds;
+} ETH_PTPTime;
+
 /**
   * @brief  Received Frame Information structure definition
    *
@@ -75,9 +78,121 @@ typedef struct {
     ETH_DMADescriptor  *LastSegmentDesc;    /*!< Last Segment Rx Desc */
     uint32_t            SegmentCount;       /*!< Segment count */
     uint32_t            FrameLength;        /*!< Frame length */
+    uint32_t            ChecksumError;      /*!< ETH_CHECKSUMERROR_* */
+    uint32_t            TimeStampValid;     /*!< TimeStamp was captured (ETH_USE_PTP) */
+    ETH_PTPTime         TimeStamp;          /*!< Reception time */
 //    uint32_t            buffer;           /*!< Frame buffer */
 } ETH_DMAFrameInfo;
 
+/**
+ * @brief   Buffer of a frame for ETH_TransmitBuffers (scatter-gather)
+ */
+typedef struct {
+    const void         *data;
+    unsigned            size;
+} ETH_Buffer;
+
+/**
+ * @brief   Checksum offload
+ *
+ * @note    When CHECKSUM_BY_HARDWARE is 1, the MAC inserts the IP, UDP, TCP and
+ *          ICMP checksums (CIC in TX descriptors) and checks them on reception
+ *          (IPCO). Errors are reported in ETH_DMAFrameInfo.ChecksumError. The
+ *          same symbol selects the software checksums in lwipopts.h
+ */
+///@{
+#ifndef CHECKSUM_BY_HARDWARE
+    #define CHECKSUM_BY_HARDWARE    1
+#endif
+#define ETH_CHECKSUMERROR_HEADER    (1)     /*!< IPv4 header checksum */
+#define ETH_CHECKSUMERROR_PAYLOAD   (2)     /*!< TCP, UDP or ICMP checksum */
+///@}
+
+/**
+ * @brief   Driver statistics (ETH_GetStatistics)
+ */
+typedef struct {
+    uint32_t            rxframes;           /*!< Frames received */
+    uint32_t            rxbytes;            /*!< Bytes received (without CRC) */
+    uint32_t            txframes;           /*!< Frames queued for transmission */
+    uint32_t            txbytes;            /*!< Bytes queued for transmission */
+    uint32_t            rxirqs;             /*!< Receive interrupts */
+    uint32_t            rxbufferunavailable;/*!< DMA suspended without descriptors (RBUS) */
+    uint32_t            rxoverflow;         /*!< Frames dropped by the DMA (DMAMFBOCR) */
+    uint32_t            rxchecksumerrors;   /*!< Frames with ETH_CHECKSUMERROR_* */
+    uint32_t            rxcrcerrors;        /*!< Frames with CRC error (MMC) */
+    uint32_t            rxalignerrors;      /*!< Frames with alignment error (MMC) */
+    uint32_t            rxvlandropped;      /*!< Frames of other VLANs (ETH_SetVLANFilter) */
+    uint32_t            rxrawframes;        /*!< Frames passed to the raw handler */
+} ETH_Statistics;
+
+/**
+ * @brief   VLAN filter (ETH_SetVLANFilter)
+ *
+ * @note    MACVLANTR is set with the VLAN id (12 bit comparison), so the MAC
+ *          accepts tagged frames up to 1522 bytes and marks the matching ones.
+ *          The MAC of the STM32F746 has no VLAN filter in the frame filter
+ *          (MACFFR), so ETH_ReceiveFrame gives the frames of other VLANs back
+ *          to the DMA, before any copy or pbuf, and counts them in rxvlandropped
+ *
+ * @note    There is no tag insertion in the transmitter. lwIP inserts the tag
+ *          (LWIP_HOOK_VLAN_SET in lwipopts.h)
+ */
+///@{
+#define ETH_VLAN_ACCEPTUNTAGGED     (1)     /*!< Untagged frames are received too */
+///@}
+
+/**
+ * @brief   Raw frames (ETH_SetRawHandler, ETH_RawAlloc and ETH_RawSend)
+ *
+ * @note    Received frames with the EtherType given to ETH_SetRawHandler (after
+ *          the VLAN tag, if there is one) are passed by ETH_ReceiveFrame to the
+ *          handler and never reach lwIP. The segments point to the DMA buffers,
+ *          starting at the destination address, and are valid only until the
+ *          handler returns. It runs in the context that calls ETH_ReceiveFrame
+ *          (stnetif_input)
+ *
+ * @note    ETH_RawAlloc returns the payload area of the next TX DMA buffer, so
+ *          the data is written in place, and ETH_RawSend fills the header and
+ *          queues it (ETH_TransmitFrame). The frame must fit in one TX buffer
+ *          and is sent without a VLAN tag. They must be called in the lwIP
+ *          context and can not be used with ETH_ZEROCOPY_TX, that changes the
+ *          TX buffers
+ */
+///@{
+#define ETH_RAW_HEADER              (14)    /*!< Destination, source and EtherType */
+
+typedef void (*ETH_RawHandler)(const ETH_Buffer *segs, int n, const ETH_DMAFrameInfo *info);
+///@}
+
+/**
+ * @brief   Loopback self test (ETH_SelfTest)
+ *
+ * @note    The MAC loops the frames back internally (LM in MACCR), so the TX
+ *          and RX rings, the DMA and the driver are measured without the PHY
+ *          and the cable. Frames go to the own address, with EtherType
+ *          ETH_SELFTEST_TYPE, a sequence number and a pattern made from it
+ *
+ * @note    cyclesperframe counts only the cycles in ETH_TransmitFrame,
+ *          ETH_ReceiveFrame and the return of the RX descriptors, not the
+ *          filling and checking of the frames nor the waiting
+ */
+///@{
+#define ETH_SELFTEST_TYPE           (0x88B5)/*!< Local experimental EtherType */
+#define ETH_SELFTEST_MINSIZE        (60)    /*!< Without CRC */
+
+typedef struct {
+    uint32_t            sent;               /*!< Frames queued */
+    uint32_t            received;           /*!< Frames received with the right content */
+    uint32_t            errors;             /*!< Frames received with a wrong length or content */
+    uint32_t            lost;               /*!< Frames sent but not received */
+    uint32_t            cycles;             /*!< From the first frame sent to the last received */
+    uint32_t            framespersecond;
+    uint32_t            bytespersecond;     /*!< Without preamble, CRC and gap */
+    uint32_t            cyclesperframe;     /*!< CPU cycles in the driver */
+} ETH_SelfTestResult;
+///@}
+
 /**
  * @brief   Received Frame Info
  * 
@@ -96,14 +211,55 @@ extern ETH_DMAFrameInfo  ETH_RXFrameInfo;
 #define ETH_MIN_ETH_PAYLOAD         (46)    /*!< Minimum Ethernet payload size */
 #define ETH_MAX_ETH_PAYLOAD         (1500)  /*!< Maximum Ethernet payload size */
 #define ETH_JUMBO_FRAME_PAYLOAD     (9000)  /*!< Jumbo frame payload size */
+#define ETH_MAX_JUMBO_PACKET_SIZE   (9024)  /*!< HEADER+EXTRA+VLAN+JUMBO_PAYLOAD+CRC */
 ///@}
 
+/**
+ * @brief   Jumbo frames (ETH_JUMBO)
+ *
+ * @note    When ETH_JUMBO is defined, the MTU is ETH_JUMBO_FRAME_PAYLOAD. The
+ *          MAC has no jumbo enable bit: the receive watchdog and the transmit
+ *          jabber timer, which cut frames at 2048 bytes, are disabled (WD and JD
+ *          in MACCR), so frames up to 16384 bytes pass
+ *
+ * @note    A jumbo frame does not fit the 2 KB FIFOs, so both DMA directions
+ *          work in threshold (cut-through) mode and the checksum offload, which
+ *          needs the whole frame in the TX FIFO, can not be used
+ *          (CHECKSUM_BY_HARDWARE=0)
+ *
+ * @note    The buffers stay small and a frame spans several descriptors (5 for
+ *          a 9018 bytes frame). There are more descriptors, so two jumbo frames
+ *          fit in each ring
+ */
+#ifdef ETH_JUMBO
+#if CHECKSUM_BY_HARDWARE
+#error "ETH_JUMBO needs CHECKSUM_BY_HARDWARE=0"
+#endif
+#endif
+
 /// Maximum transmission unit
+#ifdef ETH_JUMBO
+#define ETH_MTU                     ETH_JUMBO_FRAME_PAYLOAD
+#else
 #define ETH_MTU                     ETH_MAX_ETH_PAYLOAD
+#endif
 /**
  * @brief TX and RX BUFFER size and quantity
+ *
+ * @note    The size of a buffer must be a multiple of 4 and smaller than 8192
+ *          (13 bits field of the descriptor)
  */
 ///@{
+#ifdef ETH_JUMBO
+#ifndef ETH_TXBUFFER_COUNT
+    #define ETH_TXBUFFER_COUNT      (10)
+#endif
+#ifndef ETH_RXBUFFER_COUNT
+    #define ETH_RXBUFFER_COUNT      (10)
+#endif
+#define ETH_TXBUFFER_SIZE           (2048)
+#define ETH_RXBUFFER_SIZE           (2048)
+#else
 #ifndef ETH_TXBUFFER_COUNT
     #define ETH_TXBUFFER_COUNT      (4)
 #endif
@@ -112,14 +268,102 @@ extern ETH_DMAFrameInfo  ETH_RXFrameInfo;
 #endif
 #define ETH_TXBUFFER_SIZE           ETH_MAX_PACKET_SIZE
 #define ETH_RXBUFFER_SIZE           ETH_MAX_PACKET_SIZE
+#endif
+///@}
+
+/**
+ * @brief   Buffers and descriptors (ETH_Init)
+ *
+ * @note    The number of descriptors, the size of their buffers and where they
+ *          are placed are given to ETH_Init. A frame spans as many buffers as
+ *          needed, so small buffers waste less memory with small frames and
+ *          more descriptors absorb longer bursts. The buffers of one direction
+ *          must hold a frame of ETH_MTU bytes
+ *
+ * @note    The descriptors are put at the start of the area, followed by the TX
+ *          and the RX buffers. The area must not be cached (the DMA does not see
+ *          the cache):
+ *          * ETH_PLACEMENT_SDRAM uses a pool of ETH_POOL_SIZE bytes in the non
+ *            cacheable area of the SDRAM (.nocache)
+ *          * ETH_PLACEMENT_SRAM2 uses the 16 KB of SRAM2 (.sram2), set as non
+ *            cacheable by Cache_Init. It is not slowed by the SDRAM refresh
+ *            and by the LCD, but it is small
+ *          * ETH_PLACEMENT_USER uses area, which must be word aligned and
+ *            non cacheable
+ *
+ * @note    ETH_BUFFERS_DEFAULT uses ETH_TXBUFFER_COUNT and ETH_TXBUFFER_SIZE
+ *          (and RX) in the SDRAM. ETH_BUFFERS_SMALL has 16 TX and 32 RX
+ *          buffers of 256 bytes in SRAM2, for many small frames
+ */
+///@{
+typedef struct {
+    uint16_t            txcount;            /*!< TX descriptors (and buffers) */
+    uint16_t            rxcount;            /*!< RX descriptors (and buffers) */
+    uint16_t            txsize;             /*!< Bytes in a TX buffer (multiple of 4) */
+    uint16_t            rxsize;             /*!< Bytes in a RX buffer (multiple of 4) */
+    uint8_t             placement;          /*!< ETH_PLACEMENT_* */
+    void               *area;               /*!< Area for ETH_PLACEMENT_USER */
+    uint32_t            areasize;           /*!< Size of area in bytes */
+} ETH_BufferConfig;
+
+#define ETH_PLACEMENT_SDRAM         (0)     /*!< Pool in the .nocache section */
+#define ETH_PLACEMENT_SRAM2         (1)     /*!< SRAM2 (.sram2 section) */
+#define ETH_PLACEMENT_USER          (2)     /*!< Area given in ETH_BufferConfig */
+
+#define ETH_MIN_BUFFER_SIZE         (64)
+#define ETH_MAX_BUFFER_SIZE         (8188)  /*!< 13 bits field, multiple of 4 */
+#define ETH_MAX_BUFFER_COUNT        (64)    /*!< Descriptors in a ring */
+
+#ifndef ETH_POOL_SIZE
+#ifdef ETH_JUMBO
+    #define ETH_POOL_SIZE           (48*1024)
+#else
+    #define ETH_POOL_SIZE           (24*1024)
+#endif
+#endif
+
+extern const ETH_BufferConfig ETH_BUFFERS_DEFAULT;
+extern const ETH_BufferConfig ETH_BUFFERS_SMALL;
+///@}
+
+/**
+ * @brief   Return values of ETH_Init and ETH_SelfTest
+ */
+///@{
+#define ETH_OK                      (0)
+#define ETH_ERROR_BUFFERCONFIG      (-1)    /*!< Invalid count or size */
+#define ETH_ERROR_NOMEMORY          (-2)    /*!< Area too small or missing */
+#define ETH_ERROR_PARAMETER         (-3)    /*!< ETH_SelfTest: invalid size */
+#define ETH_ERROR_SELFTEST          (-4)    /*!< ETH_SelfTest: frames lost or wrong */
 ///@}
 
 
 
+/**
+ * @brief   Receive watchdog (DMARSWTR) in units of 256 HCLK cycles
+ *
+ * @note    Delay from a received frame to the RX interrupt, when
+ *          ETH_USE_ETH_IRQ is defined. 50 is 64 us at 200 MHz. Frames arriving
+ *          meanwhile get the same interrupt
+ */
+#ifndef ETH_RXWATCHDOG
+    #define ETH_RXWATCHDOG          (50)
+#endif
+
+/**
+ * @brief   Nanoseconds added to the PTP time at each update (ETH_USE_PTP)
+ *
+ * @note    The PTP clock is 10^9/ETH_PTP_INCREMENT Hz (50 MHz). It must be lower
+ *          than HCLK, the difference is the range of the frequency correction
+ */
+#ifndef ETH_PTP_INCREMENT
+    #define ETH_PTP_INCREMENT       (20)
+#endif
+
 /**
  * lwIP examples requires this definition
  */
-#define ETHERNET_MTU   ETH_MAX_ETH_PAYLOAD
+#define ETHERNET_MTU   ETH_MTU
 /**
  * @brief   RX and TX descriptors
  */
@@ -128,6 +372,17 @@ extern ETH_DMADescriptor *ETH_TXDescriptors;
 extern ETH_DMADescriptor *ETH_RXDescriptors;
 ///@}
 
+/**
+ * @brief   Ring positions
+ *
+ * @note    ETH_TXCurrent is where the next frame to be transmitted must be
+ *          copied. ETH_RXCurrent is where the next received frame starts
+ */
+///@{
+extern ETH_DMADescriptor *ETH_TXCurrent;
+extern ETH_DMADescriptor *ETH_RXCurrent;
+///@}
+
 /**
  * @brief Pointer to callback functions
  */
@@ -150,6 +405,24 @@ extern struct ETH_Callbacks_s ETH_Callbacks;
 #define ETH_CALLBACK_FRAMETRANSMITTED           2
 #define ETH_CALLBACK_ERRORDETECTED              3
 #define ETH_CALLBACK_LINKSTATUSCHANGED          4
+
+/**
+ * @brief   Return values of ETH_PHYProcess
+ */
+///@{
+#define ETH_PHY_IDLE                            0
+#define ETH_PHY_CHANGED                         1
+#define ETH_PHY_BUSY                            2
+///@}
+
+/**
+ * @brief   PHY events (ISFR of LAN8742) returned by ETH_GetPHYEvents
+ */
+///@{
+#define ETH_PHY_EVENT_LINKDOWN                  (0x0010)
+#define ETH_PHY_EVENT_AUTONEGOTIATIONDONE       (0x0040)
+#define ETH_PHY_EVENT_ENERGYON                  (0x0080)
+///@}
 ///@}
 
 /**
@@ -173,16 +446,29 @@ extern struct ETH_Callbacks_s ETH_Callbacks;
 #define ETH_LINKINFO_10BASET_HALFDUPLEX         0x16
 
 // Initialization functions
-void ETH_Init(void);
-#ifdef ETH_ALLOCATE_BUFFERS_DYNAMICALLY
-void ETH_InitTXDescriptors(ETH_DMADescriptor *desc, int count, uint8_t *area);
-void ETH_InitRXDescriptors(ETH_DMADescriptor *desc, int count, uint8_t *area);
-#endif
+int  ETH_Init(const ETH_BufferConfig *conf);
+const ETH_BufferConfig *ETH_GetBufferConfig(void);
 
 // Operation function
 int  ETH_TransmitFrame(ETH_DMADescriptor *desc, unsigned size);
+int  ETH_TransmitBuffers(const ETH_Buffer *bufs, int n);
 int  ETH_ReceiveFrame(ETH_DMAFrameInfo *RxFrameInfo);
 int  ETH_CheckReception(void);
+void ETH_SetRXBuffer(ETH_DMADescriptor *desc, uint8_t *buffer);
+#ifdef ETH_USE_ETH_IRQ
+int  ETH_IsRXPending(void);
+void ETH_ClearRXPending(void);
+#endif
+
+// IEEE 1588 (PTP) functions
+#ifdef ETH_USE_PTP
+void ETH_PTPInit(void);
+void ETH_PTPGetTime(ETH_PTPTime *t);
+void ETH_PTPSetTime(const ETH_PTPTime *t);
+void ETH_PTPAdjustTime(int32_t seconds, int32_t nanoseconds);
+void ETH_PTPAdjustFrequency(int32_t ppb);
+int  ETH_GetLastTXTimeStamp(ETH_PTPTime *t);
+#endif
 
 // Control functions (Enable/Disable)
 void ETH_Start(void);
@@ -200,10 +486,44 @@ void ETH_GetMACAddress(uint8_t macaddr[6]);
 void ETH_GetMACAddressAsVector(uint8_t macaddr[6]);
 void ETH_GetMACAddressAsNetworkOrderedVector(uint8_t macaddr[6]);
 
+// Multicast filtering (addresses in network order)
+unsigned ETH_HashIndex(const uint8_t macaddr[6]);
+int  ETH_AddMulticastAddress(const uint8_t macaddr[6]);
+void ETH_RemoveMulticastAddress(const uint8_t macaddr[6]);
+unsigned ETH_GetDroppedFrames(void);
+int  ETH_SetVLANFilter(uint16_t vid, unsigned flags);
+uint16_t ETH_GetVLANFilter(void);
+
+// Raw frames of one EtherType, bypassing lwIP
+int  ETH_SetRawHandler(uint16_t ethertype, ETH_RawHandler handler);
+uint8_t *ETH_RawAlloc(unsigned size);
+int  ETH_RawSend(const uint8_t dst[6], unsigned size);
+
+// Loopback self test of the driver
+int  ETH_SelfTest(unsigned frames, unsigned size, ETH_SelfTestResult *res);
+
+// Statistics
+void ETH_GetStatistics(ETH_Statistics *st);
+void ETH_ResetStatistics(void);
+int  ETH_ResumeReception(void);
+extern volatile uint32_t ETH_RXIRQTime;
+extern volatile uint32_t ETH_RXIRQCount;
+
 // Link status function
 int  ETH_IsLinkUp(void);
 int  ETH_IsConnected(void);
 
+// Link management by PHY events (non blocking)
+void ETH_PHYRequestUpdate(void);
+int  ETH_PHYProcess(void);
+int  ETH_GetLinkState(void);
+int  ETH_GetLinkMode(void);
+uint16_t ETH_GetPHYEvents(void);
+
+// Warm start (PHY configuration kept across a reset of the MCU)
+void ETH_SetWarmStart(int linkinfo);
+int  ETH_IsWarmStart(void);
+
 // Reconfigure Link 
 int  ETH_UpdateLinkStatus(void);
 unsigned ETH_GetLinkStatus(void);
@@ -0,0 +1,68 @@
+#ifndef EVENT_H
+#define EVENT_H
+/**
+ * @file    event.h
+ *
+ * @note    Event loop: interrupt routines post events, the main loop runs
+ *          their handlers and sleeps (WFI) when there is nothing to do
+ *
+ * @note    An event is a handler and an argument. Event_Post can be called
+ *          from any interrupt priority and from the main loop. It does not
+ *          disable the interrupts: the slot is reserved with LDREX/STREX on the
+ *          head counter and marked as ready by its sequence number after it is
+ *          written (mpscq.c). Event_Dispatch (main loop only) runs the
+ *          handlers in the order of the reservation
+ *
+ * @note    Timers are in swtimer.c (their callbacks run as events)
+ *
+ * @note    Handlers run to completion and must not call Event_Dispatch or
+ *          Event_Loop
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Number of events in the queue (power of 2)
+ */
+#ifndef EVENT_QUEUESIZE
+#define EVENT_QUEUESIZE                 32
+#endif
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define EVENT_OK                        0
+#define EVENT_ERROR_FULL                -1
+///@}
+
+/**
+ * @brief   Handler of an event
+ */
+typedef void (*Event_Handler)(uint32_t arg);
+
+/**
+ * @brief   Statistics
+ */
+typedef struct {
+    uint32_t    posted;
+    uint32_t    dispatched;
+    uint32_t    overflows;                  ///< Event_Post with the queue full
+    uint32_t    maxdepth;                   ///< events waiting at a dispatch
+    uint32_t    sleeps;                     ///< WFI executed
+    uint32_t    sleepcycles;                ///< DWT->CYCCNT in WFI (when enabled)
+} Event_Statistics;
+
+void Event_Init(void);
+int  Event_Post(Event_Handler handler, uint32_t arg);
+int  Event_Pending(void);
+int  Event_Dispatch(void);
+void Event_Sleep(void);
+void Event_Loop(void);
+
+void Event_GetStatistics(Event_Statistics *s);
+
+#endif // EVENT_H
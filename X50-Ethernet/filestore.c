@@ -0,0 +1,304 @@
+/**
+ * @file    filestore.c
+ *
+ * @note    Flat file store for the TFTP server
+ *
+ * @note    The directory is in SRAM and each file has a slot in SDRAM. A file
+ *          being written takes a free slot, so a transfer that fails leaves the
+ *          old file unchanged. Therefore one slot must be free to replace a file
+ *
+ * @note    There is no MicroSD or QSPI driver in this project yet. The medium
+ *          is accessed only by filestore_readmedium and filestore_writemedium
+ *          (byte offsets in the slot), which are the place to call one
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "crc.h"
+#include "filestore.h"
+
+/**
+ * @brief   Maximal number of open files
+ */
+#define FILESTORE_MAXOPEN           2
+
+/**
+ * @brief   Slot states
+ */
+///@{
+#define FILESTORE_FREE              0
+#define FILESTORE_VALID             1
+#define FILESTORE_WRITING           2
+///@}
+
+/**
+ * @brief   Directory and open files
+ */
+///@{
+typedef struct {
+    char        name[FILESTORE_NAMESIZE];
+    uint32_t    size;
+    uint32_t    crc;                        // CRC-32 (zlib) of a valid file
+    int         state;
+} FileStore_Entry;
+
+struct FileStore_File_s {
+    int         slot;                       // -1 when not used
+    int         mode;
+    uint32_t    pos;
+};
+
+static FileStore_Entry  dir[FILESTORE_MAXFILES];
+static FileStore_File   files[FILESTORE_MAXOPEN];
+///@}
+
+/**
+ * @brief   Medium (SDRAM, lost at reset)
+ */
+static uint8_t slots[FILESTORE_MAXFILES][FILESTORE_SLOTSIZE]
+                                    __attribute__((section(".sdram.filestore")));
+
+/**
+ * @brief   filestore_readmedium
+ */
+static int
+filestore_readmedium(int slot, uint32_t off, void *buf, int len) {
+
+    memcpy(buf,&slots[slot][off],len);
+    return len;
+}
+
+/**
+ * @brief   filestore_writemedium
+ */
+static int
+filestore_writemedium(int slot, uint32_t off, const void *buf, int len) {
+
+    memcpy(&slots[slot][off],buf,len);
+    return len;
+}
+
+/**
+ * @brief   filestore_crcmedium
+ *
+ * @note    CRC-32 of the first n bytes of a slot. The whole slot is given to
+ *          the CRC unit, so a large file is fed by DMA
+ */
+static uint32_t
+filestore_crcmedium(int slot, uint32_t n) {
+
+    return CRC32_Update(0,&slots[slot][0],n);
+}
+
+/**
+ * @brief   filestore_find
+ *
+ * @note    Returns the slot of the valid file name or -1
+ */
+static int
+filestore_find(const char *name) {
+int i;
+
+    for(i=0;i<FILESTORE_MAXFILES;i++) {
+        if( dir[i].state == FILESTORE_VALID && strcmp(dir[i].name,name) == 0 )
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief   FileStore_Init
+ *
+ * @note    Clears the store. Returns 0
+ */
+int
+FileStore_Init(void) {
+int i;
+
+    for(i=0;i<FILESTORE_MAXFILES;i++)
+        dir[i].state = FILESTORE_FREE;
+    for(i=0;i<FILESTORE_MAXOPEN;i++)
+        files[i].slot = -1;
+    return 0;
+}
+
+/**
+ * @brief   FileStore_Open
+ *
+ * @note    Returns null when the file does not exist (FILESTORE_READ), when
+ *          there is no free slot (FILESTORE_WRITE) or too many files are open
+ */
+FileStore_File *
+FileStore_Open(const char *name, int mode) {
+FileStore_File *f = 0;
+int i,slot = -1;
+
+    if( strlen(name) >= FILESTORE_NAMESIZE )
+        return 0;
+    for(i=0;i<FILESTORE_MAXOPEN;i++) {
+        if( files[i].slot < 0 ) {
+            f = &files[i];
+            break;
+        }
+    }
+    if( f == 0 )
+        return 0;
+
+    if( mode == FILESTORE_WRITE ) {
+        for(i=0;i<FILESTORE_MAXFILES;i++) {
+            if( dir[i].state == FILESTORE_FREE ) {
+                slot = i;
+                break;
+            }
+        }
+        if( slot < 0 )
+            return 0;
+        strcpy(dir[slot].name,name);
+        dir[slot].size  = 0;
+        dir[slot].state = FILESTORE_WRITING;
+    } else {
+        slot = filestore_find(name);
+        if( slot < 0 )
+            return 0;
+    }
+    f->slot = slot;
+    f->mode = mode;
+    f->pos  = 0;
+    return f;
+}
+
+/**
+ * @brief   FileStore_Read
+ *
+ * @note    Returns the number of bytes read (0 at the end) or -1
+ */
+int
+FileStore_Read(FileStore_File *f, void *buf, int len) {
+uint32_t n;
+
+    if( f == 0 || f->slot < 0 || f->mode != FILESTORE_READ || len < 0 )
+        return -1;
+    n = dir[f->slot].size-f->pos;
+    if( n > (uint32_t) len )
+        n = len;
+    if( filestore_readmedium(f->slot,f->pos,buf,n) < 0 )
+        return -1;
+    f->pos += n;
+    return n;
+}
+
+/**
+ * @brief   FileStore_Write
+ *
+ * @note    Appends len bytes. Returns len or -1 when the slot is full
+ */
+int
+FileStore_Write(FileStore_File *f, const void *buf, int len) {
+
+    if( f == 0 || f->slot < 0 || f->mode != FILESTORE_WRITE || len < 0 )
+        return -1;
+    if( f->pos+len > FILESTORE_SLOTSIZE )
+        return -1;
+    if( filestore_writemedium(f->slot,f->pos,buf,len) < 0 )
+        return -1;
+    f->pos += len;
+    dir[f->slot].size = f->pos;
+    return len;
+}
+
+/**
+ * @brief   FileStore_Close
+ *
+ * @note    A written file replaces the old one only when ok is set, and its
+ *          CRC is computed. Otherwise it is discarded
+ */
+void
+FileStore_Close(FileStore_File *f, int ok) {
+int old;
+
+    if( f == 0 || f->slot < 0 )
+        return;
+    if( f->mode == FILESTORE_WRITE ) {
+        if( ok ) {
+            old = filestore_find(dir[f->slot].name);
+            if( old >= 0 )
+                dir[old].state = FILESTORE_FREE;
+            dir[f->slot].crc   = filestore_crcmedium(f->slot,dir[f->slot].size);
+            dir[f->slot].state = FILESTORE_VALID;
+        } else {
+            dir[f->slot].state = FILESTORE_FREE;
+        }
+    }
+    f->slot = -1;
+}
+
+/**
+ * @brief   FileStore_GetSize
+ *
+ * @note    Returns the size of the file or -1 when it does not exist
+ */
+long
+FileStore_GetSize(const char *name) {
+int slot = filestore_find(name);
+
+    return slot < 0 ? -1 : (long) dir[slot].size;
+}
+
+/**
+ * @brief   FileStore_GetFileSize
+ *
+ * @note    Size of an open file
+ */
+long
+FileStore_GetFileSize(FileStore_File *f) {
+
+    if( f == 0 || f->slot < 0 )
+        return -1;
+    return dir[f->slot].size;
+}
+
+/**
+ * @brief   FileStore_GetFileName
+ *
+ * @note    Name of an open file. It stays valid after the close of a written
+ *          file, when it is kept
+ */
+const char *
+FileStore_GetFileName(FileStore_File *f) {
+
+    if( f == 0 || f->slot < 0 )
+        return 0;
+    return dir[f->slot].name;
+}
+
+/**
+ * @brief   FileStore_GetCRC
+ *
+ * @note    CRC-32 (zlib) computed when the file was written. Returns 0 or -1
+ *          when it does not exist
+ */
+int
+FileStore_GetCRC(const char *name, uint32_t *crc) {
+int slot = filestore_find(name);
+
+    if( slot < 0 )
+        return -1;
+    *crc = dir[slot].crc;
+    return 0;
+}
+
+/**
+ * @brief   FileStore_Remove
+ *
+ * @note    Returns 0 or -1 when it does not exist
+ */
+int
+FileStore_Remove(const char *name) {
+int slot = filestore_find(name);
+
+    if( slot < 0 )
+        return -1;
+    dir[slot].state = FILESTORE_FREE;
+    return 0;
+}
@@ -0,0 +1,58 @@
+#ifndef FILESTORE_H
+#define FILESTORE_H
+/**
+ * @file    filestore.h
+ *
+ * @note    Flat file store for the TFTP server
+ *
+ * @note    Each file has a fixed slot of FILESTORE_SLOTSIZE bytes, so a file is
+ *          written sequentially without allocation. Writing a file that exists
+ *          replaces it, only when the transfer is complete (FileStore_Close with
+ *          ok set). Until then the old contents are read
+ *
+ * @note    The slots are in SDRAM and are lost at reset. The medium is accessed
+ *          only by filestore_readmedium and filestore_writemedium, so a
+ *          persistent one (MicroSD, QSPI NOR) can replace it there
+ *
+ * @note    The CRC-32 of a written file (e.g. a firmware image) is computed by
+ *          the CRC unit when it is closed, and can be compared with the one of
+ *          the host (crc32 of zlib, cksum -a crc32b)
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Size of the store
+ */
+///@{
+#ifndef FILESTORE_MAXFILES
+#define FILESTORE_MAXFILES          4
+#endif
+#ifndef FILESTORE_SLOTSIZE
+#define FILESTORE_SLOTSIZE          (1024*1024)
+#endif
+#define FILESTORE_NAMESIZE          24
+///@}
+
+/**
+ * @brief   Open modes
+ */
+///@{
+#define FILESTORE_READ              0
+#define FILESTORE_WRITE             1
+///@}
+
+typedef struct FileStore_File_s FileStore_File;
+
+int             FileStore_Init(void);
+FileStore_File *FileStore_Open(const char *name, int mode);
+int             FileStore_Read(FileStore_File *f, void *buf, int len);
+int             FileStore_Write(FileStore_File *f, const void *buf, int len);
+void            FileStore_Close(FileStore_File *f, int ok);
+long            FileStore_GetSize(const char *name);
+long            FileStore_GetFileSize(FileStore_File *f);
+const char     *FileStore_GetFileName(FileStore_File *f);
+int             FileStore_GetCRC(const char *name, uint32_t *crc);
+int             FileStore_Remove(const char *name);
+
+#endif // FILESTORE_H
@@ -0,0 +1,445 @@
+/**
+ * @file    fwupdate.c
+ *
+ * @note    Firmware update with the image staged in the QSPI flash (see
+ *          fwupdate.h)
+ *
+ * @note    Only one QSPI operation runs at a time. FWUpdate_Poll starts the
+ *          next one when the previous is done, in this order of preference:
+ *          program a full page of received data in an erased sector, erase the
+ *          sector after the last one erased (while receiving, one sector ahead
+ *          of the data), and, after FWUpdate_End, program the last partial page
+ *          and verify. A page takes about 0.5 ms and a sector about 0.7 s, so
+ *          the time of the erases is hidden by the reception
+ *
+ * @note    The header is in the subsector after the staging area. It is erased
+ *          first by each update and programmed last. The words attempts and
+ *          installed are then changed from FFFFFFFFh without erasing (NOR flash
+ *          bits go from 1 to 0)
+ *
+ * @note    Internal flash sectors of the STM32F746NG
+ *
+ *          | Sector | Size   | Address     |
+ *          |--------|--------|-------------|
+ *          |   0-3  |  32 KB | 0x0800_0000 |
+ *          |    4   | 128 KB | 0x0802_0000 |
+ *          |   5-7  | 256 KB | 0x0804_0000 |
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "stm32f746xx.h"
+#include "crc.h"
+#include "qspi.h"
+#include "fwupdate.h"
+
+/**
+ * @brief   Internal flash
+ *
+ * @note    The firmware is linked at the ITCM alias and programmed thru the
+ *          AXIM alias
+ */
+///@{
+#define FLASH_ITCM                  0x00200000
+#define FLASH_AXIM                  0x08000000
+#define FLASH_KEY1                  0x45670123
+#define FLASH_KEY2                  0xCDEF89AB
+#define FLASH_ERRORS                (FLASH_SR_OPERR|FLASH_SR_WRPERR|FLASH_SR_PGAERR\
+                                    |FLASH_SR_PGPERR|FLASH_SR_ERSERR)
+///@}
+
+/**
+ * @brief   RAM (DTCM, SRAM1 and SRAM2) for the check of the stack pointer
+ */
+///@{
+#define RAM_START                   0x20000000
+#define RAM_END                     0x20050000
+///@}
+
+/**
+ * @brief   Header of a staged image
+ *
+ * @note    check is ~(size^crc)
+ */
+///@{
+#define FWUPDATE_MAGIC              0x46575550      // "FWUP"
+
+typedef struct {
+    uint32_t    magic;
+    uint32_t    size;
+    uint32_t    crc;
+    uint32_t    check;
+    uint32_t    attempts;                   ///< a bit cleared by each copy
+    uint32_t    installed;                  ///< 0 when installed
+} Header;
+///@}
+
+/**
+ * @brief   Code run from SRAM
+ *
+ * @note    The .ramfunc section is in .data (see stm32f746-disco.ld), so it is
+ *          copied to SRAM by the startup code
+ */
+#define RAMFUNC                     __attribute__((section(".ramfunc"),noinline,long_call))
+
+/**
+ * @brief   Received image (SDRAM)
+ */
+static uint8_t buffer[FWUPDATE_MAXSIZE] __attribute__((section(".sdram.fwupdate"),aligned(32)));
+
+/**
+ * @brief   State
+ */
+///@{
+static FWUpdate_Status      status;
+static int                  ready = 0;      // QSPI found
+static int                  headererased = 0;
+static int                  erasing = 0;    // an erase is running
+static uint32_t             starttime;
+static uint32_t             endtime;
+static volatile uint32_t    now = 0;        // ms
+///@}
+
+/**
+ * @brief   Header in the QSPI flash (memory mapped)
+ */
+static const volatile Header *const header =
+                        (const volatile Header *) (QSPI_ADDRESS+FWUPDATE_HEADER);
+
+/**
+ * @brief   Initialize the QSPI flash and enter memory mapped mode
+ */
+static int
+setup(void) {
+
+    if( ready )
+        return FWUPDATE_OK;
+    if( QSPI_Init() != QSPI_OK || QSPI_EnableMemoryMapped() != QSPI_OK )
+        return FWUPDATE_ERROR_QSPI;
+    ready = 1;
+    return FWUPDATE_OK;
+}
+
+/**
+ * @brief   Check the vector table of an image
+ *
+ * @note    The initial stack pointer must be in RAM and the reset handler
+ *          (Thumb) inside the image
+ */
+static int
+checkimage(const uint32_t *v, uint32_t size) {
+uint32_t pc;
+
+    if( size < 8 )
+        return FWUPDATE_ERROR_IMAGE;
+    if( v[0] < RAM_START || v[0] > RAM_END || (v[1]&1) == 0 )
+        return FWUPDATE_ERROR_IMAGE;
+    pc = v[1]&~1U;
+    if( pc >= FLASH_ITCM && pc < FLASH_ITCM+size )
+        return FWUPDATE_OK;
+    if( pc >= FLASH_AXIM && pc < FLASH_AXIM+size )
+        return FWUPDATE_OK;
+    return FWUPDATE_ERROR_IMAGE;
+}
+
+/**
+ * @brief   Check a header
+ */
+static int
+checkheader(void) {
+
+    return header->magic == FWUPDATE_MAGIC
+        && header->size > 0 && header->size <= FWUPDATE_MAXSIZE
+        && header->check == ~(header->size^header->crc);
+}
+
+/**
+ * @brief   Change a word of the header
+ *
+ * @note    Only bits from 1 to 0
+ */
+static int
+setword(size_t offset, uint32_t w) {
+
+    if( QSPI_Write(FWUPDATE_HEADER+offset,&w,sizeof(w)) != QSPI_OK )
+        return FWUPDATE_ERROR_QSPI;
+    return FWUPDATE_OK;
+}
+
+/**
+ * @brief   End an update with an error
+ */
+static int
+fail(int error) {
+
+    status.state = FWUPDATE_FAILED;
+    status.error = error;
+    return error;
+}
+
+/**
+ * @brief   Verify the staged image and write the header
+ */
+static int
+finish(void) {
+Header h;
+
+    if( CRC_Compute(&CRC_32,(const void *) (QSPI_ADDRESS+FWUPDATE_STAGING),
+                    status.received) != status.crc )
+        return fail(FWUPDATE_ERROR_VERIFY);
+
+    h.magic     = FWUPDATE_MAGIC;
+    h.size      = status.received;
+    h.crc       = status.crc;
+    h.check     = ~(h.size^h.crc);
+    h.attempts  = 0xFFFFFFFF;
+    h.installed = 0xFFFFFFFF;
+    if( QSPI_Write(FWUPDATE_HEADER,&h,sizeof(h)) != QSPI_OK )
+        return fail(FWUPDATE_ERROR_QSPI);
+
+    status.flushms = now-endtime;
+    status.state   = FWUPDATE_PENDING;
+    return FWUPDATE_OK;
+}
+
+/**
+ * @brief   Copy the staged image to the internal flash and reset
+ *
+ * @note    Runs from SRAM with the interrupts disabled, since the flash is
+ *          erased. It calls no other function and never returns. Errors are
+ *          found by the CRC check after the reset
+ */
+static void RAMFUNC
+copy(const volatile uint32_t *src, uint32_t size) {
+volatile uint32_t *dst = (volatile uint32_t *) FLASH_AXIM;
+uint32_t sector,end,i;
+
+    FLASH->KEYR = FLASH_KEY1;
+    FLASH->KEYR = FLASH_KEY2;
+    FLASH->SR   = FLASH_ERRORS;
+
+    for(sector=0,end=0;end<size;sector++) {
+        end += sector < 4 ? 32*1024 : sector == 4 ? 128*1024 : 256*1024;
+        FLASH->CR = FLASH_CR_PSIZE_1|(sector<<FLASH_CR_SNB_Pos)|FLASH_CR_SER;
+        FLASH->CR |= FLASH_CR_STRT;
+        __DSB();
+        while( FLASH->SR&FLASH_SR_BSY ) {}
+    }
+
+    FLASH->CR = FLASH_CR_PSIZE_1|FLASH_CR_PG;
+    for(i=0;i<(size+3)/4;i++) {
+        dst[i] = src[i];
+        __DSB();
+        while( FLASH->SR&FLASH_SR_BSY ) {}
+    }
+    FLASH->CR = FLASH_CR_LOCK;
+
+    SCB->AIRCR = (0x5FAUL<<SCB_AIRCR_VECTKEY_Pos)
+                |(SCB->AIRCR&SCB_AIRCR_PRIGROUP_Msk)
+                |SCB_AIRCR_SYSRESETREQ_Msk;
+    __DSB();
+    for(;;) {}
+}
+
+/**
+ * @brief   FWUpdate_Init
+ *
+ * @note    Finds the QSPI flash. The status is FWUPDATE_PENDING when an image
+ *          staged is waiting for a reset, FWUPDATE_FAILED when its copies
+ *          failed
+ */
+int
+FWUpdate_Init(void) {
+int rc;
+
+    memset(&status,0,sizeof(status));
+    rc = setup();
+    if( rc < 0 )
+        return rc;
+    if( checkheader() && header->installed != 0 ) {
+        status.state = FWUPDATE_PENDING;
+        status.received = status.programmed = header->size;
+        status.crc = header->crc;
+        if( (header->attempts&((1U<<FWUPDATE_MAXATTEMPTS)-1)) == 0 )
+            fail(FWUPDATE_ERROR_VERIFY);
+    }
+    return FWUPDATE_OK;
+}
+
+/**
+ * @brief   FWUpdate_Begin
+ *
+ * @note    Starts receiving an image. A pending one is dropped
+ */
+int
+FWUpdate_Begin(void) {
+
+    if( !ready )
+        return FWUPDATE_ERROR_QSPI;
+    if( status.state == FWUPDATE_RECEIVING || status.state == FWUPDATE_FLUSHING )
+        return FWUPDATE_ERROR_STATE;
+    memset(&status,0,sizeof(status));
+    status.state = FWUPDATE_RECEIVING;
+    headererased = 0;
+    starttime = now;
+    return FWUpdate_Poll();
+}
+
+/**
+ * @brief   FWUpdate_Write
+ *
+ * @note    Appends data to the image
+ */
+int
+FWUpdate_Write(const void *data, uint32_t n) {
+
+    if( status.state != FWUPDATE_RECEIVING )
+        return FWUPDATE_ERROR_STATE;
+    if( n > FWUPDATE_MAXSIZE-status.received )
+        return fail(FWUPDATE_ERROR_SIZE);
+    memcpy(buffer+status.received,data,n);
+    status.crc = CRC32_Update(status.crc,data,n);
+    status.received += n;
+    return FWUpdate_Poll();
+}
+
+/**
+ * @brief   FWUpdate_End
+ *
+ * @note    ok is 0 when the transfer was aborted. Otherwise, the image is
+ *          checked and the rest is programmed by FWUpdate_Poll
+ */
+int
+FWUpdate_End(int ok) {
+int rc;
+
+    if( status.state != FWUPDATE_RECEIVING )
+        return FWUPDATE_ERROR_STATE;
+    status.receivems = now-starttime;
+    endtime = now;
+    if( !ok ) {
+        status.state = FWUPDATE_IDLE;
+        return FWUPDATE_OK;
+    }
+    rc = checkimage((const uint32_t *) buffer,status.received);
+    if( rc < 0 )
+        return fail(rc);
+    status.state = FWUPDATE_FLUSHING;
+    return FWUpdate_Poll();
+}
+
+/**
+ * @brief   FWUpdate_Poll
+ *
+ * @note    Starts the next QSPI operation when the previous is finished. Must
+ *          be called often (each ms) during an update. Returns a negative value
+ *          when the update failed
+ */
+int
+FWUpdate_Poll(void) {
+uint32_t left,n;
+int rc;
+
+    rc = QSPI_Busy();
+    if( status.state != FWUPDATE_RECEIVING && status.state != FWUPDATE_FLUSHING )
+        return status.state == FWUPDATE_FAILED ? status.error : FWUPDATE_OK;
+    left = status.received-status.programmed;
+    if( rc > 0 ) {
+        if( erasing && status.programmed == status.erased && left >= QSPI_PAGESIZE )
+            status.erasewaits++;
+        return FWUPDATE_OK;
+    }
+    erasing = 0;
+    if( rc < 0 )
+        return fail(FWUPDATE_ERROR_QSPI);
+
+    if( !headererased ) {
+        // An interrupted update leaves no header
+        rc = QSPI_StartEraseSubsector(FWUPDATE_HEADER);
+        headererased = 1;
+        erasing = 1;
+    } else if( status.programmed < status.erased
+           && (left >= QSPI_PAGESIZE || (status.state == FWUPDATE_FLUSHING && left > 0)) ) {
+        n = left < QSPI_PAGESIZE ? left : QSPI_PAGESIZE;
+        rc = QSPI_StartWrite(FWUPDATE_STAGING+status.programmed,buffer+status.programmed,n);
+        status.programmed += n;
+    } else if( status.erased < FWUPDATE_MAXSIZE
+           && (status.erased < status.received
+               || (status.state == FWUPDATE_RECEIVING
+                   && status.erased < status.received+QSPI_SECTORSIZE)) ) {
+        rc = QSPI_StartEraseSector(FWUPDATE_STAGING+status.erased);
+        status.erased += QSPI_SECTORSIZE;
+        erasing = 1;
+    } else if( status.state == FWUPDATE_FLUSHING && left == 0 ) {
+        return finish();
+    }
+    if( rc < 0 )
+        return fail(FWUPDATE_ERROR_QSPI);
+    return FWUPDATE_OK;
+}
+
+/**
+ * @brief   FWUpdate_GetStatus
+ */
+void
+FWUpdate_GetStatus(FWUpdate_Status *s) {
+
+    *s = status;
+    if( status.state == FWUPDATE_RECEIVING )
+        s->receivems = now-starttime;
+}
+
+/**
+ * @brief   FWUpdate_Install
+ *
+ * @note    Called at the start of main, after Cache_Init and SDRAM_Init. When an
+ *          image is pending, it is copied to the internal flash and the board
+ *          is reset (it does not return). Returns 1 when the firmware running
+ *          was just installed, 0 when there is nothing to do and a negative
+ *          value when the image could not be installed
+ */
+int
+FWUpdate_Install(void) {
+uint32_t attempts;
+int rc;
+
+    rc = setup();
+    if( rc < 0 )
+        return rc;
+    if( !checkheader() || header->installed == 0 )
+        return 0;
+
+    if( CRC_Compute(&CRC_32,(const void *) FLASH_AXIM,header->size) == header->crc ) {
+        rc = setword(offsetof(Header,installed),0);
+        return rc < 0 ? rc : 1;
+    }
+
+    attempts = header->attempts;
+    if( (attempts&((1U<<FWUPDATE_MAXATTEMPTS)-1)) == 0 )
+        return FWUPDATE_ERROR_VERIFY;
+    if( checkimage((const uint32_t *) (QSPI_ADDRESS+FWUPDATE_STAGING),header->size) < 0 )
+        return FWUPDATE_ERROR_IMAGE;
+    rc = setword(offsetof(Header,attempts),attempts<<1);
+    if( rc < 0 )
+        return rc;
+
+    __disable_irq();
+    SysTick->CTRL = 0;
+    copy((const volatile uint32_t *) (QSPI_ADDRESS+FWUPDATE_STAGING),header->size);
+    return FWUPDATE_ERROR_VERIFY;
+}
+
+/**
+ * @brief   FWUpdate_Tick
+ *
+ * @note    Must be called every ms
+ */
+void
+FWUpdate_Tick(void) {
+
+    now++;
+    QSPI_Tick();
+}
@@ -0,0 +1,115 @@
+#ifndef FWUPDATE_H
+#define FWUPDATE_H
+/**
+ * @file    fwupdate.h
+ *
+ * @note    Firmware update thru the network, with the image staged in the
+ *          QSPI flash
+ *
+ * @note    The image is received (e.g. by TFTP, see main.c) into a buffer in
+ *          SDRAM. Meanwhile, FWUpdate_Poll erases the staging area of the QSPI
+ *          flash one sector (64 KB) ahead of the data and programs the received
+ *          data page (256 bytes) by page, with the non blocking functions of
+ *          qspi.c. When the transfer ends, only the last pages are left to
+ *          program. The staged image is then checked against the CRC-32 of
+ *          the received data (CRC unit) and a header marks it as pending
+ *
+ * @note    The internal flash can not be the staging area: the F746 has a
+ *          single bank, so erasing or programming it stalls every fetch of
+ *          code and constants (and so the network) for up to 2 s per sector
+ *
+ * @note    At the next reset, FWUpdate_Install (called at the start of main)
+ *          finds the pending image. A function running from SRAM, with the
+ *          interrupts disabled, erases the sectors of the internal flash, copies
+ *          the image from the QSPI flash in memory mapped mode and resets. When
+ *          the new firmware calls FWUpdate_Install, it checks the CRC-32 of the
+ *          internal flash and marks the image as installed. After
+ *          FWUPDATE_MAXATTEMPTS failed copies, it gives up
+ *
+ * @note    A reset or a power loss during the reception leaves the old header
+ *          erased, so nothing is installed. During the copy, the next reset
+ *          starts it again
+ *
+ * @note    Needs Cache_Init, SDRAM_Init and CRC_Init. FWUpdate_Tick must be
+ *          called every ms (it calls QSPI_Tick)
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Staging area in the QSPI flash (offsets)
+ *
+ * @note    FWUPDATE_MAXSIZE bytes for the image, followed by a subsector for
+ *          the header. The default is the 1 MB before the last MB
+ */
+///@{
+#ifndef FWUPDATE_STAGING
+#define FWUPDATE_STAGING            0x00E00000
+#endif
+#define FWUPDATE_MAXSIZE            (1024*1024)     ///< size of the internal flash
+#define FWUPDATE_HEADER             (FWUPDATE_STAGING+FWUPDATE_MAXSIZE)
+///@}
+
+/**
+ * @brief   Copies tried before giving up
+ */
+#ifndef FWUPDATE_MAXATTEMPTS
+#define FWUPDATE_MAXATTEMPTS        3
+#endif
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define FWUPDATE_OK                 (0)
+#define FWUPDATE_ERROR_QSPI         (-1)    ///< flash not found, erase or program failed
+#define FWUPDATE_ERROR_STATE        (-2)    ///< no update or one in progress
+#define FWUPDATE_ERROR_SIZE         (-3)    ///< larger than FWUPDATE_MAXSIZE
+#define FWUPDATE_ERROR_IMAGE        (-4)    ///< not a firmware for this board
+#define FWUPDATE_ERROR_VERIFY       (-5)    ///< staged data differ from the received
+///@}
+
+/**
+ * @brief   States
+ */
+///@{
+#define FWUPDATE_IDLE               0
+#define FWUPDATE_RECEIVING          1
+#define FWUPDATE_FLUSHING           2       ///< received, pages left to program
+#define FWUPDATE_PENDING            3       ///< staged, installed at the next reset
+#define FWUPDATE_FAILED             4
+///@}
+
+/**
+ * @brief   Status of the current (or last) update
+ *
+ * @note    flushms is the time from the end of the reception to the image
+ *          being ready, the part of the programming not hidden by the transfer.
+ *          erasewaits counts the calls to FWUpdate_Poll that found data to
+ *          program in a sector still being erased
+ */
+typedef struct {
+    int         state;
+    int         error;                      ///< when FWUPDATE_FAILED
+    uint32_t    received;                   ///< bytes
+    uint32_t    programmed;                 ///< bytes
+    uint32_t    erased;                     ///< bytes
+    uint32_t    crc;                        ///< CRC-32 of the received data
+    uint32_t    erasewaits;
+    uint32_t    receivems;
+    uint32_t    flushms;
+} FWUpdate_Status;
+
+int  FWUpdate_Init(void);
+int  FWUpdate_Begin(void);
+int  FWUpdate_Write(const void *data, uint32_t n);
+int  FWUpdate_End(int ok);
+int  FWUpdate_Poll(void);
+void FWUpdate_GetStatus(FWUpdate_Status *status);
+int  FWUpdate_Install(void);
+void FWUpdate_Tick(void);
+
+#endif // FWUPDATE_H
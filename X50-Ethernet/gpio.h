@@ -53,6 +53,9 @@ void GPIO_ConfigureSinglePin( const GPIO_PinConfiguration *conf );
 /// Configure pins based on a array of PinConfiguration
 void GPIO_ConfigureMultiplePins( const GPIO_PinConfiguration *conf );
 
+/// Same, but writing each register of a port once
+void GPIO_ConfigurePinTable( const GPIO_PinConfiguration *conf );
+
 /// Configure pins specified by a bit mask from a GPIO_PinConfiguration struct
 void GPIO_ConfigureMultiplePinsEqual( GPIO_TypeDef *gpio,
                                 unsigned pinmask,
@@ -71,8 +74,20 @@ static inline void GPIO_Clear( GPIO_TypeDef *gpio, uint32_t mask ) {
 }
 
 static inline void GPIO_Toggle( GPIO_TypeDef *gpio, uint32_t mask ) {
-        /* This is a read/modify/write sequence */
-       gpio->ODR ^= mask;             // Use XOR to toggle output
+uint32_t odr = gpio->ODR;
+        /* Clears the pins that are high and sets the others in one write. ODR is
+           only read, so pins changed meanwhile by an interrupt are kept */
+        gpio->BSRR = ((odr&mask)<<16)|(~odr&mask);
+}
+
+static inline void GPIO_Write( GPIO_TypeDef *gpio, uint32_t setmask, uint32_t clearmask ) {
+        /* Sets and clears many pins in one write. Set wins when in both masks */
+        gpio->BSRR = (clearmask<<16)|setmask;
+}
+
+static inline void GPIO_WriteMasked( GPIO_TypeDef *gpio, uint32_t mask, uint32_t value ) {
+        /* The pins in mask get the corresponding bits of value */
+        gpio->BSRR = ((~value&mask)<<16)|(value&mask);
 }
 
 static inline unsigned GPIO_Read( GPIO_TypeDef *gpio) {
@@ -8,6 +8,7 @@
 #include "stm32f746xx.h"
 #include "system_stm32f746.h"
 #include "gpio.h"
+#include "clkgate.h"
 
 /**
  * @defgroup defines-1
@@ -100,27 +101,28 @@ uint32_t moder, otyper, ospeedr, pupdr, odr;
 
 /**
  * @brief   GPIO_EnableClock
+ *
+ * @note    Not kept in Sleep mode (see clkgate.h)
  */
 
 void
 GPIO_EnableClock(GPIO_TypeDef *gpio) {
-uint32_t m;
+unsigned id;
 
     /* Enable clock for GPIO */
-    if( gpio == GPIOA ) m=RCC_AHB1ENR_GPIOAEN;
-    else if ( gpio == GPIOB ) m=RCC_AHB1ENR_GPIOBEN;
-    else if ( gpio == GPIOC ) m=RCC_AHB1ENR_GPIOCEN;
-    else if ( gpio == GPIOD ) m=RCC_AHB1ENR_GPIODEN;
-    else if ( gpio == GPIOE ) m=RCC_AHB1ENR_GPIOEEN;
-    else if ( gpio == GPIOF ) m=RCC_AHB1ENR_GPIOFEN;
-    else if ( gpio == GPIOG ) m=RCC_AHB1ENR_GPIOGEN;
-    else if ( gpio == GPIOH ) m=RCC_AHB1ENR_GPIOHEN;
-    else if ( gpio == GPIOI ) m=RCC_AHB1ENR_GPIOIEN;
-    else if ( gpio == GPIOJ ) m=RCC_AHB1ENR_GPIOJEN;
-    else if ( gpio == GPIOK ) m=RCC_AHB1ENR_GPIOKEN;
-    else    m = 0;
-    RCC->AHB1ENR |= m;
-    __DSB();
+    if( gpio == GPIOA ) id=CLKGATE_GPIOA;
+    else if ( gpio == GPIOB ) id=CLKGATE_GPIOB;
+    else if ( gpio == GPIOC ) id=CLKGATE_GPIOC;
+    else if ( gpio == GPIOD ) id=CLKGATE_GPIOD;
+    else if ( gpio == GPIOE ) id=CLKGATE_GPIOE;
+    else if ( gpio == GPIOF ) id=CLKGATE_GPIOF;
+    else if ( gpio == GPIOG ) id=CLKGATE_GPIOG;
+    else if ( gpio == GPIOH ) id=CLKGATE_GPIOH;
+    else if ( gpio == GPIOI ) id=CLKGATE_GPIOI;
+    else if ( gpio == GPIOJ ) id=CLKGATE_GPIOJ;
+    else if ( gpio == GPIOK ) id=CLKGATE_GPIOK;
+    else    return;
+    ClkGate_Enable(id,0);
 
 }
 
@@ -153,7 +155,7 @@ int pos;
     gpio->OSPEEDR = (gpio->OSPEEDR&~(3<<pos2))| (conf->ospeed<<pos2);
     gpio->PUPDR   = (gpio->PUPDR&~(3<<pos2))  | (conf->pupd<<pos2);
     gpio->OTYPER  = (gpio->OTYPER&~(BIT(pos)))| (conf->otype<<pos);
-    gpio->ODR     = (gpio->ODR&~(BIT(pos)))   | (conf->initial<<pos);
+    gpio->BSRR    = conf->initial ? BIT(pos) : BIT(pos+16);
 
 }
 
@@ -168,6 +170,72 @@ void GPIO_ConfigureMultiplePins(const GPIO_PinConfiguration *pconfig) {
     }
 }
 
+/**
+ * @brief   GPIO Configure all pins in an array, writing each register once
+ *
+ * @note    GPIO_ConfigureMultiplePins does a read-modify-write of 6 registers
+ *          for each pin. Here the fields of all pins of a port are merged in
+ *          masks first, so each register of a port is read and written once.
+ *          When a pin appears twice, the last entry wins, as in
+ *          GPIO_ConfigureMultiplePins
+ *
+ * @note    BSRR and AFR are written before MODER, so a pin that becomes an
+ *          output or an alternate function pin has already its level and its
+ *          function
+ *
+ * @note    The array ends with an entry with gpio == 0
+ */
+void GPIO_ConfigurePinTable(const GPIO_PinConfiguration *pconfig) {
+const GPIO_PinConfiguration *p;
+GPIO_TypeDef *gpio;
+uint32_t done = 0;      /* ports already configured, bit 0 is GPIOA */
+uint32_t port;
+uint32_t m1,otype,m2,mode,ospeed,pupd,bsrr;
+uint32_t m4[2],af[2];
+unsigned pos,pos2,pos4,h;
+
+    for( ; pconfig->gpio; pconfig++ ) {
+        gpio = pconfig->gpio;
+        port = BIT(((uintptr_t) gpio-GPIOA_BASE)/(GPIOB_BASE-GPIOA_BASE));
+        if( done&port )
+            continue;
+        done |= port;
+
+        m1 = otype = m2 = mode = ospeed = pupd = bsrr = 0;
+        m4[0] = m4[1] = af[0] = af[1] = 0;
+        for(p=pconfig;p->gpio;p++) {
+            if( p->gpio != gpio )
+                continue;
+            pos  = p->pin;
+            pos2 = pos*2;
+            pos4 = (pos&7)*4;
+            h    = pos>>3;
+            m1     |= BIT(pos);
+            otype   = (otype&~BIT(pos))      | ((uint32_t) p->otype<<pos);
+            m2     |= 3UL<<pos2;
+            mode    = (mode&~(3UL<<pos2))    | ((uint32_t) p->mode<<pos2);
+            ospeed  = (ospeed&~(3UL<<pos2))  | ((uint32_t) p->ospeed<<pos2);
+            pupd    = (pupd&~(3UL<<pos2))    | ((uint32_t) p->pupd<<pos2);
+            m4[h]  |= 0xFUL<<pos4;
+            af[h]   = (af[h]&~(0xFUL<<pos4)) | ((uint32_t) p->af<<pos4);
+            bsrr    = (bsrr&~(BIT(pos)|BIT(pos+16)))
+                      | (p->initial ? BIT(pos) : BIT(pos+16));
+        }
+
+        GPIO_EnableClock(gpio);
+
+        gpio->BSRR    = bsrr;
+        if( m4[0] )
+            gpio->AFR[0] = (gpio->AFR[0]&~m4[0]) | af[0];
+        if( m4[1] )
+            gpio->AFR[1] = (gpio->AFR[1]&~m4[1]) | af[1];
+        gpio->OTYPER  = (gpio->OTYPER&~m1)  | otype;
+        gpio->OSPEEDR = (gpio->OSPEEDR&~m2) | ospeed;
+        gpio->PUPDR   = (gpio->PUPDR&~m2)   | pupd;
+        gpio->MODER   = (gpio->MODER&~m2)   | mode;
+    }
+}
+
 /**
  * @brief   Configure Pin using short information (only AF and MODE)).
  *          There are default for OTYPE, OSPEED, PUPD and INITIAL
@@ -207,7 +275,7 @@ int pos;
     gpio->OSPEEDR = (gpio->OSPEEDR&~(3<<pos2)) | (OSPEEDDEFAULT<<pos2);
     gpio->PUPDR   = (gpio->PUPDR&~(3<<pos2))   | (PUPDDEFAULT<<pos2);
     gpio->OTYPER  = (gpio->OTYPER&~(BIT(pos))) | (OTYPEDEFAULT<<pos);
-    gpio->ODR     = (gpio->ODR&~BIT(pos))      | (INITIALDEFAULT<<pos);
+    gpio->BSRR    = INITIALDEFAULT ? BIT(pos) : BIT(pos+16);
 }
 
 /**
@@ -283,7 +351,7 @@ unsigned pos2,pos4;
         gpio->OTYPER  = (gpio->OTYPER&~(1<<(pin))) | (otype<<(pin));
         gpio->OSPEEDR = (gpio->OSPEEDR&~(3<<pos2)) | (ospeed<<pos2);
         gpio->PUPDR   = (gpio->PUPDR&~(3<<pos2))   | (pupd<<pos2);
-        gpio->ODR     = (gpio->ODR&~(1<<(pin)))    | (init<<pos2);
+        gpio->BSRR    = init ? BIT(pin) : BIT(pin+16);
         break;
     case 2:         /*& Alternate function */
          if( pin < 8 ) {    // Use AFRL
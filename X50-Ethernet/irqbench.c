@@ -0,0 +1,241 @@
+/**
+ * @file    irqbench.c
+ *
+ * @note    Interrupt latency benchmark for a periodic control loop
+ *
+ * @note    The latency is read from TIM6->CNT as the first access of the
+ *          routine. It includes the exception entry (12 cycles with zero wait
+ *          state memory), the stacking and the APB1 read (some cycles). A
+ *          longer latency comes from the sections with the interrupts disabled
+ *          and from the bus and flash contention (ETH and DMA2D masters)
+ *
+ * @note    The counters are updated only by the routine. IRQBench_GetStats
+ *          copies them with the interrupts disabled
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <string.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "irqprio.h"
+#include "clkgate.h"
+#include "irqbench.h"
+
+/**
+ * @brief   Configuration, set by IRQBench_Start
+ */
+///@{
+static IRQBench_Work    work = 0;
+static uint32_t         timerfreq = 0;          ///< Hz
+static uint32_t         periodcycles = 0;       ///< core cycles
+static uint32_t         deadlinecycles = 0;
+static uint32_t         cyclespertick = 1;
+static uint32_t         histticks = 1;          ///< timer cycles per bin
+///@}
+
+/**
+ * @brief   Counters in timer cycles (latency) or core cycles
+ */
+///@{
+static volatile struct {
+    uint32_t    count;
+    uint32_t    latencymin;
+    uint32_t    latencymax;
+    uint64_t    latencysum;
+    uint32_t    jittermax;
+    uint32_t    responsemax;
+    uint32_t    misses;
+    uint32_t    overruns;
+    uint32_t    last;                           ///< CYCCNT at the last entry
+    uint32_t    histogram[IRQBENCH_HISTSIZE];
+} bench;
+///@}
+
+/**
+ * @brief   Control loop interrupt
+ */
+void
+TIM6_DAC_IRQHandler(void) {
+uint32_t latency,entry,delta,dev,response;
+unsigned bin;
+
+    latency = TIM6->CNT;
+    entry   = DWT->CYCCNT;
+    IRQBENCH_GPIO->BSRR = 1U<<IRQBENCH_PIN;
+    TIM6->SR = ~TIM_SR_UIF;
+
+    if( bench.count > 0 ) {
+        delta = entry-bench.last;
+        dev = delta > periodcycles ? delta-periodcycles : periodcycles-delta;
+        if( dev > bench.jittermax )
+            bench.jittermax = dev;
+        if( delta > periodcycles+periodcycles/2 )
+            bench.overruns += (delta+periodcycles/2)/periodcycles-1;
+    }
+    bench.last = entry;
+    bench.count++;
+
+    if( latency < bench.latencymin )
+        bench.latencymin = latency;
+    if( latency > bench.latencymax )
+        bench.latencymax = latency;
+    bench.latencysum += latency;
+    bin = latency/histticks;
+    if( bin >= IRQBENCH_HISTSIZE )
+        bin = IRQBENCH_HISTSIZE-1;
+    bench.histogram[bin]++;
+
+    if( work )
+        work();
+
+    response = latency*cyclespertick+(DWT->CYCCNT-entry);
+    if( response > bench.responsemax )
+        bench.responsemax = response;
+    if( response > deadlinecycles )
+        bench.misses++;
+
+    IRQBENCH_GPIO->BSRR = 1U<<(IRQBENCH_PIN+16);
+}
+
+/**
+ * @brief   IRQBench_Reset
+ */
+void
+IRQBench_Reset(void) {
+uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    memset((void *) &bench,0,sizeof(bench));
+    bench.latencymin = 0xFFFFFFFF;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief   IRQBench_Start
+ *
+ * @note    Starts TIM6 with a period of periodus. work is called at each
+ *          interrupt (it can be null). A deadline of 0 is the period
+ *
+ * @note    Returns IRQBENCH_ERROR_PARAM when the period does not fit in TIM6
+ */
+int
+IRQBench_Start(uint32_t periodus, uint32_t deadlineus, IRQBench_Work f) {
+uint32_t ticks;
+
+    // TIM6 is clocked by 2*APB1, unless the APB1 prescaler is 1
+    timerfreq = SystemGetAPB1Frequency();
+    if( SystemGetAPB1Prescaler() != 1 )
+        timerfreq *= 2;
+
+    ticks = (uint32_t) (((uint64_t) timerfreq*periodus)/1000000);
+    if( ticks < 2 || ticks > 65536 )
+        return IRQBENCH_ERROR_PARAM;
+    if( deadlineus == 0 )
+        deadlineus = periodus;
+
+    IRQBench_Stop();
+
+    work           = f;
+    periodcycles   = (uint32_t) (((uint64_t) SystemCoreClock*periodus)/1000000);
+    deadlinecycles = (uint32_t) (((uint64_t) SystemCoreClock*deadlineus)/1000000);
+    cyclespertick  = SystemCoreClock/timerfreq;
+    if( cyclespertick == 0 )
+        cyclespertick = 1;
+    histticks = (uint32_t) (((uint64_t) timerfreq*IRQBENCH_HISTSTEP)/1000000000);
+    if( histticks == 0 )
+        histticks = 1;
+
+    // Cycle counter
+    if( (DWT->CTRL&DWT_CTRL_CYCCNTENA_Msk) == 0 ) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->LAR = 0xC5ACCE55;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+
+    // Output pin, push-pull, very high speed
+    if( ClkGate_GetCount(IRQBENCH_GPIOCLK) == 0 )
+        ClkGate_Enable(IRQBENCH_GPIOCLK,0);
+    IRQBENCH_GPIO->BSRR    = 1U<<(IRQBENCH_PIN+16);
+    IRQBENCH_GPIO->MODER   = (IRQBENCH_GPIO->MODER&~(3U<<(2*IRQBENCH_PIN)))
+                             |(1U<<(2*IRQBENCH_PIN));
+    IRQBENCH_GPIO->OTYPER &= ~(1U<<IRQBENCH_PIN);
+    IRQBENCH_GPIO->OSPEEDR |= 3U<<(2*IRQBENCH_PIN);
+
+    // TIM6 without prescaler, for the resolution of the latency. Its clock
+    // is kept in Sleep mode and released by IRQBench_Stop
+    ClkGate_Enable(CLKGATE_TIM6,CLKGATE_SLEEP);
+    TIM6->CR1  = TIM_CR1_URS;
+    TIM6->PSC  = 0;
+    TIM6->ARR  = ticks-1;
+    TIM6->EGR  = TIM_EGR_UG;
+    TIM6->SR   = 0;
+    TIM6->DIER = TIM_DIER_UIE;
+
+    IRQBench_Reset();
+
+    NVIC_SetPriority(TIM6_DAC_IRQn,IRQPRIO_CONTROL);
+    NVIC_ClearPendingIRQ(TIM6_DAC_IRQn);
+    NVIC_EnableIRQ(TIM6_DAC_IRQn);
+
+    TIM6->CR1 |= TIM_CR1_CEN;
+
+    return IRQBENCH_OK;
+}
+
+/**
+ * @brief   IRQBench_Stop
+ */
+void
+IRQBench_Stop(void) {
+
+    if( ClkGate_GetCount(CLKGATE_TIM6) == 0 )
+        return;
+    TIM6->CR1 &= ~TIM_CR1_CEN;
+    TIM6->DIER = 0;
+    NVIC_DisableIRQ(TIM6_DAC_IRQn);
+    NVIC_ClearPendingIRQ(TIM6_DAC_IRQn);
+    ClkGate_Disable(CLKGATE_TIM6,CLKGATE_SLEEP);
+}
+
+/**
+ * @brief   IRQBench_GetStats
+ *
+ * @note    Converts the counters to ns
+ */
+void
+IRQBench_GetStats(IRQBench_Stats *stats) {
+uint32_t primask,count,latmin,latmax,jitter,response;
+uint64_t latsum;
+uint32_t mhz;
+int i;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    count    = bench.count;
+    latmin   = bench.latencymin;
+    latmax   = bench.latencymax;
+    latsum   = bench.latencysum;
+    jitter   = bench.jittermax;
+    response = bench.responsemax;
+    stats->misses   = bench.misses;
+    stats->overruns = bench.overruns;
+    for(i=0;i<IRQBENCH_HISTSIZE;i++)
+        stats->histogram[i] = bench.histogram[i];
+    __set_PRIMASK(primask);
+
+    mhz = SystemCoreClock/1000000;
+    stats->count = count;
+    if( count == 0 || timerfreq == 0 ) {
+        stats->latencymin = stats->latencyavg = stats->latencymax = 0;
+    } else {
+        stats->latencymin = (uint32_t) (((uint64_t) latmin*1000000000)/timerfreq);
+        stats->latencymax = (uint32_t) (((uint64_t) latmax*1000000000)/timerfreq);
+        stats->latencyavg = (uint32_t) (((latsum*1000/count)*1000000)/timerfreq);
+    }
+    stats->jittermax   = (uint32_t) (((uint64_t) jitter*1000)/mhz);
+    stats->responsemax = (uint32_t) (((uint64_t) response*1000)/mhz);
+}
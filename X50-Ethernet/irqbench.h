@@ -0,0 +1,91 @@
+#ifndef IRQBENCH_H
+#define IRQBENCH_H
+/**
+ * @file    irqbench.h
+ *
+ * @note    Interrupt latency benchmark for a periodic control loop
+ *
+ * @note    TIM6 generates an update interrupt every period at IRQPRIO_CONTROL
+ *          (irqprio.h). The counter restarts at 0 at the update event, so its
+ *          value at the entry of the routine is the entry latency, in timer
+ *          clock cycles (100 MHz with HCLK at 200 MHz). The DWT cycle counter
+ *          gives the time between entries, and the jitter is its largest
+ *          deviation from the period
+ *
+ * @note    The routine then calls the work function (the control loop step).
+ *          The response time, from the update event to the end of the work,
+ *          is compared to the deadline. When it exceeds the period, update
+ *          events are lost and counted as overruns
+ *
+ * @note    The pin IRQBENCH_GPIO/IRQBENCH_PIN is high from the entry to the
+ *          end of the work, so the jitter and the execution time can be seen
+ *          with an oscilloscope triggered on the rising edge
+ *
+ * @note    The counter has 16 bits, so the period is limited to 65536 timer
+ *          cycles (655 us at 100 MHz)
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Output pin (ARD_D8 on the Arduino connector)
+ */
+///@{
+#ifndef IRQBENCH_GPIO
+#define IRQBENCH_GPIO               GPIOI
+#define IRQBENCH_GPIOCLK            CLKGATE_GPIOI
+#define IRQBENCH_PIN                2
+#endif
+///@}
+
+/**
+ * @brief   Latency histogram
+ *
+ * @note    IRQBENCH_HISTSIZE bins of IRQBENCH_HISTSTEP ns. The last bin counts
+ *          all larger latencies
+ */
+///@{
+#ifndef IRQBENCH_HISTSIZE
+#define IRQBENCH_HISTSIZE           16
+#endif
+#ifndef IRQBENCH_HISTSTEP
+#define IRQBENCH_HISTSTEP           50
+#endif
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define IRQBENCH_OK                 (0)
+#define IRQBENCH_ERROR_PARAM        (-1)
+///@}
+
+/**
+ * @brief   Results
+ *
+ * @note    Times in ns
+ */
+typedef struct {
+    uint32_t    count;                      ///< interrupts
+    uint32_t    latencymin;
+    uint32_t    latencyavg;
+    uint32_t    latencymax;
+    uint32_t    jittermax;                  ///< of the time between entries
+    uint32_t    responsemax;                ///< update event to end of work
+    uint32_t    misses;                     ///< response after the deadline
+    uint32_t    overruns;                   ///< update events lost
+    uint32_t    histogram[IRQBENCH_HISTSIZE];
+} IRQBench_Stats;
+
+typedef void (*IRQBench_Work)(void);
+
+int  IRQBench_Start(uint32_t periodus, uint32_t deadlineus, IRQBench_Work work);
+void IRQBench_Stop(void);
+void IRQBench_Reset(void);
+void IRQBench_GetStats(IRQBench_Stats *stats);
+
+#endif // IRQBENCH_H
@@ -0,0 +1,74 @@
+#ifndef IRQPRIO_H
+#define IRQPRIO_H
+/**
+ * @file    irqprio.h
+ *
+ * @note    Interrupt priorities of all drivers of the project
+ *
+ * @note    The NVIC has 16 levels (4 bits) and the grouping is not changed,
+ *          so all bits are preemption priority. 0 is the highest level
+ *
+ * @note    Plan
+ *
+ * | Level | Interrupt                        | Macro             |
+ * |-------|----------------------------------|-------------------|
+ * |   2   | Control loop (irqbench.c, TIM6)  | IRQPRIO_CONTROL   |
+ * |   5   | ETH and PHY (EXTI2), bare metal  | IRQPRIO_ETH       |
+ * |   6   | UARTs                            | IRQPRIO_UART      |
+ * |   6   | DMA2D                            | IRQPRIO_DMA2D     |
+ * |   7   | SDMMC1 (MicroSD)                 | IRQPRIO_SD        |
+ * |   8   | ETH and PHY (EXTI2), uC/OS-II    | IRQPRIO_ETH       |
+ * |  12   | DMA1 and DMA2 streams            | IRQPRIO_DMA       |
+ * |  13   | RNG                              | IRQPRIO_RNG       |
+ * |  15   | SysTick                          | IRQPRIO_SYSTICK   |
+ *
+ * @note    The control loop has the highest level, so its latency does not
+ *          depend on the routines of the other drivers, only on the sections
+ *          with the interrupts disabled (PRIMASK)
+ *
+ * @note    With uC/OS-II, the levels below CPU_CFG_KA_IPL_BOUNDARY (app_cfg.h)
+ *          are not masked by the kernel (BASEPRI), and their routines must not
+ *          call it. The ETH routine signals the tcpip thread, so it must be
+ *          at the boundary or above
+ *
+ * @note    Each driver header still accepts its own macro (e.g. -DDMA_IRQ_PRIO=10)
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+/**
+ * @brief   Levels
+ */
+///@{
+#ifndef IRQPRIO_CONTROL
+#define IRQPRIO_CONTROL             (2)
+#endif
+#ifndef IRQPRIO_ETH
+#if LWIP_UCOS2
+#define IRQPRIO_ETH                 (8)
+#else
+#define IRQPRIO_ETH                 (5)
+#endif
+#endif
+#ifndef IRQPRIO_UART
+#define IRQPRIO_UART                (6)
+#endif
+#ifndef IRQPRIO_DMA2D
+#define IRQPRIO_DMA2D               (6)
+#endif
+#ifndef IRQPRIO_SD
+#define IRQPRIO_SD                  (7)
+#endif
+#ifndef IRQPRIO_DMA
+#define IRQPRIO_DMA                 (12)
+#endif
+#ifndef IRQPRIO_RNG
+#define IRQPRIO_RNG                 (13)
+#endif
+#ifndef IRQPRIO_SYSTICK
+#define IRQPRIO_SYSTICK             (15)
+#endif
+///@}
+
+#endif // IRQPRIO_H
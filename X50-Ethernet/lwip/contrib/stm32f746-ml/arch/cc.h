@@ -11,6 +11,15 @@
 #define BYTE_ORDER LITTLE_ENDIAN
 #endif
 
+#include <stdint.h>
+
+/* Internet checksum with LDRD and an ADCS chain (arch/chksum.c). The generic
+   lwip_standard_chksum (algorithm 3) is kept for comparison */
+uint16_t stm32_chksum(const void *dataptr, int len);
+uint16_t lwip_standard_chksum(const void *dataptr, int len);
+#define LWIP_CHKSUM             stm32_chksum
+#define LWIP_CHKSUM_ALGORITHM   3
+
 #define lock_interrupts()     __disable_irq()
 #define unlock_interrupts()   __enable_irq()
 
@@ -0,0 +1,96 @@
+/**
+ * @file    chksum.c
+ *
+ * @note    Internet checksum for the Cortex-M7 (LWIP_CHKSUM in cc.h)
+ *
+ * @note    Used when the ETH checksum offload does not apply (loopback,
+ *          fragments or CHECKSUM_BY_HARDWARE=0). Same result as
+ *          lwip_standard_chksum: the sum is computed on the little endian
+ *          halfwords and the bytes are swapped when the buffer starts at an odd
+ *          address (RFC 1071)
+ *
+ * @note    The main loop reads 16 bytes with two LDRD and adds them with an
+ *          ADDS/ADCS chain into a 32 bit sum. The carry out of the chain is
+ *          added back once per block (end around carry), before SUBS changes
+ *          it. The ones complement sum of 32 bit words folds to the one of the
+ *          halfwords
+ *
+ * @note    LDRD needs a word aligned address, so a byte and a halfword are
+ *          added first when needed
+ */
+#include <stdint.h>
+#include "lwip/opt.h"
+#include "lwip/arch.h"
+
+/**
+ * @brief   Fold a 32 bit sum to 17 bits
+ */
+#define FOLD(S)                 (((S)>>16)+((S)&0xFFFF))
+
+u16_t
+stm32_chksum(const void *dataptr, int len) {
+const uint8_t *pb = (const uint8_t *) dataptr;
+const uint32_t *pl;
+uint32_t sum = 0;
+uint32_t t = 0;
+uint32_t w,a,b,c,d;
+int odd = (uint32_t) pb&1;
+int n;
+
+    if( odd && len > 0 ) {
+        t = (uint32_t) *pb++<<8;
+        len--;
+    }
+    if( ((uint32_t) pb&2) && len > 1 ) {
+        sum = *(const uint16_t *) pb;
+        pb += 2;
+        len -= 2;
+    }
+
+    pl = (const uint32_t *) pb;
+    n = len>>4;
+    if( n > 0 ) {
+        __asm volatile (
+            "1:                                 \n"
+            "   ldrd    %[a], %[b], [%[p]], #8  \n"
+            "   ldrd    %[c], %[d], [%[p]], #8  \n"
+            "   adds    %[s], %[s], %[a]        \n"
+            "   adcs    %[s], %[s], %[b]        \n"
+            "   adcs    %[s], %[s], %[c]        \n"
+            "   adcs    %[s], %[s], %[d]        \n"
+            "   adc     %[s], %[s], #0          \n"
+            "   subs    %[n], %[n], #1          \n"
+            "   bne     1b                      \n"
+            : [s] "+r" (sum), [p] "+r" (pl), [n] "+r" (n),
+              [a] "=&r" (a), [b] "=&r" (b), [c] "=&r" (c), [d] "=&r" (d)
+            :
+            : "cc", "memory"
+        );
+        len &= 15;
+    }
+
+    // Remaining words, halfword and byte
+    while( len >= 4 ) {
+        w = *pl++;
+        sum += w;
+        if( sum < w )
+            sum++;
+        len -= 4;
+    }
+    sum = FOLD(sum);
+    pb = (const uint8_t *) pl;
+    if( len >= 2 ) {
+        sum += *(const uint16_t *) pb;
+        pb += 2;
+        len -= 2;
+    }
+    if( len > 0 )
+        t |= *pb;
+    sum += t;
+
+    sum = FOLD(sum);
+    sum = FOLD(sum);
+    if( odd )
+        sum = ((sum&0xFF)<<8)|((sum>>8)&0xFF);
+    return (u16_t) sum;
+}
@@ -3,6 +3,7 @@
  * 
  * @note    Platform dependent support routines 
  */
+#include "lwip/opt.h"
 #include "lwip/arch.h"
 #include "sys_arch.h"
 /**
@@ -27,12 +28,230 @@ u32_t sys_now(void) {
 }
 
 /**
- * @brief Used to initialize random
+ * @brief Tick counter (used only by PPP to stir its random seed)
  * 
  * @note    It can not be inline'd because timeout.c does not include sys_arch.h
+ *
+ * @note    Random numbers come from the RNG (LWIP_RAND in lwipopts.h)
  * 
  * @return u32_t 
  */
 u32_t sys_jiffies(void) {
     return sys_counter;
 }
+
+#if !NO_SYS
+/**
+ * @brief   Port to uC/OS-II
+ *
+ * @note    Timeouts are in ms and converted to ticks (OS_TICKS_PER_SEC). A
+ *          timeout of 0 waits forever, as in uC/OS-II
+ */
+#include "lwip/sys.h"
+#include "lwip/debug.h"
+
+/**
+ * @brief   Mailboxes
+ */
+struct sys_mbox_s {
+    OS_EVENT    *queue;
+    void        *msgs[SYS_MBOX_SIZE];
+    int         used;
+};
+static struct sys_mbox_s mboxes[SYS_MBOX_COUNT];
+
+/**
+ * @brief   Stacks of the threads created by sys_thread_new
+ */
+///@{
+static OS_STK   threadstacks[SYS_THREAD_COUNT][SYS_THREAD_STACKSIZE/sizeof(OS_STK)]
+                __attribute__((aligned(8)));
+static int      threadcount = 0;
+///@}
+
+/**
+ * @brief   mstoticks
+ */
+static INT32U
+mstoticks(u32_t ms) {
+INT32U ticks;
+
+    if( ms == 0 )
+        return 0;
+    ticks = ((uint64_t) ms*OS_TICKS_PER_SEC+999)/1000;
+    return ticks ? ticks : 1;
+}
+
+/**
+ * @brief   elapsedms
+ *
+ * @note    ms since start (in ticks)
+ */
+static u32_t
+elapsedms(INT32U start) {
+
+    return ((uint64_t) (OSTimeGet()-start))*1000/OS_TICKS_PER_SEC;
+}
+
+void
+sys_init(void) {
+
+}
+
+sys_prot_t
+sys_arch_protect(void) {
+#if OS_CRITICAL_METHOD == 3u
+OS_CPU_SR cpu_sr = 0u;
+#endif
+
+    OS_ENTER_CRITICAL();
+    return cpu_sr;
+}
+
+void
+sys_arch_unprotect(sys_prot_t cpu_sr) {
+
+    OS_EXIT_CRITICAL();
+}
+
+err_t
+sys_sem_new(sys_sem_t *sem, u8_t count) {
+
+    *sem = OSSemCreate(count);
+    return *sem ? ERR_OK : ERR_MEM;
+}
+
+void
+sys_sem_signal(sys_sem_t *sem) {
+
+    OSSemPost(*sem);
+}
+
+u32_t
+sys_arch_sem_wait(sys_sem_t *sem, u32_t timeout) {
+INT32U start = OSTimeGet();
+INT8U err;
+
+    OSSemPend(*sem,mstoticks(timeout),&err);
+    if( err != OS_ERR_NONE )
+        return SYS_ARCH_TIMEOUT;
+    return elapsedms(start);
+}
+
+void
+sys_sem_free(sys_sem_t *sem) {
+INT8U err;
+
+    OSSemDel(*sem,OS_DEL_ALWAYS,&err);
+}
+
+err_t
+sys_mbox_new(sys_mbox_t *mbox, int size) {
+SYS_ARCH_DECL_PROTECT(lev);
+struct sys_mbox_s *m = 0;
+int i;
+
+    LWIP_ASSERT("sys_mbox_new: mailbox too large",size <= SYS_MBOX_SIZE);
+
+    SYS_ARCH_PROTECT(lev);
+    for(i=0;i<SYS_MBOX_COUNT;i++) {
+        if( !mboxes[i].used ) {
+            m = &mboxes[i];
+            m->used = 1;
+            break;
+        }
+    }
+    SYS_ARCH_UNPROTECT(lev);
+    if( m == 0 )
+        return ERR_MEM;
+
+    m->queue = OSQCreate(m->msgs,SYS_MBOX_SIZE);
+    if( m->queue == 0 ) {
+        m->used = 0;
+        return ERR_MEM;
+    }
+    *mbox = m;
+    return ERR_OK;
+}
+
+void
+sys_mbox_post(sys_mbox_t *mbox, void *msg) {
+
+    while( OSQPost((*mbox)->queue,msg) == OS_ERR_Q_FULL )
+        OSTimeDly(1);
+}
+
+err_t
+sys_mbox_trypost(sys_mbox_t *mbox, void *msg) {
+
+    return OSQPost((*mbox)->queue,msg) == OS_ERR_NONE ? ERR_OK : ERR_MEM;
+}
+
+/**
+ * @note    The interrupt routine must be between sys_arch_isr_enter and
+ *          sys_arch_isr_exit
+ */
+err_t
+sys_mbox_trypost_fromisr(sys_mbox_t *mbox, void *msg) {
+
+    return sys_mbox_trypost(mbox,msg);
+}
+
+u32_t
+sys_arch_mbox_fetch(sys_mbox_t *mbox, void **msg, u32_t timeout) {
+INT32U start = OSTimeGet();
+INT8U err;
+void *m;
+
+    m = OSQPend((*mbox)->queue,mstoticks(timeout),&err);
+    if( err != OS_ERR_NONE )
+        return SYS_ARCH_TIMEOUT;
+    if( msg ) *msg = m;
+    return elapsedms(start);
+}
+
+u32_t
+sys_arch_mbox_tryfetch(sys_mbox_t *mbox, void **msg) {
+INT8U err;
+void *m;
+
+    m = OSQAccept((*mbox)->queue,&err);
+    if( err != OS_ERR_NONE )
+        return SYS_MBOX_EMPTY;
+    if( msg ) *msg = m;
+    return 0;
+}
+
+void
+sys_mbox_free(sys_mbox_t *mbox) {
+INT8U err;
+
+    OSQDel((*mbox)->queue,OS_DEL_ALWAYS,&err);
+    (*mbox)->queue = 0;
+    (*mbox)->used  = 0;
+}
+
+/**
+ * @brief   sys_thread_new
+ *
+ * @note    prio is the uC/OS-II priority (and task id). The stack comes from
+ *          threadstacks, so stacksize must not be larger than
+ *          SYS_THREAD_STACKSIZE
+ */
+sys_thread_t
+sys_thread_new(const char *name, lwip_thread_fn thread, void *arg, int stacksize, int prio) {
+OS_STK *stack;
+INT8U err;
+
+    LWIP_ASSERT("sys_thread_new: too many threads",threadcount < SYS_THREAD_COUNT);
+    LWIP_ASSERT("sys_thread_new: stack too large",stacksize <= SYS_THREAD_STACKSIZE);
+
+    stack = threadstacks[threadcount++];
+    err = OSTaskCreate(thread,arg,&stack[SYS_THREAD_STACKSIZE/sizeof(OS_STK)-1],prio);
+    LWIP_ASSERT("sys_thread_new: OSTaskCreate failed",err == OS_ERR_NONE);
+#if OS_TASK_NAME_EN > 0u
+    OSTaskNameSet(prio,(INT8U *) name,&err);
+#endif
+    return prio;
+}
+#endif
@@ -21,4 +21,54 @@ static inline void        sys_count(void) {
     sys_counter++;
 }
 
+#if !NO_SYS
+/**
+ * @brief   Port to uC/OS-II (LWIP_UCOS2 in lwipopts.h)
+ *
+ * @note    Mutexes are semaphores (LWIP_COMPAT_MUTEX), since each uC/OS-II
+ *          mutex needs a free priority. A mailbox is a uC/OS-II queue with
+ *          its message area, taken from a static table in sys_arch.c
+ */
+#include "ucos_ii.h"
+
+/**
+ * @brief   Number and size of mailboxes and threads
+ */
+///@{
+#ifndef SYS_MBOX_COUNT
+#define SYS_MBOX_COUNT          4
+#endif
+#ifndef SYS_MBOX_SIZE
+#define SYS_MBOX_SIZE           16
+#endif
+#ifndef SYS_THREAD_COUNT
+#define SYS_THREAD_COUNT        2
+#endif
+#ifndef SYS_THREAD_STACKSIZE
+#define SYS_THREAD_STACKSIZE    4096
+#endif
+///@}
+
+typedef OS_EVENT                *sys_sem_t;
+typedef struct sys_mbox_s       *sys_mbox_t;
+typedef INT8U                   sys_thread_t;
+typedef OS_CPU_SR               sys_prot_t;
+
+#define sys_sem_valid(sem)          (*(sem) != NULL)
+#define sys_sem_set_invalid(sem)    (*(sem) = NULL)
+#define sys_mbox_valid(mbox)        (*(mbox) != NULL)
+#define sys_mbox_set_invalid(mbox)  (*(mbox) = NULL)
+
+/**
+ * @brief   Entry and exit of an interrupt routine that calls sys_*_fromisr
+ *
+ * @note    The interrupt priority must be kernel aware (CPU_CFG_KA_IPL_BOUNDARY
+ *          in app_cfg.h or lower)
+ */
+///@{
+static inline void sys_arch_isr_enter(void) { OSIntEnter(); }
+static inline void sys_arch_isr_exit(void)  { OSIntExit();  }
+///@}
+#endif
+
 #endif // SYS_ARCH_H
@@ -10,22 +10,31 @@
  */
 
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdarg.h>
 
 #include "lwip/opt.h"
 #include "lwip/def.h"
 #include "lwip/mem.h"
+#include "lwip/memp.h"
 #include "lwip/pbuf.h"
 #include "lwip/stats.h"
 #include "lwip/snmp.h"
 #include "lwip/ethip6.h"
 #include "lwip/etharp.h"
+#include "lwip/timeouts.h"
 #include "netif/ppp/pppoe.h"
+#if !NO_SYS
+#include "lwip/tcpip.h"
+#endif
 
 // Port to STM32F746xx
 #include "eth.h"
 #include "stnetif.h"
+#ifdef ETH_ZEROCOPY_RX
+#include "cache.h"
+#endif
 
 #include "debugmessages.h"
 /**
@@ -39,7 +48,7 @@ extern int verbose;
 
 //////// Implementation according instructions in savannah.gnu.org/lwip
 
-static void low_level_init(struct netif *netif);
+static err_t low_level_init(struct netif *netif);
 static struct pbuf *low_level_input(struct netif *netif);
 
 #if !LWIP_ARP
@@ -53,6 +62,19 @@ void stnetif_update_config(struct netif *netif);
 
 u8_t low_level_get_link_status(void);
 
+/**
+ * @brief   Interface counters and receive latency (stnetif_getstats)
+ */
+///@{
+static struct stnetif_stats stats;
+static uint32_t             lastirqcount = 0;
+///@}
+
+/**
+ * @brief   Descriptors and buffers used by ETH_Init
+ */
+static const ETH_BufferConfig *ethbuffers = 0;
+
 
 
 /////// lwIP Device Driver based on code generated bySTM32CubeMX
@@ -82,6 +104,169 @@ u8_t low_level_get_link_status(void);
  *     @note netif->state should point to a struct stnetif static variable
  */
 
+#ifdef ETH_ZEROCOPY_RX
+/**
+ * @brief   Zero copy reception
+ *
+ * @note    The RX descriptors point to buffers of a static pool. A received
+ *          buffer is passed up as a custom pbuf (PBUF_REF) referencing its data
+ *          and the descriptor gets a free buffer of the pool. The buffer goes back
+ *          to the pool when lwIP frees the pbuf (rxbuffer_free)
+ *
+ * @note    The pool is in the non cacheable area, like the other DMA buffers.
+ *          When it is empty, the frame is dropped and its buffers are reused
+ *
+ * @note    The free list is only used in the lwIP context (main loop), so it
+ *          needs no locking
+ */
+///@{
+#if ETH_PAD_SIZE
+#error "ETH_ZEROCOPY_RX needs ETH_PAD_SIZE=0, the DMA writes at the buffer start"
+#endif
+#if !LWIP_SUPPORT_CUSTOM_PBUF
+#error "ETH_ZEROCOPY_RX needs LWIP_SUPPORT_CUSTOM_PBUF"
+#endif
+
+#ifndef ETH_RXPOOL_COUNT
+#if IP_REASSEMBLY
+// The fragments held by reassembly keep their buffers
+#define ETH_RXPOOL_COUNT            (2*ETH_RXBUFFER_COUNT+IP_REASS_MAX_PBUFS)
+#else
+#define ETH_RXPOOL_COUNT            (2*ETH_RXBUFFER_COUNT)
+#endif
+#endif
+
+typedef struct rxbuffer_s {
+    struct pbuf_custom  pc;                 // must be the first field
+    struct rxbuffer_s   *next;              // in the free list
+    uint8_t             data[ETH_RXBUFFER_SIZE] __attribute((aligned(sizeof(uint32_t))));
+} RXBuffer;
+
+NOCACHE static RXBuffer     rxpool[ETH_RXPOOL_COUNT];
+static RXBuffer             *rxfree = 0;
+static unsigned             rxdropped = 0;
+
+/**
+ * @brief   rxbuffer_free
+ *
+ * @note    Called by pbuf_free when the last reference to the pbuf is gone
+ */
+static void
+rxbuffer_free(struct pbuf *p) {
+RXBuffer *b = (RXBuffer *) p;
+
+    b->next = rxfree;
+    rxfree  = b;
+}
+
+/**
+ * @brief   rxbuffer_alloc
+ *
+ * @note    Returns a buffer of the pool or null when it is empty
+ */
+static RXBuffer *
+rxbuffer_alloc(void) {
+RXBuffer *b;
+
+    b = rxfree;
+    if( b )
+        rxfree = b->next;
+    return b;
+}
+
+/**
+ * @brief   rxbuffer_init
+ *
+ * @note    Builds the free list and gives a pool buffer to each RX descriptor.
+ *          Must be called after ETH_Init and before ETH_Start
+ *
+ * @note    The pool buffers have ETH_RXBUFFER_SIZE bytes, so the RX buffers of
+ *          ETH_BufferConfig can not be larger. The pool must have more buffers
+ *          than the ring, to replace the ones held by lwIP
+ */
+static int
+rxbuffer_init(void) {
+ETH_DMADescriptor *desc;
+int i;
+
+    if( ethbuffers->rxsize > ETH_RXBUFFER_SIZE || ethbuffers->rxcount >= ETH_RXPOOL_COUNT )
+        return -1;
+
+    rxfree = 0;
+    for(i=0;i<ETH_RXPOOL_COUNT;i++) {
+        rxpool[i].pc.custom_free_function = rxbuffer_free;
+        rxpool[i].next = rxfree;
+        rxfree = &rxpool[i];
+    }
+
+    desc = ETH_RXDescriptors;
+    do {
+        ETH_SetRXBuffer(desc,rxbuffer_alloc()->data);
+        desc = (ETH_DMADescriptor *) desc->Buffer2NextDescAddr;
+    } while( desc != ETH_RXDescriptors );
+    return 0;
+}
+
+/**
+ * @brief   stnetif_getdropped
+ *
+ * @note    Frames dropped because the pool was empty
+ */
+unsigned
+stnetif_getdropped(void) {
+
+    return rxdropped;
+}
+///@}
+#endif
+
+#ifdef ETH_USE_PTP
+/**
+ * @brief   Timestamps for a PTP daemon
+ *
+ * @note    netif->input is called while the frame is processed, so a UDP
+ *          receive callback gets the timestamp of its own frame with
+ *          stnetif_getrxtimestamp. Likewise, udp_send queues the frame before
+ *          returning, and stnetif_gettxtimestamp waits for its timestamp
+ */
+///@{
+static ETH_PTPTime  rxtimestamp;
+static int          rxtimestampvalid = 0;
+
+/**
+ * @brief   stnetif_getrxtimestamp
+ *
+ * @note    Reception time of the frame being processed. Returns 0 or -1 when
+ *          it was not timestamped (only PTP event messages are)
+ */
+int
+stnetif_getrxtimestamp(ETH_PTPTime *t) {
+
+    if( !rxtimestampvalid )
+        return -1;
+    *t = rxtimestamp;
+    return 0;
+}
+
+/**
+ * @brief   stnetif_gettxtimestamp
+ *
+ * @note    Transmission time of the last frame sent. Waits until the DMA is
+ *          done with it. Returns 0 or -1 on timeout
+ */
+int
+stnetif_gettxtimestamp(ETH_PTPTime *t) {
+int retries = 100000;
+
+    while( ETH_GetLastTXTimeStamp(t) < 0 ) {
+        if( --retries == 0 )
+            return -1;
+    }
+    return 0;
+}
+///@}
+#endif
+
 /**
  * @brief   low_level_input
  *
@@ -99,6 +284,7 @@ u8_t low_level_get_link_status(void);
  * @return  a pbuf filled with the received packet (including MAC header)
  *          NULL on memory error
  */
+#ifndef ETH_ZEROCOPY_RX
 static struct pbuf *
 low_level_input(struct netif *netif) {
 struct pbuf *p,*q;
@@ -120,6 +306,11 @@ uint8_t *dst;
     rc = ETH_ReceiveFrame(&RxFrameInfo);
     if( rc <= 0 ) return NULL;
 
+#ifdef ETH_USE_PTP
+    rxtimestamp      = RxFrameInfo.TimeStamp;
+    rxtimestampvalid = RxFrameInfo.TimeStampValid;
+#endif
+
     segcount = RxFrameInfo.SegmentCount;
     framelength = RxFrameInfo.FrameLength;
  
@@ -132,9 +323,20 @@ uint8_t *dst;
         goto error;
     }
 
+    // Checksum error detected by the MAC (offload). Dropped, as lwIP would do
+    if( RxFrameInfo.ChecksumError ) {
+#if LWIP_STATS
+        LINK_STATS_INC(link.chkerr);
+        LINK_STATS_INC(link.drop);
+#endif
+        p = NULL;
+        goto error;
+    }
+
     // Allocate a chain of pbuf large enough to accommodate data
     p = pbuf_alloc(PBUF_RAW,framelength,PBUF_POOL);
     if( p == NULL) {
+        stats.rxnopbuf++;
 #if LWIP_STATS
         LINK_STATS_INC(link.memerr);
         LINK_STATS_INC(link.drop);
@@ -166,7 +368,7 @@ uint8_t *dst;
         dstcnt = q->len;
         dstpos = 0;
         dst = q->payload;
-        int srccnt = ETH_TXBUFFER_SIZE - srcpos;
+        int srccnt = ethbuffers->rxsize - srcpos;
         while( srccnt < dstcnt ) {
             MESSAGEV("Copying %d bytes from %p+%1d to %p+%1d\n",
                     srccnt,src,srcpos,dst,dstpos);
@@ -182,7 +384,7 @@ uint8_t *dst;
             }
             src = (uint8_t *) desc->Buffer1Addr;
             srcpos = 0;
-            srccnt = ETH_TXBUFFER_SIZE - srcpos;
+            srccnt = ethbuffers->rxsize - srcpos;
         }
         // copy remaining data
         if( dstcnt > 0 ) {
@@ -217,13 +419,103 @@ error:
     RxFrameInfo.FrameLength      = 0;
     RxFrameInfo.SegmentCount     = 0;
     // Clear flag and resume reception
-    if( ETH->DMASR&ETH_DMASR_RBUS ) {
-        ETH->DMASR = ETH_DMASR_RBUS;
-        ETH->DMARPDR = 0;
+    ETH_ResumeReception();
+
+    return p;
+}
+#else
+static struct pbuf *
+low_level_input(struct netif *netif) {
+struct pbuf *p,*q;
+ETH_DMAFrameInfo RxFrameInfo;
+ETH_DMADescriptor *desc;
+RXBuffer *b,*nb[ETH_MAX_BUFFER_COUNT];
+int segcount;
+int rc;
+uint16_t framelength;
+uint16_t len;
+int i;
+
+    MESSAGE("low_level_input (zero copy)\n");
+
+    rc = ETH_ReceiveFrame(&RxFrameInfo);
+    if( rc <= 0 ) return NULL;
+
+#ifdef ETH_USE_PTP
+    rxtimestamp      = RxFrameInfo.TimeStamp;
+    rxtimestampvalid = RxFrameInfo.TimeStampValid;
+#endif
+
+    segcount = RxFrameInfo.SegmentCount;
+    framelength = RxFrameInfo.FrameLength;
+    p = NULL;
+
+    MESSAGEV("Received a frame with %d segment(s) and %d byte(s)\n",
+        segcount,
+        framelength);
+
+    // Checksum error detected by the MAC (offload). Dropped, as lwIP would do
+    i = 0;
+    if( RxFrameInfo.ChecksumError ) {
+#if LWIP_STATS
+        LINK_STATS_INC(link.chkerr);
+        LINK_STATS_INC(link.drop);
+#endif
+        goto drop;
+    }
+
+    // Get all new buffers first. Without them, the frame is dropped
+    for(i=0;i<segcount;i++) {
+        nb[i] = rxbuffer_alloc();
+        if( nb[i] == 0 )
+            break;
+    }
+    if( framelength == 0 || i < segcount ) {
+        while( i-- > 0 )
+            rxbuffer_free(&nb[i]->pc.pbuf);
+        rxdropped++;
+        stats.rxnopbuf++;
+#if LWIP_STATS
+        LINK_STATS_INC(link.memerr);
+        LINK_STATS_INC(link.drop);
+        MIB2_STATS_NETIF_INC(netif, ifindiscards);
+#endif
+    drop:
+        // Give the same buffers back to the DMA
+        desc = RxFrameInfo.FirstSegmentDesc;
+        for(i=0;i<segcount;i++) {
+            desc->Status = ETH_DMADESCRIPTOR_STATUS_OWN;
+            desc = (ETH_DMADescriptor *) desc->Buffer2NextDescAddr;
+        }
+        goto resume;
+    }
+
+    // Each segment becomes a pbuf referencing the DMA buffer
+    desc = RxFrameInfo.FirstSegmentDesc;
+    for(i=0;i<segcount;i++) {
+        b = (RXBuffer *) ((uint8_t *) desc->Buffer1Addr-offsetof(RXBuffer,data));
+        len = framelength > ethbuffers->rxsize ? ethbuffers->rxsize : framelength;
+        framelength -= len;
+        q = pbuf_alloced_custom(PBUF_RAW,len,PBUF_REF,&b->pc,b->data,ETH_RXBUFFER_SIZE);
+        if( p )
+            pbuf_cat(p,q);
+        else
+            p = q;
+        ETH_SetRXBuffer(desc,nb[i]->data);
+        desc = (ETH_DMADescriptor *) desc->Buffer2NextDescAddr;
     }
 
+#if LWIP_STATS
+    LINK_STATS_INC(link.recv);
+#endif
+
+resume:
+    // Clear flag and resume reception
+    ETH_ResumeReception();
+
     return p;
 }
+#endif
 
 #if !LWIP_ARP
 /**
@@ -243,14 +535,138 @@ static err_t low_level_output_arp_off(struct netif *netif, struct pbuf *q, const
  * @brief   low_level_init
  *
  * @note    handles hardware initialization
+ *
+ * @note    netif->state can point to the ETH_BufferConfig given to ETH_Init
+ *          (null for ETH_BUFFERS_DEFAULT)
+ */
+
+#if !NO_SYS
+/**
+ * @brief   Reception by the tcpip thread
+ *
+ * @note    The ETH interrupt posts rxmsg to the tcpip mailbox and the thread
+ *          drains the RX ring with stnetif_input. rxposted avoids queueing a
+ *          second notification while one is waiting in the mailbox
+ */
+///@{
+static struct tcpip_callback_msg    *rxmsg = 0;
+static volatile int                 rxposted = 0;
+
+static void
+stnetif_rxthread(void *ctx) {
+
+    // Cleared before draining, so a frame received meanwhile is posted again
+    rxposted = 0;
+    stnetif_input((struct netif *) ctx);
+}
+
+static void
+stnetif_rxinterrupt(unsigned unused) {
+
+    sys_arch_isr_enter();
+    if( !rxposted ) {
+        rxposted = 1;
+        if( tcpip_callbackmsg_trycallback_fromisr(rxmsg) != ERR_OK )
+            rxposted = 0;
+    }
+    sys_arch_isr_exit();
+}
+///@}
+
+#ifdef ETH_USE_GPIO_INTERRUPT
+/**
+ * @brief   Link change by the tcpip thread
+ *
+ * @note    The PHY interrupt posts linkmsg, like rxmsg
+ */
+///@{
+static struct tcpip_callback_msg    *linkmsg = 0;
+
+static void
+stnetif_linkthread(void *ctx) {
+
+    stnetif_link((struct netif *) ctx);
+}
+
+static void
+stnetif_linkinterrupt(unsigned unused) {
+
+    sys_arch_isr_enter();
+    tcpip_callbackmsg_trycallback_fromisr(linkmsg);
+    sys_arch_isr_exit();
+}
+///@}
+#endif
+#endif
+
+/**
+ * @brief   Periodic link update
+ *
+ * @note    Without the PHY interrupt, the state is read every
+ *          STNETIF_LINKPOLLINTERVAL ms. Each read is started by ETH_PHYProcess
+ *          and collected later, so the timer does not wait for the PHY. With
+ *          the interrupt, it is only a slow check
  */
+///@{
+#ifndef STNETIF_LINKPOLLINTERVAL
+#ifdef ETH_USE_GPIO_INTERRUPT
+#define STNETIF_LINKPOLLINTERVAL    1000
+#else
+#define STNETIF_LINKPOLLINTERVAL    100
+#endif
+#endif
+
+static int linkbusy = 0;
+
+static void
+stnetif_linktimer(void *arg) {
+
+    ETH_PHYRequestUpdate();
+    stnetif_link((struct netif *) arg);
+    sys_timeout(STNETIF_LINKPOLLINTERVAL,stnetif_linktimer,arg);
+}
+
+static void
+stnetif_linkcontinue(void *arg) {
 
-static void low_level_init(struct netif *netif) {
+    linkbusy = 0;
+    stnetif_link((struct netif *) arg);
+}
+///@}
+
+static err_t low_level_init(struct netif *netif) {
 
     MESSAGE("Entering low_level_init\n");
 
+#ifdef ETH_VLAN
+    // Kept by ETH_Init, that loads it into the MAC
+    stnetif_setvlan(ETH_VLAN,ETH_VLANPRIO,0);
+#endif
+
     // Initialize device
-    ETH_Init();
+    if( ETH_Init((const ETH_BufferConfig *) netif->state) < 0 ) {
+        MESSAGE("Invalid ETH buffer configuration\n");
+        return ERR_ARG;
+    }
+    ethbuffers = ETH_GetBufferConfig();
+
+#ifdef ETH_ZEROCOPY_RX
+    // RX descriptors use buffers from the pool
+    if( rxbuffer_init() < 0 ) {
+        MESSAGE("RX buffers larger than the pool buffers or pool too small\n");
+        return ERR_ARG;
+    }
+#endif
+
+#if !NO_SYS
+    // ETH_Init clears the callbacks
+    rxmsg = tcpip_callbackmsg_new(stnetif_rxthread,netif);
+    ETH_RegisterCallback(ETH_CALLBACK_FRAMERECEIVED,stnetif_rxinterrupt);
+#ifdef ETH_USE_GPIO_INTERRUPT
+    linkmsg = tcpip_callbackmsg_new(stnetif_linkthread,netif);
+    ETH_RegisterCallback(ETH_CALLBACK_LINKSTATUSCHANGED,stnetif_linkinterrupt);
+#endif
+#endif
 
     // Set link status
     // netif->flags |= NETIF_FLAG_LINK_UP;
@@ -261,10 +677,12 @@ static void low_level_init(struct netif *netif) {
     // Start device
     ETH_Start();
 
-    // Set flags accordingly
+    // Set flags when the PHY state is read
     stnetif_link(netif);
+    sys_timeout(STNETIF_LINKPOLLINTERVAL,stnetif_linktimer,netif);
 
     MESSAGE("Exiting low_level_init\n");
+    return ERR_OK;
 }
 
 
@@ -295,6 +713,151 @@ static void low_level_init(struct netif *netif) {
  *          dropped because of memory failure (except for the TCP timers).
  */
 
+#ifdef ETH_ZEROCOPY_TX
+/**
+ * @brief   Zero copy transmission
+ *
+ * @note    Each pbuf of the chain gets a TX descriptor pointing to its payload
+ *          (ETH_TransmitBuffers). A reference to the pbuf is held in txpbuf,
+ *          indexed by the last descriptor of the frame, until the DMA is done
+ *
+ * @note    lwIP is not protected against interrupts (SYS_LIGHTWEIGHT_PROT=0),
+ *          so the pbufs are freed by stnetif_txreclaim in the lwIP context
+ *          and not by the ETH interrupt
+ *
+ * @note    Chains with more pbufs than descriptors and pbufs whose data can
+ *          change after the call (PBUF_NEEDS_COPY, e.g. PBUF_REF) are copied
+ *          into a single PBUF_RAM first
+ *
+ * @note    A pbuf larger than ETH_TXBUFFER_SIZE (jumbo frames) is split over
+ *          consecutive descriptors
+ *
+ * @note    The DMA cannot read the ITCM bus, where the flash is linked
+ *          (0x00200000) and the ITCM RAM is. PBUF_ROM pointing to the flash
+ *          (files of the HTTP server, sendfile.c) are given to the DMA thru
+ *          the AXIM alias (0x08000000), so the payload goes from the flash to
+ *          the MAC. Only data in the ITCM RAM is copied
+ */
+///@{
+#if ETH_PAD_SIZE
+#error "ETH_ZEROCOPY_TX needs ETH_PAD_SIZE=0"
+#endif
+
+#define STNETIF_DMAREADABLE(P)      ((uint32_t) (P) >= 0x00200000)
+#define STNETIF_TXSEGMENTS(L)       (((L)+ETH_TXBUFFER_SIZE-1)/ETH_TXBUFFER_SIZE)
+
+static struct pbuf  *txpbuf[ETH_MAX_BUFFER_COUNT] = { 0 };
+static int          txdirty   = 0;          // oldest descriptor not reclaimed
+static int          txpending = 0;          // descriptors given to the DMA
+
+/**
+ * @brief   stnetif_dmaaddress
+ *
+ * @note    Address of p for the DMA: the flash is read thru the AXIM alias
+ */
+static inline const void *
+stnetif_dmaaddress(const void *p) {
+uint32_t a = (uint32_t) p;
+
+    if( a >= 0x00200000 && a < 0x00300000 )
+        return (const void *) (a-0x00200000+0x08000000);
+    return p;
+}
+
+/**
+ * @brief   stnetif_txreclaim
+ *
+ * @note    Frees the pbufs of the frames already transmitted
+ */
+static void
+stnetif_txreclaim(void) {
+ETH_DMADescriptor *desc;
+
+    while( txpending > 0 ) {
+        desc = ETH_TXDescriptors+txdirty;
+        if( desc->Status&ETH_DMADESCRIPTOR_STATUS_OWN )
+            break;
+        if( txpbuf[txdirty] ) {
+            pbuf_free(txpbuf[txdirty]);
+            txpbuf[txdirty] = NULL;
+        }
+        txdirty = (txdirty+1)%ethbuffers->txcount;
+        txpending--;
+    }
+}
+///@}
+
+err_t
+stnetif_output(struct netif *netif, struct pbuf *p) {
+ETH_Buffer bufs[ETH_MAX_BUFFER_COUNT];
+struct pbuf *q,*r;
+int n,copy,last;
+unsigned pos,k;
+
+    MESSAGE("Entering stnet output (zero copy)\n");
+
+    stnetif_txreclaim();
+
+    n = 0;
+    copy = 0;
+    for(q=p; q ; q = q->next ) {
+        n += STNETIF_TXSEGMENTS(q->len);
+        if( PBUF_NEEDS_COPY(q) ) copy = 1;
+        if( q->len && !STNETIF_DMAREADABLE(q->payload) ) copy = 1;
+    }
+    if( n == 0 )
+        return ERR_OK;
+
+    if( copy || n > ethbuffers->txcount ) {
+        r = pbuf_clone(PBUF_RAW,PBUF_RAM,p);
+        if( r == NULL ) {
+            stats.txerrors++;
+            return ERR_MEM;
+        }
+        n = STNETIF_TXSEGMENTS(r->len);
+    } else {
+        r = p;
+        pbuf_ref(r);
+    }
+
+    if( n > ethbuffers->txcount-txpending ) {
+        MESSAGE("Descriptors not free\n");
+        pbuf_free(r);
+        stats.txerrors++;
+        return ERR_USE;
+    }
+
+    // A pbuf larger than a descriptor buffer (jumbo frame) takes several
+    n = 0;
+    for(q=r; q ; q = q->next ) {
+        for(pos=0;pos<q->len;pos+=k) {
+            k = q->len-pos;
+            if( k > ETH_TXBUFFER_SIZE )
+                k = ETH_TXBUFFER_SIZE;
+            bufs[n].data = stnetif_dmaaddress((uint8_t *) q->payload+pos);
+            bufs[n].size = k;
+            n++;
+        }
+    }
+
+    MESSAGEV("Starting transmission of %d buffer(s)\n",n);
+    last = ETH_TransmitBuffers(bufs,n);
+    if( last < 0 ) {
+        pbuf_free(r);
+        stats.txerrors++;
+        return ERR_USE;
+    }
+    txpbuf[last] = r;
+    txpending += n;
+
+#if LWIP_STATS
+    LINK_STATS_INC(link.xmit);
+#endif
+
+    MESSAGE("Exiting stnet_output\n");
+    return ERR_OK;
+}
+#else
 err_t
 stnetif_output(struct netif *netif, struct pbuf *p) {
 struct pbuf *q;
@@ -325,7 +888,8 @@ err_t rc;
      * Copy data from all pbufs to one or more DMA buffers
      * concatenating them
      */
-    desc = ETH_TXDescriptors;                   // first DMA descriptor
+    ETH_DMADescriptor *first = ETH_TXCurrent;
+    desc = first;                               // first free DMA descriptor
     uint16_t framelength = 0;                   // frame size
     uint8_t *dst = (uint8_t *)desc->Buffer1Addr;// first DMA buffer;
     uint16_t dstpos = 0;                        // offset
@@ -342,7 +906,7 @@ err_t rc;
         uint16_t srccnt = q->len;
         uint16_t srcpos = 0;
         uint8_t *src = q->payload;
-        int dstcnt = ETH_TXBUFFER_SIZE - dstpos;
+        int dstcnt = ethbuffers->txsize - dstpos;
         // Transfer to DMA buffers
         while( dstcnt < srccnt ) {
             memcpy(dst + dstpos, src + srcpos, dstcnt );
@@ -352,7 +916,7 @@ err_t rc;
             srcpos += dstcnt;
             // Get next DMA buffer
             desc = (ETH_DMADescriptor *) desc->Buffer2NextDescAddr;
-            if( desc == ETH_TXDescriptors )
+            if( desc == first )
                 break;
             if( (desc->Status&ETH_DMADESCRIPTOR_STATUS_OWN) ) {
                 rc = ERR_USE;
@@ -360,7 +924,7 @@ err_t rc;
             }
             dst = (uint8_t *) desc->Buffer1Addr;
             dstpos = 0;
-            dstcnt = ETH_TXBUFFER_SIZE - dstpos;
+            dstcnt = ethbuffers->txsize - dstpos;
         }
         // copy remaining data
         if( desc ) {
@@ -373,7 +937,10 @@ err_t rc;
 
     MESSAGE("Starting transmission\n");
     /* Start MAC transmit here */
-    ETH_TransmitFrame(ETH_TXDescriptors, framelength);
+    if( ETH_TransmitFrame(first, framelength) < 0 ) {
+        rc = ERR_USE;
+        goto error;
+    }
 
 #if MIB2_STATS
     MIB2_STATS_NETIF_ADD(netif, ifoutoctets, p->tot_len);
@@ -396,14 +963,91 @@ err_t rc;
     LINK_STATS_INC(link.xmit);
 #endif
 
-    unlock_interrupts();
     rc = ERR_OK;
 
-    // An error occurred
+    // An error occurred (ring full)
 error:
+    if( rc != ERR_OK )
+        stats.txerrors++;
+    unlock_interrupts();
     MESSAGE("Exiting stnet_output\n");
     return rc;
 }
+#endif
+
+/**
+ * @brief   stnetif_addlatency
+ *
+ * @note    Adds a measurement in cycles to the histogram. Bucket 0 counts less
+ *          than 256 cycles, bucket k from 2^(k+7) to 2^(k+8)-1 and the last one
+ *          the rest
+ */
+static void
+stnetif_addlatency(uint32_t d) {
+int k;
+
+    k = d < 256 ? 0 : 24-(int) __CLZ(d);
+    if( k >= STNETIF_LATENCY_BUCKETS )
+        k = STNETIF_LATENCY_BUCKETS-1;
+    stats.latency[k]++;
+    if( stats.latencycount == 0 || d < stats.latencymin )
+        stats.latencymin = d;
+    if( d > stats.latencymax )
+        stats.latencymax = d;
+    stats.latencytotal += d;
+    stats.latencycount++;
+}
+
+#if IP_REASSEMBLY && IPFRAG_STATS && MEMP_STATS
+/**
+ * @brief   __wrap_ip_reass_tmr
+ *
+ * @note    Called by the lwIP timer instead of ip_reass_tmr (the linker option
+ *          --wrap=ip_reass_tmr in the Makefile). lwIP has no counter for the
+ *          reassembly timeouts. The timer only frees the datagrams that timed
+ *          out, so they are the reassembly entries (MEMP_REASSDATA) it freed
+ */
+void __real_ip_reass_tmr(void);
+
+void
+__wrap_ip_reass_tmr(void) {
+mem_size_t used = memp_pools[MEMP_REASSDATA]->stats->used;
+
+    __real_ip_reass_tmr();
+    stats.reasstimeouts += used-memp_pools[MEMP_REASSDATA]->stats->used;
+}
+#endif
+
+/**
+ * @brief   stnetif_getstats
+ *
+ * @note    The reassembly counters, except the timeouts, are the ones of lwIP
+ */
+void
+stnetif_getstats(struct stnetif_stats *st) {
+
+    *st = stats;
+#if IP_REASSEMBLY && IPFRAG_STATS
+    st->reassfragments = lwip_stats.ip_frag.recv;
+    st->reassdropped   = lwip_stats.ip_frag.drop;
+    st->reassoverflow  = lwip_stats.ip_frag.memerr;
+#endif
+}
+
+/**
+ * @brief   stnetif_resetstats
+ *
+ * @note    Also resets the ETH driver counters
+ */
+void
+stnetif_resetstats(void) {
+
+    memset(&stats,0,sizeof(stats));
+#if IP_REASSEMBLY && IPFRAG_STATS
+    memset(&lwip_stats.ip_frag,0,sizeof(lwip_stats.ip_frag));
+#endif
+    ETH_ResetStatistics();
+}
 
 /**
  * @brief stnetif_input
@@ -416,29 +1060,181 @@ void
 stnetif_input(struct netif *netif) {
 //struct stnetif *stnetif;
 struct pbuf *p;
+int n;
+uint32_t start = DWT->CYCCNT;
+uint32_t irqcount = ETH_RXIRQCount;
 
     MESSAGE("Entering stnet input\n");
 
+    // Measured from the receive interrupt, when there was one since the
+    // last call. Otherwise (polling) only the processing time
+    if( irqcount != lastirqcount ) {
+        start = ETH_RXIRQTime;
+        lastirqcount = irqcount;
+    }
+
     //stnetif = netif->state;
 
-    /* move received packet into a new pbuf */
-    p = low_level_input(netif);
-    /* if no packet could be read, silently ignore this */
-    if (p != NULL) {
+#ifdef ETH_ZEROCOPY_TX
+    /* free pbufs already transmitted */
+    stnetif_txreclaim();
+#endif
+
+    /* drain all frames already in the RX ring, at most one full ring */
+    for(n=0;n<ethbuffers->rxcount;n++) {
+        /* move received packet into a new pbuf */
+        p = low_level_input(netif);
+        /* if no packet could be read, silently ignore this */
+        if (p == NULL)
+            break;
         MESSAGE("Passing to ethernet_input\n");
         /* pass all packets to ethernet_input, which decides what packets it supports */
         if (netif->input(p, netif) != ERR_OK) {
           LWIP_DEBUGF(NETIF_DEBUG, ("ethernetif_input: IP input error\n"));
+          stats.rxinputerrors++;
           pbuf_free(p);
           p = NULL;
         }
     }
 
+    if( n > 0 )
+        stnetif_addlatency(DWT->CYCCNT-start);
+
     MESSAGE("Exiting stnet input\n");
 
 }
 
 
+#if ETHARP_SUPPORT_VLAN
+/**
+ * @brief   VLAN of the interface (stnetif_setvlan)
+ *
+ * @note    vlanid 0 sends untagged frames and accepts all VLANs
+ */
+///@{
+static uint16_t vlanid   = 0;
+static uint8_t  vlanprio = 0;
+///@}
+
+/**
+ * @brief   stnetif_setvlan
+ *
+ * @note    Frames are sent with the tag vid (1-4094) and priority prio (0-7,
+ *          PCP). Tagged frames of other VLANs are dropped by the driver before
+ *          reaching lwIP. With untagged set, untagged frames are received too
+ *
+ * @note    Returns 0 or -1 when vid or prio are not valid
+ */
+int
+stnetif_setvlan(uint16_t vid, uint8_t prio, int untagged) {
+
+    if( prio > 7 || ETH_SetVLANFilter(vid,untagged?ETH_VLAN_ACCEPTUNTAGGED:0) < 0 )
+        return -1;
+    vlanid   = vid;
+    vlanprio = prio;
+    return 0;
+}
+
+/**
+ * @brief   stnetif_vlan_set (LWIP_HOOK_VLAN_SET)
+ *
+ * @note    Returns the tag (PCP and VID) to insert or -1 for no tag
+ */
+s32_t
+stnetif_vlan_set(struct netif *netif, struct pbuf *p, const struct eth_addr *src,
+                 const struct eth_addr *dst, u16_t eth_type) {
+
+    LWIP_UNUSED_ARG(netif);
+    LWIP_UNUSED_ARG(p);
+    LWIP_UNUSED_ARG(src);
+    LWIP_UNUSED_ARG(dst);
+    LWIP_UNUSED_ARG(eth_type);
+    if( vlanid == 0 )
+        return -1;
+    return ((s32_t) vlanprio<<13)|vlanid;
+}
+
+/**
+ * @brief   stnetif_vlan_check (LWIP_HOOK_VLAN_CHECK)
+ *
+ * @note    Tagged frames of other VLANs are already dropped by eth.c. This
+ *          check covers the filter disabled while the id is changed
+ */
+int
+stnetif_vlan_check(struct netif *netif, const struct eth_hdr *ethhdr,
+                   const struct eth_vlan_hdr *vlanhdr) {
+
+    LWIP_UNUSED_ARG(netif);
+    LWIP_UNUSED_ARG(ethhdr);
+    return vlanid == 0 || VLAN_ID(vlanhdr) == vlanid;
+}
+#endif
+
+#if LWIP_IGMP || (LWIP_IPV6 && LWIP_IPV6_MLD)
+/**
+ * @brief   stnetif_setmacfilter
+ *
+ * @note    Adds or removes a multicast MAC address in the ETH filters
+ */
+static err_t
+stnetif_setmacfilter(const uint8_t macaddr[6], enum netif_mac_filter_action action) {
+
+    if( action == NETIF_ADD_MAC_FILTER )
+        ETH_AddMulticastAddress(macaddr);
+    else
+        ETH_RemoveMulticastAddress(macaddr);
+    return ERR_OK;
+}
+#endif
+
+#if LWIP_IGMP
+/**
+ * @brief   stnetif_igmp_mac_filter
+ *
+ * @note    Called by IGMP when joining or leaving a group. The MAC address is
+ *          01:00:5E followed by the lower 23 bits of the group (RFC 1112)
+ */
+static err_t
+stnetif_igmp_mac_filter(struct netif *netif, const ip4_addr_t *group,
+                        enum netif_mac_filter_action action) {
+uint8_t macaddr[6];
+uint32_t addr = lwip_ntohl(ip4_addr_get_u32(group));
+
+    LWIP_UNUSED_ARG(netif);
+    macaddr[0] = 0x01;
+    macaddr[1] = 0x00;
+    macaddr[2] = 0x5E;
+    macaddr[3] = (addr>>16)&0x7F;
+    macaddr[4] = (addr>>8)&0xFF;
+    macaddr[5] = addr&0xFF;
+    return stnetif_setmacfilter(macaddr,action);
+}
+#endif /* LWIP_IGMP */
+
+#if LWIP_IPV6 && LWIP_IPV6_MLD
+/**
+ * @brief   stnetif_mld_mac_filter
+ *
+ * @note    Called by MLD. The MAC address is 33:33 followed by the last 32 bits
+ *          of the group (RFC 2464)
+ */
+static err_t
+stnetif_mld_mac_filter(struct netif *netif, const ip6_addr_t *group,
+                       enum netif_mac_filter_action action) {
+uint8_t macaddr[6];
+uint32_t addr = lwip_ntohl(group->addr[3]);
+
+    LWIP_UNUSED_ARG(netif);
+    macaddr[0] = 0x33;
+    macaddr[1] = 0x33;
+    macaddr[2] = (addr>>24)&0xFF;
+    macaddr[3] = (addr>>16)&0xFF;
+    macaddr[4] = (addr>>8)&0xFF;
+    macaddr[5] = addr&0xFF;
+    return stnetif_setmacfilter(macaddr,action);
+}
+#endif /* LWIP_IPV6 && LWIP_IPV6_MLD */
+
 /**
  * @brief   stnetif_init
  *
@@ -463,9 +1259,17 @@ struct pbuf *p;
 err_t
 stnetif_init(struct netif *netif) {
 uint8_t macaddr[6];
+err_t err;
 
     MESSAGE("Entering netif_init\n");
 
+    // Cycle counter for the latency histogram (as in Profile_Init)
+    if( (DWT->CTRL&DWT_CTRL_CYCCNTENA_Msk) == 0 ) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->LAR = 0xC5ACCE55;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+
 #if LWIP_NETIF_HOSTNAME
     /* Initialize interface hostname */
     netif->hostname = "lwip";
@@ -504,6 +1308,13 @@ uint8_t macaddr[6];
                         | NETIF_FLAG_ETHERNET
                         | NETIF_FLAG_IGMP;
 
+#if LWIP_IGMP
+    netif_set_igmp_mac_filter(netif,stnetif_igmp_mac_filter);
+#endif
+#if LWIP_IPV6 && LWIP_IPV6_MLD
+    netif_set_mld_mac_filter(netif,stnetif_mld_mac_filter);
+#endif
+
     ETH_GetMACAddressAsVector(macaddr);
     SMEMCPY(netif->hwaddr, macaddr, ETH_HWADDR_LEN);
     netif->hwaddr_len = ETH_HWADDR_LEN;
@@ -522,7 +1333,9 @@ uint8_t macaddr[6];
     etharp_cleanup_netif(netif);
 
     // Do hardware initialization
-    low_level_init(netif);
+    err = low_level_init(netif);
+    if( err != ERR_OK )
+        return err;
 
     // Set link status
     netif->flags |= NETIF_FLAG_LINK_UP;
@@ -621,8 +1434,7 @@ uint8_t macaddr[6];
 
 u8_t low_level_get_link_status(void) {
 
-    ETH_UpdateLinkStatus();
-    return ETH_IsLinkUp();
+    return ETH_GetLinkState();
 
 }
 
@@ -663,6 +1475,7 @@ uint32_t s;
 #endif
 
     message("Link status = %s\n",ETH_GetLinkInfoString());
+    message("Frames dropped by the MAC = %u\n",ETH_GetDroppedFrames());
 
 }
 
@@ -670,13 +1483,30 @@ uint32_t s;
 /**
  * @brief   stnetif_link
  *
- * @note    check link status
+ * @note    Advances the PHY update (ETH_PHYProcess) and sets the netif link
+ *          when it changed. It does not wait for the PHY: while a MDIO read
+ *          is in progress, it is called again by a 1 ms timeout
+ *
+ * @note    A link down followed by a link up between two updates is passed
+ *          to lwIP as both events
  */
 void stnetif_link(struct netif *netif) {
 u8_t up;
+int rc;
 
     MESSAGE("stnet link\n");
 
+    rc = ETH_PHYProcess();
+    if( rc == ETH_PHY_BUSY ) {
+        if( !linkbusy ) {
+            linkbusy = 1;
+            sys_timeout(1,stnetif_linkcontinue,netif);
+        }
+        return;
+    }
+    if( rc != ETH_PHY_CHANGED )
+        return;
+
     up = low_level_get_link_status();
 
     if( up ) {
@@ -685,14 +1515,16 @@ u8_t up;
         MESSAGE("Link is down\n");
     }
 
+    if( netif_is_link_up(netif)
+     && (!up || (ETH_GetPHYEvents()&ETH_PHY_EVENT_LINKDOWN)) ) {
+        // If link is down (or was down) but netif state is link_up
+        // set link down in netif
+        netif_set_link_down(netif);
+    }
     if( up&&!netif_is_link_up(netif) ) {
         // If link is up but netif state is link_down
         // set link up in netif
         netif_set_link_up(netif);
-    } else if( !up&&netif_is_link_up(netif) ) {
-        // If link is down but netif state is link_up
-        // set link down in netif
-        netif_set_link_down(netif);
     }
 
     up = netif_is_link_up(netif);
@@ -738,8 +1570,7 @@ u8_t up;
 void stnetif_update_config(struct netif *netif) {
 
     if( netif_is_link_up(netif) ) {
-        // Update configuration (Speed/Duplex)
-        ETH_UpdateLinkStatus();
+        // Speed and duplex mode were set by ETH_PHYProcess
 
         /* Restart MAC interface */
         ETH_Start();
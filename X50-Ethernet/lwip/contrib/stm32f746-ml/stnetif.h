@@ -14,10 +14,16 @@
 /* Exported functions ------------------------------------------------------- */
 err_t       stnetif_init(struct netif *netif);
 
-// The functions below must be called in the main loop
+// The functions below must be called in the main loop (NO_SYS) or in the
+// tcpip thread
 void        stnetif_input(struct netif *netif);
 void        stnetif_link(struct netif *netif);
 
+#if ETHARP_SUPPORT_VLAN
+// 802.1Q VLAN of the interface (see lwipopts.h)
+int         stnetif_setvlan(uint16_t vid, uint8_t prio, int untagged);
+#endif
+
 //
 // Default callback routines 
 // They must be defined by the netif_set_{link,remove,status}_callback functions
@@ -36,6 +42,44 @@ void stnetif_status_callback(struct netif *netif);
 void stnetif_remove_callback(struct netif *netif);
 #endif
 
+/**
+ * @brief   Interface statistics (stnetif_getstats)
+ *
+ * @note    The latency is counted in cycles (DWT->CYCCNT) from the receive
+ *          interrupt to the end of stnetif_input, or in polling mode only the
+ *          time in stnetif_input. Bucket 0 counts less than 256 cycles and
+ *          bucket k from 2^(k+7) to 2^(k+8)-1
+ */
+#define STNETIF_LATENCY_BUCKETS     16
+struct stnetif_stats {
+    uint32_t    rxnopbuf;                   // no pbuf or RX buffer, frame dropped
+    uint32_t    rxinputerrors;              // netif->input failed
+    uint32_t    txerrors;                   // no descriptor or memory for a frame
+    uint32_t    reassfragments;             // fragments given to IP reassembly
+    uint32_t    reassdropped;               // fragments dropped by reassembly
+    uint32_t    reassoverflow;              // no room in IP_REASS_MAX_PBUFS
+    uint32_t    reasstimeouts;              // datagrams not completed in IP_REASS_MAXAGE
+    uint32_t    latencycount;
+    uint32_t    latencymin;
+    uint32_t    latencymax;
+    uint64_t    latencytotal;
+    uint32_t    latency[STNETIF_LATENCY_BUCKETS];
+};
+void        stnetif_getstats(struct stnetif_stats *st);
+void        stnetif_resetstats(void);
+
+#ifdef ETH_ZEROCOPY_RX
+// Frames dropped because there was no free RX buffer
+unsigned    stnetif_getdropped(void);
+#endif
+
+#ifdef ETH_USE_PTP
+#include "eth.h"
+// IEEE 1588 timestamps of the frame being received and of the last one sent
+int         stnetif_getrxtimestamp(ETH_PTPTime *t);
+int         stnetif_gettxtimestamp(ETH_PTPTime *t);
+#endif
+
 // For debug
 void stnetif_printstatus(void);
 #endif
@@ -0,0 +1,80 @@
+/**
+ * @file    lwipmem.c
+ *
+ * @note    lwIP heap on top of the buddy allocator
+ *
+ * @note    With LWIP_MEM_BUDDY, lwIP is compiled with MEM_LIBC_MALLOC and
+ *          mem_malloc/mem_free call these routines instead of using ram_heap.
+ *          Allocation and freeing take a fixed time, independent of the
+ *          fragmentation of the heap. The fixed size objects (PCBs, segments,
+ *          pbufs of the pool) stay in the memp pools
+ *
+ * @note    Not reentrant. Like the rest of lwIP (NO_SYS=1), only used from the
+ *          main loop
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "lwipopts.h"
+#include "buddy.h"
+#include "lwipmem.h"
+
+#if LWIP_MEM_BUDDY
+
+/**
+ * @brief   Area and pool
+ */
+///@{
+static char lwipmemarea[LWIP_MEM_BUDDYSIZE]
+            __attribute__((section(".lwip.buddy"),aligned(LWIP_MEM_BUDDYMIN)));
+static POOL lwipmempool = 0;
+///@}
+
+/**
+ * @brief   LWIPMem_Init
+ *
+ * @note    Creates the pool. Must be called before lwip_init. Returns 0 or -1
+ */
+int
+LWIPMem_Init(void) {
+
+    lwipmempool = Buddy_CreatePool(lwipmemarea,sizeof(lwipmemarea),LWIP_MEM_BUDDYMIN);
+    return lwipmempool ? 0 : -1;
+}
+
+/**
+ * @brief   LWIPMem_Malloc
+ */
+void *
+LWIPMem_Malloc(size_t size) {
+
+    if( lwipmempool == 0 || size == 0 )
+        return 0;
+    return Buddy_AllocFrom(lwipmempool,size);
+}
+
+/**
+ * @brief   LWIPMem_Calloc
+ */
+void *
+LWIPMem_Calloc(size_t n, size_t size) {
+void *p;
+
+    p = LWIPMem_Malloc(n*size);
+    if( p )
+        memset(p,0,n*size);
+    return p;
+}
+
+/**
+ * @brief   LWIPMem_Free
+ */
+void
+LWIPMem_Free(void *p) {
+
+    if( p )
+        Buddy_FreeTo(lwipmempool,p);
+}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef LWIPMEM_H
+#define LWIPMEM_H
+/**
+ * @file    lwipmem.h
+ *
+ * @note    lwIP heap on top of the buddy allocator (LWIP_MEM_BUDDY in lwipopts.h)
+ *
+ * @note    The area is in SDRAM (.lwip.buddy section). Blocks are rounded up to
+ *          a power of 2, so the area is larger than the MEM_SIZE it replaces
+ */
+
+#include <stddef.h>
+
+/**
+ * @brief   Size of the area and minimal block size (both powers of 2)
+ */
+///@{
+#ifndef LWIP_MEM_BUDDYSIZE
+#define LWIP_MEM_BUDDYSIZE          (512*1024)
+#endif
+#ifndef LWIP_MEM_BUDDYMIN
+#define LWIP_MEM_BUDDYMIN           64
+#endif
+///@}
+
+int   LWIPMem_Init(void);
+void *LWIPMem_Malloc(size_t size);
+void *LWIPMem_Calloc(size_t n, size_t size);
+void  LWIPMem_Free(void *p);
+
+#endif // LWIPMEM_H
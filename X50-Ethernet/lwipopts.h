@@ -3,8 +3,10 @@
 
 /*----- WITH_RTOS disabled (Since FREERTOS is not set) -----*/
 #define WITH_RTOS 0
-/*----- CHECKSUM_BY_HARDWARE enabled -----*/
+/*----- CHECKSUM_BY_HARDWARE enabled (also used by eth.c) -----*/
+#ifndef CHECKSUM_BY_HARDWARE
 #define CHECKSUM_BY_HARDWARE    1
+#endif
 // Needed for netif_poll
 #define LWIP_NETIF_LOOPBACK     1
 
@@ -15,25 +17,195 @@
 #define LWIP_UDP                1
 #define LWIP_ICMP               1
 
-//#define LWIP_TCP              1
+#define LWIP_TCP                1
 //#define LWIP_DNS              1
 
+/*----- TCP profile -----*/
+/*
+ * LWIP_TCP_THROUGHPUT=1: MSS of a full Ethernet frame, 64 segment receive window
+ * (window scaling), 32 segment send buffer. The pools and the heap (about 350 KB)
+ * do not fit in the 320 KB of SRAM. They are placed in SDRAM (LWIP_MEM_SECTIONS).
+ * LWIP_TCP_THROUGHPUT=0: small lwIP defaults
+ */
+#ifndef LWIP_TCP_THROUGHPUT
+#define LWIP_TCP_THROUGHPUT     1
+#endif
+
+#if LWIP_TCP_THROUGHPUT
+#define TCP_MSS                 1460
+#define LWIP_WND_SCALE          1
+#define TCP_RCV_SCALE           1
+#define TCP_WND                 (64*TCP_MSS)
+#define TCP_SND_BUF             (32*TCP_MSS)
+#define TCP_SND_QUEUELEN        (4*TCP_SND_BUF/TCP_MSS)
+#define TCP_SNDLOWAT            (TCP_SND_BUF/2)
+#define TCP_SNDQUEUELOWAT       (TCP_SND_QUEUELEN/2)
+#define MEMP_NUM_TCP_PCB        8
+#define MEMP_NUM_TCP_SEG        TCP_SND_QUEUELEN
+/* The whole receive window must fit in the pool, plus the fragments held by reassembly */
+#define PBUF_POOL_SIZE          (96+IP_REASS_MAX_PBUFS)
+/* tcp_write copies the data to be sent into the heap */
+#define MEM_SIZE                (192*1024)
+#else
+#define PBUF_POOL_SIZE          (16+IP_REASS_MAX_PBUFS)
+#endif
+
+/*----- IP reassembly -----*/
+/*
+ * Datagrams up to IP_REASS_MAXSIZE bytes (16 KB are 12 fragments of 1480 bytes)
+ * are reassembled, IP_REASS_DATAGRAMS at a time. The fragments stay in the pbufs
+ * where they were received until the datagram is complete or IP_REASS_MAXAGE
+ * seconds pass. IP_REASS_MAX_PBUFS is added to the pbuf pool (and to the RX pool
+ * of stnetif.c with ETH_ZEROCOPY_RX), so reassembly has its own share of buffers
+ * and does not take the TCP receive window. With LWIP_MEM_SECTIONS, they are in
+ * SDRAM. When the share is full, the oldest datagram is dropped
+ */
+#define IP_REASSEMBLY           1
+#ifndef IP_REASS_MAXSIZE
+#define IP_REASS_MAXSIZE        (16*1024)
+#endif
+#ifndef IP_REASS_DATAGRAMS
+#define IP_REASS_DATAGRAMS      2
+#endif
+#define IP_REASS_MAX_PBUFS      (IP_REASS_DATAGRAMS*((IP_REASS_MAXSIZE+1479)/1480))
+#define MEMP_NUM_REASSDATA      IP_REASS_DATAGRAMS
+#define IP_REASS_MAXAGE         3
+#define IP_REASS_FREE_OLDEST    1
+
+/*----- Placement of lwIP memory -----*/
+/*
+ * LWIP_MEM_SECTIONS=1: the heap (ram_heap) and each memp pool are put in their own
+ * section (.lwip.<name>). The linker script places the small control blocks
+ * (RAW, UDP and TCP PCBs, timeouts) in DTCM and all the others (heap, pbuf pool,
+ * segments) in SDRAM.
+ * LWIP_MEM_SECTIONS=0: all in .bss (SRAM)
+ */
+#ifndef LWIP_MEM_SECTIONS
+#define LWIP_MEM_SECTIONS       1
+#endif
+
+#if LWIP_MEM_SECTIONS
+#define LWIP_DECLARE_MEMORY_ALIGNED(variable_name, size) \
+        u8_t variable_name[LWIP_MEM_ALIGN_BUFFER(size)] \
+        __attribute__((section(".lwip." #variable_name)))
+#endif
+
+/*
+ * LWIP_MEM_BUDDY=1: mem_malloc uses the buddy allocator (lwipmem.c) instead of
+ * the lwIP heap. LWIPMem_Init must be called before lwip_init
+ */
+#ifndef LWIP_MEM_BUDDY
+#define LWIP_MEM_BUDDY          0
+#endif
+
+#if LWIP_MEM_BUDDY
+#include "lwipmem.h"
+#define MEM_LIBC_MALLOC         1
+#define mem_clib_malloc         LWIPMem_Malloc
+#define mem_clib_free           LWIPMem_Free
+#define mem_clib_calloc         LWIPMem_Calloc
+#endif
+
+
+/*
+ * Random numbers from the RNG (rng.c) for the initial local ports, the DNS ids
+ * and the TCP initial sequence numbers (a random ISN for each connection).
+ * RNG_Init must be called before lwip_init
+ */
+#include "rng.h"
+#define LWIP_RAND()             RNG_GetWord()
+#define LWIP_HOOK_TCP_ISN(local_ip,local_port,remote_ip,remote_port) RNG_GetWord()
+
+
+/*
+ * 802.1Q VLAN. With ETH_VLAN defined as the VLAN id (e.g. -DETH_VLAN=100),
+ * frames are sent tagged with it and priority ETH_VLANPRIO, and tagged frames
+ * of other VLANs are dropped by the driver (eth.c), before any copy. The hooks
+ * are in stnetif.c. stnetif_setvlan changes the VLAN at run time
+ */
+#ifdef ETH_VLAN
+#include <stdint.h>
+#ifndef ETH_VLANPRIO
+#define ETH_VLANPRIO            0
+#endif
+struct netif;
+struct pbuf;
+struct eth_addr;
+struct eth_hdr;
+struct eth_vlan_hdr;
+int32_t stnetif_vlan_set(struct netif *netif, struct pbuf *p, const struct eth_addr *src,
+                         const struct eth_addr *dst, uint16_t eth_type);
+int     stnetif_vlan_check(struct netif *netif, const struct eth_hdr *ethhdr,
+                           const struct eth_vlan_hdr *vlanhdr);
+#define ETHARP_SUPPORT_VLAN     1
+#define LWIP_HOOK_VLAN_SET(netif,p,src,dst,eth_type)    stnetif_vlan_set(netif,p,src,dst,eth_type)
+#define LWIP_HOOK_VLAN_CHECK(netif,eth_hdr,vlan_hdr)    stnetif_vlan_check(netif,eth_hdr,vlan_hdr)
+#endif
+
 
 /*----- Value in opt.h for MEMP_NUM_SYS_TIMEOUT: (LWIP_TCP + IP_REASSEMBLY + LWIP_ARP + (2*LWIP_DHCP) + LWIP_AUTOIP + LWIP_IGMP + LWIP_DNS + (PPP_SUPPORT*6*MEMP_NUM_PPP_PCB) + (LWIP_IPV6 ? (1 + LWIP_IPV6_REASS + LWIP_IPV6_MLD) : 0)) -*/
 //#define MEMP_NUM_SYS_TIMEOUT 10
+/* Link timer and MDIO continuation of stnetif.c, Network_Poll of main.c and tftpd.c */
+#define MEMP_NUM_SYS_TIMEOUT    (LWIP_NUM_SYS_TIMEOUT_INTERNAL+4)
 
 #define LWIP_CALLBACK_API       1
 
+/*
+ * Reference pbufs of tcp_write without copy (one per segment of mqttpub.c in
+ * flight) and of the applications (opt.h: 16), plus a send buffer of segments
+ * of sendfile.c. When they run out, sendfile.c retries at the next ACK
+ */
+#define MEMP_NUM_PBUF           (32+TCP_SND_BUF/TCP_MSS)
+
+/*----- HTTP server (webui.c) -----*/
+/*
+ * Files are generated by tools/mkwebfs with the headers included (Content-Length
+ * for static files), so HTTP/1.1 connections are kept alive. The SSI tags are
+ * replaced by their values
+ */
+#define LWIP_HTTPD_CGI                      1
+#define LWIP_HTTPD_SSI                      1
+#define LWIP_HTTPD_SSI_INCLUDE_TAG          0
+#define LWIP_HTTPD_SUPPORT_11_KEEPALIVE     1
+#define HTTPD_FSDATA_FILE                   "webfs_data.h"
+
 /*-----------------------------------------------------------------------------*/
 /* LwIP Stack Parameters (modified compared to initialization value in opt.h) -*/
 /*----- Value in opt.h for LWIP_DHCP: 0 -----*/
 #define LWIP_DHCP 0
+/*----- Value in opt.h for LWIP_IGMP: 0 -----*/
+/*
+ * Groups joined with igmp_joingroup are programmed in the ETH multicast
+ * filters (perfect filters and hash table) by stnetif_igmp_mac_filter
+ */
+#define LWIP_IGMP 1
 
 ////
+/*----- lwIP with uC/OS-II -----*/
+/*
+ * LWIP_UCOS2=1: lwIP runs in its tcpip thread under uC/OS-II (arch/sys_arch.c),
+ * with higher priority than the application tasks. The ETH interrupt posts the
+ * received frames to the thread (stnetif.c).
+ * LWIP_UCOS2=0: NO_SYS, lwIP is polled in the main loop
+ */
+#ifndef LWIP_UCOS2
+#define LWIP_UCOS2              0
+#endif
+
+#if LWIP_UCOS2
+#define NO_SYS                  0
+#define SYS_LIGHTWEIGHT_PROT    1
+#define LWIP_COMPAT_MUTEX       1
+#define TCPIP_THREAD_NAME       "tcpip"
+#define TCPIP_THREAD_PRIO       5
+#define TCPIP_THREAD_STACKSIZE  4096
+#define TCPIP_MBOX_SIZE         16
+#else
 /*----- Value in opt.h for NO_SYS: 0 -----*/
 #define NO_SYS 1
 /*----- Value in opt.h for SYS_LIGHTWEIGHT_PROT: 1 -----*/
 #define SYS_LIGHTWEIGHT_PROT 0
+#endif
 /*----- Value in opt.h for MEM_ALIGNMENT: 1 -----*/
 #define MEM_ALIGNMENT 4
 
@@ -41,6 +213,7 @@
 #define LWIP_ETHERNET 1
 /*----- Value in opt.h for LWIP_DNS_SECURE: (LWIP_DNS_SECURE_RAND_XID | LWIP_DNS_SECURE_NO_MULTIPLE_OUTSTANDING | LWIP_DNS_SECURE_RAND_SRC_PORT) -*/
 #define LWIP_DNS_SECURE 7
+#if !LWIP_TCP_THROUGHPUT
 /*----- Value in opt.h for TCP_SND_QUEUELEN: (4*TCP_SND_BUF + (TCP_MSS - 1))/TCP_MSS -----*/
 #define TCP_SND_QUEUELEN 9
 /*----- Value in opt.h for TCP_SNDLOWAT: LWIP_MIN(LWIP_MAX(((TCP_SND_BUF)/2), (2 * TCP_MSS) + 1), (TCP_SND_BUF) - 1) -*/
@@ -49,6 +222,7 @@
 #define TCP_SNDQUEUELOWAT 5
 /*----- Value in opt.h for TCP_WND_UPDATE_THRESHOLD: LWIP_MIN(TCP_WND/4, TCP_MSS*4) -----*/
 #define TCP_WND_UPDATE_THRESHOLD 536
+#endif
 /*----- Value in opt.h for LWIP_NETIF_LINK_CALLBACK: 0 -----*/
 #define LWIP_NETIF_LINK_CALLBACK 1
 /*----- Value in opt.h for LWIP_NETIF_STATUS_CALLBACK: 0 -----*/
@@ -60,27 +234,49 @@
 /*----- Value in opt.h for RECV_BUFSIZE_DEFAULT: INT_MAX -----*/
 #define RECV_BUFSIZE_DEFAULT 2000000000
 /*----- Value in opt.h for LWIP_STATS: 1 -----*/
-#define LWIP_STATS 0
+/*
+ * Only the reassembly counters (IPFRAG_STATS) and the memp pools (MEMP_STATS,
+ * for the reassembly timeouts counted by stnetif.c). The driver has its own
+ * counters (ETH_GetStatistics, stnetif_getstats)
+ */
+#define LWIP_STATS 1
+#define LINK_STATS 0
+#define ETHARP_STATS 0
+#define IP_STATS 0
+#define IPFRAG_STATS 1
+#define ICMP_STATS 0
+#define IGMP_STATS 0
+#define UDP_STATS 0
+#define TCP_STATS 0
+#define MEM_STATS 0
+#define MEMP_STATS 1
+#define SYS_STATS 0
+/* Checksums are calculated and checked by lwIP only without hardware offload */
+#if CHECKSUM_BY_HARDWARE
+#define CHECKSUM_SOFTWARE 0
+#else
+#define CHECKSUM_SOFTWARE 1
+#endif
 /*----- Value in opt.h for CHECKSUM_GEN_IP: 1 -----*/
-#define CHECKSUM_GEN_IP 0
+#define CHECKSUM_GEN_IP CHECKSUM_SOFTWARE
 /*----- Value in opt.h for CHECKSUM_GEN_UDP: 1 -----*/
-#define CHECKSUM_GEN_UDP 0
+#define CHECKSUM_GEN_UDP CHECKSUM_SOFTWARE
 /*----- Value in opt.h for CHECKSUM_GEN_TCP: 1 -----*/
-#define CHECKSUM_GEN_TCP 0
+#define CHECKSUM_GEN_TCP CHECKSUM_SOFTWARE
 /*----- Value in opt.h for CHECKSUM_GEN_ICMP: 1 -----*/
-#define CHECKSUM_GEN_ICMP 0
+#define CHECKSUM_GEN_ICMP CHECKSUM_SOFTWARE
 /*----- Value in opt.h for CHECKSUM_GEN_ICMP6: 1 -----*/
-#define CHECKSUM_GEN_ICMP6 0
+#define CHECKSUM_GEN_ICMP6 CHECKSUM_SOFTWARE
 /*----- Value in opt.h for CHECKSUM_CHECK_IP: 1 -----*/
-#define CHECKSUM_CHECK_IP 0
+#define CHECKSUM_CHECK_IP CHECKSUM_SOFTWARE
 /*----- Value in opt.h for CHECKSUM_CHECK_UDP: 1 -----*/
-#define CHECKSUM_CHECK_UDP 0
+#define CHECKSUM_CHECK_UDP CHECKSUM_SOFTWARE
 /*----- Value in opt.h for CHECKSUM_CHECK_TCP: 1 -----*/
-#define CHECKSUM_CHECK_TCP 0
+#define CHECKSUM_CHECK_TCP CHECKSUM_SOFTWARE
 /*----- Value in opt.h for CHECKSUM_CHECK_ICMP: 1 -----*/
-#define CHECKSUM_CHECK_ICMP 0
+#define CHECKSUM_CHECK_ICMP CHECKSUM_SOFTWARE
 /*----- Value in opt.h for CHECKSUM_CHECK_ICMP6: 1 -----*/
-#define CHECKSUM_CHECK_ICMP6 0
+#define CHECKSUM_CHECK_ICMP6 CHECKSUM_SOFTWARE
 
 /*----- Debug options ----------------------------------*/
 #define LWIP_DEBUG                      1
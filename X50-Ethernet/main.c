@@ -24,6 +24,7 @@
 #include "sdram.h"
 #include "led.h"
 #include "eth.h"
+#include "cache.h"
 
 
 #include "lwip/init.h"
@@ -37,11 +38,43 @@
 #include "arch/sys_arch.h"
 #include "lwip/tcp.h"
 #include "lwip/prot/ethernet.h"
-#include "lwip/apps/tftp_server.h"
+#include "lwip/apps/lwiperf.h"
 #include "stnetif.h"
+#include "lwipmem.h"
+#include "netstats.h"
+#include "udpstream.h"
+#include "netbench.h"
+#include "event.h"
+#include "swtimer.h"
+#include "stack.h"
+#include "clkgate.h"
+#include "gpio.h"
+#include "sendfile.h"
+#include "sdcard.h"
+#include "fat.h"
+#include "sdstream.h"
+#include "bootcache.h"
+#include "filestore.h"
+#include "crc.h"
+#include "rng.h"
+#include "tftpd.h"
+#include "webui.h"
+#include "dma2d.h"
+#include "rfb.h"
+#include "fwupdate.h"
+#include "mqttpub.h"
+#include "irqprio.h"
+#include "irqbench.h"
+#if LWIP_UCOS2
+#include "lwip/tcpip.h"
+#include "ucos_ii.h"
+#endif
 
 #include "debugdump.h"
 #include "debugmessages.h"
+#ifdef MESSAGE_DEFERRED
+#include "tracelog.h"
+#endif
 
 
 /**
@@ -57,18 +90,293 @@ int verbose = VERBOSE;
  * @brief Configuration
  */
 ///@{
-//#define USE_HTTPD               1
+#define USE_HTTPD                 1
 #define USE_TFTP                  1
+#define USE_IPERF                 1
+#define USE_NETSTATS              1
+#define USE_UDPSTREAM             0
+#define USE_NETBENCH              1
+#define USE_RFB                   0
+#define USE_EVENTLOOP             1
+#define USE_FWUPDATE              1
+#define USE_MQTTPUB               0
+#define USE_IRQBENCH              0
+#define USE_SENDFILE              1
+#define USE_SDSTREAM              0
+#define USE_BOOTCACHE             0
 ///@}
 
+#if USE_IRQBENCH
+/**
+ * @brief   Interrupt latency benchmark (irqbench.c)
+ *
+ * @note    A control loop step runs every IRQBENCH_PERIOD us in the TIM6
+ *          interrupt. The latency, the jitter and the deadline misses are
+ *          printed every IRQBENCHDEMO_PERIOD ms. For the load, enable USE_RFB
+ *          (DMA2D fills in SDRAM) and run iperf or tools/netbench on the host
+ */
+///@{
+#define IRQBENCH_PERIOD           100       // us
+#define IRQBENCH_DEADLINE         20        // us
+#define IRQBENCHDEMO_PERIOD       10000
+///@}
+#endif
 
-#if USE_HTTPD
+#if USE_SENDFILE
+/**
+ * @brief   Firmware image in the flash (linker script), sent by sendfile.c
+ *
+ * @note    The initial values of .data follow .text in the flash
+ */
+///@{
+extern const char _text_start[], _text_end[];
+extern char _data_start[], _data_end[];
+///@}
+#endif
+
+#if USE_FWUPDATE
 /**
- * @brief IP_PORT for HTTP
+ * @brief   File name that goes to the firmware update (fwupdate.c)
  *
- * @note  Port number where the server listens
+ * @note    tftp -m octet <board> -c put <project>.bin update.bin, then reset
  */
-#define IP_PORT              8080
+#define FWUPDATE_FILENAME         "update.bin"
+#endif
+
+#if USE_MQTTPUB
+/**
+ * @brief   MQTT telemetry (mqttpub.c)
+ *
+ * @note    Run a broker on the host (mosquitto -v) and subscribe with
+ *          mosquitto_sub -h <host> -t 'stm32f746/#' -v. A sample is published
+ *          each ms, in batches, and the rates are printed every MQTTDEMO_PERIOD ms
+ */
+///@{
+#define MQTTPUB_BROKER            "192.168.0.1"
+#define MQTTPUB_CLIENTID          "stm32f746"
+#define MQTTDEMO_PERIOD           10000
+
+static ip_addr_t    mqttbroker;
+///@}
+#endif
+
+/**
+ * @brief   ETH descriptors and buffers (given to ETH_Init by stnetif_init)
+ *
+ * @note    ETH_BUFFERS_SMALL (32 RX buffers of 256 bytes in SRAM2) absorbs
+ *          longer bursts of small frames than ETH_BUFFERS_DEFAULT
+ */
+#define ETH_BUFFERS               ETH_BUFFERS_DEFAULT
+
+#if USE_UDPSTREAM
+/**
+ * @brief   Destination of the UDP stream
+ *
+ * @note    Receive with nc -u -l 5005 > /dev/null, the throughput is shown by
+ *          the statistics endpoint (netstats.c)
+ */
+#define UDPSTREAM_HOST            "192.168.0.1"
+
+/**
+ * @brief   Throughput measurement of the stream
+ *
+ * @note    Every UDPSTREAM_PERIOD ms the throughput is printed. With ETH_JUMBO,
+ *          the stream then alternates between datagrams filling a 1500 bytes
+ *          frame and datagrams filling a 9000 bytes frame (28 bytes of IPv4
+ *          and UDP headers)
+ */
+///@{
+#define UDPSTREAM_PERIOD          10000
+
+static const unsigned streampayload[] = {
+    ETH_MAX_ETH_PAYLOAD-28,
+    ETH_MTU-28
+};
+static int          streamsel = 0;
+static ip_addr_t    streamhost;
+///@}
+
+/**
+ * @brief   Stream_Poll
+ *
+ * @note    Example source. Fills each free buffer of the ring with a counter
+ *          and sends it
+ */
+static void Stream_Poll(void) {
+static uint32_t counter = 0;
+unsigned payload = streampayload[streamsel];
+UDPStream_Stats st;
+uint32_t *buf;
+unsigned i;
+
+    while( (buf = UDPStream_GetBuffer()) != 0 ) {
+        for(i=0;i<payload/4;i++)
+            buf[i] = counter++;
+        if( UDPStream_Send(payload) < 0 )
+            break;
+    }
+
+    UDPStream_GetStats(&st);
+    if( st.elapsed >= UDPSTREAM_PERIOD ) {
+        message("UDP stream: payload %u bytes, %lu datagrams, %lu kbit/s, %lu errors\n",
+                payload,(unsigned long) st.datagrams,(unsigned long) st.kbps,
+                (unsigned long) st.senderrors);
+#ifdef ETH_JUMBO
+        streamsel ^= 1;
+        UDPStream_Init(&streamhost,UDPSTREAM_PORT,streampayload[streamsel]);
+#else
+        UDPStream_ResetStats();
+#endif
+    }
+}
+#endif
+
+
+#if USE_IPERF
+/**
+ * @brief   iperf_report
+ *
+ * @note    Called by lwiperf at the end of each test
+ */
+static void
+iperf_report(void *arg, enum lwiperf_report_type type,
+             const ip_addr_t *local, u16_t localport,
+             const ip_addr_t *remote, u16_t remoteport,
+             u32_t bytes, u32_t ms, u32_t kbps) {
+char s[20];
+
+    ipaddr_ntoa_r(remote,s,20);
+    printf("iperf %s:%u: %lu bytes in %lu ms = %lu kbit/s (report %d)\n",
+            s,remoteport,(unsigned long) bytes,(unsigned long) ms,
+            (unsigned long) kbps,type);
+}
+#endif
+
+#ifdef CHKSUM_BENCHMARK
+/**
+ * @brief   ChecksumBenchmark
+ *
+ * @note    Compares the cycles of stm32_chksum (arch/chksum.c) and of the generic
+ *          lwip_standard_chksum, for some packet sizes at an aligned and at an
+ *          odd address
+ */
+#define CHKSUM_RUNS               100
+static uint8_t chksumbuf[8192+4] __attribute__((aligned(4)));
+
+static void ChecksumBenchmark(void) {
+static const int sizes[] = { 20, 64, 576, 1460, 8192 };
+uint32_t start,tgeneric,tarm;
+u16_t sgeneric,sarm;
+unsigned i,k,off;
+
+    for(i=0;i<sizeof(chksumbuf);i++)
+        chksumbuf[i] = (uint8_t) (i*7+(i>>8));
+
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for(off=0;off<2;off++) {
+        for(i=0;i<sizeof(sizes)/sizeof(sizes[0]);i++) {
+            start = DWT->CYCCNT;
+            for(k=0;k<CHKSUM_RUNS;k++)
+                sgeneric = lwip_standard_chksum(chksumbuf+off,sizes[i]);
+            tgeneric = (DWT->CYCCNT-start)/CHKSUM_RUNS;
+            start = DWT->CYCCNT;
+            for(k=0;k<CHKSUM_RUNS;k++)
+                sarm = stm32_chksum(chksumbuf+off,sizes[i]);
+            tarm = (DWT->CYCCNT-start)/CHKSUM_RUNS;
+            printf("chksum %4d bytes offset %u: generic %5lu cycles, arm %5lu cycles %s\n",
+                    sizes[i],off,(unsigned long) tgeneric,(unsigned long) tarm,
+                    sgeneric == sarm ? "" : "MISMATCH");
+        }
+    }
+}
+#endif
+
+#ifdef ETH_SELFTEST
+/**
+ * @brief   ETHSelfTest
+ *
+ * @note    Runs the loopback self test of eth.c for some frame sizes, before
+ *          lwIP takes the driver (stnetif_init calls ETH_Init again)
+ */
+#define ETH_SELFTEST_FRAMES       10000
+
+static void ETHSelfTest(void) {
+static const unsigned sizes[] = { 60, 128, 512, 1024, 1514 };
+ETH_SelfTestResult r;
+unsigned i;
+int rc;
+
+    if( ETH_Init(0) != ETH_OK ) {
+        printf("ethselftest: ETH_Init failed\n");
+        return;
+    }
+    for(i=0;i<sizeof(sizes)/sizeof(sizes[0]);i++) {
+        rc = ETH_SelfTest(ETH_SELFTEST_FRAMES,sizes[i],&r);
+        printf("ethselftest %4u bytes: %lu frames/s %lu kB/s %lu cycles/frame "
+               "(sent %lu received %lu errors %lu lost %lu) %s\n",
+                sizes[i],(unsigned long) r.framespersecond,
+                (unsigned long) r.bytespersecond/1000,(unsigned long) r.cyclesperframe,
+                (unsigned long) r.sent,(unsigned long) r.received,
+                (unsigned long) r.errors,(unsigned long) r.lost,
+                rc == ETH_OK ? "OK" : "FAILED");
+    }
+}
+#endif
+
+#ifdef PINMUX_BENCHMARK
+/**
+ * @brief   PinMuxBenchmark
+ *
+ * @note    Compares the cycles of GPIO_ConfigureMultiplePins (read-modify-write
+ *          of 6 registers for each pin) and of GPIO_ConfigurePinTable (each
+ *          register written once per port) for the pins configured at boot
+ *          (SDRAM, ETH, UART, LED). Their configuration is read back into a
+ *          table and written again, so nothing changes
+ */
+#define PINMUX_RUNS               100
+static GPIO_PinConfiguration pinmuxtab[11*16+1];
+
+static void PinMuxBenchmark(void) {
+static GPIO_TypeDef * const ports[] = {
+    GPIOA, GPIOB, GPIOC, GPIOD, GPIOE, GPIOF, GPIOG, GPIOH, GPIOI, GPIOJ, GPIOK
+};
+GPIO_PinConfiguration conf;
+uint32_t start,tsingle,tbatched,mhz;
+unsigned i,k,pin,n,nports;
+
+    // Pins not in the reset state (input)
+    n = nports = 0;
+    for(i=0;i<sizeof(ports)/sizeof(ports[0]);i++) {
+        k = n;
+        for(pin=0;pin<16;pin++) {
+            GPIO_GetPinConfiguration(ports[i],pin,&conf);
+            if( conf.mode != 0 )
+                pinmuxtab[n++] = conf;
+        }
+        if( n > k )
+            nports++;
+    }
+    pinmuxtab[n].gpio = 0;
+
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    start = DWT->CYCCNT;
+    for(k=0;k<PINMUX_RUNS;k++)
+        GPIO_ConfigureMultiplePins(pinmuxtab);
+    tsingle = (DWT->CYCCNT-start)/PINMUX_RUNS;
+    start = DWT->CYCCNT;
+    for(k=0;k<PINMUX_RUNS;k++)
+        GPIO_ConfigurePinTable(pinmuxtab);
+    tbatched = (DWT->CYCCNT-start)/PINMUX_RUNS;
+
+    mhz = SystemCoreClock/1000000;
+    printf("pinmux %u pins in %u ports: per pin %lu cycles (%lu us), batched %lu cycles (%lu us)\n",
+            n,nports,(unsigned long) tsingle,(unsigned long) (tsingle/mhz),
+            (unsigned long) tbatched,(unsigned long) (tbatched/mhz));
+}
 #endif
 
 //////////////////// Network configuration /////////////////////////////////////
@@ -90,13 +398,19 @@ static ip4_addr_t       gateway = {0};
 
 ////////////////// Timing Functions  ///////////////////////////////////////////
 
-static volatile uint32_t tick_ms = 0;
 static volatile uint32_t delay_ms = 0;
+#if !USE_EVENTLOOP || LWIP_UCOS2
+static volatile uint32_t tick_ms = 0;
 static int led_initialized = 0;
+#endif
 
 #define INTERVAL 500
 void SysTick_Handler(void) {
 
+#if USE_EVENTLOOP && !LWIP_UCOS2
+    // The LED is blinked by a software timer (ledtimer)
+    SWTimer_Tick();
+#else
     if( !led_initialized ) {
         LED_Init();
         led_initialized = 1;
@@ -107,23 +421,34 @@ void SysTick_Handler(void) {
     } else {
        tick_ms++;
     }
+#endif
 
     if( delay_ms > 0 ) delay_ms--;
 
     sys_count();
 
+#if USE_FWUPDATE
+    FWUpdate_Tick();
+#endif
+
+#if USE_SDSTREAM
+    SD_ProcessTimeouts();
+#endif
+
 }
 
 /**
  *  @brief  Delay
  *
- * @note    Delays *delay* milliseconds
+ * @note    Delays *delay* milliseconds. Sleeps between the SysTick interrupts
  */
 
 void Delay(uint32_t delay) {
 
     delay_ms = delay;
-    while( delay_ms ) {}
+    while( delay_ms ) {
+        __WFI();
+    }
 
 }
 
@@ -221,57 +546,146 @@ int e10 = 1;
 ///////////////////// TFTP Functions ///////////////////////////////////////////
 
 
-#define ONLY_FILE  ((void *) 1)
-static void*
-tftp_open(const char* fname, const char* mode, u8_t is_write) {
+/**
+ * @brief   TFTP callbacks
+ *
+ * @note    Files are kept in the file store (filestore.c). A file sent to the
+ *          board replaces the old one only when the transfer is completed.
+ *          The CRC-32 of the file is printed at the end of a transfer, to be
+ *          compared with the one of the image on the host
+ *
+ * @note    With USE_FWUPDATE, FWUPDATE_FILENAME sent to the board is staged in
+ *          the QSPI flash while it is received and installed at the next reset
+ */
+///@{
+#if USE_FWUPDATE
+static int fwhandle;
+#endif
 
-    if (is_write) {
-        return NULL;                    // not yet
-    } else {
-        return ONLY_FILE;
-    }
+static void *
+tftp_open(const char *fname, const char *mode, int is_write) {
+
+#if USE_FWUPDATE
+    if( is_write && strcmp(fname,FWUPDATE_FILENAME) == 0 )
+        return FWUpdate_Begin() == FWUPDATE_OK ? &fwhandle : NULL;
+#endif
+    return FileStore_Open(fname,is_write?FILESTORE_WRITE:FILESTORE_READ);
 }
 
 static void
-tftp_close(void* handle) {
-
-    return;
+tftp_close(void *handle, int ok) {
+const char *name;
+uint32_t crc;
+
+#if USE_FWUPDATE
+    if( handle == &fwhandle ) {
+        FWUpdate_End(ok);
+        return;
+    }
+#endif
+    name = FileStore_GetFileName(handle);
+    FileStore_Close(handle,ok);
+    if( ok && name && FileStore_GetCRC(name,&crc) == 0 )
+        message("TFTP %s: %ld bytes, CRC-32 %08lX\n",name,FileStore_GetSize(name),
+                (unsigned long) crc);
 }
 
-static int counter = 0;
-
 static int
-tftp_read(void* handle, void* buf, int len) {
-int rc;
+tftp_read(void *handle, void *buf, int len) {
 
-    if( handle != ONLY_FILE )
-        return -1;
-
-    rc = int2str(counter,buf,len);
-    counter++;
-    return rc;
+    return FileStore_Read(handle,buf,len);
 }
 
 static int
-tftp_write(void* handle, struct pbuf* p) {
+tftp_write(void *handle, struct pbuf *p) {
 
-    if( handle != ONLY_FILE )
-        return -1;
-
-    while (p != NULL) {
-        hexdump(p->payload,p->len,0);
+#if USE_FWUPDATE
+    if( handle == &fwhandle ) {
+        for( ; p != NULL; p = p->next ) {
+            if( FWUpdate_Write(p->payload,p->len) < 0 )
+                return -1;
+        }
+        return 0;
+    }
+#endif
+    while( p != NULL ) {
+        if( FileStore_Write(handle,p->payload,p->len) < 0 )
+            return -1;
         p = p->next;
     }
     return 0;
 }
 
-static const struct tftp_context
+static long
+tftp_size(void *handle) {
+
+    return FileStore_GetFileSize(handle);
+}
+
+static const TFTPD_Context
 tftp_config = {
-  tftp_open,
-  tftp_close,
-  tftp_read,
-  tftp_write
+    tftp_open,
+    tftp_close,
+    tftp_read,
+    tftp_write,
+    tftp_size
 };
+///@}
+
+#if USE_MQTTPUB
+/**
+ * @brief   MQTTDemo_Poll
+ *
+ * @note    Example source. Publishes the time and a sequence number each ms
+ */
+static void MQTTDemo_Poll(void) {
+static uint32_t lastsample = 0, lastreport = 0, seq = 0;
+uint32_t now = sys_now();
+MQTTPub_Stats st;
+
+    MQTTPub_Poll();
+    if( now != lastsample && MQTTPub_IsConnected() ) {
+        lastsample = now;
+        MQTTPub_Printf("stm32f746/telemetry","%lu %lu\n",(unsigned long) now,
+                       (unsigned long) seq++);
+    }
+    if( now-lastreport >= MQTTDEMO_PERIOD ) {
+        lastreport = now;
+        MQTTPub_GetStats(&st);
+        message("MQTT: %lu samples/s, %lu PUBLISH/s, %lu kbit/s, %lu dropped, "
+                "TCP queue %u/%u segments %lu/%lu bytes (max), buffers %u/%u\n",
+                (unsigned long) st.samplerate,(unsigned long) st.publishrate,
+                (unsigned long) st.kbps,(unsigned long) st.dropped,
+                st.sndqueue,st.sndqueuemax,(unsigned long) st.sndbytes,
+                (unsigned long) st.sndbytesmax,st.buffers,st.buffersmax);
+    }
+}
+#endif
+
+#if USE_FWUPDATE
+/**
+ * @brief   Firmware update progress
+ *
+ * @note    Programs the QSPI flash while the image is received and reports the
+ *          end of an update
+ */
+static void FWUpdate_Process(void) {
+static int laststate = FWUPDATE_IDLE;
+FWUpdate_Status st;
+
+    FWUpdate_Poll();
+    FWUpdate_GetStatus(&st);
+    if( st.state == laststate )
+        return;
+    laststate = st.state;
+    if( st.state == FWUPDATE_PENDING )
+        message("Firmware staged: %ld bytes, CRC-32 %08lX, received in %ld ms, "
+                "ready %ld ms after. Reset to install\n",(long) st.received,
+                (unsigned long) st.crc,(long) st.receivems,(long) st.flushms);
+    else if( st.state == FWUPDATE_FAILED )
+        message("Firmware update failed (%d)\n",st.error);
+}
+#endif
 
 //////////////////////// LWIP Data /////////////////////////////////////////////////////////////////
 
@@ -292,20 +706,237 @@ static struct netif     netif;
                         |((u32_t)(C)<<8)                    \
                         |((u32_t)(D)<<0))
 #endif
+#if USE_RFB
+/**
+ * @brief   Remote frame buffer demo
+ *
+ * @note    A RGB888 frame buffer in SDRAM, as layer 1 of 24-LCD, with a box
+ *          bouncing over a plain background. Both are drawn by the DMA2D and
+ *          the old and new positions are reported to rfb.c. It is seen with
+ *          tools/rfbview -o lcd.ppm <board>
+ */
+///@{
+#define RFBDEMO_BOX               48
+#define RFBDEMO_STEP              20        // ms
+#define RFBDEMO_PERIOD            10000     // ms between prints of the counters
+#define RFBDEMO_BACKGROUND        0x203060
+#define RFBDEMO_FOREGROUND        0xF0C000
+
+static uint8_t rfbdemo[RFB_MAXWIDTH*RFB_MAXHEIGHT*3]
+                                __attribute__((section(".sdram.rfbdemo"),aligned(32)));
+static int      boxx = 0, boxy = 0, boxdx = 3, boxdy = 2;
+static uint32_t boxtime = 0;
+static uint32_t rfbprint = 0;
+
+static void RFBDemo_Fill(int x, int y, int w, int h, unsigned color) {
+DECLARE_REGION(r,rfbdemo,x,y,w,h,DMA2D_RGB888,RFB_MAXWIDTH*3);
+
+    while( DMA2D_SubmitFill(&r,color,0,0) == 0 ) {}
+    RFB_AddDamage(x,y,w,h);
+}
+
+static void RFBDemo_Init(void) {
+
+    DMA2D_Init();
+    RFB_SetSource(rfbdemo,RFB_MAXWIDTH,RFB_MAXHEIGHT,RFB_MAXWIDTH*3,DMA2D_RGB888);
+    RFBDemo_Fill(0,0,RFB_MAXWIDTH,RFB_MAXHEIGHT,RFBDEMO_BACKGROUND);
+}
+
+static void RFBDemo_Poll(void) {
+RFB_Stats st;
+
+    if( sys_now()-boxtime < RFBDEMO_STEP )
+        return;
+    boxtime = sys_now();
+
+    RFBDemo_Fill(boxx,boxy,RFBDEMO_BOX,RFBDEMO_BOX,RFBDEMO_BACKGROUND);
+    if( boxx+boxdx < 0 || boxx+boxdx+RFBDEMO_BOX > RFB_MAXWIDTH )  boxdx = -boxdx;
+    if( boxy+boxdy < 0 || boxy+boxdy+RFBDEMO_BOX > RFB_MAXHEIGHT ) boxdy = -boxdy;
+    boxx += boxdx;
+    boxy += boxdy;
+    RFBDemo_Fill(boxx,boxy,RFBDEMO_BOX,RFBDEMO_BOX,RFBDEMO_FOREGROUND);
+
+    if( boxtime-rfbprint >= RFBDEMO_PERIOD ) {
+        rfbprint = boxtime;
+        RFB_GetStats(&st);
+        message("RFB: %lu frames (%lu key), %lu pixels, %lu unchanged, %lu bytes, %lu late\n",
+                (unsigned long) st.frames,(unsigned long) st.keyframes,
+                (unsigned long) st.pixels,(unsigned long) st.unchanged,
+                (unsigned long) st.bytes,(unsigned long) st.late);
+    }
+}
+///@}
+#endif
+
+
+#if USE_IRQBENCH
+/**
+ * @brief   Control loop step
+ *
+ * @note    A PI controller of a first order plant, in fixed point (Q16)
+ */
+///@{
+static int32_t  ctlsetpoint = 1<<16;
+static int32_t  ctloutput = 0;
+static int32_t  ctlintegral = 0;
+
+static void IRQBenchDemo_Step(void) {
+int32_t error,u;
+
+    error = ctlsetpoint-ctloutput;
+    ctlintegral += error>>4;
+    u = error+(ctlintegral>>2);
+    ctloutput += (u-ctloutput)>>3;
+}
+///@}
+
+static void IRQBenchDemo_Init(void) {
+int rc;
+
+    rc = IRQBench_Start(IRQBENCH_PERIOD,IRQBENCH_DEADLINE,IRQBenchDemo_Step);
+    if( rc != IRQBENCH_OK )
+        message("IRQ benchmark not started (%d)\n",rc);
+}
+
+static void IRQBenchDemo_Poll(void) {
+static uint32_t lastreport = 0;
+uint32_t now = sys_now();
+IRQBench_Stats st;
+char hist[IRQBENCH_HISTSIZE*11+1];
+int i,n;
+
+    if( now-lastreport < IRQBENCHDEMO_PERIOD )
+        return;
+    lastreport = now;
+    IRQBench_GetStats(&st);
+    message("IRQ: %lu interrupts, latency %lu/%lu/%lu ns (min/avg/max), jitter %lu ns, "
+            "response %lu ns, %lu misses, %lu overruns\n",
+            (unsigned long) st.count,(unsigned long) st.latencymin,
+            (unsigned long) st.latencyavg,(unsigned long) st.latencymax,
+            (unsigned long) st.jittermax,(unsigned long) st.responsemax,
+            (unsigned long) st.misses,(unsigned long) st.overruns);
+    for(i=0,n=0;i<IRQBENCH_HISTSIZE && n<(int) sizeof(hist);i++)
+        n += snprintf(hist+n,sizeof(hist)-n," %lu",(unsigned long) st.histogram[i]);
+    message("IRQ latency histogram (%d ns bins):%s\n",IRQBENCH_HISTSTEP,hist);
+    IRQBench_Reset();
+}
+#endif
+
+
+#if USE_BOOTCACHE
+/**
+ * @brief   Boot state in the backup SRAM (bootcache.c)
+ *
+ * @note    A warm boot configures the PLL with the parameters of the last good
+ *          boot, skips the power up wait of the SDRAM, keeps the PHY
+ *          configuration when the PHY was not reset (eth.c) and, with DHCP,
+ *          starts with the last address. The state is saved when the link is
+ *          up and again when the link mode or the address change
+ */
+///@{
+static BootCache_State      bootstate;
+static PLLConfiguration_t   bootpll;
+static int                  bootsaved = 0;
+
+static void BootState_Start(void) {
+const BootCache_State *st;
+PLLOutputFrequencies_t freq;
+
+    bootpll = MainPLLConfiguration_200MHz;
+    memset(&bootstate,0,sizeof(bootstate));
+    if( BootCache_Init() != BOOTCACHE_WARM )
+        return;
+
+    st = BootCache_Get();
+    bootstate = *st;
+    // The SDRAM needs 200 MHz, so only such a configuration is taken
+    if( SystemCheckPLLConfiguration(&st->pll) == 0
+     && SystemCalcPLLFrequencies(&st->pll,&freq) == SDRAM_CLOCKFREQUENCY )
+        bootpll = st->pll;
+    SDRAM_SetWarmStart(1);
+    ETH_SetWarmStart(st->linkinfo);
+}
+
+static void BootState_Check(void) {
+int mode;
+
+    if( !ETH_GetLinkState() )
+        return;
+    mode = ETH_GetLinkMode();
+    if( bootsaved && bootstate.linkinfo == (uint32_t) mode
+                  && bootstate.ipaddr == netif_ip4_addr(&netif)->addr )
+        return;
+
+    if( !bootsaved )
+        BootCache_Mark(BOOTCACHE_MARK_LINK);
+    bootstate.pll      = bootpll;
+    bootstate.linkinfo = mode;
+    bootstate.ipaddr   = netif_ip4_addr(&netif)->addr;
+    bootstate.netmask  = netif_ip4_netmask(&netif)->addr;
+    bootstate.gateway  = netif_ip4_gw(&netif)->addr;
+    BootCache_Save(&bootstate);
+    if( !bootsaved ) {
+        bootsaved = 1;
+        if( ETH_IsWarmStart() )
+            message("PHY configuration kept across the reset\n");
+        BootCache_Report();
+    }
+}
+///@}
+#endif
 
 ///////////////////// Network Functions ////////////////////////////////////////
 
+#if LWIP_UCOS2
 /**
- * @brief   Initialize lwIP
- * 
- * @note    Do all initialization for lwIP
+ * @brief   Network_Poll
+ *
+ * @note    Checks the link every NETWORK_POLLINTERVAL ms in the tcpip thread
  */
+#define NETWORK_POLLINTERVAL    100
 
-void Network_Init(void) {
-err_t err;
+static void Network_Poll(void *arg) {
 
-    MESSAGE("Initialing lwip\n");
-    lwip_init();
+    stnetif_printstatus();
+    stnetif_link(&netif);
+#if USE_UDPSTREAM
+    Stream_Poll();
+#endif
+#if USE_RFB
+    RFBDemo_Poll();
+    RFB_Poll();
+#endif
+#if USE_FWUPDATE
+    FWUpdate_Process();
+#endif
+#if USE_MQTTPUB
+    MQTTDemo_Poll();
+#endif
+#if USE_IRQBENCH
+    IRQBenchDemo_Poll();
+#endif
+#if USE_SDSTREAM
+    SDStream_Poll();
+#endif
+#if USE_BOOTCACHE
+    BootState_Check();
+#endif
+    sys_timeout(NETWORK_POLLINTERVAL,Network_Poll,0);
+}
+#endif
+
+/**
+ * @brief   Network_Config
+ *
+ * @note    Adds the interface and starts the servers. With LWIP_UCOS2, it is
+ *          called by the tcpip thread when it starts
+ */
+
+static void Network_Config(void *arg) {
+err_t err;
+#if USE_SDSTREAM
+int rc;
+#endif
 
     MESSAGE("Initializing interface\n");
 
@@ -313,12 +944,19 @@ err_t err;
     IP4_ADDR(&ipaddr,192,168,0,190);
     IP4_ADDR(&netmask,255,255,255,0);
     IP4_ADDR(&gateway,192,168,0,1);
+#elif USE_BOOTCACHE
+    // Last lease, usable until DHCP confirms or changes it
+    if( BootCache_IsWarm() && bootstate.ipaddr ) {
+        ipaddr.addr  = bootstate.ipaddr;
+        netmask.addr = bootstate.netmask;
+        gateway.addr = bootstate.gateway;
+    }
 #endif
     netif_add(  &netif, 
                 &ipaddr, 
                 &netmask, 
                 &gateway, 
-                NULL, 
+                (void *) &ETH_BUFFERS, 
                 stnetif_init, 
                 ethernet_input
                 );
@@ -364,19 +1002,112 @@ err_t err;
 
 
 #if USE_TFTP 
+    // Files in SDRAM (filestore.c). tftp -m octet <board> -c put firmware.bin
     message("Starting TFTP server\n");
-    tftp_init(&tftp_config);
+    if( CRC_Init() != CRC_OK )
+        message("CRC unit self test failed, CRC in software\n");
+    FileStore_Init();
+    TFTPD_Init(&tftp_config);
+#endif
+
+#if USE_IPERF
+    // iperf 2 server on port 5001 (iperf -c <board> -i 1)
+    message("Starting iperf server\n");
+    lwiperf_start_tcp_server_default(iperf_report,0);
+#endif
+
+#if USE_NETSTATS
+    // Driver statistics on UDP port 7777 (echo | nc -u -w1 <board> 7777)
+    message("Starting statistics endpoint\n");
+    NetStats_Init(NETSTATS_PORT);
+#endif
+
+#if USE_NETBENCH
+    // Benchmark server on UDP port 7000 (host tool tools/netbench)
+    message("Starting benchmark server\n");
+    NetBench_Init(NETBENCH_PORT);
+#endif
+
+#if USE_UDPSTREAM
+    message("Starting UDP stream to %s:%d\n",UDPSTREAM_HOST,UDPSTREAM_PORT);
+    ipaddr_aton(UDPSTREAM_HOST,&streamhost);
+    UDPStream_Init(&streamhost,UDPSTREAM_PORT,streampayload[streamsel]);
+#endif
+
+#if USE_RFB
+    // Remote frame buffer on UDP port 5010 (host tool tools/rfbview)
+    message("Starting remote frame buffer\n");
+    RFBDemo_Init();
+    RFB_Init(RFB_PORT);
+#endif
+
+#if USE_MQTTPUB
+    // Telemetry to the broker on TCP port 1883
+    message("Starting MQTT publisher to %s\n",MQTTPUB_BROKER);
+    ipaddr_aton(MQTTPUB_BROKER,&mqttbroker);
+    MQTTPub_Init(&mqttbroker,MQTTPUB_PORT,MQTTPUB_CLIENTID);
+#endif
+
+#if USE_IRQBENCH
+    // Control loop in the TIM6 interrupt, while the servers run
+    message("Starting IRQ benchmark\n");
+    IRQBenchDemo_Init();
+#endif
+
+#if USE_SENDFILE
+    // Firmware image from the flash on TCP port 7001 (nc <board> 7001 > image.bin),
+    // sent without copy (see ETH_ZEROCOPY_TX in the Makefile)
+    message("Starting firmware image server\n");
+    SendFile_Init(SENDFILE_PORT,_text_start,(_text_end-_text_start)+(_data_end-_data_start));
+#endif
+
+#if USE_SDSTREAM
+    // Files of the MicroSD card on TCP port 7002 (echo LOG.TXT | nc <board> 7002 > log.txt),
+    // read ahead into SDRAM while the previous buffers are sent
+    message("Starting MicroSD file server\n");
+    if( (rc=SD_Init()) < 0 || (rc=FAT_Mount()) < 0 )
+        message("MicroSD not available (%d)\n",rc);
+    else
+        SDStream_Init(SDSTREAM_PORT);
 #endif
 
 #if USE_HTTPD
-    // not tested yet!!! Not configured too.
-    // It uses TCP!!!
     message("Starting HTTP server\n");
-    httpd_init();
+    WebUI_Init();
+#endif
+
+#if USE_BOOTCACHE
+    BootCache_Mark(BOOTCACHE_MARK_NETWORK);
 #endif
 
+#if LWIP_UCOS2
+    sys_timeout(NETWORK_POLLINTERVAL,Network_Poll,0);
+#endif
+}
+
+/**
+ * @brief   Initialize lwIP
+ * 
+ * @note    Do all initialization for lwIP
+ */
+
+void Network_Init(void) {
+
+#if LWIP_MEM_BUDDY
+    if( LWIPMem_Init() < 0 )
+        MESSAGE("Could not create the lwIP buddy pool\n");
+#endif
+#if LWIP_UCOS2
+    MESSAGE("Starting tcpip thread\n");
+    tcpip_init(Network_Config,0);
+#else
+    MESSAGE("Initialing lwip\n");
+    lwip_init();
+    Network_Config(0);
+#endif
 }
 
+#if !LWIP_UCOS2
 /**
  * @brief   LWIP processing in the main loop
  * 
@@ -391,7 +1122,44 @@ void Network_Process(void) {
     //LWIP_CheckLink();
     stnetif_link(&netif);
 
+#ifdef ETH_USE_ETH_IRQ
+    // Drain the RX ring only when the interrupt signaled new frames
+    if( ETH_IsRXPending() ) {
+        ETH_ClearRXPending();
+        stnetif_input(&netif);
+    }
+#else
     stnetif_input(&netif);
+#endif
+
+#if USE_UDPSTREAM
+    Stream_Poll();
+#endif
+
+#if USE_RFB
+    RFBDemo_Poll();
+    RFB_Poll();
+#endif
+
+#if USE_FWUPDATE
+    FWUpdate_Process();
+#endif
+
+#if USE_MQTTPUB
+    MQTTDemo_Poll();
+#endif
+
+#if USE_IRQBENCH
+    IRQBenchDemo_Poll();
+#endif
+
+#if USE_SDSTREAM
+    SDStream_Poll();
+#endif
+
+#if USE_BOOTCACHE
+    BootState_Check();
+#endif
             
     // Check timers
     sys_check_timeouts();
@@ -420,6 +1188,99 @@ void Network_Process(void) {
 
 }
 
+#if USE_EVENTLOOP
+/**
+ * @brief   Network processing as events
+ *
+ * @note    The ETH interrupt posts Network_RXEvent (FrameReceived callback) and
+ *          a 1 ms software timer runs Network_Timer for the lwIP timers, the
+ *          link and, without ETH_USE_ETH_IRQ, the RX polling
+ */
+///@{
+static SWTimer nettimer;
+static SWTimer ledtimer;
+
+static void Network_RXEvent(uint32_t arg) {
+
+#ifdef ETH_USE_ETH_IRQ
+    ETH_ClearRXPending();
+#endif
+    stnetif_input(&netif);
+}
+
+#ifdef ETH_USE_ETH_IRQ
+static void Network_FrameReceived(unsigned arg) {
+
+    Event_Post(Network_RXEvent,0);
+}
+#endif
+
+static void Network_Timer(void *arg) {
+
+    Network_Process();
+#ifdef MESSAGE_DEFERRED
+    // Print messages stored by interrupts and network routines
+    Trace_Flush();
+#endif
+}
+
+static void LED_Timer(void *arg) {
+
+    LED_Toggle();
+}
+///@}
+#endif
+#endif
+
+#if LWIP_UCOS2
+///////////////////// Tasks ///////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief   Stacks for tasks
+ */
+///@{
+static OS_STK TaskStartStack[APP_CFG_STARTUP_TASK_STK_SIZE];
+static OS_STK TaskAppStack[TASKAPP_STK_SIZE];
+///@}
+
+/**
+ * @brief   TaskApp
+ *
+ * @note    Application task. It has lower priority than the tcpip thread, so
+ *          it runs when the network processing is done
+ */
+static void TaskApp(void *param) {
+
+    while(1) {
+#ifdef MESSAGE_DEFERRED
+        // Print messages stored by interrupts and network routines
+        Trace_Flush();
+#endif
+        // Application code here
+        OSTimeDly(10);
+    }
+}
+
+/**
+ * @brief   TaskStart
+ *
+ * @note    Starts lwIP (tcpip thread) and the application tasks once the
+ *          kernel is running
+ */
+static void TaskStart(void *param) {
+
+    message("Initializing LWIP\n");
+    Network_Init();
+
+    OSTaskCreate(   TaskApp,                                    // Pointer to task
+                    (void *) 0,                                 // Parameter
+                    (void *) &TaskAppStack[TASKAPP_STK_SIZE-1], // Initial value of SP
+                    TASKAPP_PRIO);                              // Task Priority/ID
+
+    OSTaskDel(OS_PRIO_SELF);                                    // Kill itself
+}
+#endif
+
 ///////////////////// Main Function ///////////////////////////////////////////////////////////////
 
 /**
@@ -429,44 +1290,139 @@ void Network_Process(void) {
  */
 int main(void) {
 err_t rc;
+#if USE_FWUPDATE
+int fwrc;
+#endif
 
     // Disable buffering for stdout (Trying)
     //setvbuf(stdout, NULL,_IONBF, 0);
 
     message("Starting.at %ld KHz...\n",SystemCoreClock/1000);
 
+#if USE_BOOTCACHE
+    // Reset cause and state of the last boot, before the clock change. The
+    // RCC is reset with the MCU, so the PLL is configured at each boot
+    BootState_Start();
+    SystemConfigMainPLL(&bootpll);
+    SystemSetCoreClock(CLOCKSRC_PLL,1);
+    BootCache_Mark(BOOTCACHE_MARK_CLOCK);
+#else
     /* Set Clock to 200 MHz */
     SystemConfigMainPLL(&MainPLLConfiguration_200MHz);
     SystemSetCoreClock(CLOCKSRC_PLL,1);
+#endif
 
     message("Now running at %ld KHz...\n",SystemCoreClock/1000);
 
+#if USE_EVENTLOOP && !LWIP_UCOS2
+    // Before SysTick, that posts the software timer events
+    Event_Init();
+#endif
+
     // Set SysTick to 1 ms
     SysTick_Config(SystemCoreClock/1000);
+    NVIC_SetPriority(SysTick_IRQn,IRQPRIO_SYSTICK);
+
+    // SDRAM write through and non cacheable area for DMA
+    Cache_Init();
 
     printf("Starting SDRAM\n");
     SDRAM_Init();
+#if USE_BOOTCACHE
+    BootCache_Mark(BOOTCACHE_MARK_SDRAM);
+#endif
+
+#if USE_FWUPDATE
+    // Copies a firmware staged in the QSPI flash and resets (does not return)
+    fwrc = FWUpdate_Install();
+    if( fwrc == 1 )
+        message("Firmware updated\n");
+    else if( fwrc < 0 )
+        message("Firmware update not installed (%d)\n",fwrc);
+    if( FWUpdate_Init() != FWUPDATE_OK )
+        message("QSPI flash not found, no firmware update\n");
+#endif
+
+#ifdef CHKSUM_BENCHMARK
+    ChecksumBenchmark();
+#endif
+
+#ifdef ETH_SELFTEST
+    ETHSelfTest();
+#endif
+
+    // RNG for lwIP (LWIP_RAND and TCP ISN), clocked by PLLSAI P (48 MHz)
+    SystemConfigPLLSAI(&PLLSAIConfiguration_48MHz);
+    if( RNG_Init() != RNG_OK )
+        printf("RNG not running, lwIP uses pseudo random numbers\n");
 
     memset((uint8_t *) 0xC0000000, 0x12345678, 0x1000 );
     memcpy((uint8_t *) 0xC0000000, (uint8_t *) 0x20000000, 0x1000);
 
+#if LWIP_UCOS2
+    // lwIP and the application run as uC/OS-II tasks
+    OSInit();
+    OSTaskCreate(   TaskStart,                                          // Pointer to function
+            (void *) 0,                                                 // Parameter for task
+            (void *) &TaskStartStack[APP_CFG_STARTUP_TASK_STK_SIZE-1],  // Initial value of SP
+            APP_CFG_STARTUP_TASK_PRIO);                                 // Task Priority/ID
+    OSStart();                                                          // Never returns
+#else
+
 #if 1
     message("Initializing LWIP\n");
     Network_Init();
  #endif
+#ifdef PINMUX_BENCHMARK
+    PinMuxBenchmark();
+#endif
+    Stack_Report();
+    ClkGate_Report();
+#if USE_EVENTLOOP
+    // Handlers run by events, sleeps when there are none
+#ifdef ETH_USE_ETH_IRQ
+    ETH_RegisterCallback(ETH_CALLBACK_FRAMERECEIVED,Network_FrameReceived);
+#endif
+    LED_Init();
+    SWTimer_Init(&ledtimer,LED_Timer,0);
+    SWTimer_Start(&ledtimer,SWTIMER_MS(INTERVAL),SWTIMER_MS(INTERVAL));
+    SWTimer_Init(&nettimer,Network_Timer,0);
+    SWTimer_Start(&nettimer,1,1);
+    Event_Loop();
+#else
     // Entering Main loop
     int cnt = 0;
     while(1) {
 
         Network_Process();
 
+#ifdef MESSAGE_DEFERRED
+        // Print messages stored by interrupts and network routines
+        Trace_Flush();
+#endif
+
+#ifdef ETH_USE_ETH_IRQ
+        // Sleep until the next interrupt (ETH or SysTick for the lwIP timers).
+        // Interrupts are masked while testing, but a pending one still
+        // wakes WFI, so a frame received just before is not missed
+        __disable_irq();
+        if( !ETH_IsRXPending() )
+            __WFI();
+        __enable_irq();
+#endif
+
         // Application code here
         cnt++;
+#if !USE_IPERF
+        // The pause stops the network processing, so not with iperf
         if( cnt == 20 ) {
             char line[20];
             MESSAGE("PAUSE\n");
             fgets(line,20,stdin);
             cnt = 0;
         }
+#endif
     }
+#endif
+#endif
 }
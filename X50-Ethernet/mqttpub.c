@@ -0,0 +1,576 @@
+/**
+ * @file    mqttpub.c
+ *
+ * @note    MQTT 3.1.1 publisher with batching and zero copy transmission (see
+ *          mqttpub.h)
+ *
+ * @note    The buffers form a ring, used in order. Each one holds a complete
+ *          packet: a PUBLISH (fixed header, topic and the samples), CONNECT or
+ *          PINGREQ. They go thru three stages, given by free running counters:
+ *
+ *          | Buffers         | Stage                                       |
+ *          |-----------------|---------------------------------------------|
+ *          | tail..written-1 | given to tcp_write, waiting for the ACK     |
+ *          | written..head-1 | complete, waiting for room in the TCP queue |
+ *          | head            | batch being filled (when filling is set)    |
+ *
+ * @note    The fixed header of a PUBLISH has a variable length. Three bytes
+ *          are reserved at the start of the buffer and the header is written
+ *          when the batch is closed, right before the topic, so the packet
+ *          starts at the first or at the second byte
+ *
+ * @note    tcp_write without TCP_WRITE_FLAG_COPY keeps a reference to the data
+ *          until it is acknowledged. The ACKs come in order, so the bytes
+ *          acknowledged (tcp_sent callback) free the buffers from tail. A
+ *          connection is ended with tcp_abort, that drops the segments still
+ *          referencing the buffers (tcp_close would go on sending them)
+ *
+ * @note    The buffers are in the non cacheable area, so the ETH DMA can send
+ *          them in place with ETH_ZEROCOPY_TX
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "lwip/opt.h"
+#include "lwip/tcp.h"
+#include "lwip/sys.h"
+#include "cache.h"
+#include "mqttpub.h"
+
+#if MQTTPUB_BUFSIZE > 16383+3
+#error "MQTTPUB_BUFSIZE too large for a two bytes remaining length"
+#endif
+
+/**
+ * @brief   MQTT control packets
+ */
+///@{
+#define MQTT_CONNECT                0x10
+#define MQTT_CONNACK                0x20
+#define MQTT_PUBLISH                0x30    // QoS 0, no retain
+#define MQTT_PINGREQ                0xC0
+#define MQTT_PINGRESP               0xD0
+#define MQTT_LEVEL                  4       // 3.1.1
+#define MQTT_CLEANSESSION           0x02
+///@}
+
+/**
+ * @brief   Bytes reserved for the fixed header of a PUBLISH
+ */
+#define HEADROOM                    3
+
+/**
+ * @brief   Connection states
+ */
+///@{
+#define STATE_CLOSED                0
+#define STATE_CONNECTING            1       // TCP
+#define STATE_CONNACK               2       // CONNECT sent
+#define STATE_CONNECTED             3
+///@}
+
+/**
+ * @brief   Buffer ring
+ */
+///@{
+typedef struct {
+    uint16_t    start;                      // first byte of the packet
+    uint16_t    len;                        // bytes of the packet
+    uint8_t     publish;
+} Packet;
+
+NOCACHE static uint8_t  data[MQTTPUB_BUFCOUNT][MQTTPUB_BUFSIZE] __attribute__((aligned(4)));
+static Packet           packets[MQTTPUB_BUFCOUNT];
+static uint32_t         tail = 0;
+static uint32_t         written = 0;
+static uint32_t         head = 0;
+static int              filling = 0;
+static unsigned         fill = 0;           // bytes in the batch
+static unsigned         topiclen = 0;       // of the batch
+static uint32_t         acked = 0;          // bytes of the packet at tail
+///@}
+
+/**
+ * @brief   Connection
+ */
+///@{
+static struct tcp_pcb   *pcb = 0;
+static int              state = STATE_CLOSED;
+static ip_addr_t        brokeraddr;
+static uint16_t         brokerport = MQTTPUB_PORT;
+static const char       *client = 0;
+static uint8_t          rx[4];              // CONNACK or PINGRESP
+static unsigned         rxn = 0;
+///@}
+
+/**
+ * @brief   Times (sys_now)
+ */
+///@{
+static uint32_t         attempttime = 0;    // last connection attempt
+static uint32_t         batchtime = 0;      // first sample of the batch
+static uint32_t         sendtime = 0;       // last packet given to TCP
+static uint32_t         ratetime = 0;
+///@}
+
+/**
+ * @brief   Counters
+ */
+///@{
+static MQTTPub_Stats    stats;
+static uint32_t         lastsamples, lastpublishes, lastbytes;
+///@}
+
+#define INDEX(N)        ((N)%MQTTPUB_BUFCOUNT)
+
+/**
+ * @brief   Forget all packets
+ *
+ * @note    Only when lwIP holds no segment referencing them (no pcb)
+ */
+static void
+reset(void) {
+
+    tail = written = head = 0;
+    filling = 0;
+    acked = 0;
+    rxn = 0;
+    state = STATE_CLOSED;
+}
+
+/**
+ * @brief   End the connection
+ */
+static void
+disconnect(void) {
+
+    if( pcb ) {
+        tcp_arg(pcb,0);
+        tcp_recv(pcb,0);
+        tcp_sent(pcb,0);
+        tcp_err(pcb,0);
+        tcp_abort(pcb);
+        pcb = 0;
+    }
+    reset();
+}
+
+/**
+ * @brief   Give the complete packets to TCP while there is room
+ */
+static void
+output(void) {
+Packet *pk;
+int n = 0;
+
+    if( !pcb )
+        return;
+    while( written != head ) {
+        pk = &packets[INDEX(written)];
+        if( pk->len > tcp_sndbuf(pcb) || tcp_sndqueuelen(pcb)+1 >= TCP_SND_QUEUELEN )
+            break;
+        if( tcp_write(pcb,data[INDEX(written)]+pk->start,pk->len,0) != ERR_OK )
+            break;
+        if( pk->publish )
+            stats.publishes++;
+        stats.bytes += pk->len;
+        written++;
+        n++;
+    }
+    if( n ) {
+        sendtime = sys_now();
+        tcp_output(pcb);
+    }
+}
+
+/**
+ * @brief   Close the batch and queue its PUBLISH
+ */
+static void
+closebatch(void) {
+uint8_t *b = data[INDEX(head)];
+Packet *pk = &packets[INDEX(head)];
+unsigned rl = fill-HEADROOM;
+
+    if( !filling )
+        return;
+    filling = 0;
+    if( fill == HEADROOM+2+topiclen )
+        return;                             // no sample
+    if( rl < 128 ) {
+        pk->start = 1;
+        b[1] = MQTT_PUBLISH;
+        b[2] = rl;
+    } else {
+        pk->start = 0;
+        b[0] = MQTT_PUBLISH;
+        b[1] = (rl&0x7F)|0x80;
+        b[2] = rl>>7;
+    }
+    pk->len = fill-pk->start;
+    pk->publish = 1;
+    head++;
+    output();
+}
+
+/**
+ * @brief   Start a batch for topic in the next buffer
+ */
+static int
+openbatch(const char *topic, unsigned tl) {
+uint8_t *b;
+
+    if( head-tail >= MQTTPUB_BUFCOUNT )
+        return MQTTPUB_ERROR_NOBUFFER;
+    b = data[INDEX(head)];
+    b[HEADROOM]   = tl>>8;
+    b[HEADROOM+1] = tl;
+    memcpy(b+HEADROOM+2,topic,tl);
+    fill = HEADROOM+2+tl;
+    topiclen = tl;
+    filling = 1;
+    batchtime = sys_now();
+    return MQTTPUB_OK;
+}
+
+/**
+ * @brief   Get room for len bytes of samples of topic in the batch
+ *
+ * @note    Closes the batch when the topic is another or it is full, and opens
+ *          a new one. Returns the address of the room or null
+ */
+static uint8_t *
+room(const char *topic, unsigned len, int *rc) {
+unsigned tl = strlen(topic);
+uint8_t *b;
+
+    *rc = MQTTPUB_OK;
+    if( HEADROOM+2+tl+len > MQTTPUB_BUFSIZE ) {
+        *rc = MQTTPUB_ERROR_SIZE;
+        return 0;
+    }
+    if( state != STATE_CONNECTED ) {
+        stats.dropped++;
+        *rc = MQTTPUB_ERROR_NOTCONNECTED;
+        return 0;
+    }
+    if( filling ) {
+        b = data[INDEX(head)];
+        if( tl != topiclen || memcmp(b+HEADROOM+2,topic,tl) != 0 || fill+len > MQTTPUB_BUFSIZE )
+            closebatch();
+    }
+    if( !filling && (*rc = openbatch(topic,tl)) < 0 ) {
+        stats.dropped++;
+        return 0;
+    }
+    return data[INDEX(head)]+fill;
+}
+
+/**
+ * @brief   Queue a CONNECT or PINGREQ
+ */
+static int
+control(const uint8_t *hdr, unsigned hl, const char *id) {
+unsigned il = id ? strlen(id) : 0;
+Packet *pk;
+uint8_t *b;
+
+    closebatch();
+    // A remaining length of one byte
+    if( hl-2+2+il >= 128 )
+        return MQTTPUB_ERROR_SIZE;
+    if( head-tail >= MQTTPUB_BUFCOUNT )
+        return MQTTPUB_ERROR_NOBUFFER;
+    pk = &packets[INDEX(head)];
+    b  = data[INDEX(head)];
+    memcpy(b,hdr,hl);
+    pk->len = hl;
+    if( id ) {
+        b[1] = hl-2+2+il;
+        b[hl]   = il>>8;
+        b[hl+1] = il;
+        memcpy(b+hl+2,id,il);
+        pk->len += 2+il;
+    }
+    pk->start = 0;
+    pk->publish = 0;
+    head++;
+    output();
+    return MQTTPUB_OK;
+}
+
+/**
+ * @brief   lwIP callbacks
+ */
+///@{
+static void
+mqtt_err(void *arg, err_t err) {
+
+    // The pcb is already freed
+    pcb = 0;
+    reset();
+}
+
+static err_t
+mqtt_sent(void *arg, struct tcp_pcb *tpcb, u16_t len) {
+
+    acked += len;
+    while( tail != written && acked >= packets[INDEX(tail)].len ) {
+        acked -= packets[INDEX(tail)].len;
+        tail++;
+    }
+    output();
+    return ERR_OK;
+}
+
+static err_t
+mqtt_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
+struct pbuf *q;
+uint16_t i;
+uint8_t c;
+
+    if( p == 0 || err != ERR_OK ) {
+        if( p )
+            pbuf_free(p);
+        disconnect();
+        return ERR_ABRT;
+    }
+    tcp_recved(tpcb,p->tot_len);
+    for(q=p;q!=0;q=q->next) {
+        for(i=0;i<q->len;i++) {
+            c = ((uint8_t *) q->payload)[i];
+            rx[rxn++] = c;
+            // Only CONNACK (4 bytes) and PINGRESP (2 bytes) are expected
+            if( rxn == 2 && (rx[1]&0x80 || rx[1] > 2) ) {
+                pbuf_free(p);
+                disconnect();
+                return ERR_ABRT;
+            }
+            if( rxn < 2 || rxn < 2u+rx[1] )
+                continue;
+            if( (rx[0]&0xF0) == MQTT_CONNACK ) {
+                if( rxn != 4 || rx[3] != 0 ) {
+                    pbuf_free(p);
+                    disconnect();
+                    return ERR_ABRT;
+                }
+                state = STATE_CONNECTED;
+                stats.connects++;
+            }
+            rxn = 0;
+        }
+    }
+    pbuf_free(p);
+    return ERR_OK;
+}
+
+static err_t
+mqtt_connected(void *arg, struct tcp_pcb *tpcb, err_t err) {
+static const uint8_t connect[] = {
+    MQTT_CONNECT, 0,
+    0, 4, 'M', 'Q', 'T', 'T', MQTT_LEVEL, MQTT_CLEANSESSION,
+    (MQTTPUB_KEEPALIVE/1000)>>8, (MQTTPUB_KEEPALIVE/1000)&0xFF
+};
+
+    if( err != ERR_OK )
+        return err;
+    state = STATE_CONNACK;
+    attempttime = sys_now();
+    control(connect,sizeof(connect),client);
+    return ERR_OK;
+}
+///@}
+
+/**
+ * @brief   Start a connection to the broker
+ */
+static int
+brokerconnect(void) {
+
+    attempttime = sys_now();
+    pcb = tcp_new_ip_type(IP_GET_TYPE(&brokeraddr));
+    if( pcb == 0 )
+        return MQTTPUB_ERROR_TCP;
+    tcp_arg(pcb,0);
+    tcp_err(pcb,mqtt_err);
+    tcp_recv(pcb,mqtt_recv);
+    tcp_sent(pcb,mqtt_sent);
+    // Batches are sent at once, they are already full segments
+    tcp_nagle_disable(pcb);
+    state = STATE_CONNECTING;
+    if( tcp_connect(pcb,&brokeraddr,brokerport,mqtt_connected) != ERR_OK ) {
+        disconnect();
+        return MQTTPUB_ERROR_TCP;
+    }
+    return MQTTPUB_OK;
+}
+
+/**
+ * @brief   MQTTPub_Init
+ *
+ * @note    Connects to the broker at broker/port (0 for MQTTPUB_PORT) as
+ *          clientid, which must remain valid. The connection is retried every
+ *          MQTTPUB_RETRY ms by MQTTPub_Poll
+ */
+int
+MQTTPub_Init(const ip_addr_t *broker, uint16_t port, const char *clientid) {
+
+    disconnect();
+    memset(&stats,0,sizeof(stats));
+    lastsamples = lastpublishes = lastbytes = 0;
+    ip_addr_copy(brokeraddr,*broker);
+    brokerport = port ? port : MQTTPUB_PORT;
+    client = clientid;
+    ratetime = sys_now();
+    return brokerconnect();
+}
+
+/**
+ * @brief   MQTTPub_IsConnected
+ */
+int
+MQTTPub_IsConnected(void) {
+
+    return state == STATE_CONNECTED;
+}
+
+/**
+ * @brief   MQTTPub_Add
+ *
+ * @note    Appends len bytes to the batch of topic
+ */
+int
+MQTTPub_Add(const char *topic, const void *sample, unsigned len) {
+uint8_t *p;
+int rc;
+
+    p = room(topic,len,&rc);
+    if( p == 0 )
+        return rc;
+    memcpy(p,sample,len);
+    fill += len;
+    stats.samples++;
+    return MQTTPUB_OK;
+}
+
+/**
+ * @brief   MQTTPub_Printf
+ *
+ * @note    Formats a sample directly in the batch of topic. The samples are not
+ *          separated: the format can end with a new line
+ */
+int
+MQTTPub_Printf(const char *topic, const char *fmt, ...) {
+va_list ap;
+uint8_t *p;
+unsigned avail;
+int n,rc;
+
+    p = room(topic,0,&rc);
+    if( p == 0 )
+        return rc;
+    avail = MQTTPUB_BUFSIZE-fill;
+    va_start(ap,fmt);
+    n = vsnprintf((char *) p,avail,fmt,ap);
+    va_end(ap);
+    if( n < 0 )
+        return MQTTPUB_ERROR_SIZE;
+    if( (unsigned) n >= avail ) {
+        // Does not fit: in a new batch
+        if( (p = room(topic,n+1,&rc)) == 0 )
+            return rc;
+        va_start(ap,fmt);
+        n = vsnprintf((char *) p,MQTTPUB_BUFSIZE-fill,fmt,ap);
+        va_end(ap);
+    }
+    fill += n;
+    stats.samples++;
+    return MQTTPUB_OK;
+}
+
+/**
+ * @brief   MQTTPub_Flush
+ *
+ * @note    Sends the batch without waiting for MQTTPUB_MAXDELAY
+ */
+int
+MQTTPub_Flush(void) {
+
+    if( state != STATE_CONNECTED )
+        return MQTTPUB_ERROR_NOTCONNECTED;
+    closebatch();
+    return MQTTPUB_OK;
+}
+
+/**
+ * @brief   MQTTPub_Poll
+ *
+ * @note    Connects, closes old batches, sends PINGREQ when nothing was sent
+ *          for half the keep alive time and computes the rates
+ */
+void
+MQTTPub_Poll(void) {
+static const uint8_t pingreq[] = { MQTT_PINGREQ, 0 };
+uint32_t now = sys_now();
+uint32_t used;
+
+    switch( state ) {
+    case STATE_CLOSED:
+        if( now-attempttime >= MQTTPUB_RETRY )
+            brokerconnect();
+        break;
+    case STATE_CONNECTING:
+    case STATE_CONNACK:
+        if( now-attempttime >= MQTTPUB_RETRY )
+            disconnect();
+        break;
+    case STATE_CONNECTED:
+        if( filling && now-batchtime >= MQTTPUB_MAXDELAY )
+            closebatch();
+        if( now-sendtime >= MQTTPUB_KEEPALIVE/2 )
+            control(pingreq,sizeof(pingreq),0);
+        output();
+        break;
+    }
+
+    if( pcb ) {
+        stats.sndqueue = tcp_sndqueuelen(pcb);
+        stats.sndbytes = TCP_SND_BUF-tcp_sndbuf(pcb);
+    } else {
+        stats.sndqueue = 0;
+        stats.sndbytes = 0;
+    }
+    used = head-tail+filling;
+    stats.buffers = used;
+    if( stats.sndqueue > stats.sndqueuemax )
+        stats.sndqueuemax = stats.sndqueue;
+    if( stats.sndbytes > stats.sndbytesmax )
+        stats.sndbytesmax = stats.sndbytes;
+    if( stats.buffers > stats.buffersmax )
+        stats.buffersmax = stats.buffers;
+
+    if( now-ratetime >= 1000 ) {
+        stats.samplerate  = (stats.samples-lastsamples)*1000/(now-ratetime);
+        stats.publishrate = (stats.publishes-lastpublishes)*1000/(now-ratetime);
+        stats.kbps        = (stats.bytes-lastbytes)*8/(now-ratetime);
+        lastsamples   = stats.samples;
+        lastpublishes = stats.publishes;
+        lastbytes     = stats.bytes;
+        ratetime      = now;
+    }
+}
+
+/**
+ * @brief   MQTTPub_GetStats
+ */
+void
+MQTTPub_GetStats(MQTTPub_Stats *s) {
+
+    *s = stats;
+}
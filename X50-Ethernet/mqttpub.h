@@ -0,0 +1,112 @@
+#ifndef MQTTPUB_H
+#define MQTTPUB_H
+/**
+ * @file    mqttpub.h
+ *
+ * @note    MQTT 3.1.1 publisher for telemetry (QoS 0 only)
+ *
+ * @note    Samples are appended to the PUBLISH packet being built in a batch
+ *          buffer (MQTTPub_Add, MQTTPub_Printf format in place). A batch is
+ *          sent, as one PUBLISH with all its samples, when it is full, when the
+ *          topic changes or MQTTPUB_MAXDELAY ms after its first sample
+ *
+ * @note    The buffers are given to tcp_write without copy, so lwIP sends the
+ *          segments from them (reference pbufs), and a buffer is reused when its
+ *          bytes are acknowledged. With QoS 0 there is no reply: when all buffers
+ *          are waiting for the network, or there is no connection, samples are
+ *          dropped and counted
+ *
+ * @note    The lwIP MQTT client (apps/mqtt/mqtt.c) is not used: it copies each
+ *          message into its output ring and tcp_write copies it again
+ *
+ * @note    All functions use the lwIP raw API. They must be called in the main
+ *          loop (NO_SYS) or in the tcpip thread (LWIP_UCOS2). MQTTPub_Poll must
+ *          be called periodically (each ms to 100 ms)
+ */
+
+#include <stdint.h>
+
+#include "lwip/ip_addr.h"
+
+/**
+ * @brief   Batch buffers
+ *
+ * @note    A batch fills a TCP segment (TCP_MSS). Each buffer in flight uses a
+ *          reference pbuf (MEMP_NUM_PBUF in lwipopts.h)
+ */
+///@{
+#ifndef MQTTPUB_BUFCOUNT
+#define MQTTPUB_BUFCOUNT            8
+#endif
+#ifndef MQTTPUB_BUFSIZE
+#define MQTTPUB_BUFSIZE             1460
+#endif
+///@}
+
+/**
+ * @brief   Timing in ms
+ */
+///@{
+#ifndef MQTTPUB_MAXDELAY
+#define MQTTPUB_MAXDELAY            20      ///< of a sample in the batch
+#endif
+#ifndef MQTTPUB_KEEPALIVE
+#define MQTTPUB_KEEPALIVE           60000
+#endif
+#ifndef MQTTPUB_RETRY
+#define MQTTPUB_RETRY               5000    ///< between connection attempts
+#endif
+///@}
+
+/**
+ * @brief   Default broker port
+ */
+#ifndef MQTTPUB_PORT
+#define MQTTPUB_PORT                1883
+#endif
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define MQTTPUB_OK                  (0)
+#define MQTTPUB_ERROR_NOTCONNECTED  (-1)
+#define MQTTPUB_ERROR_NOBUFFER      (-2)    ///< sample dropped
+#define MQTTPUB_ERROR_SIZE          (-3)    ///< larger than a batch
+#define MQTTPUB_ERROR_TCP           (-4)
+///@}
+
+/**
+ * @brief   Counters
+ *
+ * @note    The rates are computed every second. sndqueue is the number of TCP
+ *          segments not acknowledged (tcp_sndqueuelen) and sndbytes the bytes
+ *          (TCP_SND_BUF minus tcp_sndbuf), with their maxima. buffers is the
+ *          number of batch buffers in use
+ */
+typedef struct {
+    uint32_t    samples;                    ///< added to batches
+    uint32_t    publishes;                  ///< PUBLISH packets given to TCP
+    uint32_t    bytes;                      ///< MQTT bytes given to TCP
+    uint32_t    dropped;                    ///< samples
+    uint32_t    connects;                   ///< accepted by the broker
+    uint32_t    samplerate;                 ///< samples/s
+    uint32_t    publishrate;                ///< PUBLISH/s
+    uint32_t    kbps;                       ///< kbit/s of MQTT data
+    uint16_t    sndqueue;
+    uint16_t    sndqueuemax;
+    uint32_t    sndbytes;
+    uint32_t    sndbytesmax;
+    uint16_t    buffers;
+    uint16_t    buffersmax;
+} MQTTPub_Stats;
+
+int  MQTTPub_Init(const ip_addr_t *broker, uint16_t port, const char *clientid);
+int  MQTTPub_IsConnected(void);
+int  MQTTPub_Add(const char *topic, const void *data, unsigned len);
+int  MQTTPub_Printf(const char *topic, const char *fmt, ...);
+int  MQTTPub_Flush(void);
+void MQTTPub_Poll(void);
+void MQTTPub_GetStats(MQTTPub_Stats *stats);
+
+#endif // MQTTPUB_H
@@ -0,0 +1,252 @@
+/**
+ * @file    netbench.c
+ *
+ * @note    UDP benchmark server (see netbench.h)
+ *
+ * @note    ECHO datagrams are sent back in the same pbuf, after the header is
+ *          updated, so the time in the board includes only lwIP and the driver.
+ *          The source allocates a PBUF_RAM for each datagram. When the driver
+ *          rejects it (ring full), the same sequence number is sent again at
+ *          the next timeout
+ *
+ * @note    The sink keeps the next expected sequence number. A larger number
+ *          adds the gap to lost and a smaller one is counted as reordered and
+ *          removed from lost
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "lwip/opt.h"
+#include "lwip/pbuf.h"
+#include "lwip/udp.h"
+#include "lwip/timeouts.h"
+#include "eth.h"
+#include "netbench.h"
+
+/**
+ * @brief   Source pacing
+ */
+///@{
+#define NETBENCH_POLLINTERVAL       1       // ms
+#define NETBENCH_MAXPAYLOAD         (ETH_MTU-28)
+///@}
+
+/**
+ * @brief   State
+ */
+///@{
+static struct udp_pcb   *benchpcb = 0;
+
+// Sink
+static uint32_t         received;
+static uint32_t         lost;
+static uint32_t         reordered;
+static uint32_t         bytes;
+static uint32_t         expected;
+static uint32_t         firstcycles;
+static uint32_t         lastcycles;
+
+// Source
+static ip_addr_t        srcaddr;
+static u16_t            srcport;
+static uint32_t         srccount = 0;       // datagrams to send
+static uint32_t         srcsize;
+static uint32_t         srcrate;
+static uint32_t         srcstart;           // sys_now at START
+static uint32_t         sent;
+static uint32_t         senderrors;
+///@}
+
+/**
+ * @brief   netbench_reset
+ */
+static void
+netbench_reset(void) {
+
+    received = lost = reordered = bytes = 0;
+    expected = 0;
+    firstcycles = lastcycles = 0;
+    sent = senderrors = 0;
+}
+
+/**
+ * @brief   netbench_report
+ *
+ * @note    Answers with the counters
+ */
+static void
+netbench_report(const ip_addr_t *addr, u16_t port) {
+NetBench_Header h;
+struct pbuf *r;
+
+    memset(&h,0,sizeof(h));
+    h.magic = NETBENCH_MAGIC;
+    h.type  = NETBENCH_TYPE_REPORT;
+    h.value[NETBENCH_REPORT_RECEIVED]   = received;
+    h.value[NETBENCH_REPORT_LOST]       = lost;
+    h.value[NETBENCH_REPORT_REORDERED]  = reordered;
+    h.value[NETBENCH_REPORT_BYTES]      = bytes;
+    h.value[NETBENCH_REPORT_ELAPSED]    = (lastcycles-firstcycles)/(SystemCoreClock/1000000);
+    h.value[NETBENCH_REPORT_SENT]       = sent;
+    h.value[NETBENCH_REPORT_SENDERRORS] = senderrors;
+    h.value[NETBENCH_REPORT_CLOCK]      = SystemCoreClock;
+
+    r = pbuf_alloc(PBUF_TRANSPORT,sizeof(h),PBUF_RAM);
+    if( r == NULL )
+        return;
+    h.txcycles = DWT->CYCCNT;
+    memcpy(r->payload,&h,sizeof(h));
+    udp_sendto(benchpcb,r,addr,port);
+    pbuf_free(r);
+}
+
+/**
+ * @brief   netbench_timer
+ *
+ * @note    Sends the SOURCE datagrams due since START
+ */
+static void
+netbench_timer(void *arg) {
+NetBench_Header h;
+struct pbuf *p;
+uint32_t due;
+err_t err;
+
+    LWIP_UNUSED_ARG(arg);
+
+    due = srccount;
+    if( srcrate != 0 ) {
+        due = (uint32_t) ((uint64_t) (sys_now()-srcstart)*srcrate/1000)+1;
+        if( due > srccount )
+            due = srccount;
+    }
+
+    memset(&h,0,sizeof(h));
+    h.magic = NETBENCH_MAGIC;
+    h.type  = NETBENCH_TYPE_SOURCE;
+    h.size  = srcsize;
+    h.value[NETBENCH_REPORT_CLOCK] = SystemCoreClock;
+    while( sent < due ) {
+        p = pbuf_alloc(PBUF_TRANSPORT,srcsize,PBUF_RAM);
+        if( p == NULL ) {
+            senderrors++;
+            break;
+        }
+        h.seq      = sent;
+        h.txcycles = DWT->CYCCNT;
+        memcpy(p->payload,&h,sizeof(h));
+        memset((uint8_t *) p->payload+sizeof(h),0,srcsize-sizeof(h));
+        err = udp_sendto(benchpcb,p,&srcaddr,srcport);
+        pbuf_free(p);
+        if( err != ERR_OK ) {
+            senderrors++;
+            break;
+        }
+        sent++;
+    }
+
+    if( sent < srccount )
+        sys_timeout(NETBENCH_POLLINTERVAL,netbench_timer,0);
+    else
+        srccount = 0;
+}
+
+/**
+ * @brief   netbench_recv
+ */
+static void
+netbench_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+              const ip_addr_t *addr, u16_t port) {
+uint32_t now = DWT->CYCCNT;
+NetBench_Header h;
+
+    LWIP_UNUSED_ARG(arg);
+
+    if( pbuf_copy_partial(p,&h,sizeof(h),0) != sizeof(h) || h.magic != NETBENCH_MAGIC ) {
+        pbuf_free(p);
+        return;
+    }
+
+    switch( h.type ) {
+    case NETBENCH_TYPE_ECHO:
+        h.rxcycles = now;
+        h.value[NETBENCH_REPORT_CLOCK] = SystemCoreClock;
+        h.txcycles = DWT->CYCCNT;
+        pbuf_take_at(p,&h,sizeof(h),0);
+        udp_sendto(pcb,p,addr,port);
+        break;
+    case NETBENCH_TYPE_DATA:
+        if( received == 0 )
+            firstcycles = now;
+        lastcycles = now;
+        received++;
+        bytes += p->tot_len;
+        if( h.seq >= expected ) {
+            lost += h.seq-expected;
+            expected = h.seq+1;
+        } else {
+            reordered++;
+            if( lost > 0 )
+                lost--;
+        }
+        break;
+    case NETBENCH_TYPE_START:
+        if( srccount != 0 )
+            break;                          // already running
+        ip_addr_copy(srcaddr,*addr);
+        srcport  = port;
+        srcsize  = h.value[1];
+        if( srcsize < sizeof(h) )          srcsize = sizeof(h);
+        if( srcsize > NETBENCH_MAXPAYLOAD ) srcsize = NETBENCH_MAXPAYLOAD;
+        srcrate  = h.value[2];
+        srcstart = sys_now();
+        sent = senderrors = 0;
+        srccount = h.value[0];
+        if( srccount != 0 )
+            sys_timeout(NETBENCH_POLLINTERVAL,netbench_timer,0);
+        break;
+    case NETBENCH_TYPE_RESET:
+        netbench_reset();
+        netbench_report(addr,port);
+        break;
+    case NETBENCH_TYPE_REPORT:
+        netbench_report(addr,port);
+        break;
+    }
+    pbuf_free(p);
+}
+
+/**
+ * @brief   NetBench_Init
+ *
+ * @note    Must be called after the netif is up, in the main loop or in the
+ *          tcpip thread. Returns 0 or -1
+ */
+int
+NetBench_Init(unsigned port) {
+
+    // Cycle counter for the timestamps (as in Profile_Init)
+    if( (DWT->CTRL&DWT_CTRL_CYCCNTENA_Msk) == 0 ) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->LAR = 0xC5ACCE55;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+
+    netbench_reset();
+    benchpcb = udp_new();
+    if( benchpcb == 0 )
+        return -1;
+    if( udp_bind(benchpcb,IP_ANY_TYPE,port) != ERR_OK ) {
+        udp_remove(benchpcb);
+        benchpcb = 0;
+        return -1;
+    }
+    udp_recv(benchpcb,netbench_recv,0);
+    return 0;
+}
@@ -0,0 +1,81 @@
+#ifndef NETBENCH_H
+#define NETBENCH_H
+/**
+ * @file    netbench.h
+ *
+ * @note    UDP benchmark server: echo, sink and source (host side is
+ *          tools/netbench.c)
+ *
+ * @note    Every datagram starts with a NetBench_Header. The type selects
+ *          what the board does:
+ *          * ECHO: sent back with the DWT->CYCCNT values at reception and at
+ *            transmission, so the host separates the time in the board from
+ *            the round trip time
+ *          * DATA: counted by the sink. Gaps in the sequence numbers are lost
+ *            datagrams, smaller numbers are reordered ones
+ *          * START: the board sends value[0] datagrams of value[1] bytes to
+ *            the sender at value[2] datagrams/s (0 for the maximal rate), as
+ *            SOURCE datagrams numbered from 0
+ *          * REPORT: answered with the counters (see NETBENCH_REPORT_*)
+ *          * RESET: clears the counters and is answered as REPORT
+ *
+ * @note    All fields are little endian
+ *
+ * @note    Uses the raw API. NetBench_Init must be called in the main loop
+ *          (NO_SYS) or in the tcpip thread (LWIP_UCOS2). The source is paced by
+ *          a lwIP timeout of 1 ms
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   UDP port of the server
+ */
+#ifndef NETBENCH_PORT
+#define NETBENCH_PORT               7000
+#endif
+
+/**
+ * @brief   Header of every datagram
+ */
+///@{
+#define NETBENCH_MAGIC              0x48434E42      // "NBCH"
+
+#define NETBENCH_TYPE_ECHO          1
+#define NETBENCH_TYPE_DATA          2
+#define NETBENCH_TYPE_START         3
+#define NETBENCH_TYPE_SOURCE        4
+#define NETBENCH_TYPE_REPORT        5
+#define NETBENCH_TYPE_RESET         6
+
+typedef struct {
+    uint32_t    magic;
+    uint16_t    type;
+    uint16_t    size;                   ///< datagram size (SOURCE)
+    uint32_t    seq;                    ///< sequence number
+    uint32_t    rxcycles;               ///< CYCCNT at reception (ECHO)
+    uint32_t    txcycles;               ///< CYCCNT at transmission
+    uint32_t    value[8];               ///< depends on type
+} NetBench_Header;
+///@}
+
+/**
+ * @brief   Fields of value in a REPORT answer
+ */
+///@{
+#define NETBENCH_REPORT_RECEIVED    0   ///< DATA datagrams received
+#define NETBENCH_REPORT_LOST        1   ///< missing DATA sequence numbers
+#define NETBENCH_REPORT_REORDERED   2   ///< DATA received after a larger number
+#define NETBENCH_REPORT_BYTES       3   ///< DATA bytes received (UDP payload)
+#define NETBENCH_REPORT_ELAPSED     4   ///< us from the first to the last DATA
+#define NETBENCH_REPORT_SENT        5   ///< SOURCE datagrams sent
+#define NETBENCH_REPORT_SENDERRORS  6   ///< SOURCE datagrams retried (ring full)
+#define NETBENCH_REPORT_CLOCK       7   ///< CYCCNT frequency in Hz (also ECHO)
+///@}
+
+int  NetBench_Init(unsigned port);
+
+#endif // NETBENCH_H
@@ -0,0 +1,159 @@
+/**
+ * @file    netstats.c
+ *
+ * @note    UDP status endpoint with the counters of eth.c, stnetif.c and
+ *          udpstream.c
+ *
+ * @note    Uses the raw API, so the receive callback runs in the main loop
+ *          (NO_SYS) or in the tcpip thread (LWIP_UCOS2), where lwIP can be
+ *          called. A datagram with the text "reset" clears the counters after
+ *          the report
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "lwip/opt.h"
+#include "lwip/pbuf.h"
+#include "lwip/udp.h"
+#include "eth.h"
+#include "stnetif.h"
+#include "udpstream.h"
+#include "stack.h"
+#include "netstats.h"
+
+/**
+ * @brief   Size of the report
+ */
+#define NETSTATS_BUFSIZE            1536
+
+/**
+ * @brief   PCB of the endpoint
+ */
+static struct udp_pcb *netstatspcb = 0;
+
+/**
+ * @brief   NetStats_Format
+ *
+ * @note    Writes the report into buf. Returns its length
+ */
+int
+NetStats_Format(char *buf, int size) {
+ETH_Statistics es;
+struct stnetif_stats ns;
+UDPStream_Stats us;
+Stack_Info si;
+int n = 0, k, lo;
+
+    ETH_GetStatistics(&es);
+    stnetif_getstats(&ns);
+    UDPStream_GetStats(&us);
+    Stack_GetInfo(&si);
+
+#define NETSTATS_PUT(...) \
+        do { if( n < size ) n += snprintf(buf+n,size-n,__VA_ARGS__); } while(0)
+
+    NETSTATS_PUT("rxframes %lu\n",(unsigned long) es.rxframes);
+    NETSTATS_PUT("rxbytes %lu\n",(unsigned long) es.rxbytes);
+    NETSTATS_PUT("txframes %lu\n",(unsigned long) es.txframes);
+    NETSTATS_PUT("txbytes %lu\n",(unsigned long) es.txbytes);
+    NETSTATS_PUT("rxirqs %lu\n",(unsigned long) es.rxirqs);
+    NETSTATS_PUT("rxbufferunavailable %lu\n",(unsigned long) es.rxbufferunavailable);
+    NETSTATS_PUT("rxoverflow %lu\n",(unsigned long) es.rxoverflow);
+    NETSTATS_PUT("rxchecksumerrors %lu\n",(unsigned long) es.rxchecksumerrors);
+    NETSTATS_PUT("rxcrcerrors %lu\n",(unsigned long) es.rxcrcerrors);
+    NETSTATS_PUT("rxalignerrors %lu\n",(unsigned long) es.rxalignerrors);
+    NETSTATS_PUT("rxvlandropped %lu\n",(unsigned long) es.rxvlandropped);
+    NETSTATS_PUT("rxrawframes %lu\n",(unsigned long) es.rxrawframes);
+    NETSTATS_PUT("rxnopbuf %lu\n",(unsigned long) ns.rxnopbuf);
+    NETSTATS_PUT("rxinputerrors %lu\n",(unsigned long) ns.rxinputerrors);
+    NETSTATS_PUT("txerrors %lu\n",(unsigned long) ns.txerrors);
+    NETSTATS_PUT("reassfragments %lu\n",(unsigned long) ns.reassfragments);
+    NETSTATS_PUT("reassdropped %lu\n",(unsigned long) ns.reassdropped);
+    NETSTATS_PUT("reassoverflow %lu\n",(unsigned long) ns.reassoverflow);
+    NETSTATS_PUT("reasstimeouts %lu\n",(unsigned long) ns.reasstimeouts);
+    NETSTATS_PUT("latencycount %lu\n",(unsigned long) ns.latencycount);
+    if( ns.latencycount ) {
+        NETSTATS_PUT("latencymin %lu\n",(unsigned long) ns.latencymin);
+        NETSTATS_PUT("latencymax %lu\n",(unsigned long) ns.latencymax);
+        NETSTATS_PUT("latencyavg %lu\n",
+                (unsigned long) (ns.latencytotal/ns.latencycount));
+    }
+    // Histogram: lower limit of each bucket in cycles and count
+    for(k=0;k<STNETIF_LATENCY_BUCKETS;k++) {
+        if( ns.latency[k] == 0 )
+            continue;
+        lo = k == 0 ? 0 : 1<<(k+7);
+        NETSTATS_PUT("latency%d %lu\n",lo,(unsigned long) ns.latency[k]);
+    }
+    // UDP stream (udpstream.c), when used
+    if( us.datagrams || us.senderrors ) {
+        NETSTATS_PUT("streamdatagrams %lu\n",(unsigned long) us.datagrams);
+        NETSTATS_PUT("streambytes %lu\n",(unsigned long) us.bytes);
+        NETSTATS_PUT("streamnobuffer %lu\n",(unsigned long) us.nobuffer);
+        NETSTATS_PUT("streamsenderrors %lu\n",(unsigned long) us.senderrors);
+        NETSTATS_PUT("streamkbps %lu\n",(unsigned long) us.kbps);
+    }
+    // Stack high water marks (stack.c)
+    NETSTATS_PUT("stacksize %lu\n",(unsigned long) si.size);
+    NETSTATS_PUT("stackused %lu\n",(unsigned long) si.used);
+    NETSTATS_PUT("stackfree %lu\n",(unsigned long) si.free);
+    if( si.isrsize ) {
+        NETSTATS_PUT("isrstacksize %lu\n",(unsigned long) si.isrsize);
+        NETSTATS_PUT("isrstackused %lu\n",(unsigned long) si.isrused);
+    }
+#undef NETSTATS_PUT
+
+    return n < size ? n : size-1;
+}
+
+/**
+ * @brief   netstats_recv
+ *
+ * @note    Answers each datagram with the report
+ */
+static void
+netstats_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+              const ip_addr_t *addr, u16_t port) {
+static char buf[NETSTATS_BUFSIZE];
+struct pbuf *r;
+int reset,n;
+
+    LWIP_UNUSED_ARG(arg);
+    reset = pbuf_memfind(p,"reset",5,0) != 0xFFFF;
+    pbuf_free(p);
+
+    n = NetStats_Format(buf,sizeof(buf));
+    r = pbuf_alloc(PBUF_TRANSPORT,n,PBUF_RAM);
+    if( r == NULL )
+        return;
+    memcpy(r->payload,buf,n);
+    udp_sendto(pcb,r,addr,port);
+    pbuf_free(r);
+
+    if( reset ) {
+        stnetif_resetstats();
+        UDPStream_ResetStats();
+    }
+}
+
+/**
+ * @brief   NetStats_Init
+ *
+ * @note    Must be called after the netif is up, in the main loop or in the
+ *          tcpip thread. Returns 0 or -1
+ */
+int
+NetStats_Init(unsigned port) {
+
+    netstatspcb = udp_new();
+    if( netstatspcb == 0 )
+        return -1;
+    if( udp_bind(netstatspcb,IP_ANY_TYPE,port) != ERR_OK ) {
+        udp_remove(netstatspcb);
+        netstatspcb = 0;
+        return -1;
+    }
+    udp_recv(netstatspcb,netstats_recv,0);
+    return 0;
+}
@@ -0,0 +1,22 @@
+#ifndef NETSTATS_H
+#define NETSTATS_H
+/**
+ * @file    netstats.h
+ *
+ * @note    UDP status endpoint with the driver statistics
+ *
+ * @note    Any datagram sent to NETSTATS_PORT is answered with a text report,
+ *          one "name value" pair per line (echo | nc -u -w1 <board> 7777)
+ */
+
+/**
+ * @brief   UDP port of the endpoint
+ */
+#ifndef NETSTATS_PORT
+#define NETSTATS_PORT               7777
+#endif
+
+int  NetStats_Init(unsigned port);
+int  NetStats_Format(char *buf, int size);
+
+#endif // NETSTATS_H
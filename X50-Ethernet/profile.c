@@ -0,0 +1,118 @@
+/**
+ * @file    profile.c
+ *
+ * @note    Probes for measurement of execution time using DWT->CYCCNT
+ *
+ * @note    The probes are stored in a static table (probetab), so they can be
+ *          inspected with the debugger when there is no console.
+ *
+ * @note    The cost of reading the counter is measured by Profile_Init and
+ *          subtracted from every measurement.
+ *
+ * @note    Profile_Dump uses printf. Define PROFILE_NODUMP when there is no stdio.
+ */
+
+#ifdef PROFILE_ENABLE
+
+#ifndef PROFILE_NODUMP
+#include <stdio.h>
+#endif
+#include "stm32f746xx.h"
+#include "profile.h"
+
+/**
+ * @brief   Probe table
+ */
+///@{
+PROFILE_Probe   probetab[PROFILE_MAXPROBES];
+int             probecount = 0;
+uint32_t        profileoverhead = 0;
+///@}
+
+/**
+ * @brief   Enable cycle counter and measure overhead
+ */
+void
+Profile_Init(void) {
+PROFILE_Probe p = { "overhead", 0, UINT32_MAX, 0, 0 };
+uint32_t start;
+int i;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;                  // Unlock access on Cortex-M7
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    profileoverhead = 0;
+    for(i=0;i<8;i++) {
+        start = DWT->CYCCNT;
+        Profile_Update(&p,start);
+    }
+    profileoverhead = p.min;
+}
+
+/**
+ * @brief   Get a probe
+ *
+ * @note    Returns 0 when the table is full. The measurements are discarded.
+ */
+PROFILE_Probe *
+Profile_Register(const char *name) {
+PROFILE_Probe *p;
+
+    if( (DWT->CTRL&DWT_CTRL_CYCCNTENA_Msk) == 0 )
+        Profile_Init();
+
+    if( probecount >= PROFILE_MAXPROBES )
+        return 0;
+
+    p = &probetab[probecount++];
+    p->name  = name;
+    p->count = 0;
+    p->min   = UINT32_MAX;
+    p->max   = 0;
+    p->total = 0;
+    return p;
+}
+
+/**
+ * @brief   Clear measurements of all probes
+ */
+void
+Profile_Reset(void) {
+int i;
+
+    for(i=0;i<probecount;i++) {
+        probetab[i].count = 0;
+        probetab[i].min   = UINT32_MAX;
+        probetab[i].max   = 0;
+        probetab[i].total = 0;
+    }
+}
+
+#ifndef PROFILE_NODUMP
+/**
+ * @brief   Print measurements of all probes
+ *
+ * @note    Values in cycles of the core clock
+ */
+void
+Profile_Dump(void) {
+PROFILE_Probe *p;
+int i;
+
+    printf("%-24s %10s %10s %10s %10s\n","probe","count","min","max","mean");
+    for(i=0;i<probecount;i++) {
+        p = &probetab[i];
+        if( p->count == 0 ) {
+            printf("%-24s %10d\n",p->name,0);
+            continue;
+        }
+        printf("%-24s %10lu %10lu %10lu %10lu\n",p->name,
+               (unsigned long) p->count,(unsigned long) p->min,
+               (unsigned long) p->max,(unsigned long) (p->total/p->count));
+    }
+}
+#endif
+
+#endif
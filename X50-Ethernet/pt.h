@@ -0,0 +1,102 @@
+#ifndef PT_H
+#define PT_H
+/**
+ * @file    pt.h
+ *
+ * @note    Stackless coroutines (protothreads)
+ *
+ * @note    A protothread is a function that returns when it must wait and
+ *          continues at the same point when it is called again. The point is
+ *          kept in a struct pt as the line number of the wait, and PT_BEGIN
+ *          opens a switch on it, so the waits are case labels (Duff's device).
+ *          A protothread has no stack of its own: local variables are lost at
+ *          a wait and must be static or in a state structure
+ *
+ * @note    The macros cannot be used inside a switch of the protothread
+ *          function, and there can be only one wait per line
+ *
+ * @note    Usage
+ *
+ *          static PT_THREAD(Reset(struct pt *pt)) {
+ *              PT_BEGIN(pt);
+ *              StartReset();
+ *              PT_WAIT_UNTIL(pt,ResetDone());
+ *              PT_END(pt);
+ *          }
+ *
+ *          PT_INIT(&pt);
+ *          while( PT_SCHEDULE(Reset(&pt)) ) { other work }
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   State of a protothread
+ */
+struct pt {
+    uint16_t    lc;                 ///< line of the last wait, 0 at the beginning
+};
+
+/**
+ * @brief   Return values of a protothread
+ */
+///@{
+#define PT_WAITING                  0
+#define PT_YIELDED                  1
+#define PT_EXITED                   2
+#define PT_ENDED                    3
+///@}
+
+/**
+ * @brief   Declaration and control
+ */
+///@{
+#define PT_THREAD(DECL)             char DECL
+#define PT_INIT(PT)                 do { (PT)->lc = 0; } while(0)
+#define PT_SCHEDULE(F)              ((F) < PT_EXITED)
+///@}
+
+/**
+ * @brief   Body of a protothread
+ */
+///@{
+#define PT_BEGIN(PT)                { char pt_yielded = 1; (void) pt_yielded; \
+                                      switch((PT)->lc) { case 0:
+
+#define PT_END(PT)                  } pt_yielded = 0; PT_INIT(PT); return PT_ENDED; }
+
+#define PT_WAIT_UNTIL(PT,COND)      do { (PT)->lc = __LINE__; case __LINE__:    \
+                                         if( !(COND) ) return PT_WAITING;       \
+                                    } while(0)
+
+#define PT_WAIT_WHILE(PT,COND)      PT_WAIT_UNTIL((PT),!(COND))
+
+#define PT_WAIT_THREAD(PT,F)        PT_WAIT_WHILE((PT),PT_SCHEDULE(F))
+
+#define PT_SPAWN(PT,CHILD,F)        do { PT_INIT(CHILD);                        \
+                                         PT_WAIT_THREAD((PT),(F));              \
+                                    } while(0)
+
+#define PT_YIELD(PT)                do { pt_yielded = 0; (PT)->lc = __LINE__;   \
+                                         case __LINE__:                         \
+                                         if( pt_yielded == 0 ) return PT_YIELDED; \
+                                    } while(0)
+
+#define PT_RESTART(PT)              do { PT_INIT(PT); return PT_WAITING; } while(0)
+
+#define PT_EXIT(PT)                 do { PT_INIT(PT); return PT_EXITED; } while(0)
+///@}
+
+/**
+ * @brief   Waits until NOW-START >= TIME (free running counter, e.g. DWT->CYCCNT
+ *          or a tick count). START must be static
+ */
+#define PT_WAIT_ELAPSED(PT,START,TIME,NOW) \
+                                    do { (START) = (NOW);                       \
+                                         PT_WAIT_UNTIL((PT),(uint32_t) ((NOW)-(START)) >= (uint32_t) (TIME)); \
+                                    } while(0)
+
+#endif // PT_H
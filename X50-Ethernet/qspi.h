@@ -0,0 +1,114 @@
+#ifndef QSPI_H
+#define QSPI_H
+/**
+ * @file    qspi.h
+ *
+ * @note    Driver for the 16 MB N25Q128A NOR flash of the STM32F746 Discovery
+ *          board, connected to the QUADSPI interface (bank 1)
+ *
+ * @note    QSPI_Read uses QUAD I/O FAST READ (EBh, address and data on 4
+ *          lines) and QSPI_Write QUAD INPUT FAST PROGRAM (32h, data on 4 lines),
+ *          both with DMA2 Stream 7. The flash is clocked at HCLK/2 (100 MHz)
+ *
+ * @note    After QSPI_EnableMemoryMapped, the flash is read by the CPU (and by
+ *          DMA masters) at QSPI_ADDRESS like internal memory, using the same
+ *          EBh command: constants, fonts, images and code can be used in place.
+ *          QSPI_Write and the erase functions leave this mode during the
+ *          operation and come back to it, invalidating the caches
+ *
+ * @note    The MPU makes the QSPI area a device (no speculative reads, that
+ *          would hang the bus outside memory mapped mode) and changes the
+ *          flash to normal write through memory in memory mapped mode.
+ *          Cache_Init must be called before QSPI_Init
+ *
+ * @note    The startup code calls QSPI_StartupInit before main, so code and
+ *          constants in the QSPI flash can be used from the start
+ *
+ * @note    QSPI_Write and the erase functions are blocking. QSPI_StartWrite
+ *          (one page), QSPI_StartEraseSubsector and QSPI_StartEraseSector return
+ *          once the command is sent, so the CPU can go on (e.g. receiving the
+ *          next data) while the flash works. QSPI_Busy tells when it is done.
+ *          Meanwhile the flash is not mapped: code and constants in it must not
+ *          be used, not even by interrupts
+ *
+ * @note    QSPI_Tick must be called every ms (e.g. from SysTick_Handler) to
+ *          count the timeouts. Before that, there are no timeouts
+ *
+ * @note    Erased bytes are FFh and programming only changes bits from 1 to 0.
+ *          Data must be written to erased areas
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Flash geometry
+ */
+///@{
+#define QSPI_ADDRESS                    0x90000000
+#define QSPI_SIZE                       0x01000000      // 16 MB
+#define QSPI_PAGESIZE                   256
+#define QSPI_SUBSECTORSIZE              4096
+#define QSPI_SECTORSIZE                 65536
+///@}
+
+/**
+ * @brief   MPU regions used (see cache.h)
+ *
+ * @note    QSPI_MPUREGION (256 MB device) and QSPI_MPUREGION+1 (flash in memory
+ *          mapped mode)
+ */
+#ifndef QSPI_MPUREGION
+#define QSPI_MPUREGION                  CACHE_REGION_FREE
+#endif
+
+/**
+ * @brief   Attributes to place code and constants in the QSPI flash
+ *
+ * @note    The .qspi_text and .qspi_rodata sections are linked at QSPI_ADDRESS
+ *          and written to the QSPI flash from a separate image (see stm32f746.ld
+ *          and Makefile). Functions must be called only in memory mapped mode.
+ *          They are not inlined and are called with long calls (the QSPI is far
+ *          from the internal flash)
+ */
+///@{
+#define QSPI_CODE                       __attribute__((section(".qspi_text"),noinline,noclone,long_call))
+#define QSPI_CONST                      __attribute__((section(".qspi_rodata")))
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define QSPI_OK                         0
+#define QSPI_ERROR_TIMEOUT              -1
+#define QSPI_ERROR_ID                   -2      // not a N25Q128
+#define QSPI_ERROR_PARAMETER            -3
+#define QSPI_ERROR_PROGRAM              -4
+#define QSPI_ERROR_ERASE                -5
+#define QSPI_ERROR_PROTECTED            -6
+#define QSPI_ERROR_NOTINITIALIZED       -7
+#define QSPI_ERROR_TRANSFER             -8      // DMA or QUADSPI error
+///@}
+
+int  QSPI_Init(void);
+int  QSPI_ReadID(uint8_t id[3]);
+int  QSPI_Read(uint32_t address, void *data, uint32_t n);
+int  QSPI_Write(uint32_t address, const void *data, uint32_t n);
+int  QSPI_EraseSubsector(uint32_t address);
+int  QSPI_EraseSector(uint32_t address);
+int  QSPI_EraseChip(void);
+int  QSPI_StartWrite(uint32_t address, const void *data, uint32_t n);
+int  QSPI_StartEraseSubsector(uint32_t address);
+int  QSPI_StartEraseSector(uint32_t address);
+int  QSPI_Busy(void);
+int  QSPI_Wait(void);
+int  QSPI_EnableMemoryMapped(void);
+int  QSPI_DisableMemoryMapped(void);
+int  QSPI_IsMemoryMapped(void);
+void QSPI_StartupInit(void);
+void QSPI_Tick(void);
+
+#endif // QSPI_H
@@ -0,0 +1,566 @@
+/**
+ * @file    rfb.c
+ *
+ * @note    Remote frame buffer over UDP (see rfb.h)
+ *
+ * @note    A frame goes thru three states. IDLE: damage is collected. CAPTURING:
+ *          the damaged rectangles are queued in the DMA2D as copies with pixel
+ *          format conversion into the capture buffer and the last fence is
+ *          polled. SENDING: the rectangles are coded line by line against the
+ *          copy of the frame of the viewer (previous), which is updated at the
+ *          same time, and sent, RFB_MAXDATAGRAMS at each call to RFB_Poll.
+ *          Damage reported meanwhile goes to the next frame
+ *
+ * @note    Rectangles wider than a datagram can hold are sent in slices of at
+ *          most maxslice columns. The size of a coded line is at most
+ *          2*w+w/64+2 bytes, so lines are added while that fits
+ *
+ * @note    A datagram rejected by lwIP is kept and sent again at the next call,
+ *          since previous already has its lines
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "lwip/opt.h"
+#include "lwip/pbuf.h"
+#include "lwip/udp.h"
+#include "lwip/timeouts.h"
+#include "cache.h"
+#include "dma2d.h"
+#include "rfb.h"
+
+/**
+ * @brief   Rectangle (x1,y1 not included)
+ */
+typedef struct {
+    int16_t         x0,y0,x1,y1;
+} Rect;
+
+/**
+ * @brief   States
+ */
+///@{
+#define STATE_IDLE          0
+#define STATE_CAPTURING     1
+#define STATE_SENDING       2
+///@}
+
+/**
+ * @brief   Widest slice coded in a datagram
+ */
+#define MAXSLICE            (((RFB_PAYLOAD-(int)sizeof(RFB_Header)-2)*64)/129)
+
+/**
+ * @brief   Capture and copy of the frame of the viewer (RGB565)
+ */
+///@{
+static uint16_t capture[RFB_MAXWIDTH*RFB_MAXHEIGHT]
+                            __attribute__((section(".sdram.rfb"),aligned(32)));
+static uint16_t previous[RFB_MAXWIDTH*RFB_MAXHEIGHT]
+                            __attribute__((section(".sdram.rfb"),aligned(32)));
+///@}
+
+/**
+ * @brief   State
+ */
+///@{
+static struct udp_pcb   *rfbpcb = 0;
+static ip_addr_t        viewer;
+static u16_t            viewerport = 0;
+
+// Source
+static const void       *srcpixels = 0;
+static int              srcwidth;
+static int              srcheight;
+static int              srcpitch;
+static int              srcformat;
+
+// Damage collected for the next frame
+static Rect             damage[RFB_MAXRECTS];
+static int              ndamage = 0;
+static int              keyrequested = 1;
+
+// Frame in progress
+static int              state = STATE_IDLE;
+static Rect             rects[RFB_MAXRECTS];
+static int              nrects;
+static int              fw,fh;                  // size of the frame
+static int              key;
+static int              submitted;              // rectangles queued in the DMA2D
+static DMA2D_Fence      fence;
+static int              currect;                // position in SENDING
+static int              curx,cury;
+static uint16_t         framenumber = 0;
+static uint16_t         seq;
+static uint32_t         framessincekey = 0;
+static uint32_t         starttime;              // sys_now at the capture
+static struct pbuf      *retry = 0;             // rejected datagram
+
+static RFB_Stats        stats;
+///@}
+
+static inline int rectarea(const Rect *r) { return (r->x1-r->x0)*(r->y1-r->y0); }
+
+/**
+ * @brief   addrect
+ *
+ * @note    Adds rectangle to damage list. Rectangles that overlap or touch it are
+ *          merged into it. When the list is full, it is merged with the one whose
+ *          bounding box grows less (as addrect in lcd.c of 24-LCD)
+ */
+static void
+addrect(Rect r) {
+Rect *q;
+Rect u;
+int i,best,growth,bestgrowth;
+
+restart:
+    for(i=0;i<ndamage;i++) {
+        q = &damage[i];
+        if( r.x0 <= q->x1 && q->x0 <= r.x1 && r.y0 <= q->y1 && q->y0 <= r.y1 ) {
+            if( q->x0 < r.x0 ) r.x0 = q->x0;
+            if( q->y0 < r.y0 ) r.y0 = q->y0;
+            if( q->x1 > r.x1 ) r.x1 = q->x1;
+            if( q->y1 > r.y1 ) r.y1 = q->y1;
+            damage[i] = damage[--ndamage];
+            goto restart;
+        }
+    }
+
+    if( ndamage < RFB_MAXRECTS ) {
+        damage[ndamage++] = r;
+        return;
+    }
+
+    best = 0;
+    bestgrowth = 0x7FFFFFFF;
+    for(i=0;i<ndamage;i++) {
+        q = &damage[i];
+        u.x0 = q->x0 < r.x0 ? q->x0 : r.x0;
+        u.y0 = q->y0 < r.y0 ? q->y0 : r.y0;
+        u.x1 = q->x1 > r.x1 ? q->x1 : r.x1;
+        u.y1 = q->y1 > r.y1 ? q->y1 : r.y1;
+        growth = rectarea(&u)-rectarea(q);
+        if( growth < bestgrowth ) {
+            bestgrowth = growth;
+            best = i;
+        }
+    }
+    q = &damage[best];
+    r.x0 = q->x0 < r.x0 ? q->x0 : r.x0;
+    r.y0 = q->y0 < r.y0 ? q->y0 : r.y0;
+    r.x1 = q->x1 > r.x1 ? q->x1 : r.x1;
+    r.y1 = q->y1 > r.y1 ? q->y1 : r.y1;
+    damage[best] = damage[--ndamage];
+    goto restart;
+}
+
+/**
+ * @brief   encodeline
+ *
+ * @note    Codes n pixels of cur against prev into out and copies them to prev.
+ *          In a key frame there are no unchanged runs. Returns the size in bytes
+ */
+static int
+encodeline(uint8_t *out, const uint16_t *cur, uint16_t *prev, int n, int keyframe) {
+uint8_t *o = out;
+int i,k;
+
+    i = 0;
+    while( i < n ) {
+        // Unchanged
+        if( !keyframe && cur[i] == prev[i] ) {
+            k = 1;
+            while( i+k < n && k < 128 && cur[i+k] == prev[i+k] )
+                k++;
+            *o++ = 0x80|(k-1);
+            stats.unchanged += k;
+            i += k;
+            continue;
+        }
+        // Repeated
+        k = 1;
+        while( i+k < n && k < 64 && cur[i+k] == cur[i] )
+            k++;
+        if( k >= 3 ) {
+            *o++ = 0x40|(k-1);
+            *o++ = cur[i]&0xFF;
+            *o++ = cur[i]>>8;
+            i += k;
+            continue;
+        }
+        // Literal, until an unchanged pair or a run of 3
+        o++;
+        k = 0;
+        while( i < n && k < 64 ) {
+            if( !keyframe && i+1 < n && cur[i] == prev[i] && cur[i+1] == prev[i+1] )
+                break;
+            if( i+2 < n && cur[i+1] == cur[i] && cur[i+2] == cur[i] )
+                break;
+            *o++ = cur[i]&0xFF;
+            *o++ = cur[i]>>8;
+            i++;
+            k++;
+        }
+        o[-2*k-1] = k-1;
+    }
+    memcpy(prev,cur,n*sizeof(uint16_t));
+    return o-out;
+}
+
+/**
+ * @brief   startframe
+ *
+ * @note    Moves the damage to the frame in progress. A key frame has the whole
+ *          frame as its only rectangle
+ */
+static void
+startframe(void) {
+int i;
+
+    fw  = srcwidth;
+    fh  = srcheight;
+    key = keyrequested || framessincekey >= RFB_KEYINTERVAL;
+    if( key ) {
+        rects[0].x0 = rects[0].y0 = 0;
+        rects[0].x1 = fw;
+        rects[0].y1 = fh;
+        nrects = 1;
+        keyrequested = 0;
+    } else {
+        for(i=0;i<ndamage;i++)
+            rects[i] = damage[i];
+        nrects = ndamage;
+    }
+    ndamage   = 0;
+    submitted = 0;
+    seq       = 0;
+    starttime = sys_now();
+    state     = STATE_CAPTURING;
+}
+
+/**
+ * @brief   capturerects
+ *
+ * @note    Queues the conversion of the rectangles not yet submitted. Returns 1
+ *          when all were queued and are done
+ */
+static int
+capturerects(void) {
+const Rect *r;
+DMA2D_Fence f;
+int i;
+
+    while( submitted < nrects ) {
+        r = &rects[submitted];
+        {
+        DECLARE_REGION(src,srcpixels,r->x0,r->y0,r->x1-r->x0,r->y1-r->y0,srcformat,srcpitch);
+        DECLARE_REGION(dst,capture,r->x0,r->y0,r->x1-r->x0,r->y1-r->y0,DMA2D_RGB565,
+                       fw*sizeof(uint16_t));
+        f = DMA2D_SubmitCopy(&src,&dst,0,0);
+        }
+        if( f == 0 )
+            return 0;                       // queue full, continue at next call
+        fence = f;
+        submitted++;
+    }
+    if( !DMA2D_FenceDone(fence) )
+        return 0;
+
+    for(i=0;i<nrects;i++) {
+        r = &rects[i];
+        Cache_InvalidateRange(&capture[r->y0*fw+r->x0],
+                ((r->y1-r->y0-1)*fw+r->x1-r->x0)*sizeof(uint16_t));
+        stats.pixels += rectarea(r);
+    }
+    stats.rects += nrects;
+    currect = 0;
+    curx    = rects[0].x0;
+    cury    = rects[0].y0;
+    return 1;
+}
+
+/**
+ * @brief   senddatagram
+ *
+ * @note    Returns 0 when sent. Otherwise p is kept in retry
+ */
+static int
+senddatagram(struct pbuf *p) {
+unsigned len = p->tot_len;
+
+    if( udp_sendto(rfbpcb,p,&viewer,viewerport) != ERR_OK ) {
+        stats.senderrors++;
+        retry = p;
+        return -1;
+    }
+    pbuf_free(p);
+    stats.datagrams++;
+    stats.bytes += len;
+    return 0;
+}
+
+/**
+ * @brief   nextdatagram
+ *
+ * @note    Codes the next lines of the current slice into a datagram and sends
+ *          it. Returns 1 when the frame is done, 0 when there is more to send and
+ *          -1 when the datagram could not be allocated or sent
+ */
+static int
+nextdatagram(void) {
+const Rect *r = &rects[currect];
+RFB_Header h;
+struct pbuf *p;
+uint8_t *out;
+int len,w,lines;
+
+    p = pbuf_alloc(PBUF_TRANSPORT,RFB_PAYLOAD,PBUF_RAM);
+    if( p == 0 ) {
+        stats.senderrors++;
+        return -1;
+    }
+
+    w = r->x1-curx;
+    if( w > MAXSLICE )
+        w = MAXSLICE;
+    out = (uint8_t *) p->payload;
+    len = sizeof(h);
+    h.y = cury;
+    lines = 0;
+    while( cury < r->y1 && len+2*w+w/64+2 <= RFB_PAYLOAD ) {
+        len += encodeline(out+len,&capture[cury*fw+curx],&previous[cury*fw+curx],w,key);
+        cury++;
+        lines++;
+    }
+
+    h.magic  = RFB_MAGIC;
+    h.frame  = framenumber;
+    h.seq    = seq++;
+    h.flags  = key ? RFB_FLAG_KEY : 0;
+    h.format = DMA2D_RGB565;
+    h.width  = fw;
+    h.height = fh;
+    h.x      = curx;
+    h.w      = w;
+    h.h      = lines;
+
+    // Next slice and next rectangle
+    if( cury == r->y1 ) {
+        curx += w;
+        cury  = r->y0;
+        if( curx >= r->x1 && ++currect < nrects ) {
+            curx = rects[currect].x0;
+            cury = rects[currect].y0;
+        }
+    }
+    if( currect == nrects )
+        h.flags |= RFB_FLAG_END;
+
+    memcpy(out,&h,sizeof(h));
+    pbuf_realloc(p,len);
+    if( senddatagram(p) < 0 )
+        return -1;
+    return currect == nrects;
+}
+
+/**
+ * @brief   endframe
+ */
+static void
+endframe(void) {
+
+    stats.frames++;
+    if( key ) {
+        stats.keyframes++;
+        framessincekey = 0;
+    } else {
+        framessincekey++;
+    }
+    if( sys_now()-starttime > RFB_INTERVAL )
+        stats.late++;
+    framenumber++;
+    state = STATE_IDLE;
+}
+
+/**
+ * @brief   rfb_recv
+ *
+ * @note    The sender becomes the viewer and gets a key frame
+ */
+static void
+rfb_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+         const ip_addr_t *addr, u16_t port) {
+
+    LWIP_UNUSED_ARG(arg);
+    LWIP_UNUSED_ARG(pcb);
+
+    RFB_SetViewer(addr,port);
+    pbuf_free(p);
+}
+
+/**
+ * @brief   RFB_Init
+ *
+ * @note    Must be called after the netif is up, in the main loop or in the
+ *          tcpip thread. DMA2D_Init must have been called
+ */
+int
+RFB_Init(uint16_t port) {
+
+    rfbpcb = udp_new();
+    if( rfbpcb == 0 )
+        return RFB_ERROR_NETWORK;
+    if( udp_bind(rfbpcb,IP_ANY_TYPE,port) != ERR_OK ) {
+        udp_remove(rfbpcb);
+        rfbpcb = 0;
+        return RFB_ERROR_NETWORK;
+    }
+    udp_recv(rfbpcb,rfb_recv,0);
+    memset(&stats,0,sizeof(stats));
+    return RFB_OK;
+}
+
+/**
+ * @brief   RFB_SetSource
+ *
+ * @note    pixels is the first pixel of a frame buffer of width x height pixels
+ *          with lines pitch bytes apart in a DMA2D input format (DMA2D_ARGB8888
+ *          to DMA2D_ARGB4444). It is used from the next frame on, so with double
+ *          buffering it can be called with the new front buffer after each flip.
+ *          A change in size requests a key frame
+ */
+int
+RFB_SetSource(const void *pixels, int width, int height, int pitch, int format) {
+
+    if( pixels == 0 || width <= 0 || width > RFB_MAXWIDTH || height <= 0
+        || height > RFB_MAXHEIGHT || format < DMA2D_ARGB8888 || format > DMA2D_ARGB4444 )
+        return RFB_ERROR_PARAMETER;
+    if( srcpixels == 0 || width != srcwidth || height != srcheight ) {
+        keyrequested = 1;
+        ndamage = 0;
+    }
+    srcpixels = pixels;
+    srcwidth  = width;
+    srcheight = height;
+    srcpitch  = pitch;
+    srcformat = format;
+    return RFB_OK;
+}
+
+/**
+ * @brief   RFB_SetViewer
+ *
+ * @note    Frames go to addr:port from the next one on. It gets a key frame
+ */
+int
+RFB_SetViewer(const ip_addr_t *addr, uint16_t port) {
+
+    if( addr == 0 || port == 0 )
+        return RFB_ERROR_PARAMETER;
+    ip_addr_copy(viewer,*addr);
+    viewerport   = port;
+    keyrequested = 1;
+    return RFB_OK;
+}
+
+/**
+ * @brief   RFB_AddDamage
+ *
+ * @note    The rectangle is clipped to the source. Its signature matches the
+ *          callback of LCD_SetDamageCallback but the layer
+ */
+void
+RFB_AddDamage(int x, int y, int w, int h) {
+Rect r;
+
+    if( srcpixels == 0 )
+        return;
+    if( x < 0 ) { w += x; x = 0; }
+    if( y < 0 ) { h += y; y = 0; }
+    if( x+w > srcwidth )  w = srcwidth-x;
+    if( y+h > srcheight ) h = srcheight-y;
+    if( w <= 0 || h <= 0 )
+        return;
+
+    r.x0 = x;
+    r.y0 = y;
+    r.x1 = x+w;
+    r.y1 = y+h;
+    addrect(r);
+}
+
+/**
+ * @brief   RFB_RequestKeyFrame
+ */
+void
+RFB_RequestKeyFrame(void) {
+
+    keyrequested = 1;
+}
+
+/**
+ * @brief   RFB_Poll
+ *
+ * @note    Must be called often in the main loop (or by a lwIP timeout). A new
+ *          frame is started at most every RFB_INTERVAL ms and only when there
+ *          is damage
+ */
+void
+RFB_Poll(void) {
+struct pbuf *p;
+int i,rc;
+
+    if( rfbpcb == 0 || viewerport == 0 || srcpixels == 0 )
+        return;
+
+    if( retry ) {
+        p = retry;
+        retry = 0;
+        if( senddatagram(p) < 0 )
+            return;
+        if( currect == nrects ) {
+            endframe();
+            return;
+        }
+    }
+
+    switch( state ) {
+    case STATE_IDLE:
+        if( (ndamage == 0 && !keyrequested) || sys_now()-starttime < RFB_INTERVAL )
+            break;
+        startframe();
+        /* FALLTHRU */
+    case STATE_CAPTURING:
+        if( !capturerects() )
+            break;
+        state = STATE_SENDING;
+        /* FALLTHRU */
+    case STATE_SENDING:
+        for(i=0;i<RFB_MAXDATAGRAMS;i++) {
+            rc = nextdatagram();
+            if( rc < 0 )
+                break;
+            if( rc > 0 ) {
+                endframe();
+                break;
+            }
+        }
+        break;
+    }
+}
+
+/**
+ * @brief   RFB_GetStats
+ */
+void
+RFB_GetStats(RFB_Stats *st) {
+
+    *st = stats;
+}
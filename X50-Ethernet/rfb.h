@@ -0,0 +1,144 @@
+#ifndef RFB_H
+#define RFB_H
+/**
+ * @file    rfb.h
+ *
+ * @note    Remote frame buffer: the changed parts of a frame buffer are sent
+ *          over UDP to a viewer (host side is tools/rfbview.c)
+ *
+ * @note    The application reports what it drew with RFB_AddDamage, as it does
+ *          with LCD_AddDamage in 24-LCD (LCD_SetDamageCallback forwards them).
+ *          Every RFB_INTERVAL ms, the damaged rectangles are converted by the
+ *          DMA2D from the frame buffer into a RGB565 capture buffer. The jobs
+ *          go to the same queue as the drawing jobs, so neither the drawing nor
+ *          the CPU wait for the capture. Then each line is compared with the
+ *          frame the viewer has and coded as runs of unchanged, repeated and
+ *          literal pixels
+ *
+ * @note    Every datagram is a RFB_Header followed by the lines y to y+h-1 of
+ *          the columns x to x+w-1. Each line is a sequence of codes:
+ *          * 1nnnnnnn: n+1 pixels unchanged
+ *          * 01nnnnnn: n+1 copies of the next pixel
+ *          * 00nnnnnn: n+1 pixels follow
+ *          Pixels are RGB565. All fields are little endian
+ *
+ * @note    Any datagram received on the port makes its sender the viewer and
+ *          requests a key frame (the whole frame without unchanged runs). A key
+ *          frame is also sent every RFB_KEYINTERVAL frames, so the viewer
+ *          recovers from lost datagrams
+ *
+ * @note    Uses the raw API. The functions must be called in the main loop
+ *          (NO_SYS) or in the tcpip thread (LWIP_UCOS2), not in interrupts
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "lwip/ip_addr.h"
+
+/**
+ * @brief   UDP port of the service
+ */
+#ifndef RFB_PORT
+#define RFB_PORT                    5010
+#endif
+
+/**
+ * @brief   Maximal size of the frame buffer
+ *
+ * @note    The capture and the copy of the frame of the viewer are static
+ *          RGB565 buffers of this size in SDRAM
+ */
+///@{
+#ifndef RFB_MAXWIDTH
+#define RFB_MAXWIDTH                480
+#endif
+#ifndef RFB_MAXHEIGHT
+#define RFB_MAXHEIGHT               272
+#endif
+///@}
+
+/**
+ * @brief   Parameters
+ *
+ * @note    RFB_MAXRECTS is the size of the damage list (see LCD_MAXDAMAGE).
+ *          RFB_MAXDATAGRAMS limits the datagrams sent in a call to RFB_Poll,
+ *          so the main loop and the TX ring are not held by a large frame
+ */
+///@{
+#ifndef RFB_MAXRECTS
+#define RFB_MAXRECTS                16
+#endif
+#ifndef RFB_INTERVAL
+#define RFB_INTERVAL                40      // ms
+#endif
+#ifndef RFB_KEYINTERVAL
+#define RFB_KEYINTERVAL             250     // frames
+#endif
+#ifndef RFB_PAYLOAD
+#define RFB_PAYLOAD                 1472
+#endif
+#ifndef RFB_MAXDATAGRAMS
+#define RFB_MAXDATAGRAMS            16
+#endif
+///@}
+
+/**
+ * @brief   Header of every datagram
+ */
+///@{
+#define RFB_MAGIC                   0x4246          // "FB"
+
+#define RFB_FLAG_KEY                1       ///< datagram of a key frame
+#define RFB_FLAG_END                2       ///< last datagram of the frame
+
+typedef struct {
+    uint16_t    magic;
+    uint16_t    frame;                      ///< frame number
+    uint16_t    seq;                        ///< datagram number in the frame
+    uint8_t     flags;                      ///< RFB_FLAG_*
+    uint8_t     format;                     ///< DMA2D_RGB565
+    uint16_t    width;                      ///< frame size
+    uint16_t    height;
+    uint16_t    x;                          ///< area coded in the datagram
+    uint16_t    y;
+    uint16_t    w;
+    uint16_t    h;
+} RFB_Header;
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define RFB_OK                      (0)
+#define RFB_ERROR_PARAMETER         (-1)
+#define RFB_ERROR_NETWORK           (-2)
+///@}
+
+/**
+ * @brief   Counters
+ */
+typedef struct {
+    uint32_t    frames;                     ///< frames sent
+    uint32_t    keyframes;
+    uint32_t    rects;                      ///< rectangles captured
+    uint32_t    pixels;                     ///< pixels captured
+    uint32_t    unchanged;                  ///< pixels coded as unchanged
+    uint32_t    datagrams;
+    uint32_t    bytes;                      ///< payload bytes sent
+    uint32_t    senderrors;                 ///< rejected by lwIP or the driver (resent)
+    uint32_t    late;                       ///< intervals with the last frame still being sent
+} RFB_Stats;
+
+int  RFB_Init(uint16_t port);
+int  RFB_SetSource(const void *pixels, int width, int height, int pitch, int format);
+int  RFB_SetViewer(const ip_addr_t *addr, uint16_t port);
+void RFB_AddDamage(int x, int y, int w, int h);
+void RFB_RequestKeyFrame(void);
+void RFB_Poll(void);
+void RFB_GetStats(RFB_Stats *stats);
+
+#endif // RFB_H
@@ -0,0 +1,173 @@
+/**
+ * @file    rng.c
+ *
+ * @note    True random number generator (see rng.h)
+ *
+ * @note    The pool is a ring with free running counters. The interrupt routine
+ *          adds words and disables the interrupt when the pool is full.
+ *          RNG_GetWord takes a word with the interrupts disabled (it can be
+ *          called by several tasks) and enables the interrupt again
+ *
+ * @note    A seed error (SEIS) restarts the RNG. The word of DR is not used
+ *          while SECS is set (RM0385 22.3.7). The words already in the pool were
+ *          read before the error and are kept
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <string.h>
+#include "stm32f746xx.h"
+#include "rng.h"
+#include "clkgate.h"
+
+#if (RNG_POOLSIZE&(RNG_POOLSIZE-1)) != 0
+#error "RNG_POOLSIZE must be a power of 2"
+#endif
+
+/**
+ * @brief   Number of polls for the pool to be filled by RNG_Init
+ */
+#define INITTIMEOUT                     1000000
+
+/**
+ * @brief   State
+ */
+///@{
+static uint32_t             pool[RNG_POOLSIZE];
+static volatile uint32_t    head = 0;           // incremented by the interrupt
+static volatile uint32_t    tail = 0;           // incremented by RNG_GetWord
+static uint32_t             xorstate = 2463534242U;
+static RNG_Statistics       stats;
+///@}
+
+/**
+ * @brief  RNG_Init
+ *
+ * @note   PLLSAI must give 48 MHz on its P output (PLLSAIConfiguration_48MHz).
+ *         Waits until the pool is full, so the first words used by lwip_init
+ *         are random
+ */
+int
+RNG_Init( void ) {
+uint32_t i;
+
+    if( (RCC->CR&RCC_CR_PLLSAIRDY) == 0 )
+        return RNG_ERROR_NOCLOCK;
+
+    NVIC_DisableIRQ(HASH_RNG_IRQn);
+
+    // CK48 = PLLSAI P
+    RCC->DCKCFGR2 |= RCC_DCKCFGR2_CK48MSEL;
+    // Kept in Sleep mode, so the interrupt fills the pool meanwhile
+    if( ClkGate_GetCount(CLKGATE_RNG) == 0 )
+        ClkGate_Enable(CLKGATE_RNG,CLKGATE_SLEEP);
+    RCC->AHB2RSTR |= RCC_AHB2RSTR_RNGRST;
+    RCC->AHB2RSTR &= ~RCC_AHB2RSTR_RNGRST;
+
+    head = tail = 0;
+    memset(&stats,0,sizeof(stats));
+
+    NVIC_SetPriority(HASH_RNG_IRQn,RNG_IRQ_PRIO);
+    NVIC_ClearPendingIRQ(HASH_RNG_IRQn);
+    NVIC_EnableIRQ(HASH_RNG_IRQn);
+    RNG->CR = RNG_CR_RNGEN|RNG_CR_IE;
+
+    for(i=0;i<INITTIMEOUT&&head-tail<RNG_POOLSIZE;i++) {}
+    return head != tail ? RNG_OK : RNG_ERROR_TIMEOUT;
+}
+
+/**
+ * @brief  Next word of the xorshift generator
+ */
+static uint32_t XorShift( void ) {
+uint32_t x = xorstate;
+
+    x ^= x<<13;
+    x ^= x>>17;
+    x ^= x<<5;
+    xorstate = x;
+    return x;
+}
+
+/**
+ * @brief  RNG_GetWord
+ *
+ * @note   Never waits. Can be called from tasks and interrupts
+ */
+uint32_t
+RNG_GetWord( void ) {
+uint32_t primask;
+uint32_t w;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if( tail != head ) {
+        w = pool[tail&(RNG_POOLSIZE-1)];
+        tail++;
+        RNG->CR |= RNG_CR_IE;
+    } else {
+        w = XorShift();
+        stats.fallbacks++;
+    }
+    __set_PRIMASK(primask);
+    return w;
+}
+
+/**
+ * @brief  RNG_Available
+ *
+ * @note   Number of words in the pool
+ */
+int
+RNG_Available( void ) {
+
+    return head-tail;
+}
+
+/**
+ * @brief  RNG_GetStatistics
+ */
+void
+RNG_GetStatistics( RNG_Statistics *s ) {
+uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    *s = stats;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Interrupt routine (shared with HASH)
+ */
+void
+HASH_RNG_IRQHandler( void ) {
+uint32_t sr = RNG->SR;
+uint32_t w;
+
+    if( sr&RNG_SR_SEIS ) {
+        RNG->SR = ~RNG_SR_SEIS;
+        RNG->CR &= ~RNG_CR_RNGEN;
+        RNG->CR |= RNG_CR_RNGEN;
+        stats.seederrors++;
+        return;
+    }
+    if( sr&RNG_SR_CEIS ) {
+        RNG->SR = ~RNG_SR_CEIS;
+        stats.clockerrors++;
+    }
+    if( (sr&(RNG_SR_DRDY|RNG_SR_SECS)) == RNG_SR_DRDY ) {
+        w = RNG->DR;
+        stats.words++;
+        xorstate ^= w;
+        if( xorstate == 0 )
+            xorstate = 2463534242U;
+        if( head-tail < RNG_POOLSIZE ) {
+            pool[head&(RNG_POOLSIZE-1)] = w;
+            head++;
+        }
+    }
+    if( head-tail >= RNG_POOLSIZE )
+        RNG->CR &= ~RNG_CR_IE;
+}
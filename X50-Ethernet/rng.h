@@ -0,0 +1,64 @@
+#ifndef RNG_H
+#define RNG_H
+/**
+ * @file    rng.h
+ *
+ * @note    True random number generator (RNG peripheral)
+ *
+ * @note    The RNG gives a word every 40 periods of its 48 MHz clock (CK48,
+ *          PLLSAI P output). The interrupt keeps a small pool full, so
+ *          RNG_GetWord never waits. It is used by lwIP for LWIP_RAND (initial
+ *          local ports, DNS ids) and for the TCP initial sequence numbers
+ *          (LWIP_HOOK_TCP_ISN in lwipopts.h)
+ *
+ * @note    When the pool is empty, or the RNG is stopped by a clock or seed
+ *          error, RNG_GetWord returns a word of a xorshift generator, whose state
+ *          is mixed with every random word. These words are counted in fallbacks
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "irqprio.h"
+
+/**
+ * @brief   Number of words kept in the pool (power of 2)
+ */
+#ifndef RNG_POOLSIZE
+#define RNG_POOLSIZE                    16
+#endif
+
+/**
+ * @brief   Priority of the RNG interrupt (see irqprio.h)
+ */
+#ifndef RNG_IRQ_PRIO
+#define RNG_IRQ_PRIO                    IRQPRIO_RNG
+#endif
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define RNG_OK                          (0)
+#define RNG_ERROR_NOCLOCK               (-1)    ///< PLLSAI not running
+#define RNG_ERROR_TIMEOUT               (-2)    ///< no word at initialization
+///@}
+
+/**
+ * @brief   Counters
+ */
+typedef struct {
+    uint32_t    words;                  // read from the RNG
+    uint32_t    fallbacks;              // given by the xorshift generator
+    uint32_t    seederrors;
+    uint32_t    clockerrors;
+} RNG_Statistics;
+
+int      RNG_Init(void);
+uint32_t RNG_GetWord(void);
+int      RNG_Available(void);
+void     RNG_GetStatistics(RNG_Statistics *stats);
+
+#endif // RNG_H
@@ -14,13 +14,15 @@
 #include "system_stm32f746.h"
 #include "gpio.h"
 #include "sdram.h"
+#include "clkgate.h"
 
 /**
  *  @brief  Pin initialization routines
  *
  *  @note   There are two versions:
- *          1: using GPIO routines from a pin configuration table (smaller but slow))
-  *         2: using direct access to register (faster but larger)
+ *          1: using a pin configuration table (smaller). GPIO_ConfigurePinTable
+ *             writes each register of a port once, as version 2
+ *          2: using direct access to register (larger)
  */
 //#define SDRAM_USEGPIO             (1)
 
@@ -278,13 +280,13 @@ static const GPIO_PinConfiguration pinconfig_bank2[] = {
 static void
 ConfigureFMCSDRAMPins(int bank) {
 
-    /* Configure pins from table*/
-    GPIO_ConfigureMultiplePins(pinconfig_common);
+    /* Configure pins from table, a port at a time */
+    GPIO_ConfigurePinTable(pinconfig_common);
 
     if( bank == SDRAM_BANK1 ) {
-        GPIO_ConfigureMultiplePins(pinconfig_bank1);
+        GPIO_ConfigurePinTable(pinconfig_bank1);
     } else {
-        GPIO_ConfigureMultiplePins(pinconfig_bank2);
+        GPIO_ConfigurePinTable(pinconfig_bank2);
     }
 }
 
@@ -306,7 +308,7 @@ uint32_t mAND,mOR; // Mask
     // Configure pins in GPIOD
     // 0/DQ2 1/DQ3 8/DQ13 9/DQ14 10/DQ15 14/DQ0 15/DQ1
 
-    RCC->AHB1ENR |= RCC_AHB1ENR_GPIODEN;
+    ClkGate_Enable(CLKGATE_GPIOD,0);
 
     mAND =   GPIO_AFRL_AFRL0_Msk
             |GPIO_AFRL_AFRL1_Msk;
@@ -393,7 +395,7 @@ uint32_t mAND,mOR; // Mask
     // Configure pins in GPIOE
     // 0/DQM0 1/DQM1 7/DQ4 8/DQ5 9/DQ6 10/DQ7 11/DQ8 AF/DQ9 13/DQ10 14/DQ11 15/DQAF
 
-    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOEEN;
+    ClkGate_Enable(CLKGATE_GPIOE,0);
 
     mAND =   GPIO_AFRL_AFRL0_Msk
             |GPIO_AFRL_AFRL1_Msk
@@ -520,7 +522,7 @@ uint32_t mAND,mOR; // Mask
     // Configure pins in GPIOF
     // 0/A0 1/A1 2/A2 3/A3 4/A4 5/A5 11/RAS 12/A6 13/A7 14/A8 15/A9
 
-    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOFEN;
+    ClkGate_Enable(CLKGATE_GPIOF,0);
 
     mAND =   GPIO_AFRL_AFRL0_Msk
             |GPIO_AFRL_AFRL1_Msk
@@ -647,7 +649,7 @@ uint32_t mAND,mOR; // Mask
     // Configure pins in GPIOG
     // 0/A10 1/A11 4/BA0 5/BA1 8/CLK 15/CAS
 
-    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOGEN;
+    ClkGate_Enable(CLKGATE_GPIOG,0);
 
     mAND =   GPIO_AFRL_AFRL0_Msk
             |GPIO_AFRL_AFRL1_Msk
@@ -724,7 +726,7 @@ uint32_t mAND,mOR; // Mask
     // Configure pins in GPIOH
     // 5/WE
 
-    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOHEN;
+    ClkGate_Enable(CLKGATE_GPIOH,0);
 
     mAND =   GPIO_AFRL_AFRL5_Msk;
     mOR  =   (SD_AF<<GPIO_AFRL_AFRL5_Pos);
@@ -762,7 +764,7 @@ uint32_t mAND,mOR; // Mask
         // Configure pins in GPIOC
         // 3/CLKE
 
-        RCC->AHB1ENR |= RCC_AHB1ENR_GPIOCEN;
+        ClkGate_Enable(CLKGATE_GPIOC,0);
 
         mAND = GPIO_AFRL_AFRL3_Msk;
         mOR  = (SD_AF<<GPIO_AFRL_AFRL3_Pos);
@@ -787,7 +789,7 @@ uint32_t mAND,mOR; // Mask
         // Configure pins in GPIOH
         // 3/CS
 
-        RCC->AHB1ENR |= RCC_AHB1ENR_GPIOHEN;
+        ClkGate_Enable(CLKGATE_GPIOH,0);
 
         mAND =   GPIO_AFRL_AFRL3_Msk;
         mOR  =   (SD_AF<<GPIO_AFRL_AFRL3_Pos);
@@ -814,7 +816,7 @@ uint32_t mAND,mOR; // Mask
         // Configure pins in GPIOH
         // 6/CS 7/CKE for Bank2 (There are alternatives on PB6 and PB5)
         while(1) {}
-        RCC->AHB1ENR |= RCC_AHB1ENR_GPIOHEN;
+        ClkGate_Enable(CLKGATE_GPIOH,0);
 
         mAND =   GPIO_AFRL_AFRL6_Msk
                 |GPIO_AFRL_AFRL7_Msk;
@@ -860,17 +862,28 @@ uint32_t mAND,mOR; // Mask
 /**
  *  @brief  EnableFMCClock
  *
+ *  @note   Kept in Sleep mode: the FMC refreshes the SDRAM and DMAs (ETH,
+ *          DMA2D) access it while the core sleeps
  */
 
 static void
 EnableFMCClock(void) {
 
-    RCC->AHB3ENR |= RCC_AHB3ENR_FMCEN;
+    ClkGate_Enable(CLKGATE_FMC,CLKGATE_SLEEP);
 
 }
 
 
 
+/**
+ * @brief   Warm start (SDRAM_SetWarmStart)
+ *
+ * @note    The SDRAM stays powered across a reset of the MCU, so the power up
+ *          wait before the initialization sequence is not needed again
+ */
+static int sdramwarm = 0;
+
+
 /**
  * @brief   SmallDelay
  *
@@ -1101,7 +1114,8 @@ ConfigureSDRAMDevice(int bank) {
     /* Clock enable command */
     SendCommand(bank,SDRAM_MODE_CLOCKCONFIGENABLE,0x0000);
 
-    SmallDelay(1000);       // 100 us, maybe systick is better */
+    if( !sdramwarm )
+        SmallDelay(1000);   // 100 us, maybe systick is better */
 
     /* PALL command */
     SendCommand(bank,SDRAM_MODE_PALL,0x0000);
@@ -1153,6 +1167,19 @@ SDRAM_InitEx(int bank) {
 }
 
 
+/**
+ * @brief   SDRAM_SetWarmStart
+ *
+ * @note    Set before SDRAM_Init after a reset that did not cut the power. The
+ *          commands of the initialization sequence are still sent
+ */
+void
+SDRAM_SetWarmStart(int warm) {
+
+    sdramwarm = warm;
+}
+
+
 /**
  * @brief   SDRAM Init
  *
@@ -8,6 +8,7 @@
  */
 
 int SDRAM_Init();
+void SDRAM_SetWarmStart(int warm);
 
 /**
  *  @brief  SystemCoreClock for correct working of the SDRAM
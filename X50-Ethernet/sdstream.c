@@ -0,0 +1,429 @@
+/**
+ * @file    sdstream.c
+ *
+ * @note    Files of the MicroSD card over TCP with read ahead (see sdstream.h)
+ *
+ * @note    The buffers of a transfer are used in order. Three counters give
+ *          their state (buffer k is slot[k%SDSTREAM_BUFFERS])
+ *
+ *          | From     | To       | Buffers                                 |
+ *          |----------|----------|-----------------------------------------|
+ *          | ackidx   | sendidx  | given to tcp_write, not acknowledged    |
+ *          | sendidx  | readidx  | read submitted, being given (sendoff)   |
+ *          | readidx  | ackidx+N | free                                    |
+ *
+ *          A buffer is read with the sectors given by FAT_MapRead, so it holds
+ *          one run of consecutive sectors, up to SDSTREAM_BUFFERSIZE bytes
+ *
+ * @note    The segments reference the buffers (no TCP_WRITE_FLAG_COPY), so a
+ *          buffer is reused only when all its bytes are acknowledged. For the
+ *          same reason the connection is closed only after the last ACK, and
+ *          a transfer with reads still running is not reused after an abort
+ *
+ * @note    FAT_MapRead reads the FAT sectors thru the cache of fat.c. When one
+ *          is not there (once every 128 clusters), it waits for the reads
+ *          queued before it
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "lwip/opt.h"
+#include "lwip/tcp.h"
+#include "lwip/sys.h"
+#include "sdcard.h"
+#include "fat.h"
+#include "sdstream.h"
+
+#if SDSTREAM_BUFFERSIZE%SD_BLOCKSIZE != 0
+#error "SDSTREAM_BUFFERSIZE must be a multiple of 512"
+#endif
+
+#define NAMESIZE                    13      // 8.3 and the null
+
+/**
+ * @brief   Buffers (SDRAM, read by DMA)
+ */
+static uint8_t ring[SDSTREAM_MAXCONN][SDSTREAM_BUFFERS][SDSTREAM_BUFFERSIZE]
+                                    __attribute__((section(".sdram.sdstream"),aligned(32)));
+
+/**
+ * @brief   Transfers
+ */
+///@{
+typedef struct {
+    SD_Request          req;
+    uint32_t            len;                // bytes of the file in the buffer
+} Slot;
+
+typedef struct {
+    struct tcp_pcb     *pcb;                // null when free
+    int                 index;              // in transfers and ring
+    int                 sending;            // file open, name received
+    int                 eof;                // all the file mapped
+    FAT_File            file;
+    char                name[NAMESIZE];
+    int                 namelen;
+    Slot                slot[SDSTREAM_BUFFERS];
+    uint32_t            readidx;
+    uint32_t            sendidx;
+    uint32_t            ackidx;
+    uint32_t            sendoff;            // bytes of sendidx given to TCP
+    uint32_t            acked;              // bytes of ackidx acknowledged
+    uint32_t            start;              // sys_now
+} Transfer;
+
+static Transfer         transfers[SDSTREAM_MAXCONN];
+///@}
+
+static struct tcp_pcb   *listenpcb = 0;
+
+static SDStream_Stats   stats;
+
+/**
+ * @brief   Reads running in the buffers of a transfer
+ */
+static int
+reading(Transfer *t) {
+int k;
+
+    for(k=0;k<SDSTREAM_BUFFERS;k++) {
+        if( t->slot[k].req.status == SD_PENDING )
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief   Detach a transfer from its pcb
+ */
+static void
+release(Transfer *t) {
+
+    if( t->pcb ) {
+        tcp_arg(t->pcb,0);
+        tcp_recv(t->pcb,0);
+        tcp_sent(t->pcb,0);
+        tcp_err(t->pcb,0);
+        tcp_poll(t->pcb,0,0);
+    }
+    if( t->sending )
+        FAT_Close(&t->file);
+    t->pcb     = 0;
+    t->sending = 0;
+}
+
+/**
+ * @brief   End a transfer. The queued segments are still sent (tcp_close)
+ *          unless abort is set
+ *
+ * @note    Returns ERR_ABRT when the pcb was aborted (and freed)
+ */
+static err_t
+finish(Transfer *t, int abort) {
+struct tcp_pcb *pcb = t->pcb;
+
+    release(t);
+    if( !pcb )
+        return ERR_OK;
+    if( abort || tcp_close(pcb) != ERR_OK ) {
+        stats.aborted++;
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+    return ERR_OK;
+}
+
+/**
+ * @brief   Submit the reads of the free buffers
+ *
+ * @note    Returns 0 or a negative error of fat.c or sdcard.c
+ */
+static int
+readahead(Transfer *t) {
+Slot *s;
+uint32_t sector;
+int n,rc;
+
+    while( !t->eof && t->readidx-t->ackidx < SDSTREAM_BUFFERS ) {
+        s = &t->slot[t->readidx%SDSTREAM_BUFFERS];
+        n = FAT_MapRead(&t->file,SDSTREAM_BUFFERSIZE,&sector);
+        if( n < 0 )
+            return n;
+        if( n == 0 ) {
+            t->eof = 1;
+            break;
+        }
+        s->len         = n;
+        s->req.op      = SD_READ;
+        s->req.block   = sector;
+        s->req.count   = (n+SD_BLOCKSIZE-1)/SD_BLOCKSIZE;
+        s->req.data    = ring[t->index][t->readidx%SDSTREAM_BUFFERS];
+        s->req.callback = 0;
+        rc = SD_Submit(&s->req);
+        if( rc < 0 )
+            return rc;
+        t->readidx++;
+        stats.reads++;
+    }
+    if( !t->eof && t->readidx-t->ackidx == SDSTREAM_BUFFERS )
+        stats.ringfull++;
+    return 0;
+}
+
+/**
+ * @brief   Give the buffers read to TCP and start the next reads
+ *
+ * @note    Returns ERR_ABRT when the pcb was aborted
+ */
+static err_t
+output(Transfer *t) {
+struct tcp_pcb *pcb = t->pcb;
+Slot *s;
+uint8_t *data;
+uint32_t n;
+u8_t flags;
+err_t err;
+int queued = 0;
+
+    if( readahead(t) < 0 ) {
+        stats.readerrors++;
+        return finish(t,1);
+    }
+    while( t->sendidx != t->readidx ) {
+        s = &t->slot[t->sendidx%SDSTREAM_BUFFERS];
+        n = tcp_sndbuf(pcb);
+        if( n == 0 || tcp_sndqueuelen(pcb)+2 >= TCP_SND_QUEUELEN )
+            break;
+        if( s->req.status == SD_PENDING ) {
+            stats.diskwaits++;
+            break;
+        }
+        if( s->req.status < 0 ) {
+            stats.readerrors++;
+            return finish(t,1);
+        }
+        if( n > s->len-t->sendoff )
+            n = s->len-t->sendoff;
+        if( n > 0xFFFF )
+            n = 0xFFFF;
+        data = ring[t->index][t->sendidx%SDSTREAM_BUFFERS]+t->sendoff;
+        flags = (t->sendoff+n < s->len || !t->eof || t->sendidx+1 != t->readidx)
+                ? TCP_WRITE_FLAG_MORE : 0;
+        err = tcp_write(pcb,data,(u16_t) n,flags);
+        if( err == ERR_MEM ) {
+            stats.retries++;
+            break;
+        }
+        if( err != ERR_OK )
+            return finish(t,1);
+        t->sendoff  += n;
+        stats.bytes += n;
+        queued = 1;
+        if( t->sendoff == s->len ) {
+            t->sendoff = 0;
+            t->sendidx++;
+        }
+    }
+    if( queued )
+        tcp_output(pcb);
+    if( t->eof && t->ackidx == t->readidx ) {
+        stats.completed++;
+        stats.lastbytes = t->file.size;
+        stats.lastms    = sys_now()-t->start;
+        return finish(t,0);
+    }
+    return ERR_OK;
+}
+
+/**
+ * @brief   Open the file named by the client and start the transfer
+ *
+ * @note    Returns ERR_ABRT when the pcb was aborted
+ */
+static err_t
+start(Transfer *t) {
+
+    t->name[t->namelen] = 0;
+    if( FAT_Open(&t->file,t->name,FAT_READ) != FAT_OK ) {
+        stats.notfound++;
+        return finish(t,0);
+    }
+    t->sending = 1;
+    t->start   = sys_now();
+    return output(t);
+}
+
+/**
+ * @brief   lwIP callbacks
+ */
+///@{
+static void
+sdstream_err(void *arg, err_t err) {
+Transfer *t = (Transfer *) arg;
+
+    // The pcb is already freed
+    t->pcb = 0;
+    release(t);
+    stats.aborted++;
+}
+
+static err_t
+sdstream_sent(void *arg, struct tcp_pcb *tpcb, u16_t len) {
+Transfer *t = (Transfer *) arg;
+Slot *s;
+
+    if( !t->sending )
+        return ERR_OK;
+    t->acked += len;
+    while( t->ackidx != t->sendidx ) {
+        s = &t->slot[t->ackidx%SDSTREAM_BUFFERS];
+        if( t->acked < s->len )
+            break;
+        t->acked -= s->len;
+        t->ackidx++;
+    }
+    return output(t);
+}
+
+static err_t
+sdstream_poll(void *arg, struct tcp_pcb *tpcb) {
+Transfer *t = (Transfer *) arg;
+
+    if( !t->sending )
+        return finish(t,1);                 // no name after 1 s
+    return output(t);
+}
+
+static err_t
+sdstream_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
+Transfer *t = (Transfer *) arg;
+struct pbuf *q;
+const char *c;
+u16_t k;
+
+    if( p == NULL ) {
+        // Closing after the name (echo | nc) is right, before it is not
+        if( t->sending )
+            return ERR_OK;
+        return finish(t,1);
+    }
+    tcp_recved(tpcb,p->tot_len);
+    if( t->sending ) {
+        // Anything received after the name is discarded
+        pbuf_free(p);
+        return ERR_OK;
+    }
+    for(q=p;q;q=q->next) {
+        c = (const char *) q->payload;
+        for(k=0;k<q->len;k++) {
+            if( c[k] == '\n' || c[k] == '\r' ) {
+                pbuf_free(p);
+                return start(t);
+            }
+            if( t->namelen == NAMESIZE-1 ) {
+                pbuf_free(p);
+                stats.notfound++;
+                return finish(t,0);
+            }
+            t->name[t->namelen++] = c[k];
+        }
+    }
+    pbuf_free(p);
+    return ERR_OK;
+}
+///@}
+
+/**
+ * @brief   Server
+ */
+static err_t
+sdstream_accept(void *arg, struct tcp_pcb *newpcb, err_t err) {
+Transfer *t = 0;
+int i;
+
+    if( err != ERR_OK || newpcb == NULL )
+        return ERR_VAL;
+
+    for(i=0;i<SDSTREAM_MAXCONN;i++) {
+        if( transfers[i].pcb == 0 && !reading(&transfers[i]) ) {
+            t = &transfers[i];
+            break;
+        }
+    }
+    if( !t ) {
+        stats.aborted++;
+        tcp_abort(newpcb);
+        return ERR_ABRT;
+    }
+
+    memset(t,0,sizeof(*t));
+    t->pcb   = newpcb;
+    t->index = i;
+    stats.connections++;
+
+    tcp_arg(newpcb,t);
+    tcp_recv(newpcb,sdstream_recv);
+    tcp_sent(newpcb,sdstream_sent);
+    tcp_err(newpcb,sdstream_err);
+    tcp_poll(newpcb,sdstream_poll,2);       // 1 s
+    return ERR_OK;
+}
+
+/**
+ * @brief   SDStream_Init
+ *
+ * @note    Listens on port
+ */
+int
+SDStream_Init(unsigned port) {
+struct tcp_pcb *pcb;
+
+    memset(transfers,0,sizeof(transfers));
+    memset(&stats,0,sizeof(stats));
+
+    pcb = tcp_new_ip_type(IPADDR_TYPE_ANY);
+    if( !pcb )
+        return SDSTREAM_ERROR_LWIP;
+    if( tcp_bind(pcb,IP_ANY_TYPE,port) != ERR_OK ) {
+        tcp_close(pcb);
+        return SDSTREAM_ERROR_LWIP;
+    }
+    listenpcb = tcp_listen(pcb);
+    if( !listenpcb ) {
+        tcp_close(pcb);
+        return SDSTREAM_ERROR_LWIP;
+    }
+    tcp_accept(listenpcb,sdstream_accept);
+    return SDSTREAM_OK;
+}
+
+/**
+ * @brief   SDStream_Poll
+ *
+ * @note    Gives the buffers read since the last call to TCP
+ */
+void
+SDStream_Poll(void) {
+Transfer *t;
+int i;
+
+    for(i=0;i<SDSTREAM_MAXCONN;i++) {
+        t = &transfers[i];
+        if( t->pcb && t->sending && t->sendidx != t->readidx
+         && t->slot[t->sendidx%SDSTREAM_BUFFERS].req.status != SD_PENDING )
+            output(t);
+    }
+}
+
+/**
+ * @brief   SDStream_GetStats
+ */
+void
+SDStream_GetStats(SDStream_Stats *st) {
+
+    *st = stats;
+}
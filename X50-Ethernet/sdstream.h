@@ -0,0 +1,93 @@
+#ifndef SDSTREAM_H
+#define SDSTREAM_H
+/**
+ * @file    sdstream.h
+ *
+ * @note    Sends files of the MicroSD card (fat.c) over TCP, for logs too
+ *          large for TFTP, which waits for an ACK after each 512 byte block
+ *
+ * @note    The client sends the 8.3 name of a file in the root directory,
+ *          ended by a new line, and receives the file. The connection is then
+ *          closed. When the file is not found, it is closed at once
+ *
+ *          echo LOG001.TXT | nc <board> 7002 > log001.txt
+ *
+ * @note    Each transfer has a ring of SDSTREAM_BUFFERS buffers of
+ *          SDSTREAM_BUFFERSIZE bytes in SDRAM. The free buffers are filled
+ *          ahead by multiple block reads (SD_Submit, DMA), queued all at once
+ *          in sdcard.c. The buffers that were read are given to tcp_write
+ *          without copy, as in sendfile.c, and are free again when all their
+ *          bytes are acknowledged. So the card reads the next buffers while
+ *          the previous ones are on the network
+ *
+ * @note    SDStream_Poll must be called in the main loop (NO_SYS) or in the
+ *          tcpip thread (LWIP_UCOS2): it gives the buffers read since the last
+ *          call to TCP. The acknowledgments start the next reads
+ *
+ * @note    SD_Init and FAT_Mount must be called before SDStream_Init
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "lwip/tcp.h"
+
+/**
+ * @brief   Parameters
+ *
+ * @note    SDSTREAM_BUFFERSIZE is the largest read (a multiple of 512 bytes).
+ *          A read ends earlier where the file is fragmented. The ring must be
+ *          larger than TCP_SND_BUF, so that reads go on while it is full
+ */
+///@{
+#ifndef SDSTREAM_PORT
+#define SDSTREAM_PORT               7002
+#endif
+#ifndef SDSTREAM_MAXCONN
+#define SDSTREAM_MAXCONN            1
+#endif
+#ifndef SDSTREAM_BUFFERS
+#define SDSTREAM_BUFFERS            8
+#endif
+#ifndef SDSTREAM_BUFFERSIZE
+#define SDSTREAM_BUFFERSIZE         16384   ///< bytes, multiple of 512
+#endif
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define SDSTREAM_OK                 (0)
+#define SDSTREAM_ERROR_LWIP         (-1)
+///@}
+
+/**
+ * @brief   Statistics
+ *
+ * @note    diskwaits counts the times the next buffer to send was still being
+ *          read while TCP had room (the card is the limit) and ringfull the
+ *          times all buffers were read or in flight (the network is the limit)
+ */
+typedef struct {
+    uint32_t    connections;                ///< transfers started
+    uint32_t    completed;                  ///< all bytes acknowledged
+    uint32_t    aborted;                    ///< connection lost or refused
+    uint32_t    notfound;                   ///< file not found or bad name
+    uint32_t    readerrors;                 ///< card or file system errors
+    uint32_t    bytes;                      ///< bytes given to tcp_write
+    uint32_t    reads;                      ///< multiple block reads
+    uint32_t    diskwaits;
+    uint32_t    ringfull;
+    uint32_t    retries;                    ///< tcp_write without memory (ERR_MEM)
+    uint32_t    lastbytes;                  ///< size of the last completed file
+    uint32_t    lastms;                     ///< and its transfer time
+} SDStream_Stats;
+
+int  SDStream_Init(unsigned port);
+void SDStream_Poll(void);
+void SDStream_GetStats(SDStream_Stats *st);
+
+#endif // SDSTREAM_H
@@ -0,0 +1,273 @@
+/**
+ * @file    sendfile.c
+ *
+ * @note    Zero copy transmission of a constant memory area over TCP (see
+ *          sendfile.h)
+ *
+ * @note    The area is given to tcp_write in pieces of up to tcp_sndbuf bytes,
+ *          while the send queue has room. The tcp_sent callback (an ACK freed
+ *          room) gives the next piece. When tcp_write fails for lack of pbufs
+ *          (ERR_MEM), the tcp_poll callback retries when no ACK is expected
+ *
+ * @note    The connection is closed after the last tcp_write. tcp_close sends
+ *          the FIN after the queued segments, which keep referencing the area
+ *          until they are acknowledged. So the slot is free at once
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "lwip/opt.h"
+#include "lwip/tcp.h"
+#include "sendfile.h"
+
+/**
+ * @brief   Transfers
+ */
+///@{
+typedef struct {
+    struct tcp_pcb     *pcb;                // null when free
+    const uint8_t      *next;               // next byte to give to tcp_write
+    uint32_t            left;               // bytes not given yet
+} Transfer;
+
+static Transfer         transfers[SENDFILE_MAXCONN];
+///@}
+
+/**
+ * @brief   Server
+ */
+///@{
+static struct tcp_pcb   *listenpcb = 0;
+static const uint8_t    *srvdata = 0;
+static uint32_t         srvsize = 0;
+///@}
+
+static SendFile_Stats   stats;
+
+/**
+ * @brief   Detach a transfer from its pcb
+ */
+static void
+release(Transfer *t) {
+
+    if( t->pcb ) {
+        tcp_arg(t->pcb,0);
+        tcp_recv(t->pcb,0);
+        tcp_sent(t->pcb,0);
+        tcp_err(t->pcb,0);
+        tcp_poll(t->pcb,0,0);
+    }
+    t->pcb  = 0;
+    t->left = 0;
+}
+
+/**
+ * @brief   End a transfer. The queued segments are still sent (tcp_close)
+ *          unless abort is set
+ *
+ * @note    Returns ERR_ABRT when the pcb was aborted (and freed)
+ */
+static err_t
+finish(Transfer *t, int abort) {
+struct tcp_pcb *pcb = t->pcb;
+
+    release(t);
+    if( !pcb )
+        return ERR_OK;
+    if( abort || tcp_close(pcb) != ERR_OK ) {
+        stats.aborted++;
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+    return ERR_OK;
+}
+
+/**
+ * @brief   Give the next pieces of the area to TCP
+ *
+ * @note    Returns ERR_ABRT when the pcb was aborted
+ */
+static err_t
+output(Transfer *t) {
+struct tcp_pcb *pcb = t->pcb;
+uint32_t n;
+u8_t flags;
+err_t err;
+int queued = 0;
+
+    while( t->left > 0 ) {
+        n = tcp_sndbuf(pcb);
+        if( n == 0 || tcp_sndqueuelen(pcb)+2 >= TCP_SND_QUEUELEN )
+            break;
+        if( n > t->left )
+            n = t->left;
+        flags = n < t->left ? TCP_WRITE_FLAG_MORE : 0;
+        err = tcp_write(pcb,t->next,(u16_t) n,flags);
+        if( err == ERR_MEM ) {
+            stats.retries++;
+            break;
+        }
+        if( err != ERR_OK )
+            return finish(t,1);
+        t->next    += n;
+        t->left    -= n;
+        stats.bytes += n;
+        queued = 1;
+    }
+    if( queued )
+        tcp_output(pcb);
+    if( t->left == 0 ) {
+        stats.completed++;
+        return finish(t,0);
+    }
+    return ERR_OK;
+}
+
+/**
+ * @brief   lwIP callbacks
+ */
+///@{
+static void
+sendfile_err(void *arg, err_t err) {
+Transfer *t = (Transfer *) arg;
+
+    // The pcb is already freed
+    t->pcb = 0;
+    t->left = 0;
+    stats.aborted++;
+}
+
+static err_t
+sendfile_sent(void *arg, struct tcp_pcb *tpcb, u16_t len) {
+
+    return output((Transfer *) arg);
+}
+
+static err_t
+sendfile_poll(void *arg, struct tcp_pcb *tpcb) {
+
+    return output((Transfer *) arg);
+}
+
+static err_t
+sendfile_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
+Transfer *t = (Transfer *) arg;
+
+    if( p == NULL ) {
+        // Closed by the client before the end
+        return finish(t,1);
+    }
+    // Anything received is discarded
+    tcp_recved(tpcb,p->tot_len);
+    pbuf_free(p);
+    return ERR_OK;
+}
+///@}
+
+/**
+ * @brief   SendFile_Send
+ *
+ * @note    Sends size bytes at data on pcb and closes it. The callbacks and
+ *          the argument of pcb are replaced. The application must not use pcb
+ *          after the call
+ *
+ * @note    Returns SENDFILE_ERROR_NOCONN when SENDFILE_MAXCONN transfers are
+ *          running (pcb is not changed) and SENDFILE_ERROR_LWIP when pcb was
+ *          aborted (a callback of lwIP calling it must return ERR_ABRT)
+ */
+int
+SendFile_Send(struct tcp_pcb *pcb, const void *data, uint32_t size) {
+Transfer *t = 0;
+int i;
+
+    if( !pcb || (!data && size) )
+        return SENDFILE_ERROR_PARAM;
+
+    for(i=0;i<SENDFILE_MAXCONN;i++) {
+        if( transfers[i].pcb == 0 ) {
+            t = &transfers[i];
+            break;
+        }
+    }
+    if( !t )
+        return SENDFILE_ERROR_NOCONN;
+
+    t->pcb  = pcb;
+    t->next = (const uint8_t *) data;
+    t->left = size;
+    stats.connections++;
+
+    tcp_arg(pcb,t);
+    tcp_recv(pcb,sendfile_recv);
+    tcp_sent(pcb,sendfile_sent);
+    tcp_err(pcb,sendfile_err);
+    tcp_poll(pcb,sendfile_poll,2);          // 1 s
+
+    if( output(t) == ERR_ABRT )
+        return SENDFILE_ERROR_LWIP;
+    return SENDFILE_OK;
+}
+
+/**
+ * @brief   Server
+ */
+static err_t
+sendfile_accept(void *arg, struct tcp_pcb *newpcb, err_t err) {
+int rc;
+
+    if( err != ERR_OK || newpcb == NULL )
+        return ERR_VAL;
+    rc = SendFile_Send(newpcb,srvdata,srvsize);
+    if( rc == SENDFILE_ERROR_NOCONN ) {
+        stats.aborted++;
+        tcp_abort(newpcb);
+    }
+    return rc == SENDFILE_OK ? ERR_OK : ERR_ABRT;
+}
+
+/**
+ * @brief   SendFile_Init
+ *
+ * @note    Listens on port. Each client receives the size bytes at data and
+ *          the connection is closed
+ */
+int
+SendFile_Init(unsigned port, const void *data, uint32_t size) {
+struct tcp_pcb *pcb;
+
+    if( !data && size )
+        return SENDFILE_ERROR_PARAM;
+
+    memset(transfers,0,sizeof(transfers));
+    memset(&stats,0,sizeof(stats));
+    srvdata = (const uint8_t *) data;
+    srvsize = size;
+
+    pcb = tcp_new_ip_type(IPADDR_TYPE_ANY);
+    if( !pcb )
+        return SENDFILE_ERROR_LWIP;
+    if( tcp_bind(pcb,IP_ANY_TYPE,port) != ERR_OK ) {
+        tcp_close(pcb);
+        return SENDFILE_ERROR_LWIP;
+    }
+    listenpcb = tcp_listen(pcb);
+    if( !listenpcb ) {
+        tcp_close(pcb);
+        return SENDFILE_ERROR_LWIP;
+    }
+    tcp_accept(listenpcb,sendfile_accept);
+    return SENDFILE_OK;
+}
+
+/**
+ * @brief   SendFile_GetStats
+ */
+void
+SendFile_GetStats(SendFile_Stats *st) {
+
+    *st = stats;
+}
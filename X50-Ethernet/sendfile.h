@@ -0,0 +1,74 @@
+#ifndef SENDFILE_H
+#define SENDFILE_H
+/**
+ * @file    sendfile.h
+ *
+ * @note    Sends a constant memory area (internal flash, QSPI flash in memory
+ *          mapped mode) over TCP without copying it
+ *
+ * @note    tcp_write is called without TCP_WRITE_FLAG_COPY, so the segments
+ *          reference the area (PBUF_ROM) instead of a copy in the lwIP heap.
+ *          With ETH_ZEROCOPY_TX, stnetif.c gives these references to the TX
+ *          descriptors (ETH_TransmitBuffers) and the MAC reads the payload
+ *          straight from the flash. Only the headers are in RAM
+ *
+ * @note    The area must not change until the last byte is acknowledged: the
+ *          retransmissions read it again. The QSPI flash must stay in memory
+ *          mapped mode (no QSPI_Write or erase, e.g. by fwupdate.c) meanwhile
+ *
+ * @note    SendFile_Init starts a server that sends the area to each client
+ *          and closes the connection. SendFile_Send does the same on a
+ *          connection of the application, taking over its callbacks
+ *
+ * @note    Uses the raw API. Must be called in the main loop (NO_SYS) or in the
+ *          tcpip thread (LWIP_UCOS2)
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+#include "lwip/tcp.h"
+
+/**
+ * @brief   Parameters
+ *
+ * @note    Each segment in flight takes a PBUF_ROM from MEMP_NUM_PBUF (up to
+ *          TCP_SND_BUF/TCP_MSS per connection)
+ */
+///@{
+#ifndef SENDFILE_PORT
+#define SENDFILE_PORT               7001
+#endif
+#ifndef SENDFILE_MAXCONN
+#define SENDFILE_MAXCONN            2
+#endif
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define SENDFILE_OK                 (0)
+#define SENDFILE_ERROR_PARAM        (-1)
+#define SENDFILE_ERROR_NOCONN       (-2)    ///< SENDFILE_MAXCONN in use
+#define SENDFILE_ERROR_LWIP         (-3)
+///@}
+
+/**
+ * @brief   Statistics
+ */
+typedef struct {
+    uint32_t    connections;                ///< transfers started
+    uint32_t    completed;                  ///< all bytes given to TCP
+    uint32_t    aborted;                    ///< connection lost or refused
+    uint32_t    bytes;                      ///< bytes given to tcp_write
+    uint32_t    retries;                    ///< tcp_write without memory (ERR_MEM)
+} SendFile_Stats;
+
+int  SendFile_Init(unsigned port, const void *data, uint32_t size);
+int  SendFile_Send(struct tcp_pcb *pcb, const void *data, uint32_t size);
+void SendFile_GetStats(SendFile_Stats *st);
+
+#endif // SENDFILE_H
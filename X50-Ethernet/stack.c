@@ -0,0 +1,147 @@
+/**
+ * @file    stack.c
+ *
+ * @note    Stack painting and high water mark (see stack.h)
+ *
+ * @note    The main stack goes from _stack_end (top of SRAM) down to the heap.
+ *          Stack_GetInfo scans it upward from the end of the heap, so the time
+ *          is proportional to the free RAM (about 1 ms for 200 KB at 200 MHz).
+ *          It is meant for reports, not for the fast path
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include "stm32f746xx.h"
+#include "syscalls.h"
+#include "stack.h"
+
+#if defined(STACK_USE_PSP) && LWIP_UCOS2
+#error "STACK_USE_PSP can not be used with uC/OS-II"
+#endif
+
+/**
+ * @brief   Symbols defined in the linker script
+ */
+///@{
+extern uint32_t _bss_end;
+extern uint32_t _stack_start;
+extern uint32_t _stack_end;
+///@}
+
+#ifdef STACK_USE_PSP
+/**
+ * @brief   Interrupt stack (MSP). In DTCM: no wait states and not used by DMA
+ */
+static uint32_t isrstack[STACK_ISRSIZE/4] __attribute__((section(".dtcm.isrstack"),aligned(8)));
+#endif
+
+/**
+ * @brief   Returns the number of bytes from the first word different from
+ *          STACK_PAINT to end
+ */
+static uint32_t scan(const uint32_t *p, const uint32_t *end) {
+
+    while( p < end && *p == STACK_PAINT )
+        p++;
+    return (uint32_t) (end-p)*4;
+}
+
+/**
+ * @brief   Stack_Init
+ *
+ * @note    Called by Reset_Handler before _main, when there is no heap yet and
+ *          only a few words of the stack are used. It does not call any function
+ */
+void
+Stack_Init(void) {
+uint32_t *p,*top;
+
+    top = (uint32_t *) ((__get_MSP()-STACK_MARGIN)&~3UL);
+    for(p=&_bss_end;p<top;p++)
+        *p = STACK_PAINT;
+#ifdef STACK_USE_PSP
+    for(p=isrstack;p<isrstack+STACK_ISRSIZE/4;p++)
+        *p = STACK_PAINT;
+#endif
+}
+
+/**
+ * @brief   Stack_Start
+ *
+ * @note    Calls entry (main) and never returns. With STACK_USE_PSP, entry runs
+ *          on PSP from the top of SRAM and MSP is moved to isrstack. The frame
+ *          of Stack_Start is left on the old MSP, so the switch and the call
+ *          are done in assembly, without using the stack
+ */
+void
+Stack_Start(void (*entry)(void)) {
+
+#ifdef STACK_USE_PSP
+    __asm volatile(
+        " msr       psp,%0                  \n"
+        " movs      r3,#2                   \n"     // CONTROL.SPSEL = 1
+        " msr       control,r3              \n"
+        " isb                               \n"
+        " msr       msp,%1                  \n"
+        " blx       %2                      \n"
+        :
+        : "r" (((uint32_t) &_stack_end)&~7UL),     // 8 byte aligned (AAPCS)
+          "r" (isrstack+STACK_ISRSIZE/4), "r" (entry)
+        : "r3", "memory"
+    );
+#else
+    entry();
+#endif
+    for(;;) {}
+}
+
+/**
+ * @brief   Stack_GetInfo
+ */
+void
+Stack_GetInfo(Stack_Info *s) {
+uint32_t *bottom,*heap;
+
+    // Memory below the heap end belongs to malloc
+    bottom = &_bss_end;
+    heap = (uint32_t *) (((uint32_t) _sbrk(0)+3)&~3UL);
+    if( heap > bottom )
+        bottom = heap;
+
+    s->size = (uint32_t) (&_stack_end-&_stack_start)*4;
+    s->used = scan(bottom,&_stack_end);
+    s->free = (uint32_t) (&_stack_end-bottom)*4-s->used;
+#ifdef STACK_USE_PSP
+    s->isrsize = STACK_ISRSIZE;
+    s->isrused = scan(isrstack,isrstack+STACK_ISRSIZE/4);
+#else
+    s->isrsize = 0;
+    s->isrused = 0;
+#endif
+}
+
+/**
+ * @brief   Stack_Report
+ *
+ * @note    Uses printf
+ */
+void
+Stack_Report(void) {
+Stack_Info s;
+
+    Stack_GetInfo(&s);
+#ifdef STACK_USE_PSP
+    printf("Stack: main %lu of %lu bytes, interrupts %lu of %lu bytes, %lu bytes never used\n",
+            (unsigned long) s.used,(unsigned long) s.size,
+            (unsigned long) s.isrused,(unsigned long) s.isrsize,
+            (unsigned long) s.free);
+#else
+    printf("Stack: main and interrupts %lu of %lu bytes, %lu bytes never used\n",
+            (unsigned long) s.used,(unsigned long) s.size,(unsigned long) s.free);
+#endif
+    if( s.used > s.size )
+        printf("Stack: larger than STACK_SIZE\n");
+}
@@ -0,0 +1,71 @@
+#ifndef STACK_H
+#define STACK_H
+/**
+ * @file    stack.h
+ *
+ * @note    Stack painting and high water mark
+ *
+ * @note    Stack_Init (called by Reset_Handler after .bss is zeroed) fills the
+ *          free RAM between the end of .bss and the stack pointer with
+ *          STACK_PAINT. The high water mark is the highest address where the
+ *          pattern was overwritten, found by a scan from the bottom. The scan
+ *          starts at the end of the heap (_sbrk), so memory given to malloc is
+ *          not taken as stack
+ *
+ * @note    Without STACK_USE_PSP, main and the interrupts share the main stack
+ *          (MSP) and only the total can be measured. With STACK_USE_PSP,
+ *          Stack_Start runs main on the process stack (PSP) at the end of SRAM
+ *          and the interrupts on isrstack (MSP, STACK_ISRSIZE bytes in DTCM),
+ *          so each one has its own high water mark
+ *
+ * @note    STACK_SIZE in the linker script is the space reserved for the stack
+ *          (the link fails when .bss leaves less than it). Use the report to
+ *          reduce it
+ *
+ * @note    With uC/OS-II, the tasks have their own stacks (OSTaskStkChk) and the
+ *          port moves MSP to its exception stack, so STACK_USE_PSP must not be
+ *          used. The main stack is then only used until OSStart
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Pattern written in the free stack
+ */
+#define STACK_PAINT                 0xA5A5A5A5UL
+
+/**
+ * @brief   Size of the interrupt stack (bytes) with STACK_USE_PSP
+ */
+#ifndef STACK_ISRSIZE
+#define STACK_ISRSIZE               2048
+#endif
+
+/**
+ * @brief   Bytes below the stack pointer not painted by Stack_Init (they are
+ *          used by Stack_Init itself)
+ */
+#define STACK_MARGIN                64
+
+/**
+ * @brief   Stack usage (bytes)
+ *
+ * @note    isrsize and isrused are 0 without STACK_USE_PSP
+ */
+typedef struct {
+    uint32_t    size;                       ///< reserved (STACK_SIZE)
+    uint32_t    used;                       ///< high water mark of main
+    uint32_t    free;                       ///< never used, down to the heap
+    uint32_t    isrsize;
+    uint32_t    isrused;                    ///< high water mark of interrupts
+} Stack_Info;
+
+void Stack_Init(void);
+void Stack_Start(void (*entry)(void));
+void Stack_GetInfo(Stack_Info *s);
+void Stack_Report(void);
+
+#endif // STACK_H
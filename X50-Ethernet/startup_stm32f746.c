@@ -17,6 +17,7 @@
  ******************************************************************************/
 
 #include "stm32f746xx.h"
+#include "stack.h"
 
 /* main : codigo do usuario */
 extern void main(void);
@@ -56,6 +57,12 @@ void BusFault_Handler(void)               WEAK_DEFAULT_ATTRIBUTE;   /* M3/M4/M7
 void UsageFault_Handler(void)             WEAK_DEFAULT_ATTRIBUTE;   /* M3/M4/M7 */
 void DebugMon_Handler(void)               WEAK_DEFAULT_ATTRIBUTE;   /* M3/M4/M7 */
 
+#if LWIP_UCOS2
+/* With uC/OS-II, PendSV and SysTick are handled by the kernel (see 17-ucos2) */
+extern void OS_CPU_PendSVHandler(void);
+extern void OS_CPU_SysTickHandler(void);
+#endif
+
 /*
  * Implementation dependent interrupt routines
  */
@@ -106,7 +113,7 @@ void TIM8_BRK_TIM12_IRQHandler(void)      WEAK_DEFAULT_ATTRIBUTE;
 void TIM8_UP_TIM13_IRQHandler(void)       WEAK_DEFAULT_ATTRIBUTE;
 void TIM8_TRG_COM_TIM14_IRQHandler(void)  WEAK_DEFAULT_ATTRIBUTE;
 void TIM8_CC_IRQHandler(void)             WEAK_DEFAULT_ATTRIBUTE;
-void DAM1_Stream7_IRQHandler(void)        WEAK_DEFAULT_ATTRIBUTE;
+void DMA1_Stream7_IRQHandler(void)        WEAK_DEFAULT_ATTRIBUTE;
 void FSMC_IRQHandler(void)                WEAK_DEFAULT_ATTRIBUTE;
 void SDMMC1_IRQHandler(void)              WEAK_DEFAULT_ATTRIBUTE;
 void TIM5_IRQHandler(void)                WEAK_DEFAULT_ATTRIBUTE;
@@ -204,8 +211,13 @@ void(*nvictable[])(void) = {
     SVC_Handler,                    /*11 : Software Interrupt         */
     DebugMon_Handler,               /*12 : Debug Monitor              */
     0,                              /*13 : reserved                   */
+#if LWIP_UCOS2
+    OS_CPU_PendSVHandler,           /*14 : PendSV                     */
+    OS_CPU_SysTickHandler,          /*15 : SysTick                    */
+#else
     PendSV_Handler,                 /*14 : PendSV                     */
     SysTick_Handler,                /*15 : SysTick                    */
+#endif
     
    /* Implementation dependent interrupt routines                     */
     WWDG_IRQHandler,                /* IRQ =  0 : Window Watchdog interrupt */
@@ -255,7 +267,7 @@ void(*nvictable[])(void) = {
     TIM8_UP_TIM13_IRQHandler,       /* IRQ = 44 : TIM8 Update and TIM13 global interrupt */
     TIM8_TRG_COM_TIM14_IRQHandler,  /* IRQ = 45 : TIM8 Trigger and Commutation and TIM14 interrupt */
     TIM8_CC_IRQHandler,             /* IRQ = 46 : TIM8 Capture Compare interrupt */
-    DAM1_Stream7_IRQHandler,        /* IRQ = 47 : DMA1 Stream7 global interrupt */
+    DMA1_Stream7_IRQHandler,        /* IRQ = 47 : DMA1 Stream7 global interrupt */
     FSMC_IRQHandler,                /* IRQ = 48 : FSMC global interrupt */
     SDMMC1_IRQHandler,              /* IRQ = 49 : SDIO global interrupt */
     TIM5_IRQHandler,                /* IRQ = 50 : TIM5 global interrupt */
@@ -365,9 +377,10 @@ void _stop(void) {
  *
  * @note Copies initial values of variables from FLASH to RAM
  * @note Zeroes uninitialized variables
+ * @note Paints the free stack (stack.c)
  * @note Calls SystemInit
  * @note Calls _main
- * @note Call main
+ * @note Call main (thru Stack_Start, that can move it to PSP)
  * @note Call _stop if main returns
  */
 
@@ -388,6 +401,9 @@ unsigned long *pDest;
         *pDest++ = 0;
     }
 
+    /* Step 2a: Fill the free stack to measure its usage */
+    Stack_Init();
+
     /* Step 3 : Call SystemInit conforme CMSIS */
     SystemInit();
 
@@ -395,7 +411,7 @@ unsigned long *pDest;
     _main();
 
     /* Step 5 : Call main */
-    main();
+    Stack_Start(main);
 
     _stop();
 }
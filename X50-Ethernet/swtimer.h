@@ -0,0 +1,81 @@
+#ifndef SWTIMER_H
+#define SWTIMER_H
+/**
+ * @file    swtimer.h
+ *
+ * @note    Software timers on a hierarchical timing wheel
+ *
+ * @note    SWTimer_Tick is called by SysTick_Handler every tick (1 ms). It
+ *          only counts and posts SWTimer_Process to the event loop (event.h),
+ *          so the wheel is changed only in thread context and the callbacks run
+ *          there, as event handlers. SWTimer_Start and SWTimer_Stop must not be
+ *          called from interrupts
+ *
+ * @note    The wheel has a level of 256 slots of 1 tick and four levels of 64
+ *          slots, each slot 64 times longer than in the level below (32 bits of
+ *          ticks in total). A timer is linked in the slot of its expiration time
+ *          in the lowest level that covers it, so start and stop are O(1). When
+ *          the first level wraps, a slot of the next level is moved down
+ *          (cascade)
+ *
+ * @note    Periodic timers are restarted from their expiration time, so they
+ *          do not drift when the callback is late
+ *
+ * @note    SWTimer_GetCycles extends DWT->CYCCNT to 64 bits (the counter wraps
+ *          in 21 s at 200 MHz, SWTimer_Tick reads it every tick)
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Ticks per second (SysTick rate)
+ */
+#ifndef SWTIMER_TICKRATE
+#define SWTIMER_TICKRATE                1000
+#endif
+
+/**
+ * @brief   Conversion from ms to ticks (rounded up)
+ */
+#define SWTIMER_MS(MS)                  ((((uint32_t) (MS))*SWTIMER_TICKRATE+999)/1000)
+
+/**
+ * @brief   Longest delay and period (ticks)
+ */
+#define SWTIMER_MAXDELAY                0x7FFFFFFFUL
+
+/**
+ * @brief   Callback (thread context)
+ */
+typedef void (*SWTimer_Callback)(void *arg);
+
+/**
+ * @brief   Timer
+ *
+ * @note    Allocated by the caller. Must be initialized with SWTimer_Init
+ */
+typedef struct SWTimer_s {
+    struct SWTimer_s   *next;           ///< 0 when not running
+    struct SWTimer_s   *prev;
+    uint32_t            expires;        ///< tick
+    uint32_t            period;         ///< ticks, 0 for one shot
+    SWTimer_Callback    callback;
+    void               *arg;
+} SWTimer;
+
+void     SWTimer_Init(SWTimer *t, SWTimer_Callback callback, void *arg);
+void     SWTimer_Start(SWTimer *t, uint32_t delay, uint32_t period);
+void     SWTimer_Stop(SWTimer *t);
+int      SWTimer_IsRunning(const SWTimer *t);
+
+void     SWTimer_Tick(void);
+void     SWTimer_Process(uint32_t arg);
+
+uint32_t SWTimer_GetTicks(void);
+uint64_t SWTimer_GetCycles(void);
+uint64_t SWTimer_GetMicroseconds(void);
+
+#endif // SWTIMER_H
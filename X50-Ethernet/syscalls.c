@@ -56,9 +56,15 @@
 
 /**
  * @brief   access to SP to detect memory overflow
+ *
+ * @note    With STACK_USE_PSP (stack.c), main runs on PSP
  */
 
-static inline char * GetStackPointer(void) { return (char *) __get_MSP(); }
+static inline char * GetStackPointer(void) {
+    if( __get_CONTROL()&CONTROL_SPSEL_Msk )
+        return (char *) __get_PSP();
+    return (char *) __get_MSP();
+}
 
 
 
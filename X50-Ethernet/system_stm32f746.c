@@ -1188,7 +1188,7 @@ SystemInit(void) {
     // Set mode to output */
     GPIOK->MODER = (GPIOK->MODER&~(0x3<<(3*2)))|(0x1<<(3*2));
     /* Turn off display */
-    GPIOK->ODR  &= ~(1<<3);
+    GPIOK->BSRR  = (1<<3)<<16;
                                         
 }
 
@@ -0,0 +1,543 @@
+/**
+ * @file    tftpd.c
+ *
+ * @note    TFTP server with block size, transfer size and window size options
+ *
+ * @note    A request (RRQ or WRQ) is received on TFTPD_PORT. The transfer uses a
+ *          second PCB bound to a free port and connected to the client, so its
+ *          packets are not mixed with new requests, which are refused with an
+ *          error while a transfer is in progress
+ *
+ * @note    Read (RRQ). The server sends a window of windowsize blocks and waits
+ *          for the ACK. The blocks are kept in the window buffer until they are
+ *          acknowledged. When the ACK is for a block before the end of the
+ *          window, the following ones were lost and are sent again (RFC 7440)
+ *
+ * @note    Write (WRQ). The server acknowledges the last block of each window
+ *          and the last block of the file. When a block is missing, the last
+ *          one received in order is acknowledged once, so the client restarts
+ *          from the next
+ *
+ * @note    When there is nothing from the client for TFTPD_TIMEOUT ms, the
+ *          unacknowledged blocks or the last ACK/OACK are sent again, up to
+ *          TFTPD_MAXRETRIES times
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "lwip/opt.h"
+#include "lwip/def.h"
+#include "lwip/pbuf.h"
+#include "lwip/udp.h"
+#include "lwip/timeouts.h"
+#include "tftpd.h"
+
+#if (TFTPD_MAXWINDOW&(TFTPD_MAXWINDOW-1)) != 0
+#error "TFTPD_MAXWINDOW must be a power of 2"
+#endif
+
+/**
+ * @brief   Opcodes and error codes
+ */
+///@{
+#define TFTPD_RRQ                   1
+#define TFTPD_WRQ                   2
+#define TFTPD_DATA                  3
+#define TFTPD_ACK                   4
+#define TFTPD_ERROR                 5
+#define TFTPD_OACK                  6
+
+#define TFTPD_ERR_UNDEFINED         0
+#define TFTPD_ERR_NOTFOUND          1
+#define TFTPD_ERR_ACCESS            2
+#define TFTPD_ERR_DISKFULL          3
+#define TFTPD_ERR_ILLEGAL           4
+#define TFTPD_ERR_OPTION            8
+///@}
+
+#define TFTPD_HEADER                4
+#define TFTPD_DEFBLKSIZE            512
+#define TFTPD_NAMESIZE              64
+#define TFTPD_CTRLSIZE              80
+
+/**
+ * @brief   Transfer state
+ */
+///@{
+static const TFTPD_Context  *tftpdctx = 0;
+static struct udp_pcb       *listenpcb = 0;
+static struct udp_pcb       *xferpcb = 0;   // null when idle
+static void                 *handle = 0;
+static int                  writing;
+static unsigned             blksize;
+static unsigned             windowsize;
+static u16_t                base;           // RRQ: first block not acknowledged
+                                            // WRQ: next block expected
+static unsigned             nwin;           // RRQ: blocks in the window buffer
+                                            // WRQ: blocks since the last ACK
+static int                  eof;            // RRQ: last block read
+static unsigned             nakdone;        // WRQ: blocks out of order
+static int                  retries;
+static u8_t                 ctrl[TFTPD_CTRLSIZE];   // last ACK or OACK
+static int                  ctrllen = 0;
+///@}
+
+/**
+ * @brief   Blocks of the window (RRQ), indexed by the block number
+ */
+///@{
+static u8_t                 window[TFTPD_MAXWINDOW][TFTPD_MAXBLKSIZE];
+static u16_t                winlen[TFTPD_MAXWINDOW];
+///@}
+
+static void tftpd_timeout(void *arg);
+
+/**
+ * @brief   tftpd_sendraw
+ *
+ * @note    Sends len bytes of data through pcb, to addr/port when addr is set
+ */
+static void
+tftpd_sendraw(struct udp_pcb *pcb, const ip_addr_t *addr, u16_t port,
+              const void *data, int len) {
+struct pbuf *p;
+
+    p = pbuf_alloc(PBUF_TRANSPORT,len,PBUF_RAM);
+    if( p == 0 )
+        return;
+    memcpy(p->payload,data,len);
+    if( addr )
+        udp_sendto(pcb,p,addr,port);
+    else
+        udp_send(pcb,p);
+    pbuf_free(p);
+}
+
+/**
+ * @brief   tftpd_senderror
+ */
+static void
+tftpd_senderror(struct udp_pcb *pcb, const ip_addr_t *addr, u16_t port,
+                int code, const char *msg) {
+u8_t buf[TFTPD_HEADER+48];
+int n = strlen(msg);
+
+    if( n > (int) sizeof(buf)-TFTPD_HEADER-1 )
+        n = sizeof(buf)-TFTPD_HEADER-1;
+    buf[0] = 0;
+    buf[1] = TFTPD_ERROR;
+    buf[2] = code>>8;
+    buf[3] = code&0xFF;
+    memcpy(buf+TFTPD_HEADER,msg,n);
+    buf[TFTPD_HEADER+n] = 0;
+    tftpd_sendraw(pcb,addr,port,buf,TFTPD_HEADER+n+1);
+}
+
+/**
+ * @brief   tftpd_sendctrl
+ *
+ * @note    Sends an ACK for blk, or the OACK already in ctrl when blk is
+ *          negative. ctrl keeps it for a retransmission
+ */
+static void
+tftpd_sendctrl(int blk) {
+
+    if( blk >= 0 ) {
+        ctrl[0] = 0;
+        ctrl[1] = TFTPD_ACK;
+        ctrl[2] = (blk>>8)&0xFF;
+        ctrl[3] = blk&0xFF;
+        ctrllen = TFTPD_HEADER;
+    }
+    tftpd_sendraw(xferpcb,0,0,ctrl,ctrllen);
+}
+
+/**
+ * @brief   tftpd_senddata
+ *
+ * @note    Sends block blk from the window buffer
+ */
+static void
+tftpd_senddata(u16_t blk) {
+int i = blk&(TFTPD_MAXWINDOW-1);
+struct pbuf *p;
+u8_t *q;
+
+    p = pbuf_alloc(PBUF_TRANSPORT,TFTPD_HEADER+winlen[i],PBUF_RAM);
+    if( p == 0 )
+        return;
+    q = p->payload;
+    q[0] = 0;
+    q[1] = TFTPD_DATA;
+    q[2] = blk>>8;
+    q[3] = blk&0xFF;
+    memcpy(q+TFTPD_HEADER,window[i],winlen[i]);
+    udp_send(xferpcb,p);
+    pbuf_free(p);
+}
+
+/**
+ * @brief   tftpd_close
+ *
+ * @note    Ends the transfer. ok tells the callback if it was completed
+ */
+static void
+tftpd_close(int ok) {
+
+    sys_untimeout(tftpd_timeout,0);
+    if( handle ) {
+        tftpdctx->close(handle,ok);
+        handle = 0;
+    }
+    if( xferpcb ) {
+        udp_remove(xferpcb);
+        xferpcb = 0;
+    }
+}
+
+/**
+ * @brief   tftpd_restarttimer
+ *
+ * @note    Called for each valid packet from the client
+ */
+static void
+tftpd_restarttimer(void) {
+
+    retries = 0;
+    sys_untimeout(tftpd_timeout,0);
+    sys_timeout(TFTPD_TIMEOUT,tftpd_timeout,0);
+}
+
+/**
+ * @brief   tftpd_fillwindow
+ *
+ * @note    Reads and sends blocks until the window is full or the file ends.
+ *          Returns -1 on a read error
+ */
+static int
+tftpd_fillwindow(void) {
+u16_t blk;
+int i,n;
+
+    while( nwin < windowsize && !eof ) {
+        blk = base+nwin;
+        i = blk&(TFTPD_MAXWINDOW-1);
+        n = tftpdctx->read(handle,window[i],blksize);
+        if( n < 0 )
+            return -1;
+        winlen[i] = n;
+        if( n < (int) blksize )
+            eof = 1;
+        nwin++;
+        tftpd_senddata(blk);
+    }
+    return 0;
+}
+
+/**
+ * @brief   tftpd_resendwindow
+ */
+static void
+tftpd_resendwindow(void) {
+unsigned k;
+
+    for(k=0;k<nwin;k++)
+        tftpd_senddata(base+k);
+}
+
+/**
+ * @brief   tftpd_timeout
+ */
+static void
+tftpd_timeout(void *arg) {
+
+    LWIP_UNUSED_ARG(arg);
+    if( xferpcb == 0 )
+        return;
+    if( ++retries > TFTPD_MAXRETRIES ) {
+        tftpd_close(0);
+        return;
+    }
+    if( !writing && nwin > 0 )
+        tftpd_resendwindow();
+    else
+        tftpd_sendctrl(-1);
+    sys_timeout(TFTPD_TIMEOUT,tftpd_timeout,0);
+}
+
+/**
+ * @brief   tftpd_recvack
+ *
+ * @note    ACK in a read transfer. Block 0 is the ACK of the OACK
+ */
+static void
+tftpd_recvack(u16_t blk) {
+u16_t acked = (u16_t) (blk-base+1);
+
+    // Older than the window
+    if( acked > nwin )
+        return;
+    // Duplicate ACK without window: the timeout sends again (Sorcerer's
+    // Apprentice, RFC 1123)
+    if( acked == 0 && nwin > 0 && windowsize == 1 )
+        return;
+    base += acked;
+    nwin -= acked;
+    if( eof && nwin == 0 ) {
+        tftpd_close(1);
+        return;
+    }
+    // Blocks after blk were lost
+    tftpd_resendwindow();
+    if( tftpd_fillwindow() < 0 ) {
+        tftpd_senderror(xferpcb,0,0,TFTPD_ERR_ACCESS,"Read error");
+        tftpd_close(0);
+    }
+}
+
+/**
+ * @brief   tftpd_recvdata
+ *
+ * @note    DATA in a write transfer. p has the header removed
+ */
+static void
+tftpd_recvdata(u16_t blk, struct pbuf *p) {
+int last;
+
+    if( blk != base ) {
+        // Gap or duplicate: acknowledge the last block received in order,
+        // once for each window
+        if( nakdone == 0 ) {
+            tftpd_sendctrl((u16_t) (base-1));
+            nwin = 0;
+        }
+        if( ++nakdone >= windowsize )
+            nakdone = 0;
+        return;
+    }
+    last = p->tot_len < blksize;
+    if( p->tot_len > 0 && tftpdctx->write(handle,p) < 0 ) {
+        tftpd_senderror(xferpcb,0,0,TFTPD_ERR_DISKFULL,"Write error");
+        tftpd_close(0);
+        return;
+    }
+    base++;
+    nwin++;
+    nakdone = 0;
+    if( last || nwin >= windowsize ) {
+        tftpd_sendctrl(blk);
+        nwin = 0;
+    }
+    if( last )
+        tftpd_close(1);
+}
+
+/**
+ * @brief   tftpd_xferrecv
+ *
+ * @note    Receive callback of the transfer PCB (only from the client)
+ */
+static void
+tftpd_xferrecv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+               const ip_addr_t *addr, u16_t port) {
+u8_t hdr[TFTPD_HEADER];
+u16_t op,blk;
+
+    LWIP_UNUSED_ARG(arg);
+    LWIP_UNUSED_ARG(addr);
+    LWIP_UNUSED_ARG(port);
+
+    if( pbuf_copy_partial(p,hdr,TFTPD_HEADER,0) != TFTPD_HEADER ) {
+        pbuf_free(p);
+        return;
+    }
+    op  = (hdr[0]<<8)|hdr[1];
+    blk = (hdr[2]<<8)|hdr[3];
+
+    if( op == TFTPD_ERROR ) {
+        tftpd_close(0);
+    } else if( op == TFTPD_ACK && !writing ) {
+        tftpd_restarttimer();
+        tftpd_recvack(blk);
+    } else if( op == TFTPD_DATA && writing ) {
+        tftpd_restarttimer();
+        pbuf_remove_header(p,TFTPD_HEADER);
+        tftpd_recvdata(blk,p);
+    } else {
+        tftpd_senderror(pcb,0,0,TFTPD_ERR_ILLEGAL,"Illegal operation");
+        tftpd_close(0);
+    }
+    pbuf_free(p);
+}
+
+/**
+ * @brief   tftpd_getstring
+ *
+ * @note    Copies the string at offset off of p into s. Returns the offset
+ *          after its terminator or -1
+ */
+static int
+tftpd_getstring(struct pbuf *p, int off, char *s, int size) {
+u16_t end;
+int n;
+
+    if( off >= p->tot_len )
+        return -1;
+    end = pbuf_memfind(p,"",1,off);
+    if( end == 0xFFFF )
+        return -1;
+    n = end-off;
+    if( n >= size )
+        return -1;
+    pbuf_copy_partial(p,s,n,off);
+    s[n] = 0;
+    return end+1;
+}
+
+/**
+ * @brief   tftpd_addoption
+ *
+ * @note    Appends an option with a numerical value to the OACK in ctrl
+ */
+static void
+tftpd_addoption(const char *name, unsigned long value) {
+
+    ctrllen += snprintf((char *) ctrl+ctrllen,sizeof(ctrl)-ctrllen,"%s",name)+1;
+    ctrllen += snprintf((char *) ctrl+ctrllen,sizeof(ctrl)-ctrllen,"%lu",value)+1;
+}
+
+/**
+ * @brief   tftpd_recv
+ *
+ * @note    Receive callback of TFTPD_PORT: RRQ and WRQ
+ */
+static void
+tftpd_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+           const ip_addr_t *addr, u16_t port) {
+char name[TFTPD_NAMESIZE];
+char mode[12];
+char opt[12];
+char val[12];
+int off, op, oack = 0;
+long tsize = -1, size;
+unsigned long v;
+u8_t hdr[2];
+
+    LWIP_UNUSED_ARG(arg);
+
+    if( pbuf_copy_partial(p,hdr,2,0) != 2 )
+        goto done;
+    op = (hdr[0]<<8)|hdr[1];
+    if( op != TFTPD_RRQ && op != TFTPD_WRQ ) {
+        tftpd_senderror(pcb,addr,port,TFTPD_ERR_ILLEGAL,"Illegal operation");
+        goto done;
+    }
+    if( xferpcb ) {
+        tftpd_senderror(pcb,addr,port,TFTPD_ERR_UNDEFINED,"Busy");
+        goto done;
+    }
+
+    off = tftpd_getstring(p,2,name,sizeof(name));
+    if( off > 0 )
+        off = tftpd_getstring(p,off,mode,sizeof(mode));
+    if( off < 0 ) {
+        tftpd_senderror(pcb,addr,port,TFTPD_ERR_ILLEGAL,"Bad request");
+        goto done;
+    }
+
+    // Options. Unknown ones are ignored
+    writing    = op == TFTPD_WRQ;
+    blksize    = TFTPD_DEFBLKSIZE;
+    windowsize = 1;
+    ctrl[0]    = 0;
+    ctrl[1]    = TFTPD_OACK;
+    ctrllen    = 2;
+    while( off > 0 && off < p->tot_len ) {
+        off = tftpd_getstring(p,off,opt,sizeof(opt));
+        if( off > 0 )
+            off = tftpd_getstring(p,off,val,sizeof(val));
+        if( off < 0 )
+            break;
+        v = strtoul(val,0,10);
+        if( lwip_stricmp(opt,"blksize") == 0 && v >= 8 ) {
+            blksize = v < TFTPD_MAXBLKSIZE ? v : TFTPD_MAXBLKSIZE;
+            tftpd_addoption("blksize",blksize);
+            oack = 1;
+        } else if( lwip_stricmp(opt,"windowsize") == 0 && v >= 1 ) {
+            windowsize = v < TFTPD_MAXWINDOW ? v : TFTPD_MAXWINDOW;
+            tftpd_addoption("windowsize",windowsize);
+            oack = 1;
+        } else if( lwip_stricmp(opt,"tsize") == 0 ) {
+            tsize = v;
+            oack = 1;
+        }
+    }
+
+    handle = tftpdctx->open(name,mode,writing);
+    if( handle == 0 ) {
+        tftpd_senderror(pcb,addr,port,
+                writing?TFTPD_ERR_ACCESS:TFTPD_ERR_NOTFOUND,"Cannot open file");
+        goto done;
+    }
+    // tsize: the size of the file to the client, the one announced by the client
+    if( tsize >= 0 ) {
+        size = tsize;
+        if( !writing )
+            size = tftpdctx->size ? tftpdctx->size(handle) : -1;
+        if( size >= 0 )
+            tftpd_addoption("tsize",size);
+        else if( ctrllen == 2 )
+            oack = 0;
+    }
+
+    xferpcb = udp_new_ip_type(IP_GET_TYPE(addr));
+    if( xferpcb == 0
+     || udp_bind(xferpcb,IP_ANY_TYPE,0) != ERR_OK
+     || udp_connect(xferpcb,addr,port) != ERR_OK ) {
+        tftpd_senderror(pcb,addr,port,TFTPD_ERR_UNDEFINED,"No memory");
+        tftpd_close(0);
+        goto done;
+    }
+    udp_recv(xferpcb,tftpd_xferrecv,0);
+
+    base    = 1;
+    nwin    = 0;
+    eof     = 0;
+    nakdone = 0;
+    tftpd_restarttimer();
+    if( oack ) {
+        // RRQ: the data starts with the ACK of block 0. WRQ: OACK is ACK 0
+        tftpd_sendctrl(-1);
+    } else if( writing ) {
+        tftpd_sendctrl(0);
+    } else if( tftpd_fillwindow() < 0 ) {
+        tftpd_senderror(xferpcb,0,0,TFTPD_ERR_ACCESS,"Read error");
+        tftpd_close(0);
+    }
+done:
+    pbuf_free(p);
+}
+
+/**
+ * @brief   TFTPD_Init
+ *
+ * @note    Starts listening on TFTPD_PORT. Returns 0 or -1
+ */
+int
+TFTPD_Init(const TFTPD_Context *ctx) {
+
+    tftpdctx = ctx;
+    listenpcb = udp_new_ip_type(IPADDR_TYPE_ANY);
+    if( listenpcb == 0 )
+        return -1;
+    if( udp_bind(listenpcb,IP_ANY_TYPE,TFTPD_PORT) != ERR_OK ) {
+        udp_remove(listenpcb);
+        listenpcb = 0;
+        return -1;
+    }
+    udp_recv(listenpcb,tftpd_recv,0);
+    return 0;
+}
@@ -0,0 +1,61 @@
+#ifndef TFTPD_H
+#define TFTPD_H
+/**
+ * @file    tftpd.h
+ *
+ * @note    TFTP server with block size (RFC 2348), transfer size (RFC 2349)
+ *          and window size (RFC 7440) options
+ *
+ * @note    It replaces the lwIP tftp_server app, which transfers only one block
+ *          of 512 bytes for each round trip. One transfer at a time is served,
+ *          from its own UDP port
+ *
+ * @note    Uses the raw API. TFTPD_Init must be called in the main loop (NO_SYS)
+ *          or in the tcpip thread (LWIP_UCOS2)
+ */
+
+#include "lwip/pbuf.h"
+
+/**
+ * @brief   Parameters
+ */
+///@{
+#ifndef TFTPD_PORT
+#define TFTPD_PORT                  69
+#endif
+/// Largest block accepted (1500 bytes MTU less IPv4, UDP and TFTP headers)
+#ifndef TFTPD_MAXBLKSIZE
+#define TFTPD_MAXBLKSIZE            1468
+#endif
+/// Largest window accepted. Must be a power of 2
+#ifndef TFTPD_MAXWINDOW
+#define TFTPD_MAXWINDOW             16
+#endif
+/// Time in ms without an answer before the last packets are sent again
+#ifndef TFTPD_TIMEOUT
+#define TFTPD_TIMEOUT               1000
+#endif
+#ifndef TFTPD_MAXRETRIES
+#define TFTPD_MAXRETRIES            5
+#endif
+///@}
+
+/**
+ * @brief   Callbacks for the files
+ *
+ * @note    read returns the number of bytes read (less than len at the end of
+ *          the file) or -1. write returns 0 or -1. close gets ok set when the
+ *          transfer was completed. size returns the size of a file open for
+ *          reading or -1 when unknown. It can be null
+ */
+typedef struct {
+    void   *(*open)(const char *name, const char *mode, int write);
+    void    (*close)(void *handle, int ok);
+    int     (*read)(void *handle, void *buf, int len);
+    int     (*write)(void *handle, struct pbuf *p);
+    long    (*size)(void *handle);
+} TFTPD_Context;
+
+int TFTPD_Init(const TFTPD_Context *ctx);
+
+#endif // TFTPD_H
@@ -0,0 +1,297 @@
+/**
+ * @file    mkwebfs.c
+ *
+ * @note    Converts a directory into the file system of the lwIP httpd
+ *          (HTTPD_FSDATA_FILE, see fs.c)
+ *
+ * @note    Host program. Built with make mkwebfs. Usage
+ *
+ *          mkwebfs [-z] dir > webfs_data.h
+ *
+ *          -z compresses text files (html, css, js, svg, txt) with gzip, when
+ *          they get smaller. They are sent with Content-Encoding: gzip
+ *
+ * @note    The HTTP headers are included in the data, with Content-Length for
+ *          static files, so the connection can be kept alive. Files with the
+ *          SSI extensions of httpd.c (shtml, shtm, ssi, xml, json) are never
+ *          compressed and are sent with Connection: close
+ *
+ * @note    All files are in one const array, so they are contiguous in flash
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+/**
+ * @brief   Content types by extension
+ */
+static const struct {
+    const char  *ext;
+    const char  *type;
+    int         text;                       // can be compressed
+} types[] = {
+    { "html",   "text/html",                1 },
+    { "htm",    "text/html",                1 },
+    { "shtml",  "text/html",                0 },
+    { "shtm",   "text/html",                0 },
+    { "ssi",    "text/html",                0 },
+    { "css",    "text/css",                 1 },
+    { "js",     "application/javascript",   1 },
+    { "json",   "application/json",         0 },
+    { "xml",    "text/xml",                 0 },
+    { "svg",    "image/svg+xml",            1 },
+    { "txt",    "text/plain",               1 },
+    { "png",    "image/png",                0 },
+    { "gif",    "image/gif",                0 },
+    { "jpg",    "image/jpeg",               0 },
+    { "ico",    "image/x-icon",             0 },
+};
+#define NTYPES ((int)(sizeof(types)/sizeof(types[0])))
+
+static const char *ssiext[] = { "shtml", "shtm", "ssi", "xml", "json" };
+#define NSSIEXT ((int)(sizeof(ssiext)/sizeof(ssiext[0])))
+
+/**
+ * @brief   Files found
+ */
+#define MAXFILES 256
+static char *names[MAXFILES];
+static int  nfiles = 0;
+
+/**
+ * @brief   Output array
+ */
+static unsigned char    *out;
+static long             outsize = 0, outcap = 0;
+
+static void
+emit(const void *data, long n) {
+
+    if( outsize+n > outcap ) {
+        outcap = (outsize+n)*2;
+        out = realloc(out,outcap);
+        if( !out ) {
+            fprintf(stderr,"mkwebfs: no memory\n");
+            exit(1);
+        }
+    }
+    memcpy(out+outsize,data,n);
+    outsize += n;
+}
+
+static void
+align4(void) {
+static const unsigned char zero[4] = { 0 };
+
+    emit(zero,(4-outsize%4)%4);
+}
+
+/**
+ * @brief   scandir_r
+ *
+ * @note    Collects the regular files under dir (path relative to root)
+ */
+static void
+scandir_r(const char *root, const char *rel) {
+char path[1024];
+DIR *d;
+struct dirent *e;
+struct stat st;
+
+    snprintf(path,sizeof(path),"%s%s",root,rel);
+    d = opendir(path);
+    if( !d )
+        return;
+    while( (e = readdir(d)) != 0 ) {
+        char sub[1024];
+        if( e->d_name[0] == '.' )
+            continue;
+        snprintf(sub,sizeof(sub),"%s/%s",rel,e->d_name);
+        snprintf(path,sizeof(path),"%s%s",root,sub);
+        if( stat(path,&st) < 0 )
+            continue;
+        if( S_ISDIR(st.st_mode) ) {
+            scandir_r(root,sub);
+        } else if( S_ISREG(st.st_mode) && nfiles < MAXFILES ) {
+            names[nfiles++] = strdup(sub);
+        }
+    }
+    closedir(d);
+}
+
+static int
+cmpnames(const void *a, const void *b) {
+
+    return strcmp(*(char * const *) a,*(char * const *) b);
+}
+
+/**
+ * @brief   readfile
+ *
+ * @note    Reads a whole file or the output of a command (ispipe)
+ */
+static unsigned char *
+readfile(const char *fn, int ispipe, long *size) {
+FILE *f;
+unsigned char *buf = 0;
+long n = 0, cap = 0;
+int c;
+
+    f = ispipe ? popen(fn,"r") : fopen(fn,"rb");
+    if( !f )
+        return 0;
+    while( (c = fgetc(f)) != EOF ) {
+        if( n == cap ) {
+            cap = cap ? 2*cap : 4096;
+            buf = realloc(buf,cap);
+            if( !buf )
+                exit(1);
+        }
+        buf[n++] = c;
+    }
+    if( ispipe ) pclose(f); else fclose(f);
+    *size = n;
+    return buf ? buf : malloc(1);
+}
+
+static const char *
+extension(const char *name) {
+const char *p = strrchr(name,'.');
+
+    return (p && !strchr(p,'/')) ? p+1 : "";
+}
+
+static void
+usage(void) {
+
+    fprintf(stderr,"Usage: mkwebfs [-z] dir > webfs_data.h\n");
+    exit(1);
+}
+
+int
+main(int argc, char *argv[]) {
+const char *root = 0;
+int compress = 0;
+int i,k,ssi,text,gz;
+long size,gzsize,nameoff,dataoff,total = 0;
+long offs[MAXFILES][3];
+int flags[MAXFILES];
+char fn[1200], cmd[1300], hdr[512];
+const char *type,*ext;
+unsigned char *data,*gzdata;
+
+    for(i=1;i<argc;i++) {
+        if( strcmp(argv[i],"-z") == 0 )
+            compress = 1;
+        else if( argv[i][0] != '-' && root == 0 )
+            root = argv[i];
+        else
+            usage();
+    }
+    if( !root )
+        usage();
+
+    scandir_r(root,"");
+    qsort(names,nfiles,sizeof(names[0]),cmpnames);
+
+    for(i=0;i<nfiles;i++) {
+        snprintf(fn,sizeof(fn),"%s%s",root,names[i]);
+        data = readfile(fn,0,&size);
+        if( !data ) {
+            fprintf(stderr,"mkwebfs: cannot read %s\n",fn);
+            return 1;
+        }
+
+        ext  = extension(names[i]);
+        type = "application/octet-stream";
+        text = 0;
+        for(k=0;k<NTYPES;k++) {
+            if( strcmp(ext,types[k].ext) == 0 ) {
+                type = types[k].type;
+                text = types[k].text;
+            }
+        }
+        ssi = 0;
+        for(k=0;k<NSSIEXT;k++)
+            if( strcmp(ext,ssiext[k]) == 0 ) ssi = 1;
+
+        gz = 0;
+        if( compress && text && !ssi ) {
+            snprintf(cmd,sizeof(cmd),"gzip -9 -n -c '%s'",fn);
+            gzdata = readfile(cmd,1,&gzsize);
+            if( gzdata && gzsize > 0 && gzsize < size ) {
+                free(data);
+                data = gzdata;
+                size = gzsize;
+                gz = 1;
+            } else {
+                free(gzdata);
+            }
+        }
+
+        // Name
+        nameoff = outsize;
+        emit(names[i],strlen(names[i])+1);
+        align4();
+
+        // Headers and contents
+        dataoff = outsize;
+        k  = snprintf(hdr,sizeof(hdr),"HTTP/1.1 %s\r\nServer: lwIP\r\nContent-Type: %s\r\n",
+                strncmp(names[i],"/404",4) == 0 ? "404 File not found" : "200 OK",type);
+        if( ssi ) {
+            k += snprintf(hdr+k,sizeof(hdr)-k,"Cache-Control: no-cache\r\nConnection: close\r\n");
+        } else {
+            k += snprintf(hdr+k,sizeof(hdr)-k,"Content-Length: %ld\r\n",size);
+            if( gz )
+                k += snprintf(hdr+k,sizeof(hdr)-k,"Content-Encoding: gzip\r\n");
+        }
+        k += snprintf(hdr+k,sizeof(hdr)-k,"\r\n");
+        emit(hdr,k);
+        emit(data,size);
+        offs[i][0] = nameoff;
+        offs[i][1] = dataoff;
+        offs[i][2] = outsize-dataoff;
+        flags[i]   = ssi;
+        align4();
+
+        fprintf(stderr,"mkwebfs: %-24s %7ld bytes%s%s\n",names[i],size,
+                gz?" (gzip)":"",ssi?" (SSI)":"");
+        total += size;
+        free(data);
+    }
+
+    printf("/**\n * @file    webfs_data.h\n *\n * @note    Generated by mkwebfs from %s\n",root);
+    printf(" *\n * @note    %d files, %ld bytes (%ld with headers). Included by fs.c\n */\n\n",
+            nfiles,total,outsize);
+    printf("static const unsigned char webfs_data[%ld] __attribute__((aligned(4))) = {",outsize);
+    for(i=0;i<outsize;i++)
+        printf("%s0x%02X,",(i%16)?" ":"\n    ",out[i]);
+    printf("\n};\n\n");
+
+    // Linked list, first file last
+    for(i=0;i<nfiles;i++) {
+        printf("const struct fsdata_file webfs_file%d[] = { {\n",i);
+        if( i == 0 )
+            printf("    NULL,\n");
+        else
+            printf("    webfs_file%d,\n",i-1);
+        printf("    webfs_data+%ld,\n    webfs_data+%ld,\n    %ld,\n",offs[i][0],offs[i][1],offs[i][2]);
+        if( flags[i] )
+            printf("    FS_FILE_FLAGS_HEADER_INCLUDED|FS_FILE_FLAGS_SSI,\n} };\n\n");
+        else
+            printf("    FS_FILE_FLAGS_HEADER_INCLUDED|FS_FILE_FLAGS_HEADER_PERSISTENT"
+                   "|FS_FILE_FLAGS_HEADER_HTTPVER_1_1,\n} };\n\n");
+    }
+    if( nfiles )
+        printf("#define FS_ROOT webfs_file%d\n",nfiles-1);
+    else
+        printf("#define FS_ROOT NULL\n");
+    printf("#define FS_NUMFILES %d\n",nfiles);
+    return 0;
+}
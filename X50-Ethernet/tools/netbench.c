@@ -0,0 +1,507 @@
+/**
+ * @file    netbench.c
+ *
+ * @note    Host side of the UDP benchmark (netbench.h of the board)
+ *
+ * @note    Host program. Built with make netbench. Usage
+ *
+ *          netbench [-p port] [-n count] [-s size] [-r rate] [-t ms] board mode
+ *
+ *          echo    sends count ECHO datagrams of size bytes, one at a time, and
+ *                  reports the round trip time (min, p50, p99, max) and the
+ *                  time spent in the board (from the DWT->CYCCNT timestamps)
+ *          icmp    the same with ICMP echo requests (ping socket, or raw
+ *                  socket when run as root)
+ *          sink    sends count DATA datagrams of size bytes at rate
+ *                  datagrams/s (0 for as fast as possible) and reports what
+ *                  the board received (pps, Mbit/s, lost, reordered)
+ *          source  asks the board to send count datagrams of size bytes at
+ *                  rate datagrams/s and reports what was received
+ *
+ * @note    size is the UDP payload (at least the 52 bytes of the header, at most
+ *          1472 for a 1500 bytes MTU). Defaults: port 7000, count 1000, size 64,
+ *          rate 0, timeout 1000 ms
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <endian.h>
+#include <poll.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/ip_icmp.h>
+#include <sys/socket.h>
+
+/**
+ * @brief   Protocol (same as netbench.h of the board)
+ */
+///@{
+#define NETBENCH_MAGIC              0x48434E42
+
+#define NETBENCH_TYPE_ECHO          1
+#define NETBENCH_TYPE_DATA          2
+#define NETBENCH_TYPE_START         3
+#define NETBENCH_TYPE_SOURCE        4
+#define NETBENCH_TYPE_REPORT        5
+#define NETBENCH_TYPE_RESET         6
+
+typedef struct {
+    uint32_t    magic;
+    uint16_t    type;
+    uint16_t    size;
+    uint32_t    seq;
+    uint32_t    rxcycles;
+    uint32_t    txcycles;
+    uint32_t    value[8];
+} NetBench_Header;
+
+#define NETBENCH_REPORT_RECEIVED    0
+#define NETBENCH_REPORT_LOST        1
+#define NETBENCH_REPORT_REORDERED   2
+#define NETBENCH_REPORT_BYTES       3
+#define NETBENCH_REPORT_ELAPSED     4
+#define NETBENCH_REPORT_SENT        5
+#define NETBENCH_REPORT_SENDERRORS  6
+#define NETBENCH_REPORT_CLOCK       7
+///@}
+
+#define MAXSIZE                     9000
+
+/**
+ * @brief   Options
+ */
+///@{
+static int          port    = 7000;
+static unsigned     count   = 1000;
+static unsigned     size    = 64;
+static unsigned     rate    = 0;
+static int          timeout = 1000;         // ms
+static struct sockaddr_in board;
+///@}
+
+/**
+ * @brief   Time in ns (monotonic)
+ */
+static uint64_t now_ns( void ) {
+struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (uint64_t) ts.tv_sec*1000000000ULL+ts.tv_nsec;
+}
+
+/**
+ * @brief   Header conversion (the board is little endian)
+ */
+static void header_swap( NetBench_Header *h ) {
+int i;
+
+    h->magic    = le32toh(h->magic);
+    h->type     = le16toh(h->type);
+    h->size     = le16toh(h->size);
+    h->seq      = le32toh(h->seq);
+    h->rxcycles = le32toh(h->rxcycles);
+    h->txcycles = le32toh(h->txcycles);
+    for(i=0;i<8;i++)
+        h->value[i] = le32toh(h->value[i]);
+}
+
+/**
+ * @brief   Sends a header padded to len bytes
+ */
+static int send_header( int s, NetBench_Header *h, unsigned len ) {
+static uint8_t buf[MAXSIZE];
+
+    memset(buf,0,len);
+    header_swap(h);                         // htole32 is the same swap
+    memcpy(buf,h,sizeof(*h));
+    header_swap(h);
+    return send(s,buf,len,0) == (ssize_t) len ? 0 : -1;
+}
+
+/**
+ * @brief   Receives a datagram with a header. Returns its size, 0 on timeout
+ */
+static int recv_header( int s, NetBench_Header *h, int ms ) {
+static uint8_t buf[MAXSIZE+64];
+struct pollfd pfd = { s, POLLIN, 0 };
+ssize_t n;
+
+    for(;;) {
+        if( poll(&pfd,1,ms) <= 0 )
+            return 0;
+        n = recv(s,buf,sizeof(buf),0);
+        if( n < (ssize_t) sizeof(*h) )
+            continue;
+        memcpy(h,buf,sizeof(*h));
+        header_swap(h);
+        if( h->magic == NETBENCH_MAGIC )
+            return (int) n;
+    }
+}
+
+/**
+ * @brief   Latency statistics
+ */
+static int cmp_u64( const void *a, const void *b ) {
+uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+
+    return x < y ? -1 : x > y;
+}
+
+static void print_latency( const char *name, uint64_t *v, unsigned n ) {
+
+    if( n == 0 ) {
+        printf("%-8s no samples\n",name);
+        return;
+    }
+    qsort(v,n,sizeof(v[0]),cmp_u64);
+    printf("%-8s min %8.1f  p50 %8.1f  p99 %8.1f  max %8.1f us\n",name,
+            v[0]/1000.0,v[n/2]/1000.0,v[(n*99)/100]/1000.0,v[n-1]/1000.0);
+}
+
+/**
+ * @brief   Paces the transmission at rate datagrams/s
+ */
+static void pace( uint64_t start, unsigned i ) {
+uint64_t due,t;
+
+    if( rate == 0 )
+        return;
+    due = start+(uint64_t) i*1000000000ULL/rate;
+    while( (t = now_ns()) < due ) {
+        if( due-t > 200000 )
+            usleep((due-t)/1000-100);
+    }
+}
+
+/**
+ * @brief   UDP socket connected to the board
+ */
+static int open_udp( void ) {
+int s;
+int bufsize = 4*1024*1024;
+
+    s = socket(AF_INET,SOCK_DGRAM,0);
+    if( s < 0 ) {
+        perror("socket");
+        exit(1);
+    }
+    setsockopt(s,SOL_SOCKET,SO_RCVBUF,&bufsize,sizeof(bufsize));
+    board.sin_port = htons(port);
+    if( connect(s,(struct sockaddr *) &board,sizeof(board)) < 0 ) {
+        perror("connect");
+        exit(1);
+    }
+    return s;
+}
+
+/**
+ * @brief   Asks the board for its counters (REPORT or RESET)
+ */
+static int request( int s, int type, NetBench_Header *r ) {
+NetBench_Header h;
+int tries;
+
+    for(tries=0;tries<3;tries++) {
+        memset(&h,0,sizeof(h));
+        h.magic = NETBENCH_MAGIC;
+        h.type  = type;
+        send_header(s,&h,sizeof(h));
+        if( recv_header(s,r,timeout) > 0 && r->type == NETBENCH_TYPE_REPORT )
+            return 0;
+    }
+    fprintf(stderr,"No answer from the board\n");
+    return -1;
+}
+
+/**
+ * @brief   echo mode
+ */
+static int bench_echo( void ) {
+NetBench_Header h,r;
+uint64_t *rtt,*inboard;
+uint64_t t0,t1,start;
+unsigned i,n = 0,lost = 0;
+int s = open_udp();
+
+    rtt     = calloc(count,sizeof(uint64_t));
+    inboard = calloc(count,sizeof(uint64_t));
+    start = now_ns();
+    for(i=0;i<count;i++) {
+        memset(&h,0,sizeof(h));
+        h.magic = NETBENCH_MAGIC;
+        h.type  = NETBENCH_TYPE_ECHO;
+        h.seq   = i;
+        t0 = now_ns();
+        send_header(s,&h,size);
+        for(;;) {
+            if( recv_header(s,&r,timeout) == 0 ) {
+                lost++;
+                break;
+            }
+            if( r.type != NETBENCH_TYPE_ECHO || r.seq != i )
+                continue;                   // late answer
+            t1 = now_ns();
+            rtt[n] = t1-t0;
+            if( r.value[NETBENCH_REPORT_CLOCK] )
+                inboard[n] = (uint64_t) (r.txcycles-r.rxcycles)*1000000000ULL
+                             /r.value[NETBENCH_REPORT_CLOCK];
+            n++;
+            break;
+        }
+        pace(start,i+1);
+    }
+    t1 = now_ns();
+    printf("echo: %u datagrams of %u bytes, %u lost, %.0f pps\n",
+            count,size,lost,n*1e9/(t1-start));
+    print_latency("rtt",rtt,n);
+    print_latency("board",inboard,n);
+    close(s);
+    return 0;
+}
+
+/**
+ * @brief   ICMP checksum
+ */
+static uint16_t icmp_checksum( const void *p, int len ) {
+const uint16_t *w = p;
+uint32_t sum = 0;
+
+    for(;len>1;len-=2)
+        sum += *w++;
+    if( len )
+        sum += *(const uint8_t *) w;
+    sum = (sum>>16)+(sum&0xFFFF);
+    sum += sum>>16;
+    return (uint16_t) ~sum;
+}
+
+/**
+ * @brief   icmp mode
+ */
+static int bench_icmp( void ) {
+static uint8_t buf[MAXSIZE+64];
+struct icmphdr *icmp;
+struct pollfd pfd;
+uint64_t *rtt;
+uint64_t t0,t1,start;
+unsigned i,n = 0,lost = 0;
+uint16_t id = getpid()&0xFFFF;
+int raw = 0,len,off;
+ssize_t k;
+int s;
+
+    s = socket(AF_INET,SOCK_DGRAM,IPPROTO_ICMP);
+    if( s < 0 ) {
+        s = socket(AF_INET,SOCK_RAW,IPPROTO_ICMP);
+        raw = 1;
+    }
+    if( s < 0 ) {
+        perror("ICMP socket (see net.ipv4.ping_group_range or run as root)");
+        return 1;
+    }
+    board.sin_port = 0;
+    len = sizeof(struct icmphdr)+size;
+    if( len > MAXSIZE )
+        len = MAXSIZE;
+    rtt = calloc(count,sizeof(uint64_t));
+    pfd.fd = s;
+    pfd.events = POLLIN;
+    start = now_ns();
+    for(i=0;i<count;i++) {
+        memset(buf,0,len);
+        icmp = (struct icmphdr *) buf;
+        icmp->type = ICMP_ECHO;
+        icmp->un.echo.id = htons(id);       // replaced by the kernel (ping socket)
+        icmp->un.echo.sequence = htons(i&0xFFFF);
+        icmp->checksum = icmp_checksum(buf,len);
+        t0 = now_ns();
+        if( sendto(s,buf,len,0,(struct sockaddr *) &board,sizeof(board)) != len ) {
+            perror("sendto");
+            return 1;
+        }
+        for(;;) {
+            if( poll(&pfd,1,timeout) <= 0 ) {
+                lost++;
+                break;
+            }
+            k = recv(s,buf,sizeof(buf),0);
+            off = raw ? (buf[0]&0x0F)*4 : 0;
+            if( k < off+(ssize_t) sizeof(struct icmphdr) )
+                continue;
+            icmp = (struct icmphdr *) (buf+off);
+            if( icmp->type != ICMP_ECHOREPLY || ntohs(icmp->un.echo.sequence) != (i&0xFFFF) )
+                continue;
+            if( raw && ntohs(icmp->un.echo.id) != id )
+                continue;
+            t1 = now_ns();
+            rtt[n++] = t1-t0;
+            break;
+        }
+        pace(start,i+1);
+    }
+    t1 = now_ns();
+    printf("icmp: %u requests of %u bytes, %u lost, %.0f pps\n",
+            count,size,lost,n*1e9/(t1-start));
+    print_latency("rtt",rtt,n);
+    close(s);
+    return 0;
+}
+
+/**
+ * @brief   Prints throughput
+ */
+static void print_rate( const char *name, unsigned datagrams, uint64_t bytes, uint64_t ns ) {
+
+    if( ns == 0 ) {
+        printf("%-8s %u datagrams\n",name,datagrams);
+        return;
+    }
+    printf("%-8s %u datagrams in %.3f s: %.0f pps, %.2f Mbit/s\n",name,datagrams,
+            ns/1e9,datagrams*1e9/ns,bytes*8*1e3/ns);
+}
+
+/**
+ * @brief   sink mode
+ */
+static int bench_sink( void ) {
+NetBench_Header h,r;
+uint64_t start,t1;
+unsigned i;
+int s = open_udp();
+
+    if( request(s,NETBENCH_TYPE_RESET,&r) < 0 )
+        return 1;
+
+    start = now_ns();
+    for(i=0;i<count;i++) {
+        memset(&h,0,sizeof(h));
+        h.magic = NETBENCH_MAGIC;
+        h.type  = NETBENCH_TYPE_DATA;
+        h.seq   = i;
+        if( send_header(s,&h,size) < 0 ) {
+            if( errno != ENOBUFS ) {
+                perror("send");
+                return 1;
+            }
+            i--;                            // retry
+            continue;
+        }
+        pace(start,i+1);
+    }
+    t1 = now_ns();
+    usleep(200000);                         // let the board drain its ring
+
+    if( request(s,NETBENCH_TYPE_REPORT,&r) < 0 )
+        return 1;
+    print_rate("sent",count,(uint64_t) count*size,t1-start);
+    print_rate("board",r.value[NETBENCH_REPORT_RECEIVED],r.value[NETBENCH_REPORT_BYTES],
+            (uint64_t) r.value[NETBENCH_REPORT_ELAPSED]*1000);
+    printf("lost %u (%.2f%%), reordered %u\n",
+            count-r.value[NETBENCH_REPORT_RECEIVED],
+            100.0*(count-r.value[NETBENCH_REPORT_RECEIVED])/count,
+            r.value[NETBENCH_REPORT_REORDERED]);
+    close(s);
+    return 0;
+}
+
+/**
+ * @brief   source mode
+ */
+static int bench_source( void ) {
+NetBench_Header h,r;
+uint64_t first = 0,last = 0,bytes = 0;
+unsigned received = 0,reordered = 0;
+uint32_t expected = 0;
+int s = open_udp();
+int k;
+
+    memset(&h,0,sizeof(h));
+    h.magic    = NETBENCH_MAGIC;
+    h.type     = NETBENCH_TYPE_START;
+    h.value[0] = count;
+    h.value[1] = size;
+    h.value[2] = rate;
+    send_header(s,&h,sizeof(h));
+
+    while( received < count ) {
+        k = recv_header(s,&r,timeout);
+        if( k == 0 )
+            break;
+        if( r.type != NETBENCH_TYPE_SOURCE )
+            continue;
+        last = now_ns();
+        if( received == 0 )
+            first = last;
+        received++;
+        bytes += k;
+        if( r.seq >= expected ) expected = r.seq+1;
+        else                    reordered++;
+    }
+
+    print_rate("received",received,bytes,last-first);
+    printf("lost %u (%.2f%%), reordered %u\n",count-received,
+            100.0*(count-received)/count,reordered);
+    if( request(s,NETBENCH_TYPE_REPORT,&r) == 0 )
+        printf("board sent %u, retried %u\n",r.value[NETBENCH_REPORT_SENT],
+                r.value[NETBENCH_REPORT_SENDERRORS]);
+    close(s);
+    return 0;
+}
+
+static void usage( void ) {
+
+    fprintf(stderr,"Usage: netbench [-p port] [-n count] [-s size] [-r rate] [-t ms] "
+                   "board echo|icmp|sink|source\n");
+    exit(1);
+}
+
+int main( int argc, char *argv[] ) {
+struct addrinfo hints,*ai;
+const char *mode;
+int c;
+
+    while( (c = getopt(argc,argv,"p:n:s:r:t:")) != -1 ) {
+        switch( c ) {
+        case 'p': port    = atoi(optarg); break;
+        case 'n': count   = atoi(optarg); break;
+        case 's': size    = atoi(optarg); break;
+        case 'r': rate    = atoi(optarg); break;
+        case 't': timeout = atoi(optarg); break;
+        default:  usage();
+        }
+    }
+    if( argc-optind != 2 || count == 0 )
+        usage();
+    mode = argv[optind+1];
+    if( strcmp(mode,"icmp") != 0 && size < sizeof(NetBench_Header) )
+        size = sizeof(NetBench_Header);
+    if( size > MAXSIZE )
+        size = MAXSIZE;
+
+    memset(&hints,0,sizeof(hints));
+    hints.ai_family = AF_INET;
+    if( getaddrinfo(argv[optind],0,&hints,&ai) != 0 ) {
+        fprintf(stderr,"Unknown host %s\n",argv[optind]);
+        return 1;
+    }
+    board = *(struct sockaddr_in *) ai->ai_addr;
+    freeaddrinfo(ai);
+
+    if( strcmp(mode,"echo") == 0 )   return bench_echo();
+    if( strcmp(mode,"icmp") == 0 )   return bench_icmp();
+    if( strcmp(mode,"sink") == 0 )   return bench_sink();
+    if( strcmp(mode,"source") == 0 ) return bench_source();
+    usage();
+    return 1;
+}
@@ -0,0 +1,311 @@
+/**
+ * @file    rfbview.c
+ *
+ * @note    Host side of the remote frame buffer (rfb.h of the board)
+ *
+ * @note    Host program. Built with make rfbview. Usage
+ *
+ *          rfbview [-p port] [-o file] [-n frames] board
+ *
+ *          A datagram sent to the board makes this program the viewer. Each
+ *          complete frame is written to file as a binary PPM (overwritten at
+ *          each frame, so an image viewer that reloads it shows the display)
+ *          and the frame rate and throughput are printed every second
+ *
+ * @note    When a datagram is lost, the frame is incomplete and the copy here
+ *          is not the one the board codes against, so a key frame is requested
+ *          by sending another datagram. Without data for 2 s, the request is
+ *          repeated (the board was reset or is not running yet)
+ *
+ * @note    Defaults: port 5010, no file, frames 0 (forever)
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <endian.h>
+#include <poll.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+/**
+ * @brief   Protocol (same as rfb.h of the board)
+ */
+///@{
+#define RFB_MAGIC                   0x4246
+
+#define RFB_FLAG_KEY                1
+#define RFB_FLAG_END                2
+
+typedef struct {
+    uint16_t    magic;
+    uint16_t    frame;
+    uint16_t    seq;
+    uint8_t     flags;
+    uint8_t     format;
+    uint16_t    width;
+    uint16_t    height;
+    uint16_t    x;
+    uint16_t    y;
+    uint16_t    w;
+    uint16_t    h;
+} RFB_Header;
+///@}
+
+#define MAXSIZE                     9000
+
+/**
+ * @brief   Options
+ */
+///@{
+static int          port    = 5010;
+static const char  *output  = 0;
+static unsigned     nframes = 0;
+static struct sockaddr_in board;
+///@}
+
+/**
+ * @brief   Copy of the frame of the board (RGB565)
+ */
+///@{
+static uint16_t    *frame = 0;
+static int          width  = 0;
+static int          height = 0;
+static int          valid  = 0;             // got a key frame and lost nothing since
+///@}
+
+/**
+ * @brief   Time in ms (monotonic)
+ */
+static uint64_t now_ms( void ) {
+struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (uint64_t) ts.tv_sec*1000ULL+ts.tv_nsec/1000000;
+}
+
+/**
+ * @brief   Header conversion (the board is little endian)
+ */
+static void header_swap( RFB_Header *h ) {
+
+    h->magic  = le16toh(h->magic);
+    h->frame  = le16toh(h->frame);
+    h->seq    = le16toh(h->seq);
+    h->width  = le16toh(h->width);
+    h->height = le16toh(h->height);
+    h->x      = le16toh(h->x);
+    h->y      = le16toh(h->y);
+    h->w      = le16toh(h->w);
+    h->h      = le16toh(h->h);
+}
+
+/**
+ * @brief   Asks the board for a key frame (any datagram does it)
+ */
+static void request_key( int s ) {
+static const char hello[] = "RFB";
+
+    send(s,hello,sizeof(hello),0);
+    valid = 0;
+}
+
+/**
+ * @brief   Decodes the lines of a datagram into frame. Returns -1 when it is
+ *          malformed
+ */
+static int decode( const RFB_Header *h, const uint8_t *p, const uint8_t *end ) {
+uint16_t *q,v;
+int y,i,k,c;
+
+    if( h->x+h->w > width || h->y+h->h > height )
+        return -1;
+    for(y=h->y;y<h->y+h->h;y++) {
+        q = frame+y*width+h->x;
+        i = 0;
+        while( i < h->w ) {
+            if( p >= end )
+                return -1;
+            c = *p++;
+            if( c&0x80 ) {
+                k = (c&0x7F)+1;
+            } else if( c&0x40 ) {
+                k = (c&0x3F)+1;
+                if( p+2 > end || i+k > h->w )
+                    return -1;
+                v = p[0]|(p[1]<<8);
+                p += 2;
+                for(c=0;c<k;c++)
+                    q[i+c] = v;
+            } else {
+                k = (c&0x3F)+1;
+                if( p+2*k > end || i+k > h->w )
+                    return -1;
+                for(c=0;c<k;c++,p+=2)
+                    q[i+c] = p[0]|(p[1]<<8);
+            }
+            i += k;
+        }
+        if( i != h->w )
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief   Writes frame as a binary PPM
+ */
+static void write_ppm( const char *name ) {
+char tmp[1024];
+uint16_t v;
+FILE *f;
+int i;
+
+    snprintf(tmp,sizeof(tmp),"%s.tmp",name);
+    f = fopen(tmp,"wb");
+    if( f == 0 )
+        return;
+    fprintf(f,"P6\n%d %d\n255\n",width,height);
+    for(i=0;i<width*height;i++) {
+        v = frame[i];
+        fputc(((v>>11)&0x1F)*255/31,f);
+        fputc(((v>>5)&0x3F)*255/63,f);
+        fputc((v&0x1F)*255/31,f);
+    }
+    fclose(f);
+    rename(tmp,name);                       // viewers never see a partial file
+}
+
+/**
+ * @brief   Receives and shows frames
+ */
+static int view( int s ) {
+static uint8_t buf[MAXSIZE];
+struct pollfd pfd = { s, POLLIN, 0 };
+RFB_Header h;
+uint64_t t0,last;
+unsigned frames = 0,total = 0,keys = 0,lost = 0;
+unsigned long bytes = 0;
+int curframe = -1,nextseq = 0;
+ssize_t n;
+
+    request_key(s);
+    t0 = last = now_ms();
+    for(;;) {
+        if( poll(&pfd,1,2000) <= 0 ) {
+            request_key(s);
+            continue;
+        }
+        n = recv(s,buf,sizeof(buf),0);
+        if( n < (ssize_t) sizeof(h) )
+            continue;
+        memcpy(&h,buf,sizeof(h));
+        header_swap(&h);
+        if( h.magic != RFB_MAGIC )
+            continue;
+        bytes += n;
+        last = now_ms();
+
+        if( h.width != width || h.height != height ) {
+            free(frame);
+            width  = h.width;
+            height = h.height;
+            frame  = calloc(width*height,sizeof(uint16_t));
+            if( frame == 0 )
+                return 1;
+            valid = 0;
+        }
+        if( h.frame != curframe ) {
+            if( curframe >= 0 && nextseq != 0 && valid ) {
+                lost++;                     // previous frame without its end
+                request_key(s);
+            }
+            curframe = h.frame;
+            nextseq  = 0;
+            if( h.flags&RFB_FLAG_KEY )
+                valid = 1;
+        }
+        if( h.seq != nextseq ) {
+            if( valid ) {
+                lost++;
+                request_key(s);
+            }
+            nextseq = -1;
+            continue;
+        }
+        nextseq++;
+        if( !valid )
+            continue;
+        if( decode(&h,buf+sizeof(h),buf+n) < 0 ) {
+            fprintf(stderr,"Malformed datagram (frame %u seq %u)\n",h.frame,h.seq);
+            request_key(s);
+            continue;
+        }
+        if( h.flags&RFB_FLAG_END ) {
+            frames++;
+            total++;
+            if( h.flags&RFB_FLAG_KEY )
+                keys++;
+            nextseq = 0;
+            if( output )
+                write_ppm(output);
+            if( nframes != 0 && total >= nframes )
+                return 0;
+        }
+        if( last-t0 >= 1000 ) {
+            printf("%dx%d %5.1f frames/s %8.1f kbit/s %u key frames %u lost\n",
+                    width,height,frames*1000.0/(last-t0),bytes*8.0/(last-t0),keys,lost);
+            fflush(stdout);
+            frames = 0;
+            bytes  = 0;
+            t0     = last;
+        }
+    }
+}
+
+static void usage( void ) {
+
+    fprintf(stderr,"Usage: rfbview [-p port] [-o file.ppm] [-n frames] board\n");
+    exit(1);
+}
+
+int main( int argc, char *argv[] ) {
+struct addrinfo hints,*ai;
+int c,s;
+
+    while( (c = getopt(argc,argv,"p:o:n:")) != -1 ) {
+        switch( c ) {
+        case 'p': port    = atoi(optarg); break;
+        case 'o': output  = optarg; break;
+        case 'n': nframes = atoi(optarg); break;
+        default:  usage();
+        }
+    }
+    if( argc-optind != 1 )
+        usage();
+
+    memset(&hints,0,sizeof(hints));
+    hints.ai_family = AF_INET;
+    if( getaddrinfo(argv[optind],0,&hints,&ai) != 0 ) {
+        fprintf(stderr,"Unknown host %s\n",argv[optind]);
+        return 1;
+    }
+    board = *(struct sockaddr_in *) ai->ai_addr;
+    board.sin_port = htons(port);
+    freeaddrinfo(ai);
+
+    s = socket(AF_INET,SOCK_DGRAM,0);
+    if( s < 0 || connect(s,(struct sockaddr *) &board,sizeof(board)) < 0 ) {
+        perror("socket");
+        return 1;
+    }
+    return view(s);
+}
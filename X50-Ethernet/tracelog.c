@@ -0,0 +1,139 @@
+/**
+ * @file    tracelog.c
+ *
+ * @note    Deferred logging into a ring buffer
+ *
+ * @note    Recording a message costs a few tens of cycles and does not depend on
+ *          the console speed, so the timing of interrupt and network routines
+ *          is not changed much when logging is enabled.
+ *
+ * @note    Records are formatted with printf by Trace_Flush, that must be called
+ *          where there is time to spare, e.g., the idle part of the main loop.
+ *
+ * @note    The buffer (tracebuffer) and counters (tracehead, tracetail) are global,
+ *          so they can be dumped by the debugger and formatted on the host, using
+ *          the map file to find the format strings.
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include "stm32f746xx.h"
+#include "tracelog.h"
+
+#if (TRACE_RECORDS&(TRACE_RECORDS-1)) != 0
+#error TRACE_RECORDS must be a power of 2
+#endif
+
+/**
+ * @brief   Ring buffer
+ *
+ * @note    tracehead and tracetail are free running counters
+ */
+///@{
+TRACE_Record        tracebuffer[TRACE_RECORDS];
+volatile unsigned   tracehead = 0;
+volatile unsigned   tracetail = 0;
+volatile unsigned   tracedropped = 0;
+///@}
+
+/**
+ * @brief   Enable cycle counter used as timestamp
+ */
+static void
+enablecyclecounter(void) {
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;                  // Unlock access on Cortex-M7
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @brief   Store a record
+ *
+ * @note    Normally called by the TRACE macro
+ *
+ * @note    Interrupts are disabled only to reserve a slot
+ */
+void
+Trace_Log(int nargs, const char *fmt, ...) {
+va_list ap;
+TRACE_Record *r;
+uint32_t primask;
+unsigned h;
+int i;
+
+    if( (DWT->CTRL&DWT_CTRL_CYCCNTENA_Msk) == 0 )
+        enablecyclecounter();
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    h = tracehead;
+    if( h-tracetail >= TRACE_RECORDS ) {
+        tracedropped++;
+        __set_PRIMASK(primask);
+        return;
+    }
+    r = &tracebuffer[h&(TRACE_RECORDS-1)];
+    r->fmt = 0;                             // not valid yet
+    tracehead = h+1;
+    __set_PRIMASK(primask);
+
+    if( nargs > TRACE_MAXARGS )
+        nargs = TRACE_MAXARGS;
+    va_start(ap,fmt);
+    for(i=0;i<nargs;i++)
+        r->args[i] = va_arg(ap,uint32_t);
+    va_end(ap);
+    r->nargs     = nargs;
+    r->timestamp = DWT->CYCCNT;
+    __DMB();
+    r->fmt       = fmt;
+}
+
+/**
+ * @brief   Format and print the stored records
+ *
+ * @note    Stops at a record still being written by an interrupted Trace_Log
+ *
+ * @note    Returns the number of records printed
+ */
+int
+Trace_Flush(void) {
+TRACE_Record *r;
+unsigned t;
+int n = 0;
+
+    t = tracetail;
+    while( t != tracehead ) {
+        r = &tracebuffer[t&(TRACE_RECORDS-1)];
+        if( r->fmt == 0 )
+            break;
+        printf(r->fmt,r->args[0],r->args[1],r->args[2],r->args[3]);
+        r->fmt = 0;
+        tracetail = ++t;
+        n++;
+    }
+    if( tracedropped ) {
+        printf("trace: %u records dropped\n",tracedropped);
+        tracedropped = 0;
+    }
+    return n;
+}
+
+/**
+ * @brief   Number of records waiting to be printed
+ */
+int
+Trace_Pending(void) {
+
+    return tracehead-tracetail;
+}
+
+/**
+ * @brief   Number of records dropped because buffer was full
+ */
+unsigned
+Trace_Dropped(void) {
+
+    return tracedropped;
+}
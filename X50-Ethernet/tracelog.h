@@ -0,0 +1,58 @@
+#ifndef TRACELOG_H
+#define TRACELOG_H
+/**
+ * @file    tracelog.h
+ *
+ * @note    Deferred logging. Only a pointer to the format string and the
+ *          raw arguments are stored in a ring buffer in RAM. The formatting is
+ *          done later, by Trace_Flush in the main loop, or on the host from a
+ *          dump of tracebuffer.
+ *
+ * @note    All arguments must be 32 bit words (int, unsigned, char, pointers).
+ *          Strings (%s) must be constant, because only the pointer is stored.
+ *
+ * @note    Safe to use in interrupts routines. When the buffer is full, the new
+ *          records are dropped and counted.
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Number of records in buffer (must be a power of 2)
+ */
+#ifndef TRACE_RECORDS
+#define TRACE_RECORDS       256
+#endif
+
+/**
+ * @brief   Maximal number of arguments
+ */
+#define TRACE_MAXARGS       4
+
+/**
+ * @brief   Record stored in buffer
+ */
+typedef struct {
+    const char  *fmt;                       ///< format string
+    uint32_t    timestamp;                  ///< DWT cycle counter
+    uint32_t    nargs;                      ///< number of arguments
+    uint32_t    args[TRACE_MAXARGS];        ///< arguments
+} TRACE_Record;
+
+void Trace_Log(int nargs, const char *fmt, ...);
+int  Trace_Flush(void);
+int  Trace_Pending(void);
+unsigned Trace_Dropped(void);
+
+/**
+ * @brief   TRACE(fmt,...)
+ *
+ * @note    Counts the arguments (up to TRACE_MAXARGS) and calls Trace_Log
+ */
+///@{
+#define TRACE_NARGS_(A0,A1,A2,A3,A4,N,...) N
+#define TRACE_NARGS(...) TRACE_NARGS_(__VA_ARGS__,4,3,2,1,0,0)
+#define TRACE(...)  Trace_Log(TRACE_NARGS(__VA_ARGS__),__VA_ARGS__)
+///@}
+
+#endif // TRACELOG_H
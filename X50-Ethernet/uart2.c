@@ -16,6 +16,8 @@
 #include "gpio.h"
 #include "uart.h"
 #include "fifo.h"
+#include "irqprio.h"
+#include "clkgate.h"
 
 /**
  ** @brief Bit manipulation macros
@@ -57,9 +59,9 @@ DECLARE_FIFO_AREA(inputarea,INPUTAREASIZE);
 DECLARE_FIFO_AREA(outputarea,OUTPUTAREASIZE);
 
 /**
- * @brief   Interrupt level for UARTs
+ * @brief   Interrupt level for UARTs (see irqprio.h)
  */
-#define INTLEVEL 6
+#define INTLEVEL IRQPRIO_UART
 
 /**
  ** @brief  List of known UARTs
@@ -84,17 +86,19 @@ static const int uarttabsize = sizeof(uarttab)/sizeof(UART_Info)-1;
 
 /**
  * @brief   Enable clock for UART
+ *
+ * @note    Kept in Sleep mode, so a received character wakes the core
  */
 void UART_EnableClock(USART_TypeDef *uart) {
 
-    if ( uart == USART1 )       RCC->APB2ENR |= RCC_APB2ENR_USART1EN;
-    else if ( uart == USART2 )  RCC->APB1ENR |= RCC_APB1ENR_USART2EN;
-    else if ( uart == USART3 )  RCC->APB1ENR |= RCC_APB1ENR_USART3EN;
-    else if ( uart == UART4 )   RCC->APB1ENR |= RCC_APB1ENR_UART4EN;
-    else if ( uart == UART5 )   RCC->APB1ENR |= RCC_APB1ENR_UART5EN;
-    else if ( uart == USART6 )  RCC->APB2ENR |= RCC_APB2ENR_USART6EN;
-    else if ( uart == UART7 )   RCC->APB1ENR |= RCC_APB1ENR_UART7EN;
-    else if ( uart == UART8 )   RCC->APB1ENR |= RCC_APB1ENR_UART8EN;
+    if ( uart == USART1 )       ClkGate_Enable(CLKGATE_USART1,CLKGATE_SLEEP);
+    else if ( uart == USART2 )  ClkGate_Enable(CLKGATE_USART2,CLKGATE_SLEEP);
+    else if ( uart == USART3 )  ClkGate_Enable(CLKGATE_USART3,CLKGATE_SLEEP);
+    else if ( uart == UART4 )   ClkGate_Enable(CLKGATE_UART4,CLKGATE_SLEEP);
+    else if ( uart == UART5 )   ClkGate_Enable(CLKGATE_UART5,CLKGATE_SLEEP);
+    else if ( uart == USART6 )  ClkGate_Enable(CLKGATE_USART6,CLKGATE_SLEEP);
+    else if ( uart == UART7 )   ClkGate_Enable(CLKGATE_UART7,CLKGATE_SLEEP);
+    else if ( uart == UART8 )   ClkGate_Enable(CLKGATE_UART8,CLKGATE_SLEEP);
 }
 
 
@@ -226,6 +230,7 @@ uint32_t baudrate,div,t,over;
 USART_TypeDef * uart;
 uint32_t uartfreq;
 uint32_t cr1,cr2,cr3,ckcfgr;
+GPIO_PinConfiguration pins[3];
 
     if( uartn >= uarttabsize ) return -1;
 
@@ -239,9 +244,11 @@ uint32_t cr1,cr2,cr3,ckcfgr;
     if( out )
         uarttab[uartn].conf.useoutputfifo = 1;
 
-    // Configure pins
-    GPIO_ConfigureSinglePin(&uarttab[uartn].txpinconf);
-    GPIO_ConfigureSinglePin(&uarttab[uartn].rxpinconf);
+    // Configure pins (TX and RX are in the same port in most cases)
+    pins[0] = uarttab[uartn].txpinconf;
+    pins[1] = uarttab[uartn].rxpinconf;
+    pins[2].gpio = 0;
+    GPIO_ConfigurePinTable(pins);
 
     // Configure clock for UxARTy at RCC DCKCFGR2
     ckcfgr = RCC->DCKCFGR2;
@@ -0,0 +1,233 @@
+/**
+ * @file    udpstream.c
+ *
+ * @note    High rate UDP transmission from a ring of preallocated buffers
+ *
+ * @note    Each buffer is a custom pbuf (PBUF_RAM) over a static area with room
+ *          for the UDP, IP and Ethernet headers before the payload. At each send
+ *          the pbuf is reinitialized over the same area (pbuf_alloced_custom) and
+ *          lwIP writes the headers in place, so there is no allocation and no
+ *          header pbuf in the chain. The buffer is free again when the last
+ *          reference is gone (streambuffer_free), after the driver or the ARP
+ *          queue released it
+ *
+ * @note    The buffers are in the non cacheable area, so a DMA can fill them
+ *          and the ETH DMA can transmit them (ETH_ZEROCOPY_TX) without cache
+ *          maintenance
+ *
+ * @note    Buffers are used in ring order. When the next one is still in use,
+ *          UDPStream_GetBuffer returns null and counts it in nobuffer, so the
+ *          application can drop or wait
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "lwip/opt.h"
+#include "lwip/pbuf.h"
+#include "lwip/udp.h"
+#include "lwip/sys.h"
+#include "cache.h"
+#include "udpstream.h"
+
+#if !LWIP_SUPPORT_CUSTOM_PBUF
+#error "udpstream.c needs LWIP_SUPPORT_CUSTOM_PBUF"
+#endif
+
+/**
+ * @brief   Room for the headers before the payload
+ *
+ * @note    Same offset used by pbuf_alloced_custom for PBUF_TRANSPORT
+ */
+#define UDPSTREAM_HEADROOM          LWIP_MEM_ALIGN_SIZE(PBUF_TRANSPORT)
+
+/**
+ * @brief   Buffer ring
+ */
+///@{
+typedef struct {
+    struct pbuf_custom  pc;                 // must be the first field
+    int                 busy;               // given to lwIP
+    uint8_t             mem[UDPSTREAM_HEADROOM+UDPSTREAM_PAYLOAD]
+                                        __attribute((aligned(sizeof(uint32_t))));
+} StreamBuffer;
+
+NOCACHE static StreamBuffer ring[UDPSTREAM_BUFCOUNT];
+static int                  head = 0;       // next buffer to fill
+static unsigned             fill = 0;       // bytes written by UDPStream_Write
+static unsigned             maxpayload = UDPSTREAM_PAYLOAD;
+static struct udp_pcb       *streampcb = 0;
+///@}
+
+/**
+ * @brief   Counters
+ */
+///@{
+static UDPStream_Stats      stats;
+static uint32_t             starttime = 0;
+///@}
+
+/**
+ * @brief   streambuffer_free
+ *
+ * @note    Called by pbuf_free when the last reference to the pbuf is gone
+ */
+static void
+streambuffer_free(struct pbuf *p) {
+StreamBuffer *b = (StreamBuffer *) p;
+
+    b->busy = 0;
+}
+
+/**
+ * @brief   UDPStream_Init
+ *
+ * @note    Creates the PCB, connected to addr/port, and the buffer ring.
+ *          payload is the maximal payload of a datagram (0 or larger than
+ *          UDPSTREAM_PAYLOAD for UDPSTREAM_PAYLOAD). Returns 0 or -1
+ */
+int
+UDPStream_Init(const ip_addr_t *addr, uint16_t port, unsigned payload) {
+int i;
+
+    if( streampcb == 0 ) {
+        streampcb = udp_new();
+        if( streampcb == 0 )
+            return -1;
+    }
+    if( udp_connect(streampcb,addr,port) != ERR_OK ) {
+        udp_remove(streampcb);
+        streampcb = 0;
+        return -1;
+    }
+
+    // Buffers still held by the driver are freed later by streambuffer_free
+    for(i=0;i<UDPSTREAM_BUFCOUNT;i++)
+        ring[i].pc.custom_free_function = streambuffer_free;
+    head = 0;
+    fill = 0;
+    maxpayload = (payload == 0 || payload > UDPSTREAM_PAYLOAD) ? UDPSTREAM_PAYLOAD : payload;
+
+    UDPStream_ResetStats();
+    return 0;
+}
+
+/**
+ * @brief   UDPStream_GetBuffer
+ *
+ * @note    Returns the payload area of the next buffer (maximal payload bytes) or
+ *          null when it is still in use. The same buffer is returned until it
+ *          is sent
+ */
+void *
+UDPStream_GetBuffer(void) {
+StreamBuffer *b = &ring[head];
+
+    if( streampcb == 0 )
+        return 0;
+    if( b->busy ) {
+        stats.nobuffer++;
+        return 0;
+    }
+    return b->mem+UDPSTREAM_HEADROOM;
+}
+
+/**
+ * @brief   UDPStream_Send
+ *
+ * @note    Sends len bytes of the buffer returned by UDPStream_GetBuffer and
+ *          advances to the next buffer. Returns 0 or -1. When lwIP rejects the
+ *          datagram, it is counted in senderrors and the buffer is reused
+ */
+int
+UDPStream_Send(unsigned len) {
+StreamBuffer *b = &ring[head];
+struct pbuf *p;
+err_t err;
+
+    if( streampcb == 0 || b->busy || len > maxpayload )
+        return -1;
+
+    p = pbuf_alloced_custom(PBUF_TRANSPORT,len,PBUF_RAM,&b->pc,b->mem,sizeof(b->mem));
+    if( p == 0 )
+        return -1;
+    b->busy = 1;
+    err = udp_send(streampcb,p);
+    // Reference of udp_send. The driver or ARP may keep their own
+    pbuf_free(p);
+
+    head = (head+1)%UDPSTREAM_BUFCOUNT;
+    fill = 0;
+    if( err != ERR_OK ) {
+        stats.senderrors++;
+        return -1;
+    }
+    stats.datagrams++;
+    stats.bytes += len;
+    return 0;
+}
+
+/**
+ * @brief   UDPStream_Write
+ *
+ * @note    Copies len bytes into the buffers and sends each one when full.
+ *          Returns the number of bytes copied, less than len when the ring
+ *          is full
+ */
+int
+UDPStream_Write(const void *data, unsigned len) {
+const uint8_t *src = data;
+uint8_t *buf;
+unsigned n, done = 0;
+
+    while( done < len ) {
+        buf = UDPStream_GetBuffer();
+        if( buf == 0 )
+            break;
+        n = maxpayload-fill;
+        if( n > len-done )
+            n = len-done;
+        memcpy(buf+fill,src+done,n);
+        fill += n;
+        done += n;
+        if( fill == maxpayload )
+            UDPStream_Send(fill);
+    }
+    return done;
+}
+
+/**
+ * @brief   UDPStream_Flush
+ *
+ * @note    Sends the data of UDPStream_Write not sent yet. Returns 0 or -1
+ */
+int
+UDPStream_Flush(void) {
+
+    if( fill == 0 )
+        return 0;
+    return UDPStream_Send(fill);
+}
+
+/**
+ * @brief   UDPStream_GetStats
+ *
+ * @note    Throughput is the payload sent in the time since the last reset
+ */
+void
+UDPStream_GetStats(UDPStream_Stats *st) {
+
+    stats.elapsed = sys_now()-starttime;
+    stats.kbps    = stats.elapsed ? (uint32_t) ((uint64_t) stats.bytes*8/stats.elapsed) : 0;
+    *st = stats;
+}
+
+/**
+ * @brief   UDPStream_ResetStats
+ */
+void
+UDPStream_ResetStats(void) {
+
+    memset(&stats,0,sizeof(stats));
+    starttime = sys_now();
+}
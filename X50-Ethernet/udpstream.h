@@ -0,0 +1,80 @@
+#ifndef UDPSTREAM_H
+#define UDPSTREAM_H
+/**
+ * @file    udpstream.h
+ *
+ * @note    High rate UDP transmission from a ring of preallocated buffers
+ *
+ * @note    The application gets the next free buffer of the ring
+ *          (UDPStream_GetBuffer), fills its payload in place, by the CPU or by a
+ *          DMA, and sends it (UDPStream_Send). No pbuf is allocated per datagram.
+ *          UDPStream_Write copies data into the buffers and sends them when full
+ *
+ * @note    All functions use the lwIP raw API. They must be called in the main
+ *          loop (NO_SYS) or in the tcpip thread (LWIP_UCOS2)
+ */
+
+#include <stdint.h>
+
+#include "lwip/ip_addr.h"
+
+/**
+ * @brief   Number of buffers in the ring
+ *
+ * @note    A buffer is free again when the driver and ARP are done with it. With
+ *          ETH_ZEROCOPY_TX it can be held until the DMA transmitted it
+ */
+#ifndef UDPSTREAM_BUFCOUNT
+#ifdef ETH_JUMBO
+#define UDPSTREAM_BUFCOUNT          4
+#else
+#define UDPSTREAM_BUFCOUNT          16
+#endif
+#endif
+
+/**
+ * @brief   Maximal payload of a datagram
+ *
+ * @note    1472 bytes fill a 1500 bytes MTU with the IPv4 and UDP headers, so
+ *          the datagram is not fragmented. 8972 bytes fill a jumbo frame
+ *          (ETH_JUMBO)
+ */
+#ifndef UDPSTREAM_PAYLOAD
+#ifdef ETH_JUMBO
+#define UDPSTREAM_PAYLOAD           8972
+#else
+#define UDPSTREAM_PAYLOAD           1472
+#endif
+#endif
+
+/**
+ * @brief   Default destination port
+ */
+#ifndef UDPSTREAM_PORT
+#define UDPSTREAM_PORT              5005
+#endif
+
+/**
+ * @brief   Counters of the stream
+ *
+ * @note    elapsed is the time in ms from UDPStream_Init or UDPStream_ResetStats
+ *          to the last UDPStream_GetStats
+ */
+typedef struct {
+    uint32_t    datagrams;                  ///< sent
+    uint32_t    bytes;                      ///< payload bytes sent
+    uint32_t    nobuffer;                   ///< ring full in UDPStream_GetBuffer
+    uint32_t    senderrors;                 ///< rejected by lwIP or the driver
+    uint32_t    elapsed;                    ///< ms
+    uint32_t    kbps;                       ///< payload throughput in kbit/s
+} UDPStream_Stats;
+
+int   UDPStream_Init(const ip_addr_t *addr, uint16_t port, unsigned payload);
+void *UDPStream_GetBuffer(void);
+int   UDPStream_Send(unsigned len);
+int   UDPStream_Write(const void *data, unsigned len);
+int   UDPStream_Flush(void);
+void  UDPStream_GetStats(UDPStream_Stats *stats);
+void  UDPStream_ResetStats(void);
+
+#endif // UDPSTREAM_H
@@ -0,0 +1,19 @@
+// Polls the SSI status page and fills the table
+function update() {
+    fetch("/status.json", { cache: "no-store" })
+        .then(function(r) { return r.json(); })
+        .then(function(s) {
+            for( var k in s ) {
+                var e = document.getElementById(k);
+                if( e ) e.textContent = s[k];
+            }
+        })
+        .catch(function() {});
+}
+
+document.getElementById("reset").onclick = function() {
+    fetch("/reset.cgi", { cache: "no-store" }).then(update);
+};
+
+update();
+setInterval(update, 1000);
@@ -0,0 +1,171 @@
+/**
+ * @file    webfs_data.h
+ *
+ * @note    Generated by mkwebfs from web
+ *
+ * @note    5 files, 1274 bytes (1884 with headers). Included by fs.c
+ */
+
+static const unsigned char webfs_data[1884] __attribute__((aligned(4))) = {
+    0x2F, 0x34, 0x30, 0x34, 0x2E, 0x68, 0x74, 0x6D, 0x6C, 0x00, 0x00, 0x00, 0x48, 0x54, 0x54, 0x50,
+    0x2F, 0x31, 0x2E, 0x31, 0x20, 0x34, 0x30, 0x34, 0x20, 0x46, 0x69, 0x6C, 0x65, 0x20, 0x6E, 0x6F,
+    0x74, 0x20, 0x66, 0x6F, 0x75, 0x6E, 0x64, 0x0D, 0x0A, 0x53, 0x65, 0x72, 0x76, 0x65, 0x72, 0x3A,
+    0x20, 0x6C, 0x77, 0x49, 0x50, 0x0D, 0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x54,
+    0x79, 0x70, 0x65, 0x3A, 0x20, 0x74, 0x65, 0x78, 0x74, 0x2F, 0x68, 0x74, 0x6D, 0x6C, 0x0D, 0x0A,
+    0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x4C, 0x65, 0x6E, 0x67, 0x74, 0x68, 0x3A, 0x20,
+    0x31, 0x34, 0x37, 0x0D, 0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x45, 0x6E, 0x63,
+    0x6F, 0x64, 0x69, 0x6E, 0x67, 0x3A, 0x20, 0x67, 0x7A, 0x69, 0x70, 0x0D, 0x0A, 0x0D, 0x0A, 0x1F,
+    0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x45, 0x8E, 0xB1, 0x0E, 0xC2, 0x30, 0x0C,
+    0x44, 0xF7, 0x7C, 0x85, 0xC9, 0x5E, 0x05, 0xA4, 0x0E, 0x0C, 0xAE, 0x17, 0xA8, 0xC4, 0x04, 0x1D,
+    0x58, 0x18, 0x0D, 0x71, 0x08, 0x52, 0xD3, 0xA0, 0xE2, 0x0E, 0xFC, 0x3D, 0x51, 0x10, 0x62, 0x3A,
+    0xE9, 0xEE, 0xDD, 0xE9, 0x70, 0xB5, 0x3F, 0xED, 0xCE, 0x97, 0xA1, 0x87, 0xA8, 0x69, 0x24, 0x83,
+    0x3F, 0x11, 0xF6, 0x84, 0x49, 0x94, 0xE1, 0x16, 0x79, 0x7E, 0x89, 0x76, 0x76, 0xD1, 0xD0, 0x6C,
+    0x2D, 0xA1, 0x3E, 0x74, 0x14, 0x3A, 0x66, 0x85, 0x90, 0x97, 0xC9, 0xA3, 0xFB, 0x1A, 0xE8, 0x6A,
+    0xC9, 0xE0, 0x35, 0xFB, 0x37, 0x61, 0xDC, 0x50, 0xBB, 0x6E, 0xA1, 0x81, 0x81, 0xEF, 0x02, 0xD3,
+    0x9F, 0x2E, 0x01, 0x3E, 0x09, 0x19, 0xE2, 0x2C, 0xA1, 0xB3, 0xCE, 0xD2, 0x21, 0x27, 0x41, 0xC7,
+    0x65, 0xA1, 0xF8, 0xAE, 0xD6, 0x4D, 0xE1, 0xEA, 0x93, 0x0F, 0x94, 0x19, 0x6D, 0x23, 0xA1, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x2F, 0x61, 0x70, 0x70, 0x2E, 0x6A, 0x73, 0x00, 0x48, 0x54, 0x54, 0x50,
+    0x2F, 0x31, 0x2E, 0x31, 0x20, 0x32, 0x30, 0x30, 0x20, 0x4F, 0x4B, 0x0D, 0x0A, 0x53, 0x65, 0x72,
+    0x76, 0x65, 0x72, 0x3A, 0x20, 0x6C, 0x77, 0x49, 0x50, 0x0D, 0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65,
+    0x6E, 0x74, 0x2D, 0x54, 0x79, 0x70, 0x65, 0x3A, 0x20, 0x61, 0x70, 0x70, 0x6C, 0x69, 0x63, 0x61,
+    0x74, 0x69, 0x6F, 0x6E, 0x2F, 0x6A, 0x61, 0x76, 0x61, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x0D,
+    0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x4C, 0x65, 0x6E, 0x67, 0x74, 0x68, 0x3A,
+    0x20, 0x32, 0x38, 0x36, 0x0D, 0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x45, 0x6E,
+    0x63, 0x6F, 0x64, 0x69, 0x6E, 0x67, 0x3A, 0x20, 0x67, 0x7A, 0x69, 0x70, 0x0D, 0x0A, 0x0D, 0x0A,
+    0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x7D, 0x51, 0x3D, 0x4F, 0xC3, 0x30,
+    0x10, 0xDD, 0xFD, 0x2B, 0x9E, 0x32, 0x39, 0x52, 0x71, 0xC2, 0x4A, 0xC4, 0x02, 0x62, 0xC8, 0x86,
+    0xD4, 0x11, 0x31, 0x18, 0xE7, 0x92, 0x86, 0x04, 0xBB, 0xB2, 0x2F, 0x15, 0xA8, 0xCA, 0x7F, 0xC7,
+    0x49, 0x48, 0xD5, 0x82, 0xCA, 0x9B, 0x6C, 0xDD, 0xFB, 0xF2, 0x39, 0xCB, 0xF0, 0xEC, 0xFA, 0x3E,
+    0x80, 0x77, 0x84, 0xED, 0xB6, 0x44, 0x60, 0xCD, 0x43, 0xC0, 0x5E, 0x37, 0x04, 0x6D, 0x2B, 0xD4,
+    0xED, 0x3A, 0x65, 0xFD, 0xD6, 0x93, 0xA8, 0x07, 0x6B, 0xB8, 0x75, 0x16, 0xC3, 0xBE, 0xD2, 0x4C,
+    0x32, 0xC5, 0x51, 0x20, 0xA2, 0x26, 0x36, 0x3B, 0x99, 0x64, 0x8B, 0x5E, 0xBD, 0x07, 0x67, 0x93,
+    0x0D, 0x8E, 0x30, 0xDA, 0xEC, 0xE8, 0x0E, 0x89, 0x75, 0x37, 0x81, 0x9D, 0xA7, 0x04, 0x63, 0x3A,
+    0x0B, 0x26, 0xA8, 0xE8, 0x6B, 0xE5, 0x6A, 0x29, 0x7D, 0x34, 0x83, 0x27, 0x1E, 0xBC, 0x85, 0x9F,
+    0x2D, 0x64, 0x5A, 0xFC, 0xC3, 0x0F, 0x6B, 0xF8, 0x8A, 0xDA, 0x79, 0x89, 0x83, 0xF6, 0xE8, 0xD0,
+    0x5A, 0x04, 0xFC, 0x9E, 0x4F, 0x98, 0xC6, 0x84, 0x7B, 0x54, 0xCE, 0x0C, 0x1F, 0x64, 0x59, 0x35,
+    0xC4, 0x4F, 0x3D, 0x4D, 0xC7, 0x87, 0xAF, 0xB2, 0x92, 0x5D, 0x5A, 0xFC, 0xD1, 0xB4, 0xB5, 0x8C,
+    0x9A, 0x14, 0xA4, 0x98, 0x3E, 0xF9, 0xD1, 0x59, 0x8E, 0xEC, 0xE8, 0x11, 0x5E, 0xBA, 0xD7, 0x4B,
+    0xF6, 0x78, 0xBA, 0x9D, 0xD7, 0x36, 0x7A, 0x5A, 0xCE, 0xA9, 0x77, 0xAC, 0x35, 0xC6, 0x94, 0x51,
+    0x88, 0x6B, 0x25, 0x12, 0x4F, 0x81, 0x38, 0x49, 0x95, 0xB3, 0xA6, 0x6F, 0x4D, 0x17, 0xB3, 0xCE,
+    0xD5, 0x17, 0x1B, 0x9F, 0xA9, 0xCA, 0x34, 0xED, 0xD5, 0x7D, 0x2F, 0x6B, 0x5B, 0x3E, 0x6C, 0xCA,
+    0x2D, 0x84, 0x58, 0x7F, 0xAF, 0x10, 0x51, 0x5C, 0xC6, 0xF7, 0xF8, 0x83, 0xEE, 0x7F, 0x28, 0x1B,
+    0xDC, 0xE6, 0x79, 0x1E, 0x47, 0xDF, 0xAB, 0x88, 0xF5, 0x06, 0x1D, 0x02, 0x00, 0x00, 0x00, 0x00,
+    0x2F, 0x69, 0x6E, 0x64, 0x65, 0x78, 0x2E, 0x68, 0x74, 0x6D, 0x6C, 0x00, 0x48, 0x54, 0x54, 0x50,
+    0x2F, 0x31, 0x2E, 0x31, 0x20, 0x32, 0x30, 0x30, 0x20, 0x4F, 0x4B, 0x0D, 0x0A, 0x53, 0x65, 0x72,
+    0x76, 0x65, 0x72, 0x3A, 0x20, 0x6C, 0x77, 0x49, 0x50, 0x0D, 0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65,
+    0x6E, 0x74, 0x2D, 0x54, 0x79, 0x70, 0x65, 0x3A, 0x20, 0x74, 0x65, 0x78, 0x74, 0x2F, 0x68, 0x74,
+    0x6D, 0x6C, 0x0D, 0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x4C, 0x65, 0x6E, 0x67,
+    0x74, 0x68, 0x3A, 0x20, 0x34, 0x30, 0x38, 0x0D, 0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74,
+    0x2D, 0x45, 0x6E, 0x63, 0x6F, 0x64, 0x69, 0x6E, 0x67, 0x3A, 0x20, 0x67, 0x7A, 0x69, 0x70, 0x0D,
+    0x0A, 0x0D, 0x0A, 0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x8D, 0x53, 0x4D,
+    0x4F, 0xDC, 0x30, 0x10, 0xBD, 0xEF, 0xAF, 0x98, 0xFA, 0x04, 0x07, 0x36, 0x6A, 0xA9, 0x68, 0x0F,
+    0x5E, 0x1F, 0x28, 0x20, 0x55, 0xA2, 0x02, 0xD1, 0x45, 0x6A, 0x8F, 0x8E, 0x3D, 0x4B, 0x02, 0x4E,
+    0x6C, 0xD9, 0x93, 0x85, 0xFC, 0xFB, 0x8E, 0x93, 0xE5, 0x23, 0x25, 0xD0, 0x5E, 0x3C, 0xF2, 0x9B,
+    0x79, 0xF3, 0x3C, 0xF6, 0xB3, 0xFC, 0x70, 0x72, 0xF1, 0x6D, 0xFD, 0xFB, 0xF2, 0x14, 0x2A, 0x6A,
+    0x9C, 0x5A, 0xC8, 0xC7, 0x80, 0xDA, 0x72, 0x68, 0x90, 0x34, 0x98, 0x4A, 0xC7, 0x84, 0xB4, 0x12,
+    0x1D, 0x6D, 0x0E, 0xBE, 0x0A, 0x86, 0xA9, 0x26, 0x87, 0xEA, 0xE7, 0xFA, 0xC7, 0xE1, 0xA7, 0xB3,
+    0x2F, 0x9F, 0x8F, 0xE0, 0xA4, 0x4E, 0xC6, 0x6F, 0x31, 0xF6, 0xB2, 0x18, 0x53, 0x0B, 0xE9, 0xEA,
+    0xF6, 0x0E, 0x22, 0xBA, 0x95, 0x48, 0xD4, 0x3B, 0x4C, 0x15, 0x22, 0x09, 0xA8, 0x22, 0x6E, 0x56,
+    0xA2, 0x18, 0xA0, 0xA5, 0x49, 0x29, 0x37, 0x2B, 0x76, 0x5A, 0xA5, 0xB7, 0x7D, 0x56, 0xFE, 0x38,
+    0xDF, 0x98, 0xF1, 0x85, 0x0C, 0xCA, 0xDD, 0x7F, 0xBF, 0x04, 0xDF, 0x02, 0x55, 0x08, 0x4F, 0x75,
+    0x4B, 0x58, 0xF3, 0x76, 0xAB, 0x5D, 0x87, 0x09, 0x4A, 0x74, 0xFE, 0x1E, 0x74, 0x44, 0x96, 0xD7,
+    0x16, 0x30, 0xD3, 0x21, 0xA1, 0xF1, 0xAD, 0x85, 0x4D, 0xF4, 0xCD, 0x42, 0xEA, 0xE7, 0x73, 0x68,
+    0xEA, 0xD2, 0xF2, 0x36, 0xF9, 0x56, 0xA8, 0x97, 0x3B, 0x59, 0x68, 0xB5, 0x94, 0x45, 0xC8, 0xB3,
+    0xEA, 0xD2, 0x21, 0xD4, 0x36, 0x0F, 0x92, 0xF3, 0xC3, 0xFC, 0x51, 0x49, 0xAA, 0xD4, 0x75, 0xA0,
+    0xBA, 0x41, 0xD8, 0x4B, 0xFB, 0x3C, 0x77, 0xC5, 0x90, 0x1D, 0xEA, 0xBA, 0x01, 0x16, 0xEA, 0x80,
+    0x51, 0xAB, 0x78, 0x89, 0xCF, 0x94, 0x73, 0xBE, 0x96, 0x49, 0x71, 0xBE, 0xA7, 0xF9, 0x52, 0x9E,
+    0x53, 0x5B, 0x1B, 0x31, 0xA5, 0x09, 0xA1, 0x0E, 0xF3, 0xE5, 0x67, 0x51, 0x37, 0x3C, 0x7D, 0x44,
+    0x83, 0xF5, 0x16, 0xED, 0x84, 0x13, 0x1F, 0x36, 0x43, 0x76, 0x9E, 0x79, 0xDC, 0xD3, 0xDB, 0xC4,
+    0x32, 0x27, 0xDF, 0x55, 0x4C, 0xD8, 0xD2, 0x84, 0x44, 0xFF, 0xA1, 0x36, 0x43, 0xFA, 0xB7, 0x92,
+    0x8D, 0x3E, 0x84, 0x57, 0x27, 0xCC, 0xE8, 0x1B, 0xBC, 0xAB, 0x5F, 0xE0, 0x34, 0x61, 0x6B, 0x7A,
+    0xD8, 0x33, 0xBD, 0x61, 0x1B, 0x4E, 0x5F, 0x8A, 0x93, 0x7A, 0x7B, 0xF3, 0x17, 0xB7, 0x18, 0x5E,
+    0x7C, 0x30, 0x9B, 0x2C, 0x3B, 0x22, 0x36, 0xDB, 0x20, 0x84, 0xFC, 0x07, 0x84, 0xBA, 0xCA, 0x01,
+    0x8C, 0xEF, 0x5A, 0xC2, 0xC8, 0x2F, 0x33, 0x56, 0xA8, 0xD1, 0x2B, 0xC9, 0xC4, 0x3A, 0x10, 0xA4,
+    0x68, 0xD8, 0x5C, 0x3A, 0x04, 0xF6, 0x92, 0xE0, 0xD4, 0x08, 0xE7, 0xD6, 0x3B, 0x8F, 0x17, 0xE3,
+    0x2F, 0xFB, 0x03, 0xF2, 0x9A, 0xD9, 0xCC, 0x7D, 0x03, 0x00, 0x00, 0x00, 0x2F, 0x73, 0x74, 0x61,
+    0x74, 0x75, 0x73, 0x2E, 0x6A, 0x73, 0x6F, 0x6E, 0x00, 0x00, 0x00, 0x00, 0x48, 0x54, 0x54, 0x50,
+    0x2F, 0x31, 0x2E, 0x31, 0x20, 0x32, 0x30, 0x30, 0x20, 0x4F, 0x4B, 0x0D, 0x0A, 0x53, 0x65, 0x72,
+    0x76, 0x65, 0x72, 0x3A, 0x20, 0x6C, 0x77, 0x49, 0x50, 0x0D, 0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65,
+    0x6E, 0x74, 0x2D, 0x54, 0x79, 0x70, 0x65, 0x3A, 0x20, 0x61, 0x70, 0x70, 0x6C, 0x69, 0x63, 0x61,
+    0x74, 0x69, 0x6F, 0x6E, 0x2F, 0x6A, 0x73, 0x6F, 0x6E, 0x0D, 0x0A, 0x43, 0x61, 0x63, 0x68, 0x65,
+    0x2D, 0x43, 0x6F, 0x6E, 0x74, 0x72, 0x6F, 0x6C, 0x3A, 0x20, 0x6E, 0x6F, 0x2D, 0x63, 0x61, 0x63,
+    0x68, 0x65, 0x0D, 0x0A, 0x43, 0x6F, 0x6E, 0x6E, 0x65, 0x63, 0x74, 0x69, 0x6F, 0x6E, 0x3A, 0x20,
+    0x63, 0x6C, 0x6F, 0x73, 0x65, 0x0D, 0x0A, 0x0D, 0x0A, 0x7B, 0x0A, 0x22, 0x75, 0x70, 0x74, 0x69,
+    0x6D, 0x65, 0x22, 0x3A, 0x20, 0x3C, 0x21, 0x2D, 0x2D, 0x23, 0x75, 0x70, 0x74, 0x69, 0x6D, 0x65,
+    0x2D, 0x2D, 0x3E, 0x2C, 0x0A, 0x22, 0x6C, 0x69, 0x6E, 0x6B, 0x22, 0x3A, 0x20, 0x22, 0x3C, 0x21,
+    0x2D, 0x2D, 0x23, 0x6C, 0x69, 0x6E, 0x6B, 0x2D, 0x2D, 0x3E, 0x22, 0x2C, 0x0A, 0x22, 0x69, 0x70,
+    0x22, 0x3A, 0x20, 0x22, 0x3C, 0x21, 0x2D, 0x2D, 0x23, 0x69, 0x70, 0x2D, 0x2D, 0x3E, 0x22, 0x2C,
+    0x0A, 0x22, 0x72, 0x78, 0x66, 0x72, 0x61, 0x6D, 0x65, 0x73, 0x22, 0x3A, 0x20, 0x3C, 0x21, 0x2D,
+    0x2D, 0x23, 0x72, 0x78, 0x66, 0x72, 0x61, 0x6D, 0x65, 0x73, 0x2D, 0x2D, 0x3E, 0x2C, 0x0A, 0x22,
+    0x72, 0x78, 0x62, 0x79, 0x74, 0x65, 0x73, 0x22, 0x3A, 0x20, 0x3C, 0x21, 0x2D, 0x2D, 0x23, 0x72,
+    0x78, 0x62, 0x79, 0x74, 0x65, 0x73, 0x2D, 0x2D, 0x3E, 0x2C, 0x0A, 0x22, 0x74, 0x78, 0x66, 0x72,
+    0x61, 0x6D, 0x65, 0x73, 0x22, 0x3A, 0x20, 0x3C, 0x21, 0x2D, 0x2D, 0x23, 0x74, 0x78, 0x66, 0x72,
+    0x61, 0x6D, 0x65, 0x73, 0x2D, 0x2D, 0x3E, 0x2C, 0x0A, 0x22, 0x74, 0x78, 0x62, 0x79, 0x74, 0x65,
+    0x73, 0x22, 0x3A, 0x20, 0x3C, 0x21, 0x2D, 0x2D, 0x23, 0x74, 0x78, 0x62, 0x79, 0x74, 0x65, 0x73,
+    0x2D, 0x2D, 0x3E, 0x2C, 0x0A, 0x22, 0x72, 0x78, 0x64, 0x72, 0x6F, 0x70, 0x73, 0x22, 0x3A, 0x20,
+    0x3C, 0x21, 0x2D, 0x2D, 0x23, 0x72, 0x78, 0x64, 0x72, 0x6F, 0x70, 0x73, 0x2D, 0x2D, 0x3E, 0x2C,
+    0x0A, 0x22, 0x6C, 0x61, 0x74, 0x61, 0x76, 0x67, 0x22, 0x3A, 0x20, 0x3C, 0x21, 0x2D, 0x2D, 0x23,
+    0x6C, 0x61, 0x74, 0x61, 0x76, 0x67, 0x2D, 0x2D, 0x3E, 0x0A, 0x7D, 0x0A, 0x2F, 0x73, 0x74, 0x79,
+    0x6C, 0x65, 0x2E, 0x63, 0x73, 0x73, 0x00, 0x00, 0x48, 0x54, 0x54, 0x50, 0x2F, 0x31, 0x2E, 0x31,
+    0x20, 0x32, 0x30, 0x30, 0x20, 0x4F, 0x4B, 0x0D, 0x0A, 0x53, 0x65, 0x72, 0x76, 0x65, 0x72, 0x3A,
+    0x20, 0x6C, 0x77, 0x49, 0x50, 0x0D, 0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x54,
+    0x79, 0x70, 0x65, 0x3A, 0x20, 0x74, 0x65, 0x78, 0x74, 0x2F, 0x63, 0x73, 0x73, 0x0D, 0x0A, 0x43,
+    0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x4C, 0x65, 0x6E, 0x67, 0x74, 0x68, 0x3A, 0x20, 0x31,
+    0x39, 0x30, 0x0D, 0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x45, 0x6E, 0x63, 0x6F,
+    0x64, 0x69, 0x6E, 0x67, 0x3A, 0x20, 0x67, 0x7A, 0x69, 0x70, 0x0D, 0x0A, 0x0D, 0x0A, 0x1F, 0x8B,
+    0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x6D, 0x8F, 0xC1, 0x0E, 0xC2, 0x20, 0x10, 0x44,
+    0xEF, 0xFD, 0x8A, 0x4D, 0xBC, 0xDA, 0xC6, 0x62, 0xBC, 0xD0, 0xAF, 0xA1, 0xB0, 0xA5, 0x24, 0xC0,
+    0x12, 0xE0, 0xD0, 0x6A, 0xFA, 0xEF, 0x22, 0xB5, 0x89, 0x46, 0xF7, 0xB4, 0xD9, 0x79, 0x33, 0x99,
+    0x1D, 0x49, 0xAD, 0xF0, 0x68, 0xA0, 0xCC, 0x44, 0x3E, 0xB7, 0x93, 0x70, 0xC6, 0xAE, 0x1C, 0x92,
+    0xF0, 0xA9, 0x4D, 0x18, 0xCD, 0x34, 0x54, 0xD1, 0x89, 0xA8, 0x8D, 0xE7, 0xC0, 0xD0, 0xED, 0x07,
+    0x49, 0x96, 0x22, 0x87, 0x13, 0x63, 0x6C, 0x68, 0xB6, 0x66, 0xEE, 0x3F, 0x53, 0x92, 0xB9, 0x23,
+    0x87, 0xBE, 0xBB, 0xBD, 0xE8, 0xAD, 0xC9, 0x62, 0xB4, 0xF8, 0xD6, 0x47, 0x8A, 0x0A, 0x63, 0x5B,
+    0xEC, 0x56, 0x84, 0x54, 0xA8, 0x63, 0xAB, 0xE0, 0x7C, 0x86, 0xAC, 0xBE, 0xC9, 0x91, 0x72, 0x26,
+    0x57, 0xD2, 0xC2, 0x02, 0x89, 0xAC, 0x51, 0x70, 0x92, 0x52, 0xEE, 0x25, 0x82, 0x50, 0xCA, 0x78,
+    0xCD, 0xE1, 0xD2, 0x5D, 0xD1, 0x41, 0x7F, 0x94, 0xCB, 0xB8, 0xE4, 0x56, 0x58, 0xA3, 0x4B, 0x63,
+    0x8B, 0x53, 0xAE, 0xD9, 0xEA, 0xDF, 0x9F, 0x8E, 0x3C, 0xA5, 0x20, 0x24, 0xFE, 0x1A, 0xA3, 0xD1,
+    0x73, 0x75, 0x3E, 0x01, 0xBB, 0xE3, 0xEB, 0x21, 0x24, 0x01, 0x00, 0x00,
+};
+
+const struct fsdata_file webfs_file0[] = { {
+    NULL,
+    webfs_data+0,
+    webfs_data+12,
+    262,
+    FS_FILE_FLAGS_HEADER_INCLUDED|FS_FILE_FLAGS_HEADER_PERSISTENT|FS_FILE_FLAGS_HEADER_HTTPVER_1_1,
+} };
+
+const struct fsdata_file webfs_file1[] = { {
+    webfs_file0,
+    webfs_data+276,
+    webfs_data+284,
+    402,
+    FS_FILE_FLAGS_HEADER_INCLUDED|FS_FILE_FLAGS_HEADER_PERSISTENT|FS_FILE_FLAGS_HEADER_HTTPVER_1_1,
+} };
+
+const struct fsdata_file webfs_file2[] = { {
+    webfs_file1,
+    webfs_data+688,
+    webfs_data+700,
+    511,
+    FS_FILE_FLAGS_HEADER_INCLUDED|FS_FILE_FLAGS_HEADER_PERSISTENT|FS_FILE_FLAGS_HEADER_HTTPVER_1_1,
+} };
+
+const struct fsdata_file webfs_file3[] = { {
+    webfs_file2,
+    webfs_data+1212,
+    webfs_data+1228,
+    352,
+    FS_FILE_FLAGS_HEADER_INCLUDED|FS_FILE_FLAGS_SSI,
+} };
+
+const struct fsdata_file webfs_file4[] = { {
+    webfs_file3,
+    webfs_data+1580,
+    webfs_data+1592,
+    292,
+    FS_FILE_FLAGS_HEADER_INCLUDED|FS_FILE_FLAGS_HEADER_PERSISTENT|FS_FILE_FLAGS_HEADER_HTTPVER_1_1,
+} };
+
+#define FS_ROOT webfs_file4
+#define FS_NUMFILES 5
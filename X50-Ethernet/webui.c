@@ -0,0 +1,129 @@
+/**
+ * @file    webui.c
+ *
+ * @note    SSI tags and CGI handlers of the web interface
+ *
+ * @note    LWIP_HTTPD_SSI_INCLUDE_TAG is 0 (lwipopts.h), so the tags are
+ *          replaced by their values and status.json is valid JSON. Tag names
+ *          have at most LWIP_HTTPD_MAX_TAG_NAME_LEN (8) characters
+ *
+ * @note    Files are generated by tools/mkwebfs (make webfs)
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "lwip/opt.h"
+#include "lwip/netif.h"
+#include "lwip/sys.h"
+#include "lwip/apps/httpd.h"
+#include "eth.h"
+#include "stnetif.h"
+#include "udpstream.h"
+#include "webui.h"
+
+/**
+ * @brief   SSI tags. The order is the one of the switch in webui_ssi
+ */
+static const char *webuitags[] = {
+    "uptime",
+    "link",
+    "ip",
+    "rxframes",
+    "rxbytes",
+    "txframes",
+    "txbytes",
+    "rxdrops",
+    "latavg",
+};
+#define WEBUI_NTAGS ((int)(sizeof(webuitags)/sizeof(webuitags[0])))
+
+/**
+ * @brief   webui_ssi
+ *
+ * @note    Writes the value of tag index into insert. Returns its length
+ */
+static u16_t
+webui_ssi(int index, char *insert, int len) {
+ETH_Statistics es;
+struct stnetif_stats ns;
+int n;
+
+    ETH_GetStatistics(&es);
+    stnetif_getstats(&ns);
+
+    switch(index) {
+    case 0:
+        n = snprintf(insert,len,"%lu",(unsigned long) (sys_now()/1000));
+        break;
+    case 1:
+        n = snprintf(insert,len,"%s",ETH_GetLinkState()?ETH_GetLinkInfoString():"down");
+        break;
+    case 2:
+        n = 0;
+        if( netif_default && ipaddr_ntoa_r(&netif_default->ip_addr,insert,len) )
+            n = strlen(insert);
+        break;
+    case 3:
+        n = snprintf(insert,len,"%lu",(unsigned long) es.rxframes);
+        break;
+    case 4:
+        n = snprintf(insert,len,"%lu",(unsigned long) es.rxbytes);
+        break;
+    case 5:
+        n = snprintf(insert,len,"%lu",(unsigned long) es.txframes);
+        break;
+    case 6:
+        n = snprintf(insert,len,"%lu",(unsigned long) es.txbytes);
+        break;
+    case 7:
+        n = snprintf(insert,len,"%lu",(unsigned long) (ETH_GetDroppedFrames()+ns.rxnopbuf));
+        break;
+    case 8:
+        n = snprintf(insert,len,"%lu",
+                (unsigned long) (ns.latencycount ? ns.latencytotal/ns.latencycount : 0));
+        break;
+    default:
+        n = 0;
+        break;
+    }
+    if( n >= len )
+        n = len-1;
+    return n < 0 ? 0 : n;
+}
+
+/**
+ * @brief   webui_reset
+ *
+ * @note    /reset.cgi: clears the counters, like the reset request of
+ *          netstats.c, and answers with the status
+ */
+static const char *
+webui_reset(int index, int nparams, char *params[], char *values[]) {
+
+    LWIP_UNUSED_ARG(index);
+    LWIP_UNUSED_ARG(nparams);
+    LWIP_UNUSED_ARG(params);
+    LWIP_UNUSED_ARG(values);
+    stnetif_resetstats();
+    UDPStream_ResetStats();
+    return "/status.json";
+}
+
+static const tCGI webuicgis[] = {
+    { "/reset.cgi",     webui_reset },
+};
+
+/**
+ * @brief   WebUI_Init
+ *
+ * @note    Starts the httpd. Must be called after the netif is added, in the
+ *          main loop or in the tcpip thread
+ */
+void
+WebUI_Init(void) {
+
+    http_set_ssi_handler(webui_ssi,webuitags,WEBUI_NTAGS);
+    http_set_cgi_handlers(webuicgis,sizeof(webuicgis)/sizeof(webuicgis[0]));
+    httpd_init();
+}
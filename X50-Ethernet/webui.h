@@ -0,0 +1,14 @@
+#ifndef WEBUI_H
+#define WEBUI_H
+/**
+ * @file    webui.h
+ *
+ * @note    Web interface: the lwIP httpd with the files of web/ (webfs_data.h)
+ *
+ * @note    /status.json is filled by the SSI handler with the driver counters
+ *          and is polled by the page. /reset.cgi clears the counters
+ */
+
+void WebUI_Init(void);
+
+#endif // WEBUI_H
@@ -0,0 +1,121 @@
+/**
+ * @file    bench.c
+ *
+ * @note    Micro benchmark harness using the DWT cycle counter
+ *
+ * @note    Every function is called once before the measurements, to fill the
+ *          caches, so the minimal value is repeatable. The mean shows the effect
+ *          of interrupts (SysTick, UART) during the runs.
+ *
+ * @note    The overhead of the call thru the function pointer and of reading the
+ *          counter is measured with an empty function and subtracted.
+ */
+
+#include <stdio.h>
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "bench.h"
+
+static uint32_t benchoverhead = 0;
+
+static void nothing(void *arg) { (void) arg; }
+
+/**
+ * @brief   Measure f
+ */
+static void
+measure(unsigned reps, BENCH_Function f, void *arg, BENCH_Result *res) {
+uint32_t start,d;
+uint64_t total = 0;
+unsigned i;
+
+    res->reps = reps;
+    res->min  = UINT32_MAX;
+    res->max  = 0;
+    f(arg);                                 // warm up
+    for(i=0;i<reps;i++) {
+        start = DWT->CYCCNT;
+        f(arg);
+        d = DWT->CYCCNT-start;
+        d = (d > benchoverhead) ? d-benchoverhead : 0;
+        if( d < res->min ) res->min = d;
+        if( d > res->max ) res->max = d;
+        total += d;
+    }
+    res->mean = reps ? total/reps : 0;
+}
+
+/**
+ * @brief   Enable cycle counter and measure overhead
+ */
+void
+Bench_Init(void) {
+BENCH_Result r;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;                  // Unlock access on Cortex-M7
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    benchoverhead = 0;
+    measure(16,nothing,0,&r);
+    benchoverhead = r.min;
+}
+
+/**
+ * @brief   Print header of result table
+ */
+void
+Bench_PrintHeader(void) {
+
+    printf("BENCH,suite,name,bytes,reps,min,mean,max,MBps\n");
+    printf("#core clock %lu Hz, overhead %lu cycles\n",
+            (unsigned long) SystemCoreClock,(unsigned long) benchoverhead);
+}
+
+/**
+ * @brief   Run and report a benchmark
+ *
+ * @note    bytes is the amount of data processed in one run (zero when it does
+ *          not make sense). It is used to calculate the throughput.
+ *
+ * @note    If res is not null, the result is stored there too.
+ */
+int
+Bench_Run(const char *suite, const char *name, unsigned bytes, unsigned reps,
+          BENCH_Function f, void *arg, BENCH_Result *res) {
+BENCH_Result r;
+
+    measure(reps,f,arg,&r);
+    Bench_Report(suite,name,bytes,&r);
+    if( res )
+        *res = r;
+    return 0;
+}
+
+/**
+ * @brief   Print a result line
+ *
+ * @note    Throughput (in MBytes/s = bytes per microsecond) uses the minimal value
+ */
+void
+Bench_Report(const char *suite, const char *name, unsigned bytes,
+             const BENCH_Result *res) {
+unsigned long mbps = 0;
+
+    if( bytes && res->min )
+        mbps = (unsigned long) (((uint64_t) bytes*(SystemCoreClock/1000000))/res->min);
+
+    printf("BENCH,%s,%s,%u,%lu,%lu,%lu,%lu,%lu\n",suite,name,bytes,
+            (unsigned long) res->reps,(unsigned long) res->min,
+            (unsigned long) res->mean,(unsigned long) res->max,mbps);
+}
+
+/**
+ * @brief   Report a benchmark that could not be run
+ */
+void
+Bench_Skip(const char *suite, const char *name, const char *reason) {
+
+    printf("#skipped %s,%s: %s\n",suite,name,reason);
+}
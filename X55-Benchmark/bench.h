@@ -0,0 +1,43 @@
+#ifndef BENCH_H
+#define BENCH_H
+/**
+ * @file    bench.h
+ *
+ * @note    Micro benchmark harness using the DWT cycle counter
+ *
+ * @note    Each result is printed as a line
+ *
+ *          BENCH,suite,name,bytes,reps,min,mean,max,Mbytes/s
+ *
+ *          with cycles for one run. Lines not starting with BENCH can be ignored
+ *          by the program that compares the results.
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Function to be measured
+ *
+ * @note    Called reps times with the same argument
+ */
+typedef void (*BENCH_Function)(void *arg);
+
+/**
+ * @brief   Result of a benchmark
+ */
+typedef struct {
+    uint32_t    reps;                       ///< number of measured runs
+    uint32_t    min;                        ///< minimal cycles of a run
+    uint32_t    max;                        ///< maximal cycles of a run
+    uint32_t    mean;                       ///< mean cycles of a run
+} BENCH_Result;
+
+void Bench_Init(void);
+void Bench_PrintHeader(void);
+int  Bench_Run(const char *suite, const char *name, unsigned bytes, unsigned reps,
+               BENCH_Function f, void *arg, BENCH_Result *res);
+void Bench_Report(const char *suite, const char *name, unsigned bytes,
+                  const BENCH_Result *res);
+void Bench_Skip(const char *suite, const char *name, const char *reason);
+
+#endif // BENCH_H
@@ -0,0 +1,361 @@
+/**
+ * @file    corebench.c
+ *
+ * @note    CoreMark style CPU kernels (see corebench.h)
+ *
+ * @note    The data is static and generated by CoreBench_Init from a seed, so
+ *          the compiler cannot precompute the results. Each kernel leaves the
+ *          data as it found it, so the runs are repeatable
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "corebench.h"
+
+/**
+ * @brief   Sizes
+ */
+///@{
+#define LISTSIZE        64
+#define MATSIZE         16
+#define STATESIZE       256
+///@}
+
+/**
+ * @brief   Linked list
+ */
+///@{
+typedef struct ListNode_s {
+    struct ListNode_s   *next;
+    int16_t             value;
+    int16_t             index;
+} ListNode;
+
+static ListNode         listnodes[LISTSIZE];
+static ListNode         *listhead = 0;
+///@}
+
+/**
+ * @brief   Matrices (C = A*B)
+ */
+///@{
+static int16_t          matA[MATSIZE*MATSIZE];
+static int16_t          matB[MATSIZE*MATSIZE];
+static int32_t          matC[MATSIZE*MATSIZE];
+///@}
+
+/**
+ * @brief   State machine input
+ */
+static char             statein[STATESIZE];
+
+/**
+ * @brief   Pseudo random generator (LCG)
+ */
+static uint32_t         rndstate = 1;
+
+static uint32_t
+rnd(void) {
+
+    rndstate = rndstate*1664525+1013904223;
+    return rndstate>>16;
+}
+
+/**
+ * @brief   CoreBench_CRC16
+ *
+ * @note    CRC-16 (polynomial 0xA001, reflected), bitwise
+ */
+uint16_t
+CoreBench_CRC16(uint16_t crc, uint16_t v) {
+int i;
+
+    crc ^= v;
+    for(i=0;i<16;i++) {
+        if( crc&1 )
+            crc = (crc>>1)^0xA001;
+        else
+            crc >>= 1;
+    }
+    return crc;
+}
+
+/**
+ * @brief   CoreBench_Init
+ *
+ * @note    Fills the list, the matrices and the state machine input
+ */
+void
+CoreBench_Init(uint32_t seed) {
+int i,n;
+unsigned k;
+static const char * const tokens[] = {
+    "5012", "1.234", "-874", "+122", "3.5e-3", ".0041", "-1.0E+7", "12e1",
+    "0x1F", "T0.3e-1F", "-.6", "1e", "123.45", "289+", "6", "---"
+};
+
+    rndstate = seed;
+
+    listhead = 0;
+    for(i=LISTSIZE-1;i>=0;i--) {
+        listnodes[i].value = (int16_t) (rnd()&0x7FFF);
+        listnodes[i].index = (int16_t) i;
+        listnodes[i].next  = listhead;
+        listhead = &listnodes[i];
+    }
+
+    for(i=0;i<MATSIZE*MATSIZE;i++) {
+        matA[i] = (int16_t) ((rnd()&0xFFF)-0x800);
+        matB[i] = (int16_t) ((rnd()&0xFFF)-0x800);
+    }
+
+    n = 0;
+    for(;;) {
+        const char *t = tokens[rnd()%(sizeof(tokens)/sizeof(tokens[0]))];
+        for(k=0;t[k];k++) {}
+        if( n+k+1 >= STATESIZE )
+            break;
+        for(k=0;t[k];k++)
+            statein[n++] = t[k];
+        statein[n++] = ',';
+    }
+    statein[n] = 0;
+}
+
+/**
+ * @brief   List comparison functions
+ */
+///@{
+static int
+cmpvalue(const ListNode *a, const ListNode *b) {
+
+    return a->value-b->value;
+}
+
+static int
+cmpindex(const ListNode *a, const ListNode *b) {
+
+    return a->index-b->index;
+}
+///@}
+
+/**
+ * @brief   listsort
+ *
+ * @note    Merge sort of a non empty list, without recursion
+ */
+static ListNode *
+listsort(ListNode *list, int (*cmp)(const ListNode *, const ListNode *)) {
+ListNode *p,*q,*e,*tail;
+int insize = 1, nmerges, psize, qsize, i;
+
+    for(;;) {
+        p = list;
+        list = 0;
+        tail = 0;
+        nmerges = 0;
+        while( p ) {
+            nmerges++;
+            q = p;
+            psize = 0;
+            for(i=0;i<insize && q;i++) {
+                psize++;
+                q = q->next;
+            }
+            qsize = insize;
+            while( psize > 0 || (qsize > 0 && q) ) {
+                if( psize == 0 ) {
+                    e = q; q = q->next; qsize--;
+                } else if( qsize == 0 || !q ) {
+                    e = p; p = p->next; psize--;
+                } else if( cmp(p,q) <= 0 ) {
+                    e = p; p = p->next; psize--;
+                } else {
+                    e = q; q = q->next; qsize--;
+                }
+                if( tail )
+                    tail->next = e;
+                else
+                    list = e;
+                tail = e;
+            }
+            p = q;
+        }
+        tail->next = 0;
+        if( nmerges <= 1 )
+            return list;
+        insize *= 2;
+    }
+}
+
+static ListNode *
+listreverse(ListNode *list) {
+ListNode *prev = 0, *next;
+
+    while( list ) {
+        next = list->next;
+        list->next = prev;
+        prev = list;
+        list = next;
+    }
+    return prev;
+}
+
+/**
+ * @brief   CoreBench_List
+ *
+ * @note    Finds some values, reverses the list, sorts it by value and sorts it
+ *          back by index
+ */
+uint16_t
+CoreBench_List(void) {
+ListNode *p;
+uint16_t crc = 0;
+int i,steps;
+
+    for(i=0;i<LISTSIZE;i+=4) {
+        int16_t v = listnodes[(i*7)%LISTSIZE].value;
+        steps = 0;
+        for(p=listhead;p&&p->value!=v;p=p->next)
+            steps++;
+        crc = CoreBench_CRC16(crc,(uint16_t) steps);
+    }
+
+    listhead = listreverse(listhead);
+    crc = CoreBench_CRC16(crc,(uint16_t) listhead->index);
+
+    listhead = listsort(listhead,cmpvalue);
+    for(p=listhead,i=0;p;p=p->next,i++) {
+        if( (i&7) == 0 )
+            crc = CoreBench_CRC16(crc,(uint16_t) p->value);
+    }
+
+    listhead = listsort(listhead,cmpindex);
+    return crc;
+}
+
+/**
+ * @brief   CoreBench_Matrix
+ *
+ * @note    C = A*B and a sum of bit fields of C
+ */
+uint16_t
+CoreBench_Matrix(void) {
+int i,j,k;
+int32_t s;
+uint32_t sum = 0;
+
+    for(i=0;i<MATSIZE;i++) {
+        for(j=0;j<MATSIZE;j++) {
+            s = 0;
+            for(k=0;k<MATSIZE;k++)
+                s += (int32_t) matA[i*MATSIZE+k]*matB[k*MATSIZE+j];
+            matC[i*MATSIZE+j] = s;
+        }
+    }
+    for(i=0;i<MATSIZE*MATSIZE;i++) {
+        if( matC[i] > 0 )
+            sum += ((uint32_t) matC[i]>>4)&0xFF;
+        else
+            sum -= ((uint32_t) -matC[i]>>2)&0x3F;
+    }
+    return CoreBench_CRC16(CoreBench_CRC16(0,(uint16_t) sum),(uint16_t) (sum>>16));
+}
+
+/**
+ * @brief   State machine states
+ */
+enum { ST_START, ST_INT, ST_FLOAT, ST_EXP, ST_SCI, ST_SIGN, ST_INVALID, ST_N };
+
+/**
+ * @brief   CoreBench_State
+ *
+ * @note    Classifies the comma separated tokens as integer, float, scientific
+ *          notation or invalid and counts them
+ */
+uint16_t
+CoreBench_State(void) {
+unsigned counts[ST_N] = { 0 };
+const char *p;
+int state = ST_START;
+uint16_t crc = 0;
+char c;
+int i;
+
+    for(p=statein;;p++) {
+        c = *p;
+        if( c == ',' || c == 0 ) {
+            counts[state]++;
+            state = ST_START;
+            if( c == 0 )
+                break;
+            continue;
+        }
+        switch(state) {
+        case ST_START:
+            if( c >= '0' && c <= '9' )
+                state = ST_INT;
+            else if( c == '+' || c == '-' )
+                state = ST_SIGN;
+            else if( c == '.' )
+                state = ST_FLOAT;
+            else
+                state = ST_INVALID;
+            break;
+        case ST_SIGN:
+            if( c >= '0' && c <= '9' )
+                state = ST_INT;
+            else if( c == '.' )
+                state = ST_FLOAT;
+            else
+                state = ST_INVALID;
+            break;
+        case ST_INT:
+            if( c == '.' )
+                state = ST_FLOAT;
+            else if( c == 'e' || c == 'E' )
+                state = ST_EXP;
+            else if( c < '0' || c > '9' )
+                state = ST_INVALID;
+            break;
+        case ST_FLOAT:
+            if( c == 'e' || c == 'E' )
+                state = ST_EXP;
+            else if( c < '0' || c > '9' )
+                state = ST_INVALID;
+            break;
+        case ST_EXP:
+            if( (c >= '0' && c <= '9') || c == '+' || c == '-' )
+                state = ST_SCI;
+            else
+                state = ST_INVALID;
+            break;
+        case ST_SCI:
+            if( c < '0' || c > '9' )
+                state = ST_INVALID;
+            break;
+        default:
+            break;
+        }
+    }
+    for(i=0;i<ST_N;i++)
+        crc = CoreBench_CRC16(crc,(uint16_t) counts[i]);
+    return crc;
+}
+
+/**
+ * @brief   CoreBench_All
+ *
+ * @note    All kernels, as one iteration of CoreMark
+ */
+uint16_t
+CoreBench_All(void) {
+uint16_t crc;
+
+    crc = CoreBench_List();
+    crc = CoreBench_CRC16(crc,CoreBench_Matrix());
+    crc = CoreBench_CRC16(crc,CoreBench_State());
+    return crc;
+}
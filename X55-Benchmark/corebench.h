@@ -0,0 +1,31 @@
+#ifndef COREBENCH_H
+#define COREBENCH_H
+/**
+ * @file    corebench.h
+ *
+ * @note    CoreMark style CPU kernels: linked list (find, reverse and merge
+ *          sort), 16x16 matrix multiply and a state machine that classifies
+ *          number tokens
+ *
+ * @note    They are not CoreMark and the results are not CoreMark scores. They
+ *          have the same kind of code (pointer chasing, multiply accumulate and
+ *          branches) and are used to compare code placements (ITCM or AXIM) and
+ *          flash accelerators
+ *
+ * @note    Each kernel returns a CRC of its results. It must be the same for
+ *          all configurations
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+void     CoreBench_Init(uint32_t seed);
+uint16_t CoreBench_List(void);
+uint16_t CoreBench_Matrix(void);
+uint16_t CoreBench_State(void);
+uint16_t CoreBench_All(void);
+uint16_t CoreBench_CRC16(uint16_t crc, uint16_t v);
+
+#endif // COREBENCH_H
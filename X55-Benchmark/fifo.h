@@ -0,0 +1,52 @@
+#ifndef FIFO_H
+#define FIFO_H
+/**
+ *  @file   fifo.h
+ */
+
+
+/**
+ *  @brief  Data structure to store info about a fifo, including its data
+ *
+ * @note    Uses x[0] hack. This structure is a header
+ * @note    Single producer/single consumer ring. Only the producer changes head and
+ *          only the consumer changes tail. So one side can run in an interrupt routine
+ *          without disabling interrupts
+ * @note    head and tail are free running counters. The position in data is
+ *          obtained masking them with capacity-1, so capacity must be a power of 2
+ */
+
+typedef struct fifo_s {
+    volatile unsigned   head;   // counter of chars inserted (changed by producer)
+    volatile unsigned   tail;   // counter of chars removed (changed by consumer)
+    unsigned            mask;   // capacity-1
+    int                 capacity;   // number of chars in data (power of 2)
+    char                data[];     // flexible array
+} FIFO_t;
+
+typedef FIFO_t *FIFO;
+
+#define DECLARE_FIFO_AREA(AREANAME,SIZE) unsigned AREANAME[ \
+                        (sizeof(struct fifo_s)+(SIZE)+sizeof(unsigned)-1)/sizeof(unsigned) \
+                        ]
+
+FIFO    fifo_init(void *area,int size);
+void    fifo_deinit(FIFO f);
+int     fifo_insert(FIFO f, char x);
+int     fifo_remove(FIFO f);
+void    fifo_clear(FIFO f);
+
+int     fifo_write(FIFO f, const char *buf, int n);
+int     fifo_read(FIFO f, char *buf, int n);
+
+int     fifo_readspan(FIFO f, char **p);
+void    fifo_skip(FIFO f, int n);
+int     fifo_writespan(FIFO f, char **p);
+void    fifo_commit(FIFO f, int n);
+
+#define fifo_capacity(F) ((F)->capacity)
+#define fifo_size(F) ((int) ((F)->head-(F)->tail))
+#define fifo_empty(F) ((F)->head==(F)->tail)
+#define fifo_full(F) (fifo_size(F)==fifo_capacity(F))
+
+#endif
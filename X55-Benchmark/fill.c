@@ -0,0 +1,174 @@
+/**
+ * @file    fill.c
+ *
+ * @note    Memory fill routines used by LCD_FillFrameBuffer (lcd.c)
+ *
+ * @note    Copied from lcd.c, where they are static, so they can be compared
+ *          with the DMA2D fill. lcd.c now uses the kernels of pixops.c for the
+ *          aligned part, these are the plain C loops
+ */
+
+#include <stdint.h>
+#include "fill.h"
+
+/**
+ * @brief   fill1
+ *
+ * @note    fill a memory area with a 1 byte value
+ *
+ * @note    n = size in bytes!!!
+ *
+ */
+void fill1( void *area, int n, unsigned c) {
+uint8_t uc;
+uint8_t *p;
+uint32_t uv;
+uint32_t *q;
+
+    p = (uint8_t *) area;
+    uc = c&0xFF;
+    // align to a word address (last two bits are zero)
+    while( (n>0) && ((((uintptr_t)p)&0x3)!=0) ) {
+        *p++ = uc;
+        n--;
+    }
+    // after that, can fill 4 bytes at one
+    uv = (uc<<24)|(uc<<16)|(uc<<8)|uc;
+    q = (uint32_t *) p;
+    while( n > 3 ) {
+        *q++ = uv;
+        n -= 4;
+    }
+    p = (uint8_t *) q;
+    while( n>0 ) {
+        *p++ = uc;
+        n--;
+    }
+
+}
+
+/**
+ * @brief   fill2
+ *
+ * @note    Fill a memory area with a 16-bit value
+ *
+ * @note    n = size in bytes!!!
+ *
+ */
+void fill2( void *area, int n, unsigned c) {
+uint8_t *p;
+uint16_t uc;
+uint32_t uv;
+uint32_t *q;
+
+    p = (uint8_t *) area;
+    uc = c&0xFFFF;
+    // align to a even address
+    while( ((uintptr_t) p)&3 ) {
+        *p++ = uc;
+        n--;
+        uc = (uc>>8)|(uc<<8);
+    }
+    // after that, can fill 4 bytes at one
+    uv = (uc<<16)|uc;
+    q = (uint32_t *) p;
+    while( n > 3 ) {
+        *q++ = uv;
+        n -= 4;
+    }
+    // fill the remaining bytes
+    p = (uint8_t *) q;
+    while( n > 0 ) {
+        *p++ = uc;
+        n--;
+        uc = (uc>>8)|(uc<<8);
+    }
+}
+
+
+/**
+ * @brief   fill3
+ *
+ * @note    Fill the frame buffer with a 3-byte value
+ *
+ * @note    n = size in bytes!!!
+ *
+ * @note    Memory organization
+ *            word  | Pixel
+ *         ---------|-----------------
+ *            +0    | B1 R0 G0 B0
+ *            +1    | G2 B2 R1 G1
+ *            +2    | R3 G3 B3 R2
+ */
+void fill3( void *area, int n, unsigned c) {
+uint32_t w1,w2,w3;
+uint8_t *p;
+uint32_t uc;
+uint32_t *q;
+
+    p = (uint8_t *) area;
+    uc = c&0xFFFFFF;
+    // align to a even address
+    while( ((uintptr_t) p)&3 ) {
+        *p++ = uc;
+        n--;
+        uc = ((uc>>8)|(uc<<16))&0xFFFFFF;
+    }
+    // after that, can fill 4 bytes at one
+    q = (uint32_t *) p;
+    // uc = 0ABC
+    w1 = (uc<<8)|(uc>>16);      // ABCA
+    w2 = (uc<<16)|(uc>>8);      // BCAB
+    w3 = (uc<<24)|uc;           // CABC
+    while( n > 11 ) {
+        *q++ = w3;
+        *q++ = w2;
+        *q++ = w1;
+        n -= 12;
+    }
+    // fill the remaining bytes
+    p = (uint8_t *) q;
+    while( n > 0 ) {
+        *p++ = uc;
+        n--;
+        uc = ((uc>>8)|(uc<<16))&0xFFFFFF;
+    }
+}
+
+/*
+ * @brief   fill4
+ *
+ * @note    Fill the frame buffer with a 4-byte value
+ *
+ * @note    n = size in bytes!!!
+ *
+ */
+
+void fill4( void *area, int n, unsigned c) {
+uint8_t *p;
+uint32_t uc;
+uint32_t *q;
+
+    p = (uint8_t *) area;
+    uc = c;
+    // align to a even address
+    while( ((uintptr_t) p)&3 ) {
+        *p++ = uc;
+        n--;
+        uc = (uc>>8)|(uc<<24);
+    }
+    // after that, can fill 4 bytes at one
+    q = (uint32_t *) p;
+    while( n > 3 ) {
+        *q++ = uc;
+        n -= 4;
+    }
+    // fill the remaining bytes
+    p = (uint8_t *) q;
+    while( n > 0 ) {
+        *p++ = uc;
+        n--;
+        uc = (uc>>8)|(uc<<24);
+    }
+
+}
@@ -0,0 +1,16 @@
+#ifndef FILL_H
+#define FILL_H
+/**
+ * @file    fill.h
+ *
+ * @note    Fill a memory area with a 1, 2, 3 or 4 byte value
+ *
+ * @note    n is the size in bytes
+ */
+
+void fill1(void *area, int n, unsigned c);
+void fill2(void *area, int n, unsigned c);
+void fill3(void *area, int n, unsigned c);
+void fill4(void *area, int n, unsigned c);
+
+#endif // FILL_H
@@ -0,0 +1,867 @@
+/**
+ * @file     main.c
+ * @brief    On target micro benchmarks
+ * @version  V1.0
+ * @date     14/10/2026
+ *
+ * @note     Results are printed as a table (see bench.h) thru the UART or,
+ *           when STDIO_USE_SWO is defined, thru the SWO pin
+ *
+ * @note     Suites
+ *              mem     memcpy and memset in DTCM, SRAM1 and SDRAM
+ *              memfast memcpy, memset and memmove of memfast.c versus newlib
+ *                      for 8 bytes to 64 KB in DTCM, SRAM1 and SDRAM
+ *              fill    fill1..fill4 versus DMA2D fill of a 480x272 frame in SDRAM
+ *              pixops  unrolled and DSP kernels of pixops.c versus plain C loops
+ *              copy2d  DMA2D_Copy2D versus C loops: matrix blocks and channels
+ *              buddy   alloc and free of a buddy pool in SDRAM
+ *              fifo    fifo_write/fifo_read and fifo_insert/fifo_remove
+ *              i2c     register read of the touch controller (FT5336 on I2C3)
+ *              core    CoreMark style kernels of corebench.c with the flash
+ *                      accelerators on and off
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "led.h"
+#include "sdram.h"
+#include "buddy.h"
+#include "fifo.h"
+#include "fill.h"
+#include "pixops.h"
+#include "memfast.h"
+#include "dma2d.h"
+#include "i2c-master.h"
+#include "bench.h"
+#include "corebench.h"
+#ifdef STDIO_USE_SWO
+#include "swo.h"
+#endif
+#ifdef PCSAMPLE_ENABLE
+#include "pcsample.h"
+#endif
+
+/**
+ * @brief   Systick routine
+ *
+ * @note    It is called every 1ms
+ */
+static volatile uint32_t tick_ms = 0;
+
+#define INTERVAL 500
+void SysTick_Handler(void) {
+
+    if( tick_ms >= INTERVAL ) {
+       LED_Toggle();
+       tick_ms = 0;
+    } else {
+       tick_ms++;
+    }
+}
+
+/**
+ * @brief   Memory areas
+ *
+ * @note    .data and .bss start at DTCM (0x20000000). SRAM1 area is above them
+ *          and below the stack. The first 2 MB of SDRAM are used for memory tests
+ *          and frame fills, the next 4 MB for the buddy pool and the last 2 MB
+ *          for the histogram of pcsample.c.
+ */
+///@{
+#define MEMSIZE             (8*1024)
+static char dtcmarea[2*MEMSIZE] __attribute__((aligned(32)));
+#define SRAM1AREA           ((char *) 0x20030000)
+#define SRAM1SIZE           (0x1C000)       // up to the end of SRAM1
+#define SDRAMAREA           ((char *) SDRAM_ADDRESS)
+#define FRAMEAREA           ((char *) SDRAM_ADDRESS+0x100000)
+#define POOLAREA            ((char *) SDRAM_ADDRESS+0x200000)
+#define POOLSIZE            (0x400000)
+#define POOLMINSIZE         (64)
+#define PCSAMPLEAREA        ((char *) SDRAM_ADDRESS+0x600000)
+#define PCSAMPLESIZE        (0x200000)
+
+#define FRAMEWIDTH          480
+#define FRAMEHEIGHT         272
+#define FRAMEPIXELS         (FRAMEWIDTH*FRAMEHEIGHT)
+#define FRAMEAREA2          (FRAMEAREA+FRAMEPIXELS*4)
+///@}
+
+/**
+ * @brief   Number of runs for each benchmark
+ */
+#define REPS                100
+
+/**
+ * @brief   Memory benchmarks
+ */
+///@{
+typedef struct {
+    char        *dst;
+    const char  *src;
+    unsigned    n;
+} MemArgs;
+
+static void bench_memcpy(void *arg) {
+MemArgs *a = arg;
+
+    memcpy(a->dst,a->src,a->n);
+}
+
+static void bench_memset(void *arg) {
+MemArgs *a = arg;
+
+    memset(a->dst,0x55,a->n);
+}
+
+static void
+suite_mem(void) {
+static const struct {
+    const char  *name;
+    char        *area;
+} regions[] = {
+    { "dtcm",   dtcmarea    },
+    { "sram1",  SRAM1AREA   },
+    { "sdram",  SDRAMAREA   },
+};
+char name[32];
+MemArgs a;
+unsigned i,j;
+
+    if( ((uintptr_t) dtcmarea+sizeof(dtcmarea)) > 0x20010000 )
+        printf("#dtcm area is not in DTCM (%p)\n",(void *) dtcmarea);
+
+    for(i=0;i<sizeof(regions)/sizeof(regions[0]);i++) {
+        for(j=0;j<sizeof(regions)/sizeof(regions[0]);j++) {
+            a.src = regions[i].area;
+            a.dst = regions[j].area+MEMSIZE;
+            a.n   = MEMSIZE;
+            snprintf(name,sizeof(name),"memcpy_%s_%s",regions[i].name,regions[j].name);
+            Bench_Run("mem",name,MEMSIZE,REPS,bench_memcpy,&a,0);
+        }
+    }
+    for(i=0;i<sizeof(regions)/sizeof(regions[0]);i++) {
+        a.src = 0;
+        a.dst = regions[i].area;
+        a.n   = MEMSIZE;
+        snprintf(name,sizeof(name),"memset_%s",regions[i].name);
+        Bench_Run("mem",name,MEMSIZE,REPS,bench_memset,&a,0);
+    }
+}
+///@}
+
+/**
+ * @brief   memfast.c versus newlib
+ *
+ * @note    In each region, the source is at the beginning and the destination
+ *          in the middle. copyu has the source one byte after, so source and
+ *          destination are not aligned alike. move copies to 4 bytes after
+ *          the source (overlap, backward copy). Sizes that do not fit in the
+ *          half of a region are skipped (64 KB only fits in SDRAM)
+ *
+ * @note    With USE_MEMFAST (Makefile), memcpy is memfast.c and the newlib
+ *          functions are called as __real_memcpy etc.
+ */
+///@{
+#ifdef MEMFAST_WRAP
+#define NEWLIB_MEMCPY       __real_memcpy
+#define NEWLIB_MEMSET       __real_memset
+#define NEWLIB_MEMMOVE      __real_memmove
+#else
+#define NEWLIB_MEMCPY       memcpy
+#define NEWLIB_MEMSET       memset
+#define NEWLIB_MEMMOVE      memmove
+#endif
+
+static void bench_newlib_copy(void *arg) {
+MemArgs *a = arg;
+
+    NEWLIB_MEMCPY(a->dst,a->src,a->n);
+}
+
+static void bench_fast_copy(void *arg) {
+MemArgs *a = arg;
+
+    MemFast_Copy(a->dst,a->src,a->n);
+}
+
+static void bench_newlib_set(void *arg) {
+MemArgs *a = arg;
+
+    NEWLIB_MEMSET(a->dst,0x55,a->n);
+}
+
+static void bench_fast_set(void *arg) {
+MemArgs *a = arg;
+
+    MemFast_Set(a->dst,0x55,a->n);
+}
+
+static void bench_newlib_move(void *arg) {
+MemArgs *a = arg;
+
+    NEWLIB_MEMMOVE(a->dst,a->src,a->n);
+}
+
+static void bench_fast_move(void *arg) {
+MemArgs *a = arg;
+
+    MemFast_Move(a->dst,a->src,a->n);
+}
+
+static void
+suite_memfast(void) {
+static const struct {
+    const char  *name;
+    char        *area;
+    unsigned    size;
+} regions[] = {
+    { "dtcm",   dtcmarea,   sizeof(dtcmarea)    },
+    { "sram1",  SRAM1AREA,  SRAM1SIZE           },
+    { "sdram",  SDRAMAREA,  0x100000            },
+};
+static const unsigned sizes[] = {
+    8, 16, 64, 256, 1024, 4096, 16384, 65536
+};
+static const struct {
+    const char      *name;
+    BENCH_Function  newlib;
+    BENCH_Function  fast;
+    unsigned        srcoffset;
+    int             dstoffset;              // -1: middle of the region
+} ops[] = {
+    { "copy",   bench_newlib_copy,  bench_fast_copy,    0,  -1 },
+    { "copyu",  bench_newlib_copy,  bench_fast_copy,    1,  -1 },
+    { "set",    bench_newlib_set,   bench_fast_set,     0,  -1 },
+    { "move",   bench_newlib_move,  bench_fast_move,    0,  4  },
+};
+char name[48];
+MemArgs a;
+unsigned i,j,k;
+
+    for(i=0;i<sizeof(regions)/sizeof(regions[0]);i++) {
+        for(j=0;j<sizeof(sizes)/sizeof(sizes[0]);j++) {
+            for(k=0;k<sizeof(ops)/sizeof(ops[0]);k++) {
+                a.src = regions[i].area+ops[k].srcoffset;
+                a.dst = (ops[k].dstoffset < 0) ? regions[i].area+regions[i].size/2
+                                               : regions[i].area+ops[k].dstoffset;
+                a.n   = sizes[j];
+                snprintf(name,sizeof(name),"%s_newlib_%s_%u",ops[k].name,
+                         regions[i].name,sizes[j]);
+                if( sizes[j]+ops[k].srcoffset > regions[i].size/2 ) {
+                    Bench_Skip("memfast",name,"area too small");
+                    continue;
+                }
+                Bench_Run("memfast",name,sizes[j],REPS,ops[k].newlib,&a,0);
+                snprintf(name,sizeof(name),"%s_fast_%s_%u",ops[k].name,
+                         regions[i].name,sizes[j]);
+                Bench_Run("memfast",name,sizes[j],REPS,ops[k].fast,&a,0);
+            }
+        }
+    }
+}
+///@}
+
+/**
+ * @brief   Fill benchmarks
+ *
+ * @note    DMA2D writes thru the bus matrix. The frame in SDRAM is not read by
+ *          the CPU, so there is no need to invalidate the cache.
+ */
+///@{
+typedef struct {
+    void        (*fill)(void *area, int n, unsigned c);
+    DMA2DRegion region;
+    unsigned    n;
+} FillArgs;
+
+static void bench_fill(void *arg) {
+FillArgs *a = arg;
+
+    a->fill(FRAMEAREA,a->n,0x12345678);
+}
+
+static void bench_dma2d(void *arg) {
+FillArgs *a = arg;
+
+    DMA2D_FillRegion(&a->region,0x12345678);
+    while( !DMA2D_IsReady() ) {}
+}
+
+static void
+suite_fill(void) {
+static const struct {
+    const char  *name;
+    void        (*fill)(void *area, int n, unsigned c);
+    int         pixelformat;                // -1: no DMA2D output format
+    unsigned    pixelsize;
+} fills[] = {
+    { "1",  fill1,  -1,             1 },
+    { "2",  fill2,  DMA2D_RGB565,   2 },
+    { "3",  fill3,  DMA2D_RGB888,   3 },
+    { "4",  fill4,  DMA2D_ARGB8888, 4 },
+};
+char name[32];
+FillArgs a;
+unsigned i,n;
+
+    DMA2D_Init();
+    for(i=0;i<sizeof(fills)/sizeof(fills[0]);i++) {
+        n = FRAMEWIDTH*FRAMEHEIGHT*fills[i].pixelsize;
+        a.fill = fills[i].fill;
+        a.n    = n;
+        snprintf(name,sizeof(name),"fill%s",fills[i].name);
+        Bench_Run("fill",name,n,REPS/10,bench_fill,&a,0);
+        snprintf(name,sizeof(name),"dma2d%s",fills[i].name);
+        if( fills[i].pixelformat < 0 ) {
+            Bench_Skip("fill",name,"no 8 bit output format");
+            continue;
+        }
+        a.region.address     = (unsigned long) FRAMEAREA;
+        a.region.x           = 0;
+        a.region.y           = 0;
+        a.region.w           = FRAMEWIDTH;
+        a.region.h           = FRAMEHEIGHT;
+        a.region.pixelformat = fills[i].pixelformat;
+        a.region.linesize    = FRAMEWIDTH*fills[i].pixelsize;
+        Bench_Run("fill",name,n,REPS/10,bench_dma2d,&a,0);
+    }
+}
+///@}
+
+/**
+ * @brief   Pixel kernel benchmarks
+ *
+ * @note    Each kernel of pixops.c is compared with the plain C loop doing the
+ *          same. Fills write a 480x272 frame, copies and blends read a second
+ *          frame (FRAMEAREA2). All in SDRAM.
+ */
+///@{
+typedef struct {
+    void        *dst;
+    const void  *src;
+    unsigned    n;                          // pixels
+    unsigned    ps;                         // pixel size
+} PixArgs;
+
+static void bench_pixfill2(void *arg) {
+PixArgs *a = arg;
+
+    PixOps_FillWords(a->dst,0x12341234,a->n/2);
+}
+
+static void bench_pixfill3(void *arg) {
+PixArgs *a = arg;
+
+    PixOps_Fill3Words(a->dst,0x56123456,0x34561234,0x12345612,a->n/4);
+}
+
+static void bench_pixfill4(void *arg) {
+PixArgs *a = arg;
+
+    PixOps_FillWords(a->dst,0x12345678,a->n);
+}
+
+static void bench_cfill(void *arg) {
+PixArgs *a = arg;
+
+    switch(a->ps) {
+    case 2: fill2(a->dst,a->n*2,0x1234);        break;
+    case 3: fill3(a->dst,a->n*3,0x123456);      break;
+    case 4: fill4(a->dst,a->n*4,0x12345678);    break;
+    }
+}
+
+static void bench_ccopy(void *arg) {
+PixArgs *a = arg;
+
+    memcpy(a->dst,a->src,a->n*a->ps);
+}
+
+static void bench_pixcopy(void *arg) {
+PixArgs *a = arg;
+
+    PixOps_Copy(a->dst,a->src,a->n*a->ps);
+}
+
+static void bench_cblend50(void *arg) {
+PixArgs *a = arg;
+uint16_t *p16 = a->dst;
+const uint16_t *q16 = a->src;
+uint8_t *p8 = a->dst;
+const uint8_t *q8 = a->src;
+unsigned i,s,d;
+
+    if( a->ps == 2 ) {
+        for(i=0;i<a->n;i++) {
+            s = q16[i];
+            d = p16[i];
+            p16[i] = (((s>>11)+(d>>11))>>1)<<11
+                    |((((s>>5)&0x3F)+((d>>5)&0x3F))>>1)<<5
+                    |(((s&0x1F)+(d&0x1F))>>1);
+        }
+    } else {
+        for(i=0;i<a->n*a->ps;i++)
+            p8[i] = (p8[i]+q8[i])>>1;
+    }
+}
+
+static void bench_pixblend50(void *arg) {
+PixArgs *a = arg;
+
+    if( a->ps == 2 )
+        PixOps_Blend50RGB565(a->dst,a->src,a->n);
+    else
+        PixOps_Blend50Bytes(a->dst,a->src,a->n*a->ps);
+}
+
+#define ALPHA   (100)
+static void bench_cblendalpha(void *arg) {
+PixArgs *a = arg;
+uint16_t *p16 = a->dst;
+const uint16_t *q16 = a->src;
+uint8_t *p8 = a->dst;
+const uint8_t *q8 = a->src;
+unsigned i,s,d;
+
+    if( a->ps == 2 ) {
+        for(i=0;i<a->n;i++) {
+            s = q16[i];
+            d = p16[i];
+            p16[i] = (((s>>11)*ALPHA+(d>>11)*(255-ALPHA))/255)<<11
+                    |((((s>>5)&0x3F)*ALPHA+((d>>5)&0x3F)*(255-ALPHA))/255)<<5
+                    |(((s&0x1F)*ALPHA+(d&0x1F)*(255-ALPHA))/255);
+        }
+    } else {
+        for(i=0;i<a->n*a->ps;i++)
+            p8[i] = (q8[i]*ALPHA+p8[i]*(255-ALPHA))/255;
+    }
+}
+
+static void bench_pixblendalpha(void *arg) {
+PixArgs *a = arg;
+
+    if( a->ps == 2 )
+        PixOps_BlendAlphaRGB565(a->dst,a->src,a->n,ALPHA);
+    else
+        PixOps_BlendAlphaBytes(a->dst,a->src,a->n*a->ps,ALPHA);
+}
+
+static void bench_cblendargb(void *arg) {
+PixArgs *a = arg;
+uint8_t *p = a->dst;
+const uint8_t *q = a->src;
+unsigned i,c,sa;
+
+    for(i=0;i<a->n;i++,p+=4,q+=4) {
+        sa = q[3];
+        for(c=0;c<3;c++)
+            p[c] = (q[c]*sa+p[c]*(255-sa))/255;
+        p[3] = sa+p[3]*(255-sa)/255;
+    }
+}
+
+static void bench_pixblendargb(void *arg) {
+PixArgs *a = arg;
+
+    PixOps_BlendARGB8888(a->dst,a->src,a->n);
+}
+
+static void
+suite_pixops(void) {
+static const struct {
+    const char      *name;
+    unsigned        ps;
+    BENCH_Function  c;
+    BENCH_Function  pixops;
+} kernels[] = {
+    { "fill_rgb565",        2,  bench_cfill,        bench_pixfill2      },
+    { "fill_rgb888",        3,  bench_cfill,        bench_pixfill3      },
+    { "fill_argb8888",      4,  bench_cfill,        bench_pixfill4      },
+    { "copy_rgb565",        2,  bench_ccopy,        bench_pixcopy       },
+    { "copy_argb8888",      4,  bench_ccopy,        bench_pixcopy       },
+    { "blend50_rgb565",     2,  bench_cblend50,     bench_pixblend50    },
+    { "blend50_rgb888",     3,  bench_cblend50,     bench_pixblend50    },
+    { "blend50_argb8888",   4,  bench_cblend50,     bench_pixblend50    },
+    { "alpha_rgb565",       2,  bench_cblendalpha,  bench_pixblendalpha },
+    { "alpha_rgb888",       3,  bench_cblendalpha,  bench_pixblendalpha },
+    { "alpha_argb8888",     4,  bench_cblendalpha,  bench_pixblendalpha },
+    { "srcover_argb8888",   4,  bench_cblendargb,   bench_pixblendargb  },
+};
+char name[40];
+PixArgs a;
+unsigned i,n;
+uint32_t *p;
+
+    // source frame with varying colors and alpha values
+    p = (uint32_t *) FRAMEAREA2;
+    for(i=0;i<FRAMEPIXELS;i++)
+        p[i] = i*0x01030507;
+
+    a.dst = FRAMEAREA;
+    a.src = FRAMEAREA2;
+    a.n   = FRAMEPIXELS;
+    for(i=0;i<sizeof(kernels)/sizeof(kernels[0]);i++) {
+        a.ps = kernels[i].ps;
+        n = FRAMEPIXELS*a.ps;
+        snprintf(name,sizeof(name),"c_%s",kernels[i].name);
+        Bench_Run("pixops",name,n,REPS/10,kernels[i].c,&a,0);
+        snprintf(name,sizeof(name),"pixops_%s",kernels[i].name);
+        Bench_Run("pixops",name,n,REPS/10,kernels[i].pixops,&a,0);
+    }
+}
+///@}
+
+/**
+ * @brief   2D copy benchmarks
+ *
+ * @note    DMA2D_Copy2D used on data that are not pixels, compared with the C
+ *          loops doing the same. A 128x128 block is extracted from a 480x272
+ *          matrix (FRAMEAREA2) of 8, 16 and 32 bit elements, and one channel of
+ *          interleaved 16 bit samples (2 and 8 channels) is gathered into a
+ *          contiguous buffer. All in SDRAM, that is not cached.
+ */
+///@{
+#define BLOCKSIZE           128
+#define SAMPLES             8192
+
+typedef struct {
+    void        *dst;
+    const void  *src;
+    unsigned    w;                          // elements per line
+    unsigned    h;                          // lines
+    unsigned    srcstride;                  // elements
+    unsigned    es;                         // element size
+} Copy2DArgs;
+
+static void bench_cblock(void *arg) {
+Copy2DArgs *a = arg;
+uint8_t *p = a->dst;
+const uint8_t *q = a->src;
+unsigned i;
+
+    for(i=0;i<a->h;i++) {
+        memcpy(p,q,a->w*a->es);
+        p += a->w*a->es;
+        q += a->srcstride*a->es;
+    }
+}
+
+static void bench_cchannel(void *arg) {
+Copy2DArgs *a = arg;
+uint16_t *p = a->dst;
+const uint16_t *q = a->src;
+unsigned i;
+
+    for(i=0;i<a->h;i++) {
+        p[i] = *q;
+        q += a->srcstride;
+    }
+}
+
+static void bench_dma2dcopy(void *arg) {
+Copy2DArgs *a = arg;
+
+    DMA2D_Copy2D(a->dst,a->w,a->src,a->srcstride,a->w,a->h,a->es);
+    while( !DMA2D_IsReady() ) {}
+}
+
+static void
+suite_copy2d(void) {
+static const unsigned elemsizes[] = { 1, 2, 4 };
+static const unsigned channels[]  = { 2, 8 };
+char name[32];
+Copy2DArgs a;
+unsigned i,n;
+
+    DMA2D_Init();
+
+    a.dst = FRAMEAREA;
+    for(i=0;i<sizeof(elemsizes)/sizeof(elemsizes[0]);i++) {
+        a.es        = elemsizes[i];
+        a.w         = BLOCKSIZE;
+        a.h         = BLOCKSIZE;
+        a.srcstride = FRAMEWIDTH;
+        a.src       = FRAMEAREA2+(16*FRAMEWIDTH+16)*a.es;
+        n = BLOCKSIZE*BLOCKSIZE*a.es;
+        snprintf(name,sizeof(name),"c_block%u",8*a.es);
+        Bench_Run("copy2d",name,n,REPS,bench_cblock,&a,0);
+        snprintf(name,sizeof(name),"dma2d_block%u",8*a.es);
+        Bench_Run("copy2d",name,n,REPS,bench_dma2dcopy,&a,0);
+    }
+
+    a.src = FRAMEAREA2;
+    a.es  = 2;
+    a.w   = 1;
+    a.h   = SAMPLES;
+    for(i=0;i<sizeof(channels)/sizeof(channels[0]);i++) {
+        a.srcstride = channels[i];
+        n = SAMPLES*2;
+        snprintf(name,sizeof(name),"c_channel%u",channels[i]);
+        Bench_Run("copy2d",name,n,REPS,bench_cchannel,&a,0);
+        snprintf(name,sizeof(name),"dma2d_channel%u",channels[i]);
+        Bench_Run("copy2d",name,n,REPS,bench_dma2dcopy,&a,0);
+    }
+}
+///@}
+
+/**
+ * @brief   Buddy benchmarks
+ *
+ * @note    Each run allocates BLOCKS blocks of pseudo random sizes and frees
+ *          them in a different order
+ */
+///@{
+#define BLOCKS 64
+
+typedef struct {
+    POOL        pool;
+    unsigned    sizes[BLOCKS];
+    void        *blocks[BLOCKS];
+} BuddyArgs;
+
+static void bench_buddyalloc(void *arg) {
+BuddyArgs *a = arg;
+int i;
+
+    for(i=0;i<BLOCKS;i++)
+        a->blocks[i] = Buddy_AllocFrom(a->pool,a->sizes[i]);
+    for(i=0;i<BLOCKS;i++)
+        Buddy_FreeTo(a->pool,a->blocks[(i*7)%BLOCKS]);
+}
+
+static void
+suite_buddy(void) {
+static BuddyArgs a;
+BENCH_Result r;
+uint32_t seed = 313;
+int i;
+
+    a.pool = Buddy_CreatePool(POOLAREA,POOLSIZE,POOLMINSIZE);
+    if( a.pool == 0 ) {
+        Bench_Skip("buddy","allocfree","cannot create pool");
+        return;
+    }
+    for(i=0;i<BLOCKS;i++) {
+        seed = seed*1103515245+12345;
+        a.sizes[i] = (seed>>16)%(POOLSIZE/(4*BLOCKS));
+    }
+    Bench_Run("buddy","allocfree64",0,REPS,bench_buddyalloc,&a,&r);
+    r.min  /= 2*BLOCKS;
+    r.mean /= 2*BLOCKS;
+    r.max  /= 2*BLOCKS;
+    Bench_Report("buddy","perop",0,&r);
+}
+///@}
+
+/**
+ * @brief   FIFO benchmarks
+ */
+///@{
+#define FIFOSIZE    1024
+#define FIFOBURST   256
+
+typedef struct {
+    FIFO        f;
+    char        buf[FIFOBURST];
+} FifoArgs;
+
+static void bench_fifoblock(void *arg) {
+FifoArgs *a = arg;
+
+    fifo_write(a->f,a->buf,FIFOBURST);
+    fifo_read(a->f,a->buf,FIFOBURST);
+}
+
+static void bench_fifochar(void *arg) {
+FifoArgs *a = arg;
+int i;
+
+    for(i=0;i<FIFOBURST;i++)
+        fifo_insert(a->f,a->buf[i]);
+    for(i=0;i<FIFOBURST;i++)
+        a->buf[i] = fifo_remove(a->f);
+}
+
+static void
+suite_fifo(void) {
+static DECLARE_FIFO_AREA(fifoarea,FIFOSIZE);
+static FifoArgs a;
+
+    a.f = fifo_init(fifoarea,FIFOSIZE);
+    memset(a.buf,'x',sizeof(a.buf));
+    Bench_Run("fifo","block",2*FIFOBURST,REPS,bench_fifoblock,&a,0);
+    Bench_Run("fifo","char",2*FIFOBURST,REPS,bench_fifochar,&a,0);
+}
+///@}
+
+/**
+ * @brief   I2C benchmarks
+ *
+ * @note    Reads the chip id register of the touch controller
+ */
+///@{
+#define I2C_INTERFACE       I2C3
+#define I2C_ADDRESS         0x38
+#define FT5336_CHIPID       0xA8
+
+static void bench_i2cread(void *arg) {
+uint8_t reg = FT5336_CHIPID;
+uint8_t v;
+
+    (void) arg;
+    I2CMaster_Write(I2C_INTERFACE,I2C_ADDRESS,&reg,1);
+    I2CMaster_Read(I2C_INTERFACE,I2C_ADDRESS,&v,1);
+}
+
+static void
+suite_i2c(void) {
+BENCH_Result r;
+
+    if( I2CMaster_Init(I2C_INTERFACE,0,0) < 0 ) {
+        Bench_Skip("i2c","regread","cannot initialize I2C3");
+        return;
+    }
+    if( I2CMaster_Detect(I2C_INTERFACE,I2C_ADDRESS) < 0 ) {
+        Bench_Skip("i2c","regread","touch controller not found");
+        return;
+    }
+    Bench_Run("i2c","regread",2,REPS,bench_i2cread,0,&r);
+    if( r.mean )
+        printf("#i2c transactions/s %lu\n",(unsigned long) (SystemCoreClock/r.mean));
+}
+///@}
+
+/**
+ * @brief   CoreMark style benchmarks
+ *
+ * @note    The kernels run from flash, so the results depend on the code
+ *          placement. With ITCM (default), the ART accelerator and the prefetch
+ *          are turned on and off. With AXIM (USE_AXIMFLASH in Makefile), the L1
+ *          I-cache is turned on and off
+ *
+ * @note    The first run of Bench_Run is a warm-up, so the minimum is the value
+ *          with the loop in the ART or in the I-cache
+ */
+///@{
+#define CORESEED            0x3415
+
+typedef struct {
+    uint16_t    (*f)(void);
+    uint16_t    crc;
+} CoreArgs;
+
+static void bench_core(void *arg) {
+CoreArgs *a = arg;
+
+    a->crc = a->f();
+}
+
+static void
+suite_core(void) {
+static const struct {
+    const char  *name;
+    uint16_t    (*f)(void);
+} kernels[] = {
+    { "list",   CoreBench_List      },
+    { "matrix", CoreBench_Matrix    },
+    { "state",  CoreBench_State     },
+    { "all",    CoreBench_All       },
+};
+static const struct {
+    const char  *name;
+    int         art;
+    int         prefetch;
+    int         icache;
+} configs[] = {
+#ifdef USE_AXIMFLASH
+    { "icache", 1,  1,  1 },
+    { "none",   1,  1,  0 },
+#else
+    { "art_pf", 1,  1,  1 },
+    { "art",    1,  0,  1 },
+    { "pf",     0,  1,  1 },
+    { "none",   0,  0,  1 },
+#endif
+};
+uint16_t crcs[sizeof(kernels)/sizeof(kernels[0])];
+char name[32];
+CoreArgs a;
+unsigned i,j;
+
+#ifdef USE_AXIMFLASH
+    printf("#core code thru AXIM at %p\n",(void *) suite_core);
+#else
+    printf("#core code thru ITCM at %p\n",(void *) suite_core);
+#endif
+    CoreBench_Init(CORESEED);
+    for(j=0;j<sizeof(configs)/sizeof(configs[0]);j++) {
+        SystemConfigFlashAccelerator(configs[j].art,configs[j].prefetch);
+        if( !configs[j].icache )
+            SCB_DisableICache();
+        for(i=0;i<sizeof(kernels)/sizeof(kernels[0]);i++) {
+            a.f = kernels[i].f;
+            snprintf(name,sizeof(name),"%s_%s",kernels[i].name,configs[j].name);
+            Bench_Run("core",name,0,REPS,bench_core,&a,0);
+            if( j == 0 )
+                crcs[i] = a.crc;
+            else if( a.crc != crcs[i] )
+                printf("#core %s crc 0x%04X instead of 0x%04X\n",name,a.crc,crcs[i]);
+        }
+        if( !configs[j].icache )
+            SCB_EnableICache();
+    }
+    SystemConfigFlashAccelerator(1,1);
+}
+///@}
+
+/**
+ * @brief   main
+ *
+ * @note    Runs all suites once and stops
+ */
+int main(void) {
+
+    /* configure clock to 200 MHz */
+    SystemSetCoreClock(CLOCKSRC_PLL,1);
+
+    SysTick_Config(SystemCoreClock/1000);
+
+#ifdef STDIO_USE_SWO
+    /* Enable stimulus ports for stdio, logs, counters and events */
+    SWO_Init(0,0xF);
+#endif
+
+    LED_Init();
+
+    SDRAM_Init();
+
+    Bench_Init();
+
+    printf("\n#benchmark start\n");
+#ifdef PCSAMPLE_ENABLE
+    if( PCSample_Init(PCSAMPLEAREA,PCSAMPLESIZE,PCSAMPLE_RATE) == PCSAMPLE_OK )
+        PCSample_Start();
+    else
+        printf("#pcsample cannot be initialized\n");
+#endif
+    Bench_PrintHeader();
+    suite_mem();
+    suite_memfast();
+    suite_fill();
+    suite_pixops();
+    suite_copy2d();
+    suite_buddy();
+    suite_fifo();
+    suite_i2c();
+    suite_core();
+#ifdef PCSAMPLE_ENABLE
+    PCSample_Stop();
+    PCSample_Dump();
+#endif
+    printf("#benchmark end\n");
+
+    for(;;) {}
+}
@@ -0,0 +1,325 @@
+/**
+ * @file    memfast.c
+ *
+ * @note    memcpy, memset and memmove tuned for the Cortex-M7 (see memfast.h)
+ *
+ * @note    The destination is word aligned first (prologue). When the source
+ *          has then the same alignment, blocks of 32 bytes (a cache line) are
+ *          moved with 4 LDRD and 4 STRD. Otherwise the source is read by
+ *          aligned words and two consecutive words are shifted into one. No
+ *          unaligned access is done, because the SDRAM at 0xC000_0000 is device
+ *          memory in the default memory map, where it faults
+ *
+ * @note    PLD loads a cache line of the source in advance when it is cached.
+ *          It does nothing otherwise and it never faults, so it can point past
+ *          the end of the source
+ *
+ * @note    memmove copies forward, as memcpy, unless the destination starts
+ *          inside the source. Then it copies backward, by blocks when source
+ *          and destination have the same alignment and by bytes otherwise
+ *
+ * @note    GCC must not replace the byte loops by calls to memcpy or memset,
+ *          that would come back here
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#pragma GCC optimize ("no-tree-loop-distribute-patterns")
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "memfast.h"
+
+#if MEMFAST_SMALLSIZE < 8
+#error "MEMFAST_SMALLSIZE must be at least 8"
+#endif
+
+/**
+ * @brief   Word access, without the aliasing rules
+ */
+typedef uint32_t __attribute__((may_alias)) Word;
+
+/**
+ * @brief   Byte loops
+ */
+///@{
+static inline void
+CopyBytes(uint8_t *p, const uint8_t *q, size_t n) {
+
+    while( n >= 2 ) {
+        p[0] = q[0]; p[1] = q[1];
+        p += 2;
+        q += 2;
+        n -= 2;
+    }
+    if( n )
+        *p = *q;
+}
+
+static inline void
+CopyBytesBack(uint8_t *p, const uint8_t *q, size_t n) {
+
+    while( n > 0 ) {
+        n--;
+        p[n] = q[n];
+    }
+}
+///@}
+
+/**
+ * @brief   Moves 32 bytes. Both must be word aligned
+ */
+static inline void
+Copy32(uint8_t *p, const uint8_t *q) {
+#if defined(__thumb2__)
+uint32_t r0,r1,r2,r3,r4,r5,r6,r7;
+
+    __asm volatile(
+        " ldrd      %0,%1,[%8]              \n"
+        " ldrd      %2,%3,[%8,#8]           \n"
+        " ldrd      %4,%5,[%8,#16]          \n"
+        " ldrd      %6,%7,[%8,#24]          \n"
+        " strd      %0,%1,[%9]              \n"
+        " strd      %2,%3,[%9,#8]           \n"
+        " strd      %4,%5,[%9,#16]          \n"
+        " strd      %6,%7,[%9,#24]          \n"
+        : "=&r" (r0), "=&r" (r1), "=&r" (r2), "=&r" (r3),
+          "=&r" (r4), "=&r" (r5), "=&r" (r6), "=&r" (r7)
+        : "r" (q), "r" (p)
+        : "memory"
+    );
+#else
+const Word *qw = (const Word *) q;
+Word *pw = (Word *) p;
+uint32_t w0,w1,w2,w3,w4,w5,w6,w7;
+
+    w0 = qw[0]; w1 = qw[1]; w2 = qw[2]; w3 = qw[3];
+    w4 = qw[4]; w5 = qw[5]; w6 = qw[6]; w7 = qw[7];
+    pw[0] = w0; pw[1] = w1; pw[2] = w2; pw[3] = w3;
+    pw[4] = w4; pw[5] = w5; pw[6] = w6; pw[7] = w7;
+#endif
+}
+
+/**
+ * @brief   Writes w in 32 bytes. p must be word aligned
+ */
+static inline void
+Set32(uint8_t *p, uint32_t w) {
+#if defined(__thumb2__)
+uint32_t w2 = w;
+
+    __asm volatile(
+        " strd      %1,%2,[%0]              \n"
+        " strd      %1,%2,[%0,#8]           \n"
+        " strd      %1,%2,[%0,#16]          \n"
+        " strd      %1,%2,[%0,#24]          \n"
+        :
+        : "r" (p), "r" (w), "r" (w2)
+        : "memory"
+    );
+#else
+Word *pw = (Word *) p;
+
+    pw[0] = w; pw[1] = w; pw[2] = w; pw[3] = w;
+    pw[4] = w; pw[5] = w; pw[6] = w; pw[7] = w;
+#endif
+}
+
+/**
+ * @brief   Forward copy, both word aligned
+ *
+ * @note    Copies the multiple of 4 bytes below n and returns it
+ */
+static size_t
+CopyAligned(uint8_t *p, const uint8_t *q, size_t n) {
+size_t done = n&~(size_t) 3;
+
+    while( n >= 32 ) {
+        __builtin_prefetch(q+MEMFAST_PREFETCH);
+        Copy32(p,q);
+        p += 32;
+        q += 32;
+        n -= 32;
+    }
+    while( n >= 4 ) {
+        *(Word *) p = *(const Word *) q;
+        p += 4;
+        q += 4;
+        n -= 4;
+    }
+    return done;
+}
+
+/**
+ * @brief   Forward copy, destination word aligned, source not
+ *
+ * @note    Each word written is made of the end of an aligned word of the
+ *          source and the beginning of the next one. Only the words holding
+ *          bytes of the source are read. Copies the multiple of 4 bytes below
+ *          n and returns it
+ */
+static size_t
+CopyShifted(uint8_t *p, const uint8_t *q, size_t n) {
+size_t done = n&~(size_t) 3;
+unsigned sh = ((uintptr_t) q&3)*8;
+const Word *qw = (const Word *) ((uintptr_t) q&~(uintptr_t) 3);
+Word *pw = (Word *) p;
+uint32_t w0,w1,w2,w3,w4;
+
+    w0 = *qw++;
+    while( n >= 16 ) {
+        __builtin_prefetch((const uint8_t *) qw+MEMFAST_PREFETCH);
+        w1 = qw[0]; w2 = qw[1]; w3 = qw[2]; w4 = qw[3];
+        pw[0] = (w0>>sh)|(w1<<(32-sh));
+        pw[1] = (w1>>sh)|(w2<<(32-sh));
+        pw[2] = (w2>>sh)|(w3<<(32-sh));
+        pw[3] = (w3>>sh)|(w4<<(32-sh));
+        w0 = w4;
+        qw += 4;
+        pw += 4;
+        n  -= 16;
+    }
+    while( n >= 4 ) {
+        w1 = *qw++;
+        *pw++ = (w0>>sh)|(w1<<(32-sh));
+        w0 = w1;
+        n -= 4;
+    }
+    return done;
+}
+
+/**
+ * @brief   MemFast_Copy
+ *
+ * @note    memcpy. The areas must not overlap
+ */
+void *
+MemFast_Copy(void *dst, const void *src, size_t n) {
+uint8_t *p = dst;
+const uint8_t *q = src;
+size_t k;
+
+    if( n < MEMFAST_SMALLSIZE ) {
+        CopyBytes(p,q,n);
+        return dst;
+    }
+
+    k = (-(uintptr_t) p)&3;
+    CopyBytes(p,q,k);
+    p += k;
+    q += k;
+    n -= k;
+
+    if( ((uintptr_t) q&3) == 0 )
+        k = CopyAligned(p,q,n);
+    else
+        k = CopyShifted(p,q,n);
+    CopyBytes(p+k,q+k,n-k);
+    return dst;
+}
+
+/**
+ * @brief   MemFast_Set
+ *
+ * @note    memset
+ */
+void *
+MemFast_Set(void *dst, int c, size_t n) {
+uint8_t *p = dst;
+uint32_t w = (uint8_t) c;
+size_t k;
+
+    if( n < MEMFAST_SMALLSIZE ) {
+        while( n > 0 ) {
+            *p++ = (uint8_t) w;
+            n--;
+        }
+        return dst;
+    }
+
+    k = (-(uintptr_t) p)&3;
+    n -= k;
+    while( k > 0 ) {
+        *p++ = (uint8_t) w;
+        k--;
+    }
+
+    w |= w<<8;
+    w |= w<<16;
+    while( n >= 32 ) {
+        Set32(p,w);
+        p += 32;
+        n -= 32;
+    }
+    while( n >= 4 ) {
+        *(Word *) p = w;
+        p += 4;
+        n -= 4;
+    }
+    while( n > 0 ) {
+        *p++ = (uint8_t) w;
+        n--;
+    }
+    return dst;
+}
+
+/**
+ * @brief   MemFast_Move
+ *
+ * @note    memmove. The forward copy of MemFast_Copy reads each block before
+ *          writing it, so it is right when the destination is below the source
+ */
+void *
+MemFast_Move(void *dst, const void *src, size_t n) {
+uint8_t *p = dst;
+const uint8_t *q = src;
+size_t k;
+
+    if( (uintptr_t) p-(uintptr_t) q >= n )  // no overlap or destination below
+        return MemFast_Copy(dst,src,n);
+
+    p += n;
+    q += n;
+    if( n < MEMFAST_SMALLSIZE || (((uintptr_t) p^(uintptr_t) q)&3) ) {
+        CopyBytesBack(p-n,q-n,n);
+        return dst;
+    }
+
+    k = (uintptr_t) p&3;
+    p -= k;
+    q -= k;
+    n -= k;
+    CopyBytesBack(p,q,k);
+
+    while( n >= 32 ) {
+        p -= 32;
+        q -= 32;
+        n -= 32;
+        __builtin_prefetch(q-MEMFAST_PREFETCH);
+        Copy32(p,q);
+    }
+    while( n >= 4 ) {
+        p -= 4;
+        q -= 4;
+        n -= 4;
+        *(Word *) p = *(const Word *) q;
+    }
+    CopyBytesBack(p-n,q-n,n);
+    return dst;
+}
+
+/**
+ * @brief   Replacements of newlib (--wrap in Makefile)
+ */
+///@{
+#ifdef MEMFAST_WRAP
+void *__wrap_memcpy(void *dst, const void *src, size_t n)
+                                        __attribute__((alias("MemFast_Copy")));
+void *__wrap_memset(void *dst, int c, size_t n)
+                                        __attribute__((alias("MemFast_Set")));
+void *__wrap_memmove(void *dst, const void *src, size_t n)
+                                        __attribute__((alias("MemFast_Move")));
+#endif
+///@}
@@ -0,0 +1,46 @@
+#ifndef MEMFAST_H
+#define MEMFAST_H
+/**
+ * @file    memfast.h
+ *
+ * @note    memcpy, memset and memmove tuned for the Cortex-M7
+ *
+ * @note    They have the same interface as the functions of string.h. When the
+ *          Makefile sets USE_MEMFAST, the linker wraps memcpy, memset and
+ *          memmove (--wrap), so all calls, of newlib too, come here and the
+ *          functions of newlib stay reachable as __real_memcpy, __real_memset
+ *          and __real_memmove (for the benchmark)
+ *
+ * @note    Sizes below MEMFAST_SMALLSIZE are done byte by byte, without the
+ *          alignment work. Larger areas are copied 32 bytes at a time with
+ *          LDRD/STRD, reading MEMFAST_PREFETCH bytes ahead with PLD
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stddef.h>
+
+/**
+ * @brief   Parameters
+ */
+///@{
+#ifndef MEMFAST_SMALLSIZE
+#define MEMFAST_SMALLSIZE           16      ///< bytes, at least 8
+#endif
+#ifndef MEMFAST_PREFETCH
+#define MEMFAST_PREFETCH            64      ///< bytes ahead (2 cache lines)
+#endif
+///@}
+
+void *MemFast_Copy(void *dst, const void *src, size_t n);
+void *MemFast_Set(void *dst, int c, size_t n);
+void *MemFast_Move(void *dst, const void *src, size_t n);
+
+#ifdef MEMFAST_WRAP
+void *__real_memcpy(void *dst, const void *src, size_t n);
+void *__real_memset(void *dst, int c, size_t n);
+void *__real_memmove(void *dst, const void *src, size_t n);
+#endif
+
+#endif // MEMFAST_H
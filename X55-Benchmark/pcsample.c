@@ -0,0 +1,215 @@
+/**
+ * @file    pcsample.c
+ *
+ * @note    Statistical profiler using TIM7 (see pcsample.h)
+ *
+ * @note    TIM7 counts microseconds. At each update, the handler takes the PC
+ *          from the exception frame (on MSP or PSP, as given by bit 2 of
+ *          EXC_RETURN in LR) and increments its counter. The frame layout is
+ *          the same with the FPU registers (they are after xPSR)
+ *
+ * @note    The jitter comes from a 16 bit LFSR. The new reload value is written
+ *          after the update, so it applies to the next period
+ *
+ * @note    Compiled only when PCSAMPLE_ENABLE is defined (Makefile)
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#ifdef PCSAMPLE_ENABLE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "pcsample.h"
+
+/**
+ * @brief   Limits of the code (stm32f746.ld)
+ */
+///@{
+extern char _text_start[];
+extern char _text_end[];
+///@}
+
+/**
+ * @brief   State
+ */
+///@{
+static PCSample_Info    info;
+static uint32_t         period = 0;         // us
+static uint32_t         jitter = 0;         // us, 0 or power of 2
+static uint16_t         lfsr = 0xACE1;
+///@}
+
+/**
+ * @brief   Count a sample
+ *
+ * @note    Called by TIM7_IRQHandler with the address of the exception frame.
+ *          The stacked PC is frame[6]
+ */
+void pcsample_record(uint32_t *frame);
+
+void
+pcsample_record(uint32_t *frame) {
+uint32_t i;
+
+    TIM7->SR = 0;
+
+    i = (frame[6]-info.base)>>info.shift;
+    if( i < info.counters )
+        info.histogram[i]++;
+    else
+        info.outside++;
+    info.samples++;
+
+    if( jitter ) {
+        lfsr = (lfsr>>1)^(-(lfsr&1U)&0xB400U);
+        TIM7->ARR = period-1-jitter/2+(lfsr&(jitter-1));
+    }
+}
+
+/**
+ * @brief   TIM7 interrupt
+ *
+ * @note    Naked, so the stack pointer is not changed before it is read. LR
+ *          keeps EXC_RETURN, so pcsample_record returns from the exception
+ */
+void __attribute__((naked))
+TIM7_IRQHandler(void) {
+
+    __asm volatile(
+        " tst       lr,#4                   \n"
+        " ite       eq                      \n"
+        " mrseq     r0,msp                  \n"
+        " mrsne     r0,psp                  \n"
+        " b         pcsample_record         \n"
+    );
+}
+
+/**
+ * @brief   PCSample_Init
+ *
+ * @note    Configures TIM7 for rate samples per second and the histogram in
+ *          the area of size bytes. The sampling starts with PCSample_Start
+ *
+ * @note    The APB1 timer clock is twice the APB1 clock when its prescaler is
+ *          not 1
+ */
+int
+PCSample_Init(void *area, uint32_t size, unsigned rate) {
+uint32_t textsize = (uint32_t) (_text_end-_text_start);
+uint32_t clk;
+unsigned shift;
+
+    if( rate < 16 || rate > 500000 )
+        return PCSAMPLE_ERROR_PARAM;
+
+    shift = PCSAMPLE_MINSHIFT;
+    while( ((textsize+(1U<<shift)-1)>>shift)*sizeof(uint32_t) > size ) {
+        if( ++shift > 16 )
+            return PCSAMPLE_ERROR_SIZE;
+    }
+
+    PCSample_Stop();
+
+    info.histogram = (uint32_t *) area;
+    info.base      = (uint32_t) _text_start;
+    info.shift     = shift;
+    info.counters  = (textsize+(1U<<shift)-1)>>shift;
+    info.rate      = rate;
+    PCSample_Clear();
+
+    period = 1000000/rate;
+    jitter = (PCSAMPLE_JITTER < period) ? PCSAMPLE_JITTER : 0;
+
+    RCC->APB1ENR |= RCC_APB1ENR_TIM7EN;
+    RCC->APB1RSTR |= RCC_APB1RSTR_TIM7RST;
+    RCC->APB1RSTR &= ~RCC_APB1RSTR_TIM7RST;
+
+    clk = SystemGetAPB1Frequency();
+    if( SystemGetAPB1Prescaler() != 1 )
+        clk *= 2;
+
+    TIM7->PSC  = clk/1000000-1;
+    TIM7->ARR  = period-1;
+    TIM7->EGR  = TIM_EGR_UG;                // load PSC
+    TIM7->SR   = 0;
+    TIM7->DIER = TIM_DIER_UIE;
+
+    NVIC_SetPriority(TIM7_IRQn,PCSAMPLE_IRQLEVEL);
+    NVIC_ClearPendingIRQ(TIM7_IRQn);
+    NVIC_EnableIRQ(TIM7_IRQn);
+
+    return PCSAMPLE_OK;
+}
+
+/**
+ * @brief   PCSample_Start
+ */
+void
+PCSample_Start(void) {
+
+    if( info.histogram )
+        TIM7->CR1 |= TIM_CR1_CEN;
+}
+
+/**
+ * @brief   PCSample_Stop
+ */
+void
+PCSample_Stop(void) {
+
+    if( RCC->APB1ENR&RCC_APB1ENR_TIM7EN )
+        TIM7->CR1 &= ~TIM_CR1_CEN;
+}
+
+/**
+ * @brief   PCSample_Clear
+ *
+ * @note    Clears the histogram and the counts. Stop the sampling before
+ */
+void
+PCSample_Clear(void) {
+
+    memset(info.histogram,0,info.counters*sizeof(uint32_t));
+    info.samples = 0;
+    info.outside = 0;
+}
+
+/**
+ * @brief   PCSample_GetInfo
+ */
+void
+PCSample_GetInfo(PCSample_Info *p) {
+
+    *p = info;
+}
+
+/**
+ * @brief   PCSample_Dump
+ *
+ * @note    Prints the counters not zero (see pcsample.h). The sampling is
+ *          stopped during the printing, so printf is not counted
+ */
+void
+PCSample_Dump(void) {
+uint32_t cr1 = TIM7->CR1;
+uint32_t i;
+
+    PCSample_Stop();
+    printf("#pcsample rate=%u shift=%u base=0x%08lX samples=%lu outside=%lu\n",
+            info.rate,info.shift,(unsigned long) info.base,
+            (unsigned long) info.samples,(unsigned long) info.outside);
+    for(i=0;i<info.counters;i++) {
+        if( info.histogram[i] )
+            printf("PCSAMPLE,0x%08lX,%lu\n",(unsigned long) (info.base+(i<<info.shift)),
+                    (unsigned long) info.histogram[i]);
+    }
+    TIM7->CR1 = cr1;
+}
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef PCSAMPLE_H
+#define PCSAMPLE_H
+/**
+ * @file    pcsample.h
+ *
+ * @note    Statistical profiler: the PC stacked by a periodic interrupt of TIM7
+ *          is counted in a histogram over the code (.text), so the hot spots
+ *          of the whole firmware are found without probes (see profile.h)
+ *
+ * @note    Each counter covers 2^shift bytes of code. PCSample_Init chooses the
+ *          smallest shift (at least PCSAMPLE_MINSHIFT) that makes the histogram
+ *          fit in the given area, normally in SDRAM. The samples outside .text
+ *          (code in RAM, the ROM bootloader) are only counted
+ *
+ * @note    The period is changed at random by up to PCSAMPLE_JITTER us, so a
+ *          loop with the same period as the timer is not always sampled at the
+ *          same point
+ *
+ * @note    PCSample_Dump prints the histogram as lines
+ *
+ *          PCSAMPLE,address,count
+ *
+ *          (only the counters not zero) after a line #pcsample with the
+ *          parameters. tools/pcprof maps them to the functions of the ELF file
+ *
+ *          grep ^PCSAMPLE log.txt | ../tools/pcprof gcc/benchmark.axf
+ *
+ * @note    The interrupt has the highest priority, so it samples the other
+ *          interrupts too, and takes about 50 cycles at each sample. At 10 kHz
+ *          and 200 MHz it is 0.25% of the time, but it is inside the cycles
+ *          measured by bench.c or profile.c
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Parameters
+ */
+///@{
+#ifndef PCSAMPLE_RATE
+#define PCSAMPLE_RATE               10000   ///< samples per second
+#endif
+#ifndef PCSAMPLE_JITTER
+#define PCSAMPLE_JITTER             8       ///< us (power of 2, 0: none)
+#endif
+#define PCSAMPLE_MINSHIFT           1       ///< Thumb instructions are halfwords
+#define PCSAMPLE_IRQLEVEL           0
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define PCSAMPLE_OK                 (0)
+#define PCSAMPLE_ERROR_PARAM        (-1)    ///< rate out of 16 to 500000 Hz
+#define PCSAMPLE_ERROR_SIZE         (-2)    ///< area too small for 1 counter per 64 KB
+///@}
+
+/**
+ * @brief   State of the profiler
+ */
+typedef struct {
+    uint32_t    *histogram;
+    uint32_t    counters;                   ///< number of counters
+    uint32_t    base;                       ///< address of the first counter
+    unsigned    shift;                      ///< each counter covers 2^shift bytes
+    unsigned    rate;                       ///< samples per second
+    uint32_t    samples;                    ///< total samples
+    uint32_t    outside;                    ///< samples outside .text
+} PCSample_Info;
+
+int  PCSample_Init(void *area, uint32_t size, unsigned rate);
+void PCSample_Start(void);
+void PCSample_Stop(void);
+void PCSample_Clear(void);
+void PCSample_GetInfo(PCSample_Info *info);
+void PCSample_Dump(void);
+
+#endif // PCSAMPLE_H
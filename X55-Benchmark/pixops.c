@@ -0,0 +1,330 @@
+/**
+ * @file    pixops.c
+ *
+ * @note    CPU kernels to fill, copy and blend pixels
+ *
+ * @note    Fills and copies move 8 words per iteration. GCC generates STM/LDM or
+ *          STRD/LDRD for them, so a 32 byte block is written in one burst.
+ *
+ * @note    Blends work on a word at a time (two RGB565 pixels or four bytes).
+ *          50% blends use the halving add of the DSP extension (UHADD8) and the
+ *          RGB565 kernels pack the two halves with PKHBT. When there is no DSP
+ *          extension, plain C with the same results is used.
+ *
+ * @note    Constant alpha blends split a word in two groups of alternate bytes
+ *          (mask 0x00FF00FF), so two channels are multiplied at once. RGB565
+ *          pixels are expanded to the 0x07E0F81F form for the same reason.
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "stm32f746xx.h"
+#include "pixops.h"
+
+/**
+ * @brief   Copied from 24-LCD, where the kernels are placed in ITCM
+ */
+#define ITCM_CODE
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP==1)
+#define PIXOPS_USEDSP 1
+#endif
+
+/**
+ * @brief   Halving add of 4 bytes
+ */
+static inline uint32_t avg8(uint32_t a, uint32_t b) {
+#ifdef PIXOPS_USEDSP
+    return __UHADD8(a,b);
+#else
+    return (a&b)+(((a^b)&0xFEFEFEFE)>>1);
+#endif
+}
+
+/**
+ * @brief   Halving add of two RGB565 pixels packed in a word
+ */
+static inline uint32_t avg565(uint32_t a, uint32_t b) {
+
+    return ((a&0xF7DEF7DE)>>1)+((b&0xF7DEF7DE)>>1)+(a&b&0x08210821);
+}
+
+/**
+ * @brief   Pack two halfwords in a word (lo in bits 15..0)
+ */
+static inline uint32_t pack16(uint32_t lo, uint32_t hi) {
+#ifdef PIXOPS_USEDSP
+    return __PKHBT(lo,hi,16);
+#else
+    return (lo&0xFFFF)|(hi<<16);
+#endif
+}
+
+/**
+ * @brief   Blend a RGB565 pixel with a 0..32 alpha
+ *
+ * @note    In the 0x07E0F81F form green is in bits 26..21, red in 15..11 and
+ *          blue in 4..0, with enough space above each for a product by 32
+ */
+static inline uint32_t blend565(uint32_t s, uint32_t d, uint32_t a) {
+uint32_t x;
+
+    s = (s|(s<<16))&0x07E0F81F;
+    d = (d|(d<<16))&0x07E0F81F;
+    x = ((s*a+d*(32-a))>>5)&0x07E0F81F;
+    return (x|(x>>16))&0xFFFF;
+}
+
+/**
+ * @brief   Blend 4 bytes with a 0..256 alpha
+ */
+static inline uint32_t blend8(uint32_t s, uint32_t d, uint32_t a) {
+uint32_t rb,g;
+
+    rb = (((s&0x00FF00FF)*a+(d&0x00FF00FF)*(256-a))>>8)&0x00FF00FF;
+    g  = ((((s>>8)&0x00FF00FF)*a+((d>>8)&0x00FF00FF)*(256-a))>>8)&0x00FF00FF;
+    return rb|(g<<8);
+}
+
+/**
+ * @brief   PixOps_FillWords
+ *
+ * @note    Writes w to nwords words
+ */
+ITCM_CODE void
+PixOps_FillWords(uint32_t *dst, uint32_t w, unsigned nwords) {
+
+    while( nwords >= 8 ) {
+        dst[0] = w; dst[1] = w; dst[2] = w; dst[3] = w;
+        dst[4] = w; dst[5] = w; dst[6] = w; dst[7] = w;
+        dst += 8;
+        nwords -= 8;
+    }
+    while( nwords > 0 ) {
+        *dst++ = w;
+        nwords--;
+    }
+}
+
+/**
+ * @brief   PixOps_Fill3Words
+ *
+ * @note    Writes the sequence w0,w1,w2 ngroups times. Used for RGB888, where
+ *          4 pixels take 3 words
+ */
+ITCM_CODE void
+PixOps_Fill3Words(uint32_t *dst, uint32_t w0, uint32_t w1, uint32_t w2,
+                  unsigned ngroups) {
+
+    while( ngroups >= 2 ) {
+        dst[0] = w0; dst[1] = w1; dst[2] = w2;
+        dst[3] = w0; dst[4] = w1; dst[5] = w2;
+        dst += 6;
+        ngroups -= 2;
+    }
+    if( ngroups ) {
+        dst[0] = w0; dst[1] = w1; dst[2] = w2;
+    }
+}
+
+/**
+ * @brief   PixOps_Copy
+ *
+ * @note    Copies nbytes bytes. The areas must not overlap
+ *
+ * @note    When source and destination have the same alignment, the first bytes
+ *          are copied until both are word aligned, then 8 words at a time.
+ *          Otherwise memcpy is used.
+ */
+ITCM_CODE void
+PixOps_Copy(void *dst, const void *src, unsigned nbytes) {
+uint8_t *p = dst;
+const uint8_t *q = src;
+uint32_t *pw;
+const uint32_t *qw;
+uint32_t w0,w1,w2,w3,w4,w5,w6,w7;
+
+    if( (((uintptr_t) p)^((uintptr_t) q))&3 ) {
+        memcpy(dst,src,nbytes);
+        return;
+    }
+    while( (nbytes>0) && (((uintptr_t) p)&3) ) {
+        *p++ = *q++;
+        nbytes--;
+    }
+    pw = (uint32_t *) p;
+    qw = (const uint32_t *) q;
+    while( nbytes >= 32 ) {
+        w0 = qw[0]; w1 = qw[1]; w2 = qw[2]; w3 = qw[3];
+        w4 = qw[4]; w5 = qw[5]; w6 = qw[6]; w7 = qw[7];
+        pw[0] = w0; pw[1] = w1; pw[2] = w2; pw[3] = w3;
+        pw[4] = w4; pw[5] = w5; pw[6] = w6; pw[7] = w7;
+        pw += 8;
+        qw += 8;
+        nbytes -= 32;
+    }
+    while( nbytes >= 4 ) {
+        *pw++ = *qw++;
+        nbytes -= 4;
+    }
+    p = (uint8_t *) pw;
+    q = (const uint8_t *) qw;
+    while( nbytes > 0 ) {
+        *p++ = *q++;
+        nbytes--;
+    }
+}
+
+/**
+ * @brief   PixOps_Blend50RGB565
+ *
+ * @note    dst = (dst+src)/2 for each channel (rounded down)
+ */
+ITCM_CODE void
+PixOps_Blend50RGB565(uint16_t *dst, const uint16_t *src, unsigned npixels) {
+uint32_t *p = (uint32_t *) dst;
+const uint32_t *q = (const uint32_t *) src;
+
+    while( npixels >= 4 ) {
+        p[0] = avg565(p[0],q[0]);
+        p[1] = avg565(p[1],q[1]);
+        p += 2;
+        q += 2;
+        npixels -= 4;
+    }
+    if( npixels >= 2 ) {
+        *p = avg565(*p,*q);
+        p++;
+        q++;
+        npixels -= 2;
+    }
+    if( npixels ) {
+        *(uint16_t *) p = avg565(*(uint16_t *) p,*(const uint16_t *) q);
+    }
+}
+
+/**
+ * @brief   PixOps_Blend50Bytes
+ *
+ * @note    dst = (dst+src)/2 for each byte. Used for RGB888 and ARGB8888, where
+ *          each channel is a byte
+ */
+ITCM_CODE void
+PixOps_Blend50Bytes(void *dst, const void *src, unsigned nbytes) {
+uint32_t *p = dst;
+const uint32_t *q = src;
+uint8_t *pb;
+const uint8_t *qb;
+
+    while( nbytes >= 8 ) {
+        p[0] = avg8(p[0],q[0]);
+        p[1] = avg8(p[1],q[1]);
+        p += 2;
+        q += 2;
+        nbytes -= 8;
+    }
+    if( nbytes >= 4 ) {
+        *p = avg8(*p,*q);
+        p++;
+        q++;
+        nbytes -= 4;
+    }
+    pb = (uint8_t *) p;
+    qb = (const uint8_t *) q;
+    while( nbytes > 0 ) {
+        *pb = (*pb+*qb)>>1;
+        pb++;
+        qb++;
+        nbytes--;
+    }
+}
+
+/**
+ * @brief   PixOps_BlendAlphaRGB565
+ *
+ * @note    dst = src*alpha+dst*(1-alpha) with alpha in 0..255 (255 = src).
+ *          The alpha is reduced to 5 bits like in RGB565 green
+ */
+ITCM_CODE void
+PixOps_BlendAlphaRGB565(uint16_t *dst, const uint16_t *src, unsigned npixels,
+                        unsigned alpha) {
+uint32_t *p = (uint32_t *) dst;
+const uint32_t *q = (const uint32_t *) src;
+uint32_t a,s,d;
+
+    a = (alpha+4)>>3;
+    while( npixels >= 2 ) {
+        s = *q++;
+        d = *p;
+        *p++ = pack16(blend565(s&0xFFFF,d&0xFFFF,a),blend565(s>>16,d>>16,a));
+        npixels -= 2;
+    }
+    if( npixels ) {
+        *(uint16_t *) p = blend565(*(const uint16_t *) q,*(uint16_t *) p,a);
+    }
+}
+
+/**
+ * @brief   PixOps_BlendAlphaBytes
+ *
+ * @note    dst = src*alpha+dst*(1-alpha) for each byte with alpha in 0..255
+ *          (255 = src). Used for RGB888 and ARGB8888
+ */
+ITCM_CODE void
+PixOps_BlendAlphaBytes(void *dst, const void *src, unsigned nbytes,
+                       unsigned alpha) {
+uint32_t *p = dst;
+const uint32_t *q = src;
+uint8_t *pb;
+const uint8_t *qb;
+uint32_t a;
+
+    a = alpha+(alpha>>7);
+    while( nbytes >= 4 ) {
+        *p = blend8(*q,*p,a);
+        p++;
+        q++;
+        nbytes -= 4;
+    }
+    pb = (uint8_t *) p;
+    qb = (const uint8_t *) q;
+    while( nbytes > 0 ) {
+        *pb = (*qb*a+*pb*(256-a))>>8;
+        pb++;
+        qb++;
+        nbytes--;
+    }
+}
+
+/**
+ * @brief   PixOps_BlendARGB8888
+ *
+ * @note    Draws src over dst using the alpha of each source pixel
+ *
+ * @note    Fully transparent and fully opaque source pixels are common in
+ *          images and fonts, so they are handled without multiplications
+ */
+ITCM_CODE void
+PixOps_BlendARGB8888(uint32_t *dst, const uint32_t *src, unsigned npixels) {
+uint32_t s,d,sa,da,a;
+
+    while( npixels > 0 ) {
+        s  = *src++;
+        sa = s>>24;
+        if( sa == 0xFF ) {
+            *dst = s;
+        } else if( sa != 0 ) {
+            d  = *dst;
+            da = d>>24;
+            a  = sa+(sa>>7);
+            da = sa+((da*(256-a))>>8);
+            *dst = (blend8(s,d,a)&0x00FFFFFF)|(da<<24);
+        }
+        dst++;
+        npixels--;
+    }
+}
@@ -0,0 +1,117 @@
+/**
+ * @file    ttyemul.c
+ *
+ * @note    TTY emulation for a UART
+ */
+
+#include "ttyemul.h"
+#include "uart.h"
+#include "fifo.h"
+
+/// Backspace used in line buffered mode
+#define TTY_BS          '\b'
+
+static unsigned ttyconfig = TTY_IECHO|TTY_OCRLF|TTY_ICRLF|TTY_LINEBUFFERED;
+
+
+/**
+ *  #brief  UART unit to be used for all I/O
+ */
+#define UART_N  UART_1
+
+
+/**
+ * @brief   Communication parameters
+ */
+static const unsigned uartconfig =  UART_NOPARITY | UART_8BITS | UART_STOP_2 |
+                                    UART_BAUD_9600;
+
+/**
+ *  @brief  tty_init
+ */
+int tty_init(int chn) {
+
+    UART_Init(  UART_N,uartconfig );
+
+    return 0;
+}
+/**
+ *  @brief  tty_write
+ *
+ *  @note   Uses the block write of the UART. The LF to CR-LF mapping is done
+ *          while the chars are copied into the output fifo
+ */
+int tty_write(int chn, char *ptr, int len) {
+
+    return UART_Write(UART_N,ptr,len,(ttyconfig&TTY_OCRLF)?UART_WRITE_CRLF:0);
+}
+
+/**
+ *  @brief  tty_read
+ *
+ *  @note   No timeout yet
+ */
+int tty_read(int chn, char *ptr, int len) {
+
+    if( ttyconfig&TTY_LINEBUFFERED)
+        return tty_read_lb(chn,ptr,len);
+    else
+        return tty_read_un(chn,ptr,len);
+}
+
+/**
+ *  @brief  tty_read_un
+ *  @note   unbuffered
+ *  @note   No timeout yet
+ */
+int tty_read_un(int chn, char *ptr, int len) {
+int cnt;
+int ch;
+
+    for(cnt=0;cnt < len;cnt++ ) {
+        ch = UART_ReadChar(UART_N);
+        if( ttyconfig&TTY_IECHO )
+            UART_WriteChar(UART_N,ch);
+        ptr[cnt] = ch;
+    }
+
+    return cnt;
+}
+
+/**
+ *  @brief  tty_read_lb
+ *  @note   line buffered
+ *  @note   no timeout yet!!
+ */
+int tty_read_lb(int chn, char *ptr, int len) {
+int cnt;
+int ch;
+
+    cnt = 0;
+    UART_Flush(UART_N);
+    while ( ((ch=UART_ReadChar(UART_N)) != '\n') && (ch!='\r') ) {
+        if( ch == TTY_BS ) {
+            if( cnt > 0 ) {
+                cnt--;
+                UART_WriteChar(UART_N,'\b');
+                UART_WriteChar(UART_N,' ');
+                UART_WriteChar(UART_N,'\b');
+            }
+        } else {
+            if( ttyconfig&TTY_IECHO )
+                UART_WriteChar(UART_N,ch);
+            if( cnt < len )         // overflow characters not stored
+                ptr[cnt++] = ch;
+        }
+    }
+
+    if( cnt < len ) {
+        ptr[cnt++] = '\n';
+    }
+    if(ttyconfig&TTY_ICRLF ) {
+        UART_WriteChar(UART_N,'\r');
+        UART_WriteChar(UART_N,'\n');
+    }
+    return cnt;
+}
+
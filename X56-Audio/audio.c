@@ -0,0 +1,487 @@
+/**
+ * @file    audio.c
+ *
+ * @brief   Audio output and input thru SAI2 and the WM8994 codec (see audio.h)
+ *
+ * @note    Clocks: SAI2 uses PLLI2S_Q/PLLI2SDIVQ (SAI2SEL=01). The PLLI2S
+ *          input is the main PLL input, that must be 1 MHz (HSE/25). MCLK is
+ *          SAI_CK/(2*MCKDIV), or SAI_CK when MCKDIV=0, and is 256*fs. SCK is
+ *          32*fs (two 16 bit slots)
+ *
+ * | fs (Hz) | PLLI2SN | PLLI2SQ | PLLI2SDIVQ | SAI_CK (MHz) | MCKDIV | fs real  |
+ * |---------|---------|---------|------------|--------------|--------|----------|
+ * |  16000  |   344   |    7    |      1     |    49.143    |    6   | 15997.0  |
+ * |  44100  |   429   |    2    |     19     |    11.289    |    0   | 44099.6  |
+ * |  48000  |   344   |    7    |      1     |    49.143    |    2   | 47991.1  |
+ *
+ * @note    Pins (all AF10)
+ *
+ * | Signal      | Pin  | Codec   |
+ * |-------------|------|---------|
+ * | SAI2_MCLK_A | PI4  | MCLK1   |
+ * | SAI2_SCK_A  | PI5  | BCLK1   |
+ * | SAI2_SD_A   | PI6  | DACDAT1 |
+ * | SAI2_FS_A   | PI7  | LRCLK1  |
+ * | SAI2_SD_B   | PG10 | ADCDAT1 |
+ *
+ * @note    DMA: SAI2_A is DMA2 Stream4 channel 3 and SAI2_B is DMA2 Stream6
+ *          channel 3. The buffers are cacheable. The received half is
+ *          invalidated before the callback and the half to be sent is cleaned
+ *          after it, so they are cache line aligned and padded
+ *
+ * @note    With AUDIO_DTCM (Makefile), the buffers are in DTCM, that is not
+ *          cached and is reached by the DMA through the AHB slave port. The
+ *          cache maintenance is then done on addresses that are not cached
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "gpio.h"
+#include "dma.h"
+#include "i2c-master.h"
+#include "wm8994.h"
+#include "memsections.h"
+#include "audio.h"
+
+/**
+ * @brief   I2C bus of the codec
+ */
+#define AUDIO_I2C                       I2C3
+
+/**
+ * @brief   Clock configuration for each sampling frequency
+ */
+static const struct {
+    unsigned            freq;
+    PLLConfiguration_t  pll;
+    uint32_t            divq;
+    uint32_t            mckdiv;
+} clocktab[] = {
+    { 16000, { .source = CLOCKSRC_HSE, .M = 25, .N = 344, .P = 0, .Q = 7, .R = 2 },  1, 6 },
+    { 44100, { .source = CLOCKSRC_HSE, .M = 25, .N = 429, .P = 0, .Q = 2, .R = 2 }, 19, 0 },
+    { 48000, { .source = CLOCKSRC_HSE, .M = 25, .N = 344, .P = 0, .Q = 7, .R = 2 },  1, 2 },
+};
+#define NCLOCKS (sizeof(clocktab)/sizeof(clocktab[0]))
+
+/**
+ * @brief   Pins
+ */
+static const GPIO_PinConfiguration saipins[] = {
+    //  GPIO  Pin AF  Mode OType Speed PuPd
+    { GPIOI,  4, 10,  2,   0,    3,    0 },    // SAI2_MCLK_A
+    { GPIOI,  5, 10,  2,   0,    3,    0 },    // SAI2_SCK_A
+    { GPIOI,  6, 10,  2,   0,    3,    0 },    // SAI2_SD_A
+    { GPIOI,  7, 10,  2,   0,    3,    0 },    // SAI2_FS_A
+    { GPIOG, 10, 10,  2,   0,    3,    0 },    // SAI2_SD_B
+    {     0,  0,  0,  0,   0,    0,    0 }
+};
+
+/**
+ * @brief   DMA buffers: two halves of AUDIO_BLOCKFRAMES frames
+ */
+///@{
+#define HALFSAMPLES     (AUDIO_BLOCKFRAMES*AUDIO_CHANNELS)
+#define HALFBYTES       (HALFSAMPLES*sizeof(int16_t))
+
+#ifdef AUDIO_DTCM
+static int16_t txbuffer[2*HALFSAMPLES] __attribute__((aligned(32))) DTCM_BSS;
+static int16_t rxbuffer[2*HALFSAMPLES] __attribute__((aligned(32))) DTCM_BSS;
+#else
+static int16_t txbuffer[2*HALFSAMPLES] __attribute__((aligned(32)));
+static int16_t rxbuffer[2*HALFSAMPLES] __attribute__((aligned(32)));
+#endif
+///@}
+
+/**
+ * @brief   State
+ */
+///@{
+static unsigned         audiofreq = 0;
+static unsigned         audiopaths = 0;
+static int              txdma = -1;
+static int              rxdma = -1;
+static Audio_Callback   callback = 0;
+static void            *callbackarg = 0;
+static Audio_Stats      stats;
+///@}
+
+/**
+ * @brief   Half (0 or 1) being transferred by a circular stream
+ *
+ * @note    Also returns the frames until the end of that half
+ */
+static int CurrentHalf( int h, uint32_t *left ) {
+uint32_t remaining = DMA_Remaining(h);
+
+    if( remaining > HALFSAMPLES ) {
+        *left = (remaining-HALFSAMPLES)/AUDIO_CHANNELS;
+        return 0;
+    }
+    *left = remaining/AUDIO_CHANNELS;
+    return 1;
+}
+
+/**
+ * @brief   Process a block
+ *
+ * @note    Called from the DMA interrupt of the receiver (with input) or of the
+ *          transmitter (output only). done is the half just completed
+ */
+static void ProcessBlock( int done ) {
+const int16_t *in = 0;
+int16_t *out = 0;
+uint32_t t0,cycles,left,latency;
+int outhalf = 0;
+
+    // Without a callback the application uses the buffers as rings
+    if( !callback )
+        return;
+
+    t0 = DWT->CYCCNT;
+    if( audiopaths&AUDIO_INPUT ) {
+        in = rxbuffer+done*HALFSAMPLES;
+        SCB_InvalidateDCache_by_Addr((uint32_t *) in,HALFBYTES);
+    }
+    if( audiopaths&AUDIO_OUTPUT ) {
+        outhalf = CurrentHalf(txdma,&left)^1;
+        out = txbuffer+outhalf*HALFSAMPLES;
+    }
+
+    callback(in,out,AUDIO_BLOCKFRAMES,callbackarg);
+
+    if( out ) {
+        SCB_CleanDCache_by_Addr((uint32_t *) out,HALFBYTES);
+        // Late when the transmitter has already entered the block
+        if( CurrentHalf(txdma,&left) == outhalf )
+            stats.late++;
+        latency = left;
+        if( in )
+            latency += AUDIO_BLOCKFRAMES;
+    } else {
+        // Late when the receiver is already overwriting the block
+        if( CurrentHalf(rxdma,&left) == done )
+            stats.late++;
+        latency = AUDIO_BLOCKFRAMES;
+    }
+
+    cycles = DWT->CYCCNT-t0;
+    stats.blocks++;
+    stats.cycles = cycles;
+    if( cycles > stats.maxcycles )
+        stats.maxcycles = cycles;
+    stats.latency = latency;
+    if( latency < stats.latencymin || stats.latencymin == 0 )
+        stats.latencymin = latency;
+    if( latency > stats.latencymax )
+        stats.latencymax = latency;
+}
+
+/**
+ * @brief   DMA callbacks
+ *
+ * @note    A DMA error only counts as a late block. The streams keep running
+ */
+static void DMADone( void *arg, int event ) {
+
+    (void) arg;
+    if( event == DMA_EVENT_HALF )
+        ProcessBlock(0);
+    else if( event == DMA_EVENT_FULL )
+        ProcessBlock(1);
+    else
+        stats.late++;
+}
+
+/**
+ * @brief   Configure PLLI2S and the SAI2 clock
+ */
+static int ConfigureClock( unsigned k ) {
+
+    SystemConfigPLLI2S(&clocktab[k].pll);
+    if( (RCC->CR&RCC_CR_PLLI2SRDY) == 0 )
+        return AUDIO_ERROR_CLOCK;
+
+    RCC->DCKCFGR1 = (RCC->DCKCFGR1&~(RCC_DCKCFGR1_PLLI2SDIVQ|RCC_DCKCFGR1_SAI2SEL))
+                   |((clocktab[k].divq-1)<<RCC_DCKCFGR1_PLLI2SDIVQ_Pos)
+                   |(1U<<RCC_DCKCFGR1_SAI2SEL_Pos);
+    RCC->APB2ENR |= RCC_APB2ENR_SAI2EN;
+    __DSB();
+    RCC->APB2RSTR |= RCC_APB2RSTR_SAI2RST;
+    RCC->APB2RSTR &= ~RCC_APB2RSTR_SAI2RST;
+    return AUDIO_OK;
+}
+
+/**
+ * @brief   Configure the SAI2 blocks for I2S, 16 bit stereo
+ *
+ * @note    A is the master transmitter and drives MCLK even without output,
+ *          because the codec and block B need its clocks. B is a receiver
+ *          synchronous with A. Signals change on the falling edge of SCK and
+ *          are sampled on the rising edge (CKSTR=1)
+ */
+static void ConfigureSAI( unsigned k ) {
+uint32_t frcr,slotr;
+
+    SAI2_Block_A->CR1 = 0;
+    SAI2_Block_B->CR1 = 0;
+    SAI2->GCR = 0;
+
+    frcr  = (31U<<SAI_xFRCR_FRL_Pos)            // 32 bits per frame
+           |(15U<<SAI_xFRCR_FSALL_Pos)          // FS low for the left slot
+           |SAI_xFRCR_FSDEF                     // FS identifies the channel
+           |SAI_xFRCR_FSOFF;                    // FS one bit before the data
+    slotr = (1U<<SAI_xSLOTR_NBSLOT_Pos)         // two slots of 16 bits
+           |(3U<<SAI_xSLOTR_SLOTEN_Pos);
+
+    SAI2_Block_A->FRCR  = frcr;
+    SAI2_Block_A->SLOTR = slotr;
+    SAI2_Block_A->CR2   = (1U<<SAI_xCR2_FTH_Pos)|SAI_xCR2_FFLUSH;
+    SAI2_Block_A->CR1   = (0U<<SAI_xCR1_MODE_Pos)       // master transmitter
+                         |(4U<<SAI_xCR1_DS_Pos)         // 16 bits
+                         |SAI_xCR1_CKSTR
+                         |SAI_xCR1_OUTDRIV
+                         |(clocktab[k].mckdiv<<SAI_xCR1_MCKDIV_Pos);
+
+    SAI2_Block_B->FRCR  = frcr;
+    SAI2_Block_B->SLOTR = slotr;
+    SAI2_Block_B->CR2   = (1U<<SAI_xCR2_FTH_Pos)|SAI_xCR2_FFLUSH;
+    SAI2_Block_B->CR1   = (3U<<SAI_xCR1_MODE_Pos)       // slave receiver
+                         |(4U<<SAI_xCR1_DS_Pos)
+                         |SAI_xCR1_CKSTR
+                         |(1U<<SAI_xCR1_SYNCEN_Pos);    // synchronous with A
+}
+
+/**
+ * @brief   Configure a DMA stream for a SAI block
+ */
+static int ConfigureDMA( int request, int dir, volatile uint32_t *dr, int irq ) {
+DMA_Config conf;
+int h;
+
+    h = DMA_Allocate(request);
+    if( h < 0 )
+        return h;
+    conf.dir      = dir;
+    conf.periph   = dr;
+    conf.psize    = DMA_SIZE_16;
+    conf.msize    = DMA_SIZE_16;
+    conf.burst    = DMA_BURST_SINGLE;
+    conf.priority = 3;
+    conf.flags    = DMA_FLAG_MINC|DMA_FLAG_CIRCULAR|DMA_FLAG_HALF;
+    conf.callback = irq ? DMADone : 0;
+    conf.arg      = 0;
+    if( DMA_Configure(h,&conf) < 0 ) {
+        DMA_Free(h);
+        return DMA_ERROR_PARAMETER;
+    }
+    return h;
+}
+
+/**
+ * @brief  Audio_Init
+ *
+ * @note   Configures the clocks, SAI2, the DMA streams and the codec for freq
+ *         (16000, 44100 or 48000 Hz) and paths (AUDIO_OUTPUT and/or
+ *         AUDIO_INPUT). volume is 0 to 100. The main PLL must be running and
+ *         I2C3 is initialized here, with the default timing. SysTick must call
+ *         I2CMaster_ProcessTimeouts
+ */
+int
+Audio_Init( unsigned freq, unsigned paths, unsigned volume ) {
+unsigned k;
+int rc;
+
+    for(k=0;k<NCLOCKS&&clocktab[k].freq!=freq;k++) {}
+    if( k == NCLOCKS || (paths&(AUDIO_OUTPUT|AUDIO_INPUT)) == 0 )
+        return AUDIO_ERROR_PARAMETER;
+
+    Audio_Stop();
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    rc = ConfigureClock(k);
+    if( rc < 0 )
+        return rc;
+    GPIO_ConfigureMultiplePins(saipins);
+    ConfigureSAI(k);
+
+    // The stream of the receiver drives the callbacks when there is input
+    DMA_Free(txdma);
+    DMA_Free(rxdma);
+    rxdma = -1;
+    txdma = ConfigureDMA(DMA_REQ_SAI2_A,DMA_DIR_M2P,&SAI2_Block_A->DR,
+                         (paths&AUDIO_INPUT) == 0);
+    if( paths&AUDIO_INPUT )
+        rxdma = ConfigureDMA(DMA_REQ_SAI2_B,DMA_DIR_P2M,&SAI2_Block_B->DR,1);
+    if( txdma < 0 || ((paths&AUDIO_INPUT) && rxdma < 0) )
+        return AUDIO_ERROR_DMA;
+
+    audiofreq  = freq;
+    audiopaths = paths;
+    Audio_ResetStats();
+
+    // The codec needs MCLK during its start-up sequences
+    SAI2_Block_A->CR1 |= SAI_xCR1_SAIEN;
+    if( I2CMaster_Init(AUDIO_I2C,0,0) < 0 )
+        return AUDIO_ERROR_CODEC;
+    rc = WM8994_Init(AUDIO_I2C,freq,
+                     ((paths&AUDIO_OUTPUT) ? WM8994_OUTPUT_HEADPHONE : 0)
+                    |((paths&AUDIO_INPUT)  ? WM8994_INPUT_LINE1 : 0),
+                     volume);
+    SAI2_Block_A->CR1 &= ~SAI_xCR1_SAIEN;
+    while( SAI2_Block_A->CR1&SAI_xCR1_SAIEN ) {}
+    if( rc < 0 )
+        return AUDIO_ERROR_CODEC;
+    return AUDIO_OK;
+}
+
+/**
+ * @brief  Audio_Start
+ *
+ * @note   Starts the transfers with silence in the output buffer. The first
+ *         callback comes after AUDIO_BLOCKFRAMES frames
+ */
+int
+Audio_Start( Audio_Callback cb, void *arg ) {
+unsigned i;
+
+    if( !audiopaths || txdma < 0 )
+        return AUDIO_ERROR_PARAMETER;
+
+    callback    = cb;
+    callbackarg = arg;
+    for(i=0;i<2*HALFSAMPLES;i++)
+        txbuffer[i] = 0;
+    SCB_CleanDCache_by_Addr((uint32_t *) txbuffer,sizeof(txbuffer));
+    SCB_InvalidateDCache_by_Addr((uint32_t *) rxbuffer,sizeof(rxbuffer));
+
+    SAI2_Block_A->CR2 |= SAI_xCR2_FFLUSH;
+    SAI2_Block_B->CR2 |= SAI_xCR2_FFLUSH;
+    if( DMA_Start(txdma,txbuffer,0,2*HALFSAMPLES) < 0 )
+        return AUDIO_ERROR_DMA;
+    SAI2_Block_A->CR1 |= SAI_xCR1_DMAEN;
+    if( audiopaths&AUDIO_INPUT ) {
+        if( DMA_Start(rxdma,rxbuffer,0,2*HALFSAMPLES) < 0 )
+            return AUDIO_ERROR_DMA;
+        // The slave must be enabled before the master gives the clocks
+        SAI2_Block_B->CR1 |= SAI_xCR1_DMAEN|SAI_xCR1_SAIEN;
+    }
+    SAI2_Block_A->CR1 |= SAI_xCR1_SAIEN;
+    return AUDIO_OK;
+}
+
+/**
+ * @brief  Audio_Stop
+ *
+ * @note   Stops SAI2 and the DMA streams. The codec stays configured
+ */
+void
+Audio_Stop( void ) {
+
+    if( RCC->APB2ENR&RCC_APB2ENR_SAI2EN ) {
+        SAI2_Block_B->CR1 &= ~(SAI_xCR1_SAIEN|SAI_xCR1_DMAEN);
+        SAI2_Block_A->CR1 &= ~(SAI_xCR1_SAIEN|SAI_xCR1_DMAEN);
+        while( (SAI2_Block_A->CR1|SAI2_Block_B->CR1)&SAI_xCR1_SAIEN ) {}
+    }
+    if( txdma >= 0 )
+        DMA_Stop(txdma);
+    if( rxdma >= 0 )
+        DMA_Stop(rxdma);
+}
+
+/**
+ * @brief  Audio_SetVolume
+ */
+int
+Audio_SetVolume( unsigned volume ) {
+
+    return WM8994_SetVolume(volume) < 0 ? AUDIO_ERROR_CODEC : AUDIO_OK;
+}
+
+/**
+ * @brief  Audio_Mute
+ */
+int
+Audio_Mute( int mute ) {
+
+    return WM8994_Mute(mute) < 0 ? AUDIO_ERROR_CODEC : AUDIO_OK;
+}
+
+/**
+ * @brief  Audio_GetStats
+ *
+ * @note   latencyus is calculated from latencymax and the nominal frequency
+ */
+void
+Audio_GetStats( Audio_Stats *s ) {
+uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    *s = stats;
+    __set_PRIMASK(primask);
+    s->freq = audiofreq;
+    s->latencyus = audiofreq ? (uint32_t) ((s->latencymax*1000000ULL)/audiofreq) : 0;
+}
+
+/**
+ * @brief  Audio_ResetStats
+ */
+void
+Audio_ResetStats( void ) {
+uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    stats.blocks     = 0;
+    stats.late       = 0;
+    stats.latency    = 0;
+    stats.latencymin = 0;
+    stats.latencymax = 0;
+    stats.cycles     = 0;
+    stats.maxcycles  = 0;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Audio_GetBuffer
+ *
+ * @note   Returns the circular DMA buffer of path (AUDIO_OUTPUT or AUDIO_INPUT)
+ *         and its size in frames (2*AUDIO_BLOCKFRAMES), or 0 when the path is
+ *         not used. It is cache line aligned
+ */
+int16_t *
+Audio_GetBuffer( unsigned path, unsigned *frames ) {
+
+    if( frames )
+        *frames = 2*AUDIO_BLOCKFRAMES;
+    if( path == AUDIO_OUTPUT && (audiopaths&AUDIO_OUTPUT) )
+        return txbuffer;
+    if( path == AUDIO_INPUT && (audiopaths&AUDIO_INPUT) )
+        return rxbuffer;
+    return 0;
+}
+
+/**
+ * @brief  Audio_GetPosition
+ *
+ * @note   Returns the frame of the buffer of path that its DMA stream moves
+ *         now (0 to 2*AUDIO_BLOCKFRAMES-1). The output frames before it were
+ *         given to SAI2 and the input frames before it were written
+ */
+unsigned
+Audio_GetPosition( unsigned path ) {
+int h = (path == AUDIO_INPUT) ? rxdma : txdma;
+uint32_t done;
+
+    if( h < 0 )
+        return 0;
+    done = (2*HALFSAMPLES-DMA_Remaining(h))/AUDIO_CHANNELS;
+    return done < 2*AUDIO_BLOCKFRAMES ? done : 0;
+}
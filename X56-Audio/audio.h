@@ -0,0 +1,104 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+/**
+ * @file    audio.h
+ *
+ * @brief   Audio output and input thru SAI2 and the WM8994 codec
+ *
+ * @note    SAI2 block A is the master transmitter (MCLK, SCK, FS and SD to
+ *          the codec) and block B is a receiver synchronous with it. Both use
+ *          I2S with 16 bit stereo frames. Each one has a circular DMA buffer
+ *          of two halves of AUDIO_BLOCKFRAMES frames
+ *
+ * @note    The callback is called from the DMA interrupt every half buffer,
+ *          with the block just received (in) and the block that will be sent
+ *          after the one being sent now (out). Samples are interleaved (left,
+ *          right). in is 0 without AUDIO_INPUT and out is 0 without
+ *          AUDIO_OUTPUT. The callback must return before the next half, i.e.
+ *          in less than AUDIO_BLOCKFRAMES/fs seconds
+ *
+ * @note    The latency from the line input to the headphone output is the
+ *          block being received plus the time until the block written by the
+ *          callback starts to be sent, about 2*AUDIO_BLOCKFRAMES frames. It is
+ *          measured at each callback from the position of the DMA streams.
+ *          The delay of the codec filters is not included
+ *
+ * @note    The DMA buffers can also be used as rings that the application
+ *          reads and writes itself, at the position given by
+ *          Audio_GetPosition (e.g. usbaudio.c, that moves the USB packets
+ *          straight from and to them), with no callback or with one that does
+ *          not touch the blocks. It must clean the D-cache after writing the
+ *          output ring and invalidate it before reading the input ring
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Frames in each half of the DMA buffers
+ *
+ * @note    Smaller values reduce the latency and increase the interrupt rate
+ */
+#ifndef AUDIO_BLOCKFRAMES
+#define AUDIO_BLOCKFRAMES               (256)
+#endif
+
+/**
+ * @brief   Samples in a frame (stereo)
+ */
+#define AUDIO_CHANNELS                  (2)
+
+/**
+ * @brief   Paths
+ */
+///@{
+#define AUDIO_OUTPUT                    (1)     ///< headphone output (OUT jack)
+#define AUDIO_INPUT                     (2)     ///< line input (LINE IN jack)
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define AUDIO_OK                        (0)
+#define AUDIO_ERROR_PARAMETER           (-1)
+#define AUDIO_ERROR_CLOCK               (-2)    ///< main PLL not configured
+#define AUDIO_ERROR_DMA                 (-3)    ///< SAI2 DMA streams in use
+#define AUDIO_ERROR_CODEC               (-4)    ///< codec not found or I2C error
+///@}
+
+/**
+ * @brief   Callback
+ *
+ * @note    Called from the DMA interrupt with AUDIO_BLOCKFRAMES frames
+ */
+typedef void (*Audio_Callback)(const int16_t *in, int16_t *out, unsigned frames, void *arg);
+
+/**
+ * @brief   Statistics
+ */
+typedef struct {
+    unsigned    freq;                       ///< sampling frequency (nominal)
+    unsigned    blocks;                     ///< callbacks
+    unsigned    late;                       ///< callbacks that returned too late
+    uint32_t    latency;                    ///< frames, last callback
+    uint32_t    latencymin;                 ///< frames
+    uint32_t    latencymax;                 ///< frames
+    uint32_t    latencyus;                  ///< latencymax in microseconds
+    uint32_t    cycles;                     ///< duration of last callback (cycles)
+    uint32_t    maxcycles;                  ///< longest callback (cycles)
+} Audio_Stats;
+
+int  Audio_Init( unsigned freq, unsigned paths, unsigned volume );
+int  Audio_Start( Audio_Callback cb, void *arg );
+void Audio_Stop( void );
+int  Audio_SetVolume( unsigned volume );
+int  Audio_Mute( int mute );
+void Audio_GetStats( Audio_Stats *s );
+void Audio_ResetStats( void );
+int16_t *Audio_GetBuffer( unsigned path, unsigned *frames );
+unsigned Audio_GetPosition( unsigned path );
+
+#endif // AUDIO_H
@@ -0,0 +1,105 @@
+#ifndef DSP_H
+#define DSP_H
+/**
+ * @file    dsp.h
+ *
+ * @brief   Chain of signal processing stages using CMSIS-DSP
+ *
+ * @note    DSP_Process receives a block of interleaved 16 bit samples (e.g. a
+ *          DMA half buffer), converts it to one float buffer per channel, runs
+ *          the stages in the order they were added and converts the result
+ *          back, with saturation. Input and output can be the same buffer
+ *
+ * @note    Stages
+ *          - FIR filter (arm_fir_f32), one state for each channel
+ *          - Biquad cascade (arm_biquad_cascade_df2T_f32), one state for each
+ *            channel
+ *          - Real FFT (arm_rfft_fast_f32) of the first channel, with a Hann
+ *            window. The samples are collected over several blocks and the
+ *            magnitude is read by DSP_GetSpectrum. The signal is not changed
+ *
+ * @note    DSP_Process and the stages run from ITCM and the coefficients,
+ *          states and buffers are in DTCM (see memsections.h). The code of
+ *          the library is placed in ITCM by the linker script. The project
+ *          must be compiled for the hard float ABI (Makefile)
+ *
+ * @note    The cycles of each stage and of the whole chain are measured with
+ *          the cycle counter. DSP_GetStats reports them per block and per
+ *          sample (a sample is a value of one channel)
+ *
+ * @note    Stages must be added before DSP_Process is called from the
+ *          interrupt
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "stm32f746xx.h"
+#include "arm_math.h"
+
+/**
+ * @brief   Limits (all buffers are static)
+ */
+///@{
+#ifndef DSP_MAXFRAMES
+#define DSP_MAXFRAMES                   (256)   ///< frames in a block
+#endif
+#define DSP_CHANNELS                    (2)     ///< interleaved channels
+#define DSP_MAXSTAGES                   (4)
+#define DSP_MAXTAPS                     (64)    ///< FIR
+#define DSP_MAXSECTIONS                 (8)     ///< biquad
+#define DSP_MAXFFT                      (1024)  ///< FFT (only one FFT stage)
+///@}
+
+/**
+ * @brief   Stage types
+ */
+///@{
+#define DSP_STAGE_FIR                   (1)
+#define DSP_STAGE_BIQUAD                (2)
+#define DSP_STAGE_FFT                   (3)
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define DSP_OK                          (0)
+#define DSP_ERROR_PARAMETER             (-1)
+#define DSP_ERROR_NOSTAGE               (-2)    ///< DSP_MAXSTAGES reached
+#define DSP_ERROR_FFT                   (-3)    ///< FFT already in the chain
+#define DSP_ERROR_NOSPECTRUM            (-4)    ///< no new FFT since last read
+///@}
+
+/**
+ * @brief   Processing time of a stage (or of the whole chain)
+ */
+typedef struct {
+    unsigned    type;                       ///< DSP_STAGE_x (0 for the chain)
+    uint32_t    cycles;                     ///< last block
+    uint32_t    maxcycles;                  ///< longest block
+    uint32_t    cps100;                     ///< average cycles per sample x 100
+} DSP_StageStats;
+
+/**
+ * @brief   Statistics
+ */
+typedef struct {
+    unsigned        blocks;                 ///< calls to DSP_Process
+    unsigned        spectra;                ///< FFTs computed
+    unsigned        nstages;
+    DSP_StageStats  chain;                  ///< conversions and all stages
+    DSP_StageStats  stage[DSP_MAXSTAGES];
+} DSP_Stats;
+
+void DSP_Init( void );
+int  DSP_AddFIR( const float32_t *coefs, unsigned ntaps );
+int  DSP_AddBiquad( const float32_t *coefs, unsigned nsections );
+int  DSP_AddFFT( unsigned size );
+int  DSP_Process( const int16_t *in, int16_t *out, unsigned frames );
+int  DSP_GetSpectrum( float32_t *mag, unsigned n );
+void DSP_GetStats( DSP_Stats *s );
+void DSP_ResetStats( void );
+
+#endif // DSP_H
@@ -0,0 +1,897 @@
+/**
+ * @file    i2c-master.c
+ *
+ * @brief   I2C implementation of a master interface for STM32F746
+ *
+ * @note    Simple implementation. Configured to use 16 MHz HSI as clock source
+ *
+ * @note    The are three alternatives for the implementation:
+ *          * Polling
+ *          * Interrupt
+ *          * Direct Memory Access (DMA)
+ *
+ * @note    This module uses DMA for the data and interrupts for the control of
+ *          the transfer. Transactions are queued for each bus, so many devices
+ *          can share it without the CPU waiting. I2CMaster_Write, Read and
+ *          WriteAndRead are blocking versions built on I2CMaster_Submit.
+ * @author  Hans
+ */
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "i2c-master.h"
+#include "gpio.h"
+#include "dma.h"
+
+
+/**
+ *  @brief  Data structure to store information about I2C Configuration
+ */
+typedef struct {
+    I2C_TypeDef             *i2c;
+    GPIO_PinConfiguration   sclpin;
+    GPIO_PinConfiguration   sdapin;
+} I2C_Configuration_t;
+
+
+/**
+ *
+ * @brief I2CCLK frequency
+ *
+ *
+ * @note  I2CCLK Clock is configured in the RCC->DCKCFGR2 register.
+ *        They are I2CxSEL fields, one for each I2C unit
+ *
+ * @note  Clock sources
+ *
+ *  | Source         | I2CxSEL |
+ *  |----------------|---------|
+ *  |  APB1 (PCLK1)  |   00    |
+ *  |  SYSCLK        |   01    |
+ *  |  HSI           |   10    |
+ *
+ * @note Minimal frequencies
+ *
+ * | Mode                | Analog filter |  DNF = 1 |
+ * |---------------------|---------------|----------|
+ * | Standard mode       |    2 MHz      |   2 MHz  |
+ * | Fast mode           |   10 MHz      |   9 MHz  |
+ * | Fast plus mode      |   22.5 MHz    |  16 MHz  |
+ *
+ * OBS: Using HSI (=16 MHz) as filter, it is not possible to use Fast plus mode
+ *
+ * @note  From Table 182 of the STM32F746NG Datasheet
+ *
+ * | Parameter     |  Standard  |   Fast     | Fast Plus  |
+ * |---------------|------------|------------|------------|
+ * |  PRESC        |      3     |       1    |       0    |
+ * |  SCLL         |     0x13   |     0x9    |     0x4    |
+ * |  SCLH         |     0xF    |     0x3    |     0x2    |
+ * |  SDADEL       |     0x2    |     0x2    |     0x0    |
+ * |  SCLDEL       |     0x4    |     0x3    |     0x2    |
+ */
+
+/**
+ * @brief   All timing for 16 MHz (=HSI)
+ *
+ * @note    Generated by STM3CubeMX for a 16 MHz I2CCLK
+ *
+  * @note The timing is set by
+ *       PRESC (31-28:4 bits):   fPRESC = fI2CCLK/(PRESC+1)
+ *       SCLDEL(23-20:4 bits):   tSCLDEL= tPRESC*(SCLDEL+1)
+ *       SDADEL(19-10:4 bits):   tSDADEL= tPRESC*(SDADEL+1)
+ *       SCLH  (15-8:8 bits):    tSCLH = (SCLH+1)*tPRESC
+ *       SCLL  ( 7-0:8 bits):    tSCLL = (SCLL+1)*tPRESC
+ *
+ * @note The restrictions are:
+ *
+ *       SDADEL >= (tfmax+tHDDATmin-tAFmin-(DNF+3)*tI2CCLK)/(PRESC+1)*tI2CCLK
+ *       SDADEL <= (tHDDATmax-fAFmax-(DNF+4)xtI2CCLK)/(PRESC+1)*tI2CCLK
+ *       SCLDEL >= (trmax+tSUDAT,om)/(PRESC+1)*tI2CCLK-1
+ *
+ * @note The I2C standard specifies the following parameters (RM Table 180)
+ *
+ * | Speed    | fSCL | tHDSTA | tSUSTA | tSUSTO | tBUF | tLOW | tHIGH | tf  | tf  |
+ * |----------|------|--------|--------|--------|------|------|-------|-----|-----|
+ * | Standard |  100 |   4    |   4,7  |   4.0  |  4.7 |  4.7 |  4,0  | 1.0 | 0.3 |
+ * | Fast     |  400 |   0.6  |   0.6  |   0.6  |  1.3 |  1.3 |  0.6  | 0.3 | 0.3 |
+ * | Fast plus| 1000 |   0.26 |   0.26 |   0.26 |  0.5 |  0.5 |  0.26 | 0.12| 0.12|
+ *
+ * @note The I2C standard specifies the following parameters (RM Table 178)
+ *
+ *
+ *| Speed     |tHDDATmin|tVDDATmax|tSUDATmin|trmax |tfmax|
+ *|-----------|---------|---------|---------|------|-----|
+ *| Standard  |    0    |   3.45  |  0.250  |  1   | 0.3 |
+ *| Fast      |    0    |   0.9   |  0.100  |  0.3 | 0.3 |
+ *| Fast plus |    0    |   0.45  |  0.050  |  0.12| 0.12|
+ *| SMBUS     |    0.3  |     -   |  0.250  |  1   | 0.3 |
+ *
+ * @note tAF (Maximum pulse width of spikes that are suppressed by the analog
+ *       filter) is defined in the STM32F746NG datasheet
+ *
+ * | Parameter |  Min  |  Max  |
+ * |-----------|-------|-------|
+ * |  tAF (ns) |   50  |  150  |
+ *
+ * @note Table with values for TIMINGR generated by STM32CubeMX
+ *       tr and tf considered 0.
+ *
+ * | Speed     |   None     |   Analog   | Digital=1  | Digital=2  |
+ * |-----------|------------|------------|------------|------------|
+ * |  100 KHz  | 0x00303D5D | 0x00303D5B | 0x00303C5C | 0x00303B5B |
+ * |  400 KHz  | 0x0010071B | 0x0010061A | 0x0010061A | 0x00100519 |
+ * | 1000 KHz  | 0x00000208 | 0x00000107 | 0x00000107 | 0x00000006 |
+ *
+ * @note TIMINGR = 0x00303D5D means
+ *                  PRESC=0   -> fPRESC = fI2CCLK/(PRESC+1)
+ *                  SCLDEL=3
+ *                  SDADEL=3
+ *                  SCLH=3D   = 61
+ *                  SCLL=5D   = 91
+ *
+ * @note Table 182 of RM shows another set of values for a 16 MHz clock.
+ *       It is not clear which kind of filter is beeing used!
+ *
+ * | Speed          | TIMINGR     | PRESC | SCLDEL | SDADEL | SCLH | SCLL |
+ * |----------------|-------------|-------|--------|--------|------|------|
+ * |      100 KHz   | 0x30420F13  |  0x3  |   0x4  |   0x2  | 0x0F | 0x13 |
+ * |      400 KHz   | 0x10320309  |  0x1  |   0x3  |   0x2  | 0x03 | 0x09 |
+ * |     1000 KHz   | 0x00200204  |  0x0  |   0x2  |   0x0  | 0x02 | 0x04 |
+ *
+ */
+
+
+/**
+ * @brief   Configuration for STM32F746G Discovery Boardd
+ *
+ * @note
+ *
+ * |  I2C   |    SCL             |           SDA              |
+ * |--------|--------------------|----------------------------|
+ * |  I2C1  |  PB6 *PB8*         |  PB7 *PB9*                 |
+ * |  I2C2  |  PB10 PF1 PH4      |  PB11 PF0 PH5              |
+ * |  I2C3  |  PA8 *PH7*         |  PC9 *PH8*                 |
+ * |  I2C4  |  PD12 PF14 PH11    |  PD13 PF15 PH12            |
+ *
+ * Only I2C1 and I2C3 in the table above are free to use
+ * I2C1 at PB8 and PB9 used for EXT I2C (Arduino connectors)
+ * I2C3 at PH7 and PH* used for LCD Touch and AUDIO I2C
+ * Other I2C has pin usage conflicts
+ *
+ * @note All SCL and SDA pins must be configured as
+ *                     ALTERNATE FUNCTION (=4)
+ *                     OPEN DRAIN
+ *                     HIGH SPEED
+ *                     PULL-UP
+ */
+static I2C_Configuration_t i2c_configuration[] = {
+    //          SCL            SDA
+    //      GPIO  Pin AF   GPIO  Pin AF
+    { I2C1,
+            {GPIOB,  8, 4, 2, 1, 3, 1}, // SCL
+            {GPIOB,  9, 4, 2, 1, 3, 1}, // SDA
+    },
+    { I2C3,
+            {GPIOH,  7, 4, 2, 1, 3, 1}, // SCL
+            {GPIOH,  8, 4, 2, 1, 3, 1}, // SDA
+    },
+    { 0,
+            {    0,  0, 0, 0, 0, 0, 0}, // SCL
+            {    0,  0, 0, 0, 0, 0, 0}, // SDA
+    }
+};
+
+
+static int I2CMaster_EngineInit( I2C_TypeDef *i2c );
+
+/**
+ *  @brief  ConfigurePins
+ *
+ *  @note   For now, uses GPIO library
+ */
+static int I2CMaster_ConfigurePins( I2C_TypeDef *i2c ) {
+I2C_Configuration_t *p;
+
+    // Lookup configuration information on table
+    p = i2c_configuration;
+    while( p->i2c && (i2c!=p->i2c) ) p++;
+
+    // Not found!!
+    if( ! p->i2c )
+        return -1;
+
+    // Pins not configurable
+    if( (p->sclpin.gpio == 0) || (p->sdapin.gpio == 0) )
+        return -2;
+    // Configure pins when possible
+    GPIO_ConfigureSinglePin(&(p->sclpin));
+    GPIO_ConfigureSinglePin(&(p->sdapin));
+}
+
+
+/**
+ *  @brief  I2CMaster_PeripheralClockEnable
+ *
+ *  @note   Using HSI as I2CCLK clock source (=16 MHz)
+ */
+static void
+I2CMaster_PeripheralClockEnable( I2C_TypeDef *i2c ) {
+
+    // Enable Peripheral Clock
+    if ( i2c == I2C1 ) {
+        RCC->APB1ENR |= RCC_APB1ENR_I2C1EN_Msk;
+    } else if ( i2c == I2C2 ) {
+        RCC->APB1ENR |= RCC_APB1ENR_I2C2EN_Msk;
+    } else if ( i2c == I2C3 ) {
+        RCC->APB1ENR |= RCC_APB1ENR_I2C3EN_Msk;
+    } else if ( i2c == I2C4 ) {
+        RCC->APB1ENR |= RCC_APB1ENR_I2C4EN_Msk;
+    }
+
+}
+
+/**
+ *  @brief  I2CMaster_PeripheralClockEnable
+ *
+ *  @note   Using HSI as I2CCLK clock source (=16 MHz)
+ */
+#define I2CLKSRC (2)
+
+
+static void
+I2CMaster_I2CClockEnable( I2C_TypeDef *i2c ) {
+
+    // Enable I2C clocks
+    if ( i2c == I2C1 ) {
+        RCC->DCKCFGR2 =  (RCC->DCKCFGR2&~(3<<RCC_DCKCFGR2_I2C1SEL_Pos))
+                        |(I2CLKSRC<<RCC_DCKCFGR2_I2C1SEL_Pos);
+    } else if ( i2c == I2C2 ) {
+        RCC->DCKCFGR2 =  (RCC->DCKCFGR2&~(3<<RCC_DCKCFGR2_I2C2SEL_Pos))
+                        |(I2CLKSRC<<RCC_DCKCFGR2_I2C2SEL_Pos);
+    } else if ( i2c == I2C3 ) {
+        RCC->DCKCFGR2 =  (RCC->DCKCFGR2&~(3<<RCC_DCKCFGR2_I2C3SEL_Pos))
+                        |(I2CLKSRC<<RCC_DCKCFGR2_I2C3SEL_Pos);
+    } else if ( i2c == I2C4 ) {
+        RCC->DCKCFGR2 =  (RCC->DCKCFGR2&~(3<<RCC_DCKCFGR2_I2C4SEL_Pos))
+                        |(I2CLKSRC<<RCC_DCKCFGR2_I2C4SEL_Pos);
+    }
+
+}
+
+/**
+ *  @brief  I2CMaster_Reset
+ *
+ *  @note   Reset I2C using the SWRST pin on the APB1RSTR
+ *
+ *  @note   There is another way to reset it by using the PE=0, PE=1
+ *          sequence as describe in RM 30.4.4: "A software reset can be
+ *          performed by clearing the PE bit in the I2C_CR1 register"
+ *
+ */
+static void I2CMaster_Reset( I2C_TypeDef *i2c ) {
+uint32_t mask;
+
+    if ( i2c == I2C1 ) {
+        mask =  RCC_APB1RSTR_I2C1RST;
+    } else if ( i2c == I2C2 ) {
+        mask =  RCC_APB1RSTR_I2C2RST;
+    } else if ( i2c == I2C3 ) {
+        mask =  RCC_APB1RSTR_I2C3RST;
+    } else if ( i2c == I2C4 ) {
+        mask =  RCC_APB1RSTR_I2C4RST;
+    }
+    // Set reset pin
+    RCC->APB1RSTR |=  mask;
+    // Clear reset pin
+    RCC->APB1RSTR &= ~mask;
+
+}
+
+
+
+/**
+ *  @brief  I2CMaster_Disable
+ *
+ *  @note   Disable I2C and at the same time, reset it
+ *          See RM 30.4.4
+ *
+ *  @note   When cleared, PE must be kept low for at
+ *          least 3 APB clock cycles. (RM Section 30.7.1)
+ *
+ *  @note   This is ensured by writing the following software sequence:
+ *           - Write PE=0
+ *           - Check PE=0
+ *           - Write PE=0
+ *          (RM Section 30.4.5)
+ */
+static void I2CMaster_Disable( I2C_TypeDef *i2c ) {
+
+    // Turn off device (Three times, see Note in RM Section 30.7.1 */
+    i2c->CR1 &= ~I2C_CR1_PE;
+    i2c->CR1 &= ~I2C_CR1_PE;
+    i2c->CR1 &= ~I2C_CR1_PE;
+}
+
+/**
+ *  @brief  I2CMaster_Init
+ *
+ *  @note   Initializes I2C and configure it
+ *
+ *  @note   It only accepts one of the filters: None, Analog or Digital.
+ */
+int
+I2CMaster_Init( I2C_TypeDef *i2c, uint32_t conf, uint32_t timing) {
+int index;
+
+    // In the example in CubeF7, there is a 200 ms delay here
+
+    // Enable peripheral clock to use registers
+    I2CMaster_PeripheralClockEnable(i2c);
+
+    // Disable I2C (It resets too)
+    I2CMaster_Disable(i2c);
+
+    // Configure pins
+    I2CMaster_ConfigurePins(i2c);
+
+    // Configure filters
+    if( (conf&I2C_CONF_FILTER_NONE)!=0 ) {
+        // Using no filter
+        i2c->CR1 |= I2C_CR1_ANFOFF;                 // Turn off analog filter
+        i2c->CR1 = (i2c->CR1&~(I2C_CR1_DNF_Msk));   // Turn off digital filter
+        index = 0;
+    } else if( (conf&I2C_CONF_FILTER_ANALOG)!=0 )  {
+        // Using analog filter
+        i2c->CR1 &= ~I2C_CR1_ANFOFF;                // Turn on analog filter
+        i2c->CR1 = (i2c->CR1&~(I2C_CR1_DNF_Msk));   // Turn off digital filter
+        index = 1;
+    } else if( (conf&I2C_CONF_FILTER_DIGITAL_MASK)!=0 ) {
+        i2c->CR1 |= I2C_CR1_ANFOFF;                 // Turn off analog filter
+        // Using digital filter
+        uint32_t dnf = (conf&I2C_CONF_FILTER_DIGITAL_MASK)>>I2C_CONF_FILTER_DIGITAL_Pos;
+        // Limit dnf to 2
+        if( dnf > 2 ) dnf = 2;
+        i2c->CR1 = (i2c->CR1&~(I2C_CR1_DNF_Msk))|(dnf<<I2C_CR1_DNF_Pos);
+    }
+
+    i2c->TIMINGR = timing;
+
+
+    // Turn Peripheral Clock for the I2C interface
+    I2CMaster_I2CClockEnable(i2c);
+
+    // Turn on device. Three times, just in case. See above */
+    i2c->CR1 |= I2C_CR1_PE;
+    i2c->CR1 |= I2C_CR1_PE;
+    i2c->CR1 |= I2C_CR1_PE;
+
+    // Interrupts and DMA for the transaction queue
+    return I2CMaster_EngineInit(i2c);
+}
+
+/**
+ * @brief  Transaction engine
+ *
+ * @note   Each bus has a queue of transactions. The first one is being
+ *         transferred and the others wait for it. A transaction is an optional
+ *         write phase and an optional read phase, joined by a repeated start.
+ *
+ *          SAAAAAAAW*DDDDDDDD*...*DDDDDDDD*SAAAAAAAR*DDDDDDDD*...DDDDDDDD*P
+ *
+ * @note   Data phases are done by DMA. The event interrupt drives the rest:
+ *         - TCR: more than 255 bytes: NBYTES is reloaded with the next chunk
+ *         - TC:  write phase done: the read phase starts with a repeated start
+ *         - STOPF: transaction done: the callback is called and the next
+ *           transaction is started
+ *         - NACKF: slave did not acknowledge: STOP and failure
+ *
+ * @note   The DMA1 streams are allocated by dma.c. When they are free, all
+ *         four buses get the streams below and can work at the same time
+ *
+ *          | I2C   | RX Stream/Channel | TX Stream/Channel |
+ *          |-------|-------------------|-------------------|
+ *          | I2C1  |       0 / 1       |       6 / 1       |
+ *          | I2C2  |       3 / 7       |       7 / 7       |
+ *          | I2C3  |       1 / 1       |       4 / 3       |
+ *          | I2C4  |       2 / 2       |       5 / 2       |
+ *
+ * @note   The data cache is cleaned over the write buffer and invalidated over
+ *         the read buffer. Read buffers should be aligned and padded to 32
+ *         bytes (cache line), so that no other data share their lines.
+ *
+ * @note   Timeouts are counted by I2CMaster_ProcessTimeouts, that must be
+ *         called every ms (e.g. from SysTick_Handler). A transaction that
+ *         does not finish in I2C_TIMEOUT_MS is aborted, the I2C is reset and
+ *         the next transaction is started.
+ */
+///@{
+typedef struct {
+    I2C_TypeDef             *i2c;
+    int                     rxrequest;      // DMA_REQ_*
+    int                     txrequest;
+    IRQn_Type               evirq;
+    IRQn_Type               erirq;
+} I2C_DMAConfiguration_t;
+
+static const I2C_DMAConfiguration_t i2c_dmaconfiguration[] = {
+    { I2C1, DMA_REQ_I2C1_RX, DMA_REQ_I2C1_TX, I2C1_EV_IRQn, I2C1_ER_IRQn },
+    { I2C2, DMA_REQ_I2C2_RX, DMA_REQ_I2C2_TX, I2C2_EV_IRQn, I2C2_ER_IRQn },
+    { I2C3, DMA_REQ_I2C3_RX, DMA_REQ_I2C3_TX, I2C3_EV_IRQn, I2C3_ER_IRQn },
+    { I2C4, DMA_REQ_I2C4_RX, DMA_REQ_I2C4_TX, I2C4_EV_IRQn, I2C4_ER_IRQn },
+};
+#define I2C_NBUSES (sizeof(i2c_dmaconfiguration)/sizeof(i2c_dmaconfiguration[0]))
+
+#define PHASE_IDLE                      0
+#define PHASE_WRITE                     1
+#define PHASE_READ                      2
+
+typedef struct {
+    I2C_Transaction         *first;         // being transferred
+    I2C_Transaction         *last;
+    int                     phase;
+    uint32_t                remaining;      // bytes of the phase not in NBYTES yet
+    int                     error;
+    volatile uint32_t       timer;          // ms left for the transaction
+    int                     dmaready;       // streams allocated
+    int                     rxdma;          // DMA stream handles
+    int                     txdma;
+} I2C_Bus_t;
+
+static I2C_Bus_t            i2c_bus[I2C_NBUSES];
+///@}
+
+/**
+ * @brief  Find bus index for a specific I2C
+ */
+static int FindBus( I2C_TypeDef *i2c ) {
+unsigned k;
+
+    for(k=0;k<I2C_NBUSES;k++) {
+        if( i2c_dmaconfiguration[k].i2c == i2c )
+            return k;
+    }
+    return -1;
+}
+
+/**
+ * @brief  Cache maintenance over whole lines
+ */
+///@{
+static void CleanBuffer( const uint8_t *p, uint32_t n ) {
+uint32_t a = (uint32_t) p&~31U;
+
+    SCB_CleanDCache_by_Addr((uint32_t *) a,(((uint32_t) p+n+31)&~31U)-a);
+}
+
+static void CleanInvalidateBuffer( uint8_t *p, uint32_t n ) {
+uint32_t a = (uint32_t) p&~31U;
+
+    SCB_CleanInvalidateDCache_by_Addr((uint32_t *) a,(((uint32_t) p+n+31)&~31U)-a);
+}
+
+static void InvalidateBuffer( uint8_t *p, uint32_t n ) {
+uint32_t a = (uint32_t) p&~31U;
+
+    SCB_InvalidateDCache_by_Addr((uint32_t *) a,(((uint32_t) p+n+31)&~31U)-a);
+}
+///@}
+
+/**
+ * @brief  Start the write (read=0) or read (read=1) phase of the first transaction
+ *
+ * @note   Writing CR2 with START generates a start or a repeated start
+ */
+static void StartPhase( int k, int read ) {
+const I2C_DMAConfiguration_t *c = &i2c_dmaconfiguration[k];
+I2C_Bus_t *bus = &i2c_bus[k];
+I2C_Transaction *t = bus->first;
+I2C_TypeDef *i2c = c->i2c;
+uint32_t n,chunk,cr2;
+
+    n = read ? t->nrx : t->ntx;
+    chunk = n > 255 ? 255 : n;
+    bus->remaining = n-chunk;
+    bus->phase = read ? PHASE_READ : PHASE_WRITE;
+
+    cr2 = ((t->addr<<1)&I2C_CR2_SADD_Msk)
+         |(chunk<<I2C_CR2_NBYTES_Pos)
+         |I2C_CR2_START;
+    if( read )
+        cr2 |= I2C_CR2_RD_WRN;
+    if( bus->remaining )
+        cr2 |= I2C_CR2_RELOAD;
+    else if( read || t->nrx == 0 )
+        cr2 |= I2C_CR2_AUTOEND;
+
+    i2c->CR1 &= ~(I2C_CR1_TXDMAEN|I2C_CR1_RXDMAEN);
+    if( n > 0 ) {
+        if( read ) {
+            DMA_Start(bus->rxdma,t->rxdata,0,n);
+            i2c->CR1 |= I2C_CR1_RXDMAEN;
+        } else {
+            DMA_Start(bus->txdma,t->txdata,0,n);
+            i2c->CR1 |= I2C_CR1_TXDMAEN;
+        }
+    }
+    i2c->CR2 = cr2;
+}
+
+/**
+ * @brief  Start the first transaction of the queue
+ */
+static void StartTransaction( int k ) {
+I2C_Bus_t *bus = &i2c_bus[k];
+I2C_Transaction *t = bus->first;
+
+    bus->error = 0;
+    bus->timer = I2C_TIMEOUT_MS;
+    if( t->ntx )
+        CleanBuffer(t->txdata,t->ntx);
+    if( t->nrx )
+        CleanInvalidateBuffer(t->rxdata,t->nrx);
+    i2c_dmaconfiguration[k].i2c->ICR = I2C_ICR_NACKCF|I2C_ICR_STOPCF
+                                      |I2C_ICR_BERRCF|I2C_ICR_ARLOCF|I2C_ICR_OVRCF;
+    StartPhase(k,t->ntx == 0 && t->nrx > 0);
+}
+
+/**
+ * @brief  Finish the first transaction with status and start the next one
+ *
+ * @note   Called from the interrupts
+ */
+static void CompleteTransaction( int k, int status ) {
+const I2C_DMAConfiguration_t *c = &i2c_dmaconfiguration[k];
+I2C_Bus_t *bus = &i2c_bus[k];
+I2C_Transaction *t = bus->first;
+
+    c->i2c->CR1 &= ~(I2C_CR1_TXDMAEN|I2C_CR1_RXDMAEN);
+    DMA_Stop(bus->rxdma);
+    DMA_Stop(bus->txdma);
+    bus->phase = PHASE_IDLE;
+    if( !t )
+        return;
+
+    if( t->nrx )
+        InvalidateBuffer(t->rxdata,t->nrx);
+
+    bus->first = t->next;
+    if( !bus->first )
+        bus->last = 0;
+    else
+        StartTransaction(k);
+
+    t->status = status;
+    if( t->callback )
+        t->callback(t->arg,status);
+}
+
+/**
+ * @brief  Abort the first transaction, resetting the I2C state machine
+ *
+ * @note   PE=0 releases the bus. See I2CMaster_Disable
+ */
+static void AbortTransaction( int k, int status ) {
+I2C_TypeDef *i2c = i2c_dmaconfiguration[k].i2c;
+
+    i2c->CR1 &= ~I2C_CR1_PE;
+    i2c->CR1 &= ~I2C_CR1_PE;
+    i2c->CR1 &= ~I2C_CR1_PE;
+    i2c->CR1 |= I2C_CR1_PE;
+    CompleteTransaction(k,status);
+}
+
+/**
+ * @brief  Enable interrupts and DMA for a bus. Called by I2CMaster_Init
+ *
+ * @note   The DMA streams are allocated once and kept when the bus is
+ *         initialized again. Bytes, direct mode, no DMA interrupts (the I2C
+ *         interrupts tell when a phase ends)
+ */
+static int I2CMaster_EngineInit( I2C_TypeDef *i2c ) {
+const I2C_DMAConfiguration_t *c;
+I2C_Bus_t *bus;
+DMA_Config dc;
+int k;
+
+    k = FindBus(i2c);
+    if( k < 0 )
+        return -1;
+    c   = &i2c_dmaconfiguration[k];
+    bus = &i2c_bus[k];
+
+    if( !bus->dmaready ) {
+        bus->rxdma = DMA_Allocate(c->rxrequest);
+        if( bus->rxdma < 0 )
+            return bus->rxdma;
+        bus->txdma = DMA_Allocate(c->txrequest);
+        if( bus->txdma < 0 ) {
+            DMA_Free(bus->rxdma);
+            return bus->txdma;
+        }
+        bus->dmaready = 1;
+    }
+    dc.psize    = DMA_SIZE_8;
+    dc.msize    = DMA_SIZE_8;
+    dc.burst    = DMA_BURST_SINGLE;
+    dc.priority = 1;
+    dc.flags    = DMA_FLAG_MINC;
+    dc.callback = 0;
+    dc.arg      = 0;
+    dc.dir      = DMA_DIR_P2M;
+    dc.periph   = &(i2c->RXDR);
+    DMA_Configure(bus->rxdma,&dc);
+    dc.dir      = DMA_DIR_M2P;
+    dc.periph   = &(i2c->TXDR);
+    DMA_Configure(bus->txdma,&dc);
+
+    i2c_bus[k].first = i2c_bus[k].last = 0;
+    i2c_bus[k].phase = PHASE_IDLE;
+
+    i2c->CR1 |= I2C_CR1_TCIE|I2C_CR1_STOPIE|I2C_CR1_NACKIE|I2C_CR1_ERRIE;
+
+    NVIC_SetPriority(c->evirq,I2C_IRQ_PRIO);
+    NVIC_SetPriority(c->erirq,I2C_IRQ_PRIO);
+    NVIC_EnableIRQ(c->evirq);
+    NVIC_EnableIRQ(c->erirq);
+    return 0;
+}
+
+/**
+ * @brief  I2CMaster_Submit
+ *
+ * @note   Appends a transaction to the queue of the bus. It is started at once
+ *         when the bus is idle. The transaction (and its buffers) must not be
+ *         changed until its status is not I2C_TRANSACTION_PENDING
+ *
+ * @note   Can be called from interrupts, including completion callbacks
+ *
+ * @return 0 if queued, negative for invalid parameters
+ */
+int
+I2CMaster_Submit( I2C_TypeDef *i2c, I2C_Transaction *t ) {
+uint32_t primask;
+int k;
+
+    k = FindBus(i2c);
+    if( k < 0 || (t->ntx && !t->txdata) || (t->nrx && !t->rxdata) )
+        return -1;
+
+    t->status = I2C_TRANSACTION_PENDING;
+    t->next   = 0;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if( i2c_bus[k].last )
+        i2c_bus[k].last->next = t;
+    else
+        i2c_bus[k].first = t;
+    i2c_bus[k].last = t;
+    if( i2c_bus[k].phase == PHASE_IDLE )
+        StartTransaction(k);
+    __set_PRIMASK(primask);
+
+    return 0;
+}
+
+/**
+ * @brief  I2CMaster_ProcessTimeouts
+ *
+ * @note   Must be called every ms
+ */
+void
+I2CMaster_ProcessTimeouts( void ) {
+uint32_t primask;
+unsigned k;
+
+    for(k=0;k<I2C_NBUSES;k++) {
+        if( i2c_bus[k].phase == PHASE_IDLE )
+            continue;
+        primask = __get_PRIMASK();
+        __disable_irq();
+        if( i2c_bus[k].phase != PHASE_IDLE && --i2c_bus[k].timer == 0 )
+            AbortTransaction(k,I2C_TRANSACTION_TIMEOUT);
+        __set_PRIMASK(primask);
+    }
+}
+
+/**
+ * @brief Process I2C Event Interrupt
+ */
+void
+I2CMaster_ProcessEvent( I2C_TypeDef *i2c ) {
+I2C_Bus_t *bus;
+I2C_Transaction *t;
+uint32_t isr,chunk,cr2;
+int k;
+
+    k = FindBus(i2c);
+    if( k < 0 )
+        return;
+    bus = &i2c_bus[k];
+    t   = bus->first;
+    isr = i2c->ISR;
+
+    if( isr&I2C_ISR_NACKF ) {
+        // Without AUTOEND, the STOP must be generated by software
+        i2c->ICR = I2C_ICR_NACKCF;
+        bus->error = I2C_TRANSACTION_NACK;
+        if( (i2c->CR2&I2C_CR2_AUTOEND) == 0 )
+            i2c->CR2 |= I2C_CR2_STOP;
+    }
+
+    if( (isr&I2C_ISR_TCR) && t ) {
+        // Next chunk of the phase. The last one ends with AUTOEND or TC
+        chunk = bus->remaining > 255 ? 255 : bus->remaining;
+        bus->remaining -= chunk;
+        cr2 = (i2c->CR2&~(I2C_CR2_NBYTES_Msk|I2C_CR2_RELOAD|I2C_CR2_AUTOEND))
+             |(chunk<<I2C_CR2_NBYTES_Pos);
+        if( bus->remaining )
+            cr2 |= I2C_CR2_RELOAD;
+        else if( bus->phase == PHASE_READ || t->nrx == 0 )
+            cr2 |= I2C_CR2_AUTOEND;
+        i2c->CR2 = cr2;
+    }
+
+    if( (isr&I2C_ISR_TC) && t ) {
+        if( bus->phase == PHASE_WRITE && t->nrx > 0 && !bus->error )
+            StartPhase(k,1);
+        else
+            i2c->CR2 |= I2C_CR2_STOP;
+    }
+
+    if( isr&I2C_ISR_STOPF ) {
+        i2c->ICR = I2C_ICR_STOPCF;
+        if( bus->phase != PHASE_IDLE )
+            CompleteTransaction(k,bus->error);
+    }
+}
+
+/**
+ * @brief Process I2C Error Interrupt
+ *
+ * @note  After a bus error or an arbitration loss, the I2C releases the bus and
+ *        no STOPF is generated. The transaction is aborted.
+ */
+void
+I2CMaster_ProcessError( I2C_TypeDef *i2c ) {
+uint32_t isr;
+int k;
+
+    k = FindBus(i2c);
+    if( k < 0 )
+        return;
+    isr = i2c->ISR;
+    i2c->ICR = I2C_ICR_BERRCF|I2C_ICR_ARLOCF|I2C_ICR_OVRCF;
+
+    if( i2c_bus[k].phase == PHASE_IDLE )
+        return;
+    if( isr&I2C_ISR_ARLO )
+        AbortTransaction(k,I2C_TRANSACTION_ARLO);
+    else if( isr&(I2C_ISR_BERR|I2C_ISR_OVR) )
+        AbortTransaction(k,I2C_TRANSACTION_BUSERROR);
+}
+
+#ifndef I2C_DONT_IMPLEMENT_IRQ
+/**
+ * @brief I2C Event and Error interrupts
+ */
+///@{
+void I2C1_EV_IRQHandler(void) {
+
+    I2CMaster_ProcessEvent(I2C1);
+}
+
+void I2C1_ER_IRQHandler(void) {
+
+    I2CMaster_ProcessError(I2C1);
+}
+
+void I2C2_EV_IRQHandler(void) {
+
+    I2CMaster_ProcessEvent(I2C2);
+}
+
+void I2C2_ER_IRQHandler(void) {
+
+    I2CMaster_ProcessError(I2C2);
+}
+
+void I2C3_EV_IRQHandler(void) {
+
+    I2CMaster_ProcessEvent(I2C3);
+}
+
+void I2C3_ER_IRQHandler(void) {
+
+    I2CMaster_ProcessError(I2C3);
+}
+
+void I2C4_EV_IRQHandler(void) {
+
+    I2CMaster_ProcessEvent(I2C4);
+}
+
+void I2C4_ER_IRQHandler(void) {
+
+    I2CMaster_ProcessError(I2C4);
+}
+///@}
+#endif
+
+/**
+ * @brief  Transfer
+ *
+ * @note   Queues a transaction and waits for it. It must not be called from an
+ *         interrupt with priority equal or higher than I2C_IRQ_PRIO
+ */
+static int
+I2CMaster_Transfer( I2C_TypeDef *i2c, uint16_t addr, uint8_t *txdata, uint16_t ntx,
+                    uint8_t *rxdata, uint16_t nrx ) {
+I2C_Transaction t;
+int rc;
+
+    t.addr     = addr;
+    t.txdata   = txdata;
+    t.ntx      = ntx;
+    t.rxdata   = rxdata;
+    t.nrx      = nrx;
+    t.callback = 0;
+    t.arg      = 0;
+    rc = I2CMaster_Submit(i2c,&t);
+    if( rc < 0 )
+        return rc;
+    while( t.status == I2C_TRANSACTION_PENDING ) {}
+    return t.status;
+}
+
+/**
+ * @brief I2CMaster_Write
+ *
+ * @note  Send the *n* bytes in the *data array* to slave *addr* and waits
+ *
+ * @param i2c
+ * @param address (7 bit)
+ * @param data
+ * @param n
+ * @return int: 0 if OK, negative (I2C_TRANSACTION_*) for error
+ */
+int
+I2CMaster_Write( I2C_TypeDef *i2c, uint16_t addr, uint8_t *data, uint16_t nbytes) {
+
+    return I2CMaster_Transfer(i2c,addr,data,nbytes,0,0);
+}
+
+/**
+ * @brief I2CMaster_Read
+ *
+ * @note  Read *n* bytes into the *data array* from slave *addr* and waits
+ *
+ * @param i2c
+ * @param address (7 bit)
+ * @param data
+ * @param n
+ * @return int: 0 if OK, negative (I2C_TRANSACTION_*) for error
+ */
+int
+I2CMaster_Read( I2C_TypeDef *i2c, uint16_t addr, uint8_t *data, uint16_t nbytes) {
+
+    return I2CMaster_Transfer(i2c,addr,0,0,data,nbytes);
+}
+
+/**
+ * @brief I2CMaster_WriteAndRead
+ *
+ * @note  Write *nwrite* bytes and, after a repeated start, read *nread* bytes
+ *
+ * @return int: 0 if OK, negative (I2C_TRANSACTION_*) for error
+ */
+int
+I2CMaster_WriteAndRead( I2C_TypeDef *i2c, uint16_t addr,
+                        uint8_t *writedata, int nwrite,
+                        uint8_t *readdata,  int nread ) {
+
+    if( nwrite < 0 || nwrite > 65535 || nread < 0 || nread > 65535 )
+        return -1;
+    return I2CMaster_Transfer(i2c,addr,writedata,nwrite,readdata,nread);
+}
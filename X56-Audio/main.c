@@ -0,0 +1,382 @@
+/**
+ * @file     main.c
+ * @brief    Audio thru SAI2 and the WM8994 codec
+ * @version  V1.0
+ * @date     15/10/2026
+ *
+ * @note     The line input (LINE IN jack) is copied to the headphone output
+ *           (OUT jack) at 48 kHz. With AUDIO_TONE (Makefile), a 1 kHz tone is
+ *           played instead
+ *
+ * @note     Every second, the latency and the time of the callback are
+ *           printed thru the UART
+ *
+ * @note     With AUDIO_DSP (Makefile), the output goes thru a 100 Hz high-pass
+ *           biquad and a 4 kHz low-pass FIR, and a 1024 point FFT finds the
+ *           strongest frequency. The cycles per sample of each stage are
+ *           printed too
+ *
+ * @note     With AUDIO_USB (Makefile), the board is a USB audio interface on
+ *           the USB FS port: the host plays to the OUT jack and records the
+ *           LINE IN jack. The packet counts, the feedback and the latency in
+ *           the device are printed instead
+ *
+ * @note     With AUDIO_MIXER (Makefile), the line input is a voice of the
+ *           mixer, with two tones at 48 and 32 kHz and a third one at 22.05 kHz
+ *           that is started and stopped every second. The cycles of the mixer
+ *           are printed too
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "led.h"
+#include "i2c-master.h"
+#include "audio.h"
+#ifdef AUDIO_USB
+#include "usbaudio.h"
+#endif
+#ifdef AUDIO_DSP
+#include "dsp.h"
+#endif
+#ifdef AUDIO_MIXER
+#include "mixer.h"
+#endif
+
+/**
+ * @brief   Audio parameters
+ */
+///@{
+#define FREQUENCY           (48000)
+#define VOLUME              (70)
+///@}
+
+/**
+ * @brief   Systick routine
+ *
+ * @note    It is called every 1ms. It counts the I2C timeouts
+ */
+static volatile uint32_t tick_ms = 0;
+
+void SysTick_Handler(void) {
+
+    tick_ms++;
+    I2CMaster_ProcessTimeouts();
+}
+
+#ifdef AUDIO_DSP
+#if AUDIO_BLOCKFRAMES > DSP_MAXFRAMES
+#error "AUDIO_BLOCKFRAMES must not be greater than DSP_MAXFRAMES"
+#endif
+
+/**
+ * @brief   High-pass Butterworth at 100 Hz for 48 kHz {b0,b1,b2,-a1,-a2}
+ */
+static const float32_t highpass[5] = {
+    0.99078670f, -1.98157340f,  0.99078670f,  1.98148851f, -0.98165828f
+};
+
+/**
+ * @brief   Low-pass FIR at 4 kHz for 48 kHz (31 taps, Hamming window)
+ */
+static const float32_t lowpass[31] = {
+    0.00169225f,  0.00176751f,  0.00146163f,  0.00000000f, -0.00334892f,
+   -0.00851838f, -0.01402633f, -0.01689652f, -0.01332832f,  0.00000000f,
+    0.02443181f,  0.05824102f,  0.09647368f,  0.13192928f,  0.15705336f,
+    0.16613590f,  0.15705336f,  0.13192928f,  0.09647368f,  0.05824102f,
+    0.02443181f,  0.00000000f, -0.01332832f, -0.01689652f, -0.01402633f,
+   -0.00851838f, -0.00334892f,  0.00000000f,  0.00146163f,  0.00176751f,
+    0.00169225f
+};
+
+#define FFTSIZE             (1024)
+
+static float32_t spectrum[FFTSIZE/2];
+
+/**
+ * @brief   Configure the DSP chain
+ */
+static int ConfigDSP( void ) {
+
+    DSP_Init();
+    if( DSP_AddBiquad(highpass,1) < 0 )
+        return -1;
+    if( DSP_AddFIR(lowpass,sizeof(lowpass)/sizeof(lowpass[0])) < 0 )
+        return -1;
+    if( DSP_AddFFT(FFTSIZE) < 0 )
+        return -1;
+    return 0;
+}
+
+/**
+ * @brief   Print the time of the stages and the strongest frequency
+ */
+static void PrintDSP( void ) {
+static const char *names[] = { "chain", "fir", "biquad", "fft" };
+DSP_Stats s;
+unsigned k,peak;
+int n;
+
+    DSP_GetStats(&s);
+    for(k=0;k<s.nstages;k++) {
+        printf("  %-6s %5lu cycles (max %5lu) %lu.%02lu cycles/sample\n",
+                names[s.stage[k].type],
+                (unsigned long) s.stage[k].cycles,(unsigned long) s.stage[k].maxcycles,
+                (unsigned long) s.stage[k].cps100/100,(unsigned long) s.stage[k].cps100%100);
+    }
+    printf("  %-6s %5lu cycles (max %5lu) %lu.%02lu cycles/sample\n",
+            names[0],
+            (unsigned long) s.chain.cycles,(unsigned long) s.chain.maxcycles,
+            (unsigned long) s.chain.cps100/100,(unsigned long) s.chain.cps100%100);
+
+    n = DSP_GetSpectrum(spectrum,FFTSIZE/2);
+    if( n <= 0 )
+        return;
+    peak = 1;
+    for(k=2;k<(unsigned) n;k++) {
+        if( spectrum[k] > spectrum[peak] )
+            peak = k;
+    }
+    printf("  peak %u Hz\n",(peak*FREQUENCY)/FFTSIZE);
+}
+#endif
+
+#if (defined(AUDIO_TONE) || defined(AUDIO_MIXER)) && !defined(AUDIO_USB)
+/**
+ * @brief   One period of a 1 kHz sine at 48 kHz (-12 dB)
+ */
+static const int16_t sinetab[48] = {
+         0,   1069,   2120,   3135,   4096,   4987,   5793,   6499,
+      7094,   7568,   7913,   8122,   8192,   8122,   7913,   7568,
+      7094,   6499,   5793,   4987,   4096,   3135,   2120,   1069,
+         0,  -1069,  -2120,  -3135,  -4096,  -4987,  -5793,  -6499,
+     -7094,  -7568,  -7913,  -8122,  -8192,  -8122,  -7913,  -7568,
+     -7094,  -6499,  -5793,  -4987,  -4096,  -3135,  -2120,  -1069,
+};
+#endif
+
+#if defined(AUDIO_MIXER) && !defined(AUDIO_USB)
+#if AUDIO_BLOCKFRAMES > MIXER_MAXFRAMES
+#error "AUDIO_BLOCKFRAMES must not be greater than MIXER_MAXFRAMES"
+#endif
+
+/**
+ * @brief   Voices of the mixer
+ */
+///@{
+#define VOICE_LINEIN        (0)
+#define VOICE_TONE1K        (1)
+#define VOICE_TONE667       (2)
+#define VOICE_TONE459       (3)
+#define SINEFRAMES          (sizeof(sinetab)/sizeof(sinetab[0]))
+///@}
+
+static const int16_t *linein = 0;
+
+/**
+ * @brief   Source of the line input voice: the input block of the callback
+ */
+static unsigned LineIn( int16_t *buf, unsigned frames, void *arg ) {
+unsigned i;
+
+    (void) arg;
+    if( linein == 0 )
+        return 0;
+    for(i=0;i<frames*AUDIO_CHANNELS;i++)
+        buf[i] = linein[i];
+    return frames;
+}
+
+/**
+ * @brief   Mix the voices to the output (thru the DSP chain with AUDIO_DSP)
+ */
+static void Mix( const int16_t *in, int16_t *out, unsigned frames, void *arg ) {
+
+    (void) arg;
+    linein = in;
+    Mixer_Process(out,frames,MIXER_REPLACE);
+    linein = 0;
+#ifdef AUDIO_DSP
+    DSP_Process(out,out,frames);
+#endif
+}
+
+/**
+ * @brief   Start the voices
+ */
+static int ConfigMixer( void ) {
+
+    if( Mixer_Init(FREQUENCY) < 0 )
+        return -1;
+    Mixer_SetGain(VOICE_LINEIN,MIXER_UNITY/2,MIXER_UNITY/2);
+    Mixer_SetGain(VOICE_TONE1K,MIXER_UNITY/2,0);
+    Mixer_SetGain(VOICE_TONE667,0,MIXER_UNITY/2);
+    Mixer_SetGain(VOICE_TONE459,MIXER_UNITY/4,MIXER_UNITY/4);
+    if( Mixer_Stream(VOICE_LINEIN,LineIn,0,FREQUENCY) < 0 )
+        return -1;
+    if( Mixer_Play(VOICE_TONE1K,sinetab,SINEFRAMES,1,48000,MIXER_LOOP) < 0 )
+        return -1;
+    if( Mixer_Play(VOICE_TONE667,sinetab,SINEFRAMES,1,32000,MIXER_LOOP) < 0 )
+        return -1;
+    return 0;
+}
+
+/**
+ * @brief   Toggle the third tone and print the cycles of the mixer
+ */
+static void PrintMixer( void ) {
+Mixer_Stats m;
+
+    if( Mixer_IsPlaying(VOICE_TONE459) )
+        Mixer_Stop(VOICE_TONE459);
+    else
+        Mixer_Play(VOICE_TONE459,sinetab,SINEFRAMES,1,22050,MIXER_LOOP);
+
+    Mixer_GetStats(&m);
+    printf("  mixer  %u voices %5lu cycles (max %5lu) src %lu mix %lu %lu.%02lu cycles/frame underruns %u\n",
+            m.voices,(unsigned long) m.cycles,(unsigned long) m.maxcycles,
+            (unsigned long) m.srccycles,(unsigned long) m.mixcycles,
+            (unsigned long) m.cpf100/100,(unsigned long) m.cpf100%100,
+            m.underruns);
+    Mixer_ResetStats();
+}
+#elif defined(AUDIO_TONE) && !defined(AUDIO_USB)
+static void Tone( const int16_t *in, int16_t *out, unsigned frames, void *arg ) {
+static unsigned phase = 0;
+unsigned i;
+
+    (void) in;
+    (void) arg;
+    for(i=0;i<frames;i++) {
+        out[2*i]   = sinetab[phase];
+        out[2*i+1] = sinetab[phase];
+        if( ++phase == sizeof(sinetab)/sizeof(sinetab[0]) )
+            phase = 0;
+    }
+#ifdef AUDIO_DSP
+    DSP_Process(out,out,frames);
+#endif
+}
+#elif !defined(AUDIO_USB)
+/**
+ * @brief   Copy the input to the output (thru the DSP chain with AUDIO_DSP)
+ */
+static void Loopback( const int16_t *in, int16_t *out, unsigned frames, void *arg ) {
+#ifdef AUDIO_DSP
+
+    (void) arg;
+    DSP_Process(in,out,frames);
+#else
+unsigned i;
+
+    (void) arg;
+    for(i=0;i<frames*AUDIO_CHANNELS;i++)
+        out[i] = in[i];
+#endif
+}
+#endif
+
+/**
+ * @brief   main
+ */
+int main(void) {
+#ifdef AUDIO_USB
+UsbAudio_Stats u;
+#else
+Audio_Stats s;
+#endif
+uint32_t last;
+int rc;
+
+    /* configure clock to 200 MHz */
+    SystemSetCoreClock(CLOCKSRC_PLL,1);
+
+    SysTick_Config(SystemCoreClock/1000);
+
+    LED_Init();
+
+    printf("\nAudio: %u Hz, %u frames per block\n",FREQUENCY,AUDIO_BLOCKFRAMES);
+
+#ifdef AUDIO_USB
+    // OTG_FS needs 48 MHz from PLLSAI
+    SystemConfigPLLSAI(&PLLSAIConfiguration_48MHz);
+    rc = Audio_Init(FREQUENCY,AUDIO_OUTPUT|AUDIO_INPUT,VOLUME);
+    if( rc == AUDIO_OK )
+        rc = UsbAudio_Init();
+    if( rc != AUDIO_OK ) {
+        printf("USB audio: error %d\n",rc);
+        for(;;) {}
+    }
+    last = tick_ms;
+    for(;;) {
+        if( tick_ms-last < 1000 )
+            continue;
+        last = tick_ms;
+        LED_Toggle();
+        UsbAudio_GetStats(&u);
+        printf("out %lu in %lu fb %lu (%lu.%04lu) under %lu over %lu dropped %lu "
+               "fill %ld-%ld frames (%lu us)\n",
+                (unsigned long) u.outpackets,(unsigned long) u.inpackets,
+                (unsigned long) u.fbpackets,
+                (unsigned long) (u.feedback>>14),
+                (unsigned long) (((u.feedback&0x3FFF)*10000UL)>>14),
+                (unsigned long) u.underruns,(unsigned long) u.overruns,
+                (unsigned long) u.indropped,
+                (long) u.outfillmin,(long) u.outfillmax,
+                (unsigned long) u.latencyus);
+        UsbAudio_ResetStats();
+    }
+#else
+
+#ifdef AUDIO_DSP
+    if( ConfigDSP() < 0 ) {
+        printf("DSP: error\n");
+        for(;;) {}
+    }
+#endif
+
+#if defined(AUDIO_MIXER)
+    if( ConfigMixer() < 0 ) {
+        printf("Mixer: error\n");
+        for(;;) {}
+    }
+    rc = Audio_Init(FREQUENCY,AUDIO_OUTPUT|AUDIO_INPUT,VOLUME);
+    if( rc == AUDIO_OK )
+        rc = Audio_Start(Mix,0);
+#elif defined(AUDIO_TONE)
+    rc = Audio_Init(FREQUENCY,AUDIO_OUTPUT,VOLUME);
+    if( rc == AUDIO_OK )
+        rc = Audio_Start(Tone,0);
+#else
+    rc = Audio_Init(FREQUENCY,AUDIO_OUTPUT|AUDIO_INPUT,VOLUME);
+    if( rc == AUDIO_OK )
+        rc = Audio_Start(Loopback,0);
+#endif
+    if( rc != AUDIO_OK ) {
+        printf("Audio: error %d\n",rc);
+        for(;;) {}
+    }
+
+    last = tick_ms;
+    for(;;) {
+        if( tick_ms-last < 1000 )
+            continue;
+        last = tick_ms;
+        LED_Toggle();
+        Audio_GetStats(&s);
+        printf("blocks %u late %u latency %lu-%lu frames (%lu us) callback %lu cycles (max %lu)\n",
+                s.blocks,s.late,
+                (unsigned long) s.latencymin,(unsigned long) s.latencymax,
+                (unsigned long) s.latencyus,
+                (unsigned long) s.cycles,(unsigned long) s.maxcycles);
+#ifdef AUDIO_DSP
+        PrintDSP();
+#endif
+#ifdef AUDIO_MIXER
+        PrintMixer();
+#endif
+    }
+#endif
+}
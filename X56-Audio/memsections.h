@@ -0,0 +1,26 @@
+#ifndef MEMSECTIONS_H
+#define MEMSECTIONS_H
+/**
+ * @file    memsections.h
+ *
+ * @note    Attributes to place code and data in the fast memories
+ *
+ * @note    The sections are defined in stm32f746.ld and initialized by
+ *          Reset_Handler (startup_stm32f746.c)
+ *
+ *  Attribute   | Section    | Memory  | Initialization
+ *  ------------|------------|---------|--------------------------------
+ *  ITCM_CODE   | .itcm_text | ITCMRAM | copied from flash at start
+ *  DTCM_DATA   | .dtcm_data | DTCMRAM | copied from flash at start
+ *  DTCM_BSS    | .dtcm_bss  | DTCMRAM | zeroed at start
+ *
+ * @note    Code in ITCM must not call functions in flash in its hot path, so
+ *          small helpers must be inline or in ITCM too. The code of the
+ *          CMSIS-DSP library is placed in ITCM by the linker script
+ */
+
+#define ITCM_CODE       __attribute__((section(".itcm_text"),noinline))
+#define DTCM_DATA       __attribute__((section(".dtcm_data")))
+#define DTCM_BSS        __attribute__((section(".dtcm_bss")))
+
+#endif // MEMSECTIONS_H
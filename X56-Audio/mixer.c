@@ -0,0 +1,468 @@
+/**
+ * @file    mixer.c
+ *
+ * @brief   Mixer of 16 bit stereo voices for the audio output (see mixer.h)
+ *
+ * @note    A frame is kept as a word, left in the lower half and right in the
+ *          upper half, as in the interleaved buffers. Each voice is rendered
+ *          in its own buffer of MIXER_MAXFRAMES words and the sum reads all
+ *          of them for each frame, so the accumulators stay in registers
+ *
+ * @note    The resampler keeps the input frame at the integer position (prev)
+ *          and the fraction of the position (phase, 16 bits). The frames
+ *          between are fetched for each block. When the block ends between
+ *          two input frames, the second one was already fetched and is kept
+ *          for the next block (next). prev is a zero frame at the start, so
+ *          a resampled voice is one input frame late and starts without a click
+ *
+ * @note    A voice is started by the application and stopped by it or at the
+ *          end of its samples by Mixer_Process (in the interrupt). The fields
+ *          are written while the voice is idle, and state is written last
+ *
+ * @note    The statistics are updated in Mixer_Process, so they are read and
+ *          cleared with the interrupts disabled
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "stm32f746xx.h"
+#include "memsections.h"
+#include "mixer.h"
+
+#if MIXER_MAXVOICES > 15
+#error "MIXER_MAXVOICES at unity gain must fit the 32 bit accumulator"
+#endif
+
+/**
+ * @brief   Voice
+ */
+///@{
+#define VOICE_IDLE                      (0)
+#define VOICE_ACTIVE                    (1)
+
+typedef struct {
+    volatile unsigned   state;
+    volatile uint32_t   gain;               ///< right<<16|left
+    const int16_t      *data;               ///< samples in memory
+    uint32_t            length;             ///< frames
+    uint32_t            pos;                ///< next frame to fetch
+    unsigned            channels;
+    unsigned            flags;
+    unsigned            ended;              ///< end of the samples reached
+    Mixer_Source        source;             ///< or source of a stream
+    void               *arg;
+    uint32_t            step;               ///< input frames per output frame (16.16)
+    uint32_t            phase;              ///< fraction of the position (16 bits)
+    uint32_t            prev;               ///< frame at the position
+    uint32_t            next;               ///< frame after it, when hasnext
+    unsigned            hasnext;
+} Mixer_Voice;
+
+static Mixer_Voice  voices[MIXER_MAXVOICES] DTCM_BSS;
+static unsigned     outfreq DTCM_BSS;
+///@}
+
+/**
+ * @brief   Buffers: one block for each voice and the input of the resampler
+ */
+///@{
+static uint32_t     vbuf[MIXER_MAXVOICES][MIXER_MAXFRAMES] DTCM_BSS;
+static uint32_t     inbuf[MIXER_MAXSTEP*MIXER_MAXFRAMES+4] DTCM_BSS;
+///@}
+
+/**
+ * @brief   Statistics
+ */
+///@{
+static volatile unsigned blocks DTCM_BSS;
+static unsigned     active DTCM_BSS;
+static unsigned     underruns DTCM_BSS;
+static uint32_t     cycles DTCM_BSS;
+static uint32_t     maxcycles DTCM_BSS;
+static uint32_t     srccycles DTCM_BSS;
+static uint32_t     mixcycles DTCM_BSS;
+static uint64_t     totalcycles DTCM_BSS;
+static uint64_t     totalframes DTCM_BSS;
+///@}
+
+/**
+ * @brief   Fetch n input frames of a voice
+ *
+ * @note    Past the end of the samples (without MIXER_LOOP) and after a short
+ *          source, the frames are zeros
+ */
+static void ITCM_CODE
+Fetch( Mixer_Voice *vo, uint32_t *dst, unsigned n ) {
+const int16_t *p;
+unsigned got,k,i;
+
+    if( vo->source ) {
+        got = vo->source((int16_t *) dst,n,vo->arg);
+        if( got > n )
+            got = n;
+        underruns += n-got;
+        for(i=got;i<n;i++)
+            dst[i] = 0;
+        return;
+    }
+
+    while( n > 0 ) {
+        if( vo->pos >= vo->length ) {
+            if( !(vo->flags&MIXER_LOOP) ) {
+                vo->ended = 1;
+                for(i=0;i<n;i++)
+                    dst[i] = 0;
+                return;
+            }
+            vo->pos = 0;
+        }
+        k = vo->length-vo->pos;
+        if( k > n )
+            k = n;
+        p = vo->data+vo->pos*vo->channels;
+        if( vo->channels == 2 ) {
+            for(i=0;i<k;i++)
+                dst[i] = (uint16_t) p[2*i]|((uint32_t) (uint16_t) p[2*i+1]<<16);
+        } else {
+            for(i=0;i<k;i++)
+                dst[i] = (uint16_t) p[i]|((uint32_t) (uint16_t) p[i]<<16);
+        }
+        vo->pos += k;
+        dst += k;
+        n -= k;
+    }
+}
+
+/**
+ * @brief   Linear interpolation of a channel, f is the fraction (15 bits)
+ */
+static inline int32_t
+Interpolate( int32_t a, int32_t b, int32_t f ) {
+
+    return a+(((b-a)*f)>>15);
+}
+
+/**
+ * @brief   Render n output frames of a voice at the output rate
+ */
+static void ITCM_CODE
+Render( Mixer_Voice *vo, uint32_t *dst, unsigned n ) {
+uint32_t t,last,a,b;
+unsigned need,have,i,k;
+int32_t f,l,r;
+
+    // Same rate: the frames are the output
+    if( vo->step == (1U<<16) && vo->phase == 0 && !vo->hasnext ) {
+        Fetch(vo,dst,n);
+        return;
+    }
+
+    // Input frames up to the one after the last output frame and up to the
+    // position of the next block (in[0] is prev)
+    last = vo->phase+(n-1)*vo->step;
+    t    = vo->phase+n*vo->step;
+    need = (last>>16)+1;
+    if( (t>>16) > need )
+        need = t>>16;
+
+    inbuf[0] = vo->prev;
+    have = 1;
+    if( vo->hasnext )
+        inbuf[have++] = vo->next;
+    if( need+1 > have )
+        Fetch(vo,inbuf+have,need+1-have);
+
+    for(i=0,t=vo->phase;i<n;i++,t+=vo->step) {
+        k = t>>16;
+        f = (int32_t) ((t&0xFFFF)>>1);
+        a = inbuf[k];
+        b = inbuf[k+1];
+        l = Interpolate((int16_t) a,(int16_t) b,f);
+        r = Interpolate((int16_t) (a>>16),(int16_t) (b>>16),f);
+        dst[i] = (uint16_t) l|((uint32_t) (uint16_t) r<<16);
+    }
+
+    k = t>>16;
+    vo->prev    = inbuf[k];
+    vo->hasnext = need > k;
+    if( vo->hasnext )
+        vo->next = inbuf[k+1];
+    vo->phase = t&0xFFFF;
+}
+
+/**
+ * @brief  Mixer_Process
+ *
+ * @note   out is a block of n interleaved stereo frames, word aligned (a DMA
+ *         half buffer). It is called from the DMA interrupt, usually by the
+ *         callback of Audio_Start
+ */
+int ITCM_CODE
+Mixer_Process( int16_t *out, unsigned n, unsigned mode ) {
+const uint32_t *src[MIXER_MAXVOICES];
+uint32_t gain[MIXER_MAXVOICES];
+uint32_t gl[MIXER_MAXVOICES/2],gr[MIXER_MAXVOICES/2];
+uint32_t *o = (uint32_t *) out;
+uint32_t t0,t1,a,b,g,y;
+int32_t accl,accr;
+unsigned v,nv,np,p,i;
+Mixer_Voice *vo;
+
+    if( n == 0 || n > MIXER_MAXFRAMES || ((uintptr_t) out&3) != 0 )
+        return MIXER_ERROR_PARAMETER;
+
+    t0 = DWT->CYCCNT;
+
+    nv = 0;
+    for(v=0;v<MIXER_MAXVOICES;v++) {
+        vo = &voices[v];
+        if( vo->state != VOICE_ACTIVE )
+            continue;
+        Render(vo,vbuf[v],n);
+        src[nv]  = vbuf[v];
+        gain[nv] = vo->gain;
+        nv++;
+        // Mixed once more, with the zeros after the end
+        if( vo->ended )
+            vo->state = VOICE_IDLE;
+    }
+
+    t1 = DWT->CYCCNT;
+
+    // Gains of the pairs of voices, packed as the samples
+    np = nv/2;
+    for(p=0;p<np;p++) {
+        gl[p] = (gain[2*p]&0xFFFF)|(gain[2*p+1]<<16);
+        gr[p] = (gain[2*p]>>16)|(gain[2*p+1]&0xFFFF0000);
+    }
+
+    for(i=0;i<n;i++) {
+        accl = 0;
+        accr = 0;
+        for(p=0;p<np;p++) {
+            a = src[2*p][i];
+            b = src[2*p+1][i];
+            accl = (int32_t) __SMLAD(__PKHBT(a,b,16),gl[p],(uint32_t) accl);
+            accr = (int32_t) __SMLAD(__PKHTB(b,a,16),gr[p],(uint32_t) accr);
+        }
+        if( nv&1 ) {
+            // SMLABB and SMLATT
+            a = src[nv-1][i];
+            g = gain[nv-1];
+            accl += (int16_t) a*(int16_t) g;
+            accr += (int16_t) (a>>16)*(int16_t) (g>>16);
+        }
+        y = (uint16_t) __SSAT(accl>>MIXER_GAINBITS,16)
+           |((uint32_t) __SSAT(accr>>MIXER_GAINBITS,16)<<16);
+        o[i] = mode == MIXER_ADD ? __QADD16(o[i],y) : y;
+    }
+
+    mixcycles = DWT->CYCCNT-t1;
+    srccycles = t1-t0;
+    cycles = DWT->CYCCNT-t0;
+    if( cycles > maxcycles )
+        maxcycles = cycles;
+    totalcycles += cycles;
+    totalframes += n;
+    active = nv;
+    blocks++;
+    return MIXER_OK;
+}
+
+/**
+ * @brief  Mixer_Init
+ *
+ * @note   freq is the output rate. Stops all voices and starts the cycle
+ *         counter
+ */
+int
+Mixer_Init( unsigned freq ) {
+unsigned v;
+
+    if( freq == 0 )
+        return MIXER_ERROR_PARAMETER;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for(v=0;v<MIXER_MAXVOICES;v++) {
+        voices[v].state = VOICE_IDLE;
+        voices[v].gain  = ((uint32_t) MIXER_UNITY<<16)|MIXER_UNITY;
+    }
+    outfreq = freq;
+    Mixer_ResetStats();
+    return MIXER_OK;
+}
+
+/**
+ * @brief  Prepare an idle voice. Returns the step or 0
+ */
+static uint32_t
+Prepare( unsigned voice, unsigned freq ) {
+Mixer_Voice *vo;
+uint32_t step;
+
+    step = (uint32_t) (((uint64_t) freq<<16)/outfreq);
+    if( step == 0 || step > (MIXER_MAXSTEP<<16) )
+        return 0;
+
+    vo = &voices[voice];
+    vo->state = VOICE_IDLE;
+    __DMB();
+    vo->data    = 0;
+    vo->length  = 0;
+    vo->pos     = 0;
+    vo->channels= 2;
+    vo->flags   = 0;
+    vo->ended   = 0;
+    vo->source  = 0;
+    vo->arg     = 0;
+    vo->step    = step;
+    vo->phase   = 0;
+    vo->prev    = 0;
+    vo->next    = 0;
+    vo->hasnext = 0;
+    return step;
+}
+
+/**
+ * @brief  Start a voice
+ */
+static void
+Start( unsigned voice ) {
+
+    __DMB();
+    voices[voice].state = VOICE_ACTIVE;
+}
+
+/**
+ * @brief  Mixer_Play
+ *
+ * @note   Plays frames samples (channels 1 or 2, interleaved) at freq. They
+ *         are not copied. The voice keeps its gain (unity after Mixer_Init)
+ *         and stops at the end, unless MIXER_LOOP
+ */
+int
+Mixer_Play( unsigned voice, const int16_t *data, unsigned frames,
+            unsigned channels, unsigned freq, unsigned flags ) {
+Mixer_Voice *vo;
+
+    if( voice >= MIXER_MAXVOICES || outfreq == 0 || data == 0 || frames == 0
+     || (channels != 1 && channels != 2) )
+        return MIXER_ERROR_PARAMETER;
+
+    vo = &voices[voice];
+    if( Prepare(voice,freq) == 0 )
+        return MIXER_ERROR_RATE;
+    vo->data     = data;
+    vo->length   = frames;
+    vo->channels = channels;
+    vo->flags    = flags;
+    Start(voice);
+    return MIXER_OK;
+}
+
+/**
+ * @brief  Mixer_Stream
+ *
+ * @note   Plays the stereo frames given by source at freq, until Mixer_Stop
+ */
+int
+Mixer_Stream( unsigned voice, Mixer_Source source, void *arg, unsigned freq ) {
+Mixer_Voice *vo;
+
+    if( voice >= MIXER_MAXVOICES || outfreq == 0 || source == 0 )
+        return MIXER_ERROR_PARAMETER;
+
+    vo = &voices[voice];
+    if( Prepare(voice,freq) == 0 )
+        return MIXER_ERROR_RATE;
+    vo->source = source;
+    vo->arg    = arg;
+    Start(voice);
+    return MIXER_OK;
+}
+
+/**
+ * @brief  Mixer_SetGain
+ *
+ * @note   Gains of the left and right channels, MIXER_UNITY is 1.0. They are
+ *         limited to [-1.0,1.0]. The change is done at the next block. The
+ *         gain is kept for the next Mixer_Play or Mixer_Stream on the voice
+ */
+int
+Mixer_SetGain( unsigned voice, int left, int right ) {
+
+    if( voice >= MIXER_MAXVOICES )
+        return MIXER_ERROR_PARAMETER;
+    if( left > MIXER_UNITY )        left = MIXER_UNITY;
+    if( left < -MIXER_UNITY )       left = -MIXER_UNITY;
+    if( right > MIXER_UNITY )       right = MIXER_UNITY;
+    if( right < -MIXER_UNITY )      right = -MIXER_UNITY;
+    voices[voice].gain = (uint16_t) left|((uint32_t) (uint16_t) right<<16);
+    return MIXER_OK;
+}
+
+/**
+ * @brief  Mixer_Stop
+ */
+void
+Mixer_Stop( unsigned voice ) {
+
+    if( voice < MIXER_MAXVOICES )
+        voices[voice].state = VOICE_IDLE;
+}
+
+/**
+ * @brief  Mixer_IsPlaying
+ */
+int
+Mixer_IsPlaying( unsigned voice ) {
+
+    return voice < MIXER_MAXVOICES && voices[voice].state == VOICE_ACTIVE;
+}
+
+/**
+ * @brief  Mixer_GetStats
+ */
+void
+Mixer_GetStats( Mixer_Stats *s ) {
+uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    s->blocks    = blocks;
+    s->voices    = active;
+    s->underruns = underruns;
+    s->cycles    = cycles;
+    s->maxcycles = maxcycles;
+    s->srccycles = srccycles;
+    s->mixcycles = mixcycles;
+    s->cpf100    = totalframes ? (uint32_t) ((totalcycles*100)/totalframes) : 0;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Mixer_ResetStats
+ */
+void
+Mixer_ResetStats( void ) {
+uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    blocks      = 0;
+    active      = 0;
+    underruns   = 0;
+    cycles      = 0;
+    maxcycles   = 0;
+    srccycles   = 0;
+    mixcycles   = 0;
+    totalcycles = 0;
+    totalframes = 0;
+    __set_PRIMASK(primask);
+}
@@ -0,0 +1,128 @@
+#ifndef MIXER_H
+#define MIXER_H
+/**
+ * @file    mixer.h
+ *
+ * @brief   Mixer of 16 bit stereo voices for the audio output
+ *
+ * @note    Mixer_Process is called by the callback of Audio_Start with the
+ *          output block (a DMA half buffer). Each active voice is converted to
+ *          the output rate, multiplied by its gain (left and right) and added
+ *          to the others. The sum is saturated to 16 bits. With MIXER_ADD, the
+ *          result is added to the block with saturation (e.g. to the line
+ *          input copied by the callback)
+ *
+ * @note    A voice plays samples in memory (mono or stereo, once or in a loop,
+ *          e.g. sound effects) or frames given by a source function (e.g. a
+ *          music stream). The source is called from the DMA interrupt and
+ *          must give the frames at once. Missing frames are zeros and are
+ *          counted as underruns
+ *
+ * @note    Voices at another rate than the output are resampled by linear
+ *          interpolation. The source can be at most MIXER_MAXSTEP times faster
+ *          than the output. Voices at the output rate are copied
+ *
+ * @note    The sum uses the DSP instructions of the Cortex-M7: the samples of
+ *          two voices are packed (PKHBT/PKHTB) and multiplied by their gains
+ *          and accumulated in one SMLAD for each channel. The result is
+ *          saturated with SSAT and added to the block with QADD16. The gains
+ *          have MIXER_GAINBITS fractional bits and are at most 1.0, so the sum
+ *          of MIXER_MAXVOICES full scale voices fits the 32 bit accumulator
+ *
+ * @note    Mixer_Process runs from ITCM and the buffers of the voices are in
+ *          DTCM (see memsections.h). With AUDIO_DTCM (Makefile), the DMA
+ *          buffers are in DTCM too (audio.c)
+ *
+ * @note    The cycles of the resampling and of the sum are measured with the
+ *          cycle counter for each block. Mixer_GetStats reports them per block
+ *          and per output frame
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "stm32f746xx.h"
+
+/**
+ * @brief   Limits (all buffers are static)
+ */
+///@{
+#ifndef MIXER_MAXVOICES
+#define MIXER_MAXVOICES                 (8)
+#endif
+#ifndef MIXER_MAXFRAMES
+#define MIXER_MAXFRAMES                 (256)   ///< frames in a block
+#endif
+#define MIXER_CHANNELS                  (2)     ///< output is stereo
+#define MIXER_MAXSTEP                   (2)     ///< source rate/output rate
+///@}
+
+/**
+ * @brief   Gains
+ *
+ * @note    The accumulator takes MIXER_MAXVOICES*32768*MIXER_UNITY
+ */
+///@{
+#define MIXER_GAINBITS                  (12)
+#define MIXER_UNITY                     (1<<MIXER_GAINBITS)    ///< 1.0
+///@}
+
+/**
+ * @brief   Flags of Mixer_Play
+ */
+///@{
+#define MIXER_LOOP                      (1)     ///< restart at the end
+///@}
+
+/**
+ * @brief   Modes of Mixer_Process
+ */
+///@{
+#define MIXER_REPLACE                   (0)     ///< block = mix
+#define MIXER_ADD                       (1)     ///< block = block + mix
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define MIXER_OK                        (0)
+#define MIXER_ERROR_PARAMETER           (-1)
+#define MIXER_ERROR_RATE                (-2)    ///< rate above MIXER_MAXSTEP times the output
+///@}
+
+/**
+ * @brief   Source of a stream voice
+ *
+ * @note    Writes up to frames interleaved stereo frames to buf and returns the
+ *          number written. Called from the DMA interrupt
+ */
+typedef unsigned (*Mixer_Source)( int16_t *buf, unsigned frames, void *arg );
+
+/**
+ * @brief   Statistics
+ */
+typedef struct {
+    unsigned    blocks;                     ///< calls to Mixer_Process
+    unsigned    voices;                     ///< active in the last block
+    unsigned    underruns;                  ///< frames missing from sources
+    uint32_t    cycles;                     ///< last block
+    uint32_t    maxcycles;                  ///< longest block
+    uint32_t    srccycles;                  ///< last block, fetch and resampling
+    uint32_t    mixcycles;                  ///< last block, gains and sum
+    uint32_t    cpf100;                     ///< average cycles per output frame x 100
+} Mixer_Stats;
+
+int  Mixer_Init( unsigned freq );
+int  Mixer_Play( unsigned voice, const int16_t *data, unsigned frames,
+                 unsigned channels, unsigned freq, unsigned flags );
+int  Mixer_Stream( unsigned voice, Mixer_Source source, void *arg, unsigned freq );
+int  Mixer_SetGain( unsigned voice, int left, int right );
+void Mixer_Stop( unsigned voice );
+int  Mixer_IsPlaying( unsigned voice );
+int  Mixer_Process( int16_t *out, unsigned frames, unsigned mode );
+void Mixer_GetStats( Mixer_Stats *s );
+void Mixer_ResetStats( void );
+
+#endif // MIXER_H
@@ -0,0 +1,550 @@
+/**
+ * @file    usbaudio.c
+ *
+ * @note    USB Audio Class 1.0 device on the SAI2 rings (see usbaudio.h)
+ *
+ * @note    Interfaces and endpoints
+ *
+ *          | Interface | Class            | Setting 1 endpoints             |
+ *          |-----------|------------------|---------------------------------|
+ *          | 0         | Audio control    | -                               |
+ *          | 1         | Audio streaming  | 0x01 iso OUT async (196 bytes)  |
+ *          |           |                  | 0x82 iso IN feedback (3 bytes)  |
+ *          | 2         | Audio streaming  | 0x83 iso IN async (196 bytes)   |
+ *
+ *          Terminals: USB streaming (1) -> headphones (2) and line
+ *          connector (3) -> USB streaming (4). No feature unit: the volume
+ *          is the one given to Audio_Init
+ *
+ * @note    TX FIFOs (words): EP0 16, EP2 16 and EP3 64 (one packet). The RX
+ *          FIFO gets the other 224 words
+ *
+ * @note    Everything runs in the OTG_FS interrupt: the OUT packets are read
+ *          into the output ring, the IN packets are armed when the previous
+ *          one was sent and the start of frame updates the position of the
+ *          output ring and the feedback. The frames played are zeroed behind
+ *          the DMA, so the output is silent when the host stops sending. When
+ *          there is no start of frame (suspend, cable removed), the audio
+ *          callback zeroes the output blocks instead
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <string.h>
+#include "stm32f746xx.h"
+#include "usbd.h"
+#include "audio.h"
+#include "usbaudio.h"
+
+/**
+ * @brief   Endpoints
+ */
+///@{
+#define EP_OUT                          0x01
+#define EP_FEEDBACK                     0x82
+#define EP_IN                           0x83
+#define FRAMEBYTES                      (AUDIO_CHANNELS*2)
+#define PACKETSIZE                      (USBAUDIO_MAXFRAMES*FRAMEBYTES)
+///@}
+
+/**
+ * @brief   Rings and feedback
+ *
+ * @note    TARGETFILL is the fill of the output ring at the start of a USB
+ *          frame, leaving room for the packet of the frame. A fill error of
+ *          e frames changes the feedback by e/2^FBGAINSHIFT frames per USB
+ *          frame
+ */
+///@{
+#define RINGFRAMES                      (2*AUDIO_BLOCKFRAMES)
+#define TARGETFILL                      ((RINGFRAMES-USBAUDIO_MAXFRAMES)/2)
+#define FBNOMINAL                       ((USBAUDIO_FREQ*16384U)/1000)
+#define FBGAINSHIFT                     7
+///@}
+
+/**
+ * @brief   Class requests (to an endpoint)
+ */
+///@{
+#define AUDIO_SET_CUR                   0x01
+#define AUDIO_GET_CUR                   0x81
+#define SAMPLING_FREQ_CONTROL           0x01
+///@}
+
+/**
+ * @brief   Descriptors
+ */
+///@{
+#define FREQBYTES(F)    ((F)&0xFF), (((F)>>8)&0xFF), (((F)>>16)&0xFF)
+
+static const uint8_t devicedescriptor[18] = {
+    18, 1,                                  // bLength, DEVICE
+    0x00, 0x02,                             // USB 2.0
+    0x00, 0x00, 0x00,                       // class in the interfaces
+    USBD_EP0SIZE,
+    0x83, 0x04,                             // idVendor
+    0x50, 0x57,                             // idProduct
+    0x00, 0x01,                             // bcdDevice
+    1, 2, 3,                                // strings
+    1                                       // configurations
+};
+
+static const uint8_t configurationdescriptor[183] = {
+    9, 2, 183, 0, 3, 1, 0, 0x80, 50,        // 3 interfaces, bus powered 100 mA
+    // Audio control
+    9, 4, 0, 0, 0, 0x01, 0x01, 0x00, 0,
+    10, 0x24, 0x01, 0x00, 0x01, 52, 0, 2, 1, 2,     // Header (ADC 1.00), 2 streams
+    12, 0x24, 0x02, 1, 0x01, 0x01, 0, 2, 0x03, 0x00, 0, 0, // IT 1 USB streaming
+    9, 0x24, 0x03, 2, 0x02, 0x03, 0, 1, 0,          // OT 2 headphones
+    12, 0x24, 0x02, 3, 0x03, 0x06, 0, 2, 0x03, 0x00, 0, 0, // IT 3 line connector
+    9, 0x24, 0x03, 4, 0x01, 0x01, 0, 3, 0,          // OT 4 USB streaming
+    // Audio streaming OUT (speaker)
+    9, 4, 1, 0, 0, 0x01, 0x02, 0x00, 0,
+    9, 4, 1, 1, 2, 0x01, 0x02, 0x00, 0,
+    7, 0x24, 0x01, 1, 1, 0x01, 0x00,                // terminal 1, PCM
+    11, 0x24, 0x02, 0x01, 2, 2, 16, 1, FREQBYTES(USBAUDIO_FREQ),
+    9, 5, EP_OUT, 0x05, PACKETSIZE&0xFF, PACKETSIZE>>8, 1, 0, EP_FEEDBACK,
+    7, 0x25, 0x01, 0x00, 0, 0, 0,
+    9, 5, EP_FEEDBACK, 0x01, 3, 0, 1, USBAUDIO_FBREFRESH, 0,
+    // Audio streaming IN (microphone)
+    9, 4, 2, 0, 0, 0x01, 0x02, 0x00, 0,
+    9, 4, 2, 1, 1, 0x01, 0x02, 0x00, 0,
+    7, 0x24, 0x01, 4, 1, 0x01, 0x00,                // terminal 4, PCM
+    11, 0x24, 0x02, 0x01, 2, 2, 16, 1, FREQBYTES(USBAUDIO_FREQ),
+    9, 5, EP_IN, 0x05, PACKETSIZE&0xFF, PACKETSIZE>>8, 1, 0, 0,
+    7, 0x25, 0x01, 0x00, 0, 0, 0
+};
+
+static const char * const strings[] = {
+    "Hans",
+    "STM32F746 Discovery Audio",
+    "0001"
+};
+///@}
+
+/**
+ * @brief   State
+ *
+ * @note    Positions are frames in the rings (0 to RINGFRAMES-1). outfill is
+ *          the number of frames between the DMA and outwr
+ */
+///@{
+static USBD_Device          device;
+static int16_t             *outring = 0;
+static int16_t             *inring = 0;
+static volatile uint8_t     outactive = 0;
+static volatile uint8_t     inactive = 0;
+
+static uint32_t             outpos = 0;         // DMA, at the last update
+static uint32_t             outwr = 0;          // next OUT packet
+static int32_t              outfill = 0;
+static uint8_t              outbounced = 0;     // OUT packet armed in outbounce
+static uint32_t             outbounce[PACKETSIZE/4];
+
+static uint32_t             inrd = 0;           // next frame to send
+static uint32_t             inbounce[PACKETSIZE/4];
+
+static uint32_t             fbframes = 0;       // frames played
+static uint32_t             fbcount = 0;        // over fbcount USB frames
+static uint32_t             fbvalue = FBNOMINAL;
+static uint8_t              fbbuf[4] __attribute__((aligned(4)));
+static uint8_t              freqbuf[4] __attribute__((aligned(4)));
+
+static volatile uint8_t     sofseen = 0;
+static volatile uint8_t     nosof = 0;          // blocks without SOF
+
+static UsbAudio_Stats       stats;
+///@}
+
+/**
+ * @brief  Frames from position a to position b
+ */
+static inline uint32_t Distance( uint32_t a, uint32_t b ) {
+
+    return (b+RINGFRAMES-a)%RINGFRAMES;
+}
+
+/**
+ * @brief  Clean (after writing) or invalidate (before reading) n frames of a
+ *         ring from position i
+ *
+ * @note   The rings are whole cache lines, so the lines are in the ring
+ */
+static void CacheFrames( int16_t *ring, uint32_t i, uint32_t n, int clean ) {
+uint32_t k, a, e;
+
+    while( n ) {
+        k = RINGFRAMES-i;
+        if( k > n )
+            k = n;
+        a = (uint32_t) (ring+i*AUDIO_CHANNELS)&~31U;
+        e = ((uint32_t) (ring+(i+k)*AUDIO_CHANNELS)+31)&~31U;
+        if( clean )
+            SCB_CleanDCache_by_Addr((uint32_t *) a,e-a);
+        else
+            SCB_InvalidateDCache_by_Addr((uint32_t *) a,e-a);
+        n -= k;
+        i = 0;
+    }
+}
+
+/**
+ * @brief  Take the frames played since the last update
+ *
+ * @note   They are zeroed, so the DMA plays silence when no packet comes.
+ *         Must be called at least once per ring (each USB frame)
+ */
+static void UpdateOut( void ) {
+uint32_t pos, n, i, k, m;
+
+    pos = Audio_GetPosition(AUDIO_OUTPUT);
+    n = Distance(outpos,pos);
+    for(i=outpos,k=n;k;i=0) {
+        m = RINGFRAMES-i < k ? RINGFRAMES-i : k;
+        memset(outring+i*AUDIO_CHANNELS,0,m*FRAMEBYTES);
+        k -= m;
+    }
+    CacheFrames(outring,outpos,n,1);
+    outpos    = pos;
+    outfill  -= n;
+    fbframes += n;
+}
+
+/**
+ * @brief  Put the write position TARGETFILL frames ahead of the DMA
+ */
+static void ResyncOut( void ) {
+
+    outwr   = (outpos+TARGETFILL)%RINGFRAMES;
+    outfill = TARGETFILL;
+}
+
+/**
+ * @brief  Enable the OUT endpoint for the next packet
+ *
+ * @note   Straight into the ring, unless the packet could cross its end
+ */
+static void ArmOut( void ) {
+uint8_t *p;
+
+    if( !outactive || USBD_IsBusy(&device,EP_OUT) )
+        return;
+    outbounced = RINGFRAMES-outwr < USBAUDIO_MAXFRAMES;
+    p = outbounced ? (uint8_t *) outbounce : (uint8_t *) (outring+outwr*AUDIO_CHANNELS);
+    USBD_Receive(&device,EP_OUT,p,PACKETSIZE);
+}
+
+/**
+ * @brief  Send the input frames received since the last packet
+ *
+ * @note   When the host did not read for more than a packet, the oldest
+ *         frames are dropped
+ */
+static void SendIn( void ) {
+const uint8_t *p;
+uint32_t pos, n, k;
+
+    if( !inactive || USBD_IsBusy(&device,EP_IN) )
+        return;
+    pos = Audio_GetPosition(AUDIO_INPUT);
+    n = Distance(inrd,pos);
+    if( n > USBAUDIO_MAXFRAMES ) {
+        stats.indropped += n-USBAUDIO_FRAMES;
+        inrd = (pos+RINGFRAMES-USBAUDIO_FRAMES)%RINGFRAMES;
+        n = USBAUDIO_FRAMES;
+    }
+    CacheFrames(inring,inrd,n,0);
+    k = RINGFRAMES-inrd;
+    if( k >= n ) {
+        p = (const uint8_t *) (inring+inrd*AUDIO_CHANNELS);
+    } else {
+        memcpy(inbounce,inring+inrd*AUDIO_CHANNELS,k*FRAMEBYTES);
+        memcpy((uint8_t *) inbounce+k*FRAMEBYTES,inring,(n-k)*FRAMEBYTES);
+        p = (const uint8_t *) inbounce;
+        stats.bounces++;
+    }
+    if( USBD_Transmit(&device,EP_IN,p,n*FRAMEBYTES) == USBD_OK )
+        inrd = (inrd+n)%RINGFRAMES;
+}
+
+/**
+ * @brief  Audio callback (every AUDIO_BLOCKFRAMES frames)
+ *
+ * @note   Only watches the start of frame interrupts. Without them for two
+ *         blocks, the USB interrupt does not zero the played frames anymore,
+ *         so the next output block is zeroed here
+ */
+static void Watchdog( const int16_t *in, int16_t *out, unsigned frames, void *arg ) {
+
+    (void) in;
+    (void) arg;
+    if( sofseen ) {
+        sofseen = 0;
+        nosof = 0;
+        return;
+    }
+    if( nosof < 2 ) {
+        nosof++;
+        return;
+    }
+    if( out )
+        memset(out,0,frames*FRAMEBYTES);
+}
+
+/**
+ * @brief  Class callbacks
+ */
+///@{
+static void Configure( USBD_Device *dev, int configured ) {
+
+    outactive = 0;
+    inactive  = 0;
+    if( configured ) {
+        USBD_OpenEndpoint(dev,EP_OUT,USBD_EP_ISOCHRONOUS,PACKETSIZE);
+        USBD_OpenEndpoint(dev,EP_FEEDBACK,USBD_EP_ISOCHRONOUS,3);
+        USBD_OpenEndpoint(dev,EP_IN,USBD_EP_ISOCHRONOUS,PACKETSIZE);
+    }
+}
+
+static int SetInterface( USBD_Device *dev, uint32_t interface, uint32_t alt ) {
+
+    if( alt > 1 || interface > 2 || (interface == 0 && alt) )
+        return USBD_ERROR_PARAMETER;
+    if( interface == 1 ) {
+        outactive = 0;
+        USBD_Abort(dev,EP_OUT);
+        USBD_Abort(dev,EP_FEEDBACK);
+        if( alt ) {
+            UpdateOut();
+            ResyncOut();
+            outactive = 1;
+            ArmOut();
+        }
+    } else if( interface == 2 ) {
+        inactive = 0;
+        USBD_Abort(dev,EP_IN);
+        if( alt ) {
+            // The first packet goes at the next start of frame
+            inrd = Audio_GetPosition(AUDIO_INPUT);
+            inactive = 1;
+        }
+    }
+    return USBD_OK;
+}
+
+static int Setup( USBD_Device *dev, const USBD_Setup *s ) {
+
+    if( (s->bmRequestType&(USBD_REQ_TYPE|USBD_REQ_RECIPIENT)) != (USBD_REQ_CLASS|USBD_REQ_ENDPOINT)
+        || (s->wValue>>8) != SAMPLING_FREQ_CONTROL )
+        return USBD_ERROR_PARAMETER;
+    switch(s->bRequest) {
+    case AUDIO_SET_CUR:
+        // The frequency is fixed: the value is read and ignored
+        return USBD_ControlReceive(dev,freqbuf,3);
+    case AUDIO_GET_CUR:
+        freqbuf[0] = USBAUDIO_FREQ&0xFF;
+        freqbuf[1] = (USBAUDIO_FREQ>>8)&0xFF;
+        freqbuf[2] = (USBAUDIO_FREQ>>16)&0xFF;
+        return USBD_ControlSend(dev,freqbuf,3);
+    }
+    return USBD_ERROR_PARAMETER;
+}
+
+static void Transmitted( USBD_Device *dev, uint32_t ep ) {
+
+    if( ep == USBD_EPNUM(EP_FEEDBACK) ) {
+        stats.fbpackets++;
+    } else if( ep == USBD_EPNUM(EP_IN) ) {
+        stats.inpackets++;
+        SendIn();
+    }
+}
+
+static void Received( USBD_Device *dev, uint32_t ep, uint32_t n ) {
+uint32_t frames, k;
+
+    if( ep != USBD_EPNUM(EP_OUT) || !outactive )
+        return;
+    frames = n/FRAMEBYTES;
+    if( frames ) {
+        if( outbounced ) {
+            k = RINGFRAMES-outwr;
+            if( k > frames )
+                k = frames;
+            memcpy(outring+outwr*AUDIO_CHANNELS,outbounce,k*FRAMEBYTES);
+            memcpy(outring,(uint8_t *) outbounce+k*FRAMEBYTES,(frames-k)*FRAMEBYTES);
+            stats.bounces++;
+        }
+        CacheFrames(outring,outwr,frames,1);
+        UpdateOut();
+        if( outfill < 0 )
+            stats.underruns++;
+        outwr    = (outwr+frames)%RINGFRAMES;
+        outfill += frames;
+        stats.outpackets++;
+        if( outfill > RINGFRAMES-USBAUDIO_MAXFRAMES ) {
+            stats.overruns++;
+            ResyncOut();
+        } else if( outfill < 0 ) {
+            ResyncOut();
+        }
+    }
+    ArmOut();
+}
+
+/**
+ * @brief  Start of frame
+ *
+ * @note   The feedback is the number of frames played in the last
+ *         2^USBAUDIO_FBSHIFT USB frames (10.14 format), plus the correction
+ *         of the fill, within one frame of the nominal value
+ */
+static void Sof( USBD_Device *dev, uint32_t frame ) {
+int32_t fb;
+
+    (void) frame;
+    stats.frames++;
+    sofseen = 1;
+    if( nosof >= 2 ) {
+        // Back from a suspend: the played frames were not counted
+        nosof    = 0;
+        outpos   = Audio_GetPosition(AUDIO_OUTPUT);
+        fbframes = 0;
+        fbcount  = 0;
+        ResyncOut();
+    }
+    UpdateOut();
+
+    if( ++fbcount == (1U<<USBAUDIO_FBSHIFT) ) {
+        fb = (int32_t) (fbframes<<(14-USBAUDIO_FBSHIFT));
+        if( outactive )
+            fb += (TARGETFILL-outfill)*(1<<(14-FBGAINSHIFT));
+        if( fb > (int32_t) FBNOMINAL+16384 )
+            fb = FBNOMINAL+16384;
+        if( fb < (int32_t) FBNOMINAL-16384 )
+            fb = FBNOMINAL-16384;
+        fbvalue  = (uint32_t) fb;
+        fbframes = 0;
+        fbcount  = 0;
+    }
+
+    if( !outactive ) {
+        SendIn();
+        return;
+    }
+    if( outfill < stats.outfillmin )
+        stats.outfillmin = outfill;
+    if( outfill > stats.outfillmax )
+        stats.outfillmax = outfill;
+    if( !USBD_IsBusy(dev,EP_FEEDBACK) ) {
+        fbbuf[0] = fbvalue&0xFF;
+        fbbuf[1] = (fbvalue>>8)&0xFF;
+        fbbuf[2] = (fbvalue>>16)&0xFF;
+        USBD_Transmit(dev,EP_FEEDBACK,fbbuf,3);
+    }
+    // Streams started by SET_INTERFACE or after a failed start
+    ArmOut();
+    SendIn();
+}
+///@}
+
+static const USBD_Class audioclass = {
+    .device         = devicedescriptor,
+    .configuration  = configurationdescriptor,
+    .hsconfiguration = 0,
+    .strings        = strings,
+    .nstrings       = sizeof(strings)/sizeof(strings[0]),
+    .txfifo         = { 16, 0, 16, 64, 0, 0 },
+    .configure      = Configure,
+    .setup          = Setup,
+    .ep0received    = 0,
+    .transmitted    = Transmitted,
+    .received       = Received,
+    .cleared        = 0,
+    .setinterface   = SetInterface,
+    .sof            = Sof
+};
+
+/**
+ * @brief  UsbAudio_Init
+ *
+ * @note   Audio_Init must have been called with USBAUDIO_FREQ and both paths.
+ *         Starts SAI2 (Audio_Start) and connects the device on OTG_FS. OTG_HS
+ *         is not used: its DMA needs OUT buffers aligned to cache lines
+ */
+int
+UsbAudio_Init( void ) {
+Audio_Stats as;
+unsigned frames;
+int rc;
+
+    // Rings of whole cache lines, with room for two packets
+    if( AUDIO_BLOCKFRAMES < USBAUDIO_MAXFRAMES || AUDIO_BLOCKFRAMES%4 != 0 )
+        return USBAUDIO_ERROR_AUDIO;
+    Audio_GetStats(&as);
+    outring = Audio_GetBuffer(AUDIO_OUTPUT,&frames);
+    inring  = Audio_GetBuffer(AUDIO_INPUT,&frames);
+    if( as.freq != USBAUDIO_FREQ || !outring || !inring || frames != RINGFRAMES )
+        return USBAUDIO_ERROR_AUDIO;
+
+    outactive = inactive = 0;
+    fbvalue   = FBNOMINAL;
+    fbframes  = 0;
+    fbcount   = 0;
+    sofseen   = 0;
+    nosof     = 0;
+    UsbAudio_ResetStats();
+
+    if( Audio_Start(Watchdog,0) != AUDIO_OK )
+        return USBAUDIO_ERROR_AUDIO;
+    outpos = Audio_GetPosition(AUDIO_OUTPUT);
+    ResyncOut();
+
+    rc = USBD_Init(&device,USBD_CORE_FS,&audioclass);
+    if( rc < 0 )
+        return rc;
+    USBD_Connect(&device);
+    return USBAUDIO_OK;
+}
+
+/**
+ * @brief  UsbAudio_IsStreaming
+ *
+ * @note   Returns 1 when the host opened the output or the input
+ */
+int
+UsbAudio_IsStreaming( void ) {
+
+    return outactive || inactive;
+}
+
+/**
+ * @brief  UsbAudio_GetStats
+ */
+void
+UsbAudio_GetStats( UsbAudio_Stats *s ) {
+
+    NVIC_DisableIRQ(OTG_FS_IRQn);
+    *s = stats;
+    s->feedback = fbvalue;
+    s->isoincomplete = device.isoincomplete;
+    NVIC_EnableIRQ(OTG_FS_IRQn);
+    if( s->outfillmin > s->outfillmax )
+        s->outfillmin = s->outfillmax = 0;
+    s->latencyus = (uint32_t) (((s->outfillmax+USBAUDIO_MAXFRAMES+2*USBAUDIO_FRAMES)
+                                *1000000ULL)/USBAUDIO_FREQ);
+}
+
+/**
+ * @brief  UsbAudio_ResetStats
+ */
+void
+UsbAudio_ResetStats( void ) {
+
+    NVIC_DisableIRQ(OTG_FS_IRQn);
+    memset(&stats,0,sizeof(stats));
+    stats.outfillmin = RINGFRAMES;
+    stats.outfillmax = -RINGFRAMES;
+    NVIC_EnableIRQ(OTG_FS_IRQn);
+}
@@ -0,0 +1,99 @@
+#ifndef USBAUDIO_H
+#define USBAUDIO_H
+/**
+ * @file    usbaudio.h
+ *
+ * @note    USB Audio Class 1.0 device (full speed, OTG_FS): a 16 bit stereo
+ *          speaker (headphone output) and microphone (line input) at
+ *          USBAUDIO_FREQ
+ *
+ * @note    The samples go straight between the USB FIFOs and the circular DMA
+ *          buffers of SAI2 (audio.c without a callback): each OUT packet is
+ *          read from the RX FIFO into the output ring after the last frame
+ *          queued, and each IN packet is written to the TX FIFO from the input
+ *          ring. Only a packet that would cross the end of a ring goes thru a
+ *          small bounce buffer
+ *
+ * @note    The codec clock (PLLI2S, 47991.1 Hz for 48 kHz) is not the clock of
+ *          the host, so the OUT endpoint is asynchronous with a feedback
+ *          endpoint: the frames played by the SAI are counted over
+ *          2^USBAUDIO_FBSHIFT USB frames, giving the rate in frames per USB
+ *          frame (10.14 format), corrected by the distance of the fill of the
+ *          ring to its target. The host sends 47 to 49 frames per packet to
+ *          follow it. The IN endpoint is asynchronous too: each packet carries
+ *          the frames received since the last one
+ *
+ * @note    Latency in the device: the frames queued in the output ring (kept
+ *          at about (2*AUDIO_BLOCKFRAMES-USBAUDIO_MAXFRAMES)/2 at the start of
+ *          a USB frame) plus the packet, and up to two USB frames of input
+ *          (waiting for the packet to be armed, then for the host to read it).
+ *          AUDIO_BLOCKFRAMES must be a multiple of 4 and at least
+ *          USBAUDIO_MAXFRAMES (Makefile sets 64 with AUDIO_USB)
+ *
+ * @note    Audio_Init must have been called with USBAUDIO_FREQ and both paths.
+ *          UsbAudio_Init starts SAI2. PLLSAI must give 48 MHz on its P output
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "usbd.h"
+#include "audio.h"
+
+/**
+ * @brief   Parameters
+ */
+///@{
+#ifndef USBAUDIO_FREQ
+#define USBAUDIO_FREQ                   48000
+#endif
+#define USBAUDIO_FBSHIFT                6       // feedback over 64 USB frames
+#define USBAUDIO_FBREFRESH              2       // host reads it every 4 ms
+///@}
+
+/**
+ * @brief   Frames in a packet (nominal and maximum)
+ */
+///@{
+#define USBAUDIO_FRAMES                 (USBAUDIO_FREQ/1000)
+#define USBAUDIO_MAXFRAMES              (USBAUDIO_FRAMES+1)
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define USBAUDIO_OK                     0
+#define USBAUDIO_ERROR_AUDIO            -10     // SAI2 or AUDIO_BLOCKFRAMES
+///@}
+
+/**
+ * @brief   Statistics
+ *
+ * @note    outfill is the number of frames queued in the output ring at the
+ *          start of a USB frame. latencyus is the latency in the device,
+ *          from outfillmax (see above)
+ */
+typedef struct {
+    uint32_t    frames;                     ///< USB frames (SOF)
+    uint32_t    outpackets;
+    uint32_t    inpackets;
+    uint32_t    fbpackets;
+    uint32_t    bounces;                    ///< packets copied at the ring end
+    uint32_t    underruns;                  ///< output ring empty
+    uint32_t    overruns;                   ///< output ring full
+    uint32_t    indropped;                  ///< input frames not sent
+    uint32_t    isoincomplete;              ///< transfers the host skipped
+    uint32_t    feedback;                   ///< frames per USB frame (10.14)
+    int32_t     outfillmin;                 ///< frames
+    int32_t     outfillmax;                 ///< frames
+    uint32_t    latencyus;
+} UsbAudio_Stats;
+
+int  UsbAudio_Init(void);
+int  UsbAudio_IsStreaming(void);
+void UsbAudio_GetStats(UsbAudio_Stats *s);
+void UsbAudio_ResetStats(void);
+
+#endif // USBAUDIO_H
@@ -0,0 +1,250 @@
+#ifndef USBD_H
+#define USBD_H
+/**
+ * @file    usbd.h
+ *
+ * @note    USB device core for the OTG_FS controller (internal full speed PHY)
+ *          and the OTG_HS controller (USB3320 ULPI high speed PHY of the board)
+ *
+ * @note    The core handles the reset, the enumeration and the standard
+ *          requests on endpoint 0. A class (USBD_Class) gives the descriptors,
+ *          the size of the TX FIFOs and callbacks for its requests and for the
+ *          end of the transfers of its endpoints
+ *
+ * @note    Slave mode: the CPU moves the data between the buffers and the FIFOs
+ *          in the OTG interrupt. An IN transfer is programmed for all its
+ *          packets at once, and packets are written while the TX FIFO has
+ *          space, each time it becomes half empty (TXFE). With a FIFO of two or
+ *          more packets, one is sent while the next is written (double
+ *          buffering). OUT packets are read from the RX FIFO as they arrive.
+ *          This is the mode of OTG_FS
+ *
+ * @note    DMA mode (OTG_HS): the internal DMA of the core moves the data, so
+ *          there is one interrupt per transfer instead of one per packet. The
+ *          buffers must be word aligned and, for OUT transfers, aligned to a
+ *          cache line (32 bytes), since the D-cache is cleaned before an IN
+ *          transfer and invalidated after an OUT transfer
+ *
+ * @note    USBD_Transmit and USBD_Receive start a transfer. Its end is reported
+ *          by the transmitted and received callbacks, called in the interrupt
+ *
+ * @note    Isochronous endpoints: a transfer (one packet) is programmed for the
+ *          frame after the current one (even/odd frame bit). When the host
+ *          does not poll the endpoint in that frame (incomplete isochronous
+ *          transfer, e.g. a feedback endpoint polled every 2^bRefresh frames),
+ *          the transfer is moved to the next frame, so it waits for the host
+ *          like a bulk transfer. The sof callback, called at each start of
+ *          frame, lets a class start its transfers in step with the frames
+ *
+ * @note    The 48 MHz clock (CK48) must come from the P output of PLLSAI
+ *          (PLLSAIConfiguration_48MHz) and HCLK must be at least 30 MHz. VBUS
+ *          is not connected to PA9 on the board, so its sensing is disabled and
+ *          the session is forced valid. OTG_HS does not need CK48: the PHY
+ *          gives the 60 MHz ULPI clock. Its session is also forced valid
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "stm32f746xx.h"
+
+/**
+ * @brief   Limits
+ */
+///@{
+#define USBD_MAXEP                      9       // endpoints (with 0) of OTG_HS
+#define USBD_EP0SIZE                    64
+#define USBD_CTRLBUFSIZE                128     // descriptors built in RAM
+#define USBD_MAXPACKETS                 1023    // per transfer
+#define USBD_MAXINTERFACES              4       // with alternate settings
+///@}
+
+/**
+ * @brief   Cores
+ */
+///@{
+#define USBD_CORE_FS                    0
+#define USBD_CORE_HS                    1
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define USBD_OK                         0
+#define USBD_ERROR_PARAMETER            -1
+#define USBD_ERROR_BUSY                 -2
+#define USBD_ERROR_NOTCONFIGURED        -3
+#define USBD_ERROR_NOCLOCK              -4      // PLLSAI not running
+#define USBD_ERROR_TIMEOUT              -5      // core reset
+///@}
+
+/**
+ * @brief   Speeds (after the enumeration)
+ */
+///@{
+#define USBD_SPEED_HIGH                 0
+#define USBD_SPEED_FULL                 3
+///@}
+
+/**
+ * @brief   Device states
+ */
+///@{
+#define USBD_STATE_DETACHED             0
+#define USBD_STATE_DEFAULT              1
+#define USBD_STATE_ADDRESS              2
+#define USBD_STATE_CONFIGURED           3
+///@}
+
+/**
+ * @brief   Endpoint types
+ */
+///@{
+#define USBD_EP_CONTROL                 0
+#define USBD_EP_ISOCHRONOUS             1
+#define USBD_EP_BULK                    2
+#define USBD_EP_INTERRUPT               3
+///@}
+
+/**
+ * @brief   Endpoint address
+ */
+///@{
+#define USBD_EPIN                       0x80
+#define USBD_EPNUM(A)                   ((A)&0x0F)
+///@}
+
+/**
+ * @brief   Fields of bmRequestType
+ */
+///@{
+#define USBD_REQ_DIRIN                  0x80
+#define USBD_REQ_TYPE                   0x60
+#define USBD_REQ_STANDARD               0x00
+#define USBD_REQ_CLASS                  0x20
+#define USBD_REQ_VENDOR                 0x40
+#define USBD_REQ_RECIPIENT              0x1F
+#define USBD_REQ_DEVICE                 0x00
+#define USBD_REQ_INTERFACE              0x01
+#define USBD_REQ_ENDPOINT               0x02
+///@}
+
+/**
+ * @brief   SETUP packet
+ */
+typedef struct {
+    uint8_t     bmRequestType;
+    uint8_t     bRequest;
+    uint16_t    wValue;
+    uint16_t    wIndex;
+    uint16_t    wLength;
+} USBD_Setup;
+
+typedef struct USBD_Device_s USBD_Device;
+
+/**
+ * @brief   Class driver
+ *
+ * @note    strings[i-1] is the string descriptor i (ASCII). txfifo gives the
+ *          size in words of the TX FIFO of each IN endpoint (at least 16). The
+ *          RX FIFO gets the rest. OTG_FS has 6 endpoints and 320 words
+ *
+ * @note    hsconfiguration, when given, is the configuration descriptor at
+ *          high speed (bulk endpoints of 512 bytes) and hstxfifo the TX FIFOs
+ *          on OTG_HS (1006 words). Without it, OTG_HS runs at full speed
+ *
+ * @note    configure is called with 1 by SET_CONFIGURATION (open the endpoints
+ *          with USBD_OpenEndpoint) and with 0 at a reset or deconfiguration
+ *
+ * @note    setup is called for class and vendor requests and for the standard
+ *          requests to an interface that the core does not handle. It starts
+ *          the data stage with USBD_ControlSend or USBD_ControlReceive and
+ *          returns USBD_OK, or returns a negative value to stall the request.
+ *          ep0received is called when the data of USBD_ControlReceive arrived
+ *
+ * @note    cleared is called when the host clears the halt of an endpoint
+ *          (CLEAR_FEATURE), e.g. to send a status that waited for it
+ *
+ * @note    setinterface is called by SET_INTERFACE and returns a negative value
+ *          when the alternate setting does not exist. Without it, only the
+ *          setting 0 exists. The core answers GET_INTERFACE
+ *
+ * @note    sof, when given, is called at each start of frame (every 1 ms at
+ *          full speed) with the frame number
+ */
+typedef struct {
+    const uint8_t       *device;
+    const uint8_t       *configuration;
+    const uint8_t       *hsconfiguration;
+    const char * const  *strings;
+    uint32_t            nstrings;
+    uint16_t            txfifo[USBD_MAXEP];
+    uint16_t            hstxfifo[USBD_MAXEP];
+    void                (*configure)(USBD_Device *dev, int configured);
+    int                 (*setup)(USBD_Device *dev, const USBD_Setup *setup);
+    void                (*ep0received)(USBD_Device *dev);
+    void                (*transmitted)(USBD_Device *dev, uint32_t ep);
+    void                (*received)(USBD_Device *dev, uint32_t ep, uint32_t n);
+    void                (*cleared)(USBD_Device *dev, uint32_t ep);
+    int                 (*setinterface)(USBD_Device *dev, uint32_t interface, uint32_t alt);
+    void                (*sof)(USBD_Device *dev, uint32_t frame);
+} USBD_Class;
+
+/**
+ * @brief   Transfer of an endpoint
+ */
+typedef struct {
+    uint8_t             *data;
+    uint32_t            len;
+    uint32_t            count;          // bytes written to or read from the FIFO
+    uint16_t            mps;
+    uint8_t             type;
+    volatile uint8_t    busy;
+} USBD_Endpoint;
+
+/**
+ * @brief   Device (one per core)
+ */
+struct USBD_Device_s {
+    USB_OTG_GlobalTypeDef   *otg;
+    const USBD_Class        *cls;
+    IRQn_Type               irq;
+    uint32_t                fifowords;
+    uint8_t                 core;
+    uint8_t                 neps;           // endpoints of the core
+    uint8_t                 dma;
+    volatile uint8_t        state;
+    uint8_t                 configuration;
+    uint8_t                 ep0state;
+    uint8_t                 speed;
+    uint8_t                 ep0zlp;         // data stage ends with a ZLP
+    uint8_t                 altsetting[USBD_MAXINTERFACES];
+    uint32_t                isoincomplete;  // isochronous transfers moved
+    uint8_t                 *ep0data;       // data stage
+    uint32_t                ep0len;
+    uint32_t                ep0count;
+    USBD_Setup              setup;
+    uint32_t                setupbuf[8] __attribute__((aligned(32)));  // 3 with DMA
+    uint32_t                ep0buf[USBD_EP0SIZE/4] __attribute__((aligned(32)));
+    uint8_t                 ctrlbuf[USBD_CTRLBUFSIZE] __attribute__((aligned(4)));
+    USBD_Endpoint           in[USBD_MAXEP];
+    USBD_Endpoint           out[USBD_MAXEP];
+};
+
+int  USBD_Init(USBD_Device *dev, int core, const USBD_Class *cls);
+void USBD_Connect(USBD_Device *dev);
+void USBD_Disconnect(USBD_Device *dev);
+int  USBD_IsConfigured(USBD_Device *dev);
+int  USBD_IsHighSpeed(USBD_Device *dev);
+int  USBD_OpenEndpoint(USBD_Device *dev, uint32_t ep, uint32_t type, uint32_t mps);
+int  USBD_Transmit(USBD_Device *dev, uint32_t ep, const void *data, uint32_t len);
+int  USBD_Receive(USBD_Device *dev, uint32_t ep, void *data, uint32_t len);
+int  USBD_IsBusy(USBD_Device *dev, uint32_t ep);
+void USBD_Stall(USBD_Device *dev, uint32_t ep);
+void USBD_Abort(USBD_Device *dev, uint32_t ep);
+int  USBD_ControlSend(USBD_Device *dev, const void *data, uint32_t len);
+int  USBD_ControlReceive(USBD_Device *dev, void *data, uint32_t len);
+
+#endif // USBD_H
@@ -0,0 +1,301 @@
+/**
+ * @file    wm8994.c
+ *
+ * @brief   Configuration of the WM8994 audio codec (see wm8994.h)
+ *
+ * @note    The register sequences follow the start-up sequences of the WM8994
+ *          data sheet for the headphone output (charge pump, DC servo and
+ *          removal of the output clamps) and for the line input, as used by
+ *          the ST board support package
+ *
+ * @note    The accesses wait for the end of the I2C transaction, so the
+ *          functions must not be called from interrupts
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "i2c-master.h"
+#include "wm8994.h"
+
+/**
+ * @brief   Register writes with a delay (ms) after them
+ */
+typedef struct {
+    uint16_t    reg;
+    uint16_t    value;
+    uint16_t    delay;
+} WM8994_RegWrite;
+
+/**
+ * @brief   Power up: errata work arounds, VMID soft start and bias
+ */
+static const WM8994_RegWrite seq_powerup[] = {
+    { 0x0102, 0x0003,   0 },
+    { 0x0817, 0x0000,   0 },
+    { 0x0102, 0x0000,   0 },
+    { 0x0039, 0x006C,   0 },        // VMID soft start (fast), start-up bias current
+    { 0x0001, 0x0003,  50 },        // bias generator and VMID
+};
+
+/**
+ * @brief   AIF1 timeslot 0 to DAC1 (left and right)
+ */
+static const WM8994_RegWrite seq_output[] = {
+    { 0x0005, 0x0303,   0 },        // AIF1DAC1L/R and DAC1L/R enabled
+    { 0x0601, 0x0001,   0 },        // AIF1 timeslot 0 left to DAC1L
+    { 0x0602, 0x0001,   0 },        // AIF1 timeslot 0 right to DAC1R
+    { 0x0604, 0x0000,   0 },        // nothing to DAC2
+    { 0x0605, 0x0000,   0 },
+};
+
+/**
+ * @brief   IN1L/IN1R (line input) thru ADC1 to AIF1 timeslot 0
+ */
+static const WM8994_RegWrite seq_input[] = {
+    { 0x0028, 0x0011,   0 },        // IN1LN to IN1L, IN1RN to IN1R
+    { 0x0029, 0x0035,   0 },        // IN1L PGA to MIXINL, unmuted
+    { 0x002A, 0x0035,   0 },        // IN1R PGA to MIXINR, unmuted
+    { 0x0004, 0x0303,   0 },        // AIF1ADC1L/R and ADCL/R enabled
+    { 0x0440, 0x00DB,   0 },        // AIF1 DRC1 signal detect
+    { 0x0002, 0x6350,   0 },        // IN1L/IN1R PGAs, MIXINL/R, thermal shutdown
+    { 0x0606, 0x0002,   0 },        // ADCL to AIF1 timeslot 0 left
+    { 0x0607, 0x0002,   0 },        // ADCR to AIF1 timeslot 0 right
+    { 0x0700, 0x000D,   0 },        // GPIO1 = AIF1 DRC1 signal detect
+};
+
+/**
+ * @brief   AIF1 slave, I2S, 16 bits, clocked by MCLK1. Rate written before
+ */
+static const WM8994_RegWrite seq_interface[] = {
+    { 0x0300, 0x4010,   0 },        // AIF1 I2S, 16 bits
+    { 0x0302, 0x0000,   0 },        // AIF1 slave
+    { 0x0208, 0x000A,   0 },        // AIF1 DSP clock and core clock
+    { 0x0200, 0x0001,   0 },        // AIF1CLK enabled, source MCLK1
+};
+
+/**
+ * @brief   Headphone start-up
+ */
+static const WM8994_RegWrite seq_headphone[] = {
+    { 0x002D, 0x0100,   0 },        // DAC1L to HPOUT1L mixer
+    { 0x002E, 0x0100,   0 },        // DAC1R to HPOUT1R mixer
+    { 0x0110, 0x8100, 300 },        // headphone cold start-up sequence
+    { 0x0420, 0x0000,   0 },        // unmute AIF1 timeslot 0 DAC path
+    { 0x0051, 0x0005,   0 },        // class W, envelope tracking of timeslot 0
+    { 0x0001, 0x0303,   0 },        // bias, VMID, HPOUT1L/R input stages
+    { 0x0060, 0x0022,   0 },        // HPOUT1L/R intermediate stages
+    { 0x004C, 0x9F25,  15 },        // charge pump
+    { 0x002D, 0x0001,   0 },        // DAC1L direct to HPOUT1L
+    { 0x002E, 0x0001,   0 },        // DAC1R direct to HPOUT1R
+    { 0x0003, 0x0030,   0 },        // MIXOUTL/R enabled
+    { 0x0054, 0x0033, 257 },        // DC servo start-up
+    { 0x0060, 0x00EE,   0 },        // output stages enabled, clamps removed
+    { 0x0610, 0x00C0,   0 },        // DAC1L unmuted, 0 dB
+    { 0x0611, 0x00C0,   0 },        // DAC1R unmuted, 0 dB
+    { 0x0420, 0x0000,   0 },
+};
+
+/**
+ * @brief   Line input gains
+ */
+static const WM8994_RegWrite seq_linein[] = {
+    { 0x0018, 0x000B,   0 },        // IN1L unmuted, 0 dB
+    { 0x001A, 0x000B,   0 },        // IN1R unmuted, 0 dB
+    { 0x0410, 0x1800,   0 },        // AIF1 ADC1 high pass filter (4 Hz)
+};
+
+#define NWRITES(S) (sizeof(S)/sizeof(S[0]))
+
+/**
+ * @brief   AIF1_SR and AIF1CLK_RATE (256) for each sampling frequency
+ */
+static const struct {
+    unsigned    freq;
+    uint16_t    value;
+} ratetab[] = {
+    { 16000, 0x0033 },
+    { 44100, 0x0073 },
+    { 48000, 0x0083 },
+};
+
+/**
+ * @brief   Bus, paths configured by WM8994_Init
+ */
+///@{
+static I2C_TypeDef  *wmi2c = 0;
+static unsigned      wmpaths = 0;
+///@}
+
+/**
+ * @brief   Transfer buffer
+ *
+ * @note    Cache line aligned and padded, because the I2C driver cleans and
+ *          invalidates the data cache over it for the DMA
+ */
+static uint8_t  iobuf[32] __attribute__((aligned(32)));
+
+/**
+ * @brief   Delay using the cycle counter (does not need SysTick)
+ */
+static void Delay( unsigned ms ) {
+uint32_t t0,cycles;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    cycles = SystemCoreClock/1000;
+    while( ms-- > 0 ) {
+        t0 = DWT->CYCCNT;
+        while( DWT->CYCCNT-t0 < cycles ) {}
+    }
+}
+
+/**
+ * @brief   Execute a register sequence
+ */
+static int WriteSequence( const WM8994_RegWrite *s, unsigned n ) {
+unsigned i;
+
+    for(i=0;i<n;i++) {
+        if( WM8994_Write(s[i].reg,s[i].value) < 0 )
+            return WM8994_ERROR_I2C;
+        if( s[i].delay )
+            Delay(s[i].delay);
+    }
+    return WM8994_OK;
+}
+
+/**
+ * @brief  WM8994_Write
+ */
+int
+WM8994_Write( uint16_t reg, uint16_t value ) {
+
+    if( !wmi2c )
+        return WM8994_ERROR_PARAMETER;
+    iobuf[0] = reg>>8;
+    iobuf[1] = reg;
+    iobuf[2] = value>>8;
+    iobuf[3] = value;
+    if( I2CMaster_Write(wmi2c,WM8994_ADDRESS,iobuf,4) < 0 )
+        return WM8994_ERROR_I2C;
+    return WM8994_OK;
+}
+
+/**
+ * @brief  WM8994_Read
+ */
+int
+WM8994_Read( uint16_t reg, uint16_t *value ) {
+
+    if( !wmi2c )
+        return WM8994_ERROR_PARAMETER;
+    iobuf[0] = reg>>8;
+    iobuf[1] = reg;
+    if( I2CMaster_WriteAndRead(wmi2c,WM8994_ADDRESS,iobuf,2,iobuf+2,2) < 0 )
+        return WM8994_ERROR_I2C;
+    *value = (iobuf[2]<<8)|iobuf[3];
+    return WM8994_OK;
+}
+
+/**
+ * @brief  WM8994_Init
+ *
+ * @note   Resets the codec, checks its id and configures the paths for freq
+ *         (16000, 44100 or 48000 Hz). The I2C bus must already be initialized.
+ *         It takes about 650 ms with the headphone output
+ *
+ * @note   MCLK1 must be running, because the sequences are clocked by it
+ */
+int
+WM8994_Init( I2C_TypeDef *i2c, unsigned freq, unsigned paths, unsigned volume ) {
+uint16_t id;
+unsigned k;
+int rc;
+
+    for(k=0;k<NWRITES(ratetab)&&ratetab[k].freq!=freq;k++) {}
+    if( k == NWRITES(ratetab) || (paths&(WM8994_OUTPUT_HEADPHONE|WM8994_INPUT_LINE1)) == 0 )
+        return WM8994_ERROR_PARAMETER;
+
+    wmi2c = i2c;
+    wmpaths = paths;
+
+    // Software reset. The id is read from the same register
+    if( WM8994_Write(0x0000,0x0000) < 0 )
+        return WM8994_ERROR_I2C;
+    Delay(5);
+    if( WM8994_Read(0x0000,&id) < 0 )
+        return WM8994_ERROR_I2C;
+    if( id != WM8994_CHIPID )
+        return WM8994_ERROR_CHIPID;
+
+    rc = WriteSequence(seq_powerup,NWRITES(seq_powerup));
+    if( rc == WM8994_OK && (paths&WM8994_OUTPUT_HEADPHONE) )
+        rc = WriteSequence(seq_output,NWRITES(seq_output));
+    if( rc == WM8994_OK && (paths&WM8994_INPUT_LINE1) )
+        rc = WriteSequence(seq_input,NWRITES(seq_input));
+    if( rc == WM8994_OK )
+        rc = WM8994_Write(0x0210,ratetab[k].value);
+    if( rc == WM8994_OK )
+        rc = WriteSequence(seq_interface,NWRITES(seq_interface));
+    if( rc == WM8994_OK && (paths&WM8994_OUTPUT_HEADPHONE) )
+        rc = WriteSequence(seq_headphone,NWRITES(seq_headphone));
+    if( rc == WM8994_OK && (paths&WM8994_INPUT_LINE1) )
+        rc = WriteSequence(seq_linein,NWRITES(seq_linein));
+    if( rc == WM8994_OK && (paths&WM8994_OUTPUT_HEADPHONE) )
+        rc = WM8994_SetVolume(volume);
+    return rc;
+}
+
+/**
+ * @brief  WM8994_SetVolume
+ *
+ * @note   Headphone volume from 0 (muted) to 100 (+6 dB). It is mapped to the
+ *         64 steps of 1 dB of HPOUT1L/R. The update bit changes both at once
+ */
+int
+WM8994_SetVolume( unsigned volume ) {
+uint16_t v;
+
+    if( (wmpaths&WM8994_OUTPUT_HEADPHONE) == 0 )
+        return WM8994_ERROR_PARAMETER;
+    if( volume > 100 )
+        volume = 100;
+    v = (volume*63)/100;
+    if( volume > 0 )
+        v |= 0x0040;                    // HPOUT1x_MUTE_N
+    if( WM8994_Write(0x001C,v) < 0 || WM8994_Write(0x001D,v|0x0100) < 0 )
+        return WM8994_ERROR_I2C;
+    return WM8994_OK;
+}
+
+/**
+ * @brief  WM8994_Mute
+ *
+ * @note   Soft mute of the AIF1 timeslot 0 DAC path
+ */
+int
+WM8994_Mute( int mute ) {
+
+    return WM8994_Write(0x0420,mute ? 0x0200 : 0x0000);
+}
+
+/**
+ * @brief  WM8994_PowerDown
+ *
+ * @note   Mutes and resets the codec. WM8994_Init must be called again
+ */
+int
+WM8994_PowerDown( void ) {
+int rc;
+
+    rc = WM8994_Mute(1);
+    if( rc == WM8994_OK )
+        rc = WM8994_Write(0x0000,0x0000);
+    wmpaths = 0;
+    return rc;
+}
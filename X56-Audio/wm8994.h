@@ -0,0 +1,56 @@
+#ifndef WM8994_H
+#define WM8994_H
+/**
+ * @file    wm8994.h
+ *
+ * @brief   Configuration of the WM8994 audio codec
+ *
+ * @note    The codec is at I2C3 (shared with the touch controller). Its
+ *          registers have 16 bit addresses and 16 bit values, sent MSB first
+ *
+ * @note    The codec is a slave of SAI2: MCLK1, BCLK1 and LRCLK1 come from
+ *          SAI2 block A. AIF1 uses I2S with 16 bit words and MCLK = 256*fs.
+ *          Timeslot 0 goes to DAC1 and the headphone output (OUT jack) and
+ *          the line input (IN1L/IN1R, LINE IN jack) comes back in timeslot 0
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "stm32f746xx.h"
+
+/**
+ * @brief   I2C address (7 bit) and chip id (register 0)
+ */
+///@{
+#define WM8994_ADDRESS                  (0x1A)
+#define WM8994_CHIPID                   (0x8994)
+///@}
+
+/**
+ * @brief   Paths (same values as AUDIO_OUTPUT and AUDIO_INPUT)
+ */
+///@{
+#define WM8994_OUTPUT_HEADPHONE         (1)
+#define WM8994_INPUT_LINE1              (2)
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define WM8994_OK                       (0)
+#define WM8994_ERROR_PARAMETER          (-1)
+#define WM8994_ERROR_I2C                (-2)
+#define WM8994_ERROR_CHIPID             (-3)
+///@}
+
+int WM8994_Init( I2C_TypeDef *i2c, unsigned freq, unsigned paths, unsigned volume );
+int WM8994_Write( uint16_t reg, uint16_t value );
+int WM8994_Read( uint16_t reg, uint16_t *value );
+int WM8994_SetVolume( unsigned volume );
+int WM8994_Mute( int mute );
+int WM8994_PowerDown( void );
+
+#endif // WM8994_H
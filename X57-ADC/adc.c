@@ -0,0 +1,456 @@
+/**
+ * @file    adc.c
+ *
+ * @brief   Acquisition with ADC1..3 and DMA double buffering (see adc.h)
+ *
+ * @note    Clocks: ADCCLK is PCLK2 divided by 2, 4, 6 or 8 (ADCPRE), the
+ *          smallest divisor that gives at most ADC_MAXCLOCK (25 MHz with PCLK2
+ *          = 100 MHz). A 12 bit conversion takes the sampling time plus 12
+ *          cycles. TIM2 runs at 2*PCLK1 (when APB1 is divided)
+ *
+ * @note    Scan mode: ADC3 with SCAN, triggered by TIM2 TRGO (EXTSEL=1011) on
+ *          the rising edge. One DMA request for each conversion (DDS=1), read
+ *          from ADC3->DR
+ *
+ * @note    Triple mode: MULTI=10111 (regular simultaneous interleaved), DMA
+ *          mode 2 (two samples in a 32 bit word, read from ADC->CDR). The
+ *          delay between the ADCs is at least a third of the conversion time
+ *          and at least 5 cycles, so the rate is ADCCLK/delay
+ *
+ * @note    DMA: ADC1 is DMA2 Stream0 or Stream4 channel 0 and ADC3 is DMA2
+ *          Stream0 or Stream1 channel 2. The SD driver uses DMA2 Stream3
+ *          directly, so they do not conflict
+ *
+ * @note    Overrun recovery (RM0385, Using the DMA): the ADCs and the stream
+ *          are stopped, the flags cleared and everything is started again
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "gpio.h"
+#include "dma.h"
+#include "adc.h"
+
+/**
+ * @brief   Pins of the ADC3 channels (all analog). Channels 0-3 and 10-13 are
+ *          also inputs of ADC1 and ADC2
+ */
+static const GPIO_PinConfiguration adcpins[16] = {
+    //  GPIO  Pin AF  Mode OType Speed PuPd
+    { GPIOA,  0,  0,  3,   0,    0,    0 },    // IN0  (A0)
+    { GPIOA,  1,  0,  3,   0,    0,    0 },    // IN1
+    { GPIOA,  2,  0,  3,   0,    0,    0 },    // IN2
+    { GPIOA,  3,  0,  3,   0,    0,    0 },    // IN3
+    { GPIOF,  6,  0,  3,   0,    0,    0 },    // IN4  (A5)
+    { GPIOF,  7,  0,  3,   0,    0,    0 },    // IN5  (A4)
+    { GPIOF,  8,  0,  3,   0,    0,    0 },    // IN6  (A3)
+    { GPIOF,  9,  0,  3,   0,    0,    0 },    // IN7  (A2)
+    { GPIOF, 10,  0,  3,   0,    0,    0 },    // IN8  (A1)
+    { GPIOF,  3,  0,  3,   0,    0,    0 },    // IN9
+    { GPIOC,  0,  0,  3,   0,    0,    0 },    // IN10
+    { GPIOC,  1,  0,  3,   0,    0,    0 },    // IN11
+    { GPIOC,  2,  0,  3,   0,    0,    0 },    // IN12
+    { GPIOC,  3,  0,  3,   0,    0,    0 },    // IN13
+    { GPIOF,  4,  0,  3,   0,    0,    0 },    // IN14
+    { GPIOF,  5,  0,  3,   0,    0,    0 },    // IN15
+};
+
+/**
+ * @brief   Channels of ADC1, ADC2 and ADC3 (triple mode)
+ */
+#define TRIPLECHANNELS                  ((1U<<0)|(1U<<1)|(1U<<2)|(1U<<3)\
+                                        |(1U<<10)|(1U<<11)|(1U<<12)|(1U<<13))
+
+/**
+ * @brief   Cycles of the sampling time codes
+ */
+static const uint16_t smptab[8] = { 3, 15, 28, 56, 84, 112, 144, 480 };
+
+/**
+ * @brief   External trigger TIM2 TRGO
+ */
+#define EXTSEL_TIM2_TRGO                (11U)
+
+/**
+ * @brief   State
+ */
+///@{
+static int              adcmode = 0;    ///< 0 when not initialized
+static int              running = 0;
+static int              dmah = -1;
+static uint16_t        *buffers[2];
+static unsigned         nsamples;
+static ADC_Callback     callback = 0;
+static void            *callbackarg = 0;
+static ADC_Stats        stats;
+///@}
+
+/**
+ * @brief   Busy wait using the cycle counter
+ */
+static void DelayCycles( uint32_t cycles ) {
+uint32_t t0 = DWT->CYCCNT;
+
+    while( DWT->CYCCNT-t0 < cycles ) {}
+}
+
+/**
+ * @brief   Stop the conversions and the stream
+ */
+static void StopConversions( void ) {
+
+    TIM2->CR1 &= ~TIM_CR1_CEN;
+    ADC1->CR2 &= ~ADC_CR2_ADON;
+    ADC2->CR2 &= ~ADC_CR2_ADON;
+    ADC3->CR2 &= ~ADC_CR2_ADON;
+    DMA_Stop(dmah);
+    ADC1->SR = 0;
+    ADC2->SR = 0;
+    ADC3->SR = 0;
+}
+
+/**
+ * @brief   Start the stream and the conversions from the first buffer
+ *
+ * @note    The ADCs need 3 us (tSTAB) after ADON before converting
+ */
+static int StartConversions( void ) {
+uint32_t n;
+
+    n = adcmode == ADC_MODE_TRIPLE ? nsamples/2 : nsamples;
+    if( DMA_Start(dmah,buffers[0],buffers[1],n) < 0 )
+        return ADC_ERROR_DMA;
+
+    if( adcmode == ADC_MODE_TRIPLE ) {
+        ADC1->CR2 |= ADC_CR2_ADON;
+        ADC2->CR2 |= ADC_CR2_ADON;
+        ADC3->CR2 |= ADC_CR2_ADON;
+        DelayCycles(SystemCoreClock/1000000*3);
+        ADC1->CR2 |= ADC_CR2_SWSTART;
+    } else {
+        ADC3->CR2 |= ADC_CR2_ADON;
+        DelayCycles(SystemCoreClock/1000000*3);
+        TIM2->EGR = TIM_EGR_UG;
+        TIM2->CR1 |= TIM_CR1_CEN;
+    }
+    return ADC_OK;
+}
+
+/**
+ * @brief   DMA callback
+ *
+ * @note    In double buffer mode, the completed buffer is the one that is not
+ *          being transferred now. If the stream is in it again when the
+ *          callback returns, it is already overwriting the samples
+ */
+static void DMADone( void *arg, int event ) {
+uint32_t t0,cycles;
+uint16_t *buf;
+int done;
+
+    (void) arg;
+    if( event == DMA_EVENT_ERROR ) {
+        stats.dmaerrors++;
+        StopConversions();
+        StartConversions();
+        return;
+    }
+    if( event != DMA_EVENT_FULL )
+        return;
+
+    t0 = DWT->CYCCNT;
+    done = DMA_CurrentBuffer(dmah)^1;
+    buf = buffers[done];
+    SCB_InvalidateDCache_by_Addr((uint32_t *) buf,nsamples*sizeof(uint16_t));
+    if( callback )
+        callback(buf,nsamples,callbackarg);
+    if( DMA_CurrentBuffer(dmah) == done )
+        stats.late++;
+
+    cycles = DWT->CYCCNT-t0;
+    stats.buffers++;
+    stats.cycles = cycles;
+    if( cycles > stats.maxcycles )
+        stats.maxcycles = cycles;
+}
+
+/**
+ * @brief   ADC interrupt (ADC1, ADC2 and ADC3)
+ *
+ * @note    Only overruns are enabled
+ */
+void ADC_IRQHandler( void ) {
+
+    if( (ADC1->SR|ADC2->SR|ADC3->SR)&ADC_SR_OVR ) {
+        stats.overruns++;
+        StopConversions();
+        if( running )
+            StartConversions();
+    }
+}
+
+/**
+ * @brief   Set the sampling time of a channel
+ */
+static void SetSampleTime( ADC_TypeDef *adc, unsigned ch, unsigned smp ) {
+
+    if( ch < 10 )
+        adc->SMPR2 = (adc->SMPR2&~(7U<<(3*ch)))|(smp<<(3*ch));
+    else
+        adc->SMPR1 = (adc->SMPR1&~(7U<<(3*(ch-10))))|(smp<<(3*(ch-10)));
+}
+
+/**
+ * @brief   Set the regular sequence
+ */
+static void SetSequence( ADC_TypeDef *adc, const uint8_t *channels, unsigned n ) {
+uint32_t sqr[3] = { 0, 0, 0 };
+unsigned i;
+
+    for(i=0;i<n;i++)
+        sqr[i/6] |= (uint32_t) channels[i]<<(5*(i%6));
+    adc->SQR3 = sqr[0];
+    adc->SQR2 = sqr[1];
+    adc->SQR1 = sqr[2]|((n-1)<<ADC_SQR1_L_Pos);
+}
+
+/**
+ * @brief   Configure a DMA stream for the ADC data register
+ */
+static int ConfigureDMA( int request, volatile uint32_t *dr, int size ) {
+DMA_Config conf;
+int h;
+
+    h = DMA_Allocate(request);
+    if( h < 0 )
+        return h;
+    conf.dir      = DMA_DIR_P2M;
+    conf.periph   = dr;
+    conf.psize    = size;
+    conf.msize    = size;
+    conf.burst    = size == DMA_SIZE_32 ? DMA_BURST_4 : DMA_BURST_SINGLE;
+    conf.priority = 3;
+    conf.flags    = DMA_FLAG_MINC|DMA_FLAG_DOUBLEBUFFER;
+    conf.callback = DMADone;
+    conf.arg      = 0;
+    if( DMA_Configure(h,&conf) < 0 ) {
+        DMA_Free(h);
+        return DMA_ERROR_PARAMETER;
+    }
+    return h;
+}
+
+/**
+ * @brief   Scan mode: ADC3 and TIM2
+ */
+static int ConfigureScan( const ADC_Config *conf, uint32_t adcclk ) {
+uint32_t timclk,arr;
+unsigned i;
+
+    if( conf->rate == 0 || conf->nchannels == 0 || conf->nchannels > 16
+        || (conf->n%conf->nchannels) != 0 )
+        return ADC_ERROR_PARAMETER;
+    for(i=0;i<conf->nchannels;i++) {
+        if( conf->channels[i] > 15 )
+            return ADC_ERROR_PARAMETER;
+    }
+    if( (uint64_t) conf->rate*conf->nchannels*(smptab[conf->sampletime]+12) > adcclk )
+        return ADC_ERROR_RATE;
+
+    // TIM2 (32 bits) generates TRGO on update
+    timclk = SystemGetAPB1Frequency();
+    if( SystemGetAPB1Prescaler() != 1 )
+        timclk *= 2;
+    arr = timclk/conf->rate;
+    if( arr < 2 )
+        return ADC_ERROR_RATE;
+    RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;
+    __DSB();
+    RCC->APB1RSTR |= RCC_APB1RSTR_TIM2RST;
+    RCC->APB1RSTR &= ~RCC_APB1RSTR_TIM2RST;
+    TIM2->PSC = 0;
+    TIM2->ARR = arr-1;
+    TIM2->CR2 = 2U<<TIM_CR2_MMS_Pos;
+
+    for(i=0;i<conf->nchannels;i++) {
+        GPIO_ConfigureSinglePin(&adcpins[conf->channels[i]]);
+        SetSampleTime(ADC3,conf->channels[i],conf->sampletime);
+    }
+    SetSequence(ADC3,conf->channels,conf->nchannels);
+    ADC3->CR1 = ADC_CR1_SCAN|ADC_CR1_OVRIE;
+    ADC3->CR2 = ADC_CR2_DMA|ADC_CR2_DDS
+               |(1U<<ADC_CR2_EXTEN_Pos)
+               |(EXTSEL_TIM2_TRGO<<ADC_CR2_EXTSEL_Pos);
+
+    dmah = ConfigureDMA(DMA_REQ_ADC3,&ADC3->DR,DMA_SIZE_16);
+    if( dmah < 0 )
+        return ADC_ERROR_DMA;
+    stats.rate = timclk/arr*conf->nchannels;
+    return ADC_OK;
+}
+
+/**
+ * @brief   Triple interleaved mode: ADC1, ADC2 and ADC3 on one channel
+ */
+static int ConfigureTriple( const ADC_Config *conf, uint32_t adcclk ) {
+ADC_TypeDef *adc[3] = { ADC1, ADC2, ADC3 };
+unsigned ch,delay,i;
+
+    if( conf->nchannels != 1 || conf->channels[0] > 15
+        || (TRIPLECHANNELS&(1U<<conf->channels[0])) == 0
+        || (conf->n%8) != 0 || conf->n/2 > 65535 )
+        return ADC_ERROR_PARAMETER;
+
+    // Each ADC must end its conversion before its next turn
+    delay = (smptab[conf->sampletime]+12+2)/3;
+    if( delay < 5 )
+        delay = 5;
+    if( delay > 20 )
+        return ADC_ERROR_RATE;
+
+    ch = conf->channels[0];
+    GPIO_ConfigureSinglePin(&adcpins[ch]);
+    for(i=0;i<3;i++) {
+        SetSampleTime(adc[i],ch,conf->sampletime);
+        SetSequence(adc[i],conf->channels,1);
+        adc[i]->CR1 = ADC_CR1_OVRIE;
+        adc[i]->CR2 = ADC_CR2_CONT;
+    }
+    ADC->CCR = (ADC->CCR&ADC_CCR_ADCPRE)
+              |(0x17U<<ADC_CCR_MULTI_Pos)
+              |((delay-5)<<ADC_CCR_DELAY_Pos)
+              |(2U<<ADC_CCR_DMA_Pos)
+              |ADC_CCR_DDS;
+
+    dmah = ConfigureDMA(DMA_REQ_ADC1,&ADC->CDR,DMA_SIZE_32);
+    if( dmah < 0 )
+        return ADC_ERROR_DMA;
+    stats.rate = adcclk/delay;
+    return ADC_OK;
+}
+
+/**
+ * @brief  ADC_Init
+ *
+ * @note   Configures the ADCs, the pins of the channels, the DMA stream and
+ *         TIM2 (scan mode). Does not start the acquisition
+ */
+int
+ADC_Init( const ADC_Config *conf ) {
+uint32_t pclk2,adcclk;
+unsigned pre;
+int rc;
+
+    if( !conf || !conf->channels || conf->sampletime > 7 || conf->n == 0
+        || conf->n > 65535 || !conf->buffer[0] || !conf->buffer[1]
+        || (conf->mode != ADC_MODE_SCAN && conf->mode != ADC_MODE_TRIPLE) )
+        return ADC_ERROR_PARAMETER;
+
+    ADC_Stop();
+    DMA_Free(dmah);
+    dmah    = -1;
+    adcmode = 0;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    RCC->APB2ENR |= RCC_APB2ENR_ADC1EN|RCC_APB2ENR_ADC2EN|RCC_APB2ENR_ADC3EN;
+    __DSB();
+    RCC->APB2RSTR |= RCC_APB2RSTR_ADCRST;
+    RCC->APB2RSTR &= ~RCC_APB2RSTR_ADCRST;
+
+    // ADCPRE: 0 = /2, 1 = /4, 2 = /6, 3 = /8
+    pclk2 = SystemGetAPB2Frequency();
+    for(pre=0;pre<3&&pclk2/(2*(pre+1))>ADC_MAXCLOCK;pre++) {}
+    adcclk = pclk2/(2*(pre+1));
+    ADC->CCR = pre<<ADC_CCR_ADCPRE_Pos;
+
+    ADC_ResetStats();
+    if( conf->mode == ADC_MODE_TRIPLE )
+        rc = ConfigureTriple(conf,adcclk);
+    else
+        rc = ConfigureScan(conf,adcclk);
+    if( rc < 0 )
+        return rc;
+
+    buffers[0]  = conf->buffer[0];
+    buffers[1]  = conf->buffer[1];
+    nsamples    = conf->n;
+    callback    = conf->callback;
+    callbackarg = conf->arg;
+    adcmode     = conf->mode;
+
+    NVIC_SetPriority(ADC_IRQn,ADC_IRQ_PRIO);
+    NVIC_ClearPendingIRQ(ADC_IRQn);
+    NVIC_EnableIRQ(ADC_IRQn);
+    return ADC_OK;
+}
+
+/**
+ * @brief  ADC_Start
+ *
+ * @note   The first callback comes after n samples
+ */
+int
+ADC_Start( void ) {
+int rc;
+
+    if( !adcmode )
+        return ADC_ERROR_NOTINITIALIZED;
+    running = 1;
+    rc = StartConversions();
+    if( rc < 0 )
+        running = 0;
+    return rc;
+}
+
+/**
+ * @brief  ADC_Stop
+ *
+ * @note   The samples in the buffer being filled are lost
+ */
+void
+ADC_Stop( void ) {
+
+    running = 0;
+    if( adcmode )
+        StopConversions();
+}
+
+/**
+ * @brief  ADC_GetStats
+ */
+void
+ADC_GetStats( ADC_Stats *s ) {
+uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    *s = stats;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  ADC_ResetStats
+ *
+ * @note   The rate is kept
+ */
+void
+ADC_ResetStats( void ) {
+uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    stats.buffers   = 0;
+    stats.overruns  = 0;
+    stats.late      = 0;
+    stats.dmaerrors = 0;
+    stats.cycles    = 0;
+    stats.maxcycles = 0;
+    __set_PRIMASK(primask);
+}
@@ -0,0 +1,123 @@
+#ifndef ADC_H
+#define ADC_H
+/**
+ * @file    adc.h
+ *
+ * @brief   Acquisition with ADC1..3 and DMA double buffering
+ *
+ * @note    Two modes
+ *          - ADC_MODE_SCAN: ADC3 converts a sequence of channels at each
+ *            update of TIM2 (TRGO). The pins of the Arduino connector A0-A5
+ *            are ADC3 channels (table below)
+ *          - ADC_MODE_TRIPLE: ADC1, ADC2 and ADC3 convert the same channel in
+ *            triple interleaved mode, started by software and continuous.
+ *            The rate is ADCCLK/5 (5 MSPS with ADCCLK = 25 MHz)
+ *
+ * | Pin  | Connector | Channel          |
+ * |------|-----------|------------------|
+ * | PA0  | A0        | ADC123_IN0       |
+ * | PF10 | A1        | ADC3_IN8         |
+ * | PF9  | A2        | ADC3_IN7         |
+ * | PF8  | A3        | ADC3_IN6         |
+ * | PF7  | A4        | ADC3_IN5         |
+ * | PF6  | A5        | ADC3_IN4         |
+ *
+ * @note    The DMA stream runs in double buffer mode (DBM): while one buffer
+ *          is filled, the other one is given to the callback. The samples are
+ *          right aligned 12 bit values, in the order of the sequence (scan) or
+ *          in the order of conversion (triple, ADC1, ADC2, ADC3, ADC1, ...)
+ *
+ * @note    The buffers can be in DTCM, SRAM or SDRAM. In cacheable memory,
+ *          they are invalidated before the callback, so they must be aligned
+ *          and padded to 32 bytes (cache line)
+ *
+ * @note    Errors are counted, the acquisition does not stop
+ *          - overruns: the ADC converted again before the DMA read the data.
+ *            The ADC and the stream are restarted and the buffer being filled
+ *            is discarded
+ *          - late: the callback of a buffer did not return before the DMA
+ *            finished the other one and started to overwrite it
+ *          - dmaerrors: transfer or direct mode errors of the stream
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Modes
+ */
+///@{
+#define ADC_MODE_SCAN                   (1)
+#define ADC_MODE_TRIPLE                 (2)
+///@}
+
+/**
+ * @brief   Maximal ADC clock (datasheet, VDDA >= 2.4 V)
+ */
+#define ADC_MAXCLOCK                    (36000000)
+
+/**
+ * @brief   Priority of the ADC interrupt (overruns)
+ *
+ * @note    The same as DMA_IRQ_PRIO, so that a restart does not preempt the
+ *          callback
+ */
+#ifndef ADC_IRQ_PRIO
+#define ADC_IRQ_PRIO                    (12)
+#endif
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define ADC_OK                          (0)
+#define ADC_ERROR_PARAMETER             (-1)
+#define ADC_ERROR_RATE                  (-2)    ///< rate too high for the sequence
+#define ADC_ERROR_DMA                   (-3)    ///< no stream or bad alignment
+#define ADC_ERROR_NOTINITIALIZED        (-4)
+///@}
+
+/**
+ * @brief   Callback
+ *
+ * @note    Called from the DMA interrupt with a full buffer of n samples
+ */
+typedef void (*ADC_Callback)(const uint16_t *samples, unsigned n, void *arg);
+
+/**
+ * @brief   Configuration
+ */
+typedef struct {
+    int             mode;                   ///< ADC_MODE_*
+    unsigned        rate;                   ///< scan: sequences per second
+    const uint8_t  *channels;               ///< scan: sequence (1 to 16 channels)
+    unsigned        nchannels;              ///< scan: 1 for triple mode
+    unsigned        sampletime;             ///< SMP code, 0 (3 cycles) to 7 (480)
+    uint16_t       *buffer[2];
+    unsigned        n;                      ///< samples in each buffer
+    ADC_Callback    callback;
+    void           *arg;
+} ADC_Config;
+
+/**
+ * @brief   Statistics
+ */
+typedef struct {
+    uint32_t    rate;                       ///< samples per second (actual)
+    uint32_t    buffers;                    ///< callbacks
+    uint32_t    overruns;
+    uint32_t    late;
+    uint32_t    dmaerrors;
+    uint32_t    cycles;                     ///< duration of last callback
+    uint32_t    maxcycles;                  ///< longest callback
+} ADC_Stats;
+
+int  ADC_Init( const ADC_Config *conf );
+int  ADC_Start( void );
+void ADC_Stop( void );
+void ADC_GetStats( ADC_Stats *s );
+void ADC_ResetStats( void );
+
+#endif // ADC_H
@@ -0,0 +1,373 @@
+/**
+ * @file    dsp.c
+ *
+ * @brief   Chain of signal processing stages using CMSIS-DSP (see dsp.h)
+ *
+ * @note    The block is converted to floats (1.0 is full scale), one buffer
+ *          for each channel. Each stage reads one buffer and writes the other
+ *          of a pair, and the pair is swapped after it
+ *
+ * @note    arm_fir_f32 uses the coefficients in reverse order (h[N-1] first).
+ *          For the biquads, each section has 5 coefficients {b0,b1,b2,a1,a2}
+ *          with a1 and a2 negated, i.e.
+ *          y[n] = b0*x[n]+b1*x[n-1]+b2*x[n-2]+a1*y[n-1]+a2*y[n-2]
+ *
+ * @note    The magnitude of the FFT of a sine with amplitude A (full scale is
+ *          1.0) is about A*size/4 at its bin, because of the Hann window.
+ *          Bin k is k*fs/size Hz
+ *
+ * @note    The statistics are updated in DSP_Process, so they are read and
+ *          cleared with the interrupts disabled
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "stm32f746xx.h"
+#include "arm_math.h"
+#include "memsections.h"
+#include "dsp.h"
+
+/**
+ * @brief   Time of a stage
+ */
+typedef struct {
+    uint32_t    cycles;
+    uint32_t    maxcycles;
+    uint64_t    total;
+} DSP_Time;
+
+/**
+ * @brief   FIR stage
+ */
+typedef struct {
+    arm_fir_instance_f32    inst[DSP_CHANNELS];
+    float32_t               coefs[DSP_MAXTAPS];
+    float32_t               state[DSP_CHANNELS][DSP_MAXTAPS+DSP_MAXFRAMES-1];
+} DSP_FIR;
+
+/**
+ * @brief   Biquad cascade stage
+ */
+typedef struct {
+    arm_biquad_cascade_df2T_instance_f32    inst[DSP_CHANNELS];
+    float32_t               coefs[5*DSP_MAXSECTIONS];
+    float32_t               state[DSP_CHANNELS][2*DSP_MAXSECTIONS];
+} DSP_Biquad;
+
+/**
+ * @brief   Stage. The FFT stage uses the fft variables below
+ */
+typedef struct {
+    unsigned    type;
+    DSP_Time    time;
+    union {
+        DSP_FIR     fir;
+        DSP_Biquad  biquad;
+    } u;
+} DSP_Stage;
+
+/**
+ * @brief   Chain
+ */
+///@{
+static DSP_Stage    stages[DSP_MAXSTAGES] DTCM_BSS;
+static unsigned     nstages DTCM_BSS;
+///@}
+
+/**
+ * @brief   Buffers of the block (float), two for each channel
+ */
+static float32_t    buf[2][DSP_CHANNELS][DSP_MAXFRAMES] DTCM_BSS;
+
+/**
+ * @brief   FFT stage
+ */
+///@{
+static arm_rfft_fast_instance_f32 fftinst DTCM_BSS;
+static unsigned     fftsize DTCM_BSS;           ///< 0 when there is no FFT stage
+static unsigned     fftpos DTCM_BSS;            ///< samples in fftin
+static float32_t    fftwindow[DSP_MAXFFT] DTCM_BSS;
+static float32_t    fftin[DSP_MAXFFT] DTCM_BSS;
+static float32_t    fftout[DSP_MAXFFT] DTCM_BSS;
+static float32_t    spectrum[DSP_MAXFFT/2] DTCM_BSS;
+static volatile unsigned spectra DTCM_BSS;      ///< FFTs computed
+static unsigned     spectraread DTCM_BSS;       ///< value of spectra at last read
+///@}
+
+/**
+ * @brief   Statistics
+ */
+///@{
+static volatile unsigned blocks DTCM_BSS;
+static uint64_t     samples DTCM_BSS;
+static DSP_Time     chaintime DTCM_BSS;
+///@}
+
+/**
+ * @brief   Add the cycles of a block
+ */
+static void ITCM_CODE
+AddTime( DSP_Time *t, uint32_t cycles ) {
+
+    t->cycles = cycles;
+    if( cycles > t->maxcycles )
+        t->maxcycles = cycles;
+    t->total += cycles;
+}
+
+/**
+ * @brief   Collect samples of the first channel and compute the FFT when
+ *          fftsize samples are available
+ *
+ * @note    fftout is packed: fftout[0] is the DC bin and fftout[1] the real
+ *          part of the Nyquist bin, that is not in the spectrum
+ */
+static void ITCM_CODE
+FFTStage( const float32_t *x, unsigned frames ) {
+unsigned i;
+
+    for(i=0;i<frames;i++) {
+        fftin[fftpos] = x[i]*fftwindow[fftpos];
+        if( ++fftpos < fftsize )
+            continue;
+        fftpos = 0;
+        arm_rfft_fast_f32(&fftinst,fftin,fftout,0);
+        arm_cmplx_mag_f32(fftout,spectrum,fftsize/2);
+        spectrum[0] = fftout[0] < 0.0f ? -fftout[0] : fftout[0];
+        spectra++;
+    }
+}
+
+/**
+ * @brief  DSP_Process
+ *
+ * @note   frames must not be greater than DSP_MAXFRAMES. It is called from
+ *         the DMA interrupt, usually by the callback of Audio_Start
+ */
+int ITCM_CODE
+DSP_Process( const int16_t *in, int16_t *out, unsigned frames ) {
+float32_t *x[DSP_CHANNELS],*y[DSP_CHANNELS],*t;
+DSP_Stage *st;
+uint32_t t0,tchain;
+unsigned i,c,k;
+
+    if( frames == 0 || frames > DSP_MAXFRAMES )
+        return DSP_ERROR_PARAMETER;
+
+    tchain = DWT->CYCCNT;
+
+    for(c=0;c<DSP_CHANNELS;c++) {
+        x[c] = buf[0][c];
+        y[c] = buf[1][c];
+    }
+    for(i=0;i<frames;i++) {
+        for(c=0;c<DSP_CHANNELS;c++)
+            x[c][i] = (float32_t) in[i*DSP_CHANNELS+c]*(1.0f/32768.0f);
+    }
+
+    for(k=0;k<nstages;k++) {
+        st = &stages[k];
+        t0 = DWT->CYCCNT;
+        switch( st->type ) {
+        case DSP_STAGE_FIR:
+            for(c=0;c<DSP_CHANNELS;c++) {
+                arm_fir_f32(&st->u.fir.inst[c],x[c],y[c],frames);
+                t = x[c]; x[c] = y[c]; y[c] = t;
+            }
+            break;
+        case DSP_STAGE_BIQUAD:
+            for(c=0;c<DSP_CHANNELS;c++) {
+                arm_biquad_cascade_df2T_f32(&st->u.biquad.inst[c],x[c],y[c],frames);
+                t = x[c]; x[c] = y[c]; y[c] = t;
+            }
+            break;
+        case DSP_STAGE_FFT:
+            FFTStage(x[0],frames);
+            break;
+        }
+        AddTime(&st->time,DWT->CYCCNT-t0);
+    }
+
+    // The conversion saturates values outside [-1.0,1.0)
+    for(i=0;i<frames;i++) {
+        for(c=0;c<DSP_CHANNELS;c++)
+            out[i*DSP_CHANNELS+c] = (int16_t) __SSAT((int32_t) (x[c][i]*32768.0f),16);
+    }
+
+    samples += frames*DSP_CHANNELS;
+    blocks++;
+    AddTime(&chaintime,DWT->CYCCNT-tchain);
+    return DSP_OK;
+}
+
+/**
+ * @brief  DSP_Init
+ *
+ * @note   Removes all stages and starts the cycle counter
+ */
+void
+DSP_Init( void ) {
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    nstages = 0;
+    fftsize = 0;
+    fftpos  = 0;
+    DSP_ResetStats();
+}
+
+/**
+ * @brief  DSP_AddFIR
+ *
+ * @note   coefs (ntaps values, reverse order) are copied. Returns the index of
+ *         the stage
+ */
+int
+DSP_AddFIR( const float32_t *coefs, unsigned ntaps ) {
+DSP_FIR *fir;
+unsigned c;
+
+    if( ntaps == 0 || ntaps > DSP_MAXTAPS )
+        return DSP_ERROR_PARAMETER;
+    if( nstages == DSP_MAXSTAGES )
+        return DSP_ERROR_NOSTAGE;
+
+    fir = &stages[nstages].u.fir;
+    memcpy(fir->coefs,coefs,ntaps*sizeof(float32_t));
+    for(c=0;c<DSP_CHANNELS;c++)
+        arm_fir_init_f32(&fir->inst[c],ntaps,fir->coefs,fir->state[c],DSP_MAXFRAMES);
+    stages[nstages].type = DSP_STAGE_FIR;
+    return nstages++;
+}
+
+/**
+ * @brief  DSP_AddBiquad
+ *
+ * @note   coefs (5*nsections values) are copied. Returns the index of the
+ *         stage
+ */
+int
+DSP_AddBiquad( const float32_t *coefs, unsigned nsections ) {
+DSP_Biquad *bq;
+unsigned c;
+
+    if( nsections == 0 || nsections > DSP_MAXSECTIONS )
+        return DSP_ERROR_PARAMETER;
+    if( nstages == DSP_MAXSTAGES )
+        return DSP_ERROR_NOSTAGE;
+
+    bq = &stages[nstages].u.biquad;
+    memcpy(bq->coefs,coefs,5*nsections*sizeof(float32_t));
+    memset(bq->state,0,sizeof(bq->state));
+    for(c=0;c<DSP_CHANNELS;c++)
+        arm_biquad_cascade_df2T_init_f32(&bq->inst[c],nsections,bq->coefs,bq->state[c]);
+    stages[nstages].type = DSP_STAGE_BIQUAD;
+    return nstages++;
+}
+
+/**
+ * @brief  DSP_AddFFT
+ *
+ * @note   size is a power of 2 from 32 to DSP_MAXFFT. Returns the index of
+ *         the stage
+ */
+int
+DSP_AddFFT( unsigned size ) {
+unsigned i;
+
+    if( size < 32 || size > DSP_MAXFFT || (size&(size-1)) != 0 )
+        return DSP_ERROR_PARAMETER;
+    if( fftsize != 0 )
+        return DSP_ERROR_FFT;
+    if( nstages == DSP_MAXSTAGES )
+        return DSP_ERROR_NOSTAGE;
+
+    if( arm_rfft_fast_init_f32(&fftinst,size) != ARM_MATH_SUCCESS )
+        return DSP_ERROR_PARAMETER;
+    for(i=0;i<size;i++)
+        fftwindow[i] = 0.5f-0.5f*arm_cos_f32(2.0f*PI*i/size);
+    fftpos  = 0;
+    fftsize = size;
+    stages[nstages].type = DSP_STAGE_FFT;
+    return nstages++;
+}
+
+/**
+ * @brief  DSP_GetSpectrum
+ *
+ * @note   Copies the magnitude of the last FFT (up to size/2 bins) to mag.
+ *         Returns the number of bins or DSP_ERROR_NOSPECTRUM when there was no
+ *         new FFT since the last call
+ */
+int
+DSP_GetSpectrum( float32_t *mag, unsigned n ) {
+uint32_t primask;
+
+    if( fftsize == 0 )
+        return DSP_ERROR_PARAMETER;
+    if( spectra == spectraread )
+        return DSP_ERROR_NOSPECTRUM;
+    if( n > fftsize/2 )
+        n = fftsize/2;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    memcpy(mag,spectrum,n*sizeof(float32_t));
+    spectraread = spectra;
+    __set_PRIMASK(primask);
+    return n;
+}
+
+/**
+ * @brief  Fill a DSP_StageStats
+ */
+static void
+StageStats( DSP_StageStats *s, unsigned type, const DSP_Time *t, uint64_t n ) {
+
+    s->type      = type;
+    s->cycles    = t->cycles;
+    s->maxcycles = t->maxcycles;
+    s->cps100    = n ? (uint32_t) ((t->total*100)/n) : 0;
+}
+
+/**
+ * @brief  DSP_GetStats
+ */
+void
+DSP_GetStats( DSP_Stats *s ) {
+uint32_t primask;
+unsigned k;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    s->blocks  = blocks;
+    s->spectra = spectra;
+    s->nstages = nstages;
+    StageStats(&s->chain,0,&chaintime,samples);
+    for(k=0;k<nstages;k++)
+        StageStats(&s->stage[k],stages[k].type,&stages[k].time,samples);
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  DSP_ResetStats
+ */
+void
+DSP_ResetStats( void ) {
+uint32_t primask;
+unsigned k;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    blocks  = 0;
+    samples = 0;
+    memset(&chaintime,0,sizeof(chaintime));
+    for(k=0;k<DSP_MAXSTAGES;k++)
+        memset(&stages[k].time,0,sizeof(stages[k].time));
+    __set_PRIMASK(primask);
+}
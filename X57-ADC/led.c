@@ -0,0 +1,11 @@
+/**
+ * @file    led.c
+ *
+ * @date    07/10/2020
+ * @author  Hans
+ */
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "led.h"
+
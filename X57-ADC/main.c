@@ -0,0 +1,307 @@
+/**
+ * @file     main.c
+ * @brief    Acquisition with the ADCs, DMA double buffering, DSP and SD logging
+ * @version  V1.0
+ * @date     15/10/2026
+ *
+ * @note     Scan mode (default): A0 and A1 are sampled at 48 kHz by ADC3,
+ *           triggered by TIM2, into two buffers in DTCM. Each buffer goes thru
+ *           the DSP chain (4 kHz low-pass FIR and a 1024 point FFT that finds
+ *           the strongest frequency of A0)
+ *
+ * @note     Triple mode (ACQ_TRIPLE in the Makefile): A0 is sampled at 5 MSPS
+ *           by ADC1..3 interleaved into two buffers in SDRAM. The callback only
+ *           finds the minimum and the maximum, the DSP chain is too slow for
+ *           this rate
+ *
+ * @note     With ACQ_LOG (Makefile), the samples are streamed to the last
+ *           LOG_MB MB of the MicroSD card, destroying their contents
+ *
+ * @note     Every second, the counters are printed thru the UART
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "led.h"
+#include "memsections.h"
+#include "sdram.h"
+#include "adc.h"
+#ifndef ACQ_TRIPLE
+#include "dsp.h"
+#endif
+#ifdef ACQ_LOG
+#include "sdcard.h"
+#include "buddy.h"
+#include "streamlog.h"
+#endif
+
+/**
+ * @brief   Systick routine
+ *
+ * @note    It is called every 1ms. It counts the SD timeouts
+ */
+static volatile uint32_t tick_ms = 0;
+
+void SysTick_Handler(void) {
+
+    tick_ms++;
+#ifdef ACQ_LOG
+    SD_ProcessTimeouts();
+#endif
+}
+
+#ifdef ACQ_LOG
+/**
+ * @brief   Logger parameters
+ *
+ * @note    The pool takes 4 MB of SDRAM after the first MB. Four buffers of
+ *          256 KB hold more than 5 s of scan mode data (192 KB/s). In triple
+ *          mode (10 MB/s), most cards can not keep up and samples are dropped
+ */
+///@{
+#define LOG_POOL            ((char *) SDRAM_ADDRESS+0x100000)
+#define LOG_POOLSIZE        0x400000
+#define LOG_BUFFERS         4
+#define LOG_BUFFERSIZE      (256*1024)
+#define LOG_MB              (64)
+#define LOG_BLOCKS          (LOG_MB*2048)
+///@}
+#endif
+
+#ifdef ACQ_TRIPLE
+/**
+ * @brief   Triple mode: A0 (IN0), buffers of 32K samples in SDRAM
+ */
+///@{
+#define NSAMPLES            (32768)
+#define BUFFER0             ((uint16_t *) SDRAM_ADDRESS)
+#define BUFFER1             ((uint16_t *) SDRAM_ADDRESS+NSAMPLES)
+
+static const uint8_t channels[] = { 0 };
+
+static volatile uint16_t minvalue = 0xFFFF;
+static volatile uint16_t maxvalue = 0;
+///@}
+
+/**
+ * @brief   Minimum and maximum of the buffer (and logging)
+ */
+static void Process( const uint16_t *samples, unsigned n, void *arg ) {
+uint16_t lo = minvalue, hi = maxvalue;
+unsigned i;
+
+    (void) arg;
+    for(i=0;i<n;i++) {
+        if( samples[i] < lo )
+            lo = samples[i];
+        if( samples[i] > hi )
+            hi = samples[i];
+    }
+    minvalue = lo;
+    maxvalue = hi;
+#ifdef ACQ_LOG
+    StreamLog_Put(samples,n);
+#endif
+}
+#else
+/**
+ * @brief   Scan mode: A0 (IN0) and A1 (IN8) at 48 kHz, buffers of 256
+ *          sequences in DTCM
+ */
+///@{
+#define FREQUENCY           (48000)
+#define FRAMES              (256)
+#define NSAMPLES            (FRAMES*DSP_CHANNELS)
+#define FFTSIZE             (1024)
+
+static const uint8_t channels[DSP_CHANNELS] = { 0, 8 };
+
+static uint16_t buffer0[NSAMPLES] DTCM_BSS __attribute__((aligned(32)));
+static uint16_t buffer1[NSAMPLES] DTCM_BSS __attribute__((aligned(32)));
+#define BUFFER0             buffer0
+#define BUFFER1             buffer1
+
+static int16_t work[NSAMPLES] DTCM_BSS;
+static float32_t spectrum[FFTSIZE/2];
+///@}
+
+/**
+ * @brief   Low-pass FIR at 4 kHz for 48 kHz (31 taps, Hamming window)
+ */
+static const float32_t lowpass[31] = {
+    0.00169225f,  0.00176751f,  0.00146163f,  0.00000000f, -0.00334892f,
+   -0.00851838f, -0.01402633f, -0.01689652f, -0.01332832f,  0.00000000f,
+    0.02443181f,  0.05824102f,  0.09647368f,  0.13192928f,  0.15705336f,
+    0.16613590f,  0.15705336f,  0.13192928f,  0.09647368f,  0.05824102f,
+    0.02443181f,  0.00000000f, -0.01332832f, -0.01689652f, -0.01402633f,
+   -0.00851838f, -0.00334892f,  0.00000000f,  0.00146163f,  0.00176751f,
+    0.00169225f
+};
+
+/**
+ * @brief   Convert to signed samples and run the DSP chain (and logging)
+ *
+ * @note    The 12 bit values are centered and scaled to 16 bits
+ */
+static void Process( const uint16_t *samples, unsigned n, void *arg ) {
+unsigned i;
+
+    (void) arg;
+    for(i=0;i<n;i++)
+        work[i] = (int16_t) ((samples[i]-2048)<<4);
+    DSP_Process(work,work,n/DSP_CHANNELS);
+#ifdef ACQ_LOG
+    StreamLog_Put(samples,n/DSP_CHANNELS);
+#endif
+}
+
+/**
+ * @brief   Configure the DSP chain
+ */
+static int ConfigDSP( void ) {
+
+    DSP_Init();
+    if( DSP_AddFIR(lowpass,sizeof(lowpass)/sizeof(lowpass[0])) < 0 )
+        return -1;
+    if( DSP_AddFFT(FFTSIZE) < 0 )
+        return -1;
+    return 0;
+}
+
+/**
+ * @brief   Print the time of the DSP chain and the strongest frequency
+ */
+static void PrintDSP( void ) {
+DSP_Stats s;
+unsigned k,peak;
+int n;
+
+    DSP_GetStats(&s);
+    printf("  dsp %lu cycles (max %lu) %lu.%02lu cycles/sample\n",
+            (unsigned long) s.chain.cycles,(unsigned long) s.chain.maxcycles,
+            (unsigned long) s.chain.cps100/100,(unsigned long) s.chain.cps100%100);
+
+    n = DSP_GetSpectrum(spectrum,FFTSIZE/2);
+    if( n <= 0 )
+        return;
+    peak = 1;
+    for(k=2;k<(unsigned) n;k++) {
+        if( spectrum[k] > spectrum[peak] )
+            peak = k;
+    }
+    printf("  peak %u Hz\n",(peak*FREQUENCY)/FFTSIZE);
+}
+#endif
+
+#ifdef ACQ_LOG
+/**
+ * @brief   Initialize the card and start the logger at its end
+ */
+static int StartLog( unsigned samplesize ) {
+SD_CardInfo info;
+POOL pool;
+int rc;
+
+    SystemConfigPLLSAI(&PLLSAIConfiguration_48MHz);
+    rc = SD_Init();
+    if( rc < 0 )
+        return rc;
+    SD_GetCardInfo(&info);
+    if( info.blocks < LOG_BLOCKS )
+        return -1;
+    pool = Buddy_CreatePool(LOG_POOL,LOG_POOLSIZE,4096);
+    return StreamLog_Start(pool,LOG_BUFFERS,LOG_BUFFERSIZE,samplesize,
+                           info.blocks-LOG_BLOCKS,LOG_BLOCKS);
+}
+#endif
+
+/**
+ * @brief   main
+ */
+int main(void) {
+ADC_Config conf;
+ADC_Stats s;
+#ifdef ACQ_LOG
+StreamLog_Stats ls;
+#endif
+uint32_t last;
+int rc;
+
+    /* configure clock to 200 MHz */
+    SystemConfigMainPLL(&MainPLLConfiguration_200MHz);
+    SystemSetCoreClock(CLOCKSRC_PLL,1);
+
+    SysTick_Config(SystemCoreClock/1000);
+
+    LED_Init();
+    SDRAM_Init();
+
+    conf.channels   = channels;
+    conf.nchannels  = sizeof(channels)/sizeof(channels[0]);
+    conf.sampletime = 0;
+    conf.buffer[0]  = BUFFER0;
+    conf.buffer[1]  = BUFFER1;
+    conf.n          = NSAMPLES;
+    conf.callback   = Process;
+    conf.arg        = 0;
+#ifdef ACQ_TRIPLE
+    conf.mode       = ADC_MODE_TRIPLE;
+    conf.rate       = 0;
+#else
+    conf.mode       = ADC_MODE_SCAN;
+    conf.rate       = FREQUENCY;
+    conf.sampletime = 3;                    // 56 cycles
+    if( ConfigDSP() < 0 ) {
+        printf("DSP: error\n");
+        for(;;) {}
+    }
+#endif
+
+#ifdef ACQ_LOG
+    rc = StartLog(conf.mode == ADC_MODE_TRIPLE ? sizeof(uint16_t)
+                                               : conf.nchannels*sizeof(uint16_t));
+    if( rc < 0 ) {
+        printf("Log: error %d\n",rc);
+        for(;;) {}
+    }
+#endif
+
+    rc = ADC_Init(&conf);
+    if( rc == ADC_OK )
+        rc = ADC_Start();
+    if( rc != ADC_OK ) {
+        printf("ADC: error %d\n",rc);
+        for(;;) {}
+    }
+    ADC_GetStats(&s);
+    printf("\nADC: %lu samples/s, %u samples per buffer\n",
+            (unsigned long) s.rate,NSAMPLES);
+
+    last = tick_ms;
+    for(;;) {
+        if( tick_ms-last < 1000 )
+            continue;
+        last = tick_ms;
+        LED_Toggle();
+        ADC_GetStats(&s);
+        printf("buffers %lu overruns %lu late %lu dma errors %lu callback %lu cycles (max %lu)\n",
+                (unsigned long) s.buffers,(unsigned long) s.overruns,
+                (unsigned long) s.late,(unsigned long) s.dmaerrors,
+                (unsigned long) s.cycles,(unsigned long) s.maxcycles);
+#ifdef ACQ_TRIPLE
+        printf("  min %u max %u\n",minvalue,maxvalue);
+#else
+        PrintDSP();
+#endif
+#ifdef ACQ_LOG
+        StreamLog_GetStats(&ls);
+        printf("  log %lu samples %lu dropped %lu blocks high water %lu KB\n",
+                (unsigned long) ls.samples,(unsigned long) ls.dropped,
+                (unsigned long) ls.blockswritten,(unsigned long) (ls.highwater/1024));
+#endif
+    }
+}
@@ -0,0 +1,231 @@
+/**
+ * @file    streamlog.c
+ *
+ * @note    Streaming logger (see streamlog.h)
+ *
+ * @note    Each buffer has its own SD_Request. The states are
+ *
+ *          | State   | Owner                                     |
+ *          |---------|-------------------------------------------|
+ *          | FREE    | producer, may be filled                   |
+ *          | WRITING | SD driver, until the completion callback  |
+ *
+ *          The producer fills the buffers in ring order and the SD queue writes
+ *          them in the same order, so it only checks the state of the next one
+ *
+ * @note    pending = submitted-completed. Each counter has one writer
+ *          (producer and callback)
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <string.h>
+#include "stm32f746xx.h"
+#include "sdcard.h"
+#include "buddy.h"
+#include "streamlog.h"
+
+#define ST_FREE                         0
+#define ST_WRITING                      1
+
+/**
+ * @brief   A buffer
+ */
+typedef struct {
+    uint8_t             *data;
+    volatile int        state;
+    SD_Request          request;
+} Buffer;
+
+/**
+ * @brief   Logger state
+ */
+///@{
+static Buffer               buffers[STREAMLOG_MAXBUFFERS];
+static POOL                 pool = 0;
+static int                  started = 0;
+static uint32_t             nbuffers;
+static uint32_t             buffersize;
+static uint32_t             samplesize;
+static uint32_t             fill;           // buffer being filled
+static uint32_t             fillbytes;
+static uint32_t             nextblock;
+static uint32_t             endblock;
+static uint32_t             submitted;      // written by the producer
+static volatile uint32_t    completed;      // written by the callback
+static volatile uint32_t    blockswritten;
+static volatile uint32_t    writeerrors;
+static uint32_t             samples;
+static uint32_t             dropped;
+static uint32_t             highwater;
+///@}
+
+/**
+ * @brief  Completion of a buffer write (SDMMC1 interrupt)
+ */
+static void WriteDone( void *arg, int status ) {
+Buffer *b = arg;
+
+    if( status < 0 )
+        writeerrors++;
+    else
+        blockswritten += b->request.count;
+    b->state = ST_FREE;
+    __DMB();
+    completed++;
+}
+
+/**
+ * @brief  Submit the buffer being filled (n bytes, a multiple of 512)
+ */
+static int Submit( uint32_t n ) {
+Buffer *b = &buffers[fill];
+uint32_t pending;
+int rc;
+
+    b->request.op       = SD_WRITE;
+    b->request.block    = nextblock;
+    b->request.count    = n/SD_BLOCKSIZE;
+    b->request.data     = b->data;
+    b->request.callback = WriteDone;
+    b->request.arg      = b;
+    b->state = ST_WRITING;
+    rc = SD_Submit(&b->request);
+    if( rc < 0 ) {
+        b->state = ST_FREE;
+        writeerrors++;
+        return rc;
+    }
+    nextblock += n/SD_BLOCKSIZE;
+    submitted++;
+    pending = (submitted-completed)*buffersize;
+    if( pending > highwater )
+        highwater = pending;
+    fill = (fill+1)%nbuffers;
+    fillbytes = 0;
+    return STREAMLOG_OK;
+}
+
+/**
+ * @brief  StreamLog_Start
+ *
+ * @note   buffersize must be a multiple of 512 and of samplesize. The buffers
+ *         are 32 byte aligned (buddy blocks of at least 32 bytes)
+ */
+int
+StreamLog_Start( POOL p, uint32_t n, uint32_t size,
+                 uint32_t ssize, uint32_t firstblock, uint32_t nblocks ) {
+uint32_t i;
+
+    if( started || n < 2 || n > STREAMLOG_MAXBUFFERS || size == 0 || ssize == 0
+     || size%SD_BLOCKSIZE || size%ssize )
+        return STREAMLOG_ERROR_PARAMETER;
+
+    for(i=0;i<n;i++) {
+        buffers[i].data  = Buddy_AllocFrom(p,size);
+        buffers[i].state = ST_FREE;
+        if( !buffers[i].data || ((uint32_t) buffers[i].data&31) ) {
+            while( i-- > 0 )
+                Buddy_FreeTo(p,buffers[i].data);
+            return STREAMLOG_ERROR_NOMEMORY;
+        }
+    }
+    pool        = p;
+    nbuffers    = n;
+    buffersize  = size;
+    samplesize  = ssize;
+    fill        = 0;
+    fillbytes   = 0;
+    nextblock   = firstblock;
+    endblock    = firstblock+nblocks;
+    submitted   = completed = 0;
+    blockswritten = writeerrors = 0;
+    samples = dropped = highwater = 0;
+    started = 1;
+    return STREAMLOG_OK;
+}
+
+/**
+ * @brief  StreamLog_Put
+ *
+ * @note   Copies count samples. Returns the number accepted, the others are
+ *         dropped because all buffers are waiting for the card or the block
+ *         range is full. It never waits
+ */
+int
+StreamLog_Put( const void *data, uint32_t count ) {
+const uint8_t *d = data;
+Buffer *b;
+uint32_t k, accepted = 0;
+
+    if( !started )
+        return STREAMLOG_ERROR_NOTSTARTED;
+    while( count ) {
+        b = &buffers[fill];
+        if( b->state != ST_FREE || nextblock+buffersize/SD_BLOCKSIZE > endblock )
+            break;
+        k = (buffersize-fillbytes)/samplesize;
+        if( k > count )
+            k = count;
+        memcpy(b->data+fillbytes,d,k*samplesize);
+        fillbytes += k*samplesize;
+        d        += k*samplesize;
+        count    -= k;
+        accepted += k;
+        if( fillbytes == buffersize && Submit(buffersize) < 0 )
+            break;
+    }
+    samples += accepted;
+    dropped += count;
+    return accepted;
+}
+
+/**
+ * @brief  StreamLog_Stop
+ *
+ * @note   Writes the partial buffer (padded with zeros to a block), waits for
+ *         all writes and frees the buffers. blocks (can be null) gets the
+ *         number of blocks written
+ */
+int
+StreamLog_Stop( uint32_t *blocks ) {
+uint32_t i, n;
+int rc = STREAMLOG_OK;
+
+    if( !started )
+        return STREAMLOG_ERROR_NOTSTARTED;
+    if( fillbytes ) {
+        n = (fillbytes+SD_BLOCKSIZE-1)/SD_BLOCKSIZE*SD_BLOCKSIZE;
+        memset(buffers[fill].data+fillbytes,0,n-fillbytes);
+        if( nextblock+n/SD_BLOCKSIZE <= endblock )
+            rc = Submit(n);
+        else
+            dropped += fillbytes/samplesize;
+    }
+    for(i=0;i<nbuffers;i++) {
+        while( buffers[i].state != ST_FREE ) {}
+        Buddy_FreeTo(pool,buffers[i].data);
+        buffers[i].data = 0;
+    }
+    started = 0;
+    if( blocks )
+        *blocks = blockswritten;
+    return rc < 0 ? rc : (writeerrors ? SD_ERROR_DATA : STREAMLOG_OK);
+}
+
+/**
+ * @brief  StreamLog_GetStats
+ */
+void
+StreamLog_GetStats( StreamLog_Stats *stats ) {
+
+    stats->samples       = samples;
+    stats->dropped       = dropped;
+    stats->blockswritten = blockswritten;
+    stats->writeerrors   = writeerrors;
+    stats->pending       = submitted-completed;
+    stats->highwater     = highwater;
+    stats->buffersize    = buffersize;
+    stats->nbuffers      = nbuffers;
+}
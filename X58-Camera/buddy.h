@@ -0,0 +1,95 @@
+#ifndef BUDDY_H
+#define BUDDY_H
+/**
+ *  @file   buddy.h
+ *
+ *  @author Hans
+ *  @date   27/10/2020
+ */
+
+#include "sdram.h"
+
+/**
+ *  @brief  Handle for a buddy pool
+ *
+ *  @note   Many pools can be used at same time, e.g. one for DTCM and another
+ *          for the SDRAM, each with its own minimal block size.
+ */
+typedef struct buddypool_s *POOL;
+
+/**
+ *  @brief  Maximal number of levels (orders) in a pool
+ */
+#define BUDDY_MAXLEVELS         24
+
+/**
+ *  @brief  Number of bins in latency histograms
+ *
+ *  @note   Bin i counts calls that took from 2^i to 2^(i+1)-1 cycles. Last bin
+ *          counts all larger values
+ */
+#define BUDDY_HISTOGRAMSIZE     16
+
+/**
+ *  @brief  Cache line size of the Cortex-M7
+ *
+ *  @note   Buddy_AllocDMA aligns start and size of the block to it, so a cache
+ *          invalidate for a DMA reception does not discard data of other blocks
+ */
+#define BUDDY_CACHELINE         32
+
+/**
+ *  @brief  Statistics of a pool
+ */
+typedef struct {
+    long        size;                               ///< size of pool
+    long        minsize;                            ///< minimal block size
+    int         orders;                             ///< number of block sizes
+    long        inuse;                              ///< bytes in allocated blocks
+    long        highwater;                          ///< maximal value of inuse
+    long        largestfree;                        ///< size of largest free block
+    unsigned    allocs;                             ///< number of allocations
+    unsigned    frees;                              ///< number of frees
+    unsigned    failures;                           ///< number of allocations failed
+    unsigned    inplace;                            ///< reallocations done without a copy
+    unsigned    maxlockcycles;                      ///< longest time with interrupts disabled
+    unsigned    freeblocks[BUDDY_MAXLEVELS];        ///< free blocks of size minsize<<order
+    unsigned    alloccycles[BUDDY_HISTOGRAMSIZE];   ///< histogram of allocation latency
+    unsigned    freecycles[BUDDY_HISTOGRAMSIZE];    ///< histogram of free latency
+} BUDDY_Stats;
+
+POOL  Buddy_CreatePool(char *addr, long size, long minsize);
+POOL  Buddy_CreatePoolWithMap(char *addr, long size, long minsize, void *map, long mapbytes);
+long  Buddy_MapSize(long size, long minsize);
+void *Buddy_AllocFrom(POOL pool, unsigned size);
+void *Buddy_AllocAlignedFrom(POOL pool, unsigned size, unsigned align);
+void  Buddy_FreeTo(POOL pool, void *addr);
+void *Buddy_ReallocFrom(POOL pool, void *addr, unsigned size);
+long  Buddy_BlockSize(POOL pool, void *addr);
+void  Buddy_GetPoolStats(POOL pool, BUDDY_Stats *stats);
+void  Buddy_ResetStats(POOL pool);
+
+/*
+ * Functions using a default pool created by Buddy_Init
+ */
+int   Buddy_Init(char *addr, long size, long minsize);
+void *Buddy_Alloc(unsigned size);
+void *Buddy_AllocAligned(unsigned size, unsigned align);
+void  Buddy_Free(void *addr);
+void *Buddy_Realloc(void *addr, unsigned size);
+int   Buddy_GetStats(BUDDY_Stats *stats);
+
+/*
+ * DMA buffers: from the pool given to Buddy_SetDMAPool (e.g. in a non cacheable
+ * MPU region) or, without it, from the default pool aligned to the cache line.
+ * Freed by Buddy_Free
+ */
+void  Buddy_SetDMAPool(POOL pool);
+void *Buddy_AllocDMA(unsigned size);
+
+#ifdef DEBUG
+void  Buddy_PrintPoolMap(POOL pool);
+void  Buddy_PrintMap(void);
+void  Buddy_PrintAddresses(void);
+#endif
+#endif
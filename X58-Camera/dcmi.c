@@ -0,0 +1,482 @@
+/**
+ * @file    dcmi.c
+ *
+ * @brief   Camera capture with the DCMI and DMA into SDRAM frame buffers
+ *
+ * @note    Each frame buffer is in one of four states. Two of them (one in
+ *          snapshot mode) are owned by the DMA stream, one can be ready and the
+ *          others are free or locked by the application
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "gpio.h"
+#include "dma.h"
+#include "cache.h"
+#include "buddy.h"
+#include "i2c-master.h"
+#include "ov9655.h"
+#include "dcmi.h"
+
+/**
+ * @brief   Bus of the camera
+ */
+#define CAMERA_I2C                      I2C1
+
+/**
+ * @brief   Pins (AF13) and power enable (PH13, output, high = power down)
+ */
+///@{
+static const GPIO_PinConfiguration dcmipins[] = {
+    //  GPIO  Pin AF  Mode OType Speed PuPd
+    { GPIOA,  4, 13,  2,   0,    3,    0 },    // DCMI_HSYNC
+    { GPIOA,  6, 13,  2,   0,    3,    0 },    // DCMI_PIXCLK
+    { GPIOG,  9, 13,  2,   0,    3,    0 },    // DCMI_VSYNC
+    { GPIOH,  9, 13,  2,   0,    3,    0 },    // DCMI_D0
+    { GPIOH, 10, 13,  2,   0,    3,    0 },    // DCMI_D1
+    { GPIOH, 11, 13,  2,   0,    3,    0 },    // DCMI_D2
+    { GPIOH, 12, 13,  2,   0,    3,    0 },    // DCMI_D3
+    { GPIOH, 14, 13,  2,   0,    3,    0 },    // DCMI_D4
+    { GPIOD,  3, 13,  2,   0,    3,    0 },    // DCMI_D5
+    { GPIOE,  5, 13,  2,   0,    3,    0 },    // DCMI_D6
+    { GPIOE,  6, 13,  2,   0,    3,    0 },    // DCMI_D7
+    {     0,  0,  0,  0,   0,    0,    0 }
+};
+
+static const GPIO_PinConfiguration pwrpin =
+    { GPIOH, 13,  0,  1,   0,    0,    0,  1 };  // DCMI_PWR_EN
+///@}
+
+/**
+ * @brief   States of a frame buffer
+ */
+///@{
+#define BUFFER_FREE                     (0)
+#define BUFFER_DMA                      (1)     ///< in the stream (M0AR or M1AR)
+#define BUFFER_READY                    (2)     ///< complete, not taken
+#define BUFFER_LOCKED                   (3)     ///< taken by DCMI_GetFrame
+///@}
+
+/**
+ * @brief   Frame buffers and capture state
+ */
+///@{
+static uint16_t         *buffers[DCMI_MAXBUFFERS];
+static volatile uint8_t  state[DCMI_MAXBUFFERS];
+static unsigned          nbuf = 0;
+static int               slot[2] = { -1, -1 };  ///< buffers in the stream
+static volatile int      ready = -1;
+static unsigned          width = 0;
+static unsigned          height = 0;
+static uint32_t          framewords = 0;        ///< DMA transfers in a frame
+static int               dmah = -1;
+static int               dcmimode = 0;
+static volatile int      capturing = 0;
+static DCMI_Stats        stats;
+///@}
+
+/**
+ * @brief   Delay using the cycle counter (does not need SysTick)
+ */
+static void Delay( unsigned ms ) {
+uint32_t t0,cycles;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    cycles = SystemCoreClock/1000;
+    while( ms-- > 0 ) {
+        t0 = DWT->CYCCNT;
+        while( DWT->CYCCNT-t0 < cycles ) {}
+    }
+}
+
+/**
+ * @brief   First free buffer (or -1)
+ */
+static int FindFree( void ) {
+unsigned i;
+
+    for(i=0;i<nbuf;i++) {
+        if( state[i] == BUFFER_FREE )
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief   Start the stream and the capture with the buffers in slot
+ */
+static void StartCapture( void ) {
+uint16_t *m1;
+
+    m1 = (slot[1] >= 0) ? buffers[slot[1]] : buffers[slot[0]];
+    DMA_Start(dmah,buffers[slot[0]],m1,framewords);
+    DCMI->ICR = DCMI_ICR_FRAME_ISC|DCMI_ICR_OVR_ISC|DCMI_ICR_ERR_ISC
+               |DCMI_ICR_VSYNC_ISC|DCMI_ICR_LINE_ISC;
+    DCMI->CR |= DCMI_CR_ENABLE;
+    DCMI->CR |= DCMI_CR_CAPTURE;
+}
+
+/**
+ * @brief   Stop the capture at once and the stream
+ */
+static void StopCapture( void ) {
+
+    DCMI->CR &= ~DCMI_CR_CAPTURE;
+    DCMI->CR &= ~DCMI_CR_ENABLE;
+    DMA_Stop(dmah);
+}
+
+/**
+ * @brief   End of frame in buffer slot k
+ *
+ * @note    The previous ready frame, if not taken, is dropped and its buffer
+ *          can replace the new one in the stream
+ */
+static void FrameDone( int k ) {
+int done = slot[k];
+int next;
+
+    if( ready >= 0 ) {
+        state[ready] = BUFFER_FREE;
+        ready = -1;
+        stats.dropped++;
+    }
+
+    if( dcmimode == DCMI_MODE_CONTINUOUS ) {
+        next = FindFree();
+        if( next < 0 || DMA_SetBuffer(dmah,k,buffers[next]) != DMA_OK ) {
+            // The frame stays in the stream and is overwritten
+            stats.dropped++;
+            return;
+        }
+        state[next] = BUFFER_DMA;
+        slot[k] = next;
+    } else {
+        slot[0] = -1;
+        capturing = 0;
+    }
+
+    state[done] = BUFFER_READY;
+    ready = done;
+    stats.frames++;
+}
+
+/**
+ * @brief   DMA callback
+ *
+ * @note    In double buffer mode, the stream already writes into the other
+ *          buffer
+ */
+static void DMADone( void *arg, int event ) {
+
+    (void) arg;
+    if( event == DMA_EVENT_ERROR ) {
+        stats.dmaerrors++;
+        StopCapture();
+        if( capturing )
+            StartCapture();
+        return;
+    }
+    if( event != DMA_EVENT_FULL )
+        return;
+    if( dcmimode == DCMI_MODE_CONTINUOUS )
+        FrameDone(DMA_CurrentBuffer(dmah)^1);
+    else
+        FrameDone(0);
+}
+
+/**
+ * @brief   DCMI interrupt
+ *
+ * @note    Only overruns and synchronization errors are enabled. The end of a
+ *          frame is signaled by the DMA
+ */
+void DCMI_IRQHandler( void ) {
+uint32_t mis;
+
+    mis = DCMI->MIS;
+    DCMI->ICR = mis;
+    if( mis&DCMI_MIS_ERR_MIS )
+        stats.syncerrors++;
+    if( mis&DCMI_MIS_OVR_MIS ) {
+        stats.overruns++;
+        StopCapture();
+        if( capturing )
+            StartCapture();
+    }
+}
+
+/**
+ * @brief   Configure the stream for the mode
+ */
+static int ConfigureDMA( int mode ) {
+DMA_Config conf;
+
+    if( dmah < 0 )
+        dmah = DMA_Allocate(DMA_REQ_DCMI);
+    if( dmah < 0 )
+        return DCMI_ERROR_DMA;
+    conf.dir      = DMA_DIR_P2M;
+    conf.periph   = &DCMI->DR;
+    conf.psize    = DMA_SIZE_32;
+    conf.msize    = DMA_SIZE_32;
+    conf.burst    = DMA_BURST_4;
+    conf.priority = 3;
+    conf.flags    = DMA_FLAG_MINC;
+    if( mode == DCMI_MODE_CONTINUOUS )
+        conf.flags |= DMA_FLAG_DOUBLEBUFFER;
+    conf.callback = DMADone;
+    conf.arg      = 0;
+    if( DMA_Configure(dmah,&conf) < 0 )
+        return DCMI_ERROR_DMA;
+    return DCMI_OK;
+}
+
+/**
+ * @brief  DCMI_Init
+ *
+ * @note   Powers up and configures the camera for RGB565 at resolution and
+ *         allocates nbuffers frame buffers (1 to DCMI_MAXBUFFERS, 3 or more for
+ *         the continuous mode) from the buddy pool. The SDRAM and the pool must
+ *         be initialized. I2C1 is initialized here, with the default timing.
+ *         SysTick must call I2CMaster_ProcessTimeouts
+ */
+int
+DCMI_Init( int resolution, unsigned nbuffers ) {
+uint32_t size;
+unsigned i;
+
+    if( nbuffers == 0 || nbuffers > DCMI_MAXBUFFERS )
+        return DCMI_ERROR_PARAMETER;
+    if( resolution == DCMI_RES_QVGA ) {
+        width  = 320;
+        height = 240;
+    } else if( resolution == DCMI_RES_QQVGA ) {
+        width  = 160;
+        height = 120;
+    } else {
+        return DCMI_ERROR_PARAMETER;
+    }
+
+    DCMI_Stop();
+    for(i=0;i<nbuf;i++)
+        Buddy_Free(buffers[i]);
+    nbuf = 0;
+    ready = -1;
+
+    // RGB565: two pixels in each word read from the DCMI
+    size = width*height*sizeof(uint16_t);
+    framewords = size/sizeof(uint32_t);
+    for(i=0;i<nbuffers;i++) {
+        buffers[i] = Buddy_Alloc(size);
+        if( buffers[i] == 0 ) {
+            while( i-- > 0 )
+                Buddy_Free(buffers[i]);
+            return DCMI_ERROR_NOMEMORY;
+        }
+        // No dirty line may be written back over a frame (SDRAM is write through)
+        Cache_CleanInvalidateRange(buffers[i],size);
+        state[i] = BUFFER_FREE;
+    }
+    nbuf = nbuffers;
+
+    GPIO_ConfigureSinglePin(&pwrpin);
+    GPIO_ConfigureMultiplePins(dcmipins);
+    GPIO_Clear(GPIOH,1U<<13);
+    Delay(10);
+
+    if( I2CMaster_Init(CAMERA_I2C,0,0) < 0 )
+        return DCMI_ERROR_CAMERA;
+    if( OV9655_Init(CAMERA_I2C,resolution) < 0 )
+        return DCMI_ERROR_CAMERA;
+
+    RCC->AHB2ENR |= RCC_AHB2ENR_DCMIEN;
+    __DSB();
+    // 8 bit data, hardware synchronization, all frames, PCLK rising edge,
+    // HSYNC low and VSYNC high while data is not valid
+    DCMI->CR  = DCMI_CR_PCKPOL|DCMI_CR_VSPOL;
+    DCMI->IER = DCMI_IER_OVR_IE|DCMI_IER_ERR_IE;
+    NVIC_SetPriority(DCMI_IRQn,DCMI_IRQ_PRIO);
+    NVIC_EnableIRQ(DCMI_IRQn);
+
+    DCMI_ResetStats();
+    dcmimode = 0;
+    return DCMI_OK;
+}
+
+/**
+ * @brief  DCMI_Start
+ *
+ * @note   In snapshot mode, the frame is ready when DCMI_IsCapturing returns 0
+ */
+int
+DCMI_Start( int mode ) {
+uint32_t primask;
+int rc;
+
+    if( nbuf == 0 )
+        return DCMI_ERROR_NOTINITIALIZED;
+    if( mode != DCMI_MODE_SNAPSHOT && mode != DCMI_MODE_CONTINUOUS )
+        return DCMI_ERROR_PARAMETER;
+    if( mode == DCMI_MODE_CONTINUOUS && nbuf < 3 )
+        return DCMI_ERROR_PARAMETER;
+
+    DCMI_Stop();
+    rc = ConfigureDMA(mode);
+    if( rc < 0 )
+        return rc;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    slot[0] = FindFree();
+    if( slot[0] >= 0 )
+        state[slot[0]] = BUFFER_DMA;
+    slot[1] = -1;
+    if( mode == DCMI_MODE_CONTINUOUS ) {
+        slot[1] = FindFree();
+        if( slot[1] >= 0 )
+            state[slot[1]] = BUFFER_DMA;
+    }
+    if( slot[0] < 0 || (mode == DCMI_MODE_CONTINUOUS && slot[1] < 0) ) {
+        if( slot[0] >= 0 )
+            state[slot[0]] = BUFFER_FREE;
+        slot[0] = -1;
+        __set_PRIMASK(primask);
+        return DCMI_ERROR_NOBUFFER;
+    }
+    __set_PRIMASK(primask);
+
+    if( mode == DCMI_MODE_SNAPSHOT )
+        DCMI->CR |= DCMI_CR_CM;
+    else
+        DCMI->CR &= ~DCMI_CR_CM;
+    dcmimode  = mode;
+    capturing = 1;
+    StartCapture();
+    return DCMI_OK;
+}
+
+/**
+ * @brief  DCMI_Stop
+ *
+ * @note   The frame being captured is lost. Ready and locked frames are kept
+ */
+void
+DCMI_Stop( void ) {
+unsigned k;
+
+    capturing = 0;
+    if( dmah >= 0 )
+        StopCapture();
+    for(k=0;k<2;k++) {
+        if( slot[k] >= 0 )
+            state[slot[k]] = BUFFER_FREE;
+        slot[k] = -1;
+    }
+}
+
+/**
+ * @brief  DCMI_IsCapturing
+ */
+int
+DCMI_IsCapturing( void ) {
+
+    return capturing;
+}
+
+/**
+ * @brief  DCMI_GetFrame
+ *
+ * @note   Returns the ready frame and locks it, or 0 when there is none. The
+ *         cache is invalidated over it, so the CPU can read it
+ */
+const uint16_t *
+DCMI_GetFrame( void ) {
+uint32_t primask;
+int f;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    f = ready;
+    if( f >= 0 ) {
+        state[f] = BUFFER_LOCKED;
+        ready = -1;
+    }
+    __set_PRIMASK(primask);
+
+    if( f < 0 )
+        return 0;
+    Cache_InvalidateRange(buffers[f],framewords*sizeof(uint32_t));
+    return buffers[f];
+}
+
+/**
+ * @brief  DCMI_ReleaseFrame
+ *
+ * @note   The buffer can be used again by the stream
+ */
+void
+DCMI_ReleaseFrame( const uint16_t *frame ) {
+unsigned i;
+
+    for(i=0;i<nbuf;i++) {
+        if( buffers[i] == frame && state[i] == BUFFER_LOCKED ) {
+            state[i] = BUFFER_FREE;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief  DCMI_GetWidth
+ */
+unsigned
+DCMI_GetWidth( void ) {
+
+    return width;
+}
+
+/**
+ * @brief  DCMI_GetHeight
+ */
+unsigned
+DCMI_GetHeight( void ) {
+
+    return height;
+}
+
+/**
+ * @brief  DCMI_GetStats
+ */
+void
+DCMI_GetStats( DCMI_Stats *s ) {
+uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    *s = stats;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  DCMI_ResetStats
+ */
+void
+DCMI_ResetStats( void ) {
+uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    stats.frames     = 0;
+    stats.dropped    = 0;
+    stats.overruns   = 0;
+    stats.syncerrors = 0;
+    stats.dmaerrors  = 0;
+    __set_PRIMASK(primask);
+}
@@ -0,0 +1,115 @@
+#ifndef DCMI_H
+#define DCMI_H
+/**
+ * @file    dcmi.h
+ *
+ * @brief   Camera capture with the DCMI and DMA into SDRAM frame buffers
+ *
+ * @note    The camera module (OV9655) is plugged into the camera connector P1.
+ *          It is powered up by DCMI_PWR_EN (PH13, low) and configured thru
+ *          I2C1 (see ov9655.h). The DCMI uses 8 bit data and hardware
+ *          synchronization
+ *
+ * | Signal       | Pin  |  | Signal       | Pin  |
+ * |--------------|------|--|--------------|------|
+ * | DCMI_D0      | PH9  |  | DCMI_D5      | PD3  |
+ * | DCMI_D1      | PH10 |  | DCMI_D6      | PE5  |
+ * | DCMI_D2      | PH11 |  | DCMI_D7      | PE6  |
+ * | DCMI_D3      | PH12 |  | DCMI_HSYNC   | PA4  |
+ * | DCMI_D4      | PH14 |  | DCMI_VSYNC   | PG9  |
+ * | DCMI_PWR_EN  | PH13 |  | DCMI_PIXCLK  | PA6  |
+ *
+ * @note    The frames are RGB565 and are stored in nbuffers frame buffers
+ *          allocated from the buddy pool (SDRAM). A DMA2 stream reads the DCMI
+ *          with 4 word bursts
+ *
+ * @note    Two modes
+ *          - DCMI_MODE_SNAPSHOT: one frame is captured into a free buffer and
+ *            the capture stops. DCMI_Start must be called for the next one
+ *          - DCMI_MODE_CONTINUOUS: the stream runs in double buffer mode over
+ *            two buffers. At the end of a frame, the buffer just filled
+ *            becomes the ready frame and a free buffer takes its place in the
+ *            stream. Three buffers are needed, so that the application can hold
+ *            one frame while the DMA fills the other two
+ *
+ * @note    DCMI_GetFrame returns the most recent frame not yet taken and locks
+ *          it until DCMI_ReleaseFrame. A ready frame that is not taken before
+ *          the next one ends is dropped, as is a new frame when there is no
+ *          free buffer to replace it (it is overwritten)
+ *
+ * @note    On an overrun of the DCMI FIFO, the capture is restarted and the
+ *          frame being captured is lost
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief   Resolutions
+ */
+///@{
+#define DCMI_RES_QQVGA                  (1)     ///< 160x120
+#define DCMI_RES_QVGA                   (2)     ///< 320x240
+///@}
+
+/**
+ * @brief   Modes
+ */
+///@{
+#define DCMI_MODE_SNAPSHOT              (1)
+#define DCMI_MODE_CONTINUOUS            (2)
+///@}
+
+/**
+ * @brief   Number of frame buffers
+ */
+#define DCMI_MAXBUFFERS                 (4)
+
+/**
+ * @brief   Priority of the DCMI interrupt (overruns)
+ *
+ * @note    The same as DMA_IRQ_PRIO, so that a restart does not preempt the
+ *          end of frame processing
+ */
+#ifndef DCMI_IRQ_PRIO
+#define DCMI_IRQ_PRIO                   (12)
+#endif
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define DCMI_OK                         (0)
+#define DCMI_ERROR_PARAMETER            (-1)
+#define DCMI_ERROR_CAMERA               (-2)    ///< no answer or wrong id
+#define DCMI_ERROR_DMA                  (-3)    ///< no stream or bad alignment
+#define DCMI_ERROR_NOMEMORY             (-4)    ///< buddy pool exhausted
+#define DCMI_ERROR_NOTINITIALIZED       (-5)
+#define DCMI_ERROR_NOBUFFER             (-6)    ///< all buffers are locked
+///@}
+
+/**
+ * @brief   Statistics
+ */
+typedef struct {
+    uint32_t    frames;                     ///< frames captured
+    uint32_t    dropped;                    ///< frames never taken (or overwritten)
+    uint32_t    overruns;
+    uint32_t    syncerrors;
+    uint32_t    dmaerrors;
+} DCMI_Stats;
+
+int   DCMI_Init( int resolution, unsigned nbuffers );
+int   DCMI_Start( int mode );
+void  DCMI_Stop( void );
+int   DCMI_IsCapturing( void );
+const uint16_t *DCMI_GetFrame( void );
+void  DCMI_ReleaseFrame( const uint16_t *frame );
+unsigned DCMI_GetWidth( void );
+unsigned DCMI_GetHeight( void );
+void  DCMI_GetStats( DCMI_Stats *s );
+void  DCMI_ResetStats( void );
+
+#endif // DCMI_H
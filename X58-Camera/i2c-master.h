@@ -0,0 +1,140 @@
+#ifndef I2C_MASTER_H
+#define I2C_MASTER_H
+/**
+ * @file    i2c-master.h
+ *
+ * @brief   I2C implementation of master interface
+ *
+ * @note    Simple implementation of a I2C Master
+ *
+ * @note    NORMAL MODE\:            100 KHz
+ *          FAST MODE\:              400 KHz
+ *          FAST PLUS MODE\:        1000 KHz
+ *
+ * @author  Hans
+ */
+
+#define I2C_CONF_MODE_NORMAL         (0)
+#define I2C_CONF_MODE_FAST           (1)
+#define I2C_CONF_MODE_FASTPLUS       (2)
+#define I2C_CONF_MODE_MASK           (3)
+
+#define I2C_CONF_FILTER_NONE         (1<<4)
+#define I2C_CONF_FILTER_ANALOG       (1<<5)
+#define I2C_CONF_FILTER_DIGITAL_Pos  (6)
+#define I2C_CONF_FILTER_DIGITAL_1    (1<<I2C_FILTER_DIGITAL_Pos)
+#define I2C_CONF_FILTER_DIGITAL_2    (2<<I2C_FILTER_DIGITAL_Pos)
+#define I2C_CONF_FILTER_DIGITAL_MASK (0xF<<I2C_CONF_FILTER_DIGITAL_Pos)
+
+/*
+ * The calculation of the timing parameters (PRESC,SCLDEL,SDADEL,SCLH,SCLL)
+ * is a PITA.
+ *
+ * The easiest way is to use STM32CubeMX.
+ * Do not forget to specify tr and tf, because they have a bit impact on the
+ * timing parameters
+ *
+ * Below there are some precalculated values for timing according the speed
+ * and the filters used
+ */
+
+/* For Standard Mode */
+#define I2C_TIMING_STANDARD_NONE        0x00503D5A
+#define I2C_TIMING_STANDARD_ANALOG      0x00503D58
+#define I2C_TIMING_STANDARD_DNF_1       0x00503C59
+#define I2C_TIMING_STANDARD_DNF_2       0x00503B58
+/* For Fast Mode */
+#define I2C_TIMING_FAST_NONE            0x00300718
+#define I2C_TIMING_FAST_ANALOG          0x00300617
+#define I2C_TIMING_FAST_DNF_1           0x00300617
+#define I2C_TIMING_FAST_DNF_2           0x00300912
+/* For Fast Plus Mode */
+#define I2C_TIMING_FASTPLUS_NONE        0x00200205
+#define I2C_TIMING_FASTPLUS_ANALOG      0x00200105
+#define I2C_TIMING_FASTPLUS_DNF_1       0x00200004
+#define I2C_TIMING_FASTPLUS_DNF_2       0x00200003
+
+/**
+ * @brief   Transaction status
+ */
+///@{
+#define I2C_TRANSACTION_OK              (0)
+#define I2C_TRANSACTION_PENDING         (1)
+#define I2C_TRANSACTION_NACK            (-1)
+#define I2C_TRANSACTION_BUSERROR        (-2)
+#define I2C_TRANSACTION_ARLO            (-3)
+#define I2C_TRANSACTION_TIMEOUT         (-4)
+///@}
+
+/**
+ * @brief   Maximal duration of a transaction (ms)
+ */
+#ifndef I2C_TIMEOUT_MS
+#define I2C_TIMEOUT_MS                  (25)
+#endif
+
+/**
+ * @brief   Priority of the I2C interrupts
+ */
+#ifndef I2C_IRQ_PRIO
+#define I2C_IRQ_PRIO                    (14)
+#endif
+
+/**
+ * @brief   Completion callback
+ *
+ * @note    Called from the I2C interrupt with the transaction status
+ */
+typedef void (*I2C_Callback)(void *arg, int status);
+
+/**
+ * @brief   Transaction
+ *
+ * @note    Write ntx bytes (if any) and then, after a repeated start, read nrx
+ *          bytes (if any). With both zero, only the address is sent (detect).
+ *          Storage is provided by the caller and linked in the bus queue.
+ */
+typedef struct I2C_Transaction_s {
+    uint16_t                    addr;       ///< 7 bit slave address
+    uint16_t                    ntx;
+    uint8_t                     *txdata;
+    uint16_t                    nrx;
+    uint8_t                     *rxdata;
+    I2C_Callback                callback;   ///< can be null
+    void                        *arg;
+    volatile int                status;     ///< I2C_TRANSACTION_*
+    struct I2C_Transaction_s    *next;      ///< internal
+} I2C_Transaction;
+
+int I2CMaster_Init(         I2C_TypeDef *i2c,
+                            uint32_t conf,
+                            uint32_t timing
+                            );
+
+int I2CMaster_Write(        I2C_TypeDef *i2c,
+                            uint16_t address,
+                            uint8_t *data,
+                            uint16_t n
+                            );
+
+int I2CMaster_Read(         I2C_TypeDef *i2c,
+                            uint16_t address,
+                            uint8_t *data,
+                            uint16_t n
+                            );
+
+int I2CMaster_WriteAndRead( I2C_TypeDef *i2c,
+                            uint16_t address,
+                            uint8_t *writedata, int nwrite,
+                            uint8_t *readdata,  int nread
+                            );
+
+int I2CMaster_Submit(       I2C_TypeDef *i2c,
+                            I2C_Transaction *t
+                            );
+
+void I2CMaster_ProcessTimeouts(void);
+void I2CMaster_ProcessEvent( I2C_TypeDef *i2c );
+void I2CMaster_ProcessError( I2C_TypeDef *i2c );
+
+#endif // I2C_MASTER_H
@@ -0,0 +1,2606 @@
+/**
+ * @file    lcd.c
+ *
+ * @date    07/10/2020
+ * @author  Hans
+ */
+
+#include <string.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "lcd.h"
+#include "profile.h"
+#include "memsections.h"
+#include "dma2d.h"
+#include "buddy.h"
+#include "pixops.h"
+#ifdef USE_PLLCONFIG
+#include "pllconfig.h"
+#endif
+
+
+#define BIT(N)          (1U<<(N))
+
+/**
+ * @brief Use GPIO library to initialize and control pins
+ *
+ * @note  Comment it to use a faster but larger implementation
+ */
+#define LCD_USEGPIO 1
+
+/**
+ *  @brief  Default values
+ */
+///@{
+#define BACKGROUND_COLOR        RGB(0,0,255)
+
+
+///@}
+
+/**
+ * @brief   Hardware acceleration of fills (DMA2D)
+ *
+ * @note    LCD_ACCEL_DEFAULT is the setting of all layers after LCD_Init. It can
+ *          be changed for each layer by LCD_SetAcceleration
+ *
+ * @note    Rectangles with less than LCD_ACCEL_MINPIXELS pixels are filled by the
+ *          CPU. The setup of the DMA2D costs more than a short span
+ *
+ * @note    DMA2D can only write ARGB8888, RGB888, RGB565, ARGB1555 and ARGB4444.
+ *          Layers in other formats always use the CPU
+ */
+///@{
+#ifndef LCD_ACCEL_DEFAULT
+#define LCD_ACCEL_DEFAULT       1
+#endif
+#ifndef LCD_ACCEL_MINPIXELS
+#define LCD_ACCEL_MINPIXELS     64
+#endif
+static int accelerated[3] = { 0, 0, 0 };
+///@}
+
+/*
+ * @brief   LCD Connection
+ *
+ * LCD signal   | Board signal      | MCU signal             |
+ *--------------|-------------------|------------------------|
+ *  CLK         | LCD_CLK           | PI14                   |
+ *  LCD_R       | LCD_R0-7          | PI15 PJ0-6             |
+ *  LCD_G       | LCD_G0-7          | PJ7-11 PK0-2           |
+ *  LCD_B       | LCD_B0-7          | PE4 PJ13-15 PG12 PK4-6 |
+ *  HSYNC       | LCD_HSYNC         | PI10                   |
+ *  VSYNC       | LCD_VSYNC         | PI9                    |
+ *  DE          | LCD_DE            | PK7                    |
+ *  SCL         | LCD_SCL           | PH7                    |
+ *  SDA         | LCD_SDA           | PH8                    |
+ *  RST         | LCD_RST/NRST      | NRST                   |
+ *  INT         | LCD_INT           | PI13                   |
+ *  DISP        | LCD_DISP          | PI12                   |
+ *  Backlight   | LCD_BL_CTRL       | PK3                    |
+ *
+ * @note I2CX signals (LCD_SCL and LCD_SDA) are shared with an audio device
+ *
+ * @note LCD_BL_CTRL, LCD_DISP, LCD_INT, LCD_RST are not controlled by the LCD
+ *       interface
+ */
+
+/*
+ * @brief   Mask for LCD signals
+ *
+ * @note    LCD_BACKLIGHTCTRL  controls the enable pin of the STLD40DPUR (hite LED power
+ *          supply for large display backlight)
+ *
+ * @note    LCD_DISP controls normal operation (1) or stand-by (0)
+ *
+ * @note    LCD_INT interrupts the MCU
+ *
+ */
+/** On port K */
+///@{
+#define LCD_BACKLIGHTCTRL_MASK  BIT(3)
+///@}
+/** On port I */
+///@{
+#define LCD_INTERRUPT_MASK      BIT(13)
+#define LCD_NORMALSTANDBY_MASK  BIT(12)
+///@}
+
+/**
+ *  @brief  Characteristics of the LCD interface
+ *
+ * | Signal  | Description                 |  Min     |  Max     |
+ * |---------|-----------------------------|----------|----------|
+ * | LCD_CLK | LTDC clock output frequency |  -       |  45 MHz  |
+ *
+ *  @note LCD_CLK is generated from the R output of the PLLSAI
+ *
+ *  @note There is a divisor (LLSAIDIVR) of the R output signal that can assume the
+ *        values 2, 4, 8 and 16. Is is set in the field PLLSAIDIVR of the RCC_DCKFGR1 register.
+ *  @note The input of the PLLSAI is the same of Main PLL. In this project
+ *        it is 1 MHz, obtained by dividing the 25 MHz clock input by M=25, set in the
+ *        field PLLM of the RCC_PLLCFGR register.
+ */
+
+/**
+ * @brief   Point to base address of LTDC Layer registers
+ *
+ * @note    Extra Layer2 at 0 to make possible to use integer 1 and 2 to represent
+ *          the layer. An extra benefit is that 0 can be used as an index too.
+ */
+static LTDC_Layer_TypeDef * const LTDC_Layer[3] = {LTDC_Layer2, LTDC_Layer1, LTDC_Layer2};
+/**
+ * @brief   Characteristics of the LCD display
+ *
+ * @note    Device Caracteristics from Rocktech RK043FN48H-CT672B Datasheet
+ *
+ *     Item               |  Min  |  Typ  |  Max  |  Units
+ *   ---------------------|-------|-------|-------|--------------------
+ *   DCLK Frequency       |    5  |    9  |   12  |  MHz
+ *   DCLK Period          |   83  |  119  |  200  |  ns
+ *   HSYNC Period         |  490  |  531  |  605  | DCLK Period
+ *   HSYNC Display        |       |  480  |       | DCLK Period
+ *   HSYNC Back porch     |    8  |   43  |       | DCLK Period
+ *   HSYNC Front porch    |    2  |    1  |       | DCLK Period
+ *   HSYNC pulse width    |    1  |       |       | DCLK Period
+ *   VSYNC Period         |  275  |  288  |  335  | HSYNC Period
+ *   VSYNC Display Period |       |  272  |       | HSYNC Period
+ *   VSYNC Back porch     |    2  |   12  |       | HSYNC Period
+ *   VSYNC Front porch    |    1  |    4  |       | HSYNC Period
+ *   VSYNC pulse width    |    1  |   10  |       | HSYNC Period
+ */
+
+/**
+ * @brief   Struct to store information about display
+ */
+typedef struct {
+    uint32_t    frequency;          /// LCD frequency
+    uint32_t    polarity;           /// polarity of control signals (Use LTDC_CGR_xxPOL symbols)
+    uint16_t    divider;            /// divider to be used ??
+    uint16_t    width;              /// Visible width
+    uint16_t    height;             /// Visible height
+    uint16_t    hsync;              /// Horizontal synchronization
+    uint16_t    vsync;              /// Vertical synchronization (unit is HSYNC Period)
+    uint16_t    hfp;                /// Horizontal front porch (unit is LCD_CLK Period)
+    uint16_t    hbp;                /// Horizontal back porch  (unit is LCD_CLK Period)
+    uint16_t    vfp;                /// Vertical front porch (unit is HSYNC Period)
+    uint16_t    vbp;                /// Vertical back porch (unit is HSYNC Period)
+    uint16_t    pitch[5];           /// Pitch used to store lines in memory (in bytes)
+                                    /// For 1,2,3,4 bytes (Position 0 not used)
+
+} DisplayProperties_t;
+
+/**
+  * @brief  RK043FN48H properties
+  */
+
+const DisplayProperties_t dispRK043 = {
+    .frequency  =   9000000,        // range [5..12] MHz
+    .polarity   =   0,              // Use LTDC_CGR_xxPOL symbols)
+    .divider    =   5,              //
+    .width      =   480,            //
+    .height     =   272,            //
+    .hsync      =   41,             //
+    .vsync      =   10,             //
+    .hfp        =   32,             // or 8
+    .hbp        =   13,             // or 40
+    .vfp        =   2,              // or 4
+    .vbp        =   2,              // or 12
+    .pitch      = { 0,              // Position not used!!!!
+                    512,            // L8 and other 1 byte representation
+                    1024,           // RGB565 and other 2 bytes representation
+                    1536,           // RGB888 (3 bytes)
+                    2048 },         // for ARGB8888 (4 bytes)
+};
+
+/**
+ * @brief Pointer to current display
+ *
+ * @note  For now, only one
+ */
+const DisplayProperties_t *display = &dispRK043;
+
+/**
+ * @brief Symbols to make it easier to write complex expressions
+ */
+///@{
+#define LCD_FREQ    (display->frequency)
+#define HSW         (display->hsync)
+#define HAW         (display->width)
+#define HFP         (display->hfp)
+#define HBP         (display->hbp)
+#define VSH         (display->vsync)
+#define VAH         (display->height)
+#define VBP         (display->vbp)
+#define VFP         (display->vfp)
+#define POL         (display->polarity)
+///@}
+
+static const int pixelsize[] = {
+        4,  // 000: ARGB8888
+        3,  // 001: RGB888
+        2,  // 010: RGB565
+        2,  // 011: ARGB1555
+        2,  // 100: ARGB4444
+        1,  // 101: L8 (8-bit luminance)
+        1,  // 110: AL44 (4-bit alpha, 4-bit luminance)
+        1   // 111: AL88 (8-bit alpha, 8-bit luminance)
+};
+
+/**
+ *  @brief Pin Configuration for LCD
+ *
+ * Alternate Functions.(Table 12 of datasheet)
+ *
+ * LCD Signal   | ALT     |  Pin
+ * -------------|---------|--------------------
+ * LCD_CLK      |  AF14   | *PI14* PE14 PG7
+ *
+ * LCD_R0       |  AF14   | PG13 PH2 *PI15*
+ * LCD_R1       |  AF14   | PA2 PH3 *PJ0*
+ * LCD_R2       |  AF14   | PA1 PC10 PH8 *PJ1*
+ * LCD_R3       |  AF14   | PH9 *PJ2* PB0 (AF9)
+ * LCD_R4       |  AF14   | PA5 PA11 PH10 *PJ3*
+ * LCD_R5       |  AF14   | PA12 PC0 PH11 *PJ4*
+ * LCD_R6       |  AF14   | PA8 PH12 *PJ5* PB1(AF9)
+ * LCD_R7       |  AF14   | PE15 PG6 *PJ6*
+ *
+ * LCD_G0       |  AF14   | PE5 *PJ7*
+ * LCD_G1       |  AF14   | PE6 *PJ8*
+ * LCD_G2       |  AF14   | PA6 PH13 *PJ9*
+ * LCD_G3       |  AF14   | PE11 PH14 *PJ10* PG10(AF9)
+ * LCD_G4       |  AF14   | PB10 PH15 *PJ11*
+ * LCD_G5       |  AF14   | PB11 PI0 *PK0*
+ * LCD_G6       |  AF14   | PC7 PI1 *PK1*
+ * LCD_G7       |  AF14   | PD3 PI2 *PK2*
+ * -            |   -     | ---
+ * LCD_B0       |  AF14   | *PE4* PG14 PJ12
+ * LCD_B1       |  AF14   | PG12 *PJ13*
+ * LCD_B2       |  AF14   | PD6 PG10 *PJ14*
+ * LCD_B3       |  AF14   | PD10 PG11 *PJ15*
+ * LCD_B4       |  AF14   | PE12 PG12 *PG12(AF9)* PI4 PK3
+ * LCD_B5       |  AF14   | PA3 PI5 *PK4*
+ * LCD_B6       |  AF14   | PB8 PI6 *PK5*
+ * LCD_B7       |  AF14   | PB9 PI7 *PK6*
+ * -            |   -     | ---
+ * LCD_VSYNC    |  AF14   | PA4 *PI9* PI13
+ * LCD_HSYNC    |  AF14   | PC6 *PI10* PI12
+ * LCD_DE       |  AF14   | PE13 PF10 *PK7*
+ *
+ * The following uses GPIO I/O or other modes
+ *
+ * LCD Signal    |        |  Pin   |  Description
+ * --------------|--------|--------|------------------
+ *  LCD_DISP     | GPIO   | I12    |  Enable LCD
+ *  LCD_INT      | GPIO   | I13    |  LCD Interrupt
+ *  LCD_BL_CTRL  | GPIO   | K3     |  Backlight PWM
+ */
+
+#ifdef LCD_USEGPIO
+
+#include "gpio.h"
+/* Pin Configuration Fields                                                    */
+/* GPIOx: GPIO interface        [GPIOA...GPIOK]                                */
+/*     AF: Alternate function   [0:GPIO,2:I2C, ... 14:LCD]                     */
+/*     M:  Mode                 [0:Input, 1=Output,2=AF,3=Analog]              */
+/*     OT: Output Type          [0:Push-pull, 1=Open-drain ]                   */
+/*     S:  Speed                [0:Low, 1:Medium, 2:High, 3:Very high]         */
+/*     P:  Pull-down/Pull-up    [0:None, 1:Pull-up, 2:Pull-down]               */
+/*     I:  Initial              [0: Low, 1:High]                               */
+static const GPIO_PinConfiguration configtable[] = {
+
+/*    GPIOx    Pin     AF  M  O  S  P  I  */
+// Control
+    { GPIOI,    14,    14, 2, 0, 3, 0, 0 },       // LCD_CLK
+    { GPIOI,     9,    14, 2, 0, 3, 0, 0 },       // LCD_VSYNC
+    { GPIOI,    10,    14, 2, 0, 3, 0, 0 },       // LCD_HSYNC
+    { GPIOK,     7,    14, 2, 0, 3, 0, 0 },       // LCD_DE
+// Red
+    { GPIOI,    15,    14, 2, 0, 3, 0, 0 },       // LCD_R0
+    { GPIOJ,     0,    14, 2, 0, 3, 0, 0 },       // LCD_R1
+    { GPIOJ,     1,    14, 2, 0, 3, 0, 0 },       // LCD_R2
+    { GPIOJ,     2,    14, 2, 0, 3, 0, 0 },       // LCD_R3
+    { GPIOJ,     3,    14, 2, 0, 3, 0, 0 },       // LCD_R4
+    { GPIOJ,     4,    14, 2, 0, 3, 0, 0 },       // LCD_R5
+    { GPIOJ,     5,    14, 2, 0, 3, 0, 0 },       // LCD_R6
+    { GPIOJ,     6,    14, 2, 0, 3, 0, 0 },       // LCD_R7
+// Green
+    { GPIOJ,     7,    14, 2, 0, 3, 0, 0 },       // LCD_G0
+    { GPIOJ,     8,    14, 2, 0, 3, 0, 0 },       // LCD_G1
+    { GPIOJ,     9,    14, 2, 0, 3, 0, 0 },       // LCD_G2
+    { GPIOJ,    10,    14, 2, 0, 3, 0, 0 },       // LCD_G3
+    { GPIOJ,    11,    14, 2, 0, 3, 0, 0 },       // LCD_G4
+    { GPIOK,     0,    14, 2, 0, 3, 0, 0 },       // LCD_G5
+    { GPIOK,     1,    14, 2, 0, 3, 0, 0 },       // LCD_G6
+    { GPIOK,     2,    14, 2, 0, 3, 0, 0 },       // LCD_G7
+// Blue
+    { GPIOE,     4,    14, 2, 0, 3, 0, 0 },       // LCD_B0
+    { GPIOJ,    13,    14, 2, 0, 3, 0, 0 },       // LCD_B1
+    { GPIOJ,    14,    14, 2, 0, 3, 0, 0 },       // LCD_B2
+    { GPIOJ,    15,    14, 2, 0, 3, 0, 0 },       // LCD_B3
+    { GPIOG,    12,    14, 2, 0, 3, 0, 0 },       // LCD_B4
+    { GPIOK,     4,    14, 2, 0, 3, 0, 0 },       // LCD_B5
+    { GPIOK,     5,    14, 2, 0, 3, 0, 0 },       // LCD_B6
+    { GPIOK,     6,    14, 2, 0, 3, 0, 0 },       // LCD_B7
+
+// I2C
+    { GPIOH,     7,     4, 0, 2, 3, 0, 0 },       // LCD_SCL / AUDIO SCL (I2C3_SDA)
+    { GPIOH,     8,     4, 0, 2, 3, 0, 0 },       // LCD_SDA / AUDIO SDA (I2C3_SCL)
+// Others
+    { GPIOI,    13,     0, 0, 1, 0, 0, 0 },       // LCD INT = input
+    { GPIOI,    12,     0, 1, 0, 3, 0, 0 },       // LCD DISP = output
+    { GPIOK,     3,     0, 1, 0, 2, 0 ,0 },       // LCD Backlight Control = output
+    {     0,     0,     0, 0, 0, 0, 0 ,0 },       // End of table indicator
+};
+
+
+static void ConfigureLCDPins(void) {
+
+    /* Configure pins from table*/
+    GPIO_ConfigureMultiplePins(configtable);
+
+}
+#else
+
+static void ConfigureLCDPins(void) {
+uint32_t mFIELD, mVALUE;
+
+    /********* Configuring LCD signals *******************/
+
+    /*
+     * Port   GPIOE
+     */
+                // Enabling clock
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOEEN;
+    __NOP(); __DSB();
+                // Configuring Mode
+
+    mFIELD =    GPIO_MODER_MODER4_Msk;
+    mVALUE =   (2<<GPIO_MODER_MODER4_Pos);
+    GPIOE->MODER  = (GPIOE->MODER&~mFIELD)|mVALUE;
+
+                // Configuring Alternate Function (Pins 7-0)
+    mFIELD =    GPIO_AFRL_AFRL4_Msk;
+    mVALUE =   (14<<GPIO_AFRL_AFRL4_Pos);
+    GPIOE->AFR[0]  = (GPIOE->AFR[0]&~mFIELD)|mVALUE;
+
+    /*
+     * Port   GPIOG
+     */
+                // Enabling clock
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOGEN;
+    __NOP(); __DSB();
+                // Configuring Mode
+    mFIELD =    GPIO_MODER_MODER12_Msk;
+    mVALUE =   (2<<GPIO_MODER_MODER12_Pos);
+    GPIOG->MODER  = (GPIOG->MODER&~mFIELD)|mVALUE;
+
+                // Configuring Alternate Function (Pins 15-8)
+    mFIELD =    GPIO_AFRL_AFRL4_Msk;
+    mVALUE =   (14<<GPIO_AFRL_AFRL4_Pos);  /////////
+    GPIOG->AFR[1]  = (GPIOG->AFR[1]&~mFIELD)|mVALUE;
+
+    /*
+     * Port   GPIOI
+     */
+                // Enabling clock
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOIEN;
+    __NOP(); __DSB();
+                // Configuring Mode
+    mFIELD =   GPIO_MODER_MODER9_Msk
+              |GPIO_MODER_MODER10_Msk
+              |GPIO_MODER_MODER12_Msk
+              |GPIO_MODER_MODER13_Msk
+              |GPIO_MODER_MODER14_Msk
+              |GPIO_MODER_MODER15_Msk;
+    mVALUE =   (2<<GPIO_MODER_MODER9_Pos)
+              |(2<<GPIO_MODER_MODER10_Pos)
+              |(2<<GPIO_MODER_MODER12_Pos)
+              |(2<<GPIO_MODER_MODER13_Pos)
+              |(2<<GPIO_MODER_MODER14_Pos)
+              |(2<<GPIO_MODER_MODER15_Pos);
+    GPIOI->MODER  = (GPIOI->MODER&~mFIELD)|mVALUE;
+
+                // Configuring Alternate Function (Pins 15-8)
+    mFIELD =   GPIO_AFRL_AFRL1_Msk
+              |GPIO_AFRL_AFRL2_Msk
+              |GPIO_AFRL_AFRL4_Msk
+              |GPIO_AFRL_AFRL5_Msk
+              |GPIO_AFRL_AFRL6_Msk
+              |GPIO_AFRL_AFRL7_Msk;
+    mVALUE =   (14<<GPIO_AFRL_AFRL1_Pos)
+              |(14<<GPIO_AFRL_AFRL2_Pos)
+              |(14<<GPIO_AFRL_AFRL4_Pos)
+              |(14<<GPIO_AFRL_AFRL5_Pos)
+              |(14<<GPIO_AFRL_AFRL6_Pos)
+              |(14<<GPIO_AFRL_AFRL7_Pos);
+    GPIOI->AFR[1]  = (GPIOI->AFR[1]&~mFIELD)|mVALUE;
+
+    /*
+     * Port   GPIOJ
+     */
+                // Enabling clock
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOJEN;
+    __NOP(); __DSB();
+                // Configuring Mode
+    mFIELD =   GPIO_MODER_MODER0_Msk
+              |GPIO_MODER_MODER1_Msk
+              |GPIO_MODER_MODER2_Msk
+              |GPIO_MODER_MODER3_Msk
+              |GPIO_MODER_MODER4_Msk
+              |GPIO_MODER_MODER5_Msk
+              |GPIO_MODER_MODER6_Msk
+              |GPIO_MODER_MODER7_Msk;
+
+    mVALUE =   (2<<GPIO_MODER_MODER0_Pos)
+              |(2<<GPIO_MODER_MODER1_Pos)
+              |(2<<GPIO_MODER_MODER2_Pos)
+              |(2<<GPIO_MODER_MODER3_Pos)
+              |(2<<GPIO_MODER_MODER4_Pos)
+              |(2<<GPIO_MODER_MODER5_Pos)
+              |(2<<GPIO_MODER_MODER6_Pos)
+              |(2<<GPIO_MODER_MODER7_Pos)
+              |(2<<GPIO_MODER_MODER8_Pos)
+              |(2<<GPIO_MODER_MODER9_Pos)
+              |(2<<GPIO_MODER_MODER10_Pos)
+              |(2<<GPIO_MODER_MODER11_Pos)
+              |(2<<GPIO_MODER_MODER13_Pos)
+              |(2<<GPIO_MODER_MODER14_Pos)
+              |(2<<GPIO_MODER_MODER15_Pos);
+    GPIOJ->MODER  = (GPIOJ->MODER&~mFIELD)|mVALUE;
+
+                // Configuring Alternate Function (Pins 7-0)
+    mFIELD =   GPIO_AFRL_AFRL0_Msk
+              |GPIO_AFRL_AFRL1_Msk
+              |GPIO_AFRL_AFRL2_Msk
+              |GPIO_AFRL_AFRL3_Msk
+              |GPIO_AFRL_AFRL4_Msk
+              |GPIO_AFRL_AFRL5_Msk
+              |GPIO_AFRL_AFRL6_Msk
+              |GPIO_AFRL_AFRL7_Msk;
+    mVALUE =   (14<<GPIO_AFRL_AFRL0_Pos)
+              |(14<<GPIO_AFRL_AFRL1_Pos)
+              |(14<<GPIO_AFRL_AFRL2_Pos)
+              |(14<<GPIO_AFRL_AFRL3_Pos)
+              |(14<<GPIO_AFRL_AFRL4_Pos)
+              |(14<<GPIO_AFRL_AFRL5_Pos)
+              |(14<<GPIO_AFRL_AFRL6_Pos)
+              |(14<<GPIO_AFRL_AFRL7_Pos);
+    GPIOJ->AFR[0]  = (GPIOJ->AFR[0]&~mFIELD)|mVALUE;
+
+                // Configuring Alternate Function (Pins 15-8)
+    mFIELD =   GPIO_AFRL_AFRL0_Msk
+              |GPIO_AFRL_AFRL1_Msk
+              |GPIO_AFRL_AFRL2_Msk
+              |GPIO_AFRL_AFRL3_Msk
+              |GPIO_AFRL_AFRL5_Msk
+              |GPIO_AFRL_AFRL6_Msk
+              |GPIO_AFRL_AFRL7_Msk;
+    mVALUE =   (14<<GPIO_AFRL_AFRL0_Pos)
+              |(14<<GPIO_AFRL_AFRL1_Pos)
+              |(14<<GPIO_AFRL_AFRL2_Pos)
+              |(14<<GPIO_AFRL_AFRL3_Pos)
+              |(14<<GPIO_AFRL_AFRL5_Pos)
+              |(14<<GPIO_AFRL_AFRL6_Pos)
+              |(14<<GPIO_AFRL_AFRL7_Pos);
+    GPIOJ->AFR[1]  = (GPIOJ->AFR[1]&~mFIELD)|mVALUE;
+
+
+
+    /*
+     * Port   GPIOK
+     */
+                // Enabling clock
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOIEN;
+    __NOP(); __DSB();
+                // Configuring Mode
+    mFIELD =   GPIO_MODER_MODER0_Msk
+              |GPIO_MODER_MODER1_Msk
+              |GPIO_MODER_MODER2_Msk
+              |GPIO_MODER_MODER4_Msk
+              |GPIO_MODER_MODER5_Msk
+              |GPIO_MODER_MODER6_Msk
+              |GPIO_MODER_MODER7_Msk;
+    mVALUE =   (2<<GPIO_MODER_MODER0_Pos)
+              |(2<<GPIO_MODER_MODER1_Pos)
+              |(2<<GPIO_MODER_MODER2_Pos)
+              |(2<<GPIO_MODER_MODER4_Pos)
+              |(2<<GPIO_MODER_MODER5_Pos)
+              |(2<<GPIO_MODER_MODER6_Pos)
+              |(2<<GPIO_MODER_MODER7_Pos);
+    GPIOK->MODER  = (GPIOK->MODER&~mFIELD)|mVALUE;
+
+                // Configuring Alternate Function (Pins 7-0)
+    mFIELD =   GPIO_AFRL_AFRL0_Msk
+              |GPIO_AFRL_AFRL1_Msk
+              |GPIO_AFRL_AFRL2_Msk
+              |GPIO_AFRL_AFRL4_Msk
+              |GPIO_AFRL_AFRL5_Msk
+              |GPIO_AFRL_AFRL6_Msk
+              |GPIO_AFRL_AFRL7_Msk;
+    mVALUE =   (14<<GPIO_AFRL_AFRL0_Pos)
+              |(14<<GPIO_AFRL_AFRL1_Pos)
+              |(14<<GPIO_AFRL_AFRL2_Pos)
+              |(14<<GPIO_AFRL_AFRL4_Pos)
+              |(14<<GPIO_AFRL_AFRL5_Pos)
+              |(14<<GPIO_AFRL_AFRL6_Pos)
+              |(14<<GPIO_AFRL_AFRL7_Pos);
+    GPIOK->AFR[0]  = (GPIOK->AFR[0]&~mFIELD)|mVALUE;
+
+    /*
+     * I2C signals
+     */
+                // Enabling clock
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOHEN;
+    __NOP(); __DSB();
+                // Configuring Mode
+    mFIELD =   GPIO_MODER_MODER7_Msk
+              |GPIO_MODER_MODER8_Msk;
+    mVALUE =   (2<<GPIO_MODER_MODER7_Pos)
+              |(2<<GPIO_MODER_MODER8_Pos);
+    GPIOH->MODER  = (GPIOH->MODER&~mFIELD)|mVALUE;
+                // Configuring Alternate Function (Pins 7-0)
+    mFIELD =   GPIO_AFRL_AFRL7_Msk;
+    mVALUE =   (4<<GPIO_AFRL_AFRL7_Pos);
+    GPIOH->AFR[0]  = (GPIOH->AFR[0]&~mFIELD)|mVALUE;
+                // Configuring Alternate Function (Pins 15-8)
+    mFIELD =   GPIO_AFRL_AFRL0_Msk;
+    mVALUE =   (4<<GPIO_AFRL_AFRL0_Pos);
+    GPIOH->AFR[1]  = (GPIOH->AFR[1]&~mFIELD)|mVALUE;
+    /*
+     * LCD Control signals using GPIO
+     *
+     *     LCD_INT      PI13    input   LCD interrupt signal
+     *     LCD_DISP     PI12    output
+     *     LCD_BL_CTRL  PK3     output
+     */
+                // Enabling clock
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOIEN;
+    __NOP(); __DSB();
+                // Configuring mode
+    mFIELD =   GPIO_MODER_MODER12_Msk
+              |GPIO_MODER_MODER13_Msk;
+    mVALUE =   (1<<GPIO_MODER_MODER12_Pos)
+              |(0<<GPIO_MODER_MODER13_Pos);
+    GPIOI->MODER  = (GPIOI->MODER&~mFIELD)|mVALUE;
+
+                // Enabling clock
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOKEN;
+    __NOP(); __DSB();
+                // Configuring mode
+    mFIELD =   GPIO_MODER_MODER3_Msk;
+    mVALUE =   (1<<GPIO_MODER_MODER3_Pos);
+    GPIOK->MODER  = (GPIOK->MODER&~mFIELD)|mVALUE;
+
+}
+#endif
+
+/**
+ * @brief   Turn LCD Backlight On/Off
+ *
+ * @note    GPIOK Pin 3 controls the backlight
+ */
+
+///@{
+void  LCD_TurnBacklightOn(void) {
+
+#ifdef LCD_USEGPIO
+    GPIO_Init(GPIOK,0,LCD_BACKLIGHTCTRL_MASK);
+    GPIO_Set(GPIOK,LCD_BACKLIGHTCTRL_MASK);
+#else
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOKEN;
+    __NOP(); __DSB();
+    GPIOK->MODER  = (GPIOK->MODER&~GPIO_MODER_MODER3_Msk)
+                    |(1<<GPIO_MODER_MODER3_Pos);
+    GPIOK->BSRR |= LCD_BACKLIGHTCTRL_MASK;
+#endif
+
+}
+
+void  LCD_TurnBacklightOff(void) {
+
+#ifdef LCD_USEGPIO
+    GPIO_Init(GPIOK,0,LCD_BACKLIGHTCTRL_MASK);
+    GPIO_Clear(GPIOK,LCD_BACKLIGHTCTRL_MASK);
+#else
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOKEN;
+    __NOP(); __DSB();
+    GPIOK->MODER  = (GPIOK->MODER&~GPIO_MODER_MODER3_Msk)
+                    |(1<<GPIO_MODER_MODER3_Pos);
+    GPIOK->BSRR |= (LCD_BACKLIGHTCTRL_MASK<<16);
+#endif
+
+}
+///@}
+
+/**
+ * @brief   Put LCD Operation/Standby
+ *
+ * @note    GPIOI Pin 12 controls normal operation/standby
+ */
+
+///@{
+void  LCD_PutDisplayOperation(void) {
+
+#ifdef LCD_USEGPIO
+    GPIO_Set(GPIOI,LCD_NORMALSTANDBY_MASK);
+#else
+    GPIOI->BSRR |= LCD_NORMALSTANDBY_MASK;
+#endif
+
+}
+
+void  LCD_PutDisplayStandBy(void) {
+
+#ifdef LCD_USEGPIO
+    GPIO_Clear(GPIOI,LCD_NORMALSTANDBY_MASK);
+#else
+    GPIOI->BSRR |= (LCD_NORMALSTANDBY_MASK<<16);
+#endif
+
+}
+///@}
+
+
+
+/**
+ * @brief   Enable/Disable LCD Controler
+ *
+ * @note    Disable LTDC controller
+ */
+
+///@{
+void  LCD_EnableController(void) {
+
+    LTDC->GCR |= LTDC_GCR_LTDCEN;
+
+}
+
+void  LCD_DisableController(void) {
+
+    LTDC->GCR &= ~LTDC_GCR_LTDCEN;
+
+}
+///@}
+
+
+/**
+ * @brief   Turn LCD Backlight On/Off
+ *
+ * @note    GPIOK Pin 3 controls the backlight
+ */
+
+///@{
+void  LCD_On(void) {
+
+    LCD_EnableController();
+    LCD_PutDisplayOperation();
+    LCD_TurnBacklightOn();
+
+}
+
+void  LCD_Off(void) {
+
+    LCD_DisableController();
+    LCD_PutDisplayStandBy();
+    LCD_TurnBacklightOff();
+}
+///@}
+
+
+/*
+ * @brief   Configuration for PLLSAI
+ *
+ * @note    Assumes PLL Main will use HSE (crystal) and have a 1 MHz input for PLL
+ *
+ * @note    $$ f_{VCOOUT} = f_{INPUT} * N / M $$
+ *          $$ f_{OUTP} = {VCOOUT} / P $$
+ *          $$ f_{OUTQ} = {VCOOUT} / Q $$
+ *          $$ f_{OUTR} = {VCOOUT} / R $$
+ *
+ *          $$ f_{INPUT} = "16 MHz (HSI)" or "25 MHz (HSE)" $$
+ *          $$ M = {2..63} identical to the one used in Main PLL
+ *          $$ N = {50..432 } $$
+ *          $$ P = {2, 4, 6, 8 } $$
+ *          $$ Q = {2..15 } $$
+ *          $$ R = {2..7} $$
+
+
+ * @note    LCD_CLK should be in range 5-12, with typical value 9 MHz.
+ *
+ * @note    There is an extra divisor in PLLSAIDIVR[1:0] of RCC_DCKCFGR, that can
+ *          have value 2, 4, 8 or 16.
+ *
+ * @note    So the R output must be 18, 36, 72 or 144 MHz.
+ *          But USB, RNG and SDMMC needs 48 MHz. The LCM of 48 and 9 is 144.
+ *          But there are a minimal value for the divisor equal to 2.
+ *          $$ f_{OUTR} = 72 $$
+ *
+ * @note    For f_LCDCLK  = 9 MHz the extra divisor PLLSAIRDIV must be 8
+ *
+ */
+
+/**
+ * @brief   Flag to indicate clock for the LCD is set
+ */
+static int  LCDCLOCK_Initialized = 0;
+
+#ifdef USE_PLLCONFIG
+/**
+ * @brief   PLLSAI configuration and PLLSAIDIVR found by tools/mkpll (pllconfig.h)
+ */
+static const PLLConfiguration_t PLLSAIConfiguration = PLLCONFIG_SAI;
+#endif
+
+/**
+ * @brief   Set Clock for LCD
+ *
+ * @note    LCD_CLOCK for the display used must be in the range [5..12]
+ */
+int LCD_SetClock(void) {
+uint32_t pllsaidivr;
+#ifndef USE_PLLCONFIG
+int div;
+PLLOutputFrequencies_t pllfreq;
+#endif
+
+#ifdef USE_PLLCONFIG
+    if( ! (RCC->CR&RCC_CR_PLLSAION) ) {
+        SystemConfigPLLSAI(&PLLSAIConfiguration);
+        SystemEnablePLLSAI();
+    }
+    pllsaidivr = PLLCONFIG_PLLSAIDIVR;
+#else
+    if( ! (RCC->CR&RCC_CR_PLLSAION) ) {
+        SystemConfigPLLSAI(&PLLSAIConfiguration_48MHz);
+        SystemEnablePLLSAI();
+    }
+
+    SystemGetPLLFrequencies(PLL_SAI, &pllfreq);
+    div = pllfreq.routfreq/LCD_FREQ;
+
+
+    switch(div) {
+    case 2:  pllsaidivr = 0; break;
+    case 4:  pllsaidivr = 1; break;
+    case 8:  pllsaidivr = 2; break;
+    case 16: pllsaidivr = 3; break;
+    default:
+        return -2; // ignore wrong divisor
+    }
+#endif
+
+    // Configure divisor for LCD controller
+    RCC->DCKCFGR1 = (RCC->DCKCFGR1&~RCC_DCKCFGR1_PLLSAIDIVR)
+                    |(pllsaidivr<<RCC_DCKCFGR1_PLLSAIDIVR_Pos);
+
+    // Enable clock for LCD controller
+    RCC->APB2ENR |= RCC_APB2ENR_LTDCEN;
+
+    LCDCLOCK_Initialized = 1;
+    return 0;
+}
+
+
+/**
+ * @brief   LCD Low Level Initializationb
+ *
+ * @note    Configure LCD unit
+ *
+ * @note    *PLLSAI must be configured and ON before calling this routine*
+ *
+ * @note    The R output of PLLSAI generates pixel clock (LCD_CLK)
+ */
+
+void LCD_Init(void) {
+
+    /* If LCD Clock not initialized */
+    if( !LCDCLOCK_Initialized )
+        LCD_SetClock();
+
+    /* If PLLSAI not on, return */
+    if( (RCC->CR & RCC_CR_PLLSAION) == 0 )
+        return;
+
+    /* If PLLSAI not ready, return */
+    if( (RCC->CR & RCC_CR_PLLSAIRDY) == 0 )
+        return;
+
+    /* Configure pins for LCD usage */
+    ConfigureLCDPins();
+
+    // Enable clock for LCD
+    RCC->APB2ENR |= RCC_APB2ENR_LTDCEN;
+
+    // Reset LCD
+
+    // configure polarity of control signals
+    LTDC->GCR =   (LTDC->GCR&~(LTDC_GCR_DEPOL|LTDC_GCR_HSPOL|LTDC_GCR_VSPOL|LTDC_GCR_PCPOL))
+                 |(POL);
+    // Configure LCD geometry
+    LTDC->SSCR =  ((HSW-1)<<LTDC_SSCR_HSW_Pos)
+                 |((VSH-1)<<LTDC_SSCR_VSH_Pos);
+    LTDC->BPCR =  ((HSW+HBP-1)<<LTDC_BPCR_AHBP_Pos)
+                 |((VSH+VBP-1)<<LTDC_BPCR_AVBP_Pos);
+    LTDC->AWCR =  ((HSW+HBP+HAW-1)<<LTDC_AWCR_AAW_Pos)
+                 |((VSH+VBP+VAH-1)<<LTDC_AWCR_AAH_Pos);
+    LTDC->TWCR  = ((HSW+HBP+HAW+HFP-1)<<LTDC_TWCR_TOTALW_Pos)
+                 |((VSH+VBP+VAH+VFP-1)<<LTDC_TWCR_TOTALH_Pos);
+
+    // Set background color
+    LTDC->BCCR = BACKGROUND_COLOR;
+
+    /* Enable interrupts */
+    //LTDC->IER  |= (LTDC_IER_RRIE|LTDC_IER_TERRIE|LTDC_IER_FUIE|LTDC_IER_LIE);
+
+    /* DMA2D for fills */
+    DMA2D_Init();
+    for(int i=0;i<3;i++)
+        accelerated[i] = LCD_ACCEL_DEFAULT;
+
+
+    LCD_PutDisplayOperation();
+    LCD_TurnBacklightOn();
+
+}
+
+
+/*
+ * @brief   LCD Set Background Color
+ */
+
+void
+LCD_SetBackgroundColor( uint32_t bgcolor ) {
+
+    LTDC->BCCR = bgcolor;
+}
+
+
+//////////////////////////// LAYER routines ////////////////////////////////////////////////////////
+
+
+
+/**
+ * @brief   Enable/Disable Layer
+ *
+ * @note
+ */
+///@{
+void  LCD_EnableLayer(int layer) {
+
+    LTDC_Layer[layer]->CR |= LTDC_LxCR_LEN;
+    // Reload parameters
+    LTDC->SRCR |= LTDC_SRCR_IMR;
+}
+
+
+void  LCD_DisableLayer(int layer) {
+
+    LTDC_Layer[layer]->CR &= ~LTDC_LxCR_LEN;
+    // Reload parameters
+    LTDC->SRCR |= LTDC_SRCR_IMR;
+}
+
+void  LCD_SwapLayers(void) {
+
+    LTDC_Layer[0]->CR ^= LTDC_LxCR_LEN;
+    LTDC_Layer[1]->CR ^= LTDC_LxCR_LEN;
+    // Reload parameters
+    LTDC->SRCR |= LTDC_SRCR_IMR;
+}
+
+
+///@}
+
+/**
+ * @brief   Enable/Disable Layer
+ *
+ * @note
+ */
+void  LCD_ReloadLayerImmediately(int layer) {
+
+    LTDC->SRCR |= LTDC_SRCR_IMR;
+}
+
+/**
+ * @brief   Enable/Disable Layer
+ *
+ * @note
+ */
+void  LCD_ReloadLayerByVerticalBlanking(int layer) {
+
+    LTDC->SRCR |= LTDC_SRCR_VBR;
+}
+
+
+/*
+ * @brief   LCD Set Default Color for layer
+ */
+
+void
+LCD_SetDefaultColor(int layer,  uint32_t color ) {
+
+    LTDC_Layer[layer]->DCCR = color;
+}
+
+/*
+ * @brief   LCD Set format for layer
+ */
+void  LCD_SetFormat(int layer, int format) {
+
+    LTDC_Layer[layer]->PFCR = format;
+}
+
+
+
+/*
+ * @brief   LCD SetLayerOpacity
+ *
+ * @note    Set of constant alpha opacity
+ */
+void  LCD_SetLayerOpacity(int layer, int opacity) {
+uint32_t bfcr;
+
+    if( opacity > 255 ) opacity = 255;
+
+    LTDC_Layer[layer]->CACR = opacity;
+
+    bfcr = LTDC_Layer[layer]->BFCR;
+    if( layer == 1 ) {
+        LTDC_Layer[layer]->BFCR = (bfcr&~LTDC_LxBFCR_BF1_Msk)|(4<<LTDC_LxBFCR_BF1_Pos);
+    } else if ( layer == 2 ) {
+        LTDC_Layer[layer]->BFCR = (bfcr&~LTDC_LxBFCR_BF2_Msk)|(4<<LTDC_LxBFCR_BF2_Pos);
+    }
+
+}
+
+/*
+ * @brief   LCD Set Color Key for layer
+ */
+
+void
+LCD_SetColorKey(int layer,  uint32_t c ) {
+
+    LTDC_Layer[layer]->CKCR = c;
+}
+
+/**
+ * @brief   LCD_EnableColorKey
+ *
+ * @note    Pixels of layer with color c (RGB888) become transparent. Effective
+ *          at the next reload
+ */
+void
+LCD_EnableColorKey(int layer, uint32_t c) {
+
+    LTDC_Layer[layer]->CKCR = c&0xFFFFFF;
+    LTDC_Layer[layer]->CR  |= LTDC_LxCR_COLKEN;
+}
+
+/**
+ * @brief   LCD_DisableColorKey
+ */
+void
+LCD_DisableColorKey(int layer) {
+
+    LTDC_Layer[layer]->CR  &= ~LTDC_LxCR_COLKEN;
+}
+
+/**
+ * @brief   LCD_SetLayerPosition
+ *
+ * @note    Moves the window of layer to (hp,vp) keeping its size. The window is
+ *          kept inside the display. Effective at the next reload
+ *
+ * @note    Only the window registers change, so no pixel is copied
+ */
+void
+LCD_SetLayerPosition(int layer, int hp, int vp) {
+LTDC_Layer_TypeDef *const p = LTDC_Layer[layer];
+int w,h,dw,dh;
+
+    w  = ((p->WHPCR&LTDC_LxWHPCR_WHSPPOS_Msk)>>LTDC_LxWHPCR_WHSPPOS_Pos)
+        -((p->WHPCR&LTDC_LxWHPCR_WHSTPOS_Msk)>>LTDC_LxWHPCR_WHSTPOS_Pos)+1;
+    h  = ((p->WVPCR&LTDC_LxWVPCR_WVSPPOS_Msk)>>LTDC_LxWVPCR_WVSPPOS_Pos)
+        -((p->WVPCR&LTDC_LxWVPCR_WVSTPOS_Msk)>>LTDC_LxWVPCR_WVSTPOS_Pos)+1;
+
+    if( hp+w > (int) display->width )  hp = display->width-w;
+    if( vp+h > (int) display->height ) vp = display->height-h;
+    if( hp < 0 ) hp = 0;
+    if( vp < 0 ) vp = 0;
+
+    dw = (LTDC->BPCR&LTDC_BPCR_AHBP_Msk)>>LTDC_BPCR_AHBP_Pos;
+    dh = (LTDC->BPCR&LTDC_BPCR_AVBP_Msk)>>LTDC_BPCR_AVBP_Pos;
+
+    p->WHPCR  = ((hp+w+dw)<<LTDC_LxWHPCR_WHSPPOS_Pos)
+               |((hp+dw+1)<<LTDC_LxWHPCR_WHSTPOS_Pos);
+    p->WVPCR  = ((vp+h+dh)<<LTDC_LxWVPCR_WVSPPOS_Pos)
+               |((vp+dh+1)<<LTDC_LxWVPCR_WVSTPOS_Pos);
+}
+
+
+//////////////////////////// CLUT routines /////////////////////////////////////////////////////
+
+/**
+ * @brief   Palettes of the layers
+ *
+ * @note    Copy of what was loaded in the LTDC CLUT. The CLUT registers can not
+ *          be read back, and LCD_GetColorIndex needs them
+ */
+///@{
+static uint32_t palette[3][LCD_CLUTSIZE];
+static int      palettesize[3] = { 0, 0, 0 };
+///@}
+
+/**
+ * @brief   LCD_LoadCLUT
+ *
+ * @note    Loads n colors (RGB888, alpha ignored) at the start of the CLUT of a
+ *          layer. They are used by the L8, AL44 and AL88 formats when the CLUT
+ *          is enabled (LCD_EnableCLUT)
+ *
+ * @note    The CLUT can only be written when the layer is disabled or during
+ *          the vertical blanking. When the layer is enabled, it waits for it.
+ *
+ * @note    Returns 0 when OK, -1 on error
+ */
+int
+LCD_LoadCLUT(int layer, const uint32_t *colors, int n) {
+LTDC_Layer_TypeDef *p = LTDC_Layer[layer];
+int i;
+
+    if( n <= 0 || n > LCD_CLUTSIZE )
+        return -1;
+
+    if( p->CR&LTDC_LxCR_LEN ) {
+        while( LTDC->CDSR&LTDC_CDSR_VDES ) {}
+    }
+    for(i=0;i<n;i++) {
+        palette[layer][i] = colors[i]&0xFFFFFF;
+        p->CLUTWR = (((uint32_t) i)<<LTDC_LxCLUTWR_CLUTADD_Pos)|palette[layer][i];
+    }
+    palettesize[layer] = n;
+    return 0;
+}
+
+/**
+ * @brief   Enable/Disable CLUT of a layer
+ *
+ * @note    Takes effect at the next vertical blanking
+ */
+///@{
+void
+LCD_EnableCLUT(int layer) {
+
+    LTDC_Layer[layer]->CR |= LTDC_LxCR_CLUTEN;
+    LTDC->SRCR |= LTDC_SRCR_VBR;
+}
+
+void
+LCD_DisableCLUT(int layer) {
+
+    LTDC_Layer[layer]->CR &= ~LTDC_LxCR_CLUTEN;
+    LTDC->SRCR |= LTDC_SRCR_VBR;
+}
+///@}
+
+/**
+ * @brief   LCD_GetColorIndex
+ *
+ * @note    Returns the index of the palette entry nearest to color (RGB888).
+ *          The result can be used as color in the fill and draw routines of
+ *          L8 layers (or with LCD_AL44/LCD_AL88 for the others)
+ *
+ * @note    Returns 0 when no palette was loaded
+ */
+int
+LCD_GetColorIndex(int layer, uint32_t color) {
+int i,best,dr,dg,db;
+uint32_t d,bestd,c;
+
+    best  = 0;
+    bestd = 0xFFFFFFFF;
+    for(i=0;i<palettesize[layer];i++) {
+        c  = palette[layer][i];
+        dr = (int) ((c>>16)&0xFF)-(int) ((color>>16)&0xFF);
+        dg = (int) ((c>>8)&0xFF)-(int) ((color>>8)&0xFF);
+        db = (int) (c&0xFF)-(int) (color&0xFF);
+        d  = dr*dr+dg*dg+db*db;
+        if( d < bestd ) {
+            bestd = d;
+            best  = i;
+            if( d == 0 )
+                break;
+        }
+    }
+    return best;
+}
+
+/*
+ * @brief   LCD Get Frame Buffer Address of a specified layer
+ */
+void *
+LCD_GetFrameBufferAddress(int layer) {
+
+   return (void *) LTDC_Layer[layer]->CFBAR;
+}
+
+
+/*
+ * @brief   LCD Get Format used in layer
+ */
+int   LCD_GetFormat(int layer) {
+
+    return LTDC_Layer[layer]->PFCR;
+}
+
+/*
+ * @brief   LCD Get Pixel Size in bytes of the layer specified
+ */
+int   LCD_GetPixelSize(int layer) {
+
+    return pixelsize[LCD_GetFormat(layer)];
+}
+
+/*
+ * @brief   LCD Get Pixel Size in bytes of the layer specified
+ *
+ * @note    Uses the pitch information to calculate the demanded
+ *          area size
+ */
+int   LCD_GetMinimalFullFrameBufferSize(int format) {
+int ps = pixelsize[format];
+
+    return display->pitch[ps]*display->height;
+
+}
+
+/*
+ * @brief   LCD Set Frame Buffer for layer
+ */
+
+void
+LCD_SetFullSizeFrameBuffer(int layer, void *area, int format) {
+LTDC_Layer_TypeDef *const p = LTDC_Layer[layer];
+uint32_t ps,w,h,ws,hs,pitch,dw,dh;
+
+    ps        = pixelsize[format];
+    h         = display->height;
+    w         = display->width;
+    p->PFCR   = format;
+    pitch     = display->pitch[ps];
+    p->CFBAR  = (uint32_t) area;
+    p->CFBLR  = (pitch<<LTDC_LxCFBLR_CFBP_Pos) | ((w*ps+3)<<LTDC_LxCFBLR_CFBLL_Pos);
+    p->CFBLNR = (h<<LTDC_LxCFBLNR_CFBLNBR_Pos);
+
+    dw        = (LTDC->BPCR&LTDC_BPCR_AHBP_Msk)>>LTDC_BPCR_AHBP_Pos;
+    ws        = w+dw;
+    dh        = (LTDC->BPCR&LTDC_BPCR_AVBP_Msk)>>LTDC_BPCR_AVBP_Pos;
+    hs        = h+dh;
+    p->WHPCR  = ((ws)<<LTDC_LxWHPCR_WHSPPOS_Pos)
+               |((dw+1)<<LTDC_LxWHPCR_WHSTPOS_Pos);
+    p->WVPCR  = ((hs)<<LTDC_LxWVPCR_WVSPPOS_Pos)
+               |((dh+1)<<LTDC_LxWVPCR_WVSTPOS_Pos);
+
+    // Enable layer, effective immediately
+    LCD_EnableLayer(layer);
+    LTDC->SRCR |= LTDC_SRCR_IMR;
+}
+
+/*
+ * @brief   LCD Set Frame Buffer for layer
+ */
+
+void
+LCD_SetFrameBuffer(int layer, void *a, int f, int x, int y, int w, int h, int pi ) {
+LTDC_Layer_TypeDef *const p = LTDC_Layer[layer];
+uint32_t ps,uf,uw,uh,pitch,dw,dh,hmax,wmax;
+
+    hmax      = display->height;
+    wmax      = display->width;
+    ps        = pixelsize[f];
+    pitch     = pi;
+    // Avoid extrapolation
+    if ( (x+w) > wmax )
+        w = (wmax-x)-1;
+    if ( (y+h) > hmax )
+        h = (hmax-y)-1;
+
+    // Configure dimensions
+    uh        = h;
+    uw        = w;
+    p->PFCR   = f;
+    p->CFBAR  = (uint32_t) a;
+    p->CFBLR  = (pitch<<LTDC_LxCFBLR_CFBP_Pos) | ((uw*ps+3)<<LTDC_LxCFBLR_CFBLL_Pos);
+    p->CFBLNR = (uh<<LTDC_LxCFBLNR_CFBLNBR_Pos);
+
+    // Get initial shift
+    dw        = (LTDC->BPCR&LTDC_BPCR_AHBP_Msk)>>LTDC_BPCR_AHBP_Pos;
+    dh        = (LTDC->BPCR&LTDC_BPCR_AVBP_Msk)>>LTDC_BPCR_AVBP_Pos;
+
+    // Configure start and stop position
+    p->WHPCR  = ((x+uw+dw)<<LTDC_LxWHPCR_WHSPPOS_Pos)
+               |((x+dw+1)<<LTDC_LxWHPCR_WHSTPOS_Pos);
+    p->WVPCR  = ((y+uh+dh)<<LTDC_LxWVPCR_WVSPPOS_Pos)
+               |((y+dh+1)<<LTDC_LxWVPCR_WVSTPOS_Pos);
+
+    // Enable layer, effective immediately
+    LCD_EnableLayer(layer);
+    LTDC->SRCR |= LTDC_SRCR_IMR;
+}
+
+/**
+ * @brief Get Framebuffer height
+ *
+ * @note  Returns the number of lines
+ */
+int
+LCD_GetHeight(int layer) {
+
+    return (LTDC_Layer[layer]->CFBLNR&LTDC_LxCFBLNR_CFBLNBR_Msk)>>LTDC_LxCFBLNR_CFBLNBR_Pos;
+
+}
+
+/**
+ * @brief Get Framebuffer width in pixels
+ */
+int
+LCD_GetWidth(int layer) {
+LTDC_Layer_TypeDef *p = LTDC_Layer[layer];
+int w, format, ps;
+
+
+    format = p->PFCR;
+    ps = pixelsize[format];
+    w = (p->CFBLR&LTDC_LxCFBLR_CFBLL_Msk)>>LTDC_LxCFBLR_CFBLL_Pos;
+    w -= 3;
+    w /= ps;
+
+    return w;
+
+}
+
+/**
+ * @brief Get Framebuffer pitch
+ *
+ * @note This is the distance in bytes
+ */
+int
+LCD_GetPitch(int layer) {
+
+    return (LTDC_Layer[layer]->CFBLR&LTDC_LxCFBLR_CFBP_Msk)>>LTDC_LxCFBLR_CFBP_Pos;
+
+}
+
+
+/**
+ * @brief   Get Line Address
+ *
+ * @note    It uses the pitch information to calculate the start position
+ *          of a line in buffer
+ */
+void *LCD_GetLineAddress(int layer, int line) {
+LTDC_Layer_TypeDef *p = LTDC_Layer[layer];
+
+    uint32_t base = (uint32_t) LCD_GetDrawBuffer(layer);
+    uint32_t pitch = p->CFBLR>>LTDC_LxCFBLR_CFBP_Pos;
+
+    return (void *) (base + line*pitch);
+}
+
+//////////////////////////// Frame buffer flipping /////////////////////////////////////////////////
+
+/**
+ * @brief   Buffers of a layer for double or triple buffering
+ *
+ * @note    front is scanned out, back is where drawing routines write and pending
+ *          was given to LCD_PresentFrame and becomes front at the next reload
+ *          (vertical blanking). back is -1 while no buffer is free
+ *
+ * @note    n = 0 means that the layer is not flipped. Drawing is done in CFBAR
+ */
+typedef struct {
+    void           *buffer[LCD_MAXFRAMEBUFFERS];
+    int             n;
+    int             front;
+    volatile int    back;
+    volatile int    pending;
+    volatile uint32_t frames;       /// number of buffer flips done
+    int             latest;         /// last buffer given to LCD_PresentFrame
+    int             needsync;       /// back buffer must get the damage from latest
+} FrameBuffers_t;
+
+static FrameBuffers_t framebuffers[3];
+
+/**
+ * @brief   Damaged (dirty) rectangles
+ *
+ * @note    Coordinates are x0 <= x < x1 and y0 <= y < y1
+ *
+ * @note    history[0] has the rectangles drawn in the frame being built and
+ *          history[1] and history[2] the ones of the two frames presented before.
+ *          A back buffer is brought up to date by copying the rectangles of the
+ *          frames it missed from the latest presented buffer
+ */
+typedef struct {
+    int16_t         x0,y0,x1,y1;
+} DamageRect_t;
+
+typedef struct {
+    DamageRect_t    rect[LCD_MAXDAMAGE];
+    int             count;
+} DamageList_t;
+
+static DamageList_t damage[3][LCD_MAXFRAMEBUFFERS];
+
+static LCD_DamageStats_t damagestats[3];
+
+/**
+ * @brief   area of a rectangle
+ */
+static inline int rectarea(const DamageRect_t *r) { return (r->x1-r->x0)*(r->y1-r->y0); }
+
+/**
+ * @brief   addrect
+ *
+ * @note    Adds rectangle to damage list. Rectangles that overlap or touch it are
+ *          merged into it. When the list is full, it is merged with the one whose
+ *          bounding box grows less
+ */
+static void
+addrect(DamageList_t *d, DamageRect_t r) {
+DamageRect_t *q;
+DamageRect_t u;
+int i,best,growth,bestgrowth;
+
+restart:
+    for(i=0;i<d->count;i++) {
+        q = &d->rect[i];
+        if( r.x0 <= q->x1 && q->x0 <= r.x1 && r.y0 <= q->y1 && q->y0 <= r.y1 ) {
+            if( q->x0 < r.x0 ) r.x0 = q->x0;
+            if( q->y0 < r.y0 ) r.y0 = q->y0;
+            if( q->x1 > r.x1 ) r.x1 = q->x1;
+            if( q->y1 > r.y1 ) r.y1 = q->y1;
+            d->rect[i] = d->rect[--d->count];
+            // The union can overlap rectangles already visited
+            goto restart;
+        }
+    }
+
+    if( d->count < LCD_MAXDAMAGE ) {
+        d->rect[d->count++] = r;
+        return;
+    }
+
+    best = 0;
+    bestgrowth = 0x7FFFFFFF;
+    for(i=0;i<d->count;i++) {
+        q = &d->rect[i];
+        u.x0 = q->x0 < r.x0 ? q->x0 : r.x0;
+        u.y0 = q->y0 < r.y0 ? q->y0 : r.y0;
+        u.x1 = q->x1 > r.x1 ? q->x1 : r.x1;
+        u.y1 = q->y1 > r.y1 ? q->y1 : r.y1;
+        growth = rectarea(&u)-rectarea(q);
+        if( growth < bestgrowth ) {
+            bestgrowth = growth;
+            best = i;
+        }
+    }
+    q = &d->rect[best];
+    r.x0 = q->x0 < r.x0 ? q->x0 : r.x0;
+    r.y0 = q->y0 < r.y0 ? q->y0 : r.y0;
+    r.x1 = q->x1 > r.x1 ? q->x1 : r.x1;
+    r.y1 = q->y1 > r.y1 ? q->y1 : r.y1;
+    d->rect[best] = d->rect[--d->count];
+    // The bigger one can now touch others
+    goto restart;
+}
+
+/**
+ * @brief   LCD_AddDamage
+ *
+ * @note    Records that the rectangle (x,y,w,h) of the back buffer of layer was
+ *          changed. Drawing routines call it. It must be called by code that
+ *          writes directly in the buffer returned by LCD_GetDrawBuffer
+ *
+ * @note    Nothing is done for layers without flipping
+ */
+void
+LCD_AddDamage(int layer, int x, int y, int w, int h) {
+DamageRect_t r;
+int lw,lh;
+
+    if( framebuffers[layer].n == 0 )
+        return;
+
+    lw = LCD_GetWidth(layer);
+    lh = LCD_GetHeight(layer);
+    if( x < 0 ) { w += x; x = 0; }
+    if( y < 0 ) { h += y; y = 0; }
+    if( x+w > lw ) w = lw-x;
+    if( y+h > lh ) h = lh-y;
+    if( w <= 0 || h <= 0 )
+        return;
+
+    r.x0 = x;
+    r.y0 = y;
+    r.x1 = x+w;
+    r.y1 = y+h;
+    addrect(&damage[layer][0],r);
+}
+
+/**
+ * @brief   copyrect
+ *
+ * @note    Copy a rectangle between two buffers of a layer with DMA2D or,
+ *          for formats DMA2D can not write, with the CPU
+ */
+static void
+copyrect(int layer, void *from, void *to, const DamageRect_t *r) {
+int format,pitch,ps,w,h,i;
+char *p,*q;
+
+    format = LCD_GetFormat(layer);
+    pitch  = LCD_GetPitch(layer);
+    w = r->x1-r->x0;
+    h = r->y1-r->y0;
+
+    if( format <= LCD_FORMAT_ARGB4444 ) {
+        DECLARE_REGION(src,from,r->x0,r->y0,w,h,format,pitch);
+        DECLARE_REGION(dst,to,r->x0,r->y0,w,h,format,pitch);
+        if( DMA2D_CopyRegion(&src,&dst) == 0 )
+            return;
+    }
+
+    LCD_WaitDrawing();
+    ps = pixelsize[format];
+    p = (char *) from + r->y0*pitch + r->x0*ps;
+    q = (char *) to   + r->y0*pitch + r->x0*ps;
+    for(i=0;i<h;i++) {
+        PixOps_Copy(q,p,w*ps);
+        p += pitch;
+        q += pitch;
+    }
+}
+
+/**
+ * @brief   syncbackbuffer
+ *
+ * @note    Copy the rectangles damaged in the frames the back buffer missed
+ *          from the latest presented buffer. It waits until the copy is done
+ *
+ * @note    With double buffering the back buffer missed one frame and with
+ *          triple buffering, two
+ */
+static void
+syncbackbuffer(int layer) {
+FrameBuffers_t *fb = &framebuffers[layer];
+LCD_DamageStats_t *st = &damagestats[layer];
+void *from,*to;
+int missed,k,i;
+uint32_t pixels = 0;
+unsigned rects = 0;
+
+    fb->needsync = 0;
+    from = fb->buffer[fb->latest];
+    to   = fb->buffer[fb->back];
+    missed = fb->n-1;
+    for(k=1;k<=missed;k++) {
+        for(i=0;i<damage[layer][k].count;i++) {
+            copyrect(layer,from,to,&damage[layer][k].rect[i]);
+            pixels += rectarea(&damage[layer][k].rect[i]);
+            rects++;
+        }
+    }
+    LCD_WaitDrawing();
+
+    st->lastpixels  = pixels;
+    st->lastrects   = rects;
+    st->totalpixels += pixels;
+    st->syncs++;
+}
+
+/**
+ * @brief   LCD_GetDamageStats
+ *
+ * @note    Returns the number of rectangles and pixels copied to bring the back
+ *          buffer up to date in the last frame and in total
+ */
+void
+LCD_GetDamageStats(int layer, LCD_DamageStats_t *stats) {
+
+    *stats = damagestats[layer];
+}
+
+
+/**
+ * @brief   Band rendering (racing the beam)
+ *
+ * @note    The active area is split in nbands bands. The line interrupt (LIPCR)
+ *          is set to the first line of a band. When the scan out reaches band k,
+ *          band k+1 is rendered, so it must be ready before the beam gets there.
+ *          The last band renders band 0 of the next frame
+ *
+ * @note    Lines are counted like CPSR.CYPOS: 0 at the start of VSYNC and the
+ *          first active line at VSH+VBP
+ */
+///@{
+static LCD_BandCallback     bandcallback = 0;
+static void                 *bandarg     = 0;
+static int                  bandcount    = 0;
+static volatile int         bandcurrent  = 0;
+static uint16_t             bandstart[LCD_MAXBANDS+1];
+static LCD_BandStats_t      bandstats[LCD_MAXBANDS];
+///@}
+
+/**
+ * @brief   bandline
+ *
+ * @note    Returns the scan line (CYPOS) of the first line of band b
+ */
+static inline int
+bandline(int b) {
+
+    return VSH+VBP+bandstart[b];
+}
+
+/**
+ * @brief   bandinterrupt
+ *
+ * @note    Called from the LTDC interrupt when the beam reaches the current band.
+ *          Arms the interrupt for the next band, renders it and measures how many
+ *          lines were left before the beam reached it
+ */
+static void
+bandinterrupt(void) {
+LCD_BandStats_t *st;
+int next,total,entry,done,budget,slack;
+
+    next  = bandcurrent+1;
+    if( next >= bandcount )
+        next = 0;
+    bandcurrent = next;
+    LTDC->LIPCR = bandline(next);
+
+    total = VSH+VBP+VAH+VFP;
+    entry = (LTDC->CPSR&LTDC_CPSR_CYPOS_Msk)>>LTDC_CPSR_CYPOS_Pos;
+    bandcallback(next,bandstart[next],bandstart[next+1],bandarg);
+    done  = (LTDC->CPSR&LTDC_CPSR_CYPOS_Msk)>>LTDC_CPSR_CYPOS_Pos;
+
+    // Distances are modulo the frame, since band 0 is in the next one
+    budget = (bandline(next)-entry+total)%total;
+    slack  = budget-(done-entry+total)%total;
+
+    st = &bandstats[next];
+    st->calls++;
+    st->lastslack = slack;
+    if( slack < st->minslack )
+        st->minslack = slack;
+    if( slack < 0 )
+        st->late++;
+}
+
+/**
+ * @brief   LCD_StartBands
+ *
+ * @note    Splits the active area in nbands bands of (almost) the same height and
+ *          calls cb(band,y0,y1,arg) to render lines y0 to y1-1 of the band just
+ *          ahead of the beam. It can be used with a single frame buffer
+ *
+ * @note    The callback runs in the LTDC interrupt (priority LCD_IRQLEVEL). It
+ *          must not wait for DMA2D jobs queued by the main program, since they are
+ *          started by the DMA2D interrupt, which has a lower priority
+ *
+ * @note    Returns -1 when nbands is invalid
+ */
+int
+LCD_StartBands(int nbands, LCD_BandCallback cb, void *arg) {
+int i;
+
+    if( nbands < 1 || nbands > LCD_MAXBANDS || cb == 0 )
+        return -1;
+
+    LCD_StopBands();
+
+    for(i=0;i<=nbands;i++)
+        bandstart[i] = (i*VAH)/nbands;
+    for(i=0;i<nbands;i++) {
+        bandstats[i].calls     = 0;
+        bandstats[i].late      = 0;
+        bandstats[i].lastslack = 0;
+        bandstats[i].minslack  = INT32_MAX;
+    }
+    bandcallback = cb;
+    bandarg      = arg;
+    bandcount    = nbands;
+    bandcurrent  = 0;
+
+    /* First interrupt when the beam reaches band 0 */
+    LTDC->LIPCR = bandline(0);
+    LTDC->ICR   = LTDC_ICR_CLIF;
+    LTDC->IER  |= LTDC_IER_LIE;
+    NVIC_SetPriority(LTDC_IRQn,LCD_IRQLEVEL);
+    NVIC_EnableIRQ(LTDC_IRQn);
+
+    return 0;
+}
+
+/**
+ * @brief   LCD_StopBands
+ *
+ * @note    Disables the line interrupt. The callback is not called anymore
+ */
+void
+LCD_StopBands(void) {
+
+    LTDC->IER &= ~LTDC_IER_LIE;
+    LTDC->ICR  = LTDC_ICR_CLIF;
+    bandcount  = 0;
+}
+
+/**
+ * @brief   LCD_GetBandStats
+ *
+ * @note    Returns the slack (in lines) measured for band since LCD_StartBands.
+ *          A negative slack means the band was rendered while it was being
+ *          scanned out (tearing)
+ */
+void
+LCD_GetBandStats(int band, LCD_BandStats_t *stats) {
+
+    *stats = bandstats[band];
+}
+
+
+/**
+ * @brief   LCD_TFT_EV_IRQHandler
+ *
+ * @note    The LTDC reloaded the shadow registers (vertical blanking). The pending
+ *          buffer is now the front one and the old front one is free
+ *
+ * @note    The line interrupt is used for band rendering
+ */
+void LCD_TFT_EV_IRQHandler(void) {
+FrameBuffers_t *fb;
+int oldfront;
+int i;
+
+    if( LTDC->ISR&LTDC_ISR_LIF ) {
+        LTDC->ICR = LTDC_ICR_CLIF;
+        if( bandcount > 0 )
+            bandinterrupt();
+    }
+
+    if( (LTDC->ISR&LTDC_ISR_RRIF) == 0 )
+        return;
+    LTDC->ICR = LTDC_ICR_CRRIF;
+
+    for(i=0;i<3;i++) {
+        fb = &framebuffers[i];
+        if( fb->n == 0 || fb->pending < 0 )
+            continue;
+        oldfront  = fb->front;
+        fb->front = fb->pending;
+        fb->pending = -1;
+        fb->frames++;
+        if( fb->back < 0 )
+            fb->back = oldfront;
+    }
+}
+
+/**
+ * @brief   LCD_SetupFrameBuffers
+ *
+ * @note    Allocates n (2 or 3) full size frame buffers for layer from the buddy
+ *          allocator (SDRAM) and shows the first one
+ *
+ * @note    After it, drawing routines write in the back buffer and
+ *          LCD_PresentFrame shows it
+ *
+ * @note    Returns 0 when OK or -1 when there is no memory
+ */
+int
+LCD_SetupFrameBuffers(int layer, int n, int format) {
+FrameBuffers_t *fb = &framebuffers[layer];
+int size;
+int i;
+
+    if( n < 2 || n > LCD_MAXFRAMEBUFFERS )
+        return -1;
+
+    size = LCD_GetMinimalFullFrameBufferSize(format);
+    for(i=0;i<n;i++) {
+        fb->buffer[i] = Buddy_Alloc(size);
+        if( fb->buffer[i] == 0 ) {
+            while( --i >= 0 )
+                Buddy_Free(fb->buffer[i]);
+            return -1;
+        }
+    }
+
+    fb->front   = 0;
+    fb->back    = 1;
+    fb->pending = -1;
+    fb->frames  = 0;
+    fb->latest  = 0;
+    fb->needsync= 0;
+    for(i=0;i<LCD_MAXFRAMEBUFFERS;i++)
+        damage[layer][i].count = 0;
+    LCD_SetFullSizeFrameBuffer(layer,fb->buffer[0],format);
+    fb->n       = n;
+
+    /* Interrupt at each reload of shadow registers */
+    LTDC->ICR  = LTDC_ICR_CRRIF;
+    LTDC->IER |= LTDC_IER_RRIE;
+    NVIC_SetPriority(LTDC_IRQn,LCD_IRQLEVEL);
+    NVIC_EnableIRQ(LTDC_IRQn);
+
+    return 0;
+}
+
+/**
+ * @brief   LCD_GetDrawBuffer
+ *
+ * @note    Returns the address of the buffer where drawing is done. For a layer
+ *          without flipping, it is the one scanned out (CFBAR)
+ *
+ * @note    With double buffering, it waits until the flip requested by
+ *          LCD_PresentFrame is done, since the only free buffer is still shown
+ */
+void *
+LCD_GetDrawBuffer(int layer) {
+FrameBuffers_t *fb = &framebuffers[layer];
+
+    if( fb->n == 0 )
+        return (void *) LTDC_Layer[layer]->CFBAR;
+
+    while( fb->back < 0 ) {
+        __WFI();
+    }
+    if( fb->needsync )
+        syncbackbuffer(layer);
+    return fb->buffer[fb->back];
+}
+
+/**
+ * @brief   LCD_IsNextBufferAvailable
+ *
+ * @note    Returns 1 when a buffer is free for drawing. It does not wait
+ */
+int
+LCD_IsNextBufferAvailable(int layer) {
+FrameBuffers_t *fb = &framebuffers[layer];
+
+    return (fb->n == 0) || (fb->back >= 0);
+}
+
+/**
+ * @brief   LCD_PresentFrame
+ *
+ * @note    Shows the back buffer at the next vertical blanking and chooses another
+ *          buffer for drawing. It returns at once, unless a previous flip is
+ *          still pending
+ *
+ * @note    With three buffers, drawing can continue at once in the third one.
+ *          With two, the next drawing waits for the vertical blanking
+ *
+ * @note    Returns -1 if the layer has no buffers set by LCD_SetupFrameBuffers
+ */
+int
+LCD_PresentFrame(int layer) {
+FrameBuffers_t *fb = &framebuffers[layer];
+int next;
+int i;
+
+    if( fb->n == 0 )
+        return -1;
+
+    /* Only one flip can be waiting for a reload */
+    while( fb->pending >= 0 ) {
+        __WFI();
+    }
+    /* Back buffer must be complete */
+    LCD_WaitDrawing();
+    if( fb->back < 0 )
+        return 0;
+
+    next = -1;
+    for(i=0;i<fb->n;i++) {
+        if( i != fb->front && i != fb->back ) {
+            next = i;
+            break;
+        }
+    }
+
+    /* Damage history: the frame just built becomes history[1] */
+    for(i=fb->n-1;i>0;i--)
+        damage[layer][i] = damage[layer][i-1];
+    damage[layer][0].count = 0;
+    fb->latest   = fb->back;
+    fb->needsync = 1;
+
+    __disable_irq();
+    fb->pending = fb->back;
+    fb->back    = (fb->n > 2) ? next : -1;
+    LTDC_Layer[layer]->CFBAR = (uint32_t) fb->buffer[fb->pending];
+    LTDC->SRCR = LTDC_SRCR_VBR;
+    __enable_irq();
+
+    return 0;
+}
+
+/**
+ * @brief   LCD_GetFrameCount
+ *
+ * @note    Returns the number of flips done in layer
+ */
+uint32_t
+LCD_GetFrameCount(int layer) {
+
+    return framebuffers[layer].frames;
+}
+
+/**
+ * @brief   fill1
+ *
+ * @note    fill a memory area with a 1 byte value
+ *
+ * @note    n = size in bytes!!!
+ *
+ */
+ITCM_CODE static void fill1( void *area, int n, unsigned c) {
+uint8_t uc;
+uint8_t *p;
+uint32_t uv;
+uint32_t *q;
+
+    p = (uint8_t *) area;
+    uc = c&0xFF;
+    // align to a word address (last two bits are zero)
+    while( (n>0) && ((((uintptr_t)p)&0x3)!=0) ) {
+        *p++ = uc;
+        n--;
+    }
+    // after that, can fill 4 bytes at one
+    uv = (uc<<24)|(uc<<16)|(uc<<8)|uc;
+    q = (uint32_t *) p;
+    PixOps_FillWords(q,uv,n>>2);
+    q += n>>2;
+    n &= 3;
+    p = (uint8_t *) q;
+    while( n>0 ) {
+        *p++ = uc;
+        n--;
+    }
+
+}
+
+/**
+ * @brief   fill2
+ *
+ * @note    Fill a memory area with a 16-bit value
+ *
+ * @note    n = size in bytes!!!
+ *
+ */
+ITCM_CODE static void fill2( void *area, int n, unsigned c) {
+uint8_t *p;
+uint16_t uc;
+uint32_t uv;
+uint32_t *q;
+
+    p = (uint8_t *) area;
+    uc = c&0xFFFF;
+    // align to a even address
+    while( ((uintptr_t) p)&3 ) {
+        *p++ = uc;
+        n--;
+        uc = (uc>>8)|(uc<<8);
+    }
+    // after that, can fill 4 bytes at one
+    uv = (uc<<16)|uc;
+    q = (uint32_t *) p;
+    PixOps_FillWords(q,uv,n>>2);
+    q += n>>2;
+    n &= 3;
+    // fill the remaining bytes
+    p = (uint8_t *) q;
+    while( n > 0 ) {
+        *p++ = uc;
+        n--;
+        uc = (uc>>8)|(uc<<8);
+    }
+}
+
+
+/**
+ * @brief   fill3
+ *
+ * @note    Fill the frame buffer with a 3-byte value
+ *
+ * @note    n = size in bytes!!!
+ *
+ * @note    Memory organization
+ *            word  | Pixel
+ *         ---------|-----------------
+ *            +0    | B1 R0 G0 B0
+ *            +1    | G2 B2 R1 G1
+ *            +2    | R3 G3 B3 R2
+ */
+ITCM_CODE static void fill3( void *area, int n, unsigned c) {
+uint32_t w1,w2,w3;
+uint8_t *p;
+uint32_t uc;
+uint32_t *q;
+
+    p = (uint8_t *) area;
+    uc = c&0xFFFFFF;
+    // align to a even address
+    while( ((uintptr_t) p)&3 ) {
+        *p++ = uc;
+        n--;
+        uc = ((uc>>8)|(uc<<16))&0xFFFFFF;
+    }
+    // after that, can fill 4 bytes at one
+    q = (uint32_t *) p;
+    // uc = 0ABC
+    w1 = (uc<<8)|(uc>>16);      // ABCA
+    w2 = (uc<<16)|(uc>>8);      // BCAB
+    w3 = (uc<<24)|uc;           // CABC
+    PixOps_Fill3Words(q,w3,w2,w1,n/12);
+    q += 3*(n/12);
+    n %= 12;
+    // fill the remaining bytes
+    p = (uint8_t *) q;
+    while( n > 0 ) {
+        *p++ = uc;
+        n--;
+        uc = ((uc>>8)|(uc<<16))&0xFFFFFF;
+    }
+}
+
+/*
+ * @brief   fill4
+ *
+ * @note    Fill the frame buffer with a 4-byte value
+ *
+ * @note    n = size in bytes!!!
+ *
+ */
+
+ITCM_CODE static void fill4( void *area, int n, unsigned c) {
+uint8_t *p;
+uint32_t uc;
+uint32_t *q;
+
+    p = (uint8_t *) area;
+    uc = c;
+    // align to a even address
+    while( ((uintptr_t) p)&3 ) {
+        *p++ = uc;
+        n--;
+        uc = (uc>>8)|(uc<<24);
+    }
+    // after that, can fill 4 bytes at one
+    q = (uint32_t *) p;
+    PixOps_FillWords(q,uc,n>>2);
+    q += n>>2;
+    n &= 3;
+    // fill the remaining bytes
+    p = (uint8_t *) q;
+    while( n > 0 ) {
+        *p++ = uc;
+        n--;
+        uc = (uc>>8)|(uc<<24);
+    }
+
+}
+
+
+/**
+ * @brief   LCD_SetAcceleration
+ *
+ * @note    Enables (on=1) or disables (on=0) the use of DMA2D for fills in layer
+ */
+void
+LCD_SetAcceleration(int layer, int on) {
+
+    LCD_WaitDrawing();
+    accelerated[layer] = on;
+}
+
+/**
+ * @brief   LCD_WaitDrawing
+ *
+ * @note    Waits until the DMA2D finishes the fills started and the jobs queued
+ *          (text). CPU drawing routines call it before writing into the frame buffer
+ */
+void
+LCD_WaitDrawing(void) {
+
+    while( !DMA2D_IsIdle() ) {}
+}
+
+/**
+ * @brief   accelfill
+ *
+ * @note    Fills a rectangle of layer using DMA2D
+ *
+ * @note    It does not wait for the end of the operation
+ *
+ * @note    Returns -1 when the rectangle must be filled by the CPU (acceleration
+ *          disabled, small rectangle or format not supported by DMA2D)
+ */
+static int
+accelfill(int layer, int x, int y, int w, int h, unsigned color) {
+int format;
+
+    if( !accelerated[layer] )
+        return -1;
+    if( w <= 0 || h <= 0 || w*h < LCD_ACCEL_MINPIXELS )
+        return -1;
+    format = LCD_GetFormat(layer);
+    if( format > LCD_FORMAT_ARGB4444 )
+        return -1;
+
+    DECLARE_REGION(r,LCD_GetDrawBuffer(layer),x,y,w,h,format,LCD_GetPitch(layer));
+
+    if( DMA2D_FillRegion(&r,color) < 0 )
+        return -1;
+
+    return 0;
+}
+
+
+/*
+ * @brief   LCD_FillFrameBuffer
+ *
+ * @note    Fill the frame buffer with a color using an efficient algorithm
+ */
+void
+LCD_FillFrameBuffer(int layer, unsigned color ) {
+LTDC_Layer_TypeDef *p = LTDC_Layer[layer];
+int  ps;
+char *area,*lineaddr;
+int  w,h,pitch;
+int i;
+
+    PROFILE_BEGIN(LCD_FillFrameBuffer);
+
+    ps     = LCD_GetPixelSize(layer);
+    area   = (char *) LCD_GetDrawBuffer(layer);
+    w      = LCD_GetWidth(layer);
+    h      = LCD_GetHeight(layer);
+    pitch  = LCD_GetPitch(layer);
+
+    LCD_AddDamage(layer,0,0,w,h);
+
+    if( accelfill(layer,0,0,w,h,color) == 0 ) {
+        PROFILE_END(LCD_FillFrameBuffer);
+        return;
+    }
+
+    LCD_WaitDrawing();
+
+    switch(ps) {
+    case 1:
+        w = LCD_GetPitch(layer);
+        fill1(area,w*h,color);
+        break;
+    case 2:
+        for(i=0;i<h;i++) {
+            lineaddr = (char *) LCD_GetLineAddress(layer,i);
+            fill2(lineaddr,pitch,color);
+        }
+        break;
+    case 3:
+        for(i=0;i<h;i++) {
+            lineaddr = (char *) LCD_GetLineAddress(layer,i);
+            fill3(lineaddr,pitch,color);
+        }
+        break;
+    case 4:
+        for(i=0;i<h;i++) {
+            lineaddr = (char *) LCD_GetLineAddress(layer,i);
+            fill4(lineaddr,pitch,color);
+        }
+        break;
+    default:
+        break;
+    }
+
+    PROFILE_END(LCD_FillFrameBuffer);
+}
+
+
+//////////////////////////// Drawing routines /////////////////////////////////////////////////////
+
+
+
+
+/*
+ * @brief   LCD_DrawHorizontalLine
+ *
+ * @note    Draw an horizontal line from point (x,y) with size 'size'
+ */
+void
+LCD_DrawHorizontalLine(int layer, int x, int y, int size, unsigned color) {
+int  ps,w,i;
+char *lineaddr;
+char *q;
+uint8_t c1,c2,c3,c4;
+
+    ps     = LCD_GetPixelSize(layer);
+    w      = LCD_GetWidth(layer);
+
+    if( (x+size) > w )
+        size = w-x;
+
+    LCD_AddDamage(layer,x,y,size,1);
+
+    if( accelfill(layer,x,y,size,1,color) == 0 )
+        return;
+
+    LCD_WaitDrawing();
+
+    lineaddr = (char *) LCD_GetLineAddress(layer,y);
+    switch(ps) {
+    case 1:
+        q = lineaddr + x;
+        c1 = color&0xFF;
+        for(i=0;i<size;i++) {
+            *q++ = c1;
+        }
+        break;
+    case 2:
+        q = lineaddr + x*2;
+        c1 = color&0xFF;
+        c2 = (color>>8)&0xFF;
+        for(i=0;i<size;i++) {
+            *q++ = c1;
+            *q++ = c2;
+        }
+        break;
+    case 3:
+        q = lineaddr + x*3;
+        c1 = color&0xFF;
+        c2 = (color>>8)&0xFF;
+        c3 = (color>>16)&0xFF;
+        for(i=0;i<size;i++) {
+            *q++ = c1;
+            *q++ = c2;
+            *q++ = c3;
+        }
+        break;
+    case 4:
+        q = lineaddr + x*4;
+        c1 = color&0xFF;
+        c2 = (color>>8)&0xFF;
+        c3 = (color>>16)&0xFF;
+        c4 = (color>>24)&0xFF;
+        for(i=0;i<size;i++) {
+            *q++ = c1;
+            *q++ = c2;
+            *q++ = c3;
+            *q++ = c4;
+        }
+        break;
+    }
+}
+
+
+/*
+ * @brief   LCD_DrawVerticalLine
+ *
+ * @note    Draw an vertical line from point (x,y) with size 'size'
+ */
+void
+LCD_DrawVerticalLine(int layer, int x, int y, int size, unsigned color) {
+int  ps,w,h,i;
+char *lineaddr;
+char *q;
+uint8_t c1,c2,c3,c4;
+
+    ps     = LCD_GetPixelSize(layer);
+    w      = LCD_GetWidth(layer);
+    h      = LCD_GetHeight(layer);
+
+    if( (y+size) > h )
+        size = h-y;
+
+    LCD_AddDamage(layer,x,y,1,size);
+
+    if( accelfill(layer,x,y,1,size,color) == 0 )
+        return;
+
+    LCD_WaitDrawing();
+
+    switch(ps) {
+    case 1:
+        c1 = color&0xFF;
+        for(i=0;i<size;i++) {
+            lineaddr = (char *) LCD_GetLineAddress(layer,y);
+            q = lineaddr + x;
+            *q = c1;
+            y++;
+        }
+        break;
+    case 2:
+        q = lineaddr + x*2;
+        c1 = color&0xFF;
+        c2 = (color>>8)&0xFF;
+        for(i=0;i<size;i++) {
+            lineaddr = (char *) LCD_GetLineAddress(layer,y);
+            q = lineaddr + 2*x;
+            *q++ = c1;
+            *q++ = c2;
+            y++;
+        }
+        break;
+    case 3:
+        q = lineaddr + x*3;
+        c1 = color&0xFF;
+        c2 = (color>>8)&0xFF;
+        c3 = (color>>16)&0xFF;
+        for(i=0;i<size;i++) {
+            lineaddr = (char *) LCD_GetLineAddress(layer,y);
+            q = lineaddr + 3*x;
+            *q++ = c1;
+            *q++ = c2;
+            *q++ = c3;
+            y++;
+        }
+        break;
+    case 4:
+        c1 = color&0xFF;
+        c2 = (color>>8)&0xFF;
+        c3 = (color>>16)&0xFF;
+        c4 = (color>>24)&0xFF;
+        for(i=0;i<size;i++) {
+            lineaddr = (char *) LCD_GetLineAddress(layer,y);
+            q = lineaddr + 4*x;
+            *q++ = c1;
+            *q++ = c2;
+            *q++ = c3;
+            *q++ = c4;
+            y++;
+        }
+        break;
+    }
+}
+
+/*
+ * @brief   LCD_DrawBox
+ *
+ * @note    Draw an horizontal line from point (x,y) with size 'size'
+ */
+void
+LCD_DrawBox(int layer, int x, int y, int sizew, int sizeh, unsigned color, unsigned bordercolor) {
+int  ps,w,h,i;
+char *lineaddr;
+char *q;
+uint8_t c1,c2,c3,c4;
+
+    ps     = LCD_GetPixelSize(layer);
+    w      = LCD_GetWidth(layer);
+    h      = LCD_GetHeight(layer);
+
+    if( (x+sizew) > w )
+        sizew = w-x;
+    if( (y+sizeh) > h )
+        sizeh = h-y;
+
+    if( sizew <= 2 || sizeh <= 2 )
+        return;
+
+    LCD_DrawHorizontalLine(layer,x,y,sizew,bordercolor);
+    LCD_DrawHorizontalLine(layer,x,y+sizeh,sizew,bordercolor);
+    LCD_DrawVerticalLine(layer,x,y,sizeh,bordercolor);
+    LCD_DrawVerticalLine(layer,x+sizew,y,sizeh,bordercolor);
+    sizew -= 1;
+    sizeh -= 1;
+    x++;
+    y++;
+
+    LCD_AddDamage(layer,x,y,sizew,sizeh);
+
+    if( accelfill(layer,x,y,sizew,sizeh,color) == 0 )
+        return;
+
+    LCD_WaitDrawing();
+
+    for(i=0;i<sizeh;i++) {
+        q = LCD_GetLineAddress(layer,y+i);
+        q += ps*x;
+        switch(ps) {
+        case 1:
+            fill1(q,sizew*ps,color);
+            break;
+        case 2:
+            fill2(q,sizew*ps,color);
+            break;
+        case 3:
+            fill3(q,sizew*ps,color);
+            break;
+        case 4:
+            fill4(q,sizew*ps,color);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief   LCD_BlitIndexed
+ *
+ * @note    Draws a w x h image with 8 bit indexes (L8) at (x,y). srcpitch is the
+ *          distance in bytes between lines of the image
+ *
+ * @note    For L8 layers the indexes are copied and the palette of the layer
+ *          is used (clut can be 0). For other layers, DMA2D expands the indexes
+ *          using clut (ARGB8888, n entries), that is loaded in the DMA2D
+ *          foreground CLUT when not 0. Use opaque colors (alpha=0xFF) for
+ *          ARGB layers.
+ *
+ * @note    The image is not clipped. Returns 0 when OK, -1 on error
+ */
+int
+LCD_BlitIndexed(int layer, int x, int y, int w, int h, const uint8_t *src, int srcpitch,
+                const uint32_t *clut, int n) {
+int format,pitch,i;
+char *base,*q;
+
+    if( x < 0 || y < 0 || w <= 0 || h <= 0
+     || x+w > LCD_GetWidth(layer) || y+h > LCD_GetHeight(layer) )
+        return -1;
+
+    format = LCD_GetFormat(layer);
+    pitch  = LCD_GetPitch(layer);
+    base   = (char *) LCD_GetLineAddress(layer,0);
+    LCD_AddDamage(layer,x,y,w,h);
+
+    if( format == LCD_FORMAT_L8 ) {
+        LCD_WaitDrawing();
+        q = base+y*pitch+x;
+        for(i=0;i<h;i++) {
+            PixOps_Copy(q,src,w);
+            q   += pitch;
+            src += srcpitch;
+        }
+        return 0;
+    }
+    if( format > LCD_FORMAT_ARGB4444 )
+        return -1;
+
+    if( clut && DMA2D_LoadCLUT(DMA2D_FOREGROUND,clut,n) < 0 )
+        return -1;
+
+    DECLARE_REGION(s,src,0,0,w,h,DMA2D_L8,srcpitch);
+    DECLARE_REGION(d,base,x,y,w,h,format,pitch);
+    return DMA2D_CopyRegion(&s,&d);
+}
+
+/**
+ * @brief   Pixel stores used by the line rasterizers
+ *
+ * @note    Pixels are stored in the same (little endian) order as the fills
+ */
+///@{
+#define STORE8(P,C)     (*(uint8_t *)  (P) = (C))
+#define STORE16(P,C)    (*(uint16_t *) (P) = (C))
+#define STORE24(P,C)    ((P)[0] = (C), (P)[1] = (C)>>8, (P)[2] = (C)>>16)
+#define STORE32(P,C)    (*(uint32_t *) (P) = (C))
+///@}
+
+#define ABS(X)  ((X)>0?(X):-(X))
+
+/**
+ * @brief   Line rasterizer specialized for a pixel size
+ *
+ * @note    Bresenham algorithm valid for all octants. The end points must be
+ *          inside the layer. The address is advanced by pixel size and pitch,
+ *          so there are no multiplications inside the loop
+ */
+#define DEFINE_LINE(NAME,PS,STORE)                                          \
+ITCM_CODE static void                                                       \
+NAME(char *base, int pitch, int x0, int y0, int x1, int y1, unsigned c) {   \
+int dx,dy,sx,sy,err,e2,n;                                                   \
+char *p;                                                                    \
+                                                                            \
+    dx  = ABS(x1-x0);                                                       \
+    dy  = -ABS(y1-y0);                                                      \
+    sx  = (x0<x1)?(PS):-(PS);                                               \
+    sy  = (y0<y1)?pitch:-pitch;                                             \
+    err = dx+dy;                                                            \
+    n   = (dx>-dy)?dx:-dy;                                                  \
+    p   = base+y0*pitch+x0*(PS);                                            \
+    for(;;) {                                                               \
+        STORE(p,c);                                                         \
+        if( n-- == 0 )                                                      \
+            break;                                                          \
+        e2 = 2*err;                                                         \
+        if( e2 >= dy ) {                                                    \
+            err += dy;                                                      \
+            p   += sx;                                                      \
+        }                                                                   \
+        if( e2 <= dx ) {                                                    \
+            err += dx;                                                      \
+            p   += sy;                                                      \
+        }                                                                   \
+    }                                                                       \
+}
+
+DEFINE_LINE(line8, 1,STORE8)
+DEFINE_LINE(line16,2,STORE16)
+DEFINE_LINE(line24,3,STORE24)
+DEFINE_LINE(line32,4,STORE32)
+
+/**
+ * @brief   Rasterizers indexed by pixel size
+ */
+static void (* const linefunctions[5])(char *, int, int, int, int, int, unsigned) = {
+    0, line8, line16, line24, line32
+};
+
+/**
+ * @brief   Cohen-Sutherland outcodes
+ */
+///@{
+#define CLIP_LEFT       1
+#define CLIP_RIGHT      2
+#define CLIP_TOP        4
+#define CLIP_BOTTOM     8
+///@}
+
+static inline int outcode(int x, int y, int w, int h) {
+int code = 0;
+
+    if( x < 0 )         code |= CLIP_LEFT;
+    else if( x >= w )   code |= CLIP_RIGHT;
+    if( y < 0 )         code |= CLIP_TOP;
+    else if( y >= h )   code |= CLIP_BOTTOM;
+    return code;
+}
+
+/**
+ * @brief   clipline
+ *
+ * @note    Clips the segment (x0,y0)-(x1,y1) to the rectangle (0,0)-(w-1,h-1) with
+ *          the Cohen-Sutherland algorithm
+ *
+ * @note    Returns 0 when the segment is completely outside. Segments inside
+ *          or completely on one side cost only the outcode calculations
+ */
+static int
+clipline(int *x0, int *y0, int *x1, int *y1, int w, int h) {
+int c0,c1,c;
+int x,y;
+
+    c0 = outcode(*x0,*y0,w,h);
+    c1 = outcode(*x1,*y1,w,h);
+    for(;;) {
+        if( (c0|c1) == 0 )
+            return 1;
+        if( c0&c1 )
+            return 0;
+        c = c0?c0:c1;
+        // Intersection with the border. 64 bit products avoid overflows
+        if( c&CLIP_BOTTOM ) {
+            y = h-1;
+            x = *x0+(int)((int64_t)(*x1-*x0)*(y-*y0)/(*y1-*y0));
+        } else if( c&CLIP_TOP ) {
+            y = 0;
+            x = *x0+(int)((int64_t)(*x1-*x0)*(y-*y0)/(*y1-*y0));
+        } else if( c&CLIP_RIGHT ) {
+            x = w-1;
+            y = *y0+(int)((int64_t)(*y1-*y0)*(x-*x0)/(*x1-*x0));
+        } else {
+            x = 0;
+            y = *y0+(int)((int64_t)(*y1-*y0)*(x-*x0)/(*x1-*x0));
+        }
+        if( c == c0 ) {
+            *x0 = x;
+            *y0 = y;
+            c0 = outcode(x,y,w,h);
+        } else {
+            *x1 = x;
+            *y1 = y;
+            c1 = outcode(x,y,w,h);
+        }
+    }
+}
+
+/**
+ * @brief   Layer parameters used by all segments of a call
+ */
+typedef struct {
+    int         layer;
+    char        *base;
+    int         pitch;
+    int         w;
+    int         h;
+    void        (*line)(char *, int, int, int, int, int, unsigned);
+} LineContext_t;
+
+/**
+ * @brief   linesetup
+ *
+ * @note    Queries the layer once and waits for DMA2D drawings in progress
+ */
+static void
+linesetup(int layer, LineContext_t *lc) {
+
+    lc->layer = layer;
+    lc->w     = LCD_GetWidth(layer);
+    lc->h     = LCD_GetHeight(layer);
+    lc->pitch = LCD_GetPitch(layer);
+    lc->base  = (char *) LCD_GetLineAddress(layer,0);
+    lc->line  = linefunctions[LCD_GetPixelSize(layer)];
+
+    LCD_WaitDrawing();
+}
+
+/**
+ * @brief   drawsegment
+ *
+ * @note    Clips, marks the damaged area and draws a segment
+ */
+static void
+drawsegment(const LineContext_t *lc, int x0, int y0, int x1, int y1, unsigned color) {
+
+    if( !clipline(&x0,&y0,&x1,&y1,lc->w,lc->h) )
+        return;
+
+    LCD_AddDamage(lc->layer,x0<x1?x0:x1,y0<y1?y0:y1,ABS(x1-x0)+1,ABS(y1-y0)+1);
+    lc->line(lc->base,lc->pitch,x0,y0,x1,y1,color);
+}
+
+/**
+ * @brief   LCD_DrawLine
+ *
+ * @note    Draw a line from point (x,y) to point (x+dx,y+dy)
+ *
+ * @note    The line is clipped to the layer, so any part of it can be outside
+ */
+void
+LCD_DrawLine(int layer, int x, int y, int dx, int dy, unsigned color) {
+LineContext_t lc;
+
+    linesetup(layer,&lc);
+    drawsegment(&lc,x,y,x+dx,y+dy,color);
+}
+
+/**
+ * @brief   LCD_DrawPolyline
+ *
+ * @note    Draw lines connecting n points (n-1 segments)
+ *
+ * @note    The layer is queried once for all segments
+ */
+void
+LCD_DrawPolyline(int layer, const LCD_Point_t *points, int n, unsigned color) {
+LineContext_t lc;
+int i;
+
+    if( n < 2 )
+        return;
+    linesetup(layer,&lc);
+    for(i=1;i<n;i++) {
+        drawsegment(&lc,points[i-1].x,points[i-1].y,points[i].x,points[i].y,color);
+    }
+}
+
+/**
+ * @brief   LCD_DrawLines
+ *
+ * @note    Draw n independent lines. Line i goes from points[2*i] to points[2*i+1]
+ */
+void
+LCD_DrawLines(int layer, const LCD_Point_t *points, int n, unsigned color) {
+LineContext_t lc;
+int i;
+
+    linesetup(layer,&lc);
+    for(i=0;i<n;i++) {
+        drawsegment(&lc,points[2*i].x,points[2*i].y,points[2*i+1].x,points[2*i+1].y,color);
+    }
+}
@@ -0,0 +1,204 @@
+#ifndef LCD_H
+#define LCD_H
+/**
+ * @file    lcd.h
+ *
+ * @date    07/10/2020
+ * @author  Hans
+ */
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+
+/**
+ * @brief   Create a RGB color in an unsigned int
+ *
+ * @note    The order is reversed!!!
+ *
+ * @note    The 8 low order bits are 0
+ */
+#define RGB(R,G,B)     ( (((uint32_t) (R))<<16)         \
+                        |(((uint32_t) (G))<<8)          \
+                        |(((uint32_t) (B))<<0) )
+#define RGB565(R,G,B)  ( (((uint16_t)((R)&0x1F))<<8)    \
+                        |(((uint16_t)((G)&0x3F))<<3)    \
+                        |(((uint16_t)((B)&0x1F))>>3) )
+#define RGB555(R,G,B)  ( (((uint16_t)((R)&0x1F))<<7)    \
+                        |(((uint16_t)((G)&0x1F))<<3)    \
+                        |(((uint16_t)((B)&0x1F))>>3) )
+#define RGBA(R,G,B)    ( (((uint32_t) (A))<<24)         \
+                        |(((uint32_t) (R))<<16)         \
+                        |(((uint32_t) (G))<<8)          \
+                        |(((uint32_t) (B))<<0) )
+
+/*
+ * @brief   LCD Set Pixel Format
+ */
+#define LCD_FORMAT_ARGB8888         (0)
+#define LCD_FORMAT_RGB888           (1)
+#define LCD_FORMAT_RGB565           (2)
+#define LCD_FORMAT_ARGB1555         (3)
+#define LCD_FORMAT_ARGB4444         (4)
+#define LCD_FORMAT_L8               (5)
+#define LCD_FORMAT_AL44             (6)
+#define LCD_FORMAT_AL88             (7)
+
+/**
+ * @brief   Active area
+ */
+///@{
+#define LCD_DW          480
+#define LCD_DH          272
+///@}
+
+typedef struct {
+    uint8_t     B;
+    uint8_t     G;
+    uint8_t     R;
+} RGB_t;
+
+
+void  LCD_Init(void);
+
+void  LCD_TurnBacklightOn(void);
+void  LCD_TurnBacklightOff(void);
+void  LCD_PutDisplayOperation(void);
+void  LCD_PutDisplayStandBy(void);
+void  LCD_EnableController(void);
+void  LCD_DisableController(void);
+
+void  LCD_SetBackgroundColor( uint32_t bg );
+void  LCD_SetColorKey(int layer,  uint32_t c );
+void  LCD_EnableColorKey(int layer, uint32_t c);
+void  LCD_DisableColorKey(int layer);
+
+/**
+ * @brief   Indexed color formats (L8, AL44 and AL88)
+ *
+ * @note    The color of L8 is the index. AL44 and AL88 colors have an alpha
+ *          value too
+ */
+///@{
+#define LCD_CLUTSIZE        256
+#define LCD_AL44(A,I)       ( ((((uint32_t) (A))&0xF)<<4)|(((uint32_t) (I))&0xF) )
+#define LCD_AL88(A,I)       ( ((((uint32_t) (A))&0xFF)<<8)|(((uint32_t) (I))&0xFF) )
+///@}
+
+int   LCD_LoadCLUT(int layer, const uint32_t *colors, int n);
+void  LCD_EnableCLUT(int layer);
+void  LCD_DisableCLUT(int layer);
+int   LCD_GetColorIndex(int layer, uint32_t color);
+int   LCD_BlitIndexed(int layer, int x, int y, int w, int h, const uint8_t *src,
+                      int srcpitch, const uint32_t *clut, int n);
+
+/**
+ * @brief Layer management
+ *
+ *
+ * @note  There are two types of framebuffers:
+ *
+ *        * Full size:    Only the format must be specified
+ *        * Partial size: Format, position and size must be specified
+ */
+void  LCD_SetFullSizeFrameBuffer(int layer, void *area, int format);
+void  LCD_SetFrameBuffer(int layer, void *a, int f, int w, int h, int p, int hp, int vp );
+void  LCD_SetDefaultColor(int layer, uint32_t c );
+void  LCD_SetDefaultColor(int layer, uint32_t c );
+void  LCD_FillFrameBuffer(int layer, unsigned c );
+void  LCD_EnableLayer(int layer);
+void  LCD_DisableLayer(int layer);
+void  LCD_SwapLayers(void);
+void  LCD_ReloadLayerImmediately(int layer);
+void  LCD_ReloadLayerByVerticalBlanking(int layer);
+void  LCD_SetLayerPosition(int layer, int hp, int vp);
+void  LCD_SetLayerOpacity(int layer, int opacity);
+
+void *LCD_GetLineAddress(int layer, int line);
+int   LCD_GetHeight(int layer);
+int   LCD_GetWidth(int layer);
+int   LCD_GetPitch(int layer);
+void *LCD_GetFrameBufferAddress(int layer);
+void  LCD_SetFormat(int layer, int format);
+int   LCD_GetFormat(int layer);
+int   LCD_GetPixelSize(int layer);
+
+int   LCD_GetMinimalFullFrameBufferSize(int format);
+
+void LCD_DrawHorizontalLine(int layer, int x, int y, int size, unsigned color);
+void LCD_DrawVerticalLine(int layer, int x, int y, int size, unsigned color);
+void LCD_DrawBox(int layer, int x, int y, int sw, int sh, unsigned color, unsigned bordercolor);
+void LCD_DrawLine(int layer, int x, int y, int dx, int dy, unsigned color);
+
+/**
+ * @brief   Point for polylines and batches of lines
+ */
+typedef struct {
+    int16_t     x;
+    int16_t     y;
+} LCD_Point_t;
+
+void LCD_DrawPolyline(int layer, const LCD_Point_t *points, int n, unsigned color);
+void LCD_DrawLines(int layer, const LCD_Point_t *points, int n, unsigned color);
+
+/**
+ * @brief   Double and triple buffering
+ *
+ * @note    LCD_IRQLEVEL is the priority of the LTDC interrupt used to detect the
+ *          reload of the frame buffer address at vertical blanking
+ */
+///@{
+#define LCD_MAXFRAMEBUFFERS     3
+#ifndef LCD_MAXDAMAGE
+#define LCD_MAXDAMAGE           16
+#endif
+#ifndef LCD_IRQLEVEL
+#define LCD_IRQLEVEL            5
+#endif
+///@}
+
+/**
+ * @brief   Statistics of partial updates (dirty rectangles)
+ */
+typedef struct {
+    uint32_t    lastpixels;                 ///< pixels copied for the last frame
+    uint32_t    lastrects;                  ///< rectangles copied for the last frame
+    uint32_t    totalpixels;                ///< pixels copied since setup
+    uint32_t    syncs;                      ///< number of back buffer updates
+} LCD_DamageStats_t;
+
+int   LCD_SetupFrameBuffers(int layer, int n, int format);
+void *LCD_GetDrawBuffer(int layer);
+int   LCD_IsNextBufferAvailable(int layer);
+int   LCD_PresentFrame(int layer);
+uint32_t LCD_GetFrameCount(int layer);
+void  LCD_AddDamage(int layer, int x, int y, int w, int h);
+void  LCD_GetDamageStats(int layer, LCD_DamageStats_t *stats);
+
+/**
+ * @brief   Band rendering (racing the beam)
+ *
+ * @note    The callback renders lines y0 to y1-1 and is called in the LTDC
+ *          interrupt when the beam reaches the band before it
+ */
+///@{
+#ifndef LCD_MAXBANDS
+#define LCD_MAXBANDS            16
+#endif
+typedef void (*LCD_BandCallback)(int band, int y0, int y1, void *arg);
+
+typedef struct {
+    uint32_t    calls;                      ///< times the band was rendered
+    uint32_t    late;                       ///< renders ended after the beam got there
+    int32_t     lastslack;                  ///< lines left at the end of the last render
+    int32_t     minslack;                   ///< smallest slack since start
+} LCD_BandStats_t;
+
+int   LCD_StartBands(int nbands, LCD_BandCallback cb, void *arg);
+void  LCD_StopBands(void);
+void  LCD_GetBandStats(int band, LCD_BandStats_t *stats);
+///@}
+
+void LCD_SetAcceleration(int layer, int on);
+void LCD_WaitDrawing(void);
+#endif
+
@@ -0,0 +1,176 @@
+/**
+ * @file     main.c
+ * @brief    Camera capture with the DCMI shown on the LCD thru the DMA2D
+ * @version  V1.0
+ * @date     15/10/2026
+ *
+ * @note     The camera (OV9655) captures RGB565 frames into three buffers in
+ *           SDRAM, allocated from the buddy pool. Each new frame is converted
+ *           by the DMA2D (pixel format conversion to RGB888) into the back
+ *           buffer of layer 1, centered, and the layer is flipped at the next
+ *           vertical blanking (triple buffering)
+ *
+ * @note     With CAMERA_SNAPSHOT (Makefile), one frame is taken each second.
+ *           With CAMERA_QQVGA, the frames are 160x120 instead of 320x240
+ *
+ * @note     Every second, the capture and display rates are printed thru the
+ *           UART
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "led.h"
+#include "sdram.h"
+#include "cache.h"
+#include "buddy.h"
+#include "lcd.h"
+#include "dma2d.h"
+#include "i2c-master.h"
+#include "dcmi.h"
+#ifdef USE_PLLCONFIG
+#include "pllconfig.h"
+
+/**
+ * @brief   Main PLL configuration found by tools/mkpll (pllconfig.h)
+ */
+static const PLLConfiguration_t MainPLLConfiguration = PLLCONFIG_MAIN;
+#endif
+
+/**
+ * @brief   Capture and display parameters
+ */
+///@{
+#ifdef CAMERA_QQVGA
+#define RESOLUTION          DCMI_RES_QQVGA
+#else
+#define RESOLUTION          DCMI_RES_QVGA
+#endif
+#define NBUFFERS            (3)
+#define LAYER               (1)
+#define FORMAT              LCD_FORMAT_RGB888
+///@}
+
+/**
+ * @brief   Systick routine
+ *
+ * @note    It is called every 1ms. It counts the I2C timeouts
+ */
+static volatile uint32_t tick_ms = 0;
+
+void SysTick_Handler(void) {
+
+    tick_ms++;
+    I2CMaster_ProcessTimeouts();
+}
+
+/**
+ * @brief   Frame converted: the DMA2D does not read it anymore
+ *
+ * @note    Called from the DMA2D interrupt
+ */
+static void Converted( void *arg, int status ) {
+
+    (void) status;
+    DCMI_ReleaseFrame(arg);
+}
+
+/**
+ * @brief   Convert a frame into the back buffer of the layer and show it
+ *
+ * @note    Only the window of the camera is written. The rest of the buffer
+ *          was filled once and is kept by the damage tracking of lcd.c
+ */
+static void ShowFrame( const uint16_t *frame ) {
+unsigned w = DCMI_GetWidth();
+unsigned h = DCMI_GetHeight();
+unsigned x = (LCD_GetWidth(LAYER)-w)/2;
+unsigned y = (LCD_GetHeight(LAYER)-h)/2;
+void *fb;
+
+    fb = LCD_GetDrawBuffer(LAYER);
+    DECLARE_REGION(src,frame,0,0,w,h,DMA2D_RGB565,w*sizeof(uint16_t));
+    DECLARE_REGION(dst,fb,x,y,w,h,DMA2D_RGB888,LCD_GetPitch(LAYER));
+    if( DMA2D_SubmitCopy(&src,&dst,Converted,(void *) frame) == 0 ) {
+        DCMI_ReleaseFrame(frame);
+        return;
+    }
+    LCD_PresentFrame(LAYER);
+}
+
+/**
+ * @brief   main
+ */
+int main(void) {
+const uint16_t *frame;
+DCMI_Stats s;
+uint32_t lastframes = 0, lastflips = 0, flips;
+uint32_t last;
+int rc;
+
+#ifdef USE_PLLCONFIG
+    // No search at run time. M, N, P and Q come from pllconfig.h
+    SystemConfigMainPLL(&MainPLLConfiguration);
+    RCC->DCKCFGR2 = (RCC->DCKCFGR2&~RCC_DCKCFGR2_CK48MSEL)
+                    |(PLLCONFIG_CK48MSEL<<RCC_DCKCFGR2_CK48MSEL_Pos);
+#endif
+    // Main PLL was started by SystemInit and locked meanwhile
+    SystemSetCoreClock(CLOCKSRC_PLL,1);
+
+    SysTick_Config(SystemCoreClock/1000);
+
+    LED_Init();
+    SDRAM_Init();
+    Cache_Init();
+    Buddy_Init((char*) SDRAM_ADDRESS,SDRAM_SIZE,4096);
+
+    LCD_Init();
+    if( LCD_SetupFrameBuffers(LAYER,3,FORMAT) < 0 ) {
+        printf("LCD: no memory\n");
+        for(;;) {}
+    }
+    LCD_FillFrameBuffer(LAYER,RGB(0,0,0));
+    LCD_EnableLayer(LAYER);
+    LCD_PresentFrame(LAYER);
+
+    rc = DCMI_Init(RESOLUTION,NBUFFERS);
+    if( rc == DCMI_OK ) {
+#ifdef CAMERA_SNAPSHOT
+        rc = DCMI_Start(DCMI_MODE_SNAPSHOT);
+#else
+        rc = DCMI_Start(DCMI_MODE_CONTINUOUS);
+#endif
+    }
+    if( rc != DCMI_OK ) {
+        printf("DCMI: error %d\n",rc);
+        for(;;) {}
+    }
+    printf("\nCamera: %ux%u RGB565, %d buffers\n",
+            DCMI_GetWidth(),DCMI_GetHeight(),NBUFFERS);
+
+    last = tick_ms;
+    for(;;) {
+        frame = DCMI_GetFrame();
+        if( frame )
+            ShowFrame(frame);
+        if( tick_ms-last < 1000 )
+            continue;
+        last = tick_ms;
+        LED_Toggle();
+#ifdef CAMERA_SNAPSHOT
+        if( !DCMI_IsCapturing() )
+            DCMI_Start(DCMI_MODE_SNAPSHOT);
+#endif
+        DCMI_GetStats(&s);
+        flips = LCD_GetFrameCount(LAYER);
+        printf("capture %lu fps display %lu fps dropped %lu overruns %lu sync errors %lu dma errors %lu\n",
+                (unsigned long) (s.frames-lastframes),(unsigned long) (flips-lastflips),
+                (unsigned long) s.dropped,(unsigned long) s.overruns,
+                (unsigned long) s.syncerrors,(unsigned long) s.dmaerrors);
+        lastframes = s.frames;
+        lastflips  = flips;
+    }
+}
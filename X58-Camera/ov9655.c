@@ -0,0 +1,232 @@
+/**
+ * @file    ov9655.c
+ *
+ * @brief   Configuration of the OV9655 camera sensor
+ *
+ * @note    The sensor is reset and the registers below are written. The values
+ *          come from the OV9655 datasheet (VGA window, RGB565, automatic gain,
+ *          exposure and white balance). QVGA and QQVGA are obtained by the
+ *          scaler (POIDX and PCKDV)
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "i2c-master.h"
+#include "ov9655.h"
+
+/**
+ * @brief   Registers
+ */
+///@{
+#define REG_VREF            (0x03)
+#define REG_PID             (0x0A)
+#define REG_VER             (0x0B)
+#define REG_COM3            (0x0C)
+#define REG_COM5            (0x0E)
+#define REG_COM6            (0x0F)
+#define REG_CLKRC           (0x11)
+#define REG_COM7            (0x12)
+#define REG_COM8            (0x13)
+#define REG_COM9            (0x14)
+#define REG_HSTART          (0x17)
+#define REG_HSTOP           (0x18)
+#define REG_VSTART          (0x19)
+#define REG_VSTOP           (0x1A)
+#define REG_AEW             (0x24)
+#define REG_AEB             (0x25)
+#define REG_VPT             (0x26)
+#define REG_HREF            (0x32)
+#define REG_COM14           (0x3E)
+#define REG_COM15           (0x40)
+#define REG_POIDX           (0x72)
+#define REG_PCKDV           (0x73)
+///@}
+
+/**
+ * @brief   Register write
+ */
+typedef struct {
+    uint8_t     reg;
+    uint8_t     value;
+} OV9655_RegWrite;
+
+/**
+ * @brief   Common configuration (after the reset)
+ */
+static const OV9655_RegWrite seq_common[] = {
+    { REG_CLKRC,    0x01 },         // internal clock = XCLK/2
+    { REG_COM5,     0x61 },         // slam mode off, exposure timing
+    { REG_COM6,     0x42 },         // BLC on, reset timing at format change
+    { REG_COM7,     0x63 },         // VGA, RGB
+    { REG_COM15,    0xD0 },         // RGB565, output range 00 to FF
+    { REG_COM8,     0xE7 },         // fast AEC, AGC, AWB and AEC on
+    { REG_COM9,     0x3A },         // maximal AGC gain 16x, drop VSYNC on frame drop
+    { REG_AEW,      0x3C },         // AEC/AGC stable region
+    { REG_AEB,      0x36 },
+    { REG_VPT,      0x72 },
+    { REG_HSTART,   0x16 },         // VGA window
+    { REG_HSTOP,    0x02 },
+    { REG_HREF,     0x12 },
+    { REG_VSTART,   0x01 },
+    { REG_VSTOP,    0x3D },
+    { REG_VREF,     0x12 },
+};
+
+/**
+ * @brief   Scaler for QVGA (1/2) and QQVGA (1/4)
+ */
+///@{
+static const OV9655_RegWrite seq_qvga[] = {
+    { REG_COM3,     0x44 },         // swap MSB/LSB, VarioPixel
+    { REG_COM14,    0x02 },         // zoom on
+    { REG_POIDX,    0x11 },         // skip every other line and pixel
+    { REG_PCKDV,    0x01 },         // PCLK/2
+};
+
+static const OV9655_RegWrite seq_qqvga[] = {
+    { REG_COM3,     0x44 },
+    { REG_COM14,    0x0E },
+    { REG_POIDX,    0x22 },         // keep one line and pixel of four
+    { REG_PCKDV,    0x02 },         // PCLK/4
+};
+///@}
+
+#define NWRITES(S) (sizeof(S)/sizeof(S[0]))
+
+/**
+ * @brief   Bus configured by OV9655_Init
+ */
+static I2C_TypeDef  *ovi2c = 0;
+
+/**
+ * @brief   Transfer buffer
+ *
+ * @note    Cache line aligned and padded, because the I2C driver cleans and
+ *          invalidates the data cache over it for the DMA
+ */
+static uint8_t  iobuf[32] __attribute__((aligned(32)));
+
+/**
+ * @brief   Delay using the cycle counter (does not need SysTick)
+ */
+static void Delay( unsigned ms ) {
+uint32_t t0,cycles;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    cycles = SystemCoreClock/1000;
+    while( ms-- > 0 ) {
+        t0 = DWT->CYCCNT;
+        while( DWT->CYCCNT-t0 < cycles ) {}
+    }
+}
+
+/**
+ * @brief   Execute a register sequence
+ */
+static int WriteSequence( const OV9655_RegWrite *s, unsigned n ) {
+unsigned i;
+
+    for(i=0;i<n;i++) {
+        if( OV9655_Write(s[i].reg,s[i].value) < 0 )
+            return OV9655_ERROR_I2C;
+    }
+    return OV9655_OK;
+}
+
+/**
+ * @brief  OV9655_Write
+ */
+int
+OV9655_Write( uint8_t reg, uint8_t value ) {
+
+    if( !ovi2c )
+        return OV9655_ERROR_PARAMETER;
+    iobuf[0] = reg;
+    iobuf[1] = value;
+    if( I2CMaster_Write(ovi2c,OV9655_ADDRESS,iobuf,2) < 0 )
+        return OV9655_ERROR_I2C;
+    return OV9655_OK;
+}
+
+/**
+ * @brief  OV9655_Read
+ *
+ * @note   Two transactions, because SCCB has no repeated start
+ */
+int
+OV9655_Read( uint8_t reg, uint8_t *value ) {
+
+    if( !ovi2c )
+        return OV9655_ERROR_PARAMETER;
+    iobuf[0] = reg;
+    if( I2CMaster_Write(ovi2c,OV9655_ADDRESS,iobuf,1) < 0 )
+        return OV9655_ERROR_I2C;
+    if( I2CMaster_Read(ovi2c,OV9655_ADDRESS,iobuf+1,1) < 0 )
+        return OV9655_ERROR_I2C;
+    *value = iobuf[1];
+    return OV9655_OK;
+}
+
+/**
+ * @brief  OV9655_GetId
+ *
+ * @note   PID in the high byte and VER in the low byte
+ */
+int
+OV9655_GetId( uint16_t *id ) {
+uint8_t pid,ver;
+
+    if( OV9655_Read(REG_PID,&pid) < 0 || OV9655_Read(REG_VER,&ver) < 0 )
+        return OV9655_ERROR_I2C;
+    *id = (pid<<8)|ver;
+    return OV9655_OK;
+}
+
+/**
+ * @brief  OV9655_Init
+ *
+ * @note   Checks the id, resets the sensor and configures it for RGB565 at the
+ *         resolution. The I2C bus must already be initialized and the sensor
+ *         powered up
+ */
+int
+OV9655_Init( I2C_TypeDef *i2c, int resolution ) {
+uint16_t id;
+int rc;
+
+    if( resolution != OV9655_RES_QVGA && resolution != OV9655_RES_QQVGA )
+        return OV9655_ERROR_PARAMETER;
+
+    ovi2c = i2c;
+    rc = OV9655_GetId(&id);
+    if( rc < 0 )
+        return rc;
+    if( (id>>8) != OV9655_PID
+        || ((id&0xFF) != OV9655_VER_REV4 && (id&0xFF) != OV9655_VER_REV5) )
+        return OV9655_ERROR_CHIPID;
+
+    // Reset of all registers, the sensor needs 1 ms before the next access
+    if( OV9655_Write(REG_COM7,0x80) < 0 )
+        return OV9655_ERROR_I2C;
+    Delay(10);
+
+    rc = WriteSequence(seq_common,NWRITES(seq_common));
+    if( rc < 0 )
+        return rc;
+    if( resolution == OV9655_RES_QVGA )
+        rc = WriteSequence(seq_qvga,NWRITES(seq_qvga));
+    else
+        rc = WriteSequence(seq_qqvga,NWRITES(seq_qqvga));
+    if( rc < 0 )
+        return rc;
+
+    // Automatic exposure needs some frames to settle
+    Delay(300);
+    return OV9655_OK;
+}
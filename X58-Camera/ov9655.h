@@ -0,0 +1,62 @@
+#ifndef OV9655_H
+#define OV9655_H
+/**
+ * @file    ov9655.h
+ *
+ * @brief   Configuration of the OV9655 camera sensor (STM32F4DIS-CAM module)
+ *
+ * @note    The module is plugged into the camera connector (P1). Its SCCB port
+ *          is at I2C1 (EXT I2C, PB8/PB9, shared with the Arduino connector).
+ *          Registers have 8 bit addresses and 8 bit values
+ *
+ * @note    SCCB does not accept a repeated start, so a read is a write of the
+ *          register address followed by a separate read
+ *
+ * @note    The sensor is configured for RGB565 at QVGA (320x240) or QQVGA
+ *          (160x120). The bytes are swapped (COM3), so that the DCMI packs
+ *          them as little endian 16 bit pixels. VSYNC is high during the
+ *          vertical blanking, HREF is high while a line is valid and data is
+ *          sampled at the rising edge of PCLK. The module has its own 24 MHz
+ *          oscillator
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "stm32f746xx.h"
+
+/**
+ * @brief   SCCB address (7 bit) and product id (registers PID and VER)
+ */
+///@{
+#define OV9655_ADDRESS                  (0x30)
+#define OV9655_PID                      (0x96)
+#define OV9655_VER_REV4                 (0x56)
+#define OV9655_VER_REV5                 (0x57)
+///@}
+
+/**
+ * @brief   Resolutions (same values as DCMI_RES_*)
+ */
+///@{
+#define OV9655_RES_QQVGA                (1)     ///< 160x120
+#define OV9655_RES_QVGA                 (2)     ///< 320x240
+///@}
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define OV9655_OK                       (0)
+#define OV9655_ERROR_PARAMETER          (-1)
+#define OV9655_ERROR_I2C                (-2)
+#define OV9655_ERROR_CHIPID             (-3)
+///@}
+
+int OV9655_Init( I2C_TypeDef *i2c, int resolution );
+int OV9655_Write( uint8_t reg, uint8_t value );
+int OV9655_Read( uint8_t reg, uint8_t *value );
+int OV9655_GetId( uint16_t *id );
+
+#endif // OV9655_H
@@ -0,0 +1,34 @@
+#ifndef PIXOPS_H
+#define PIXOPS_H
+/**
+ * @file    pixops.h
+ *
+ * @note    CPU kernels to fill, copy and blend pixels
+ *
+ * @note    They are used by lcd.c where DMA2D is not used (8 bit formats, small
+ *          areas) and compared with plain C loops in X55-Benchmark
+ *
+ * @note    Sizes are given in words (fill), bytes (copy and byte wise blend) or
+ *          pixels (RGB565 and ARGB8888 blend). The areas must be word aligned,
+ *          except for PixOps_Copy.
+ *
+ * @date    14/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+
+void PixOps_FillWords(uint32_t *dst, uint32_t w, unsigned nwords);
+void PixOps_Fill3Words(uint32_t *dst, uint32_t w0, uint32_t w1, uint32_t w2,
+                       unsigned ngroups);
+void PixOps_Copy(void *dst, const void *src, unsigned nbytes);
+
+void PixOps_Blend50RGB565(uint16_t *dst, const uint16_t *src, unsigned npixels);
+void PixOps_Blend50Bytes(void *dst, const void *src, unsigned nbytes);
+void PixOps_BlendAlphaRGB565(uint16_t *dst, const uint16_t *src, unsigned npixels,
+                             unsigned alpha);
+void PixOps_BlendAlphaBytes(void *dst, const void *src, unsigned nbytes,
+                            unsigned alpha);
+void PixOps_BlendARGB8888(uint32_t *dst, const uint32_t *src, unsigned npixels);
+
+#endif // PIXOPS_H
@@ -0,0 +1,306 @@
+/**
+ * @file    gpiowave.c
+ *
+ * @brief   Parallel GPIO waveforms written by DMA at a timer rate (see
+ *          gpiowave.h)
+ *
+ * @note    The timer comes from timer.c and the stream from dma.c. The timer
+ *          only generates the update requests (UDE), it has no channel
+ *          enabled
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "stm32f746xx.h"
+#include "gpio.h"
+#include "dma.h"
+#include "timer.h"
+#include "gpiowave.h"
+
+/**
+ * @brief   State of the engines (TIM1 and TIM8)
+ */
+///@{
+typedef struct {
+    TIM_TypeDef        *tim;
+    int                 request;
+    int                 initialized;
+    GPIO_TypeDef       *gpio;
+    uint32_t            rate;
+    int                 h;                  ///< stream or -1
+    uint32_t           *buf[2];             ///< stream mode
+    unsigned            n;
+    GPIOWave_Refill     refill;
+    void               *arg;
+    volatile uint32_t   buffers;
+    volatile uint32_t   late;
+    volatile uint32_t   errors;
+} GPIOWaveState;
+
+static GPIOWaveState wavestate[] = {
+    { TIM1, DMA_REQ_TIM1_UP, 0, 0, 0, -1, { 0, 0 }, 0, 0, 0, 0, 0, 0 },
+    { TIM8, DMA_REQ_TIM8_UP, 0, 0, 0, -1, { 0, 0 }, 0, 0, 0, 0, 0, 0 },
+};
+#define NWAVES (sizeof(wavestate)/sizeof(wavestate[0]))
+///@}
+
+/**
+ * @brief   Configuration of the pins: push-pull outputs at very high speed
+ *
+ * @note    gpio and pin are set by GPIO_ConfigureMultiplePinsEqual
+ */
+static GPIO_PinConfiguration outputpin =
+    //  GPIO  Pin AF  Mode OType Speed PuPd
+    { 0,      0,  0,  1,   0,    3,    0 };
+
+/**
+ * @brief   State of the engine of the timer (or null)
+ */
+static GPIOWaveState *FindWave( TIM_TypeDef *tim ) {
+unsigned i;
+
+    for(i=0;i<NWAVES;i++) {
+        if( wavestate[i].tim == tim )
+            return &wavestate[i];
+    }
+    return 0;
+}
+
+/**
+ * @brief   Write a buffer from the data cache to the memory
+ */
+static void CleanBuffer( const uint32_t *p, unsigned n ) {
+uint32_t a = (uint32_t) p;
+
+    SCB_CleanDCache_by_Addr((uint32_t *) (a&~31U),n*sizeof(uint32_t)+(a&31U));
+}
+
+/**
+ * @brief   Transfer complete of the stream mode
+ *
+ * @note    The buffer that ended is the one not in use now. When the stream
+ *          is in it again at the end of the refill, the DMA has already
+ *          started to play it
+ */
+static void StreamDone( void *arg, int event ) {
+GPIOWaveState *w = (GPIOWaveState *) arg;
+int k;
+
+    if( event == DMA_EVENT_ERROR ) {
+        w->errors++;
+        return;
+    }
+    if( event != DMA_EVENT_FULL )
+        return;
+    k = DMA_CurrentBuffer(w->h)^1;
+    w->refill(w->arg,w->buf[k],w->n);
+    CleanBuffer(w->buf[k],w->n);
+    if( DMA_CurrentBuffer(w->h) == k )
+        w->late++;
+    w->buffers++;
+}
+
+/**
+ * @brief   Allocate and configure the stream
+ */
+static int Configure( GPIOWaveState *w, uint32_t flags, DMA_Callback cb ) {
+DMA_Config conf;
+int h;
+
+    h = DMA_Allocate(w->request);
+    if( h < 0 )
+        return GPIOWAVE_ERROR_DMA;
+    conf.dir      = DMA_DIR_M2P;
+    conf.periph   = &w->gpio->BSRR;
+    conf.psize    = DMA_SIZE_32;
+    conf.msize    = DMA_SIZE_32;
+    conf.burst    = DMA_BURST_SINGLE;
+    conf.priority = 3;
+    conf.flags    = DMA_FLAG_MINC|flags;
+    conf.callback = cb;
+    conf.arg      = w;
+    if( DMA_Configure(h,&conf) < 0 ) {
+        DMA_Free(h);
+        return GPIOWAVE_ERROR_DMA;
+    }
+    w->h = h;
+    return GPIOWAVE_OK;
+}
+
+/**
+ * @brief   Enable the requests and start the timer
+ */
+static void Run( GPIOWaveState *w ) {
+
+    w->tim->DIER |= TIM_DIER_UDE;
+    Timer_Start(w->tim);
+}
+
+/**
+ * @brief  GPIOWave_Init
+ *
+ * @note   Configures pins of gpio as outputs and the timer (TIM1 or TIM8) to
+ *         count rate updates per second. The prescaler is only used when the
+ *         period does not fit in 16 bits, so the rate is the closest one to a
+ *         divisor of the timer clock (see GPIOWave_GetRate)
+ */
+int
+GPIOWave_Init( TIM_TypeDef *tim, GPIO_TypeDef *gpio, uint32_t pins,
+               uint32_t rate ) {
+GPIOWaveState *w;
+uint32_t clk,tickfreq,period,psc;
+
+    w = FindWave(tim);
+    if( !w || !gpio || pins == 0 || pins > 0xFFFF )
+        return GPIOWAVE_ERROR_PARAMETER;
+    if( rate == 0 )
+        return GPIOWAVE_ERROR_RATE;
+    GPIOWave_Stop(tim);
+
+    clk    = Timer_GetClock(tim);
+    period = (clk+rate/2)/rate;
+    if( period < GPIOWAVE_MINPERIOD )
+        return GPIOWAVE_ERROR_RATE;
+    psc      = (period+65535)/65536;
+    tickfreq = clk/psc;
+    period   = (tickfreq+rate/2)/rate;
+    if( Timer_Init(tim,tickfreq,period) != TIMER_OK )
+        return GPIOWAVE_ERROR_RATE;
+
+    GPIO_ConfigureMultiplePinsEqual(gpio,pins,&outputpin);
+
+    w->gpio        = gpio;
+    w->rate        = Timer_GetTickFrequency(tim)/period;
+    w->initialized = 1;
+    return GPIOWAVE_OK;
+}
+
+/**
+ * @brief  GPIOWave_GetRate
+ *
+ * @note   Words written per second (0 when not initialized)
+ */
+uint32_t
+GPIOWave_GetRate( TIM_TypeDef *tim ) {
+GPIOWaveState *w;
+
+    w = FindWave(tim);
+    return (w && w->initialized) ? w->rate : 0;
+}
+
+/**
+ * @brief  GPIOWave_StartLoop
+ *
+ * @note   Writes words[0] to words[n-1] to BSRR, one at each update, and starts
+ *         again. words is cleaned from the data cache here and must not change
+ *         while it runs. The first word is written one period after the start
+ */
+int
+GPIOWave_StartLoop( TIM_TypeDef *tim, const uint32_t *words, unsigned n ) {
+GPIOWaveState *w;
+int rc;
+
+    w = FindWave(tim);
+    if( !w || !words || n == 0 || n > 65535 )
+        return GPIOWAVE_ERROR_PARAMETER;
+    if( !w->initialized )
+        return GPIOWAVE_ERROR_NOTINITIALIZED;
+    GPIOWave_Stop(tim);
+
+    rc = Configure(w,DMA_FLAG_CIRCULAR,0);
+    if( rc < 0 )
+        return rc;
+    CleanBuffer(words,n);
+    if( DMA_Start(w->h,(void *) words,(void *) words,n) < 0 ) {
+        GPIOWave_Stop(tim);
+        return GPIOWAVE_ERROR_PARAMETER;
+    }
+    Run(w);
+    return GPIOWAVE_OK;
+}
+
+/**
+ * @brief  GPIOWave_StartStream
+ *
+ * @note   buf0 and buf1 have n words each. refill is called here for both of
+ *         them and then, from the DMA interrupt (DMA_IRQ_PRIO), for each buffer
+ *         that ends. It must be shorter than a buffer (n/rate seconds). The
+ *         buffers should be aligned to 32 bytes and padded to whole cache
+ *         lines
+ */
+int
+GPIOWave_StartStream( TIM_TypeDef *tim, uint32_t *buf0, uint32_t *buf1,
+                      unsigned n, GPIOWave_Refill refill, void *arg ) {
+GPIOWaveState *w;
+int rc;
+
+    w = FindWave(tim);
+    if( !w || !buf0 || !buf1 || buf0 == buf1 || !refill || n == 0 || n > 65535 )
+        return GPIOWAVE_ERROR_PARAMETER;
+    if( !w->initialized )
+        return GPIOWAVE_ERROR_NOTINITIALIZED;
+    GPIOWave_Stop(tim);
+
+    w->buf[0]  = buf0;
+    w->buf[1]  = buf1;
+    w->n       = n;
+    w->refill  = refill;
+    w->arg     = arg;
+    w->buffers = 0;
+    w->late    = 0;
+    w->errors  = 0;
+    rc = Configure(w,DMA_FLAG_DOUBLEBUFFER,StreamDone);
+    if( rc < 0 )
+        return rc;
+    refill(arg,buf0,n);
+    refill(arg,buf1,n);
+    CleanBuffer(buf0,n);
+    CleanBuffer(buf1,n);
+    if( DMA_Start(w->h,buf0,buf1,n) < 0 ) {
+        GPIOWave_Stop(tim);
+        return GPIOWAVE_ERROR_PARAMETER;
+    }
+    Run(w);
+    return GPIOWAVE_OK;
+}
+
+/**
+ * @brief  GPIOWave_Stop
+ *
+ * @note   The pins keep the last level written
+ */
+void
+GPIOWave_Stop( TIM_TypeDef *tim ) {
+GPIOWaveState *w;
+
+    w = FindWave(tim);
+    if( !w || !w->initialized )
+        return;
+    tim->DIER &= ~TIM_DIER_UDE;
+    Timer_Stop(tim);
+    if( w->h >= 0 ) {
+        DMA_Stop(w->h);
+        DMA_Free(w->h);
+        w->h = -1;
+    }
+}
+
+/**
+ * @brief  GPIOWave_GetStats
+ */
+int
+GPIOWave_GetStats( TIM_TypeDef *tim, GPIOWave_Stats *st ) {
+GPIOWaveState *w;
+
+    w = FindWave(tim);
+    if( !w || !st )
+        return GPIOWAVE_ERROR_PARAMETER;
+    if( !w->initialized )
+        return GPIOWAVE_ERROR_NOTINITIALIZED;
+    st->buffers = w->buffers;
+    st->late    = w->late;
+    st->errors  = w->errors;
+    return GPIOWAVE_OK;
+}
@@ -0,0 +1,91 @@
+#ifndef GPIOWAVE_H
+#define GPIOWAVE_H
+/**
+ * @file    gpiowave.h
+ *
+ * @brief   Parallel GPIO waveforms written by DMA at a timer rate
+ *
+ * @note    At each update of the timer, a DMA2 stream writes the next word of
+ *          a buffer into BSRR of the port. A word sets the pins of its lower
+ *          half and clears the pins of its upper half (see GPIO_Write), so the
+ *          pins change together, at the rate of the timer, whatever the CPU
+ *          does. GPIOWave_Word builds it from a value
+ *
+ * @note    Only the update requests of TIM1 and TIM8 are served by DMA2, whose
+ *          peripheral port reaches the GPIO ports (AHB1). DMA1 only reaches
+ *          APB1. The timer can not be used for PWM waveforms
+ *          (Timer_StartWaveform) at the same time
+ *
+ * @note    Modes
+ *          - Loop: a buffer is repeated forever (circular mode)
+ *          - Stream: two buffers are played one after the other (double buffer
+ *            mode). When one ends, the refill callback is called from the DMA
+ *            interrupt to write its next words while the other one plays. A
+ *            refill that ends after the other buffer is counted as late
+ *
+ * @note    Each word is a single DMA transfer from memory to AHB1, so the rate
+ *          is limited by the DMA and by the other masters of the bus matrix.
+ *          Rates above the limit give lost requests, that is, a slower
+ *          waveform. The timer period is at least GPIOWAVE_MINPERIOD ticks
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "stm32f746xx.h"
+
+/**
+ * @brief   Minimal period of the timer (in timer clocks)
+ *
+ * @note    20 clocks of 200 MHz give 10 MHz
+ */
+#ifndef GPIOWAVE_MINPERIOD
+#define GPIOWAVE_MINPERIOD              (20)
+#endif
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define GPIOWAVE_OK                     (0)
+#define GPIOWAVE_ERROR_PARAMETER        (-1)
+#define GPIOWAVE_ERROR_RATE             (-2)    ///< rate too high or too low
+#define GPIOWAVE_ERROR_DMA              (-3)    ///< no stream
+#define GPIOWAVE_ERROR_NOTINITIALIZED   (-4)
+///@}
+
+/**
+ * @brief   Refill callback of the stream mode
+ *
+ * @note    Called from the DMA interrupt with the buffer to fill (n words)
+ */
+typedef void (*GPIOWave_Refill)(void *arg, uint32_t *buf, unsigned n);
+
+/**
+ * @brief   Statistics of the stream mode
+ */
+typedef struct {
+    uint32_t    buffers;                ///< buffers played
+    uint32_t    late;                   ///< refills not done in time
+    uint32_t    errors;                 ///< DMA errors (the output stops)
+} GPIOWave_Stats;
+
+/**
+ * @brief   BSRR word that gives the pins in mask the bits of value
+ */
+static inline uint32_t GPIOWave_Word( uint32_t mask, uint32_t value ) {
+
+    return ((~value&mask)<<16)|(value&mask);
+}
+
+int      GPIOWave_Init( TIM_TypeDef *tim, GPIO_TypeDef *gpio, uint32_t pins,
+                        uint32_t rate );
+uint32_t GPIOWave_GetRate( TIM_TypeDef *tim );
+int      GPIOWave_StartLoop( TIM_TypeDef *tim, const uint32_t *words, unsigned n );
+int      GPIOWave_StartStream( TIM_TypeDef *tim, uint32_t *buf0, uint32_t *buf1,
+                               unsigned n, GPIOWave_Refill refill, void *arg );
+void     GPIOWave_Stop( TIM_TypeDef *tim );
+int      GPIOWave_GetStats( TIM_TypeDef *tim, GPIOWave_Stats *st );
+
+#endif // GPIOWAVE_H
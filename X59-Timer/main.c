@@ -0,0 +1,237 @@
+/**
+ * @file     main.c
+ * @brief    PWM, encoder, one pulse and input capture with the timers
+ * @version  V1.0
+ * @date     15/10/2026
+ *
+ * @note     TIM1 generates a 20 kHz PWM at D10 (PA8). With TIMER_SINEPWM
+ *           (Makefile), its duty cycle follows a 64 point sine table written
+ *           by DMA at each update, otherwise it is fixed at 25%
+ *
+ * @note     TIM2 captures the rising edges at D9 (PA15) into a ring buffer by
+ *           DMA. With D10 connected to D9, the PWM frequency is measured from
+ *           the last 256 edges. The older ones are counted as overruns
+ *
+ * @note     TIM3 counts a quadrature encoder connected to D3 (PB4) and D0
+ *           (PC7), with pull-ups
+ *
+ * @note     TIM5 generates a 100 us pulse at D5 (PI0), 10 us after a software
+ *           trigger, once per second
+ *
+ * @note     With TIMER_GPIOWAVE (Makefile), TIM8 and DMA2 write a 2 bit counter
+ *           to D2 (PG6) and D4 (PG7) at 2 MHz, from two buffers refilled in
+ *           the DMA interrupt (gpiowave.c)
+ *
+ * @note     Every second, the counters are printed thru the UART
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "led.h"
+#include "gpio.h"
+#include "timer.h"
+#ifdef TIMER_GPIOWAVE
+#include "gpiowave.h"
+#endif
+
+/**
+ * @brief   PWM parameters (TIM1, 20 MHz tick)
+ */
+///@{
+#define PWM_TICK            (20000000)
+#define PWM_PERIOD          (1000)
+///@}
+
+/**
+ * @brief   Capture parameters (TIM2, 100 MHz tick)
+ */
+///@{
+#define CAPTURE_TICK        (100000000)
+#define CAPTURE_RING        (256)
+///@}
+
+/**
+ * @brief   Pins
+ */
+///@{
+static const GPIO_PinConfiguration pwmpin =
+    //  GPIO  Pin AF  Mode OType Speed PuPd
+    { GPIOA,  8,  1,  2,   0,    2,    0 };     // D10 TIM1_CH1
+static const GPIO_PinConfiguration capturepin =
+    { GPIOA, 15,  1,  2,   0,    2,    0 };     // D9  TIM2_CH1
+static const GPIO_PinConfiguration encoderpins[2] = {
+    { GPIOB,  4,  2,  2,   0,    0,    1 },     // D3  TIM3_CH1
+    { GPIOC,  7,  2,  2,   0,    0,    1 },     // D0  TIM3_CH2
+};
+static const GPIO_PinConfiguration pulsepin =
+    { GPIOI,  0,  2,  2,   0,    2,    0 };     // D5  TIM5_CH4
+///@}
+
+#ifdef TIMER_SINEPWM
+/**
+ * @brief   Sine table (pulse values for PWM_PERIOD = 1000)
+ *
+ * @note    At 20 kHz, the sine has 312.5 Hz
+ */
+static const uint32_t sinetable[64] __attribute__((aligned(32))) = {
+     500,  544,  588,  631,  672,  712,  750,  785,
+     818,  848,  874,  897,  916,  931,  941,  948,
+     950,  948,  941,  931,  916,  897,  874,  848,
+     818,  785,  750,  712,  672,  631,  588,  544,
+     500,  456,  412,  369,  328,  288,  250,  215,
+     182,  152,  126,  103,   84,   69,   59,   52,
+      50,   52,   59,   69,   84,  103,  126,  152,
+     182,  215,  250,  288,  328,  369,  412,  456,
+};
+#endif
+
+#ifdef TIMER_GPIOWAVE
+/**
+ * @brief   Parallel output (TIM8, DMA2 to GPIOG BSRR)
+ *
+ * @note    A buffer of 256 words lasts 128 us at 2 MHz
+ */
+///@{
+#define WAVE_RATE           (2000000)
+#define WAVE_WORDS          (256)
+#define WAVE_PINS           ((1U<<6)|(1U<<7))       // D2 PG6, D4 PG7
+
+static uint32_t wavebuf[2][WAVE_WORDS] __attribute__((aligned(32)));
+static uint32_t wavecount = 0;
+
+/**
+ * @brief   Next words of the counter (called from the DMA interrupt)
+ */
+static void WaveRefill( void *arg, uint32_t *buf, unsigned n ) {
+unsigned i;
+
+    for(i=0;i<n;i++) {
+        buf[i] = GPIOWave_Word(WAVE_PINS,(wavecount&3)<<6);
+        wavecount++;
+    }
+}
+///@}
+#endif
+
+/**
+ * @brief   Capture ring and a copy of the new time stamps
+ */
+///@{
+static uint32_t capturering[CAPTURE_RING] __attribute__((aligned(32)));
+static uint32_t captures[CAPTURE_RING];
+///@}
+
+/**
+ * @brief   Systick routine
+ *
+ * @note    It is called every 1ms
+ */
+static volatile uint32_t tick_ms = 0;
+
+void SysTick_Handler(void) {
+
+    tick_ms++;
+}
+
+/**
+ * @brief   Stop on error
+ */
+static void Check( const char *what, int rc ) {
+
+    if( rc == TIMER_OK )
+        return;
+    printf("%s: error %d\n",what,rc);
+    for(;;) {}
+}
+
+/**
+ * @brief   Frequency measured from the last time stamps
+ *
+ * @note    Returns 0 when there are less than two
+ */
+static uint32_t MeasureFrequency( void ) {
+unsigned n;
+
+    n = Timer_ReadCaptures(TIM2,1,captures,CAPTURE_RING);
+    if( n < 2 || captures[n-1] == captures[0] )
+        return 0;
+    return (uint32_t) ((uint64_t) CAPTURE_TICK*(n-1)/(captures[n-1]-captures[0]));
+}
+
+/**
+ * @brief   main
+ */
+int main(void) {
+Timer_CaptureStats cs;
+#ifdef TIMER_GPIOWAVE
+GPIOWave_Stats ws;
+#endif
+uint32_t last,freq;
+
+    /* configure clock to 200 MHz */
+    SystemConfigMainPLL(&MainPLLConfiguration_200MHz);
+    SystemSetCoreClock(CLOCKSRC_PLL,1);
+
+    SysTick_Config(SystemCoreClock/1000);
+
+    LED_Init();
+
+    // PWM
+    Check("TIM1",Timer_Init(TIM1,PWM_TICK,PWM_PERIOD));
+    Check("TIM1",Timer_ConfigurePWM(TIM1,1,&pwmpin,PWM_PERIOD/4,0));
+    Check("TIM1",Timer_Start(TIM1));
+#ifdef TIMER_SINEPWM
+    Check("TIM1",Timer_StartWaveform(TIM1,1,1,sinetable,64));
+#endif
+
+    // Input capture of the rising edges. The counter wraps every 42 s
+    Check("TIM2",Timer_Init(TIM2,CAPTURE_TICK,0xFFFFFFFF));
+    Check("TIM2",Timer_ConfigureCapture(TIM2,1,&capturepin,TIMER_EDGE_RISING,
+                                        capturering,CAPTURE_RING));
+    Check("TIM2",Timer_Start(TIM2));
+
+    // Encoder
+    Check("TIM3",Timer_ConfigureEncoder(TIM3,&encoderpins[0],&encoderpins[1],0));
+
+    // One pulse: 10 us delay, 100 us width
+    Check("TIM5",Timer_Init(TIM5,1000000,1000));
+    Check("TIM5",Timer_ConfigureOnePulse(TIM5,4,&pulsepin,10,100,
+                                         TIMER_TRIGGER_SOFTWARE,0));
+
+#ifdef TIMER_GPIOWAVE
+    // Parallel output
+    Check("TIM8",GPIOWave_Init(TIM8,GPIOG,WAVE_PINS,WAVE_RATE));
+    Check("TIM8",GPIOWave_StartStream(TIM8,wavebuf[0],wavebuf[1],WAVE_WORDS,
+                                      WaveRefill,0));
+    printf("\nGPIO wave: %lu words/s\n",(unsigned long) GPIOWave_GetRate(TIM8));
+#endif
+
+    printf("\nTimers: PWM %lu Hz, capture tick %lu Hz\n",
+            (unsigned long) (Timer_GetTickFrequency(TIM1)/PWM_PERIOD),
+            (unsigned long) Timer_GetTickFrequency(TIM2));
+
+    last = tick_ms;
+    for(;;) {
+        if( tick_ms-last < 1000 )
+            continue;
+        last = tick_ms;
+        LED_Toggle();
+        Timer_Fire(TIM5);
+        freq = MeasureFrequency();
+        Timer_GetCaptureStats(TIM2,1,&cs);
+        printf("frequency %lu Hz captures %lu overruns %lu encoder %ld\n",
+                (unsigned long) freq,
+                (unsigned long) cs.captures,(unsigned long) cs.overruns,
+                (long) Timer_GetEncoderCount(TIM3));
+#ifdef TIMER_GPIOWAVE
+        GPIOWave_GetStats(TIM8,&ws);
+        printf("wave buffers %lu late %lu errors %lu\n",
+                (unsigned long) ws.buffers,(unsigned long) ws.late,
+                (unsigned long) ws.errors);
+#endif
+    }
+}
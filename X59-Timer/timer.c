@@ -0,0 +1,741 @@
+/**
+ * @file    timer.c
+ *
+ * @brief   PWM, one pulse, encoder and input capture with the timers
+ *
+ * @note    The DMA streams come from dma.c. Input capture and waveforms run
+ *          without interrupts of the timer: the capture rings are followed by
+ *          counting the laps of the stream (transfer complete callback) and
+ *          reading the remaining transfers
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "stm32f746xx.h"
+#include "system_stm32f746.h"
+#include "gpio.h"
+#include "dma.h"
+#include "timer.h"
+
+/**
+ * @brief   Offset of CCR1 in 32 bit words (DBA of the DMA burst)
+ */
+#define CCR1_INDEX                      (13)
+
+/**
+ * @brief   Description of the timers
+ *
+ * @note    NOREQ when the DMA has no request for it
+ */
+///@{
+#define NOREQ                           (-1)
+
+typedef struct {
+    TIM_TypeDef    *tim;
+    uint32_t        enbit;              ///< in APBxENR and APBxRSTR
+    uint8_t         apb2;
+    uint8_t         bits32;
+    uint8_t         nch;
+    uint8_t         advanced;           ///< needs MOE
+    uint8_t         encoder;
+    int8_t          upreq;
+    int8_t          chreq[4];
+} TimerInfo;
+
+static const TimerInfo timertab[] = {
+    { TIM1,  RCC_APB2ENR_TIM1EN,  1, 0, 4, 1, 1, DMA_REQ_TIM1_UP,
+        { DMA_REQ_TIM1_CH1, DMA_REQ_TIM1_CH2, DMA_REQ_TIM1_CH3, DMA_REQ_TIM1_CH4 } },
+    { TIM2,  RCC_APB1ENR_TIM2EN,  0, 1, 4, 0, 1, DMA_REQ_TIM2_UP,
+        { DMA_REQ_TIM2_CH1, DMA_REQ_TIM2_CH2, DMA_REQ_TIM2_CH3, DMA_REQ_TIM2_CH4 } },
+    { TIM3,  RCC_APB1ENR_TIM3EN,  0, 0, 4, 0, 1, DMA_REQ_TIM3_UP,
+        { DMA_REQ_TIM3_CH1, DMA_REQ_TIM3_CH2, DMA_REQ_TIM3_CH3, DMA_REQ_TIM3_CH4 } },
+    { TIM4,  RCC_APB1ENR_TIM4EN,  0, 0, 4, 0, 1, DMA_REQ_TIM4_UP,
+        { DMA_REQ_TIM4_CH1, DMA_REQ_TIM4_CH2, DMA_REQ_TIM4_CH3, NOREQ } },
+    { TIM5,  RCC_APB1ENR_TIM5EN,  0, 1, 4, 0, 1, DMA_REQ_TIM5_UP,
+        { DMA_REQ_TIM5_CH1, DMA_REQ_TIM5_CH2, DMA_REQ_TIM5_CH3, DMA_REQ_TIM5_CH4 } },
+    { TIM8,  RCC_APB2ENR_TIM8EN,  1, 0, 4, 1, 1, DMA_REQ_TIM8_UP,
+        { DMA_REQ_TIM8_CH1, DMA_REQ_TIM8_CH2, DMA_REQ_TIM8_CH3, DMA_REQ_TIM8_CH4 } },
+    { TIM9,  RCC_APB2ENR_TIM9EN,  1, 0, 2, 0, 0, NOREQ, { NOREQ, NOREQ, NOREQ, NOREQ } },
+    { TIM10, RCC_APB2ENR_TIM10EN, 1, 0, 1, 0, 0, NOREQ, { NOREQ, NOREQ, NOREQ, NOREQ } },
+    { TIM11, RCC_APB2ENR_TIM11EN, 1, 0, 1, 0, 0, NOREQ, { NOREQ, NOREQ, NOREQ, NOREQ } },
+    { TIM12, RCC_APB1ENR_TIM12EN, 0, 0, 2, 0, 0, NOREQ, { NOREQ, NOREQ, NOREQ, NOREQ } },
+    { TIM13, RCC_APB1ENR_TIM13EN, 0, 0, 1, 0, 0, NOREQ, { NOREQ, NOREQ, NOREQ, NOREQ } },
+    { TIM14, RCC_APB1ENR_TIM14EN, 0, 0, 1, 0, 0, NOREQ, { NOREQ, NOREQ, NOREQ, NOREQ } },
+};
+#define NTIMERS (sizeof(timertab)/sizeof(timertab[0]))
+///@}
+
+/**
+ * @brief   State of the timers
+ */
+///@{
+typedef struct {
+    int                 initialized;
+    uint32_t            tickfreq;
+    int                 updma;              ///< waveform stream
+    int                 capdma[4];          ///< capture streams
+    uint32_t           *ring[4];
+    unsigned            ringsize[4];
+    volatile uint32_t   laps[4];            ///< times the ring was filled
+    uint64_t            readcount[4];       ///< captures read
+    uint32_t            overruns[4];
+} TimerState;
+
+static TimerState timerstate[NTIMERS];
+///@}
+
+/**
+ * @brief   Index of the timer in timertab (or -1)
+ */
+static int FindTimer( TIM_TypeDef *tim ) {
+unsigned i;
+
+    for(i=0;i<NTIMERS;i++) {
+        if( timertab[i].tim == tim )
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief   Release the DMA streams of a timer
+ */
+static void FreeStreams( int k ) {
+TimerState *s = &timerstate[k];
+unsigned c;
+
+    if( s->updma >= 0 ) {
+        DMA_Stop(s->updma);
+        DMA_Free(s->updma);
+    }
+    s->updma = -1;
+    for(c=0;c<4;c++) {
+        if( s->capdma[c] >= 0 ) {
+            DMA_Stop(s->capdma[c]);
+            DMA_Free(s->capdma[c]);
+        }
+        s->capdma[c] = -1;
+    }
+}
+
+/**
+ * @brief   Enable the clock of the timer and reset it
+ */
+static void Setup( int k ) {
+const TimerInfo *t = &timertab[k];
+unsigned c;
+
+    if( timerstate[k].initialized )
+        FreeStreams(k);
+    else {
+        timerstate[k].updma = -1;
+        for(c=0;c<4;c++)
+            timerstate[k].capdma[c] = -1;
+    }
+
+    if( t->apb2 ) {
+        RCC->APB2ENR |= t->enbit;
+        __DSB();
+        RCC->APB2RSTR |= t->enbit;
+        RCC->APB2RSTR &= ~t->enbit;
+    } else {
+        RCC->APB1ENR |= t->enbit;
+        __DSB();
+        RCC->APB1RSTR |= t->enbit;
+        RCC->APB1RSTR &= ~t->enbit;
+    }
+    if( t->advanced )
+        t->tim->BDTR = TIM_BDTR_MOE;
+    timerstate[k].initialized = 1;
+}
+
+/**
+ * @brief   Set the mode bits of a channel in CCMR1/CCMR2
+ *
+ * @note    v is the low byte of the channel (CCxS, OCxFE, OCxPE, OCxM or ICxF).
+ *          OCxM bit 3 is cleared
+ */
+static void SetCCMR( TIM_TypeDef *tim, unsigned ch, uint32_t v ) {
+volatile uint32_t *ccmr = (ch <= 2) ? &tim->CCMR1 : &tim->CCMR2;
+unsigned shift = ((ch-1)&1)*8;
+
+    *ccmr = (*ccmr&~(0x100FFU<<shift))|(v<<shift);
+}
+
+/**
+ * @brief   Compare/capture register of a channel
+ */
+static inline volatile uint32_t *CCR( TIM_TypeDef *tim, unsigned ch ) {
+
+    return &tim->CCR1+(ch-1);
+}
+
+/**
+ * @brief   Check timer and channel
+ */
+static int CheckChannel( TIM_TypeDef *tim, unsigned ch ) {
+int k;
+
+    k = FindTimer(tim);
+    if( k < 0 || ch < 1 || ch > timertab[k].nch )
+        return TIMER_ERROR_PARAMETER;
+    return k;
+}
+
+/**
+ * @brief  Timer_GetClock
+ *
+ * @note   Clock of the counter before the prescaler
+ */
+uint32_t
+Timer_GetClock( TIM_TypeDef *tim ) {
+uint32_t clk;
+int k;
+
+    k = FindTimer(tim);
+    if( k < 0 )
+        return 0;
+    if( timertab[k].apb2 ) {
+        clk = SystemGetAPB2Frequency();
+        if( SystemGetAPB2Prescaler() != 1 )
+            clk *= 2;
+    } else {
+        clk = SystemGetAPB1Frequency();
+        if( SystemGetAPB1Prescaler() != 1 )
+            clk *= 2;
+    }
+    return clk;
+}
+
+/**
+ * @brief  Timer_Init
+ *
+ * @note   The counter runs at tickfreq (rounded to a divisor of the timer
+ *         clock) and counts period ticks (2 to 65536, or 2^32 for TIM2 and
+ *         TIM5). The timer is stopped and all its channels are disabled
+ */
+int
+Timer_Init( TIM_TypeDef *tim, uint32_t tickfreq, uint32_t period ) {
+uint32_t clk,psc;
+int k;
+
+    k = FindTimer(tim);
+    if( k < 0 || period < 2 || (!timertab[k].bits32 && period > 65536) )
+        return TIMER_ERROR_PARAMETER;
+    clk = Timer_GetClock(tim);
+    if( tickfreq == 0 || tickfreq > clk )
+        return TIMER_ERROR_FREQUENCY;
+    psc = (clk+tickfreq/2)/tickfreq;
+    if( psc > 65536 )
+        return TIMER_ERROR_FREQUENCY;
+
+    Setup(k);
+    tim->PSC = psc-1;
+    tim->ARR = period-1;
+    tim->CR1 = TIM_CR1_ARPE;
+    // Load the prescaler now, without a pending update flag
+    tim->EGR = TIM_EGR_UG;
+    tim->SR  = 0;
+    timerstate[k].tickfreq = clk/psc;
+    return TIMER_OK;
+}
+
+/**
+ * @brief  Timer_GetTickFrequency
+ */
+uint32_t
+Timer_GetTickFrequency( TIM_TypeDef *tim ) {
+int k;
+
+    k = FindTimer(tim);
+    if( k < 0 || !timerstate[k].initialized )
+        return 0;
+    return timerstate[k].tickfreq;
+}
+
+/**
+ * @brief  Timer_SetPeriod
+ *
+ * @note   Used at the next update (preloaded)
+ */
+int
+Timer_SetPeriod( TIM_TypeDef *tim, uint32_t period ) {
+int k;
+
+    k = FindTimer(tim);
+    if( k < 0 || period < 2 || (!timertab[k].bits32 && period > 65536) )
+        return TIMER_ERROR_PARAMETER;
+    tim->ARR = period-1;
+    return TIMER_OK;
+}
+
+/**
+ * @brief  Timer_Start
+ */
+int
+Timer_Start( TIM_TypeDef *tim ) {
+int k;
+
+    k = FindTimer(tim);
+    if( k < 0 )
+        return TIMER_ERROR_PARAMETER;
+    if( !timerstate[k].initialized )
+        return TIMER_ERROR_NOTINITIALIZED;
+    tim->CR1 |= TIM_CR1_CEN;
+    return TIMER_OK;
+}
+
+/**
+ * @brief  Timer_Stop
+ *
+ * @note   Outputs keep their level
+ */
+void
+Timer_Stop( TIM_TypeDef *tim ) {
+
+    if( FindTimer(tim) >= 0 )
+        tim->CR1 &= ~TIM_CR1_CEN;
+}
+
+/**
+ * @brief  Timer_ConfigurePWM
+ *
+ * @note   PWM mode 1: the output is active while the counter is below pulse.
+ *         pulse = 0 gives 0% and pulse >= period gives 100%. The compare
+ *         register is preloaded, so changes happen at the update
+ *
+ * @note   TIMER_FLAG_CENTERALIGNED changes the counting of the whole timer
+ *         (the PWM frequency is halved) and must be set while it is stopped
+ */
+int
+Timer_ConfigurePWM( TIM_TypeDef *tim, unsigned ch, const GPIO_PinConfiguration *pin,
+                    uint32_t pulse, unsigned flags ) {
+unsigned pos;
+int k;
+
+    k = CheckChannel(tim,ch);
+    if( k < 0 )
+        return k;
+    if( !timerstate[k].initialized )
+        return TIMER_ERROR_NOTINITIALIZED;
+
+    pos = 4*(ch-1);
+    tim->CCER &= ~(0xFU<<pos);
+    SetCCMR(tim,ch,(6U<<TIM_CCMR1_OC1M_Pos)|TIM_CCMR1_OC1PE);
+    *CCR(tim,ch) = pulse;
+    if( flags&TIMER_FLAG_CENTERALIGNED )
+        tim->CR1 = (tim->CR1&~TIM_CR1_CMS)|(1U<<TIM_CR1_CMS_Pos);
+    tim->CCER |= (TIM_CCER_CC1E|((flags&TIMER_FLAG_INVERTED) ? TIM_CCER_CC1P : 0))<<pos;
+    if( pin )
+        GPIO_ConfigureSinglePin(pin);
+    return TIMER_OK;
+}
+
+/**
+ * @brief  Timer_SetPulse
+ */
+int
+Timer_SetPulse( TIM_TypeDef *tim, unsigned ch, uint32_t pulse ) {
+int k;
+
+    k = CheckChannel(tim,ch);
+    if( k < 0 )
+        return k;
+    *CCR(tim,ch) = pulse;
+    return TIMER_OK;
+}
+
+/**
+ * @brief  Timer_ConfigureOnePulse
+ *
+ * @note   After the trigger, the output goes active delay ticks later (at
+ *         least 1) and stays active for width ticks. Then the counter stops.
+ *         The period of Timer_Init is replaced by delay+width
+ *
+ * @note   With TIMER_TRIGGER_TI1 or TI2, the counter is started by a rising
+ *         edge at trigpin, that must be channel 1 or 2 of the same timer and
+ *         not the output channel. The fast mode of the output is enabled, so
+ *         the delay counts from the edge
+ */
+int
+Timer_ConfigureOnePulse( TIM_TypeDef *tim, unsigned ch, const GPIO_PinConfiguration *pin,
+                         uint32_t delay, uint32_t width, int trigger,
+                         const GPIO_PinConfiguration *trigpin ) {
+uint32_t period;
+unsigned pos;
+int k;
+
+    k = CheckChannel(tim,ch);
+    if( k < 0 )
+        return k;
+    if( !timerstate[k].initialized )
+        return TIMER_ERROR_NOTINITIALIZED;
+    period = delay+width;
+    if( delay == 0 || width == 0 || period < delay
+        || (!timertab[k].bits32 && period > 65536) )
+        return TIMER_ERROR_PARAMETER;
+    if( (trigger == TIMER_TRIGGER_TI1 && ch == 1) || (trigger == TIMER_TRIGGER_TI2 && ch == 2) )
+        return TIMER_ERROR_PARAMETER;
+    if( trigger != TIMER_TRIGGER_SOFTWARE && timertab[k].nch < 2 )
+        return TIMER_ERROR_NOTSUPPORTED;
+
+    tim->CR1 &= ~TIM_CR1_CEN;
+    tim->ARR  = period-1;
+    tim->CNT  = 0;
+    pos = 4*(ch-1);
+    tim->CCER &= ~(0xFU<<pos);
+    *CCR(tim,ch) = delay;
+    // PWM mode 2: inactive while the counter is below delay
+    SetCCMR(tim,ch,(7U<<TIM_CCMR1_OC1M_Pos)
+                  |((trigger != TIMER_TRIGGER_SOFTWARE) ? TIM_CCMR1_OC1FE : 0));
+    tim->EGR  = TIM_EGR_UG;
+    tim->SR   = 0;
+    tim->CR1 |= TIM_CR1_OPM;
+
+    switch( trigger ) {
+    case TIMER_TRIGGER_SOFTWARE:
+        tim->SMCR = 0;
+        break;
+    case TIMER_TRIGGER_TI1:
+        SetCCMR(tim,1,1U<<TIM_CCMR1_CC1S_Pos);
+        tim->CCER &= ~(TIM_CCER_CC1P|TIM_CCER_CC1NP);
+        tim->SMCR  = (5U<<TIM_SMCR_TS_Pos)|(6U<<TIM_SMCR_SMS_Pos);
+        break;
+    case TIMER_TRIGGER_TI2:
+        SetCCMR(tim,2,1U<<TIM_CCMR1_CC1S_Pos);
+        tim->CCER &= ~(TIM_CCER_CC2P|TIM_CCER_CC2NP);
+        tim->SMCR  = (6U<<TIM_SMCR_TS_Pos)|(6U<<TIM_SMCR_SMS_Pos);
+        break;
+    default:
+        return TIMER_ERROR_PARAMETER;
+    }
+
+    tim->CCER |= TIM_CCER_CC1E<<pos;
+    if( pin )
+        GPIO_ConfigureSinglePin(pin);
+    if( trigpin && trigger != TIMER_TRIGGER_SOFTWARE )
+        GPIO_ConfigureSinglePin(trigpin);
+    return TIMER_OK;
+}
+
+/**
+ * @brief  Timer_Fire
+ *
+ * @note   Starts a pulse (software trigger). Ignored while a pulse is running
+ */
+int
+Timer_Fire( TIM_TypeDef *tim ) {
+
+    if( FindTimer(tim) < 0 )
+        return TIMER_ERROR_PARAMETER;
+    if( (tim->CR1&TIM_CR1_CEN) == 0 )
+        tim->CR1 |= TIM_CR1_CEN;
+    return TIMER_OK;
+}
+
+/**
+ * @brief  Timer_ConfigureEncoder
+ *
+ * @note   Channels 1 and 2 count the quadrature signal of pin1 and pin2 (4
+ *         counts per cycle, 2 with TIMER_FLAG_X2). The counter is cleared and
+ *         started. Timer_Init is not needed
+ */
+int
+Timer_ConfigureEncoder( TIM_TypeDef *tim, const GPIO_PinConfiguration *pin1,
+                        const GPIO_PinConfiguration *pin2, unsigned flags ) {
+int k;
+
+    k = FindTimer(tim);
+    if( k < 0 )
+        return TIMER_ERROR_PARAMETER;
+    if( !timertab[k].encoder )
+        return TIMER_ERROR_NOTSUPPORTED;
+
+    Setup(k);
+    tim->PSC   = 0;
+    tim->ARR   = timertab[k].bits32 ? 0xFFFFFFFF : 0xFFFF;
+    tim->CCMR1 = (1U<<TIM_CCMR1_CC1S_Pos)|(TIMER_ENCODER_FILTER<<TIM_CCMR1_IC1F_Pos)
+                |(1U<<TIM_CCMR1_CC2S_Pos)|(TIMER_ENCODER_FILTER<<TIM_CCMR1_IC2F_Pos);
+    tim->CCER  = (flags&TIMER_FLAG_INVERTED) ? TIM_CCER_CC1P : 0;
+    tim->SMCR  = ((flags&TIMER_FLAG_X2) ? 1U : 3U)<<TIM_SMCR_SMS_Pos;
+    tim->EGR   = TIM_EGR_UG;
+    tim->CNT   = 0;
+    timerstate[k].tickfreq = 0;
+    if( pin1 )
+        GPIO_ConfigureSinglePin(pin1);
+    if( pin2 )
+        GPIO_ConfigureSinglePin(pin2);
+    tim->CR1   = TIM_CR1_CEN;
+    return TIMER_OK;
+}
+
+/**
+ * @brief  Timer_GetEncoderCount
+ *
+ * @note   Signed, so that it goes negative when turning backwards from 0
+ */
+int32_t
+Timer_GetEncoderCount( TIM_TypeDef *tim ) {
+int k;
+
+    k = FindTimer(tim);
+    if( k < 0 )
+        return 0;
+    if( timertab[k].bits32 )
+        return (int32_t) tim->CNT;
+    return (int16_t) tim->CNT;
+}
+
+/**
+ * @brief   Transfer complete of a capture ring
+ *
+ * @note    arg is the timer index times 4 plus the channel index
+ */
+static void CaptureDone( void *arg, int event ) {
+unsigned id = (unsigned) (uintptr_t) arg;
+
+    if( event == DMA_EVENT_FULL )
+        timerstate[id/4].laps[id%4]++;
+}
+
+/**
+ * @brief   Number of captures written in a ring since it was started
+ *
+ * @note    The laps are read again, in case the ring wrapped meanwhile
+ */
+static uint64_t Written( int k, unsigned c ) {
+TimerState *s = &timerstate[k];
+uint32_t laps,rem;
+
+    do {
+        laps = s->laps[c];
+        rem  = DMA_Remaining(s->capdma[c]);
+    } while( laps != s->laps[c] );
+    return (uint64_t) laps*s->ringsize[c]+(s->ringsize[c]-rem);
+}
+
+/**
+ * @brief  Timer_ConfigureCapture
+ *
+ * @note   The counter is captured at each edge of pin and a DMA stream copies
+ *         it into ring (n values, circular). The ring is in words for all
+ *         timers and should be aligned and padded to 32 bytes (cache line),
+ *         because it is invalidated before it is read
+ *
+ * @note   Timer_Init must be called before (the tick is the resolution of the
+ *         time stamps and the period is their range) and Timer_Start after
+ */
+int
+Timer_ConfigureCapture( TIM_TypeDef *tim, unsigned ch, const GPIO_PinConfiguration *pin,
+                        int edge, uint32_t *ring, unsigned n ) {
+TimerState *s;
+DMA_Config conf;
+uint32_t pol;
+unsigned pos,c;
+int k,h;
+
+    k = CheckChannel(tim,ch);
+    if( k < 0 )
+        return k;
+    s = &timerstate[k];
+    if( !s->initialized )
+        return TIMER_ERROR_NOTINITIALIZED;
+    if( ring == 0 || n == 0 || n > 65535 )
+        return TIMER_ERROR_PARAMETER;
+    switch( edge ) {
+    case TIMER_EDGE_RISING:  pol = 0;                            break;
+    case TIMER_EDGE_FALLING: pol = TIM_CCER_CC1P;                break;
+    case TIMER_EDGE_BOTH:    pol = TIM_CCER_CC1P|TIM_CCER_CC1NP; break;
+    default:                 return TIMER_ERROR_PARAMETER;
+    }
+    c = ch-1;
+    if( timertab[k].chreq[c] == NOREQ )
+        return TIMER_ERROR_NOTSUPPORTED;
+
+    if( s->capdma[c] < 0 ) {
+        h = DMA_Allocate(timertab[k].chreq[c]);
+        if( h < 0 )
+            return TIMER_ERROR_DMA;
+        s->capdma[c] = h;
+    }
+    h = s->capdma[c];
+    conf.dir      = DMA_DIR_P2M;
+    conf.periph   = CCR(tim,ch);
+    conf.psize    = DMA_SIZE_32;
+    conf.msize    = DMA_SIZE_32;
+    conf.burst    = DMA_BURST_SINGLE;
+    conf.priority = 2;
+    conf.flags    = DMA_FLAG_MINC|DMA_FLAG_CIRCULAR;
+    conf.callback = CaptureDone;
+    conf.arg      = (void *) (uintptr_t) (k*4+c);
+    if( DMA_Configure(h,&conf) < 0 )
+        return TIMER_ERROR_DMA;
+
+    pos = 4*c;
+    tim->DIER &= ~(TIM_DIER_CC1DE<<c);
+    tim->CCER &= ~(0xFU<<pos);
+    SetCCMR(tim,ch,1U<<TIM_CCMR1_CC1S_Pos);
+
+    s->ring[c]      = ring;
+    s->ringsize[c]  = n;
+    s->laps[c]      = 0;
+    s->readcount[c] = 0;
+    s->overruns[c]  = 0;
+    if( DMA_Start(h,ring,ring,n) < 0 )
+        return TIMER_ERROR_DMA;
+
+    if( pin )
+        GPIO_ConfigureSinglePin(pin);
+    tim->CCER |= (TIM_CCER_CC1E|pol)<<pos;
+    tim->DIER |= TIM_DIER_CC1DE<<c;
+    return TIMER_OK;
+}
+
+/**
+ * @brief  Timer_ReadCaptures
+ *
+ * @note   Copies up to max new time stamps to out, oldest first, and returns
+ *         how many. When the ring was overwritten, the lost ones are counted
+ *         and the oldest still in the ring comes first
+ */
+unsigned
+Timer_ReadCaptures( TIM_TypeDef *tim, unsigned ch, uint32_t *out, unsigned max ) {
+TimerState *s;
+uint64_t written;
+unsigned c,n,i,pos,avail;
+int k;
+
+    k = CheckChannel(tim,ch);
+    if( k < 0 )
+        return 0;
+    s = &timerstate[k];
+    c = ch-1;
+    if( !s->initialized || s->capdma[c] < 0 )
+        return 0;
+
+    n = s->ringsize[c];
+    written = Written(k,c);
+    if( written <= s->readcount[c] )
+        return 0;
+    if( written-s->readcount[c] > n ) {
+        s->overruns[c] += (uint32_t) (written-s->readcount[c]-n);
+        s->readcount[c] = written-n;
+    }
+    avail = (unsigned) (written-s->readcount[c]);
+    if( avail > max )
+        avail = max;
+
+    SCB_InvalidateDCache_by_Addr(s->ring[c],n*sizeof(uint32_t));
+    pos = (unsigned) (s->readcount[c]%n);
+    for(i=0;i<avail;i++) {
+        out[i] = s->ring[c][pos];
+        if( ++pos == n )
+            pos = 0;
+    }
+    s->readcount[c] += avail;
+    return avail;
+}
+
+/**
+ * @brief  Timer_GetCaptureStats
+ */
+int
+Timer_GetCaptureStats( TIM_TypeDef *tim, unsigned ch, Timer_CaptureStats *st ) {
+TimerState *s;
+int k;
+
+    k = CheckChannel(tim,ch);
+    if( k < 0 )
+        return k;
+    s = &timerstate[k];
+    if( !s->initialized || s->capdma[ch-1] < 0 )
+        return TIMER_ERROR_NOTINITIALIZED;
+    st->captures = (uint32_t) Written(k,ch-1);
+    st->overruns = s->overruns[ch-1];
+    return TIMER_OK;
+}
+
+/**
+ * @brief  Timer_StartWaveform
+ *
+ * @note   At each update, the DMA writes nch values of table into CCRch to
+ *         CCRch+nch-1 (DMA burst thru DMAR). table has nupdates groups of nch
+ *         values and is read in circular mode, so the waveform has nupdates
+ *         periods. The channels must be configured (e.g. PWM) and the timer
+ *         started. table is cleaned from the data cache here and must not
+ *         change while the waveform runs
+ */
+int
+Timer_StartWaveform( TIM_TypeDef *tim, unsigned ch, unsigned nch,
+                     const uint32_t *table, unsigned nupdates ) {
+TimerState *s;
+DMA_Config conf;
+uint32_t n,a;
+int k,h;
+
+    k = CheckChannel(tim,ch);
+    if( k < 0 )
+        return k;
+    s = &timerstate[k];
+    if( !s->initialized )
+        return TIMER_ERROR_NOTINITIALIZED;
+    if( nch == 0 || ch+nch-1 > timertab[k].nch || table == 0 || nupdates == 0 )
+        return TIMER_ERROR_PARAMETER;
+    n = nupdates*nch;
+    if( n > 65535 )
+        return TIMER_ERROR_PARAMETER;
+    if( timertab[k].upreq == NOREQ )
+        return TIMER_ERROR_NOTSUPPORTED;
+
+    Timer_StopWaveform(tim);
+    h = DMA_Allocate(timertab[k].upreq);
+    if( h < 0 )
+        return TIMER_ERROR_DMA;
+    conf.dir      = DMA_DIR_M2P;
+    conf.periph   = &tim->DMAR;
+    conf.psize    = DMA_SIZE_32;
+    conf.msize    = DMA_SIZE_32;
+    conf.burst    = DMA_BURST_SINGLE;
+    conf.priority = 2;
+    conf.flags    = DMA_FLAG_MINC|DMA_FLAG_CIRCULAR;
+    conf.callback = 0;
+    conf.arg      = 0;
+    if( DMA_Configure(h,&conf) < 0 ) {
+        DMA_Free(h);
+        return TIMER_ERROR_DMA;
+    }
+    s->updma = h;
+
+    a = (uint32_t) table;
+    SCB_CleanDCache_by_Addr((uint32_t *) (a&~31U),n*sizeof(uint32_t)+(a&31U));
+
+    tim->DCR = ((CCR1_INDEX+ch-1)<<TIM_DCR_DBA_Pos)|((nch-1)<<TIM_DCR_DBL_Pos);
+    if( DMA_Start(h,(void *) table,(void *) table,n) < 0 )
+        return TIMER_ERROR_DMA;
+    tim->DIER |= TIM_DIER_UDE;
+    return TIMER_OK;
+}
+
+/**
+ * @brief  Timer_StopWaveform
+ *
+ * @note   The compare registers keep the last values written
+ */
+void
+Timer_StopWaveform( TIM_TypeDef *tim ) {
+TimerState *s;
+int k;
+
+    k = FindTimer(tim);
+    if( k < 0 )
+        return;
+    s = &timerstate[k];
+    tim->DIER &= ~TIM_DIER_UDE;
+    if( s->initialized && s->updma >= 0 ) {
+        DMA_Stop(s->updma);
+        DMA_Free(s->updma);
+        s->updma = -1;
+    }
+}
@@ -0,0 +1,143 @@
+#ifndef TIMER_H
+#define TIMER_H
+/**
+ * @file    timer.h
+ *
+ * @brief   PWM, one pulse, encoder and input capture with the timers
+ *
+ * @note    Timer_Init sets the counter clock (tickfreq) and the period (in
+ *          ticks) of a timer. Then its channels are configured for one use:
+ *          - PWM: edge aligned (or center aligned for the whole timer) PWM
+ *            with preloaded compare registers
+ *          - One pulse: a pulse of width ticks, delay ticks after a software
+ *            trigger (Timer_Fire) or an edge at TI1/TI2
+ *          - Encoder: quadrature counting of TI1 and TI2 (channels 1 and 2)
+ *          - Input capture: the counter is stored at each edge and a DMA
+ *            stream copies it to a ring buffer, without interrupts
+ *
+ * @note    Waveforms: Timer_StartWaveform makes a DMA stream write the compare
+ *          registers of consecutive channels at each update, using the DMA
+ *          burst of the timer (DCR/DMAR). The table is read in circular mode,
+ *          so the waveform repeats without CPU intervention
+ *
+ * @note    Supported timers
+ *
+ * | Timer      | Bits | Channels | Bus  | Encoder | DMA             |
+ * |------------|------|----------|------|---------|-----------------|
+ * | TIM1, TIM8 | 16   | 4        | APB2 | yes     | update, CH1-CH4 |
+ * | TIM2, TIM5 | 32   | 4        | APB1 | yes     | update, CH1-CH4 |
+ * | TIM3       | 16   | 4        | APB1 | yes     | update, CH1-CH4 |
+ * | TIM4       | 16   | 4        | APB1 | yes     | update, CH1-CH3 |
+ * | TIM9       | 16   | 2        | APB2 | no      | no              |
+ * | TIM10,11   | 16   | 1        | APB2 | no      | no              |
+ * | TIM12      | 16   | 2        | APB1 | no      | no              |
+ * | TIM13,14   | 16   | 1        | APB1 | no      | no              |
+ *
+ * @note    The pins are given by the caller, with their alternate function.
+ *          On the Arduino connector: D3 PB4 (TIM3_CH1, AF2), D5 PI0 (TIM5_CH4,
+ *          AF2), D6 PH6 (TIM12_CH1, AF9), D9 PA15 (TIM2_CH1, AF1), D10 PA8
+ *          (TIM1_CH1, AF1), D11 PB15 (TIM12_CH2, AF9), D0 PC7 (TIM3_CH2, AF2)
+ *
+ * @note    The timer clock is twice the APB clock when the APB prescaler is
+ *          not 1 (TIMPRE = 0). With the core at 200 MHz, it is 100 MHz for the
+ *          APB1 timers and 200 MHz for the APB2 timers
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdint.h>
+#include "stm32f746xx.h"
+#include "gpio.h"
+
+/**
+ * @brief   Flags for Timer_ConfigurePWM and Timer_ConfigureEncoder
+ */
+///@{
+#define TIMER_FLAG_INVERTED             (1U<<0) ///< active low output or inverted TI1
+#define TIMER_FLAG_CENTERALIGNED        (1U<<1) ///< PWM: counter up and down (whole timer)
+#define TIMER_FLAG_X2                   (1U<<2) ///< encoder: count only the TI1 edges
+///@}
+
+/**
+ * @brief   Triggers of the one pulse mode
+ */
+///@{
+#define TIMER_TRIGGER_SOFTWARE          (0)
+#define TIMER_TRIGGER_TI1               (1)     ///< rising edge at channel 1 input
+#define TIMER_TRIGGER_TI2               (2)     ///< rising edge at channel 2 input
+///@}
+
+/**
+ * @brief   Edges for input capture
+ */
+///@{
+#define TIMER_EDGE_RISING               (0)
+#define TIMER_EDGE_FALLING              (1)
+#define TIMER_EDGE_BOTH                 (2)
+///@}
+
+/**
+ * @brief   Input filter of the encoder inputs (IC1F/IC2F: 8 samples at the
+ *          timer clock)
+ */
+#ifndef TIMER_ENCODER_FILTER
+#define TIMER_ENCODER_FILTER            (3)
+#endif
+
+/**
+ * @brief   Return values
+ */
+///@{
+#define TIMER_OK                        (0)
+#define TIMER_ERROR_PARAMETER           (-1)
+#define TIMER_ERROR_FREQUENCY           (-2)    ///< tick frequency not reachable
+#define TIMER_ERROR_DMA                 (-3)    ///< no stream or no request
+#define TIMER_ERROR_NOTSUPPORTED        (-4)    ///< not available in this timer
+#define TIMER_ERROR_NOTINITIALIZED      (-5)
+///@}
+
+/**
+ * @brief   Statistics of an input capture ring
+ */
+typedef struct {
+    uint32_t    captures;                   ///< edges stored by the DMA
+    uint32_t    overruns;                   ///< edges overwritten before read
+} Timer_CaptureStats;
+
+int      Timer_Init( TIM_TypeDef *tim, uint32_t tickfreq, uint32_t period );
+uint32_t Timer_GetTickFrequency( TIM_TypeDef *tim );
+uint32_t Timer_GetClock( TIM_TypeDef *tim );
+int      Timer_SetPeriod( TIM_TypeDef *tim, uint32_t period );
+int      Timer_Start( TIM_TypeDef *tim );
+void     Timer_Stop( TIM_TypeDef *tim );
+
+int      Timer_ConfigurePWM( TIM_TypeDef *tim, unsigned ch,
+                             const GPIO_PinConfiguration *pin,
+                             uint32_t pulse, unsigned flags );
+int      Timer_SetPulse( TIM_TypeDef *tim, unsigned ch, uint32_t pulse );
+
+int      Timer_ConfigureOnePulse( TIM_TypeDef *tim, unsigned ch,
+                                  const GPIO_PinConfiguration *pin,
+                                  uint32_t delay, uint32_t width,
+                                  int trigger,
+                                  const GPIO_PinConfiguration *trigpin );
+int      Timer_Fire( TIM_TypeDef *tim );
+
+int      Timer_ConfigureEncoder( TIM_TypeDef *tim,
+                                 const GPIO_PinConfiguration *pin1,
+                                 const GPIO_PinConfiguration *pin2,
+                                 unsigned flags );
+int32_t  Timer_GetEncoderCount( TIM_TypeDef *tim );
+
+int      Timer_ConfigureCapture( TIM_TypeDef *tim, unsigned ch,
+                                 const GPIO_PinConfiguration *pin, int edge,
+                                 uint32_t *ring, unsigned n );
+unsigned Timer_ReadCaptures( TIM_TypeDef *tim, unsigned ch, uint32_t *out, unsigned max );
+int      Timer_GetCaptureStats( TIM_TypeDef *tim, unsigned ch, Timer_CaptureStats *s );
+
+int      Timer_StartWaveform( TIM_TypeDef *tim, unsigned ch, unsigned nch,
+                              const uint32_t *table, unsigned nupdates );
+void     Timer_StopWaveform( TIM_TypeDef *tim );
+
+#endif // TIMER_H
@@ -0,0 +1,599 @@
+/**
+ * @file    hostbench.c
+ *
+ * @note    Micro benchmarks of the modules without hardware dependencies, built
+ *          for the host from the sources of their projects
+ *
+ *          | Module        | Project               |
+ *          |---------------|-----------------------|
+ *          | buddy.c       | 23-Buddy              |
+ *          | bitvector.h   | 23-Buddy              |
+ *          | fifo.c        | 14-Newlib             |
+ *          | conversions.c | 11-Conversions        |
+ *          | ministdio.c   | 12-Ministdio          |
+ *          | tte.c         | 15-TimeTriggered-v1   |
+ *
+ *          tte-v2.c is not included, because it uses the SysTick and PendSV
+ *          registers
+ *
+ * @note    Host program. Built with make host (Makefile at the top). Usage
+ *
+ *          hostbench [-f filter] [-t ms]
+ *
+ *          Each benchmark whose name contains filter is run with 1, 10, 100...
+ *          iterations until it takes at least ms (default 200) and prints the
+ *          time per iteration. Before the timing, each module is checked against
+ *          the C library (or an invariant for buddy.c and fifo.c). The number of
+ *          failed checks is printed at the end and is the exit status, so an
+ *          optimization that changes a result is found before flashing
+ *
+ * @note    The host is much faster than the Cortex-M7 and has other caches, so
+ *          only the ratios between versions of a module are meaningful
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "buddy.h"
+#include "bitvector.h"
+#include "fifo.h"
+#include "conversions.h"
+#include "tte.h"
+
+/**
+ * @brief   ministdio.h is not included, because it renames the stdio functions
+ */
+///@{
+int minisnprintf(char *s, int n, const char *fmt, ...);
+int miniputchar(int c)  { return c; }
+int minigetchar(void)   { return -1; }
+///@}
+
+/**
+ * @brief   Options
+ */
+///@{
+static const char   *filter  = "";
+static double       mintime  = 0.2;
+///@}
+
+/**
+ * @brief   Results of the checks
+ */
+///@{
+static int          failures = 0;
+
+#define CHECK(COND,...) do { if( !(COND) ) { failures++;                            \
+                            printf("FAILED %s:%d ",__FILE__,__LINE__);              \
+                            printf(__VA_ARGS__); printf("\n"); } } while(0)
+///@}
+
+/**
+ * @brief   Keeps the compiler from removing the benchmarked code
+ */
+static volatile uint32_t sink;
+
+/**
+ * @brief   now
+ */
+static double
+now(void) {
+struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec+ts.tv_nsec*1e-9;
+}
+
+/**
+ * @brief   Runs a benchmark
+ *
+ * @note    The number of iterations is multiplied by 10 until the run takes at
+ *          least mintime
+ */
+static void
+bench(const char *name, void (*f)(long n)) {
+double t0,t;
+long n;
+
+    if( !strstr(name,filter) )
+        return;
+    for(n=1;;n*=10) {
+        t0 = now();
+        f(n);
+        t = now()-t0;
+        if( t >= mintime || n >= 1000000000L )
+            break;
+    }
+    printf("%-36s %12ld %12.1f ns\n",name,n,t*1e9/n);
+}
+
+/**
+ * @brief   Pseudo random numbers (xorshift32)
+ */
+///@{
+static uint32_t seed = 2463534242U;
+
+static uint32_t
+rnd(void) {
+
+    seed ^= seed<<13;
+    seed ^= seed>>17;
+    seed ^= seed<<5;
+    return seed;
+}
+///@}
+
+/**
+ * @brief   Values for the conversions
+ */
+///@{
+#define NVALUES     256
+
+static int      ivalues[NVALUES];
+static double   dvalues[NVALUES];
+static char     istrings[NVALUES][16];
+
+static void
+initvalues(void) {
+int i;
+
+    for(i=0;i<NVALUES;i++) {
+        ivalues[i] = (int) rnd()>>(rnd()%31);
+        dvalues[i] = ((int) rnd())/(double) (1+(rnd()%100000))*((rnd()&1)?1e-3:1e3);
+        sprintf(istrings[i],"%d",ivalues[i]);
+    }
+}
+///@}
+
+/**
+ * @brief   buddy.c
+ */
+///@{
+#define POOLSIZE    (1024*1024)
+#define POOLMIN     (32)
+#define NBLOCKS     (256)
+
+static char     *poolarea;
+static POOL     pool;
+static void     *blocks[NBLOCKS];
+
+static void
+checkbuddy(void) {
+BUDDY_Stats st0,st;
+unsigned size[NBLOCKS];
+int i,k;
+
+    poolarea = aligned_alloc(POOLSIZE,POOLSIZE);
+    pool     = Buddy_CreatePool(poolarea,POOLSIZE,POOLMIN);
+    CHECK(pool != 0,"Buddy_CreatePool");
+    if( !pool )
+        exit(1);
+    Buddy_GetPoolStats(pool,&st0);          // the bit vectors may use the area
+    for(k=0;k<4;k++) {
+        for(i=0;i<NBLOCKS;i++) {
+            size[i]   = 1+rnd()%2048;
+            blocks[i] = Buddy_AllocFrom(pool,size[i]);
+            CHECK(blocks[i] != 0,"Buddy_AllocFrom(%u)",size[i]);
+            if( blocks[i] )
+                memset(blocks[i],i,size[i]);
+        }
+        for(i=0;i<NBLOCKS;i++) {
+            if( !blocks[i] )
+                continue;
+            CHECK(Buddy_BlockSize(pool,blocks[i]) >= (long) size[i],"Buddy_BlockSize");
+            CHECK(((unsigned char *) blocks[i])[0] == (unsigned char) i
+                  && ((unsigned char *) blocks[i])[size[i]-1] == (unsigned char) i,
+                  "block %d overwritten",i);
+        }
+        for(i=(k&1);i<NBLOCKS;i+=2)
+            Buddy_FreeTo(pool,blocks[i]);
+        for(i=1-(k&1);i<NBLOCKS;i+=2)
+            Buddy_FreeTo(pool,blocks[i]);
+    }
+    Buddy_GetPoolStats(pool,&st);
+    CHECK(st.inuse == st0.inuse,"inuse %ld after freeing all",st.inuse);
+    CHECK(st.largestfree == st0.largestfree,"largest free %ld",st.largestfree);
+}
+
+static void
+benchbuddyfixed(long n) {
+long i;
+
+    for(i=0;i<n;i++) {
+        void *p = Buddy_AllocFrom(pool,64);
+        Buddy_FreeTo(pool,p);
+    }
+}
+
+static void
+benchbuddyrandom(long n) {
+long i;
+int k;
+
+    for(i=0;i<n;i++) {
+        k = rnd()%NBLOCKS;
+        if( blocks[k] )
+            Buddy_FreeTo(pool,blocks[k]);
+        blocks[k] = Buddy_AllocFrom(pool,1+rnd()%2048);
+    }
+}
+
+static void
+benchmallocrandom(long n) {
+long i;
+int k;
+
+    for(i=0;i<n;i++) {
+        k = rnd()%NBLOCKS;
+        free(blocks[k]);
+        blocks[k] = malloc(1+rnd()%2048);
+    }
+}
+///@}
+
+/**
+ * @brief   bitvector.h
+ */
+///@{
+#define NBITS       4096
+
+static BV_TYPE  bits[BV_SIZE(NBITS)];
+
+static void
+checkbitvector(void) {
+int i;
+
+    bv_clearall(bits,NBITS);
+    for(i=0;i<NBITS;i+=3)
+        bv_set(bits,i);
+    for(i=0;i<NBITS;i++)
+        CHECK((bv_test(bits,i) != 0) == (i%3 == 0),"bit %d",i);
+    for(i=0;i<NBITS;i+=3)
+        bv_clear(bits,i);
+    for(i=0;i<BV_SIZE(NBITS);i++)
+        CHECK(bits[i] == 0,"word %d",i);
+}
+
+static void
+benchbitvector(long n) {
+long i;
+uint32_t s = 0;
+
+    for(i=0;i<n;i++) {
+        int b = i&(NBITS-1);
+        bv_set(bits,b);
+        s += bv_test(bits,b^1) != 0;
+        bv_clear(bits,b);
+    }
+    sink = s;
+}
+///@}
+
+/**
+ * @brief   fifo.c
+ */
+///@{
+static DECLARE_FIFO_AREA(fifoarea,256);
+static FIFO fifo;
+
+static void
+checkfifo(void) {
+char buf[100];
+char out[100];
+int i,k,n,m;
+char c = 0;
+char e = 0;
+
+    fifo = fifo_init(fifoarea,256);
+    CHECK(fifo != 0 && fifo_capacity(fifo) == 256,"fifo_init");
+    for(k=0;k<1000;k++) {
+        n = 1+rnd()%100;
+        for(i=0;i<n;i++)
+            buf[i] = c++;
+        m = fifo_write(fifo,buf,n);
+        c -= n-m;
+        CHECK(fifo_size(fifo) <= 256,"size %d",fifo_size(fifo));
+        n = fifo_read(fifo,out,1+rnd()%100);
+        for(i=0;i<n;i++,e++)
+            CHECK(out[i] == e,"order");
+    }
+    fifo_clear(fifo);
+    for(i=0;i<300;i++)
+        fifo_insert(fifo,i);
+    CHECK(fifo_full(fifo),"not full after 300 inserts");
+    CHECK(fifo_remove(fifo) == 0,"first char");
+}
+
+static void
+benchfifochar(long n) {
+long i;
+uint32_t s = 0;
+
+    for(i=0;i<n;i++) {
+        fifo_insert(fifo,i);
+        s += fifo_remove(fifo);
+    }
+    sink = s;
+}
+
+static void
+benchfifoblock(long n) {
+char buf[64];
+long i;
+
+    memset(buf,'x',sizeof(buf));
+    for(i=0;i<n;i++) {
+        fifo_write(fifo,buf,sizeof(buf));
+        fifo_read(fifo,buf,sizeof(buf));
+    }
+}
+///@}
+
+/**
+ * @brief   conversions.c
+ */
+///@{
+static void
+checkconversions(void) {
+char s[CONV_FLOAT_BUFSIZE];
+char r[CONV_FLOAT_BUFSIZE];
+unsigned u;
+int i,v;
+
+    for(i=0;i<NVALUES;i++) {
+        IntToString(ivalues[i],s);
+        CHECK(strcmp(s,istrings[i]) == 0,"IntToString(%d) = %s",ivalues[i],s);
+        UnsignedToString((unsigned) ivalues[i],s);
+        sprintf(r,"%u",(unsigned) ivalues[i]);
+        CHECK(strcmp(s,r) == 0,"UnsignedToString(%u) = %s",(unsigned) ivalues[i],s);
+        CHECK(StringToInt(istrings[i],&v) > 0 && v == ivalues[i],"StringToInt(%s)",istrings[i]);
+        sprintf(r,"%X",(unsigned) ivalues[i]);
+        CHECK(HexStringToUnsigned(r,&u) > 0 && u == (unsigned) ivalues[i],
+              "HexStringToUnsigned(%s)",r);
+        DoubleToString(dvalues[i],s);
+        CHECK(strtod(s,0) == dvalues[i],"DoubleToString(%.17g) = %s",dvalues[i],s);
+        DoubleToFixedString(dvalues[i],3,s);
+        sprintf(r,"%.3f",dvalues[i]);
+        CHECK(strcmp(s,r) == 0,"DoubleToFixedString(%.17g,3) = %s (%s)",dvalues[i],s,r);
+    }
+    CHECK(StringToInt("99999999999",&v) == CONV_ERROR_OVERFLOW,"overflow");
+    CHECK(StringToInt("x",&v) == CONV_ERROR_SYNTAX,"syntax");
+}
+
+static void
+benchinttostring(long n) {
+char s[16];
+long i;
+
+    for(i=0;i<n;i++)
+        IntToString(ivalues[i&(NVALUES-1)],s);
+    sink = s[0];
+}
+
+static void
+benchsprintfint(long n) {
+char s[16];
+long i;
+
+    for(i=0;i<n;i++)
+        sprintf(s,"%d",ivalues[i&(NVALUES-1)]);
+    sink = s[0];
+}
+
+static void
+benchstringtoint(long n) {
+long i;
+int v = 0;
+
+    for(i=0;i<n;i++)
+        StringToInt(istrings[i&(NVALUES-1)],&v);
+    sink = v;
+}
+
+static void
+benchstrtol(long n) {
+long i;
+long v = 0;
+
+    for(i=0;i<n;i++)
+        v = strtol(istrings[i&(NVALUES-1)],0,10);
+    sink = v;
+}
+
+static void
+benchdoubletostring(long n) {
+char s[CONV_FLOAT_BUFSIZE];
+long i;
+
+    for(i=0;i<n;i++)
+        DoubleToString(dvalues[i&(NVALUES-1)],s);
+    sink = s[0];
+}
+
+static void
+benchsprintfg(long n) {
+char s[CONV_FLOAT_BUFSIZE];
+long i;
+
+    for(i=0;i<n;i++)
+        sprintf(s,"%.17g",dvalues[i&(NVALUES-1)]);
+    sink = s[0];
+}
+
+static void
+benchdoubletofixed(long n) {
+char s[CONV_FLOAT_BUFSIZE];
+long i;
+
+    for(i=0;i<n;i++)
+        DoubleToFixedString(dvalues[i&(NVALUES-1)],3,s);
+    sink = s[0];
+}
+
+static void
+benchsprintff(long n) {
+char s[CONV_FLOAT_BUFSIZE];
+long i;
+
+    for(i=0;i<n;i++)
+        sprintf(s,"%.3f",dvalues[i&(NVALUES-1)]);
+    sink = s[0];
+}
+///@}
+
+/**
+ * @brief   ministdio.c
+ */
+///@{
+static void
+checkministdio(void) {
+char s[100];
+char r[100];
+int i,k;
+
+    for(i=0;i<NVALUES;i++) {
+        k = ivalues[i];
+        minisnprintf(s,sizeof(s),"%d|%5u|%-8x|%08X|%s|%c",k,(unsigned) k&0xFFFF,
+                     (unsigned) k,(unsigned) k,"abc",'A'+(i%26));
+        snprintf(r,sizeof(r),"%d|%5u|%-8x|%08X|%s|%c",k,(unsigned) k&0xFFFF,
+                 (unsigned) k,(unsigned) k,"abc",'A'+(i%26));
+        CHECK(strcmp(s,r) == 0,"minisnprintf %s (%s)",s,r);
+#ifndef MINIPRINTF_NOFLOAT
+        minisnprintf(s,sizeof(s),"%.3f %f",dvalues[i],dvalues[i]);
+        snprintf(r,sizeof(r),"%.3f %f",dvalues[i],dvalues[i]);
+        CHECK(strcmp(s,r) == 0,"minisnprintf %s (%s)",s,r);
+#endif
+    }
+    k = minisnprintf(s,8,"%s","0123456789");
+    CHECK(k == 10 && strcmp(s,"0123456") == 0,"truncation %d %s",k,s);
+}
+
+static void
+benchminisnprintf(long n) {
+char s[64];
+long i;
+
+    for(i=0;i<n;i++)
+        minisnprintf(s,sizeof(s),"%d %x %s",ivalues[i&(NVALUES-1)],(unsigned) i,"abc");
+    sink = s[0];
+}
+
+static void
+benchsnprintf(long n) {
+char s[64];
+long i;
+
+    for(i=0;i<n;i++)
+        snprintf(s,sizeof(s),"%d %x %s",ivalues[i&(NVALUES-1)],(unsigned) i,"abc");
+    sink = s[0];
+}
+///@}
+
+/**
+ * @brief   tte.c
+ *
+ * @note    Task_Update is called as in the SysTick and Task_Dispatch as in the
+ *          main loop, with TASK_MAXCNT tasks of periods 1 to TASK_MAXCNT
+ */
+///@{
+#define NTASKS      8
+
+static uint32_t     taskruns[NTASKS];
+
+#define TASK(N) static void task##N(void) { taskruns[N]++; }
+TASK(0) TASK(1) TASK(2) TASK(3) TASK(4) TASK(5) TASK(6) TASK(7)
+
+static void (*const tasks[NTASKS])(void) = {
+    task0, task1, task2, task3, task4, task5, task6, task7
+};
+
+static void
+checktte(void) {
+int i;
+
+    Task_Init();
+    for(i=0;i<NTASKS;i++) {
+        taskruns[i] = 0;
+        CHECK(Task_Add(tasks[i],i+1,0) == i,"Task_Add(%d)",i);
+    }
+    for(i=0;i<840;i++) {
+        Task_Update();
+        Task_Dispatch();
+    }
+    // Run at tick 0 and then every period+1 ticks
+    for(i=0;i<NTASKS;i++)
+        CHECK(taskruns[i] == (840+i+1)/(i+2),"task %d ran %u times",i,taskruns[i]);
+}
+
+static void
+benchtte(long n) {
+long i;
+
+    for(i=0;i<n;i++) {
+        Task_Update();
+        Task_Dispatch();
+    }
+}
+///@}
+
+static void
+usage(void) {
+
+    fprintf(stderr,"Usage: hostbench [-f filter] [-t ms]\n");
+    exit(1);
+}
+
+int
+main(int argc, char *argv[]) {
+int i;
+
+    for(i=1;i<argc;i++) {
+        if( strcmp(argv[i],"-f") == 0 && i+1 < argc ) {
+            filter = argv[++i];
+        } else if( strcmp(argv[i],"-t") == 0 && i+1 < argc ) {
+            mintime = atoi(argv[++i])/1000.0;
+        } else {
+            usage();
+        }
+    }
+
+    initvalues();
+    checkbuddy();
+    checkbitvector();
+    checkfifo();
+    checkconversions();
+    checkministdio();
+    checktte();
+
+    printf("%-36s %12s %12s\n","Benchmark","Iterations","Time");
+    bench("buddy/alloc_free_64",benchbuddyfixed);
+    bench("buddy/random_1_2048",benchbuddyrandom);
+    for(i=0;i<NBLOCKS;i++)
+        if( blocks[i] )
+            Buddy_FreeTo(pool,blocks[i]);
+    memset(blocks,0,sizeof(blocks));
+    bench("malloc/random_1_2048",benchmallocrandom);
+    bench("bitvector/set_test_clear",benchbitvector);
+    bench("fifo/insert_remove",benchfifochar);
+    bench("fifo/write_read_64",benchfifoblock);
+    bench("conversions/IntToString",benchinttostring);
+    bench("libc/sprintf_d",benchsprintfint);
+    bench("conversions/StringToInt",benchstringtoint);
+    bench("libc/strtol",benchstrtol);
+    bench("conversions/DoubleToString",benchdoubletostring);
+    bench("libc/sprintf_17g",benchsprintfg);
+    bench("conversions/DoubleToFixedString_3",benchdoubletofixed);
+    bench("libc/sprintf_3f",benchsprintff);
+    bench("ministdio/minisnprintf",benchminisnprintf);
+    bench("libc/snprintf",benchsnprintf);
+    bench("tte/update_dispatch_8",benchtte);
+
+    printf("%d checks failed\n",failures);
+    return failures != 0;
+}
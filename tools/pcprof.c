@@ -0,0 +1,268 @@
+/**
+ * @file    pcprof.c
+ *
+ * @note    Maps the PC samples printed by pcsample.c (X55-Benchmark) to the
+ *          functions of the ELF file of the firmware and prints the functions
+ *          in decreasing order of samples
+ *
+ * @note    Host program. Built with make pcprof (Makefile at the top). Usage
+ *
+ *          pcprof [-n lines] file.axf [samples.txt]
+ *
+ *          The samples are the lines PCSAMPLE,address,count of samples.txt (or
+ *          of stdin). Other lines are ignored, so the whole log can be given.
+ *          At most lines functions (default 40) are printed
+ *
+ * @note    The functions are the STT_FUNC symbols of .symtab (the ELF must not
+ *          be stripped). The Thumb bit of their addresses is cleared. A sample
+ *          counter covers 2^shift bytes and is given to the function at its
+ *          first byte, so with a large shift a short function can receive the
+ *          samples of its neighbour. The samples outside all functions are
+ *          summed as (unknown)
+ *
+ * @note    Reads 32 bit little endian ELF files only, without <elf.h>
+ *
+ * @date    15/10/2026
+ * @author  Hans
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief   ELF constants (System V ABI)
+ */
+///@{
+#define EI_CLASS        4
+#define EI_DATA         5
+#define ELFCLASS32      1
+#define ELFDATA2LSB     1
+#define SHT_SYMTAB      2
+#define STT_FUNC        2
+#define SHDRSIZE        40
+#define SYMSIZE         16
+///@}
+
+/**
+ * @brief   Functions
+ */
+///@{
+typedef struct {
+    const char  *name;
+    uint32_t    start;
+    uint32_t    end;                        // first byte after
+    uint64_t    samples;
+} Function;
+
+static Function     *functions = 0;
+static unsigned     nfunctions = 0;
+///@}
+
+/**
+ * @brief   Little endian fields
+ */
+///@{
+static uint32_t get16(const uint8_t *p) { return p[0]|(p[1]<<8); }
+static uint32_t get32(const uint8_t *p) { return p[0]|(p[1]<<8)|(p[2]<<16)|((uint32_t) p[3]<<24); }
+///@}
+
+static int cmpstart(const void *a, const void *b) {
+const Function *fa = a, *fb = b;
+
+    return (fa->start > fb->start)-(fa->start < fb->start);
+}
+
+static int cmpsamples(const void *a, const void *b) {
+const Function *fa = a, *fb = b;
+
+    return (fa->samples < fb->samples)-(fa->samples > fb->samples);
+}
+
+/**
+ * @brief   Read the file in memory
+ */
+static uint8_t *
+readfile(const char *fn, long *size) {
+FILE *f;
+uint8_t *buf;
+
+    f = fopen(fn,"rb");
+    if( !f )
+        return 0;
+    fseek(f,0,SEEK_END);
+    *size = ftell(f);
+    fseek(f,0,SEEK_SET);
+    buf = malloc(*size > 0 ? *size : 1);
+    if( buf && fread(buf,1,*size,f) != (size_t) *size ) {
+        free(buf);
+        buf = 0;
+    }
+    fclose(f);
+    return buf;
+}
+
+/**
+ * @brief   Load the functions of the symbol table, sorted by address
+ *
+ * @note    A function of size 0 (assembly) ends at the next one
+ */
+static int
+loadfunctions(const char *fn) {
+uint8_t *elf,*sh,*sym;
+uint32_t shoff,shnum,symoff,symsize,stroff,strsize,link,value,size,i,j;
+long len;
+
+    elf = readfile(fn,&len);
+    if( !elf ) {
+        fprintf(stderr,"pcprof: cannot read %s\n",fn);
+        return -1;
+    }
+    if( len < 52 || memcmp(elf,"\177ELF",4) != 0
+     || elf[EI_CLASS] != ELFCLASS32 || elf[EI_DATA] != ELFDATA2LSB ) {
+        fprintf(stderr,"pcprof: %s is not a 32 bit little endian ELF file\n",fn);
+        return -1;
+    }
+    shoff = get32(elf+32);
+    shnum = get16(elf+48);
+    if( shoff+(uint64_t) shnum*SHDRSIZE > (uint64_t) len ) {
+        fprintf(stderr,"pcprof: %s is truncated\n",fn);
+        return -1;
+    }
+
+    for(i=0;i<shnum;i++) {
+        sh = elf+shoff+i*SHDRSIZE;
+        if( get32(sh+4) == SHT_SYMTAB )
+            break;
+    }
+    if( i == shnum ) {
+        fprintf(stderr,"pcprof: %s has no symbol table (stripped?)\n",fn);
+        return -1;
+    }
+    symoff  = get32(sh+16);
+    symsize = get32(sh+20);
+    link    = get32(sh+24);
+    if( link >= shnum ) {
+        fprintf(stderr,"pcprof: %s has no string table\n",fn);
+        return -1;
+    }
+    stroff  = get32(elf+shoff+link*SHDRSIZE+16);
+    strsize = get32(elf+shoff+link*SHDRSIZE+20);
+    if( (uint64_t) symoff+symsize > (uint64_t) len || (uint64_t) stroff+strsize > (uint64_t) len ) {
+        fprintf(stderr,"pcprof: %s is truncated\n",fn);
+        return -1;
+    }
+
+    functions = calloc(symsize/SYMSIZE+1,sizeof(Function));
+    for(i=0;i<symsize/SYMSIZE;i++) {
+        sym = elf+symoff+i*SYMSIZE;
+        if( (sym[12]&0xF) != STT_FUNC || get16(sym+14) == 0 || get32(sym) >= strsize )
+            continue;
+        value = get32(sym+4)&~1U;
+        size  = get32(sym+8);
+        functions[nfunctions].name    = (const char *) elf+stroff+get32(sym);
+        functions[nfunctions].start   = value;
+        functions[nfunctions].end     = value+size;
+        functions[nfunctions].samples = 0;
+        nfunctions++;
+    }
+    qsort(functions,nfunctions,sizeof(Function),cmpstart);
+
+    // Aliases (same address) keep the first name
+    for(i=0,j=0;i<nfunctions;i++) {
+        if( j > 0 && functions[j-1].start == functions[i].start )
+            continue;
+        functions[j++] = functions[i];
+    }
+    nfunctions = j;
+    for(i=0;i<nfunctions;i++) {
+        if( functions[i].end == functions[i].start )
+            functions[i].end = (i+1 < nfunctions) ? functions[i+1].start : functions[i].start+2;
+    }
+    return 0;
+}
+
+/**
+ * @brief   Function containing address, or 0
+ */
+static Function *
+findfunction(uint32_t address) {
+unsigned lo = 0, hi = nfunctions, mid;
+
+    while( lo < hi ) {
+        mid = (lo+hi)/2;
+        if( functions[mid].start <= address )
+            lo = mid+1;
+        else
+            hi = mid;
+    }
+    if( lo == 0 || address >= functions[lo-1].end )
+        return 0;
+    return &functions[lo-1];
+}
+
+static void
+usage(void) {
+
+    fprintf(stderr,"usage: pcprof [-n lines] file.axf [samples.txt]\n");
+    exit(2);
+}
+
+int
+main(int argc, char *argv[]) {
+FILE *in = stdin;
+char line[256];
+unsigned long address,count;
+uint64_t total = 0, unknown = 0;
+unsigned lines = 40;
+Function *f;
+unsigned i;
+int argi = 1;
+
+    if( argi+1 < argc && strcmp(argv[argi],"-n") == 0 ) {
+        lines = (unsigned) atoi(argv[argi+1]);
+        argi += 2;
+    }
+    if( argi >= argc || argi+2 < argc )
+        usage();
+    if( loadfunctions(argv[argi]) < 0 )
+        return 1;
+    if( argi+1 < argc ) {
+        in = fopen(argv[argi+1],"r");
+        if( !in ) {
+            fprintf(stderr,"pcprof: cannot open %s\n",argv[argi+1]);
+            return 1;
+        }
+    }
+
+    while( fgets(line,sizeof(line),in) ) {
+        if( sscanf(line,"PCSAMPLE,%lx,%lu",&address,&count) != 2 )
+            continue;
+        total += count;
+        f = findfunction((uint32_t) address);
+        if( f )
+            f->samples += count;
+        else
+            unknown += count;
+    }
+    if( in != stdin )
+        fclose(in);
+    if( total == 0 ) {
+        fprintf(stderr,"pcprof: no PCSAMPLE lines\n");
+        return 1;
+    }
+
+    qsort(functions,nfunctions,sizeof(Function),cmpsamples);
+    printf("%7s %10s  %-10s  %s\n","%","samples","address","function");
+    for(i=0;i<nfunctions && i<lines && functions[i].samples;i++) {
+        printf("%6.2f%% %10llu  0x%08lX  %s\n",100.0*functions[i].samples/total,
+               (unsigned long long) functions[i].samples,
+               (unsigned long) functions[i].start,functions[i].name);
+    }
+    if( unknown )
+        printf("%6.2f%% %10llu  %-10s  (unknown)\n",100.0*unknown/total,
+               (unsigned long long) unknown,"");
+    printf("%7s %10llu\n","total",(unsigned long long) total);
+    return 0;
+}